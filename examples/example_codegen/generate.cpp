@@ -0,0 +1,37 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  generate.cpp
+ * @brief Generate the kinematics and dynamics kernels of a robot file.
+ *
+ * Usage: generate <robot file> <output.cpp> [model name], with gravity
+ * (0, 0, -9.8), as used by the benchmark.
+ */
+
+#include <gtdynamics/dynamics/CodeGenerator.h>
+#include <gtdynamics/universal_robot/sdf.h>
+
+#include <iostream>
+#include <string>
+
+using namespace gtdynamics;
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <robot file> <output.cpp> [model name]" << std::endl;
+    return 1;
+  }
+  const Robot robot =
+      CreateRobotFromFile(argv[1], argc > 3 ? argv[3] : std::string());
+  const DynamicsCodeGenerator generator(robot, gtsam::Vector3(0, 0, -9.8));
+  generator.write(argv[2]);
+  std::cout << "Wrote kernels of " << robot.numLinks() << " links and "
+            << robot.numJoints() << " joints to " << argv[2] << std::endl;
+  return 0;
+}
@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Accuracy and speed of the generated A1 kernels, loaded from a
+ * plugin, against the generic ArticulatedBodySolver.
+ *
+ * Usage: benchmark <plugin> [num_repeats]. Prints the largest difference of
+ * each kernel with the solver, the FD Jacobian being compared to central
+ * differences, then the time per call of both paths.
+ */
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/dynamics/GeneratedDynamics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+using namespace gtdynamics;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// Microseconds per call, after one warm-up call.
+double timePerCall(size_t num_repeats, const std::function<void()> &call) {
+  call();
+  const auto start = Clock::now();
+  for (size_t k = 0; k < num_repeats; k++) call();
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+             .count() /
+         num_repeats;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <plugin> [num_repeats]"
+              << std::endl;
+    return 1;
+  }
+  const size_t num_repeats = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const ArticulatedBodySolver solver(robot, kGravity);
+  const GeneratedDynamics generated =
+      GeneratedDynamics::Load(robot, argv[1], kGravity);
+
+  // A bent, moving configuration of a tilted floating base.
+  const size_t m = solver.numJoints();
+  Vector q(m), v(m), a(m), tau(m);
+  for (size_t j = 0; j < m; j++) {
+    q(j) = 0.3 * std::sin(j + 1.0);
+    v(j) = 0.5 * std::cos(j + 1.0);
+    a(j) = 0.2 * std::sin(2.0 * j);
+    tau(j) = std::cos(3.0 * j);
+  }
+  const Pose3 wTroot(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                     gtsam::Point3(0.1, 0.0, 0.3));
+  Vector6 V_root;
+  V_root << 0.1, -0.1, 0.2, 0.3, 0.0, -0.1;
+
+  // Accuracy.
+  TreeDynamicsResult result;
+  TreeDynamicsWorkspace workspace;
+  solver.forwardDynamics(q, v, tau, wTroot, V_root, &result, &workspace);
+  const Vector qdd = result.joint_accels;
+  double pose_error = 0;
+  const std::vector<Pose3> poses = generated.forwardKinematics(q, wTroot);
+  for (size_t i = 0; i < poses.size(); i++) {
+    pose_error = std::max(
+        pose_error,
+        (poses[i].matrix() - result.poses[i].matrix()).cwiseAbs().maxCoeff());
+  }
+  std::cout << "FK max error: " << pose_error << std::endl;
+  std::cout << "FD max error: "
+            << (generated.forwardDynamics(q, v, tau, wTroot, V_root) - qdd)
+                   .cwiseAbs()
+                   .maxCoeff()
+            << std::endl;
+  solver.inverseDynamics(q, v, qdd, wTroot, V_root, &result);
+  std::cout << "ID max error: "
+            << (generated.inverseDynamics(q, v, qdd, wTroot, V_root) - tau)
+                   .cwiseAbs()
+                   .maxCoeff()
+            << std::endl;
+
+  Matrix J_q, J_v, J_tau;
+  generated.forwardDynamics(q, v, tau, wTroot, V_root, &J_q, &J_v, &J_tau);
+  const double h = 1e-6;
+  Matrix numerical(m, m);
+  for (size_t j = 0; j < m; j++) {
+    Vector dq = Vector::Zero(m);
+    dq(j) = h;
+    solver.forwardDynamics(q + dq, v, tau, wTroot, V_root, &result,
+                           &workspace);
+    const Vector plus = result.joint_accels;
+    solver.forwardDynamics(q - dq, v, tau, wTroot, V_root, &result,
+                           &workspace);
+    numerical.col(j) = (plus - result.joint_accels) / (2 * h);
+  }
+  std::cout << "FD Jacobian max error: "
+            << (J_q - numerical).cwiseAbs().maxCoeff() << std::endl;
+
+  // Speed.
+  Vector out(m);
+  std::cout << "path,fd_us,id_us,fd_jacobian_us" << std::endl;
+  const double solver_fd = timePerCall(num_repeats, [&] {
+    solver.forwardDynamics(q, v, tau, wTroot, V_root, &result, &workspace);
+  });
+  const double solver_id = timePerCall(num_repeats, [&] {
+    solver.inverseDynamics(q, v, a, wTroot, V_root, &result);
+  });
+  const double solver_jacobian = timePerCall(num_repeats / 10 + 1, [&] {
+    for (size_t j = 0; j < m; j++) {
+      Vector dq = Vector::Zero(m);
+      dq(j) = h;
+      solver.forwardDynamics(q + dq, v, tau, wTroot, V_root, &result,
+                             &workspace);
+      solver.forwardDynamics(q - dq, v, tau, wTroot, V_root, &result,
+                             &workspace);
+    }
+  });
+  std::cout << "ArticulatedBodySolver," << solver_fd << "," << solver_id
+            << "," << solver_jacobian << std::endl;
+
+  const double generated_fd = timePerCall(num_repeats, [&] {
+    generated.forwardDynamics(q, v, tau, wTroot, V_root, &out);
+  });
+  const double generated_id = timePerCall(num_repeats, [&] {
+    out = generated.inverseDynamics(q, v, a, wTroot, V_root);
+  });
+  const double generated_jacobian = timePerCall(num_repeats / 10 + 1, [&] {
+    generated.forwardDynamics(q, v, tau, wTroot, V_root, &J_q, nullptr,
+                              nullptr);
+  });
+  std::cout << "GeneratedDynamics," << generated_fd << "," << generated_id
+            << "," << generated_jacobian << std::endl;
+  return 0;
+}
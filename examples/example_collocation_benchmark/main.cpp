@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Per-factor timing of the link pose collocation factors, against the
+ * previous implementation with dynamic-size intermediate Jacobians.
+ */
+
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+using namespace gtdynamics;
+
+namespace legacy {
+
+// The Euler pose collocation factor as it was: intermediate Jacobians are
+// dynamic-size and always computed.
+class EulerPoseCollocationFactor
+    : public gtsam::NoiseModelFactor4<Pose3, Pose3, Vector6, double> {
+  using Base = gtsam::NoiseModelFactor4<Pose3, Pose3, Vector6, double>;
+
+ public:
+  EulerPoseCollocationFactor(gtsam::Key pose_t0_key, gtsam::Key pose_t1_key,
+                             gtsam::Key twist_key, gtsam::Key dt_key,
+                             const gtsam::noiseModel::Base::shared_ptr &model)
+      : Base(model, pose_t0_key, pose_t1_key, twist_key, dt_key) {}
+
+  gtsam::Vector evaluateError(
+      const Pose3 &pose_t0, const Pose3 &pose_t1, const Vector6 &twist,
+      const double &dt, boost::optional<Matrix &> H_pose_t0 = boost::none,
+      boost::optional<Matrix &> H_pose_t1 = boost::none,
+      boost::optional<Matrix &> H_twist = boost::none,
+      boost::optional<Matrix &> H_dt = boost::none) const override {
+    Vector6 twistdt = twist * dt;
+    Matrix Hexp, H_compose, H_twistdt;
+    Pose3 t1Tt0 = Pose3::Expmap(twistdt, Hexp);
+    Pose3 pose_t1_hat = pose_t0.compose(t1Tt0, H_pose_t0, H_compose);
+    H_twistdt = H_compose * Hexp;
+    gtsam::Vector error = pose_t1.logmap(pose_t1_hat);
+    if (H_pose_t1) *H_pose_t1 = -gtsam::I_6x6;
+    if (H_twist) *H_twist = H_twistdt * dt;
+    if (H_dt) *H_dt = H_twistdt * twist;
+    return error;
+  }
+};
+
+}  // namespace legacy
+
+// Return the seconds per linearization of a factor, averaged over a loop.
+double timeLinearize(const gtsam::NonlinearFactor &factor,
+                     const gtsam::Values &values, size_t num_repeats) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_repeats; i++) factor.linearize(values);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / num_repeats;
+}
+
+int main(int argc, char **argv) {
+  const size_t num_repeats = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+  gtsam::Symbol p0('p', 0), p1('p', 1), v0('v', 0), v1('v', 1), a0('a', 0),
+      a1('a', 1), dt_key('t', 0);
+  auto model = gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+
+  Vector6 twist_t0, twist_t1, accel_t0, accel_t1;
+  twist_t0 << 0.1, 0.6, 0.2, -0.1, 0.9, 1;
+  twist_t1 << 0.6, 0.2, -0.1, 0.4, -0.8, -0.9;
+  accel_t0 << 2, -9, -1, 5, -7, -9;
+  accel_t1 << 1, 2, 3, -4, 5, -6;
+  const double dt = 0.01;
+  const Pose3 pose_t0(Rot3::RzRyRx(0.7, -0.5, 2), gtsam::Point3(0.4, -0.3, 1));
+
+  gtsam::Values values;
+  values.insert(p0, pose_t0);
+  values.insert(p1, pose_t0 * Pose3::Expmap(twist_t0 * dt));
+  values.insert(v0, twist_t0);
+  values.insert(v1, twist_t1);
+  values.insert(a0, accel_t0);
+  values.insert(a1, accel_t1);
+  values.insert(dt_key, dt);
+
+  const double legacy_euler = timeLinearize(
+      legacy::EulerPoseCollocationFactor(p0, p1, v0, dt_key, model), values,
+      num_repeats);
+  const double euler = timeLinearize(
+      EulerPoseCollocationFactor(p0, p1, v0, dt_key, model), values,
+      num_repeats);
+  const double trapezoidal = timeLinearize(
+      TrapezoidalPoseCollocationFactor(p0, p1, v0, v1, dt_key, model), values,
+      num_repeats);
+  const double hermite_simpson = timeLinearize(
+      HermiteSimpsonPoseCollocationFactor(p0, p1, v0, v1, a0, a1, dt_key,
+                                          model),
+      values, num_repeats);
+
+  std::cout << "factor,microseconds per linearize\n";
+  std::cout << "legacy Euler," << 1e6 * legacy_euler << "\n";
+  std::cout << "Euler," << 1e6 * euler << "\n";
+  std::cout << "trapezoidal," << 1e6 * trapezoidal << "\n";
+  std::cout << "Hermite-Simpson," << 1e6 * hermite_simpson << "\n";
+  std::cout << "Euler speedup," << legacy_euler / euler << std::endl;
+  return 0;
+}
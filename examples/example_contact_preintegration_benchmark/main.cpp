@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Throughput of streaming contact preintegration at 1 kHz, alone and
+ * inside an incremental estimator with a keyframe every 50 ms.
+ */
+
+#include <gtdynamics/factors/PreintegratedContactFactors.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/navigation/ImuFactor.h>
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using gtsam::I_3x3;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+
+using namespace gtdynamics;
+
+int main(int argc, char **argv) {
+  const double duration = argc > 1 ? std::stod(argv[1]) : 10.0;
+  const double dt = 1e-3;            // 1 kHz contact and IMU rate
+  const size_t steps_per_keyframe = 50;
+  const size_t num_steps = duration / dt;
+  const int base_id = 0, foot_id = 1;
+
+  // The base walks along x with a stance foot fixed on the ground, so the
+  // base and contact frames keep the same rotation.
+  const double speed = 0.5;
+  const Point3 foot(0.2, 0.1, 0.0);
+  auto base_pose = [&](size_t k) {
+    return Pose3(Rot3(), Point3(speed * k * dt, 0, 0.4));
+  };
+  const Vector3 gravity_specific_force(0, 0, 9.81), omega(0, 0, 0);
+
+  // Preintegration alone.
+  {
+    gtsam::PreintegratedImuMeasurements pim(
+        gtsam::PreintegrationParams::MakeSharedU(9.81));
+    PreintegratedPointContactMeasurements point(I_3x3 * 1e-4);
+    PreintegratedRigidContactMeasurements rigid(I_3x3 * 1e-4, I_3x3 * 1e-4);
+    const Pose3 bTc(Rot3(), Point3(0.2, 0.1, -0.4));
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t k = 1; k <= num_steps; k++) {
+      pim.integrateMeasurement(gravity_specific_force, omega, dt);
+      point.integrateMeasurement(pim, bTc);
+      rigid.integrateMeasurement(dt);
+      if (k % steps_per_keyframe == 0) {
+        pim.resetIntegration();
+        point.resetIntegration();
+        rigid.resetIntegration();
+      }
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "preintegration,measurements per second,"
+              << num_steps / elapsed.count() << "\n";
+  }
+
+  // Incremental estimator: at each keyframe, a point and a rigid contact
+  // factor summarize the contact measurements since the previous one.
+  gtsam::ISAM2 isam;
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values initial;
+  graph.emplace_shared<gtsam::PriorFactor<Pose3>>(
+      PoseKey(base_id, 0), base_pose(0),
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3));
+  graph.emplace_shared<gtsam::PriorFactor<Pose3>>(
+      PoseKey(foot_id, 0), Pose3(Rot3(), foot),
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3));
+  initial.insert(PoseKey(base_id, 0), base_pose(0));
+  initial.insert(PoseKey(foot_id, 0), Pose3(Rot3(), foot));
+
+  gtsam::PreintegratedImuMeasurements pim(
+      gtsam::PreintegrationParams::MakeSharedU(9.81));
+  PreintegratedPointContactMeasurements point(I_3x3 * 1e-4);
+  PreintegratedRigidContactMeasurements rigid(I_3x3 * 1e-4, I_3x3 * 1e-4);
+  const auto odometry_model = gtsam::noiseModel::Isotropic::Sigma(6, 1e-2);
+
+  size_t num_keyframes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t k = 1; k <= num_steps; k++) {
+    pim.integrateMeasurement(gravity_specific_force, omega, dt);
+    const Pose3 bTc = base_pose(k).between(Pose3(Rot3(), foot));
+    point.integrateMeasurement(pim, bTc);
+    rigid.integrateMeasurement(dt);
+    if (k % steps_per_keyframe != 0) continue;
+
+    const int i = num_keyframes, j = num_keyframes + 1;
+    const size_t k_i = k - steps_per_keyframe;
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(base_id, i), PoseKey(base_id, j),
+        base_pose(k_i).between(base_pose(k)), odometry_model);
+    graph.emplace_shared<PreintegratedPointContactFactor>(
+        PoseKey(base_id, i), PoseKey(foot_id, i), PoseKey(base_id, j),
+        PoseKey(foot_id, j), point);
+    graph.emplace_shared<PreintegratedRigidContactFactor>(
+        PoseKey(foot_id, i), PoseKey(foot_id, j), rigid);
+    initial.insert(PoseKey(base_id, j), base_pose(k));
+    initial.insert(PoseKey(foot_id, j), Pose3(Rot3(), foot));
+
+    isam.update(graph, initial);
+    graph.resize(0);
+    initial.clear();
+    pim.resetIntegration();
+    point.resetIntegration();
+    rigid.resetIntegration();
+    num_keyframes++;
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  const Pose3 estimate =
+      isam.calculateEstimate<Pose3>(PoseKey(base_id, num_keyframes));
+  std::cout << "estimator,measurements per second,"
+            << num_steps / elapsed.count() << "\n";
+  std::cout << "estimator,milliseconds per keyframe,"
+            << 1e3 * elapsed.count() / num_keyframes << "\n";
+  std::cout << "estimator,real-time factor," << duration / elapsed.count()
+            << "\n";
+  std::cout << "estimator,final base x error,"
+            << estimate.x() - base_pose(num_steps).x() << std::endl;
+  return 0;
+}
@@ -0,0 +1,206 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Core scaling of the multifrontal elimination of the A1 and spider
+ * trajectory problems, for several orderings.
+ *
+ * Usage: <benchmark> [horizon [repetitions]]. For each robot and ordering
+ * (COLAMD, TimeOrdering, NestedTimeOrdering, and METIS if GTSAM has it) the
+ * first table gives the number of cliques and the depth of the Bayes tree,
+ * whose ratio bounds the parallelism of the elimination, and the median time
+ * of eliminating the linearized problem with each thread count. The second
+ * table times a few LM iterations of the Optimizer with nested_ordering and
+ * num_threads. Without TBB only one thread is timed.
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/config.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using gtsam::noiseModel::Isotropic;
+using gtsam::noiseModel::Unit;
+
+using namespace gtdynamics;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Thread counts to time: powers of two up to the hardware concurrency.
+vector<size_t> ThreadCounts() {
+#ifdef GTSAM_USE_TBB
+  const size_t max_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  vector<size_t> counts;
+  for (size_t n = 1; n < max_threads; n *= 2) counts.push_back(n);
+  counts.push_back(max_threads);
+  return counts;
+#else
+  return {1};
+#endif
+}
+
+// A floating-base robot, and the link whose initial pose and twist are fixed.
+struct Model {
+  string name;
+  Robot robot;
+  string base_name;
+};
+
+// Start at rest in the zero configuration, with a fixed time step and the
+// least torque, as in example_trajectory_scaling_benchmark.
+gtsam::NonlinearFactorGraph BuildGraph(const Model &model, int num_steps,
+                                       gtsam::Values *initial) {
+  const double dt = 1. / 240, sigma = 1e-5;
+  OptimizerSetting opt(sigma);
+  DynamicsGraph graph_builder(opt, gtsam::Vector3(0, 0, -9.8));
+  auto graph = graph_builder.multiPhaseTrajectoryFG(
+      model.robot, {num_steps}, {}, CollocationScheme::Trapezoidal);
+  auto base = model.robot.link(model.base_name);
+  graph.add(LinkObjectives(base->id(), 0)
+                .pose(base->bMcom(), Isotropic::Sigma(6, sigma))
+                .twist(gtsam::Z_6x1, Isotropic::Sigma(6, sigma)));
+  graph.addPrior<double>(PhaseKey(0), dt, Isotropic::Sigma(1, sigma));
+  for (auto &&joint : model.robot.joints()) {
+    const int j = joint->id();
+    graph.addPrior<double>(JointAngleKey(j, 0), 0.0,
+                           Isotropic::Sigma(1, sigma));
+    graph.addPrior<double>(JointVelKey(j, 0), 0.0, Isotropic::Sigma(1, sigma));
+    for (int k = 0; k <= num_steps; k++) {
+      graph.emplace_shared<MinTorqueFactor>(TorqueKey(j, k), Unit::Create(1));
+    }
+  }
+  Initializer initializer;
+  *initial = initializer.MultiPhaseZeroValuesTrajectory(
+      model.robot, {num_steps}, {}, dt, sigma);
+  return graph;
+}
+
+// Depth of the subtree of a clique, in cliques.
+size_t Depth(const gtsam::GaussianBayesTree::sharedClique &clique) {
+  size_t depth = 0;
+  for (auto &&child : clique->children) depth = std::max(depth, Depth(child));
+  return depth + 1;
+}
+
+// Median time of eliminating the graph with an ordering.
+double EliminateSeconds(const gtsam::GaussianFactorGraph &linear,
+                        const gtsam::Ordering &ordering, size_t threads,
+                        size_t repetitions) {
+  vector<double> times;
+  WithThreads(threads, [&] {
+    for (size_t r = 0; r < repetitions; r++) {
+      const auto start = Clock::now();
+      linear.eliminateMultifrontal(ordering);
+      times.push_back(Seconds(start));
+    }
+  });
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+void RunElimination(const Model &model, int num_steps, size_t repetitions) {
+  gtsam::Values initial;
+  const auto graph = BuildGraph(model, num_steps, &initial);
+  const auto linear = graph.linearize(initial);
+
+  vector<std::pair<string, std::function<gtsam::Ordering()>>> orderings = {
+      {"COLAMD", [&] { return gtsam::Ordering::Colamd(*linear); }},
+      {"TIME", [&] { return TimeOrdering(graph); }},
+      {"NESTED_TIME", [&] { return NestedTimeOrdering(graph); }}};
+#ifdef GTSAM_SUPPORT_NESTED_DISSECTION
+  orderings.emplace_back("METIS",
+                         [&] { return gtsam::Ordering::Metis(*linear); });
+#endif
+
+  for (auto &&named : orderings) {
+    const gtsam::Ordering ordering = named.second();
+    const auto bayes_tree = linear->eliminateMultifrontal(ordering);
+    size_t depth = 0;
+    for (auto &&root : bayes_tree->roots()) {
+      depth = std::max(depth, Depth(root));
+    }
+    double serial = 0;
+    for (size_t threads : ThreadCounts()) {
+      const double seconds =
+          EliminateSeconds(*linear, ordering, threads, repetitions);
+      if (threads == 1) serial = seconds;
+      std::cout << model.name << "," << num_steps << "," << named.first << ","
+                << bayes_tree->size() << "," << depth << "," << threads << ","
+                << 1e3 * seconds << "," << serial / seconds << std::endl;
+    }
+  }
+}
+
+void RunOptimizer(const Model &model, int num_steps) {
+  gtsam::Values initial;
+  const auto graph = BuildGraph(model, num_steps, &initial);
+  double serial = 0;
+  for (size_t threads : ThreadCounts()) {
+    OptimizationParameters parameters;
+    parameters.lm_parameters.setMaxIterations(3);
+    parameters.nested_ordering = true;
+    parameters.num_threads = threads;
+    const auto start = Clock::now();
+    const gtsam::Values result =
+        Optimizer(parameters).optimize(graph, initial);
+    const double seconds = Seconds(start);
+    if (threads == 1) serial = seconds;
+    std::cout << model.name << "," << num_steps << "," << threads << ","
+              << seconds << "," << serial / seconds << ","
+              << graph.error(result) << std::endl;
+  }
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  const int num_steps = argc > 1 ? std::stoi(argv[1]) : 200;
+  const size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 5;
+
+  const vector<Model> models = {
+      {"a1", CreateRobotFromFile(kUrdfPath + string("a1/a1.urdf")), "trunk"},
+      {"spider",
+       CreateRobotFromFile(kSdfPath + string("spider_alt.sdf"), "spider"),
+       "body"}};
+
+  std::cout << "robot,horizon,ordering,cliques,depth,threads,eliminate_ms,"
+               "speedup"
+            << std::endl;
+  for (auto &&model : models) RunElimination(model, num_steps, repetitions);
+
+  std::cout << std::endl
+            << "robot,horizon,threads,solve_seconds,speedup,error"
+            << std::endl;
+  for (auto &&model : models) RunOptimizer(model, num_steps);
+  return 0;
+}
@@ -0,0 +1,238 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Per-factor timing and heap allocations of the error, the error with
+ * Jacobians and the linearization of each factor type, on the A1 robot.
+ */
+
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/factors/ContactEqualityFactor.h>
+#include <gtdynamics/factors/ContactHeightFactor.h>
+#include <gtdynamics/factors/ContactKinematicsAccelFactor.h>
+#include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/factors/ContactPointFactor.h>
+#include <gtdynamics/factors/JointLimitFactor.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/factors/PoseFactor.h>
+#include <gtdynamics/factors/TorqueFactor.h>
+#include <gtdynamics/factors/TwistAccelFactor.h>
+#include <gtdynamics/factors/TwistFactor.h>
+#include <gtdynamics/factors/WrenchEquivalenceFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/factors/WrenchPlanarFactor.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+using namespace gtdynamics;
+
+namespace {
+// Number of heap allocations so far, counted by the malloc below.
+size_t num_allocations = 0;
+bool counts_allocations = false;
+}  // namespace
+
+#if defined(__GLIBC__)
+// Count every heap allocation of the process, including those of Eigen,
+// which bypass operator new.
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *malloc(size_t size) noexcept {
+  num_allocations++;
+  return __libc_malloc(size);
+}
+#endif
+
+// Time and heap allocations per call of a function, averaged over a loop.
+struct Measurement {
+  double ns;
+  double allocations;
+};
+
+template <typename Function>
+Measurement measure(size_t num_repeats, Function &&function) {
+  function();  // warm up
+  const size_t allocations = num_allocations;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_repeats; i++) function();
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return {elapsed.count() / num_repeats,
+          double(num_allocations - allocations) / num_repeats};
+}
+
+// Insert values for the keys of a factor that have none yet, by the label of
+// their DynamicsSymbol: poses, twists, accelerations, wrenches and contact
+// wrenches of links, and scalars of joints.
+void insertValues(const gtsam::NonlinearFactor &factor, gtsam::Values *values) {
+  for (gtsam::Key key : factor.keys()) {
+    if (values->exists(key)) continue;
+    const double s = 0.1 * (values->size() + 1);
+    const std::string label = DynamicsSymbol(key).label();
+    if (label == "p") {
+      values->insert(key, Pose3(Rot3::RzRyRx(s, -2 * s, 3 * s),
+                                Point3(s, 2 * s, -s)));
+    } else if (label == "V" || label == "A" || label == "F" ||
+               label == "C") {
+      Vector6 v;
+      v << s, -s, 2 * s, 0.5, -0.3, 3 * s;
+      values->insert(key, v);
+    } else {
+      values->insert(key, s);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  const size_t num_repeats = argc > 1 ? std::stoul(argv[1]) : 100000;
+#if defined(__GLIBC__)
+  counts_allocations = true;
+#endif
+
+  auto robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const JointConstSharedPtr joint = robot.joint("FR_lower_joint");
+  const LinkConstSharedPtr link = robot.link("FR_lower");
+  std::vector<DynamicsSymbol> wrench_keys;
+  for (auto &&link_joint : link->joints()) {
+    wrench_keys.push_back(WrenchKey(link->id(), link_joint->id(), 0));
+  }
+  const Vector3 gravity(0, 0, -9.8);
+  const int i = link->id(), j = joint->id();
+  const gtsam::Symbol contact_key('c', 0), dt_key('t', 0);
+  const PointOnLink foot(robot.link("FR_lower"), Point3(0, 0, -0.07));
+  const Pose3 cTcom(Rot3(), -foot.point);
+
+  auto model = [](size_t dim) { return gtsam::noiseModel::Unit::Create(dim); };
+  const std::vector<
+      std::pair<std::string, gtsam::NoiseModelFactor::shared_ptr>>
+      factors = {
+          {"PoseFactor", PoseFactor(model(6), joint, 0)},
+          {"AnalyticPoseFactor",
+           boost::make_shared<AnalyticPoseFactor>(model(6), joint, 0)},
+          {"TwistFactor", TwistFactor(model(6), joint, 0)},
+          {"AnalyticTwistFactor",
+           boost::make_shared<AnalyticTwistFactor>(model(6), joint, 0)},
+          {"TwistAccelFactor", TwistAccelFactor(model(6), joint, 0)},
+          {"AnalyticTwistAccelFactor",
+           boost::make_shared<AnalyticTwistAccelFactor>(model(6), joint, 0)},
+          {"WrenchFactor",
+           WrenchFactor(model(6), link, wrench_keys, 0, gravity)},
+          {"AnalyticWrenchFactor",
+           boost::make_shared<AnalyticWrenchFactor>(model(6), link,
+                                                    wrench_keys, 0, gravity)},
+          {"TorqueFactor", TorqueFactor(model(1), joint, 0)},
+          {"WrenchEquivalenceFactor",
+           WrenchEquivalenceFactor(model(6), joint, 0)},
+          {"WrenchPlanarFactor",
+           WrenchPlanarFactor(model(3), Vector3(1, 0, 0), joint, 0)},
+          {"MinTorqueFactor",
+           boost::make_shared<MinTorqueFactor>(TorqueKey(j, 0), model(1))},
+          {"JointLimitFactor",
+           boost::make_shared<JointLimitFactor>(JointAngleKey(j, 0), model(1),
+                                                -1.0, 1.0, 0.1)},
+          {"ContactPointFactor",
+           boost::make_shared<ContactPointFactor>(
+               PoseKey(i, 0), contact_key, model(3), Point3(0, 0, -0.07))},
+          {"ContactEqualityFactor",
+           boost::make_shared<ContactEqualityFactor>(foot, model(3), 0, 1)},
+          {"ContactKinematicsTwistFactor",
+           boost::make_shared<ContactKinematicsTwistFactor>(
+               TwistKey(i, 0), model(3), cTcom)},
+          {"AnalyticContactKinematicsTwistFactor",
+           boost::make_shared<AnalyticContactKinematicsTwistFactor>(
+               TwistKey(i, 0), model(3), cTcom)},
+          {"ContactKinematicsAccelFactor",
+           boost::make_shared<ContactKinematicsAccelFactor>(
+               TwistAccelKey(i, 0), model(3), cTcom)},
+          {"AnalyticContactKinematicsAccelFactor",
+           boost::make_shared<AnalyticContactKinematicsAccelFactor>(
+               TwistAccelKey(i, 0), model(3), cTcom)},
+          {"ContactDynamicsMomentFactor",
+           boost::make_shared<ContactDynamicsMomentFactor>(
+               ContactWrenchKey(i, 0, 0), model(3), cTcom)},
+          {"AnalyticContactDynamicsMomentFactor",
+           boost::make_shared<AnalyticContactDynamicsMomentFactor>(
+               ContactWrenchKey(i, 0, 0), model(3), cTcom)},
+          {"ContactHeightFactor",
+           boost::make_shared<ContactHeightFactor>(
+               PoseKey(i, 0), model(1), Point3(0, 0, -0.07), gravity)},
+          {"PointGoalFactor",
+           boost::make_shared<PointGoalFactor>(PoseKey(i, 0), model(3),
+                                               Point3(0, 0, -0.07),
+                                               Point3(0.2, -0.1, 0))},
+          {"EulerPoseCollocationFactor",
+           boost::make_shared<EulerPoseCollocationFactor>(
+               PoseKey(i, 0), PoseKey(i, 1), TwistKey(i, 0), dt_key,
+               model(6))},
+          {"TrapezoidalPoseCollocationFactor",
+           boost::make_shared<TrapezoidalPoseCollocationFactor>(
+               PoseKey(i, 0), PoseKey(i, 1), TwistKey(i, 0), TwistKey(i, 1),
+               dt_key, model(6))},
+          {"HermiteSimpsonPoseCollocationFactor",
+           boost::make_shared<HermiteSimpsonPoseCollocationFactor>(
+               PoseKey(i, 0), PoseKey(i, 1), TwistKey(i, 0), TwistKey(i, 1),
+               TwistAccelKey(i, 0), TwistAccelKey(i, 1), dt_key, model(6))},
+          {"EulerTwistCollocationFactor",
+           boost::make_shared<EulerTwistCollocationFactor>(
+               TwistKey(i, 0), TwistKey(i, 1), TwistAccelKey(i, 0), dt_key,
+               model(6))},
+          {"TrapezoidalTwistCollocationFactor",
+           boost::make_shared<TrapezoidalTwistCollocationFactor>(
+               TwistKey(i, 0), TwistKey(i, 1), TwistAccelKey(i, 0),
+               TwistAccelKey(i, 1), dt_key, model(6))}};
+
+  gtsam::Values values;
+  values.insert(contact_key, Point3(0.1, -0.2, 0));
+  values.insert(dt_key, 0.01);
+  for (auto &&factor : factors) insertValues(*factor.second, &values);
+
+  std::cout << "factor,mode,ns per op,allocations per op\n";
+  for (auto &&named_factor : factors) {
+    const gtsam::NoiseModelFactor &factor = *named_factor.second;
+    std::vector<Matrix> H(factor.size());
+    volatile double sink = 0;  // keeps the calls
+    const std::vector<std::pair<std::string, Measurement>> measurements = {
+        {"error", measure(num_repeats,
+                          [&] { sink += factor.unwhitenedError(values)(0); })},
+        {"error+Jacobians",
+         measure(num_repeats,
+                 [&] { sink += factor.unwhitenedError(values, H)(0); })},
+        {"linearize", measure(num_repeats, [&] {
+           sink += factor.linearize(values)->size();
+         })}};
+    for (auto &&measurement : measurements) {
+      std::cout << named_factor.first << "," << measurement.first << ","
+                << measurement.second.ns << ",";
+      if (counts_allocations) {
+        std::cout << measurement.second.allocations;
+      } else {
+        std::cout << "n/a";
+      }
+      std::cout << "\n";
+    }
+  }
+  std::cout << std::flush;
+  return 0;
+}
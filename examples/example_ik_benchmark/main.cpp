@@ -0,0 +1,355 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Success rate, solve-time distribution and throughput of the inverse
+ * kinematics solvers on the Panda, the A1 legs and the spider.
+ *
+ * Usage: <benchmark> [problems] [seed] [tolerance]. Each problem is a set of
+ * goals reached by forward kinematics at random joint angles, drawn from
+ * RandomStream(seed, problem), so goal sets do not depend on the thread
+ * count. A problem is solved when all its goals are within tolerance.
+ *
+ * Solvers: Kinematics::inverse with each OptimizationParameters::Method,
+ * ChainInverseKinematics (damped least squares given the trunk pose),
+ * BatchInverseKinematics, and the analytic solver of the robot, if one is
+ * registered in AnalyticIKRegistry. The Panda base is pinned by a prior for
+ * the Kinematics methods, the legged robots float as in Kinematics::inverse.
+ * Solvers a robot does not support are skipped. Every solver runs the whole
+ * problem set with each thread count; without TBB only one thread is timed.
+ */
+
+#include <gtdynamics/kinematics/AnalyticIK.h>
+#include <gtdynamics/kinematics/BatchInverseKinematics.h>
+#include <gtdynamics/kinematics/ChainInverseKinematics.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/RandomStream.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/config.h>
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using std::string;
+using std::vector;
+
+using namespace gtdynamics;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+constexpr size_t k = 0;
+
+double Seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Thread counts to time: powers of two up to the hardware concurrency.
+vector<int> threadCounts() {
+#ifdef GTSAM_USE_TBB
+  const int max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  vector<int> counts;
+  for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+  counts.push_back(max_threads);
+  return counts;
+#else
+  return {1};
+#endif
+}
+
+// Run f with at most n threads.
+void withThreads(int n, const std::function<void()> &f) {
+#ifdef GTSAM_USE_TBB
+  tbb::task_arena arena(n);
+  arena.execute(f);
+#else
+  (void)n;
+  f();
+#endif
+}
+
+// A robot, its base link and the points with goals.
+struct Model {
+  string name;
+  Robot robot;
+  string base;
+  vector<PointOnLink> end_effectors;
+  double window;  // joint angles are drawn in [-window, window] if feasible
+  bool pinned;    // whether the Kinematics methods keep the base in place
+};
+
+// The goals reached at random joint angles, with the base at rest.
+struct Problem {
+  Values angles;
+  ContactGoals goals;
+};
+
+Pose3 BasePose(const Model &model) {
+  return model.robot.link(model.base)->bMcom();
+}
+
+vector<Problem> RandomProblems(const Model &model, size_t n, uint64_t seed) {
+  vector<Problem> problems(n);
+  for (size_t i = 0; i < n; i++) {
+    RandomStream stream(seed, i);
+    Problem &problem = problems[i];
+    for (auto &&joint : model.robot.joints()) {
+      const auto &limits = joint->parameters().scalar_limits;
+      double lo = std::max(limits.value_lower_limit, -model.window),
+             hi = std::min(limits.value_upper_limit, model.window);
+      if (lo > hi) {
+        lo = limits.value_lower_limit;
+        hi = limits.value_upper_limit;
+      }
+      InsertJointAngle(&problem.angles, joint->id(), k,
+                       lo + (hi - lo) * stream.uniform());
+    }
+    Values values = problem.angles;
+    InsertPose(&values, model.robot.link(model.base)->id(), k,
+               BasePose(model));
+    const Values fk = model.robot.forwardKinematics(values, k, model.base);
+    for (const PointOnLink &point : model.end_effectors) {
+      problem.goals.emplace_back(point, point.predict(fk, k));
+    }
+  }
+  return problems;
+}
+
+bool Satisfied(const ContactGoals &goals, const Values &values,
+               double tolerance) {
+  for (const ContactGoal &goal : goals) {
+    if (!goal.satisfied(values, k, tolerance)) return false;
+  }
+  return true;
+}
+
+// Solve one problem, returning whether it was solved.
+using Solver = std::function<bool(const Problem &)>;
+
+// Solve all problems at once, returning which were solved.
+using BatchSolver = std::function<vector<bool>(const vector<Problem> &)>;
+
+Solver KinematicsSolver(const Model &model,
+                        OptimizationParameters::Method method,
+                        double tolerance) {
+  KinematicsParameters parameters;
+  parameters.method = method;
+  auto kinematics = std::make_shared<const Kinematics>(parameters);
+  return [=](const Problem &problem) -> bool {
+    if (!model.pinned) {
+      return Satisfied(problem.goals,
+                       kinematics->inverse(Slice(k), model.robot,
+                                           problem.goals),
+                       tolerance);
+    }
+    const Slice slice(k);
+    auto constraints = kinematics->constraints(slice, model.robot);
+    constraints.add(kinematics->pointGoalConstraints(slice, problem.goals));
+    auto graph = kinematics->jointAngleObjectives(slice, model.robot);
+    graph.addPrior(PoseKey(model.robot.link(model.base)->id(), k),
+                   BasePose(model), InternedIsotropic(6, 1e-4));
+    const Values result = kinematics->optimize(
+        graph, constraints, kinematics->initialValues(slice, model.robot));
+    return Satisfied(problem.goals, result, tolerance);
+  };
+}
+
+Solver ChainSolver(const Model &model, double tolerance) {
+  auto ik = std::make_shared<const ChainInverseKinematics>(model.robot,
+                                                           model.base);
+  for (const PointOnLink &point : model.end_effectors) {
+    bool on_foot = false;
+    for (const LegChain &leg : ik->legs()) on_foot |= leg.foot == point.link;
+    if (!on_foot) {
+      throw std::invalid_argument(point.link->name() + " is not a foot.");
+    }
+  }
+  const Pose3 wTbase = BasePose(model);
+  return [=](const Problem &problem) -> bool {
+    bool converged = false;
+    const Values result =
+        ik->inverse(Slice(k), problem.goals, wTbase, Values(), &converged);
+    return converged && Satisfied(problem.goals, result, tolerance);
+  };
+}
+
+// The analytic solver reaches the end-effector pose at the drawn angles.
+Solver AnalyticSolver(const Model &model, double tolerance) {
+  AnalyticIKPtr ik = AnalyticIKRegistry::Create(model.name, model.robot);
+  const vector<string> names = ik->jointNames();
+  return [=](const Problem &problem) -> bool {
+    gtsam::Vector q(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+      q(i) = JointAngle(problem.angles, model.robot.joint(names[i])->id(), k);
+    }
+    const Pose3 bTe = ik->computeForward(q);
+    const boost::optional<gtsam::Vector> solution =
+        ik->nearest(bTe, gtsam::Vector::Zero(names.size()));
+    return solution && gtsam::distance3(ik->computeForward(*solution)
+                                            .translation(),
+                                        bTe.translation()) < tolerance;
+  };
+}
+
+BatchSolver BatchKinematicsSolver(const Model &model, double tolerance) {
+  auto batch =
+      std::make_shared<const BatchInverseKinematics>(model.robot, Slice(k));
+  return [=](const vector<Problem> &problems) -> vector<bool> {
+    vector<ContactGoals> goals;
+    for (const Problem &problem : problems) goals.push_back(problem.goals);
+    vector<bool> solved;
+    for (auto &&result : batch->solve(goals, tolerance)) {
+      solved.push_back(result.converged);
+    }
+    return solved;
+  };
+}
+
+// Print one CSV row; times are per problem, in milliseconds.
+void Report(const string &robot, const string &solver, int threads,
+            const vector<bool> &solved, vector<double> times, double wall) {
+  const size_t n = solved.size();
+  const double success =
+      n ? double(std::count(solved.begin(), solved.end(), true)) / n : 0;
+  std::sort(times.begin(), times.end());
+  auto quantile = [&](double p) -> double {
+    if (times.empty()) return std::numeric_limits<double>::quiet_NaN();
+    return 1e3 * times[std::min(times.size() - 1,
+                                size_t(p * (times.size() - 1) + 0.5))];
+  };
+  std::cout << robot << "," << solver << "," << threads << "," << n << ","
+            << success << "," << quantile(0.5) << "," << quantile(0.9) << ","
+            << quantile(1.0) << "," << n / wall << std::endl;
+}
+
+void Run(const Model &model, const string &name, const Solver &solver,
+         const vector<Problem> &problems) {
+  const size_t n = problems.size();
+  for (int threads : threadCounts()) {
+    vector<char> solved(n);  // not vector<bool>, written concurrently
+    vector<double> times(n);
+    double wall = 0;
+    withThreads(threads, [&] {
+      const auto start = Clock::now();
+      ParallelFor(n, [&](size_t i) {
+        const auto problem_start = Clock::now();
+        bool ok = false;
+        try {
+          ok = solver(problems[i]);
+        } catch (const std::exception &) {
+          // A failed solve, e.g., an indeterminant linear system.
+        }
+        times[i] = Seconds(problem_start);
+        solved[i] = ok;
+      });
+      wall = Seconds(start);
+    });
+    Report(model.name, name, threads,
+           vector<bool>(solved.begin(), solved.end()), times, wall);
+  }
+}
+
+// Batch solvers do not time problems one by one.
+void Run(const Model &model, const string &name, const BatchSolver &solver,
+         const vector<Problem> &problems) {
+  for (int threads : threadCounts()) {
+    vector<bool> solved;
+    double wall = 0;
+    withThreads(threads, [&] {
+      const auto start = Clock::now();
+      solved = solver(problems);
+      wall = Seconds(start);
+    });
+    Report(model.name, name, threads, solved, {}, wall);
+  }
+}
+
+Model Panda() {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + string("panda/panda.urdf"));
+  return {"panda", robot, "link0", {{robot.link("link7"), Point3(0, 0, 0)}},
+          std::numeric_limits<double>::infinity(), true};
+}
+
+Model A1() {
+  const Robot robot = CreateRobotFromFile(kUrdfPath + string("a1/a1.urdf"));
+  vector<PointOnLink> feet;
+  for (const string leg : {"FR", "FL", "RR", "RL"}) {
+    feet.emplace_back(robot.link(leg + "_lower"), Point3(0, 0, -0.1));
+  }
+  return {"a1", robot, "trunk", feet, 0.4, false};
+}
+
+Model Spider() {
+  const Robot robot =
+      CreateRobotFromFile(kSdfPath + string("spider_alt.sdf"), "spider");
+  vector<PointOnLink> feet;
+  for (const string foot :
+       {"tarsus_1_L1", "tarsus_2_L2", "tarsus_3_L3", "tarsus_4_L4",
+        "tarsus_5_R4", "tarsus_6_R3", "tarsus_7_R2", "tarsus_8_R1"}) {
+    feet.emplace_back(robot.link(foot), Point3(0, 0.19, 0));
+  }
+  return {"spider", robot, "body", feet, 0.3, false};
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  const size_t num_problems = argc > 1 ? std::stoul(argv[1]) : 50;
+  const uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 42;
+  const double tolerance = argc > 3 ? std::stod(argv[3]) : 1e-3;
+  const vector<std::pair<string, OptimizationParameters::Method>> methods = {
+      {"soft", OptimizationParameters::SOFT_CONSTRAINTS},
+      {"penalty", OptimizationParameters::PENALTY},
+      {"augmented_lagrangian", OptimizationParameters::AUGMENTED_LAGRANGIAN},
+      {"sqp", OptimizationParameters::SQP}};
+
+  std::cout << "robot,solver,threads,problems,success_rate,median_ms,p90_ms,"
+               "max_ms,problems_per_second"
+            << std::endl;
+  for (const Model &model : {Panda(), A1(), Spider()}) {
+    const vector<Problem> problems =
+        RandomProblems(model, num_problems, seed);
+    for (auto &&method : methods) {
+      Run(model, method.first,
+          KinematicsSolver(model, method.second, tolerance), problems);
+    }
+    try {
+      Run(model, "chain_dls", ChainSolver(model, tolerance), problems);
+    } catch (const std::invalid_argument &e) {
+      std::cerr << model.name << ": skipping chain_dls, " << e.what()
+                << std::endl;
+    }
+    if (!model.pinned) {
+      Run(model, "batch", BatchKinematicsSolver(model, tolerance), problems);
+    }
+    if (AnalyticIKRegistry::Has(model.name)) {
+      Run(model, "analytic", AnalyticSolver(model, tolerance), problems);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Scaling of parallel linearization with the horizon and the number
+ * of threads, against gtsam's serial linearization.
+ *
+ * Usage: <benchmark> [repeats]. Each time is the fastest of `repeats` runs.
+ * Without TBB only one thread is timed.
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/ParallelLinearize.h>
+#include <gtsam/config.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using namespace gtdynamics;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Fastest of `repeats` runs of f, in seconds.
+double fastest(size_t repeats, const std::function<void()> &f) {
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t r = 0; r < repeats; r++) {
+    const auto start = Clock::now();
+    f();
+    best = std::min(
+        best, std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  return best;
+}
+
+// Thread counts to time: powers of two up to the hardware concurrency.
+vector<int> threadCounts() {
+#ifdef GTSAM_USE_TBB
+  const int max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  vector<int> counts;
+  for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+  counts.push_back(max_threads);
+  return counts;
+#else
+  return {1};
+#endif
+}
+
+// Run f with at most n threads.
+void withThreads(int n, const std::function<void()> &f) {
+#ifdef GTSAM_USE_TBB
+  tbb::task_arena arena(n);
+  arena.execute(f);
+#else
+  (void)n;
+  f();
+#endif
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  const size_t repeats = argc > 1 ? std::stoul(argv[1]) : 5;
+  const vector<std::pair<string, std::function<Robot()>>> models = {
+      {"a1",
+       [] { return CreateRobotFromFile(kUrdfPath + string("a1/a1.urdf")); }},
+      {"spider", [] {
+         return CreateRobotFromFile(kSdfPath + string("spider_alt.sdf"),
+                                    "spider");
+       }}};
+  const vector<int> horizons = {50, 200, 1000};
+  const double dt = 1. / 240;
+
+  std::cout << "robot,horizon,factors,threads,serial_seconds,"
+               "parallel_seconds,speedup"
+            << std::endl;
+  for (auto &&model : models) {
+    const Robot robot = model.second();
+    const DynamicsGraph graph_builder(OptimizerSetting(1e-5),
+                                      gtsam::Vector3(0, 0, -9.8));
+    for (int num_steps : horizons) {
+      const gtsam::NonlinearFactorGraph graph =
+          graph_builder.multiPhaseTrajectoryFG(robot, {num_steps}, {},
+                                               CollocationScheme::Trapezoidal);
+      Initializer initializer;
+      const gtsam::Values values = initializer.MultiPhaseZeroValuesTrajectory(
+          robot, {num_steps}, {}, dt, 0.1);
+
+      const double serial =
+          fastest(repeats, [&] { graph.linearize(values); });
+      for (int threads : threadCounts()) {
+        double parallel = 0;
+        withThreads(threads, [&] {
+          parallel =
+              fastest(repeats, [&] { ParallelLinearize(graph, values); });
+        });
+        std::cout << model.first << "," << num_steps << "," << graph.size()
+                  << "," << threads << "," << serial << "," << parallel << ","
+                  << serial / parallel << std::endl;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Resident walking planner: request lines in, response lines out, over
+ * TCP. Robots are loaded once, and later requests for the same robot and gait
+ * reuse its cached graph slices and warm start from earlier plans. Try
+ *   echo "id=1 robot=sdfs/spider_alt.sdf name=spider phase=1:tarsus_1_L1,\
+ * tarsus_2_L2,tarsus_3_L3,tarsus_4_L4,tarsus_5_R4,tarsus_6_R3,tarsus_7_R2,\
+ * tarsus_8_R1 contact=0,0.19,0 step=0,0.4,0" | nc localhost 5555
+ * with the phase on one line. Responses are sent as plans finish, so they
+ * may come out of order; the id is echoed to match them.
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/PlanningServer.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace gtdynamics;
+
+// A client connection, closed when the last pending reply is sent.
+class Connection {
+ private:
+  int fd_;
+  std::mutex mutex_;  // serializes replies
+
+ public:
+  explicit Connection(int fd) : fd_(fd) {}
+  ~Connection() { close(fd_); }
+
+  int fd() const { return fd_; }
+
+  // Send a line, ignoring clients that went away.
+  void send(const std::string &line) {
+    const std::string data = line + "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t sent = 0;
+    while (sent < data.size()) {
+      const ssize_t n =
+          ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) return;
+      sent += n;
+    }
+  }
+};
+
+// Read request lines from a client and queue them on the server.
+void serve(PlanningServer *server,
+           const std::shared_ptr<Connection> &connection) {
+  std::string buffer;
+  char chunk[4096];
+  ssize_t n;
+  while ((n = recv(connection->fd(), chunk, sizeof(chunk), 0)) > 0) {
+    buffer.append(chunk, n);
+    size_t end;
+    while ((end = buffer.find('\n')) != std::string::npos) {
+      const std::string line = buffer.substr(0, end);
+      buffer.erase(0, end + 1);
+      if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+      server->submit(line, [connection](const std::string &response) {
+        connection->send(response);
+      });
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  const int port = argc > 1 ? std::atoi(argv[1]) : 5555;
+
+  PlanningServerParams params;
+  params.model_directory = std::string(kSdfPath) + "../";
+  params.num_threads = argc > 2 ? std::atoi(argv[2]) : 0;
+  PlanningServer server(params);
+
+  const int listener = socket(AF_INET, SOCK_STREAM, 0);
+  const int yes = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      listen(listener, 16) < 0) {
+    std::cerr << "Cannot listen on port " << port << std::endl;
+    return 1;
+  }
+  std::cout << "Planning server on port " << port << ", models in "
+            << params.model_directory << std::endl;
+
+  while (true) {
+    const int fd = accept(listener, nullptr, nullptr);
+    if (fd < 0) continue;
+    std::thread(serve, &server, std::make_shared<Connection>(fd)).detach();
+  }
+}
@@ -11,23 +11,13 @@
  * @author Alejandro Escontrela
  */
 
-#include <gtdynamics/dynamics/DynamicsGraph.h>
-#include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/kinematics/KinematicMotionPlanner.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/sdf.h>
-#include <gtdynamics/utils/values.h>
-#include <gtsam/base/Vector.h>
-#include <gtsam/geometry/Pose3.h>
-#include <gtsam/nonlinear/GaussNewtonOptimizer.h>
-#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
-#include <gtsam/nonlinear/NonlinearFactorGraph.h>
-#include <gtsam/nonlinear/Values.h>
-#include <gtsam/slam/PriorFactor.h>
+#include <gtdynamics/utils/TrajectoryState.h>
 
-#include <cmath>
 #include <fstream>
 #include <iostream>
-#include <map>
 #include <string>
 #include <vector>
 
@@ -37,221 +27,9 @@ using std::endl;
 using gtsam::Point3;
 using gtsam::Pose3;
 using gtsam::Rot3;
-using gtsam::Vector3;
-
-using CoeffMatrix = gtsam::Matrix43;
-using TargetFootholds = std::map<int, std::map<std::string, Pose3>>;
-using TargetPoses = std::map<std::string, Pose3>;
 
 using namespace gtdynamics;
 
-#define GROUND_HEIGHT -0.2
-
-/**
- * Compute cubic polynomial coefficients via Hermite parameterization.
- *
- * @param wTb_i initial pose corresponding to the knot at the start
- * @param wTb_f final pose corresponding to the knot at the end
- * @param x_0_p tangent at the starting knot
- * @param x_1_p tangent at the ending knot
- * @param horizon timestep between the knot at the start and the knot at the end
- *
- * @return 4*3 matrix of coefficients.
- *
- * Since u ∈ [0,1] in the parametrization of the hermite spline equation, for
- * t ∈ [0,horizon], u is set equal to `t/horizon`.
- *
- * Refer to this lecture for more info on the hermite parameterization
- * for cubic polynomials:
- * http://www.cs.cmu.edu/afs/cs/academic/class/15462-s10/www/lec-slides/lec06.pdf
- */
-CoeffMatrix compute_spline_coefficients(const Pose3 &wTb_i, const Pose3 &wTb_f,
-                                        const Vector3 &x_0_p,
-                                        const Vector3 &x_1_p,
-                                        const double horizon) {
-  // Extract position at the starting and ending knot.
-  Vector3 x_0 = wTb_i.translation();
-  Vector3 x_1 = wTb_f.translation();
-
-  // Hermite parameterization: p(u)=U(u)*B*C where vector U(u) includes the
-  // polynomial terms, and B and C are the basis matrix and control matrices
-  // respectively.
-  gtsam::Matrix43 C;
-  C.row(0) = x_0;
-  C.row(1) = x_1;
-  C.row(2) = x_0_p;
-  C.row(3) = x_1_p;
-
-  gtsam::Matrix4 B;
-  B << 2, -2, 1, 1, -3, 3, -2, -1, 0, 0, 1, 0, 1, 0, 0, 0;
-  gtsam::Matrix43 A = B * C;
-
-  // Scale U by the horizon `t = u/horizon` so that we can directly use t.
-  A.row(0) /= (horizon * horizon * horizon);
-  A.row(1) /= (horizon * horizon);
-  A.row(2) /= horizon;
-
-  return A;
-}
-
-/**
- * Compute the robot base pose as defined by the calculated trajectory.
- * The calculated trajectory is a piecewise polynomial consisting of
- * cubic hermite splines; the base pose will move along this trajectory.
- *
- * @param coeffs 4*3 matrix of cubic polynomial coefficients
- * @param x_0_p tangent at the starting knot
- * @param t time at which pose will be evaluated
- * @param wTb_i initial pose corresponding to the knot at the start
- *
- * @return rotation and position
- */
-Pose3 compute_hermite_pose(const CoeffMatrix &coeffs, const Vector3 &x_0_p,
-                           const double t, const Pose3 &wTb_i) {
-  // The position computed from the spline equation as a function of time,
-  // p(t)=U(t)*A where U(t)=[t^3,t^2,t,1].
-  gtsam::Matrix14 t_vec(std::pow(t, 3), std::pow(t, 2), t, 1);
-  Point3 p(t_vec * coeffs);
-
-  // Differentiate position with respect to t for velocity.
-  gtsam::Matrix14 du(3 * t * t, 2 * t, 1, 0);
-  Point3 dpdt_v3 = Point3(du * coeffs);
-
-  // Unit vector for velocity.
-  dpdt_v3 = dpdt_v3 / dpdt_v3.norm();
-  Point3 x_0_p_point(x_0_p);
-  x_0_p_point = x_0_p_point / x_0_p_point.norm();
-
-  Point3 axis = x_0_p_point.cross(dpdt_v3);
-  double angle = std::acos(x_0_p_point.dot(dpdt_v3));
-  // The rotation.
-  Rot3 R = wTb_i.rotation() * Rot3::AxisAngle(axis, angle);
-
-  return Pose3(R, p);
-}
-
-/** Compute the target footholds for each support phase. */
-TargetFootholds compute_target_footholds(
-    const CoeffMatrix &coeffs, const Vector3 &x_0_p, const Pose3 &wTb_i,
-    const double horizon, const double t_support,
-    const std::map<std::string, Pose3> &bTfs) {
-  TargetFootholds target_footholds;
-
-  double t_swing = t_support / 4.0;  // Time for each swing foot trajectory.
-  int n_support_phases = horizon / t_support;
-
-  for (int i = 0; i <= n_support_phases; i++) {
-    Pose3 wTb =
-        compute_hermite_pose(coeffs, x_0_p, i * t_support / horizon, wTb_i);
-    std::map<std::string, Pose3> target_footholds_i;
-    for (auto &&bTf : bTfs) {
-      Pose3 wTf = wTb * bTf.second;
-      // TODO(frank): #179 make sure height is handled correctly.
-      Pose3 wTf_gh(wTf.rotation(), Point3(wTf.translation()[0],
-                                          wTf.translation()[1], GROUND_HEIGHT));
-      target_footholds_i.emplace(bTf.first, wTf_gh);
-    }
-    target_footholds.emplace(i, target_footholds_i);
-  }
-  return target_footholds;
-}
-
-/** Get base pose and foot positions at any time t. */
-TargetPoses compute_target_poses(const TargetFootholds &targ_footholds,
-                                 const double horizon, const double t_support,
-                                 const double t,
-                                 const std::vector<std::string> &swing_sequence,
-                                 const CoeffMatrix &coeffs,
-                                 const Vector3 &x_0_p, const Pose3 &wTb_i) {
-  TargetPoses t_poses;
-  // Compute the body pose.
-  Pose3 wTb = compute_hermite_pose(coeffs, x_0_p, t / horizon, wTb_i);
-  t_poses.emplace("body", wTb);
-
-  const std::map<std::string, Pose3> &prev_targ_foothold =
-      targ_footholds.at(static_cast<int>(std::floor(t / t_support)));
-  const std::map<std::string, Pose3> &next_targ_foothold =
-      targ_footholds.at(static_cast<int>(std::ceil(t / t_support)));
-
-  // Time spent in current support phase.
-  double t_in_support = std::fmod(t, t_support);
-  double t_swing = t_support / 4.0;  // Duration of swing phase.
-
-  int swing_leg_idx;
-  if (t_in_support <= t_swing)
-    swing_leg_idx = 0;
-  else if (t_in_support <= (2 * t_swing))
-    swing_leg_idx = 1;
-  else if (t_in_support <= (3 * t_swing))
-    swing_leg_idx = 2;
-  else
-    swing_leg_idx = 3;
-
-  // Normalized swing duration.
-  double t_normed = (t_in_support - swing_leg_idx * t_swing) / t_swing;
-
-  // Already completed swing phase in this support phase.
-  for (int i = 0; i < swing_leg_idx; i++) {
-    std::string leg_i = swing_sequence[i];
-    t_poses.emplace(leg_i, next_targ_foothold.at(leg_i));
-  }
-
-  // Currently swinging.
-  std::string swing_leg = swing_sequence[swing_leg_idx];
-  auto prev_foot_pos = prev_targ_foothold.at(swing_leg).translation();
-  auto next_foot_pos = next_targ_foothold.at(swing_leg).translation();
-  Point3 curr_foot_pos =
-      prev_foot_pos + (next_foot_pos - prev_foot_pos) * t_normed;
-  double h = GROUND_HEIGHT +
-             0.2 * std::pow(t_normed, 1.1) * std::pow(1 - t_normed, 0.7);
-
-  t_poses.emplace(swing_leg,
-                  Pose3(Rot3(), Point3(curr_foot_pos[0], curr_foot_pos[1], h)));
-
-  // Yet to complete swing phase in this support phase.
-  for (int i = swing_leg_idx + 1; i < 4; i++) {
-    std::string leg_i = swing_sequence[i];
-    t_poses.emplace(leg_i, prev_targ_foothold.at(leg_i));
-  }
-  return t_poses;
-}
-
-struct CsvWriter {
-  std::ofstream pose_file;
-  const std::vector<std::string> &swing_sequence;
-  const Robot robot;
-
-  CsvWriter(const std::string &filename,
-            const std::vector<std::string> &swing_sequence, const Robot &robot)
-      : swing_sequence(swing_sequence), robot(robot) {
-    pose_file.open(filename);
-  }
-  ~CsvWriter() { pose_file.close(); }
-
-  void writeheader() {
-    pose_file << "bodyx,bodyy,bodyz";
-    for (auto &&leg : swing_sequence)
-      pose_file << "," << leg << "x"
-                << "," << leg << "y"
-                << "," << leg << "z";
-    for (auto &&joint : robot.joints()) pose_file << "," << joint->name();
-    pose_file << "\n";
-  }
-
-  void writerow(const TargetPoses &tposes, const gtsam::Values &results,
-                int k) {
-    auto body = tposes.at("body").translation();
-    pose_file << body[0] << "," << body[1] << "," << body[2];
-    for (auto &&leg_name : swing_sequence) {
-      auto leg = tposes.at(leg_name).translation();
-      pose_file << "," << leg[0] << "," << leg[1] << "," << leg[2];
-    }
-    for (auto &&joint : robot.joints())
-      pose_file << "," << JointAngle(results, joint->id(), k);
-    pose_file << "\n";
-  }
-};
-
 int main(int argc, char **argv) {
   // Load the vision 60 quadruped by Ghost robotics:
   // https://youtu.be/wrBNJKZKg10
@@ -270,19 +48,9 @@ int main(int argc, char **argv) {
   robot.print();
   cout << "-------------" << endl;
 
-  // Compute coefficients for cubic spline from current robot position
-  // to final position using hermite parameterization.
-  Pose3 wTb_i = robot.link("body")->bMcom();
-  Pose3 wTb_f = Pose3(Rot3(), Point3(3, 0, 0.1));
-  Point3 x_0_p(1, 0, 0);
-  Point3 x_0_p_traj(1, 0, 0.4);
-  Point3 x_1_p_traj(1, 0, 0);
-  auto coeffs =
-      compute_spline_coefficients(wTb_i, wTb_f, x_0_p_traj, x_1_p_traj, 1);
-
-  // Time horizon.
-  double horizon = 72;
-
+  // The base follows a cubic spline from its current pose to the final pose,
+  // with the Hermite tangents of the defaults, over a 72 s horizon.
+  //
   //                       Gait pattern
   //               (Shaded indicates swing phase)
   //               ------------------------------
@@ -292,86 +60,40 @@ int main(int argc, char **argv) {
   //            LF |                     #######| left forward
   //               ------------------------------
   //             t = 0   normalized time (t)  t = 1
-  std::vector<std::string> swing_sequence{"lower0", "lower1", "lower2",
-                                          "lower3"};
-  double t_support = 8;  // Duration of a support phase.
-
-  // Offsets from base to foot.
-  std::map<std::string, Pose3> bTfs;
-  Pose3 comTfoot =
-      Pose3(Rot3(), Point3(0.14, 0, 0));  // Foot is 14cm along X in COM
-  for (auto &&leg : swing_sequence) {
-    const Pose3 bTfoot = robot.link(leg)->bMcom() * comTfoot;
-    bTfs.emplace(leg, bTfoot);
-  }
+  KinematicMotionPlannerParams params;
+  params.feet = {"lower0", "lower1", "lower2", "lower3"};
+  params.wTb_f = Pose3(Rot3(), Point3(3, 0, 0.1));
+  params.horizon = 72;
+  params.t_support = 8;  // Duration of a support phase.
+  const KinematicMotionPlanner planner(robot, params);
 
-  // Calculate foothold at the end of each support phase.
-  TargetFootholds targ_footholds =
-      compute_target_footholds(coeffs, x_0_p, wTb_i, horizon, t_support, bTfs);
-
-  // Iteratively solve the inverse kinematics problem to obtain joint angles.
-  double dt = 1. / 240., curr_t = 0.0;
-  int k = 0;  // The time index.
-  auto dgb = DynamicsGraph();
-
-  // Initialize values.
-  gtsam::Values values;
-  for (auto &&link : robot.links())
-    InsertPose(&values, link->id(), link->bMcom());
-  for (auto &&joint : robot.joints())
-    InsertJointAngle(&values, joint->id(), 0.0);
+  // Solve the inverse kinematics of every step.
+  const TrajectoryState state = planner.plan();
+  cout << "Solved " << state.numSteps() << " steps." << endl;
 
   // Write body,foot poses and joint angles to csv file.
-  CsvWriter writer("traj.csv", swing_sequence, robot);
-  writer.writeheader();
-
-  // Set parameters for optimizer
-  gtsam::LevenbergMarquardtParams params;
-  params.setMaxIterations(50);
-  params.setlambdaInitial(1e5);
-
-  // params.setVerbosityLM("SUMMARY");
-
-  while (curr_t < horizon) {
-    const TargetPoses tposes =
-        compute_target_poses(targ_footholds, horizon, t_support, curr_t,
-                             swing_sequence, coeffs, x_0_p, wTb_i);
-
-    // Create factor graph of kinematics constraints.
-    gtsam::NonlinearFactorGraph kfg = dgb.qFactors(robot, k);
-
-    // Constrain the base pose using trajectory value.
-    kfg.addPrior(PoseKey(robot.link("body")->id(), k), tposes.at("body"),
-                 gtsam::noiseModel::Constrained::All(6));
-
-    // Constrain the footholds.
-    auto model3 = gtsam::noiseModel::Constrained::All(3);
-    for (auto &&leg : swing_sequence) {
-      kfg.add(PointGoalFactor(PoseKey(robot.link(leg)->id(), k), model3,
-                              comTfoot.translation(),
-                              tposes.at(leg).translation()));
+  const std::vector<Pose3> wTbs = planner.basePoses();
+  std::vector<gtsam::Matrix> feet;
+  for (size_t f = 0; f < params.feet.size(); f++) {
+    feet.push_back(planner.footPositions(f));
+  }
+  std::ofstream pose_file("traj.csv");
+  pose_file << "bodyx,bodyy,bodyz";
+  for (auto &&leg : params.feet)
+    pose_file << "," << leg << "x"
+              << "," << leg << "y"
+              << "," << leg << "z";
+  for (auto &&joint : robot.joints()) pose_file << "," << joint->name();
+  pose_file << "\n";
+  for (size_t k = 0; k < state.numSteps(); k++) {
+    const Point3 body = wTbs[k].translation();
+    pose_file << body[0] << "," << body[1] << "," << body[2];
+    for (auto &&foot : feet) {
+      pose_file << "," << foot(0, k) << "," << foot(1, k) << "," << foot(2, k);
     }
-
-    // gtsam::LevenbergMarquardtOptimizer optimizer(kfg, values, params);
-    gtsam::GaussNewtonOptimizer optimizer(kfg, values);
-    gtsam::Values results = optimizer.optimize();
-
-    if ((k % 100) == 0)
-      cout << "iter: " << k << ", err: " << kfg.error(results) << endl;
-
-    // Update the values for next iteration.
-    values.clear();
-
-    for (auto &&link : robot.links())
-      InsertPose(&values, link->id(), k + 1, Pose(results, link->id(), k));
-
     for (auto &&joint : robot.joints())
-      InsertJointAngle(&values, joint->id(), k + 1,
-                       JointAngle(results, joint->id(), k));
-
-    writer.writerow(tposes, results, k);
-    curr_t = curr_t + dt;
-    k = k + 1;
+      pose_file << "," << state.jointAngle(joint->id(), k);
+    pose_file << "\n";
   }
 
   return 0;
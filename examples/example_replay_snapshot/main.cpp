@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Replay of a solve captured with OptimizationParameters::snapshot_path,
+ * with the captured parameters and then under each solver profile. Each solve
+ * is repeated and the fastest time is reported, with the error of the graph
+ * and the constraint violation of the result.
+ *
+ * Usage: example_replay_snapshot_replay snapshot_file [repeats]
+ */
+
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SolveSnapshot.h>
+#include <gtdynamics/optimizer/SolverProfile.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using std::string;
+
+using namespace gtdynamics;
+
+// Time the fastest of repeated solves and write the result as a CSV line.
+void replay(const SolveSnapshot& snapshot, const string& name,
+            const OptimizationParameters& parameters, int repeats,
+            std::ostream& file) {
+  double seconds = std::numeric_limits<double>::infinity();
+  OptimizationStatus status;
+  for (int r = 0; r < repeats; r++) {
+    const auto start = std::chrono::steady_clock::now();
+    snapshot.solve(parameters, &status);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    seconds = std::min(seconds, elapsed.count());
+  }
+  const string line = name + "," + std::to_string(seconds) + "," +
+                      std::to_string(status.error) + "," +
+                      std::to_string(status.violation) + "," +
+                      (status.feasible ? "1" : "0");
+  std::cout << line << std::endl;
+  file << line << "\n";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " snapshot_file [repeats]"
+              << std::endl;
+    return 1;
+  }
+  const SolveSnapshot snapshot = LoadSolveSnapshot(argv[1]);
+  const int repeats = argc > 2 ? std::max(1, std::stoi(argv[2])) : 3;
+  std::cout << snapshot.graph.size() << " factors, "
+            << snapshot.constraint_factors.size() << " constraints, "
+            << snapshot.initial_values.dim() << " variables" << std::endl;
+
+  std::ofstream file("replay_snapshot.csv");
+  file << "profile,seconds,error,violation,feasible\n";
+  std::cout << "profile,seconds,error,violation,feasible\n";
+
+  replay(snapshot, "CAPTURED", snapshot.parameters, repeats, file);
+  for (SolverProfile profile : AvailableSolverProfiles()) {
+    // A captured ordering is dropped by the profile.
+    OptimizationParameters parameters = snapshot.parameters;
+    SetSolverProfile(profile, &parameters);
+    try {
+      replay(snapshot, SolverProfileName(profile), parameters, repeats, file);
+    } catch (const std::exception& e) {
+      std::cout << SolverProfileName(profile) << " failed: " << e.what()
+                << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,214 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Throughput and per-step latency of the forward dynamics and
+ * simulation paths, across robots and batch sizes.
+ *
+ * Single simulations step one robot at a time: Simulator with the linear
+ * factor graph or the articulated-body method, LinearDynamicsSolver with its
+ * cached ordering, and the allocation-free JointSpaceSimulator. Batches of
+ * independent states step through BatchSimulator and linearSolveFDBatch, on
+ * one thread and on all threads of the TBB scheduler, and on the CUDA
+ * backend of BatchSimulator when a device is available.
+ */
+
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/dynamics/LinearDynamicsSolver.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/config.h>
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+using namespace gtdynamics;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+const double kDt = 1e-3;
+
+// Steps per second, and percentiles of the latency of one call in
+// microseconds, over a loop. A call steps `batch` states.
+struct Throughput {
+  double steps_per_second, p50, p99;
+};
+
+Throughput measure(size_t num_repeats, size_t batch,
+                   const std::function<void()> &step) {
+  step();  // warm up
+  vector<double> latencies(num_repeats);
+  const auto start = Clock::now();
+  for (auto &&latency : latencies) {
+    const auto call_start = Clock::now();
+    step();
+    latency = std::chrono::duration<double, std::micro>(Clock::now() -
+                                                        call_start)
+                  .count();
+  }
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    return latencies[std::lround(p * (latencies.size() - 1))];
+  };
+  return {batch * num_repeats / seconds, percentile(0.5), percentile(0.99)};
+}
+
+// Run a batch step on `num_threads` threads, or on all if zero.
+void onThreads(size_t num_threads, const std::function<void()> &step) {
+#ifdef GTSAM_USE_TBB
+  if (num_threads > 0) {
+    tbb::task_arena arena(num_threads);
+    arena.execute(step);
+    return;
+  }
+#endif
+  step();
+}
+
+size_t maxThreads() {
+#ifdef GTSAM_USE_TBB
+  return tbb::this_task_arena::max_concurrency();
+#else
+  return 1;
+#endif
+}
+
+void print(const string &robot, const string &path, size_t threads,
+           size_t batch, const Throughput &throughput) {
+  std::cout << robot << "," << path << "," << threads << "," << batch << ","
+            << throughput.steps_per_second << "," << throughput.p50 << ","
+            << throughput.p99 << std::endl;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  const size_t num_repeats = argc > 1 ? std::stoul(argv[1]) : 1000;
+
+  const vector<std::pair<string, std::function<Robot()>>> robots = {
+      {"pendulum",
+       [] {
+         return CreateRobotFromFile(kUrdfPath +
+                                    string("inverted_pendulum.urdf"))
+             .fixLink("l1");
+       }},
+      {"a1",
+       [] { return CreateRobotFromFile(kUrdfPath + string("a1/a1.urdf")); }},
+      {"spider",
+       [] {
+         return CreateRobotFromFile(kSdfPath + string("spider_alt.sdf"),
+                                    "spider");
+       }},
+      {"atlas",
+       [] { return CreateRobotFromFile(kUrdfPath + string("atlas.urdf")); }}};
+  const vector<size_t> batch_sizes = {1, 16, 256};
+
+  std::cout << "robot,path,threads,batch,steps_per_second,p50_us,p99_us"
+            << std::endl;
+
+  for (auto &&named_robot : robots) {
+    const string &name = named_robot.first;
+    const Robot robot = named_robot.second();
+    const size_t num_joints = robot.numJoints();
+
+    // A bent configuration at rest, and small constant torques.
+    Values initial, torques;
+    Vector q(num_joints), v = Vector::Zero(num_joints), tau(num_joints);
+    for (size_t n = 0; n < num_joints; n++) {
+      const int j = robot.joints()[n]->id();
+      q(n) = 0.1 * std::sin(n + 1.0);
+      tau(n) = 0.01 * std::cos(n + 1.0);
+      InsertJointAngle(&initial, j, q(n));
+      InsertJointVel(&initial, j, 0.0);
+      InsertTorque(&torques, j, tau(n));
+    }
+
+    // Single simulations.
+    for (auto &&method : {LinearFactorGraph, ArticulatedBody}) {
+      Simulator simulator(robot, initial, kGravity, boost::none, method);
+      print(name,
+            method == LinearFactorGraph ? "Simulator/LinearFactorGraph"
+                                        : "Simulator/ArticulatedBody",
+            1, 1, measure(num_repeats, 1, [&] {
+              simulator.step(torques, kDt);
+            }));
+    }
+
+    Values known_values = robot.forwardKinematics(initial);
+    known_values.insert(torques);
+    LinearDynamicsSolver linear_solver(robot, kGravity);
+    print(name, "LinearDynamicsSolver", 1, 1,
+          measure(num_repeats, 1,
+                  [&] { linear_solver.solveFD(0, known_values); }));
+
+    JointSpaceSimulator joint_space_simulator(robot, initial, num_repeats + 1,
+                                              kGravity);
+    print(name, "JointSpaceSimulator", 1, 1, measure(num_repeats, 1, [&] {
+            joint_space_simulator.step(tau, kDt);
+          }));
+
+    // Batches, on one thread and on all of them.
+    DynamicsGraph graph_builder(kGravity);
+    const BatchSimulator batch_simulator(robot, kGravity);
+    std::unique_ptr<BatchSimulator> cuda_simulator;
+    if (CudaBatchBackend::Available()) {
+      cuda_simulator.reset(new BatchSimulator(robot, kGravity, boost::none,
+                                              ExplicitEuler, 1e-6,
+                                              CudaBackend));
+    }
+    for (size_t batch : batch_sizes) {
+      const Matrix qs = q.replicate(1, batch), vs = v.replicate(1, batch),
+                   taus = tau.replicate(1, batch);
+      const vector<Matrix> torque_sequences(batch, tau);
+      for (size_t threads : {size_t(1), size_t(0)}) {
+        const size_t num_threads = threads ? threads : maxThreads();
+        print(name, "BatchSimulator", num_threads, batch,
+              measure(num_repeats, batch, [&] {
+                onThreads(threads, [&] {
+                  batch_simulator.simulate(qs, vs, torque_sequences, kDt);
+                });
+              }));
+        print(name, "linearSolveFDBatch", num_threads, batch,
+              measure(num_repeats, batch, [&] {
+                onThreads(threads, [&] {
+                  graph_builder.linearSolveFDBatch(robot, qs, vs, taus);
+                });
+              }));
+      }
+      if (cuda_simulator) {
+        print(name, "BatchSimulator/CUDA", 1, batch,
+              measure(num_repeats, batch, [&] {
+                cuda_simulator->simulate(qs, vs, torque_sequences, kDt);
+              }));
+      }
+    }
+  }
+  return 0;
+}
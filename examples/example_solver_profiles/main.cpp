@@ -0,0 +1,201 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Benchmark of solver profiles on the spider and A1 walking problems.
+ * The fill is the number of entries of the Bayes net of one elimination at
+ * the initial values, with the ordering of the profile.
+ */
+
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SolverProfile.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::noiseModel::Isotropic;
+using gtsam::noiseModel::Unit;
+
+using namespace gtdynamics;
+
+// Number of entries of the R and S blocks of a Bayes net.
+size_t bayesNetEntries(const gtsam::GaussianBayesNet& bayes_net) {
+  size_t result = 0;
+  for (const auto& conditional : bayes_net) {
+    const size_t n = conditional->get_R().rows();
+    result += n * (n + 1) / 2 + conditional->get_S().size();
+  }
+  return result;
+}
+
+// A walking trajectory optimization problem.
+struct Problem {
+  string name;
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values initial;
+};
+
+// Build a walking problem as in the spider and A1 walking examples.
+Problem walkingProblem(const string& name, const Robot& robot,
+                       const Trajectory& trajectory, const string& base_name,
+                       const Point3& step, double base_height,
+                       double sigma_dynamics, double sigma_objectives) {
+  auto dynamics_model_6 = Isotropic::Sigma(6, sigma_dynamics),
+       objectives_model_6 = Isotropic::Sigma(6, sigma_objectives),
+       objectives_model_1 = Isotropic::Sigma(1, sigma_objectives);
+
+  OptimizerSetting opt(sigma_dynamics);
+  DynamicsGraph graph_builder(opt, gtsam::Vector3(0, 0, -9.8));
+
+  Problem problem;
+  problem.name = name;
+  problem.graph = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Euler, 1.0);
+
+  gtsam::NonlinearFactorGraph objectives = trajectory.contactPointObjectives(
+      robot, Isotropic::Sigma(3, 1e-7), step, 1.0);
+  const int K = trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+  auto base_link = robot.link(base_name);
+  for (int k = 0; k <= K; k++) {
+    objectives.add(LinkObjectives(base_link->id(), k)
+                       .pose(Pose3(Rot3(), Point3(0, 0, base_height)),
+                             Isotropic::Sigma(6, 5e-5))
+                       .twist(gtsam::Z_6x1, Isotropic::Sigma(6, 5e-5)));
+  }
+  trajectory.addBoundaryConditions(&objectives, robot, dynamics_model_6,
+                                   dynamics_model_6, objectives_model_6,
+                                   objectives_model_1, objectives_model_1);
+  const double desired_dt = 1. / 240;
+  trajectory.addIntegrationTimeFactors(&objectives, desired_dt, 1e-30);
+  trajectory.addMinimumTorqueFactors(&objectives, robot, Unit::Create(1));
+  problem.graph.add(objectives);
+
+  Initializer initializer;
+  problem.initial = trajectory.multiPhaseInitialValues(robot, initializer,
+                                                       1e-5, desired_dt);
+  return problem;
+}
+
+// Spider walk, as in example_spider_walking.
+Problem spiderProblem() {
+  auto robot =
+      CreateRobotFromFile(kSdfPath + string("spider_alt.sdf"), "spider");
+  const vector<LinkSharedPtr> odd_links = {
+      robot.link("tarsus_1_L1"), robot.link("tarsus_3_L3"),
+      robot.link("tarsus_5_R4"), robot.link("tarsus_7_R2")};
+  const vector<LinkSharedPtr> even_links = {
+      robot.link("tarsus_2_L2"), robot.link("tarsus_4_L4"),
+      robot.link("tarsus_6_R3"), robot.link("tarsus_8_R1")};
+  auto links = odd_links;
+  links.insert(links.end(), even_links.begin(), even_links.end());
+
+  const Point3 contact_in_com(0, 0.19, 0);
+  auto stationary =
+      boost::make_shared<FootContactConstraintSpec>(links, contact_in_com);
+  auto odd =
+      boost::make_shared<FootContactConstraintSpec>(odd_links, contact_in_com);
+  auto even =
+      boost::make_shared<FootContactConstraintSpec>(even_links, contact_in_com);
+  WalkCycle walk_cycle({stationary, even, stationary, odd}, {1, 2, 1, 2});
+
+  return walkingProblem("spider", robot, Trajectory(walk_cycle, 1), "body",
+                        Point3(0, 0.4, 0), 0.5, 1e-5, 1e-6);
+}
+
+// A1 walk, as in example_a1_walking.
+Problem a1Problem() {
+  auto robot = CreateRobotFromFile(kUrdfPath + string("a1/a1.urdf"), "a1");
+  const vector<LinkSharedPtr> rlfr = {robot.link("RL_lower"),
+                                      robot.link("FR_lower")};
+  const vector<LinkSharedPtr> rrfl = {robot.link("RR_lower"),
+                                      robot.link("FL_lower")};
+  auto all_feet = rlfr;
+  all_feet.insert(all_feet.end(), rrfl.begin(), rrfl.end());
+
+  const Point3 contact_in_com(0, 0, -0.07);
+  auto stationary =
+      boost::make_shared<FootContactConstraintSpec>(all_feet, contact_in_com);
+  auto RLFR =
+      boost::make_shared<FootContactConstraintSpec>(rlfr, contact_in_com);
+  auto RRFL =
+      boost::make_shared<FootContactConstraintSpec>(rrfl, contact_in_com);
+  WalkCycle walk_cycle({stationary, RRFL, stationary, RLFR}, {1, 5, 1, 5});
+
+  return walkingProblem("a1", robot, Trajectory(walk_cycle, 1), "trunk",
+                        Point3(0.5, 0, 0), 0.4, 1e-6, 1e-7);
+}
+
+int main(int argc, char** argv) {
+  // Optional argument: maximum number of LM iterations per solve.
+  const int max_iterations = argc > 1 ? std::stoi(argv[1]) : 100;
+
+  std::ofstream file("solver_profiles.csv");
+  file << "model,profile,seconds,iterations,error,fill\n";
+  std::cout << "model,profile,seconds,iterations,error,fill\n";
+
+  for (const Problem& problem : {spiderProblem(), a1Problem()}) {
+    for (SolverProfile profile : AvailableSolverProfiles()) {
+      OptimizationParameters parameters;
+      parameters.lm_parameters.setlambdaInitial(1e10);
+      parameters.lm_parameters.setlambdaLowerBound(1e-7);
+      parameters.lm_parameters.setlambdaUpperBound(1e10);
+      parameters.lm_parameters.setAbsoluteErrorTol(1.0);
+      parameters.lm_parameters.setMaxIterations(max_iterations);
+      SetSolverProfile(profile, &parameters);
+
+      // The ordering is part of the profile, so it is timed too.
+      const auto start = std::chrono::steady_clock::now();
+      gtsam::LevenbergMarquardtParams params = parameters.lm_parameters;
+      if (parameters.dynamics_ordering) {
+        params.setOrdering(DynamicsOrdering(problem.graph));
+      } else if (parameters.nested_ordering) {
+        params.setOrdering(NestedTimeOrdering(problem.graph));
+      } else if (parameters.time_ordering) {
+        params.setOrdering(TimeOrdering(problem.graph));
+      }
+      gtsam::LevenbergMarquardtOptimizer optimizer(problem.graph,
+                                                   problem.initial, params);
+      optimizer.optimize();
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+
+      const auto linear = problem.graph.linearize(problem.initial);
+      const gtsam::Ordering ordering =
+          params.ordering ? *params.ordering
+                          : gtsam::Ordering::Create(params.orderingType,
+                                                    *linear);
+      const size_t fill =
+          bayesNetEntries(*linear->eliminateSequential(ordering));
+
+      const string line = problem.name + "," + SolverProfileName(profile) +
+                          "," + std::to_string(elapsed.count()) + "," +
+                          std::to_string(optimizer.iterations()) + "," +
+                          std::to_string(optimizer.error()) + "," +
+                          std::to_string(fill);
+      std::cout << line << std::endl;
+      file << line << "\n";
+    }
+  }
+  return 0;
+}
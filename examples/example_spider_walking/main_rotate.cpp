@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <boost/algorithm/string/join.hpp>
 #include <boost/optional.hpp>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <utility>
@@ -190,8 +191,13 @@ int main(int argc, char** argv) {
 
   // Construct the multi-phase trajectory factor graph.
   std::cout << "Creating dynamics graph" << std::endl;
+  auto construction_start = std::chrono::steady_clock::now();
   auto graph = graph_builder.multiPhaseTrajectoryFG(
       robot, phase_steps, transition_graphs, collocation, phase_cps, mu);
+  std::chrono::duration<double> construction_time =
+      std::chrono::steady_clock::now() - construction_start;
+  std::cout << "Graph construction time: " << construction_time.count()
+            << " s" << std::endl;
 
   // Build the objective factors.
   gtsam::NonlinearFactorGraph objective_factors;
@@ -351,7 +357,12 @@ int main(int argc, char** argv) {
   params.setlambdaLowerBound(1e-7);
   params.setlambdaUpperBound(1e10);
   gtsam::LevenbergMarquardtOptimizer optimizer(graph, init_vals, params);
+  auto optimization_start = std::chrono::steady_clock::now();
   auto results = optimizer.optimize();
+  std::chrono::duration<double> optimization_time =
+      std::chrono::steady_clock::now() - optimization_start;
+  std::cout << "Optimization time: " << optimization_time.count() << " s"
+            << std::endl;
 
   vector<string> joint_names;
   for (auto&& joint : robot.joints()) joint_names.push_back(joint->name());
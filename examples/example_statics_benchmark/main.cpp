@@ -0,0 +1,227 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Solve times and throughput of the statics solvers on the Panda and
+ * on the A1 hanging from its trunk, and linearization times of the static
+ * wrench factors.
+ *
+ * Usage: <benchmark> [samples] [seed]. Joint angles of each sample are drawn
+ * within the joint limits from RandomStream(seed, sample), and poses are
+ * obtained by forward kinematics.
+ *
+ * Solvers: Statics::solve (nonlinear optimization), LinearStaticsSolver::solve
+ * (one linear solve per sample, timed one by one) and
+ * LinearStaticsSolver::solveBatch (all samples at once). Every solver runs
+ * the whole sample set with each thread count; without TBB only one thread
+ * is timed. A second table compares the linearization of StaticWrenchFactor
+ * and FixedStaticWrenchFactor for one to four wrenches.
+ */
+
+#include <gtdynamics/statics/LinearStaticsSolver.h>
+#include <gtdynamics/statics/StaticWrenchFactor.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/RandomStream.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/config.h>
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using gtsam::Values;
+using std::string;
+using std::vector;
+
+using namespace gtdynamics;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+constexpr size_t k = 0;
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+double Seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Thread counts to time: powers of two up to the hardware concurrency.
+vector<int> threadCounts() {
+#ifdef GTSAM_USE_TBB
+  const int max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  vector<int> counts;
+  for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+  counts.push_back(max_threads);
+  return counts;
+#else
+  return {1};
+#endif
+}
+
+// Run f with at most n threads.
+void withThreads(int n, const std::function<void()> &f) {
+#ifdef GTSAM_USE_TBB
+  tbb::task_arena arena(n);
+  arena.execute(f);
+#else
+  (void)n;
+  f();
+#endif
+}
+
+// A fixed base robot and its random joint configurations.
+struct Model {
+  string name;
+  Robot robot;
+  gtsam::Matrix qs;        // num_joints x num_samples
+  vector<Values> samples;  // poses and joint angles of each column of qs
+};
+
+Model RandomSamples(const string &name, const Robot &robot, size_t n,
+                    uint64_t seed) {
+  Model model{name, robot, gtsam::Matrix(robot.numJoints(), n), {}};
+  model.samples.resize(n);
+  for (size_t s = 0; s < n; s++) {
+    RandomStream stream(seed, s);
+    Values angles;
+    size_t j = 0;
+    for (auto &&joint : robot.joints()) {
+      const auto &limits = joint->parameters().scalar_limits;
+      const double lo = limits.value_lower_limit,
+                   hi = limits.value_upper_limit;
+      model.qs(j++, s) = lo + (hi - lo) * stream.uniform();
+      InsertJointAngle(&angles, joint->id(), k, model.qs(j - 1, s));
+    }
+    model.samples[s] = robot.forwardKinematics(angles, k);
+  }
+  return model;
+}
+
+// Print one CSV row; times are per sample, in milliseconds.
+void Report(const string &robot, const string &solver, int threads, size_t n,
+            vector<double> times, double wall) {
+  std::sort(times.begin(), times.end());
+  auto quantile = [&](double p) -> double {
+    if (times.empty()) return std::numeric_limits<double>::quiet_NaN();
+    return 1e3 * times[std::min(times.size() - 1,
+                                size_t(p * (times.size() - 1) + 0.5))];
+  };
+  std::cout << robot << "," << solver << "," << threads << "," << n << ","
+            << quantile(0.5) << "," << quantile(0.9) << "," << n / wall
+            << std::endl;
+}
+
+// Time a solver of one sample, sample by sample.
+void Run(const Model &model, const string &name,
+         const std::function<void(const Values &)> &solve) {
+  const size_t n = model.samples.size();
+  for (int threads : threadCounts()) {
+    vector<double> times(n);
+    double wall = 0;
+    withThreads(threads, [&] {
+      const auto start = Clock::now();
+      ParallelFor(n, [&](size_t s) {
+        const auto sample_start = Clock::now();
+        solve(model.samples[s]);
+        times[s] = Seconds(sample_start);
+      });
+      wall = Seconds(start);
+    });
+    Report(model.name, name, threads, n, times, wall);
+  }
+}
+
+// Time the batched solver, which does not time samples one by one.
+void RunBatch(const Model &model, const LinearStaticsSolver &solver) {
+  for (int threads : threadCounts()) {
+    double wall = 0;
+    withThreads(threads, [&] {
+      const auto start = Clock::now();
+      solver.solveBatch(model.qs);
+      wall = Seconds(start);
+    });
+    Report(model.name, "batch", threads, model.qs.cols(), {}, wall);
+  }
+}
+
+// Linearizations per second of a static wrench factor.
+double Throughput(const gtsam::NonlinearFactor &factor, const Values &values,
+                  size_t repetitions) {
+  const auto start = Clock::now();
+  for (size_t r = 0; r < repetitions; r++) factor.linearize(values);
+  return repetitions / Seconds(start);
+}
+
+// Compare the generic and fixed-arity factors on one to four wrenches.
+void RunFactors(size_t repetitions) {
+  std::cout << "wrenches,generic_per_second,fixed_per_second" << std::endl;
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(6, 1e-4);
+  const int id = 0;
+  for (size_t n = 1; n <= 4; n++) {
+    vector<DynamicsSymbol> keys;
+    Values values;
+    for (size_t j = 0; j < n; j++) {
+      keys.push_back(WrenchKey(id, j, k));
+      InsertWrench(&values, id, j, k, gtsam::Vector6::Ones());
+    }
+    InsertPose(&values, id, k, gtsam::Pose3());
+    const StaticWrenchFactor generic(keys, PoseKey(id, k), model, 1.0,
+                                     kGravity);
+    const auto fixed =
+        CreateStaticWrenchFactor(keys, PoseKey(id, k), model, 1.0, kGravity);
+    std::cout << n << "," << Throughput(generic, values, repetitions) << ","
+              << Throughput(*fixed, values, repetitions) << std::endl;
+  }
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  const size_t num_samples = argc > 1 ? std::stoul(argv[1]) : 200;
+  const uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 42;
+
+  const Robot panda =
+      CreateRobotFromFile(kUrdfPath + string("panda/panda.urdf"))
+          .fixLink("link0");
+  const Robot a1 =
+      CreateRobotFromFile(kUrdfPath + string("a1/a1.urdf")).fixLink("trunk");
+
+  const StaticsParameters parameters(1e-5, kGravity);
+  const Statics statics(parameters);
+  const Slice slice(k);
+
+  std::cout << "robot,solver,threads,samples,median_ms,p90_ms,"
+               "samples_per_second"
+            << std::endl;
+  for (const Model &model : {RandomSamples("panda", panda, num_samples, seed),
+                             RandomSamples("a1", a1, num_samples, seed)}) {
+    Run(model, "nonlinear", [&](const Values &configuration) {
+      statics.solve(slice, model.robot, configuration);
+    });
+    const LinearStaticsSolver solver(model.robot, slice, parameters);
+    Run(model, "linear", [&](const Values &configuration) {
+      solver.solve(configuration);
+    });
+    RunBatch(model, solver);
+  }
+
+  std::cout << std::endl;
+  RunFactors(100000);
+  return 0;
+}
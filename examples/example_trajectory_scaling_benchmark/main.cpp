@@ -0,0 +1,234 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Scaling of trajectory optimization with the horizon and the number
+ * of joints, for every optimization method.
+ *
+ * Usage: <benchmark> [max_iterations [robot horizon method]]. Without a
+ * configuration all are run in turn; since the peak resident set size only
+ * grows, run one configuration per process to measure its memory alone.
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SolverTelemetry.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <sys/resource.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using gtsam::noiseModel::Isotropic;
+using gtsam::noiseModel::Unit;
+
+using namespace gtdynamics;
+
+using Method = OptimizationParameters::Method;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Seconds since start.
+double secondsSince(const Clock::time_point &start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Peak resident set size of the process, in kB on Linux.
+long peakRss() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+string methodName(Method method) {
+  switch (method) {
+    case Method::SOFT_CONSTRAINTS:
+      return "SOFT_CONSTRAINTS";
+    case Method::PENALTY:
+      return "PENALTY";
+    case Method::AUGMENTED_LAGRANGIAN:
+      return "AUGMENTED_LAGRANGIAN";
+    case Method::SQP:
+      return "SQP";
+  }
+  return "";
+}
+}  // namespace
+
+// A robot, and the link whose initial pose and twist are fixed.
+struct Model {
+  string name;
+  std::function<Robot()> load;
+  string base_name;
+};
+
+// A trajectory optimization problem.
+struct Problem {
+  gtsam::NonlinearFactorGraph graph;
+  EqualityConstraints constraints;
+  gtsam::Values initial;
+  double build_seconds = 0;
+};
+
+// Start at rest in the zero configuration, with a fixed time step and the
+// least torque. Floating bases have no contacts and fall. The initial joint
+// state is a hard constraint of the constrained methods, and a cost of the
+// soft constraints method.
+Problem buildProblem(const Robot &robot, const string &base_name,
+                     int num_steps) {
+  const double dt = 1. / 240, sigma = 1e-5;
+  Problem problem;
+
+  const auto start = Clock::now();
+  OptimizerSetting opt(sigma);
+  DynamicsGraph graph_builder(opt, gtsam::Vector3(0, 0, -9.8));
+  problem.graph = graph_builder.multiPhaseTrajectoryFG(
+      robot, {num_steps}, {}, CollocationScheme::Trapezoidal);
+  auto base = robot.link(base_name);
+  problem.graph.add(LinkObjectives(base->id(), 0)
+                        .pose(base->bMcom(), Isotropic::Sigma(6, sigma))
+                        .twist(gtsam::Z_6x1, Isotropic::Sigma(6, sigma)));
+  problem.graph.addPrior<double>(PhaseKey(0), dt, Isotropic::Sigma(1, sigma));
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    for (int k = 0; k <= num_steps; k++) {
+      problem.graph.emplace_shared<MinTorqueFactor>(TorqueKey(j, k),
+                                                    Unit::Create(1));
+    }
+    problem.constraints.emplace_shared<DoubleExpressionEquality>(
+        gtsam::Double_(JointAngleKey(j, 0)), sigma);
+    problem.constraints.emplace_shared<DoubleExpressionEquality>(
+        gtsam::Double_(JointVelKey(j, 0)), sigma);
+  }
+  problem.build_seconds = secondsSince(start);
+
+  Initializer initializer;
+  problem.initial = initializer.MultiPhaseZeroValuesTrajectory(
+      robot, {num_steps}, {}, dt, sigma);
+  return problem;
+}
+
+// Build, linearize, eliminate and optimize one configuration, and print its
+// line of the table.
+void run(const Model &model, int num_steps, Method method,
+         size_t max_iterations) {
+  const Robot robot = model.load();
+  const Problem problem = buildProblem(robot, model.base_name, num_steps);
+
+  // One linearization and elimination at the initial values.
+  auto start = Clock::now();
+  const auto linear = problem.graph.linearize(problem.initial);
+  const double linearize_seconds = secondsSince(start);
+  start = Clock::now();
+  linear->eliminateMultifrontal();
+  const double eliminate_seconds = secondsSince(start);
+
+  OptimizationParameters parameters;
+  parameters.method = method;
+  parameters.lm_parameters.setMaxIterations(max_iterations);
+  const Optimizer optimizer(parameters);
+  SolverTelemetry telemetry;
+  start = Clock::now();
+  const gtsam::Values result = optimizer.optimize(
+      problem.graph, problem.constraints, problem.initial, &telemetry);
+  const double solve_seconds = secondsSince(start);
+
+  // The SQP method records no telemetry.
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  double solver_linearize_seconds = telemetry.iterations.empty() ? nan : 0,
+         solver_eliminate_seconds = solver_linearize_seconds;
+  for (auto &&iteration : telemetry.iterations) {
+    solver_linearize_seconds += iteration.linearize_time;
+    solver_eliminate_seconds += iteration.solve_time;
+  }
+  const long iterations =
+      telemetry.iterations.empty() ? -1 : long(telemetry.iterations.size());
+
+  std::cout << model.name << "," << robot.numJoints() << "," << num_steps
+            << "," << methodName(method) << "," << problem.graph.size() << ","
+            << problem.initial.size() << "," << problem.build_seconds << ","
+            << linearize_seconds << "," << eliminate_seconds << ","
+            << solve_seconds << "," << iterations << ","
+            << solver_linearize_seconds << "," << solver_eliminate_seconds
+            << "," << problem.graph.error(result) << "," << peakRss()
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  const size_t max_iterations = argc > 1 ? std::stoul(argv[1]) : 10;
+
+  // There is no Nao model in models/, the Atlas humanoid stands in for it.
+  const vector<Model> models = {
+      {"pendulum",
+       [] {
+         return CreateRobotFromFile(kUrdfPath +
+                                    string("inverted_pendulum.urdf"))
+             .fixLink("l1");
+       },
+       "l1"},
+      {"a1",
+       [] { return CreateRobotFromFile(kUrdfPath + string("a1/a1.urdf")); },
+       "trunk"},
+      {"spider",
+       [] {
+         return CreateRobotFromFile(kSdfPath + string("spider_alt.sdf"),
+                                    "spider");
+       },
+       "body"},
+      {"atlas",
+       [] { return CreateRobotFromFile(kUrdfPath + string("atlas.urdf")); },
+       "pelvis"}};
+  const vector<int> horizons = {50, 100, 200, 500, 1000};
+  const vector<Method> methods = {Method::SOFT_CONSTRAINTS, Method::PENALTY,
+                                  Method::AUGMENTED_LAGRANGIAN, Method::SQP};
+
+  std::cout << "robot,joints,horizon,method,factors,variables,build_seconds,"
+               "linearize_seconds,eliminate_seconds,solve_seconds,iterations,"
+               "solver_linearize_seconds,solver_eliminate_seconds,error,"
+               "peak_rss_kb"
+            << std::endl;
+
+  if (argc > 4) {
+    for (auto &&model : models) {
+      if (model.name != argv[2]) continue;
+      for (auto &&method : methods) {
+        if (methodName(method) == argv[4]) {
+          run(model, std::stoi(argv[3]), method, max_iterations);
+          return 0;
+        }
+      }
+    }
+    std::cerr << "unknown robot or method" << std::endl;
+    return 1;
+  }
+
+  for (auto &&model : models) {
+    for (int num_steps : horizons) {
+      for (auto &&method : methods) {
+        run(model, num_steps, method, max_iterations);
+      }
+    }
+  }
+  return 0;
+}
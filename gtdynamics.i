@@ -74,6 +74,9 @@ class ContactPointFactor : gtsam::NoiseModelFactor {
 
   void print(const string &s = "", const gtsam::KeyFormatter &keyFormatter =
                                        gtdynamics::GTDKeyFormatter);
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 #include <gtdynamics/factors/MinTorqueFactor.h>
@@ -83,6 +86,9 @@ class MinTorqueFactor : gtsam::NonlinearFactor {
 
   void print(const string &s="",
              const gtsam::KeyFormatter &keyFormatter=gtdynamics::GTDKeyFormatter);
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 /// TODO(yetong): remove the wrapper for WrenchFactor once EqualityConstraint is
@@ -98,6 +104,9 @@ class EulerPoseCollocationFactor : gtsam::NonlinearFactor {
   EulerPoseCollocationFactor(gtsam::Key pose_t0_key, gtsam::Key pose_t1_key,
                              gtsam::Key twist_key, gtsam::Key dt_key,
                              const gtsam::noiseModel::Base *cost_model);
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 class TrapezoidalPoseCollocationFactor : gtsam::NonlinearFactor {
@@ -106,12 +115,29 @@ class TrapezoidalPoseCollocationFactor : gtsam::NonlinearFactor {
                                    gtsam::Key twist_t0_key,
                                    gtsam::Key twist_t1_key, gtsam::Key dt_key,
                                    const gtsam::noiseModel::Base *cost_model);
+
+  // enabling serialization functionality
+  void serialize() const;
+};
+
+class HermiteSimpsonPoseCollocationFactor : gtsam::NonlinearFactor {
+  HermiteSimpsonPoseCollocationFactor(
+      gtsam::Key pose_t0_key, gtsam::Key pose_t1_key, gtsam::Key twist_t0_key,
+      gtsam::Key twist_t1_key, gtsam::Key accel_t0_key,
+      gtsam::Key accel_t1_key, gtsam::Key dt_key,
+      const gtsam::noiseModel::Base *cost_model);
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 class EulerTwistCollocationFactor : gtsam::NonlinearFactor {
   EulerTwistCollocationFactor(gtsam::Key twist_t0_key, gtsam::Key twist_t1_key,
                               gtsam::Key accel_key, gtsam::Key dt_key,
                               const gtsam::noiseModel::Base *cost_model);
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 class TrapezoidalTwistCollocationFactor : gtsam::NonlinearFactor {
@@ -120,6 +146,9 @@ class TrapezoidalTwistCollocationFactor : gtsam::NonlinearFactor {
                                     gtsam::Key accel_t0_key,
                                     gtsam::Key accel_t1_key, gtsam::Key dt_key,
                                     const gtsam::noiseModel::Base *cost_model);
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 #include <gtdynamics/factors/ContactHeightFactor.h>
@@ -159,7 +188,9 @@ class Link  {
   static gtdynamics::Link fix(const gtdynamics::Link& link);
   static gtdynamics::Link fix(const gtdynamics::Link& link, gtsam::Pose3 &fixed_pose);
   static gtdynamics::Link unfix(const gtdynamics::Link& link);
-  
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 /********************** joint **********************/
@@ -181,7 +212,7 @@ class JointParams {
 };
 
 virtual class Joint {
-  uint8_t id() const;
+  uint16_t id() const;
   const gtsam::Pose3 &jMp() const;
   const gtsam::Pose3 &jMc() const;
   gtsam::Pose3 pMc() const;
@@ -204,6 +235,9 @@ virtual class RevoluteJoint : gtdynamics::Joint {
       const Vector &axis,
       const gtdynamics::JointParams &parameters = gtdynamics::JointParams());
   void print(const string &s = "") const;
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 virtual class PrismaticJoint : gtdynamics::Joint {
@@ -213,6 +247,9 @@ virtual class PrismaticJoint : gtdynamics::Joint {
       const Vector &axis,
       const gtdynamics::JointParams &parameters = gtdynamics::JointParams());
   void print(const string &s = "") const;
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 virtual class HelicalJoint : gtdynamics::Joint {
@@ -222,6 +259,9 @@ virtual class HelicalJoint : gtdynamics::Joint {
       const Vector &axis, double thread_pitch,
       const gtdynamics::JointParams &parameters = gtdynamics::JointParams());
   void print(const string &s = "") const;
+
+  // enabling serialization functionality
+  void serialize() const;
 };
 
 /********************** robot **********************/
@@ -239,13 +279,18 @@ class Robot {
 
   void removeLink(gtdynamics::Link* link);
 
+  size_t contentHash() const;
+
   void removeJoint(gtdynamics::Joint* joint);
 
   gtdynamics::Link* link(string name) const;
 
   gtdynamics::Joint* joint(string name) const;
 
-  gtdynamics::Robot fixLink(const string& name);
+  gtdynamics::Robot fixLink(const string& name) const;
+  gtdynamics::Robot unfixLink(const string& name) const;
+  bool isFixed(const gtdynamics::Link* link) const;
+  gtsam::Pose3 fixedPose(const gtdynamics::Link* link) const;
 
   int numLinks() const;
 
@@ -293,9 +338,33 @@ class PointOnLink {
 #include <gtdynamics/optimizer/Optimizer.h>
 class OptimizationParameters {
   gtsam::LevenbergMarquardtParams lm_parameters;
+  string checkpoint_path;
+  size_t checkpoint_interval;
+  bool nested_ordering;
+  size_t num_threads;
   OptimizationParameters();
 };
 
+#include <gtdynamics/optimizer/LqrGains.h>
+class LqrGains {
+  size_t state_dim;
+  size_t control_dim;
+  gtsam::Matrix K;
+  gtsam::Matrix k;
+  size_t numSteps() const;
+  gtsam::Matrix gain(size_t t) const;
+  gtsam::Vector feedForward(size_t t) const;
+  gtsam::Vector control(size_t t, const gtsam::Vector &dx) const;
+};
+
+gtsam::Ordering LqrOrdering(const gtsam::GaussianFactorGraph &graph,
+                            const std::vector<gtsam::KeyVector> &state_keys,
+                            const std::vector<gtsam::KeyVector> &control_keys);
+gtdynamics::LqrGains EliminateLqrGains(
+    const gtsam::GaussianFactorGraph &graph,
+    const std::vector<gtsam::KeyVector> &state_keys,
+    const std::vector<gtsam::KeyVector> &control_keys);
+
 /********************** kinematics **********************/
 #include <gtdynamics/kinematics/Kinematics.h>
 
@@ -372,7 +441,13 @@ class OptimizerSetting {
 
 
 #include<gtdynamics/dynamics/DynamicsGraph.h>
-enum CollocationScheme { Euler, RungeKutta, Trapezoidal, HermiteSimpson };
+enum CollocationScheme {
+  Euler,
+  RungeKutta,
+  Trapezoidal,
+  HermiteSimpson,
+  LegendreGaussRadau
+};
 
 class DynamicsGraph {
   DynamicsGraph();
@@ -487,6 +562,14 @@ class DynamicsGraph {
       const gtdynamics::Robot &robot, const int t, const int phase,
       const gtdynamics::CollocationScheme collocation) const;
 
+  gtsam::NonlinearFactorGraph pseudospectralCollocationFactors(
+      const gtdynamics::Robot &robot, const int t, const size_t num_points,
+      const double dt) const;
+
+  gtsam::NonlinearFactorGraph multiPhasePseudospectralCollocationFactors(
+      const gtdynamics::Robot &robot, const int t, const size_t num_points,
+      const int phase) const;
+
   gtsam::NonlinearFactorGraph jointLimitFactors(const gtdynamics::Robot &robot,
                                                 const int t) const;
 
@@ -513,6 +596,20 @@ class DynamicsGraph {
   static Vector jointTorques(const gtdynamics::Robot &robot,
                                     const gtsam::Values &result, const int t);
 
+  /* return joint values over time steps, [num_steps x num_joints]. */
+  static gtsam::Matrix jointAccelsTrajectory(const gtdynamics::Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps, int t0 = 0);
+  static gtsam::Matrix jointVelsTrajectory(const gtdynamics::Robot &robot,
+                                           const gtsam::Values &result,
+                                           size_t num_steps, int t0 = 0);
+  static gtsam::Matrix jointAnglesTrajectory(const gtdynamics::Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps, int t0 = 0);
+  static gtsam::Matrix jointTorquesTrajectory(const gtdynamics::Robot &robot,
+                                              const gtsam::Values &result,
+                                              size_t num_steps, int t0 = 0);
+
   static gtdynamics::JointValueMap jointAccelsMap(const gtdynamics::Robot &robot,
                                            const gtsam::Values &result,
                                            const int t);
@@ -553,6 +650,12 @@ class DynamicsGraph {
                             const gtsam::NonlinearFactorGraph &graph,
                             const gtsam::Values &values, const int num_steps);
 
+  static void saveGraphSlices(const string &directory,
+                              const gtsam::NonlinearFactorGraph &graph,
+                              const gtsam::Values &values,
+                              const gtdynamics::Robot &robot,
+                              const int num_steps, bool radial);
+
   /* return the optimizer setting. */
   const gtdynamics::OptimizerSetting &opt() const;
 };
@@ -589,9 +692,22 @@ gtsam::NonlinearFactorGraph JointsAtRestObjectives(
     const gtsam::SharedNoiseModel &joint_velocity_model,
     const gtsam::SharedNoiseModel &joint_acceleration_model, int k = 0);
 
+gtsam::NonlinearFactorGraph JointAngleObjectives(
+    const std::vector<int> &joint_ids, const gtsam::Matrix &angles,
+    const gtsam::SharedNoiseModel &model, int k = 0);
+gtsam::NonlinearFactorGraph JointVelObjectives(
+    const std::vector<int> &joint_ids, const gtsam::Matrix &vels,
+    const gtsam::SharedNoiseModel &model, int k = 0);
+gtsam::NonlinearFactorGraph JointAccelObjectives(
+    const std::vector<int> &joint_ids, const gtsam::Matrix &accels,
+    const gtsam::SharedNoiseModel &model, int k = 0);
+gtsam::NonlinearFactorGraph TorqueObjectives(
+    const std::vector<int> &joint_ids, const gtsam::Matrix &torques,
+    const gtsam::SharedNoiseModel &model, int k = 0);
+
 gtsam::NonlinearFactorGraph PointGoalFactors(
     const gtsam::SharedNoiseModel &cost_model, const gtsam::Point3 &point_com,
-    const std::vector<gtsam::Point3> &goal_trajectory, uint8_t i,
+    const std::vector<gtsam::Point3> &goal_trajectory, uint16_t i,
     size_t k = 0);
 
 std::vector<gtsam::Point3> StanceTrajectory(const gtsam::Point3 &stance_point,
@@ -624,18 +740,18 @@ class DynamicsSymbol {
   DynamicsSymbol(const gtdynamics::DynamicsSymbol& key);
 
   static DynamicsSymbol LinkJointSymbol(const string& s,
-                                        uint8_t link_idx,
-                                        uint8_t joint_idx,
+                                        uint16_t link_idx,
+                                        uint16_t joint_idx,
                                         std::uint64_t t);
   static DynamicsSymbol JointSymbol(const string& s,
-                                    uint8_t joint_idx, std::uint64_t t);
-  static DynamicsSymbol LinkSymbol(const string& s, uint8_t link_idx,
+                                    uint16_t joint_idx, std::uint64_t t);
+  static DynamicsSymbol LinkSymbol(const string& s, uint16_t link_idx,
                                    std::uint64_t t);
   static DynamicsSymbol SimpleSymbol(const string& s, std::uint64_t t);
 
   string label() const;
-  uint8_t linkIdx() const;
-  uint8_t jointIdx() const;
+  uint16_t linkIdx() const;
+  uint16_t jointIdx() const;
   size_t time() const;
   gtsam::Key key() const;
 
@@ -688,6 +804,18 @@ gtsam::Vector Torque(const gtsam::VectorValues &values, int j, int t=0);
 
 double Torque(const gtsam::Values &values, int j, int t=0);
 
+void InsertJointAngles(gtsam::Values @values, const std::vector<int> &joint_ids,
+                       const gtsam::Matrix &angles, int t=0);
+
+void InsertJointVels(gtsam::Values @values, const std::vector<int> &joint_ids,
+                     const gtsam::Matrix &vels, int t=0);
+
+void InsertJointAccels(gtsam::Values @values, const std::vector<int> &joint_ids,
+                       const gtsam::Matrix &accels, int t=0);
+
+void InsertTorques(gtsam::Values @values, const std::vector<int> &joint_ids,
+                   const gtsam::Matrix &torques, int t=0);
+
 void InsertPose(gtsam::Values @values, int i, int t, gtsam::Pose3 value);
 
 void InsertPose(gtsam::Values @values, int i, gtsam::Pose3 value);
@@ -718,9 +846,67 @@ gtsam::Vector Wrench(const gtsam::VectorValues &values, int i, int j, int t=0);
 
 gtsam::Vector6 Wrench(const gtsam::Values &values, int i, int j, int t=0);
 
+/********************** ArticulatedBodySolver **********************/
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+
+class ArticulatedBodySolver {
+  ArticulatedBodySolver(const gtdynamics::Robot &robot);
+  ArticulatedBodySolver(const gtdynamics::Robot &robot,
+                        const gtsam::Vector3 &gravity);
+  ArticulatedBodySolver(const gtdynamics::Robot &robot,
+                        const gtsam::Vector3 &gravity,
+                        const gtsam::Vector3 &planar_axis);
+
+  gtsam::Values solveFD(const gtsam::Values &known_values, int t) const;
+  gtsam::Values solveID(const gtsam::Values &known_values, int t) const;
+};
+
 /********************** Simulator **********************/
+#include <gtdynamics/utils/TrajectoryState.h>
+class TrajectoryState {
+  TrajectoryState();
+  TrajectoryState(const gtdynamics::Robot &robot, size_t num_steps);
+  TrajectoryState(const gtdynamics::Robot &robot, size_t num_steps,
+                  unsigned quantities, int t0);
+  static gtdynamics::TrajectoryState FromValues(
+      const gtdynamics::Robot &robot, const gtsam::Values &values,
+      size_t num_steps, int t0);
+  void setStep(int t, const gtsam::Values &values, int t_values);
+  gtsam::Values values() const;
+  int t0() const;
+  size_t numSteps() const;
+  unsigned quantities() const;
+  bool has(unsigned quantities) const;
+  const gtsam::Matrix &jointAngles() const;
+  const gtsam::Matrix &jointVels() const;
+  const gtsam::Matrix &jointAccels() const;
+  const gtsam::Matrix &torques() const;
+  gtsam::Pose3 pose(int i, int t) const;
+  void setPose(int i, int t, const gtsam::Pose3 &pose);
+  gtsam::Vector6 twist(int i, int t) const;
+  gtsam::Vector6 twistAccel(int i, int t) const;
+  gtsam::Vector6 wrench(int i, int j, int t) const;
+};
+
 #include <gtdynamics/dynamics/Simulator.h>
 
+enum ForwardDynamicsMethod { LinearFactorGraph, ArticulatedBody };
+
+#include <gtdynamics/dynamics/Integrator.h>
+enum IntegrationMethod { ExplicitEuler, SemiImplicitEuler, RK4, RK45 };
+
+class SimulatorEvent {
+  string name;
+  int direction;
+};
+
+gtdynamics::SimulatorEvent ContactHeightEvent(
+    const gtdynamics::PointOnLink &point, double ground_height = 0.0);
+gtdynamics::SimulatorEvent ContactForceEvent(
+    const gtdynamics::Link* link,
+    const gtdynamics::Joint* joint,
+    const gtsam::Vector3 &normal);
+
 class Simulator {
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values);
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values,
@@ -728,6 +914,10 @@ class Simulator {
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values,
             const gtsam::Vector3 &gravity,
             const gtsam::Vector3 &planar_axis);
+  Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values,
+            const gtsam::Vector3 &gravity,
+            const gtsam::Vector3 &planar_axis,
+            const gtdynamics::ForwardDynamicsMethod method);
 
   void reset(const double t);
   void forwardDynamics(const gtsam::Values &torques);
@@ -735,7 +925,48 @@ class Simulator {
   void step(const gtsam::Values &torques, const double dt);
   gtsam::Values simulate(const std::vector<gtsam::Values> &torques_seq,
                          const double dt);
+  gtdynamics::TrajectoryState simulateTrajectory(
+      const std::vector<gtsam::Values> &torques_seq, const double dt);
+  double stepUntilEvent(const gtsam::Values &torques, const double dt);
+  gtsam::Values simulateWithEvents(
+      const std::vector<gtsam::Values> &torques_seq, const double dt);
+  void addEvent(const gtdynamics::SimulatorEvent &event);
+  void clearEvents();
+  void setEventTolerance(const double tolerance);
+  string lastEvent() const;
+  double time() const;
+  void setRobot(const gtdynamics::Robot &robot);
+  const gtdynamics::Robot &robot() const;
   const gtsam::Values &getValues() const;
+  void setIntegrationMethod(const gtdynamics::IntegrationMethod method);
+  void setIntegrationMethod(const gtdynamics::IntegrationMethod method,
+                            const double tolerance);
+  gtdynamics::IntegrationMethod integrationMethod() const;
+};
+
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+class JointSpaceSimulator {
+  JointSpaceSimulator(const gtdynamics::Robot &robot,
+                      const gtsam::Values &initial_values, size_t num_steps);
+  JointSpaceSimulator(const gtdynamics::Robot &robot,
+                      const gtsam::Values &initial_values, size_t num_steps,
+                      const gtsam::Vector3 &gravity);
+  JointSpaceSimulator(const gtdynamics::Robot &robot,
+                      const gtsam::Values &initial_values, size_t num_steps,
+                      const gtsam::Vector3 &gravity,
+                      const gtsam::Vector3 &planar_axis);
+
+  void reset();
+  void step(const gtsam::Vector &torques, double dt);
+  void simulate(const gtsam::Matrix &torques, double dt);
+  size_t numSteps() const;
+  size_t currentStep() const;
+  const gtsam::Matrix &jointAngles() const;
+  const gtsam::Matrix &jointVels() const;
+  const gtsam::Matrix &jointAccels() const;
+  const gtsam::Matrix &torques() const;
+  gtsam::Values values(size_t k) const;
+  gtdynamics::TrajectoryState trajectoryState() const;
 };
 
 /********************** Trajectory et al  **********************/
@@ -784,6 +1015,7 @@ class WalkCycle {
   gtdynamics::ContactPointGoals initContactPointGoal(
       const gtdynamics::Robot &robot, double ground_height) const;
   void print(const string& s = "") const;
+  size_t contentHash() const;
   std::vector<string> getPhaseSwingLinks(size_t p) const;
   const gtdynamics::PointOnLinks getPhaseContactPoints(size_t p) const;
 };
@@ -838,6 +1070,8 @@ class Trajectory {
   void addIntegrationTimeFactors(gtsam::NonlinearFactorGraph @graph,
                                  double desired_dt, double sigma = 0) const;
   void writeToFile(const gtdynamics::Robot &robot, const string &name, const gtsam::Values &results) const;
+  gtsam::Matrix jointMatrix(const gtdynamics::Robot &robot, const gtsam::Values &results) const;
+  void writeToBinaryFile(const gtdynamics::Robot &robot, const string &name, const gtsam::Values &results) const;
 };
 
 /********************** Utilities  **********************/
@@ -28,6 +28,97 @@ class CableTensionFactor : gtsam::NonlinearFactor {
   void print(const string &s, const gtsam::KeyFormatter &keyFormatter);
 };
 
+#include <gtdynamics/cablerobot/factors/CableRobotFactors.h>
+class CableKinematicsFactor : gtsam::NonlinearFactor {
+  CableKinematicsFactor(gtsam::Key wTx_key, gtsam::Key Vx_key,
+                        const gtsam::KeyVector &l_keys,
+                        const gtsam::KeyVector &ldot_keys,
+                        const gtsam::noiseModel::Base *cost_model,
+                        const std::vector<gtsam::Point3> &wPa,
+                        const std::vector<gtsam::Point3> &xPb);
+  size_t numCables() const;
+  void print(const string &s, const gtsam::KeyFormatter &keyFormatter);
+};
+
+class CableTensionsFactor : gtsam::NonlinearFactor {
+  CableTensionsFactor(gtsam::Key wTx_key, const gtsam::KeyVector &tension_keys,
+                      const gtsam::KeyVector &wrench_keys,
+                      const gtsam::noiseModel::Base *cost_model,
+                      const std::vector<gtsam::Point3> &wPa,
+                      const std::vector<gtsam::Point3> &xPb);
+  size_t numCables() const;
+  void print(const string &s, const gtsam::KeyFormatter &keyFormatter);
+};
+
+/****************************************** Controller ******************************************/
+
+#include <gtdynamics/cablerobot/controller/CableTensionDistribution.h>
+gtsam::Vector NonNegativeLeastSquares(const gtsam::Matrix &A,
+                                      const gtsam::Vector &b,
+                                      size_t max_iterations);
+
+class CableTensionDistribution {
+  CableTensionDistribution(const std::vector<gtsam::Point3> &wPa,
+                           const std::vector<gtsam::Point3> &xPb,
+                           double t_min, double lambda,
+                           size_t max_iterations);
+  size_t numCables() const;
+  double tMin() const;
+  gtsam::Matrix structureMatrix(const gtsam::Pose3 &wTx) const;
+  gtsam::Vector solve(const gtsam::Pose3 &wTx, const gtsam::Vector6 &Fx,
+                      const gtsam::Vector &t_ref) const;
+};
+
+/****************************************** Simulator ******************************************/
+
+#include <gtdynamics/cablerobot/simulator/CdprPlanarSimulator.h>
+class CdprAffineController {
+  CdprAffineController(const gtsam::Matrix &feedforward);
+  CdprAffineController(const gtsam::Matrix &feedforward,
+                       const std::vector<gtsam::Pose3> &poses,
+                       const std::vector<gtsam::Vector6> &twists,
+                       const gtsam::Matrix &gain);
+  size_t numSteps() const;
+  gtsam::Vector tensions(size_t k, const gtsam::Pose3 &wTx,
+                         const gtsam::Vector6 &Vx) const;
+};
+
+class CdprRollout {
+  gtsam::Matrix lengths;
+  gtsam::Matrix length_rates;
+  gtsam::Matrix tensions;
+  size_t numSteps() const;
+  gtsam::Pose3 pose(size_t k) const;
+  gtsam::Vector6 twist(size_t k) const;
+  gtsam::Values values(int ee_id, double dt) const;
+};
+
+class CdprPlanarSimulator {
+  CdprPlanarSimulator(const std::vector<gtsam::Point3> &wPa,
+                      const std::vector<gtsam::Point3> &xPb, double mass,
+                      const gtsam::Matrix3 &inertia,
+                      const gtsam::Vector3 &gravity, double dt);
+  size_t numCables() const;
+  double dt() const;
+  gtsam::Vector lengths(const gtsam::Pose3 &wTx) const;
+  gtsam::Vector lengthRates(const gtsam::Pose3 &wTx,
+                            const gtsam::Vector6 &Vx) const;
+  gtsam::Vector6 twistAccel(const gtsam::Pose3 &wTx, const gtsam::Vector6 &Vx,
+                            const gtsam::Vector &tensions) const;
+  gtdynamics::CdprRollout rollout(const gtsam::Pose3 &wTx,
+                                  const gtsam::Vector6 &Vx,
+                                  const gtsam::Matrix &tensions) const;
+  gtdynamics::CdprRollout rollout(
+      const gtsam::Pose3 &wTx, const gtsam::Vector6 &Vx,
+      const gtdynamics::CdprAffineController &controller,
+      size_t num_steps) const;
+  std::vector<gtdynamics::CdprRollout> rollouts(
+      const std::vector<gtsam::Pose3> &poses,
+      const std::vector<gtsam::Vector6> &twists,
+      const std::vector<gtdynamics::CdprAffineController> &controllers,
+      size_t num_steps) const;
+};
+
 // need to borrow this from GTSAM since GTSAM doesn't have fixed-size vector versions
 #include <gtdynamics/cablerobot/factors/PriorFactor.h>
 template<T = {double, gtsam::Vector2, gtsam::Vector3, gtsam::Vector4, gtsam::Vector5, gtsam::Vector6}>
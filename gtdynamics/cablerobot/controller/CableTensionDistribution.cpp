@@ -0,0 +1,171 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CableTensionDistribution.cpp
+ * @brief Tension distribution of a cable robot: the cable tensions that
+ * produce a desired end-effector wrench, with the tensions bounded below.
+ */
+
+#include "CableTensionDistribution.h"
+
+#include <Eigen/Cholesky>
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+namespace {
+// Solve the normal equations restricted to the passive variables, zero for
+// the others.
+Vector SolvePassive(const Matrix &G, const Vector &g,
+                    const std::vector<bool> &passive) {
+  std::vector<Eigen::Index> indices;
+  for (size_t i = 0; i < passive.size(); i++) {
+    if (passive[i]) indices.push_back(i);
+  }
+  const Eigen::Index m = indices.size();
+  Matrix G_p(m, m);
+  Vector g_p(m);
+  for (Eigen::Index r = 0; r < m; r++) {
+    g_p(r) = g(indices[r]);
+    for (Eigen::Index c = 0; c < m; c++) {
+      G_p(r, c) = G(indices[r], indices[c]);
+    }
+  }
+  const Vector z_p = G_p.ldlt().solve(g_p);
+  Vector z = Vector::Zero(g.size());
+  for (Eigen::Index r = 0; r < m; r++) z(indices[r]) = z_p(r);
+  return z;
+}
+}  // namespace
+
+/******************************************************************************/
+Vector NonNegativeLeastSquares(const Matrix &A, const Vector &b,
+                               size_t max_iterations, size_t *iterations) {
+  if (A.rows() != b.size()) {
+    throw std::invalid_argument(
+        "NonNegativeLeastSquares: A and b have different numbers of rows.");
+  }
+  const Matrix G = A.transpose() * A;
+  const Vector g = A.transpose() * b;
+  const Eigen::Index n = g.size();
+  // Gradients below tol are taken as zero.
+  const double tol = 1e-12 * (1 + (n ? g.cwiseAbs().maxCoeff() : 0));
+
+  Vector x = Vector::Zero(n);
+  std::vector<bool> passive(n, false);
+  size_t iteration = 0;
+  for (; iteration < max_iterations; iteration++) {
+    // Free the active variable of steepest descent, if any.
+    const Vector w = g - G * x;
+    Eigen::Index j = -1;
+    double w_max = tol;
+    for (Eigen::Index i = 0; i < n; i++) {
+      if (!passive[i] && w(i) > w_max) {
+        j = i;
+        w_max = w(i);
+      }
+    }
+    if (j < 0) break;
+    passive[j] = true;
+
+    // Move towards the solution on the passive set, and make the variables
+    // that hit zero on the way active again; each pass removes at least one.
+    while (true) {
+      const Vector z = SolvePassive(G, g, passive);
+      double alpha = 1;
+      Eigen::Index blocking = -1;
+      for (Eigen::Index i = 0; i < n; i++) {
+        if (passive[i] && z(i) <= 0) {
+          const double step = x(i) - z(i);
+          const double alpha_i = step > 0 ? x(i) / step : 0;
+          if (blocking < 0 || alpha_i < alpha) {
+            alpha = alpha_i;
+            blocking = i;
+          }
+        }
+      }
+      if (blocking < 0) {
+        x = z;
+        break;
+      }
+      x += alpha * (z - x);
+      x(blocking) = 0;
+      for (Eigen::Index i = 0; i < n; i++) {
+        if (passive[i] && x(i) <= 0) {
+          passive[i] = false;
+          x(i) = 0;
+        }
+      }
+    }
+  }
+  if (iterations) *iterations = iteration;
+  return x;
+}
+
+/******************************************************************************/
+CableTensionDistribution::CableTensionDistribution(
+    const std::vector<Point3> &wPa, const std::vector<Point3> &xPb,
+    double t_min, double lambda, size_t max_iterations)
+    : wPa_(wPa),
+      xPb_(xPb),
+      t_min_(t_min),
+      lambda_(lambda),
+      max_iterations_(max_iterations) {
+  if (wPa_.size() != xPb_.size()) {
+    throw std::invalid_argument(
+        "CableTensionDistribution: needs one end-effector mounting location "
+        "per frame mounting location.");
+  }
+  if (t_min_ < 0 || lambda_ <= 0) {
+    throw std::invalid_argument(
+        "CableTensionDistribution: needs t_min >= 0 and lambda > 0.");
+  }
+}
+
+/******************************************************************************/
+Matrix CableTensionDistribution::structureMatrix(const Pose3 &wTx) const {
+  Matrix W(6, numCables());
+  const Rot3 &wRx = wTx.rotation();
+  for (size_t i = 0; i < numCables(); i++) {
+    // Same wrench as CableTensionFactor::computeWrench, for a unit tension.
+    const Point3 wPb = wTx.transformFrom(xPb_[i]);
+    const Vector3 xf = wRx.unrotate(-normalize(wPb - wPa_[i]));
+    W.col(i) << cross(xPb_[i], xf), xf;
+  }
+  return W;
+}
+
+/******************************************************************************/
+Vector CableTensionDistribution::solve(const Pose3 &wTx, const Vector6 &Fx,
+                                       const Vector &t_ref,
+                                       size_t *iterations) const {
+  const Eigen::Index n = numCables();
+  if (t_ref.size() != 0 && t_ref.size() != n) {
+    throw std::invalid_argument(
+        "CableTensionDistribution: needs one reference tension per cable.");
+  }
+  const Vector t_min = Vector::Constant(n, t_min_);
+
+  // With t = t_min + s, stack the wrench and regularization residuals, and
+  // solve for s >= 0.
+  const double sqrt_lambda = std::sqrt(lambda_);
+  const Matrix W = structureMatrix(wTx);
+  Matrix A(6 + n, n);
+  A << W, sqrt_lambda * Matrix::Identity(n, n);
+  Vector b(6 + n);
+  b << Fx - W * t_min,
+      t_ref.size() ? Vector(sqrt_lambda * (t_ref - t_min))
+                   : Vector(Vector::Zero(n));
+  return t_min + NonNegativeLeastSquares(A, b, max_iterations_, iterations);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CableTensionDistribution.h
+ * @brief Tension distribution of a cable robot: the cable tensions that
+ * produce a desired end-effector wrench, with the tensions bounded below.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Solve min ||A x - b||^2 subject to x >= 0 with the active set method of
+ * Lawson and Hanson, on the normal equations. Each iteration frees one
+ * variable, so the cost is bounded by max_iterations small solves.
+ * @param A               the matrix, with full column rank
+ * @param b               the right hand side
+ * @param max_iterations  largest number of active set changes
+ * @param iterations      if given, set to the number of iterations; equal to
+ *                        max_iterations if the solve stopped early, with a
+ *                        feasible but not optimal x
+ * @return x
+ */
+gtsam::Vector NonNegativeLeastSquares(const gtsam::Matrix &A,
+                                      const gtsam::Vector &b,
+                                      size_t max_iterations = 100,
+                                      size_t *iterations = nullptr);
+
+/**
+ * CableTensionDistribution computes the cable tensions t of a cable robot
+ * that produce a desired wrench Fx on the end effector, in the end effector
+ * frame, as seen by CableTensionFactor:
+ *
+ *   min ||W(wTx) t - Fx||^2 + lambda ||t - t_ref||^2  s.t.  t >= t_min
+ *
+ * W(wTx) is the structure matrix, the Jacobian of the cable wrenches of
+ * CableTensionFactor with respect to the tensions, which is computed in
+ * closed form at each pose instead of linearizing the factors. The small
+ * regularization picks the tensions closest to t_ref among the many that
+ * produce the same wrench, and keeps the solve well posed for planar robots.
+ */
+class CableTensionDistribution {
+ private:
+  using Matrix = gtsam::Matrix;
+  using Vector = gtsam::Vector;
+  using Point3 = gtsam::Point3;
+  using Pose3 = gtsam::Pose3;
+  using Vector6 = gtsam::Vector6;
+
+  std::vector<Point3> wPa_, xPb_;
+  double t_min_, lambda_;
+  size_t max_iterations_;
+
+ public:
+  /**
+   * Constructor.
+   * @param wPa             cable mounting locations on the fixed frame, in
+   *                        world coordinates
+   * @param xPb             cable mounting locations on the end effector, in
+   *                        the end-effector frame
+   * @param t_min           smallest tension of every cable
+   * @param lambda          weight of the tension regularization
+   * @param max_iterations  largest number of active set changes per solve
+   */
+  CableTensionDistribution(const std::vector<Point3> &wPa,
+                           const std::vector<Point3> &xPb, double t_min = 0,
+                           double lambda = 1e-6, size_t max_iterations = 100);
+
+  /// Return the number of cables.
+  size_t numCables() const { return wPa_.size(); }
+
+  /// Return the smallest tension.
+  double tMin() const { return t_min_; }
+
+  /**
+   * Return the 6 x n structure matrix at a pose: column i is the wrench on
+   * the end effector, in its frame, of a unit tension on cable i.
+   */
+  Matrix structureMatrix(const Pose3 &wTx) const;
+
+  /**
+   * Return the cable tensions that produce a wrench.
+   * @param wTx         end effector pose
+   * @param Fx          desired wrench on the end effector, in its frame
+   * @param t_ref       preferred tensions; t_min for all cables if empty
+   * @param iterations  if given, set to the number of active set changes
+   */
+  Vector solve(const Pose3 &wTx, const Vector6 &Fx,
+               const Vector &t_ref = Vector(),
+               size_t *iterations = nullptr) const;
+};
+
+}  // namespace gtdynamics
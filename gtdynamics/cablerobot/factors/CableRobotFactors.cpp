@@ -0,0 +1,179 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CableRobotFactors.cpp
+ * @brief Factors on all cables of one end effector at once.
+ */
+
+#include "CableRobotFactors.h"
+
+#include <stdexcept>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+namespace {
+// Throw unless there are n cables' worth of keys, locations and noise model
+// dimensions.
+void CheckSizes(const std::string &name, size_t num_keys, size_t n_keys,
+                size_t n_wPa, size_t n_xPb, size_t dim, size_t cable_dim) {
+  if (n_wPa == 0 || n_xPb != n_wPa || num_keys != n_keys * n_wPa ||
+      dim != cable_dim * n_wPa) {
+    throw std::invalid_argument(
+        name + ": needs the keys, mounting locations and noise model "
+               "dimensions of the same number of cables.");
+  }
+}
+}  // namespace
+
+/******************************************************************************/
+KeyVector CableKinematicsFactor::Keys(Key wTx_key, Key Vx_key,
+                                      const KeyVector &l_keys,
+                                      const KeyVector &ldot_keys) {
+  KeyVector keys{wTx_key, Vx_key};
+  keys.insert(keys.end(), l_keys.begin(), l_keys.end());
+  keys.insert(keys.end(), ldot_keys.begin(), ldot_keys.end());
+  return keys;
+}
+
+/******************************************************************************/
+CableKinematicsFactor::CableKinematicsFactor(
+    Key wTx_key, Key Vx_key, const KeyVector &l_keys,
+    const KeyVector &ldot_keys, const noiseModel::Base::shared_ptr &cost_model,
+    const std::vector<Point3> &wPa, const std::vector<Point3> &xPb)
+    : Base(cost_model, Keys(wTx_key, Vx_key, l_keys, ldot_keys)),
+      wPa_(wPa),
+      xPb_(xPb) {
+  if (l_keys.size() != ldot_keys.size()) {
+    throw std::invalid_argument(
+        "CableKinematicsFactor: needs one length rate key per length key.");
+  }
+  CheckSizes("CableKinematicsFactor", size() - 2, 2, wPa.size(), xPb.size(),
+             cost_model->dim(), 2);
+}
+
+/******************************************************************************/
+Vector CableKinematicsFactor::unwhitenedError(
+    const Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t n = numCables();
+  const Pose3 &wTx = x.at<Pose3>(keys_[0]);
+  const Vector6 &Vx = x.at<Vector6>(keys_[1]);
+  const Matrix3 wRx = wTx.rotation().matrix();
+  const Vector3 omega = Vx.head<3>(), v = Vx.tail<3>();
+
+  Vector error(2 * n);
+  if (H) {
+    H->resize(size());
+    (*H)[0] = Matrix::Zero(2 * n, 6);
+    (*H)[1] = Matrix::Zero(2 * n, 6);
+    for (size_t j = 2; j < size(); j++) (*H)[j] = Matrix::Zero(2 * n, 1);
+  }
+  for (size_t i = 0; i < n; i++) {
+    // Cable direction and mounting point velocity, in world coordinates.
+    const Vector3 wPb = wRx * xPb_[i] + wTx.translation();
+    const Vector3 d = wPb - wPa_[i];
+    const double length = d.norm();
+    const Vector3 dir = d / length;
+    const Vector3 xPdot = v + omega.cross(xPb_[i]);
+    const Vector3 wPdot = wRx * xPdot;
+
+    error(i) = x.at<double>(keys_[2 + i]) - length;
+    error(n + i) = x.at<double>(keys_[2 + n + i]) - dir.dot(wPdot);
+    if (H) {
+      Matrix36 wPb_H_wTx;
+      wPb_H_wTx << -wRx * skewSymmetric(xPb_[i]), wRx;
+      const Matrix33 dir_H_wPb =
+          (I_3x3 - dir * dir.transpose()) / length;
+      Matrix36 wPdot_H_wTx, wPdot_H_Vx;
+      wPdot_H_wTx << -wRx * skewSymmetric(xPdot), Z_3x3;
+      wPdot_H_Vx << -wRx * skewSymmetric(xPb_[i]), wRx;
+
+      (*H)[0].row(i) = -dir.transpose() * wPb_H_wTx;
+      (*H)[0].row(n + i) =
+          -(wPdot.transpose() * dir_H_wPb * wPb_H_wTx +
+            dir.transpose() * wPdot_H_wTx);
+      (*H)[1].row(n + i) = -dir.transpose() * wPdot_H_Vx;
+      (*H)[2 + i](i, 0) = 1;
+      (*H)[2 + n + i](n + i, 0) = 1;
+    }
+  }
+  return error;
+}
+
+/******************************************************************************/
+KeyVector CableTensionsFactor::Keys(Key wTx_key, const KeyVector &tension_keys,
+                                    const KeyVector &wrench_keys) {
+  KeyVector keys{wTx_key};
+  keys.insert(keys.end(), tension_keys.begin(), tension_keys.end());
+  keys.insert(keys.end(), wrench_keys.begin(), wrench_keys.end());
+  return keys;
+}
+
+/******************************************************************************/
+CableTensionsFactor::CableTensionsFactor(
+    Key wTx_key, const KeyVector &tension_keys, const KeyVector &wrench_keys,
+    const noiseModel::Base::shared_ptr &cost_model,
+    const std::vector<Point3> &wPa, const std::vector<Point3> &xPb)
+    : Base(cost_model, Keys(wTx_key, tension_keys, wrench_keys)),
+      wPa_(wPa),
+      xPb_(xPb) {
+  if (tension_keys.size() != wrench_keys.size()) {
+    throw std::invalid_argument(
+        "CableTensionsFactor: needs one wrench key per tension key.");
+  }
+  CheckSizes("CableTensionsFactor", size() - 1, 2, wPa.size(), xPb.size(),
+             cost_model->dim(), 6);
+}
+
+/******************************************************************************/
+Vector CableTensionsFactor::unwhitenedError(
+    const Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t n = numCables();
+  const Pose3 &wTx = x.at<Pose3>(keys_[0]);
+  const Matrix3 wRx = wTx.rotation().matrix();
+
+  Vector error(6 * n);
+  if (H) {
+    H->resize(size());
+    (*H)[0] = Matrix::Zero(6 * n, 6);
+    for (size_t j = 1; j <= n; j++) (*H)[j] = Matrix::Zero(6 * n, 1);
+    for (size_t j = n + 1; j < size(); j++) (*H)[j] = Matrix::Zero(6 * n, 6);
+  }
+  for (size_t i = 0; i < n; i++) {
+    // Same wrench as CableTensionFactor::computeWrench.
+    const double t = x.at<double>(keys_[1 + i]);
+    const Vector3 wPb = wRx * xPb_[i] + wTx.translation();
+    const Vector3 d = wPb - wPa_[i];
+    const double length = d.norm();
+    const Vector3 dir = d / length;
+    const Vector3 xf_t = -wRx.transpose() * dir;  // force of a unit tension
+    const Vector3 xf = t * xf_t;
+    const Matrix33 xPb_hat = skewSymmetric(xPb_[i]);
+
+    const Vector6 &F = x.at<Vector6>(keys_[1 + n + i]);
+    error.segment<3>(6 * i) = F.head<3>() - xPb_hat * xf;
+    error.segment<3>(6 * i + 3) = F.tail<3>() - xf;
+    if (H) {
+      Matrix36 wPb_H_wTx, xf_H_wTx;
+      wPb_H_wTx << -wRx * skewSymmetric(xPb_[i]), wRx;
+      xf_H_wTx << skewSymmetric(xf), Z_3x3;
+      xf_H_wTx -= t * wRx.transpose() *
+                  ((I_3x3 - dir * dir.transpose()) / length) * wPb_H_wTx;
+
+      (*H)[0].block<3, 6>(6 * i, 0) = -xPb_hat * xf_H_wTx;
+      (*H)[0].block<3, 6>(6 * i + 3, 0) = -xf_H_wTx;
+      (*H)[1 + i].block<3, 1>(6 * i, 0) = -xPb_hat * xf_t;
+      (*H)[1 + i].block<3, 1>(6 * i + 3, 0) = -xf_t;
+      (*H)[1 + n + i].block<6, 6>(6 * i, 0) = I_6x6;
+    }
+  }
+  return error;
+}
+
+}  // namespace gtdynamics
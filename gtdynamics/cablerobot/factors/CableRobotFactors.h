@@ -0,0 +1,159 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CableRobotFactors.h
+ * @brief Factors on all cables of one end effector at once.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CableKinematicsFactor is the CableLengthFactor and CableVelocityFactor of
+ * every cable of an end effector in one factor, with the error
+ *   [l_i - |wTx xPb_i - wPa_i|; ldot_i - dir_i . wPdot_i] for all i,
+ * lengths first. The rotation and the Jacobian blocks shared by all cables
+ * are computed once per evaluation, with fixed-size per-cable Jacobians.
+ *
+ * Keys are ordered as: pose, twist, the lengths, then the length rates.
+ */
+class CableKinematicsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using Point3 = gtsam::Point3;
+  using This = CableKinematicsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::vector<Point3> wPa_, xPb_;
+
+  static gtsam::KeyVector Keys(gtsam::Key wTx_key, gtsam::Key Vx_key,
+                               const gtsam::KeyVector &l_keys,
+                               const gtsam::KeyVector &ldot_keys);
+
+ public:
+  /**
+   * Constructor, throws std::invalid_argument unless every cable has a
+   * length and rate key, and mounting locations.
+   * @param wTx_key     key for end effector pose
+   * @param Vx_key      key for end effector twist
+   * @param l_keys      keys for the cable lengths
+   * @param ldot_keys   keys for the cable length rates
+   * @param cost_model  noise model, 2 n dimensional for n cables
+   * @param wPa         cable mounting locations on the fixed frame, in world
+   * @param xPb         cable mounting locations on the end effector
+   */
+  CableKinematicsFactor(gtsam::Key wTx_key, gtsam::Key Vx_key,
+                        const gtsam::KeyVector &l_keys,
+                        const gtsam::KeyVector &ldot_keys,
+                        const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                        const std::vector<Point3> &wPa,
+                        const std::vector<Point3> &xPb);
+
+  virtual ~CableKinematicsFactor() {}
+
+  /// Return the number of cables.
+  size_t numCables() const { return wPa_.size(); }
+
+  /// Evaluate the length and length rate errors of all cables.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override;
+
+  // @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /** print contents */
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 GTDKeyFormatter) const override {
+    std::cout << s << "cable kinematics factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * CableTensionsFactor is the CableTensionFactor of every cable of an end
+ * effector in one factor, with the error [F_i - W_i(wTx) t_i] for all i, the
+ * wrench F_i of each cable in the end effector frame; see
+ * CableTensionDistribution::structureMatrix for W.
+ *
+ * Keys are ordered as: pose, the tensions, then the wrenches.
+ */
+class CableTensionsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using Point3 = gtsam::Point3;
+  using This = CableTensionsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::vector<Point3> wPa_, xPb_;
+
+  static gtsam::KeyVector Keys(gtsam::Key wTx_key,
+                               const gtsam::KeyVector &tension_keys,
+                               const gtsam::KeyVector &wrench_keys);
+
+ public:
+  /**
+   * Constructor, throws std::invalid_argument unless every cable has a
+   * tension and wrench key, and mounting locations.
+   * @param wTx_key       key for end effector pose
+   * @param tension_keys  keys for the cable tensions
+   * @param wrench_keys   keys for the wrench of each cable on the end
+   *                      effector, in its frame
+   * @param cost_model    noise model, 6 n dimensional for n cables
+   * @param wPa           cable mounting locations on the fixed frame
+   * @param xPb           cable mounting locations on the end effector
+   */
+  CableTensionsFactor(gtsam::Key wTx_key, const gtsam::KeyVector &tension_keys,
+                      const gtsam::KeyVector &wrench_keys,
+                      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const std::vector<Point3> &wPa,
+                      const std::vector<Point3> &xPb);
+
+  virtual ~CableTensionsFactor() {}
+
+  /// Return the number of cables.
+  size_t numCables() const { return wPa_.size(); }
+
+  /// Evaluate the wrench errors of all cables.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override;
+
+  // @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /** print contents */
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 GTDKeyFormatter) const override {
+    std::cout << s << "cable tensions factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
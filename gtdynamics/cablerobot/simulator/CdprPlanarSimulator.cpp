@@ -0,0 +1,214 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprPlanarSimulator.cpp
+ * @brief Native simulator of a planar cable robot, with batched rollouts.
+ */
+
+#include "CdprPlanarSimulator.h"
+
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+namespace {
+// Zero the out-of-plane components of a twist or acceleration: rotation
+// about x and z, and translation along y.
+Vector6 Planar(Vector6 xi) {
+  xi(0) = xi(2) = xi(4) = 0;
+  return xi;
+}
+}  // namespace
+
+/******************************************************************************/
+CdprAffineController::CdprAffineController(const Matrix &feedforward)
+    : feedforward_(feedforward) {}
+
+/******************************************************************************/
+CdprAffineController::CdprAffineController(
+    const Matrix &feedforward, const std::vector<Pose3> &poses,
+    const std::vector<Vector6> &twists, const Matrix &gain)
+    : feedforward_(feedforward), gain_(gain), poses_(poses), twists_(twists) {
+  if (poses_.size() != numSteps() || twists_.size() != numSteps()) {
+    throw std::invalid_argument(
+        "CdprAffineController: needs one reference pose and twist per step.");
+  }
+  if (gain_.rows() != feedforward_.cols() || gain_.cols() != 12) {
+    throw std::invalid_argument(
+        "CdprAffineController: the gain must be n x 12 for n cables.");
+  }
+}
+
+/******************************************************************************/
+Vector CdprAffineController::tensions(size_t k, const Pose3 &wTx,
+                                      const Vector6 &Vx) const {
+  if (k >= numSteps()) {
+    throw std::out_of_range("CdprAffineController: no tensions at step " +
+                            std::to_string(k));
+  }
+  Vector t = feedforward_.row(k).transpose();
+  if (!poses_.empty()) {
+    Eigen::Matrix<double, 12, 1> error;
+    error << poses_[k].logmap(wTx), Vx - twists_[k];
+    t += gain_ * error;
+  }
+  return t;
+}
+
+/******************************************************************************/
+Values CdprRollout::values(int ee_id, double dt) const {
+  Values values;
+  for (size_t k = 0; k < poses.size(); k++) {
+    InsertPose(&values, ee_id, k, poses[k]);
+    InsertTwist(&values, ee_id, k, twists[k]);
+  }
+  for (size_t k = 0; k < numSteps(); k++) {
+    InsertTwistAccel(&values, ee_id, k, accels[k]);
+    for (Eigen::Index i = 0; i < tensions.cols(); i++) {
+      InsertJointAngle(&values, i, k, lengths(k, i));
+      InsertJointVel(&values, i, k, length_rates(k, i));
+      InsertTorque(&values, i, k, tensions(k, i));
+    }
+  }
+  values.insert(0, dt);
+  return values;
+}
+
+/******************************************************************************/
+CdprPlanarSimulator::CdprPlanarSimulator(const std::vector<Point3> &wPa,
+                                         const std::vector<Point3> &xPb,
+                                         double mass, const Matrix3 &inertia,
+                                         const Vector3 &gravity, double dt)
+    : cables_(wPa, xPb),
+      wPa_(wPa),
+      xPb_(xPb),
+      mass_(mass),
+      gravity_(gravity),
+      dt_(dt) {
+  if (!(mass > 0 && dt > 0)) {
+    throw std::invalid_argument(
+        "CdprPlanarSimulator: needs a positive mass and time step.");
+  }
+  inertia_.setZero();
+  inertia_.topLeftCorner<3, 3>() = inertia;
+  inertia_.bottomRightCorner<3, 3>() = mass * I_3x3;
+  inverse_inertia_ = inertia_.inverse();
+}
+
+/******************************************************************************/
+Vector CdprPlanarSimulator::lengths(const Pose3 &wTx) const {
+  Vector l(numCables());
+  for (size_t i = 0; i < numCables(); i++) {
+    l(i) = (wTx.transformFrom(xPb_[i]) - wPa_[i]).norm();
+  }
+  return l;
+}
+
+/******************************************************************************/
+Vector CdprPlanarSimulator::lengthRates(const Pose3 &wTx,
+                                        const Vector6 &Vx) const {
+  Vector ldot(numCables());
+  for (size_t i = 0; i < numCables(); i++) {
+    // Velocity of the mounting point, along the cable.
+    const Vector3 dir = (wTx.transformFrom(xPb_[i]) - wPa_[i]).normalized();
+    const Vector3 xPdot = Vx.tail<3>() + Vx.head<3>().cross(xPb_[i]);
+    ldot(i) = dir.dot(wTx.rotation().rotate(xPdot));
+  }
+  return ldot;
+}
+
+/******************************************************************************/
+Vector6 CdprPlanarSimulator::twistAccel(const Pose3 &wTx, const Vector6 &Vx,
+                                        const Vector &tensions) const {
+  if (static_cast<size_t>(tensions.size()) != numCables()) {
+    throw std::invalid_argument(
+        "CdprPlanarSimulator: needs one tension per cable.");
+  }
+  const Vector6 wrench = cables_.structureMatrix(wTx) * tensions +
+                         GravityWrench(gravity_, mass_, wTx) +
+                         Coriolis(inertia_, Vx);
+  return Planar(inverse_inertia_ * wrench);
+}
+
+/******************************************************************************/
+CdprRollout CdprPlanarSimulator::rollout(const Pose3 &wTx, const Vector6 &Vx,
+                                         const CdprController &controller,
+                                         size_t num_steps) const {
+  CdprRollout rollout;
+  rollout.poses.reserve(num_steps + 1);
+  rollout.twists.reserve(num_steps + 1);
+  rollout.accels.reserve(num_steps);
+  rollout.lengths.resize(num_steps, numCables());
+  rollout.length_rates.resize(num_steps, numCables());
+  rollout.tensions.resize(num_steps, numCables());
+
+  Pose3 pose = wTx;
+  Vector6 twist = Planar(Vx);
+  rollout.poses.push_back(pose);
+  rollout.twists.push_back(twist);
+  for (size_t k = 0; k < num_steps; k++) {
+    // Kinematics and control at step k, then Euler collocation to k + 1.
+    rollout.lengths.row(k) = lengths(pose).transpose();
+    rollout.length_rates.row(k) = lengthRates(pose, twist).transpose();
+    const Vector t = controller.tensions(k, pose, twist);
+    rollout.tensions.row(k) = t.transpose();
+    const Vector6 accel = twistAccel(pose, twist, t);
+    pose = pose.compose(Pose3::Expmap(twist * dt_));
+    twist += accel * dt_;
+    rollout.accels.push_back(accel);
+    rollout.poses.push_back(pose);
+    rollout.twists.push_back(twist);
+  }
+  return rollout;
+}
+
+/******************************************************************************/
+CdprRollout CdprPlanarSimulator::rollout(const Pose3 &wTx, const Vector6 &Vx,
+                                         const Matrix &tensions) const {
+  return rollout(wTx, Vx, CdprAffineController(tensions), tensions.rows());
+}
+
+/******************************************************************************/
+std::vector<CdprRollout> CdprPlanarSimulator::rollouts(
+    const std::vector<Pose3> &poses, const std::vector<Vector6> &twists,
+    const std::vector<std::shared_ptr<const CdprController>> &controllers,
+    size_t num_steps) const {
+  if (poses.size() != twists.size() || poses.size() != controllers.size()) {
+    throw std::invalid_argument(
+        "CdprPlanarSimulator: needs one pose, twist and controller per "
+        "rollout.");
+  }
+  std::vector<CdprRollout> rollouts(poses.size());
+  ParallelFor(rollouts.size(), [&](size_t r) {
+    rollouts[r] = rollout(poses[r], twists[r], *controllers[r], num_steps);
+  });
+  return rollouts;
+}
+
+/******************************************************************************/
+std::vector<CdprRollout> CdprPlanarSimulator::rollouts(
+    const std::vector<Pose3> &poses, const std::vector<Vector6> &twists,
+    const std::vector<CdprAffineController> &controllers,
+    size_t num_steps) const {
+  // Non-owning pointers, the controllers outlive the rollouts.
+  std::vector<std::shared_ptr<const CdprController>> pointers;
+  for (auto &&controller : controllers) {
+    pointers.emplace_back(&controller, [](const CdprController *) {});
+  }
+  return rollouts(poses, twists, pointers, num_steps);
+}
+
+}  // namespace gtdynamics
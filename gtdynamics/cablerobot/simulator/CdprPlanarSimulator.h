@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CdprPlanarSimulator.h
+ * @brief Native simulator of a planar cable robot, with batched rollouts.
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/controller/CableTensionDistribution.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Cable tensions of a cable robot at each time step, from its state.
+class CdprController {
+ public:
+  virtual ~CdprController() {}
+
+  /**
+   * Return the tension of each cable at time step k.
+   * @param k     time step
+   * @param wTx   end effector pose
+   * @param Vx    end effector twist, in its frame
+   */
+  virtual gtsam::Vector tensions(size_t k, const gtsam::Pose3 &wTx,
+                                 const gtsam::Vector6 &Vx) const = 0;
+};
+
+/**
+ * Time-varying affine state feedback around a reference trajectory,
+ *   t_k = u_k + K [ref_wTx_k.logmap(wTx); Vx - ref_Vx_k],
+ * with feedforward tensions u_k, the rows of a matrix, and n x 12 gain K.
+ * Without a reference, the tensions are open-loop.
+ */
+class CdprAffineController : public CdprController {
+ private:
+  gtsam::Matrix feedforward_, gain_;
+  std::vector<gtsam::Pose3> poses_;
+  std::vector<gtsam::Vector6> twists_;
+
+ public:
+  /// Open-loop controller, with N x n tensions.
+  explicit CdprAffineController(const gtsam::Matrix &feedforward);
+
+  /**
+   * Feedback controller, throws std::invalid_argument if the reference does
+   * not have one pose and twist per row of feedforward, or the gain is not
+   * n x 12.
+   */
+  CdprAffineController(const gtsam::Matrix &feedforward,
+                       const std::vector<gtsam::Pose3> &poses,
+                       const std::vector<gtsam::Vector6> &twists,
+                       const gtsam::Matrix &gain);
+
+  /// Return the number of time steps of the feedforward.
+  size_t numSteps() const { return feedforward_.rows(); }
+
+  /// Tensions at step k, throws std::out_of_range after numSteps().
+  gtsam::Vector tensions(size_t k, const gtsam::Pose3 &wTx,
+                         const gtsam::Vector6 &Vx) const override;
+};
+
+/// States, tensions and cable lengths of one simulated trajectory.
+struct CdprRollout {
+  std::vector<gtsam::Pose3> poses;     ///< end effector poses, N + 1
+  std::vector<gtsam::Vector6> twists;  ///< end effector twists, N + 1
+  std::vector<gtsam::Vector6> accels;  ///< twist accelerations, N
+  gtsam::Matrix lengths;       ///< N x n cable lengths
+  gtsam::Matrix length_rates;  ///< N x n cable length rates
+  gtsam::Matrix tensions;      ///< N x n cable tensions
+
+  /// Return the number of simulated time steps N.
+  size_t numSteps() const { return accels.size(); }
+
+  /// Return the pose at step k.
+  const gtsam::Pose3 &pose(size_t k) const { return poses.at(k); }
+
+  /// Return the twist at step k.
+  const gtsam::Vector6 &twist(size_t k) const { return twists.at(k); }
+
+  /**
+   * Return the trajectory with the keys of CdprSimulator in
+   * cdpr_planar_sim.py: end effector poses and twists, twist accelerations,
+   * cable lengths as joint angles, and their rates and tensions as joint
+   * velocities and torques, then dt at key 0. Wrenches are not included.
+   */
+  gtsam::Values values(int ee_id, double dt) const;
+};
+
+/**
+ * CdprPlanarSimulator advances a planar cable robot in time, as CdprSimulator
+ * in cdpr_planar_sim.py, with the same Euler collocation, but in closed form
+ * instead of by solving a factor graph per time step:
+ *
+ *   l_i, ldot_i      from the pose and twist, as CableLengthFactor and
+ *                    CableVelocityFactor,
+ *   t = controller(k, wTx, Vx),
+ *   A = G^-1 (W(wTx) t + gravity + coriolis), as CableTensionFactor and
+ *                    WrenchFactor, with the structure matrix W,
+ *   wTx' = wTx Exp(Vx dt),  Vx' = Vx + A dt.
+ *
+ * Out-of-plane components of the twist and acceleration, about x and z and
+ * along y, are zero, as with the planar kinematics factors of cdpr_planar.py.
+ * Rollouts of many initial states and controllers run in parallel.
+ */
+class CdprPlanarSimulator {
+ private:
+  CableTensionDistribution cables_;  // structure matrix
+  std::vector<gtsam::Point3> wPa_, xPb_;
+  double mass_;
+  gtsam::Matrix6 inertia_, inverse_inertia_;
+  gtsam::Vector3 gravity_;
+  double dt_;
+
+ public:
+  /**
+   * Constructor, defaults as CdprParams in cdpr_planar.py.
+   * @param wPa      cable mounting locations on the frame, in world
+   * @param xPb      cable mounting locations on the end effector
+   * @param mass     end effector mass
+   * @param inertia  end effector rotational inertia
+   * @param gravity  gravity, in world
+   * @param dt       time step
+   */
+  CdprPlanarSimulator(const std::vector<gtsam::Point3> &wPa,
+                      const std::vector<gtsam::Point3> &xPb,
+                      double mass = 1.0,
+                      const gtsam::Matrix3 &inertia = gtsam::I_3x3,
+                      const gtsam::Vector3 &gravity = gtsam::Vector3::Zero(),
+                      double dt = 0.01);
+
+  /// Return the number of cables.
+  size_t numCables() const { return wPa_.size(); }
+
+  /// Return the time step.
+  double dt() const { return dt_; }
+
+  /// Return the cable lengths at a pose.
+  gtsam::Vector lengths(const gtsam::Pose3 &wTx) const;
+
+  /// Return the cable length rates at a pose and twist.
+  gtsam::Vector lengthRates(const gtsam::Pose3 &wTx,
+                            const gtsam::Vector6 &Vx) const;
+
+  /// Return the twist acceleration for cable tensions.
+  gtsam::Vector6 twistAccel(const gtsam::Pose3 &wTx, const gtsam::Vector6 &Vx,
+                            const gtsam::Vector &tensions) const;
+
+  /// Simulate num_steps steps from a state with a controller.
+  CdprRollout rollout(const gtsam::Pose3 &wTx, const gtsam::Vector6 &Vx,
+                      const CdprController &controller,
+                      size_t num_steps) const;
+
+  /// Simulate the open-loop N x n tensions from a state.
+  CdprRollout rollout(const gtsam::Pose3 &wTx, const gtsam::Vector6 &Vx,
+                      const gtsam::Matrix &tensions) const;
+
+  /**
+   * Simulate each initial state with the controller of the same index, in
+   * parallel, throws std::invalid_argument unless the sizes agree.
+   */
+  std::vector<CdprRollout> rollouts(
+      const std::vector<gtsam::Pose3> &poses,
+      const std::vector<gtsam::Vector6> &twists,
+      const std::vector<std::shared_ptr<const CdprController>> &controllers,
+      size_t num_steps) const;
+
+  /// Batched rollouts of affine controllers, see above.
+  std::vector<CdprRollout> rollouts(
+      const std::vector<gtsam::Pose3> &poses,
+      const std::vector<gtsam::Vector6> &twists,
+      const std::vector<CdprAffineController> &controllers,
+      size_t num_steps) const;
+};
+
+}  // namespace gtdynamics
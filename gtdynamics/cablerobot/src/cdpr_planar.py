@@ -91,7 +91,7 @@ class Cdpr:
         fg.push_back(self.collocation_factors(ks=range(N - 1), dt=dt))
         return fg
 
-    def kinematics_factors(self, ks=[]):
+    def kinematics_factors(self, ks=[], fused=False):
         """Creates the factors necessary for kinematics, which includes the CableLengthFactors and
         CableVelocityFactors.  Since this is a planar CDPR, it also adds factors which constrain
         motion to the xz plane.
@@ -101,13 +101,24 @@ class Cdpr:
 
         Args:
             ks (list, optional): list of time step indices.
+            fused (bool, optional): one CableKinematicsFactor for all cables per time step, instead
+            of a CableLengthFactor and CableVelocityFactor per cable. Defaults to False.
 
         Returns:
             gtsam.NonlinearFactorGraph: The factors for kinematics
         """
         kfg = gtsam.NonlinearFactorGraph()
         for k in ks:
-            for ji in range(4):
+            if fused:
+                kfg.push_back(
+                    gtd.CableKinematicsFactor(
+                        gtd.PoseKey(self.ee_id(), k).key(),
+                        gtd.TwistKey(self.ee_id(), k).key(),
+                        gtsam.KeyVector([gtd.JointAngleKey(ji, k).key() for ji in range(4)]),
+                        gtsam.KeyVector([gtd.JointVelKey(ji, k).key() for ji in range(4)]),
+                        gtsam.noiseModel.Isotropic.Sigma(8, 0.001),
+                        list(self.params.a_locs), list(self.params.b_locs)))
+            for ji in range(0 if fused else 4):
                 kfg.push_back(
                     gtd.CableLengthFactor(
                         gtd.JointAngleKey(ji, k).key(),
@@ -144,7 +155,7 @@ class Cdpr:
                         self.costmodel_planar_twist), zeroV))
         return kfg
 
-    def dynamics_factors(self, ks=[]):
+    def dynamics_factors(self, ks=[], fused=False):
         """Creates factors necessary for dynamics calculations.  Specifically, consists of the
         generalized version of F=ma and calculates wrenches from cable tensions.
         Primary variables:          Torque <--> TwistAccel
@@ -154,6 +165,8 @@ class Cdpr:
 
         Args:
             ks (list, optional): Time step indices. Defaults to [].
+            fused (bool, optional): one CableTensionsFactor for all cables per time step, instead
+            of a CableTensionFactor per cable. Defaults to False.
 
         Returns:
             gtsam.NonlinearFactorGraph: The dynamics factors
@@ -168,7 +181,16 @@ class Cdpr:
                     gtd.WrenchKey(self.ee_id(), 2, k),
                     gtd.WrenchKey(self.ee_id(), 3, k)
                 ], k, self.params.gravity))
-            for ji in range(4):
+            if fused:
+                dfg.push_back(
+                    gtd.CableTensionsFactor(
+                        gtd.PoseKey(self.ee_id(), k).key(),
+                        gtsam.KeyVector([gtd.TorqueKey(ji, k).key() for ji in range(4)]),
+                        gtsam.KeyVector(
+                            [gtd.WrenchKey(self.ee_id(), ji, k).key() for ji in range(4)]),
+                        gtsam.noiseModel.Isotropic.Sigma(24, 0.001),
+                        list(self.params.a_locs), list(self.params.b_locs)))
+            for ji in range(0 if fused else 4):
                 dfg.push_back(
                     gtd.CableTensionFactor(
                         gtd.TorqueKey(ji, k).key(),
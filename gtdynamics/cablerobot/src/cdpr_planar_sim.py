@@ -14,6 +14,22 @@ import gtsam
 import gtdynamics as gtd
 import numpy as np
 
+def native_simulator(cdpr, dt=0.01):
+    """Creates the native simulator of a cable robot, e.g. for batched rollouts of many
+    controllers and initial states with `rollouts`.
+
+    Args:
+        cdpr (Cdpr): cable robot object
+        dt (float, optional): time step duration. Defaults to 0.01.
+
+    Returns:
+        gtd.CdprPlanarSimulator: the simulator
+    """
+    params = cdpr.params
+    return gtd.CdprPlanarSimulator(list(params.a_locs), list(params.b_locs),
+                                   params.mass, params.inertia,
+                                   np.reshape(params.gravity, 3), dt)
+
 class CdprSimulator:
     """Simulates a cable robot forward in time, given a robot, initial state, and controller.
 
@@ -163,6 +179,22 @@ class CdprSimulator:
             self.step(verbose=verbose)
         return self.x
 
+    def run_native(self, torques):
+        """Runs the simulation for open-loop torques with the native CdprPlanarSimulator, in
+        closed form instead of solving a factor graph per time step.
+
+        Args:
+            torques (np.ndarray): N x 4 cable tensions, one row per time step.
+
+        Returns:
+            gtsam.Values: The poses, twists, twist accelerations, cable lengths and rates, and
+            torques of all time steps, with the same keys as `run`, except for the wrenches.
+        """
+        ee_id = self.cdpr.ee_id()
+        rollout = native_simulator(self.cdpr, self.dt).rollout(
+            gtd.Pose(self.x0, ee_id, 0), gtd.Twist(self.x0, ee_id, 0), torques)
+        return rollout.values(ee_id, self.dt)
+
     def reset(self):
         self.fg = gtsam.NonlinearFactorGraph()
         self.x = gtsam.Values(self.x0)
@@ -57,5 +57,34 @@ class TestCdprPlanar(GtsamTestCase):
             x += xdot * dt
             xdot += xddot * dt
 
+    def testSimNative(self):
+        """Tests that the native simulator gives the trajectory of the factor graph one
+        """
+        class OpenLoopController(CdprControllerBase):
+            def __init__(self, torques):
+                self.torques = torques
+            def update(self, values, k):
+                tau = gtsam.Values()
+                for ji in range(4):
+                    gtd.InsertTorque(tau, ji, k, self.torques[k, ji])
+                return tau
+        N, dt = 10, 0.1
+        torques = np.zeros((N, 4))
+        torques[:, 0] = 1.
+        torques[:, 1] = np.linspace(0.5, 1., N)
+        cdpr = Cdpr()
+        xInit = gtsam.Values()
+        gtd.InsertPose(xInit, cdpr.ee_id(), 0, Pose3(Rot3(), (1.5, 0, 1.5)))
+        gtd.InsertTwist(xInit, cdpr.ee_id(), 0, np.zeros(6))
+        sim = CdprSimulator(cdpr, xInit, OpenLoopController(torques), dt=dt)
+        expected = sim.run(N=N)
+        actual = sim.run_native(torques)
+        for k in range(N):
+            self.gtsamAssertEquals(gtd.Pose(expected, cdpr.ee_id(), k),
+                                   gtd.Pose(actual, cdpr.ee_id(), k), tol=1e-9)
+            for ji in range(4):
+                self.assertAlmostEqual(gtd.JointAngle(expected, ji, k),
+                                       gtd.JointAngle(actual, ji, k), places=6)
+
 if __name__ == "__main__":
     unittest.main()
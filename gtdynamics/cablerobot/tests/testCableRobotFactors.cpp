@@ -0,0 +1,123 @@
+/**
+ * @file  testCableRobotFactors.cpp
+ * @brief test the factors on all cables of an end effector
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/factors/CableLengthFactor.h>
+#include <gtdynamics/cablerobot/factors/CableRobotFactors.h>
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/cablerobot/factors/CableVelocityFactor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+namespace example {
+// Mounting locations of CdprParams in cdpr_planar.py.
+const double s = 0.15;
+const vector<Point3> wPa{Point3(3, 0, 0), Point3(3, 0, 3), Point3(0, 0, 3),
+                         Point3(0, 0, 0)};
+const vector<Point3> xPb{Point3(s, 0, -s), Point3(s, 0, s), Point3(-s, 0, s),
+                         Point3(-s, 0, -s)};
+const int ee = 1, k = 3;
+
+// Values off the solution, with an out-of-plane rotation.
+Values ExampleValues() {
+  Values values;
+  InsertPose(&values, ee, k,
+             Pose3(Rot3::RzRyRx(0.1, 0.3, -0.2), Point3(1.2, 0.1, 1.7)));
+  InsertTwist(&values, ee, k,
+              (Vector6() << 0.1, 0.4, -0.2, 0.2, 0.1, -0.3).finished());
+  for (int j = 0; j < 4; j++) {
+    InsertJointAngle(&values, j, k, 1.5 + 0.1 * j);
+    InsertJointVel(&values, j, k, 0.2 - 0.1 * j);
+    InsertTorque(&values, j, k, 1 + j);
+    InsertWrench(&values, ee, j, k, Vector6::Constant(0.1 * j));
+  }
+  return values;
+}
+}  // namespace example
+
+/**
+ * The fused kinematics factor is the length and velocity factors of all
+ * cables, with correct Jacobians
+ */
+TEST(CableKinematicsFactor, error) {
+  using namespace example;
+  KeyVector l_keys, ldot_keys;
+  NonlinearFactorGraph separate;
+  auto model1 = noiseModel::Isotropic::Sigma(1, 0.001);
+  for (int j = 0; j < 4; j++) {
+    l_keys.push_back(JointAngleKey(j, k));
+    ldot_keys.push_back(JointVelKey(j, k));
+    separate.emplace_shared<CableLengthFactor>(
+        l_keys.back(), PoseKey(ee, k), model1, wPa[j], xPb[j]);
+  }
+  for (int j = 0; j < 4; j++) {
+    separate.emplace_shared<CableVelocityFactor>(
+        ldot_keys[j], PoseKey(ee, k), TwistKey(ee, k), model1,
+        wPa[j], xPb[j]);
+  }
+  const CableKinematicsFactor factor(
+      PoseKey(ee, k), TwistKey(ee, k), l_keys, ldot_keys,
+      noiseModel::Isotropic::Sigma(8, 0.001), wPa, xPb);
+  EXPECT_LONGS_EQUAL(10, factor.size());
+
+  const Values values = ExampleValues();
+  EXPECT_DOUBLES_EQUAL(separate.error(values), factor.error(values), 1e-9);
+  Vector expected(8);
+  for (size_t i = 0; i < 8; i++) {
+    expected(i) = boost::dynamic_pointer_cast<NoiseModelFactor>(separate[i])
+                      ->unwhitenedError(values)(0);
+  }
+  EXPECT(assert_equal(expected, factor.unwhitenedError(values), 1e-12));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  THROWS_EXCEPTION(CableKinematicsFactor(
+      PoseKey(ee, k), TwistKey(ee, k), l_keys, ldot_keys,
+      noiseModel::Isotropic::Sigma(4, 0.001), wPa, xPb));
+}
+
+/**
+ * The fused tension factor is the tension factors of all cables, with
+ * correct Jacobians
+ */
+TEST(CableTensionsFactor, error) {
+  using namespace example;
+  KeyVector tension_keys, wrench_keys;
+  NonlinearFactorGraph separate;
+  auto model6 = noiseModel::Isotropic::Sigma(6, 0.001);
+  for (int j = 0; j < 4; j++) {
+    tension_keys.push_back(TorqueKey(j, k));
+    wrench_keys.push_back(WrenchKey(ee, j, k));
+    separate.emplace_shared<CableTensionFactor>(
+        tension_keys.back(), PoseKey(ee, k), wrench_keys.back(), model6,
+        wPa[j], xPb[j]);
+  }
+  const CableTensionsFactor factor(PoseKey(ee, k), tension_keys, wrench_keys,
+                                   noiseModel::Isotropic::Sigma(24, 0.001),
+                                   wPa, xPb);
+  EXPECT_LONGS_EQUAL(9, factor.size());
+
+  const Values values = ExampleValues();
+  EXPECT_DOUBLES_EQUAL(separate.error(values), factor.error(values), 1e-9);
+  Vector expected(24);
+  for (size_t i = 0; i < 4; i++) {
+    expected.segment<6>(6 * i) =
+        boost::dynamic_pointer_cast<NoiseModelFactor>(separate[i])
+            ->unwhitenedError(values);
+  }
+  EXPECT(assert_equal(expected, factor.unwhitenedError(values), 1e-12));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file  testCableTensionDistribution.cpp
+ * @brief test the cable robot tension distribution
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/controller/CableTensionDistribution.h>
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+namespace example {
+// Mounting locations of CdprParams in cdpr_planar.py.
+const double s = 0.15;
+const vector<Point3> wPa{Point3(3, 0, 0), Point3(3, 0, 3), Point3(0, 0, 3),
+                         Point3(0, 0, 0)};
+const vector<Point3> xPb{Point3(s, 0, -s), Point3(s, 0, s), Point3(-s, 0, s),
+                         Point3(-s, 0, -s)};
+}  // namespace example
+
+/**
+ * Test the active set solver on small problems
+ */
+TEST(NonNegativeLeastSquares, solve) {
+  size_t iterations;
+  Vector x = NonNegativeLeastSquares(I_2x2, Vector2(1, -1), 100, &iterations);
+  EXPECT(assert_equal(Vector2(1, 0), x, 1e-12));
+  EXPECT_LONGS_EQUAL(1, iterations);
+
+  // The unconstrained solution (2, -1) is infeasible.
+  const Matrix A = (Matrix(3, 2) << 1, 1, 0, 1, 1, 0).finished();
+  x = NonNegativeLeastSquares(A, A * Vector2(2, -1));
+  EXPECT(assert_equal(Vector2(1.5, 0), x, 1e-12));
+
+  THROWS_EXCEPTION(NonNegativeLeastSquares(A, Vector2(1, 1)));
+}
+
+/**
+ * The structure matrix has the wrenches of CableTensionFactor
+ */
+TEST(CableTensionDistribution, structureMatrix) {
+  CableTensionDistribution distribution(example::wPa, example::xPb);
+  EXPECT_LONGS_EQUAL(4, distribution.numCables());
+  const Pose3 wTx(Rot3::Ry(0.3), Point3(1.4, 0, 1.7));
+  const Matrix W = distribution.structureMatrix(wTx);
+  for (size_t i = 0; i < 4; i++) {
+    CableTensionFactor factor(TorqueKey(i), PoseKey(0), WrenchKey(0, i),
+                              noiseModel::Isotropic::Sigma(6, 1.0),
+                              example::wPa[i], example::xPb[i]);
+    Vector6 expected = -factor.evaluateError(1.0, wTx, Vector6::Zero());
+    EXPECT(assert_equal(expected, Vector6(W.col(i)), 1e-9));
+  }
+}
+
+/**
+ * The tensions hold the end effector against a vertical force
+ */
+TEST(CableTensionDistribution, solve) {
+  const Pose3 wTx(Rot3(), Point3(1.5, 0, 1.5));
+  const Vector6 Fx = (Vector6() << 0, 0, 0, 0, 0, 10).finished();
+
+  // Only the upper cables pull.
+  CableTensionDistribution slack(example::wPa, example::xPb);
+  Vector t = slack.solve(wTx, Fx);
+  const double t_up = 10 / sqrt(2);
+  EXPECT(assert_equal(Vector4(0, t_up, t_up, 0), t, 1e-4));
+
+  // With a lower bound, the lower cables are at the bound and the upper
+  // cables balance them.
+  CableTensionDistribution taut(example::wPa, example::xPb, 1.0);
+  size_t iterations;
+  t = taut.solve(wTx, Fx, Vector(), &iterations);
+  EXPECT(assert_equal(Vector4(1, t_up + 1, t_up + 1, 1), t, 1e-4));
+  EXPECT(assert_equal(Fx, Vector6(taut.structureMatrix(wTx) * t), 1e-4));
+  EXPECT(iterations < 100);
+
+  // Among the tensions that produce the wrench, the preferred ones.
+  const Vector4 t_ref(3, t_up + 2, t_up + 3, 2);
+  EXPECT(assert_equal(t_ref, taut.solve(wTx, Fx, t_ref), 1e-4));
+
+  THROWS_EXCEPTION(taut.solve(wTx, Fx, Vector2(1, 1)));
+  THROWS_EXCEPTION(CableTensionDistribution({Point3()}, example::xPb));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
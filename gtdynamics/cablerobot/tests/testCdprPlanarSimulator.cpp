@@ -0,0 +1,131 @@
+/**
+ * @file  testCdprPlanarSimulator.cpp
+ * @brief test the native planar cable robot simulator
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/cablerobot/factors/CableLengthFactor.h>
+#include <gtdynamics/cablerobot/factors/CableVelocityFactor.h>
+#include <gtdynamics/cablerobot/simulator/CdprPlanarSimulator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+namespace example {
+// Mounting locations of CdprParams in cdpr_planar.py.
+const double s = 0.15;
+const vector<Point3> wPa{Point3(3, 0, 0), Point3(3, 0, 3), Point3(0, 0, 3),
+                         Point3(0, 0, 0)};
+const vector<Point3> xPb{Point3(s, 0, -s), Point3(s, 0, s), Point3(-s, 0, s),
+                         Point3(-s, 0, -s)};
+const Pose3 wTx0(Rot3(), Point3(1.5, 0, 1.5));
+}  // namespace example
+
+/**
+ * Cable lengths and rates are those of the kinematics factors
+ */
+TEST(CdprPlanarSimulator, kinematics) {
+  const CdprPlanarSimulator sim(example::wPa, example::xPb);
+  const Pose3 wTx(Rot3::Ry(0.3), Point3(1.2, 0, 1.7));
+  const Vector6 Vx = (Vector6() << 0, 0.4, 0, 0.2, 0, -0.3).finished();
+  const Vector l = sim.lengths(wTx), ldot = sim.lengthRates(wTx, Vx);
+  auto model = noiseModel::Unit::Create(1);
+  for (size_t i = 0; i < 4; i++) {
+    const CableLengthFactor length(0, 1, model, example::wPa[i],
+                                   example::xPb[i]);
+    EXPECT(assert_equal(Vector1::Zero(), length.evaluateError(l(i), wTx),
+                        1e-12));
+    const CableVelocityFactor velocity(0, 1, 2, model, example::wPa[i],
+                                       example::xPb[i]);
+    EXPECT(assert_equal(Vector1::Zero(),
+                        velocity.evaluateError(ldot(i), wTx, Vx), 1e-12));
+  }
+}
+
+/**
+ * Same trajectory as testSim in test_cdpr_planar_sim.py
+ */
+TEST(CdprPlanarSimulator, rollout) {
+  const double dt = 0.1;
+  const CdprPlanarSimulator sim(example::wPa, example::xPb, 1.0, I_3x3,
+                                Vector3::Zero(), dt);
+  Matrix tensions = Matrix::Zero(10, 4);
+  tensions.leftCols<2>().setOnes();
+  const CdprRollout rollout =
+      sim.rollout(example::wTx0, Vector6::Zero(), tensions);
+  EXPECT_LONGS_EQUAL(10, rollout.numSteps());
+
+  double x = 1.5, xdot = 0;
+  for (size_t k = 0; k < 10; k++) {
+    EXPECT(assert_equal(Pose3(Rot3(), Point3(x, 0, 1.5)), rollout.pose(k),
+                        1e-12));
+    const double dx = 3 - x - 0.15, dy = 1.35;  // cable vector
+    const double xddot = 2 * dx / std::sqrt(dx * dx + dy * dy);
+    x += xdot * dt;
+    xdot += xddot * dt;
+  }
+
+  // Values with the keys of CdprSimulator.
+  const Values values = rollout.values(1, dt);
+  EXPECT(assert_equal(rollout.pose(3), Pose(values, 1, 3)));
+  EXPECT_DOUBLES_EQUAL(1.0, Torque(values, 1, 9), 0);
+  EXPECT_DOUBLES_EQUAL(rollout.lengths(2, 0), JointAngle(values, 0, 2), 0);
+  EXPECT_DOUBLES_EQUAL(dt, values.atDouble(0), 0);
+}
+
+/**
+ * Batched rollouts agree with single ones, and feedback tracks a reference
+ */
+TEST(CdprPlanarSimulator, rollouts) {
+  const CdprPlanarSimulator sim(example::wPa, example::xPb);
+  const size_t N = 50;
+  const Matrix feedforward = Matrix::Constant(N, 4, 2.0);
+
+  // Hold the center against an offset start, with proportional-derivative
+  // gains on the planar translation of the position and velocity error.
+  const vector<Pose3> reference(N, example::wTx0);
+  const vector<Vector6> zero_twists(N, Vector6::Zero());
+  Matrix gain = Matrix::Zero(4, 12);
+  const CableTensionDistribution cables(example::wPa, example::xPb);
+  const Matrix W = cables.structureMatrix(example::wTx0);
+  const Matrix Wpinv = W.completeOrthogonalDecomposition().pseudoInverse();
+  gain.leftCols<6>() = -20 * Wpinv;
+  gain.rightCols<6>() = -8 * Wpinv;
+  const vector<CdprAffineController> controllers{
+      CdprAffineController(feedforward),
+      CdprAffineController(feedforward, reference, zero_twists, gain)};
+
+  const Pose3 offset(Rot3(), Point3(1.3, 0, 1.4));
+  const vector<Pose3> poses{offset, offset};
+  const vector<Vector6> twists(2, Vector6::Zero());
+  const vector<CdprRollout> rollouts =
+      sim.rollouts(poses, twists, controllers, N);
+  EXPECT_LONGS_EQUAL(2, rollouts.size());
+  const CdprRollout open_loop = sim.rollout(offset, Vector6::Zero(),
+                                            feedforward);
+  EXPECT(assert_equal(open_loop.tensions, rollouts[0].tensions));
+  EXPECT(assert_equal(open_loop.pose(N), rollouts[0].pose(N)));
+
+  // Feedback moves the end effector towards the center.
+  const double start = (offset.translation() - example::wTx0.translation())
+                           .norm();
+  const double end = (rollouts[1].pose(N).translation() -
+                      example::wTx0.translation())
+                         .norm();
+  EXPECT(end < 0.5 * start);
+
+  const vector<CdprAffineController> one{controllers[0]};
+  THROWS_EXCEPTION(sim.rollouts(poses, twists, one, N));
+  THROWS_EXCEPTION(sim.rollout(offset, Vector6::Zero(), controllers[0], N + 1));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
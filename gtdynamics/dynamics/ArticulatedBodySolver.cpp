@@ -0,0 +1,450 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ArticulatedBodySolver.cpp
+ * @brief Recursive O(n) forward and inverse dynamics for tree robots.
+ */
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/utils/values.h>
+
+#include <iostream>
+#include <map>
+#include <queue>
+#include <stdexcept>
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ArticulatedBodySolver::ArticulatedBodySolver(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis)
+    : links_(robot.links()), joints_(robot.joints()), gravity_(gravity) {
+  if (links_.empty()) {
+    throw std::invalid_argument("ArticulatedBodySolver: robot has no links.");
+  }
+
+  std::map<const Link *, size_t> link_index;
+  for (size_t i = 0; i < links_.size(); i++) link_index[links_[i].get()] = i;
+  std::map<const Joint *, size_t> joint_index;
+  for (size_t j = 0; j < joints_.size(); j++) {
+    joint_index[joints_[j].get()] = j;
+  }
+
+  // Root is the fixed link if any, otherwise the lowest-id link.
+  root_index_ = 0;
+  size_t num_fixed = 0;
+  for (size_t i = 0; i < links_.size(); i++) {
+    if (robot.isFixed(links_[i])) {
+      root_index_ = i;
+      num_fixed++;
+    } else if (num_fixed == 0 && links_[i]->id() < links_[root_index_]->id()) {
+      root_index_ = i;
+    }
+  }
+  if (num_fixed > 1) {
+    throw std::invalid_argument(
+        "ArticulatedBodySolver: robots with more than one fixed link are not "
+        "supported.");
+  }
+  root_fixed_ = num_fixed == 1;
+  if (root_fixed_) root_fixed_pose_ = robot.fixedPose(links_[root_index_]);
+
+  // BFS from the root to record joints in parent-to-child order.
+  std::vector<bool> link_visited(links_.size(), false);
+  std::vector<bool> joint_visited(joints_.size(), false);
+  std::queue<size_t> queue;
+  queue.push(root_index_);
+  link_visited[root_index_] = true;
+  while (!queue.empty()) {
+    const size_t p = queue.front();
+    queue.pop();
+    for (auto &&joint : links_[p]->joints()) {
+      const size_t j = joint_index.at(joint.get());
+      if (joint_visited[j]) continue;
+      joint_visited[j] = true;
+
+      const LinkSharedPtr child = joint->otherLink(links_[p]);
+      const size_t c = link_index.at(child.get());
+      if (link_visited[c]) {
+        throw std::invalid_argument(
+            "ArticulatedBodySolver: kinematic loop detected at joint " +
+            joint->name() + ", only trees are supported.");
+      }
+      link_visited[c] = true;
+
+      TreeJoint tree_joint;
+      tree_joint.joint = joint;
+      tree_joint.kernel = JointKernel(*joint);
+      tree_joint.joint_index = j;
+      tree_joint.parent_index = p;
+      tree_joint.child_index = c;
+      tree_joint.aligned = (joint->child() == child);
+      tree_joint.S = joint->screwAxis(child);
+      tree_.push_back(tree_joint);
+      queue.push(c);
+    }
+  }
+
+  for (size_t i = 0; i < links_.size(); i++) {
+    if (!link_visited[i]) {
+      throw std::invalid_argument("ArticulatedBodySolver: link " +
+                                  links_[i]->name() +
+                                  " is not connected to the root link.");
+    }
+  }
+}
+
+/* ************************************************************************* */
+Vector6 ArticulatedBodySolver::gravityWrench(size_t i,
+                                             const Pose3 &wTi) const {
+  Vector6 wrench = Vector6::Zero();
+  if (gravity_) {
+    wrench.tail<3>() =
+        wTi.rotation().transpose() * (*gravity_) * links_[i]->mass();
+  }
+  return wrench;
+}
+
+/* ************************************************************************* */
+void ArticulatedBodySolver::forwardKinematicsPass(
+    const Vector &q, const Vector &v, const Pose3 &wTroot,
+    const Vector6 &V_root, TreeDynamicsResult *result,
+    TreeDynamicsWorkspace *workspace) const {
+  const size_t n = links_.size(), m = joints_.size();
+  if (size_t(q.size()) != m || size_t(v.size()) != m) {
+    throw std::invalid_argument(
+        "ArticulatedBodySolver: joint vectors have the wrong size.");
+  }
+
+  result->poses.resize(n);
+  result->twists.resize(n);
+  result->twist_accels.resize(n);
+  result->parent_wrenches.resize(m);
+  result->child_wrenches.resize(m);
+  result->joint_accels.resize(m);
+  result->torques.resize(m);
+  workspace->iTparent.resize(n);
+  workspace->bias_accels.assign(n, Vector6::Zero());
+
+  if (root_fixed_) {
+    result->poses[root_index_] = root_fixed_pose_;
+    result->twists[root_index_].setZero();
+  } else {
+    result->poses[root_index_] = wTroot;
+    result->twists[root_index_] = V_root;
+  }
+
+  for (const TreeJoint &tj : tree_) {
+    const size_t p = tj.parent_index, c = tj.child_index;
+    const double q_j = q(tj.joint_index), v_j = v(tj.joint_index);
+
+    // Pose of the tree parent expressed in the tree child frame.
+    const Pose3 cTp = tj.aligned ? tj.kernel.childTparent(q_j)
+                                 : tj.kernel.parentTchild(q_j);
+    workspace->iTparent[c] = cTp;
+    result->poses[c] = result->poses[p] * cTp.inverse();
+
+    // V_c = Ad(cTp) * V_p + S_c * v_j
+    const Vector6 joint_twist = tj.S * v_j;
+    result->twists[c] = cTp.Adjoint(result->twists[p]) + joint_twist;
+
+    // Velocity-product acceleration, ad(V_c) * S_c * v_j.
+    workspace->bias_accels[c] =
+        Pose3::adjointMap(result->twists[c]) * joint_twist;
+  }
+}
+
+/* ************************************************************************* */
+void ArticulatedBodySolver::forwardDynamics(const Vector &q, const Vector &v,
+                                            const Vector &tau,
+                                            const Pose3 &wTroot,
+                                            const Vector6 &V_root,
+                                            TreeDynamicsResult *result) const {
+  TreeDynamicsWorkspace workspace;
+  forwardDynamics(q, v, tau, wTroot, V_root, result, &workspace);
+}
+
+/* ************************************************************************* */
+void ArticulatedBodySolver::forwardDynamics(
+    const Vector &q, const Vector &v, const Vector &tau, const Pose3 &wTroot,
+    const Vector6 &V_root, TreeDynamicsResult *result,
+    TreeDynamicsWorkspace *workspace,
+    const std::vector<Vector6> *external_wrenches) const {
+  if (size_t(tau.size()) != joints_.size()) {
+    throw std::invalid_argument(
+        "ArticulatedBodySolver: torque vector has the wrong size.");
+  }
+  if (external_wrenches && external_wrenches->size() != links_.size()) {
+    throw std::invalid_argument(
+        "ArticulatedBodySolver: external wrenches have the wrong size.");
+  }
+
+  forwardKinematicsPass(q, v, wTroot, V_root, result, workspace);
+  const std::vector<Pose3> &cTp = workspace->iTparent;
+  const std::vector<Vector6> &c_bias = workspace->bias_accels;
+
+  // Initialize articulated inertias and bias wrenches with the rigid body
+  // ones, such that the wrench exerted by the joints is F = I^A * A + p^A.
+  const size_t n = links_.size(), m = joints_.size();
+  std::vector<Matrix6> &IA = workspace->IA;
+  std::vector<Vector6> &pA = workspace->pA;
+  IA.resize(n);
+  pA.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    const Matrix6 G_i = links_[i]->inertiaMatrix();
+    const Vector6 &V_i = result->twists[i];
+    IA[i] = G_i;
+    pA[i] = -Pose3::adjointMap(V_i).transpose() * G_i * V_i -
+            gravityWrench(i, result->poses[i]);
+    if (external_wrenches) pA[i] -= (*external_wrenches)[i];
+  }
+
+  // Backward pass: accumulate articulated inertias towards the root.
+  std::vector<Vector6> &U = workspace->U;
+  std::vector<double> &D = workspace->D, &u = workspace->u;
+  U.resize(m);
+  D.assign(m, 0.0);
+  u.assign(m, 0.0);
+  for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+    const size_t c = it->child_index, p = it->parent_index,
+                 j = it->joint_index;
+    const Vector6 &S = it->S;
+    Matrix6 Ia = IA[c];
+    Vector6 pa = pA[c];
+    if (!S.isZero()) {
+      U[j] = IA[c] * S;
+      D[j] = S.dot(U[j]);
+      if (D[j] <= 1e-12) {
+        throw std::runtime_error(
+            "ArticulatedBodySolver: singular articulated inertia at joint " +
+            it->joint->name());
+      }
+      u[j] = tau(j) - S.dot(pA[c]);
+      Ia -= U[j] * U[j].transpose() / D[j];
+      pa += Ia * c_bias[c] + U[j] * u[j] / D[j];
+    } else {
+      pa += Ia * c_bias[c];
+    }
+    const Matrix6 Ad = cTp[c].AdjointMap();
+    IA[p] += Ad.transpose() * Ia * Ad;
+    pA[p] += Ad.transpose() * pa;
+  }
+
+  // Root acceleration: zero for a fixed base, no joint wrench when floating.
+  auto &A = result->twist_accels;
+  if (root_fixed_) {
+    A[root_index_].setZero();
+  } else {
+    A[root_index_] = -IA[root_index_].ldlt().solve(pA[root_index_]);
+  }
+
+  // Forward pass: joint accelerations, twist accelerations and wrenches.
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index, p = tj.parent_index, j = tj.joint_index;
+    const Matrix6 Ad = cTp[c].AdjointMap();
+    const Vector6 A_prime = Ad * A[p] + c_bias[c];
+    const double a_j = (D[j] > 0) ? (u[j] - U[j].dot(A_prime)) / D[j] : 0.0;
+    A[c] = A_prime + tj.S * a_j;
+
+    // Wrench on the tree child, and its equivalent on the tree parent.
+    const Vector6 F_c = IA[c] * A[c] + pA[c];
+    const Vector6 F_p = -Ad.transpose() * F_c;
+    result->child_wrenches[j] = tj.aligned ? F_c : F_p;
+    result->parent_wrenches[j] = tj.aligned ? F_p : F_c;
+    result->joint_accels(j) = a_j;
+    result->torques(j) = tau(j);
+  }
+}
+
+/* ************************************************************************* */
+TreeDynamicsResult ArticulatedBodySolver::forwardDynamics(
+    const Vector &q, const Vector &v, const Vector &tau) const {
+  TreeDynamicsResult result;
+  forwardDynamics(q, v, tau, Pose3(), Vector6::Zero(), &result);
+  return result;
+}
+
+/* ************************************************************************* */
+void ArticulatedBodySolver::inverseDynamics(const Vector &q, const Vector &v,
+                                            const Vector &a,
+                                            const Pose3 &wTroot,
+                                            const Vector6 &V_root,
+                                            TreeDynamicsResult *result) const {
+  if (size_t(a.size()) != joints_.size()) {
+    throw std::invalid_argument(
+        "ArticulatedBodySolver: acceleration vector has the wrong size.");
+  }
+
+  TreeDynamicsWorkspace workspace;
+  forwardKinematicsPass(q, v, wTroot, V_root, result, &workspace);
+  const std::vector<Pose3> &cTp = workspace.iTparent;
+  const std::vector<Vector6> &c_bias = workspace.bias_accels;
+
+  // Forward pass with zero root acceleration.
+  auto &A = result->twist_accels;
+  A[root_index_].setZero();
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index, j = tj.joint_index;
+    A[c] = cTp[c].Adjoint(A[tj.parent_index]) + tj.S * a(j) + c_bias[c];
+  }
+
+  // Backward pass: F holds the wrench exerted by the joint on each tree child,
+  // IC the composite inertia of the subtree rooted at each link.
+  const size_t n = links_.size();
+  std::vector<Vector6> F(n);
+  std::vector<Matrix6> IC(n);
+  for (size_t i = 0; i < n; i++) {
+    const Matrix6 G_i = links_[i]->inertiaMatrix();
+    const Vector6 &V_i = result->twists[i];
+    IC[i] = G_i;
+    F[i] = G_i * A[i] - Pose3::adjointMap(V_i).transpose() * G_i * V_i -
+           gravityWrench(i, result->poses[i]);
+  }
+  for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+    const size_t c = it->child_index, p = it->parent_index;
+    const Matrix6 Ad = cTp[c].AdjointMap();
+    F[p] += Ad.transpose() * F[c];
+    if (!root_fixed_) IC[p] += Ad.transpose() * IC[c] * Ad;
+  }
+
+  // A floating root has no joint wrench: solve for the root acceleration and
+  // propagate the correction, which is linear in the root acceleration.
+  if (!root_fixed_) {
+    std::vector<Vector6> dA(n);
+    dA[root_index_] = -IC[root_index_].ldlt().solve(F[root_index_]);
+    A[root_index_] = dA[root_index_];
+    for (const TreeJoint &tj : tree_) {
+      const size_t c = tj.child_index;
+      dA[c] = cTp[c].Adjoint(dA[tj.parent_index]);
+      A[c] += dA[c];
+      F[c] += IC[c] * dA[c];
+    }
+  }
+
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index, j = tj.joint_index;
+    const Vector6 F_p = -cTp[c].AdjointMap().transpose() * F[c];
+    result->child_wrenches[j] = tj.aligned ? F[c] : F_p;
+    result->parent_wrenches[j] = tj.aligned ? F_p : F[c];
+    result->joint_accels(j) = a(j);
+    result->torques(j) = tj.S.dot(F[c]);
+  }
+}
+
+/* ************************************************************************* */
+TreeDynamicsResult ArticulatedBodySolver::inverseDynamics(
+    const Vector &q, const Vector &v, const Vector &a) const {
+  TreeDynamicsResult result;
+  inverseDynamics(q, v, a, Pose3(), Vector6::Zero(), &result);
+  return result;
+}
+
+/* ************************************************************************* */
+Pose3 ArticulatedBodySolver::rootPose(const gtsam::Values &values,
+                                      int t) const {
+  const LinkSharedPtr &root_link = root();
+  if (root_fixed_) return root_fixed_pose_;
+  const auto key = PoseKey(root_link->id(), t);
+  return values.exists(key) ? values.at<Pose3>(key) : Pose3();
+}
+
+/* ************************************************************************* */
+Vector6 ArticulatedBodySolver::rootTwist(const gtsam::Values &values,
+                                         int t) const {
+  const LinkSharedPtr &root_link = root();
+  if (root_fixed_) return Vector6::Zero();
+  const auto key = TwistKey(root_link->id(), t);
+  return values.exists(key) ? values.at<Vector6>(key) : Vector6(Vector6::Zero());
+}
+
+/* ************************************************************************* */
+gtsam::Values ArticulatedBodySolver::solveFD(const gtsam::Values &known_values,
+                                             int t) const {
+  const size_t m = joints_.size();
+  Vector q(m), v(m), tau(m);
+  for (size_t j = 0; j < m; j++) {
+    const int id = joints_[j]->id();
+    q(j) = JointAngle(known_values, id, t);
+    v(j) = JointVel(known_values, id, t);
+    tau(j) = Torque(known_values, id, t);
+  }
+
+  TreeDynamicsResult result;
+  forwardDynamics(q, v, tau, rootPose(known_values, t),
+                  rootTwist(known_values, t), &result);
+
+  gtsam::Values values = known_values;
+  insertResult(result, t, &values, false, true);
+  return values;
+}
+
+/* ************************************************************************* */
+gtsam::Values ArticulatedBodySolver::solveID(const gtsam::Values &known_values,
+                                             int t) const {
+  const size_t m = joints_.size();
+  Vector q(m), v(m), a(m);
+  for (size_t j = 0; j < m; j++) {
+    const int id = joints_[j]->id();
+    q(j) = JointAngle(known_values, id, t);
+    v(j) = JointVel(known_values, id, t);
+    a(j) = JointAccel(known_values, id, t);
+  }
+
+  TreeDynamicsResult result;
+  inverseDynamics(q, v, a, rootPose(known_values, t),
+                  rootTwist(known_values, t), &result);
+
+  gtsam::Values values = known_values;
+  insertResult(result, t, &values, true, false);
+  return values;
+}
+
+/* ************************************************************************* */
+void ArticulatedBodySolver::insertResult(const TreeDynamicsResult &result,
+                                         int t, gtsam::Values *values,
+                                         bool torques, bool accels) const {
+  // Kinematics are only added when not already present.
+  for (size_t i = 0; i < links_.size(); i++) {
+    const int id = links_[i]->id();
+    if (!values->exists(PoseKey(id, t))) {
+      InsertPose(values, id, t, result.poses[i]);
+    }
+    if (!values->exists(TwistKey(id, t))) {
+      InsertTwist(values, id, t, result.twists[i]);
+    }
+  }
+
+  try {
+    for (size_t j = 0; j < joints_.size(); j++) {
+      const auto &joint = joints_[j];
+      const int id = joint->id();
+      if (accels) InsertJointAccel(values, id, t, result.joint_accels(j));
+      if (torques) InsertTorque(values, id, t, result.torques(j));
+      InsertWrench(values, joint->parent()->id(), id, t,
+                   result.parent_wrenches[j]);
+      InsertWrench(values, joint->child()->id(), id, t,
+                   result.child_wrenches[j]);
+    }
+    for (size_t i = 0; i < links_.size(); i++) {
+      InsertTwistAccel(values, links_[i]->id(), t, result.twist_accels[i]);
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "ArticulatedBodySolver: known_values should contain no wrenches, "
+        "twist accelerations, or the quantities being solved for.");
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,226 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ArticulatedBodySolver.h
+ * @brief Recursive O(n) forward and inverse dynamics for tree robots.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/JointKernel.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * All quantities of a single time slice computed by the recursive solvers.
+ *
+ * Link quantities are indexed by position in `robot.links()`, joint quantities
+ * by position in `robot.joints()`, i.e., the same ordering used by
+ * `DynamicsGraph::jointAngles` and friends. All link quantities are expressed
+ * in the link CoM frame.
+ */
+struct TreeDynamicsResult {
+  std::vector<gtsam::Pose3> poses;            ///< wTcom of each link.
+  std::vector<gtsam::Vector6> twists;         ///< V_i of each link.
+  std::vector<gtsam::Vector6> twist_accels;   ///< A_i of each link.
+  std::vector<gtsam::Vector6> parent_wrenches;  ///< F on joint->parent().
+  std::vector<gtsam::Vector6> child_wrenches;   ///< F on joint->child().
+  gtsam::Vector joint_accels;                 ///< Joint accelerations.
+  gtsam::Vector torques;                      ///< Joint torques.
+};
+
+/**
+ * Scratch buffers of the recursions. Passing the same workspace to repeated
+ * calls avoids all heap allocations once the buffers have been sized.
+ */
+struct TreeDynamicsWorkspace {
+  std::vector<gtsam::Pose3> iTparent;       ///< tree parent pose in link frame
+  std::vector<gtsam::Vector6> bias_accels;  ///< velocity-product accels
+  std::vector<gtsam::Matrix6> IA;           ///< articulated inertias
+  std::vector<gtsam::Vector6> pA;           ///< articulated bias wrenches
+  std::vector<gtsam::Vector6> U;            ///< I^A * S per joint
+  std::vector<double> D, u;                 ///< S^T * U and u per joint
+};
+
+/**
+ * ArticulatedBodySolver implements Featherstone's Articulated-Body Algorithm
+ * and the Recursive Newton-Euler Algorithm on top of Robot/Link/Joint. They
+ * yield the same results as DynamicsGraph::linearSolveFD and
+ * DynamicsGraph::linearSolveID, without building a GaussianFactorGraph.
+ *
+ * For a floating base, inverse dynamics also solves for the base acceleration
+ * (no wrench acts on the root), matching what the factor graph computes.
+ *
+ * The traversal order is computed once at construction. The root is the fixed
+ * link of the robot if there is one, otherwise the lowest-id link is treated
+ * as a floating base. Kinematic loops and multiple fixed links are not
+ * supported, use the factor graph solver for those.
+ *
+ * When a planar axis is given, the robot is assumed to actually move in that
+ * plane, in which case the planar wrench constraints of the factor graph are
+ * satisfied by construction and are not enforced separately.
+ */
+class ArticulatedBodySolver {
+ protected:
+  /// Pre-computed data for one joint, stored in parent-to-child order.
+  struct TreeJoint {
+    JointSharedPtr joint;
+    JointKernel kernel;   ///< flat copy of the joint kinematics
+    size_t joint_index;   ///< position in robot.joints()
+    size_t parent_index;  ///< position of the link closer to the root
+    size_t child_index;   ///< position of the link further from the root
+    bool aligned;         ///< tree child is joint->child()
+    gtsam::Vector6 S;     ///< screw axis expressed in the tree child frame
+  };
+
+  std::vector<LinkSharedPtr> links_;
+  std::vector<JointSharedPtr> joints_;
+  std::vector<TreeJoint> tree_;  // parent-first traversal order
+  size_t root_index_;
+  bool root_fixed_ = false;       ///< whether the root is fixed in the robot
+  gtsam::Pose3 root_fixed_pose_;  ///< pose of a fixed root
+  boost::optional<gtsam::Vector3> gravity_;
+
+  /// Return the gravity wrench acting on a link, in the link CoM frame.
+  gtsam::Vector6 gravityWrench(size_t i, const gtsam::Pose3 &wTi) const;
+
+  /// Forward pass: poses, twists and velocity-product accelerations.
+  void forwardKinematicsPass(const gtsam::Vector &q, const gtsam::Vector &v,
+                             const gtsam::Pose3 &wTroot,
+                             const gtsam::Vector6 &V_root,
+                             TreeDynamicsResult *result,
+                             TreeDynamicsWorkspace *workspace) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot, must be a tree
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   */
+  ArticulatedBodySolver(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none);
+
+  /// Return the robot links, in the order used for all index based APIs.
+  const std::vector<LinkSharedPtr> &links() const { return links_; }
+
+  /// Return the robot joints, in the order used for all index based APIs.
+  const std::vector<JointSharedPtr> &joints() const { return joints_; }
+
+  /// Return the root link of the traversal.
+  const LinkSharedPtr &root() const { return links_[root_index_]; }
+
+  /// Return whether the root link is fixed.
+  bool rootIsFixed() const { return root_fixed_; }
+
+  /// Return the number of joints, i.e., the size of all joint vectors.
+  size_t numJoints() const { return joints_.size(); }
+
+  /**
+   * Run the ABA recursion.
+   * @param q       joint angles, ordered as robot.joints()
+   * @param v       joint velocities, ordered as robot.joints()
+   * @param tau     joint torques, ordered as robot.joints()
+   * @param wTroot  pose of the root link CoM (ignored if the root is fixed)
+   * @param V_root  twist of the root link (ignored if the root is fixed)
+   * @param result  output, resized if necessary so it can be re-used.
+   */
+  void forwardDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &tau, const gtsam::Pose3 &wTroot,
+                       const gtsam::Vector6 &V_root,
+                       TreeDynamicsResult *result) const;
+
+  /**
+   * Run the ABA recursion, re-using the buffers of `workspace`. Does not
+   * allocate once `result` and `workspace` were used with this solver.
+   * @param external_wrenches  optional wrenches acting on each link, in the
+   * link CoM frame and ordered as robot.links(), e.g. contact forces
+   */
+  void forwardDynamics(
+      const gtsam::Vector &q, const gtsam::Vector &v, const gtsam::Vector &tau,
+      const gtsam::Pose3 &wTroot, const gtsam::Vector6 &V_root,
+      TreeDynamicsResult *result, TreeDynamicsWorkspace *workspace,
+      const std::vector<gtsam::Vector6> *external_wrenches = nullptr) const;
+
+  /// Run the ABA recursion with identity pose and zero twist for the root.
+  TreeDynamicsResult forwardDynamics(const gtsam::Vector &q,
+                                     const gtsam::Vector &v,
+                                     const gtsam::Vector &tau) const;
+
+  /**
+   * Run the RNEA recursion.
+   * @param q       joint angles, ordered as robot.joints()
+   * @param v       joint velocities, ordered as robot.joints()
+   * @param a       joint accelerations, ordered as robot.joints()
+   * @param wTroot  pose of the root link CoM (ignored if the root is fixed)
+   * @param V_root  twist of the root link (ignored if the root is fixed)
+   * @param result  output, resized if necessary so it can be re-used.
+   */
+  void inverseDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &a, const gtsam::Pose3 &wTroot,
+                       const gtsam::Vector6 &V_root,
+                       TreeDynamicsResult *result) const;
+
+  /// Run the RNEA recursion with identity pose and zero twist for the root.
+  TreeDynamicsResult inverseDynamics(const gtsam::Vector &q,
+                                     const gtsam::Vector &v,
+                                     const gtsam::Vector &a) const;
+
+  /**
+   * Solve forward dynamics, Values version with the same interface as
+   * DynamicsGraph::linearSolveFD. Poses and twists missing from
+   * `known_values` are inserted as well.
+   *
+   * @param t            time step
+   * @param known_values Values with joint angles, joint velocities, and
+   * torques, and optionally the root link pose and twist.
+   * @return known_values with joint accelerations, wrenches and twist
+   * accelerations added.
+   */
+  gtsam::Values solveFD(const gtsam::Values &known_values, int t = 0) const;
+
+  /**
+   * Solve inverse dynamics, Values version with the same interface as
+   * DynamicsGraph::linearSolveID.
+   *
+   * @param t            time step
+   * @param known_values Values with joint angles, joint velocities, and joint
+   * accelerations, and optionally the root link pose and twist.
+   * @return known_values with torques, wrenches and twist accelerations added.
+   */
+  gtsam::Values solveID(const gtsam::Values &known_values, int t = 0) const;
+
+  /// Return root pose from Values, fixed pose, or identity if not present.
+  gtsam::Pose3 rootPose(const gtsam::Values &values, int t = 0) const;
+
+  /// Return root twist from Values, or zero if not present.
+  gtsam::Vector6 rootTwist(const gtsam::Values &values, int t = 0) const;
+
+  /**
+   * Insert the recursion results into Values, the same way linearSolveFD does.
+   * @param result     result of a recursion
+   * @param t          time step
+   * @param values     Values to insert into
+   * @param torques    whether to insert torques (for inverse dynamics)
+   * @param accels     whether to insert joint accelerations
+   */
+  void insertResult(const TreeDynamicsResult &result, int t,
+                    gtsam::Values *values, bool torques, bool accels) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,285 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.cpp
+ * @brief Run many independent rollouts of the same robot in parallel.
+ */
+
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/utils/ParallelFor.h>
+
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+BatchSimulator::BatchSimulator(const Robot &robot,
+                               const boost::optional<gtsam::Vector3> &gravity,
+                               const boost::optional<gtsam::Vector3> &,
+                               IntegrationMethod method, double tolerance,
+                               BatchBackend backend)
+    : solver_(robot, gravity),
+      method_(method),
+      tolerance_(tolerance),
+      backend_(backend) {
+  if (backend_ == CudaBackend) {
+    if (method_ != ExplicitEuler && method_ != SemiImplicitEuler) {
+      throw std::invalid_argument(
+          "BatchSimulator: the CUDA backend only supports the Euler methods.");
+    }
+    cuda_ = std::make_shared<const CudaBatchBackend>(solver_.model());
+  }
+}
+
+/* ************************************************************************* */
+Matrix BatchSimulator::forwardKinematics(const Matrix &qs) const {
+  const size_t m = numJoints(), num_rollouts = qs.cols();
+  const size_t num_poses = 12 * solver_.flatLinks().size();
+  if (size_t(qs.rows()) != m) {
+    throw std::invalid_argument(
+        "BatchSimulator: joint angles must be num_joints x num_rollouts.");
+  }
+
+  if (cuda_) {
+    // The backend takes rollouts as the fastest index, i.e., transposed.
+    const Matrix qs_t = qs.transpose();
+    Matrix poses_t(num_rollouts, num_poses);
+    cuda_->forwardKinematics(qs_t.data(), num_rollouts, poses_t.data());
+    return poses_t.transpose();
+  }
+
+  const FlatRobotModel model = solver_.model();
+  Matrix poses(num_poses, num_rollouts);
+  ParallelFor(num_rollouts, [&](size_t r) {
+    FlatForwardKinematics(model, Strided<const double>{qs.col(r).data(), 1},
+                          Strided<double>{poses.col(r).data(), 1});
+  });
+  return poses;
+}
+
+/* ************************************************************************* */
+Matrix BatchSimulator::forwardDynamics(const Matrix &qs, const Matrix &vs,
+                                       const Matrix &taus) const {
+  const size_t m = numJoints(), num_rollouts = qs.cols();
+  for (const Matrix *x : {&qs, &vs, &taus}) {
+    if (size_t(x->rows()) != m || size_t(x->cols()) != num_rollouts) {
+      throw std::invalid_argument(
+          "BatchSimulator: states and torques must be num_joints x "
+          "num_rollouts.");
+    }
+  }
+
+  if (cuda_) {
+    const Matrix qs_t = qs.transpose(), vs_t = vs.transpose(),
+                 taus_t = taus.transpose();
+    Matrix accels_t(num_rollouts, m);
+    cuda_->forwardDynamics(qs_t.data(), vs_t.data(), taus_t.data(),
+                           num_rollouts, accels_t.data());
+    return accels_t.transpose();
+  }
+
+  Matrix accels(m, num_rollouts);
+  ParallelFor(num_rollouts, [&](size_t r) {
+    TreeDynamicsResult dynamics;
+    TreeDynamicsWorkspace workspace;
+    solver_.forwardDynamics(qs.col(r), vs.col(r), taus.col(r), Pose3(),
+                            Vector6::Zero(), &dynamics, &workspace);
+    accels.col(r) = dynamics.joint_accels;
+  });
+  return accels;
+}
+
+// Throw if the float result is further than tolerance from the double one.
+static void VerifyFloat(const char *name, const Eigen::MatrixXf &actual,
+                        const Matrix &expected, double tolerance) {
+  const double error =
+      expected.size() == 0
+          ? 0.0
+          : (actual.cast<double>() - expected).cwiseAbs().maxCoeff();
+  if (!(error <= tolerance)) {
+    throw std::runtime_error(std::string("BatchSimulator: float ") + name +
+                             " differs from double by " +
+                             std::to_string(error));
+  }
+}
+
+/* ************************************************************************* */
+Eigen::MatrixXf BatchSimulator::forwardKinematics(
+    const Eigen::MatrixXf &qs) const {
+  const size_t m = numJoints(), num_rollouts = qs.cols();
+  const size_t num_poses = 12 * solver_.flatLinks().size();
+  if (size_t(qs.rows()) != m) {
+    throw std::invalid_argument(
+        "BatchSimulator: joint angles must be num_joints x num_rollouts.");
+  }
+
+  const FlatRobotModel model = solver_.model();
+  Eigen::MatrixXf poses(num_poses, num_rollouts);
+  ParallelFor(num_rollouts, [&](size_t r) {
+    FlatForwardKinematics(model, Strided<const float>{qs.col(r).data(), 1},
+                          Strided<float>{poses.col(r).data(), 1});
+  });
+  if (float_tolerance_ > 0) {
+    VerifyFloat("kinematics", poses,
+                forwardKinematics(Matrix(qs.cast<double>())), float_tolerance_);
+  }
+  return poses;
+}
+
+/* ************************************************************************* */
+Eigen::MatrixXf BatchSimulator::forwardDynamics(
+    const Eigen::MatrixXf &qs, const Eigen::MatrixXf &vs,
+    const Eigen::MatrixXf &taus) const {
+  const size_t m = numJoints(), num_rollouts = qs.cols();
+  for (const Eigen::MatrixXf *x : {&qs, &vs, &taus}) {
+    if (size_t(x->rows()) != m || size_t(x->cols()) != num_rollouts) {
+      throw std::invalid_argument(
+          "BatchSimulator: states and torques must be num_joints x "
+          "num_rollouts.");
+    }
+  }
+
+  const FlatRobotModel model = solver_.model();
+  Eigen::MatrixXf accels(m, num_rollouts);
+  ParallelForRanges(num_rollouts, [&](size_t begin, size_t end) {
+    std::vector<float> workspace(FlatWorkspaceSize(model));
+    for (size_t r = begin; r < end; r++) {
+      FlatForwardDynamics(model, Strided<const float>{qs.col(r).data(), 1},
+                          Strided<const float>{vs.col(r).data(), 1},
+                          Strided<const float>{taus.col(r).data(), 1},
+                          Strided<float>{workspace.data(), 1},
+                          Strided<float>{accels.col(r).data(), 1});
+    }
+  });
+  if (float_tolerance_ > 0) {
+    VerifyFloat("dynamics", accels,
+                forwardDynamics(Matrix(qs.cast<double>()),
+                                Matrix(vs.cast<double>()),
+                                Matrix(taus.cast<double>())),
+                float_tolerance_);
+  }
+  return accels;
+}
+
+/* ************************************************************************* */
+BatchTrajectories BatchSimulator::simulate(const Matrix &initial_qs,
+                                           const Matrix &initial_vs,
+                                           const std::vector<Matrix> &torques,
+                                           double dt) const {
+  const size_t m = numJoints(), num_rollouts = torques.size();
+  const size_t num_steps = torques.empty() ? 0 : torques.front().cols();
+  Matrix packed(m * num_steps, num_rollouts);
+  for (size_t r = 0; r < num_rollouts; r++) {
+    if (size_t(torques[r].rows()) != m ||
+        size_t(torques[r].cols()) != num_steps) {
+      throw std::invalid_argument(
+          "BatchSimulator: torques must all be num_joints x num_steps.");
+    }
+    packed.col(r) = Eigen::Map<const Vector>(torques[r].data(), m * num_steps);
+  }
+
+  BatchTrajectories result;
+  simulate(initial_qs, initial_vs, packed, dt, &result);
+  return result;
+}
+
+/* ************************************************************************* */
+void BatchSimulator::simulate(const Matrix &initial_qs,
+                              const Matrix &initial_vs, const Matrix &torques,
+                              double dt, BatchTrajectories *result,
+                              BatchWorkspace *workspace) const {
+  const size_t m = numJoints(), num_rollouts = torques.cols();
+  if (m == 0 ? torques.rows() != 0 : torques.rows() % m != 0) {
+    throw std::invalid_argument(
+        "BatchSimulator: torques must be (num_joints * num_steps) x "
+        "num_rollouts.");
+  }
+  const size_t num_steps = m == 0 ? 0 : torques.rows() / m;
+  if (size_t(initial_qs.rows()) != m || size_t(initial_vs.rows()) != m ||
+      size_t(initial_qs.cols()) != num_rollouts ||
+      size_t(initial_vs.cols()) != num_rollouts) {
+    throw std::invalid_argument(
+        "BatchSimulator: initial states must be num_joints x num_rollouts.");
+  }
+
+  // Eigen only re-allocates when the size changes.
+  result->num_joints = m;
+  result->num_steps = num_steps;
+  result->qs.resize(m * (num_steps + 1), num_rollouts);
+  result->vs.resize(m * (num_steps + 1), num_rollouts);
+  result->as.resize(m * num_steps, num_rollouts);
+
+  if (cuda_) {
+    // Pack the rollouts as the fastest index: row r holds rollout r.
+    const Matrix initial_qs_t = initial_qs.transpose(),
+                 initial_vs_t = initial_vs.transpose(),
+                 torques_t = torques.transpose();
+    Matrix qs_t(num_rollouts, m * (num_steps + 1)),
+        vs_t(num_rollouts, m * (num_steps + 1)),
+        as_t(num_rollouts, m * num_steps);
+    cuda_->simulate(initial_qs_t.data(), initial_vs_t.data(),
+                    torques_t.data(), num_rollouts, num_steps, dt,
+                    method_ == SemiImplicitEuler, qs_t.data(), vs_t.data(),
+                    as_t.data());
+    result->qs = qs_t.transpose();
+    result->vs = vs_t.transpose();
+    result->as = as_t.transpose();
+    return;
+  }
+
+  BatchWorkspace local_workspace;
+  if (!workspace) workspace = &local_workspace;
+  workspace->rollouts.resize(num_rollouts);
+
+  ParallelFor(num_rollouts, [&](size_t r) {
+    // Scratch buffers of this rollout, re-used for every step.
+    BatchWorkspace::Rollout *scratch = &workspace->rollouts[r];
+    Vector &q = scratch->q, &v = scratch->v, &tau = scratch->tau;
+    q = initial_qs.col(r);
+    v = initial_vs.col(r);
+    tau.resize(m);
+    const Pose3 wTroot;
+    const Vector6 V_root = Vector6::Zero();
+    // Captures two pointers only, which std::function stores inline.
+    const ArticulatedBodySolver *solver = &solver_;
+    const AccelFunction accel = [solver, scratch](const Vector &q_i,
+                                                  const Vector &v_i) -> Vector {
+      solver->forwardDynamics(q_i, v_i, scratch->tau, Pose3(),
+                              Vector6::Zero(), &scratch->stage,
+                              &scratch->workspace);
+      return scratch->stage.joint_accels;
+    };
+
+    Eigen::Map<Matrix> qs(result->qs.col(r).data(), m, num_steps + 1);
+    Eigen::Map<Matrix> vs(result->vs.col(r).data(), m, num_steps + 1);
+    Eigen::Map<Matrix> as(result->as.col(r).data(), m, num_steps);
+    Eigen::Map<const Matrix> taus(torques.col(r).data(), m, num_steps);
+    qs.col(0) = q;
+    vs.col(0) = v;
+    for (size_t k = 0; k < num_steps; k++) {
+      tau = taus.col(k);
+      solver_.forwardDynamics(q, v, tau, wTroot, V_root, &scratch->dynamics,
+                              &scratch->workspace);
+      as.col(k) = scratch->dynamics.joint_accels;
+      Integrate(method_, accel, dt, scratch->dynamics.joint_accels, &q, &v,
+                tolerance_);
+      qs.col(k + 1) = q;
+      vs.col(k + 1) = v;
+    }
+  });
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,202 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.h
+ * @brief Run many independent rollouts of the same robot in parallel.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/dynamics/CudaBatchBackend.h>
+#include <gtdynamics/dynamics/FlatRobot.h>
+#include <gtdynamics/dynamics/Integrator.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Joint space trajectories of a batch of rollouts, stored in one contiguous
+ * column-major buffer per quantity. Column r of each buffer holds rollout r,
+ * step after step, and can be viewed as a num_joints x num_steps matrix.
+ */
+struct BatchTrajectories {
+  size_t num_joints = 0, num_steps = 0;
+  gtsam::Matrix qs;    ///< (num_joints * (num_steps + 1)) x num_rollouts
+  gtsam::Matrix vs;    ///< (num_joints * (num_steps + 1)) x num_rollouts
+  gtsam::Matrix as;    ///< (num_joints * num_steps) x num_rollouts
+
+  /// Return the number of rollouts.
+  size_t numRollouts() const { return qs.cols(); }
+
+  /// Return joint angles of rollout r, num_joints x (num_steps + 1).
+  Eigen::Map<const gtsam::Matrix> jointAngles(size_t r) const {
+    return Eigen::Map<const gtsam::Matrix>(qs.col(r).data(), num_joints,
+                                           num_steps + 1);
+  }
+
+  /// Return joint velocities of rollout r, num_joints x (num_steps + 1).
+  Eigen::Map<const gtsam::Matrix> jointVels(size_t r) const {
+    return Eigen::Map<const gtsam::Matrix>(vs.col(r).data(), num_joints,
+                                           num_steps + 1);
+  }
+
+  /// Return joint accelerations of rollout r, num_joints x num_steps.
+  Eigen::Map<const gtsam::Matrix> jointAccels(size_t r) const {
+    return Eigen::Map<const gtsam::Matrix>(as.col(r).data(), num_joints,
+                                           num_steps);
+  }
+};
+
+/**
+ * Scratch buffers of BatchSimulator, one set per rollout. Passing the same
+ * workspace and result to repeated simulations of the same size avoids all
+ * heap allocations on the CPU with the Euler methods, once sized.
+ */
+struct BatchWorkspace {
+  struct Rollout {
+    TreeDynamicsResult dynamics, stage;
+    TreeDynamicsWorkspace workspace;
+    gtsam::Vector q, v, tau;
+  };
+  std::vector<Rollout> rollouts;
+};
+
+/// Where BatchSimulator runs the rollouts.
+enum BatchBackend { CpuBackend, CudaBackend };
+
+/**
+ * BatchSimulator runs independent rollouts of one robot, in parallel on the
+ * TBB work-stealing scheduler when GTSAM is built with TBB.
+ *
+ * All rollouts share a single ArticulatedBodySolver, built once from the
+ * robot and only used through its const interface, so the robot model is
+ * not copied per rollout. Each rollout has its own scratch buffers and
+ * writes into its own column of the result.
+ *
+ * With the CudaBackend, the rollouts run instead on a CUDA device, one
+ * thread per rollout, on a copy of the FlatRobotModel of the robot, with
+ * the same interface and results up to round-off. It requires GTDynamics
+ * built with GTDYNAMICS_WITH_CUDA, and supports the Euler methods only.
+ *
+ * As in Simulator, only the joints are integrated: the root link stays at
+ * identity pose and zero twist, unless it is fixed.
+ */
+class BatchSimulator {
+ private:
+  FlatRobot solver_;
+  IntegrationMethod method_;
+  double tolerance_;
+  BatchBackend backend_;
+  std::shared_ptr<const CudaBatchBackend> cuda_;
+  double float_tolerance_ = 0;
+
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot, must be a tree
+   * @param gravity      gravity vector
+   * @param planar_axis  planar axis vector
+   * @param method       integration method
+   * @param tolerance    error tolerance, only used by RK45
+   * @param backend      where to run the rollouts
+   */
+  BatchSimulator(const Robot &robot,
+                 const boost::optional<gtsam::Vector3> &gravity = boost::none,
+                 const boost::optional<gtsam::Vector3> &planar_axis =
+                     boost::none,
+                 IntegrationMethod method = ExplicitEuler,
+                 double tolerance = 1e-6, BatchBackend backend = CpuBackend);
+
+  /// Return the number of joints, ordered as robot.joints().
+  size_t numJoints() const { return solver_.numJoints(); }
+
+  /// Return the dynamics solver shared by all rollouts on the CPU.
+  const ArticulatedBodySolver &solver() const { return solver_; }
+
+  /// Return the flattened robot, as copied to the device.
+  const FlatRobot &flatRobot() const { return solver_; }
+
+  /// Return where the rollouts run.
+  BatchBackend backend() const { return backend_; }
+
+  /**
+   * Forward kinematics of a batch of joint angles, with the root at
+   * identity unless fixed.
+   * @param qs  joint angles, num_joints x num_rollouts
+   * @return link CoM poses, (12 * num_links) x num_rollouts, 12 numbers per
+   * link: the row-major rotation matrix then the translation
+   */
+  gtsam::Matrix forwardKinematics(const gtsam::Matrix &qs) const;
+
+  /**
+   * Forward dynamics of a batch of states and torques, all of size
+   * num_joints x num_rollouts, with the root as in forwardKinematics.
+   * @return joint accelerations, num_joints x num_rollouts
+   */
+  gtsam::Matrix forwardDynamics(const gtsam::Matrix &qs,
+                                const gtsam::Matrix &vs,
+                                const gtsam::Matrix &taus) const;
+
+  /**
+   * Forward kinematics in single precision, on the CPU, with the flat
+   * kernel instantiated for float. Buffers are half the size of the double
+   * version, for sampling workloads that tolerate float round-off, of the
+   * order of 1e-6 relative.
+   */
+  Eigen::MatrixXf forwardKinematics(const Eigen::MatrixXf &qs) const;
+
+  /// Forward dynamics in single precision, on the CPU, as forwardKinematics.
+  Eigen::MatrixXf forwardDynamics(const Eigen::MatrixXf &qs,
+                                  const Eigen::MatrixXf &vs,
+                                  const Eigen::MatrixXf &taus) const;
+
+  /**
+   * Verify every single precision evaluation against the double one, which
+   * doubles its cost. The float methods then throw std::runtime_error if an
+   * output differs by more than the tolerance; 0 disables the check.
+   */
+  void setFloatVerification(double tolerance) { float_tolerance_ = tolerance; }
+
+  /**
+   * Simulate all rollouts.
+   * @param initial_qs  initial joint angles, num_joints x num_rollouts
+   * @param initial_vs  initial joint velocities, num_joints x num_rollouts
+   * @param torques     torque sequence of each rollout, each of size
+   * num_joints x num_steps, with the same num_steps for all rollouts
+   * @param dt          duration of each time step
+   */
+  BatchTrajectories simulate(const gtsam::Matrix &initial_qs,
+                             const gtsam::Matrix &initial_vs,
+                             const std::vector<gtsam::Matrix> &torques,
+                             double dt) const;
+
+  /**
+   * Simulate all rollouts into `result`, re-using its buffers and those of
+   * `workspace` when they already have the right size.
+   * @param initial_qs  initial joint angles, num_joints x num_rollouts
+   * @param initial_vs  initial joint velocities, num_joints x num_rollouts
+   * @param torques     torques, (num_joints * num_steps) x num_rollouts, in
+   * the layout of BatchTrajectories::as
+   * @param dt          duration of each time step
+   * @param result      output trajectories
+   * @param workspace   optional scratch buffers, to re-use across calls
+   */
+  void simulate(const gtsam::Matrix &initial_qs,
+                const gtsam::Matrix &initial_vs, const gtsam::Matrix &torques,
+                double dt, BatchTrajectories *result,
+                BatchWorkspace *workspace = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/utils/ParallelFor.h>
 
 namespace gtdynamics {
 
@@ -34,19 +35,25 @@ Chain operator*(const Chain &chainA, const Chain &chainB) {
   return Chain(aTc, axes);
 }
 
-Chain Chain::compose(std::vector<Chain> &chains) {
-  // Initialize total chain
-  Chain total_chain;
-
-  // Perform monoid operations
-  for (auto &&chain : chains) {
-    total_chain = total_chain * chain;
+Chain Chain::compose(const std::vector<Chain> &chains) {
+  if (chains.empty()) return Chain();
+
+  // Tree reduction: compose neighbors pairwise until one chain is left.
+  std::vector<Chain> level(chains);
+  while (level.size() > 1) {
+    const size_t num_pairs = level.size() / 2;
+    std::vector<Chain> next((level.size() + 1) / 2);
+    ParallelFor(num_pairs, [&](size_t i) {
+      next[i] = level[2 * i] * level[2 * i + 1];
+    });
+    if (level.size() % 2 == 1) next.back() = level.back();
+    level.swap(next);
   }
-  return total_chain;
+  return level.front();
 }
 
 Pose3 Chain::poe(const Vector &q, boost::optional<Pose3 &> fTe,
-                 gtsam::OptionalJacobian<-1, -1> J) {
+                 gtsam::OptionalJacobian<-1, -1> J) const {
   // Check that input has good size
   if (q.size() != length()) {
     throw std::runtime_error(
@@ -54,88 +61,131 @@ Pose3 Chain::poe(const Vector &q, boost::optional<Pose3 &> fTe,
   }
 
   // Build vector of exponential maps to use in poe
-  std::vector<Pose3> exp;
-  for (int i = 0; i < q.size(); ++i) {
-    exp.push_back(Pose3::Expmap(axes_.col(i) * q(i)));
+  const int n = q.size();
+  std::vector<Pose3> exp(n);
+  for (int i = 0; i < n; ++i) {
+    exp[i] = Pose3::Expmap(axes_.col(i) * q(i));
   }
 
-  Pose3 poe;
-  if (!J) {
-    // If J is not given, compute regular poe
-    poe = sMb_;
-    for (auto &expmap : exp) {
-      poe = poe.compose(expmap);
-    }
-    if (fTe) {
-      // compose end-effector pose
-      poe = poe.compose(*fTe);
-    }
-  } else {
-    // Compute FK + Jacobian with monoid compose.
-    Chain chain(sMb_);
-    for (int j = 0; j < q.size(); ++j) {
-      chain = chain * Chain(exp[j], axes_.col(j));
-    }
-    if (fTe) {
-      // compose end-effector pose
-      chain = chain * Chain(*fTe);
+  Pose3 poe = sMb_;
+  for (auto &expmap : exp) {
+    poe = poe.compose(expmap);
+  }
+  if (fTe) {
+    // compose end-effector pose
+    poe = poe.compose(*fTe);
+  }
+
+  if (J) {
+    // Same result as monoid compose, without temporary chains: column i is
+    // axis i adjointed to the end-effector frame by the poses after joint i.
+    Matrix jacobian(6, n);
+    Pose3 tail = fTe ? *fTe : Pose3();
+    for (int i = n - 1; i >= 0; --i) {
+      jacobian.col(i) = tail.inverse().Adjoint(axes_.col(i));
+      tail = exp[i].compose(tail);
     }
-    poe = chain.sMb();
-    *J = chain.axes();
+    *J = jacobian;
   }
   return poe;
 }
 
+std::vector<Pose3> Chain::poeBatch(const Matrix &qs,
+                                   boost::optional<Pose3> fTe,
+                                   std::vector<Matrix> *Js) const {
+  const size_t num_samples = qs.cols();
+  std::vector<Pose3> poses(num_samples);
+  if (Js) Js->resize(num_samples);
+  ParallelFor(num_samples, [&](size_t k) {
+    const Vector q = qs.col(k);
+    Pose3 fTe_k = fTe ? *fTe : Pose3();
+    poses[k] = Js ? poe(q, fTe_k, (*Js)[k]) : poe(q, fTe_k);
+  });
+  return poses;
+}
+
 gtsam::Vector3 Chain::DynamicalEquality3(
     const gtsam::Vector6 &wrench, const gtsam::Vector3 &angles,
     const gtsam::Vector3 &torques, gtsam::OptionalJacobian<3, 6> H_wrench,
     gtsam::OptionalJacobian<3, 3> H_angles,
-    gtsam::OptionalJacobian<3, 3> H_torques) {
-  Matrix J;
-  poe(angles, boost::none, J);
+    gtsam::OptionalJacobian<3, 3> H_torques) const {
+  return DynamicalEquality<3>(wrench, angles, torques, H_wrench, H_angles,
+                              H_torques);
+}
+
+template <int N>
+Eigen::Matrix<double, N, 1> Chain::DynamicalEquality(
+    const gtsam::Vector6 &wrench, const Eigen::Matrix<double, N, 1> &angles,
+    const Eigen::Matrix<double, N, 1> &torques,
+    OptionalChainJacobian<N, 6> H_wrench, OptionalChainJacobian<N, N> H_angles,
+    OptionalChainJacobian<N, N> H_torques) const {
+  const int n = length();
+  if (angles.size() != n || torques.size() != n) {
+    throw std::runtime_error(
+        "number of angles or torques different from number of cols in axes");
+  }
+
+  // Adjoint maps of the inverse joint exponentials, Ad(exp(A_k * q_k)^-1),
+  // stored side by side.
+  constexpr int M = (N == Eigen::Dynamic) ? Eigen::Dynamic : 6 * N;
+  Eigen::Matrix<double, 6, M> Ad_inv(6, 6 * n);
+  for (int k = 0; k < n; ++k) {
+    const gtsam::Vector6 A_k = axes_.col(k);
+    Ad_inv.template block<6, 6>(0, 6 * k) =
+        Pose3::Expmap(-A_k * angles(k)).AdjointMap();
+  }
+
+  // As in poe, column i of the Jacobian is J_i = T_i * A_i, with
+  // T_i = Ad_inv_{n-1} * ... * Ad_inv_{i+1}. F_i = T_i^T * F is the wrench
+  // expressed in the frame after joint i.
+  Eigen::Matrix<double, 6, N> J(6, n), F(6, n);
+  gtsam::Matrix6 T = gtsam::I_6x6;
+  for (int i = n - 1; i >= 0; --i) {
+    J.col(i) = T * axes_.col(i);
+    F.col(i) = T.transpose() * wrench;
+    T = T * Ad_inv.template block<6, 6>(0, 6 * i);
+  }
+
   if (H_wrench) {
     // derivative of difference with respect to wrench
     *H_wrench = J.transpose();
   }
   if (H_angles) {
-    // derivative of difference with respect to angles
-
-    // The manipulator Jacobian is built such that in every step of chain
-    // composition we multiply the existing screw axes with the adjoint map of
-    // the inverse pose of the new chain, and then stack the screw axes of the
-    // new chain horizontally in the axes matrix.
-    // This means that the first angle actually doesn't get into the matrix at
-    // all. The last column of the jacobian actually doesn't depend on the
-    // angles at all, the second column depends only on the third angle, and the
-    // first column depends on the second and third angles.
-    // This means that the 3*3 jacobian has an upper triangular structure.
-    Matrix A = gtsam::Z_3x3;
-
-    // Calculate the Adjoint and take its derivative in relation to angles
-    auto ad_J_angles1 = AdjointMapJacobianQ(angles(1), Pose3(), axes_.col(1));
-    auto ad_J_angles2 = AdjointMapJacobianQ(angles(2), Pose3(), axes_.col(2));
-
-    // Calculate the invers adjoint maps of the Poses, as we do in * operator
-    Pose3 p1 = Pose3::Expmap(axes_.col(1) * angles(1));
-    Pose3 p2 = Pose3::Expmap(axes_.col(2) * angles(2));
-    auto ad_inv_p1 = p1.inverse().AdjointMap();
-    auto ad_inv_p2 = p2.inverse().AdjointMap();
-
-    // calculate the non-zero terms
-    A(1, 2) = (ad_J_angles2 * axes_.col(1)).transpose() * wrench;
-    A(0, 2) = (ad_J_angles2 * ad_inv_p1 * axes_.col(0)).transpose() * wrench;
-    A(0, 1) = (ad_inv_p2 * ad_J_angles1 * axes_.col(0)).transpose() * wrench;
-
-    *H_angles = A;
+    // Column i only depends on the angles of the joints after joint i, so the
+    // Jacobian is strictly upper triangular. Angle k enters via
+    // d/dq_k Ad_inv_k = -ad(A_k) * Ad_inv_k.
+    Eigen::Matrix<double, N, N> H = Eigen::Matrix<double, N, N>::Zero(n, n);
+    for (int i = 0; i < n; ++i) {
+      gtsam::Vector6 R = axes_.col(i);
+      for (int k = i + 1; k < n; ++k) {
+        R = Ad_inv.template block<6, 6>(0, 6 * k) * R;
+        const gtsam::Vector6 A_k = axes_.col(k);
+        H(i, k) = -F.col(k).dot(Pose3::adjointMap(A_k) * R);
+      }
+    }
+    *H_angles = H;
   }
   if (H_torques) {
     // derivative of difference with respect to torques
-    *H_torques = -gtsam::I_3x3;
+    *H_torques = -Eigen::Matrix<double, N, N>::Identity(n, n);
   }
 
-  return (J.transpose() * wrench - torques);
+  return J.transpose() * wrench - torques;
 }
 
+// Fixed-size instantiations for common arm and leg lengths.
+#define GTDYNAMICS_INSTANTIATE_DYNAMICAL_EQUALITY(N)                      \
+  template Eigen::Matrix<double, N, 1> Chain::DynamicalEquality<N>(      \
+      const gtsam::Vector6 &, const Eigen::Matrix<double, N, 1> &,       \
+      const Eigen::Matrix<double, N, 1> &, OptionalChainJacobian<N, 6>,  \
+      OptionalChainJacobian<N, N>, OptionalChainJacobian<N, N>) const;
+GTDYNAMICS_INSTANTIATE_DYNAMICAL_EQUALITY(3)
+GTDYNAMICS_INSTANTIATE_DYNAMICAL_EQUALITY(4)
+GTDYNAMICS_INSTANTIATE_DYNAMICAL_EQUALITY(6)
+GTDYNAMICS_INSTANTIATE_DYNAMICAL_EQUALITY(7)
+GTDYNAMICS_INSTANTIATE_DYNAMICAL_EQUALITY(Eigen::Dynamic)
+#undef GTDYNAMICS_INSTANTIATE_DYNAMICAL_EQUALITY
+
 gtsam::Vector3_ Chain::ChainConstraint3(
     const std::vector<JointSharedPtr> &joints, const gtsam::Key wrench_key,
     size_t k) {
@@ -19,6 +19,7 @@
 #include <gtsam/geometry/Pose3.h>
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/utils/utils.h"
@@ -30,6 +31,19 @@ using gtsam::Vector;
 
 namespace gtdynamics {
 
+/// OptionalJacobian of a chain quantity with Rows rows, dynamic if Rows is.
+template <int Rows, int Cols>
+struct OptionalChainJacobianTraits {
+  typedef gtsam::OptionalJacobian<Rows, Cols> type;
+};
+template <int Cols>
+struct OptionalChainJacobianTraits<Eigen::Dynamic, Cols> {
+  typedef gtsam::OptionalJacobian<-1, -1> type;
+};
+template <int Rows, int Cols>
+using OptionalChainJacobian =
+    typename OptionalChainJacobianTraits<Rows, Cols>::type;
+
 /**
  * Chain is a class used to create a serial kinematic chain, which
  * helps in creating a LeanDynamicsGraph
@@ -69,11 +83,12 @@ class Chain {
 
   /**
    * This function returns a chain object composed from all chains in
-   * the input vector
+   * the input vector. As the monoid operation is associative, the chains are
+   * composed pairwise in a tree reduction, each level in parallel.
    * @param chain_vector ........... Vector containing chains to compose
    * @return ....................... Composed chain
    */
-  static Chain compose(std::vector<Chain> &chains);
+  static Chain compose(const std::vector<Chain> &chains);
 
   // Return sMb.
   inline const Pose3 &sMb() const { return sMb_; }
@@ -96,7 +111,19 @@ class Chain {
    * Exponentials
    */
   Pose3 poe(const Vector &q, boost::optional<Pose3 &> fTe = boost::none,
-            gtsam::OptionalJacobian<-1, -1> J = boost::none);
+            gtsam::OptionalJacobian<-1, -1> J = boost::none) const;
+
+  /**
+   * Perform forward kinematics for many joint vectors at once, in parallel.
+   * @param qs .......... Input angles, one column per sample
+   * @param fTe ......... The end-effector pose with respect to final link
+   * (Optional)
+   * @param(out) Js...... If given, filled with the Jacobian of each sample
+   * @return ............ Pose of the end-effector for each sample
+   */
+  std::vector<Pose3> poeBatch(const Matrix &qs,
+                              boost::optional<Pose3> fTe = boost::none,
+                              std::vector<Matrix> *Js = nullptr) const;
 
   /**
    * This function implements the dynamic dependency between the
@@ -116,7 +143,27 @@ class Chain {
       const gtsam::Vector3 &torques,
       gtsam::OptionalJacobian<3, 6> H_wrench = boost::none,
       gtsam::OptionalJacobian<3, 3> H_angles = boost::none,
-      gtsam::OptionalJacobian<3, 3> H_torques = boost::none);
+      gtsam::OptionalJacobian<3, 3> H_torques = boost::none) const;
+
+  /**
+   * Dynamical equality tau = J^T * F of DynamicalEquality3, for a chain with
+   * N joints. The Jacobians are fixed-size, except for N = Eigen::Dynamic,
+   * which works for any chain length. Instantiated for N = 3, 4, 6, 7 and
+   * Eigen::Dynamic.
+   *
+   * @param wrench .................. Wrench applied on the body by the joint
+   * closest to it in the chain.
+   * @param angles .................. Angles of the joints in the chain.
+   * @param torques ................. Torques applied by the joints.
+   * @return ........................ Vector of difference.
+   */
+  template <int N>
+  Eigen::Matrix<double, N, 1> DynamicalEquality(
+      const gtsam::Vector6 &wrench, const Eigen::Matrix<double, N, 1> &angles,
+      const Eigen::Matrix<double, N, 1> &torques,
+      OptionalChainJacobian<N, 6> H_wrench = boost::none,
+      OptionalChainJacobian<N, N> H_angles = boost::none,
+      OptionalChainJacobian<N, N> H_torques = boost::none) const;
 
   /**
    * This function creates a gtsam expression of the Chain constraint FOR A
@@ -136,11 +183,11 @@ class Chain {
 
 // Helper function to create expression with a vector, used in
 // ChainConstraint3.
-gtsam::Vector3 MakeVector3(const double &value0, const double &value1,
-                           const double &value2,
-                           gtsam::OptionalJacobian<3, 1> J0 = boost::none,
-                           gtsam::OptionalJacobian<3, 1> J1 = boost::none,
-                           gtsam::OptionalJacobian<3, 1> J2 = boost::none) {
+inline gtsam::Vector3 MakeVector3(
+    const double &value0, const double &value1, const double &value2,
+    gtsam::OptionalJacobian<3, 1> J0 = boost::none,
+    gtsam::OptionalJacobian<3, 1> J1 = boost::none,
+    gtsam::OptionalJacobian<3, 1> J2 = boost::none) {
   gtsam::Vector3 q;
   q << value0, value1, value2;
   if (J0) {
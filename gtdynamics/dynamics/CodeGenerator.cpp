@@ -0,0 +1,936 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CodeGenerator.cpp
+ * @brief Generation of robot-specific kinematics and dynamics kernels.
+ */
+
+#include <gtdynamics/dynamics/CodeGenerator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using gtsam::Matrix3;
+using gtsam::Pose3;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// Coefficients below this magnitude are treated as structural zeros.
+constexpr double kZero = 1e-14;
+
+bool IsZero(double x) { return std::abs(x) < kZero; }
+
+// Shortest literal that reads back as x.
+std::string Num(double x) {
+  std::string str;
+  for (int precision = 15; precision <= 17; precision++) {
+    std::ostringstream os;
+    os << std::setprecision(precision) << x;
+    str = os.str();
+    if (std::strtod(str.c_str(), nullptr) == x) break;
+  }
+  if (str.find_first_of(".en") == std::string::npos) str += ".0";
+  return str;
+}
+
+// Sum of coefficient * expression terms plus a constant, skipping zeros.
+using Terms = std::vector<std::pair<double, std::string>>;
+std::string Combination(const Terms &terms, double constant = 0.0) {
+  std::string out;
+  for (auto &&term : terms) {
+    const double c = term.first;
+    if (IsZero(c)) continue;
+    const std::string factor = IsZero(std::abs(c) - 1.0)
+                                   ? term.second
+                                   : Num(std::abs(c)) + " * " + term.second;
+    if (out.empty()) {
+      out = (c < 0 ? "-" : "") + factor;
+    } else {
+      out += (c < 0 ? " - " : " + ") + factor;
+    }
+  }
+  if (!IsZero(constant)) {
+    if (out.empty()) return "T(" + Num(constant) + ")";
+    out += (constant < 0 ? " - " : " + ") + Num(std::abs(constant));
+  }
+  return out.empty() ? "T(0)" : out;
+}
+
+// Terms S_k * array[k] of a screw axis.
+Terms ScrewTerms(const Vector6 &S, const std::string &array) {
+  Terms terms;
+  for (size_t k = 0; k < 6; k++) {
+    terms.emplace_back(S(k), array + "[" + std::to_string(k) + "]");
+  }
+  return terms;
+}
+
+std::string Index(const std::string &array, size_t i) {
+  return array + "[" + std::to_string(i) + "]";
+}
+
+// Literal {9 numbers} of a row-major 3x3 matrix.
+std::string MatrixLiteral(const Matrix3 &M) {
+  std::string out = "{";
+  for (size_t r = 0; r < 3; r++) {
+    for (size_t c = 0; c < 3; c++) {
+      out += Num(M(r, c)) + (r == 2 && c == 2 ? "}" : ", ");
+    }
+  }
+  return out;
+}
+
+std::string VectorLiteral(const Vector3 &v) {
+  return "{" + Num(v(0)) + ", " + Num(v(1)) + ", " + Num(v(2)) + "}";
+}
+
+std::string PoseLiteral(const Pose3 &pose) {
+  return "ConstPose<T>(" + MatrixLiteral(pose.rotation().matrix()) + ", " +
+         VectorLiteral(pose.translation()) + ")";
+}
+
+// Helpers shared by all generated kernels, independent of the robot.
+const char *const kPreamble = R"code(
+#include <gtdynamics/dynamics/GeneratedKernels.h>
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(_WIN32)
+#define GTD_GENERATED_EXPORT __declspec(dllexport)
+#else
+#define GTD_GENERATED_EXPORT __attribute__((visibility("default")))
+#endif
+
+namespace {
+
+// Forward-mode dual number, carrying one directional derivative.
+struct Dual {
+  double v, d;
+  Dual(double value = 0.0, double derivative = 0.0)
+      : v(value), d(derivative) {}
+  Dual &operator+=(const Dual &y) {
+    v += y.v;
+    d += y.d;
+    return *this;
+  }
+  Dual &operator-=(const Dual &y) {
+    v -= y.v;
+    d -= y.d;
+    return *this;
+  }
+};
+
+inline Dual operator-(const Dual &x) { return Dual(-x.v, -x.d); }
+inline Dual operator+(const Dual &x, const Dual &y) {
+  return Dual(x.v + y.v, x.d + y.d);
+}
+inline Dual operator-(const Dual &x, const Dual &y) {
+  return Dual(x.v - y.v, x.d - y.d);
+}
+inline Dual operator*(const Dual &x, const Dual &y) {
+  return Dual(x.v * y.v, x.d * y.v + x.v * y.d);
+}
+inline Dual operator/(const Dual &x, const Dual &y) {
+  return Dual(x.v / y.v, (x.d * y.v - x.v * y.d) / (y.v * y.v));
+}
+inline Dual sin(const Dual &x) {
+  return Dual(std::sin(x.v), std::cos(x.v) * x.d);
+}
+inline Dual cos(const Dual &x) {
+  return Dual(std::cos(x.v), -std::sin(x.v) * x.d);
+}
+inline Dual sqrt(const Dual &x) {
+  const double s = std::sqrt(x.v);
+  return Dual(s, 0.5 * x.d / s);
+}
+using std::cos;
+using std::sin;
+using std::sqrt;
+
+inline double Value(double x) { return x; }
+inline double Value(const Dual &x) { return x.v; }
+inline double Derivative(double) { return 0.0; }
+inline double Derivative(const Dual &x) { return x.d; }
+
+// Rigid transform, with a row-major rotation matrix.
+template <class T>
+struct Pose {
+  T R[9];
+  T t[3];
+};
+
+template <class T>
+Pose<T> ConstPose(const double (&R)[9], const double (&t)[3]) {
+  Pose<T> X;
+  for (int k = 0; k < 9; k++) X.R[k] = T(R[k]);
+  for (int k = 0; k < 3; k++) X.t[k] = T(t[k]);
+  return X;
+}
+
+// Pose from 12 numbers, identity if null.
+template <class T>
+Pose<T> RootPose(const double *pose) {
+  Pose<T> X;
+  for (int k = 0; k < 9; k++) {
+    X.R[k] = T(pose ? pose[k] : (k % 4 == 0 ? 1.0 : 0.0));
+  }
+  for (int k = 0; k < 3; k++) X.t[k] = T(pose ? pose[9 + k] : 0.0);
+  return X;
+}
+
+template <class T>
+void Rotate(const T *R, const T *x, T *y) {
+  for (int i = 0; i < 3; i++) {
+    y[i] = R[3 * i] * x[0] + R[3 * i + 1] * x[1] + R[3 * i + 2] * x[2];
+  }
+}
+
+template <class T>
+void RotateT(const T *R, const T *x, T *y) {
+  for (int i = 0; i < 3; i++) {
+    y[i] = R[i] * x[0] + R[3 + i] * x[1] + R[6 + i] * x[2];
+  }
+}
+
+template <class T>
+void Cross(const T *a, const T *b, T *c) {
+  c[0] = a[1] * b[2] - a[2] * b[1];
+  c[1] = a[2] * b[0] - a[0] * b[2];
+  c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+template <class T>
+Pose<T> Compose(const Pose<T> &A, const Pose<T> &B) {
+  Pose<T> C;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      C.R[3 * i + j] = A.R[3 * i] * B.R[j] + A.R[3 * i + 1] * B.R[3 + j] +
+                       A.R[3 * i + 2] * B.R[6 + j];
+    }
+  }
+  Rotate(A.R, B.t, C.t);
+  for (int k = 0; k < 3; k++) C.t[k] += A.t[k];
+  return C;
+}
+
+template <class T>
+Pose<T> Inverse(const Pose<T> &A) {
+  Pose<T> B;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) B.R[3 * i + j] = A.R[3 * j + i];
+  }
+  RotateT(A.R, A.t, B.t);
+  for (int k = 0; k < 3; k++) B.t[k] = -B.t[k];
+  return B;
+}
+
+// y = Ad(X) * x = [R * w; t x (R * w) + R * v]
+template <class T>
+void Adjoint(const Pose<T> &X, const T *x, T *y) {
+  T Rw[3], Rv[3], tRw[3];
+  Rotate(X.R, x, Rw);
+  Rotate(X.R, x + 3, Rv);
+  Cross(X.t, Rw, tRw);
+  for (int k = 0; k < 3; k++) {
+    y[k] = Rw[k];
+    y[3 + k] = tRw[k] + Rv[k];
+  }
+}
+
+// y = Ad(X)^T * f = [R^T * (f_w - t x f_v); R^T * f_v]
+template <class T>
+void AdjointTranspose(const Pose<T> &X, const T *f, T *y) {
+  T tf[3], m[3];
+  Cross(X.t, f + 3, tf);
+  for (int k = 0; k < 3; k++) m[k] = f[k] - tf[k];
+  RotateT(X.R, m, y);
+  RotateT(X.R, f + 3, y + 3);
+}
+
+// y = ad(V) * x = [w x x_w; w x x_v + v x x_w]
+template <class T>
+void ad(const T *V, const T *x, T *y) {
+  T a[3], b[3];
+  Cross(V, x, y);
+  Cross(V, x + 3, a);
+  Cross(V + 3, x, b);
+  for (int k = 0; k < 3; k++) y[3 + k] = a[k] + b[k];
+}
+
+// y = ad(V)^T * f = [-w x f_w - v x f_v; -w x f_v]
+template <class T>
+void adTranspose(const T *V, const T *f, T *y) {
+  T a[3], b[3], c[3];
+  Cross(V, f, a);
+  Cross(V + 3, f + 3, b);
+  Cross(V, f + 3, c);
+  for (int k = 0; k < 3; k++) {
+    y[k] = -a[k] - b[k];
+    y[3 + k] = -c[k];
+  }
+}
+
+template <class T>
+void SetZero(T *x) {
+  for (int k = 0; k < 6; k++) x[k] = T(0);
+}
+
+// y += x
+template <class T>
+void Add(const T *x, T *y) {
+  for (int k = 0; k < 6; k++) y[k] += x[k];
+}
+
+template <class T>
+void Negate(T *x) {
+  for (int k = 0; k < 6; k++) x[k] = -x[k];
+}
+
+template <class T>
+T Dot6(const T *x, const T *y) {
+  T sum = x[0] * y[0];
+  for (int k = 1; k < 6; k++) sum += x[k] * y[k];
+  return sum;
+}
+
+// Row-major 6x6 [[R, 0], [t^ * R, R]].
+template <class T>
+void AdjointMap(const Pose<T> &X, T *M) {
+  for (int k = 0; k < 36; k++) M[k] = T(0);
+  for (int j = 0; j < 3; j++) {
+    const T col[3] = {X.R[j], X.R[3 + j], X.R[6 + j]};
+    T tcol[3];
+    Cross(X.t, col, tcol);
+    for (int i = 0; i < 3; i++) {
+      M[6 * i + j] = col[i];
+      M[6 * (i + 3) + j + 3] = col[i];
+      M[6 * (i + 3) + j] = tcol[i];
+    }
+  }
+}
+
+// B += Ad(X)^T * A * Ad(X), all row-major 6x6.
+template <class T>
+void CongruenceAdd(const Pose<T> &X, const T *A, T *B) {
+  T Ad[36], AAd[36];
+  AdjointMap(X, Ad);
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 6; j++) {
+      T sum = A[6 * i] * Ad[j];
+      for (int k = 1; k < 6; k++) sum += A[6 * i + k] * Ad[6 * k + j];
+      AAd[6 * i + j] = sum;
+    }
+  }
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 6; j++) {
+      T sum = Ad[i] * AAd[j];
+      for (int k = 1; k < 6; k++) sum += Ad[6 * k + i] * AAd[6 * k + j];
+      B[6 * i + j] += sum;
+    }
+  }
+}
+
+template <class T>
+void MatVec6(const T *A, const T *x, T *y) {
+  for (int i = 0; i < 6; i++) y[i] = Dot6(A + 6 * i, x);
+}
+
+// out = A - U * U^T / D
+template <class T>
+void RankOneDowndate(const T *A, const T *U, const T &D, T *out) {
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 6; j++) {
+      out[6 * i + j] = A[6 * i + j] - U[i] * U[j] / D;
+    }
+  }
+}
+
+// Rigid body inertia diag(I, m * I3).
+template <class T>
+void SetInertia(T *M, const double (&I)[9], double m) {
+  for (int k = 0; k < 36; k++) M[k] = T(0);
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) M[6 * i + j] = T(I[3 * i + j]);
+    M[6 * (i + 3) + i + 3] = T(m);
+  }
+}
+
+// Solve A * x = b by Cholesky, A symmetric positive definite.
+template <class T>
+void Solve6(const T *A, const T *b, T *x) {
+  T L[36], y[6];
+  for (int j = 0; j < 6; j++) {
+    T diagonal = A[6 * j + j];
+    for (int k = 0; k < j; k++) diagonal -= L[6 * j + k] * L[6 * j + k];
+    L[6 * j + j] = sqrt(diagonal);
+    for (int i = j + 1; i < 6; i++) {
+      T sum = A[6 * i + j];
+      for (int k = 0; k < j; k++) sum -= L[6 * i + k] * L[6 * j + k];
+      L[6 * i + j] = sum / L[6 * j + j];
+    }
+  }
+  for (int i = 0; i < 6; i++) {
+    T sum = b[i];
+    for (int k = 0; k < i; k++) sum -= L[6 * i + k] * y[k];
+    y[i] = sum / L[6 * i + i];
+  }
+  for (int i = 5; i >= 0; i--) {
+    T sum = y[i];
+    for (int k = i + 1; k < 6; k++) sum -= L[6 * k + i] * x[k];
+    x[i] = sum / L[6 * i + i];
+  }
+}
+
+// Dual copies of x, with unit derivative for entry k only.
+void Seed(const double *x, size_t n, size_t k, Dual *y) {
+  for (size_t i = 0; i < n; i++) y[i] = Dual(x[i], i == k ? 1.0 : 0.0);
+}
+
+void Derivatives(const Dual *y, size_t n, double *d) {
+  for (size_t i = 0; i < n; i++) d[i] = y[i].d;
+}
+
+template <class T>
+void WritePoses(const Pose<T> *wT, size_t n, double *poses) {
+  for (size_t i = 0; i < n; i++) {
+    for (int k = 0; k < 9; k++) poses[12 * i + k] = Value(wT[i].R[k]);
+    for (int k = 0; k < 3; k++) poses[12 * i + 9 + k] = Value(wT[i].t[k]);
+  }
+}
+
+template <class T>
+void WritePoseDerivatives(const Pose<T> *wT, size_t n, double *d) {
+  for (size_t i = 0; i < n; i++) {
+    for (int k = 0; k < 9; k++) d[12 * i + k] = Derivative(wT[i].R[k]);
+    for (int k = 0; k < 3; k++) d[12 * i + 9 + k] = Derivative(wT[i].t[k]);
+  }
+}
+)code";
+
+// Robot-independent kernels wrapping the generated templates.
+const char *const kKernelWrappers = R"code(
+void ForwardKinematicsKernel(const double *q, const double *wTroot,
+                             double *poses) {
+  Pose<double> cTp[kLinkArray], wT[kLinkArray];
+  Poses(q, wTroot, cTp, wT);
+  WritePoses(wT, kNumLinks, poses);
+}
+
+void InverseDynamicsKernel(const double *q, const double *v, const double *a,
+                           const double *wTroot, const double *V_root,
+                           double *tau) {
+  InverseDynamics(q, v, a, wTroot, V_root, tau);
+}
+
+void ForwardDynamicsKernel(const double *q, const double *v,
+                           const double *tau, const double *wTroot,
+                           const double *V_root, double *qdd) {
+  ForwardDynamics(q, v, tau, wTroot, V_root, qdd);
+}
+
+void ForwardKinematicsJacobianKernel(const double *q, const double *wTroot,
+                                     double *poses, double *J_q) {
+  if (poses) ForwardKinematicsKernel(q, wTroot, poses);
+  if (!J_q) return;
+  Dual dq[kJointArray];
+  Pose<Dual> cTp[kLinkArray], wT[kLinkArray];
+  for (size_t k = 0; k < kNumJoints; k++) {
+    Seed(q, kNumJoints, k, dq);
+    Poses(dq, wTroot, cTp, wT);
+    WritePoseDerivatives(wT, kNumLinks, J_q + 12 * kNumLinks * k);
+  }
+}
+
+void InverseDynamicsJacobianKernel(const double *q, const double *v,
+                                   const double *a, const double *wTroot,
+                                   const double *V_root, double *tau,
+                                   double *J_q, double *J_v) {
+  if (tau) InverseDynamicsKernel(q, v, a, wTroot, V_root, tau);
+  Dual dq[kJointArray], dv[kJointArray], da[kJointArray];
+  Dual dtau[kJointArray];
+  Seed(q, kNumJoints, kNumJoints, dq);
+  Seed(v, kNumJoints, kNumJoints, dv);
+  Seed(a, kNumJoints, kNumJoints, da);
+  for (size_t k = 0; k < kNumJoints; k++) {
+    if (J_q) {
+      dq[k].d = 1.0;
+      InverseDynamics(dq, dv, da, wTroot, V_root, dtau);
+      dq[k].d = 0.0;
+      Derivatives(dtau, kNumJoints, J_q + kNumJoints * k);
+    }
+    if (J_v) {
+      dv[k].d = 1.0;
+      InverseDynamics(dq, dv, da, wTroot, V_root, dtau);
+      dv[k].d = 0.0;
+      Derivatives(dtau, kNumJoints, J_v + kNumJoints * k);
+    }
+  }
+}
+
+void ForwardDynamicsJacobianKernel(const double *q, const double *v,
+                                   const double *tau, const double *wTroot,
+                                   const double *V_root, double *qdd,
+                                   double *J_q, double *J_v, double *J_tau) {
+  if (qdd) ForwardDynamicsKernel(q, v, tau, wTroot, V_root, qdd);
+  Dual dq[kJointArray], dv[kJointArray], dtau[kJointArray];
+  Dual dqdd[kJointArray];
+  Seed(q, kNumJoints, kNumJoints, dq);
+  Seed(v, kNumJoints, kNumJoints, dv);
+  Seed(tau, kNumJoints, kNumJoints, dtau);
+  for (size_t k = 0; k < kNumJoints; k++) {
+    if (J_q) {
+      dq[k].d = 1.0;
+      ForwardDynamics(dq, dv, dtau, wTroot, V_root, dqdd);
+      dq[k].d = 0.0;
+      Derivatives(dqdd, kNumJoints, J_q + kNumJoints * k);
+    }
+    if (J_v) {
+      dv[k].d = 1.0;
+      ForwardDynamics(dq, dv, dtau, wTroot, V_root, dqdd);
+      dv[k].d = 0.0;
+      Derivatives(dqdd, kNumJoints, J_v + kNumJoints * k);
+    }
+    if (J_tau) {
+      dtau[k].d = 1.0;
+      ForwardDynamics(dq, dv, dtau, wTroot, V_root, dqdd);
+      dtau[k].d = 0.0;
+      Derivatives(dqdd, kNumJoints, J_tau + kNumJoints * k);
+    }
+  }
+}
+)code";
+}  // namespace
+
+/* ************************************************************************* */
+uint64_t RobotFingerprint(const Robot &robot,
+                          const boost::optional<Vector3> &gravity) {
+  std::ostringstream os;
+  os << std::setprecision(17);
+  const auto write_matrix = [&os](const gtsam::Matrix &M) {
+    for (int k = 0; k < M.size(); k++) os << ' ' << M.data()[k];
+  };
+
+  for (auto &&link : robot.links()) {
+    os << "link " << link->name() << ' ' << link->id() << ' ' << link->mass();
+    write_matrix(link->inertia());
+    const bool fixed = robot.isFixed(link);
+    os << " fixed " << fixed;
+    if (fixed) write_matrix(robot.fixedPose(link).matrix());
+    os << '\n';
+  }
+  for (auto &&joint : robot.joints()) {
+    os << "joint " << joint->name() << ' ' << joint->id() << ' '
+       << char(joint->type()) << ' ' << joint->parent()->name() << ' '
+       << joint->child()->name();
+    write_matrix(joint->pMc().matrix());
+    write_matrix(joint->cScrewAxis());
+    os << '\n';
+  }
+  os << "gravity";
+  if (gravity) write_matrix(*gravity);
+
+  // 64-bit FNV-1a.
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : os.str()) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/* ************************************************************************* */
+DynamicsCodeGenerator::DynamicsCodeGenerator(
+    const Robot &robot, const boost::optional<Vector3> &gravity)
+    : ArticulatedBodySolver(robot, gravity),
+      fingerprint_(RobotFingerprint(robot, gravity)) {}
+
+/* ************************************************************************* */
+void DynamicsCodeGenerator::emitPoses(std::ostream &os) const {
+  os << "template <class T>\n"
+        "void Poses(const T *q, const double *wTroot, Pose<T> *cTp,\n"
+        "           Pose<T> *wT) {\n";
+  const std::string root = Index("wT", root_index_);
+  if (root_fixed_) {
+    os << "  (void)wTroot;\n"
+       << "  " << root << " = " << PoseLiteral(root_fixed_pose_) << ";\n";
+  } else {
+    os << "  " << root << " = RootPose<T>(wTroot);\n";
+  }
+
+  for (const TreeJoint &tj : tree_) {
+    const JointKernel &kernel = tj.kernel;
+    const size_t p = tj.parent_index, c = tj.child_index;
+    const std::string q = Index("q", tj.joint_index);
+    const Vector3 w = kernel.cScrewAxis.head<3>();
+    const Vector3 v = kernel.cScrewAxis.tail<3>();
+    os << "\n  // " << tj.joint->name() << ": " << links_[p]->name()
+       << " -> " << links_[c]->name() << "\n  {\n";
+
+    const std::string pMc = PoseLiteral(kernel.pMc);
+    if (kernel.type == Joint::Type::Fixed) {
+      os << "    const Pose<T> X = " << pMc << ";\n";
+    } else if (kernel.type == Joint::Type::Prismatic || IsZero(w.norm())) {
+      // exp(S q) = (I, v q)
+      os << "    Pose<T> E = ConstPose<T>({1.0, 0.0, 0.0, 0.0, 1.0, 0.0, "
+            "0.0, 0.0, 1.0},\n"
+            "                             {0.0, 0.0, 0.0});\n";
+      for (size_t k = 0; k < 3; k++) {
+        if (IsZero(v(k))) continue;
+        os << "    E.t[" << k << "] = " << Combination({{v(k), q}}) << ";\n";
+      }
+      os << "    const Pose<T> X = Compose(" << pMc << ", E);\n";
+    } else {
+      // Rodrigues with K = [w / |w|]^ and th = |w| q, and the translation
+      // (I - R) (w x v) / |w|^2 + w (w . v) q / |w|^2 of the screw motion.
+      const double norm = w.norm();
+      const Matrix3 K = gtsam::skewSymmetric(w / norm), K2 = K * K;
+      const Vector3 u = w.cross(v) / (norm * norm);
+      const Vector3 a = -K * u, b = -K2 * u;
+      const Vector3 h = w * w.dot(v) / (norm * norm);
+      os << "    const T th = " << Combination({{norm, q}}) << ";\n"
+         << "    const T s = sin(th), omc = 1.0 - cos(th);\n"
+         << "    Pose<T> E;\n";
+      for (size_t k = 0; k < 9; k++) {
+        const size_t r = k / 3, col = k % 3;
+        os << "    E.R[" << k << "] = "
+           << Combination({{K(r, col), "s"}, {K2(r, col), "omc"}},
+                          r == col ? 1.0 : 0.0)
+           << ";\n";
+      }
+      for (size_t k = 0; k < 3; k++) {
+        os << "    E.t[" << k << "] = "
+           << Combination({{a(k), "s"}, {b(k), "omc"}, {h(k), q}}) << ";\n";
+      }
+      os << "    const Pose<T> X = Compose(" << pMc << ", E);\n";
+    }
+
+    // X is the joint child in the joint parent frame.
+    const std::string child = Index("wT", c), parent = Index("wT", p);
+    if (tj.aligned) {
+      os << "    " << Index("cTp", c) << " = Inverse(X);\n"
+         << "    " << child << " = Compose(" << parent << ", X);\n";
+    } else {
+      os << "    " << Index("cTp", c) << " = X;\n"
+         << "    " << child << " = Compose(" << parent << ", Inverse(X));\n";
+    }
+    os << "  }\n";
+  }
+  os << "}\n\n";
+}
+
+/* ************************************************************************* */
+void DynamicsCodeGenerator::emitVelocities(std::ostream &os) const {
+  os << "template <class T>\n"
+        "void Velocities(const Pose<T> *cTp, const T *v, const double "
+        "*V_root,\n"
+        "                T (*V)[6], T (*bias)[6]) {\n";
+  const size_t r = root_index_;
+  if (root_fixed_) {
+    os << "  (void)V_root;\n  SetZero(V[" << r << "]);\n";
+  } else {
+    os << "  for (int k = 0; k < 6; k++) {\n"
+       << "    V[" << r << "][k] = T(V_root ? V_root[k] : 0.0);\n  }\n";
+  }
+  os << "  SetZero(bias[" << r << "]);\n";
+
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index;
+    const std::string Vc = Index("V", c);
+    os << "  Adjoint(cTp[" << c << "], " << Index("V", tj.parent_index)
+       << ", " << Vc << ");\n";
+    if (tj.S.isZero()) {
+      os << "  SetZero(bias[" << c << "]);\n";
+      continue;
+    }
+    const std::string v = Index("v", tj.joint_index);
+    os << "  {\n    const T Sv[6] = {";
+    for (size_t k = 0; k < 6; k++) {
+      os << Combination({{tj.S(k), v}}) << (k == 5 ? "};\n" : ", ");
+    }
+    for (size_t k = 0; k < 6; k++) {
+      if (IsZero(tj.S(k))) continue;
+      os << "    " << Vc << "[" << k << "] += Sv[" << k << "];\n";
+    }
+    os << "    ad(" << Vc << ", Sv, bias[" << c << "]);\n  }\n";
+  }
+  os << "}\n\n";
+}
+
+/* ************************************************************************* */
+void DynamicsCodeGenerator::emitLinkWrench(std::ostream &os, size_t i,
+                                           bool with_accel,
+                                           const std::string &wrench) const {
+  const Matrix3 &I = links_[i]->inertia();
+  const double m = links_[i]->mass();
+  const std::string V = Index("V", i), A = Index("A", i);
+
+  // Products with the inertia diag(I, m I3), written out.
+  const auto inertia_times = [&](const std::string &x) -> std::string {
+    std::string out = "{";
+    for (size_t r = 0; r < 3; r++) {
+      Terms terms;
+      for (size_t k = 0; k < 3; k++) terms.emplace_back(I(r, k), Index(x, k));
+      out += Combination(terms) + ", ";
+    }
+    for (size_t r = 3; r < 6; r++) {
+      out += Combination({{m, Index(x, r)}}) + (r == 5 ? "}" : ", ");
+    }
+    return out;
+  };
+
+  os << "  {  // " << links_[i]->name() << "\n"
+     << "    const T GV[6] = " << inertia_times(V) << ";\n"
+     << "    T C[6];\n"
+     << "    adTranspose(" << V << ", GV, C);\n";
+  if (with_accel) os << "    const T GA[6] = " << inertia_times(A) << ";\n";
+  if (gravity_) {
+    os << "    const T mg[3] = " << VectorLiteral(*gravity_ * m) << ";\n"
+       << "    T g[3];\n"
+       << "    RotateT(wT[" << i << "].R, mg, g);\n";
+  }
+  for (size_t k = 0; k < 6; k++) {
+    os << "    " << wrench << "[" << k << "] = "
+       << (with_accel ? "GA[" + std::to_string(k) + "] - " : "-") << "C[" << k
+       << "]";
+    if (gravity_ && k >= 3) os << " - g[" << k - 3 << "]";
+    os << ";\n";
+  }
+  os << "  }\n";
+}
+
+/* ************************************************************************* */
+void DynamicsCodeGenerator::emitInverseDynamics(std::ostream &os) const {
+  os << "template <class T>\n"
+        "void InverseDynamics(const T *q, const T *v, const T *a,\n"
+        "                     const double *wTroot, const double *V_root,\n"
+        "                     T *tau) {\n"
+        "  Pose<T> cTp[kLinkArray], wT[kLinkArray];\n"
+        "  T V[kLinkArray][6], bias[kLinkArray][6];\n"
+        "  T A[kLinkArray][6], F[kLinkArray][6];\n"
+        "  Poses(q, wTroot, cTp, wT);\n"
+        "  Velocities(cTp, v, V_root, V, bias);\n"
+     << "  SetZero(A[" << root_index_ << "]);\n";
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index;
+    const std::string Ac = Index("A", c);
+    os << "  Adjoint(cTp[" << c << "], " << Index("A", tj.parent_index)
+       << ", " << Ac << ");\n";
+    if (tj.S.isZero()) continue;
+    for (size_t k = 0; k < 6; k++) {
+      if (IsZero(tj.S(k))) continue;
+      os << "  " << Ac << "[" << k << "] += "
+         << Combination({{tj.S(k), Index("a", tj.joint_index)}}) << ";\n";
+    }
+    os << "  Add(bias[" << c << "], " << Ac << ");\n";
+  }
+
+  // Wrenches exerted by the joints on the tree children.
+  for (size_t i = 0; i < links_.size(); i++) {
+    emitLinkWrench(os, i, true, Index("F", i));
+  }
+  for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+    os << "  {\n    T Fp[6];\n"
+       << "    AdjointTranspose(cTp[" << it->child_index << "], "
+       << Index("F", it->child_index) << ", Fp);\n"
+       << "    Add(Fp, " << Index("F", it->parent_index) << ");\n  }\n";
+  }
+
+  // A floating root has no joint wrench: correct with the root acceleration.
+  if (!root_fixed_) {
+    const size_t r = root_index_;
+    os << "  T IC[kLinkArray][36], dA[kLinkArray][6];\n";
+    for (size_t i = 0; i < links_.size(); i++) {
+      os << "  SetInertia(IC[" << i << "], "
+         << MatrixLiteral(links_[i]->inertia()) << ", "
+         << Num(links_[i]->mass()) << ");\n";
+    }
+    for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+      os << "  CongruenceAdd(cTp[" << it->child_index << "], "
+         << Index("IC", it->child_index) << ", "
+         << Index("IC", it->parent_index) << ");\n";
+    }
+    os << "  Solve6(IC[" << r << "], F[" << r << "], dA[" << r << "]);\n"
+       << "  Negate(dA[" << r << "]);\n";
+    for (const TreeJoint &tj : tree_) {
+      const size_t c = tj.child_index;
+      os << "  Adjoint(cTp[" << c << "], " << Index("dA", tj.parent_index)
+         << ", " << Index("dA", c) << ");\n"
+         << "  {\n    T dF[6];\n"
+         << "    MatVec6(IC[" << c << "], dA[" << c << "], dF);\n"
+         << "    Add(dF, F[" << c << "]);\n  }\n";
+    }
+  }
+
+  for (const TreeJoint &tj : tree_) {
+    os << "  " << Index("tau", tj.joint_index) << " = "
+       << Combination(ScrewTerms(tj.S, Index("F", tj.child_index))) << ";\n";
+  }
+  os << "}\n\n";
+}
+
+/* ************************************************************************* */
+void DynamicsCodeGenerator::emitForwardDynamics(std::ostream &os) const {
+  os << "template <class T>\n"
+        "void ForwardDynamics(const T *q, const T *v, const T *tau,\n"
+        "                     const double *wTroot, const double *V_root,\n"
+        "                     T *qdd) {\n"
+        "  Pose<T> cTp[kLinkArray], wT[kLinkArray];\n"
+        "  T V[kLinkArray][6], bias[kLinkArray][6];\n"
+        "  T IA[kLinkArray][36], pA[kLinkArray][6], A[kLinkArray][6];\n"
+        "  T U[kJointArray][6], D[kJointArray], u[kJointArray];\n"
+        "  Poses(q, wTroot, cTp, wT);\n"
+        "  Velocities(cTp, v, V_root, V, bias);\n";
+  for (size_t i = 0; i < links_.size(); i++) {
+    os << "  SetInertia(IA[" << i << "], "
+       << MatrixLiteral(links_[i]->inertia()) << ", "
+       << Num(links_[i]->mass()) << ");\n";
+    emitLinkWrench(os, i, false, Index("pA", i));
+  }
+
+  // Backward pass: articulated inertias, with U = IA * S and D = S^T * U.
+  for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+    const size_t c = it->child_index, p = it->parent_index,
+                 j = it->joint_index;
+    const std::string IAc = Index("IA", c), pAc = Index("pA", c);
+    const std::string Uj = Index("U", j), Dj = Index("D", j),
+                      uj = Index("u", j);
+    os << "  // " << it->joint->name() << "\n  {\n";
+    if (it->S.isZero()) {
+      os << "    T pa[6];\n"
+         << "    MatVec6(" << IAc << ", bias[" << c << "], pa);\n"
+         << "    Add(" << pAc << ", pa);\n"
+         << "    CongruenceAdd(cTp[" << c << "], " << IAc << ", "
+         << Index("IA", p) << ");\n";
+    } else {
+      for (size_t r = 0; r < 6; r++) {
+        Terms terms;
+        for (size_t k = 0; k < 6; k++) {
+          terms.emplace_back(it->S(k), IAc + "[" + std::to_string(6 * r + k) +
+                                           "]");
+        }
+        os << "    " << Uj << "[" << r << "] = " << Combination(terms)
+           << ";\n";
+      }
+      os << "    " << Dj << " = " << Combination(ScrewTerms(it->S, Uj))
+         << ";\n"
+         << "    " << uj << " = " << Index("tau", j) << " - ("
+         << Combination(ScrewTerms(it->S, pAc)) << ");\n"
+         << "    T Ia[36], pa[6];\n"
+         << "    RankOneDowndate(" << IAc << ", " << Uj << ", " << Dj
+         << ", Ia);\n"
+         << "    MatVec6(Ia, bias[" << c << "], pa);\n"
+         << "    for (int k = 0; k < 6; k++) {\n"
+         << "      pa[k] += " << pAc << "[k] + " << Uj << "[k] * " << uj
+         << " / " << Dj << ";\n    }\n"
+         << "    CongruenceAdd(cTp[" << c << "], Ia, " << Index("IA", p)
+         << ");\n";
+    }
+    os << "    T pp[6];\n"
+       << "    AdjointTranspose(cTp[" << c << "], pa, pp);\n"
+       << "    Add(pp, " << Index("pA", p) << ");\n  }\n";
+  }
+
+  // Root acceleration: zero for a fixed base, no joint wrench when floating.
+  const size_t r = root_index_;
+  if (root_fixed_) {
+    os << "  SetZero(A[" << r << "]);\n";
+  } else {
+    os << "  Solve6(IA[" << r << "], pA[" << r << "], A[" << r << "]);\n"
+       << "  Negate(A[" << r << "]);\n";
+  }
+
+  // Forward pass: joint accelerations.
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index, j = tj.joint_index;
+    const std::string Ac = Index("A", c);
+    os << "  Adjoint(cTp[" << c << "], " << Index("A", tj.parent_index)
+       << ", " << Ac << ");\n"
+       << "  Add(bias[" << c << "], " << Ac << ");\n";
+    if (tj.S.isZero()) {
+      os << "  " << Index("qdd", j) << " = T(0);\n";
+      continue;
+    }
+    os << "  {\n    const T a_j = (" << Index("u", j) << " - Dot6("
+       << Index("U", j) << ", " << Ac << ")) / " << Index("D", j) << ";\n";
+    for (size_t k = 0; k < 6; k++) {
+      if (IsZero(tj.S(k))) continue;
+      os << "    " << Ac << "[" << k << "] += "
+         << Combination({{tj.S(k), "a_j"}}) << ";\n";
+    }
+    os << "    " << Index("qdd", j) << " = a_j;\n  }\n";
+  }
+  os << "}\n\n";
+}
+
+/* ************************************************************************* */
+std::string DynamicsCodeGenerator::generate(const std::string &symbol) const {
+  std::ostringstream os;
+  os << "// Kinematics and dynamics kernels generated by GTDynamics.\n"
+        "// Do not edit: regenerate with DynamicsCodeGenerator instead.\n"
+     << "// Root link: " << links_[root_index_]->name()
+     << (root_fixed_ ? " (fixed)" : " (floating)") << "\n"
+     << kPreamble << "\n"
+     << "constexpr size_t kNumLinks = " << links_.size() << ";\n"
+     << "constexpr size_t kNumJoints = " << joints_.size() << ";\n"
+     << "constexpr size_t kLinkArray = " << std::max<size_t>(links_.size(), 1)
+     << ";\n"
+     << "constexpr size_t kJointArray = "
+     << std::max<size_t>(joints_.size(), 1) << ";\n\n";
+
+  emitPoses(os);
+  emitVelocities(os);
+  emitInverseDynamics(os);
+  emitForwardDynamics(os);
+
+  char fingerprint[32];
+  std::snprintf(fingerprint, sizeof(fingerprint), "0x%016llxull",
+                static_cast<unsigned long long>(fingerprint_));
+  os << kKernelWrappers << "\n"
+     << "const gtdynamics::GeneratedKernels kKernels = {\n"
+     << "    gtdynamics::kGeneratedKernelsAbiVersion,\n"
+     << "    " << fingerprint << ",\n"
+     << "    kNumLinks,\n    kNumJoints,\n"
+     << "    " << root_index_ << ",\n"
+     << "    " << (root_fixed_ ? "true" : "false") << ",\n"
+     << "    &ForwardKinematicsKernel,\n"
+     << "    &InverseDynamicsKernel,\n"
+     << "    &ForwardDynamicsKernel,\n"
+     << "    &ForwardKinematicsJacobianKernel,\n"
+     << "    &InverseDynamicsJacobianKernel,\n"
+     << "    &ForwardDynamicsJacobianKernel};\n\n"
+     << "}  // namespace\n\n"
+     << "extern \"C\" GTD_GENERATED_EXPORT const gtdynamics::GeneratedKernels "
+        "*\n"
+     << symbol << "() {\n  return &kKernels;\n}\n";
+  return os.str();
+}
+
+/* ************************************************************************* */
+void DynamicsCodeGenerator::write(const std::string &filename,
+                                  const std::string &symbol) const {
+  std::ofstream file(filename);
+  if (!file) {
+    throw std::runtime_error("DynamicsCodeGenerator: cannot open " +
+                             filename);
+  }
+  file << generate(symbol);
+}
+
+}  // namespace gtdynamics
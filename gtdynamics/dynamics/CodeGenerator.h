@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CodeGenerator.h
+ * @brief Generation of robot-specific kinematics and dynamics kernels.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/dynamics/GeneratedKernels.h>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Return a fingerprint of the links, joints and gravity of a robot: names,
+ * ids, types, rest poses, screw axes and inertias. Kernels generated for a
+ * robot embed it, so that they are only used with the same robot.
+ */
+uint64_t RobotFingerprint(
+    const Robot &robot,
+    const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+/**
+ * DynamicsCodeGenerator emits C++ source of the forward kinematics, the RNEA
+ * and the ABA of one robot, and of their Jacobians, with the same results as
+ * ArticulatedBodySolver. The traversal is unrolled into straight-line code,
+ * with the rest poses, screw axes, inertias and gravity written as literals
+ * and the products with zero entries of screw axes and inertias removed.
+ *
+ * The kernels are templated on the scalar type and instantiated both with
+ * doubles and with forward-mode dual numbers, which yield the Jacobians. The
+ * source only includes GeneratedKernels.h and <cmath>, and defines an
+ * exported function returning a GeneratedKernels, so it can be compiled
+ * into a plugin and loaded with GeneratedDynamics::Load.
+ */
+class DynamicsCodeGenerator : public ArticulatedBodySolver {
+ private:
+  uint64_t fingerprint_;
+
+  /// Emit the link poses, and the poses cTp of the tree parents.
+  void emitPoses(std::ostream &os) const;
+
+  /// Emit the link twists, and their velocity-product accelerations.
+  void emitVelocities(std::ostream &os) const;
+
+  /**
+   * Emit the wrench of link i for its twist and optional acceleration,
+   * without the joint wrenches: G * A - ad(V)^T * G * V - gravity.
+   */
+  void emitLinkWrench(std::ostream &os, size_t i, bool with_accel,
+                      const std::string &wrench) const;
+
+  /// Emit the RNEA.
+  void emitInverseDynamics(std::ostream &os) const;
+
+  /// Emit the ABA.
+  void emitForwardDynamics(std::ostream &os) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot    the robot, must be a tree
+   * @param gravity  gravity in world frame
+   */
+  DynamicsCodeGenerator(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Return the fingerprint embedded in the generated kernels.
+  uint64_t fingerprint() const { return fingerprint_; }
+
+  /**
+   * Return the source of the kernels.
+   * @param symbol name of the exported function returning the kernels
+   */
+  std::string generate(
+      const std::string &symbol = kGeneratedKernelsSymbol) const;
+
+  /// Write the source of the kernels to a file.
+  void write(const std::string &filename,
+             const std::string &symbol = kGeneratedKernelsSymbol) const;
+};
+
+}  // namespace gtdynamics
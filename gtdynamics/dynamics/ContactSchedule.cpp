@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSchedule.cpp
+ * @brief Contact schedules discovered by contact-implicit trajectory
+ * optimization.
+ */
+
+#include <gtdynamics/dynamics/ContactSchedule.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ContactSchedule ExtractContactSchedule(
+    const gtsam::Values &values, const PointOnLinks &candidates,
+    size_t num_steps, const boost::optional<gtsam::Vector3> &gravity,
+    double force_threshold) {
+  if (num_steps == 0) {
+    throw std::invalid_argument("ExtractContactSchedule: needs steps.");
+  }
+  const gtsam::Vector3 g = gravity ? *gravity : gtsam::Vector3(0, 0, -9.8);
+  const gtsam::Vector3 up =
+      g.norm() > 0 ? gtsam::Vector3(-g.normalized()) : gtsam::Vector3::UnitZ();
+
+  // Which candidates push on the ground at knot k.
+  auto contacts = [&](size_t k) -> std::vector<bool> {
+    std::vector<bool> in_contact(candidates.size(), false);
+    for (size_t c = 0; c < candidates.size(); c++) {
+      const int i = candidates[c].link->id();
+      const gtsam::Key wrench_key = ContactWrenchKey(i, 0, k);
+      if (!values.exists(wrench_key)) continue;
+      const gtsam::Vector6 wrench = values.at<gtsam::Vector6>(wrench_key);
+      const gtsam::Vector3 f =
+          Pose(values, i, k).rotation().rotate(wrench.tail<3>());
+      in_contact[c] = up.dot(f) > force_threshold;
+    }
+    return in_contact;
+  };
+
+  ContactSchedule schedule;
+  std::vector<bool> previous;
+  for (size_t k = 1; k <= num_steps; k++) {
+    const std::vector<bool> current = contacts(k);
+    if (k == 1 || current != previous) {
+      PointOnLinks points;
+      for (size_t c = 0; c < candidates.size(); c++) {
+        if (current[c]) points.push_back(candidates[c]);
+      }
+      schedule.phase_steps.push_back(0);
+      schedule.phase_contact_points.push_back(points);
+      previous = current;
+    }
+    schedule.phase_steps.back()++;
+  }
+  return schedule;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSchedule.h
+ * @brief Contact schedules discovered by contact-implicit trajectory
+ * optimization.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Phases of a trajectory, in the layout of multiPhaseTrajectoryFG.
+struct ContactSchedule {
+  std::vector<int> phase_steps;                    ///< intervals per phase
+  std::vector<PointOnLinks> phase_contact_points;  ///< contacts per phase
+};
+
+/**
+ * Extract the contact schedule of a contact-implicit solution, i.e., one
+ * with OptimizerSetting::contact_implicit, so that the fixed-schedule
+ * multi-phase formulation can polish it.
+ *
+ * A candidate is in contact at a step when the normal component of its
+ * contact force exceeds force_threshold. Step k, the interval ending at knot
+ * k, takes the contacts of knot k, and runs of steps with the same contacts
+ * make up the phases; knot 0 joins the first phase.
+ * @param values           solution of the contact-implicit trajectory graph
+ * @param candidates       candidate contact points of the solve
+ * @param num_steps        number of intervals of the trajectory
+ * @param gravity          gravity, defines the up direction; -z if none
+ * @param force_threshold  smallest normal force of a contact
+ */
+ContactSchedule ExtractContactSchedule(
+    const gtsam::Values &values, const PointOnLinks &candidates,
+    size_t num_steps,
+    const boost::optional<gtsam::Vector3> &gravity = boost::none,
+    double force_threshold = 1.0);
+
+}  // namespace gtdynamics
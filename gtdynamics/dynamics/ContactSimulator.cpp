@@ -0,0 +1,256 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSimulator.cpp
+ * @brief Time-stepping simulation with frictional contacts on the terrain.
+ */
+
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Matrix3;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// Columns: the unit normal, then two unit tangents.
+Matrix3 ContactBasis(const Vector3 &normal) {
+  Vector3 t1 = normal.cross(Vector3::UnitX());
+  if (t1.norm() < 1e-6) t1 = normal.cross(Vector3::UnitY());
+  t1.normalize();
+  Matrix3 basis;
+  basis << normal, t1, normal.cross(t1);
+  return basis;
+}
+
+// Velocity of point p along direction d, both in the frame of the twist.
+double PointVelocity(const Vector6 &twist, const Point3 &p, const Vector3 &d) {
+  return d.dot(twist.tail<3>() + twist.head<3>().cross(p));
+}
+}  // namespace
+
+/* ************************************************************************* */
+ContactSimulator::ContactSimulator(
+    const Robot &robot, const Values &initial_values,
+    const PointOnLinks &contact_points,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const ContactSimulatorParams &params)
+    : solver_(robot, gravity),
+      params_(params),
+      wTroot_(solver_.rootPose(initial_values)),
+      V_root_(solver_.rootTwist(initial_values)) {
+  const size_t m = solver_.numJoints();
+  q_ = Vector::Zero(m);
+  v_ = Vector::Zero(m);
+  for (size_t j = 0; j < m; j++) {
+    const int id = solver_.joints()[j]->id();
+    if (initial_values.exists(JointAngleKey(id)))
+      q_(j) = JointAngle(initial_values, id);
+    if (initial_values.exists(JointVelKey(id)))
+      v_(j) = JointVel(initial_values, id);
+  }
+  wrenches_.assign(solver_.links().size(), Vector6::Zero());
+  setContactPoints(contact_points);
+}
+
+/* ************************************************************************* */
+void ContactSimulator::setContactPoints(const PointOnLinks &contact_points) {
+  const auto &links = solver_.links();
+  std::vector<size_t> contact_links;
+  for (auto &&cp : contact_points) {
+    auto it = std::find_if(links.begin(), links.end(),
+                           [&cp](const LinkSharedPtr &link) {
+                             return link->id() == cp.link->id();
+                           });
+    if (it == links.end()) {
+      throw std::invalid_argument("ContactSimulator: contact on link " +
+                                  cp.link->name() + " not in the robot.");
+    }
+    contact_links.push_back(it - links.begin());
+  }
+  contact_points_ = contact_points;
+  contact_links_ = contact_links;
+  impulses_ = Matrix::Zero(3, contact_points_.size());
+  active_.assign(contact_points_.size(), false);
+}
+
+/* ************************************************************************* */
+double ContactSimulator::terrain(const Point3 &p, Vector3 *normal) const {
+  if (!params_.height_map) {
+    *normal = Vector3::UnitZ();
+    return params_.ground_height;
+  }
+  *normal = params_.height_map->normal(p.x(), p.y());
+  return params_.height_map->height(p.x(), p.y());
+}
+
+/* ************************************************************************* */
+void ContactSimulator::step(const Vector &torques, double dt) {
+  const size_t m = solver_.numJoints();
+  if (size_t(torques.size()) != m) {
+    throw std::invalid_argument(
+        "ContactSimulator: torques must have one entry per joint.");
+  }
+  if (dt <= 0) throw std::invalid_argument("ContactSimulator: dt <= 0.");
+  const bool floating = !solver_.rootIsFixed();
+  const size_t root = std::find(solver_.links().begin(), solver_.links().end(),
+                                solver_.root()) -
+                      solver_.links().begin();
+
+  // Free motion, without contact impulses.
+  solver_.forwardDynamics(q_, v_, torques, wTroot_, V_root_, &free_,
+                          &workspace_);
+  Vector v_free = v_ + dt * free_.joint_accels;
+  Vector6 V_free = V_root_;
+  if (floating) V_free += dt * free_.twist_accels[root];
+
+  // Active contacts, with their directions in the link frames.
+  std::vector<size_t> contacts;
+  std::vector<Matrix3> directions;
+  std::vector<double> gaps;
+  for (size_t c = 0; c < contact_points_.size(); c++) {
+    const Pose3 &wTi = free_.poses[contact_links_[c]];
+    const Point3 p = wTi.transformFrom(contact_points_[c].point);
+    Vector3 normal;
+    const double gap = p.z() - terrain(p, &normal);
+    active_[c] = gap < params_.margin;
+    if (!active_[c]) {
+      impulses_.col(c).setZero();
+      continue;
+    }
+    contacts.push_back(c);
+    directions.push_back(wTi.rotation().matrix().transpose() *
+                         ContactBasis(normal));
+    // The gap along the normal, for a locally planar terrain.
+    gaps.push_back(gap * normal.z());
+  }
+  num_sweeps_ = 0;
+
+  const size_t num_rows = 3 * contacts.size();
+  Matrix response(m + 6, num_rows);  // velocity change per unit impulse
+  Matrix W(num_rows, num_rows);
+  Vector b(num_rows), lambda(num_rows);
+  if (num_rows > 0) {
+    // Contact velocities of the free motion.
+    solver_.forwardDynamics(q_, v_free, torques, wTroot_, V_free, &probe_,
+                            &workspace_);
+    for (size_t a = 0; a < contacts.size(); a++) {
+      const size_t c = contacts[a];
+      const Point3 &p = contact_points_[c].point;
+      for (size_t d = 0; d < 3; d++) {
+        b(3 * a + d) = PointVelocity(probe_.twists[contact_links_[c]], p,
+                                     directions[a].col(d));
+      }
+      // Approach until touching within the step, and remove penetration.
+      b(3 * a) += gaps[a] > 0 ? gaps[a] / dt : params_.erp * gaps[a] / dt;
+    }
+
+    // Delassus matrix: the response to unit contact forces is linear, the
+    // difference with the free motion.
+    for (size_t k = 0; k < num_rows; k++) {
+      const size_t c = contacts[k / 3], i = contact_links_[c];
+      const Vector3 f = directions[k / 3].col(k % 3);
+      wrenches_[i].head<3>() = contact_points_[c].point.cross(f);
+      wrenches_[i].tail<3>() = f;
+      solver_.forwardDynamics(q_, v_, torques, wTroot_, V_root_, &probe_,
+                              &workspace_, &wrenches_);
+      wrenches_[i].setZero();
+
+      response.col(k).head(m) = probe_.joint_accels - free_.joint_accels;
+      response.col(k).tail<6>() =
+          floating ? Vector6(probe_.twist_accels[root] -
+                             free_.twist_accels[root])
+                   : Vector6(Vector6::Zero());
+      for (size_t a = 0; a < contacts.size(); a++) {
+        const size_t c_a = contacts[a], i_a = contact_links_[c_a];
+        const Vector6 dA = probe_.twist_accels[i_a] - free_.twist_accels[i_a];
+        for (size_t d = 0; d < 3; d++) {
+          W(3 * a + d, k) = PointVelocity(dA, contact_points_[c_a].point,
+                                          directions[a].col(d));
+        }
+      }
+    }
+
+    // Projected Gauss-Seidel, warm-started with the last impulses.
+    for (size_t a = 0; a < contacts.size(); a++) {
+      lambda.segment<3>(3 * a) = impulses_.col(contacts[a]);
+    }
+    for (; num_sweeps_ < params_.max_iterations; num_sweeps_++) {
+      double max_change = 0;
+      for (size_t a = 0; a < contacts.size(); a++) {
+        const size_t n = 3 * a;
+        if (W(n, n) <= 1e-12) continue;  // contact on a fixed link
+        const Vector3 old = lambda.segment<3>(n);
+
+        // Non-penetration.
+        lambda(n) = std::max(
+            0.0, lambda(n) - (b(n) + W.row(n).dot(lambda)) / W(n, n));
+
+        // Friction, projected on the disk of the friction cone.
+        for (size_t t = n + 1; t < n + 3; t++) {
+          if (W(t, t) > 1e-12) {
+            lambda(t) -= (b(t) + W.row(t).dot(lambda)) / W(t, t);
+          }
+        }
+        const double bound = params_.mu * lambda(n);
+        const double tangential = lambda.segment<2>(n + 1).norm();
+        if (tangential > bound) {
+          lambda.segment<2>(n + 1) *= bound / tangential;
+        }
+        max_change = std::max(
+            max_change, (lambda.segment<3>(n) - old).cwiseAbs().maxCoeff());
+      }
+      if (max_change < params_.tolerance) {
+        num_sweeps_++;
+        break;
+      }
+    }
+    for (size_t a = 0; a < contacts.size(); a++) {
+      impulses_.col(contacts[a]) = lambda.segment<3>(3 * a);
+    }
+
+    const Vector du = response * lambda;
+    v_free += du.head(m);
+    if (floating) V_free += du.tail<6>();
+  }
+
+  // Semi-implicit Euler, on SE(3) for the root.
+  v_ = v_free;
+  q_ += dt * v_;
+  if (floating) {
+    V_root_ = V_free;
+    wTroot_ = wTroot_ * Pose3::Expmap(dt * V_root_);
+  }
+}
+
+/* ************************************************************************* */
+Values ContactSimulator::values() const {
+  Values values;
+  for (size_t j = 0; j < solver_.numJoints(); j++) {
+    const int id = solver_.joints()[j]->id();
+    InsertJointAngle(&values, id, q_(j));
+    InsertJointVel(&values, id, v_(j));
+  }
+  const int root_id = solver_.root()->id();
+  InsertPose(&values, root_id, 0, wTroot_);
+  InsertTwist(&values, root_id, 0, V_root_);
+  return values;
+}
+
+}  // namespace gtdynamics
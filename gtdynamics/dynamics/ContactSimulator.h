@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSimulator.h
+ * @brief Time-stepping simulation with frictional contacts on the terrain.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/HeightMap.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of ContactSimulator.
+struct ContactSimulatorParams {
+  double mu = 1.0;              ///< Coulomb friction coefficient
+  double erp = 0.2;             ///< fraction of penetration removed per step
+  double margin = 0.01;         ///< gap below which a contact is active
+  size_t max_iterations = 100;  ///< maximum number of Gauss-Seidel sweeps
+  double tolerance = 1e-10;     ///< on the largest impulse change of a sweep
+  double ground_height = 0.0;   ///< height of the ground plane, z up
+  HeightMapPtr height_map;      ///< terrain, the ground plane if null
+};
+
+/**
+ * ContactSimulator steps a tree robot with a floating or fixed base through
+ * frictional contacts between points on its links and the terrain, a ground
+ * plane or a heightmap, in the velocity-level time-stepping scheme of
+ * Stewart-Trinkle and Anitescu-Potra.
+ *
+ * Each step computes the free motion with the ArticulatedBodySolver, and the
+ * Delassus matrix of the active contacts from its response to unit contact
+ * forces given as external wrenches. The contact impulses then solve the
+ * complementarity problem with non-penetration and Coulomb friction, with
+ * the friction cone projected onto a disk, by projected Gauss-Seidel sweeps
+ * warm-started with the impulses of the previous step. Positions are
+ * integrated with semi-implicit Euler, the root pose on SE(3).
+ *
+ * Contacts within `margin` of the terrain are active, and may approach it
+ * until touching within the step; penetration is removed by a fraction
+ * `erp` per step.
+ *
+ * The contact points can be those of a FootContactConstraintSpec, see
+ * setContactPoints to switch them between phases.
+ */
+class ContactSimulator {
+ private:
+  ArticulatedBodySolver solver_;
+  ContactSimulatorParams params_;
+  PointOnLinks contact_points_;
+  std::vector<size_t> contact_links_;  ///< link index of each contact
+  gtsam::Pose3 wTroot_;
+  gtsam::Vector6 V_root_;
+  gtsam::Vector q_, v_;
+
+  gtsam::Matrix impulses_;    ///< 3 x num_contacts, normal then tangents
+  std::vector<bool> active_;  ///< whether each contact was active
+  size_t num_sweeps_ = 0;
+
+  // Buffers re-used across steps.
+  TreeDynamicsResult free_, probe_;
+  TreeDynamicsWorkspace workspace_;
+  std::vector<gtsam::Vector6> wrenches_;
+
+  /// Return the terrain height and upward normal below a point.
+  double terrain(const gtsam::Point3 &p, gtsam::Vector3 *normal) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot           the robot, must be a tree
+   * @param initial_values  initial joint angles and velocities, missing ones
+   * are zero, and optionally the root link pose and twist
+   * @param contact_points  points that can touch the terrain
+   * @param gravity         gravity vector
+   * @param params          contact and solver parameters
+   */
+  ContactSimulator(
+      const Robot &robot, const gtsam::Values &initial_values,
+      const PointOnLinks &contact_points,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const ContactSimulatorParams &params = ContactSimulatorParams());
+
+  /// Replace the contact points, e.g. with those of a new stance.
+  void setContactPoints(const PointOnLinks &contact_points);
+
+  /**
+   * Simulate for one time step.
+   * @param torques  joint torques, ordered as robot.joints()
+   * @param dt       duration of the time step
+   */
+  void step(const gtsam::Vector &torques, double dt);
+
+  /// Return the current joint angles.
+  const gtsam::Vector &q() const { return q_; }
+
+  /// Return the current joint velocities.
+  const gtsam::Vector &v() const { return v_; }
+
+  /// Return the current pose of the root link CoM.
+  const gtsam::Pose3 &rootPose() const { return wTroot_; }
+
+  /// Return the current twist of the root link, in its CoM frame.
+  const gtsam::Vector6 &rootTwist() const { return V_root_; }
+
+  /// Return the contact points.
+  const PointOnLinks &contactPoints() const { return contact_points_; }
+
+  /**
+   * Return the contact impulses of the last step, one column per contact,
+   * along the terrain normal then two tangents. Divide by dt for forces.
+   */
+  const gtsam::Matrix &contactImpulses() const { return impulses_; }
+
+  /// Return whether each contact was active in the last step.
+  const std::vector<bool> &activeContacts() const { return active_; }
+
+  /// Return the number of Gauss-Seidel sweeps of the last step.
+  size_t numSweeps() const { return num_sweeps_; }
+
+  /// Return the dynamics solver.
+  const ArticulatedBodySolver &solver() const { return solver_; }
+
+  /// Return joint angles and velocities, and the root pose and twist.
+  gtsam::Values values() const;
+};
+
+}  // namespace gtdynamics
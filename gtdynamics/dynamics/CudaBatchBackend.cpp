@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CudaBatchBackend.cpp
+ * @brief Stand-in for CudaBatchBackend when built without CUDA, see
+ * CudaBatchBackend.cu for the device implementation.
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/CudaBatchBackend.h>
+
+#ifndef GTDYNAMICS_WITH_CUDA
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+struct CudaBatchBackend::Impl {};
+
+/* ************************************************************************* */
+bool CudaBatchBackend::Available() { return false; }
+
+/* ************************************************************************* */
+CudaBatchBackend::CudaBatchBackend(const FlatRobotModel &) {
+  throw std::runtime_error(
+      "CudaBatchBackend: GTDynamics was built without CUDA, configure with "
+      "-DGTDYNAMICS_WITH_CUDA=ON.");
+}
+
+/* ************************************************************************* */
+CudaBatchBackend::~CudaBatchBackend() = default;
+
+/* ************************************************************************* */
+void CudaBatchBackend::forwardKinematics(const double *, size_t,
+                                         double *) const {}
+
+/* ************************************************************************* */
+void CudaBatchBackend::forwardDynamics(const double *, const double *,
+                                       const double *, size_t,
+                                       double *) const {}
+
+/* ************************************************************************* */
+void CudaBatchBackend::simulate(const double *, const double *,
+                                const double *, size_t, size_t, double, bool,
+                                double *, double *, double *) const {}
+
+}  // namespace gtdynamics
+
+#endif  // GTDYNAMICS_WITH_CUDA
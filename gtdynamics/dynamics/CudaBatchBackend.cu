@@ -0,0 +1,255 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CudaBatchBackend.cu
+ * @brief Batched forward kinematics, dynamics and rollouts on a CUDA device.
+ */
+
+#include <gtdynamics/dynamics/CudaBatchBackend.h>
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+namespace {
+constexpr unsigned kBlockSize = 128;
+
+// Rollouts per launch of the dynamics kernels, which bounds the workspace.
+constexpr size_t kMaxRolloutsPerLaunch = size_t(1) << 15;
+
+void Check(cudaError_t status, const char *what) {
+  if (status != cudaSuccess) {
+    throw std::runtime_error(std::string("CudaBatchBackend: ") + what +
+                             ": " + cudaGetErrorString(status));
+  }
+}
+
+// Device array of doubles, only growing, re-used across calls.
+struct DeviceBuffer {
+  double *data = nullptr;
+  size_t size = 0;
+
+  DeviceBuffer() = default;
+  DeviceBuffer(const DeviceBuffer &) = delete;
+  DeviceBuffer &operator=(const DeviceBuffer &) = delete;
+  ~DeviceBuffer() { cudaFree(data); }
+
+  void reserve(size_t n) {
+    if (n <= size) return;
+    cudaFree(data);
+    data = nullptr;
+    size = 0;
+    Check(cudaMalloc(&data, n * sizeof(double)), "cudaMalloc");
+    size = n;
+  }
+
+  void upload(const double *host, size_t n) {
+    reserve(n);
+    Check(cudaMemcpy(data, host, n * sizeof(double), cudaMemcpyHostToDevice),
+          "cudaMemcpy");
+  }
+
+  void download(double *host, size_t n) const {
+    Check(cudaMemcpy(host, data, n * sizeof(double), cudaMemcpyDeviceToHost),
+          "cudaMemcpy");
+  }
+};
+
+unsigned NumBlocks(size_t num_threads) {
+  return unsigned((num_threads + kBlockSize - 1) / kBlockSize);
+}
+
+__device__ size_t ThreadIndex() {
+  return blockIdx.x * size_t(blockDim.x) + threadIdx.x;
+}
+
+__device__ Strided<const double> Const(Strided<double> x) {
+  return Strided<const double>{x.data, x.stride};
+}
+
+__global__ void ForwardKinematicsKernel(FlatRobotModel model,
+                                        const double *qs, size_t n,
+                                        double *poses) {
+  const size_t r = ThreadIndex();
+  if (r >= n) return;
+  FlatForwardKinematics(model, Strided<const double>{qs + r, n},
+                        Strided<double>{poses + r, n});
+}
+
+// Rollouts [offset, offset + width) of n, with a workspace of stride width.
+__global__ void ForwardDynamicsKernel(FlatRobotModel model, const double *qs,
+                                      const double *vs, const double *taus,
+                                      size_t n, size_t offset, size_t width,
+                                      double *workspace, double *accels) {
+  const size_t r = ThreadIndex();
+  if (r >= width) return;
+  const size_t rollout = offset + r;
+  FlatForwardDynamics(model, Strided<const double>{qs + rollout, n},
+                      Strided<const double>{vs + rollout, n},
+                      Strided<const double>{taus + rollout, n},
+                      Strided<double>{workspace + r, width},
+                      Strided<double>{accels + rollout, n});
+}
+
+__global__ void RolloutKernel(FlatRobotModel model, const double *taus,
+                              size_t n, size_t offset, size_t width,
+                              size_t num_steps, double dt, bool semi_implicit,
+                              double *workspace, double *qs, double *vs,
+                              double *accels) {
+  const size_t r = ThreadIndex();
+  if (r >= width) return;
+  const size_t rollout = offset + r, m = model.num_joints;
+  const Strided<double> q{qs + rollout, n}, v{vs + rollout, n},
+      a{accels + rollout, n};
+  const Strided<const double> tau{taus + rollout, n};
+  const Strided<double> scratch{workspace + r, width};
+  for (size_t k = 0; k < num_steps; k++) {
+    const Strided<double> q_k = q + k * m, v_k = v + k * m, a_k = a + k * m;
+    const Strided<double> q_next = q + (k + 1) * m, v_next = v + (k + 1) * m;
+    FlatForwardDynamics(model, Const(q_k), Const(v_k), tau + k * m, scratch,
+                        a_k);
+    for (size_t j = 0; j < m; j++) {
+      if (semi_implicit) {
+        v_next[j] = v_k[j] + dt * a_k[j];
+        q_next[j] = q_k[j] + dt * v_next[j];
+      } else {
+        q_next[j] = q_k[j] + dt * v_k[j] + 0.5 * dt * dt * a_k[j];
+        v_next[j] = v_k[j] + dt * a_k[j];
+      }
+    }
+  }
+}
+}  // namespace
+
+struct CudaBatchBackend::Impl {
+  FlatJoint *joints = nullptr;
+  FlatLink *links = nullptr;
+  FlatRobotModel model;  ///< pointing to device memory
+  size_t workspace_size;
+  DeviceBuffer qs, vs, taus, outputs, workspace;
+
+  ~Impl() {
+    cudaFree(joints);
+    cudaFree(links);
+  }
+
+  // Workspace of one launch, and the number of rollouts it fits.
+  size_t reserveWorkspace(size_t num_rollouts) {
+    const size_t width = std::min(num_rollouts, kMaxRolloutsPerLaunch);
+    workspace.reserve(width * workspace_size);
+    return width;
+  }
+};
+
+/* ************************************************************************* */
+bool CudaBatchBackend::Available() {
+  int num_devices = 0;
+  return cudaGetDeviceCount(&num_devices) == cudaSuccess && num_devices > 0;
+}
+
+/* ************************************************************************* */
+CudaBatchBackend::CudaBatchBackend(const FlatRobotModel &model)
+    : impl_(new Impl) {
+  const size_t joints_bytes = model.num_joints * sizeof(FlatJoint);
+  const size_t links_bytes = model.num_links * sizeof(FlatLink);
+  Check(cudaMalloc(&impl_->joints, std::max<size_t>(joints_bytes, 1)),
+        "cudaMalloc");
+  Check(cudaMalloc(&impl_->links, std::max<size_t>(links_bytes, 1)),
+        "cudaMalloc");
+  Check(cudaMemcpy(impl_->joints, model.joints, joints_bytes,
+                   cudaMemcpyHostToDevice),
+        "cudaMemcpy");
+  Check(cudaMemcpy(impl_->links, model.links, links_bytes,
+                   cudaMemcpyHostToDevice),
+        "cudaMemcpy");
+  impl_->model = model;
+  impl_->model.joints = impl_->joints;
+  impl_->model.links = impl_->links;
+  impl_->workspace_size = FlatWorkspaceSize(model);
+}
+
+/* ************************************************************************* */
+CudaBatchBackend::~CudaBatchBackend() = default;
+
+/* ************************************************************************* */
+void CudaBatchBackend::forwardKinematics(const double *qs, size_t num_rollouts,
+                                         double *poses) const {
+  if (num_rollouts == 0) return;
+  const FlatRobotModel &model = impl_->model;
+  const size_t num_poses = 12 * model.num_links * num_rollouts;
+  impl_->qs.upload(qs, model.num_joints * num_rollouts);
+  impl_->outputs.reserve(num_poses);
+  ForwardKinematicsKernel<<<NumBlocks(num_rollouts), kBlockSize>>>(
+      model, impl_->qs.data, num_rollouts, impl_->outputs.data);
+  Check(cudaGetLastError(), "forward kinematics launch");
+  impl_->outputs.download(poses, num_poses);
+}
+
+/* ************************************************************************* */
+void CudaBatchBackend::forwardDynamics(const double *qs, const double *vs,
+                                       const double *taus,
+                                       size_t num_rollouts,
+                                       double *accels) const {
+  if (num_rollouts == 0) return;
+  const FlatRobotModel &model = impl_->model;
+  const size_t size = model.num_joints * num_rollouts;
+  impl_->qs.upload(qs, size);
+  impl_->vs.upload(vs, size);
+  impl_->taus.upload(taus, size);
+  impl_->outputs.reserve(size);
+  const size_t width = impl_->reserveWorkspace(num_rollouts);
+  for (size_t offset = 0; offset < num_rollouts; offset += width) {
+    const size_t chunk = std::min(width, num_rollouts - offset);
+    ForwardDynamicsKernel<<<NumBlocks(chunk), kBlockSize>>>(
+        model, impl_->qs.data, impl_->vs.data, impl_->taus.data,
+        num_rollouts, offset, chunk, impl_->workspace.data,
+        impl_->outputs.data);
+    Check(cudaGetLastError(), "forward dynamics launch");
+  }
+  impl_->outputs.download(accels, size);
+}
+
+/* ************************************************************************* */
+void CudaBatchBackend::simulate(const double *initial_qs,
+                                const double *initial_vs,
+                                const double *torques, size_t num_rollouts,
+                                size_t num_steps, double dt,
+                                bool semi_implicit, double *qs, double *vs,
+                                double *accels) const {
+  if (num_rollouts == 0) return;
+  const FlatRobotModel &model = impl_->model;
+  const size_t m = model.num_joints;
+  const size_t state_size = m * (num_steps + 1) * num_rollouts;
+  const size_t step_size = m * num_steps * num_rollouts;
+
+  // Step 0 of the states are the initial states, in the same layout.
+  impl_->qs.reserve(state_size);
+  impl_->vs.reserve(state_size);
+  impl_->qs.upload(initial_qs, m * num_rollouts);
+  impl_->vs.upload(initial_vs, m * num_rollouts);
+  impl_->taus.upload(torques, step_size);
+  impl_->outputs.reserve(step_size);
+  const size_t width = impl_->reserveWorkspace(num_rollouts);
+  for (size_t offset = 0; offset < num_rollouts; offset += width) {
+    const size_t chunk = std::min(width, num_rollouts - offset);
+    RolloutKernel<<<NumBlocks(chunk), kBlockSize>>>(
+        model, impl_->taus.data, num_rollouts, offset, chunk, num_steps, dt,
+        semi_implicit, impl_->workspace.data, impl_->qs.data, impl_->vs.data,
+        impl_->outputs.data);
+    Check(cudaGetLastError(), "rollout launch");
+  }
+  impl_->qs.download(qs, state_size);
+  impl_->vs.download(vs, state_size);
+  impl_->outputs.download(accels, step_size);
+}
+
+}  // namespace gtdynamics
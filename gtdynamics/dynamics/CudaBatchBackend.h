@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CudaBatchBackend.h
+ * @brief Batched forward kinematics, dynamics and rollouts on a CUDA device.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/FlatRobotModel.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace gtdynamics {
+
+/**
+ * CudaBatchBackend keeps a copy of a FlatRobotModel in device memory, and
+ * runs one device thread per rollout of the flat kernels. It is only
+ * functional when GTDynamics is built with GTDYNAMICS_WITH_CUDA; otherwise
+ * its constructor throws.
+ *
+ * All buffers are host buffers in structure-of-arrays layout over the
+ * rollouts: entry e of rollout r of a buffer is at e * num_rollouts + r.
+ * They are copied to and from device buffers, which are re-used across
+ * calls with the same number of rollouts. Calls on one backend are not
+ * thread-safe.
+ */
+class CudaBatchBackend {
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+
+ public:
+  /// Return whether GTDynamics was built with CUDA and a device is present.
+  static bool Available();
+
+  /// Copy the model to the current device.
+  explicit CudaBatchBackend(const FlatRobotModel &model);
+
+  ~CudaBatchBackend();
+
+  /**
+   * Link CoM poses, 12 entries per link as in FlatForwardKinematics.
+   * @param qs     num_joints entries per rollout
+   * @param poses  12 * num_links entries per rollout
+   */
+  void forwardKinematics(const double *qs, size_t num_rollouts,
+                         double *poses) const;
+
+  /// Joint accelerations, num_joints entries per rollout in each buffer.
+  void forwardDynamics(const double *qs, const double *vs, const double *taus,
+                       size_t num_rollouts, double *accels) const;
+
+  /**
+   * Simulate all rollouts with explicit or semi-implicit Euler, as
+   * Integrate. Entry j of step k is entry k * num_joints + j; states have
+   * num_steps + 1 steps, torques and accelerations num_steps.
+   */
+  void simulate(const double *initial_qs, const double *initial_vs,
+                const double *torques, size_t num_rollouts, size_t num_steps,
+                double dt, bool semi_implicit, double *qs, double *vs,
+                double *accels) const;
+};
+
+}  // namespace gtdynamics
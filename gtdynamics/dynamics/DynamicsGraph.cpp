@@ -12,15 +12,31 @@
  */
 
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/Pseudospectral.h>
+#include <gtdynamics/factors/ContactComplementarityFactor.h>
 #include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
 #include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
 #include <gtdynamics/factors/ContactHeightFactor.h>
 #include <gtdynamics/factors/ContactKinematicsAccelFactor.h>
 #include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/factors/InertialWrenchFactor.h>
+#include <gtdynamics/factors/JointLimitFactor.h>
+#include <gtdynamics/factors/LinkDynamicsFactor.h>
+#include <gtdynamics/factors/PolyhedralFrictionConeFactor.h>
+#include <gtdynamics/factors/PoseFactor.h>
+#include <gtdynamics/factors/TwistAccelFactor.h>
+#include <gtdynamics/factors/TwistFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/JsonSaver.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/Profiler.h>
+#include <gtdynamics/utils/SliceTemplate.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
+#include <gtsam/config.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/nonlinear/ExpressionFactor.h>
 #include <gtsam/nonlinear/expressions.h>
@@ -29,7 +45,9 @@
 #include <boost/format.hpp>
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <set>
 #include <utility>
@@ -54,10 +72,10 @@ namespace gtdynamics {
 GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
     const Robot &robot, const int t, const gtsam::Values &known_values) {
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(6);
+  auto all_constrained = InternedConstrained(6);
   for (auto &&link : robot.links()) {
     int i = link->id();
-    if (link->isFixed()) {
+    if (robot.isFixed(link)) {
       // prior on twist acceleration for fixed link
       // A_i = 0
       graph.add(TwistAccelKey(i, t), I_6x6, Z_6x1, all_constrained);
@@ -113,7 +131,7 @@ GaussianFactorGraph DynamicsGraph::linearFDPriors(
 GaussianFactorGraph DynamicsGraph::linearIDPriors(
     const Robot &robot, const int t, const gtsam::Values &joint_accels) {
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(1);
+  auto all_constrained = InternedConstrained(1);
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
     double accel = JointAccel(joint_accels, j, t);
@@ -123,13 +141,19 @@ GaussianFactorGraph DynamicsGraph::linearIDPriors(
   return graph;
 }
 
-Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
-                                    const gtsam::Values &known_values) {
+Values DynamicsGraph::linearSolveFD(
+    const Robot &robot, const int t, const gtsam::Values &known_values,
+    boost::optional<const gtsam::Ordering &> ordering) {
+  GTD_PROFILE_SCOPE("DynamicsGraph::linearSolveFD");
   // construct and solve linear graph
   GaussianFactorGraph graph = linearDynamicsGraph(robot, t, known_values);
   GaussianFactorGraph priors = linearFDPriors(robot, t, known_values);
   graph += priors;
-  gtsam::VectorValues results = graph.optimize();
+  gtsam::VectorValues results;
+  {
+    GTD_PROFILE_SCOPE("DynamicsGraph::linearSolveFD eliminate");
+    results = ordering ? graph.optimize(*ordering) : graph.optimize();
+  }
 
   // arrange values
   Values values = known_values;
@@ -156,14 +180,16 @@ Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
   return values;
 }
 
-Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
-                                    const gtsam::Values &known_values) {
+Values DynamicsGraph::linearSolveID(
+    const Robot &robot, const int t, const gtsam::Values &known_values,
+    boost::optional<const gtsam::Ordering &> ordering) {
+  GTD_PROFILE_SCOPE("DynamicsGraph::linearSolveID");
   // construct and solve linear graph
   GaussianFactorGraph graph = linearDynamicsGraph(robot, t, known_values);
   GaussianFactorGraph priors = linearIDPriors(robot, t, known_values);
   graph += priors;
-
-  gtsam::VectorValues results = graph.optimize();
+  gtsam::VectorValues results =
+      ordering ? graph.optimize(*ordering) : graph.optimize();
 
   // arrange values
   Values values = known_values;
@@ -192,20 +218,83 @@ Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
   return values;
 }
 
+gtsam::Matrix DynamicsGraph::linearSolveFDBatch(const Robot &robot,
+                                                const gtsam::Matrix &qs,
+                                                const gtsam::Matrix &vs,
+                                                const gtsam::Matrix &taus) {
+  const auto &joints = robot.joints();
+  const size_t num_joints = joints.size();
+  const size_t num_samples = qs.cols();
+  if (size_t(qs.rows()) != num_joints || size_t(vs.rows()) != num_joints ||
+      size_t(taus.rows()) != num_joints || size_t(vs.cols()) != num_samples ||
+      size_t(taus.cols()) != num_samples) {
+    throw std::invalid_argument(
+        "linearSolveFDBatch: inputs should be num_joints x num_samples.");
+  }
+
+  gtsam::Matrix accels(num_joints, num_samples);
+  if (num_samples == 0) return accels;
+
+  // Known values for one sample, at time step 0.
+  auto sample_values = [&](size_t k) {
+    Values known_values;
+    for (size_t j = 0; j < num_joints; j++) {
+      InsertJointAngle(&known_values, joints[j]->id(), qs(j, k));
+      InsertJointVel(&known_values, joints[j]->id(), vs(j, k));
+    }
+    known_values = robot.forwardKinematics(known_values);
+    for (size_t j = 0; j < num_joints; j++) {
+      InsertTorque(&known_values, joints[j]->id(), taus(j, k));
+    }
+    return known_values;
+  };
+
+  // The graph structure is the same for all samples.
+  const Values first_values = sample_values(0);
+  GaussianFactorGraph graph = linearDynamicsGraph(robot, 0, first_values);
+  graph += linearFDPriors(robot, 0, first_values);
+  const gtsam::Ordering ordering = gtsam::Ordering::Colamd(graph);
+
+  auto solve_sample = [&](size_t k) {
+    const Values results =
+        linearSolveFD(robot, 0, k == 0 ? first_values : sample_values(k),
+                      ordering);
+    for (size_t j = 0; j < num_joints; j++) {
+      accels(j, k) = JointAccel(results, joints[j]->id());
+    }
+  };
+
+  ParallelFor(num_samples, solve_sample);
+  return accels;
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
     const Robot &robot, const int k,
     const boost::optional<PointOnLinks> &contact_points) const {
   NonlinearFactorGraph graph;
+  qFactors(&graph, robot, k, contact_points);
+  return graph;
+}
+
+void DynamicsGraph::qFactors(
+    NonlinearFactorGraph *graph, const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GTD_PROFILE_SCOPE("DynamicsGraph::qFactors");
+  const size_t start = graph->size();
   for (auto &&link : robot.links())
-    if (link->isFixed())
-      graph.addPrior(PoseKey(link->id(), k), link->getFixedPose(),
-                     opt_.bp_cost_model);
+    if (robot.isFixed(link))
+      graph->addPrior(PoseKey(link->id(), k), robot.fixedPose(link),
+                      opt_.bp_cost_model);
 
   // TODO(frank): call Kinematics::graph<Slice> instead
   for (auto &&joint : robot.joints()) {
-    graph.add(PoseFactor(
-        PoseKey(joint->parent()->id(), k), PoseKey(joint->child()->id(), k),
-        JointAngleKey(joint->id(), k), opt_.p_cost_model, joint));
+    if (opt_.analytic_factors) {
+      graph->add(MakeFactor<AnalyticPoseFactor>(opt_.p_cost_model, joint, k));
+    } else {
+      graph->add(PoseFactor(
+          PoseKey(joint->parent()->id(), k), PoseKey(joint->child()->id(), k),
+          JointAngleKey(joint->id(), k), opt_.p_cost_model, joint));
+    }
   }
 
   // TODO(frank): whoever write this should clean up this mess.
@@ -215,73 +304,132 @@ gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
   else
     gravity = gtsam::Vector3(0, 0, -9.8);
 
-  // Add contact factors.
-  if (contact_points) {
+  // Add contact factors, candidates get complementarity in dynamicsFactors.
+  if (contact_points && !opt_.contact_implicit) {
     for (auto &&cp : *contact_points) {
       ContactHeightFactor contact_pose_factor(
           PoseKey(cp.link->id(), k), opt_.cp_cost_model, cp.point, gravity);
-      graph.add(contact_pose_factor);
+      graph->add(contact_pose_factor);
     }
   }
 
-  return graph;
+  GTD_PROFILE_COUNT("DynamicsGraph::qFactors factors", graph->size() - start);
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::vFactors(
     const Robot &robot, const int t,
     const boost::optional<PointOnLinks> &contact_points) const {
   NonlinearFactorGraph graph;
+  vFactors(&graph, robot, t, contact_points);
+  return graph;
+}
+
+void DynamicsGraph::vFactors(
+    NonlinearFactorGraph *graph, const Robot &robot, const int t,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GTD_PROFILE_SCOPE("DynamicsGraph::vFactors");
+  const size_t start = graph->size();
   for (auto &&link : robot.links())
-    if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(TwistKey(link->id(), t), gtsam::Z_6x1,
-                                     opt_.bv_cost_model);
+    if (robot.isFixed(link))
+      graph->addPrior<gtsam::Vector6>(TwistKey(link->id(), t), gtsam::Z_6x1,
+                                      opt_.bv_cost_model);
 
-  for (auto &&joint : robot.joints())
-    graph.add(TwistFactor(opt_.v_cost_model, joint, t));
+  for (auto &&joint : robot.joints()) {
+    if (opt_.analytic_factors) {
+      graph->add(MakeFactor<AnalyticTwistFactor>(opt_.v_cost_model, joint, t));
+    } else {
+      graph->add(TwistFactor(opt_.v_cost_model, joint, t));
+    }
+  }
 
   // Add contact factors.
-  if (contact_points) {
+  if (contact_points && !opt_.contact_implicit) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsTwistFactor contact_twist_factor(
-          TwistKey(cp.link->id(), t), opt_.cv_cost_model,
-          gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_twist_factor);
+      const gtsam::Pose3 cTcom(gtsam::Rot3(), -cp.point);
+      if (opt_.analytic_factors) {
+        graph->add(MakeFactor<AnalyticContactKinematicsTwistFactor>(
+            TwistKey(cp.link->id(), t), opt_.cv_cost_model, cTcom));
+      } else {
+        ContactKinematicsTwistFactor contact_twist_factor(
+            TwistKey(cp.link->id(), t), opt_.cv_cost_model, cTcom);
+        graph->add(contact_twist_factor);
+      }
     }
   }
 
-  return graph;
+  GTD_PROFILE_COUNT("DynamicsGraph::vFactors factors", graph->size() - start);
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::aFactors(
     const Robot &robot, const int t,
     const boost::optional<PointOnLinks> &contact_points) const {
   NonlinearFactorGraph graph;
+  aFactors(&graph, robot, t, contact_points);
+  return graph;
+}
+
+void DynamicsGraph::aFactors(
+    NonlinearFactorGraph *graph, const Robot &robot, const int t,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GTD_PROFILE_SCOPE("DynamicsGraph::aFactors");
+  const size_t start = graph->size();
   for (auto &&link : robot.links())
-    if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(TwistAccelKey(link->id(), t), gtsam::Z_6x1,
-                                     opt_.ba_cost_model);
-  for (auto &&joint : robot.joints())
-    graph.add(TwistAccelFactor(opt_.a_cost_model, joint, t));
+    if (robot.isFixed(link))
+      graph->addPrior<gtsam::Vector6>(TwistAccelKey(link->id(), t),
+                                      gtsam::Z_6x1, opt_.ba_cost_model);
+  for (auto &&joint : robot.joints()) {
+    if (opt_.analytic_factors) {
+      graph->add(MakeFactor<AnalyticTwistAccelFactor>(opt_.a_cost_model,
+                                                      joint, t));
+    } else {
+      graph->add(TwistAccelFactor(opt_.a_cost_model, joint, t));
+    }
+  }
 
   // Add contact factors.
-  if (contact_points) {
+  if (contact_points && !opt_.contact_implicit) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsAccelFactor contact_accel_factor(
-          TwistAccelKey(cp.link->id(), t), opt_.ca_cost_model,
-          gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_accel_factor);
+      const gtsam::Pose3 cTcom(gtsam::Rot3(), -cp.point);
+      if (opt_.analytic_factors) {
+        graph->add(MakeFactor<AnalyticContactKinematicsAccelFactor>(
+            TwistAccelKey(cp.link->id(), t), opt_.ca_cost_model, cTcom));
+      } else {
+        ContactKinematicsAccelFactor contact_accel_factor(
+            TwistAccelKey(cp.link->id(), t), opt_.ca_cost_model, cTcom);
+        graph->add(contact_accel_factor);
+      }
     }
   }
 
-  return graph;
+  GTD_PROFILE_COUNT("DynamicsGraph::aFactors factors", graph->size() - start);
+}
+
+// Isotropic model of the given dimension, with the sigma of a scalar model.
+static gtsam::SharedNoiseModel RepeatedModel(
+    const gtsam::noiseModel::Base::shared_ptr &model, size_t dim) {
+  auto gaussian =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Gaussian>(model);
+  return InternedIsotropic(dim, gaussian ? gaussian->sigmas()(0) : 1.0);
 }
 
 // TODO(frank): migrate to Dynamics::graph<Slice>
 gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
     const Robot &robot, const int k,
     const boost::optional<PointOnLinks> &contact_points,
-    const boost::optional<double> &mu) const {
+    const boost::optional<double> &mu,
+    const boost::optional<LinkWrenchKeys> &external_wrenches) const {
   NonlinearFactorGraph graph;
+  dynamicsFactors(&graph, robot, k, contact_points, mu, external_wrenches);
+  return graph;
+}
+
+void DynamicsGraph::dynamicsFactors(
+    NonlinearFactorGraph *graph, const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu,
+    const boost::optional<LinkWrenchKeys> &external_wrenches) const {
+  GTD_PROFILE_SCOPE("DynamicsGraph::dynamicsFactors");
+  const size_t start = graph->size();
 
   // TODO(frank): whoever write this should clean up this mess.
   gtsam::Vector3 gravity;
@@ -296,9 +444,16 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
   else
     mu_ = 1.0;
 
+  // The pyramid has one error per facet, with the sigma of the cone factor.
+  gtsam::SharedNoiseModel pyramid_model;
+  if (opt_.friction_cone_facets > 0) {
+    pyramid_model =
+        RepeatedModel(opt_.cfriction_cost_model, opt_.friction_cone_facets);
+  }
+
   for (auto &&link : robot.links()) {
     int i = link->id();
-    if (!link->isFixed()) {
+    if (!robot.isFixed(link)) {
       const auto &connected_joints = link->joints();
       std::vector<DynamicsSymbol> wrench_keys;
 
@@ -315,19 +470,53 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
           wrench_keys.push_back(wrench_key);
 
           // Add contact dynamics constraints.
-          graph.emplace_shared<ContactDynamicsFrictionConeFactor>(
-              PoseKey(i, k), wrench_key, opt_.cfriction_cost_model, mu_,
-              gravity);
+          if (opt_.friction_cone_facets > 0) {
+            graph->add(MakeFactor<PolyhedralFrictionConeFactor>(
+                PoseKey(i, k), wrench_key, pyramid_model, mu_, gravity,
+                opt_.friction_cone_facets));
+          } else {
+            graph->add(MakeFactor<ContactDynamicsFrictionConeFactor>(
+                PoseKey(i, k), wrench_key, opt_.cfriction_cost_model, mu_,
+                gravity));
+          }
+          if (opt_.contact_implicit) {
+            graph->add(MakeFactor<ContactComplementarityFactor>(
+                PoseKey(i, k), TwistKey(i, k), wrench_key,
+                opt_.ccomp_cost_model, cp.point, gravity,
+                opt_.complementarity_relaxation));
+          }
+
+          const gtsam::Pose3 cTcom(gtsam::Rot3(), -cp.point);
+          if (opt_.analytic_factors) {
+            graph->add(MakeFactor<AnalyticContactDynamicsMomentFactor>(
+                wrench_key, opt_.cm_cost_model, cTcom));
+          } else {
+            graph->add(MakeFactor<ContactDynamicsMomentFactor>(
+                wrench_key, opt_.cm_cost_model, cTcom));
+          }
+        }
+      }
 
-          graph.emplace_shared<ContactDynamicsMomentFactor>(
-              wrench_key, opt_.cm_cost_model,
-              gtsam::Pose3(gtsam::Rot3(), -cp.point));
+      // Add the other wrenches on the link, constrained by the caller.
+      if (external_wrenches) {
+        auto it = external_wrenches->find(i);
+        if (it != external_wrenches->end()) {
+          wrench_keys.insert(wrench_keys.end(), it->second.begin(),
+                             it->second.end());
         }
       }
 
       // add wrench factor for link
-      graph.add(
-          WrenchFactor(opt_.fa_cost_model, link, wrench_keys, k, gravity));
+      if (opt_.inertial_variables) {
+        graph->add(MakeFactor<InertialWrenchFactor>(opt_.fa_cost_model, link,
+                                                    wrench_keys, k, gravity));
+      } else if (opt_.analytic_factors) {
+        graph->add(MakeFactor<AnalyticWrenchFactor>(opt_.fa_cost_model, link,
+                                                    wrench_keys, k, gravity));
+      } else {
+        graph->add(
+            WrenchFactor(opt_.fa_cost_model, link, wrench_keys, k, gravity));
+      }
     }
   }
 
@@ -336,49 +525,97 @@ gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
   for (auto &&joint : robot.joints()) {
     auto j = joint->id(), child_id = joint->child()->id();
     auto const_joint = joint;
-    graph.add(WrenchEquivalenceFactor(opt_.f_cost_model, const_joint, k));
-    graph.add(TorqueFactor(opt_.t_cost_model, const_joint, k));
+    graph->add(WrenchEquivalenceFactor(opt_.f_cost_model, const_joint, k));
+    graph->add(TorqueFactor(opt_.t_cost_model, const_joint, k));
     if (planar_axis_)
-      graph.add(WrenchPlanarFactor(opt_.planar_cost_model, *planar_axis_,
-                                   const_joint, k));
+      graph->add(WrenchPlanarFactor(opt_.planar_cost_model, *planar_axis_,
+                                    const_joint, k));
   }
-  return graph;
+  GTD_PROFILE_COUNT("DynamicsGraph::dynamicsFactors factors",
+                    graph->size() - start);
+}
+
+void DynamicsGraph::dynamicsFactorGraph(
+    NonlinearFactorGraph *graph, const Robot &robot, const int t,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu,
+    const boost::optional<LinkWrenchKeys> &external_wrenches) const {
+  if (opt_.fused_link_factors) {
+    // Build with analytic factors, then fuse the core factors of each link.
+    DynamicsGraph analytic(*this);
+    analytic.opt_.analytic_factors = true;
+    analytic.opt_.fused_link_factors = false;
+    graph->add(FuseLinkFactors(analytic.dynamicsFactorGraph(
+        robot, t, contact_points, mu, external_wrenches)));
+    return;
+  }
+
+  qFactors(graph, robot, t, contact_points);
+  vFactors(graph, robot, t, contact_points);
+  aFactors(graph, robot, t, contact_points);
+  dynamicsFactors(graph, robot, t, contact_points, mu, external_wrenches);
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactorGraph(
     const Robot &robot, const int t,
     const boost::optional<PointOnLinks> &contact_points,
-    const boost::optional<double> &mu) const {
+    const boost::optional<double> &mu,
+    const boost::optional<LinkWrenchKeys> &external_wrenches) const {
   NonlinearFactorGraph graph;
-  graph.add(qFactors(robot, t, contact_points));
-  graph.add(vFactors(robot, t, contact_points));
-  graph.add(aFactors(robot, t, contact_points));
-  graph.add(dynamicsFactors(robot, t, contact_points, mu));
+  dynamicsFactorGraph(&graph, robot, t, contact_points, mu, external_wrenches);
   return graph;
 }
 
+// Append slices in order, growing graph once for all their factors.
+static void AppendSlices(NonlinearFactorGraph *graph,
+                         const std::vector<NonlinearFactorGraph> &slices) {
+  size_t num_factors = graph->size();
+  for (auto &&slice : slices) num_factors += slice.size();
+  graph->reserve(num_factors);
+  for (auto &&slice : slices) graph->add(slice);
+}
+
+void DynamicsGraph::trajectoryFG(
+    NonlinearFactorGraph *graph, const Robot &robot, const int num_steps,
+    const double dt, const CollocationScheme collocation,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu) const {
+  // All slices have the same structure, build them once and shift in time.
+  const SliceTemplate dynamics_slice(
+      [&](int t) { return dynamicsFactorGraph(robot, t, contact_points, mu); });
+  const SliceTemplate collocation_slice(
+      [&](int t) { return collocationFactors(robot, t, dt, collocation); });
+
+  // Build each time slice independently, then merge them in order so the
+  // factor ordering does not depend on the number of threads.
+  std::vector<NonlinearFactorGraph> slices(num_steps + 1);
+  FactorArena *arena = FactorArena::Active();
+  ParallelFor(slices.size(), [&](size_t t) {
+    FactorArena::Scope scope(arena);
+    slices[t] = dynamics_slice.at(t);
+    if (int(t) < num_steps) slices[t].add(collocation_slice.at(t));
+  });
+  AppendSlices(graph, slices);
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFG(
     const Robot &robot, const int num_steps, const double dt,
     const CollocationScheme collocation,
     const boost::optional<PointOnLinks> &contact_points,
     const boost::optional<double> &mu) const {
   NonlinearFactorGraph graph;
-  for (int t = 0; t < num_steps + 1; t++) {
-    graph.add(dynamicsFactorGraph(robot, t, contact_points, mu));
-    if (t < num_steps) {
-      graph.add(collocationFactors(robot, t, dt, collocation));
-    }
-  }
+  trajectoryFG(&graph, robot, num_steps, dt, collocation, contact_points, mu);
   return graph;
 }
 
-gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
-    const Robot &robot, const std::vector<int> &phase_steps,
+void DynamicsGraph::multiPhaseTrajectoryFG(
+    NonlinearFactorGraph *graph, const Robot &robot,
+    const std::vector<int> &phase_steps,
     const std::vector<gtsam::NonlinearFactorGraph> &transition_graphs,
     const CollocationScheme collocation,
     const boost::optional<std::vector<PointOnLinks>> &phase_contact_points,
     const boost::optional<double> &mu) const {
-  NonlinearFactorGraph graph;
+  GTD_PROFILE_SCOPE("DynamicsGraph::multiPhaseTrajectoryFG");
   int num_phases = phase_steps.size();
 
   // Return either PointOnLinks or None if none specified for phase p
@@ -388,33 +625,60 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
     return boost::none;
   };
 
-  // First slice, k==0
-  graph.add(dynamicsFactorGraph(robot, 0, contact_points(0), mu));
-
-  int k = 0;
+  // Phase of each time slice, -1 - p for the transition after phase p.
+  std::vector<int> slice_phases(1, 0);
+  std::vector<int> step_phases;
   for (int p = 0; p < num_phases; p++) {
-    // in-phase
-    // add dynamics for each step
     for (int step = 0; step < phase_steps[p] - 1; step++) {
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
-    }
-    if (p == num_phases - 1) {
-      // Last slice, k==K-1
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
-    } else {
-      // transition
-      graph.add(transition_graphs[p]);
-      k++;
+      slice_phases.push_back(p);
     }
+    slice_phases.push_back(p == num_phases - 1 ? p : -1 - p);
+    step_phases.insert(step_phases.end(), phase_steps[p], p);
   }
 
-  // add collocation factors
-  k = 0;
+  // Dynamics slices only differ in time within a phase.
+  std::vector<SliceTemplate> phase_slices;
   for (int p = 0; p < num_phases; p++) {
-    for (int step = 0; step < phase_steps[p]; step++) {
-      graph.add(multiPhaseCollocationFactors(robot, k++, p, collocation));
-    }
+    phase_slices.emplace_back([&, p](int k) {
+      return dynamicsFactorGraph(robot, k, contact_points(p), mu);
+    });
   }
+
+  // Dynamics slices, or the transition graph between two phases.
+  std::vector<NonlinearFactorGraph> slices(slice_phases.size());
+  FactorArena *arena = FactorArena::Active();
+  ParallelFor(slices.size(), [&](size_t k) {
+    FactorArena::Scope scope(arena);
+    const int p = slice_phases[k];
+    if (p >= 0) {
+      slices[k] = phase_slices[p].at(k);
+    } else {
+      slices[k] = transition_graphs[-1 - p];
+    }
+  });
+
+  // Collocation factors between consecutive slices.
+  std::vector<NonlinearFactorGraph> collocation_slices(step_phases.size());
+  ParallelFor(collocation_slices.size(), [&](size_t k) {
+    FactorArena::Scope scope(arena);
+    collocation_slices[k] =
+        multiPhaseCollocationFactors(robot, k, step_phases[k], collocation);
+  });
+
+  std::move(collocation_slices.begin(), collocation_slices.end(),
+            std::back_inserter(slices));
+  AppendSlices(graph, slices);
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
+    const Robot &robot, const std::vector<int> &phase_steps,
+    const std::vector<gtsam::NonlinearFactorGraph> &transition_graphs,
+    const CollocationScheme collocation,
+    const boost::optional<std::vector<PointOnLinks>> &phase_contact_points,
+    const boost::optional<double> &mu) const {
+  NonlinearFactorGraph graph;
+  multiPhaseTrajectoryFG(&graph, robot, phase_steps, transition_graphs,
+                         collocation, phase_contact_points, mu);
   return graph;
 }
 
@@ -436,7 +700,8 @@ void DynamicsGraph::addCollocationFactorDouble(
         x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr - x1_expr));
   } else {
     throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+        "runge-kutta not implemented yet, hermite-simpson and "
+        "legendre-gauss-radau need accelerations or several steps");
   }
 }
 
@@ -469,10 +734,47 @@ void DynamicsGraph::addMultiPhaseCollocationFactorDouble(
                                 x0_expr + 0.5 * v0dt + 0.5 * v1dt - x1_expr));
   } else {
     throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+        "runge-kutta not implemented yet, hermite-simpson and "
+        "legendre-gauss-radau need accelerations or several steps");
   }
 }
 
+void DynamicsGraph::addHermiteSimpsonFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const double dt, const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  Double_ x0_expr(x0_key);
+  Double_ x1_expr(x1_key);
+  Double_ v0_expr(v0_key);
+  Double_ v1_expr(v1_key);
+  Double_ a0_expr(a0_key);
+  Double_ a1_expr(a1_key);
+  graph->add(ExpressionFactor(
+      cost_model, 0.0,
+      x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr +
+          dt * dt / 12 * a0_expr - dt * dt / 12 * a1_expr - x1_expr));
+}
+
+void DynamicsGraph::addMultiPhaseHermiteSimpsonFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const Key phase_key,
+    const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  Double_ phase_expr(phase_key);
+  Double_ x0_expr(x0_key);
+  Double_ x1_expr(x1_key);
+  Double_ v0dt(multDouble, phase_expr, Double_(v0_key));
+  Double_ v1dt(multDouble, phase_expr, Double_(v1_key));
+  Double_ a0dt(multDouble, phase_expr, Double_(a0_key));
+  Double_ a1dt(multDouble, phase_expr, Double_(a1_key));
+  Double_ a0dt2(multDouble, phase_expr, a0dt);
+  Double_ a1dt2(multDouble, phase_expr, a1dt);
+  graph->add(ExpressionFactor(cost_model, 0.0,
+                              x0_expr + 0.5 * v0dt + 0.5 * v1dt +
+                                  1.0 / 12 * a0dt2 - 1.0 / 12 * a1dt2 -
+                                  x1_expr));
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
     const int j, const int t, const double dt,
     const CollocationScheme collocation) const {
@@ -480,6 +782,14 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
   Key q0_key = JointAngleKey(j, t), q1_key = JointAngleKey(j, t + 1),
       v0_key = JointVelKey(j, t), v1_key = JointVelKey(j, t + 1),
       a0_key = JointAccelKey(j, t), a1_key = JointAccelKey(j, t + 1);
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    addHermiteSimpsonFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key,
+                                  a0_key, a1_key, dt, opt_.q_col_cost_model);
+    addCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key, dt,
+                               opt_.v_col_cost_model,
+                               CollocationScheme::Trapezoidal);
+    return graph;
+  }
   addCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key, dt,
                              opt_.q_col_cost_model, collocation);
   addCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key, dt,
@@ -507,6 +817,16 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
       a1_key = JointAccelKey(j, t + 1);
 
   gtsam::NonlinearFactorGraph graph;
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    addMultiPhaseHermiteSimpsonFactorDouble(&graph, q0_key, q1_key, v0_key,
+                                            v1_key, a0_key, a1_key, phase_key,
+                                            opt_.q_col_cost_model);
+    addMultiPhaseCollocationFactorDouble(&graph, v0_key, v1_key, a0_key,
+                                         a1_key, phase_key,
+                                         opt_.v_col_cost_model,
+                                         CollocationScheme::Trapezoidal);
+    return graph;
+  }
   addMultiPhaseCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key,
                                        phase_key, opt_.q_col_cost_model,
                                        collocation);
@@ -527,6 +847,61 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseCollocationFactors(
   return graph;
 }
 
+// LGR defects sum_j D(i, j) * x_j - h / 2 * v_i, for x the angles and v
+// the velocities, then for x the velocities and v the accelerations. The
+// half_duration callback returns h / 2 * v_i as an expression.
+static NonlinearFactorGraph PseudospectralFactors(
+    const Robot &robot, const int t, const size_t num_points,
+    const std::function<Double_(const Double_ &)> &half_duration,
+    const OptimizerSetting &opt) {
+  const RadauCollocation radau = LegendreGaussRadau(num_points);
+  NonlinearFactorGraph graph;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    for (int level = 0; level < 2; level++) {
+      auto x_key = [&](int k) -> Key {
+        return level == 0 ? JointAngleKey(j, k) : JointVelKey(j, k);
+      };
+      auto v_key = [&](int k) -> Key {
+        return level == 0 ? JointVelKey(j, k) : JointAccelKey(j, k);
+      };
+      const auto &model =
+          level == 0 ? opt.q_col_cost_model : opt.v_col_cost_model;
+      for (size_t i = 0; i < num_points; i++) {
+        Double_ defect = radau.D(i, 0) * Double_(x_key(t));
+        for (size_t k = 1; k <= num_points; k++) {
+          defect = defect + radau.D(i, k) * Double_(x_key(t + k));
+        }
+        graph.add(ExpressionFactor(
+            model, 0.0, defect - half_duration(Double_(v_key(t + i)))));
+      }
+    }
+  }
+  return graph;
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::pseudospectralCollocationFactors(
+    const Robot &robot, const int t, const size_t num_points,
+    const double dt) const {
+  const double half_duration = 0.5 * num_points * dt;
+  return PseudospectralFactors(
+      robot, t, num_points,
+      [&](const Double_ &v) { return half_duration * v; }, opt_);
+}
+
+gtsam::NonlinearFactorGraph
+DynamicsGraph::multiPhasePseudospectralCollocationFactors(
+    const Robot &robot, const int t, const size_t num_points,
+    const int phase) const {
+  Double_ phase_expr(PhaseKey(phase));
+  return PseudospectralFactors(
+      robot, t, num_points,
+      [&](const Double_ &v) {
+        return 0.5 * num_points * Double_(multDouble, phase_expr, v);
+      },
+      opt_);
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::forwardDynamicsPriors(
     const Robot &robot, const int t, const gtsam::Values &known_values) const {
   gtsam::NonlinearFactorGraph graph;
@@ -578,8 +953,47 @@ gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFDPriors(
 gtsam::NonlinearFactorGraph DynamicsGraph::jointLimitFactors(
     const Robot &robot, const int t) const {
   NonlinearFactorGraph graph;
-  for (auto &&joint : robot.joints())
-    graph.add(joint->jointLimitFactors(t, opt_));
+  if (!opt_.vector_joint_limits) {
+    for (auto &&joint : robot.joints())
+      graph.add(joint->jointLimitFactors(t, opt_));
+    return graph;
+  }
+
+  // One factor per quantity, with the same limits as Joint::jointLimitFactors.
+  const size_t n = robot.numJoints();
+  if (n == 0) return graph;
+  gtsam::KeyVector q_keys, v_keys, a_keys, tau_keys;
+  gtsam::Vector q_low(n), q_high(n), q_threshold(n), v_limit(n),
+      v_threshold(n), a_limit(n), a_threshold(n), tau_limit(n),
+      tau_threshold(n);
+  size_t i = 0;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const auto &parameters = joint->parameters();
+    q_keys.push_back(JointAngleKey(j, t));
+    v_keys.push_back(JointVelKey(j, t));
+    a_keys.push_back(JointAccelKey(j, t));
+    tau_keys.push_back(TorqueKey(j, t));
+    q_low(i) = parameters.scalar_limits.value_lower_limit;
+    q_high(i) = parameters.scalar_limits.value_upper_limit;
+    q_threshold(i) = parameters.scalar_limits.value_limit_threshold;
+    v_limit(i) = parameters.velocity_limit;
+    v_threshold(i) = parameters.velocity_limit_threshold;
+    a_limit(i) = parameters.acceleration_limit;
+    a_threshold(i) = parameters.acceleration_limit_threshold;
+    tau_limit(i) = parameters.torque_limit;
+    tau_threshold(i) = parameters.torque_limit_threshold;
+    i++;
+  }
+  auto model = RepeatedModel(opt_.jl_cost_model, n);
+  graph.add(MakeFactor<VectorJointLimitFactor>(q_keys, model, q_low, q_high,
+                                               q_threshold));
+  graph.add(MakeFactor<VectorJointLimitFactor>(v_keys, model, -v_limit,
+                                               v_limit, v_threshold));
+  graph.add(MakeFactor<VectorJointLimitFactor>(a_keys, model, -a_limit,
+                                               a_limit, a_threshold));
+  graph.add(MakeFactor<VectorJointLimitFactor>(tau_keys, model, -tau_limit,
+                                               tau_limit, tau_threshold));
   return graph;
 }
 
@@ -601,11 +1015,26 @@ gtsam::NonlinearFactorGraph DynamicsGraph::targetPoseFactors(
   return graph;
 }
 
+gtsam::NonlinearFactorGraph DynamicsGraph::inertialParameterPriors(
+    const Robot &robot, const gtsam::Values &parameters, double sigma) const {
+  NonlinearFactorGraph graph;
+  auto model = InternedIsotropic(10, sigma);
+  for (auto &&link : robot.links()) {
+    const auto key = InertialParametersKey(link->id());
+    graph.addPrior<gtsam::Vector10>(
+        key,
+        parameters.exists(key) ? parameters.at<gtsam::Vector10>(key)
+                               : InertialParameters(*link),
+        model);
+  }
+  return graph;
+}
+
 gtsam::Vector DynamicsGraph::jointAccels(const Robot &robot,
                                          const gtsam::Values &result,
                                          const int t) {
   gtsam::Vector joint_accels = gtsam::Vector::Zero(robot.numJoints());
-  auto joints = robot.joints();
+  const auto &joints = robot.joints();
   for (int idx = 0; idx < robot.numJoints(); idx++) {
     auto joint = joints[idx];
     int j = joint->id();
@@ -618,7 +1047,7 @@ gtsam::Vector DynamicsGraph::jointVels(const Robot &robot,
                                        const gtsam::Values &result,
                                        const int t) {
   gtsam::Vector joint_vels = gtsam::Vector::Zero(robot.numJoints());
-  auto joints = robot.joints();
+  const auto &joints = robot.joints();
   for (int idx = 0; idx < robot.numJoints(); idx++) {
     auto joint = joints[idx];
     int j = joint->id();
@@ -631,7 +1060,7 @@ gtsam::Vector DynamicsGraph::jointAngles(const Robot &robot,
                                          const gtsam::Values &result,
                                          const int t) {
   gtsam::Vector joint_angles = gtsam::Vector::Zero(robot.numJoints());
-  auto joints = robot.joints();
+  const auto &joints = robot.joints();
   for (int idx = 0; idx < robot.numJoints(); idx++) {
     auto joint = joints[idx];
     int j = joint->id();
@@ -644,7 +1073,7 @@ gtsam::Vector DynamicsGraph::jointTorques(const Robot &robot,
                                           const gtsam::Values &result,
                                           const int t) {
   gtsam::Vector joint_torques = gtsam::Vector::Zero(robot.numJoints());
-  auto joints = robot.joints();
+  const auto &joints = robot.joints();
   for (int idx = 0; idx < robot.numJoints(); idx++) {
     auto joint = joints[idx];
     int j = joint->id();
@@ -653,6 +1082,52 @@ gtsam::Vector DynamicsGraph::jointTorques(const Robot &robot,
   return joint_torques;
 }
 
+// Joint values over time steps, one row per time step.
+template <typename GET>
+static gtsam::Matrix JointTrajectory(const Robot &robot, size_t num_steps,
+                                     int t0, GET get) {
+  const auto &joints = robot.joints();
+  gtsam::Matrix trajectory(num_steps, joints.size());
+  for (size_t k = 0; k < num_steps; k++) {
+    for (size_t idx = 0; idx < joints.size(); idx++) {
+      trajectory(k, idx) = get(joints[idx]->id(), t0 + int(k));
+    }
+  }
+  return trajectory;
+}
+
+gtsam::Matrix DynamicsGraph::jointAccelsTrajectory(const Robot &robot,
+                                                   const gtsam::Values &result,
+                                                   size_t num_steps, int t0) {
+  return JointTrajectory(robot, num_steps, t0, [&](int j, int t) {
+    return JointAccel(result, j, t);
+  });
+}
+
+gtsam::Matrix DynamicsGraph::jointVelsTrajectory(const Robot &robot,
+                                                 const gtsam::Values &result,
+                                                 size_t num_steps, int t0) {
+  return JointTrajectory(robot, num_steps, t0, [&](int j, int t) {
+    return JointVel(result, j, t);
+  });
+}
+
+gtsam::Matrix DynamicsGraph::jointAnglesTrajectory(const Robot &robot,
+                                                   const gtsam::Values &result,
+                                                   size_t num_steps, int t0) {
+  return JointTrajectory(robot, num_steps, t0, [&](int j, int t) {
+    return JointAngle(result, j, t);
+  });
+}
+
+gtsam::Matrix DynamicsGraph::jointTorquesTrajectory(
+    const Robot &robot, const gtsam::Values &result, size_t num_steps,
+    int t0) {
+  return JointTrajectory(robot, num_steps, t0, [&](int j, int t) {
+    return Torque(result, j, t);
+  });
+}
+
 JointValueMap DynamicsGraph::jointAccelsMap(const Robot &robot,
                                             const gtsam::Values &result,
                                             const int t) {
@@ -830,6 +1305,18 @@ void DynamicsGraph::saveGraphMultiSteps(
   json_file.close();
 }
 
+void DynamicsGraph::saveGraphSlices(const std::string &directory,
+                                    const gtsam::NonlinearFactorGraph &graph,
+                                    const gtsam::Values &values,
+                                    const Robot &robot, const int num_steps,
+                                    bool radial) {
+  std::map<int, JsonSaver::LocationType> locations;
+  for (int t = 0; t <= num_steps; t++) {
+    locations[t] = get_locations(robot, t, radial);
+  }
+  JsonSaver::SaveSlicedGraph(directory, graph, values, locations);
+}
+
 /* classify the variables into different clusters */
 typedef std::pair<std::string, int> ClusterInfo;
 
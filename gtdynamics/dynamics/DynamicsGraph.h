@@ -16,6 +16,7 @@
 #include <gtdynamics/dynamics/OptimizerSetting.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/inference/Ordering.h>
 #include <gtsam/linear/NoiseModel.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
@@ -23,6 +24,7 @@
 #include <boost/optional.hpp>
 #include <cmath>
 #include <iosfwd>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -31,22 +33,42 @@ namespace gtdynamics {
 using JointValueMap = std::map<std::string, double>;
 
 /// Shorthand for C_i_c_k, for contact wrench c on i-th link at time step k.
-inline DynamicsSymbol ContactWrenchKey(int i, int c, int k = 0) {
-  return DynamicsSymbol::LinkJointSymbol("C", i, c, k);
+constexpr DynamicsSymbol ContactWrenchKey(int i, int c, int k = 0) {
+  return DynamicsSymbol::LinkJointSymbol(
+      DynamicsSymbol::Label::ContactWrench, i, c, k);
 }
 
+/// Wrenches acting on links besides their joint and ground contact wrenches,
+/// e.g. of contacts with other robots, by link id.
+using LinkWrenchKeys = std::map<int, std::vector<DynamicsSymbol>>;
+
 /* Shorthand for dt_k, for duration for timestep dt_k during phase k. */
-inline DynamicsSymbol PhaseKey(int k) {
-  return DynamicsSymbol::SimpleSymbol("dt", k);
+constexpr DynamicsSymbol PhaseKey(int k) {
+  return DynamicsSymbol::SimpleSymbol(DynamicsSymbol::Label::Phase, k);
 }
 
 /* Shorthand for t_k, time at time step k. */
-inline DynamicsSymbol TimeKey(int k) {
-  return DynamicsSymbol::SimpleSymbol("t", k);
+constexpr DynamicsSymbol TimeKey(int k) {
+  return DynamicsSymbol::SimpleSymbol(DynamicsSymbol::Label::Time, k);
 }
 
-/** Collocation methods. */
-enum CollocationScheme { Euler, RungeKutta, Trapezoidal, HermiteSimpson };
+/**
+ * Collocation methods.
+ *
+ * HermiteSimpson: compressed Hermite-Simpson, with accelerations linearly
+ * interpolated within a step. Angles get a third-order defect
+ * q1 = q0 + dt / 2 * (v0 + v1) + dt^2 / 12 * (a0 - a1), velocities reduce to
+ * the trapezoidal rule.
+ * LegendreGaussRadau: pseudospectral collocation over segments of several
+ * steps, see pseudospectralCollocationFactors.
+ */
+enum CollocationScheme {
+  Euler,
+  RungeKutta,
+  Trapezoidal,
+  HermiteSimpson,
+  LegendreGaussRadau
+};
 
 /**
  * DynamicsGraph is a class which builds a factor graph to do kinodynamic
@@ -108,56 +130,120 @@ class DynamicsGraph {
    * @param t               time step
    * @param known_values Values with kinematics + torques which includes joint
    * angles, joint velocities, and torques
+   * @param ordering        elimination ordering, COLAMD if not given
    * @return values of joint angles, joint velocities, joint accelerations,
    * joint torques, and link twist accelerations
    */
-  gtsam::Values linearSolveFD(const Robot &robot, const int t,
-                              const gtsam::Values &known_values);
+  gtsam::Values linearSolveFD(
+      const Robot &robot, const int t, const gtsam::Values &known_values,
+      boost::optional<const gtsam::Ordering &> ordering = boost::none);
 
   /**
    * Solve inverse kinodynamics using linear factor graph, Values version.
    * @param  robot        the robot
    * @param  t            time step
    * @param known_values  Values with kinematics + joint accelerations
+   * @param ordering      elimination ordering, COLAMD if not given
    *
    * @return values of all variables, including computed torques
    */
-  gtsam::Values linearSolveID(const Robot &robot, const int t,
-                              const gtsam::Values &known_values);
+  gtsam::Values linearSolveID(
+      const Robot &robot, const int t, const gtsam::Values &known_values,
+      boost::optional<const gtsam::Ordering &> ordering = boost::none);
+
+  /**
+   * Solve forward kinodynamics for many states at once. Each column is one
+   * sample, rows are ordered as robot.joints(). The elimination ordering is
+   * computed once and shared by all samples, which are solved in parallel
+   * when GTSAM is built with TBB. Floating links use the default root pose
+   * and twist of Robot::forwardKinematics.
+   *
+   * @param robot  the robot
+   * @param qs     joint angles, one column per sample
+   * @param vs     joint velocities, one column per sample
+   * @param taus   joint torques, one column per sample
+   * @return joint accelerations, one column per sample
+   */
+  gtsam::Matrix linearSolveFDBatch(const Robot &robot, const gtsam::Matrix &qs,
+                                   const gtsam::Matrix &vs,
+                                   const gtsam::Matrix &taus);
 
   /// Return q-level nonlinear factor graph (pose related factors)
   gtsam::NonlinearFactorGraph qFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none) const;
 
+  /// Append q-level factors to graph.
+  void qFactors(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none) const;
+
   /// Return v-level nonlinear factor graph (twist related factors)
   gtsam::NonlinearFactorGraph vFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none) const;
 
+  /// Append v-level factors to graph.
+  void vFactors(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none) const;
+
   /// Return a-level nonlinear factor graph (acceleration related factors)
   gtsam::NonlinearFactorGraph aFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none) const;
 
-  /// Return dynamics-level nonlinear factor graph (wrench related factors)
+  /// Append a-level factors to graph.
+  void aFactors(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none) const;
+
+  /**
+   * Return dynamics-level nonlinear factor graph (wrench related factors)
+   * @param external_wrenches optional wrenches at time step t that also act
+   *                          on the links, constrained by the caller.
+   */
   gtsam::NonlinearFactorGraph dynamicsFactors(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none,
-      const boost::optional<double> &mu = boost::none) const;
+      const boost::optional<double> &mu = boost::none,
+      const boost::optional<LinkWrenchKeys> &external_wrenches =
+          boost::none) const;
+
+  /// Append dynamics-level factors to graph.
+  void dynamicsFactors(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none,
+      const boost::optional<LinkWrenchKeys> &external_wrenches =
+          boost::none) const;
 
   /**
-   * Return nonlinear factor graph of all dynamics factors
+   * Return nonlinear factor graph of all dynamics factors. With
+   * OptimizerSetting::fused_link_factors, the pose, twist, twist acceleration
+   * and wrench factors of each link are fused into one LinkDynamicsFactor.
    * @param robot          the robot
    * @param t              time step
    * link and 0 denotes no contact.
    * @param contact_points optional vector of contact points.
    * @param mu             optional coefficient of static friction.
+   * @param external_wrenches optional other wrenches on the links, see
+   *                          dynamicsFactors.
    */
   gtsam::NonlinearFactorGraph dynamicsFactorGraph(
       const Robot &robot, const int t,
       const boost::optional<PointOnLinks> &contact_points = boost::none,
-      const boost::optional<double> &mu = boost::none) const;
+      const boost::optional<double> &mu = boost::none,
+      const boost::optional<LinkWrenchKeys> &external_wrenches =
+          boost::none) const;
+
+  /// Append all dynamics factors at time step t to graph.
+  void dynamicsFactorGraph(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot, const int t,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none,
+      const boost::optional<LinkWrenchKeys> &external_wrenches =
+          boost::none) const;
 
   /**
    * Return prior factors of torque, angle, velocity
@@ -200,6 +286,17 @@ class DynamicsGraph {
       const boost::optional<PointOnLinks> &contact_points = boost::none,
       const boost::optional<double> &mu = boost::none) const;
 
+  /**
+   * Append the factors of the entire trajectory to graph, which is grown once
+   * for all time slices.
+   */
+  void trajectoryFG(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+      const int num_steps, const double dt,
+      const CollocationScheme collocation = Trapezoidal,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none) const;
+
   /**
    * Return nonlinear factor graph of the entire trajectory for multi-phase
    * @param robot                the robot configuration
@@ -217,6 +314,16 @@ class DynamicsGraph {
           boost::none,
       const boost::optional<double> &mu = boost::none) const;
 
+  /// Append the factors of a multi-phase trajectory to graph.
+  void multiPhaseTrajectoryFG(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+      const std::vector<int> &phase_steps,
+      const std::vector<gtsam::NonlinearFactorGraph> &transition_graphs,
+      const CollocationScheme collocation = Trapezoidal,
+      const boost::optional<std::vector<PointOnLinks>> &phase_contact_points =
+          boost::none,
+      const boost::optional<double> &mu = boost::none) const;
+
   /** Add collocation factor for doubles. */
   static void addCollocationFactorDouble(
       gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
@@ -232,6 +339,21 @@ class DynamicsGraph {
       const gtsam::noiseModel::Base::shared_ptr &cost_model,
       const CollocationScheme collocation = Trapezoidal);
 
+  /** Add Hermite-Simpson collocation factor for doubles. */
+  static void addHermiteSimpsonFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key, const double dt,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
+  /** Add Hermite-Simpson collocation factor for doubles, with dt a variable. */
+  static void addMultiPhaseHermiteSimpsonFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key,
+      const gtsam::Key phase_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
   /**
    * Return collocation factors for the specified joint.
    * @param j           joint index
@@ -278,7 +400,36 @@ class DynamicsGraph {
       const CollocationScheme collocation = Trapezoidal) const;
 
   /**
-   * Return joint factors to limit angle, velocity, acceleration, and torque
+   * Return Legendre-Gauss-Radau collocation factors on angles and velocities
+   * of a segment of num_points steps, from time step t to t + num_points.
+   * The slices of the segment are at the LGR nodes, not evenly spaced: slice
+   * t + i is at time RadauCollocation::time(i, t0, num_points * dt). The
+   * defects at the N collocation points replace N steps of the other schemes.
+   * @param robot       the robot
+   * @param t           first time step of the segment
+   * @param num_points  number of collocation points
+   * @param dt          average duration of a step
+   */
+  gtsam::NonlinearFactorGraph pseudospectralCollocationFactors(
+      const Robot &robot, const int t, const size_t num_points,
+      const double dt) const;
+
+  /**
+   * Return Legendre-Gauss-Radau collocation factors of a segment as above,
+   * with the average step duration as the variable of the phase.
+   * @param robot       the robot
+   * @param t           first time step of the segment
+   * @param num_points  number of collocation points
+   * @param phase       the phase of the segment
+   */
+  gtsam::NonlinearFactorGraph multiPhasePseudospectralCollocationFactors(
+      const Robot &robot, const int t, const size_t num_points,
+      const int phase) const;
+
+  /**
+   * Return joint factors to limit angle, velocity, acceleration, and torque.
+   * With OptimizerSetting::vector_joint_limits, there is one
+   * VectorJointLimitFactor per quantity instead of one factor per joint.
    * @param robot the robot
    * @param t time step
    */
@@ -307,6 +458,19 @@ class DynamicsGraph {
       const Robot &robot, const int t, const std::string &link_name,
       const gtsam::Pose3 &target_pose) const;
 
+  /**
+   * Return priors on the inertial parameters of all links, for graphs built
+   * with OptimizerSetting::inertial_variables. A new payload or design only
+   * needs new priors and Values, the dynamics factors are kept.
+   * @param robot       the robot
+   * @param parameters  Values with InertialParametersKey, links not in it
+   *                    get their nominal InertialParameters
+   * @param sigma       standard deviation (default 0: constrained)
+   */
+  gtsam::NonlinearFactorGraph inertialParameterPriors(
+      const Robot &robot, const gtsam::Values &parameters = gtsam::Values(),
+      double sigma = 0) const;
+
   /**
    * Return the joint accelerations
    * @param robot the robot
@@ -327,6 +491,29 @@ class DynamicsGraph {
   static gtsam::Vector jointTorques(const Robot &robot,
                                     const gtsam::Values &result, const int t);
 
+  /**
+   * Return the joint accelerations of time steps [t0, t0 + num_steps), one
+   * row per time step and one column per joint, in robot.joints() order.
+   */
+  static gtsam::Matrix jointAccelsTrajectory(const Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps, int t0 = 0);
+
+  /// Return joint velocities over time steps, see jointAccelsTrajectory.
+  static gtsam::Matrix jointVelsTrajectory(const Robot &robot,
+                                           const gtsam::Values &result,
+                                           size_t num_steps, int t0 = 0);
+
+  /// Return joint angles over time steps, see jointAccelsTrajectory.
+  static gtsam::Matrix jointAnglesTrajectory(const Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps, int t0 = 0);
+
+  /// Return joint torques over time steps, see jointAccelsTrajectory.
+  static gtsam::Matrix jointTorquesTrajectory(const Robot &robot,
+                                              const gtsam::Values &result,
+                                              size_t num_steps, int t0 = 0);
+
   /**
    * Return the joint accelerations as std::map<name, acceleration>
    * @param robot the robot
@@ -396,6 +583,22 @@ class DynamicsGraph {
                             const gtsam::NonlinearFactorGraph &graph,
                             const gtsam::Values &values, const int num_steps);
 
+  /**
+   * Save factor graph of multiple time steps for level-of-detail viewing in
+   * visualization/factor_graph_lod.html: an index.json of per-slice
+   * summaries, and one json chunk per slice, see JsonSaver::SaveSlicedGraph.
+   * @param directory existing directory to store the files in
+   * @param graph     factor graph
+   * @param values    values of variables in factor graph
+   * @param robot     the robot
+   * @param num_steps number of time steps
+   * @param radial    option to display in radial format
+   */
+  static void saveGraphSlices(const std::string &directory,
+                              const gtsam::NonlinearFactorGraph &graph,
+                              const gtsam::Values &values, const Robot &robot,
+                              const int num_steps, bool radial = false);
+
   /// Return the optimizer setting.
   const OptimizerSetting &opt() const { return opt_; }
 };
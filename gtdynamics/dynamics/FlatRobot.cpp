@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FlatRobot.cpp
+ * @brief Flattening of a tree robot into a FlatRobotModel.
+ */
+
+#include <gtdynamics/dynamics/FlatRobot.h>
+
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+namespace {
+// Pose as a row-major rotation followed by a translation.
+void ToArray(const Pose3 &pose, double *array) {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  for (size_t k = 0; k < 9; k++) array[k] = R(k / 3, k % 3);
+  for (size_t k = 0; k < 3; k++) array[9 + k] = pose.translation()(k);
+}
+}  // namespace
+
+/* ************************************************************************* */
+FlatRobot::FlatRobot(const Robot &robot,
+                     const boost::optional<gtsam::Vector3> &gravity)
+    : ArticulatedBodySolver(robot, gravity) {
+  for (const TreeJoint &tj : tree_) {
+    FlatJoint joint;
+    joint.type = char(tj.kernel.type);
+    joint.joint_index = tj.joint_index;
+    joint.parent_index = tj.parent_index;
+    joint.child_index = tj.child_index;
+    joint.aligned = tj.aligned;
+    ToArray(tj.kernel.pMc, joint.pMc);
+    for (size_t k = 0; k < 6; k++) {
+      joint.cScrewAxis[k] = tj.kernel.cScrewAxis(k);
+      joint.S[k] = tj.S(k);
+    }
+    flat_joints_.push_back(joint);
+  }
+  for (auto &&link : links_) {
+    FlatLink flat_link;
+    const gtsam::Matrix3 &inertia = link->inertia();
+    for (size_t k = 0; k < 9; k++) flat_link.inertia[k] = inertia(k / 3, k % 3);
+    flat_link.mass = link->mass();
+    flat_links_.push_back(flat_link);
+  }
+}
+
+/* ************************************************************************* */
+FlatRobotModel FlatRobot::model() const {
+  FlatRobotModel model;
+  model.num_links = links_.size();
+  model.num_joints = joints_.size();
+  model.root_index = root_index_;
+  model.root_fixed = root_fixed_;
+  ToArray(root_fixed_ ? root_fixed_pose_ : Pose3(), model.root_pose);
+  model.has_gravity = bool(gravity_);
+  for (size_t k = 0; k < 3; k++) {
+    model.gravity[k] = gravity_ ? (*gravity_)(k) : 0.0;
+  }
+  model.joints = flat_joints_.data();
+  model.links = flat_links_.data();
+  return model;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FlatRobot.h
+ * @brief Flattening of a tree robot into a FlatRobotModel.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/dynamics/FlatRobotModel.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * FlatRobot holds the joint table and inertias of a tree robot in the plain
+ * arrays of FlatRobotModel, in the traversal order of ArticulatedBodySolver,
+ * so that the flat kernels can run on the host or be copied to a device.
+ */
+class FlatRobot : public ArticulatedBodySolver {
+ private:
+  std::vector<FlatJoint> flat_joints_;
+  std::vector<FlatLink> flat_links_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot    the robot, must be a tree
+   * @param gravity  gravity in world frame
+   */
+  FlatRobot(const Robot &robot,
+            const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Return the tree joints, in parent-to-child order.
+  const std::vector<FlatJoint> &flatJoints() const { return flat_joints_; }
+
+  /// Return the link inertias, ordered as robot.links().
+  const std::vector<FlatLink> &flatLinks() const { return flat_links_; }
+
+  /// Return the model, pointing to the arrays of this object.
+  FlatRobotModel model() const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,538 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FlatRobotModel.h
+ * @brief Flattened tree robot model, and kinematics and dynamics kernels on
+ * it that compile both for the host and for CUDA devices.
+ *
+ * This header only depends on the standard library, so that it can be
+ * compiled by nvcc without GTSAM or Eigen.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#ifdef __CUDACC__
+#define GTD_HOST_DEVICE __host__ __device__
+#else
+#define GTD_HOST_DEVICE
+#endif
+
+namespace gtdynamics {
+
+/// One joint of the tree, in parent-to-child order.
+struct FlatJoint {
+  char type;             ///< Joint::Type
+  int joint_index;       ///< position in robot.joints()
+  int parent_index;      ///< position of the link closer to the root
+  int child_index;       ///< position of the link further from the root
+  int aligned;           ///< tree child is joint->child()
+  double pMc[12];        ///< rest pose, row-major rotation then translation
+  double cScrewAxis[6];  ///< screw axis in the joint child frame
+  double S[6];           ///< screw axis in the tree child frame
+};
+
+/// Rigid body inertia of one link, about its CoM.
+struct FlatLink {
+  double inertia[9];  ///< row-major rotational inertia
+  double mass;
+};
+
+/**
+ * Flattened tree robot, as plain arrays that can be copied to a device.
+ * Links are ordered as robot.links(), joint vectors as robot.joints(), and
+ * twists and wrenches are [angular; linear] as in ArticulatedBodySolver.
+ * The arrays are not owned.
+ */
+struct FlatRobotModel {
+  int num_links, num_joints;
+  int root_index, root_fixed;
+  double root_pose[12];  ///< pose of a fixed root
+  int has_gravity;
+  double gravity[3];
+  const FlatJoint *joints;  ///< tree joints, parent-to-child order
+  const FlatLink *links;
+};
+
+/**
+ * View of the entries of one rollout in a structure-of-arrays buffer: entry
+ * e of the rollout is data[e * stride]. With stride 1, a plain array.
+ */
+template <class T>
+struct Strided {
+  T *data;
+  size_t stride;
+
+  GTD_HOST_DEVICE T &operator[](size_t e) const { return data[e * stride]; }
+
+  /// View starting at entry e.
+  GTD_HOST_DEVICE Strided<T> operator+(size_t e) const {
+    return Strided<T>{data + e * stride, stride};
+  }
+};
+
+namespace flat {
+
+/// Rigid transform, with a row-major rotation matrix.
+template <class T>
+struct PoseT {
+  T R[9];
+  T t[3];
+};
+using Pose = PoseT<double>;
+
+template <class T>
+GTD_HOST_DEVICE inline void Rotate(const T *R, const T *x, T *y) {
+  for (int i = 0; i < 3; i++) {
+    y[i] = R[3 * i] * x[0] + R[3 * i + 1] * x[1] + R[3 * i + 2] * x[2];
+  }
+}
+
+template <class T>
+GTD_HOST_DEVICE inline void RotateT(const T *R, const T *x, T *y) {
+  for (int i = 0; i < 3; i++) {
+    y[i] = R[i] * x[0] + R[3 + i] * x[1] + R[6 + i] * x[2];
+  }
+}
+
+template <class T>
+GTD_HOST_DEVICE inline void Cross(const T *a, const T *b, T *c) {
+  c[0] = a[1] * b[2] - a[2] * b[1];
+  c[1] = a[2] * b[0] - a[0] * b[2];
+  c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+template <class T = double>
+GTD_HOST_DEVICE inline PoseT<T> Identity() {
+  PoseT<T> X;
+  for (int k = 0; k < 9; k++) X.R[k] = T(k % 4 == 0 ? 1 : 0);
+  for (int k = 0; k < 3; k++) X.t[k] = T(0);
+  return X;
+}
+
+/// Pose of 12 model numbers, rounded to T.
+template <class T = double>
+GTD_HOST_DEVICE inline PoseT<T> FromArray(const double *array) {
+  PoseT<T> X;
+  for (int k = 0; k < 9; k++) X.R[k] = T(array[k]);
+  for (int k = 0; k < 3; k++) X.t[k] = T(array[9 + k]);
+  return X;
+}
+
+template <class T>
+GTD_HOST_DEVICE inline PoseT<T> Compose(const PoseT<T> &A,
+                                        const PoseT<T> &B) {
+  PoseT<T> C;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      C.R[3 * i + j] = A.R[3 * i] * B.R[j] + A.R[3 * i + 1] * B.R[3 + j] +
+                       A.R[3 * i + 2] * B.R[6 + j];
+    }
+  }
+  Rotate(A.R, B.t, C.t);
+  for (int k = 0; k < 3; k++) C.t[k] += A.t[k];
+  return C;
+}
+
+template <class T>
+GTD_HOST_DEVICE inline PoseT<T> Inverse(const PoseT<T> &A) {
+  PoseT<T> B;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) B.R[3 * i + j] = A.R[3 * j + i];
+  }
+  RotateT(A.R, A.t, B.t);
+  for (int k = 0; k < 3; k++) B.t[k] = -B.t[k];
+  return B;
+}
+
+/// exp(cScrewAxis * q), specialized on the joint type as JointKernel::exp.
+template <class T>
+GTD_HOST_DEVICE inline PoseT<T> JointExp(const FlatJoint &joint, T q) {
+  PoseT<T> E = Identity<T>();
+  if (joint.type == 'F') return E;
+  T w[3], v[3];
+  for (int k = 0; k < 3; k++) {
+    w[k] = T(joint.cScrewAxis[k]);
+    v[k] = T(joint.cScrewAxis[3 + k]);
+  }
+  const T norm = std::sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+  if (joint.type == 'P' || norm < T(1e-14)) {
+    for (int k = 0; k < 3; k++) E.t[k] = v[k] * q;
+    return E;
+  }
+
+  // Rodrigues, and the translation (I - R) (w x v) / |w|^2 of a rotation
+  // about a line, plus w (w . v) q / |w|^2 along it for a screw.
+  const T u[3] = {w[0] / norm, w[1] / norm, w[2] / norm};
+  const T s = std::sin(norm * q), omc = T(1) - std::cos(norm * q);
+  const T K[9] = {T(0), -u[2], u[1], u[2], T(0), -u[0], -u[1], u[0], T(0)};
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      const T K2 = K[3 * i] * K[j] + K[3 * i + 1] * K[3 + j] +
+                   K[3 * i + 2] * K[6 + j];
+      E.R[3 * i + j] += s * K[3 * i + j] + omc * K2;
+    }
+  }
+  T p[3], Rp[3];
+  Cross(w, v, p);
+  for (int k = 0; k < 3; k++) p[k] /= norm * norm;
+  Rotate(E.R, p, Rp);
+  const T wv = (w[0] * v[0] + w[1] * v[1] + w[2] * v[2]) / (norm * norm);
+  for (int k = 0; k < 3; k++) E.t[k] = p[k] - Rp[k] + w[k] * wv * q;
+  return E;
+}
+
+/// y = Ad(X) * x = [R * w; t x (R * w) + R * v]
+template <class T>
+GTD_HOST_DEVICE inline void Adjoint(const PoseT<T> &X, const T *x, T *y) {
+  T Rw[3], Rv[3], tRw[3];
+  Rotate(X.R, x, Rw);
+  Rotate(X.R, x + 3, Rv);
+  Cross(X.t, Rw, tRw);
+  for (int k = 0; k < 3; k++) {
+    y[k] = Rw[k];
+    y[3 + k] = tRw[k] + Rv[k];
+  }
+}
+
+/// y = Ad(X)^T * f = [R^T * (f_w - t x f_v); R^T * f_v]
+template <class T>
+GTD_HOST_DEVICE inline void AdjointTranspose(const PoseT<T> &X, const T *f,
+                                             T *y) {
+  T tf[3], m[3];
+  Cross(X.t, f + 3, tf);
+  for (int k = 0; k < 3; k++) m[k] = f[k] - tf[k];
+  RotateT(X.R, m, y);
+  RotateT(X.R, f + 3, y + 3);
+}
+
+/// y = ad(V) * x = [w x x_w; w x x_v + v x x_w]
+template <class T>
+GTD_HOST_DEVICE inline void ad(const T *V, const T *x, T *y) {
+  T a[3], b[3];
+  Cross(V, x, y);
+  Cross(V, x + 3, a);
+  Cross(V + 3, x, b);
+  for (int k = 0; k < 3; k++) y[3 + k] = a[k] + b[k];
+}
+
+/// y = ad(V)^T * f = [-w x f_w - v x f_v; -w x f_v]
+template <class T>
+GTD_HOST_DEVICE inline void adTranspose(const T *V, const T *f, T *y) {
+  T a[3], b[3], c[3];
+  Cross(V, f, a);
+  Cross(V + 3, f + 3, b);
+  Cross(V, f + 3, c);
+  for (int k = 0; k < 3; k++) {
+    y[k] = -a[k] - b[k];
+    y[3 + k] = -c[k];
+  }
+}
+
+/// Row-major 6x6 [[R, 0], [t^ * R, R]].
+template <class T>
+GTD_HOST_DEVICE inline void AdjointMap(const PoseT<T> &X, T *M) {
+  for (int k = 0; k < 36; k++) M[k] = T(0);
+  for (int j = 0; j < 3; j++) {
+    const T col[3] = {X.R[j], X.R[3 + j], X.R[6 + j]};
+    T tcol[3];
+    Cross(X.t, col, tcol);
+    for (int i = 0; i < 3; i++) {
+      M[6 * i + j] = col[i];
+      M[6 * (i + 3) + j + 3] = col[i];
+      M[6 * (i + 3) + j] = tcol[i];
+    }
+  }
+}
+
+/// B += Ad(X)^T * A * Ad(X), all row-major 6x6.
+template <class T>
+GTD_HOST_DEVICE inline void CongruenceAdd(const PoseT<T> &X, const T *A,
+                                          Strided<T> B) {
+  T Ad[36], AAd[36];
+  AdjointMap(X, Ad);
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 6; j++) {
+      T sum = T(0);
+      for (int k = 0; k < 6; k++) sum += A[6 * i + k] * Ad[6 * k + j];
+      AAd[6 * i + j] = sum;
+    }
+  }
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 6; j++) {
+      T sum = T(0);
+      for (int k = 0; k < 6; k++) sum += Ad[6 * k + i] * AAd[6 * k + j];
+      B[6 * i + j] += sum;
+    }
+  }
+}
+
+/// Solve A * x = b by Cholesky, A symmetric positive definite, row-major.
+template <class T>
+GTD_HOST_DEVICE inline void Solve6(const T *A, const T *b, T *x) {
+  T L[36], y[6];
+  for (int j = 0; j < 6; j++) {
+    T diagonal = A[6 * j + j];
+    for (int k = 0; k < j; k++) diagonal -= L[6 * j + k] * L[6 * j + k];
+    L[6 * j + j] = std::sqrt(diagonal);
+    for (int i = j + 1; i < 6; i++) {
+      T sum = A[6 * i + j];
+      for (int k = 0; k < j; k++) sum -= L[6 * i + k] * L[6 * j + k];
+      L[6 * i + j] = sum / L[6 * j + j];
+    }
+  }
+  for (int i = 0; i < 6; i++) {
+    T sum = b[i];
+    for (int k = 0; k < i; k++) sum -= L[6 * i + k] * y[k];
+    y[i] = sum / L[6 * i + i];
+  }
+  for (int i = 5; i >= 0; i--) {
+    T sum = y[i];
+    for (int k = i + 1; k < 6; k++) sum -= L[6 * k + i] * x[k];
+    x[i] = sum / L[6 * i + i];
+  }
+}
+
+template <class T, class U>
+GTD_HOST_DEVICE inline void Load(Strided<T> x, size_t n, U *y) {
+  for (size_t k = 0; k < n; k++) y[k] = x[k];
+}
+
+template <class T>
+GTD_HOST_DEVICE inline void Store(const T *x, size_t n, Strided<T> y) {
+  for (size_t k = 0; k < n; k++) y[k] = x[k];
+}
+
+template <class T>
+GTD_HOST_DEVICE inline PoseT<T> LoadPose(Strided<T> x) {
+  PoseT<T> X;
+  Load(x, 9, X.R);
+  Load(x + 9, 3, X.t);
+  return X;
+}
+
+template <class T>
+GTD_HOST_DEVICE inline void StorePose(const PoseT<T> &X, Strided<T> y) {
+  Store(X.R, 9, y);
+  Store(X.t, 3, y + 9);
+}
+
+/// Offsets of the buffers of FlatForwardDynamics in its workspace.
+struct WorkspaceLayout {
+  size_t wT, cTp, V, bias, IA, pA, A, U, D, u, size;
+
+  GTD_HOST_DEVICE explicit WorkspaceLayout(const FlatRobotModel &model) {
+    const size_t n = model.num_links, m = model.num_joints;
+    wT = 0;
+    cTp = wT + 12 * n;
+    V = cTp + 12 * n;
+    bias = V + 6 * n;
+    IA = bias + 6 * n;
+    pA = IA + 36 * n;
+    A = pA + 6 * n;
+    U = A + 6 * n;
+    D = U + 6 * m;
+    u = D + m;
+    size = u + m;
+  }
+};
+
+}  // namespace flat
+
+/// Number of scalars of workspace of FlatForwardDynamics, per rollout.
+GTD_HOST_DEVICE inline size_t FlatWorkspaceSize(const FlatRobotModel &model) {
+  return flat::WorkspaceLayout(model).size;
+}
+
+/**
+ * Forward kinematics of one rollout, with the root at identity unless
+ * fixed: wT receives 12 numbers per link, the row-major rotation of its CoM
+ * pose then its translation. The scalar T is double or float; with float,
+ * the model is rounded to float and all arithmetic is in float.
+ */
+template <class T>
+GTD_HOST_DEVICE inline void FlatForwardKinematics(const FlatRobotModel &model,
+                                                  Strided<const T> q,
+                                                  Strided<T> wT) {
+  flat::StorePose(model.root_fixed ? flat::FromArray<T>(model.root_pose)
+                                   : flat::Identity<T>(),
+                  wT + 12 * model.root_index);
+  for (int n = 0; n < model.num_joints; n++) {
+    const FlatJoint &joint = model.joints[n];
+    const flat::PoseT<T> X =
+        flat::Compose(flat::FromArray<T>(joint.pMc),
+                      flat::JointExp(joint, T(q[joint.joint_index])));
+    const flat::PoseT<T> wTp = flat::LoadPose(wT + 12 * joint.parent_index);
+    flat::StorePose(flat::Compose(wTp, joint.aligned ? X : flat::Inverse(X)),
+                    wT + 12 * joint.child_index);
+  }
+}
+
+/**
+ * Joint accelerations of one rollout by the ABA, with the same results as
+ * ArticulatedBodySolver::forwardDynamics for a root at identity pose and
+ * zero twist unless fixed. The scalar T is as in FlatForwardKinematics.
+ * @param workspace FlatWorkspaceSize(model) scalars
+ */
+template <class T>
+GTD_HOST_DEVICE inline void FlatForwardDynamics(
+    const FlatRobotModel &model, Strided<const T> q, Strided<const T> v,
+    Strided<const T> tau, Strided<T> workspace, Strided<T> qdd) {
+  const flat::WorkspaceLayout layout(model);
+  const Strided<T> wT = workspace + layout.wT, cTp = workspace + layout.cTp,
+                   V = workspace + layout.V, bias = workspace + layout.bias,
+                   IA = workspace + layout.IA, pA = workspace + layout.pA,
+                   A = workspace + layout.A, U = workspace + layout.U,
+                   D = workspace + layout.D, u = workspace + layout.u;
+  const size_t r = model.root_index;
+
+  // Forward pass: poses, twists and velocity-product accelerations.
+  flat::StorePose(model.root_fixed ? flat::FromArray<T>(model.root_pose)
+                                   : flat::Identity<T>(),
+                  wT + 12 * r);
+  for (size_t k = 0; k < 6; k++) {
+    V[6 * r + k] = T(0);
+    bias[6 * r + k] = T(0);
+  }
+  for (int n = 0; n < model.num_joints; n++) {
+    const FlatJoint &joint = model.joints[n];
+    const size_t p = joint.parent_index, c = joint.child_index;
+    const flat::PoseT<T> X =
+        flat::Compose(flat::FromArray<T>(joint.pMc),
+                      flat::JointExp(joint, T(q[joint.joint_index])));
+    const flat::PoseT<T> cTp_c = joint.aligned ? flat::Inverse(X) : X;
+    flat::StorePose(cTp_c, cTp + 12 * c);
+    flat::StorePose(flat::Compose(flat::LoadPose(wT + 12 * p),
+                                  joint.aligned ? X : flat::Inverse(X)),
+                    wT + 12 * c);
+
+    T Vp[6], Vc[6], Sv[6], bc[6];
+    flat::Load(V + 6 * p, 6, Vp);
+    flat::Adjoint(cTp_c, Vp, Vc);
+    const T v_j = v[joint.joint_index];
+    for (int k = 0; k < 6; k++) {
+      Sv[k] = T(joint.S[k]) * v_j;
+      Vc[k] += Sv[k];
+    }
+    flat::ad(Vc, Sv, bc);
+    flat::Store(Vc, 6, V + 6 * c);
+    flat::Store(bc, 6, bias + 6 * c);
+  }
+
+  // Rigid body inertias and bias wrenches.
+  for (int i = 0; i < model.num_links; i++) {
+    const FlatLink &link = model.links[i];
+    const T mass = T(link.mass);
+    T Vi[6], GV[6], C[6];
+    flat::Load(V + 6 * i, 6, Vi);
+    for (int k = 0; k < 3; k++) {
+      GV[k] = T(link.inertia[3 * k]) * Vi[0] +
+              T(link.inertia[3 * k + 1]) * Vi[1] +
+              T(link.inertia[3 * k + 2]) * Vi[2];
+      GV[3 + k] = mass * Vi[3 + k];
+    }
+    flat::adTranspose(Vi, GV, C);
+    T g[3] = {T(0), T(0), T(0)};
+    if (model.has_gravity) {
+      const T mg[3] = {T(model.gravity[0]) * mass, T(model.gravity[1]) * mass,
+                       T(model.gravity[2]) * mass};
+      T R[9];
+      flat::Load(wT + 12 * i, 9, R);
+      flat::RotateT(R, mg, g);
+    }
+    for (int k = 0; k < 6; k++) {
+      pA[6 * i + k] = -C[k] - (k < 3 ? T(0) : g[k - 3]);
+    }
+    const Strided<T> IA_i = IA + 36 * i;
+    for (int k = 0; k < 36; k++) IA_i[k] = T(0);
+    for (int a = 0; a < 3; a++) {
+      for (int b = 0; b < 3; b++) IA_i[6 * a + b] = T(link.inertia[3 * a + b]);
+      IA_i[6 * (a + 3) + a + 3] = mass;
+    }
+  }
+
+  // Backward pass: accumulate articulated inertias towards the root.
+  for (int n = model.num_joints - 1; n >= 0; n--) {
+    const FlatJoint &joint = model.joints[n];
+    const size_t p = joint.parent_index, c = joint.child_index,
+                 j = joint.joint_index;
+    T S[6], Ia[36], pa[6], bc[6];
+    for (int k = 0; k < 6; k++) S[k] = T(joint.S[k]);
+    flat::Load(IA + 36 * c, 36, Ia);
+    flat::Load(pA + 6 * c, 6, pa);
+    flat::Load(bias + 6 * c, 6, bc);
+    const bool movable = joint.S[0] != 0 || joint.S[1] != 0 ||
+                         joint.S[2] != 0 || joint.S[3] != 0 ||
+                         joint.S[4] != 0 || joint.S[5] != 0;
+    if (movable) {
+      T Uj[6], Dj = T(0), Sp = T(0);
+      for (int a = 0; a < 6; a++) {
+        Uj[a] = T(0);
+        for (int b = 0; b < 6; b++) Uj[a] += Ia[6 * a + b] * S[b];
+      }
+      for (int a = 0; a < 6; a++) {
+        Dj += S[a] * Uj[a];
+        Sp += S[a] * pa[a];
+      }
+      const T uj = tau[j] - Sp;
+      for (int a = 0; a < 6; a++) {
+        for (int b = 0; b < 6; b++) Ia[6 * a + b] -= Uj[a] * Uj[b] / Dj;
+      }
+      for (int a = 0; a < 6; a++) pa[a] += Uj[a] * uj / Dj;
+      flat::Store(Uj, 6, U + 6 * j);
+      D[j] = Dj;
+      u[j] = uj;
+    } else {
+      D[j] = T(0);
+    }
+    for (int a = 0; a < 6; a++) {
+      for (int b = 0; b < 6; b++) pa[a] += Ia[6 * a + b] * bc[b];
+    }
+    const flat::PoseT<T> cTp_c = flat::LoadPose(cTp + 12 * c);
+    flat::CongruenceAdd(cTp_c, Ia, IA + 36 * p);
+    T pp[6];
+    flat::AdjointTranspose(cTp_c, pa, pp);
+    for (int a = 0; a < 6; a++) pA[6 * p + a] += pp[a];
+  }
+
+  // Root acceleration: zero for a fixed base, no joint wrench when floating.
+  if (model.root_fixed) {
+    for (size_t k = 0; k < 6; k++) A[6 * r + k] = T(0);
+  } else {
+    T Ir[36], pr[6], Ar[6];
+    flat::Load(IA + 36 * r, 36, Ir);
+    flat::Load(pA + 6 * r, 6, pr);
+    flat::Solve6(Ir, pr, Ar);
+    for (size_t k = 0; k < 6; k++) A[6 * r + k] = -Ar[k];
+  }
+
+  // Forward pass: joint accelerations.
+  for (int n = 0; n < model.num_joints; n++) {
+    const FlatJoint &joint = model.joints[n];
+    const size_t p = joint.parent_index, c = joint.child_index,
+                 j = joint.joint_index;
+    T Ap[6], Ac[6], bc[6];
+    flat::Load(A + 6 * p, 6, Ap);
+    flat::Load(bias + 6 * c, 6, bc);
+    flat::Adjoint(flat::LoadPose(cTp + 12 * c), Ap, Ac);
+    T a_j = T(0);
+    if (D[j] > 0) {
+      T UA = T(0);
+      for (int k = 0; k < 6; k++) UA += U[6 * j + k] * (Ac[k] + bc[k]);
+      a_j = (u[j] - UA) / D[j];
+    }
+    for (int k = 0; k < 6; k++) {
+      A[6 * c + k] = Ac[k] + bc[k] + T(joint.S[k]) * a_j;
+    }
+    qdd[j] = a_j;
+  }
+}
+
+}  // namespace gtdynamics
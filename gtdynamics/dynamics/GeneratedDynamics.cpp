@@ -0,0 +1,272 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GeneratedDynamics.cpp
+ * @brief Robot-specific generated kernels, behind the solver interface.
+ */
+
+#include <gtdynamics/dynamics/CodeGenerator.h>
+#include <gtdynamics/dynamics/GeneratedDynamics.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// Pose as a row-major rotation followed by a translation.
+void ToArray(const Pose3 &pose, double *array) {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  for (size_t k = 0; k < 9; k++) array[k] = R(k / 3, k % 3);
+  for (size_t k = 0; k < 3; k++) array[9 + k] = pose.translation()(k);
+}
+
+Pose3 FromArray(const double *array) {
+  gtsam::Matrix3 R;
+  for (size_t k = 0; k < 9; k++) R(k / 3, k % 3) = array[k];
+  return Pose3(gtsam::Rot3(R),
+               gtsam::Point3(array[9], array[10], array[11]));
+}
+
+// Root pose and twist from Values, identity and zero if not present.
+void RootState(const Values &values, int root_id, int t, Pose3 *wTroot,
+               Vector6 *V_root) {
+  const auto pose_key = PoseKey(root_id, t), twist_key = TwistKey(root_id, t);
+  *wTroot = values.exists(pose_key) ? values.at<Pose3>(pose_key) : Pose3();
+  *V_root = values.exists(twist_key) ? values.at<Vector6>(twist_key)
+                                     : Vector6(Vector6::Zero());
+}
+}  // namespace
+
+/* ************************************************************************* */
+GeneratedDynamics::GeneratedDynamics(
+    const Robot &robot, const GeneratedKernels *kernels,
+    const boost::optional<gtsam::Vector3> &gravity)
+    : links_(robot.links()), joints_(robot.joints()), kernels_(kernels) {
+  if (!kernels_) {
+    throw std::invalid_argument("GeneratedDynamics: null kernels.");
+  }
+  if (kernels_->abi_version != kGeneratedKernelsAbiVersion) {
+    throw std::invalid_argument(
+        "GeneratedDynamics: kernels were generated for ABI version " +
+        std::to_string(kernels_->abi_version) + ", expected " +
+        std::to_string(kGeneratedKernelsAbiVersion) + ".");
+  }
+  if (kernels_->num_links != links_.size() ||
+      kernels_->num_joints != joints_.size() ||
+      kernels_->fingerprint != RobotFingerprint(robot, gravity)) {
+    throw std::invalid_argument(
+        "GeneratedDynamics: kernels were generated for another robot or "
+        "gravity.");
+  }
+}
+
+/* ************************************************************************* */
+GeneratedDynamics GeneratedDynamics::Load(
+    const Robot &robot, const std::string &library_path,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const std::string &symbol) {
+#ifdef _WIN32
+  throw std::runtime_error(
+      "GeneratedDynamics: loading plugins is not supported on Windows, link "
+      "the generated source instead.");
+#else
+  void *handle = dlopen(library_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    throw std::runtime_error("GeneratedDynamics: cannot load " +
+                             library_path + ": " + dlerror());
+  }
+  std::shared_ptr<void> library(handle, [](void *h) { dlclose(h); });
+
+  typedef const GeneratedKernels *(*KernelsFunction)();
+  const auto function =
+      reinterpret_cast<KernelsFunction>(dlsym(handle, symbol.c_str()));
+  if (!function) {
+    throw std::runtime_error("GeneratedDynamics: no symbol " + symbol +
+                             " in " + library_path);
+  }
+
+  GeneratedDynamics dynamics(robot, function(), gravity);
+  dynamics.library_ = library;
+  return dynamics;
+#endif
+}
+
+/* ************************************************************************* */
+void GeneratedDynamics::checkSize(const Vector &x, const char *name) const {
+  if (size_t(x.size()) != joints_.size()) {
+    throw std::invalid_argument(std::string("GeneratedDynamics: ") + name +
+                                " has the wrong size.");
+  }
+}
+
+/* ************************************************************************* */
+std::vector<Pose3> GeneratedDynamics::forwardKinematics(
+    const Vector &q, const Pose3 &wTroot) const {
+  checkSize(q, "q");
+  double root[12];
+  ToArray(wTroot, root);
+  std::vector<double> poses(12 * links_.size());
+  kernels_->forward_kinematics(q.data(), root, poses.data());
+
+  std::vector<Pose3> result;
+  result.reserve(links_.size());
+  for (size_t i = 0; i < links_.size(); i++) {
+    result.push_back(FromArray(poses.data() + 12 * i));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Matrix GeneratedDynamics::forwardKinematicsJacobian(
+    const Vector &q, const Pose3 &wTroot) const {
+  checkSize(q, "q");
+  double root[12];
+  ToArray(wTroot, root);
+  Matrix J_q(12 * links_.size(), joints_.size());
+  kernels_->forward_kinematics_jacobian(q.data(), root, nullptr, J_q.data());
+  return J_q;
+}
+
+/* ************************************************************************* */
+Vector GeneratedDynamics::inverseDynamics(const Vector &q, const Vector &v,
+                                          const Vector &a, const Pose3 &wTroot,
+                                          const Vector6 &V_root) const {
+  return inverseDynamics(q, v, a, wTroot, V_root, nullptr, nullptr);
+}
+
+/* ************************************************************************* */
+Vector GeneratedDynamics::inverseDynamics(const Vector &q, const Vector &v,
+                                          const Vector &a, const Pose3 &wTroot,
+                                          const Vector6 &V_root, Matrix *J_q,
+                                          Matrix *J_v) const {
+  checkSize(q, "q");
+  checkSize(v, "v");
+  checkSize(a, "a");
+  const size_t m = joints_.size();
+  double root[12];
+  ToArray(wTroot, root);
+  Vector tau(m);
+  if (!J_q && !J_v) {
+    kernels_->inverse_dynamics(q.data(), v.data(), a.data(), root,
+                               V_root.data(), tau.data());
+    return tau;
+  }
+  if (J_q) J_q->resize(m, m);
+  if (J_v) J_v->resize(m, m);
+  kernels_->inverse_dynamics_jacobian(
+      q.data(), v.data(), a.data(), root, V_root.data(), tau.data(),
+      J_q ? J_q->data() : nullptr, J_v ? J_v->data() : nullptr);
+  return tau;
+}
+
+/* ************************************************************************* */
+Vector GeneratedDynamics::forwardDynamics(const Vector &q, const Vector &v,
+                                          const Vector &tau,
+                                          const Pose3 &wTroot,
+                                          const Vector6 &V_root) const {
+  Vector qdd(joints_.size());
+  forwardDynamics(q, v, tau, wTroot, V_root, &qdd);
+  return qdd;
+}
+
+/* ************************************************************************* */
+void GeneratedDynamics::forwardDynamics(const Vector &q, const Vector &v,
+                                        const Vector &tau, const Pose3 &wTroot,
+                                        const Vector6 &V_root,
+                                        Vector *qdd) const {
+  checkSize(q, "q");
+  checkSize(v, "v");
+  checkSize(tau, "tau");
+  double root[12];
+  ToArray(wTroot, root);
+  qdd->resize(joints_.size());
+  kernels_->forward_dynamics(q.data(), v.data(), tau.data(), root,
+                             V_root.data(), qdd->data());
+}
+
+/* ************************************************************************* */
+Vector GeneratedDynamics::forwardDynamics(const Vector &q, const Vector &v,
+                                          const Vector &tau,
+                                          const Pose3 &wTroot,
+                                          const Vector6 &V_root, Matrix *J_q,
+                                          Matrix *J_v, Matrix *J_tau) const {
+  checkSize(q, "q");
+  checkSize(v, "v");
+  checkSize(tau, "tau");
+  const size_t m = joints_.size();
+  double root[12];
+  ToArray(wTroot, root);
+  Vector qdd(m);
+  if (J_q) J_q->resize(m, m);
+  if (J_v) J_v->resize(m, m);
+  if (J_tau) J_tau->resize(m, m);
+  kernels_->forward_dynamics_jacobian(
+      q.data(), v.data(), tau.data(), root, V_root.data(), qdd.data(),
+      J_q ? J_q->data() : nullptr, J_v ? J_v->data() : nullptr,
+      J_tau ? J_tau->data() : nullptr);
+  return qdd;
+}
+
+/* ************************************************************************* */
+Values GeneratedDynamics::solveFD(const Values &known_values, int t) const {
+  const size_t m = joints_.size();
+  Vector q(m), v(m), tau(m);
+  for (size_t j = 0; j < m; j++) {
+    const int id = joints_[j]->id();
+    q(j) = JointAngle(known_values, id, t);
+    v(j) = JointVel(known_values, id, t);
+    tau(j) = Torque(known_values, id, t);
+  }
+
+  Pose3 wTroot;
+  Vector6 V_root;
+  RootState(known_values, root()->id(), t, &wTroot, &V_root);
+  const Vector qdd = forwardDynamics(q, v, tau, wTroot, V_root);
+
+  Values values = known_values;
+  for (size_t j = 0; j < m; j++) {
+    InsertJointAccel(&values, joints_[j]->id(), t, qdd(j));
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values GeneratedDynamics::solveID(const Values &known_values, int t) const {
+  const size_t m = joints_.size();
+  Vector q(m), v(m), a(m);
+  for (size_t j = 0; j < m; j++) {
+    const int id = joints_[j]->id();
+    q(j) = JointAngle(known_values, id, t);
+    v(j) = JointVel(known_values, id, t);
+    a(j) = JointAccel(known_values, id, t);
+  }
+
+  Pose3 wTroot;
+  Vector6 V_root;
+  RootState(known_values, root()->id(), t, &wTroot, &V_root);
+  const Vector tau = inverseDynamics(q, v, a, wTroot, V_root);
+
+  Values values = known_values;
+  for (size_t j = 0; j < m; j++) {
+    InsertTorque(&values, joints_[j]->id(), t, tau(j));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GeneratedDynamics.h
+ * @brief Robot-specific generated kernels, behind the solver interface.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/GeneratedKernels.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * GeneratedDynamics runs the kernels emitted by DynamicsCodeGenerator for a
+ * robot, either compiled into the program or loaded from a plugin, with the
+ * Eigen and gtsam types of ArticulatedBodySolver. The kernels are checked
+ * against the robot and gravity at construction.
+ *
+ * Joint vectors are ordered as robot.joints(), link poses as robot.links().
+ * The root pose and twist are ignored when the root is fixed.
+ */
+class GeneratedDynamics {
+ private:
+  std::vector<LinkSharedPtr> links_;
+  std::vector<JointSharedPtr> joints_;
+  const GeneratedKernels *kernels_;
+  std::shared_ptr<void> library_;  ///< keeps a loaded plugin open
+
+  /// Throw if a joint vector does not have one entry per joint.
+  void checkSize(const gtsam::Vector &x, const char *name) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot    the robot the kernels were generated for
+   * @param kernels  generated kernels, must outlive this object
+   * @param gravity  gravity the kernels were generated with
+   */
+  GeneratedDynamics(
+      const Robot &robot, const GeneratedKernels *kernels,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /**
+   * Load the kernels of a plugin compiled from generated source.
+   * @param robot         the robot the kernels were generated for
+   * @param library_path  path of the shared library
+   * @param gravity       gravity the kernels were generated with
+   * @param symbol        name of the function returning the kernels
+   */
+  static GeneratedDynamics Load(
+      const Robot &robot, const std::string &library_path,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const std::string &symbol = kGeneratedKernelsSymbol);
+
+  /// Return the raw kernels.
+  const GeneratedKernels &kernels() const { return *kernels_; }
+
+  /// Return the number of joints, i.e., the size of all joint vectors.
+  size_t numJoints() const { return joints_.size(); }
+
+  /// Return the root link of the generated traversal.
+  const LinkSharedPtr &root() const { return links_[kernels_->root_link]; }
+
+  /// Return the CoM pose of every link.
+  std::vector<gtsam::Pose3> forwardKinematics(
+      const gtsam::Vector &q,
+      const gtsam::Pose3 &wTroot = gtsam::Pose3()) const;
+
+  /**
+   * Return the derivative of the link poses w.r.t. q, with 12 rows per link:
+   * the row-major rotation matrix followed by the translation.
+   */
+  gtsam::Matrix forwardKinematicsJacobian(
+      const gtsam::Vector &q,
+      const gtsam::Pose3 &wTroot = gtsam::Pose3()) const;
+
+  /// Return the joint torques of the RNEA.
+  gtsam::Vector inverseDynamics(
+      const gtsam::Vector &q, const gtsam::Vector &v, const gtsam::Vector &a,
+      const gtsam::Pose3 &wTroot = gtsam::Pose3(),
+      const gtsam::Vector6 &V_root = gtsam::Vector6::Zero()) const;
+
+  /**
+   * Return the joint torques of the RNEA, and their derivatives w.r.t. the
+   * joint angles and velocities in the optional arguments.
+   */
+  gtsam::Vector inverseDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                                const gtsam::Vector &a,
+                                const gtsam::Pose3 &wTroot,
+                                const gtsam::Vector6 &V_root,
+                                gtsam::Matrix *J_q, gtsam::Matrix *J_v) const;
+
+  /// Return the joint accelerations of the ABA.
+  gtsam::Vector forwardDynamics(
+      const gtsam::Vector &q, const gtsam::Vector &v, const gtsam::Vector &tau,
+      const gtsam::Pose3 &wTroot = gtsam::Pose3(),
+      const gtsam::Vector6 &V_root = gtsam::Vector6::Zero()) const;
+
+  /// Write the joint accelerations of the ABA, allocating only if qdd has
+  /// the wrong size.
+  void forwardDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &tau, const gtsam::Pose3 &wTroot,
+                       const gtsam::Vector6 &V_root, gtsam::Vector *qdd) const;
+
+  /**
+   * Return the joint accelerations of the ABA, and their derivatives w.r.t.
+   * the joint angles, velocities and torques in the optional arguments.
+   */
+  gtsam::Vector forwardDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                                const gtsam::Vector &tau,
+                                const gtsam::Pose3 &wTroot,
+                                const gtsam::Vector6 &V_root,
+                                gtsam::Matrix *J_q, gtsam::Matrix *J_v,
+                                gtsam::Matrix *J_tau) const;
+
+  /**
+   * Solve forward dynamics from joint angles, velocities and torques in
+   * Values, and the root pose and twist if present. Unlike
+   * ArticulatedBodySolver::solveFD, only joint accelerations are added.
+   */
+  gtsam::Values solveFD(const gtsam::Values &known_values, int t = 0) const;
+
+  /// Solve inverse dynamics as solveFD, adding joint torques only.
+  gtsam::Values solveID(const gtsam::Values &known_values, int t = 0) const;
+};
+
+}  // namespace gtdynamics
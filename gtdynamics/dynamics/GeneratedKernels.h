@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GeneratedKernels.h
+ * @brief Interface between GTDynamics and robot-specific generated kernels.
+ *
+ * This header only depends on the standard library, so that generated
+ * kernels can be compiled as a plugin without GTSAM or GTDynamics.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gtdynamics {
+
+/// Version of GeneratedKernels, bumped whenever its layout changes.
+constexpr int kGeneratedKernelsAbiVersion = 1;
+
+/// Default name of the function returning the kernels of a plugin.
+constexpr const char *kGeneratedKernelsSymbol = "GTDynamicsGeneratedKernels";
+
+/**
+ * Straight-line forward kinematics, inverse and forward dynamics of one
+ * robot, generated by DynamicsCodeGenerator with the robot constants and
+ * gravity folded in.
+ *
+ * All arrays are dense doubles. Joint vectors are ordered as
+ * robot.joints(), link poses as robot.links(), each pose being a rotation
+ * matrix in row-major order followed by a translation, 12 numbers. Twists
+ * and wrenches are [angular; linear]. The root pose wTroot (12 numbers) and
+ * twist V_root (6 numbers) are those of the root link CoM, and are ignored
+ * when the root is fixed; null pointers stand for identity and zero.
+ * Jacobians are column-major, one column per joint.
+ */
+struct GeneratedKernels {
+  int abi_version;
+  uint64_t fingerprint;  ///< RobotFingerprint of the robot generated from
+  size_t num_links, num_joints;
+  size_t root_link;  ///< position of the root link in robot.links()
+  bool root_fixed;
+
+  /// Link CoM poses, 12 * num_links numbers.
+  void (*forward_kinematics)(const double *q, const double *wTroot,
+                             double *poses);
+
+  /// Joint torques of the RNEA, num_joints numbers.
+  void (*inverse_dynamics)(const double *q, const double *v, const double *a,
+                           const double *wTroot, const double *V_root,
+                           double *tau);
+
+  /// Joint accelerations of the ABA, num_joints numbers.
+  void (*forward_dynamics)(const double *q, const double *v,
+                           const double *tau, const double *wTroot,
+                           const double *V_root, double *qdd);
+
+  /// Poses and their derivative w.r.t. q, (12 * num_links) x num_joints.
+  void (*forward_kinematics_jacobian)(const double *q, const double *wTroot,
+                                      double *poses, double *J_q);
+
+  /// Torques and their derivatives w.r.t. q and v, num_joints squared.
+  void (*inverse_dynamics_jacobian)(const double *q, const double *v,
+                                    const double *a, const double *wTroot,
+                                    const double *V_root, double *tau,
+                                    double *J_q, double *J_v);
+
+  /// Accelerations and their derivatives w.r.t. q, v and tau.
+  void (*forward_dynamics_jacobian)(const double *q, const double *v,
+                                    const double *tau, const double *wTroot,
+                                    const double *V_root, double *qdd,
+                                    double *J_q, double *J_v, double *J_tau);
+};
+
+}  // namespace gtdynamics
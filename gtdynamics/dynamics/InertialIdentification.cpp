@@ -0,0 +1,270 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialIdentification.cpp
+ * @brief Identification of link inertial parameters from logged joint
+ * trajectories, in regressor form.
+ */
+
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/utils/TrajectoryFile.h>
+
+#include <Eigen/QR>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Matrix3;
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector10;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+Vector10 InertialParameters(const Link &link) {
+  const Matrix3 &I = link.inertia();
+  Vector10 parameters;
+  parameters << link.mass(), 0, 0, 0, I(0, 0), I(0, 1), I(0, 2), I(1, 1),
+      I(1, 2), I(2, 2);
+  return parameters;
+}
+
+/* ************************************************************************* */
+void InsertInertialParameters(gtsam::Values *values, const Robot &robot) {
+  for (auto &&link : robot.links()) {
+    values->insert(InertialParametersKey(link->id()),
+                   InertialParameters(*link));
+  }
+}
+
+/* ************************************************************************* */
+Matrix6 SpatialInertia(const Vector10 &parameters) {
+  const double m = parameters(0);
+  const Matrix3 S_h = gtsam::skewSymmetric(parameters(1), parameters(2),
+                                           parameters(3));
+  Matrix3 I;
+  I << parameters(4), parameters(5), parameters(6),  //
+      parameters(5), parameters(7), parameters(8),   //
+      parameters(6), parameters(8), parameters(9);
+  Matrix6 G;
+  G << I, S_h, S_h.transpose(), m * gtsam::I_3x3;
+  return G;
+}
+
+/* ************************************************************************* */
+double MassProperties(const Vector10 &parameters, gtsam::Point3 *com,
+                      Matrix3 *inertia) {
+  const double m = parameters(0);
+  if (m <= 0) {
+    throw std::invalid_argument("MassProperties: mass should be > 0.");
+  }
+  const gtsam::Point3 c = parameters.segment<3>(1) / m;
+  const Matrix3 S_c = gtsam::skewSymmetric(c(0), c(1), c(2));
+  // I_o = I_c - m S(c)^2, by the parallel axis theorem.
+  if (com) *com = c;
+  if (inertia) *inertia = SpatialInertia(parameters).topLeftCorner<3, 3>() +
+                          m * S_c * S_c;
+  return m;
+}
+
+/* ************************************************************************* */
+InertialRegressor::InertialRegressor(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis)
+    : ArticulatedBodySolver(robot, gravity, planar_axis) {
+  if (!root_fixed_) {
+    throw std::invalid_argument(
+        "InertialRegressor: the root link should be fixed.");
+  }
+}
+
+/* ************************************************************************* */
+Vector InertialRegressor::nominalParameters() const {
+  Vector parameters(numParameters());
+  for (size_t i = 0; i < links_.size(); i++) {
+    parameters.segment<10>(10 * i) = InertialParameters(*links_[i]);
+  }
+  return parameters;
+}
+
+/* ************************************************************************* */
+void InertialRegressor::regressor(const Vector &q, const Vector &v,
+                                  const Vector &a, Matrix *Y) const {
+  if (size_t(a.size()) != joints_.size()) {
+    throw std::invalid_argument(
+        "InertialRegressor: acceleration vector has the wrong size.");
+  }
+  const size_t n = links_.size(), p = numParameters();
+  TreeDynamicsResult result;
+  TreeDynamicsWorkspace workspace;
+  forwardKinematicsPass(q, v, Pose3(), Vector6::Zero(), &result, &workspace);
+  const std::vector<Pose3> &cTp = workspace.iTparent;
+
+  // Twist accelerations, as in inverseDynamics.
+  std::vector<Vector6> A(n);
+  A[root_index_].setZero();
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index;
+    A[c] = cTp[c].Adjoint(A[tj.parent_index]) + tj.S * a(tj.joint_index) +
+           workspace.bias_accels[c];
+  }
+
+  // W[i] maps the parameters to the wrench on link i by its tree joint:
+  // G_i (A_i - g_i) - ad(V_i)^T G_i V_i for its own link, plus the wrenches
+  // of its tree children, all linear in the parameters.
+  std::vector<Matrix> W(n, Matrix::Zero(6, p));
+  for (size_t i = 0; i < n; i++) {
+    const Vector6 &V_i = result.twists[i];
+    Vector6 A_i = A[i];
+    if (gravity_) {
+      A_i.tail<3>() -= result.poses[i].rotation().transpose() * (*gravity_);
+    }
+    const Matrix6 adT = Pose3::adjointMap(V_i).transpose();
+    for (size_t k = 0; k < 10; k++) {
+      const Matrix6 G = SpatialInertia(Vector10::Unit(k));
+      W[i].col(10 * i + k) = G * A_i - adT * (G * V_i);
+    }
+  }
+  for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+    const size_t c = it->child_index;
+    W[it->parent_index] += cTp[c].AdjointMap().transpose() * W[c];
+  }
+
+  Y->resize(joints_.size(), p);
+  for (const TreeJoint &tj : tree_) {
+    Y->row(tj.joint_index) = tj.S.transpose() * W[tj.child_index];
+  }
+}
+
+/* ************************************************************************* */
+Matrix InertialRegressor::regressor(const Vector &q, const Vector &v,
+                                    const Vector &a) const {
+  Matrix Y;
+  regressor(q, v, a, &Y);
+  return Y;
+}
+
+/* ************************************************************************* */
+InertialIdentification::InertialIdentification(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis,
+    const InertialIdentificationParams &params)
+    : regressor_(robot, gravity, planar_axis),
+      params_(params),
+      num_samples_(0),
+      num_buffered_(0) {
+  if (params.chunk_size == 0) {
+    throw std::invalid_argument(
+        "InertialIdentification: chunk_size should be > 0.");
+  }
+  const size_t p = regressor_.numParameters(), m = regressor_.numJoints();
+
+  // The prior rows (pi - pi_0) / prior_sigma start the triangular factor.
+  R_ = Matrix::Zero(p + 1, p + 1);
+  R_.topLeftCorner(p, p).diagonal().setConstant(1.0 / params.prior_sigma);
+  R_.col(p).head(p) = regressor_.nominalParameters() / params.prior_sigma;
+  rows_.resize(params.chunk_size * m, p + 1);
+}
+
+/* ************************************************************************* */
+void InertialIdentification::addSample(const Vector &q, const Vector &v,
+                                       const Vector &a, const Vector &tau) {
+  const size_t p = regressor_.numParameters(), m = regressor_.numJoints();
+  if (size_t(tau.size()) != m) {
+    throw std::invalid_argument(
+        "InertialIdentification: torque vector has the wrong size.");
+  }
+  regressor_.regressor(q, v, a, &Y_);
+  auto rows = rows_.middleRows(num_buffered_ * m, m);
+  rows.leftCols(p) = Y_ / params_.torque_sigma;
+  rows.col(p) = tau / params_.torque_sigma;
+  num_samples_++;
+  if (++num_buffered_ == params_.chunk_size) flush();
+}
+
+/* ************************************************************************* */
+void InertialIdentification::flush() {
+  if (num_buffered_ == 0) return;
+  const size_t p = regressor_.numParameters();
+  const size_t num_rows = num_buffered_ * regressor_.numJoints();
+  Matrix stacked(p + 1 + num_rows, p + 1);
+  stacked << R_, rows_.topRows(num_rows);
+  const Eigen::HouseholderQR<Matrix> qr(stacked);
+  R_ = qr.matrixQR().topRows(p + 1).triangularView<Eigen::Upper>();
+  num_buffered_ = 0;
+}
+
+/* ************************************************************************* */
+size_t InertialIdentification::addTrajectoryFile(const std::string &name) {
+  const TrajectoryFile file(name);
+  const auto &joints = regressor_.joints();
+  const auto &names = file.jointNames();
+  std::vector<size_t> columns;
+  for (auto &&joint : joints) {
+    const auto it = std::find(names.begin(), names.end(), joint->name());
+    if (it == names.end()) {
+      throw std::invalid_argument("InertialIdentification: joint " +
+                                  joint->name() + " is not in " + name + ".");
+    }
+    columns.push_back(it - names.begin());
+  }
+
+  const size_t m = joints.size();
+  const auto qs = file.jointAngles(), vs = file.jointVels();
+  const auto as = file.jointAccels(), taus = file.torques();
+  Vector q(m), v(m), a(m), tau(m);
+  for (size_t r = 0; r < file.numSteps(); r++) {
+    for (size_t j = 0; j < m; j++) {
+      q(j) = qs(r, columns[j]);
+      v(j) = vs(r, columns[j]);
+      a(j) = as(r, columns[j]);
+      tau(j) = taus(r, columns[j]);
+    }
+    addSample(q, v, a, tau);
+  }
+  return file.numSteps();
+}
+
+/* ************************************************************************* */
+Vector InertialIdentification::solve() {
+  flush();
+  const size_t p = regressor_.numParameters();
+  return R_.topLeftCorner(p, p).triangularView<Eigen::Upper>().solve(
+      R_.col(p).head(p));
+}
+
+/* ************************************************************************* */
+double InertialIdentification::residualRms() {
+  flush();
+  const size_t p = regressor_.numParameters();
+  const size_t num_rows = p + num_samples_ * regressor_.numJoints();
+  return std::abs(R_(p, p)) / std::sqrt(double(num_rows));
+}
+
+/* ************************************************************************* */
+gtsam::JacobianFactor::shared_ptr InertialIdentification::linearFactor() {
+  flush();
+  const size_t p = regressor_.numParameters();
+  const auto &links = regressor_.links();
+  std::vector<std::pair<gtsam::Key, Matrix>> terms;
+  for (size_t i = 0; i < links.size(); i++) {
+    terms.emplace_back(InertialParametersKey(links[i]->id()),
+                       R_.block(0, 10 * i, p, 10));
+  }
+  return boost::make_shared<gtsam::JacobianFactor>(terms,
+                                                   Vector(R_.col(p).head(p)));
+}
+
+}  // namespace gtdynamics
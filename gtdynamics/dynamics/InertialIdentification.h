@@ -0,0 +1,187 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialIdentification.h
+ * @brief Identification of link inertial parameters from logged joint
+ * trajectories, in regressor form.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+
+namespace gtdynamics {
+
+/// Shorthand for I_i, for the 10 inertial parameters of the i-th link.
+constexpr DynamicsSymbol InertialParametersKey(int i) {
+  return DynamicsSymbol::LinkSymbol(DynamicsSymbol::Label::Inertial, i, 0);
+}
+
+/**
+ * @name Inertial parameters
+ * The inertial parameters of a link, in its nominal CoM frame, are the 10
+ * coefficients of its spatial inertia, in which wrenches are linear:
+ * [m, h_x, h_y, h_z, I_xx, I_xy, I_xz, I_yy, I_yz, I_zz], with m the mass,
+ * h = m c the first moment of mass, c the CoM in the frame, and I the
+ * rotational inertia about the frame origin.
+ */
+///@{
+
+/// Return the nominal inertial parameters of a link, with h = 0.
+gtsam::Vector10 InertialParameters(const Link &link);
+
+/// Insert the nominal inertial parameters of all links of a robot.
+void InsertInertialParameters(gtsam::Values *values, const Robot &robot);
+
+/// Return the 6 x 6 spatial inertia of inertial parameters, which is the
+/// Link::inertiaMatrix() of the nominal ones.
+gtsam::Matrix6 SpatialInertia(const gtsam::Vector10 &parameters);
+
+/**
+ * Return the mass, CoM and rotational inertia about the CoM of inertial
+ * parameters, with a positive mass.
+ * @param parameters  inertial parameters
+ * @param com         output, CoM in the nominal CoM frame
+ * @param inertia     output, rotational inertia about the CoM
+ */
+double MassProperties(const gtsam::Vector10 &parameters, gtsam::Point3 *com,
+                      gtsam::Matrix3 *inertia);
+
+///@}
+
+/**
+ * InertialRegressor computes the regressor Y(q, v, a) of a fixed-base tree
+ * robot, with which the joint torques of the RNEA are tau = Y pi, for the
+ * inertial parameters pi of all links, 10 per link ordered as robot.links().
+ * The nominal parameters give ArticulatedBodySolver::inverseDynamics.
+ */
+class InertialRegressor : public ArticulatedBodySolver {
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot, a tree with a fixed root link
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   */
+  InertialRegressor(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none);
+
+  /// Return the number of inertial parameters, 10 per link.
+  size_t numParameters() const { return 10 * links_.size(); }
+
+  /// Return the nominal inertial parameters of all links.
+  gtsam::Vector nominalParameters() const;
+
+  /**
+   * Write the num_joints x numParameters() regressor, rows ordered as
+   * robot.joints(), allocating only if Y has the wrong size.
+   */
+  void regressor(const gtsam::Vector &q, const gtsam::Vector &v,
+                 const gtsam::Vector &a, gtsam::Matrix *Y) const;
+
+  /// Return the regressor.
+  gtsam::Matrix regressor(const gtsam::Vector &q, const gtsam::Vector &v,
+                          const gtsam::Vector &a) const;
+};
+
+/// Parameters of InertialIdentification.
+struct InertialIdentificationParams {
+  /// Sigma of the measured torques.
+  double torque_sigma = 1.0;
+
+  /// Sigma of the prior of the parameters on their nominal values, which
+  /// makes the parameters not excited by the data identifiable.
+  double prior_sigma = 1.0;
+
+  /// Number of samples buffered before they are folded into the solution.
+  size_t chunk_size = 1024;
+};
+
+/**
+ * InertialIdentification solves for the inertial parameters of all links,
+ * in least squares, from streamed samples (q, v, a, tau). Each sample adds
+ * the rows Y(q, v, a) pi = tau, the wrench factors of the RNEA with the
+ * inertial parameters as variables, which are linear in them.
+ *
+ * Rows are buffered, then folded with a Householder QR into an upper
+ * triangular square-root information matrix, so that the memory does not
+ * depend on the number of samples, and neither the normal equations nor a
+ * dynamics graph per sample are ever formed.
+ */
+class InertialIdentification {
+ private:
+  InertialRegressor regressor_;
+  InertialIdentificationParams params_;
+  size_t num_samples_, num_buffered_;
+  gtsam::Matrix R_;     // (p + 1) x (p + 1) triangular [R d; 0 e]
+  gtsam::Matrix rows_;  // buffered whitened rows [Y tau]
+  gtsam::Matrix Y_;     // regressor of one sample
+
+  /// Fold the buffered rows into R_.
+  void flush();
+
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot, a tree with a fixed root link
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   * @param params       parameters
+   */
+  InertialIdentification(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none,
+      const InertialIdentificationParams &params =
+          InertialIdentificationParams());
+
+  /// Add a sample, vectors ordered as robot.joints().
+  void addSample(const gtsam::Vector &q, const gtsam::Vector &v,
+                 const gtsam::Vector &a, const gtsam::Vector &tau);
+
+  /**
+   * Add all rows of a trajectory file, read in place from its memory
+   * mapping. Its joints are matched to the robot joints by name.
+   * @return the number of samples added
+   */
+  size_t addTrajectoryFile(const std::string &name);
+
+  /// Return the number of samples added.
+  size_t numSamples() const { return num_samples_; }
+
+  /// Return the inertial parameters of all links, 10 per link ordered as
+  /// robot.links().
+  gtsam::Vector solve();
+
+  /// Return the root mean square of the whitened residuals of all rows,
+  /// including the prior.
+  double residualRms();
+
+  /**
+   * Return the least-squares problem as a JacobianFactor on the
+   * InertialParametersKey of every link, to combine with other factors.
+   */
+  gtsam::JacobianFactor::shared_ptr linearFactor();
+
+  /// Return the regressor.
+  const InertialRegressor &regressor() const { return regressor_; }
+};
+
+}  // namespace gtdynamics
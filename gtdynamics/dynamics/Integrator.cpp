@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Integrator.cpp
+ * @brief Numerical integration of joint angles and velocities.
+ */
+
+#include <gtdynamics/dynamics/Integrator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+/// Derivative [v; a] of the stacked state x = [q; v].
+Vector Derivative(const AccelFunction &accel, const Vector &x,
+                  size_t *evaluations) {
+  const size_t n = x.size() / 2;
+  Vector dx(2 * n);
+  dx.head(n) = x.tail(n);
+  dx.tail(n) = accel(x.head(n), x.tail(n));
+  ++*evaluations;
+  return dx;
+}
+}  // namespace
+
+/* ************************************************************************* */
+size_t Integrate(IntegrationMethod method, const AccelFunction &accel,
+                 double dt, const Vector &a, Vector *q, Vector *v,
+                 double tolerance) {
+  const size_t n = q->size();
+  if (size_t(v->size()) != n || size_t(a.size()) != n) {
+    throw std::invalid_argument("Integrate: vectors have different sizes.");
+  }
+
+  if (method == ExplicitEuler) {
+    *q += dt * (*v) + 0.5 * dt * dt * a;
+    *v += dt * a;
+    return 0;
+  }
+  if (method == SemiImplicitEuler) {
+    *v += dt * a;
+    *q += dt * (*v);
+    return 0;
+  }
+
+  size_t evaluations = 0;
+  Vector x(2 * n), k1(2 * n);
+  x << *q, *v;
+  k1 << *v, a;
+
+  if (method == RK4) {
+    const Vector k2 = Derivative(accel, x + 0.5 * dt * k1, &evaluations);
+    const Vector k3 = Derivative(accel, x + 0.5 * dt * k2, &evaluations);
+    const Vector k4 = Derivative(accel, x + dt * k3, &evaluations);
+    x += dt / 6.0 * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+  } else {
+    // Dormand-Prince 5(4), first-same-as-last: k7 is k1 of the next sub-step.
+    double t = 0.0, h = dt;
+    bool done = (dt <= 0.0);
+    while (!done) {
+      const bool last = (h >= dt - t);
+      if (last) h = dt - t;
+
+      const Vector k2 = Derivative(accel, x + h * (k1 / 5.0), &evaluations);
+      const Vector k3 = Derivative(
+          accel, x + h * (3.0 / 40.0 * k1 + 9.0 / 40.0 * k2), &evaluations);
+      const Vector k4 = Derivative(
+          accel,
+          x + h * (44.0 / 45.0 * k1 - 56.0 / 15.0 * k2 + 32.0 / 9.0 * k3),
+          &evaluations);
+      const Vector k5 = Derivative(
+          accel,
+          x + h * (19372.0 / 6561.0 * k1 - 25360.0 / 2187.0 * k2 +
+                   64448.0 / 6561.0 * k3 - 212.0 / 729.0 * k4),
+          &evaluations);
+      const Vector k6 = Derivative(
+          accel,
+          x + h * (9017.0 / 3168.0 * k1 - 355.0 / 33.0 * k2 +
+                   46732.0 / 5247.0 * k3 + 49.0 / 176.0 * k4 -
+                   5103.0 / 18656.0 * k5),
+          &evaluations);
+      const Vector x_new =
+          x + h * (35.0 / 384.0 * k1 + 500.0 / 1113.0 * k3 +
+                   125.0 / 192.0 * k4 - 2187.0 / 6784.0 * k5 +
+                   11.0 / 84.0 * k6);
+      const Vector k7 = Derivative(accel, x_new, &evaluations);
+
+      // Difference between the fifth and fourth order solutions.
+      const Vector error =
+          h * ((35.0 / 384.0 - 5179.0 / 57600.0) * k1 +
+               (500.0 / 1113.0 - 7571.0 / 16695.0) * k3 +
+               (125.0 / 192.0 - 393.0 / 640.0) * k4 +
+               (-2187.0 / 6784.0 + 92097.0 / 339200.0) * k5 +
+               (11.0 / 84.0 - 187.0 / 2100.0) * k6 - 1.0 / 40.0 * k7);
+      const double scale =
+          tolerance * (1.0 + std::max(x.lpNorm<Eigen::Infinity>(),
+                                      x_new.lpNorm<Eigen::Infinity>()));
+      const double ratio = error.lpNorm<Eigen::Infinity>() / scale;
+
+      const bool accepted = (ratio <= 1.0);
+      if (accepted) {
+        t = last ? dt : t + h;
+        x = x_new;
+        k1 = k7;
+        done = last;
+      }
+
+      // Standard step size control for a fifth order method.
+      double factor = 5.0;
+      if (ratio > 0.0) {
+        factor = std::min(5.0, std::max(0.2, 0.9 * std::pow(ratio, -0.2)));
+      }
+      h *= factor;
+      if (!accepted && h < 1e-12 * dt) {
+        throw std::runtime_error("Integrate: RK45 step size underflow.");
+      }
+    }
+  }
+
+  *q = x.head(n);
+  *v = x.tail(n);
+  return evaluations;
+}
+
+}  // namespace gtdynamics
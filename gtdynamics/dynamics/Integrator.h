@@ -0,0 +1,55 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Integrator.h
+ * @brief Numerical integration of joint angles and velocities.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+
+#include <functional>
+
+namespace gtdynamics {
+
+/**
+ * Integration methods available in the Simulator.
+ *
+ * ExplicitEuler: v += a * dt, q += v * dt + a * dt^2 / 2.
+ * SemiImplicitEuler: symplectic Euler, v += a * dt, q += v_new * dt.
+ * RK4: classical fourth order Runge-Kutta.
+ * RK45: Dormand-Prince 5(4) with adaptive sub-steps and error control.
+ */
+enum IntegrationMethod { ExplicitEuler, SemiImplicitEuler, RK4, RK45 };
+
+/// Joint accelerations as a function of joint angles and velocities.
+using AccelFunction =
+    std::function<gtsam::Vector(const gtsam::Vector &, const gtsam::Vector &)>;
+
+/**
+ * Integrate joint angles and velocities over one time step.
+ *
+ * The accelerations at the start of the step are passed in, as the caller
+ * usually already computed them. Both Euler methods only use those, the
+ * Runge-Kutta methods additionally evaluate `accel` at intermediate states.
+ *
+ * @param method     integration method
+ * @param accel      forward dynamics, returns accelerations for (q, v)
+ * @param dt         duration of the time step
+ * @param a          joint accelerations at the start of the step
+ * @param q          joint angles, updated in place
+ * @param v          joint velocities, updated in place
+ * @param tolerance  error tolerance for RK45, relative and absolute
+ * @return number of calls to `accel`
+ */
+size_t Integrate(IntegrationMethod method, const AccelFunction &accel,
+                 double dt, const gtsam::Vector &a, gtsam::Vector *q,
+                 gtsam::Vector *v, double tolerance = 1e-6);
+
+}  // namespace gtdynamics
@@ -0,0 +1,261 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointSpaceSimulator.cpp
+ * @brief Allocation-free simulator with a preallocated state history.
+ */
+
+#include <gtdynamics/dynamics/CodeGenerator.h>
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+JointSpaceSimulator::JointSpaceSimulator(
+    const Robot &robot, const Values &initial_values, size_t num_steps,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis)
+    : robot_(robot),
+      solver_(robot, gravity, planar_axis),
+      gravity_(gravity),
+      planar_(bool(planar_axis)),
+      num_steps_(num_steps),
+      k_(0),
+      wTroot_(solver_.rootPose(initial_values)),
+      V_root_(solver_.rootTwist(initial_values)),
+      record_tape_(false),
+      delta_(1e-5) {
+  const size_t m = solver_.numJoints();
+  qs_ = Matrix::Zero(m, num_steps + 1);
+  vs_ = Matrix::Zero(m, num_steps + 1);
+  as_ = Matrix::Zero(m, num_steps);
+  taus_ = Matrix::Zero(m, num_steps);
+  for (size_t j = 0; j < m; j++) {
+    const int id = solver_.joints()[j]->id();
+    if (initial_values.exists(JointAngleKey(id)))
+      qs_(j, 0) = JointAngle(initial_values, id);
+    if (initial_values.exists(JointVelKey(id)))
+      vs_(j, 0) = JointVel(initial_values, id);
+  }
+  q_ = qs_.col(0);
+  v_ = vs_.col(0);
+  tau_ = Vector::Zero(m);
+  dts_ = Vector::Zero(num_steps);
+
+  // Size the recursion buffers, so that no step allocates.
+  solver_.forwardDynamics(q_, v_, tau_, wTroot_, V_root_, &result_,
+                          &workspace_);
+}
+
+/* ************************************************************************* */
+void JointSpaceSimulator::reset() {
+  k_ = 0;
+  q_ = qs_.col(0);
+  v_ = vs_.col(0);
+}
+
+/* ************************************************************************* */
+void JointSpaceSimulator::reset(const Vector &q, const Vector &v) {
+  if (size_t(q.size()) != solver_.numJoints() ||
+      size_t(v.size()) != solver_.numJoints()) {
+    throw std::invalid_argument(
+        "JointSpaceSimulator: one angle and velocity per joint expected.");
+  }
+  qs_.col(0) = q;
+  vs_.col(0) = v;
+  reset();
+}
+
+/* ************************************************************************* */
+void JointSpaceSimulator::useGeneratedDynamics(
+    const GeneratedDynamics &dynamics) {
+  if (planar_) {
+    throw std::invalid_argument(
+        "JointSpaceSimulator: generated kernels do not support a planar "
+        "axis.");
+  }
+  if (dynamics.kernels().fingerprint != RobotFingerprint(robot_, gravity_)) {
+    throw std::invalid_argument(
+        "JointSpaceSimulator: kernels were generated for another robot or "
+        "gravity.");
+  }
+  generated_ = dynamics;
+}
+
+/* ************************************************************************* */
+void JointSpaceSimulator::step(const Vector &torques, double dt) {
+  if (k_ >= num_steps_) {
+    throw std::out_of_range("JointSpaceSimulator: history is full.");
+  }
+  if (generated_) {
+    generated_->forwardDynamics(q_, v_, torques, wTroot_, V_root_,
+                                &result_.joint_accels);
+  } else {
+    solver_.forwardDynamics(q_, v_, torques, wTroot_, V_root_, &result_,
+                            &workspace_);
+  }
+  taus_.col(k_) = torques;
+  as_.col(k_) = result_.joint_accels;
+  dts_(k_) = dt;
+  if (record_tape_) recordJacobians(torques);
+
+  q_ += dt * v_ + (0.5 * dt * dt) * as_.col(k_);
+  v_ += dt * as_.col(k_);
+  k_++;
+  qs_.col(k_) = q_;
+  vs_.col(k_) = v_;
+}
+
+/* ************************************************************************* */
+void JointSpaceSimulator::recordTape(bool record, double delta) {
+  record_tape_ = record;
+  delta_ = delta;
+  if (!record) return;
+  const size_t m = solver_.numJoints();
+  tape_q_.resize(m, m * num_steps_);
+  tape_v_.resize(m, m * num_steps_);
+  tape_tau_.resize(m, m * num_steps_);
+  q_pert_.resize(m);
+  v_pert_.resize(m);
+  tau_pert_.resize(m);
+}
+
+/* ************************************************************************* */
+void JointSpaceSimulator::recordJacobians(const Vector &torques) {
+  const size_t m = solver_.numJoints(), first = k_ * m;
+  if (generated_) {
+    Matrix J_q, J_v, J_tau;
+    generated_->forwardDynamics(q_, v_, torques, wTroot_, V_root_, &J_q, &J_v,
+                                &J_tau);
+    tape_q_.middleCols(first, m) = J_q;
+    tape_v_.middleCols(first, m) = J_v;
+    tape_tau_.middleCols(first, m) = J_tau;
+    return;
+  }
+
+  // Central differences, each perturbed input restored after its column.
+  const Vector &accels = result_.joint_accels;
+  q_pert_ = q_;
+  v_pert_ = v_;
+  tau_pert_ = torques;
+  auto differentiate = [&](Vector *x, Matrix *tape) {
+    for (size_t i = 0; i < m; i++) {
+      const double x_i = (*x)(i);
+      (*x)(i) = x_i + delta_;
+      solver_.forwardDynamics(q_pert_, v_pert_, tau_pert_, wTroot_, V_root_,
+                              &result_, &workspace_);
+      tape->col(first + i) = accels;
+      (*x)(i) = x_i - delta_;
+      solver_.forwardDynamics(q_pert_, v_pert_, tau_pert_, wTroot_, V_root_,
+                              &result_, &workspace_);
+      tape->col(first + i) -= accels;
+      tape->col(first + i) /= 2 * delta_;
+      (*x)(i) = x_i;
+    }
+  };
+  differentiate(&q_pert_, &tape_q_);
+  differentiate(&v_pert_, &tape_v_);
+  differentiate(&tau_pert_, &tape_tau_);
+}
+
+/* ************************************************************************* */
+Matrix JointSpaceSimulator::stepJacobian(size_t k, Matrix *J_v,
+                                         Matrix *J_tau) const {
+  if (!record_tape_ || k >= k_) {
+    throw std::out_of_range("JointSpaceSimulator: step not on the tape.");
+  }
+  const size_t m = solver_.numJoints();
+  if (J_v) *J_v = tape_v_.middleCols(k * m, m);
+  if (J_tau) *J_tau = tape_tau_.middleCols(k * m, m);
+  return tape_q_.middleCols(k * m, m);
+}
+
+/* ************************************************************************* */
+JointSpaceSimulator::Gradient JointSpaceSimulator::adjoint(
+    const Matrix &dL_dq, const Matrix &dL_dv) const {
+  const size_t m = solver_.numJoints();
+  if (!record_tape_) {
+    throw std::logic_error("JointSpaceSimulator: no tape was recorded.");
+  }
+  if (size_t(dL_dq.rows()) != m || size_t(dL_dq.cols()) != k_ + 1 ||
+      size_t(dL_dv.rows()) != m || size_t(dL_dv.cols()) != k_ + 1) {
+    throw std::invalid_argument(
+        "JointSpaceSimulator: loss derivatives should be num joints x "
+        "(current step + 1).");
+  }
+
+  // Adjoints of q_k and v_k, back from the last step, through
+  // q_{k+1} = q_k + dt v_k + dt^2/2 a_k and v_{k+1} = v_k + dt a_k.
+  Gradient gradient;
+  gradient.torques.resize(m, k_);
+  gradient.accels.resize(m, k_);
+  Vector lambda_q = dL_dq.col(k_), lambda_v = dL_dv.col(k_);
+  for (size_t k = k_; k-- > 0;) {
+    const double dt = dts_(k);
+    const Vector g_a = (0.5 * dt * dt) * lambda_q + dt * lambda_v;
+    gradient.accels.col(k) = g_a;
+    gradient.torques.col(k) =
+        tape_tau_.middleCols(k * m, m).transpose() * g_a;
+    lambda_v += dL_dv.col(k) + dt * lambda_q +
+                tape_v_.middleCols(k * m, m).transpose() * g_a;
+    lambda_q += dL_dq.col(k) + tape_q_.middleCols(k * m, m).transpose() * g_a;
+  }
+  gradient.q0 = lambda_q;
+  gradient.v0 = lambda_v;
+  return gradient;
+}
+
+/* ************************************************************************* */
+void JointSpaceSimulator::simulate(const Matrix &torques, double dt) {
+  if (size_t(torques.cols()) > num_steps_) {
+    throw std::invalid_argument(
+        "JointSpaceSimulator: more torque columns than steps.");
+  }
+  reset();
+  for (size_t k = 0; k < size_t(torques.cols()); k++) {
+    tau_ = torques.col(k);
+    step(tau_, dt);
+  }
+}
+
+/* ************************************************************************* */
+Values JointSpaceSimulator::values(size_t k) const {
+  if (k > k_) {
+    throw std::out_of_range("JointSpaceSimulator: step not simulated yet.");
+  }
+  Values values;
+  for (size_t j = 0; j < solver_.numJoints(); j++) {
+    const int id = solver_.joints()[j]->id();
+    InsertJointAngle(&values, id, k, qs_(j, k));
+    InsertJointVel(&values, id, k, vs_(j, k));
+    if (k < k_) {
+      InsertJointAccel(&values, id, k, as_(j, k));
+      InsertTorque(&values, id, k, taus_(j, k));
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+TrajectoryState JointSpaceSimulator::trajectoryState() const {
+  TrajectoryState state(robot_, k_ + 1, TrajectoryState::kJointQuantities);
+  state.jointAngles() = qs_.leftCols(k_ + 1);
+  state.jointVels() = vs_.leftCols(k_ + 1);
+  state.jointAccels().leftCols(k_) = as_.leftCols(k_);
+  state.torques().leftCols(k_) = taus_.leftCols(k_);
+  return state;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,211 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointSpaceSimulator.h
+ * @brief Allocation-free simulator with a preallocated state history.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/dynamics/GeneratedDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryState.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+
+namespace gtdynamics {
+
+/**
+ * JointSpaceSimulator simulates a tree robot with the ArticulatedBodySolver,
+ * keeping its state and the whole history in Eigen buffers that are
+ * allocated at construction, instead of in gtsam::Values. After
+ * construction, step() does not allocate.
+ *
+ * Column k of jointAngles() and jointVels() is the state at step k, column k
+ * of jointAccels() and torques() the accelerations and torques of step k.
+ * Rows are ordered as robot.joints().
+ *
+ * As in Simulator, only the joints are integrated: the root link keeps the
+ * pose and twist given in the initial values.
+ *
+ * The joint accelerations can be computed by kernels generated for the
+ * robot by DynamicsCodeGenerator instead, see useGeneratedDynamics.
+ *
+ * With recordTape(), every step also records the Jacobians of its joint
+ * accelerations w.r.t. the joint angles, velocities and torques, so that
+ * adjoint() returns the gradient of a loss on the rollout w.r.t. all torques
+ * and the initial state in one backward pass, instead of one rollout per
+ * torque with finite differences.
+ */
+class JointSpaceSimulator {
+ private:
+  Robot robot_;
+  ArticulatedBodySolver solver_;
+  boost::optional<gtsam::Vector3> gravity_;
+  bool planar_;
+  boost::optional<GeneratedDynamics> generated_;
+  size_t num_steps_, k_;
+  gtsam::Pose3 wTroot_;
+  gtsam::Vector6 V_root_;
+  gtsam::Vector q_, v_, tau_;
+  TreeDynamicsResult result_;
+  TreeDynamicsWorkspace workspace_;
+  gtsam::Matrix qs_, vs_, as_, taus_;
+
+  // Tape of the acceleration Jacobians, block k of each the one of step k.
+  bool record_tape_;
+  double delta_;
+  gtsam::Matrix tape_q_, tape_v_, tape_tau_;
+  gtsam::Vector dts_, q_pert_, v_pert_, tau_pert_;
+
+  /// Record the acceleration Jacobians of step k_, clobbering result_.
+  void recordJacobians(const gtsam::Vector &torques);
+
+ public:
+  /**
+   * Constructor
+   * @param robot          the robot, must be a tree
+   * @param initial_values initial joint angles and velocities, missing ones
+   * are zero, and optionally the root link pose and twist
+   * @param num_steps      maximum number of steps to simulate
+   * @param gravity        gravity vector
+   * @param planar_axis    planar axis vector
+   */
+  JointSpaceSimulator(
+      const Robot &robot, const gtsam::Values &initial_values,
+      size_t num_steps,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none);
+
+  /// Return to the initial state, keeping the buffers.
+  void reset();
+
+  /**
+   * Start again from other joint angles and velocities, keeping the buffers
+   * and the root pose and twist.
+   * @param q joint angles, ordered as robot.joints()
+   * @param v joint velocities, ordered as robot.joints()
+   */
+  void reset(const gtsam::Vector &q, const gtsam::Vector &v);
+
+  /**
+   * Simulate for one time step, with the same integration as Simulator.
+   * @param torques joint torques, ordered as robot.joints()
+   * @param dt      duration for the time step
+   */
+  void step(const gtsam::Vector &torques, double dt);
+
+  /**
+   * Reset and simulate one step per column of `torques`.
+   * @param torques joint torques, one column per step
+   * @param dt      duration for each time step
+   */
+  void simulate(const gtsam::Matrix &torques, double dt);
+
+  /// Return the maximum number of steps.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Return the number of steps taken since the last reset.
+  size_t currentStep() const { return k_; }
+
+  /// Return the current joint angles.
+  const gtsam::Vector &q() const { return q_; }
+
+  /// Return the current joint velocities.
+  const gtsam::Vector &v() const { return v_; }
+
+  /// Return joint angle history, num_joints x (num_steps + 1).
+  const gtsam::Matrix &jointAngles() const { return qs_; }
+
+  /// Return joint velocity history, num_joints x (num_steps + 1).
+  const gtsam::Matrix &jointVels() const { return vs_; }
+
+  /// Return joint acceleration history, num_joints x num_steps.
+  const gtsam::Matrix &jointAccels() const { return as_; }
+
+  /// Return joint torque history, num_joints x num_steps.
+  const gtsam::Matrix &torques() const { return taus_; }
+
+  /// Return the dynamics solver.
+  const ArticulatedBodySolver &solver() const { return solver_; }
+
+  /**
+   * Compute the joint accelerations of step() with generated kernels instead
+   * of the solver. Throws if they were generated for another robot or
+   * gravity, or if the simulator is planar, which they do not support.
+   */
+  void useGeneratedDynamics(const GeneratedDynamics &dynamics);
+
+  /// Go back to computing joint accelerations with the solver.
+  void useSolver() { generated_ = boost::none; }
+
+  /// Return whether step() uses generated kernels.
+  bool usesGeneratedDynamics() const { return bool(generated_); }
+
+  /**
+   * Record the acceleration Jacobians of every step on a tape, allocated
+   * here for numSteps() steps. They are exact with generated kernels, and
+   * central differences of the solver otherwise, exact in the torques as
+   * the accelerations are affine in them.
+   * @param record  whether to record the tape
+   * @param delta   step of the central differences
+   */
+  void recordTape(bool record = true, double delta = 1e-5);
+
+  /// Return whether step() records the tape.
+  bool recordsTape() const { return record_tape_; }
+
+  /**
+   * Return the Jacobians of the joint accelerations of step k w.r.t. the
+   * joint angles, velocities and torques of step k, num_joints x
+   * num_joints each, from the tape.
+   */
+  gtsam::Matrix stepJacobian(size_t k, gtsam::Matrix *J_v = nullptr,
+                             gtsam::Matrix *J_tau = nullptr) const;
+
+  /// Gradient of a rollout loss, see adjoint.
+  struct Gradient {
+    gtsam::Matrix torques;  ///< dL/dtau, num_joints x current step
+    gtsam::Matrix accels;   ///< adjoint of each step's accelerations
+    gtsam::Vector q0, v0;   ///< dL/dq and dL/dv at step 0
+  };
+
+  /**
+   * Backward pass through the steps taken since the last reset, which must
+   * all have been recorded on the tape. The loss L depends on the joint
+   * angles and velocities of any step, with partial derivatives given as
+   * num_joints x (current step + 1) matrices, column k for step k.
+   *
+   * Column k of Gradient::accels is dL/da_k, so that the gradient w.r.t.
+   * any model parameter p is the sum over k of accels.col(k).dot(da_k/dp).
+   * @param dL_dq  partial derivatives of L w.r.t. the joint angles
+   * @param dL_dv  partial derivatives of L w.r.t. the joint velocities
+   */
+  Gradient adjoint(const gtsam::Matrix &dL_dq,
+                   const gtsam::Matrix &dL_dv) const;
+
+  /**
+   * Return joint angles and velocities of step k as Values, as well as joint
+   * accelerations and torques if step k was simulated.
+   */
+  gtsam::Values values(size_t k) const;
+
+  /**
+   * Return the joint history since the last reset, over steps [0, k], k the
+   * current step. The accelerations and torques of step k are zero, as it
+   * was not simulated yet.
+   */
+  TrajectoryState trajectoryState() const;
+};
+
+}  // namespace gtdynamics
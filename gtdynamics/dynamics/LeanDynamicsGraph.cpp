@@ -0,0 +1,167 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeanDynamicsGraph.cpp
+ * @brief Dynamics graph of a legged robot with one chain constraint per leg.
+ */
+
+#include <gtdynamics/dynamics/LeanDynamicsGraph.h>
+#include <gtdynamics/factors/ChainConstraintFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+Vector LegChain::angles(const gtsam::Values &values, size_t k) const {
+  Vector q(joints.size());
+  for (size_t i = 0; i < joints.size(); i++) {
+    q(i) = JointAngle(values, joints[i]->id(), k);
+  }
+  return q;
+}
+
+/* ************************************************************************* */
+LeanDynamicsGraph::LeanDynamicsGraph(
+    const Robot &robot, const std::string &trunk_name,
+    const OptimizerSetting &opt,
+    const boost::optional<gtsam::Vector3> &gravity)
+    : opt_(opt),
+      gravity_(gravity),
+      trunk_(robot.link(trunk_name)),
+      legs_(Legs(robot, trunk_)) {}
+
+/* ************************************************************************* */
+std::vector<LegChain> LeanDynamicsGraph::Legs(const Robot &robot,
+                                              const LinkSharedPtr &trunk) {
+  std::vector<LegChain> legs;
+  for (auto &&hip : trunk->joints()) {
+    // Walk from the trunk to the foot, collecting the joints.
+    std::vector<JointSharedPtr> joints{hip};
+    LinkSharedPtr link = hip->otherLink(trunk);
+    while (true) {
+      JointSharedPtr next;
+      for (auto &&joint : link->joints()) {
+        if (joint == joints.back()) continue;
+        if (next) {
+          throw std::invalid_argument("LeanDynamicsGraph: leg of link " +
+                                      link->name() + " is not serial.");
+        }
+        next = joint;
+      }
+      if (!next) break;
+      joints.push_back(next);
+      link = next->otherLink(link);
+    }
+
+    // Compose the chain from the foot to the trunk: each joint contributes
+    // the pose of its proximal link in its distal link frame.
+    LegChain leg;
+    leg.foot = link;
+    std::vector<Chain> chains;
+    for (auto it = joints.rbegin(); it != joints.rend(); ++it) {
+      const JointSharedPtr &joint = *it;
+      const LinkSharedPtr proximal = joint->otherLink(link);
+      chains.emplace_back(joint->relativePoseOf(proximal, 0.0),
+                          joint->screwAxis(proximal));
+      leg.joints.push_back(joint);
+      link = proximal;
+    }
+    leg.chain = Chain::compose(chains);
+    legs.push_back(leg);
+  }
+  return legs;
+}
+
+namespace {
+// Add the chain constraint of a leg, with fixed-size Jacobians for the
+// instantiated chain lengths.
+void AddChainConstraint(NonlinearFactorGraph *graph,
+                        const gtsam::SharedNoiseModel &cost_model,
+                        const LegChain &leg, gtsam::Key wrench_key, int k) {
+  switch (leg.joints.size()) {
+    case 3:
+      graph->emplace_shared<ChainConstraintFactor<3>>(
+          cost_model, leg.chain, leg.joints, wrench_key, k);
+      break;
+    case 4:
+      graph->emplace_shared<ChainConstraintFactor<4>>(
+          cost_model, leg.chain, leg.joints, wrench_key, k);
+      break;
+    case 6:
+      graph->emplace_shared<ChainConstraintFactor<6>>(
+          cost_model, leg.chain, leg.joints, wrench_key, k);
+      break;
+    case 7:
+      graph->emplace_shared<ChainConstraintFactor<7>>(
+          cost_model, leg.chain, leg.joints, wrench_key, k);
+      break;
+    default:
+      graph->emplace_shared<ChainConstraintFactor<>>(cost_model, leg.chain,
+                                                     leg.joints, wrench_key, k);
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+NonlinearFactorGraph LeanDynamicsGraph::dynamicsFactorGraph(
+    int k, const boost::optional<PointOnLinks> &contact_points) const {
+  NonlinearFactorGraph graph;
+  const int i = trunk_->id();
+
+  // Chain constraints are on torques, so they use the torque factor sigma.
+  auto t_model =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+          opt_.t_cost_model);
+  if (!t_model) {
+    throw std::invalid_argument(
+        "LeanDynamicsGraph: torque cost model must be diagonal.");
+  }
+
+  std::vector<DynamicsSymbol> wrench_keys;
+  for (auto &&leg : legs_) {
+    const DynamicsSymbol wrench_key = WrenchKey(i, leg.hip()->id(), k);
+    wrench_keys.push_back(wrench_key);
+
+    const size_t n = leg.joints.size();
+    auto cost_model = InternedIsotropic(n, t_model->sigma(0));
+    AddChainConstraint(&graph, cost_model, leg, wrench_key, k);
+
+    // A massless leg can only push on the trunk through its foot.
+    if (contact_points) {
+      bool in_contact = false;
+      for (auto &&cp : *contact_points) {
+        if (cp.link->id() == leg.foot->id()) in_contact = true;
+      }
+      if (!in_contact) {
+        graph.emplace_shared<gtsam::PriorFactor<Vector6>>(
+            wrench_key, Vector6::Zero(), opt_.f_cost_model);
+      }
+    }
+  }
+
+  if (opt_.analytic_factors) {
+    graph.emplace_shared<AnalyticWrenchFactor>(opt_.fa_cost_model, trunk_,
+                                               wrench_keys, k, gravity_);
+  } else {
+    graph.add(
+        WrenchFactor(opt_.fa_cost_model, trunk_, wrench_keys, k, gravity_));
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeanDynamicsGraph.h
+ * @brief Dynamics graph of a legged robot with one chain constraint per leg.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * A leg is a serial chain of joints from the trunk to a foot link. The chain
+ * is composed from the foot to the trunk, so that Chain::poe gives the pose
+ * of the trunk CoM in the foot CoM frame, with screw axes in the trunk frame.
+ */
+struct LegChain {
+  std::vector<JointSharedPtr> joints;  ///< joints, from foot to trunk
+  LinkSharedPtr foot;                  ///< last link of the leg
+  Chain chain;                         ///< foot to trunk chain
+
+  /// Return the joint connecting the leg to the trunk.
+  const JointSharedPtr &hip() const { return joints.back(); }
+
+  /// Return joint angles of the leg at time k, in chain order.
+  gtsam::Vector angles(const gtsam::Values &values, size_t k = 0) const;
+
+  /// Return the foot pose given the trunk pose and chain joint angles.
+  gtsam::Pose3 footPose(const gtsam::Pose3 &wTtrunk,
+                        const gtsam::Vector &angles) const {
+    return wTtrunk.compose(chain.poe(angles).inverse());
+  }
+};
+
+/**
+ * LeanDynamicsGraph builds the dynamics graph of a legged robot, made of a
+ * trunk with serial legs, without any intermediate link variables.
+ *
+ * The legs are assumed massless, so the wrench applied on the trunk by each
+ * leg is related to the leg joint torques by one chain constraint,
+ * tau = J^T * F. The trunk has a single wrench factor, and only the trunk
+ * pose, twist and twist acceleration, the leg wrenches, and the joint angles
+ * and torques remain as variables.
+ */
+class LeanDynamicsGraph {
+ private:
+  OptimizerSetting opt_;
+  boost::optional<gtsam::Vector3> gravity_;
+  LinkSharedPtr trunk_;
+  std::vector<LegChain> legs_;
+
+ public:
+  /**
+   * Constructor
+   * @param  robot       the robot, a trunk with serial legs
+   * @param  trunk_name  name of the trunk link
+   * @param  opt         settings for optimizer
+   * @param  gravity     gravity in world frame
+   */
+  LeanDynamicsGraph(
+      const Robot &robot, const std::string &trunk_name,
+      const OptimizerSetting &opt = OptimizerSetting(),
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /**
+   * Decompose a robot into serial legs hanging from the trunk, one per joint
+   * of the trunk. Throws std::invalid_argument if a leg branches.
+   * @param robot  the robot
+   * @param trunk  the trunk link
+   */
+  static std::vector<LegChain> Legs(const Robot &robot,
+                                    const LinkSharedPtr &trunk);
+
+  /// Return the trunk link.
+  const LinkSharedPtr &trunk() const { return trunk_; }
+
+  /// Return the legs, ordered as the joints of the trunk.
+  const std::vector<LegChain> &legs() const { return legs_; }
+
+  /**
+   * Return the lean dynamics graph at time k: the trunk wrench factor, one
+   * chain constraint per leg, and a zero wrench prior on every leg whose foot
+   * is not in contact.
+   * @param k               time step
+   * @param contact_points  contact points, all feet are in contact if not given
+   */
+  gtsam::NonlinearFactorGraph dynamicsFactorGraph(
+      int k,
+      const boost::optional<PointOnLinks> &contact_points = boost::none) const;
+};
+
+}  // namespace gtdynamics
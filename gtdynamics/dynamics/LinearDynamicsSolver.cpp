@@ -0,0 +1,56 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearDynamicsSolver.cpp
+ * @brief Reusable solver for repeated linear forward/inverse dynamics calls.
+ */
+
+#include <gtdynamics/dynamics/LinearDynamicsSolver.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Ordering;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+Ordering LinearDynamicsSolver::OrderingAtTime(const Ordering &ordering,
+                                              int t) {
+  Ordering result;
+  for (gtsam::Key key : ordering) {
+    const DynamicsSymbol symbol(key);
+    result.push_back(DynamicsSymbol::LinkJointSymbol(
+        symbol.label(), symbol.linkIdx(), symbol.jointIdx(), t));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values LinearDynamicsSolver::solveFD(const int t, const Values &known_values) {
+  const Ordering fd_ordering = ordering(t, &fd_ordering_, [&]() {
+    GaussianFactorGraph graph =
+        graph_builder_.linearDynamicsGraph(robot_, t, known_values);
+    graph += DynamicsGraph::linearFDPriors(robot_, t, known_values);
+    return graph;
+  });
+  return graph_builder_.linearSolveFD(robot_, t, known_values, fd_ordering);
+}
+
+/* ************************************************************************* */
+Values LinearDynamicsSolver::solveID(const int t, const Values &known_values) {
+  const Ordering id_ordering = ordering(t, &id_ordering_, [&]() {
+    GaussianFactorGraph graph =
+        graph_builder_.linearDynamicsGraph(robot_, t, known_values);
+    graph += DynamicsGraph::linearIDPriors(robot_, t, known_values);
+    return graph;
+  });
+  return graph_builder_.linearSolveID(robot_, t, known_values, id_ordering);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearDynamicsSolver.h
+ * @brief Reusable solver for repeated linear forward/inverse dynamics calls.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+
+namespace gtdynamics {
+
+/**
+ * LinearDynamicsSolver solves the same problems as
+ * DynamicsGraph::linearSolveFD and DynamicsGraph::linearSolveID, but is meant
+ * to be constructed once and called at every time step.
+ *
+ * The sparsity pattern of the linear dynamics graph only depends on the robot
+ * and its fixed links, so the elimination ordering is computed on the first
+ * call and re-used afterwards, shifted to the requested time step. Only the
+ * numerical factors are rebuilt on each call. Construct a new solver when the
+ * robot structure (e.g., the set of fixed links) changes.
+ */
+class LinearDynamicsSolver {
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+
+  /// Ordering together with the time step its keys refer to.
+  struct CachedOrdering {
+    gtsam::Ordering ordering;
+    int t;
+  };
+  boost::optional<CachedOrdering> fd_ordering_, id_ordering_;
+
+  /**
+   * Return the cached ordering for time t. The ordering is computed with
+   * COLAMD on the first call, using the graph returned by `graph`.
+   */
+  template <typename GRAPH_FUNC>
+  gtsam::Ordering ordering(int t, boost::optional<CachedOrdering> *cache,
+                           GRAPH_FUNC graph) const {
+    if (!*cache) {
+      *cache = CachedOrdering{gtsam::Ordering::Colamd(graph()), t};
+    }
+    if ((*cache)->t == t) return (*cache)->ordering;
+    return OrderingAtTime((*cache)->ordering, t);
+  }
+
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   */
+  LinearDynamicsSolver(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none)
+      : robot_(robot), graph_builder_(gravity, planar_axis) {}
+
+  /// Return the robot.
+  const Robot &robot() const { return robot_; }
+
+  /**
+   * Solve forward dynamics, see DynamicsGraph::linearSolveFD.
+   * @param t            time step
+   * @param known_values Values with poses, twists, joint angles, joint
+   * velocities, and torques
+   */
+  gtsam::Values solveFD(const int t, const gtsam::Values &known_values);
+
+  /**
+   * Solve inverse dynamics, see DynamicsGraph::linearSolveID.
+   * @param t            time step
+   * @param known_values Values with poses, twists, joint angles, joint
+   * velocities, and joint accelerations
+   */
+  gtsam::Values solveID(const int t, const gtsam::Values &known_values);
+
+  /// Shift all keys of an ordering to time step t.
+  static gtsam::Ordering OrderingAtTime(const gtsam::Ordering &ordering,
+                                        int t);
+};
+
+}  // namespace gtdynamics
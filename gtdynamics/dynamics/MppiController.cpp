@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MppiController.cpp
+ * @brief Model predictive path integral control on batched rollouts.
+ */
+
+#include <gtdynamics/dynamics/MppiController.h>
+#include <gtdynamics/utils/ParallelFor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+MppiController::MppiController(const BatchSimulator &simulator,
+                               const MppiParams &params,
+                               const RolloutCost &cost, const Matrix &nominal)
+    : simulator_(simulator),
+      params_(params),
+      cost_(cost),
+      rng_(params.seed) {
+  const size_t m = simulator_.numJoints(), N = params_.num_samples,
+               K = params_.horizon;
+  if (N == 0 || K == 0) {
+    throw std::invalid_argument(
+        "MppiController: num_samples and horizon must be positive.");
+  }
+  if (params_.lambda <= 0) {
+    throw std::invalid_argument("MppiController: lambda must be positive.");
+  }
+  if (params_.sigmas.size() == 0) params_.sigmas = Vector::Ones(m);
+  if (size_t(params_.sigmas.size()) != m ||
+      (params_.sigmas.array() <= 0).any()) {
+    throw std::invalid_argument(
+        "MppiController: sigmas must be positive, one per joint.");
+  }
+  if (params_.lower.size() == 0) {
+    params_.lower = Vector::Constant(m, -std::numeric_limits<double>::max());
+  }
+  if (params_.upper.size() == 0) {
+    params_.upper = Vector::Constant(m, std::numeric_limits<double>::max());
+  }
+  if (size_t(params_.lower.size()) != m || size_t(params_.upper.size()) != m ||
+      (params_.lower.array() > params_.upper.array()).any()) {
+    throw std::invalid_argument(
+        "MppiController: torque limits must be ordered, one per joint.");
+  }
+  if (!cost_) {
+    throw std::invalid_argument("MppiController: no rollout cost.");
+  }
+
+  inverse_variances_ = params_.sigmas.array().square().inverse();
+  initial_qs_.resize(m, N);
+  initial_vs_.resize(m, N);
+  perturbations_.resize(m * K, N);
+  torques_.resize(m * K, N);
+  costs_.resize(N);
+  weights_.resize(N);
+  command_ = Vector::Zero(m);
+  setNominalTorques(nominal.size() == 0 ? Matrix(Matrix::Zero(m, K))
+                                        : nominal);
+}
+
+/* ************************************************************************* */
+void MppiController::setNominalTorques(const Matrix &nominal) {
+  if (size_t(nominal.rows()) != simulator_.numJoints() ||
+      size_t(nominal.cols()) != params_.horizon) {
+    throw std::invalid_argument(
+        "MppiController: nominal torques must be num_joints x horizon.");
+  }
+  nominal_ = nominal;
+}
+
+/* ************************************************************************* */
+void MppiController::sample() {
+  const size_t m = simulator_.numJoints(), N = params_.num_samples,
+               K = params_.horizon;
+  for (size_t r = 0; r < N; r++) {
+    for (size_t k = 0; k < K; k++) {
+      for (size_t j = 0; j < m; j++) {
+        const double nominal = nominal_(j, k);
+        double tau = nominal;
+        if (r > 0) tau += params_.sigmas(j) * normal_(rng_);
+        tau = std::min(std::max(tau, params_.lower(j)), params_.upper(j));
+        torques_(k * m + j, r) = tau;
+        perturbations_(k * m + j, r) = tau - nominal;
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+void MppiController::weigh() {
+  const size_t m = simulator_.numJoints(), K = params_.horizon;
+  const double lambda = params_.lambda;
+  ParallelFor(params_.num_samples, [&](size_t r) {
+    double control_cost = 0;
+    for (size_t k = 0; k < K; k++) {
+      for (size_t j = 0; j < m; j++) {
+        control_cost += nominal_(j, k) * inverse_variances_(j) *
+                        perturbations_(k * m + j, r);
+      }
+    }
+    const Eigen::Map<const Matrix> taus(torques_.col(r).data(), m, K);
+    costs_(r) = cost_(trajectories_.jointAngles(r),
+                      trajectories_.jointVels(r), taus) +
+                lambda * control_cost;
+  });
+
+  // Subtract the minimum cost before exponentiating, for stability.
+  const double min_cost = costs_.minCoeff();
+  weights_ = (-(costs_.array() - min_cost) / lambda).exp();
+  weights_ /= weights_.sum();
+}
+
+/* ************************************************************************* */
+void MppiController::update(const Vector &q, const Vector &v) {
+  const size_t m = simulator_.numJoints();
+  if (size_t(q.size()) != m || size_t(v.size()) != m) {
+    throw std::invalid_argument(
+        "MppiController: state must have one entry per joint.");
+  }
+  initial_qs_.colwise() = q;
+  initial_vs_.colwise() = v;
+  sample();
+  simulator_.simulate(initial_qs_, initial_vs_, torques_, params_.dt,
+                      &trajectories_, &workspace_);
+  weigh();
+
+  Eigen::Map<Vector> nominal(nominal_.data(), nominal_.size());
+  nominal.noalias() += perturbations_ * weights_;
+}
+
+/* ************************************************************************* */
+const Vector &MppiController::control(const Vector &q, const Vector &v) {
+  for (size_t i = 0; i < std::max<size_t>(params_.num_iterations, 1); i++) {
+    update(q, v);
+  }
+  command_ = nominal_.col(0);
+  shift();
+  return command_;
+}
+
+/* ************************************************************************* */
+void MppiController::shift() {
+  // Column by column, as the source and destination blocks overlap.
+  for (size_t k = 0; k + 1 < params_.horizon; k++) {
+    nominal_.col(k) = nominal_.col(k + 1);
+  }
+}
+
+}  // namespace gtdynamics
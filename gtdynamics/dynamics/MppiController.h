@@ -0,0 +1,140 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MppiController.h
+ * @brief Model predictive path integral control on batched rollouts.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <functional>
+#include <random>
+
+namespace gtdynamics {
+
+/// Parameters of MppiController.
+struct MppiParams {
+  size_t num_samples = 256;  ///< number of sampled rollouts per iteration
+  size_t horizon = 20;       ///< number of time steps of each rollout
+  double dt = 0.01;          ///< duration of each time step
+  double lambda = 1.0;       ///< temperature of the importance weights
+  size_t num_iterations = 1;  ///< updates of the nominal torques per cycle
+  gtsam::Vector sigmas;      ///< torque noise per joint, one if empty
+  gtsam::Vector lower, upper;  ///< torque limits per joint, none if empty
+  unsigned seed = 42;        ///< seed of the noise generator
+};
+
+/**
+ * MppiController implements the information-theoretic model predictive path
+ * integral controller of Williams et al. 2017 over joint torques.
+ *
+ * Each iteration samples Gaussian perturbations of a nominal torque sequence,
+ * rolls them all out from the current state with a BatchSimulator, and moves
+ * the nominal torques by the importance-weighted mean of the perturbations,
+ * with weights exp(-S / lambda) of the rollout costs S. The costs include
+ * the control cost lambda * u^T Sigma^-1 eps of the perturbations. Sampled
+ * torques are clipped to the limits, the perturbations being the clipped
+ * ones. Sample 0 is left unperturbed, so the nominal torques always compete.
+ *
+ * All buffers are sized at construction and re-used across control cycles,
+ * so that steady-state cycles do not allocate on the CPU with the Euler
+ * methods, as long as the cost function does not.
+ */
+class MppiController {
+ public:
+  /**
+   * Cost of one rollout, called concurrently for different rollouts.
+   * Its arguments are the joint angles and velocities, num_joints x
+   * (horizon + 1), and the torques, num_joints x horizon.
+   */
+  using RolloutCost = std::function<double(
+      const Eigen::Map<const gtsam::Matrix> &qs,
+      const Eigen::Map<const gtsam::Matrix> &vs,
+      const Eigen::Map<const gtsam::Matrix> &torques)>;
+
+ private:
+  BatchSimulator simulator_;
+  MppiParams params_;
+  RolloutCost cost_;
+  std::mt19937 rng_;
+  std::normal_distribution<double> normal_;
+
+  gtsam::Matrix nominal_;        ///< num_joints x horizon
+  gtsam::Matrix initial_qs_, initial_vs_;  ///< replicated current state
+  gtsam::Matrix perturbations_;  ///< (num_joints * horizon) x num_samples
+  gtsam::Matrix torques_;        ///< nominal plus perturbations
+  gtsam::Vector inverse_variances_;  ///< of the noise per joint
+  gtsam::Vector costs_, weights_;  ///< per sample
+  gtsam::Vector command_;        ///< first torques of the last cycle
+  BatchTrajectories trajectories_;
+  BatchWorkspace workspace_;
+
+  /// Sample the perturbed torques around the nominal torques.
+  void sample();
+
+  /// Compute the costs and normalized weights of the rollouts.
+  void weigh();
+
+ public:
+  /**
+   * Constructor
+   * @param simulator  simulates the sampled rollouts
+   * @param params     controller parameters
+   * @param cost       cost of one rollout
+   * @param nominal    initial nominal torques, zero if empty
+   */
+  MppiController(const BatchSimulator &simulator, const MppiParams &params,
+                 const RolloutCost &cost,
+                 const gtsam::Matrix &nominal = gtsam::Matrix());
+
+  /**
+   * Run one iteration: sample, roll out and update the nominal torques.
+   * @param q  current joint angles
+   * @param v  current joint velocities
+   */
+  void update(const gtsam::Vector &q, const gtsam::Vector &v);
+
+  /**
+   * Run one control cycle: num_iterations updates, then shift the nominal
+   * torques one step forward, repeating the last step.
+   * @param q  current joint angles
+   * @param v  current joint velocities
+   * @return torques to apply for the next dt
+   */
+  const gtsam::Vector &control(const gtsam::Vector &q, const gtsam::Vector &v);
+
+  /// Shift the nominal torques one step forward, repeating the last step.
+  void shift();
+
+  /// Return the nominal torques, num_joints x horizon.
+  const gtsam::Matrix &nominalTorques() const { return nominal_; }
+
+  /// Set the nominal torques, num_joints x horizon.
+  void setNominalTorques(const gtsam::Matrix &nominal);
+
+  /// Return the rollouts of the last iteration.
+  const BatchTrajectories &rollouts() const { return trajectories_; }
+
+  /// Return the sampled torques of the last iteration, as rollouts().as.
+  const gtsam::Matrix &sampledTorques() const { return torques_; }
+
+  /// Return the costs of the rollouts of the last iteration.
+  const gtsam::Vector &costs() const { return costs_; }
+
+  /// Return the normalized importance weights of the last iteration.
+  const gtsam::Vector &weights() const { return weights_; }
+
+  /// Return the parameters.
+  const MppiParams &params() const { return params_; }
+};
+
+}  // namespace gtdynamics
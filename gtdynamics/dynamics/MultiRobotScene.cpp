@@ -0,0 +1,259 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiRobotScene.cpp
+ * @brief Dynamics graphs of several robots in contact with each other.
+ */
+
+#include <gtdynamics/dynamics/MultiRobotScene.h>
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/factors/InteractionFactors.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+
+/* ************************************************************************* */
+size_t MultiRobotScene::addRobot(
+    const std::string &name, const Robot &robot,
+    const boost::optional<PointOnLinks> &ground_contacts,
+    const boost::optional<double> &mu) {
+  if (std::find(names_.begin(), names_.end(), name) != names_.end()) {
+    throw std::invalid_argument("MultiRobotScene: robot " + name +
+                                " already added.");
+  }
+
+  // Ids of this robot start after the largest ids of the previous ones.
+  const int link_offset = link_ends_.empty() ? 0 : link_ends_.back();
+  const int joint_offset = joint_ends_.empty() ? 0 : joint_ends_.back();
+  const Robot shifted = robot.offsetIds(link_offset, joint_offset);
+  int link_end = link_offset, joint_end = joint_offset;
+  for (auto &&link : shifted.links()) {
+    link_end = std::max(link_end, link->id() + 1);
+  }
+  for (auto &&joint : shifted.joints()) {
+    joint_end = std::max(joint_end, joint->id() + 1);
+  }
+
+  // Ground contacts are given on the links of the original robot.
+  boost::optional<PointOnLinks> contacts;
+  if (ground_contacts) {
+    contacts = PointOnLinks();
+    for (auto &&cp : *ground_contacts) {
+      contacts->emplace_back(shifted.link(cp.link->name()), cp.point);
+    }
+  }
+
+  names_.push_back(name);
+  robots_.push_back(shifted);
+  ground_contacts_.push_back(contacts);
+  mus_.push_back(mu);
+  link_offsets_.push_back(link_offset);
+  link_ends_.push_back(link_end);
+  joint_offsets_.push_back(joint_offset);
+  joint_ends_.push_back(joint_end);
+  return robots_.size() - 1;
+}
+
+/* ************************************************************************* */
+size_t MultiRobotScene::robotIndex(const std::string &name) const {
+  auto it = std::find(names_.begin(), names_.end(), name);
+  if (it == names_.end()) {
+    throw std::invalid_argument("MultiRobotScene: no robot named " + name);
+  }
+  return it - names_.begin();
+}
+
+/* ************************************************************************* */
+size_t MultiRobotScene::addContact(const std::string &robot_a,
+                                   const std::string &link_a,
+                                   const Pose3 &comTc_a,
+                                   const std::string &robot_b,
+                                   const std::string &link_b,
+                                   const Pose3 &comTc_b, InteractionType type) {
+  InteractionContact contact;
+  contact.robot_a = robotIndex(robot_a);
+  contact.robot_b = robotIndex(robot_b);
+  if (contact.robot_a == contact.robot_b) {
+    throw std::invalid_argument(
+        "MultiRobotScene: contacts are between two robots.");
+  }
+  if (contacts_.size() + 1 >= DynamicsSymbol::kNoIndex) {
+    throw std::invalid_argument("MultiRobotScene: too many contacts.");
+  }
+  contact.link_a = robots_[contact.robot_a].link(link_a);
+  contact.link_b = robots_[contact.robot_b].link(link_b);
+  contact.comTc_a = comTc_a;
+  contact.comTc_b = comTc_b;
+  contact.type = type;
+  contacts_.push_back(contact);
+  return contacts_.size() - 1;
+}
+
+/* ************************************************************************* */
+size_t MultiRobotScene::addPointContact(
+    const std::string &robot_a, const std::string &link_a,
+    const gtsam::Point3 &point_a, const std::string &robot_b,
+    const std::string &link_b, const gtsam::Point3 &point_b) {
+  return addContact(robot_a, link_a, Pose3(gtsam::Rot3(), point_a), robot_b,
+                    link_b, Pose3(gtsam::Rot3(), point_b),
+                    InteractionType::Point);
+}
+
+/* ************************************************************************* */
+size_t MultiRobotScene::addRigidContact(
+    const std::string &robot_a, const std::string &link_a,
+    const Pose3 &comTc_a, const std::string &robot_b,
+    const std::string &link_b, const Pose3 &comTc_b) {
+  return addContact(robot_a, link_a, comTc_a, robot_b, link_b, comTc_b,
+                    InteractionType::Rigid);
+}
+
+/* ************************************************************************* */
+std::pair<DynamicsSymbol, DynamicsSymbol> MultiRobotScene::contactWrenchKeys(
+    size_t c, int k) const {
+  const InteractionContact &contact = contacts_.at(c);
+  // Contact index 0 is that of ground contacts, see DynamicsGraph.
+  return {ContactWrenchKey(contact.link_a->id(), c + 1, k),
+          ContactWrenchKey(contact.link_b->id(), c + 1, k)};
+}
+
+/* ************************************************************************* */
+boost::optional<size_t> MultiRobotScene::robotOfKey(Key key) const {
+  const DynamicsSymbol symbol(key);
+  const int link = symbol.linkIdx(), joint = symbol.jointIdx();
+  for (size_t r = 0; r < robots_.size(); r++) {
+    if (link != DynamicsSymbol::kNoIndex) {
+      if (link >= link_offsets_[r] && link < link_ends_[r]) return r;
+    } else if (joint != DynamicsSymbol::kNoIndex) {
+      if (joint >= joint_offsets_[r] && joint < joint_ends_[r]) return r;
+    }
+  }
+  return boost::none;
+}
+
+/* ************************************************************************* */
+LinkWrenchKeys MultiRobotScene::interactionWrenches(int k) const {
+  LinkWrenchKeys wrenches;
+  for (size_t c = 0; c < contacts_.size(); c++) {
+    const auto keys = contactWrenchKeys(c, k);
+    wrenches[contacts_[c].link_a->id()].push_back(keys.first);
+    wrenches[contacts_[c].link_b->id()].push_back(keys.second);
+  }
+  return wrenches;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph MultiRobotScene::interactionFactors(int k) const {
+  const OptimizerSetting &opt = graph_builder_.opt();
+  auto gaussian = boost::dynamic_pointer_cast<gtsam::noiseModel::Gaussian>(
+      opt.cp_cost_model);
+  const auto point_model =
+      InternedIsotropic(3, gaussian ? gaussian->sigmas()(0) : 1.0);
+
+  NonlinearFactorGraph graph;
+  for (size_t c = 0; c < contacts_.size(); c++) {
+    const InteractionContact &contact = contacts_[c];
+    const Key pose_a = PoseKey(contact.link_a->id(), k),
+              pose_b = PoseKey(contact.link_b->id(), k);
+    const auto wrench_keys = contactWrenchKeys(c, k);
+
+    if (contact.type == InteractionType::Point) {
+      graph.add(MakeFactor<InteractionPointFactor>(
+          pose_a, pose_b, point_model, contact.comTc_a.translation(),
+          contact.comTc_b.translation()));
+      // No moment about the contact point, on either link.
+      const Key moment_keys[] = {wrench_keys.first, wrench_keys.second};
+      const gtsam::Point3 points[] = {contact.comTc_a.translation(),
+                                      contact.comTc_b.translation()};
+      for (size_t side = 0; side < 2; side++) {
+        const Pose3 cTcom(gtsam::Rot3(), -points[side]);
+        if (opt.analytic_factors) {
+          graph.add(MakeFactor<AnalyticContactDynamicsMomentFactor>(
+              moment_keys[side], opt.cm_cost_model, cTcom));
+        } else {
+          graph.add(MakeFactor<ContactDynamicsMomentFactor>(
+              moment_keys[side], opt.cm_cost_model, cTcom));
+        }
+      }
+    } else {
+      // wTa * comTc_a = wTb * comTc_b, so aTb = comTc_a * comTc_b^{-1}.
+      graph.add(MakeFactor<gtsam::BetweenFactor<Pose3>>(
+          pose_a, pose_b, contact.comTc_a * contact.comTc_b.inverse(),
+          opt.p_cost_model));
+    }
+
+    graph.add(MakeFactor<ReactionWrenchFactor>(
+        pose_a, pose_b, wrench_keys.first, wrench_keys.second,
+        opt.fa_cost_model));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph MultiRobotScene::dynamicsFactorGraph(int k) const {
+  const LinkWrenchKeys wrenches = interactionWrenches(k);
+  NonlinearFactorGraph graph;
+  for (size_t r = 0; r < robots_.size(); r++) {
+    graph_builder_.dynamicsFactorGraph(&graph, robots_[r], k,
+                                       ground_contacts_[r], mus_[r], wrenches);
+  }
+  graph.add(interactionFactors(k));
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph MultiRobotScene::trajectoryFG(
+    int num_steps, double dt, CollocationScheme collocation) const {
+  // Build each time slice independently, then merge them in order.
+  std::vector<NonlinearFactorGraph> slices(num_steps + 1);
+  FactorArena *arena = FactorArena::Active();
+  ParallelFor(slices.size(), [&](size_t t) {
+    FactorArena::Scope scope(arena);
+    slices[t] = dynamicsFactorGraph(t);
+    if (int(t) == num_steps) return;
+    for (auto &&robot : robots_) {
+      slices[t].add(graph_builder_.collocationFactors(robot, t, dt,
+                                                      collocation));
+    }
+  });
+
+  NonlinearFactorGraph graph;
+  for (auto &&slice : slices) graph.add(slice);
+  return graph;
+}
+
+/* ************************************************************************* */
+std::vector<NonlinearFactorGraph> MultiRobotScene::partition(
+    const NonlinearFactorGraph &graph) const {
+  std::vector<NonlinearFactorGraph> partitions(robots_.size());
+  if (partitions.empty()) {
+    throw std::invalid_argument("MultiRobotScene: no robots to partition.");
+  }
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    size_t first = robots_.size();
+    for (Key key : factor->keys()) {
+      if (auto r = robotOfKey(key)) first = std::min(first, *r);
+    }
+    partitions[first < robots_.size() ? first : 0].push_back(factor);
+  }
+  return partitions;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiRobotScene.h
+ * @brief Dynamics graphs of several robots in contact with each other, e.g.
+ * manipulating a shared payload.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// How the links of an InteractionContact act on each other.
+enum class InteractionType {
+  Point,  ///< the contact points coincide and only transmit a force
+  Rigid   ///< the contact frames coincide, e.g. a firm grasp
+};
+
+/// Contact between links of two robots of a MultiRobotScene.
+struct InteractionContact {
+  size_t robot_a, robot_b;        ///< indices of the robots in the scene
+  LinkSharedPtr link_a, link_b;   ///< links of the scene robots
+  gtsam::Pose3 comTc_a, comTc_b;  ///< contact frame in each CoM frame
+  InteractionType type;
+};
+
+/**
+ * MultiRobotScene builds the dynamics graph of several robots, each with its
+ * own ground contacts, coupled by contacts between their links. A payload is
+ * a robot with a single link and no joints.
+ *
+ * Each robot is added with its link and joint ids offset past those of the
+ * robots added before, see Robot::offsetIds, so that the robots keep their
+ * own factors and variables in one graph. Links and joints are still looked
+ * up by name, in the robot they belong to.
+ *
+ * Contact c between links a and b at time step k has the wrenches
+ * ContactWrenchKey(a, c + 1, k) on a and ContactWrenchKey(b, c + 1, k) on b,
+ * which enter the wrench factors of the links next to their joint and ground
+ * contact wrenches. Point contacts make the contact points coincide, with
+ * zero moment about them, and rigid contacts their contact frames; either
+ * way, ReactionWrenchFactor makes the two wrenches opposite. Friction
+ * between robots is not limited, and the contact twists and accelerations
+ * are only consistent through the pose collocation of a trajectory.
+ *
+ * Robots without contacts between them are disconnected components of the
+ * graph, which OptimizationParameters::split_components optimizes apart, and
+ * `partition` splits the graph by robot for ConsensusAdmmOptimizer, so that
+ * only the variables of the contacts are shared.
+ */
+class MultiRobotScene {
+ private:
+  DynamicsGraph graph_builder_;
+  std::vector<std::string> names_;
+  std::vector<Robot> robots_;
+  std::vector<boost::optional<PointOnLinks>> ground_contacts_;
+  std::vector<boost::optional<double>> mus_;
+  std::vector<int> link_offsets_, link_ends_, joint_offsets_, joint_ends_;
+  std::vector<InteractionContact> contacts_;
+
+  // Return the wrenches of the contacts on each link at time step k.
+  LinkWrenchKeys interactionWrenches(int k) const;
+
+  // Add a contact between links of two robots, given by name.
+  size_t addContact(const std::string &robot_a, const std::string &link_a,
+                    const gtsam::Pose3 &comTc_a, const std::string &robot_b,
+                    const std::string &link_b, const gtsam::Pose3 &comTc_b,
+                    InteractionType type);
+
+ public:
+  /**
+   * Constructor.
+   * @param graph_builder  builder of the dynamics graph of each robot
+   */
+  explicit MultiRobotScene(
+      const DynamicsGraph &graph_builder = DynamicsGraph())
+      : graph_builder_(graph_builder) {}
+
+  /**
+   * Add a robot to the scene.
+   * @param name             unique name of the robot in the scene
+   * @param robot            the robot, with any ids
+   * @param ground_contacts  optional contact points with the ground, on links
+   *                         of `robot`
+   * @param mu               optional coefficient of ground friction
+   * @return index of the robot in the scene
+   */
+  size_t addRobot(
+      const std::string &name, const Robot &robot,
+      const boost::optional<PointOnLinks> &ground_contacts = boost::none,
+      const boost::optional<double> &mu = boost::none);
+
+  /**
+   * Add a point contact between links of two robots.
+   * @param robot_a  name of the first robot
+   * @param link_a   name of the link of the first robot
+   * @param point_a  contact point in the CoM frame of link_a
+   * @param robot_b  name of the second robot
+   * @param link_b   name of the link of the second robot
+   * @param point_b  contact point in the CoM frame of link_b
+   * @return index of the contact
+   */
+  size_t addPointContact(const std::string &robot_a, const std::string &link_a,
+                         const gtsam::Point3 &point_a,
+                         const std::string &robot_b, const std::string &link_b,
+                         const gtsam::Point3 &point_b);
+
+  /**
+   * Add a rigid contact between links of two robots, which keeps the given
+   * contact frames equal.
+   * @param comTc_a  contact frame in the CoM frame of link_a
+   * @param comTc_b  contact frame in the CoM frame of link_b
+   * @return index of the contact
+   * See addPointContact for the other arguments.
+   */
+  size_t addRigidContact(const std::string &robot_a, const std::string &link_a,
+                         const gtsam::Pose3 &comTc_a,
+                         const std::string &robot_b, const std::string &link_b,
+                         const gtsam::Pose3 &comTc_b);
+
+  /// Return the number of robots.
+  size_t numRobots() const { return robots_.size(); }
+
+  /// Return robot r, with the ids of its keys in the scene.
+  const Robot &robot(size_t r) const { return robots_.at(r); }
+
+  /// Return the robot with the given name.
+  const Robot &robot(const std::string &name) const {
+    return robots_[robotIndex(name)];
+  }
+
+  /// Return the index of the robot with the given name.
+  size_t robotIndex(const std::string &name) const;
+
+  /// Return the name of robot r.
+  const std::string &robotName(size_t r) const { return names_.at(r); }
+
+  /// Return the offset of the link ids of robot r.
+  int linkOffset(size_t r) const { return link_offsets_.at(r); }
+
+  /// Return the offset of the joint ids of robot r.
+  int jointOffset(size_t r) const { return joint_offsets_.at(r); }
+
+  /// Return the contacts between robots, by index.
+  const std::vector<InteractionContact> &contacts() const { return contacts_; }
+
+  /// Return the keys of the wrenches of contact c on its links at step k.
+  std::pair<DynamicsSymbol, DynamicsSymbol> contactWrenchKeys(size_t c,
+                                                              int k) const;
+
+  /**
+   * Return the robot a key belongs to, by the link id of link keys and the
+   * joint id of joint keys, or none for keys of no link or joint.
+   */
+  boost::optional<size_t> robotOfKey(gtsam::Key key) const;
+
+  /// Return the contact factors between robots at time step k.
+  gtsam::NonlinearFactorGraph interactionFactors(int k) const;
+
+  /// Return the dynamics graph of all robots and contacts at time step k.
+  gtsam::NonlinearFactorGraph dynamicsFactorGraph(int k) const;
+
+  /**
+   * Return the trajectory graph of all robots and contacts, see
+   * DynamicsGraph::trajectoryFG.
+   * @param num_steps    number of time steps
+   * @param dt           duration of each time step
+   * @param collocation  collocation scheme of the joints
+   */
+  gtsam::NonlinearFactorGraph trajectoryFG(
+      int num_steps, double dt,
+      CollocationScheme collocation = Trapezoidal) const;
+
+  /**
+   * Split a graph of the scene by robot, e.g. for ConsensusAdmmOptimizer.
+   * Each factor goes to the first robot of its keys, factors with no robot
+   * keys, e.g. on phase durations, to the first robot. Contact factors thus
+   * go to the first robot of their contact, and the variables of the other
+   * robot they involve become shared by both.
+   * @param graph  a graph on the keys of the scene
+   * @return the graph of each robot; some may be empty
+   */
+  std::vector<gtsam::NonlinearFactorGraph> partition(
+      const gtsam::NonlinearFactorGraph &graph) const;
+};
+
+}  // namespace gtdynamics
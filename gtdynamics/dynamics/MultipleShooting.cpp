@@ -0,0 +1,224 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShooting.cpp
+ * @brief Multiple-shooting trajectory optimization with simulated segments.
+ */
+
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/dynamics/MultipleShooting.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::KeyVector;
+using gtsam::Matrix;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace {
+
+// Angle and velocity keys at k, torque keys of the steps, then the angle and
+// velocity keys at k + num_steps.
+KeyVector ShootingKeys(const Robot &robot, int k, size_t num_steps) {
+  const int end = k + int(num_steps);
+  KeyVector keys;
+  auto add_state = [&](int t) {
+    for (auto &&joint : robot.joints()) {
+      keys.push_back(JointAngleKey(joint->id(), t));
+    }
+    for (auto &&joint : robot.joints()) {
+      keys.push_back(JointVelKey(joint->id(), t));
+    }
+  };
+  add_state(k);
+  for (int t = k; t < end; t++) {
+    for (auto &&joint : robot.joints()) {
+      keys.push_back(TorqueKey(joint->id(), t));
+    }
+  }
+  add_state(end);
+  return keys;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+ShootingFactor::ShootingFactor(
+    const gtsam::SharedNoiseModel &cost_model, const Robot &robot, int k,
+    size_t num_steps, double dt, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis, double delta)
+    : Base(cost_model, ShootingKeys(robot, k, num_steps)),
+      robot_(robot),
+      k_(k),
+      num_steps_(num_steps),
+      dt_(dt),
+      delta_(delta),
+      gravity_(gravity),
+      planar_axis_(planar_axis) {
+  if (num_steps == 0) {
+    throw std::invalid_argument("ShootingFactor: num_steps should be > 0.");
+  }
+}
+
+/* ************************************************************************* */
+Vector ShootingFactor::unwhitenedError(
+    const Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t n = robot_.numJoints(), L = num_steps_, m = 2 * n + n * L;
+
+  // Inputs of the segment, start state then torques, and the end state.
+  Vector inputs(m), end(2 * n);
+  for (size_t i = 0; i < m; i++) inputs(i) = x.atDouble(keys_[i]);
+  for (size_t i = 0; i < 2 * n; i++) end(i) = x.atDouble(keys_[m + i]);
+
+  // One simulator, whose buffers all rollouts reuse.
+  JointSpaceSimulator simulator(robot_, Values(), L, gravity_, planar_axis_);
+  Matrix torques(n, L);
+  Vector state(2 * n);
+  auto rollout = [&](const Vector &u) -> const Vector & {
+    for (size_t s = 0; s < L; s++) {
+      torques.col(s) = u.segment(2 * n + s * n, n);
+    }
+    simulator.reset(u.head(n), u.segment(n, n));
+    simulator.simulate(torques, dt_);
+    state << simulator.q(), simulator.v();
+    return state;
+  };
+
+  const Vector simulated = rollout(inputs);
+  if (H) {
+    H->resize(keys_.size());
+    Vector perturbed = inputs;
+    for (size_t i = 0; i < m; i++) {
+      perturbed(i) += delta_;
+      (*H)[i] = (rollout(perturbed) - simulated) / delta_;
+      perturbed(i) = inputs(i);
+    }
+    for (size_t i = 0; i < 2 * n; i++) (*H)[m + i] = -Vector::Unit(2 * n, i);
+  }
+  return simulated - end;
+}
+
+/* ************************************************************************* */
+MultipleShooting::MultipleShooting(
+    const Robot &robot, size_t num_segments, size_t segment_steps, double dt,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis, double sigma)
+    : robot_(robot),
+      num_segments_(num_segments),
+      segment_steps_(segment_steps),
+      dt_(dt),
+      gravity_(gravity),
+      planar_axis_(planar_axis),
+      model_(InternedIsotropic(2 * robot.numJoints(), sigma)) {
+  if (num_segments == 0 || segment_steps == 0) {
+    throw std::invalid_argument(
+        "MultipleShooting: segments and steps per segment should be > 0.");
+  }
+}
+
+/* ************************************************************************* */
+std::vector<int> MultipleShooting::boundaries() const {
+  std::vector<int> result;
+  for (size_t s = 0; s <= num_segments_; s++) {
+    result.push_back(s * segment_steps_);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph MultipleShooting::shootingFactors() const {
+  gtsam::NonlinearFactorGraph graph;
+  for (size_t s = 0; s < num_segments_; s++) {
+    graph.emplace_shared<ShootingFactor>(model_, robot_, s * segment_steps_,
+                                         segment_steps_, dt_, gravity_,
+                                         planar_axis_);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values MultipleShooting::initialValues(const Values &initial_state,
+                                       const Matrix &torques) const {
+  if (size_t(torques.rows()) != size_t(robot_.numJoints()) ||
+      size_t(torques.cols()) != numSteps()) {
+    throw std::invalid_argument(
+        "MultipleShooting: torques should be num joints x numSteps().");
+  }
+  const auto &joints = robot_.joints();
+  Vector q = Vector::Zero(joints.size()), v = Vector::Zero(joints.size());
+  for (size_t j = 0; j < joints.size(); j++) {
+    const int id = joints[j]->id();
+    if (initial_state.exists(JointAngleKey(id))) {
+      q(j) = JointAngle(initial_state, id);
+    }
+    if (initial_state.exists(JointVelKey(id))) {
+      v(j) = JointVel(initial_state, id);
+    }
+  }
+  JointSpaceSimulator simulator(robot_, Values(), numSteps(), gravity_,
+                                planar_axis_);
+  simulator.reset(q, v);
+  simulator.simulate(torques, dt_);
+
+  Values values;
+  for (int k : boundaries()) {
+    for (size_t j = 0; j < joints.size(); j++) {
+      InsertJointAngle(&values, joints[j]->id(), k,
+                       simulator.jointAngles()(j, k));
+      InsertJointVel(&values, joints[j]->id(), k,
+                     simulator.jointVels()(j, k));
+    }
+  }
+  for (size_t k = 0; k < numSteps(); k++) {
+    for (size_t j = 0; j < joints.size(); j++) {
+      InsertTorque(&values, joints[j]->id(), k, torques(j, k));
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+TrajectoryState MultipleShooting::rollout(const Values &values) const {
+  const auto &joints = robot_.joints();
+  const size_t n = joints.size(), L = segment_steps_;
+  TrajectoryState trajectory(robot_, numSteps() + 1,
+                             TrajectoryState::kJointQuantities);
+  ParallelFor(num_segments_, [&](size_t s) {
+    const int k = s * L;
+    Vector q(n), v(n);
+    Matrix torques(n, L);
+    for (size_t j = 0; j < n; j++) {
+      q(j) = JointAngle(values, joints[j]->id(), k);
+      v(j) = JointVel(values, joints[j]->id(), k);
+      for (size_t i = 0; i < L; i++) {
+        torques(j, i) = Torque(values, joints[j]->id(), k + i);
+      }
+    }
+    JointSpaceSimulator simulator(robot_, Values(), L, gravity_,
+                                  planar_axis_);
+    simulator.reset(q, v);
+    simulator.simulate(torques, dt_);
+
+    // Segments write disjoint columns, the last one also the final state.
+    const size_t columns = s + 1 == num_segments_ ? L + 1 : L;
+    trajectory.jointAngles().middleCols(k, columns) =
+        simulator.jointAngles().leftCols(columns);
+    trajectory.jointVels().middleCols(k, columns) =
+        simulator.jointVels().leftCols(columns);
+    trajectory.jointAccels().middleCols(k, L) = simulator.jointAccels();
+    trajectory.torques().middleCols(k, L) = simulator.torques();
+  });
+  return trajectory;
+}
+
+}  // namespace gtdynamics
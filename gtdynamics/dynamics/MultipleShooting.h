@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShooting.h
+ * @brief Multiple-shooting trajectory optimization with simulated segments.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/TrajectoryState.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ShootingFactor constrains the joint angles and velocities at the end of a
+ * segment of num_steps time steps to those obtained by simulating it, with
+ * JointSpaceSimulator, from the joint angles and velocities at its start
+ * under the torques of its steps. The error is the simulated minus the end
+ * state, angles first, ordered as robot.joints().
+ *
+ * Keys are the joint angles and velocities at the start time k, the torques
+ * of steps k to k + num_steps - 1, step by step, and the joint angles and
+ * velocities at k + num_steps. The Jacobians of the simulated state, the
+ * sensitivities of the segment, are forward differences of rollouts. The
+ * root link of a floating-base robot stays at the identity, at rest.
+ */
+class ShootingFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = ShootingFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  Robot robot_;
+  int k_;
+  size_t num_steps_;
+  double dt_, delta_;
+  boost::optional<gtsam::Vector3> gravity_, planar_axis_;
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model   noise model of dimension 2 * num joints
+   * @param robot        the robot, must be a tree
+   * @param k            time step of the start of the segment
+   * @param num_steps    number of time steps of the segment
+   * @param dt           duration of each time step
+   * @param gravity      gravity vector
+   * @param planar_axis  planar axis vector
+   * @param delta        step of the forward differences
+   */
+  ShootingFactor(const gtsam::SharedNoiseModel &cost_model,
+                 const Robot &robot, int k, size_t num_steps, double dt,
+                 const boost::optional<gtsam::Vector3> &gravity = boost::none,
+                 const boost::optional<gtsam::Vector3> &planar_axis =
+                     boost::none,
+                 double delta = 1e-6);
+
+  ~ShootingFactor() override {}
+
+  /// Simulated minus end joint angles and velocities.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override;
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 GTDKeyFormatter) const override {
+    std::cout << s << "shooting factor from step " << k_ << " over "
+              << num_steps_ << " steps" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * MultipleShooting splits a horizon of num_segments * segment_steps time
+ * steps into segments, each one a ShootingFactor. Only the joint angles and
+ * velocities at the segment boundaries, time steps s * segment_steps, and
+ * the torques of every step are variables, instead of the full state of
+ * every step in direct collocation. The shooting factors are independent,
+ * so they are linearized in parallel when the graph is, e.g. by
+ * ParallelLinearize or by GTSAM built with TBB.
+ *
+ * Objectives, e.g. on the final state or torques, are added to the graph as
+ * usual, on the boundary and torque keys.
+ */
+class MultipleShooting {
+ private:
+  Robot robot_;
+  size_t num_segments_, segment_steps_;
+  double dt_;
+  boost::optional<gtsam::Vector3> gravity_, planar_axis_;
+  gtsam::SharedNoiseModel model_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot          the robot, must be a tree
+   * @param num_segments   number of segments
+   * @param segment_steps  number of time steps of each segment
+   * @param dt             duration of each time step
+   * @param gravity        gravity vector
+   * @param planar_axis    planar axis vector
+   * @param sigma          sigma of the shooting factors
+   */
+  MultipleShooting(const Robot &robot, size_t num_segments,
+                   size_t segment_steps, double dt,
+                   const boost::optional<gtsam::Vector3> &gravity =
+                       boost::none,
+                   const boost::optional<gtsam::Vector3> &planar_axis =
+                       boost::none,
+                   double sigma = 0.001);
+
+  /// Return the number of time steps of the horizon.
+  size_t numSteps() const { return num_segments_ * segment_steps_; }
+
+  /// Return the time steps of the segment boundaries, including 0 and the
+  /// last one.
+  std::vector<int> boundaries() const;
+
+  /// Return one shooting factor per segment.
+  gtsam::NonlinearFactorGraph shootingFactors() const;
+
+  /**
+   * Simulate the whole horizon from an initial state, and return the
+   * boundary joint angles and velocities and all torques, a feasible start.
+   * @param initial_state joint angles and velocities at time 0, missing ones
+   *                      are zero
+   * @param torques       torques, num joints x numSteps(), rows ordered as
+   *                      robot.joints()
+   */
+  gtsam::Values initialValues(const gtsam::Values &initial_state,
+                              const gtsam::Matrix &torques) const;
+
+  /**
+   * Simulate all segments in parallel, each from its boundary values, and
+   * return the joint angles, velocities, accelerations and torques of every
+   * time step of the horizon.
+   */
+  TrajectoryState rollout(const gtsam::Values &values) const;
+};
+
+}  // namespace gtdynamics
@@ -12,39 +12,41 @@
  */
 
 #include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
 
 namespace gtdynamics {
 
 OptimizerSetting::OptimizerSetting()
-    : bp_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.00001)),
-      bv_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.00001)),
-      ba_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.00001)),
-      p_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      v_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      a_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      linear_a_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      linear_f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      fa_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      linear_t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      cp_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      cfriction_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      cv_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, 0.001)),
-      ca_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, 0.001)),
-      cm_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, 0.001)),
-      planar_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, 0.001)),
-      linear_planar_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, 0.001)),
-      prior_q_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      prior_qv_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      prior_qa_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      prior_t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      q_col_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      v_col_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      pose_col_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      twist_col_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, 0.001)),
-      time_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
-      jl_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, 0.001)),
+    : bp_cost_model(InternedIsotropic(6, 0.00001)),
+      bv_cost_model(InternedIsotropic(6, 0.00001)),
+      ba_cost_model(InternedIsotropic(6, 0.00001)),
+      p_cost_model(InternedIsotropic(6, 0.001)),
+      v_cost_model(InternedIsotropic(6, 0.001)),
+      a_cost_model(InternedIsotropic(6, 0.001)),
+      linear_a_cost_model(InternedIsotropic(6, 0.001)),
+      f_cost_model(InternedIsotropic(6, 0.001)),
+      linear_f_cost_model(InternedIsotropic(6, 0.001)),
+      fa_cost_model(InternedIsotropic(6, 0.001)),
+      t_cost_model(InternedIsotropic(1, 0.001)),
+      linear_t_cost_model(InternedIsotropic(1, 0.001)),
+      cp_cost_model(InternedIsotropic(1, 0.001)),
+      cfriction_cost_model(InternedIsotropic(1, 0.001)),
+      cv_cost_model(InternedIsotropic(3, 0.001)),
+      ca_cost_model(InternedIsotropic(3, 0.001)),
+      cm_cost_model(InternedIsotropic(3, 0.001)),
+      ccomp_cost_model(InternedIsotropic(5, 0.001)),
+      planar_cost_model(InternedIsotropic(3, 0.001)),
+      linear_planar_cost_model(InternedIsotropic(3, 0.001)),
+      prior_q_cost_model(InternedIsotropic(1, 0.001)),
+      prior_qv_cost_model(InternedIsotropic(1, 0.001)),
+      prior_qa_cost_model(InternedIsotropic(1, 0.001)),
+      prior_t_cost_model(InternedIsotropic(1, 0.001)),
+      q_col_cost_model(InternedIsotropic(1, 0.001)),
+      v_col_cost_model(InternedIsotropic(1, 0.001)),
+      pose_col_cost_model(InternedIsotropic(6, 0.001)),
+      twist_col_cost_model(InternedIsotropic(6, 0.001)),
+      time_cost_model(InternedIsotropic(1, 0.001)),
+      jl_cost_model(InternedIsotropic(1, 0.001)),
       rel_thresh(1e-2),
       max_iter(50) {}
 
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/NoiseModelCache.h>
 #include <gtsam/linear/NoiseModel.h>
 
 namespace gtdynamics {
@@ -42,6 +43,7 @@ class OptimizerSetting {
       cv_cost_model,             // contact twist
       ca_cost_model,             // contact acceleration
       cm_cost_model,             // contact moment
+      ccomp_cost_model,          // contact complementarity
       planar_cost_model,         // planar factor
       linear_planar_cost_model,  // linear planar factor
       prior_q_cost_model,        // joint angle prior factor
@@ -66,6 +68,20 @@ class OptimizerSetting {
   double epsilon;   // obstacle clearance
   double obsSigma;  // obstacle cost model covariance
 
+  /// factor setting
+  bool analytic_factors = false;  // hand-written Jacobians, core and contact
+  bool fused_link_factors = false;  // one LinkDynamicsFactor per link
+  size_t friction_cone_facets = 0;  // pyramid facets, 0 for the exact cone
+  bool vector_joint_limits = false;  // one limit factor per quantity and step
+  bool inertial_variables = false;  // inertial parameters as variables
+  bool contact_implicit = false;  // contact points as candidates, see below
+  double complementarity_relaxation = 1e-3;  // eps of the complementarity
+
+  // With contact_implicit, the contact points given to DynamicsGraph are
+  // candidates: instead of the contact height, twist and acceleration
+  // factors, each gets a ContactComplementarityFactor, so that the solve
+  // decides when each is in contact, see ExtractContactSchedule.
+
   /// default constructor
   OptimizerSetting();
 
@@ -83,43 +99,34 @@ class OptimizerSetting {
   OptimizerSetting(double sigma_dynamics, double sigma_linear = 0.001,
                    double sigma_contact = 0.001, double sigma_joint = 0.001,
                    double sigma_collocation = 0.001, double sigma_time = 0.001)
-      : bp_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        bv_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        ba_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        p_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        v_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        a_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        linear_a_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(6, sigma_linear)),
-        f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        linear_f_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(6, sigma_linear)),
-        fa_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_dynamics)),
-        linear_t_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_linear)),
-        cp_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_contact)),
-        cfriction_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_contact)),
-        cv_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        ca_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        cm_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        planar_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(3, sigma_dynamics)),
-        linear_planar_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(3, sigma_linear)),
-        prior_q_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_qv_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_qa_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        q_col_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_collocation)),
-        v_col_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_collocation)),
-        time_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_time)),
-        jl_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
+      : bp_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        bv_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        ba_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        p_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        v_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        a_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        linear_a_cost_model(InternedIsotropic(6, sigma_linear)),
+        f_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        linear_f_cost_model(InternedIsotropic(6, sigma_linear)),
+        fa_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        t_cost_model(InternedIsotropic(1, sigma_dynamics)),
+        linear_t_cost_model(InternedIsotropic(1, sigma_linear)),
+        cp_cost_model(InternedIsotropic(1, sigma_contact)),
+        cfriction_cost_model(InternedIsotropic(1, sigma_contact)),
+        cv_cost_model(InternedIsotropic(3, sigma_contact)),
+        ca_cost_model(InternedIsotropic(3, sigma_contact)),
+        cm_cost_model(InternedIsotropic(3, sigma_contact)),
+        ccomp_cost_model(InternedIsotropic(5, sigma_contact)),
+        planar_cost_model(InternedIsotropic(3, sigma_dynamics)),
+        linear_planar_cost_model(InternedIsotropic(3, sigma_linear)),
+        prior_q_cost_model(InternedIsotropic(1, sigma_joint)),
+        prior_qv_cost_model(InternedIsotropic(1, sigma_joint)),
+        prior_qa_cost_model(InternedIsotropic(1, sigma_joint)),
+        prior_t_cost_model(InternedIsotropic(1, sigma_joint)),
+        q_col_cost_model(InternedIsotropic(1, sigma_collocation)),
+        v_col_cost_model(InternedIsotropic(1, sigma_collocation)),
+        time_cost_model(InternedIsotropic(1, sigma_time)),
+        jl_cost_model(InternedIsotropic(1, sigma_joint)),
         rel_thresh(1e-2),
         max_iter(50) {}
 
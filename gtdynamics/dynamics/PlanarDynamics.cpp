@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamics.cpp
+ * @brief SE(2) kinematics and dynamics of links and joints of planar robots.
+ */
+
+#include <gtdynamics/dynamics/PlanarDynamics.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix3;
+using gtsam::Pose2;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+/* ************************************************************************* */
+PlanarProjection::PlanarProjection(const Vector3 &planar_axis) : axis_(-1) {
+  for (int i = 0; i < 3; i++) {
+    if (planar_axis.isApprox(Vector3::Unit(i))) axis_ = i;
+  }
+  if (axis_ < 0) {
+    throw std::invalid_argument(
+        "PlanarProjection: the planar axis should be the x, y or z axis.");
+  }
+  u_ = (axis_ + 1) % 3;
+  v_ = (axis_ + 2) % 3;
+}
+
+/* ************************************************************************* */
+Pose2 PlanarProjection::pose(const gtsam::Pose3 &pose) const {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  const gtsam::Point3 &t = pose.translation();
+  return Pose2(t[u_], t[v_], std::atan2(R(v_, u_), R(u_, u_)));
+}
+
+/* ************************************************************************* */
+Vector3 PlanarProjection::twist(const Vector6 &twist) const {
+  return Vector3(twist[3 + u_], twist[3 + v_], twist[axis_]);
+}
+
+/* ************************************************************************* */
+Vector3 PlanarProjection::wrench(const Vector6 &wrench) const {
+  return Vector3(wrench[3 + u_], wrench[3 + v_], wrench[axis_]);
+}
+
+/* ************************************************************************* */
+gtsam::Vector2 PlanarProjection::vector(const Vector3 &vector) const {
+  return gtsam::Vector2(vector[u_], vector[v_]);
+}
+
+/* ************************************************************************* */
+gtsam::Pose3 PlanarProjection::liftPose(const Pose2 &pose,
+                                        double depth) const {
+  gtsam::Point3 t;
+  t[u_] = pose.x();
+  t[v_] = pose.y();
+  t[axis_] = depth;
+  return gtsam::Pose3(
+      gtsam::Rot3::AxisAngle(gtsam::Point3(Vector3::Unit(axis_)), pose.theta()),
+      t);
+}
+
+/* ************************************************************************* */
+Vector6 PlanarProjection::liftTwist(const Vector3 &twist) const {
+  Vector6 result = Vector6::Zero();
+  result[axis_] = twist[2];
+  result[3 + u_] = twist[0];
+  result[3 + v_] = twist[1];
+  return result;
+}
+
+/* ************************************************************************* */
+Vector6 PlanarProjection::liftWrench(const Vector3 &wrench) const {
+  // Wrenches order moments and forces as twists do.
+  return liftTwist(wrench);
+}
+
+/* ************************************************************************* */
+bool PlanarProjection::isPlanar(const gtsam::Pose3 &pose, double tol) const {
+  const Vector3 axis = Vector3::Unit(axis_);
+  return (pose.rotation().matrix() * axis - axis).norm() < tol;
+}
+
+/* ************************************************************************* */
+bool PlanarProjection::isPlanar(const Vector6 &twist, double tol) const {
+  return std::abs(twist[u_]) < tol && std::abs(twist[v_]) < tol &&
+         std::abs(twist[3 + axis_]) < tol;
+}
+
+/* ************************************************************************* */
+PlanarJoint::PlanarJoint(const Joint &joint,
+                         const PlanarProjection &projection)
+    : id(joint.id()),
+      parent_id(joint.parent()->id()),
+      child_id(joint.child()->id()) {
+  if (!projection.isPlanar(joint.pMc()) ||
+      !projection.isPlanar(joint.cScrewAxis())) {
+    throw std::invalid_argument("PlanarJoint: joint " + joint.name() +
+                                " does not move in the plane.");
+  }
+  pMc = projection.pose(joint.pMc());
+  screw_axis = projection.twist(joint.cScrewAxis());
+}
+
+/* ************************************************************************* */
+Pose2 PlanarJoint::parentTchild(double q,
+                                gtsam::OptionalJacobian<3, 1> H_q) const {
+  Matrix3 exp_H_screw;
+  const Pose2 exp = Pose2::Expmap(screw_axis * q, H_q ? &exp_H_screw : 0);
+  if (H_q) *H_q = exp_H_screw * screw_axis;
+  return pMc * exp;  // The derivative of compose in exp is identity.
+}
+
+/* ************************************************************************* */
+Vector3 PlanarJoint::childTwist(const Vector3 &twist_p, double q,
+                                double q_dot,
+                                gtsam::OptionalJacobian<3, 3> H_twist_p,
+                                gtsam::OptionalJacobian<3, 1> H_q,
+                                gtsam::OptionalJacobian<3, 1> H_q_dot) const {
+  const Matrix3 cAdp = parentTchild(q).inverse().AdjointMap();
+  const Vector3 transformed = cAdp * twist_p;
+  if (H_twist_p) *H_twist_p = cAdp;
+  // cTp = Exp(-S q) * pMc^-1, so d(Ad(cTp))/dq = -ad(S) * Ad(cTp).
+  if (H_q) *H_q = -Pose2::adjointMap(screw_axis) * transformed;
+  if (H_q_dot) *H_q_dot = screw_axis;
+  return transformed + screw_axis * q_dot;
+}
+
+/* ************************************************************************* */
+Vector3 PlanarJoint::parentWrench(const Vector3 &wrench_c, double q,
+                                  gtsam::OptionalJacobian<3, 3> H_wrench_c,
+                                  gtsam::OptionalJacobian<3, 1> H_q) const {
+  const Matrix3 cAdp = parentTchild(q).inverse().AdjointMap();
+  if (H_wrench_c) *H_wrench_c = -cAdp.transpose();
+  if (H_q) {
+    *H_q = cAdp.transpose() *
+           Pose2::adjointMap(screw_axis).transpose() * wrench_c;
+  }
+  return -cAdp.transpose() * wrench_c;
+}
+
+/* ************************************************************************* */
+PlanarLink::PlanarLink(const Link &link, const PlanarProjection &projection)
+    : id(link.id()),
+      mass(link.mass()),
+      inertia(link.inertia()(projection.axis(), projection.axis())) {}
+
+/* ************************************************************************* */
+Matrix3 PlanarLink::inertiaMatrix() const {
+  return Vector3(mass, mass, inertia).asDiagonal();
+}
+
+/* ************************************************************************* */
+Vector3 PlanarLink::coriolis(const Vector3 &twist,
+                             gtsam::OptionalJacobian<3, 3> H_twist) const {
+  const double vx = twist[0], vy = twist[1], w = twist[2];
+  if (H_twist) {
+    *H_twist << 0, mass * w, mass * vy,  //
+        -mass * w, 0, -mass * vx,        //
+        0, 0, 0;
+  }
+  return Vector3(mass * w * vy, -mass * w * vx, 0);
+}
+
+/* ************************************************************************* */
+Vector3 PlanarLink::gravityWrench(const gtsam::Vector2 &gravity,
+                                  const Pose2 &wTcom,
+                                  gtsam::OptionalJacobian<3, 3> H_pose) const {
+  const gtsam::Point2 g = wTcom.rotation().unrotate(gtsam::Point2(gravity));
+  if (H_pose) {
+    // Rotating the frame by d_theta rotates gravity in it by -d_theta.
+    H_pose->setZero();
+    (*H_pose)(0, 2) = mass * g.y();
+    (*H_pose)(1, 2) = -mass * g.x();
+  }
+  return Vector3(mass * g.x(), mass * g.y(), 0);
+}
+
+}  // namespace gtdynamics
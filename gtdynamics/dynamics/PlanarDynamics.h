@@ -0,0 +1,145 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamics.h
+ * @brief SE(2) kinematics and dynamics of links and joints of planar robots.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+
+namespace gtdynamics {
+
+/**
+ * Coordinates of a plane whose normal, the planar axis, is the x, y or z
+ * axis. The in-plane axes u and v are such that u x v is the planar axis.
+ *
+ * Planar quantities use the tangent space order of gtsam::Pose2: twists
+ * are (v_u, v_v, omega), wrenches (f_u, f_v, moment), so that the wrench
+ * transforms with the transpose of the Pose2 adjoint, as in 3D.
+ */
+class PlanarProjection {
+ private:
+  int axis_, u_, v_;
+
+ public:
+  /**
+   * Constructor
+   * @param planar_axis  normal of the plane, a unit coordinate axis
+   * @throws std::invalid_argument for other axes.
+   */
+  explicit PlanarProjection(const gtsam::Vector3 &planar_axis);
+
+  /// Return the index of the planar axis.
+  int axis() const { return axis_; }
+
+  /// Return the planar pose, assuming a rotation about the planar axis.
+  gtsam::Pose2 pose(const gtsam::Pose3 &pose) const;
+
+  /// Return the in-plane components of a 3D twist (omega, v).
+  gtsam::Vector3 twist(const gtsam::Vector6 &twist) const;
+
+  /// Return the in-plane components of a 3D wrench (moment, force).
+  gtsam::Vector3 wrench(const gtsam::Vector6 &wrench) const;
+
+  /// Return the in-plane components of a vector.
+  gtsam::Vector2 vector(const gtsam::Vector3 &vector) const;
+
+  /// Return the 3D pose of a planar pose, at a depth along the planar axis.
+  gtsam::Pose3 liftPose(const gtsam::Pose2 &pose, double depth = 0) const;
+
+  /// Return the 3D twist of a planar twist.
+  gtsam::Vector6 liftTwist(const gtsam::Vector3 &twist) const;
+
+  /// Return the 3D wrench of a planar wrench.
+  gtsam::Vector6 liftWrench(const gtsam::Vector3 &wrench) const;
+
+  /// Return the component of a 3D point along the planar axis.
+  double depth(const gtsam::Point3 &point) const { return point[axis_]; }
+
+  /// Whether the rotation of a pose is about the planar axis.
+  bool isPlanar(const gtsam::Pose3 &pose, double tol = 1e-9) const;
+
+  /// Whether a twist or screw axis (omega, v) moves within the plane.
+  bool isPlanar(const gtsam::Vector6 &twist, double tol = 1e-9) const;
+};
+
+/**
+ * Planar model of a joint: the pose of the child CoM in the parent CoM frame
+ * at rest, and the screw axis in the child CoM frame, so that the relative
+ * pose at angle q is pMc * Exp(screw_axis * q), as Joint::parentTchild.
+ */
+struct PlanarJoint {
+  int id, parent_id, child_id;
+  gtsam::Pose2 pMc;
+  gtsam::Vector3 screw_axis;
+
+  /**
+   * Constructor
+   * @param joint       the joint
+   * @param projection  the plane of motion
+   * @throws std::invalid_argument if the joint does not move in the plane.
+   */
+  PlanarJoint(const Joint &joint, const PlanarProjection &projection);
+
+  /// Return the pose of the child CoM in the parent CoM frame.
+  gtsam::Pose2 parentTchild(
+      double q, gtsam::OptionalJacobian<3, 1> H_q = boost::none) const;
+
+  /**
+   * Return the twist of the child, Ad(cTp) * V_p + S * q_dot, and its
+   * Jacobians.
+   */
+  gtsam::Vector3 childTwist(
+      const gtsam::Vector3 &twist_p, double q, double q_dot,
+      gtsam::OptionalJacobian<3, 3> H_twist_p = boost::none,
+      gtsam::OptionalJacobian<3, 1> H_q = boost::none,
+      gtsam::OptionalJacobian<3, 1> H_q_dot = boost::none) const;
+
+  /**
+   * Return the parent wrench equivalent to a child wrench, which cancels
+   * it: -Ad(cTp)^T * F_c.
+   */
+  gtsam::Vector3 parentWrench(
+      const gtsam::Vector3 &wrench_c, double q,
+      gtsam::OptionalJacobian<3, 3> H_wrench_c = boost::none,
+      gtsam::OptionalJacobian<3, 1> H_q = boost::none) const;
+};
+
+/// Planar inertia of a link: its mass and moment about the planar axis.
+struct PlanarLink {
+  int id;
+  double mass, inertia;
+
+  /// Constructor from a link and the plane of motion.
+  PlanarLink(const Link &link, const PlanarProjection &projection);
+
+  /// Return the inertia matrix diag(m, m, I) in twist order.
+  gtsam::Matrix3 inertiaMatrix() const;
+
+  /// Return the Coriolis wrench ad(V)^T * G * V and its Jacobian.
+  gtsam::Vector3 coriolis(
+      const gtsam::Vector3 &twist,
+      gtsam::OptionalJacobian<3, 3> H_twist = boost::none) const;
+
+  /**
+   * Return the gravity wrench in the CoM frame, given the in-plane gravity in
+   * the world frame, and its Jacobian.
+   */
+  gtsam::Vector3 gravityWrench(
+      const gtsam::Vector2 &gravity, const gtsam::Pose2 &wTcom,
+      gtsam::OptionalJacobian<3, 3> H_pose = boost::none) const;
+};
+
+}  // namespace gtdynamics
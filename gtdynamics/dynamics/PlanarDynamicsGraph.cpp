@@ -0,0 +1,276 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsGraph.cpp
+ * @brief Dynamics graph of planar robots with SE(2) poses and 3-vector
+ * twists and wrenches.
+ */
+
+#include <gtdynamics/dynamics/PlanarDynamicsGraph.h>
+#include <gtdynamics/factors/PlanarDynamicsFactors.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose2;
+using gtsam::Values;
+using gtsam::Vector3;
+
+/* ************************************************************************* */
+PlanarDynamicsGraph::PlanarDynamicsGraph(
+    const Robot &robot, const gtsam::Vector3 &planar_axis,
+    const boost::optional<gtsam::Vector3> &gravity, double sigma)
+    : robot_(robot),
+      projection_(planar_axis),
+      fixed_model_(InternedIsotropic(3, sigma / 100)),
+      kinematics_model_(InternedIsotropic(3, sigma)),
+      dynamics_model_(InternedIsotropic(3, sigma)),
+      torque_model_(InternedIsotropic(1, sigma)) {
+  if (gravity) gravity_ = projection_.vector(*gravity);
+  for (auto &&link : robot.links()) links_.emplace_back(*link, projection_);
+  for (auto &&joint : robot.joints()) {
+    joint_index_[joint->id()] = joints_.size();
+    joints_.emplace_back(*joint, projection_);
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::qFactors(int t) const {
+  NonlinearFactorGraph graph;
+  for (auto &&link : robot_.links()) {
+    if (robot_.isFixed(link)) {
+      graph.emplace_shared<gtsam::PriorFactor<Pose2>>(
+          PoseKey(link->id(), t), projection_.pose(robot_.fixedPose(link)),
+          fixed_model_);
+    }
+  }
+  for (auto &&joint : joints_) {
+    graph.emplace_shared<PlanarPoseFactor>(kinematics_model_, joint, t);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::vFactors(int t) const {
+  NonlinearFactorGraph graph;
+  for (auto &&link : robot_.links()) {
+    if (robot_.isFixed(link)) {
+      graph.emplace_shared<gtsam::PriorFactor<Vector3>>(
+          TwistKey(link->id(), t), Vector3::Zero(), fixed_model_);
+    }
+  }
+  for (auto &&joint : joints_) {
+    graph.emplace_shared<PlanarTwistFactor>(kinematics_model_, joint, t);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::aFactors(int t) const {
+  NonlinearFactorGraph graph;
+  for (auto &&link : robot_.links()) {
+    if (robot_.isFixed(link)) {
+      graph.emplace_shared<gtsam::PriorFactor<Vector3>>(
+          TwistAccelKey(link->id(), t), Vector3::Zero(), fixed_model_);
+    }
+  }
+  for (auto &&joint : joints_) {
+    graph.emplace_shared<PlanarTwistAccelFactor>(kinematics_model_, joint, t);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::dynamicsFactors(int t) const {
+  NonlinearFactorGraph graph;
+  const auto &links = robot_.links();
+  for (size_t l = 0; l < links.size(); l++) {
+    if (robot_.isFixed(links[l])) continue;
+    std::vector<Key> wrenches;
+    for (auto &&joint : links[l]->joints()) {
+      wrenches.push_back(WrenchKey(links[l]->id(), joint->id(), t));
+    }
+    graph.emplace_shared<PlanarWrenchFactor>(dynamics_model_, links_[l],
+                                             wrenches, t, gravity_);
+  }
+  for (auto &&joint : joints_) {
+    graph.emplace_shared<PlanarWrenchEquivalenceFactor>(dynamics_model_,
+                                                        joint, t);
+    graph.emplace_shared<PlanarTorqueFactor>(torque_model_, joint, t);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::dynamicsFactorGraph(int t) const {
+  NonlinearFactorGraph graph;
+  graph.add(qFactors(t));
+  graph.add(vFactors(t));
+  graph.add(aFactors(t));
+  graph.add(dynamicsFactors(t));
+  return graph;
+}
+
+/* ************************************************************************* */
+Values PlanarDynamicsGraph::forwardKinematics(
+    const Values &known_values, int t,
+    const boost::optional<std::string> &prior_link_name) const {
+  Values values = known_values;
+
+  // The root is the prior link, or the last fixed link as in 3D.
+  LinkSharedPtr root;
+  if (prior_link_name) root = robot_.link(*prior_link_name);
+  for (auto &&link : robot_.links()) {
+    if (!robot_.isFixed(link)) continue;
+    if (!prior_link_name) root = link;
+    if (!values.exists(PoseKey(link->id(), t))) {
+      values.insert(PoseKey(link->id(), t),
+                    projection_.pose(robot_.fixedPose(link)));
+    }
+    if (!values.exists(TwistKey(link->id(), t))) {
+      values.insert(TwistKey(link->id(), t), Vector3::Zero().eval());
+    }
+  }
+  if (!root) {
+    throw std::runtime_error(
+        "forwardKinematics: no prior link given and cannot find a fixed "
+        "link.");
+  }
+  if (!values.exists(PoseKey(root->id(), t))) {
+    values.insert(PoseKey(root->id(), t), Pose2());
+  }
+  if (!values.exists(TwistKey(root->id(), t))) {
+    values.insert(TwistKey(root->id(), t), Vector3::Zero().eval());
+  }
+
+  // Breadth-first from the root, links keep poses and twists they have.
+  std::queue<LinkSharedPtr> queue;
+  queue.push(root);
+  while (!queue.empty()) {
+    const LinkSharedPtr link1 = queue.front();
+    queue.pop();
+    const Pose2 wT1 = values.at<Pose2>(PoseKey(link1->id(), t));
+    const Vector3 V1 = values.at<Vector3>(TwistKey(link1->id(), t));
+    for (auto &&j : link1->joints()) {
+      const PlanarJoint &joint = joints_[joint_index_.at(j->id())];
+      for (Key key : {Key(JointAngleKey(joint.id, t)),
+                      Key(JointVelKey(joint.id, t))}) {
+        if (!values.exists(key)) values.insertDouble(key, 0.0);
+      }
+      const double q = values.atDouble(JointAngleKey(joint.id, t));
+      const double q_dot = values.atDouble(JointVelKey(joint.id, t));
+      const LinkSharedPtr link2 = j->otherLink(link1);
+      if (values.exists(PoseKey(link2->id(), t))) continue;
+
+      const Pose2 pTc = joint.parentTchild(q);
+      if (link1->id() == joint.parent_id) {
+        values.insert(PoseKey(link2->id(), t), wT1 * pTc);
+        values.insert(TwistKey(link2->id(), t),
+                      joint.childTwist(V1, q, q_dot));
+      } else {
+        // V_c = Ad(cTp) * V_p + S * q_dot, solved for V_p.
+        values.insert(PoseKey(link2->id(), t), wT1 * pTc.inverse());
+        const Vector3 V2 =
+            pTc.AdjointMap() * (V1 - joint.screw_axis * q_dot);
+        values.insert(TwistKey(link2->id(), t), V2);
+      }
+      queue.push(link2);
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values PlanarDynamicsGraph::forwardDynamics(int t,
+                                            const Values &known_values) const {
+  NonlinearFactorGraph graph = aFactors(t);
+  graph.add(dynamicsFactors(t));
+
+  // Accelerations and wrenches are unknown.
+  Values unknowns;
+  for (auto &&link : robot_.links()) {
+    unknowns.insert(TwistAccelKey(link->id(), t), Vector3::Zero().eval());
+  }
+  for (auto &&joint : joints_) {
+    unknowns.insertDouble(JointAccelKey(joint.id, t), 0.0);
+    unknowns.insert(WrenchKey(joint.parent_id, joint.id, t),
+                    Vector3::Zero().eval());
+    unknowns.insert(WrenchKey(joint.child_id, joint.id, t),
+                    Vector3::Zero().eval());
+  }
+  Values values = unknowns;
+  for (auto &&factor : graph) {
+    for (Key key : factor->keys()) {
+      if (!values.exists(key)) values.insert(key, known_values.at(key));
+    }
+  }
+
+  // Linear in the unknowns, so linearizing at zero is exact. The known keys
+  // do not move, so their columns are dropped.
+  gtsam::GaussianFactorGraph linear;
+  for (auto &&factor : graph) {
+    const auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+        factor->linearize(values));
+    std::vector<std::pair<Key, gtsam::Matrix>> terms;
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      if (unknowns.exists(*it)) terms.emplace_back(*it, jacobian->getA(it));
+    }
+    linear.emplace_shared<gtsam::JacobianFactor>(terms, jacobian->getb(),
+                                                 jacobian->get_model());
+  }
+  const gtsam::VectorValues delta = linear.optimize();
+
+  Values result = known_values;
+  try {
+    result.insert(unknowns.retract(delta));
+  } catch (const gtsam::ValuesKeyAlreadyExists &) {
+    throw std::invalid_argument(
+        "forwardDynamics: known_values should contain no accelerations or "
+        "wrenches.");
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values PlanarDynamicsGraph::lift(const Values &planar_values) const {
+  Values values;
+  for (auto &&key_value : planar_values) {
+    const DynamicsSymbol symbol(key_value.key);
+    const std::string label = symbol.label();
+    if (symbol.linkIdx() == DynamicsSymbol::kNoIndex) {
+      values.insert(key_value.key, key_value.value);
+    } else if (label == "p") {
+      const double depth = projection_.depth(
+          robot_.link(symbol.linkIdx())->bMcom().translation());
+      values.insert(key_value.key,
+                    projection_.liftPose(key_value.value.cast<Pose2>(), depth));
+    } else if (label == "V" || label == "A") {
+      values.insert(key_value.key,
+                    projection_.liftTwist(key_value.value.cast<Vector3>()));
+    } else if (label == "F") {
+      values.insert(key_value.key,
+                    projection_.liftWrench(key_value.value.cast<Vector3>()));
+    } else {
+      values.insert(key_value.key, key_value.value);
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
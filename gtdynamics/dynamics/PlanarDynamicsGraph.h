@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsGraph.h
+ * @brief Dynamics graph of planar robots with SE(2) poses and 3-vector
+ * twists and wrenches.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/PlanarDynamics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * PlanarDynamicsGraph builds the same kinodynamic factors as DynamicsGraph
+ * with a planar axis, for robots whose links all move in a plane, e.g. the
+ * cart-pole, pendulums or the jumping robot. Instead of 6-DoF variables and
+ * WrenchPlanarFactors zeroing their off-plane components, link poses are
+ * gtsam::Pose2 and twists, twist accelerations and wrenches are 3-vectors,
+ * in the plane coordinates of PlanarProjection. The keys are the same as in
+ * DynamicsGraph, so joint angles, velocities, accelerations and torques are
+ * interchangeable, and `lift` converts planar values to 3D ones.
+ *
+ * The out-of-plane wrench components, which only hold the links in the
+ * plane, are not modeled. Contacts are not supported.
+ */
+class PlanarDynamicsGraph {
+ private:
+  Robot robot_;
+  PlanarProjection projection_;
+  boost::optional<gtsam::Vector2> gravity_;
+  std::vector<PlanarLink> links_;
+  std::vector<PlanarJoint> joints_;
+  std::map<int, size_t> joint_index_;  // by joint id
+  gtsam::SharedNoiseModel fixed_model_, kinematics_model_, dynamics_model_,
+      torque_model_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot, all joints moving in the plane
+   * @param planar_axis  normal of the plane, the x, y or z axis
+   * @param gravity      gravity in the world frame, its in-plane part is used
+   * @param sigma        sigma of the kinematics and dynamics factors, the
+   *                     fixed links use sigma / 100 as OptimizerSetting
+   * @throws std::invalid_argument if a joint does not move in the plane.
+   */
+  PlanarDynamicsGraph(
+      const Robot &robot, const gtsam::Vector3 &planar_axis,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      double sigma = 0.001);
+
+  /// Return the plane of motion.
+  const PlanarProjection &projection() const { return projection_; }
+
+  /// Return the planar links, ordered as robot.links().
+  const std::vector<PlanarLink> &links() const { return links_; }
+
+  /// Return the planar joints, ordered as robot.joints().
+  const std::vector<PlanarJoint> &joints() const { return joints_; }
+
+  /// Return pose factors of all joints and priors on fixed links at time t.
+  gtsam::NonlinearFactorGraph qFactors(int t) const;
+
+  /// Return twist factors of all joints and priors on fixed links at time t.
+  gtsam::NonlinearFactorGraph vFactors(int t) const;
+
+  /// Return twist acceleration factors and priors on fixed links at time t.
+  gtsam::NonlinearFactorGraph aFactors(int t) const;
+
+  /// Return wrench, wrench equivalence and torque factors at time t.
+  gtsam::NonlinearFactorGraph dynamicsFactors(int t) const;
+
+  /// Return all kinodynamics factors at time t.
+  gtsam::NonlinearFactorGraph dynamicsFactorGraph(int t) const;
+
+  /**
+   * Compute Pose2 poses and 3-vector twists of all links from the joint
+   * angles and velocities, as Robot::forwardKinematics: from the fixed link,
+   * or from the prior link at the identity with zero twist unless given.
+   * Missing joint angles and velocities are taken as zero.
+   */
+  gtsam::Values forwardKinematics(
+      const gtsam::Values &known_values, int t,
+      const boost::optional<std::string> &prior_link_name = boost::none) const;
+
+  /**
+   * Solve forward dynamics at time t. The factors are linear in the
+   * accelerations and wrenches once the poses, twists, joint angles,
+   * velocities and torques are known, so a single linear solve is exact.
+   * @param known_values  output of forwardKinematics, with torques
+   * @return known values with joint and twist accelerations and wrenches
+   */
+  gtsam::Values forwardDynamics(int t,
+                                const gtsam::Values &known_values) const;
+
+  /**
+   * Convert planar values to 3D values usable with DynamicsGraph: poses,
+   * twists, twist accelerations and wrenches are lifted, links at the depth
+   * of their rest pose, and all other values are copied.
+   */
+  gtsam::Values lift(const gtsam::Values &planar_values) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Pseudospectral.cpp
+ * @brief Legendre-Gauss-Radau nodes and differentiation matrix.
+ */
+
+#include <gtdynamics/dynamics/Pseudospectral.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RadauCollocation LegendreGaussRadau(size_t num_points) {
+  if (num_points == 0) {
+    throw std::invalid_argument(
+        "LegendreGaussRadau: need at least one collocation point.");
+  }
+  const size_t N = num_points;
+
+  // Newton iteration for the roots of P_{N-1} + P_N, starting from the
+  // Chebyshev-Gauss-Radau points. P(i, k) is P_k at node i.
+  gtsam::Vector x(N);
+  for (size_t i = 0; i < N; i++) x(i) = -std::cos(2 * M_PI * i / (2 * N - 1));
+  gtsam::Matrix P(N, N + 1);
+  for (size_t iteration = 0; iteration < 100; iteration++) {
+    const gtsam::Vector previous = x;
+    for (size_t i = 1; i < N; i++) {
+      P(i, 0) = 1;
+      P(i, 1) = x(i);
+      for (size_t k = 1; k < N; k++) {
+        P(i, k + 1) =
+            ((2 * k + 1) * x(i) * P(i, k) - k * P(i, k - 1)) / (k + 1);
+      }
+      x(i) = previous(i) - ((1 - previous(i)) / N) *
+                               (P(i, N - 1) + P(i, N)) /
+                               (P(i, N - 1) - P(i, N));
+    }
+    if ((x - previous).lpNorm<Eigen::Infinity>() < 1e-15) break;
+  }
+
+  RadauCollocation radau;
+  radau.nodes.resize(N + 1);
+  radau.nodes << x, 1.0;
+
+  // Differentiation matrix from the barycentric weights of all N + 1 nodes.
+  const gtsam::Vector& tau = radau.nodes;
+  gtsam::Vector w = gtsam::Vector::Ones(N + 1);
+  for (size_t j = 0; j <= N; j++) {
+    for (size_t k = 0; k <= N; k++) {
+      if (k != j) w(j) /= tau(j) - tau(k);
+    }
+  }
+  radau.D = gtsam::Matrix::Zero(N, N + 1);
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j <= N; j++) {
+      if (j == i) continue;
+      radau.D(i, j) = w(j) / w(i) / (tau(i) - tau(j));
+      radau.D(i, i) -= radau.D(i, j);
+    }
+  }
+  return radau;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Pseudospectral.h
+ * @brief Legendre-Gauss-Radau nodes and differentiation matrix.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <cstddef>
+
+namespace gtdynamics {
+
+/**
+ * Legendre-Gauss-Radau (LGR) collocation on a segment of N intervals.
+ *
+ * The N collocation points are the roots of P_{N-1} + P_N on [-1, 1), the
+ * first one being -1. The state is interpolated by a polynomial of degree N
+ * through the collocation points and the non-collocated end point +1, and
+ * its derivative at the collocation points is D * x, so the LGR defects of
+ * x' = f on a segment of duration h are D * x - h / 2 * f.
+ */
+struct RadauCollocation {
+  gtsam::Vector nodes;  ///< N + 1 points in [-1, 1], the last one is +1
+  gtsam::Matrix D;      ///< N x (N + 1) differentiation matrix
+
+  /// Return the time of a node, for a segment [t0, t0 + duration].
+  double time(size_t i, double t0, double duration) const {
+    return t0 + 0.5 * (nodes(i) + 1.0) * duration;
+  }
+};
+
+/**
+ * Return the LGR nodes and differentiation matrix with N collocation points.
+ * @param num_points  number of collocation points N, at least 1
+ */
+RadauCollocation LegendreGaussRadau(size_t num_points);
+
+}  // namespace gtdynamics
@@ -0,0 +1,159 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecedingHorizonPlanner.cpp
+ * @brief Sliding-window trajectory optimization with incremental updates.
+ */
+
+#include <gtdynamics/dynamics/RecedingHorizonPlanner.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+namespace {
+// Add the frontal keys of the cliques below `clique` whose separators contain
+// `key`, i.e., the cliques that eliminating `key` first would change.
+void MarkCliquesBelow(Key key, const gtsam::ISAM2::sharedClique &clique,
+                      gtsam::FastList<Key> *keys) {
+  const auto &conditional = clique->conditional();
+  if (std::find(conditional->beginParents(), conditional->endParents(), key) ==
+      conditional->endParents()) {
+    return;
+  }
+  for (Key frontal : conditional->frontals()) keys->push_back(frontal);
+  for (auto &&child : clique->children) MarkCliquesBelow(key, child, keys);
+}
+}  // namespace
+
+/* ************************************************************************* */
+RecedingHorizonPlanner::RecedingHorizonPlanner(
+    const Robot &robot, const DynamicsGraph &graph_builder, int horizon,
+    double dt, const CollocationScheme collocation,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu, const SliceFactors &objectives,
+    const gtsam::ISAM2Params &params)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      horizon_(horizon),
+      dt_(dt),
+      collocation_(collocation),
+      contact_points_(contact_points),
+      mu_(mu),
+      objectives_(objectives),
+      isam_(params) {
+  if (horizon < 1) {
+    throw std::invalid_argument(
+        "RecedingHorizonPlanner: horizon should be at least 1.");
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph RecedingHorizonPlanner::sliceFactors(int k) const {
+  NonlinearFactorGraph graph =
+      graph_builder_.dynamicsFactorGraph(robot_, k, contact_points_, mu_);
+  if (objectives_) graph.add(objectives_(k));
+  return graph;
+}
+
+/* ************************************************************************* */
+KeyVector RecedingHorizonPlanner::sliceKeys(int k) const {
+  KeyVector keys;
+  for (Key key : isam_.getLinearizationPoint().keys()) {
+    if (DynamicsSymbol(key).time() == uint64_t(k)) keys.push_back(key);
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+Values RecedingHorizonPlanner::shiftedSlice(const Values &values,
+                                            int k) const {
+  Values shifted;
+  for (const auto &key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    if (symbol.time() != uint64_t(k)) continue;
+    shifted.insert(DynamicsSymbol::LinkJointSymbol(symbol.label(),
+                                                   symbol.linkIdx(),
+                                                   symbol.jointIdx(), k + 1),
+                   key_value.value);
+  }
+  return shifted;
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::initialize(const NonlinearFactorGraph &priors,
+                                        const Values &initial_values) {
+  NonlinearFactorGraph graph = priors;
+  Values values = initial_values;
+  Values slice_values = initial_values;
+  for (int k = 0; k <= horizon_; k++) {
+    graph.add(sliceFactors(k));
+    if (k < horizon_) {
+      graph.add(graph_builder_.collocationFactors(robot_, k, dt_,
+                                                  collocation_));
+      slice_values = shiftedSlice(slice_values, k);
+      values.insert(slice_values);
+    }
+  }
+  isam_.update(graph, values);
+  first_step_ = 0;
+  last_step_ = horizon_;
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::advance(const NonlinearFactorGraph &new_factors) {
+  if (last_step_ < 0) {
+    throw std::runtime_error(
+        "RecedingHorizonPlanner: call initialize before advance.");
+  }
+
+  // Factors of the new slice, warm-started from the current last slice.
+  NonlinearFactorGraph graph = new_factors;
+  graph.add(graph_builder_.collocationFactors(robot_, last_step_, dt_,
+                                              collocation_));
+  graph.add(sliceFactors(last_step_ + 1));
+  const Values new_values = shiftedSlice(estimate(), last_step_);
+
+  // ISAM2 only reorders the variables it re-eliminates, so constraining the
+  // oldest slice to be eliminated first is not enough to make it a set of
+  // leaves. As IncrementalFixedLagSmoother does, re-eliminate the oldest slice
+  // and every clique below it, so the slice ends up in the leaves.
+  const KeyVector old_keys = sliceKeys(first_step_);
+  gtsam::FastList<Key> reelim_keys(old_keys.begin(), old_keys.end());
+  for (Key key : old_keys) {
+    for (auto &&child : isam_[key]->children) {
+      MarkCliquesBelow(key, child, &reelim_keys);
+    }
+  }
+
+  gtsam::FastMap<Key, int> constrained_keys;
+  for (Key key : isam_.getLinearizationPoint().keys()) {
+    constrained_keys[key] = 1;
+  }
+  for (const auto &key_value : new_values) {
+    constrained_keys[key_value.key] = 1;
+  }
+  for (Key key : old_keys) constrained_keys[key] = 0;
+
+  gtsam::ISAM2UpdateParams update_params;
+  update_params.constrainedKeys = constrained_keys;
+  update_params.extraReelimKeys = reelim_keys;
+  isam_.update(graph, new_values, update_params);
+  isam_.marginalizeLeaves(old_keys);
+  first_step_++;
+  last_step_++;
+}
+
+}  // namespace gtdynamics
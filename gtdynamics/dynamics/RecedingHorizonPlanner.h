@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecedingHorizonPlanner.h
+ * @brief Sliding-window trajectory optimization with incremental updates.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+
+namespace gtdynamics {
+
+/**
+ * RecedingHorizonPlanner keeps the factors of `trajectoryFG` for a sliding
+ * window of time slices in an ISAM2 instance. Advancing the window appends the
+ * dynamics and collocation factors of a new slice, marginalizes out the oldest
+ * slice, and performs one incremental update, so the work per cycle does not
+ * depend on how long the planner has been running.
+ *
+ * New slices are warm-started with the estimate of the previous last slice.
+ */
+class RecedingHorizonPlanner {
+ public:
+  /// Returns additional factors (e.g., objectives) for time step k.
+  using SliceFactors = std::function<gtsam::NonlinearFactorGraph(int k)>;
+
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  int horizon_;
+  double dt_;
+  CollocationScheme collocation_;
+  boost::optional<PointOnLinks> contact_points_;
+  boost::optional<double> mu_;
+  SliceFactors objectives_;
+  gtsam::ISAM2 isam_;
+  int first_step_ = 0, last_step_ = -1;
+
+  /// Return dynamics and objective factors for time step k.
+  gtsam::NonlinearFactorGraph sliceFactors(int k) const;
+
+  /// Return the keys in the current estimate at time step k.
+  gtsam::KeyVector sliceKeys(int k) const;
+
+  /// Copy the values at time step k to time step k + 1.
+  gtsam::Values shiftedSlice(const gtsam::Values &values, int k) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot          the robot
+   * @param graph_builder  builds the dynamics and collocation factors
+   * @param horizon        number of collocation intervals in the window
+   * @param dt             duration of each time step
+   * @param collocation    collocation scheme
+   * @param contact_points contact points, same for all time steps
+   * @param mu             friction coefficient
+   * @param objectives     extra factors for each time step
+   * @param params         ISAM2 parameters
+   */
+  RecedingHorizonPlanner(
+      const Robot &robot, const DynamicsGraph &graph_builder, int horizon,
+      double dt, const CollocationScheme collocation = Trapezoidal,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none,
+      const SliceFactors &objectives = nullptr,
+      const gtsam::ISAM2Params &params = gtsam::ISAM2Params());
+
+  /**
+   * Add the factors of the initial window, time steps 0 to horizon.
+   * @param priors         priors, e.g., on the current state
+   * @param initial_values initial values for time step 0, copied to all
+   * other time steps
+   */
+  void initialize(const gtsam::NonlinearFactorGraph &priors,
+                  const gtsam::Values &initial_values);
+
+  /**
+   * Move the window one time step forward.
+   * @param new_factors  new priors or measurements, e.g., on the new state
+   */
+  void advance(
+      const gtsam::NonlinearFactorGraph &new_factors =
+          gtsam::NonlinearFactorGraph());
+
+  /// Return the current estimate of all variables in the window.
+  gtsam::Values estimate() const { return isam_.calculateEstimate(); }
+
+  /// Return the first time step in the window.
+  int firstStep() const { return first_step_; }
+
+  /// Return the last time step in the window.
+  int lastStep() const { return last_step_; }
+};
+
+}  // namespace gtdynamics
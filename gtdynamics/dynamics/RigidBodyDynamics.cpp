@@ -0,0 +1,212 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RigidBodyDynamics.cpp
+ * @brief Joint-space mass matrix, bias forces and Jacobians of tree robots.
+ */
+
+#include <gtdynamics/dynamics/RigidBodyDynamics.h>
+
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RigidBodyDynamics::RigidBodyDynamics(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis)
+    : ArticulatedBodySolver(robot, gravity, planar_axis),
+      parent_joint_(links_.size()) {
+  for (size_t t = 0; t < tree_.size(); t++) {
+    parent_joint_[tree_[t].child_index] = t;
+  }
+}
+
+/* ************************************************************************* */
+size_t RigidBodyDynamics::linkIndex(const std::string &name) const {
+  for (size_t i = 0; i < links_.size(); i++) {
+    if (links_[i]->name() == name) return i;
+  }
+  throw std::invalid_argument("RigidBodyDynamics: no link named " + name);
+}
+
+/* ************************************************************************* */
+void RigidBodyDynamics::checkInitialized() const {
+  if (!initialized_) {
+    throw std::runtime_error(
+        "RigidBodyDynamics: update must be called before querying terms.");
+  }
+}
+
+/* ************************************************************************* */
+void RigidBodyDynamics::update(const Vector &q, const Vector &v,
+                               const Pose3 &wTroot, const Vector6 &V_root) {
+  const bool same_q = initialized_ && q.size() == q_.size() && q == q_;
+  const bool same_state = same_q && v.size() == v_.size() && v == v_ &&
+                          wTroot.equals(wTroot_, 0) && V_root == V_root_;
+  if (same_state) return;
+
+  forwardKinematicsPass(q, v, wTroot, V_root, &kinematics_, &workspace_);
+  q_ = q;
+  v_ = v;
+  wTroot_ = wTroot;
+  V_root_ = V_root;
+  initialized_ = true;
+  bias_valid_ = false;
+  if (!same_q) {
+    mass_valid_ = false;
+    jacobians_valid_ = false;
+  }
+}
+
+/* ************************************************************************* */
+const TreeDynamicsResult &RigidBodyDynamics::kinematics() const {
+  checkInitialized();
+  return kinematics_;
+}
+
+/* ************************************************************************* */
+const Matrix &RigidBodyDynamics::massMatrix() {
+  checkInitialized();
+  if (mass_valid_) return M_;
+  const std::vector<Pose3> &cTp = workspace_.iTparent;
+
+  // Composite inertia of the subtree rooted at each link.
+  const size_t n = links_.size();
+  composite_inertias_.resize(n);
+  std::vector<Matrix6> &IC = composite_inertias_;
+  for (size_t i = 0; i < n; i++) IC[i] = links_[i]->inertiaMatrix();
+  for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+    const Matrix6 Ad = cTp[it->child_index].AdjointMap();
+    IC[it->parent_index] += Ad.transpose() * IC[it->child_index] * Ad;
+  }
+
+  // Column of each joint: the wrench IC * S, transported towards the root and
+  // projected on the screw axes of all ancestor joints.
+  M_.setZero(numDofs(), numDofs());
+  if (rootDofs() > 0) M_.topLeftCorner<6, 6>() = IC[root_index_];
+  for (size_t t = 0; t < tree_.size(); t++) {
+    const size_t d = dof(t);
+    size_t link = tree_[t].child_index;
+    Vector6 F = IC[link] * tree_[t].S;
+    M_(d, d) = tree_[t].S.dot(F);
+    while (parent_joint_[link]) {
+      F = cTp[link].AdjointMap().transpose() * F;
+      link = tree_[*parent_joint_[link]].parent_index;
+      if (parent_joint_[link]) {
+        const size_t k = *parent_joint_[link];
+        M_(d, dof(k)) = M_(dof(k), d) = tree_[k].S.dot(F);
+      }
+    }
+    if (rootDofs() > 0) {
+      M_.block<6, 1>(0, d) = F;
+      M_.block<1, 6>(d, 0) = F.transpose();
+    }
+  }
+  mass_valid_ = true;
+  return M_;
+}
+
+/* ************************************************************************* */
+const Vector &RigidBodyDynamics::biasForces() {
+  checkInitialized();
+  if (bias_valid_) return C_;
+  const std::vector<Pose3> &cTp = workspace_.iTparent;
+  const std::vector<Vector6> &c_bias = workspace_.bias_accels;
+
+  // Twist accelerations at zero generalized acceleration.
+  const size_t n = links_.size();
+  bias_accels_.resize(n);
+  std::vector<Vector6> &A = bias_accels_;
+  A[root_index_].setZero();
+  for (const TreeJoint &tj : tree_) {
+    const size_t c = tj.child_index;
+    A[c] = cTp[c].Adjoint(A[tj.parent_index]) + c_bias[c];
+  }
+
+  // Backward pass: wrench exerted by the joint on each tree child.
+  bias_wrenches_.resize(n);
+  std::vector<Vector6> &F = bias_wrenches_;
+  for (size_t i = 0; i < n; i++) {
+    const Matrix6 G_i = links_[i]->inertiaMatrix();
+    const Vector6 &V_i = kinematics_.twists[i];
+    F[i] = G_i * A[i] - Pose3::adjointMap(V_i).transpose() * G_i * V_i -
+           gravityWrench(i, kinematics_.poses[i]);
+  }
+  for (auto it = tree_.rbegin(); it != tree_.rend(); ++it) {
+    const size_t c = it->child_index;
+    F[it->parent_index] += cTp[c].AdjointMap().transpose() * F[c];
+  }
+
+  C_.resize(numDofs());
+  if (rootDofs() > 0) C_.head<6>() = F[root_index_];
+  for (size_t t = 0; t < tree_.size(); t++) {
+    C_(dof(t)) = tree_[t].S.dot(F[tree_[t].child_index]);
+  }
+  bias_valid_ = true;
+  return C_;
+}
+
+/* ************************************************************************* */
+const Matrix &RigidBodyDynamics::linkJacobian(size_t i) {
+  checkInitialized();
+  if (i >= links_.size()) {
+    throw std::out_of_range("RigidBodyDynamics: link index out of range.");
+  }
+  if (jacobians_valid_) return jacobians_[i];
+  const std::vector<Pose3> &cTp = workspace_.iTparent;
+
+  // J_c = Ad(cTp) * J_p + S_c * e_j, from the root outwards.
+  jacobians_.resize(links_.size());
+  Matrix &J_root = jacobians_[root_index_];
+  J_root.setZero(6, numDofs());
+  if (rootDofs() > 0) J_root.leftCols<6>().setIdentity();
+  for (size_t t = 0; t < tree_.size(); t++) {
+    const size_t c = tree_[t].child_index;
+    jacobians_[c].noalias() =
+        cTp[c].AdjointMap() * jacobians_[tree_[t].parent_index];
+    jacobians_[c].col(dof(t)) += tree_[t].S;
+  }
+  jacobians_valid_ = true;
+  return jacobians_[i];
+}
+
+/* ************************************************************************* */
+Matrix RigidBodyDynamics::pointJacobian(size_t i, const gtsam::Point3 &point) {
+  const Matrix &J = linkJacobian(i);
+
+  // Velocity of the point in the link frame is v + w x p.
+  gtsam::Matrix36 H;
+  H << -gtsam::skewSymmetric(point), gtsam::I_3x3;
+  return kinematics_.poses[i].rotation().matrix() * H * J;
+}
+
+/* ************************************************************************* */
+gtsam::Vector3 RigidBodyDynamics::pointBiasAcceleration(
+    size_t i, const gtsam::Point3 &point) {
+  checkInitialized();
+  if (i >= links_.size()) {
+    throw std::out_of_range("RigidBodyDynamics: link index out of range.");
+  }
+  biasForces();
+
+  // Classical acceleration of the point: a + alpha x p + w x (v + w x p).
+  const Vector6 &V = kinematics_.twists[i], &A = bias_accels_[i];
+  const gtsam::Vector3 w = V.head<3>(), v = V.tail<3>();
+  const gtsam::Vector3 a = A.tail<3>() + A.head<3>().cross(point) +
+                           w.cross(v + w.cross(point));
+  return kinematics_.poses[i].rotation().matrix() * a;
+}
+
+}  // namespace gtdynamics
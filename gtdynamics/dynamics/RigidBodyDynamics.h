@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RigidBodyDynamics.h
+ * @brief Joint-space mass matrix, bias forces and Jacobians of tree robots.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * RigidBodyDynamics computes the terms of the equations of motion
+ *
+ *   M(q) * a + C(q, v) = tau
+ *
+ * of a tree robot: the mass matrix with the Composite-Rigid-Body Algorithm,
+ * the bias forces (velocity products and gravity) with the Recursive
+ * Newton-Euler Algorithm at zero acceleration, and the body Jacobians of all
+ * links, such that the twist of link i is J_i * [V_root; v].
+ *
+ * Generalized coordinates are the joints in the order of robot.joints(). For a
+ * floating base they are preceded by the six coordinates of the root twist, in
+ * the root CoM frame, and the corresponding generalized force is the wrench
+ * required on the root, zero for a free-floating robot.
+ *
+ * The object caches the state passed to `update`. Kinematics are shared by all
+ * terms, and the mass matrix and Jacobians are only recomputed when the joint
+ * angles change, so calling update once per control tick and then querying
+ * all terms costs a single pass of each recursion.
+ */
+class RigidBodyDynamics : public ArticulatedBodySolver {
+ private:
+  // Tree joint (position in tree_) whose child is each link, none at the root.
+  std::vector<boost::optional<size_t>> parent_joint_;
+
+  // Cached state and results.
+  bool initialized_ = false, mass_valid_ = false, bias_valid_ = false,
+       jacobians_valid_ = false;
+  gtsam::Vector q_, v_;
+  gtsam::Pose3 wTroot_;
+  gtsam::Vector6 V_root_;
+  TreeDynamicsResult kinematics_;
+  TreeDynamicsWorkspace workspace_;
+  std::vector<gtsam::Matrix6> composite_inertias_;
+  std::vector<gtsam::Vector6> bias_accels_, bias_wrenches_;
+  std::vector<gtsam::Matrix> jacobians_;
+  gtsam::Matrix M_;
+  gtsam::Vector C_;
+
+  /// Throw if update has not been called yet.
+  void checkInitialized() const;
+
+  /// Return the generalized coordinate of the tree joint at position t.
+  size_t dof(size_t t) const {
+    return rootDofs() + tree_[t].joint_index;
+  }
+
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot, must be a tree
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   */
+  RigidBodyDynamics(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none);
+
+  /// Return the number of root coordinates, 6 for a floating base, else 0.
+  size_t rootDofs() const { return rootIsFixed() ? 0 : 6; }
+
+  /// Return the number of generalized coordinates.
+  size_t numDofs() const { return rootDofs() + numJoints(); }
+
+  /// Return the position of a link in links(), the index of linkJacobian.
+  size_t linkIndex(const std::string &name) const;
+
+  /**
+   * Set the state at which all terms are evaluated. Nothing is recomputed if
+   * the state did not change, and the mass matrix and Jacobians are kept if
+   * only the velocities or the root pose changed.
+   * @param q       joint angles, ordered as robot.joints()
+   * @param v       joint velocities, ordered as robot.joints()
+   * @param wTroot  pose of the root link CoM (ignored if the root is fixed)
+   * @param V_root  twist of the root link (ignored if the root is fixed)
+   */
+  void update(const gtsam::Vector &q, const gtsam::Vector &v,
+              const gtsam::Pose3 &wTroot = gtsam::Pose3(),
+              const gtsam::Vector6 &V_root = gtsam::Vector6::Zero());
+
+  /// Return link poses and twists at the current state.
+  const TreeDynamicsResult &kinematics() const;
+
+  /// Return the numDofs() x numDofs() mass matrix, with CRBA.
+  const gtsam::Matrix &massMatrix();
+
+  /// Return the bias forces C(q, v), including gravity, with RNEA.
+  const gtsam::Vector &biasForces();
+
+  /**
+   * Return the 6 x numDofs() body Jacobian of a link, mapping generalized
+   * velocities to the twist of the link in its CoM frame.
+   * @param i  position of the link in links()
+   */
+  const gtsam::Matrix &linkJacobian(size_t i);
+
+  /**
+   * Return the 3 x numDofs() Jacobian of the velocity of a point on a link,
+   * expressed in the world frame.
+   * @param i      position of the link in links()
+   * @param point  point in the link CoM frame
+   */
+  gtsam::Matrix pointJacobian(size_t i, const gtsam::Point3 &point);
+
+  /**
+   * Return the acceleration of a point on a link at zero generalized
+   * acceleration, J_dot * [V_root; v] for the point Jacobian J, in the world
+   * frame. Computed with the bias forces.
+   * @param i      position of the link in links()
+   * @param point  point in the link CoM frame
+   */
+  gtsam::Vector3 pointBiasAcceleration(size_t i, const gtsam::Point3 &point);
+};
+
+}  // namespace gtdynamics
@@ -13,16 +13,104 @@
 
 #pragma once
 
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/Integrator.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/TrajectoryState.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
 #include <boost/optional.hpp>
+#include <cmath>
+#include <functional>
 #include <string>
 #include <vector>
 
 namespace gtdynamics {
+
+/**
+ * Forward dynamics methods available in the Simulator.
+ *
+ * LinearFactorGraph: build and eliminate DynamicsGraph::linearDynamicsGraph.
+ * ArticulatedBody: recursive O(n) ArticulatedBodySolver, trees only.
+ */
+enum ForwardDynamicsMethod { LinearFactorGraph, ArticulatedBody };
+
+class Simulator;
+
+/**
+ * An event of a hybrid simulation, e.g. a touchdown or a liftoff: the time
+ * at which `function` of the simulated values crosses zero. The values are
+ * those of forward dynamics, with joint angles, velocities, accelerations,
+ * link poses and wrenches at time step 0.
+ *
+ * direction: +1 fires when the function rises through zero, -1 when it
+ * falls through zero, and 0 on both.
+ * action: optional, called when the event fires, e.g. to switch the robot
+ * and the events to those of the next phase.
+ */
+struct SimulatorEvent {
+  std::string name;
+  std::function<double(const gtsam::Values &)> function;
+  int direction = 0;
+  std::function<void(Simulator &)> action;
+};
+
+/// An event that fired during a simulation, at `time` seconds.
+struct SimulatorEventRecord {
+  double time;
+  std::string name;
+};
+
+/**
+ * Touchdown of a point on a link: its height above the ground falls through
+ * zero.
+ * @param point          the point on its link
+ * @param ground_height  height of the ground plane, z up
+ * @param action         called at touchdown
+ */
+inline SimulatorEvent ContactHeightEvent(
+    const PointOnLink &point, double ground_height = 0.0,
+    const std::function<void(Simulator &)> &action = nullptr) {
+  SimulatorEvent event;
+  event.name = "touchdown " + point.link->name();
+  event.function = [point, ground_height](const gtsam::Values &values) {
+    return point.predict(values).z() - ground_height;
+  };
+  event.direction = -1;
+  event.action = action;
+  return event;
+}
+
+/**
+ * Liftoff of a link in contact, modeled as a joint to the ground: the force
+ * of the joint on the link along the contact normal, in the world frame,
+ * falls through zero.
+ * @param link    the link in contact
+ * @param joint   the joint modeling the contact
+ * @param normal  contact normal, in the world frame
+ * @param action  called at liftoff
+ */
+inline SimulatorEvent ContactForceEvent(
+    const LinkSharedPtr &link, const JointSharedPtr &joint,
+    const gtsam::Vector3 &normal = gtsam::Vector3(0, 0, 1),
+    const std::function<void(Simulator &)> &action = nullptr) {
+  SimulatorEvent event;
+  event.name = "liftoff " + link->name();
+  const int i = link->id(), j = joint->id();
+  event.function = [i, j, normal](const gtsam::Values &values) -> double {
+    const gtsam::Vector6 wrench = Pose(values, i).inverse().AdjointMap()
+                                      .transpose() *
+                                  Wrench(values, i, j);
+    return normal.dot(wrench.tail<3>());
+  };
+  event.direction = -1;
+  event.action = action;
+  return event;
+}
+
 /**
  * Simulator is a class which simulate robot arm motion using forward
  * dynamics.
@@ -37,6 +125,87 @@ private:
   boost::optional<gtsam::Vector3> planar_axis_;
   gtsam::Values current_values_;
   gtsam::Values new_kinematics_;
+  ForwardDynamicsMethod method_;
+  boost::optional<ArticulatedBodySolver> aba_solver_;
+  IntegrationMethod integration_method_;
+  double tolerance_;
+  gtsam::Values torques_;
+  double time_;
+  std::vector<SimulatorEvent> events_;
+  double event_tolerance_;
+  std::string last_event_;
+
+  /// Solve forward dynamics with the selected method.
+  gtsam::Values solveFD(const gtsam::Values &kinematics,
+                        const gtsam::Values &torques) {
+    if (method_ == ArticulatedBody) {
+      // The recursion computes poses and twists itself, skip FK.
+      gtsam::Values values = kinematics;
+      for (auto &&joint : robot_.joints()) {
+        auto j = joint->id();
+        if (!values.exists(JointAngleKey(j))) InsertJointAngle(&values, j, 0.0);
+        if (!values.exists(JointVelKey(j))) InsertJointVel(&values, j, 0.0);
+        InsertTorque(&values, j, Torque(torques, j));
+      }
+      return aba_solver_->solveFD(values);
+    }
+
+    // Do FK to add poses
+    auto values = robot_.forwardKinematics(kinematics);
+
+    // Add torques
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      InsertTorque(&values, j, Torque(torques, j));
+    }
+
+    // Now compute accelerations with forward dynamics
+    return graph_builder_.linearSolveFD(robot_, 0, values);
+  }
+
+  /**
+   * Integrate from the state of current_values_ over dt, with the torques of
+   * the last forwardDynamics call, and return the new angles and velocities.
+   */
+  gtsam::Values integrated(const double dt) {
+    const auto &joints = robot_.joints();
+    const size_t n = joints.size();
+    gtsam::Vector q(n), v(n), a(n);
+    for (size_t i = 0; i < n; i++) {
+      auto j = joints[i]->id();
+      q(i) = JointAngle(current_values_, j);
+      v(i) = JointVel(current_values_, j);
+      a(i) = JointAccel(current_values_, j);
+    }
+
+    auto accel = [&](const gtsam::Vector &q_i, const gtsam::Vector &v_i) {
+      gtsam::Values kinematics;
+      for (size_t i = 0; i < n; i++) {
+        InsertJointAngle(&kinematics, joints[i]->id(), q_i(i));
+        InsertJointVel(&kinematics, joints[i]->id(), v_i(i));
+      }
+      const gtsam::Values results = solveFD(kinematics, torques_);
+      gtsam::Vector a_i(n);
+      for (size_t i = 0; i < n; i++) {
+        a_i(i) = JointAccel(results, joints[i]->id());
+      }
+      return a_i;
+    };
+    Integrate(integration_method_, accel, dt, a, &q, &v, tolerance_);
+
+    gtsam::Values kinematics;
+    for (size_t i = 0; i < n; i++) {
+      InsertJointVel(&kinematics, joints[i]->id(), v(i));
+      InsertJointAngle(&kinematics, joints[i]->id(), q(i));
+    }
+    return kinematics;
+  }
+
+  /// Return whether the event fires between values g0 and g1.
+  static bool crosses(const SimulatorEvent &event, double g0, double g1) {
+    return (event.direction >= 0 && g0 < 0 && g1 >= 0) ||
+           (event.direction <= 0 && g0 > 0 && g1 <= 0);
+  }
 
 public:
   /**
@@ -47,13 +216,25 @@ public:
    * @param initial_values initial joint angles and velocities
    * @param gravity        gravity vector
    * @param planar_axis    planar axis vector
+   * @param method         forward dynamics method
    */
   Simulator(const Robot &robot, const gtsam::Values &initial_values,
             const boost::optional<gtsam::Vector3> &gravity = boost::none,
-            const boost::optional<gtsam::Vector3> &planar_axis = boost::none)
+            const boost::optional<gtsam::Vector3> &planar_axis = boost::none,
+            const ForwardDynamicsMethod method = LinearFactorGraph)
       : robot_(robot), t_(0),
         graph_builder_(DynamicsGraph(gravity, planar_axis)),
-        initial_values_(initial_values) {
+        initial_values_(initial_values),
+        gravity_(gravity),
+        planar_axis_(planar_axis),
+        method_(method),
+        integration_method_(ExplicitEuler),
+        tolerance_(1e-6),
+        time_(0),
+        event_tolerance_(1e-9) {
+    if (method_ == ArticulatedBody) {
+      aba_solver_ = ArticulatedBodySolver(robot_, gravity, planar_axis);
+    }
     reset();
   }
   ~Simulator() {}
@@ -61,6 +242,8 @@ public:
   /// Reset simulation.
   void reset(const double t = 0) {
     t_ = t;
+    time_ = 0;
+    last_event_.clear();
     new_kinematics_ = initial_values_;
   }
 
@@ -69,40 +252,17 @@ public:
    * @param torques torques for the time step
    */
   void forwardDynamics(const gtsam::Values &torques) {
-    // Do FK to add poses
-    auto values = robot_.forwardKinematics(new_kinematics_);
-
-    // Add torques
-    for (auto &&joint : robot_.joints()) {
-      auto j = joint->id();
-      InsertTorque(&values, j, Torque(torques, j));
-    }
-
-    // Now compute accelerations with forward dynamics
-    current_values_ = graph_builder_.linearSolveFD(robot_, 0, values);
+    torques_ = torques;
+    current_values_ = solveFD(new_kinematics_, torques);
   }
 
   /**
-   * Integrate to calculate new q, v for one time step, update q_, v_
-   * @param torques torques for the time step
+   * Integrate to calculate new q, v for one time step, update q_, v_.
+   * The Runge-Kutta methods call forward dynamics again at intermediate
+   * states, with the torques of the last forwardDynamics call.
    * @param dt duration for the time step
    */
-  void integration(const double dt) {
-    new_kinematics_ = gtsam::Values();
-    const double dt2 = std::pow(dt, 2);
-    for (auto &&joint : robot_.joints()) {
-      auto j = joint->id();
-      const double q = JointAngle(current_values_, j);
-      const double v = JointVel(current_values_, j);
-      const double a = JointAccel(current_values_, j);
-
-      // TODO(frank): one could use t values and save entire simulation.
-      const double v_new = v + dt * a;
-      InsertJointVel(&new_kinematics_, j, v_new);
-      // TODO(frank): consider using v_new for symplectic integration.
-      InsertJointAngle(&new_kinematics_, j, q + dt * v + 0.5 * a * dt2);
-    }
-  }
+  void integration(const double dt) { new_kinematics_ = integrated(dt); }
 
   /**
    * Simulate for one time step.
@@ -113,6 +273,113 @@ public:
     forwardDynamics(torques);
     integration(dt);
     t_++;
+    time_ += dt;
+  }
+
+  /**
+   * Simulate for at most one time step, stopping at the first event that
+   * fires within it. The event time is located by Illinois regula falsi on
+   * the integrated state, within the event tolerance, and the simulation
+   * stops just after it, so the event functions have changed sign. The action
+   * of the event, if any, is then called, e.g. to switch the phase.
+   * @param torques torques for the time step
+   * @param dt      duration of the time step
+   * @return the duration simulated, dt if no event fired
+   */
+  double stepUntilEvent(const gtsam::Values &torques, const double dt) {
+    last_event_.clear();
+    forwardDynamics(torques);
+    if (events_.empty()) {
+      integration(dt);
+      t_++;
+      time_ += dt;
+      return dt;
+    }
+
+    // Event functions at a time h within the step.
+    auto evaluate = [&](double h, gtsam::Values *kinematics)
+        -> std::vector<double> {
+      *kinematics = integrated(h);
+      const gtsam::Values values = solveFD(*kinematics, torques_);
+      std::vector<double> g;
+      for (auto &&event : events_) g.push_back(event.function(values));
+      return g;
+    };
+    std::vector<double> g0;
+    for (auto &&event : events_) g0.push_back(event.function(current_values_));
+    gtsam::Values kinematics;
+    const std::vector<double> g1 = evaluate(dt, &kinematics);
+
+    // Locate the earliest of the events that fire within the step.
+    double h_event = dt;
+    int fired = -1;
+    gtsam::Values event_kinematics;
+    for (size_t e = 0; e < events_.size(); e++) {
+      if (!crosses(events_[e], g0[e], g1[e])) continue;
+      double lo = 0, hi = h_event, g_lo = g0[e], g_hi = g1[e];
+      gtsam::Values hi_kinematics = kinematics;
+      if (hi < dt) {
+        // Does it fire before the earliest event found so far?
+        g_hi = evaluate(hi, &hi_kinematics)[e];
+        if (!crosses(events_[e], g_lo, g_hi)) continue;
+      }
+      int side = 0;
+      for (size_t iter = 0; iter < 100 && hi - lo > event_tolerance_;
+           iter++) {
+        double h = (lo * g_hi - hi * g_lo) / (g_hi - g_lo);
+        if (!(h > lo && h < hi)) h = 0.5 * (lo + hi);
+        gtsam::Values h_kinematics;
+        const double g = evaluate(h, &h_kinematics)[e];
+        if (crosses(events_[e], g_lo, g)) {
+          hi = h, g_hi = g, hi_kinematics = h_kinematics;
+          if (side == -1) g_lo *= 0.5;
+          side = -1;
+        } else {
+          lo = h, g_lo = g;
+          if (side == 1) g_hi *= 0.5;
+          side = 1;
+        }
+      }
+      h_event = hi;
+      fired = e;
+      event_kinematics = hi_kinematics;
+    }
+
+    t_++;
+    if (fired < 0) {
+      new_kinematics_ = kinematics;
+      time_ += dt;
+      return dt;
+    }
+    new_kinematics_ = event_kinematics;
+    time_ += h_event;
+    const SimulatorEvent event = events_[fired];
+    last_event_ = event.name;
+    if (event.action) event.action(*this);
+    return h_event;
+  }
+
+  /**
+   * Simulate the sequence of torques with the events, each torque for dt
+   * seconds, stopping at events within the steps and then continuing.
+   * @param torques_seq torques for each time step
+   * @param dt          duration for each time step
+   * @param records     optional, the events that fired and their times
+   * @return the values of the start of the last (partial) step simulated
+   */
+  gtsam::Values simulateWithEvents(
+      const std::vector<gtsam::Values> &torques_seq, const double dt,
+      std::vector<SimulatorEventRecord> *records = nullptr) {
+    for (const auto &torques : torques_seq) {
+      double remaining = dt;
+      while (remaining > event_tolerance_) {
+        remaining -= stepUntilEvent(torques, remaining);
+        if (records && !last_event_.empty()) {
+          records->push_back({time_, last_event_});
+        }
+      }
+    }
+    return current_values_;
   }
 
   /// Simulation for the specified sequence of torques.
@@ -124,8 +391,79 @@ public:
     return current_values_;
   }
 
+  /**
+   * Simulate the sequence of torques from the current state, and return the
+   * joint angles, velocities, accelerations and torques of each step.
+   * @param torques_seq torques for each time step
+   * @param dt          duration for each time step
+   */
+  TrajectoryState simulateTrajectory(
+      const std::vector<gtsam::Values> &torques_seq, const double dt) {
+    TrajectoryState trajectory(robot_, torques_seq.size(),
+                               TrajectoryState::kJointQuantities);
+    for (size_t k = 0; k < torques_seq.size(); k++) {
+      forwardDynamics(torques_seq[k]);
+      trajectory.setStep(k, current_values_, 0);
+      integration(dt);
+      t_++;
+    }
+    return trajectory;
+  }
+
+  /// Add an event, see stepUntilEvent.
+  void addEvent(const SimulatorEvent &event) { events_.push_back(event); }
+
+  /// Remove all events, e.g. when switching phase.
+  void clearEvents() { events_.clear(); }
+
+  /// Return the events.
+  const std::vector<SimulatorEvent> &events() const { return events_; }
+
+  /// Set the tolerance on the time of events, in seconds.
+  void setEventTolerance(const double tolerance) {
+    event_tolerance_ = tolerance;
+  }
+
+  /// Return the name of the event that ended the last step, empty if none.
+  const std::string &lastEvent() const { return last_event_; }
+
+  /// Return the simulated time in seconds since the last reset.
+  double time() const { return time_; }
+
+  /**
+   * Switch to another robot, e.g. with other links fixed to the ground in a
+   * new contact phase, keeping the joint angles and velocities. The robot
+   * needs the same joints as the current one.
+   */
+  void setRobot(const Robot &robot) {
+    robot_ = robot;
+    if (method_ == ArticulatedBody) {
+      aba_solver_ = ArticulatedBodySolver(robot_, gravity_, planar_axis_);
+    }
+  }
+
+  /// Return the robot being simulated.
+  const Robot &robot() const { return robot_; }
+
   /// Return all values during simulation.
   const gtsam::Values &getValues() const { return current_values_; }
+
+  /// Return the forward dynamics method in use.
+  ForwardDynamicsMethod method() const { return method_; }
+
+  /**
+   * Select the integration method, explicit Euler by default.
+   * @param method    integration method
+   * @param tolerance error tolerance, only used by RK45
+   */
+  void setIntegrationMethod(const IntegrationMethod method,
+                            const double tolerance = 1e-6) {
+    integration_method_ = method;
+    tolerance_ = tolerance;
+  }
+
+  /// Return the integration method in use.
+  IntegrationMethod integrationMethod() const { return integration_method_; }
 };
 
 } // namespace gtdynamics
@@ -0,0 +1,240 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeOptimalRetiming.cpp
+ * @brief Time-optimal parameterization of joint-space paths under the
+ * velocity, acceleration and torque limits of the joints.
+ */
+
+#include <gtdynamics/dynamics/TimeOptimalRetiming.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+constexpr double kSlack = 1e-9;
+
+// Linear constraint a * u + b * x <= c on the path acceleration u and the
+// squared path speed x.
+struct Row {
+  double a, b, c;
+};
+
+// Interval of x in which some u satisfies all rows.
+struct Range {
+  double lo = 0, hi = kInfinity;
+  bool empty() const { return lo > hi + kSlack * std::max(1.0, hi); }
+};
+
+// Bounds on u at x from the rows with a != 0.
+Range AccelerationRange(const std::vector<Row> &rows, double x) {
+  Range range;
+  range.lo = -kInfinity;
+  for (const Row &row : rows) {
+    const double rhs = row.c - row.b * x;
+    if (row.a > 0) {
+      range.hi = std::min(range.hi, rhs / row.a);
+    } else if (row.a < 0) {
+      range.lo = std::max(range.lo, rhs / row.a);
+    }
+  }
+  return range;
+}
+
+// Range of x for which the rows are feasible in u, by Fourier-Motzkin
+// elimination: every lower bound on u must be below every upper bound.
+Range SpeedRange(const std::vector<Row> &rows) {
+  Range range;
+  auto bound = [&range](double b, double c) {
+    if (b > 0) {
+      range.hi = std::min(range.hi, c / b);
+    } else if (b < 0) {
+      range.lo = std::max(range.lo, c / b);
+    } else if (c < 0) {
+      range.lo = kInfinity;
+    }
+  };
+  for (const Row &lower : rows) {
+    if (lower.a == 0) {
+      bound(lower.b, lower.c);
+      continue;
+    }
+    if (lower.a > 0) continue;
+    // u >= (c_l - b_l x) / a_l and u <= (c_u - b_u x) / a_u.
+    for (const Row &upper : rows) {
+      if (upper.a <= 0) continue;
+      bound(upper.b / upper.a - lower.b / lower.a,
+            upper.c / upper.a - lower.c / lower.a);
+    }
+  }
+  return range;
+}
+
+// Rows for reaching x_next in [next.lo, next.hi] with x_next = x + 2 u.
+void AddTransition(const Range &next, std::vector<Row> *rows) {
+  rows->push_back({2, 1, next.hi});
+  rows->push_back({-2, -1, -next.lo});
+}
+}  // namespace
+
+/* ************************************************************************* */
+TimeOptimalRetiming::TimeOptimalRetiming(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis,
+    const TimeOptimalRetimingParams &params)
+    : solver_(robot, gravity, planar_axis), params_(params) {
+  if (!solver_.rootIsFixed()) {
+    throw std::invalid_argument(
+        "TimeOptimalRetiming: the robot must have a fixed link.");
+  }
+  const size_t n = solver_.numJoints();
+  velocity_limits_.resize(n);
+  acceleration_limits_.resize(n);
+  torque_limits_.resize(n);
+  for (size_t j = 0; j < n; j++) {
+    const JointParams &limits = solver_.joints()[j]->parameters();
+    velocity_limits_(j) = limits.velocity_limit;
+    acceleration_limits_(j) = limits.acceleration_limit;
+    torque_limits_(j) = limits.torque_limit;
+  }
+}
+
+/* ************************************************************************* */
+RetimedPath TimeOptimalRetiming::retime(const Matrix &path) const {
+  const size_t n = solver_.numJoints(), num_waypoints = path.rows();
+  if (size_t(path.cols()) != n || num_waypoints < 2) {
+    throw std::invalid_argument(
+        "TimeOptimalRetiming: the path needs a column per joint and at least "
+        "two waypoints.");
+  }
+  const size_t N = num_waypoints - 1;
+
+  // Path derivatives by finite differences, one-sided at the ends.
+  Matrix dq(num_waypoints, n), ddq(num_waypoints, n);
+  for (size_t i = 0; i <= N; i++) {
+    const size_t prev = i == 0 ? 0 : i - 1, next = i == N ? N : i + 1;
+    dq.row(i) = (path.row(next) - path.row(prev)) / double(next - prev);
+    if (N < 2) {
+      ddq.row(i).setZero();
+    } else {
+      const size_t mid = std::min(std::max<size_t>(i, 1), N - 1);
+      ddq.row(i) =
+          path.row(mid + 1) - 2 * path.row(mid) + path.row(mid - 1);
+    }
+  }
+
+  // Torques m u + c x + g along the path, with three RNEA passes.
+  Matrix m(num_waypoints, n), c(num_waypoints, n), g(num_waypoints, n);
+  const Vector zero = Vector::Zero(n);
+  TreeDynamicsResult result;
+  for (size_t i = 0; i <= N; i++) {
+    const Vector q = path.row(i).transpose(), q1 = dq.row(i).transpose(),
+                 q2 = ddq.row(i).transpose();
+    solver_.inverseDynamics(q, zero, zero, Pose3(), Vector6::Zero(), &result);
+    g.row(i) = result.torques.transpose();
+    solver_.inverseDynamics(q, zero, q1, Pose3(), Vector6::Zero(), &result);
+    m.row(i) = result.torques.transpose() - g.row(i);
+    solver_.inverseDynamics(q, q1, q2, Pose3(), Vector6::Zero(), &result);
+    c.row(i) = result.torques.transpose() - g.row(i);
+  }
+
+  // Limits at waypoint i as rows in (u, x).
+  auto limits = [&](size_t i) -> std::vector<Row> {
+    std::vector<Row> rows;
+    rows.reserve(5 * n + 3);
+    rows.push_back({0, -1, 0});
+    for (size_t j = 0; j < n; j++) {
+      const double v = dq(i, j);
+      if (v != 0) {
+        rows.push_back(
+            {0, v * v, velocity_limits_(j) * velocity_limits_(j)});
+      }
+      rows.push_back({v, ddq(i, j), acceleration_limits_(j)});
+      rows.push_back({-v, -ddq(i, j), acceleration_limits_(j)});
+      rows.push_back({m(i, j), c(i, j), torque_limits_(j) - g(i, j)});
+      rows.push_back({-m(i, j), -c(i, j), torque_limits_(j) + g(i, j)});
+    }
+    return rows;
+  };
+
+  // Backward pass: the squared speeds at each waypoint from which the end
+  // speed can still be reached.
+  std::vector<Range> controllable(num_waypoints);
+  const double x_end = params_.end_speed * params_.end_speed;
+  controllable[N] = SpeedRange(limits(N));
+  controllable[N].lo = std::max(controllable[N].lo, x_end);
+  controllable[N].hi = std::min(controllable[N].hi, x_end);
+  for (size_t i = N; i-- > 0;) {
+    if (controllable[i + 1].empty()) {
+      controllable[0] = controllable[i + 1];
+      break;
+    }
+    std::vector<Row> rows = limits(i);
+    AddTransition(controllable[i + 1], &rows);
+    controllable[i] = SpeedRange(rows);
+  }
+  const double x_start = params_.start_speed * params_.start_speed;
+  const Range &start = controllable[0];
+  if (start.empty() || x_start < start.lo - kSlack ||
+      x_start > start.hi + kSlack * std::max(1.0, start.hi)) {
+    throw std::runtime_error(
+        "TimeOptimalRetiming: the path cannot be followed within the joint "
+        "limits.");
+  }
+
+  // Forward pass: the largest acceleration that stays controllable.
+  Vector x(num_waypoints), u = Vector::Zero(num_waypoints);
+  x(0) = x_start;
+  for (size_t i = 0; i < N; i++) {
+    std::vector<Row> rows = limits(i);
+    const Range &next = controllable[i + 1];
+    AddTransition(next, &rows);
+    u(i) = AccelerationRange(rows, x(i)).hi;
+    x(i + 1) = std::min(std::max(x(i) + 2 * u(i), next.lo), next.hi);
+    u(i) = (x(i + 1) - x(i)) / 2;
+  }
+  if (N > 0) u(N) = u(N - 1);
+
+  RetimedPath retimed;
+  retimed.speeds = x.cwiseSqrt();
+  retimed.times = Vector::Zero(num_waypoints);
+  for (size_t i = 0; i < N; i++) {
+    retimed.times(i + 1) =
+        retimed.times(i) + 2 / (retimed.speeds(i) + retimed.speeds(i + 1));
+  }
+  retimed.velocities = retimed.speeds.asDiagonal() * dq;
+  retimed.accelerations = u.asDiagonal() * dq + x.asDiagonal() * ddq;
+  retimed.torques = u.asDiagonal() * m + x.asDiagonal() * c + g;
+  return retimed;
+}
+
+/* ************************************************************************* */
+RetimedPath TimeOptimalRetiming::retime(const gtsam::Values &values,
+                                        size_t k_start, size_t k_end) const {
+  const auto &joints = solver_.joints();
+  Matrix path(k_end - k_start + 1, joints.size());
+  for (size_t k = k_start; k <= k_end; k++) {
+    for (size_t j = 0; j < joints.size(); j++) {
+      path(k - k_start, j) = JointAngle(values, joints[j]->id(), k);
+    }
+  }
+  return retime(path);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeOptimalRetiming.h
+ * @brief Time-optimal parameterization of joint-space paths under the
+ * velocity, acceleration and torque limits of the joints.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of TimeOptimalRetiming.
+struct TimeOptimalRetimingParams {
+  double start_speed = 0;  // path speed at the first waypoint
+  double end_speed = 0;    // path speed at the last waypoint
+
+  TimeOptimalRetimingParams() {}
+};
+
+/// A path with its time-optimal timing, one row per waypoint.
+struct RetimedPath {
+  gtsam::Vector times;          ///< time of each waypoint
+  gtsam::Vector speeds;         ///< path speed, in waypoints per second
+  gtsam::Matrix velocities;     ///< joint velocities
+  gtsam::Matrix accelerations;  ///< joint accelerations until next waypoint
+  gtsam::Matrix torques;        ///< joint torques
+
+  /// Return the duration of the path.
+  double duration() const { return times(times.size() - 1); }
+};
+
+/**
+ * TimeOptimalRetiming finds the fastest timing of a joint-space path, e.g.,
+ * from Kinematics::interpolate, under the velocity, acceleration and torque
+ * limits in the JointParams of each joint, in the manner of TOPP-RA.
+ *
+ * The path q(s) is parameterized by the waypoint index s, with derivatives
+ * q'(s) and q''(s) by finite differences. Along it, joint velocities are
+ * q' ds/dt, accelerations q' u + q'' x, and torques m u + c x + g, with
+ * x = (ds/dt)^2 and u = d^2s/dt^2. The coefficients m = M q', c = M q'' +
+ * C(q, q') q' and g are found per waypoint by three RNEA passes. All limits
+ * are then linear in (u, x), and x_{i+1} = x_i + 2 u_i between waypoints.
+ *
+ * A backward pass computes the interval of x from which the rest of the path
+ * can still be followed at each waypoint, each from the next one by
+ * eliminating u from a two-variable linear program. A forward pass then
+ * takes the largest u that stays in these intervals. Both passes cost a
+ * constant per waypoint, so retiming is linear in the length of the path.
+ *
+ * Limits are only enforced at the waypoints, and the robot must be a tree
+ * with a fixed root, as for ArticulatedBodySolver.
+ */
+class TimeOptimalRetiming {
+ private:
+  ArticulatedBodySolver solver_;
+  TimeOptimalRetimingParams params_;
+  gtsam::Vector velocity_limits_, acceleration_limits_, torque_limits_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   * @param params       boundary speeds
+   */
+  TimeOptimalRetiming(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none,
+      const TimeOptimalRetimingParams &params = TimeOptimalRetimingParams());
+
+  /**
+   * Retime a path.
+   * @param path  joint angles, one row per waypoint and one column per joint,
+   *              in robot.joints() order
+   * @return the timing, or throws std::runtime_error if the path cannot be
+   * followed within the limits
+   */
+  RetimedPath retime(const gtsam::Matrix &path) const;
+
+  /// Retime the joint angles of time steps [k_start, k_end] in values.
+  RetimedPath retime(const gtsam::Values &values, size_t k_start,
+                     size_t k_end) const;
+};
+
+}  // namespace gtdynamics
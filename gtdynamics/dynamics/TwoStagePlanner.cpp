@@ -0,0 +1,307 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TwoStagePlanner.cpp
+ * @brief Kinematics-then-dynamics planning of quasi-dynamic trajectories.
+ */
+
+#include <gtdynamics/dynamics/TwoStagePlanner.h>
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/factors/PolyhedralFrictionConeFactor.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/Interval.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+using gtsam::GaussianFactorGraph;
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+using std::vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+TwoStagePlanner::TwoStagePlanner(
+    const Robot &robot, const Trajectory &trajectory,
+    const vector<double> &phase_dts,
+    const boost::optional<Vector3> &gravity,
+    const boost::optional<std::string> &base_name,
+    const TwoStagePlannerParams &params)
+    : robot_(robot),
+      trajectory_(trajectory),
+      phase_dts_(phase_dts),
+      params_(params),
+      graph_builder_(params.opt, gravity),
+      gravity_(gravity) {
+  if (phase_dts.size() != trajectory.numPhases()) {
+    throw std::invalid_argument(
+        "TwoStagePlanner: need one time step per phase.");
+  }
+  if (std::any_of(phase_dts.begin(), phase_dts.end(),
+                  [](double dt) { return dt <= 0; })) {
+    throw std::invalid_argument("TwoStagePlanner: time steps must be > 0.");
+  }
+  if (trajectory.numPhases() == 0 ||
+      trajectory.getEndTimeStep(trajectory.numPhases() - 1) < 1) {
+    throw std::invalid_argument(
+        "TwoStagePlanner: trajectory needs at least one time step.");
+  }
+  const auto &links = robot.links();
+  const bool fixed =
+      std::any_of(links.begin(), links.end(), [&robot](const LinkSharedPtr &l) {
+        return robot.isFixed(l);
+      });
+  if (!fixed) base_ = base_name ? robot.link(*base_name) : links.front();
+}
+
+/* ************************************************************************* */
+const PointOnLinks &TwoStagePlanner::contactPoints(int k) const {
+  const size_t p = trajectory_.phaseIndex(k);
+  if (k == trajectory_.getEndTimeStep(p) && p + 1 < trajectory_.numPhases()) {
+    return trajectory_.transitionContactPoints()[p];
+  }
+  return trajectory_.phaseContactPoints()[p];
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph TwoStagePlanner::sliceGraph(int k) const {
+  // Contact accelerations follow from the kinematics, and friction cones are
+  // checked afterwards, so neither is part of the linear system.
+  NonlinearFactorGraph graph = graph_builder_.aFactors(robot_, k);
+  const NonlinearFactorGraph dynamics =
+      graph_builder_.dynamicsFactors(robot_, k, contactPoints(k), params_.mu);
+  for (auto &&factor : dynamics) {
+    if (boost::dynamic_pointer_cast<ContactDynamicsFrictionConeFactor>(
+            factor) ||
+        boost::dynamic_pointer_cast<PolyhedralFrictionConeFactor>(factor)) {
+      continue;
+    }
+    graph.add(factor);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values TwoStagePlanner::kinematics(const ContactGoals &contact_goals) const {
+  const Kinematics kinematics(params_.kinematics);
+  const int K = trajectory_.getEndTimeStep(trajectory_.numPhases() - 1);
+  return kinematics.inverse(Interval(0, K), robot_, contact_goals);
+}
+
+/* ************************************************************************* */
+Values TwoStagePlanner::kinematics(const ContactGoals &start,
+                                   const ContactGoals &goal) const {
+  const Kinematics kinematics(params_.kinematics);
+  const int K = trajectory_.getEndTimeStep(trajectory_.numPhases() - 1);
+  return kinematics.interpolate(Interval(0, K), robot_, start, goal);
+}
+
+/* ************************************************************************* */
+Values TwoStagePlanner::differentiate(const Values &kinematics) const {
+  const int K = trajectory_.getEndTimeStep(trajectory_.numPhases() - 1);
+  const auto &joints = robot_.joints();
+  const size_t offset = base_ ? 6 : 0, n = offset + joints.size();
+
+  // Duration of the step ending at k, and slope of each step: the base twist
+  // and the joint velocities.
+  vector<double> h(K + 1, 0.0);
+  for (int k = 1; k <= K; k++) h[k] = phase_dts_[trajectory_.phaseIndex(k)];
+  vector<Vector> slopes(K);
+  for (int k = 0; k < K; k++) {
+    Vector delta(n);
+    if (base_) {
+      const int i = base_->id();
+      delta.head<6>() = Pose3::Logmap(
+          Pose(kinematics, i, k).between(Pose(kinematics, i, k + 1)));
+    }
+    for (size_t j = 0; j < joints.size(); j++) {
+      const int id = joints[j]->id();
+      delta(offset + j) =
+          JointAngle(kinematics, id, k + 1) - JointAngle(kinematics, id, k);
+    }
+    slopes[k] = delta / h[k + 1];
+  }
+
+  // Three-point differences, exact for quadratic motions also at both ends.
+  vector<Vector> accels(K + 1, Vector::Zero(n));
+  for (int k = 1; k < K; k++) {
+    accels[k] = 2 * (slopes[k] - slopes[k - 1]) / (h[k] + h[k + 1]);
+  }
+  if (K > 1) {
+    accels[0] = accels[1];
+    accels[K] = accels[K - 1];
+  }
+  vector<Vector> vels(K + 1);
+  vels[0] = slopes[0] - 0.5 * h[1] * accels[0];
+  vels[K] = slopes[K - 1] + 0.5 * h[K] * accels[K];
+  for (int k = 1; k < K; k++) {
+    vels[k] = (h[k + 1] * slopes[k - 1] + h[k] * slopes[k]) / (h[k] + h[k + 1]);
+  }
+
+  const boost::optional<std::string> root_name =
+      base_ ? boost::optional<std::string>(base_->name()) : boost::none;
+  Values motion;
+  for (int k = 0; k <= K; k++) {
+    Values known;
+    for (size_t j = 0; j < joints.size(); j++) {
+      const int id = joints[j]->id();
+      InsertJointAngle(&known, id, k, JointAngle(kinematics, id, k));
+      InsertJointVel(&known, id, k, vels[k](offset + j));
+      InsertJointAccel(&known, id, k, accels[k](offset + j));
+    }
+    if (base_) {
+      const int i = base_->id();
+      InsertPose(&known, i, k, Pose(kinematics, i, k));
+      InsertTwist(&known, i, k, Vector6(vels[k].head<6>()));
+      InsertTwistAccel(&known, i, k, Vector6(accels[k].head<6>()));
+    }
+    motion.insert(robot_.forwardKinematics(known, k, root_name));
+  }
+  for (size_t p = 0; p < trajectory_.numPhases(); p++) {
+    motion.insert(PhaseKey(p), phase_dts_[p]);
+  }
+  return motion;
+}
+
+/* ************************************************************************* */
+Values TwoStagePlanner::inverseDynamics(const Values &motion) const {
+  const int K = trajectory_.getEndTimeStep(trajectory_.numPhases() - 1);
+
+  // Each slice writes its own entry, so no locking is needed.
+  vector<Values> slices(K + 1);
+  ParallelFor(K + 1, [&](size_t k) {
+    const NonlinearFactorGraph graph = sliceGraph(k);
+
+    // Twist accelerations, wrenches, torques and contact wrenches are
+    // unknown, all other keys are known from the motion.
+    Values linearization;
+    gtsam::KeySet unknowns;
+    for (Key key : graph.keys()) {
+      if (motion.exists(key)) {
+        linearization.insert(key, motion.at(key));
+      } else {
+        unknowns.insert(key);
+        if (DynamicsSymbol(key).label() == "T") {
+          linearization.insert(key, 0.0);
+        } else {
+          linearization.insert(key, Vector6(Vector6::Zero()));
+        }
+      }
+    }
+
+    // The factors are linear in the unknowns, so linearizing at zero is
+    // exact. The known keys do not move, so their columns are dropped.
+    GaussianFactorGraph linear;
+    for (auto &&factor : graph) {
+      const auto jacobian = boost::dynamic_pointer_cast<JacobianFactor>(
+          factor->linearize(linearization));
+      std::vector<std::pair<Key, Matrix>> terms;
+      for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+        if (unknowns.count(*it)) terms.emplace_back(*it, jacobian->getA(it));
+      }
+      if (terms.empty()) continue;
+      linear.emplace_shared<JacobianFactor>(terms, jacobian->getb(),
+                                            jacobian->get_model());
+    }
+    if (params_.regularization_sigma > 0) {
+      for (Key key : unknowns) {
+        const size_t dim = linearization.at(key).dim();
+        linear.emplace_shared<JacobianFactor>(
+            key, Matrix::Identity(dim, dim), Vector::Zero(dim),
+            InternedIsotropic(dim, params_.regularization_sigma));
+      }
+    }
+
+    const gtsam::VectorValues results = linear.optimize();
+    for (Key key : unknowns) {
+      if (DynamicsSymbol(key).label() == "T") {
+        slices[k].insert(key, results.at(key)(0));
+      } else {
+        slices[k].insert(key, Vector6(results.at(key)));
+      }
+    }
+  });
+
+  Values values = motion;
+  for (const Values &slice : slices) values.insert(slice);
+  return values;
+}
+
+/* ************************************************************************* */
+vector<int> TwoStagePlanner::violations(const Values &values) const {
+  const int K = trajectory_.getEndTimeStep(trajectory_.numPhases() - 1);
+  const double tol = params_.tolerance;
+  const Vector3 up = gravity_ && gravity_->norm() > 0
+                         ? Vector3(-gravity_->normalized())
+                         : Vector3(Vector3::UnitZ());
+  vector<int> steps;
+  for (int k = 0; k <= K; k++) {
+    bool violated = false;
+    for (auto &&joint : robot_.joints()) {
+      const double limit = joint->parameters().torque_limit;
+      violated |= std::abs(Torque(values, joint->id(), k)) > limit + tol;
+    }
+    for (auto &&cp : contactPoints(k)) {
+      const int i = cp.link->id();
+      const Key key = ContactWrenchKey(i, 0, k);
+      if (!values.exists(key)) continue;
+      const Vector3 f = Pose(values, i, k).rotation() *
+                        Vector3(values.at<Vector6>(key).tail<3>());
+      const double normal = up.dot(f);
+      const double tangential = (f - normal * up).norm();
+      violated |= normal < -tol || tangential > params_.mu * normal + tol;
+    }
+    if (violated) steps.push_back(k);
+  }
+  return steps;
+}
+
+/* ************************************************************************* */
+TwoStageResult TwoStagePlanner::plan(
+    const Values &kinematics, const NonlinearFactorGraph &objectives) const {
+  TwoStageResult result;
+  result.values = inverseDynamics(differentiate(kinematics));
+  result.violations = violations(result.values);
+  if (result.violations.empty() || !params_.fallback) return result;
+
+  // Full solve, from the two-stage solution.
+  NonlinearFactorGraph graph = trajectory_.multiPhaseFactorGraph(
+      robot_, graph_builder_, params_.collocation, params_.mu);
+  graph.add(objectives);
+  trajectory_.addIntegrationTimeFactors(&graph, phase_dts_);
+  Values initial;
+  for (Key key : graph.keys()) {
+    if (!result.values.exists(key)) {
+      throw std::runtime_error("TwoStagePlanner: no initial value for " +
+                               _GTDKeyFormatter(key));
+    }
+    initial.insert(key, result.values.at(key));
+  }
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial, params_.lm);
+  result.values = optimizer.optimize();
+  result.full_solve = true;
+  return result;
+}
+
+}  // namespace gtdynamics
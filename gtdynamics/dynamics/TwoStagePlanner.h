@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TwoStagePlanner.h
+ * @brief Kinematics-then-dynamics planning of quasi-dynamic trajectories.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of TwoStagePlanner.
+struct TwoStagePlannerParams {
+  KinematicsParameters kinematics;  ///< inverse kinematics of the first stage
+  OptimizerSetting opt;             ///< noise models of the dynamics factors
+  double mu = 1.0;                  ///< coefficient of static friction
+  double regularization_sigma = 1.0;  ///< zero prior on wrenches and torques
+  double tolerance = 1e-6;  ///< slack on the torque and friction limits
+  bool fallback = true;     ///< full solve when limits are violated
+  CollocationScheme collocation = Trapezoidal;  ///< of the full solve
+  gtsam::LevenbergMarquardtParams lm;           ///< of the full solve
+
+  TwoStagePlannerParams() {}
+};
+
+/// Outcome of TwoStagePlanner::plan.
+struct TwoStageResult {
+  gtsam::Values values;      ///< all quantities at all time steps
+  std::vector<int> violations;  ///< steps of the two-stage solution that
+                                ///< violate torque or friction limits
+  bool full_solve = false;   ///< whether values come from the full solve
+};
+
+/**
+ * TwoStagePlanner plans quasi-dynamic trajectories, for which a kinematically
+ * feasible motion with consistent torques is enough, without solving the
+ * coupled multi-phase trajectory graph.
+ *
+ * The first stage solves inverse kinematics on every slice of the trajectory,
+ * see Kinematics::inverse and Kinematics::interpolate. The second stage
+ * differentiates the joint angles and the base pose by finite differences,
+ * with the time step of each phase, and solves the inverse dynamics of each
+ * slice on its own, in parallel when GTSAM is built with TBB. With the
+ * motion known, the twist acceleration, wrench, torque and contact moment
+ * factors of a slice are linear in the twist accelerations, wrenches,
+ * torques and contact wrenches, so each slice is a single linear solve, as
+ * in LinearStaticsSolver. A weak zero prior selects the smallest contact
+ * wrenches when several contacts share the load.
+ *
+ * Only when a torque exceeds its joint limit, or a contact wrench leaves its
+ * friction cone, is the full Trajectory::multiPhaseFactorGraph solved, from
+ * the two-stage solution.
+ *
+ * Contacts at each step are those of its phase, and those shared by the two
+ * phases at a transition, as in Trajectory::multiPhaseFactorGraph.
+ */
+class TwoStagePlanner {
+ private:
+  Robot robot_;
+  Trajectory trajectory_;
+  std::vector<double> phase_dts_;
+  TwoStagePlannerParams params_;
+  DynamicsGraph graph_builder_;
+  boost::optional<gtsam::Vector3> gravity_;
+  LinkSharedPtr base_;  ///< null for a robot with a fixed link
+
+  /// Return the contact points at time step k.
+  const PointOnLinks &contactPoints(int k) const;
+
+  /// Return the factors of slice k that are linear once the motion is known.
+  gtsam::NonlinearFactorGraph sliceGraph(int k) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot      the robot
+   * @param trajectory phases and their numbers of time steps
+   * @param phase_dts  time step of each phase
+   * @param gravity    gravity in world frame
+   * @param base_name  floating base differentiated from its poses, the
+   *                   first link if not given; ignored with a fixed link
+   * @param params     parameters of both stages and of the fallback
+   */
+  TwoStagePlanner(
+      const Robot &robot, const Trajectory &trajectory,
+      const std::vector<double> &phase_dts,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<std::string> &base_name = boost::none,
+      const TwoStagePlannerParams &params = TwoStagePlannerParams());
+
+  /// Return the time step of each phase.
+  const std::vector<double> &phaseDts() const { return phase_dts_; }
+
+  /**
+   * First stage: inverse kinematics of every slice to the same goals.
+   * @param contact_goals  goals for the contact points
+   * @return poses and joint angles of all time steps
+   */
+  gtsam::Values kinematics(const ContactGoals &contact_goals) const;
+
+  /**
+   * First stage: inverse kinematics of every slice, to goals linearly
+   * interpolated over the whole trajectory.
+   * @param start  goals for the contact points at the first time step
+   * @param goal   goals for the contact points at the last time step
+   * @return poses and joint angles of all time steps
+   */
+  gtsam::Values kinematics(const ContactGoals &start,
+                           const ContactGoals &goal) const;
+
+  /**
+   * Differentiate a kinematic trajectory: central differences inside, and
+   * one-sided differences at both ends, with the time step of each phase.
+   * @param kinematics  joint angles at all steps, and the base poses
+   * @return joint angles, velocities and accelerations, poses and twists of
+   * all links, the twist accelerations of the base, and the phase time steps
+   */
+  gtsam::Values differentiate(const gtsam::Values &kinematics) const;
+
+  /**
+   * Second stage: linear inverse dynamics of every slice.
+   * @param motion  the result of differentiate
+   * @return motion with twist accelerations, wrenches, torques and contact
+   * wrenches at all steps
+   */
+  gtsam::Values inverseDynamics(const gtsam::Values &motion) const;
+
+  /// Return the time steps with torques or contact wrenches beyond limits.
+  std::vector<int> violations(const gtsam::Values &values) const;
+
+  /**
+   * Plan from a kinematic trajectory: differentiate, solve the inverse
+   * dynamics of every slice, and fall back to the full solve from there if
+   * limits are violated.
+   * @param kinematics  result of the first stage
+   * @param objectives  costs and boundary conditions of the full solve
+   */
+  TwoStageResult plan(const gtsam::Values &kinematics,
+                      const gtsam::NonlinearFactorGraph &objectives =
+                          gtsam::NonlinearFactorGraph()) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,350 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WholeBodyController.cpp
+ * @brief Whole-body inverse dynamics QP with a warm-started active-set
+ * solver.
+ */
+
+#include <gtdynamics/dynamics/WholeBodyController.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+// Inequality rows per contact: four pyramid faces and two normal bounds.
+static constexpr size_t kContactRows = 6;
+
+// Smallest pivot of the Schur complement, relative to its diagonal.
+static constexpr double kPivotTolerance = 1e-12;
+
+static constexpr double kInfinity = std::numeric_limits<double>::infinity();
+static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+/* ************************************************************************* */
+WholeBodyController::WholeBodyController(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const std::vector<WholeBodyContact> &contacts,
+    const WholeBodyParams &params)
+    : dynamics_(robot, gravity),
+      contacts_(contacts),
+      active_(contacts.size(), true),
+      params_(params) {
+  const size_t J = dynamics_.numJoints(), K = contacts.size();
+  for (const WholeBodyContact &contact : contacts) {
+    if (contact.up_axis < 0 || contact.up_axis > 2) {
+      throw std::invalid_argument("WholeBodyController: bad up axis.");
+    }
+    contact_links_.push_back(dynamics_.linkIndex(contact.link));
+  }
+  if (params.torque_limits.size() == 0) {
+    torque_limits_.resize(J);
+    for (size_t j = 0; j < J; j++) {
+      torque_limits_(j) = dynamics_.joints()[j]->parameters().torque_limit;
+    }
+  } else if (size_t(params.torque_limits.size()) == J) {
+    torque_limits_ = params.torque_limits;
+  } else {
+    throw std::invalid_argument(
+        "WholeBodyController: one torque limit per joint expected.");
+  }
+  if (!(params.acceleration_weight > 0 && params.force_weight > 0)) {
+    throw std::invalid_argument("WholeBodyController: weights must be > 0.");
+  }
+
+  nv_ = dynamics_.numDofs();
+  nx_ = nv_ + 3 * K;
+  n_eq_ = dynamics_.rootDofs() + 3 * K;
+  n_in_ = kContactRows * K + 2 * J;
+  const size_t n_rows = n_eq_ + n_in_;
+
+  h_inv_.resize(nx_);
+  h_inv_.head(nv_).setConstant(1 / params.acceleration_weight);
+  h_inv_.tail(3 * K).setConstant(1 / params.force_weight);
+  x_ref_.setZero(nx_);
+  x_.setZero(nx_);
+  z_.setZero(nx_);
+  A_.setZero(n_rows, nx_);
+  b_.setZero(n_rows);
+  J_contacts_.setZero(3 * K, nv_);
+  working_.reserve(n_in_);
+  in_working_.assign(n_rows, false);
+  lambda_.setZero(n_rows);
+  y_.setZero(n_rows);
+  r_.setZero(n_rows);
+  L_.setZero(n_rows, n_rows);
+
+  command_.torques.setZero(J);
+  command_.accelerations.setZero(nv_);
+  command_.forces.setZero(3 * K);
+}
+
+/* ************************************************************************* */
+void WholeBodyController::buildQP(const Vector &a_des) {
+  const size_t J = dynamics_.numJoints(), K = contacts_.size();
+  const size_t rd = dynamics_.rootDofs();
+  const Matrix &M = dynamics_.massMatrix();
+  const Vector &C = dynamics_.biasForces();
+  const TreeDynamicsResult &kinematics = dynamics_.kinematics();
+
+  // World-frame point Jacobians of the contacts.
+  for (size_t k = 0; k < K; k++) {
+    const size_t i = contact_links_[k];
+    gtsam::Matrix36 H;
+    H << -gtsam::skewSymmetric(contacts_[k].point), gtsam::I_3x3;
+    const gtsam::Matrix36 RH =
+        kinematics.poses[i].rotation().matrix() * H;
+    J_contacts_.middleRows<3>(3 * k).noalias() =
+        RH * dynamics_.linkJacobian(i);
+  }
+
+  x_ref_.head(nv_) = a_des;
+  A_.setZero();
+  b_.setZero();
+
+  // Root rows of the equations of motion: M_u a - J_u^T f = -C_u.
+  size_t row = 0;
+  if (rd > 0) {
+    A_.block(0, 0, rd, nv_) = M.topRows(rd);
+    A_.block(0, nv_, rd, 3 * K) = -J_contacts_.leftCols(rd).transpose();
+    b_.head(rd) = -C.head(rd);
+    row = rd;
+  }
+
+  // Contact accelerations, or zero forces of inactive contacts.
+  for (size_t k = 0; k < K; k++, row += 3) {
+    if (active_[k]) {
+      A_.block(row, 0, 3, nv_) = J_contacts_.middleRows<3>(3 * k);
+      b_.segment<3>(row) = -dynamics_.pointBiasAcceleration(
+          contact_links_[k], contacts_[k].point);
+    } else {
+      A_.block<3, 3>(row, nv_ + 3 * k).setIdentity();
+    }
+  }
+
+  // Friction pyramids and normal force bounds, never violated if inactive.
+  for (size_t k = 0; k < K; k++, row += kContactRows) {
+    if (!active_[k]) {
+      b_.segment<kContactRows>(row).setConstant(kInfinity);
+      continue;
+    }
+    const WholeBodyContact &contact = contacts_[k];
+    const size_t n = nv_ + 3 * k + contact.up_axis;
+    const size_t t1 = nv_ + 3 * k + (contact.up_axis + 1) % 3;
+    const size_t t2 = nv_ + 3 * k + (contact.up_axis + 2) % 3;
+    const double mu = contact.mu / std::sqrt(2.0);
+    size_t face = row;
+    for (size_t t : {t1, t2}) {
+      for (double sign : {1.0, -1.0}) {
+        A_(face, t) = sign;
+        A_(face, n) = -mu;
+        face++;
+      }
+    }
+    A_(face, n) = -1;
+    b_(face) = -contact.min_force;
+    A_(face + 1, n) = 1;
+    b_(face + 1) = contact.max_force;
+  }
+
+  // Torque limits, with tau = M_a a + C_a - J_a^T f.
+  for (size_t j = 0; j < J; j++, row += 2) {
+    const size_t d = rd + j;
+    A_.block(row, 0, 1, nv_) = M.row(d);
+    A_.block(row, nv_, 1, 3 * K) = -J_contacts_.col(d).transpose();
+    A_.row(row + 1) = -A_.row(row);
+    b_(row) = torque_limits_(j) - C(d);
+    b_(row + 1) = torque_limits_(j) + C(d);
+  }
+}
+
+/* ************************************************************************* */
+bool WholeBodyController::factor() {
+  const size_t m = numWorking();
+  for (size_t i = 0; i < m; i++) {
+    const auto a_i = A_.row(workingRow(i));
+    for (size_t j = 0; j <= i; j++) {
+      double s = (a_i.transpose().cwiseProduct(h_inv_))
+                     .dot(A_.row(workingRow(j)).transpose());
+      for (size_t k = 0; k < j; k++) s -= L_(i, k) * L_(j, k);
+      if (i == j) {
+        const double scale = 1 + a_i.squaredNorm() * h_inv_.maxCoeff();
+        if (!(s > kPivotTolerance * scale)) return factored_ = false;
+        L_(i, i) = std::sqrt(s);
+      } else {
+        L_(i, j) = s / L_(j, j);
+      }
+    }
+  }
+  return factored_ = true;
+}
+
+/* ************************************************************************* */
+void WholeBodyController::solveFactored() {
+  const size_t m = numWorking();
+  for (size_t i = 0; i < m; i++) {
+    for (size_t k = 0; k < i; k++) y_(i) -= L_(i, k) * y_(k);
+    y_(i) /= L_(i, i);
+  }
+  for (size_t i = m; i-- > 0;) {
+    for (size_t k = i + 1; k < m; k++) y_(i) -= L_(k, i) * y_(k);
+    y_(i) /= L_(i, i);
+  }
+}
+
+/* ************************************************************************* */
+void WholeBodyController::solveWorking() {
+  // lambda = S^-1 (A_W x_ref - b_W), x = x_ref - H^-1 A_W^T lambda.
+  const size_t m = numWorking();
+  for (size_t k = 0; k < m; k++) {
+    const size_t i = workingRow(k);
+    y_(k) = A_.row(i).dot(x_ref_) - b_(i);
+  }
+  solveFactored();
+  x_ = x_ref_;
+  for (size_t k = 0; k < m; k++) {
+    lambda_(k) = y_(k);
+    x_ -= y_(k) * h_inv_.cwiseProduct(A_.row(workingRow(k)).transpose());
+  }
+}
+
+/* ************************************************************************* */
+void WholeBodyController::dropWorking(size_t k) {
+  const size_t m = numWorking();
+  in_working_[working_[k - n_eq_]] = false;
+  working_.erase(working_.begin() + (k - n_eq_));
+  for (size_t i = k; i + 1 < m; i++) lambda_(i) = lambda_(i + 1);
+  factored_ = false;
+}
+
+/* ************************************************************************* */
+void WholeBodyController::solveQP() {
+  const double tol = params_.tolerance;
+  size_t &iterations = command_.iterations;
+  iterations = 0;
+  command_.converged = false;
+
+  // Warm start: drop constraints that cannot be active anymore, then those
+  // with negative multipliers, to start from a dual feasible point.
+  for (size_t k = numWorking(); k-- > n_eq_;) {
+    if (!std::isfinite(b_(working_[k - n_eq_]))) dropWorking(k);
+  }
+  while (true) {
+    if (!factor()) {
+      while (!working_.empty()) dropWorking(numWorking() - 1);
+      if (!factor()) return;  // dependent equalities
+    }
+    solveWorking();
+    size_t worst = kNone;
+    double most_negative = -tol;
+    for (size_t k = n_eq_; k < numWorking(); k++) {
+      if (lambda_(k) < most_negative) {
+        most_negative = lambda_(k);
+        worst = k;
+      }
+    }
+    if (worst == kNone) break;
+    dropWorking(worst);
+    iterations++;
+  }
+
+  while (iterations < params_.max_iterations) {
+    // Most violated inequality.
+    size_t p = kNone;
+    double violation = tol;
+    for (size_t i = n_eq_; i < n_eq_ + n_in_; i++) {
+      if (in_working_[i]) continue;
+      const double s = A_.row(i).dot(x_) - b_(i);
+      if (s > violation) {
+        violation = s;
+        p = i;
+      }
+    }
+    if (p == kNone) {
+      command_.converged = true;
+      return;
+    }
+
+    // Raise the multiplier of p until p is satisfied, dropping working
+    // constraints whose multipliers reach zero on the way.
+    double lambda_p = 0;
+    while (true) {
+      if (!factored_ && !factor()) return;
+      const auto a_p = A_.row(p).transpose();
+      const size_t m = numWorking();
+
+      // Directions: S r = -A_W H^-1 a_p, z = -H^-1 (a_p + A_W^T r).
+      for (size_t k = 0; k < m; k++) {
+        y_(k) = -A_.row(workingRow(k)).dot(h_inv_.cwiseProduct(a_p));
+      }
+      solveFactored();
+      z_ = -h_inv_.cwiseProduct(a_p);
+      for (size_t k = 0; k < m; k++) {
+        r_(k) = y_(k);
+        z_ -= y_(k) * h_inv_.cwiseProduct(A_.row(workingRow(k)).transpose());
+      }
+      const double slope = -a_p.dot(z_);
+      const double s = a_p.dot(x_) - b_(p);
+      const double t_full = slope > tol ? s / slope : kInfinity;
+      double t_partial = kInfinity;
+      size_t blocking = kNone;
+      for (size_t k = n_eq_; k < m; k++) {
+        if (r_(k) < 0 && -lambda_(k) / r_(k) < t_partial) {
+          t_partial = -lambda_(k) / r_(k);
+          blocking = k;
+        }
+      }
+      const double t = std::min(t_full, t_partial);
+      if (!std::isfinite(t)) return;  // infeasible
+
+      x_ += t * z_;
+      for (size_t k = 0; k < m; k++) lambda_(k) += t * r_(k);
+      lambda_p += t;
+      iterations++;
+      if (t_full <= t_partial) {
+        working_.push_back(p);
+        in_working_[p] = true;
+        lambda_(m) = lambda_p;
+        factored_ = false;
+        break;
+      }
+      dropWorking(blocking);
+      if (iterations >= params_.max_iterations) return;
+    }
+  }
+}
+
+/* ************************************************************************* */
+const WholeBodyCommand &WholeBodyController::compute(
+    const Vector &q, const Vector &v, const Vector &a_des,
+    const gtsam::Pose3 &wTroot, const gtsam::Vector6 &V_root) {
+  if (size_t(a_des.size()) != nv_) {
+    throw std::invalid_argument(
+        "WholeBodyController: a_des must have numDofs() entries.");
+  }
+  dynamics_.update(q, v, wTroot, V_root);
+  buildQP(a_des);
+  solveQP();
+
+  // tau = M_a a + C_a - J_a^T f.
+  const size_t J = dynamics_.numJoints();
+  command_.accelerations = x_.head(nv_);
+  command_.forces = x_.tail(nx_ - nv_);
+  command_.torques.noalias() =
+      dynamics_.massMatrix().bottomRows(J) * command_.accelerations;
+  command_.torques += dynamics_.biasForces().tail(J);
+  command_.torques.noalias() -=
+      J_contacts_.rightCols(J).transpose() * command_.forces;
+  return command_;
+}
+
+}  // namespace gtdynamics
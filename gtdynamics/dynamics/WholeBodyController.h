@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WholeBodyController.h
+ * @brief Whole-body inverse dynamics QP with a warm-started active-set
+ * solver.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/RigidBodyDynamics.h>
+#include <gtdynamics/factors/ContactDynamicsFrictionConeFactor.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// A point contact of WholeBodyController, with its friction cone.
+struct WholeBodyContact {
+  std::string link;        ///< name of the link in contact
+  gtsam::Point3 point;     ///< contact point, in the link CoM frame
+  double mu = 1.0;         ///< static friction coefficient
+  int up_axis = 2;         ///< world axis of the contact normal
+  double min_force = 0.0;  ///< smallest normal force
+  double max_force = std::numeric_limits<double>::infinity();
+
+  /// Constructor.
+  WholeBodyContact(const std::string &link, const gtsam::Point3 &point,
+                   double mu = 1.0, int up_axis = 2)
+      : link(link), point(point), mu(mu), up_axis(up_axis) {}
+
+  /// Constructor, with the friction cone of a planning factor.
+  WholeBodyContact(const std::string &link, const gtsam::Point3 &point,
+                   const ContactDynamicsFrictionConeFactor &cone)
+      : WholeBodyContact(link, point, cone.mu(), cone.upAxis()) {}
+};
+
+/// Parameters of WholeBodyController.
+struct WholeBodyParams {
+  double acceleration_weight = 1.0;  ///< weight of the acceleration error
+  double force_weight = 1e-4;        ///< weight of the contact forces
+  gtsam::Vector torque_limits;       ///< per joint, joint parameters if empty
+  size_t max_iterations = 100;       ///< active set changes per tick
+  double tolerance = 1e-9;           ///< constraint violation tolerance
+};
+
+/// Result of a tick of WholeBodyController.
+struct WholeBodyCommand {
+  gtsam::Vector torques;        ///< joint torques, ordered as robot.joints()
+  gtsam::Vector accelerations;  ///< generalized accelerations
+  gtsam::Vector forces;         ///< world-frame forces, 3 per contact
+  size_t iterations = 0;        ///< active set changes
+  bool converged = false;       ///< false if infeasible or out of iterations
+};
+
+/**
+ * WholeBodyController computes the joint torques that track desired
+ * generalized accelerations a_des of a tree robot, with the rigid body terms
+ * of RigidBodyDynamics, by solving at each tick the QP
+ *
+ *   min  w_a ||a - a_des||^2 + w_f ||f||^2
+ *   s.t. M a + C = S^T tau + sum_k J_k^T f_k   (root rows with tau = 0)
+ *        J_k a + J_dot_k v = 0                 (active contacts)
+ *        f_k = 0                               (inactive contacts)
+ *        f_k in the friction pyramid of contact k, min <= f_n <= max
+ *        |tau| <= torque limits
+ *
+ * over a and the world-frame contact forces f, with the torques affine in
+ * both. The friction pyramid is the one inscribed in the cone of
+ * ContactDynamicsFrictionConeFactor, with faces at mu / sqrt(2).
+ *
+ * The QP has a diagonal Hessian, so it is solved with the dual active-set
+ * method of Goldfarb and Idnani on the Schur complement of the working
+ * constraints, which is refactored in place at each active set change. The
+ * solve starts from the active set of the previous tick, so that a steady
+ * tick typically changes none. All buffers are sized at construction and
+ * contacts are switched on and off without changing the QP structure, so
+ * ticks do not allocate.
+ */
+class WholeBodyController {
+ private:
+  RigidBodyDynamics dynamics_;
+  std::vector<WholeBodyContact> contacts_;
+  std::vector<size_t> contact_links_;  // link indices in dynamics_
+  std::vector<bool> active_;
+  WholeBodyParams params_;
+  gtsam::Vector torque_limits_;
+
+  // QP: min 1/2 (x - x_ref)^T diag(h) (x - x_ref) s.t. rows of A x (= or <=)
+  // b, with x = [a; f] and the n_eq_ equalities first.
+  size_t nv_, nx_, n_eq_, n_in_;
+  gtsam::Vector h_inv_, x_ref_, x_, b_;
+  gtsam::Matrix A_, J_contacts_;
+
+  // Working set, the inequality rows after the equalities, and multipliers.
+  std::vector<size_t> working_;
+  std::vector<bool> in_working_;
+  gtsam::Vector lambda_, y_, r_, z_;
+  gtsam::Matrix L_;  // Cholesky factor of the working Schur complement
+  bool factored_ = false;
+
+  WholeBodyCommand command_;
+
+  // Return the number of working constraints, equalities included.
+  size_t numWorking() const { return n_eq_ + working_.size(); }
+
+  // Return the row of A_ of working constraint k.
+  size_t workingRow(size_t k) const {
+    return k < n_eq_ ? k : working_[k - n_eq_];
+  }
+
+  // Fill A_, b_ and x_ref_ at the current state.
+  void buildQP(const gtsam::Vector &a_des);
+
+  // Factor the Schur complement of the working set, false if singular.
+  bool factor();
+
+  // Solve L L^T u = y_ in place, for the first numWorking() entries.
+  void solveFactored();
+
+  // Minimize over the working set, setting x_ and lambda_.
+  void solveWorking();
+
+  // Remove working constraint k, with its multiplier.
+  void dropWorking(size_t k);
+
+  // Solve the QP from the working set of the previous tick.
+  void solveQP();
+
+ public:
+  /**
+   * Constructor
+   * @param robot     the robot, must be a tree
+   * @param gravity   gravity in world frame
+   * @param contacts  all contacts that may be active, see setContactActive
+   * @param params    weights, torque limits and solver parameters
+   */
+  WholeBodyController(const Robot &robot,
+                      const boost::optional<gtsam::Vector3> &gravity,
+                      const std::vector<WholeBodyContact> &contacts,
+                      const WholeBodyParams &params = WholeBodyParams());
+
+  /// Return the rigid body dynamics, at the state of the last tick.
+  const RigidBodyDynamics &dynamics() const { return dynamics_; }
+
+  /// Return the contacts.
+  const std::vector<WholeBodyContact> &contacts() const { return contacts_; }
+
+  /// Switch contact i on or off, all are active after construction.
+  void setContactActive(size_t i, bool active) { active_.at(i) = active; }
+
+  /// Return whether contact i is active.
+  bool contactActive(size_t i) const { return active_.at(i); }
+
+  /// Return the active inequalities of the last tick, rows of the QP.
+  const std::vector<size_t> &activeSet() const { return working_; }
+
+  /**
+   * Compute the torques of a control tick.
+   * @param q       joint angles, ordered as robot.joints()
+   * @param v       joint velocities, ordered as robot.joints()
+   * @param a_des   desired generalized accelerations, root twist
+   *                acceleration first for a floating base
+   * @param wTroot  pose of the root link CoM (ignored if the root is fixed)
+   * @param V_root  twist of the root link (ignored if the root is fixed)
+   * @return the command, valid until the next tick
+   */
+  const WholeBodyCommand &compute(
+      const gtsam::Vector &q, const gtsam::Vector &v,
+      const gtsam::Vector &a_des, const gtsam::Pose3 &wTroot = gtsam::Pose3(),
+      const gtsam::Vector6 &V_root = gtsam::Vector6::Zero());
+};
+
+}  // namespace gtdynamics
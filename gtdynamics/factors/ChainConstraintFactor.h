@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainConstraintFactor.h
+ * @brief Chain constraint tau = J^T * F as a factor, for any chain length.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ChainConstraintFactor is the factor version of Chain::ChainConstraint3 for
+ * a chain of any length: it relates the wrench applied on the body by the
+ * chain to the joint angles and torques, with Chain::DynamicalEquality<N>.
+ *
+ * N is the number of joints, for which fixed-size Jacobians are used. N must
+ * be one of the instantiated sizes 3, 4, 6, 7, or Eigen::Dynamic (default).
+ *
+ * Keys are ordered as: wrench, joint angles, joint torques.
+ */
+template <int N = Eigen::Dynamic>
+class ChainConstraintFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = ChainConstraintFactor<N>;
+  using Base = gtsam::NoiseModelFactor;
+  using VectorN = Eigen::Matrix<double, N, 1>;
+  using WrenchJacobian =
+      typename std::conditional<N == Eigen::Dynamic, gtsam::Matrix,
+                                Eigen::Matrix<double, N, 6>>::type;
+
+  Chain chain_;
+
+  /// Return all keys of the factor.
+  static gtsam::KeyVector Keys(const std::vector<JointSharedPtr> &joints,
+                               gtsam::Key wrench_key, size_t k) {
+    gtsam::KeyVector keys{wrench_key};
+    for (auto &&joint : joints) keys.push_back(JointAngleKey(joint->id(), k));
+    for (auto &&joint : joints) keys.push_back(TorqueKey(joint->id(), k));
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model The noise model for this factor.
+   * @param chain The composed chain, one column of axes per joint.
+   * @param joints Joints of the chain, in the order of the chain axes.
+   * @param wrench_key Key of the wrench applied on the body by the joint
+   * closest to the body.
+   * @param k Time slice.
+   */
+  ChainConstraintFactor(const gtsam::SharedNoiseModel &cost_model,
+                        const Chain &chain,
+                        const std::vector<JointSharedPtr> &joints,
+                        gtsam::Key wrench_key, size_t k)
+      : Base(cost_model, Keys(joints, wrench_key, k)), chain_(chain) {
+    if (chain.length() != joints.size() ||
+        (N != Eigen::Dynamic && joints.size() != size_t(N))) {
+      throw std::invalid_argument(
+          "ChainConstraintFactor: chain length and joints do not match.");
+    }
+  }
+
+  virtual ~ChainConstraintFactor() {}
+
+  /// Return the chain.
+  const Chain &chain() const { return chain_; }
+
+  /**
+   * Evaluate torque error, J^T * F - tau.
+   * @param x Values containing the wrench, joint angles and torques.
+   * @param H (optional) Jacobians, in key order.
+   */
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override {
+    const size_t n = chain_.length();
+    const gtsam::Vector6 wrench = x.at<gtsam::Vector6>(keys_[0]);
+    VectorN angles(n), torques(n);
+    for (size_t i = 0; i < n; i++) {
+      angles(i) = x.at<double>(keys_[1 + i]);
+      torques(i) = x.at<double>(keys_[1 + n + i]);
+    }
+
+    if (!H) return chain_.DynamicalEquality<N>(wrench, angles, torques);
+
+    WrenchJacobian H_wrench(n, 6);
+    Eigen::Matrix<double, N, N> H_angles(n, n), H_torques(n, n);
+    const VectorN error = chain_.DynamicalEquality<N>(
+        wrench, angles, torques, H_wrench, H_angles, H_torques);
+    H->resize(size());
+    (*H)[0] = H_wrench;
+    for (size_t i = 0; i < n; i++) {
+      (*H)[1 + i] = H_angles.col(i);
+      (*H)[1 + n + i] = H_torques.col(i);
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "ChainConstraintFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+}  // namespace gtdynamics
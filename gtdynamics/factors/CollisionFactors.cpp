@@ -0,0 +1,175 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionFactors.cpp
+ * @brief Signed-distance collision avoidance factors.
+ */
+
+#include <gtdynamics/factors/CollisionFactors.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <map>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+SelfCollisionFactor::SelfCollisionFactor(
+    const gtsam::KeyVector &pose_keys, const std::vector<Capsule> &capsules,
+    const std::vector<std::pair<size_t, size_t>> &excluded, double margin,
+    double sigma)
+    : Base(pose_keys),
+      capsules_(capsules),
+      margin_(margin),
+      sigma_(sigma) {
+  if (capsules.size() != pose_keys.size()) {
+    throw std::invalid_argument(
+        "SelfCollisionFactor: need one capsule per pose key.");
+  }
+  if (!(sigma > 0)) {
+    throw std::invalid_argument("SelfCollisionFactor: sigma must be positive.");
+  }
+  for (auto &&pair : excluded) {
+    if (pair.first == pair.second) continue;
+    excluded_.emplace_back(std::min(pair.first, pair.second),
+                           std::max(pair.first, pair.second));
+  }
+  std::sort(excluded_.begin(), excluded_.end());
+  excluded_.erase(std::unique(excluded_.begin(), excluded_.end()),
+                  excluded_.end());
+}
+
+/* ************************************************************************* */
+std::vector<SelfCollisionFactor::NearPair> SelfCollisionFactor::nearPairs(
+    const Values &values) const {
+  std::vector<Capsule> world;
+  world.reserve(capsules_.size());
+  for (size_t i = 0; i < capsules_.size(); i++) {
+    world.push_back(capsules_[i].transformFrom(values.at<Pose3>(keys_[i])));
+  }
+
+  std::vector<NearPair> pairs;
+  for (auto &&candidate : CapsuleBVH(world, margin_).candidatePairs()) {
+    if (std::binary_search(excluded_.begin(), excluded_.end(), candidate)) {
+      continue;
+    }
+    const Capsule &A = world[candidate.first], &B = world[candidate.second];
+    double s, t;
+    const double distance =
+        SegmentClosestPoints(A.a, A.b, B.a, B.b, &s, &t) - A.radius -
+        B.radius;
+    if (distance < margin_) {
+      pairs.emplace_back(candidate.first, candidate.second, s, t, distance);
+    }
+  }
+  return pairs;
+}
+
+/* ************************************************************************* */
+double SelfCollisionFactor::error(const Values &values) const {
+  double error = 0.0;
+  for (auto &&pair : nearPairs(values)) {
+    const double whitened = (margin_ - pair.distance) / sigma_;
+    error += 0.5 * whitened * whitened;
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+size_t SelfCollisionFactor::dim() const {
+  const size_t n = capsules_.size();
+  return n * (n - 1) / 2 - excluded_.size();
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> SelfCollisionFactor::linearize(
+    const Values &values) const {
+  const std::vector<NearPair> pairs = nearPairs(values);
+  if (pairs.empty()) return boost::shared_ptr<gtsam::GaussianFactor>();
+
+  // One row per pair, one block per capsule in any pair.
+  const Eigen::Index rows = pairs.size();
+  std::map<size_t, Matrix> blocks;
+  Vector b(rows);
+  for (Eigen::Index r = 0; r < rows; r++) {
+    const NearPair &pair = pairs[r];
+    const Pose3 &wTa = values.at<Pose3>(keys_[pair.i]);
+    const Pose3 &wTb = values.at<Pose3>(keys_[pair.j]);
+    gtsam::Matrix36 H_a, H_b;
+    const Point3 pa = wTa.transformFrom(capsules_[pair.i].point(pair.s), H_a);
+    const Point3 pb = wTb.transformFrom(capsules_[pair.j].point(pair.t), H_b);
+
+    // The closest points are kept fixed, which gives the exact gradient of
+    // the distance wherever they are unique.
+    const Point3 delta = pa - pb;
+    const double norm = delta.norm();
+    const Point3 n = norm > 1e-9 ? Point3(delta / norm) : Point3(0, 0, 1);
+
+    for (auto &&index : {pair.i, pair.j}) {
+      if (!blocks.count(index)) blocks[index] = Matrix::Zero(rows, 6);
+    }
+    blocks[pair.i].row(r) = -n.transpose() * H_a / sigma_;
+    blocks[pair.j].row(r) = n.transpose() * H_b / sigma_;
+    b(r) = -(margin_ - pair.distance) / sigma_;
+  }
+
+  std::vector<std::pair<Key, Matrix>> terms;
+  for (auto &&block : blocks) {
+    terms.emplace_back(keys_[block.first], block.second);
+  }
+  return boost::make_shared<gtsam::JacobianFactor>(terms, b);
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph CollisionFactors(
+    const Robot &robot, const CollisionParameters &parameters,
+    const SignedDistanceFieldPtr &sdf, int k) {
+  const std::vector<LinkCapsule> link_capsules =
+      LinkCapsules(robot, parameters.radius);
+
+  gtsam::KeyVector keys;
+  std::vector<Capsule> capsules;
+  std::map<int, size_t> index_of;
+  for (auto &&link_capsule : link_capsules) {
+    index_of[link_capsule.link_id] = capsules.size();
+    keys.push_back(PoseKey(link_capsule.link_id, k));
+    capsules.push_back(link_capsule.capsule);
+  }
+  std::vector<std::pair<size_t, size_t>> excluded;
+  for (auto &&pair : AdjacentLinks(robot)) {
+    excluded.emplace_back(index_of.at(pair.first), index_of.at(pair.second));
+  }
+
+  gtsam::NonlinearFactorGraph graph;
+  if (capsules.size() > 1) {
+    graph.emplace_shared<SelfCollisionFactor>(
+        keys, capsules, excluded, parameters.margin, parameters.sigma);
+  }
+  if (sdf) {
+    const auto model =
+        gtsam::noiseModel::Isotropic::Sigma(parameters.samples,
+                                            parameters.sigma);
+    for (size_t i = 0; i < capsules.size(); i++) {
+      graph.emplace_shared<ObstacleCollisionFactor>(keys[i], model,
+                                                    capsules[i], sdf,
+                                                    parameters.margin);
+    }
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionFactors.h
+ * @brief Signed-distance collision avoidance factors.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/CollisionGeometry.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/SignedDistanceField.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ObstacleCollisionFactor is a unary factor which keeps a link capsule out of
+ * the obstacles of a static environment, given by a SignedDistanceField. The
+ * capsule axis is sampled at evenly spaced points, and the error at each is
+ * the hinge loss max(0, margin + radius - sdf(p)), zero once the capsule is
+ * farther than the margin from all obstacles.
+ */
+class ObstacleCollisionFactor
+    : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
+ private:
+  using This = ObstacleCollisionFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Pose3>;
+
+  Capsule capsule_;
+  SignedDistanceFieldPtr sdf_;
+  double margin_;
+
+ public:
+  /**
+   * Constructor
+   * @param pose_key    key of the link CoM pose
+   * @param cost_model  noise model, of dimension the number of samples
+   * @param capsule     capsule of the link, in its CoM frame
+   * @param sdf         the shared distance field of the environment
+   * @param margin      distance to keep from obstacles
+   */
+  ObstacleCollisionFactor(gtsam::Key pose_key,
+                          const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                          const Capsule &capsule,
+                          const SignedDistanceFieldPtr &sdf, double margin)
+      : Base(cost_model, pose_key),
+        capsule_(capsule),
+        sdf_(sdf),
+        margin_(margin) {
+    if (!sdf_) {
+      throw std::invalid_argument("ObstacleCollisionFactor: no field.");
+    }
+  }
+
+  virtual ~ObstacleCollisionFactor() {}
+
+  /// Return the number of samples along the capsule axis.
+  size_t samples() const { return dim(); }
+
+  /**
+   * Evaluate the hinge loss at each sample.
+   * @param pose CoM pose of the link.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none) const override {
+    const size_t n = samples();
+    gtsam::Vector error = gtsam::Vector::Zero(n);
+    if (H_pose) *H_pose = gtsam::Matrix::Zero(n, 6);
+    gtsam::Matrix36 H_point;
+    gtsam::Matrix13 H_sdf;
+    for (size_t i = 0; i < n; i++) {
+      const double s = n > 1 ? double(i) / (n - 1) : 0.5;
+      const gtsam::Point3 p = pose.transformFrom(capsule_.point(s),
+                                                 H_pose ? &H_point : nullptr);
+      const double hinge = margin_ + capsule_.radius -
+                           sdf_->distance(p, H_pose ? &H_sdf : nullptr);
+      if (hinge <= 0) continue;
+      error(i) = hinge;
+      if (H_pose) H_pose->row(i) = -H_sdf * H_point;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor, sharing the field
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "ObstacleCollisionFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * SelfCollisionFactor keeps the capsules of the links of a robot apart, on
+ * the CoM poses of all links at one time step. For each pair closer than the
+ * margin, the error is the hinge loss margin - d, with d the distance between
+ * the capsules, whitened by sigma.
+ *
+ * The pairs are found at each linearization with a CapsuleBVH over the
+ * capsules at the linearization point, so the cost grows with the number of
+ * nearby pairs, not with the square of the number of links. Only the nearby
+ * pairs contribute rows and keys to the linear factor, and the linear factor
+ * is null when there are none, so pairs far apart do not couple poses in the
+ * elimination. Pairs of links connected by a joint are excluded.
+ */
+class SelfCollisionFactor : public gtsam::NonlinearFactor {
+ private:
+  using This = SelfCollisionFactor;
+  using Base = gtsam::NonlinearFactor;
+
+  std::vector<Capsule> capsules_;  // in the CoM frame, one per key
+  std::vector<std::pair<size_t, size_t>> excluded_;  // sorted, i < j
+  double margin_, sigma_;
+
+ public:
+  /// A pair of capsules closer than the margin.
+  struct NearPair {
+    size_t i, j;    // capsule indices, i < j
+    double s, t;    // closest points along each axis
+    double distance;
+
+    NearPair(size_t i, size_t j, double s, double t, double distance)
+        : i(i), j(j), s(s), t(t), distance(distance) {}
+  };
+
+  /**
+   * Constructor
+   * @param pose_keys  keys of the CoM poses, one per capsule
+   * @param capsules   capsules, in the CoM frame of their link
+   * @param excluded   pairs of capsule indices to ignore
+   * @param margin     distance to keep between capsules
+   * @param sigma      standard deviation of the hinge loss
+   */
+  SelfCollisionFactor(const gtsam::KeyVector &pose_keys,
+                      const std::vector<Capsule> &capsules,
+                      const std::vector<std::pair<size_t, size_t>> &excluded,
+                      double margin, double sigma);
+
+  virtual ~SelfCollisionFactor() {}
+
+  /// Return the pairs closer than the margin at the given values.
+  std::vector<NearPair> nearPairs(const gtsam::Values &values) const;
+
+  /// Return half the sum of the squared, whitened hinge losses.
+  double error(const gtsam::Values &values) const override;
+
+  /// Return the number of pairs that may collide, an upper bound on the rows.
+  size_t dim() const override;
+
+  /// Linearize the nearby pairs, null when there are none.
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &values) const override;
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "SelfCollisionFactor, margin "
+              << margin_ << ", sigma " << sigma_ << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/// Parameters of CollisionFactors.
+struct CollisionParameters {
+  double radius = 0.05;    ///< radius of the link capsules
+  double margin = 0.02;    ///< distance to keep between and around capsules
+  double sigma = 0.01;     ///< standard deviation of the hinge losses
+  size_t samples = 5;      ///< samples along each capsule for obstacles
+
+  CollisionParameters() {}
+};
+
+/**
+ * Return the collision avoidance factors of a robot at one time step: one
+ * SelfCollisionFactor over all links, and an ObstacleCollisionFactor per link
+ * if an environment is given. Links are approximated by LinkCapsules.
+ * @param robot       the robot
+ * @param parameters  capsule radius, margin and noise
+ * @param sdf         optional distance field of a static environment
+ * @param k           time step
+ */
+gtsam::NonlinearFactorGraph CollisionFactors(
+    const Robot &robot,
+    const CollisionParameters &parameters = CollisionParameters(),
+    const SignedDistanceFieldPtr &sdf = nullptr, int k = 0);
+
+}  // namespace gtdynamics
@@ -13,13 +13,16 @@
 
 #pragma once
 
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/OptionalJacobian.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
 
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -30,22 +33,44 @@ namespace gtdynamics {
  *
  * @return pose_t1 link pose at next time step
  */
-gtsam::Pose3 predictPose(
+inline gtsam::Pose3 predictPose(
     const gtsam::Pose3 &pose_t0, const gtsam::Vector6 &twistdt,
     gtsam::OptionalJacobian<6, 6> H_pose_t0 = boost::none,
     gtsam::OptionalJacobian<6, 6> H_twistdt = boost::none) {
   gtsam::Matrix6 Hexp;
-  gtsam::Pose3 t1Tt0 = gtsam::Pose3::Expmap(twistdt, Hexp);
+  gtsam::Pose3 t1Tt0 =
+      gtsam::Pose3::Expmap(twistdt, H_twistdt ? &Hexp : nullptr);
 
   gtsam::Matrix6 pose_t1_H_t1Tt0;
   auto pose_t1 =
       pose_t0.compose(t1Tt0, H_pose_t0, H_twistdt ? &pose_t1_H_t1Tt0 : nullptr);
   if (H_twistdt) {
-    *H_twistdt = pose_t1_H_t1Tt0 * (Hexp);
+    *H_twistdt = pose_t1_H_t1Tt0 * Hexp;
   }
   return pose_t1;
 }
 
+/**
+ * Pose collocation error pose_t1.logmap(predictPose(pose_t0, twistdt)), with
+ * fixed-size Jacobians only, shared by the pose collocation factors. As the
+ * factors are at zero error at a solution, the derivative of logmap is taken
+ * there, which makes H_pose_t1 = -I.
+ * @param pose_t0 link pose at current time step
+ * @param pose_t1 link pose at next time step
+ * @param twistdt link twist integrated over the time step
+ */
+inline gtsam::Vector6 poseCollocationError(
+    const gtsam::Pose3 &pose_t0, const gtsam::Pose3 &pose_t1,
+    const gtsam::Vector6 &twistdt,
+    gtsam::OptionalJacobian<6, 6> H_pose_t0 = boost::none,
+    gtsam::OptionalJacobian<6, 6> H_pose_t1 = boost::none,
+    gtsam::OptionalJacobian<6, 6> H_twistdt = boost::none) {
+  const gtsam::Pose3 pose_t1_hat =
+      predictPose(pose_t0, twistdt, H_pose_t0, H_twistdt);
+  if (H_pose_t1) *H_pose_t1 = -gtsam::I_6x6;
+  return pose_t1.logmap(pose_t1_hat);
+}
+
 /**
  * EulerPoseCollocationFactor is a four-way nonlinear factor between link pose of
  * current and next time steps
@@ -64,6 +89,9 @@ class EulerPoseCollocationFactor
                        const gtsam::noiseModel::Base::shared_ptr &cost_model)
       : Base(cost_model, pose_t0_key, pose_t1_key, twist_key, dt_key) {}
 
+  /// Default constructor for serialization.
+  EulerPoseCollocationFactor() {}
+
   virtual ~EulerPoseCollocationFactor() {}
 
   /**
@@ -80,13 +108,11 @@ class EulerPoseCollocationFactor
       boost::optional<gtsam::Matrix &> H_pose_t1 = boost::none,
       boost::optional<gtsam::Matrix &> H_twist = boost::none,
       boost::optional<gtsam::Matrix &> H_dt = boost::none) const override {
-    gtsam::Vector6 twistdt = twist * dt;
+    const gtsam::Vector6 twistdt = twist * dt;
     gtsam::Matrix6 H_twistdt;
-    auto pose_t1_hat = predictPose(pose_t0, twistdt, H_pose_t0, H_twistdt);
-    gtsam::Vector6 error = pose_t1.logmap(pose_t1_hat);
-    if (H_pose_t1) {
-      *H_pose_t1 = -gtsam::I_6x6;
-    }
+    const gtsam::Vector6 error =
+        poseCollocationError(pose_t0, pose_t1, twistdt, H_pose_t0, H_pose_t1,
+                             H_twist || H_dt ? &H_twistdt : nullptr);
     if (H_twist) {
       *H_twist = H_twistdt * dt;
     }
@@ -99,7 +125,7 @@ class EulerPoseCollocationFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -114,7 +140,7 @@ class EulerPoseCollocationFactor
   /// Serialization function
   friend class boost::serialization::access;
   template <class ARCHIVE>
-  void serialize(ARCHIVE const &ar, const unsigned int version) {
+  void serialize(ARCHIVE &ar, const unsigned int version) {
     ar &boost::serialization::make_nvp(
         "NoiseModelFactor4", boost::serialization::base_object<Base>(*this));
   }
@@ -140,6 +166,9 @@ class TrapezoidalPoseCollocationFactor
       : Base(cost_model, pose_t0_key, pose_t1_key, twist_t0_key, twist_t1_key,
              dt_key) {}
 
+  /// Default constructor for serialization.
+  TrapezoidalPoseCollocationFactor() {}
+
   virtual ~TrapezoidalPoseCollocationFactor() {}
 
   /**
@@ -160,13 +189,11 @@ class TrapezoidalPoseCollocationFactor
       boost::optional<gtsam::Matrix &> H_twist_t0 = boost::none,
       boost::optional<gtsam::Matrix &> H_twist_t1 = boost::none,
       boost::optional<gtsam::Matrix &> H_dt = boost::none) const override {
-    gtsam::Vector6 twistdt = 0.5 * dt * (twist_t0 + twist_t1);
+    const gtsam::Vector6 twistdt = 0.5 * dt * (twist_t0 + twist_t1);
     gtsam::Matrix6 H_twistdt;
-    auto pose_t1_hat = predictPose(pose_t0, twistdt, H_pose_t0, H_twistdt);
-    gtsam::Vector6 error = pose_t1.logmap(pose_t1_hat);
-    if (H_pose_t1) {
-      *H_pose_t1 = -gtsam::I_6x6;
-    }
+    const gtsam::Vector6 error = poseCollocationError(
+        pose_t0, pose_t1, twistdt, H_pose_t0, H_pose_t1,
+        H_twist_t0 || H_twist_t1 || H_dt ? &H_twistdt : nullptr);
     if (H_twist_t0) {
       *H_twist_t0 = 0.5 * dt * H_twistdt;
     }
@@ -182,7 +209,7 @@ class TrapezoidalPoseCollocationFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -197,12 +224,141 @@ class TrapezoidalPoseCollocationFactor
   /// Serialization function
   friend class boost::serialization::access;
   template <class ARCHIVE>
-  void serialize(ARCHIVE const &ar, const unsigned int version) {
+  void serialize(ARCHIVE &ar, const unsigned int version) {
     ar &boost::serialization::make_nvp(
         "NoiseModelFactor5", boost::serialization::base_object<Base>(*this));
   }
 };
 
+/**
+ * HermiteSimpsonPoseCollocationFactor is a seven-way nonlinear factor between
+ * link pose of current and next time steps, using twists and twist
+ * accelerations at both steps. With accelerations linearly interpolated, the
+ * compressed Hermite-Simpson rule integrates the twist to
+ * dt / 2 * (twist_t0 + twist_t1) + dt^2 / 12 * (accel_t0 - accel_t1).
+ * Twists are collocated with TrapezoidalTwistCollocationFactor, which is what
+ * Hermite-Simpson reduces to for them.
+ */
+class HermiteSimpsonPoseCollocationFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = HermiteSimpsonPoseCollocationFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  HermiteSimpsonPoseCollocationFactor(
+      gtsam::Key pose_t0_key, gtsam::Key pose_t1_key, gtsam::Key twist_t0_key,
+      gtsam::Key twist_t1_key, gtsam::Key accel_t0_key,
+      gtsam::Key accel_t1_key, gtsam::Key dt_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model,
+             gtsam::KeyVector{pose_t0_key, pose_t1_key, twist_t0_key,
+                              twist_t1_key, accel_t0_key, accel_t1_key,
+                              dt_key}) {}
+
+  /// Default constructor for serialization.
+  HermiteSimpsonPoseCollocationFactor() {}
+
+  virtual ~HermiteSimpsonPoseCollocationFactor() {}
+
+  /**
+   * Evaluate link pose errors
+   *
+   * @param pose_t0 link pose of current step
+   * @param pose_t1 link pose of next step
+   * @param twist_t0 link twist of current step
+   * @param twist_t1 link twist of next step
+   * @param accel_t0 link twist acceleration of current step
+   * @param accel_t1 link twist acceleration of next step
+   * @param dt duration of time step
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose_t0, const gtsam::Pose3 &pose_t1,
+      const gtsam::Vector6 &twist_t0, const gtsam::Vector6 &twist_t1,
+      const gtsam::Vector6 &accel_t0, const gtsam::Vector6 &accel_t1,
+      const double &dt, gtsam::OptionalJacobian<6, 6> H_pose_t0 = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_pose_t1 = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_twist_t0 = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_twist_t1 = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_accel_t0 = boost::none,
+      gtsam::OptionalJacobian<6, 6> H_accel_t1 = boost::none,
+      gtsam::OptionalJacobian<6, 1> H_dt = boost::none) const {
+    const gtsam::Vector6 twistdt = 0.5 * dt * (twist_t0 + twist_t1) +
+                                   dt * dt / 12 * (accel_t0 - accel_t1);
+    gtsam::Matrix6 H_twistdt;
+    const bool need_twistdt =
+        H_twist_t0 || H_twist_t1 || H_accel_t0 || H_accel_t1 || H_dt;
+    const gtsam::Vector6 error =
+        poseCollocationError(pose_t0, pose_t1, twistdt, H_pose_t0, H_pose_t1,
+                             need_twistdt ? &H_twistdt : nullptr);
+    if (H_twist_t0) {
+      *H_twist_t0 = 0.5 * dt * H_twistdt;
+    }
+    if (H_twist_t1) {
+      *H_twist_t1 = 0.5 * dt * H_twistdt;
+    }
+    if (H_accel_t0) {
+      *H_accel_t0 = dt * dt / 12 * H_twistdt;
+    }
+    if (H_accel_t1) {
+      *H_accel_t1 = -dt * dt / 12 * H_twistdt;
+    }
+    if (H_dt) {
+      *H_dt = H_twistdt * (0.5 * (twist_t0 + twist_t1) +
+                           dt / 6 * (accel_t0 - accel_t1));
+    }
+    return error;
+  }
+
+  /// Evaluate the error on values, as NoiseModelFactor needs.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override {
+    const gtsam::KeyVector &k = keys();
+    const gtsam::Pose3 &pose_t0 = x.at<gtsam::Pose3>(k[0]);
+    const gtsam::Pose3 &pose_t1 = x.at<gtsam::Pose3>(k[1]);
+    const gtsam::Vector6 &twist_t0 = x.at<gtsam::Vector6>(k[2]);
+    const gtsam::Vector6 &twist_t1 = x.at<gtsam::Vector6>(k[3]);
+    const gtsam::Vector6 &accel_t0 = x.at<gtsam::Vector6>(k[4]);
+    const gtsam::Vector6 &accel_t1 = x.at<gtsam::Vector6>(k[5]);
+    const double dt = x.at<double>(k[6]);
+    if (!H) {
+      return evaluateError(pose_t0, pose_t1, twist_t0, twist_t1, accel_t0,
+                           accel_t1, dt);
+    }
+    gtsam::Matrix6 H0, H1, H2, H3, H4, H5;
+    gtsam::Vector6 H6;
+    gtsam::Vector error =
+        evaluateError(pose_t0, pose_t1, twist_t0, twist_t1, accel_t0,
+                      accel_t1, dt, H0, H1, H2, H3, H4, H5, H6);
+    *H = {H0, H1, H2, H3, H4, H5, H6};
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Hermite-Simpson collocation factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+};
+
 /**
  * EulerTwistCollocationFactor is a four-way nonlinear factor between link twist of
  * current and next time steps
@@ -221,6 +377,9 @@ class EulerTwistCollocationFactor
                         const gtsam::noiseModel::Base::shared_ptr &cost_model)
       : Base(cost_model, twist_t0_key, twist_t1_key, accel_key, dt_key) {}
 
+  /// Default constructor for serialization.
+  EulerTwistCollocationFactor() {}
+
   virtual ~EulerTwistCollocationFactor() {}
 
   /**
@@ -257,7 +416,7 @@ class EulerTwistCollocationFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -272,7 +431,7 @@ class EulerTwistCollocationFactor
   /// Serialization function
   friend class boost::serialization::access;
   template <class ARCHIVE>
-  void serialize(ARCHIVE const &ar, const unsigned int version) {
+  void serialize(ARCHIVE &ar, const unsigned int version) {
     ar &boost::serialization::make_nvp(
         "NoiseModelFactor4", boost::serialization::base_object<Base>(*this));
   }
@@ -298,6 +457,9 @@ class TrapezoidalTwistCollocationFactor
       : Base(cost_model, twist_t0_key, twist_t1_key, accel_t0_key, accel_t1_key,
              dt_key) {}
 
+  /// Default constructor for serialization.
+  TrapezoidalTwistCollocationFactor() {}
+
   virtual ~TrapezoidalTwistCollocationFactor() {}
 
   /**
@@ -341,7 +503,7 @@ class TrapezoidalTwistCollocationFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -356,7 +518,7 @@ class TrapezoidalTwistCollocationFactor
   /// Serialization function
   friend class boost::serialization::access;
   template <class ARCHIVE>
-  void serialize(ARCHIVE const &ar, const unsigned int version) {
+  void serialize(ARCHIVE &ar, const unsigned int version) {
     ar &boost::serialization::make_nvp(
         "NoiseModelFactor5", boost::serialization::base_object<Base>(*this));
   }
@@ -0,0 +1,130 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompiledExpressionFactor.h
+ * @brief Expression factor whose error Jacobians are accumulated into a
+ * reused block matrix.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/base/VerticalBlockMatrix.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/internal/ExecutionTrace.h>
+#include <gtsam/nonlinear/internal/JacobianMap.h>
+
+#include <boost/serialization/base_object.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CompiledExpressionFactor is a drop-in gtsam::ExpressionFactor whose
+ * unwhitenedError accumulates the reverse-mode Jacobians into a per-thread
+ * block matrix, reused while the factors evaluated on a thread have the same
+ * dimensions, instead of allocating one on every call. Linearization is that
+ * of gtsam::ExpressionFactor, which already writes the Jacobians directly
+ * into the JacobianFactor.
+ *
+ * Being an ExpressionFactor, it is recognized wherever those are, e.g. by
+ * time shifting in SliceTemplate and by MemoryFootprint.
+ */
+template <typename T>
+class CompiledExpressionFactor : public gtsam::ExpressionFactor<T> {
+ private:
+  using This = CompiledExpressionFactor<T>;
+  using Base = gtsam::ExpressionFactor<T>;
+
+  size_t trace_size_ = 0;  ///< Number of trace records of the expression.
+
+  /// Evaluate the expression, accumulating its Jacobians into `jacobians`.
+  T evaluate(const gtsam::Values &x,
+             gtsam::internal::JacobianMap &jacobians) const {
+    // The trace is on the stack, as in gtsam::Expression.
+    using gtsam::internal::ExecutionTraceStorage;
+#ifdef _MSC_VER
+    auto storage = static_cast<ExecutionTraceStorage *>(_aligned_malloc(
+        trace_size_ * sizeof(ExecutionTraceStorage),
+        gtsam::internal::TraceAlignment));
+#else
+    ExecutionTraceStorage storage[trace_size_];
+#endif
+    gtsam::internal::ExecutionTrace<T> trace;
+    const T value =
+        this->expression_.root()->traceExecution(x, trace, storage);
+    trace.startReverseAD1(jacobians);
+#ifdef _MSC_VER
+    _aligned_free(storage);
+#endif
+    return value;
+  }
+
+ protected:
+  /// Default constructor, for serialization.
+  CompiledExpressionFactor() {}
+
+ public:
+  using shared_ptr = boost::shared_ptr<This>;
+
+  /**
+   * Constructor, as gtsam::ExpressionFactor.
+   * @param noise_model  noise model of the error
+   * @param measurement  value the expression should take
+   * @param expression   expression of the variables
+   */
+  CompiledExpressionFactor(const gtsam::SharedNoiseModel &noise_model,
+                           const T &measurement,
+                           const gtsam::Expression<T> &expression)
+      : Base(noise_model, measurement, expression),
+        trace_size_(expression.traceSize()) {}
+
+  ~CompiledExpressionFactor() override {}
+
+  /// Error -Local(h(x), measured) and its Jacobians.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override {
+    if (!H) {
+      return -gtsam::traits<T>::Local(this->expression_.value(x),
+                                      this->measured_);
+    }
+    // Rebuilt only when a factor with other dimensions runs on this thread.
+    thread_local std::vector<int> dims;
+    thread_local gtsam::VerticalBlockMatrix Ab;
+    if (dims != this->dims_) {
+      dims = this->dims_;
+      Ab = gtsam::VerticalBlockMatrix(dims, Base::Dim);
+    }
+    Ab.matrix().setZero();
+    gtsam::internal::JacobianMap jacobians(this->keys_, Ab);
+    const T value = evaluate(x, jacobians);
+    H->resize(this->size());
+    for (size_t i = 0; i < this->size(); i++) (*H)[i] = Ab(i);
+    return -gtsam::traits<T>::Local(value, this->measured_);
+  }
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "ExpressionFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(trace_size_);
+  }
+};
+
+}  // namespace gtdynamics
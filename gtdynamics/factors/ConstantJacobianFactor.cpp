@@ -0,0 +1,142 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConstantJacobianFactor.cpp
+ * @brief Wrapper that reuses the linearization of factors with constant
+ * Jacobians.
+ */
+
+#include <gtdynamics/factors/ConstantJacobianFactor.h>
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::NonlinearFactor;
+using gtsam::Values;
+using gtsam::VectorValues;
+
+/* ************************************************************************* */
+// Return whether a value lives in a vector space, where the Jacobian of a
+// linear factor is constant and localCoordinates is a plain difference.
+static bool IsVectorSpace(const gtsam::Value& value) {
+  return dynamic_cast<const gtsam::GenericValue<double>*>(&value) ||
+         dynamic_cast<const gtsam::GenericValue<gtsam::Vector>*>(&value) ||
+         dynamic_cast<const gtsam::GenericValue<gtsam::Vector1>*>(&value) ||
+         dynamic_cast<const gtsam::GenericValue<gtsam::Vector2>*>(&value) ||
+         dynamic_cast<const gtsam::GenericValue<gtsam::Vector3>*>(&value) ||
+         dynamic_cast<const gtsam::GenericValue<gtsam::Vector4>*>(&value) ||
+         dynamic_cast<const gtsam::GenericValue<gtsam::Vector6>*>(&value);
+}
+
+/* ************************************************************************* */
+// Return the values of the keys of a factor.
+static Values FactorValues(const NonlinearFactor& factor,
+                           const Values& values) {
+  Values subset;
+  for (Key key : factor.keys()) subset.insert(key, values.at(key));
+  return subset;
+}
+
+/* ************************************************************************* */
+ConstantJacobianFactor::ConstantJacobianFactor(
+    const NonlinearFactor::shared_ptr& factor, const Values& values)
+    : Base(factor->keys()),
+      factor_(factor),
+      linearization_point_(FactorValues(*factor, values)) {
+  linear_ = boost::dynamic_pointer_cast<JacobianFactor>(
+      factor_->linearize(linearization_point_));
+  if (!linear_) {
+    throw std::invalid_argument(
+        "ConstantJacobianFactor: factor does not linearize to a "
+        "JacobianFactor.");
+  }
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> ConstantJacobianFactor::linearize(
+    const Values& values) const {
+  VectorValues delta;
+  for (Key key : keys()) {
+    delta.insert(key, linearization_point_.at(key).localCoordinates_(
+                          values.at(key)));
+  }
+  auto jacobian = boost::make_shared<JacobianFactor>(*linear_);
+  jacobian->getb() = -linear_->unweighted_error(delta);
+  return jacobian;
+}
+
+/* ************************************************************************* */
+bool HasConstantJacobian(const NonlinearFactor::shared_ptr& factor,
+                         const Values& values, double tol) {
+  auto noise_factor =
+      boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+  if (!noise_factor) return false;
+  if (boost::dynamic_pointer_cast<gtsam::noiseModel::Robust>(
+          noise_factor->noiseModel())) {
+    return false;
+  }
+  for (Key key : factor->keys()) {
+    if (!values.exists(key) || !IsVectorSpace(values.at(key))) return false;
+  }
+
+  const Values x0 = FactorValues(*factor, values);
+  try {
+    auto linear0 =
+        boost::dynamic_pointer_cast<JacobianFactor>(factor->linearize(x0));
+    if (!linear0) return false;
+    const gtsam::Matrix A0 = linear0->getA();
+
+    // Probe with two asymmetric perturbations, so that a nonlinear factor
+    // is unlikely to have the same Jacobian at all three points.
+    for (double scale : {0.37, -1.3}) {
+      VectorValues delta;
+      size_t i = 0;
+      for (Key key : factor->keys()) {
+        const size_t n = x0.at(key).dim();
+        gtsam::Vector d(n);
+        for (size_t j = 0; j < n; j++) d(j) = scale * (1.0 + 0.1 * i++);
+        delta.insert(key, d);
+      }
+      auto linear = boost::dynamic_pointer_cast<JacobianFactor>(
+          factor->linearize(x0.retract(delta)));
+      if (!linear) return false;
+      if (!gtsam::equal_with_abs_tol(A0, gtsam::Matrix(linear->getA()), tol))
+        return false;
+    }
+  } catch (const std::exception&) {
+    // The factor is not defined at a probe, so it is not linear.
+    return false;
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph CacheConstantJacobians(
+    const gtsam::NonlinearFactorGraph& graph, const Values& values,
+    size_t* num_cached) {
+  gtsam::NonlinearFactorGraph result;
+  size_t count = 0;
+  for (const auto& factor : graph) {
+    if (factor && HasConstantJacobian(factor, values)) {
+      result.emplace_shared<ConstantJacobianFactor>(factor, values);
+      count++;
+    } else {
+      result.push_back(factor);
+    }
+  }
+  if (num_cached) *num_cached = count;
+  return result;
+}
+
+}  // namespace gtdynamics
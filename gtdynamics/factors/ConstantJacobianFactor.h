@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConstantJacobianFactor.h
+ * @brief Wrapper that reuses the linearization of factors with constant
+ * Jacobians.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * ConstantJacobianFactor wraps a factor on vector-space variables whose
+ * whitened Jacobian does not depend on the values, e.g. MinTorqueFactor,
+ * priors on doubles, or the pneumatic ForceBalanceFactor. The factor is
+ * linearized once; later linearizations copy the cached JacobianFactor and
+ * only update its right-hand side, b = b0 - A * (x - x0).
+ *
+ * The error is still computed by the wrapped factor, so it stays exact.
+ */
+class ConstantJacobianFactor : public gtsam::NonlinearFactor {
+ private:
+  using This = ConstantJacobianFactor;
+  using Base = gtsam::NonlinearFactor;
+
+  gtsam::NonlinearFactor::shared_ptr factor_;
+  gtsam::JacobianFactor::shared_ptr linear_;
+  gtsam::Values linearization_point_;
+
+ public:
+  /**
+   * Constructor, linearizes the factor.
+   * @param factor  factor with a constant Jacobian, on vector-space keys
+   * @param values  values for (at least) the keys of the factor
+   */
+  ConstantJacobianFactor(const gtsam::NonlinearFactor::shared_ptr& factor,
+                         const gtsam::Values& values);
+
+  /// Return the wrapped factor.
+  const gtsam::NonlinearFactor::shared_ptr& factor() const { return factor_; }
+
+  /// Return the error of the wrapped factor.
+  double error(const gtsam::Values& values) const override {
+    return factor_->error(values);
+  }
+
+  /// Return the dimension of the wrapped factor.
+  size_t dim() const override { return factor_->dim(); }
+
+  /// Return the cached Jacobian with the right-hand side at the values.
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values& values) const override;
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string& s = "",
+             const gtsam::KeyFormatter& keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "constant Jacobian factor" << std::endl;
+    factor_->print("", keyFormatter);
+  }
+};
+
+/**
+ * Return whether a factor has a constant Jacobian: it is a NoiseModelFactor
+ * with a non-robust noise model, all its keys are vector-space values, and
+ * its whitened Jacobians at the values and at two perturbations of them
+ * agree.
+ * @param factor  the factor to check
+ * @param values  values for (at least) the keys of the factor
+ * @param tol     absolute tolerance on the Jacobian entries
+ */
+bool HasConstantJacobian(const gtsam::NonlinearFactor::shared_ptr& factor,
+                         const gtsam::Values& values, double tol = 1e-9);
+
+/**
+ * Graph pass that wraps all factors with constant Jacobians in a
+ * ConstantJacobianFactor, linearized at the given values. Other factors are
+ * copied as is, so the result can replace the graph in any optimizer.
+ * @param graph       the graph to process
+ * @param values      values for all keys of the graph, e.g. the initial values
+ * @param num_cached  optional output, the number of wrapped factors
+ */
+gtsam::NonlinearFactorGraph CacheConstantJacobians(
+    const gtsam::NonlinearFactorGraph& graph, const gtsam::Values& values,
+    size_t* num_cached = nullptr);
+
+}  // namespace gtdynamics
@@ -0,0 +1,199 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactComplementarityFactor.h
+ * @brief Relaxed complementarity between contact height, normal force and
+ * slip, for contact-implicit trajectory optimization.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * ContactComplementarityFactor is a ternary factor on the pose, twist and
+ * contact wrench of a link, which lets a candidate contact point decide by
+ * itself whether it is in contact, instead of following a fixed schedule.
+ *
+ * With n the up direction, opposite to gravity, h = n' p - h_0 the height of
+ * the contact point p above the ground, f_n = n' f the normal component of
+ * the world frame contact force and v_t the tangential velocity of p, the
+ * error is
+ *
+ *   [ max(0, -h), max(0, -f_n), max(0, h f_n - eps), f_n v_t ]
+ *
+ * so that the point stays above the ground, only pushes on it, only pushes
+ * when (nearly) on it, and does not slide while pushing. The relaxation eps
+ * keeps the feasible set from pinching at h = f_n = 0, and is typically
+ * decreased between solves. Inactive hinges have zero Jacobian rows.
+ */
+class ContactComplementarityFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Vector6,
+                                      gtsam::Vector6> {
+ private:
+  using This = ContactComplementarityFactor;
+  using Base = gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Vector6,
+                                        gtsam::Vector6>;
+
+  gtsam::Point3 comPc_;    // contact point in the link CoM frame
+  gtsam::Vector3 normal_;  // up direction, world frame
+  gtsam::Matrix23 tangents_;  // tangent basis, one per row, world frame
+  double relaxation_, ground_height_;
+
+ public:
+  /**
+   * Constructor
+   * @param pose_key Key corresponding to the link's CoM pose.
+   * @param twist_key Key corresponding to the link's twist.
+   * @param contact_wrench_key Key corresponding to this link's contact wrench.
+   * @param cost_model Noise model of dimension 5.
+   * @param comPc Contact point in the link's CoM frame.
+   * @param gravity Gravity vector, defines the up direction; +z if zero.
+   * @param relaxation Relaxation eps of the height-force complementarity.
+   * @param ground_height Height of the ground along the up direction.
+   */
+  ContactComplementarityFactor(
+      gtsam::Key pose_key, gtsam::Key twist_key, gtsam::Key contact_wrench_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const gtsam::Point3 &comPc, const gtsam::Vector3 &gravity,
+      double relaxation = 1e-3, double ground_height = 0.0)
+      : Base(cost_model, pose_key, twist_key, contact_wrench_key),
+        comPc_(comPc),
+        normal_(gravity.norm() > 0 ? gtsam::Vector3(-gravity.normalized())
+                                   : gtsam::Vector3::UnitZ()),
+        relaxation_(relaxation),
+        ground_height_(ground_height) {
+    // Any tangent basis will do, start from the axis least aligned with n.
+    gtsam::Vector3 axis = gtsam::Vector3::Zero();
+    Eigen::Index least;
+    normal_.cwiseAbs().minCoeff(&least);
+    axis(least) = 1;
+    const gtsam::Vector3 t1 = normal_.cross(axis).normalized();
+    tangents_.row(0) = t1.transpose();
+    tangents_.row(1) = normal_.cross(t1).transpose();
+  }
+  virtual ~ContactComplementarityFactor() {}
+
+  /// Return the contact point in the link CoM frame.
+  const gtsam::Point3 &contactPoint() const { return comPc_; }
+
+  /// Return the relaxation of the height-force complementarity.
+  double relaxation() const { return relaxation_; }
+
+  /**
+   * Evaluate the complementarity violations.
+   * @param pose CoM pose of the link.
+   * @param twist Twist of the link, in the CoM frame.
+   * @param contact_wrench Contact wrench on this link, in the CoM frame.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose, const gtsam::Vector6 &twist,
+      const gtsam::Vector6 &contact_wrench,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist = boost::none,
+      boost::optional<gtsam::Matrix &> H_contact_wrench =
+          boost::none) const override {
+    // Height of the contact point.
+    const bool H = H_pose || H_twist || H_contact_wrench;
+    gtsam::Matrix36 H_p_pose;
+    const gtsam::Point3 p = pose.transformFrom(comPc_, H ? &H_p_pose : 0);
+    const double h = normal_.dot(p) - ground_height_;
+
+    // Normal component of the contact force in the world frame.
+    gtsam::Matrix36 H_rotation;
+    const gtsam::Rot3 &R = pose.rotation(H ? &H_rotation : 0);
+    gtsam::Matrix3 H_f_R, H_f_c;
+    const gtsam::Vector3 f = R.rotate(contact_wrench.tail<3>(),
+                                      H ? &H_f_R : 0, H ? &H_f_c : 0);
+    const double fn = normal_.dot(f);
+
+    // Tangential velocity of the contact point, in the world frame.
+    const gtsam::Vector3 u =
+        twist.tail<3>() + twist.head<3>().cross(comPc_);
+    gtsam::Matrix3 H_v_R, H_v_u;
+    const gtsam::Vector3 v = R.rotate(u, H ? &H_v_R : 0, H ? &H_v_u : 0);
+    const gtsam::Vector2 vt = tangents_ * v;
+
+    gtsam::Vector error = gtsam::Vector::Zero(5);
+    if (h < 0) error(0) = -h;
+    if (fn < 0) error(1) = -fn;
+    if (h * fn > relaxation_) error(2) = h * fn - relaxation_;
+    error.tail<2>() = fn * vt;
+    if (!H) return error;
+
+    const gtsam::Matrix16 H_h_pose = normal_.transpose() * H_p_pose;
+    const gtsam::Matrix16 H_fn_pose = normal_.transpose() * H_f_R * H_rotation;
+    gtsam::Matrix16 H_fn_wrench = gtsam::Matrix16::Zero();
+    H_fn_wrench.rightCols<3>() = normal_.transpose() * H_f_c;
+    gtsam::Matrix36 H_u_twist;
+    H_u_twist << -gtsam::skewSymmetric(comPc_), gtsam::I_3x3;
+    const gtsam::Matrix26 H_vt_pose = tangents_ * H_v_R * H_rotation,
+                          H_vt_twist = tangents_ * H_v_u * H_u_twist;
+
+    Eigen::Matrix<double, 5, 6> Hp = Eigen::Matrix<double, 5, 6>::Zero(),
+                                Hv = Hp, Hw = Hp;
+    if (h < 0) Hp.row(0) = -H_h_pose;
+    if (fn < 0) {
+      Hp.row(1) = -H_fn_pose;
+      Hw.row(1) = -H_fn_wrench;
+    }
+    if (h * fn > relaxation_) {
+      Hp.row(2) = fn * H_h_pose + h * H_fn_pose;
+      Hw.row(2) = h * H_fn_wrench;
+    }
+    Hp.bottomRows<2>() = vt * H_fn_pose + fn * H_vt_pose;
+    Hv.bottomRows<2>() = fn * H_vt_twist;
+    Hw.bottomRows<2>() = vt * H_fn_wrench;
+
+    if (H_pose) *H_pose = Hp;
+    if (H_twist) *H_twist = Hv;
+    if (H_contact_wrench) *H_contact_wrench = Hw;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Contact Complementarity Factor, relaxation "
+              << relaxation_ << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE const &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor3", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(comPc_);
+    ar &BOOST_SERIALIZATION_NVP(normal_);
+    ar &BOOST_SERIALIZATION_NVP(tangents_);
+    ar &BOOST_SERIALIZATION_NVP(relaxation_);
+    ar &BOOST_SERIALIZATION_NVP(ground_height_);
+  }
+};
+
+}  // namespace gtdynamics
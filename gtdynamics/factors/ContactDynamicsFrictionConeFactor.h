@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -20,6 +21,7 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
 #include <boost/optional.hpp>
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -71,6 +73,12 @@ class ContactDynamicsFrictionConeFactor
   }
   virtual ~ContactDynamicsFrictionConeFactor() {}
 
+  /// Return the static friction coefficient.
+  double mu() const { return std::sqrt(mu_prime_); }
+
+  /// Return the up axis, 0 for x, 1 for y and 2 for z.
+  int upAxis() const { return up_axis_; }
+
  public:
   /**
    * Evaluate contact point moment errors.
@@ -144,7 +152,7 @@ class ContactDynamicsFrictionConeFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
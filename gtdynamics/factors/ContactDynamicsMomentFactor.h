@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -51,10 +53,10 @@ inline gtsam::Vector3_ ContactDynamicsMomentConstraint(
  * moment at the contact point for the link.
  */
 class ContactDynamicsMomentFactor
-    : public gtsam::ExpressionFactor<gtsam::Vector3> {
+    : public CompiledExpressionFactor<gtsam::Vector3> {
  private:
   using This = ContactDynamicsMomentFactor;
-  using Base = gtsam::ExpressionFactor<gtsam::Vector3>;
+  using Base = CompiledExpressionFactor<gtsam::Vector3>;
 
   gtsam::Pose3 cTcom_;
   gtsam::Matrix36 H_contact_wrench_;
@@ -79,7 +81,7 @@ class ContactDynamicsMomentFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -100,4 +102,73 @@ class ContactDynamicsMomentFactor
   }
 };
 
+/**
+ * AnalyticContactDynamicsMomentFactor is the same constraint as
+ * ContactDynamicsMomentFactor, with its constant 3x6 Jacobian,
+ * the moment rows of Ad(cTcom^{-1})^T, computed once instead of an expression
+ * tree.
+ */
+class AnalyticContactDynamicsMomentFactor
+    : public gtsam::NoiseModelFactor1<gtsam::Vector6> {
+ private:
+  using This = AnalyticContactDynamicsMomentFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Vector6>;
+
+  gtsam::Matrix36 H_;
+
+ public:
+  /**
+   * Constructor.
+   * @param contact_wrench_key Key corresponding to this link's contact wrench.
+   * @param cost_model Noise model for this factor.
+   * @param cTcom Contact frame expressed in CoM frame.
+   */
+  AnalyticContactDynamicsMomentFactor(
+      gtsam::Key contact_wrench_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const gtsam::Pose3 &cTcom)
+      : Base(cost_model, contact_wrench_key),
+        H_(cTcom.inverse().AdjointMap().transpose().topRows<3>()) {}
+
+  virtual ~AnalyticContactDynamicsMomentFactor() {}
+
+  /// Return the Jacobian, the error being H * F.
+  const gtsam::Matrix36 &H() const { return H_; }
+
+  /**
+   * Evaluate the error, H * F.
+   * @param F contact wrench on the link
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &F,
+      boost::optional<gtsam::Matrix &> H_F = boost::none) const override {
+    if (H_F) *H_F = H_;
+    return H_ * F;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "AnalyticContactDynamicsMomentFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor1", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(H_);
+  }
+};
+
 }  // namespace gtdynamics
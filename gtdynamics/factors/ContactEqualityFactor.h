@@ -14,6 +14,7 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/PointOnLink.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
@@ -67,7 +68,7 @@ class ContactEqualityFactor
   /// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// Generic method to compute difference between contact points and provide
@@ -76,10 +77,13 @@ class ContactEqualityFactor
       const gtsam::Pose3 &wT1, const gtsam::Pose3 &wT2,
       boost::optional<gtsam::Matrix &> H1 = boost::none,
       boost::optional<gtsam::Matrix &> H2 = boost::none) const {
-    gtsam::Point3 p1_w = wT1.transformFrom(point_on_link_.point, H1);
-    gtsam::Point3 p2_w = wT2.transformFrom(point_on_link_.point, H2);
-
-    if (H1) *H1 = -(*H1);
+    gtsam::Matrix36 p1_H_wT1, p2_H_wT2;
+    const gtsam::Point3 p1_w =
+        wT1.transformFrom(point_on_link_.point, H1 ? &p1_H_wT1 : 0);
+    const gtsam::Point3 p2_w =
+        wT2.transformFrom(point_on_link_.point, H2 ? &p2_H_wT2 : 0);
+    if (H1) *H1 = -p1_H_wT1;
+    if (H2) *H2 = p2_H_wT2;
     return p2_w - p1_w;
   }
 
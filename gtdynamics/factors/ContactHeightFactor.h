@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -46,10 +48,10 @@ inline gtsam::Double_ ContactHeightConstraint(gtsam::Key pose_key,
  * known ground plane height for the contact point. This factor assumes that the
  * ground is flat and level.
  */
-class ContactHeightFactor : public gtsam::ExpressionFactor<double> {
+class ContactHeightFactor : public CompiledExpressionFactor<double> {
  private:
   using This = ContactHeightFactor;
-  using Base = gtsam::ExpressionFactor<double>;
+  using Base = CompiledExpressionFactor<double>;
 
  public:
   /**
@@ -76,7 +78,7 @@ class ContactHeightFactor : public gtsam::ExpressionFactor<double> {
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -51,10 +53,10 @@ inline gtsam::Vector3_ ContactKinematicsAccelConstraint(
  * linear acceleration at the contact point for a link.
  */
 class ContactKinematicsAccelFactor
-    : public gtsam::ExpressionFactor<gtsam::Vector3> {
+    : public CompiledExpressionFactor<gtsam::Vector3> {
  private:
   using This = ContactKinematicsAccelFactor;
-  using Base = gtsam::ExpressionFactor<gtsam::Vector3>;
+  using Base = CompiledExpressionFactor<gtsam::Vector3>;
 
  public:
   /**
@@ -75,7 +77,7 @@ class ContactKinematicsAccelFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -96,4 +98,72 @@ class ContactKinematicsAccelFactor
   }
 };
 
+/**
+ * AnalyticContactKinematicsAccelFactor is the same constraint as
+ * ContactKinematicsAccelFactor, with its constant 3x6 Jacobian,
+ * the linear rows of Ad(cTcom), computed once instead of an expression
+ * tree.
+ */
+class AnalyticContactKinematicsAccelFactor
+    : public gtsam::NoiseModelFactor1<gtsam::Vector6> {
+ private:
+  using This = AnalyticContactKinematicsAccelFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Vector6>;
+
+  gtsam::Matrix36 H_;
+
+ public:
+  /**
+   * Constructor.
+   * @param accel_key LabeledKey corresponding to this link's acceleration.
+   * @param cost_model Noise model for this factor.
+   * @param cTcom Contact frame expressed in CoM frame.
+   */
+  AnalyticContactKinematicsAccelFactor(
+      gtsam::Key accel_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const gtsam::Pose3 &cTcom)
+      : Base(cost_model, accel_key), H_(cTcom.AdjointMap().bottomRows<3>()) {}
+
+  virtual ~AnalyticContactKinematicsAccelFactor() {}
+
+  /// Return the Jacobian, the error being H * A.
+  const gtsam::Matrix36 &H() const { return H_; }
+
+  /**
+   * Evaluate the error, H * A.
+   * @param A twist acceleration of the link
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &A,
+      boost::optional<gtsam::Matrix &> H_A = boost::none) const override {
+    if (H_A) *H_A = H_;
+    return H_ * A;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "AnalyticContactKinematicsAccelFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor1", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(H_);
+  }
+};
+
 }  // namespace gtdynamics
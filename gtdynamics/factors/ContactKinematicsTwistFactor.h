@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -51,10 +53,10 @@ inline gtsam::Vector3_ ContactKinematicsTwistConstraint(
  * linear velocity at the contact point for a link.
  */
 class ContactKinematicsTwistFactor
-    : public gtsam::ExpressionFactor<gtsam::Vector3> {
+    : public CompiledExpressionFactor<gtsam::Vector3> {
  private:
   using This = ContactKinematicsTwistFactor;
-  using Base = gtsam::ExpressionFactor<gtsam::Vector3>;
+  using Base = CompiledExpressionFactor<gtsam::Vector3>;
 
  public:
   /**
@@ -74,7 +76,7 @@ class ContactKinematicsTwistFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   //< print contents
@@ -95,4 +97,72 @@ class ContactKinematicsTwistFactor
   }
 };
 
+/**
+ * AnalyticContactKinematicsTwistFactor is the same constraint as
+ * ContactKinematicsTwistFactor, with its constant 3x6 Jacobian,
+ * the linear rows of Ad(cTcom), computed once instead of an expression
+ * tree.
+ */
+class AnalyticContactKinematicsTwistFactor
+    : public gtsam::NoiseModelFactor1<gtsam::Vector6> {
+ private:
+  using This = AnalyticContactKinematicsTwistFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Vector6>;
+
+  gtsam::Matrix36 H_;
+
+ public:
+  /**
+   * Constructor.
+   * @param twist_key LabeledKey corresponding to this link's twist.
+   * @param cost_model Noise model for this factor.
+   * @param cTcom Contact frame expressed in CoM frame.
+   */
+  AnalyticContactKinematicsTwistFactor(
+      gtsam::Key twist_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const gtsam::Pose3 &cTcom)
+      : Base(cost_model, twist_key), H_(cTcom.AdjointMap().bottomRows<3>()) {}
+
+  virtual ~AnalyticContactKinematicsTwistFactor() {}
+
+  /// Return the Jacobian, the error being H * V.
+  const gtsam::Matrix36 &H() const { return H_; }
+
+  /**
+   * Evaluate the error, H * V.
+   * @param V twist of the link
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &V,
+      boost::optional<gtsam::Matrix &> H_V = boost::none) const override {
+    if (H_V) *H_V = H_;
+    return H_ * V;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "AnalyticContactKinematicsTwistFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor1", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(H_);
+  }
+};
+
 }  // namespace gtdynamics
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/PointOnLink.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -70,6 +71,9 @@ class ContactPointFactor
       : ContactPointFactor(gtdynamics::PoseKey(point_on_link.link->id(), t),
                            point_key, cost_model, point_on_link.point) {}
 
+  /// Default constructor for serialization.
+  ContactPointFactor() {}
+
   virtual ~ContactPointFactor() {}
 
   /**
@@ -81,16 +85,18 @@ class ContactPointFactor
       const gtsam::Pose3 &wTl, const gtsam::Point3 &wPc,
       boost::optional<gtsam::Matrix &> H_pose = boost::none,
       boost::optional<gtsam::Matrix &> H_point = boost::none) const override {
-    gtsam::Vector error = wPc - wTl.transformFrom(contact_in_com_, H_pose);
-    if (H_pose) *H_pose = -gtsam::Matrix3::Identity() * (*H_pose);
-    if (H_point) *H_point = gtsam::Matrix3::Identity();
+    gtsam::Matrix36 wPl_H_pose;
+    const gtsam::Point3 error =
+        wPc - wTl.transformFrom(contact_in_com_, H_pose ? &wPl_H_pose : 0);
+    if (H_pose) *H_pose = -wPl_H_pose;
+    if (H_point) *H_point = gtsam::I_3x3;
     return error;
   }
 
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -108,7 +114,8 @@ class ContactPointFactor
   template <class ARCHIVE>
   void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
     ar &boost::serialization::make_nvp(
-        "NonlinearEquality2", boost::serialization::base_object<Base>(*this));
+        "NoiseModelFactor2", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(contact_in_com_);
   }
 };
 
@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialWrenchFactor.h
+ * @brief Wrench balance factor with the inertial parameters of the link as a
+ * variable.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * InertialWrenchFactor is the same constraint as AnalyticWrenchFactor, but
+ * reads the spatial inertia of the link from the 10 inertial parameters at
+ * InertialParametersKey(link id) instead of baking in Link::inertiaMatrix().
+ * The parameters are a variable of the graph, held by a prior or a
+ * constraint, so changing them is a Values update rather than a rebuild.
+ *
+ * With G the SpatialInertia of the parameters, the error is
+ * ad(V)^T * G * V - G * A + sum(F_j) + G * [0; R^T g],
+ * which is linear in the parameters. The CoM frame of the link is the
+ * nominal one, and a CoM offset enters through the first moment of mass.
+ *
+ * Keys are ordered as: twist, twist acceleration, wrenches, the link pose if
+ * gravity is given, and the inertial parameters.
+ */
+class InertialWrenchFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = InertialWrenchFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  boost::optional<gtsam::Vector3> gravity_;
+
+  /// Return all keys of the factor.
+  static gtsam::KeyVector Keys(const LinkConstSharedPtr &link,
+                               const std::vector<DynamicsSymbol> &wrench_keys,
+                               int time, bool gravity) {
+    gtsam::KeyVector keys{TwistKey(link->id(), time),
+                          TwistAccelKey(link->id(), time)};
+    keys.insert(keys.end(), wrench_keys.begin(), wrench_keys.end());
+    if (gravity) keys.push_back(PoseKey(link->id(), time));
+    keys.push_back(InertialParametersKey(link->id()));
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model The noise model for this factor.
+   * @param link The link.
+   * @param wrench_keys Keys of the wrenches acting on the link.
+   * @param time The timestep at which this factor is defined.
+   * @param gravity (optional) Create gravity wrench in link COM frame.
+   */
+  InertialWrenchFactor(
+      const gtsam::SharedNoiseModel &cost_model, const LinkConstSharedPtr &link,
+      const std::vector<DynamicsSymbol> &wrench_keys, int time,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none)
+      : Base(cost_model,
+             Keys(link, wrench_keys, time, static_cast<bool>(gravity))),
+        gravity_(gravity) {}
+
+  virtual ~InertialWrenchFactor() {}
+
+  /// Evaluate wrench balance error.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override {
+    const size_t num_wrenches = size() - 3 - (gravity_ ? 1 : 0);
+    const gtsam::Vector6 twist = x.at<gtsam::Vector6>(keys_[0]);
+    const gtsam::Vector6 accel = x.at<gtsam::Vector6>(keys_[1]);
+    const gtsam::Vector10 parameters = x.at<gtsam::Vector10>(keys_.back());
+    const gtsam::Matrix6 inertia = SpatialInertia(parameters);
+
+    // Gravity acts as an acceleration -[0; R^T g] of the CoM frame.
+    gtsam::Vector6 accel_gravity = -accel;
+    gtsam::Matrix3 H_unrotate;
+    if (gravity_) {
+      const gtsam::Pose3 wTcom = x.at<gtsam::Pose3>(keys_[2 + num_wrenches]);
+      accel_gravity.tail<3>() +=
+          wTcom.rotation().unrotate(*gravity_, H ? &H_unrotate : 0);
+    }
+
+    gtsam::Matrix6 H_xi, H_y;
+    gtsam::Vector6 error =
+        gtsam::Pose3::adjointTranspose(twist, inertia * twist, H ? &H_xi : 0,
+                                       H ? &H_y : 0) +
+        inertia * accel_gravity;
+    for (size_t i = 0; i < num_wrenches; i++) {
+      error += x.at<gtsam::Vector6>(keys_[2 + i]);
+    }
+
+    if (H) {
+      H->resize(size());
+      (*H)[0] = H_xi + H_y * inertia;
+      (*H)[1] = -inertia;
+      for (size_t i = 0; i < num_wrenches; i++) (*H)[2 + i] = gtsam::I_6x6;
+      if (gravity_) {
+        gtsam::Matrix6 H_pose = gtsam::Z_6x6;
+        H_pose.leftCols<3>() = inertia.rightCols<3>() * H_unrotate;
+        (*H)[2 + num_wrenches] = H_pose;
+      }
+      // The error is linear in the parameters, one basis vector at a time.
+      gtsam::Matrix H_parameters(6, 10);
+      for (size_t p = 0; p < 10; p++) {
+        const gtsam::Matrix6 E = SpatialInertia(gtsam::Vector10::Unit(p));
+        H_parameters.col(p) =
+            gtsam::Pose3::adjointTranspose(twist, E * twist) +
+            E * accel_gravity;
+      }
+      H->back() = H_parameters;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "InertialWrenchFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(gravity_);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,193 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InteractionFactors.h
+ * @brief Factors coupling the links of two robots in contact, e.g. grippers
+ * holding a shared payload.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Return a wrench given in the CoM frame of a link in the world frame, about
+ * the world origin: Ad(wTcom^{-1})^T F, with Jacobians for the right
+ * perturbation of the pose.
+ */
+inline gtsam::Vector6 WorldWrench(
+    const gtsam::Pose3 &wTcom, const gtsam::Vector6 &F,
+    gtsam::OptionalJacobian<6, 6> H_pose = boost::none,
+    gtsam::OptionalJacobian<6, 6> H_F = boost::none) {
+  const gtsam::Matrix3 R = wTcom.rotation().matrix();
+  const gtsam::Matrix3 p_hat = gtsam::skewSymmetric(wTcom.translation());
+  const gtsam::Vector3 m = F.head<3>(), f = F.tail<3>(), Rf = R * f;
+  gtsam::Vector6 W;
+  W << R * m + p_hat * Rf, Rf;
+  if (H_pose) {
+    const gtsam::Matrix3 H_f_omega = -R * gtsam::skewSymmetric(f);
+    *H_pose << -R * gtsam::skewSymmetric(m) + p_hat * H_f_omega,
+        -gtsam::skewSymmetric(Rf) * R, H_f_omega, gtsam::Z_3x3;
+  }
+  if (H_F) *H_F << R, p_hat * R, gtsam::Z_3x3, R;
+  return W;
+}
+
+/**
+ * InteractionPointFactor is a binary factor on the CoM poses of two links,
+ * which makes a point on each coincide in the world frame:
+ * wTa * comPa - wTb * comPb.
+ */
+class InteractionPointFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3> {
+ private:
+  using This = InteractionPointFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3>;
+
+  gtsam::Point3 comPa_, comPb_;
+
+ public:
+  /**
+   * Constructor.
+   * @param pose_a_key Key of the CoM pose of the first link.
+   * @param pose_b_key Key of the CoM pose of the second link.
+   * @param cost_model Noise model of dimension 3.
+   * @param comPa Contact point in the CoM frame of the first link.
+   * @param comPb Contact point in the CoM frame of the second link.
+   */
+  InteractionPointFactor(gtsam::Key pose_a_key, gtsam::Key pose_b_key,
+                         const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                         const gtsam::Point3 &comPa, const gtsam::Point3 &comPb)
+      : Base(cost_model, pose_a_key, pose_b_key),
+        comPa_(comPa),
+        comPb_(comPb) {}
+
+  virtual ~InteractionPointFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTa, const gtsam::Pose3 &wTb,
+      boost::optional<gtsam::Matrix &> H_wTa = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTb = boost::none) const override {
+    gtsam::Matrix36 H_a, H_b;
+    const gtsam::Point3 pa = wTa.transformFrom(comPa_, H_wTa ? &H_a : 0);
+    const gtsam::Point3 pb = wTb.transformFrom(comPb_, H_wTb ? &H_b : 0);
+    if (H_wTa) *H_wTa = H_a;
+    if (H_wTb) *H_wTb = -H_b;
+    return pa - pb;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Interaction Point Factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor2", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(comPa_);
+    ar &BOOST_SERIALIZATION_NVP(comPb_);
+  }
+};
+
+/**
+ * ReactionWrenchFactor enforces Newton's third law between two links in
+ * contact: the wrenches they exert on each other, each in its own CoM frame,
+ * add up to zero in the world frame.
+ */
+class ReactionWrenchFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Pose3, gtsam::Pose3,
+                                      gtsam::Vector6, gtsam::Vector6> {
+ private:
+  using This = ReactionWrenchFactor;
+  using Base = gtsam::NoiseModelFactor4<gtsam::Pose3, gtsam::Pose3,
+                                        gtsam::Vector6, gtsam::Vector6>;
+
+ public:
+  /**
+   * Constructor.
+   * @param pose_a_key Key of the CoM pose of the first link.
+   * @param pose_b_key Key of the CoM pose of the second link.
+   * @param wrench_a_key Key of the wrench on the first link.
+   * @param wrench_b_key Key of the wrench on the second link.
+   * @param cost_model Noise model of dimension 6.
+   */
+  ReactionWrenchFactor(gtsam::Key pose_a_key, gtsam::Key pose_b_key,
+                       gtsam::Key wrench_a_key, gtsam::Key wrench_b_key,
+                       const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model, pose_a_key, pose_b_key, wrench_a_key, wrench_b_key) {}
+
+  virtual ~ReactionWrenchFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTa, const gtsam::Pose3 &wTb,
+      const gtsam::Vector6 &F_a, const gtsam::Vector6 &F_b,
+      boost::optional<gtsam::Matrix &> H_wTa = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTb = boost::none,
+      boost::optional<gtsam::Matrix &> H_F_a = boost::none,
+      boost::optional<gtsam::Matrix &> H_F_b = boost::none) const override {
+    gtsam::Matrix6 Hp_a, Hp_b, Hf_a, Hf_b;
+    const gtsam::Vector6 W_a =
+        WorldWrench(wTa, F_a, H_wTa ? &Hp_a : 0, H_F_a ? &Hf_a : 0);
+    const gtsam::Vector6 W_b =
+        WorldWrench(wTb, F_b, H_wTb ? &Hp_b : 0, H_F_b ? &Hf_b : 0);
+    if (H_wTa) *H_wTa = Hp_a;
+    if (H_wTb) *H_wTb = Hp_b;
+    if (H_F_a) *H_F_a = Hf_a;
+    if (H_F_b) *H_F_b = Hf_b;
+    return W_a + W_b;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Reaction Wrench Factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor4", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+}  // namespace gtdynamics
@@ -14,14 +14,17 @@
 #pragma once
 
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
 
 #include <boost/optional.hpp>
 #include <cmath>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -85,7 +88,7 @@ class JointLimitFactor : public gtsam::NoiseModelFactor1<double> {
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -108,4 +111,106 @@ class JointLimitFactor : public gtsam::NoiseModelFactor1<double> {
   }
 };
 
+/**
+ * VectorJointLimitFactor enforces the limits of one quantity, e.g. the angle,
+ * of many joints at once, with the hinge loss of JointLimitFactor on each.
+ * All joints are evaluated in one pass, and the Jacobian is diagonal, so one
+ * factor replaces a JointLimitFactor per joint.
+ */
+class VectorJointLimitFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = VectorJointLimitFactor;
+  using Base = gtsam::NoiseModelFactor;
+  gtsam::Vector low_, high_;
+
+ public:
+  /**
+   * Construct from joint limits
+   * @param keys joint value keys
+   * @param cost_model noise model of dimension keys.size()
+   * @param lower_limits joint lower limits, one per key
+   * @param upper_limits joint upper limits, one per key
+   * @param limit_thresholds joint limit thresholds, one per key
+   */
+  VectorJointLimitFactor(const gtsam::KeyVector &keys,
+                         const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                         const gtsam::Vector &lower_limits,
+                         const gtsam::Vector &upper_limits,
+                         const gtsam::Vector &limit_thresholds)
+      : Base(cost_model, keys),
+        low_(lower_limits + limit_thresholds),
+        high_(upper_limits - limit_thresholds) {
+    const auto n = static_cast<Eigen::Index>(keys.size());
+    if (lower_limits.size() != n || upper_limits.size() != n ||
+        limit_thresholds.size() != n) {
+      throw std::invalid_argument(
+          "VectorJointLimitFactor: need one limit per key.");
+    }
+  }
+
+  virtual ~VectorJointLimitFactor() {}
+
+ public:
+  /**
+   * Evaluate joint limit errors, as JointLimitFactor does for each joint.
+   * @param q joint values, in the order of the keys
+   * @param H_q optional diagonal Jacobian, -1, 0 or 1 on the diagonal
+   */
+  gtsam::Vector evaluateError(const gtsam::Vector &q,
+                              gtsam::Vector *H_q = nullptr) const {
+    const gtsam::Vector below = (low_ - q).cwiseMax(0.0);
+    const gtsam::Vector above = (q - high_).cwiseMax(0.0);
+    if (H_q) {
+      *H_q = (above.array() > 0).cast<double>() -
+             (below.array() > 0).cast<double>();
+    }
+    return below + above;
+  }
+
+  /// Evaluate the errors on values, as NoiseModelFactor needs.
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override {
+    const size_t n = size();
+    gtsam::Vector q(n);
+    for (size_t i = 0; i < n; i++) q(i) = x.at<double>(keys()[i]);
+    if (!H) return evaluateError(q);
+
+    gtsam::Vector diagonal;
+    gtsam::Vector error = evaluateError(q, &diagonal);
+    H->resize(n);
+    for (size_t i = 0; i < n; i++) {
+      (*H)[i] = gtsam::Matrix::Zero(n, 1);
+      (*H)[i](i, 0) = diagonal(i);
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "VectorJointLimitFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &low_;
+    ar &high_;
+  }
+};
+
 }  // namespace gtdynamics
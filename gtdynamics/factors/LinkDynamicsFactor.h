@@ -0,0 +1,242 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinkDynamicsFactor.h
+ * @brief Fused pose, twist, twist acceleration and wrench factor of a link.
+ */
+
+#pragma once
+
+#include <gtdynamics/factors/PoseFactor.h>
+#include <gtdynamics/factors/TwistAccelFactor.h>
+#include <gtdynamics/factors/TwistFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * LinkDynamicsFactor stacks several Gaussian factors into a single factor, so
+ * that all kinematic and dynamic constraints of one link at one time step are
+ * linearized in one pass into a single JacobianFactor.
+ *
+ * The residual is the concatenation of the whitened residuals of the
+ * components, with a unit noise model, hence error() and the linearization
+ * agree with the sum of the components. Components must have Gaussian,
+ * non-constrained noise models.
+ *
+ * See FuseLinkFactors for the per-link grouping used by DynamicsGraph.
+ */
+class LinkDynamicsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = LinkDynamicsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::vector<gtsam::NoiseModelFactor::shared_ptr> factors_;
+  std::vector<std::vector<size_t>> slots_;  // position of component keys
+
+  /// Return the union of the component keys, in order of appearance.
+  static gtsam::KeyVector Keys(
+      const std::vector<gtsam::NoiseModelFactor::shared_ptr> &factors) {
+    gtsam::KeyVector keys;
+    for (auto &&factor : factors) {
+      for (gtsam::Key key : factor->keys()) {
+        if (std::find(keys.begin(), keys.end(), key) == keys.end())
+          keys.push_back(key);
+      }
+    }
+    return keys;
+  }
+
+  /// Return the total residual dimension of the components.
+  static size_t Dim(
+      const std::vector<gtsam::NoiseModelFactor::shared_ptr> &factors) {
+    size_t dim = 0;
+    for (auto &&factor : factors) dim += factor->dim();
+    return dim;
+  }
+
+ protected:
+  /// Default constructor for serialization.
+  LinkDynamicsFactor() {}
+
+ public:
+  /**
+   * Constructor
+   * @param factors The component factors, e.g., the analytic pose, twist,
+   * twist acceleration and wrench factors of a link.
+   */
+  explicit LinkDynamicsFactor(
+      const std::vector<gtsam::NoiseModelFactor::shared_ptr> &factors)
+      : Base(gtsam::noiseModel::Unit::Create(Dim(factors)), Keys(factors)),
+        factors_(factors) {
+    for (auto &&factor : factors_) {
+      auto gaussian = boost::dynamic_pointer_cast<gtsam::noiseModel::Gaussian>(
+          factor->noiseModel());
+      if (!gaussian || gaussian->isConstrained()) {
+        throw std::invalid_argument(
+            "LinkDynamicsFactor: components need Gaussian noise models.");
+      }
+      std::vector<size_t> slots;
+      for (gtsam::Key key : factor->keys()) {
+        slots.push_back(std::find(keys_.begin(), keys_.end(), key) -
+                        keys_.begin());
+      }
+      slots_.push_back(slots);
+    }
+  }
+
+  virtual ~LinkDynamicsFactor() {}
+
+  /// Return the component factors.
+  const std::vector<gtsam::NoiseModelFactor::shared_ptr> &factors() const {
+    return factors_;
+  }
+
+  /**
+   * Evaluate the stacked whitened residuals of all components.
+   * @param x Values containing all keys of the factor.
+   * @param H (optional) Jacobians, one per key.
+   */
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override {
+    gtsam::Vector error(dim());
+    if (H) H->assign(size(), gtsam::Matrix());
+
+    size_t row = 0;
+    std::vector<gtsam::Matrix> H_component;
+    for (size_t c = 0; c < factors_.size(); c++) {
+      const auto &factor = factors_[c];
+      const size_t rows = factor->dim();
+      if (H) {
+        gtsam::Vector b = factor->unwhitenedError(x, H_component);
+        factor->noiseModel()->WhitenSystem(H_component, b);
+        error.segment(row, rows) = b;
+        for (size_t k = 0; k < H_component.size(); k++) {
+          gtsam::Matrix &block = (*H)[slots_[c][k]];
+          if (block.size() == 0) {
+            block = gtsam::Matrix::Zero(dim(), H_component[k].cols());
+          }
+          block.middleRows(row, rows) = H_component[k];
+        }
+      } else {
+        error.segment(row, rows) = factor->whitenedError(x);
+      }
+      row += rows;
+    }
+    return error;
+  }
+
+  /// Rekey all components, see NonlinearFactor::rekey.
+  gtsam::NonlinearFactor::shared_ptr rekey(
+      const std::map<gtsam::Key, gtsam::Key> &rekey_mapping) const override {
+    std::vector<gtsam::NoiseModelFactor::shared_ptr> factors;
+    for (auto &&factor : factors_) {
+      factors.push_back(boost::static_pointer_cast<gtsam::NoiseModelFactor>(
+          factor->rekey(rekey_mapping)));
+    }
+    return MakeFactor<This>(factors);
+  }
+
+  /// Rekey all components, see NonlinearFactor::rekey.
+  gtsam::NonlinearFactor::shared_ptr rekey(
+      const gtsam::KeyVector &new_keys) const override {
+    std::map<gtsam::Key, gtsam::Key> rekey_mapping;
+    for (size_t i = 0; i < size(); i++) rekey_mapping[keys_[i]] = new_keys[i];
+    return rekey(rekey_mapping);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "LinkDynamicsFactor with " << factors_.size()
+              << " components" << std::endl;
+    for (auto &&factor : factors_) factor->print("  ", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(factors_);
+    ar &BOOST_SERIALIZATION_NVP(slots_);
+  }
+};
+
+/**
+ * Replace the analytic pose, twist, twist acceleration and wrench factors in
+ * a graph with one LinkDynamicsFactor per link. Joint factors are assigned to
+ * the child link of the joint. All other factors are kept, in order, and the
+ * fused factors are appended in order of link id.
+ *
+ * @param graph graph built with OptimizerSetting::analytic_factors.
+ */
+inline gtsam::NonlinearFactorGraph FuseLinkFactors(
+    const gtsam::NonlinearFactorGraph &graph) {
+  gtsam::NonlinearFactorGraph fused;
+  std::map<int, std::vector<gtsam::NoiseModelFactor::shared_ptr>> link_factors;
+  for (auto &&factor : graph) {
+    boost::optional<int> link_id;
+    if (auto f = boost::dynamic_pointer_cast<AnalyticPoseFactor>(factor)) {
+      link_id = f->joint()->child()->id();
+    } else if (auto f =
+                   boost::dynamic_pointer_cast<AnalyticTwistFactor>(factor)) {
+      link_id = f->joint()->child()->id();
+    } else if (auto f = boost::dynamic_pointer_cast<AnalyticTwistAccelFactor>(
+                   factor)) {
+      link_id = f->joint()->child()->id();
+    } else if (boost::dynamic_pointer_cast<AnalyticWrenchFactor>(factor)) {
+      // The first key of the wrench factor is the twist of the link.
+      link_id = DynamicsSymbol(factor->keys().front()).linkIdx();
+    }
+
+    if (link_id) {
+      link_factors[*link_id].push_back(
+          boost::static_pointer_cast<gtsam::NoiseModelFactor>(factor));
+    } else {
+      fused.push_back(factor);
+    }
+  }
+
+  for (auto &&it : link_factors) {
+    fused.emplace_shared<LinkDynamicsFactor>(it.second);
+  }
+  return fused;
+}
+
+}  // namespace gtdynamics
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
@@ -38,6 +39,9 @@ class MinTorqueFactor : public gtsam::NoiseModelFactor1<double> {
   MinTorqueFactor(gtsam::Key torque_key,
                   const gtsam::noiseModel::Base::shared_ptr &cost_model)
       : Base(cost_model, torque_key) {}
+  /// Default constructor for serialization.
+  MinTorqueFactor() {}
+
   virtual ~MinTorqueFactor() {}
 
  public:
@@ -59,7 +63,7 @@ class MinTorqueFactor : public gtsam::NoiseModelFactor1<double> {
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -74,7 +78,7 @@ class MinTorqueFactor : public gtsam::NoiseModelFactor1<double> {
   /// Serialization function
   friend class boost::serialization::access;
   template <class ARCHIVE>
-  void serialize(ARCHIVE const &ar, const unsigned int version) {
+  void serialize(ARCHIVE &ar, const unsigned int version) {
     ar &boost::serialization::make_nvp(
         "NoiseModelFactor1", boost::serialization::base_object<Base>(*this));
   }
@@ -21,6 +21,8 @@
 #include <gtsam/nonlinear/PriorFactor.h>
 
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -39,9 +41,52 @@ gtsam::NonlinearFactorGraph JointsAtRestObjectives(
   return graph;
 }
 
+// Priors on a T x J buffer of joint values, one row per time step.
+template <typename KEY>
+static gtsam::NonlinearFactorGraph JointValueObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& targets,
+    const SharedNoiseModel& model, int k, KEY key) {
+  if (targets.cols() != static_cast<int>(joint_ids.size())) {
+    throw std::invalid_argument(
+        "JointObjectives: needs one column of targets per joint id.");
+  }
+  gtsam::NonlinearFactorGraph graph;
+  graph.reserve(targets.size());
+  for (int r = 0; r < targets.rows(); r++) {
+    for (size_t c = 0; c < joint_ids.size(); c++) {
+      AddPrior<double>(&graph, key(joint_ids[c], k + r), targets(r, c), model);
+    }
+  }
+  return graph;
+}
+
+gtsam::NonlinearFactorGraph JointAngleObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& angles,
+    const SharedNoiseModel& model, int k) {
+  return JointValueObjectives(joint_ids, angles, model, k, JointAngleKey);
+}
+
+gtsam::NonlinearFactorGraph JointVelObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& vels,
+    const SharedNoiseModel& model, int k) {
+  return JointValueObjectives(joint_ids, vels, model, k, JointVelKey);
+}
+
+gtsam::NonlinearFactorGraph JointAccelObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& accels,
+    const SharedNoiseModel& model, int k) {
+  return JointValueObjectives(joint_ids, accels, model, k, JointAccelKey);
+}
+
+gtsam::NonlinearFactorGraph TorqueObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& torques,
+    const SharedNoiseModel& model, int k) {
+  return JointValueObjectives(joint_ids, torques, model, k, TorqueKey);
+}
+
 gtsam::NonlinearFactorGraph PointGoalFactors(
     const SharedNoiseModel& cost_model, const Point3& point_com,
-    const std::vector<Point3>& goal_trajectory, unsigned char i, size_t k) {
+    const std::vector<Point3>& goal_trajectory, uint16_t i, size_t k) {
   gtsam::Key key = PoseKey(i, k);
   return PointGoalFactors(key, cost_model, point_com, goal_trajectory);
 }
@@ -15,6 +15,7 @@
 
 #include <gtdynamics/factors/PointGoalFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -25,6 +26,13 @@
 
 namespace gtdynamics {
 
+/// Add a PriorFactor on key to a graph, allocated with MakeFactor.
+template <typename T>
+void AddPrior(gtsam::NonlinearFactorGraph *graph, gtsam::Key key,
+              const T &prior, const gtsam::SharedNoiseModel &model) {
+  graph->add(MakeFactor<gtsam::PriorFactor<T>>(key, prior, model));
+}
+
 /**
  * @brief Create a graph of objectives for link i at time k using proxy class
  * idiom for keyword argument -like syntax.
@@ -56,7 +64,7 @@ class LinkObjectives : public gtsam::NonlinearFactorGraph {
    */
   LinkObjectives& pose(gtsam::Pose3 pose,
                        const gtsam::SharedNoiseModel& pose_model = nullptr) {
-    addPrior<gtsam::Pose3>(PoseKey(i_, k_), pose, pose_model);
+    AddPrior<gtsam::Pose3>(this, PoseKey(i_, k_), pose, pose_model);
     return *this;
   }
   /**
@@ -66,7 +74,7 @@ class LinkObjectives : public gtsam::NonlinearFactorGraph {
    */
   LinkObjectives& twist(gtsam::Vector6 twist,
                         const gtsam::SharedNoiseModel& twist_model = nullptr) {
-    addPrior<gtsam::Vector6>(TwistKey(i_, k_), twist, twist_model);
+    AddPrior<gtsam::Vector6>(this, TwistKey(i_, k_), twist, twist_model);
     return *this;
   }
   /**
@@ -77,7 +85,7 @@ class LinkObjectives : public gtsam::NonlinearFactorGraph {
   LinkObjectives& twistAccel(
       gtsam::Vector6 twistAccel,
       const gtsam::SharedNoiseModel& twistAccel_model = nullptr) {
-    addPrior<gtsam::Vector6>(TwistAccelKey(i_, k_), twistAccel,
+    AddPrior<gtsam::Vector6>(this, TwistAccelKey(i_, k_), twistAccel,
                              twistAccel_model);
     return *this;
   }
@@ -115,7 +123,7 @@ class JointObjectives : public gtsam::NonlinearFactorGraph {
    */
   JointObjectives& angle(double angle,
                          const gtsam::SharedNoiseModel& angle_model = nullptr) {
-    addPrior<double>(JointAngleKey(j_, k_),  //
+    AddPrior<double>(this, JointAngleKey(j_, k_),  //
                      angle, angle_model);
     return *this;
   }
@@ -127,7 +135,7 @@ class JointObjectives : public gtsam::NonlinearFactorGraph {
   JointObjectives& velocity(
       double velocity,
       const gtsam::SharedNoiseModel& velocity_model = nullptr) {
-    addPrior<double>(JointVelKey(j_, k_),  //
+    AddPrior<double>(this, JointVelKey(j_, k_),  //
                      velocity, velocity_model);
     return *this;
   }
@@ -139,7 +147,7 @@ class JointObjectives : public gtsam::NonlinearFactorGraph {
   JointObjectives& acceleration(
       double acceleration,
       const gtsam::SharedNoiseModel& acceleration_model = nullptr) {
-    addPrior<double>(JointAccelKey(j_, k_),  //
+    AddPrior<double>(this, JointAccelKey(j_, k_),  //
                      acceleration, acceleration_model);
     return *this;
   }
@@ -157,6 +165,32 @@ gtsam::NonlinearFactorGraph JointsAtRestObjectives(
     const Robot& robot, const gtsam::SharedNoiseModel& joint_velocity_model,
     const gtsam::SharedNoiseModel& joint_acceleration_model, int k = 0);
 
+/**
+ * @brief  Create a graph of joint angle priors, one per joint and time step.
+ * @param joint_ids The joint ids, one per column of angles
+ * @param angles T x J target angles, one row per time step k, k + 1, ...
+ * @param model The noise model of every prior
+ * @param k starting time index (default 0).
+ */
+gtsam::NonlinearFactorGraph JointAngleObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& angles,
+    const gtsam::SharedNoiseModel& model, int k = 0);
+
+/// Create a graph of joint velocity priors, see JointAngleObjectives.
+gtsam::NonlinearFactorGraph JointVelObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& vels,
+    const gtsam::SharedNoiseModel& model, int k = 0);
+
+/// Create a graph of joint acceleration priors, see JointAngleObjectives.
+gtsam::NonlinearFactorGraph JointAccelObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& accels,
+    const gtsam::SharedNoiseModel& model, int k = 0);
+
+/// Create a graph of joint torque priors, see JointAngleObjectives.
+gtsam::NonlinearFactorGraph TorqueObjectives(
+    const std::vector<int>& joint_ids, const gtsam::Matrix& torques,
+    const gtsam::SharedNoiseModel& model, int k = 0);
+
 /**
  * @brief  Create a graph of PointGoalFactors given a trajectory.
  * @param cost_model noise model
@@ -167,7 +201,8 @@ gtsam::NonlinearFactorGraph JointsAtRestObjectives(
  */
 gtsam::NonlinearFactorGraph PointGoalFactors(
     const gtsam::SharedNoiseModel& cost_model, const gtsam::Point3& point_com,
-    const std::vector<gtsam::Point3>& goal_trajectory, uint8_t i, size_t k = 0);
+    const std::vector<gtsam::Point3>& goal_trajectory, uint16_t i,
+    size_t k = 0);
 
 /**
  * @brief Create stance foot trajectory.
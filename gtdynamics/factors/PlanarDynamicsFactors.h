@@ -0,0 +1,404 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsFactors.h
+ * @brief Kinematics and dynamics factors of planar robots, on Pose2 poses
+ * and 3-vector twists, accelerations and wrenches.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/PlanarDynamics.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * PlanarPoseFactor relates the poses of the parent and child links of a
+ * joint, Log(wTc^-1 * wTp * pTc(q)).
+ */
+class PlanarPoseFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Pose2, gtsam::Pose2, double> {
+ private:
+  using This = PlanarPoseFactor;
+  using Base = gtsam::NoiseModelFactor3<gtsam::Pose2, gtsam::Pose2, double>;
+
+  PlanarJoint joint_;
+
+ public:
+  /// Constructor, for the joint at time step t.
+  PlanarPoseFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                   const PlanarJoint &joint, int t)
+      : Base(cost_model, PoseKey(joint.parent_id, t),
+             PoseKey(joint.child_id, t), JointAngleKey(joint.id, t)),
+        joint_(joint) {}
+
+  virtual ~PlanarPoseFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose2 &wTp, const gtsam::Pose2 &wTc, const double &q,
+      boost::optional<gtsam::Matrix &> H_wTp = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTc = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Matrix31 pTc_H_q;
+    gtsam::Matrix3 hat_H_wTp, hat_H_pTc, e_H_wTc, e_H_hat, log_H_e;
+    const gtsam::Pose2 pTc = joint_.parentTchild(q, pTc_H_q);
+    const gtsam::Pose2 wTc_hat = wTp.compose(pTc, hat_H_wTp, hat_H_pTc);
+    const gtsam::Pose2 e = wTc.between(wTc_hat, e_H_wTc, e_H_hat);
+    const gtsam::Vector3 error = gtsam::Pose2::Logmap(e, log_H_e);
+    if (H_wTp) *H_wTp = log_H_e * e_H_hat * hat_H_wTp;
+    if (H_wTc) *H_wTc = log_H_e * e_H_wTc;
+    if (H_q) *H_q = log_H_e * e_H_hat * hat_H_pTc * pTc_H_q;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "PlanarPoseFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * PlanarTwistFactor relates the twists of the parent and child links of a
+ * joint, Ad(cTp) * V_p + S * q_dot - V_c.
+ */
+class PlanarTwistFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Vector3, gtsam::Vector3, double,
+                                      double> {
+ private:
+  using This = PlanarTwistFactor;
+  using Base = gtsam::NoiseModelFactor4<gtsam::Vector3, gtsam::Vector3,
+                                        double, double>;
+
+  PlanarJoint joint_;
+
+ public:
+  /// Constructor, for the joint at time step t.
+  PlanarTwistFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                    const PlanarJoint &joint, int t)
+      : Base(cost_model, TwistKey(joint.parent_id, t),
+             TwistKey(joint.child_id, t), JointAngleKey(joint.id, t),
+             JointVelKey(joint.id, t)),
+        joint_(joint) {}
+
+  virtual ~PlanarTwistFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &twist_p, const gtsam::Vector3 &twist_c,
+      const double &q, const double &q_dot,
+      boost::optional<gtsam::Matrix &> H_twist_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none) const override {
+    gtsam::Matrix3 H_p;
+    gtsam::Matrix31 H_angle, H_vel;
+    const gtsam::Vector3 twist_c_hat =
+        joint_.childTwist(twist_p, q, q_dot, H_p, H_angle, H_vel);
+    if (H_twist_p) *H_twist_p = H_p;
+    if (H_twist_c) *H_twist_c = -gtsam::I_3x3;
+    if (H_q) *H_q = H_angle;
+    if (H_q_dot) *H_q_dot = H_vel;
+    return twist_c_hat - twist_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "PlanarTwistFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * PlanarTwistAccelFactor relates the twist accelerations of the parent and
+ * child links of a joint, Ad(cTp) * A_p + ad(V_c) * S * q_dot + S * q_ddot
+ * - A_c.
+ */
+class PlanarTwistAccelFactor
+    : public gtsam::NoiseModelFactor6<gtsam::Vector3, gtsam::Vector3,
+                                      gtsam::Vector3, double, double, double> {
+ private:
+  using This = PlanarTwistAccelFactor;
+  using Base = gtsam::NoiseModelFactor6<gtsam::Vector3, gtsam::Vector3,
+                                        gtsam::Vector3, double, double, double>;
+
+  PlanarJoint joint_;
+
+ public:
+  /// Constructor, for the joint at time step t.
+  PlanarTwistAccelFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const PlanarJoint &joint, int t)
+      : Base(cost_model, TwistKey(joint.child_id, t),
+             TwistAccelKey(joint.parent_id, t),
+             TwistAccelKey(joint.child_id, t), JointAngleKey(joint.id, t),
+             JointVelKey(joint.id, t), JointAccelKey(joint.id, t)),
+        joint_(joint) {}
+
+  virtual ~PlanarTwistAccelFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &twist_c, const gtsam::Vector3 &accel_p,
+      const gtsam::Vector3 &accel_c, const double &q, const double &q_dot,
+      const double &q_ddot,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_ddot = boost::none) const override {
+    // Ad(cTp) * A_p + S * q_ddot transforms as a twist.
+    gtsam::Matrix3 H_p;
+    gtsam::Matrix31 H_angle, H_acc;
+    const gtsam::Vector3 &S = joint_.screw_axis;
+    const gtsam::Vector3 error =
+        joint_.childTwist(accel_p, q, q_ddot, H_p, H_angle, H_acc) +
+        gtsam::Pose2::adjointMap(twist_c) * S * q_dot - accel_c;
+    if (H_twist_c) *H_twist_c = -gtsam::Pose2::adjointMap(S) * q_dot;
+    if (H_accel_p) *H_accel_p = H_p;
+    if (H_accel_c) *H_accel_c = -gtsam::I_3x3;
+    if (H_q) *H_q = H_angle;
+    if (H_q_dot) *H_q_dot = gtsam::Pose2::adjointMap(twist_c) * S;
+    if (H_q_ddot) *H_q_ddot = H_acc;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "PlanarTwistAccelFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * PlanarWrenchFactor is the wrench balance of a link,
+ * ad(V)^T * G * V - G * A + sum(F_j) + F_gravity.
+ *
+ * Keys are ordered as: twist, twist acceleration, wrenches, and the link pose
+ * if gravity is given.
+ */
+class PlanarWrenchFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = PlanarWrenchFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  PlanarLink link_;
+  boost::optional<gtsam::Vector2> gravity_;
+
+  /// Return all keys of the factor.
+  static gtsam::KeyVector Keys(int i, const std::vector<gtsam::Key> &wrenches,
+                               int t, bool gravity) {
+    gtsam::KeyVector keys{TwistKey(i, t), TwistAccelKey(i, t)};
+    keys.insert(keys.end(), wrenches.begin(), wrenches.end());
+    if (gravity) keys.push_back(PoseKey(i, t));
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model  The noise model for this factor.
+   * @param link        The planar link.
+   * @param wrenches    Keys of the wrenches acting on the link.
+   * @param t           The time step at which this factor is defined.
+   * @param gravity     (optional) in-plane gravity in the world frame.
+   */
+  PlanarWrenchFactor(const gtsam::SharedNoiseModel &cost_model,
+                     const PlanarLink &link,
+                     const std::vector<gtsam::Key> &wrenches, int t,
+                     const boost::optional<gtsam::Vector2> &gravity =
+                         boost::none)
+      : Base(cost_model,
+             Keys(link.id, wrenches, t, static_cast<bool>(gravity))),
+        link_(link),
+        gravity_(gravity) {}
+
+  virtual ~PlanarWrenchFactor() {}
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override {
+    const size_t num_wrenches = size() - 2 - (gravity_ ? 1 : 0);
+    const gtsam::Vector3 twist = x.at<gtsam::Vector3>(keys_[0]);
+    const gtsam::Vector3 accel = x.at<gtsam::Vector3>(keys_[1]);
+    const gtsam::Matrix3 G = link_.inertiaMatrix();
+
+    gtsam::Matrix3 H_twist, H_pose;
+    gtsam::Vector3 error =
+        link_.coriolis(twist, H ? &H_twist : 0) - G * accel;
+    for (size_t i = 0; i < num_wrenches; i++) {
+      error += x.at<gtsam::Vector3>(keys_[2 + i]);
+    }
+    if (gravity_) {
+      error += link_.gravityWrench(*gravity_, x.at<gtsam::Pose2>(keys_.back()),
+                                   H ? &H_pose : 0);
+    }
+
+    if (H) {
+      H->resize(size());
+      (*H)[0] = H_twist;
+      (*H)[1] = -G;
+      for (size_t i = 0; i < num_wrenches; i++) (*H)[2 + i] = gtsam::I_3x3;
+      if (gravity_) H->back() = H_pose;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "PlanarWrenchFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * PlanarWrenchEquivalenceFactor enforces that the wrenches a joint applies
+ * on its parent and child links cancel, F_p + Ad(cTp)^T * F_c.
+ */
+class PlanarWrenchEquivalenceFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Vector3, gtsam::Vector3, double> {
+ private:
+  using This = PlanarWrenchEquivalenceFactor;
+  using Base =
+      gtsam::NoiseModelFactor3<gtsam::Vector3, gtsam::Vector3, double>;
+
+  PlanarJoint joint_;
+
+ public:
+  /// Constructor, for the joint at time step t.
+  PlanarWrenchEquivalenceFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const PlanarJoint &joint, int t)
+      : Base(cost_model, WrenchKey(joint.parent_id, joint.id, t),
+             WrenchKey(joint.child_id, joint.id, t),
+             JointAngleKey(joint.id, t)),
+        joint_(joint) {}
+
+  virtual ~PlanarWrenchEquivalenceFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &wrench_p, const gtsam::Vector3 &wrench_c,
+      const double &q,
+      boost::optional<gtsam::Matrix &> H_wrench_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_wrench_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Matrix3 H_c;
+    gtsam::Matrix31 H_angle;
+    const gtsam::Vector3 error =
+        wrench_p - joint_.parentWrench(wrench_c, q, H_c, H_angle);
+    if (H_wrench_p) *H_wrench_p = gtsam::I_3x3;
+    if (H_wrench_c) *H_wrench_c = -H_c;
+    if (H_q) *H_q = -H_angle;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "PlanarWrenchEquivalenceFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * PlanarTorqueFactor relates the joint torque to the wrench on the child
+ * link, S^T * F_c - tau.
+ */
+class PlanarTorqueFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Vector3, double> {
+ private:
+  using This = PlanarTorqueFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Vector3, double>;
+
+  gtsam::Vector3 screw_axis_;
+
+ public:
+  /// Constructor, for the joint at time step t.
+  PlanarTorqueFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                     const PlanarJoint &joint, int t)
+      : Base(cost_model, WrenchKey(joint.child_id, joint.id, t),
+             TorqueKey(joint.id, t)),
+        screw_axis_(joint.screw_axis) {}
+
+  virtual ~PlanarTorqueFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &wrench, const double &torque,
+      boost::optional<gtsam::Matrix &> H_wrench = boost::none,
+      boost::optional<gtsam::Matrix &> H_torque = boost::none) const override {
+    if (H_wrench) *H_wrench = screw_axis_.transpose();
+    if (H_torque) *H_torque = -gtsam::I_1x1;
+    return gtsam::Vector1(screw_axis_.dot(wrench) - torque);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "PlanarTorqueFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
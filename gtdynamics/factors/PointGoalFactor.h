@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -44,10 +45,10 @@ inline gtsam::Vector3_ PointGoalConstraint(gtsam::Key pose_key,
   return error;
 }
 
-class PointGoalFactor : public gtsam::ExpressionFactor<gtsam::Vector3> {
+class PointGoalFactor : public CompiledExpressionFactor<gtsam::Vector3> {
  private:
   using This = PointGoalFactor;
-  using Base = gtsam::ExpressionFactor<gtsam::Vector3>;
+  using Base = CompiledExpressionFactor<gtsam::Vector3>;
   gtsam::Point3 goal_point_;
 
  public:
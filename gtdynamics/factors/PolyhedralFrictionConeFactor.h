@@ -0,0 +1,157 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PolyhedralFrictionConeFactor.h
+ * @brief Friction cone approximated by a pyramid with a given number of facets.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * PolyhedralFrictionConeFactor is a binary factor which keeps the linear
+ * contact force inside an N-sided pyramid inscribed in the friction cone,
+ * as a cheaper alternative to ContactDynamicsFrictionConeFactor.
+ *
+ * With n the up direction, opposite to gravity, and t_i, i = 0..N-1, unit
+ * tangents at angles 2 pi i / N, facet i is the half-space
+ * (t_i - mu cos(pi / N) n)' f <= 0, where f is the contact force in the
+ * world frame. The error has one hinge per facet, which is zero inside, so is
+ * piecewise linear in f. Together the facets also imply n' f >= 0.
+ */
+class PolyhedralFrictionConeFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6> {
+ private:
+  using This = PolyhedralFrictionConeFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6>;
+
+  gtsam::Matrix facets_;  // N x 3, one facet normal per row, world frame
+
+ public:
+  /**
+   * Constructor
+   * @param pose_key Key corresponding to the link's CoM pose.
+   * @param contact_wrench_key Key corresponding to this link's contact wrench.
+   * @param cost_model Noise model of dimension num_facets.
+   * @param mu Static friction coefficient.
+   * @param gravity Gravity vector, defines the up direction; +z if zero.
+   * @param num_facets Number of sides N of the pyramid, at least 3.
+   */
+  PolyhedralFrictionConeFactor(
+      gtsam::Key pose_key, gtsam::Key contact_wrench_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model, double mu,
+      const gtsam::Vector3 &gravity, size_t num_facets = 4)
+      : Base(cost_model, pose_key, contact_wrench_key),
+        facets_(num_facets, 3) {
+    if (num_facets < 3) {
+      throw std::invalid_argument(
+          "PolyhedralFrictionConeFactor: need at least 3 facets.");
+    }
+    const gtsam::Vector3 n = gravity.norm() > 0
+                                 ? gtsam::Vector3(-gravity.normalized())
+                                 : gtsam::Vector3::UnitZ();
+    // Any tangent basis will do, start from the axis least aligned with n.
+    gtsam::Vector3 axis = gtsam::Vector3::Zero();
+    Eigen::Index least;
+    n.cwiseAbs().minCoeff(&least);
+    axis(least) = 1;
+    const gtsam::Vector3 t1 = n.cross(axis).normalized(), t2 = n.cross(t1);
+
+    const double mu_inscribed = mu * std::cos(M_PI / num_facets);
+    for (size_t i = 0; i < num_facets; i++) {
+      const double angle = 2 * M_PI * i / num_facets;
+      const gtsam::Vector3 t = std::cos(angle) * t1 + std::sin(angle) * t2;
+      facets_.row(i) = (t - mu_inscribed * n).transpose();
+    }
+  }
+  virtual ~PolyhedralFrictionConeFactor() {}
+
+  /// Return the facet normals in the world frame, one per row, so that the
+  /// cone is facets() * f <= 0, e.g. for linear inequality constraints.
+  const gtsam::Matrix &facets() const { return facets_; }
+
+  /**
+   * Evaluate the facet violations.
+   * @param pose CoM pose of the link.
+   * @param contact_wrench Contact wrench on this link, in the CoM frame.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose, const gtsam::Vector6 &contact_wrench,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none,
+      boost::optional<gtsam::Matrix &> H_contact_wrench =
+          boost::none) const override {
+    const gtsam::Vector3 f_c = contact_wrench.tail<3>();
+
+    // Contact force in the world frame.
+    gtsam::Matrix36 H_rotation;
+    gtsam::Matrix3 H_R, H_f_c;
+    const gtsam::Vector3 f_s =
+        pose.rotation(H_pose ? &H_rotation : nullptr)
+            .rotate(f_c, H_pose ? &H_R : nullptr,
+                    H_contact_wrench ? &H_f_c : nullptr);
+
+    // Hinge on each facet, inactive facets have zero Jacobian rows.
+    const size_t N = facets_.rows();
+    gtsam::Vector error = facets_ * f_s;
+    for (size_t i = 0; i < N; i++) {
+      if (error(i) <= 0) error(i) = 0;
+    }
+    if (!H_pose && !H_contact_wrench) return error;
+
+    gtsam::Matrix H_f_s = facets_;
+    for (size_t i = 0; i < N; i++) {
+      if (error(i) <= 0) H_f_s.row(i).setZero();
+    }
+    if (H_pose) *H_pose = H_f_s * H_R * H_rotation;
+    if (H_contact_wrench) {
+      *H_contact_wrench = gtsam::Matrix::Zero(N, 6);
+      H_contact_wrench->rightCols<3>() = H_f_s * H_f_c;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Polyhedral Friction Cone Factor, " << facets_.rows()
+              << " facets" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE const &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor2", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(facets_);
+  }
+};
+
+}  // namespace gtdynamics
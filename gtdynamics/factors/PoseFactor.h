@@ -13,8 +13,11 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/OptionalJacobian.h>
 #include <gtsam/base/Vector.h>
@@ -23,6 +26,8 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
 #include <boost/assign/list_of.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
 #include <memory>
 #include <string>
 
@@ -48,7 +53,7 @@ using boost::assign::cref_list_of;
 inline gtsam::NoiseModelFactor::shared_ptr PoseFactor(
     const gtsam::SharedNoiseModel &cost_model, const JointConstSharedPtr &joint,
     int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+  return MakeFactor<CompiledExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(), joint->poseConstraint(time));
 }
 
@@ -67,9 +72,88 @@ inline gtsam::NoiseModelFactor::shared_ptr PoseFactor(
     DynamicsSymbol wTp_key, DynamicsSymbol wTc_key, DynamicsSymbol q_key,
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     JointConstSharedPtr joint) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+  return MakeFactor<CompiledExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(),
       joint->poseConstraint(wTp_key.time()));
 }
 
+/**
+ * AnalyticPoseFactor is the same constraint as PoseFactor, but with
+ * hand-written fixed-size Jacobians instead of an expression tree.
+ */
+class AnalyticPoseFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, double> {
+ private:
+  using This = AnalyticPoseFactor;
+  using Base = gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint connecting the two poses.
+   * @param time The timestep at which this factor is defined.
+   */
+  AnalyticPoseFactor(const gtsam::SharedNoiseModel &cost_model,
+                     const JointConstSharedPtr &joint, int time)
+      : Base(cost_model, PoseKey(joint->parent()->id(), time),
+             PoseKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time)),
+        joint_(joint) {}
+
+  virtual ~AnalyticPoseFactor() {}
+
+  /// Return the joint.
+  const JointConstSharedPtr &joint() const { return joint_; }
+
+  /**
+   * Evaluate pose error, logmap(wTc^{-1} * wTp * pTc(q)).
+   * @param wTp parent link pose
+   * @param wTc child link pose
+   * @param q joint angle
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTp, const gtsam::Pose3 &wTc, const double &q,
+      boost::optional<gtsam::Matrix &> H_wTp = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTc = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Vector6 pTc_H_q;
+    gtsam::Matrix6 wTc_hat_H_wTp, wTc_hat_H_pTc, error_H_wTc, error_H_wTc_hat;
+    const gtsam::Pose3 pTc = joint_->parentTchild(q, H_q ? &pTc_H_q : 0);
+    const gtsam::Pose3 wTc_hat = wTp.compose(
+        pTc, H_wTp ? &wTc_hat_H_wTp : 0, H_q ? &wTc_hat_H_pTc : 0);
+    gtsam::Vector6 error = wTc.logmap(wTc_hat, H_wTc ? &error_H_wTc : 0,
+                                      (H_wTp || H_q) ? &error_H_wTc_hat : 0);
+    if (H_wTp) *H_wTp = error_H_wTc_hat * wTc_hat_H_wTp;
+    if (H_wTc) *H_wTc = error_H_wTc;
+    if (H_q) *H_q = error_H_wTc_hat * wTc_hat_H_pTc * pTc_H_q;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "AnalyticPoseFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor3", boost::serialization::base_object<Base>(*this));
+  }
+};
+
 }  // namespace gtdynamics
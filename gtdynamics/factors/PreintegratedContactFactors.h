@@ -15,6 +15,7 @@
 
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/OptionalJacobian.h>
 #include <gtsam/base/Vector.h>
@@ -31,17 +32,35 @@ namespace gtdynamics {
 /**
  * Class to perform preintegration of contact measurements for a point foot
  * model.
+ *
+ * Measurements can be streamed one at a time, at the rate of the contact or
+ * leg odometry sensor, as with gtsam::PreintegratedImuMeasurements: each
+ * integrateMeasurement call is a constant-time update of the covariance, and
+ * resetIntegration starts a new interval once a factor has been created.
  */
 class PreintegratedPointContactMeasurements {
   /// The preintegrated measurement covariance
-  gtsam::Matrix3 preintMeasCov_;
+  gtsam::Matrix3 preintMeasCov_ = gtsam::Matrix3::Zero();
 
   /// The covariance of the discrete contact noise, aka Σvd in the paper
-  gtsam::Matrix3 vdCov_;
+  gtsam::Matrix3 vdCov_ = gtsam::Matrix3::Zero();
+
+  /// Time interval integrated so far
+  double deltaTij_ = 0.0;
 
  public:
   PreintegratedPointContactMeasurements() {}
 
+  /**
+   * @brief Construct an empty preintegration, to stream measurements into.
+   *
+   * @param discreteVelocityCovariance The covariance matrix for the discrete
+   * velocity of the contact frame.
+   */
+  explicit PreintegratedPointContactMeasurements(
+      const gtsam::Matrix3 &discreteVelocityCovariance)
+      : vdCov_(discreteVelocityCovariance) {}
+
   /**
    * @brief Construct a new Preintegrated Point Contact Measurements object.
    * We initialize it with the measurement at the first step.
@@ -56,7 +75,7 @@ class PreintegratedPointContactMeasurements {
   PreintegratedPointContactMeasurements(
       const gtsam::Pose3 &base_k, const gtsam::Pose3 &contact_k, double dt,
       const gtsam::Matrix3 &discreteVelocityCovariance)
-      : vdCov_(discreteVelocityCovariance) {
+      : vdCov_(discreteVelocityCovariance), deltaTij_(dt) {
     // Propagate measurement for the first step, i.e. when k = i.
     gtsam::Matrix3 B =
         base_k.rotation().transpose() * contact_k.rotation().matrix() * dt;
@@ -66,6 +85,12 @@ class PreintegratedPointContactMeasurements {
   /// Virtual destructor for serialization
   ~PreintegratedPointContactMeasurements() {}
 
+  /// Start a new interval, keeping the noise parameters.
+  void resetIntegration() {
+    preintMeasCov_.setZero();
+    deltaTij_ = 0.0;
+  }
+
   /**
    * @brief Add a single slip/noise measurement to the preintegration.
    *
@@ -76,11 +101,29 @@ class PreintegratedPointContactMeasurements {
    */
   void integrateMeasurement(const gtsam::Rot3 &deltaRik,
                             const gtsam::Pose3 &contact_k, const double dt) {
-    gtsam::Matrix3 B = (deltaRik * contact_k.rotation()).matrix() * dt;
-    preintMeasCov_ = preintMeasCov_ + (B * vdCov_ * B.transpose());
+    const gtsam::Matrix3 B = (deltaRik * contact_k.rotation()).matrix() * dt;
+    preintMeasCov_.noalias() += B * vdCov_ * B.transpose();
+    deltaTij_ += dt;
+  }
+
+  /**
+   * @brief Add a measurement in step with an IMU preintegration, after it
+   * has integrated the IMU measurements up to the time of this one.
+   *
+   * @param pim The IMU preintegration over the same interval, which gives
+   * the rotation delta and the time step since the last contact measurement.
+   * @param contact_k The pose of the contact frame at k obtained via forward
+   * kinematics.
+   */
+  void integrateMeasurement(const gtsam::PreintegratedImuMeasurements &pim,
+                            const gtsam::Pose3 &contact_k) {
+    integrateMeasurement(pim.deltaRij(), contact_k, pim.deltaTij() - deltaTij_);
   }
 
   gtsam::Matrix3 preintMeasCov() const { return preintMeasCov_; }
+
+  /// Return the time interval integrated so far.
+  double deltaTij() const { return deltaTij_; }
 };
 
 /**
@@ -173,7 +216,7 @@ class PreintegratedPointContactFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
@@ -198,10 +241,15 @@ class PreintegratedPointContactFactor
 /**
  * Class to perform preintegration of contact measurements for a rigid foot
  * model.
+ *
+ * As for the point foot, measurements can be streamed one at a time, each
+ * integrateMeasurement call being a constant-time update, and
+ * resetIntegration starts a new interval.
  */
 class PreintegratedRigidContactMeasurements {
-  gtsam::Matrix6 preintMeasCov_;
-  gtsam::Matrix3 wCov_, vCov_;
+  gtsam::Matrix6 preintMeasCov_ = gtsam::Matrix6::Zero();
+  gtsam::Matrix3 wCov_ = gtsam::Matrix3::Zero(), vCov_ = gtsam::Matrix3::Zero();
+  double deltaTij_ = 0.0;
 
  public:
   PreintegratedRigidContactMeasurements() {}
@@ -217,13 +265,17 @@ class PreintegratedRigidContactMeasurements {
   PreintegratedRigidContactMeasurements(
       const gtsam::Matrix3 &angularVelocityCovariance,
       const gtsam::Matrix3 &linearVelocityCovariance)
-      : wCov_(angularVelocityCovariance), vCov_(linearVelocityCovariance) {
-    preintMeasCov_.setZero();
-  }
+      : wCov_(angularVelocityCovariance), vCov_(linearVelocityCovariance) {}
 
   /// Virtual destructor for serialization
   ~PreintegratedRigidContactMeasurements() {}
 
+  /// Start a new interval, keeping the noise parameters.
+  void resetIntegration() {
+    preintMeasCov_.setZero();
+    deltaTij_ = 0.0;
+  }
+
   /**
    * @brief Integrate a new measurement with time varying contact noise.
    *
@@ -236,24 +288,31 @@ class PreintegratedRigidContactMeasurements {
   void integrateMeasurement(const gtsam::Matrix3 &angularVelocityCovariance,
                             const gtsam::Matrix3 &linearVelocityCovariance,
                             double dt) {
-    gtsam::Matrix6 C;
-    C << angularVelocityCovariance, gtsam::Z_3x3, gtsam::Z_3x3,
-        linearVelocityCovariance;
-    preintMeasCov_ += (C * dt * dt);
+    // The covariance is block diagonal, so only update the diagonal blocks.
+    const double dt2 = dt * dt;
+    preintMeasCov_.topLeftCorner<3, 3>() += angularVelocityCovariance * dt2;
+    preintMeasCov_.bottomRightCorner<3, 3>() += linearVelocityCovariance * dt2;
+    deltaTij_ += dt;
   }
 
   /**
-   * @brief Integrate a new measurement with constant contact noise.
+   * @brief Integrate a new measurement with constant contact noise. The
+   * covariance grows linearly with time, so integrating the whole interval
+   * at once or in steps gives the same result.
    *
-   * @param deltaT Time interval between the initial and the final contact time
-   * steps.
+   * @param dt Time interval between this and the last measurement, or
+   * between the initial and the final contact time steps.
    */
-  void integrateMeasurement(double deltaT) {
-    preintMeasCov_ << wCov_, gtsam::Z_3x3, gtsam::Z_3x3, vCov_;
-    preintMeasCov_ *= deltaT;
+  void integrateMeasurement(double dt) {
+    preintMeasCov_.topLeftCorner<3, 3>() += wCov_ * dt;
+    preintMeasCov_.bottomRightCorner<3, 3>() += vCov_ * dt;
+    deltaTij_ += dt;
   }
 
   gtsam::Matrix6 preintMeasCov() const { return preintMeasCov_; }
+
+  /// Return the time interval integrated so far.
+  double deltaTij() const { return deltaTij_; }
 };
 
 /**
@@ -289,7 +348,7 @@ class PreintegratedRigidContactFactor
   //// @return a deep copy of this factor
   gtsam::NonlinearFactor::shared_ptr clone() const override {
     return boost::static_pointer_cast<gtsam::NonlinearFactor>(
-        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+        MakeFactor<This>(*this));
   }
 
   /// print contents
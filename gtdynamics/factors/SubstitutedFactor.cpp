@@ -0,0 +1,169 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SubstitutedFactor.cpp
+ * @brief Prune variables pinned by hard constraints out of factor graphs.
+ */
+
+#include <gtdynamics/factors/SubstitutedFactor.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <boost/make_shared.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactor;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+// Return the keys of a factor without the known ones.
+static KeyVector FreeKeys(const NonlinearFactor& factor, const Values& known) {
+  KeyVector keys;
+  for (Key key : factor.keys()) {
+    if (!known.exists(key)) keys.push_back(key);
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+SubstitutedFactor::SubstitutedFactor(const NonlinearFactor::shared_ptr& factor,
+                                     const Values& known)
+    : Base(FreeKeys(*factor, known)), factor_(factor) {
+  if (auto substituted = boost::dynamic_pointer_cast<This>(factor)) {
+    factor_ = substituted->factor_;
+    known_ = substituted->known_;
+  }
+  for (Key key : factor_->keys()) {
+    if (known.exists(key) && !known_.exists(key)) {
+      known_.insert(key, known.at(key));
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values SubstitutedFactor::substituted(const Values& values) const {
+  Values result;
+  for (Key key : factor_->keys()) {
+    result.insert(key, known_.exists(key) ? known_.at(key) : values.at(key));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> SubstitutedFactor::linearize(
+    const Values& values) const {
+  auto linear = factor_->linearize(substituted(values));
+  if (!linear) return linear;
+  auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(linear);
+  if (!jacobian) {
+    throw std::invalid_argument(
+        "SubstitutedFactor: the wrapped factor must linearize to a "
+        "JacobianFactor.");
+  }
+  std::vector<std::pair<Key, gtsam::Matrix>> terms;
+  for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+    if (!known_.exists(*it)) terms.emplace_back(*it, jacobian->getA(it));
+  }
+  return boost::make_shared<gtsam::JacobianFactor>(terms, jacobian->getb(),
+                                                   jacobian->get_model());
+}
+
+/* ************************************************************************* */
+// Insert the value of a prior of type T on a stiff enough model, if any.
+template <class T>
+static bool InsertPrior(const NonlinearFactor::shared_ptr& factor,
+                        double max_sigma, Values* pinned) {
+  auto prior = boost::dynamic_pointer_cast<gtsam::PriorFactor<T>>(factor);
+  if (!prior) return false;
+  auto diagonal = boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+      prior->noiseModel());
+  const Key key = prior->key();
+  if (diagonal && diagonal->sigmas().maxCoeff() <= max_sigma &&
+      !pinned->exists(key)) {
+    pinned->insert(key, prior->prior());
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+Values HardPriorValues(const NonlinearFactorGraph& graph, double max_sigma) {
+  Values pinned;
+  for (const auto& factor : graph) {
+    if (!factor || factor->size() != 1) continue;
+    InsertPrior<double>(factor, max_sigma, &pinned) ||
+        InsertPrior<gtsam::Vector>(factor, max_sigma, &pinned) ||
+        InsertPrior<gtsam::Vector3>(factor, max_sigma, &pinned) ||
+        InsertPrior<gtsam::Vector6>(factor, max_sigma, &pinned) ||
+        InsertPrior<gtsam::Rot3>(factor, max_sigma, &pinned) ||
+        InsertPrior<gtsam::Pose3>(factor, max_sigma, &pinned);
+  }
+  return pinned;
+}
+
+/* ************************************************************************* */
+Values PrunedGraph::free(const Values& values) const {
+  Values result;
+  for (const auto& key_value : values) {
+    if (!pinned.exists(key_value.key)) {
+      result.insert(key_value.key, key_value.value);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values PrunedGraph::restore(const Values& values) const {
+  Values result = values;
+  for (const auto& key_value : pinned) {
+    if (!result.exists(key_value.key)) {
+      result.insert(key_value.key, key_value.value);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+PrunedGraph PruneVariables(const NonlinearFactorGraph& graph,
+                           const Values& known) {
+  PrunedGraph pruned;
+  for (const auto& factor : graph) {
+    if (!factor) continue;
+    size_t num_known = 0;
+    for (Key key : factor->keys()) {
+      if (known.exists(key)) {
+        num_known++;
+        if (!pruned.pinned.exists(key)) {
+          pruned.pinned.insert(key, known.at(key));
+        }
+      }
+    }
+    if (num_known == 0) {
+      pruned.graph.push_back(factor);
+    } else if (num_known < factor->size()) {
+      pruned.graph.emplace_shared<SubstitutedFactor>(factor, known);
+    }
+  }
+  return pruned;
+}
+
+/* ************************************************************************* */
+PrunedGraph PruneHardPriors(const NonlinearFactorGraph& graph,
+                            double max_sigma) {
+  return PruneVariables(graph, HardPriorValues(graph, max_sigma));
+}
+
+}  // namespace gtdynamics
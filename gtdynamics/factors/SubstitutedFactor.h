@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SubstitutedFactor.h
+ * @brief Prune variables pinned by hard constraints out of factor graphs.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * SubstitutedFactor is a factor with some of its variables replaced by known
+ * values. It is a factor on the remaining keys only, and evaluates the
+ * wrapped factor with the known values inserted; its linearization keeps the
+ * Jacobian blocks of the remaining keys, with the same right-hand side and
+ * noise model. Substituting into a SubstitutedFactor again wraps the
+ * original factor with all known values.
+ */
+class SubstitutedFactor : public gtsam::NonlinearFactor {
+ private:
+  using This = SubstitutedFactor;
+  using Base = gtsam::NonlinearFactor;
+
+  gtsam::NonlinearFactor::shared_ptr factor_;
+  gtsam::Values known_;
+
+  // Return the values of all keys of factor_.
+  gtsam::Values substituted(const gtsam::Values& values) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param factor  the factor to substitute into
+   * @param known   values of some of its keys; other values are ignored
+   */
+  SubstitutedFactor(const gtsam::NonlinearFactor::shared_ptr& factor,
+                    const gtsam::Values& known);
+
+  /// Return the wrapped factor, on all its keys.
+  const gtsam::NonlinearFactor::shared_ptr& factor() const { return factor_; }
+
+  /// Return the values substituted for the keys not in this factor.
+  const gtsam::Values& known() const { return known_; }
+
+  /// Return the error of the wrapped factor.
+  double error(const gtsam::Values& values) const override {
+    return factor_->error(substituted(values));
+  }
+
+  /// Return the dimension of the wrapped factor.
+  size_t dim() const override { return factor_->dim(); }
+
+  /**
+   * Return the linearization of the wrapped factor, without the blocks of
+   * the known keys.
+   * @throws std::invalid_argument if it is not a JacobianFactor.
+   */
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values& values) const override;
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string& s = "",
+             const gtsam::KeyFormatter& keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "substituted factor, " << known_.size()
+              << " known values" << std::endl;
+    factor_->print("", keyFormatter);
+  }
+};
+
+/**
+ * Return the variables pinned by the priors of a graph: the values of the
+ * PriorFactor factors, of the types of trajectory variables (double,
+ * Vector, Vector3, Vector6, Rot3 and Pose3), whose noise model is
+ * Constrained with all sigmas zero, or diagonal with all sigmas at most
+ * max_sigma, e.g., the pose, twist and acceleration priors of fixed links.
+ * With several priors on a key, the first one wins.
+ * @param graph      the factor graph
+ * @param max_sigma  largest sigma of a prior taken as a hard constraint
+ */
+gtsam::Values HardPriorValues(const gtsam::NonlinearFactorGraph& graph,
+                              double max_sigma = 0);
+
+/// A graph with its pinned variables substituted out.
+struct PrunedGraph {
+  /// Factors on the free variables only.
+  gtsam::NonlinearFactorGraph graph;
+
+  /// The values of the pruned variables.
+  gtsam::Values pinned;
+
+  /// Return the values without the pruned variables, e.g., to initialize.
+  gtsam::Values free(const gtsam::Values& values) const;
+
+  /// Return the values of the free variables with the pruned ones added.
+  gtsam::Values restore(const gtsam::Values& values) const;
+};
+
+/**
+ * Substitute known values for variables of a graph before optimization.
+ * Factors on known keys only are dropped, factors on both known and free
+ * keys are wrapped in a SubstitutedFactor, and the others are kept as they
+ * are. Known values of keys not in the graph are ignored.
+ * @param graph  the factor graph
+ * @param known  the values of the variables to prune
+ */
+PrunedGraph PruneVariables(const gtsam::NonlinearFactorGraph& graph,
+                           const gtsam::Values& known);
+
+/**
+ * Prune the variables pinned by the hard priors of a graph, see
+ * HardPriorValues, with their priors. For a trajectory graph, this removes
+ * the poses, twists and accelerations of fixed links from the
+ * optimization, and any variable of a phase fixed by a hard prior, e.g.,
+ * the contact wrenches of feet in the air.
+ * @param graph      the factor graph
+ * @param max_sigma  largest sigma of a prior taken as a hard constraint
+ */
+PrunedGraph PruneHardPriors(const gtsam::NonlinearFactorGraph& graph,
+                            double max_sigma = 0);
+
+}  // namespace gtdynamics
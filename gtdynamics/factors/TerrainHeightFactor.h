@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TerrainHeightFactor.h
+ * @brief Contact height factor on terrain given by a heightmap.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/HeightMap.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * TerrainHeightFactor is a unary factor which keeps a contact point on the
+ * terrain described by a HeightMap, the counterpart of ContactHeightFactor
+ * for uneven ground. The error is the height of the contact point above the
+ * interpolated terrain, z - h(x, y), in the world frame with z up.
+ *
+ * The map is shared, not copied, so it can be updated in place while the
+ * factors are in a graph.
+ */
+class TerrainHeightFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
+ private:
+  using This = TerrainHeightFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Pose3>;
+
+  HeightMapPtr map_;
+  gtsam::Point3 comPc_;
+
+ public:
+  /**
+   * Constructor
+   * @param pose_key The key corresponding to the link's CoM pose.
+   * @param cost_model Noise model associated with this factor.
+   * @param comPc Contact point in the link CoM frame.
+   * @param map The shared terrain heightmap.
+   */
+  TerrainHeightFactor(gtsam::Key pose_key,
+                      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const gtsam::Point3 &comPc, const HeightMapPtr &map)
+      : Base(cost_model, pose_key), map_(map), comPc_(comPc) {
+    if (!map_) {
+      throw std::invalid_argument("TerrainHeightFactor: no heightmap.");
+    }
+  }
+
+  virtual ~TerrainHeightFactor() {}
+
+  /// Return the shared heightmap.
+  const HeightMapPtr &map() const { return map_; }
+
+  /**
+   * Evaluate the height of the contact point above the terrain.
+   * @param pose CoM pose of the link.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &pose,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none) const override {
+    gtsam::Matrix36 H_point;
+    const gtsam::Point3 sPc =
+        pose.transformFrom(comPc_, H_pose ? &H_point : nullptr);
+    gtsam::Matrix12 H_xy;
+    const double h = map_->height(sPc.x(), sPc.y(), H_pose ? &H_xy : nullptr);
+    if (H_pose) {
+      gtsam::Matrix13 dz;
+      dz << -H_xy(0), -H_xy(1), 1.0;
+      *H_pose = dz * H_point;
+    }
+    return gtsam::Vector1(sPc.z() - h);
+  }
+
+  //// @return a deep copy of this factor, sharing the heightmap
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "TerrainHeightFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
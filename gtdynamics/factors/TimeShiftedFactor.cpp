@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeShiftedFactor.cpp
+ * @brief Re-key factor graphs and values in time, for sliding windows.
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/TimeShiftedFactor.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/linear/GaussianFactor.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactor;
+using gtsam::Values;
+
+/* ************************************************************************* */
+Key ShiftTime(Key key, int offset) {
+  const DynamicsSymbol symbol(key);
+  const int64_t t = int64_t(symbol.time()) + offset;
+  if (t < 0) {
+    throw std::invalid_argument("ShiftTime: " + _GTDKeyFormatter(key) +
+                                " would have a negative time.");
+  }
+  return DynamicsSymbol::LinkJointSymbol(symbol.label(), symbol.linkIdx(),
+                                         symbol.jointIdx(), t);
+}
+
+/* ************************************************************************* */
+// Return whether all keys of a factor stay at non-negative times.
+static bool CanShift(const NonlinearFactor& factor, int offset) {
+  for (Key key : factor.keys()) {
+    if (int64_t(DynamicsSymbol(key).time()) + offset < 0) return false;
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+// Return the shifted keys of a factor, with PhaseKey keys moved to phase if
+// it is non-negative.
+static KeyVector ShiftedKeys(const NonlinearFactor& factor, int offset,
+                             int phase) {
+  const std::string phase_label = PhaseKey(0).label();
+  KeyVector keys;
+  for (Key key : factor.keys()) {
+    if (phase >= 0 && DynamicsSymbol(key).label() == phase_label) {
+      keys.push_back(PhaseKey(phase));
+    } else {
+      keys.push_back(ShiftTime(key, offset));
+    }
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+TimeShiftedFactor::TimeShiftedFactor(const NonlinearFactor::shared_ptr& factor,
+                                     int offset, int phase)
+    : Base(ShiftedKeys(*factor, offset, phase)),
+      factor_(factor),
+      offset_(offset) {
+  if (auto shifted = boost::dynamic_pointer_cast<This>(factor)) {
+    factor_ = shifted->factor_;
+    offset_ += shifted->offset_;
+  }
+}
+
+/* ************************************************************************* */
+Values TimeShiftedFactor::unshifted(const Values& values) const {
+  Values result;
+  const KeyVector& keys = factor_->keys();
+  for (size_t i = 0; i < keys.size(); i++) {
+    result.insert(keys[i], values.at(keys_[i]));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> TimeShiftedFactor::linearize(
+    const Values& values) const {
+  auto linear = factor_->linearize(unshifted(values));
+  if (linear) linear->keys() = keys_;
+  return linear;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph ShiftTimeSteps(
+    const gtsam::NonlinearFactorGraph& graph, int offset) {
+  gtsam::NonlinearFactorGraph result;
+  for (const auto& factor : graph) {
+    if (factor && CanShift(*factor, offset)) {
+      result.emplace_shared<TimeShiftedFactor>(factor, offset);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values ShiftTimeSteps(const Values& values, int offset) {
+  Values result;
+  for (auto&& key_value : values) {
+    if (int64_t(DynamicsSymbol(key_value.key).time()) + offset >= 0) {
+      result.insert(ShiftTime(key_value.key, offset), key_value.value);
+    }
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+void SlideWindow(gtsam::NonlinearFactorGraph* graph, Values* values,
+                 const gtsam::NonlinearFactorGraph& tail_graph) {
+  *graph = ShiftTimeSteps(*graph, -1);
+  *values = ShiftTimeSteps(*values, -1);
+  graph->push_back(tail_graph);
+  for (Key key : tail_graph.keys()) {
+    if (values->exists(key) || DynamicsSymbol(key).time() == 0) continue;
+    const Key previous = ShiftTime(key, -1);
+    if (values->exists(previous)) values->insert(key, values->at(previous));
+  }
+}
+
+}  // namespace gtdynamics
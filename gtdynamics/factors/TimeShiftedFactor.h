@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeShiftedFactor.h
+ * @brief Re-key factor graphs and values in time, for sliding windows.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Return the key with the time field of its DynamicsSymbol shifted by offset.
+ * This includes PhaseKey and TimeKey, whose time field is their index.
+ * Throws std::invalid_argument if the shifted time would be negative.
+ */
+gtsam::Key ShiftTime(gtsam::Key key, int offset);
+
+/**
+ * TimeShiftedFactor is a factor on the keys of another factor shifted in
+ * time. Factors built from expressions keep their keys in the expression
+ * tree, so NonlinearFactor::rekey does not work for them; this wrapper
+ * evaluates the wrapped factor on the values moved back to its own keys
+ * instead, and works for any factor. Shifting a TimeShiftedFactor again
+ * wraps the original factor with the total offset.
+ *
+ * Optionally, PhaseKey keys are moved to a given phase instead of shifted,
+ * to stamp factors of one phase, e.g. collocation factors, into another.
+ */
+class TimeShiftedFactor : public gtsam::NonlinearFactor {
+ private:
+  using This = TimeShiftedFactor;
+  using Base = gtsam::NonlinearFactor;
+
+  gtsam::NonlinearFactor::shared_ptr factor_;
+  int offset_;
+
+  // Return the values of the keys of this factor, at the keys of factor_.
+  gtsam::Values unshifted(const gtsam::Values& values) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param factor  the factor to shift
+   * @param offset  number of time steps to add to the time of all its keys
+   * @param phase   if non-negative, the phase of its PhaseKey keys instead
+   */
+  TimeShiftedFactor(const gtsam::NonlinearFactor::shared_ptr& factor,
+                    int offset, int phase = -1);
+
+  /// Return the wrapped factor, on the original keys.
+  const gtsam::NonlinearFactor::shared_ptr& factor() const { return factor_; }
+
+  /// Return the offset from the keys of the wrapped factor.
+  int offset() const { return offset_; }
+
+  /// Return the error of the wrapped factor.
+  double error(const gtsam::Values& values) const override {
+    return factor_->error(unshifted(values));
+  }
+
+  /// Return the dimension of the wrapped factor.
+  size_t dim() const override { return factor_->dim(); }
+
+  /// Return the linearization of the wrapped factor, on the shifted keys.
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values& values) const override;
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string& s = "",
+             const gtsam::KeyFormatter& keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "time shifted factor, offset " << offset_ << std::endl;
+    factor_->print("", keyFormatter);
+  }
+};
+
+/**
+ * Shift a graph in time by offset. Factors with a key whose time would be
+ * negative are dropped, the others are wrapped in a TimeShiftedFactor.
+ */
+gtsam::NonlinearFactorGraph ShiftTimeSteps(
+    const gtsam::NonlinearFactorGraph& graph, int offset);
+
+/**
+ * Shift values in time by offset. Values whose time would be negative are
+ * dropped.
+ */
+gtsam::Values ShiftTimeSteps(const gtsam::Values& values, int offset);
+
+/**
+ * Slide a receding-horizon window over time steps [0, H] to the next time
+ * step: the factors and values of step 0 are dropped, the rest are shifted
+ * to [0, H - 1], and the factors of the new step H are appended, so only one
+ * slice is built per cycle. Keys of the tail without values are initialized
+ * with the (shifted) value of the same key at the step before, if any.
+ *
+ * Priors on step 0 are dropped with it, so the caller adds the new ones.
+ * As PhaseKey is shifted like any other key, windows with durations as
+ * variables should have one per time step.
+ * @param graph       the window graph, updated in place
+ * @param values      the window values, updated in place
+ * @param tail_graph  factors on the new step H, and linking it to H - 1
+ */
+void SlideWindow(gtsam::NonlinearFactorGraph* graph, gtsam::Values* values,
+                 const gtsam::NonlinearFactorGraph& tail_graph);
+
+}  // namespace gtdynamics
@@ -13,8 +13,10 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -44,7 +46,7 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr TorqueFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     const JointConstSharedPtr &joint, size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<double>>(
+  return MakeFactor<CompiledExpressionFactor<double>>(
       cost_model, 0.0, joint->torqueConstraint(k));
 }
 
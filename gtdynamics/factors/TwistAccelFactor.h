@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/utils.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -22,6 +26,8 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
 #include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
 #include <memory>
 #include <string>
 
@@ -44,8 +50,103 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr TwistAccelFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     JointConstSharedPtr joint, int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+  return MakeFactor<CompiledExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(), joint->twistAccelConstraint(time));
 }
 
+/**
+ * AnalyticTwistAccelFactor is the same constraint as TwistAccelFactor, but
+ * with hand-written fixed-size Jacobians instead of an expression tree.
+ */
+class AnalyticTwistAccelFactor
+    : public gtsam::NoiseModelFactor6<gtsam::Vector6, gtsam::Vector6,
+                                      gtsam::Vector6, double, double, double> {
+ private:
+  using This = AnalyticTwistAccelFactor;
+  using Base = gtsam::NoiseModelFactor6<gtsam::Vector6, gtsam::Vector6,
+                                        gtsam::Vector6, double, double, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint connecting the two links.
+   * @param time The timestep at which this factor is defined.
+   */
+  AnalyticTwistAccelFactor(
+      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+      const JointConstSharedPtr &joint, int time)
+      : Base(cost_model, TwistKey(joint->child()->id(), time),
+             TwistAccelKey(joint->parent()->id(), time),
+             TwistAccelKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time), JointVelKey(joint->id(), time),
+             JointAccelKey(joint->id(), time)),
+        joint_(joint) {}
+
+  virtual ~AnalyticTwistAccelFactor() {}
+
+  /// Return the joint.
+  const JointConstSharedPtr &joint() const { return joint_; }
+
+  /**
+   * Evaluate twist acceleration error,
+   * Ad(cTp) * A_p + ad(V_c) * S_c * q_dot + S_c * q_ddot - A_c.
+   * @param twist_c child link twist
+   * @param accel_p parent link twist acceleration
+   * @param accel_c child link twist acceleration
+   * @param q joint angle
+   * @param q_dot joint velocity
+   * @param q_ddot joint acceleration
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_c, const gtsam::Vector6 &accel_p,
+      const gtsam::Vector6 &accel_c, const double &q, const double &q_dot,
+      const double &q_ddot,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_ddot = boost::none) const override {
+    const gtsam::Vector6 &S = joint_->cScrewAxis();
+    const gtsam::Matrix6 cAdp = joint_->relativeAdjointMap(joint_->parent(), q);
+    gtsam::Vector6 error =
+        cAdp * accel_p + gtsam::Pose3::adjoint(twist_c, S * q_dot, H_twist_c) +
+        S * q_ddot - accel_c;
+    if (H_accel_p) *H_accel_p = cAdp;
+    if (H_accel_c) *H_accel_c = -gtsam::I_6x6;
+    if (H_q) {
+      *H_q = joint_->relativeAdjointMapJacobianQ(joint_->parent(), q) * accel_p;
+    }
+    if (H_q_dot) *H_q_dot = gtsam::Pose3::adjointMap(twist_c) * S;
+    if (H_q_ddot) *H_q_ddot = S;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "AnalyticTwistAccelFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor6", boost::serialization::base_object<Base>(*this));
+  }
+};
+
 }  // namespace gtdynamics
@@ -13,7 +13,10 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -21,6 +24,8 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
 #include <boost/optional.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <iostream>
 #include <string>
 
 namespace gtdynamics {
@@ -40,8 +45,85 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr TwistFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     JointConstSharedPtr joint, int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+  return MakeFactor<CompiledExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(), joint->twistConstraint(time));
 }
 
+/**
+ * AnalyticTwistFactor is the same constraint as TwistFactor, but with
+ * hand-written fixed-size Jacobians instead of an expression tree.
+ */
+class AnalyticTwistFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Vector6, gtsam::Vector6, double,
+                                      double> {
+ private:
+  using This = AnalyticTwistFactor;
+  using Base = gtsam::NoiseModelFactor4<gtsam::Vector6, gtsam::Vector6,
+                                        double, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model The noise model for this factor.
+   * @param joint The joint connecting the two links.
+   * @param time The timestep at which this factor is defined.
+   */
+  AnalyticTwistFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const JointConstSharedPtr &joint, int time)
+      : Base(cost_model, TwistKey(joint->parent()->id(), time),
+             TwistKey(joint->child()->id(), time),
+             JointAngleKey(joint->id(), time), JointVelKey(joint->id(), time)),
+        joint_(joint) {}
+
+  virtual ~AnalyticTwistFactor() {}
+
+  /// Return the joint.
+  const JointConstSharedPtr &joint() const { return joint_; }
+
+  /**
+   * Evaluate twist error, Ad(cTp) * V_p + S_c * q_dot - V_c.
+   * @param twist_p parent link twist
+   * @param twist_c child link twist
+   * @param q joint angle
+   * @param q_dot joint velocity
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_p, const gtsam::Vector6 &twist_c,
+      const double &q, const double &q_dot,
+      boost::optional<gtsam::Matrix &> H_twist_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none) const override {
+    const gtsam::Vector6 twist_c_hat = joint_->transformTwistTo(
+        joint_->child(), q, q_dot, twist_p, H_q, H_q_dot, H_twist_p);
+    if (H_twist_c) *H_twist_c = -gtsam::I_6x6;
+    return twist_c_hat - twist_c;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "AnalyticTwistFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor4", boost::serialization::base_object<Base>(*this));
+  }
+};
+
 }  // namespace gtdynamics
@@ -14,8 +14,10 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -40,7 +42,7 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr WrenchEquivalenceFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     const JointConstSharedPtr &joint, size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+  return MakeFactor<CompiledExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(),
       joint->wrenchEquivalenceConstraint(k));
 }
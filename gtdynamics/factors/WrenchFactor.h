@@ -13,10 +13,15 @@
 
 #pragma once
 
+#include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
+#include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/utils.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/linear/NoiseModel.h>
@@ -26,6 +31,7 @@
 
 #include <boost/optional.hpp>
 #include <boost/serialization/base_object.hpp>
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -46,9 +52,118 @@ inline gtsam::NoiseModelFactor::shared_ptr WrenchFactor(
     const gtsam::SharedNoiseModel &cost_model, const LinkConstSharedPtr &link,
     const std::vector<DynamicsSymbol> &wrench_keys, int time,
     const boost::optional<gtsam::Vector3> &gravity = boost::none) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
+  return MakeFactor<CompiledExpressionFactor<gtsam::Vector6>>(
       cost_model, gtsam::Vector6::Zero(),
       link->wrenchConstraint(wrench_keys, time, gravity));
 }
 
+/**
+ * AnalyticWrenchFactor is the same constraint as WrenchFactor, but with
+ * hand-written fixed-size Jacobians instead of an expression tree.
+ *
+ * Keys are ordered as: twist, twist acceleration, wrenches, and the link pose
+ * if gravity is given.
+ */
+class AnalyticWrenchFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = AnalyticWrenchFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  gtsam::Matrix6 inertia_;
+  double mass_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+  /// Return all keys of the factor.
+  static gtsam::KeyVector Keys(const LinkConstSharedPtr &link,
+                               const std::vector<DynamicsSymbol> &wrench_keys,
+                               int time, bool gravity) {
+    gtsam::KeyVector keys{TwistKey(link->id(), time),
+                          TwistAccelKey(link->id(), time)};
+    keys.insert(keys.end(), wrench_keys.begin(), wrench_keys.end());
+    if (gravity) keys.push_back(PoseKey(link->id(), time));
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model The noise model for this factor.
+   * @param link The link.
+   * @param wrench_keys Keys of the wrenches acting on the link.
+   * @param time The timestep at which this factor is defined.
+   * @param gravity (optional) Create gravity wrench in link COM frame.
+   */
+  AnalyticWrenchFactor(
+      const gtsam::SharedNoiseModel &cost_model, const LinkConstSharedPtr &link,
+      const std::vector<DynamicsSymbol> &wrench_keys, int time,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none)
+      : Base(cost_model,
+             Keys(link, wrench_keys, time, static_cast<bool>(gravity))),
+        inertia_(link->inertiaMatrix()),
+        mass_(link->mass()),
+        gravity_(gravity) {}
+
+  virtual ~AnalyticWrenchFactor() {}
+
+  /**
+   * Evaluate wrench balance error,
+   * ad(V)^T * G * V - G * A + sum(F_j) + F_gravity.
+   */
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override {
+    const size_t num_wrenches = size() - 2 - (gravity_ ? 1 : 0);
+    const gtsam::Vector6 twist = x.at<gtsam::Vector6>(keys_[0]);
+    const gtsam::Vector6 accel = x.at<gtsam::Vector6>(keys_[1]);
+
+    gtsam::Matrix6 H_twist, H_pose;
+    gtsam::Vector6 error =
+        Coriolis(inertia_, twist, H ? &H_twist : 0) - inertia_ * accel;
+    for (size_t i = 0; i < num_wrenches; i++) {
+      error += x.at<gtsam::Vector6>(keys_[2 + i]);
+    }
+    if (gravity_) {
+      error += GravityWrench(*gravity_, mass_,
+                             x.at<gtsam::Pose3>(keys_.back()),
+                             H ? &H_pose : 0);
+    }
+
+    if (H) {
+      H->resize(size());
+      (*H)[0] = H_twist;
+      (*H)[1] = -inertia_;
+      for (size_t i = 0; i < num_wrenches; i++) (*H)[2 + i] = gtsam::I_6x6;
+      if (gravity_) H->back() = H_pose;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "AnalyticWrenchFactor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(inertia_);
+    ar &BOOST_SERIALIZATION_NVP(mass_);
+    ar &BOOST_SERIALIZATION_NVP(gravity_);
+  }
+};
+
 }  // namespace gtdynamics
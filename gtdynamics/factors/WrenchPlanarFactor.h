@@ -14,8 +14,10 @@
 #pragma once
 
 #include <gtdynamics/dynamics/Dynamics.h>
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Matrix.h>
@@ -63,7 +65,7 @@ inline gtsam::NoiseModelFactor::shared_ptr WrenchPlanarFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     gtsam::Vector3 planar_axis, const JointConstSharedPtr &joint,
     size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector3>>(
+  return MakeFactor<CompiledExpressionFactor<gtsam::Vector3>>(
       cost_model, gtsam::Vector3::Zero(),
       WrenchPlanarConstraint(planar_axis, joint, k));
 }
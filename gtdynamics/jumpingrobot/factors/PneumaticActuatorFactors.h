@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <gtdynamics/utils/HermiteTable.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
@@ -214,18 +215,67 @@ class SmoothActuatorFactor
           .finished();  // TODO(yetong): using static
   const gtsam::Vector2 f0_coeffs_ = gtsam::Vector2(0, 1.966409);
   const gtsam::Vector2 k_coeffs_ = gtsam::Vector2(0, 0.35541599);
+  bool tabulated_ = false;
+
+  // Gauge pressures (kPa) and intervals of the shared table; the fit of x0
+  // is only valid (positive) up to about 500 kPa.
+  static constexpr double kTableMaxGauge = 400;
+  static constexpr size_t kTableIntervals = 800;
+
+  /** Return the maximum contraction x0 and the cubic coefficients c and d at
+   * the gauge pressure, and their derivatives in H. */
+  gtsam::Vector3 shape(double gauge_p, gtsam::Vector3 *H = nullptr) const {
+    double x0 = x0_coeffs_(4), j_x0_p = 4 * x0_coeffs_(4);
+    for (int i = 3; i >= 0; i--) {
+      x0 = x0 * gauge_p + x0_coeffs_(i);
+      if (i > 0) j_x0_p = j_x0_p * gauge_p + i * x0_coeffs_(i);
+    }
+    const double k = k_coeffs_(0) + k_coeffs_(1) * gauge_p;
+    const double f0 = f0_coeffs_(0) + f0_coeffs_(1) * gauge_p;
+    const double x0_2 = x0 * x0, x0_3 = x0_2 * x0, x0_4 = x0_3 * x0;
+    const double c = (2 * k * x0 - 3 * f0) / x0_2;
+    const double d = (-k * x0 + 2 * f0) / x0_3;
+    if (H) {
+      const double j_k_p = k_coeffs_(1), j_f0_p = f0_coeffs_(1);
+      const double j_c_p = (-2 * k / x0_2 + 6 * f0 / x0_3) * j_x0_p +
+                           (2 / x0) * j_k_p + (-3 / x0_2) * j_f0_p;
+      const double j_d_p = (2 * k / x0_3 - 6 * f0 / x0_4) * j_x0_p +
+                           (-1 / x0_2) * j_k_p + (2 / x0_3) * j_f0_p;
+      *H << j_x0_p, j_c_p, j_d_p;
+    }
+    return gtsam::Vector3(x0, c, d);
+  }
+
+  /** Table of shape over gauge pressures (0, kTableMaxGauge], shared by all
+   * factors, built when the first tabulated factor is constructed. */
+  const HermiteTable<3> &table() const {
+    static const HermiteTable<3> table(
+        0, kTableMaxGauge, kTableIntervals,
+        [this](double gauge_p, gtsam::Vector3 *H) {
+          return shape(gauge_p, H);
+        });
+    return table;
+  }
 
  public:
   /** Create pneumatic actuator factor
    *  delta_x_key -- key for actuator contraction in cm
+   *  tabulated   -- evaluate the pressure dependent part of the model from a
+   *                 cubic Hermite table up to 400 kPa gauge, with forces and
+   *                 Jacobians within 1e-6 relative error
    */
   SmoothActuatorFactor(gtsam::Key delta_x_key, gtsam::Key p_key,
                        gtsam::Key f_key,
-                       const gtsam::noiseModel::Base::shared_ptr &cost_model)
-      : Base(cost_model, delta_x_key, p_key, f_key) {}
+                       const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                       bool tabulated = false)
+      : Base(cost_model, delta_x_key, p_key, f_key), tabulated_(tabulated) {
+    if (tabulated_) table();
+  }
   virtual ~SmoothActuatorFactor() {}
 
- private:
+  /// Return whether the model is evaluated from the table.
+  bool tabulated() const { return tabulated_; }
+
  public:
   /** evaluate errors
       Keyword argument:
@@ -244,34 +294,28 @@ class SmoothActuatorFactor
       H_f->setConstant(1, 1, -1);
     }
 
-    gtsam::Vector5 gauge_p_powers5;
-    gtsam::Vector2 gauge_p_powers2(1, gauge_p);
-    // (1, gauge_p, gauge_p*gauge_p, pow(gauge_p,3), pow(gauge_p,4));
-
-    gauge_p_powers5(0) = 1;
-    for (size_t i = 1; i < 5; i++) {
-      gauge_p_powers5(i) = gauge_p_powers5(i - 1) * gauge_p;
-    }
-
-    double x0 = x0_coeffs_.dot(gauge_p_powers5);
-
     // over contraction: should return 0
-    if (gauge_p <= 0 || delta_x > x0) {
+    if (gauge_p <= 0) {
       if (H_delta_x) H_delta_x->setConstant(1, 1, 0);
       if (H_p) H_p->setConstant(1, 1, 0);
       return gtsam::Vector1(-f);
     }
-
-    double k = k_coeffs_.dot(gauge_p_powers2);
-    double f0 = f0_coeffs_.dot(gauge_p_powers2);
-    double j_k_p = 0, j_f0_p = 0;
-    if (H_p) {
-      for (size_t i = 1; i < 2; i++) {
-        j_k_p += i * k_coeffs_(i) * gauge_p_powers2(i - 1);
-        j_f0_p += i * f0_coeffs_(i) * gauge_p_powers2(i - 1);
-      }
+    gtsam::Vector3 j_shape_p;
+    gtsam::Vector3 *H_shape = H_p ? &j_shape_p : nullptr;
+    const gtsam::Vector3 x0_c_d = tabulated_ && gauge_p <= kTableMaxGauge
+                                      ? table()(gauge_p, H_shape)
+                                      : shape(gauge_p, H_shape);
+    const double x0 = x0_c_d(0), c = x0_c_d(1), d = x0_c_d(2);
+    if (delta_x > x0) {
+      if (H_delta_x) H_delta_x->setConstant(1, 1, 0);
+      if (H_p) H_p->setConstant(1, 1, 0);
+      return gtsam::Vector1(-f);
     }
 
+    double k = k_coeffs_(0) + k_coeffs_(1) * gauge_p;
+    double f0 = f0_coeffs_(0) + f0_coeffs_(1) * gauge_p;
+    double j_k_p = k_coeffs_(1), j_f0_p = f0_coeffs_(1);
+
     // over extension: should model as a spring
     if (delta_x < 0) {
       if (H_delta_x) H_delta_x->setConstant(1, 1, -k);
@@ -282,24 +326,11 @@ class SmoothActuatorFactor
     // normal condition
     double delta_x_2 = delta_x * delta_x;
     double delta_x_3 = delta_x_2 * delta_x;
-    double c = (2 * k * x0 - 3 * f0) / (x0 * x0);
-    double d = (-k * x0 + 2 * f0) / (x0 * x0 * x0);
-    double x0_2 = x0 * x0;
-    double x0_3 = x0_2 * x0;
-    double x0_4 = x0_3 * x0;
     if (H_delta_x)
       H_delta_x->setConstant(1, 1, 3 * d * delta_x_2 + 2 * c * delta_x - k);
     if (H_p) {
-      double j_x0_p = 0;
-      for (size_t i = 1; i < 5; i++) {
-        j_x0_p += i * x0_coeffs_(i) * gauge_p_powers5(i - 1);
-      }
-      double j_c_p = (-2 * k / x0_2 + 6 * f0 / x0_3) * j_x0_p +
-                     (2 / x0) * j_k_p + (-3 / x0_2) * j_f0_p;
-      double j_d_p = (2 * k / x0_3 - 6 * f0 / x0_4) * j_x0_p +
-                     (-1 / x0_2) * j_k_p + (2 / x0_3) * j_f0_p;
-      double j_p =
-          delta_x_3 * j_d_p + delta_x_2 * j_c_p + delta_x * (-j_k_p) + j_f0_p;
+      double j_p = delta_x_3 * j_shape_p(2) + delta_x_2 * j_shape_p(1) +
+                   delta_x * (-j_k_p) + j_f0_p;
       H_p->setConstant(1, 1, j_p);
     }
     double expected_f = d * delta_x_3 + c * delta_x_2 + (-k) * delta_x + f0;
@@ -327,6 +358,7 @@ class SmoothActuatorFactor
   void serialize(ARCHIVE &ar, const unsigned int version) {
     ar &boost::serialization::make_nvp(
         "SmoothActuatorFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(tabulated_);
   }
 };
 
@@ -373,8 +405,8 @@ class ClippingActuatorFactor
       boost::optional<gtsam::Matrix &> H_delta_x = boost::none,
       boost::optional<gtsam::Matrix &> H_p = boost::none,
       boost::optional<gtsam::Matrix &> H_f = boost::none) const override {
-    std::vector<double> p_powers(4, 1);
-    std::vector<double> delta_x_powers(4, 1);
+    double p_powers[4] = {1, 1, 1, 1};
+    double delta_x_powers[4] = {1, 1, 1, 1};
     for (size_t i = 1; i < 4; i++) {
       p_powers[i] = p_powers[i - 1] * p;
       delta_x_powers[i] = delta_x_powers[i - 1] * delta_x;
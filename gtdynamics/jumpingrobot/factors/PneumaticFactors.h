@@ -88,7 +88,7 @@ class MassFlowRateFactor
   typedef MassFlowRateFactor This;
   typedef gtsam::NoiseModelFactor3<double, double, double> Base;
   double D_, L_, mu_, epsilon_, k_;
-  double term1_, term2_, c1_, coeff_;
+  double term1_, term2_, inv_sqrt_c1_, coeff_;
 
  public:
   MassFlowRateFactor(gtsam::Key pm_key, gtsam::Key ps_key, gtsam::Key mdot_key,
@@ -103,7 +103,7 @@ class MassFlowRateFactor
         k_(k),
         term1_(6.9 / 4 * M_PI * D_ * mu_),
         term2_(pow(epsilon_ / (3.7 * D_), 1.11)),
-        c1_(pow(1.8 / log(10), -2)),
+        inv_sqrt_c1_(1.8 / log(10)),
         coeff_(1e3 * sqrt(pow(M_PI, 2) * pow(D_, 5) * k_ / (16.0 * L_))) {}
   virtual ~MassFlowRateFactor() {}
 
@@ -117,25 +117,26 @@ class MassFlowRateFactor
       boost::optional<gtsam::Matrix &> H_pm = boost::none,
       boost::optional<gtsam::Matrix &> H_ps = boost::none,
       boost::optional<gtsam::Matrix &> H_mdot = boost::none) const {
-    double tmp = term1_ / abs(mdot) + term2_;
-    double fD = c1_ * pow(log(tmp), -2);
-    double p_square_diff = abs(ps * ps - pm * pm);
-    int sign_p = abs(ps) > abs(pm) ? 1 : -1;
+    // With fD = c1 / log(tmp)^2, 1 / sqrt(fD) = |log(tmp)| / sqrt(c1), so
+    // the model and its Jacobians need only one log and one sqrt.
+    double tmp = term1_ / std::abs(mdot) + term2_;
+    double log_tmp = log(tmp);
+    double inv_sqrt_fD = std::abs(log_tmp) * inv_sqrt_c1_;
+    double sqrt_p_square_diff = sqrt(std::abs(ps * ps - pm * pm));
+    int sign_p = std::abs(ps) > std::abs(pm) ? 1 : -1;
     int sign_mdot = mdot > 0 ? 1 : -1;
-    double expected_mdot = sign_p * coeff_ * sqrt(p_square_diff / fD);
+    double expected_mdot = sign_p * coeff_ * sqrt_p_square_diff * inv_sqrt_fD;
 
-    if (H_pm) {
-      H_pm->setConstant(1, 1, -coeff_ * pow(p_square_diff * fD, -0.5) * pm);
-    }
-    if (H_ps) {
-      H_ps->setConstant(1, 1, coeff_ * pow(p_square_diff * fD, -0.5) * ps);
+    if (H_pm || H_ps) {
+      double d_p = coeff_ * inv_sqrt_fD / sqrt_p_square_diff;
+      if (H_pm) H_pm->setConstant(1, 1, -d_p * pm);
+      if (H_ps) H_ps->setConstant(1, 1, d_p * ps);
     }
     if (H_mdot) {
-      double d_fD =
-          -0.5 * sign_p * coeff_ * sqrt(p_square_diff) * pow(fD, -1.5);
-      double d_fD_tmp = c1_ * (-2) * pow(log(tmp), -3) / tmp;
+      double d_tmp = sign_p * coeff_ * sqrt_p_square_diff * inv_sqrt_c1_ *
+                     (log_tmp > 0 ? 1 : -1) / tmp;
       double d_tmp_mdot = -term1_ / (mdot * mdot) * sign_mdot;
-      H_mdot->setConstant(1, 1, d_fD * d_fD_tmp * d_tmp_mdot);
+      H_mdot->setConstant(1, 1, d_tmp * d_tmp_mdot);
     }
     return expected_mdot;
   }
@@ -179,7 +180,8 @@ class MassFlowRateFactor
 
 /** Sigmoid function, 1/(1+e^-x), used to model the change of mass flow 
  * rate when valve is open/closed. */
-double sigmoid(double x, boost::optional<gtsam::Matrix &> H_x = boost::none) {
+inline double sigmoid(double x,
+                      boost::optional<gtsam::Matrix &> H_x = boost::none) {
   double neg_exp = exp(-x);
   if (H_x) {
     H_x->setConstant(1, 1, neg_exp / pow(1.0 + neg_exp, 2));
@@ -49,6 +49,11 @@ class SmoothActuatorFactor: gtsam::NonlinearFactor{
   SmoothActuatorFactor(gtsam::Key delta_x_key, gtsam::Key p_key,
                           gtsam::Key f_key,
                           const gtsam::noiseModel::Base *cost_model);
+  SmoothActuatorFactor(gtsam::Key delta_x_key, gtsam::Key p_key,
+                          gtsam::Key f_key,
+                          const gtsam::noiseModel::Base *cost_model,
+                          bool tabulated);
+  bool tabulated() const;
 };
 
 class ForceBalanceFactor: gtsam::NonlinearFactor{
@@ -87,4 +92,119 @@ void AddTimeCollocationFactor(
   gtsam::Key t_prev_key, gtsam::Key t_curr_key, gtsam::Key dt_key,
   const gtsam::noiseModel::Base *cost_model);
 
+/****************************************** Simulator ******************************************/
+
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+gtdynamics::DynamicsSymbol ActuatorPressureKey(int j, int t);
+gtdynamics::DynamicsSymbol SourcePressureKey(int t);
+gtdynamics::DynamicsSymbol ContractionKey(int j, int t);
+gtdynamics::DynamicsSymbol ActuatorForceKey(int j, int t);
+gtdynamics::DynamicsSymbol ActuatorMassKey(int j, int t);
+gtdynamics::DynamicsSymbol SourceMassKey(int t);
+gtdynamics::DynamicsSymbol MassRateOpenKey(int j, int t);
+gtdynamics::DynamicsSymbol MassRateActualKey(int j, int t);
+gtdynamics::DynamicsSymbol ActuatorVolumeKey(int j, int t);
+gtdynamics::DynamicsSymbol SourceVolumeKey();
+gtdynamics::DynamicsSymbol ValveOpenTimeKey(int j);
+gtdynamics::DynamicsSymbol ValveCloseTimeKey(int j);
+
+class JRActuatorParams {
+  JRActuatorParams();
+  int j;
+  bool positive;
+  double k_anta;
+  double k_tendon;
+  double q_anta_limit;
+  double b;
+  double radius;
+  double q_rest;
+};
+
+class JRPneumaticParams {
+  JRPneumaticParams();
+  double d_tube;
+  double l_tube;
+  double mu;
+  double epsilon;
+  double ct;
+  double k_const;
+  double gas_constant;
+};
+
+class JumpingRobotSimulator {
+  JumpingRobotSimulator(
+      const gtdynamics::Robot &robot,
+      const std::vector<gtdynamics::JRActuatorParams> &actuators,
+      const gtdynamics::JRPneumaticParams &pneumatic,
+      const gtdynamics::DynamicsGraph &graph_builder);
+  JumpingRobotSimulator(
+      const gtdynamics::Robot &robot,
+      const std::vector<gtdynamics::JRActuatorParams> &actuators,
+      const gtdynamics::JRPneumaticParams &pneumatic,
+      const gtdynamics::DynamicsGraph &graph_builder,
+      const gtsam::LevenbergMarquardtParams &lm_params, double threshold,
+      const std::string &torso_name);
+
+  const gtdynamics::Robot &robot() const;
+  void stepIntegration(int k, double dt, gtsam::Values @values,
+                       bool include_actuation = true) const;
+  void stepActuationDynamics(int k, gtsam::Values @values) const;
+  void stepRobotDynamicsByLayer(int k, gtsam::Values @values) const;
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &init_values) const;
+};
+
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSweep.h>
+class JRSweepConfig {
+  JRSweepConfig();
+  JRSweepConfig(const std::vector<double> &valve_open_times,
+                const std::vector<double> &valve_close_times,
+                double source_pressure);
+  double source_pressure;
+};
+
+class JumpingRobotSweep {
+  JumpingRobotSweep(const std::vector<gtdynamics::Robot> &phase_robots,
+                    const std::vector<gtdynamics::JRActuatorParams> &actuators,
+                    const gtdynamics::JRPneumaticParams &pneumatic,
+                    const gtdynamics::DynamicsGraph &graph_builder,
+                    const gtsam::Values &initial_values);
+  JumpingRobotSweep(const std::vector<gtdynamics::Robot> &phase_robots,
+                    const std::vector<gtdynamics::JRActuatorParams> &actuators,
+                    const gtdynamics::JRPneumaticParams &pneumatic,
+                    const gtdynamics::DynamicsGraph &graph_builder,
+                    const gtsam::Values &initial_values,
+                    const std::string &torso_name);
+
+  gtsam::Values initialValues(const gtdynamics::JRSweepConfig &config) const;
+  gtsam::Values simulate(const gtdynamics::JRSweepConfig &config,
+                         size_t num_steps, double dt) const;
+  gtsam::Vector metrics(const gtsam::Values &trajectory,
+                        const std::vector<int> &step_phases, double dt) const;
+  gtsam::Matrix sweep(const std::vector<gtdynamics::JRSweepConfig> &configs,
+                      size_t num_steps, double dt) const;
+};
+
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotGraphBuilder.h>
+class JumpingRobotGraphBuilder {
+  JumpingRobotGraphBuilder(
+      const std::vector<gtdynamics::Robot> &phase_robots,
+      const std::vector<gtdynamics::JRActuatorParams> &actuators,
+      const gtdynamics::JRPneumaticParams &pneumatic,
+      const gtdynamics::DynamicsGraph &graph_builder);
+  JumpingRobotGraphBuilder(
+      const std::vector<gtdynamics::Robot> &phase_robots,
+      const std::vector<gtdynamics::JRActuatorParams> &actuators,
+      const gtdynamics::JRPneumaticParams &pneumatic,
+      const gtdynamics::DynamicsGraph &graph_builder,
+      const std::string &torso_name);
+
+  gtsam::NonlinearFactorGraph dynamicsGraph(int phase, int k) const;
+  gtsam::NonlinearFactorGraph massFlowGraph(int k) const;
+  gtsam::NonlinearFactorGraph collocationGraph(
+      const std::vector<int> &step_phases) const;
+  gtsam::NonlinearFactorGraph trajectoryGraph(
+      const std::vector<int> &step_phases) const;
+};
+
 }  // namespace gtdynamics
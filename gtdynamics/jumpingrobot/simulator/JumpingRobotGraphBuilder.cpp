@@ -0,0 +1,198 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotGraphBuilder.cpp
+ * @brief Trajectory factor graphs of the pneumatic jumping robot.
+ */
+
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/TimeShiftedFactor.h>
+#include <gtdynamics/jumpingrobot/factors/JRCollocationFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotGraphBuilder.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::noiseModel::Isotropic;
+
+namespace {
+// Cost models of ActuationGraphBuilder.
+const auto kGasLawModel = Isotropic::Sigma(1, 0.0001);
+const auto kVolumeModel = Isotropic::Sigma(1, 1e-7);
+const auto kForceModel = Isotropic::Sigma(1, 0.01);
+const auto kBalanceModel = Isotropic::Sigma(1, 0.001);
+const auto kTorqueModel = Isotropic::Sigma(1, 0.01);
+const auto kMassRateModel = Isotropic::Sigma(1, 1e-5);
+const auto kMassCollocationModel = Isotropic::Sigma(1, 1e-7);
+
+// Phase of JumpingRobot with both feet in the air.
+constexpr int kAirPhase = 3;
+}  // namespace
+
+/* ************************************************************************* */
+JumpingRobotGraphBuilder::JumpingRobotGraphBuilder(
+    const std::vector<Robot> &phase_robots,
+    const std::vector<JRActuatorParams> &actuators,
+    const JRPneumaticParams &pneumatic, const DynamicsGraph &graph_builder,
+    const std::string &torso_name)
+    : phase_robots_(phase_robots),
+      actuators_(actuators),
+      pneumatic_(pneumatic),
+      graph_builder_(graph_builder) {
+  if (phase_robots_.empty()) {
+    throw std::invalid_argument("JumpingRobotGraphBuilder: needs a robot.");
+  }
+  torso_id_ = phase_robots_.front().link(torso_name)->id();
+
+  // Actuator dynamics, shared by all phases.
+  const JRPneumaticParams &p = pneumatic_;
+  NonlinearFactorGraph actuation;
+  for (auto &&actuator : actuators_) {
+    const int j = actuator.j;
+    actuation.emplace_shared<GasLawFactor>(
+        ActuatorPressureKey(j, 0), ActuatorVolumeKey(j, 0),
+        ActuatorMassKey(j, 0), kGasLawModel, p.gas_constant);
+    actuation.emplace_shared<ActuatorVolumeFactor>(
+        ActuatorVolumeKey(j, 0), ContractionKey(j, 0), kVolumeModel,
+        p.d_tube, p.l_tube);
+    actuation.emplace_shared<SmoothActuatorFactor>(
+        ContractionKey(j, 0), ActuatorPressureKey(j, 0),
+        ActuatorForceKey(j, 0), kForceModel);
+    actuation.emplace_shared<ForceBalanceFactor>(
+        ContractionKey(j, 0), JointAngleKey(j, 0), ActuatorForceKey(j, 0),
+        kBalanceModel, actuator.k_tendon, actuator.radius, actuator.q_rest,
+        actuator.positive);
+    actuation.emplace_shared<JointTorqueFactor>(
+        JointAngleKey(j, 0), JointVelKey(j, 0), ActuatorForceKey(j, 0),
+        TorqueKey(j, 0), kTorqueModel, actuator.q_anta_limit,
+        actuator.k_anta, actuator.radius, actuator.b, actuator.positive);
+  }
+
+  // Robot dynamics of each phase, with free foot joints.
+  for (const Robot &robot : phase_robots_) {
+    NonlinearFactorGraph graph = actuation;
+    graph_builder_.dynamicsFactorGraph(&graph, robot, 0);
+    for (auto &&joint : robot.joints()) {
+      if (joint->name() == "foot_l" || joint->name() == "foot_r") {
+        graph.emplace_shared<gtsam::PriorFactor<double>>(
+            TorqueKey(joint->id(), 0), 0.0, graph_builder_.opt().t_cost_model);
+      }
+    }
+    dynamics_templates_.push_back(graph);
+  }
+}
+
+/* ************************************************************************* */
+void JumpingRobotGraphBuilder::checkPhase(int phase) const {
+  if (phase < 0 || phase >= int(phase_robots_.size())) {
+    throw std::invalid_argument("JumpingRobotGraphBuilder: no robot of phase " +
+                                std::to_string(phase));
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::dynamicsGraph(int phase,
+                                                             int k) const {
+  checkPhase(phase);
+  const NonlinearFactorGraph &graph = dynamics_templates_[phase];
+  NonlinearFactorGraph result = k == 0 ? graph : ShiftTimeSteps(graph, k);
+  result.emplace_shared<GasLawFactor>(SourcePressureKey(k), SourceVolumeKey(),
+                                      SourceMassKey(k), kGasLawModel,
+                                      pneumatic_.gas_constant);
+  return result;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::massFlowGraph(int k) const {
+  const JRPneumaticParams &p = pneumatic_;
+  NonlinearFactorGraph graph;
+  for (auto &&actuator : actuators_) {
+    const int j = actuator.j;
+    graph.emplace_shared<MassFlowRateFactor>(
+        ActuatorPressureKey(j, k), SourcePressureKey(k), MassRateOpenKey(j, k),
+        kMassRateModel, p.d_tube, p.l_tube, p.mu, p.epsilon, p.k_const);
+    graph.emplace_shared<ValveControlFactor>(
+        TimeKey(k), ValveOpenTimeKey(j), ValveCloseTimeKey(j),
+        MassRateOpenKey(j, k), MassRateActualKey(j, k), kMassRateModel, p.ct);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::collocationGraph(
+    const std::vector<int> &step_phases) const {
+  const OptimizerSetting &opt = graph_builder_.opt();
+  NonlinearFactorGraph graph;
+  for (size_t step = 0; step < step_phases.size(); step++) {
+    const int phase = step_phases[step];
+    const int k = step;
+    const Key dt_key = PhaseKey(phase);
+
+    // Air masses of the actuators and the source.
+    gtsam::KeyVector mdot_prev_keys, mdot_curr_keys;
+    for (auto &&actuator : actuators_) {
+      const int j = actuator.j;
+      mdot_prev_keys.push_back(MassRateActualKey(j, k));
+      mdot_curr_keys.push_back(MassRateActualKey(j, k + 1));
+      DynamicsGraph::addMultiPhaseCollocationFactorDouble(
+          &graph, ActuatorMassKey(j, k), ActuatorMassKey(j, k + 1),
+          mdot_prev_keys.back(), mdot_curr_keys.back(), dt_key,
+          kMassCollocationModel, Trapezoidal);
+    }
+    AddSourceMassCollocationFactor(&graph, mdot_prev_keys, mdot_curr_keys,
+                                   SourceMassKey(k), SourceMassKey(k + 1),
+                                   dt_key, false, kMassCollocationModel);
+
+    // In the air, the actuated joints move freely. On the ground, the torso
+    // collocation is enough, and more would conflict with the contacts.
+    if (phase == kAirPhase) {
+      for (auto &&actuator : actuators_) {
+        graph.push_back(graph_builder_.jointMultiPhaseCollocationFactors(
+            actuator.j, k, phase, Trapezoidal));
+      }
+    }
+
+    // Torso pose and twist.
+    const int i = torso_id_;
+    graph.emplace_shared<TrapezoidalPoseCollocationFactor>(
+        PoseKey(i, k), PoseKey(i, k + 1), TwistKey(i, k), TwistKey(i, k + 1),
+        dt_key, opt.pose_col_cost_model);
+    graph.emplace_shared<TrapezoidalTwistCollocationFactor>(
+        TwistKey(i, k), TwistKey(i, k + 1), TwistAccelKey(i, k),
+        TwistAccelKey(i, k + 1), dt_key, opt.twist_col_cost_model);
+
+    AddTimeCollocationFactor(&graph, TimeKey(k), TimeKey(k + 1), dt_key,
+                             opt.time_cost_model);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::trajectoryGraph(
+    const std::vector<int> &step_phases) const {
+  if (step_phases.empty()) {
+    throw std::invalid_argument("JumpingRobotGraphBuilder: needs steps.");
+  }
+  NonlinearFactorGraph graph;
+  for (size_t k = 0; k <= step_phases.size(); k++) {
+    const int phase = step_phases[k == 0 ? 0 : k - 1];
+    graph.push_back(dynamicsGraph(phase, k));
+    graph.push_back(massFlowGraph(k));
+  }
+  graph.push_back(collocationGraph(step_phases));
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotGraphBuilder.h
+ * @brief Trajectory factor graphs of the pneumatic jumping robot.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * JumpingRobotGraphBuilder builds the trajectory factor graphs of
+ * jr_graph_builder.py, with the actuation factors of ActuationGraphBuilder
+ * and the robot factors of RobotGraphBuilder.
+ *
+ * The dynamics graph of each phase is built once, at time step 0, and
+ * shifted to each time step with TimeShiftedFactor. Factors on keys without
+ * a time step (the source volume, the valve times and the phase durations)
+ * are added at each step instead, which is cheap.
+ *
+ * Phases are those of JumpingRobot: 0 both feet on the ground, 1 only the
+ * left, 2 only the right, 3 in the air. Step k of step_phases goes from knot
+ * k to knot k + 1, and knot k > 0 has the robot of step k - 1, so the last
+ * knot of a phase still has its contacts.
+ */
+class JumpingRobotGraphBuilder {
+ private:
+  std::vector<Robot> phase_robots_;
+  std::vector<JRActuatorParams> actuators_;
+  JRPneumaticParams pneumatic_;
+  DynamicsGraph graph_builder_;
+  int torso_id_;
+
+  // Actuation and robot dynamics of each phase at time step 0.
+  std::vector<gtsam::NonlinearFactorGraph> dynamics_templates_;
+
+  // Throw std::invalid_argument if there is no robot of the phase.
+  void checkPhase(int phase) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param phase_robots   robots of phases 0 to 3, or of the first phases
+   *                       only, with the same joint and link ids
+   * @param actuators      parameters of each actuator
+   * @param pneumatic      pneumatic parameters
+   * @param graph_builder  builder of the robot dynamics graphs, with the cost
+   *                       models of RobotGraphBuilder
+   * @param torso_name     name of the link with pose and twist collocation
+   */
+  JumpingRobotGraphBuilder(const std::vector<Robot> &phase_robots,
+                           const std::vector<JRActuatorParams> &actuators,
+                           const JRPneumaticParams &pneumatic,
+                           const DynamicsGraph &graph_builder,
+                           const std::string &torso_name = "torso");
+
+  /**
+   * Return the dynamics graph of step k, with the robot of phase: gas law of
+   * the source, actuator dynamics, robot dynamics, and zero torques on the
+   * foot joints "foot_l" and "foot_r", as JRGraphBuilder.dynamics_graph.
+   */
+  gtsam::NonlinearFactorGraph dynamicsGraph(int phase, int k) const;
+
+  /**
+   * Return the mass flow graph of step k: nominal mass flow rates, and their
+   * control by the valves, as ActuationGraphBuilder.mass_flow_graph.
+   */
+  gtsam::NonlinearFactorGraph massFlowGraph(int k) const;
+
+  /**
+   * Return the trapezoidal collocation graph of all steps, on the air masses
+   * and time, the torso pose and twist, and the actuated joints in the air,
+   * as JRGraphBuilder.collocation_graph.
+   * @param step_phases  phase of each step
+   */
+  gtsam::NonlinearFactorGraph collocationGraph(
+      const std::vector<int> &step_phases) const;
+
+  /**
+   * Return the trajectory graph: the dynamics and mass flow graphs of all
+   * knots, and the collocation graph.
+   * @param step_phases  phase of each step, for step_phases.size() + 1 knots
+   */
+  gtsam::NonlinearFactorGraph trajectoryGraph(
+      const std::vector<int> &step_phases) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,404 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotSimulator.cpp
+ * @brief Step-by-step simulation of the pneumatic jumping robot.
+ */
+
+#include <gtdynamics/factors/TimeShiftedFactor.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::PriorFactor;
+using gtsam::Values;
+using gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+namespace {
+// Cost models of ActuationGraphBuilder.
+const auto kGasLawModel = Isotropic::Sigma(1, 0.0001);
+const auto kVolumeModel = Isotropic::Sigma(1, 1e-7);
+const auto kForceModel = Isotropic::Sigma(1, 0.01);
+const auto kBalanceModel = Isotropic::Sigma(1, 0.001);
+const auto kTorqueModel = Isotropic::Sigma(1, 0.01);
+const auto kMassRateModel = Isotropic::Sigma(1, 1e-5);
+const auto kPriorMassModel = Isotropic::Sigma(1, 1e-7);
+const auto kPriorQModel = Isotropic::Sigma(1, 0.001);
+const auto kPriorVModel = Isotropic::Sigma(1, 0.001);
+const auto kPriorPressureModel = Isotropic::Sigma(1, 0.1);
+
+// Initial mass flow rate of the mass flow solve.
+constexpr double kInitMassFlow = 0.007;
+// Atmospheric pressure, in kPa.
+constexpr double kAtmosphere = 101.325;
+
+// Return the values of the keys of the graph.
+Values Extract(const Values &values, const NonlinearFactorGraph &graph) {
+  Values extracted;
+  for (Key key : graph.keys()) extracted.insert(key, values.at(key));
+  return extracted;
+}
+
+// Insert the values of other into values, replacing existing ones if
+// overwrite is set.
+void Merge(Values *values, const Values &other, bool overwrite) {
+  for (auto &&key_value : other) {
+    if (!values->exists(key_value.key)) {
+      values->insert(key_value.key, key_value.value);
+    } else if (overwrite) {
+      values->update(key_value.key, key_value.value);
+    }
+  }
+}
+
+// Insert the double of key at step k, or of the same key at step k - 1.
+void CopyOrPrevious(const Values &values, Values *init_values, Key key,
+                    Key prev_key) {
+  init_values->insert(key, values.exists(key) ? values.atDouble(key)
+                                              : values.atDouble(prev_key));
+}
+}  // namespace
+
+/* ************************************************************************* */
+JumpingRobotSimulator::JumpingRobotSimulator(
+    const Robot &robot, const std::vector<JRActuatorParams> &actuators,
+    const JRPneumaticParams &pneumatic, const DynamicsGraph &graph_builder,
+    const gtsam::LevenbergMarquardtParams &lm_params, double threshold,
+    const std::string &torso_name)
+    : robot_(robot),
+      actuators_(actuators),
+      pneumatic_(pneumatic),
+      graph_builder_(graph_builder),
+      lm_params_(lm_params),
+      threshold_(threshold),
+      torso_name_(torso_name),
+      torso_id_(robot.link(torso_name)->id()),
+      fixed_ground_(false) {
+  for (auto &&link : robot_.links()) {
+    if (link->name() == "ground") fixed_ground_ = true;
+  }
+
+  // Actuator and mass flow graphs, as in ActuationGraphBuilder.
+  const JRPneumaticParams &p = pneumatic_;
+  for (auto &&actuator : actuators_) {
+    const int j = actuator.j;
+    NonlinearFactorGraph graph;
+    graph.emplace_shared<GasLawFactor>(
+        ActuatorPressureKey(j, 0), ActuatorVolumeKey(j, 0),
+        ActuatorMassKey(j, 0), kGasLawModel, p.gas_constant);
+    graph.emplace_shared<ActuatorVolumeFactor>(ActuatorVolumeKey(j, 0),
+                                               ContractionKey(j, 0),
+                                               kVolumeModel, p.d_tube,
+                                               p.l_tube);
+    graph.emplace_shared<SmoothActuatorFactor>(
+        ContractionKey(j, 0), ActuatorPressureKey(j, 0),
+        ActuatorForceKey(j, 0), kForceModel);
+    graph.emplace_shared<ForceBalanceFactor>(
+        ContractionKey(j, 0), JointAngleKey(j, 0), ActuatorForceKey(j, 0),
+        kBalanceModel, actuator.k_tendon, actuator.radius, actuator.q_rest,
+        actuator.positive);
+    graph.emplace_shared<JointTorqueFactor>(
+        JointAngleKey(j, 0), JointVelKey(j, 0), ActuatorForceKey(j, 0),
+        TorqueKey(j, 0), kTorqueModel, actuator.q_anta_limit, actuator.k_anta,
+        actuator.radius, actuator.b, actuator.positive);
+    actuator_graphs_.push_back(graph);
+
+    NonlinearFactorGraph mass_flow_graph;
+    mass_flow_graph.emplace_shared<MassFlowRateFactor>(
+        ActuatorPressureKey(j, 0), SourcePressureKey(0), MassRateOpenKey(j, 0),
+        kMassRateModel, p.d_tube, p.l_tube, p.mu, p.epsilon, p.k_const);
+    mass_flow_graphs_.push_back(mass_flow_graph);
+  }
+
+  // Robot dynamics layers, and the links with priors in the last one.
+  q_graph_ = graph_builder_.qFactors(robot_, 0);
+  v_graph_ = graph_builder_.vFactors(robot_, 0);
+  dynamics_graph_ = graph_builder_.aFactors(robot_, 0);
+  dynamics_graph_.push_back(graph_builder_.dynamicsFactors(robot_, 0));
+  const gtsam::KeySet dynamics_keys = dynamics_graph_.keys();
+  for (auto &&link : robot_.links()) {
+    const int i = link->id();
+    if (dynamics_keys.count(PoseKey(i, 0))) dynamics_pose_links_.push_back(i);
+    if (dynamics_keys.count(TwistKey(i, 0))) {
+      dynamics_twist_links_.push_back(i);
+    }
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotSimulator::AtStep(
+    const NonlinearFactorGraph &graph, int k) {
+  return k == 0 ? graph : ShiftTimeSteps(graph, k);
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::stepIntegration(int k, double dt, Values *values,
+                                            bool include_actuation) const {
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    const double q_prev = JointAngle(*values, j, k - 1);
+    const double v_prev = JointVel(*values, j, k - 1);
+    const double a_prev = JointAccel(*values, j, k - 1);
+    InsertJointAngle(values, j, k,
+                     q_prev + v_prev * dt + 0.5 * a_prev * dt * dt);
+    InsertJointVel(values, j, k, v_prev + a_prev * dt);
+  }
+
+  const Pose3 pose_prev = Pose(*values, torso_id_, k - 1);
+  const Vector6 twist_prev = Twist(*values, torso_id_, k - 1);
+  const Vector6 twist_accel_prev = TwistAccel(*values, torso_id_, k - 1);
+  const Pose3 prev_T_curr =
+      Pose3::Expmap(dt * twist_prev + 0.5 * twist_accel_prev * dt * dt);
+  InsertPose(values, torso_id_, k, pose_prev.compose(prev_T_curr));
+  InsertTwist(values, torso_id_, k, twist_prev + twist_accel_prev * dt);
+
+  if (include_actuation) {
+    double total_m_out = 0;
+    for (auto &&actuator : actuators_) {
+      const int j = actuator.j;
+      const double m_out = values->atDouble(MassRateActualKey(j, k - 1)) * dt;
+      values->insert(ActuatorMassKey(j, k),
+                     values->atDouble(ActuatorMassKey(j, k - 1)) + m_out);
+      total_m_out += m_out;
+    }
+    values->insert(SourceMassKey(k),
+                   values->atDouble(SourceMassKey(k - 1)) - total_m_out);
+  }
+
+  values->insert(TimeKey(k), values->atDouble(TimeKey(k - 1)) + dt);
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::stepActuationDynamics(int k,
+                                                  Values *values) const {
+  // The source pressure follows from the gas law directly.
+  const Key ps_key = SourcePressureKey(k);
+  if (!values->exists(ps_key)) {
+    const double m_s = values->atDouble(SourceMassKey(k));
+    const double V_s = values->atDouble(SourceVolumeKey());
+    values->insert(ps_key, m_s * pneumatic_.gas_constant / V_s / 1e3);
+  }
+
+  for (size_t a = 0; a < actuators_.size(); a++) {
+    const int j = actuators_[a].j;
+    const Key m_a_key = ActuatorMassKey(j, k), q_key = JointAngleKey(j, k),
+              v_key = JointVelKey(j, k);
+
+    NonlinearFactorGraph graph = AtStep(actuator_graphs_[a], k);
+    graph.emplace_shared<PriorFactor<double>>(
+        m_a_key, values->atDouble(m_a_key), kPriorMassModel);
+    graph.emplace_shared<PriorFactor<double>>(q_key, values->atDouble(q_key),
+                                              kPriorQModel);
+    graph.emplace_shared<PriorFactor<double>>(v_key, values->atDouble(v_key),
+                                              kPriorVModel);
+
+    // Initial values from the previous step, or the rest configuration.
+    Values init_values;
+    for (Key key : {m_a_key, q_key, v_key}) {
+      init_values.insert(key, values->atDouble(key));
+    }
+    const Key keys[] = {ActuatorPressureKey(j, k), ContractionKey(j, k),
+                        ActuatorForceKey(j, k), TorqueKey(j, k),
+                        ActuatorVolumeKey(j, k)};
+    if (k == 0) {
+      const ActuatorVolumeFactor volume(keys[4], keys[1], kVolumeModel,
+                                        pneumatic_.d_tube, pneumatic_.l_tube);
+      const double rest[] = {kAtmosphere, 0.0, 0.0, 0.0,
+                             volume.computeVolume(0.0)};
+      for (size_t n = 0; n < 5; n++) init_values.insert(keys[n], rest[n]);
+    } else {
+      for (Key key : keys) {
+        init_values.insert(key, values->atDouble(ShiftTime(key, -1)));
+      }
+    }
+    Merge(values, optimize(graph, init_values), false);
+
+    const auto mdot = computeMassFlow(*values, j, k);
+    values->insert(MassRateOpenKey(j, k), mdot.first);
+    values->insert(MassRateActualKey(j, k), mdot.second);
+  }
+}
+
+/* ************************************************************************* */
+std::pair<double, double> JumpingRobotSimulator::computeMassFlow(
+    const Values &values, int j, int k) const {
+  size_t a = 0;
+  while (a < actuators_.size() && actuators_[a].j != j) a++;
+  if (a == actuators_.size()) {
+    throw std::invalid_argument(
+        "JumpingRobotSimulator::computeMassFlow: joint " + std::to_string(j) +
+        " has no actuator.");
+  }
+
+  const Key pa_key = ActuatorPressureKey(j, k), ps_key = SourcePressureKey(k),
+            mdot_key = MassRateOpenKey(j, k);
+  NonlinearFactorGraph graph = AtStep(mass_flow_graphs_[a], k);
+  graph.emplace_shared<PriorFactor<double>>(pa_key, values.atDouble(pa_key),
+                                            kPriorPressureModel);
+  graph.emplace_shared<PriorFactor<double>>(ps_key, values.atDouble(ps_key),
+                                            kPriorPressureModel);
+  Values init_values;
+  init_values.insert(pa_key, values.atDouble(pa_key));
+  init_values.insert(ps_key, values.atDouble(ps_key));
+  init_values.insert(mdot_key, kInitMassFlow);
+  const double mdot = optimize(graph, init_values).atDouble(mdot_key);
+
+  const ValveControlFactor valve(TimeKey(k), ValveOpenTimeKey(j),
+                                 ValveCloseTimeKey(j), mdot_key,
+                                 MassRateActualKey(j, k), kMassRateModel,
+                                 pneumatic_.ct);
+  const double mdot_sigma = valve.computeExpectedTrueMassFlow(
+      values.atDouble(TimeKey(k)), values.atDouble(ValveOpenTimeKey(j)),
+      values.atDouble(ValveCloseTimeKey(j)), mdot);
+  return std::make_pair(mdot, mdot_sigma);
+}
+
+/* ************************************************************************* */
+Values JumpingRobotSimulator::initRobotValues(int k,
+                                              const Values &values) const {
+  Values init_values;
+  if (k == 0) {
+    // Forward kinematics, with the unknowns zero.
+    const Values fk = fixed_ground_
+                          ? robot_.forwardKinematics(values, k)
+                          : robot_.forwardKinematics(values, k, torso_name_);
+    for (auto &&link : robot_.links()) {
+      const int i = link->id();
+      const Key pose_key = PoseKey(i, k), twist_key = TwistKey(i, k);
+      InsertPose(&init_values, i, k,
+                 values.exists(pose_key) ? Pose(values, i, k) : Pose(fk, i, k));
+      InsertTwist(&init_values, i, k,
+                  values.exists(twist_key) ? Twist(values, i, k)
+                                           : Twist(fk, i, k));
+      InsertTwistAccel(&init_values, i, k, Vector6::Zero());
+    }
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      for (Key key : {JointAngleKey(j, k).key(), JointVelKey(j, k).key(),
+                      TorqueKey(j, k).key()}) {
+        init_values.insert(key,
+                           values.exists(key) ? values.atDouble(key) : 0.0);
+      }
+      InsertJointAccel(&init_values, j, k, 0.0);
+      InsertWrench(&init_values, joint->parent()->id(), j, k, Vector6::Zero());
+      InsertWrench(&init_values, joint->child()->id(), j, k, Vector6::Zero());
+    }
+    return init_values;
+  }
+
+  // Values of step k where known, and else those of step k - 1.
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    for (Key key : {JointAngleKey(j, k).key(), JointVelKey(j, k).key(),
+                    TorqueKey(j, k).key()}) {
+      CopyOrPrevious(values, &init_values, key, ShiftTime(key, -1));
+    }
+    InsertJointAccel(&init_values, j, k, JointAccel(values, j, k - 1));
+    for (int i : {joint->parent()->id(), joint->child()->id()}) {
+      InsertWrench(&init_values, i, j, k, Wrench(values, i, j, k - 1));
+    }
+  }
+  for (auto &&link : robot_.links()) {
+    const int i = link->id();
+    const int t_pose = values.exists(PoseKey(i, k)) ? k : k - 1;
+    const int t_twist = values.exists(TwistKey(i, k)) ? k : k - 1;
+    InsertPose(&init_values, i, k, Pose(values, i, t_pose));
+    InsertTwist(&init_values, i, k, Twist(values, i, t_twist));
+    InsertTwistAccel(&init_values, i, k, TwistAccel(values, i, k - 1));
+  }
+  return init_values;
+}
+
+/* ************************************************************************* */
+void JumpingRobotSimulator::stepRobotDynamicsByLayer(int k,
+                                                     Values *values) const {
+  const OptimizerSetting &opt = graph_builder_.opt();
+  Values init_values = initRobotValues(k, *values);
+
+  // q level.
+  NonlinearFactorGraph graph_q = AtStep(q_graph_, k);
+  graph_q.emplace_shared<PriorFactor<Pose3>>(
+      PoseKey(torso_id_, k), Pose(*values, torso_id_, k), opt.p_cost_model);
+  if (!fixed_ground_) {
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      graph_q.emplace_shared<PriorFactor<double>>(
+          JointAngleKey(j, k), JointAngle(*values, j, k),
+          opt.prior_q_cost_model);
+    }
+  }
+  Merge(&init_values, optimize(graph_q, Extract(init_values, graph_q)), true);
+
+  // v level.
+  NonlinearFactorGraph graph_v = AtStep(v_graph_, k);
+  graph_v.emplace_shared<PriorFactor<Vector6>>(
+      TwistKey(torso_id_, k), Twist(*values, torso_id_, k), opt.v_cost_model);
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    graph_v.emplace_shared<PriorFactor<double>>(
+        JointAngleKey(j, k), JointAngle(init_values, j, k),
+        opt.prior_q_cost_model);
+    if (!fixed_ground_) {
+      graph_v.emplace_shared<PriorFactor<double>>(
+          JointVelKey(j, k), JointVel(*values, j, k), opt.prior_qv_cost_model);
+    }
+  }
+  Merge(&init_values, optimize(graph_v, Extract(init_values, graph_v)), true);
+
+  // Accelerations and wrenches.
+  NonlinearFactorGraph graph_d = AtStep(dynamics_graph_, k);
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    graph_d.emplace_shared<PriorFactor<double>>(
+        JointAngleKey(j, k), JointAngle(init_values, j, k),
+        opt.prior_q_cost_model);
+    graph_d.emplace_shared<PriorFactor<double>>(
+        JointVelKey(j, k), JointVel(init_values, j, k),
+        opt.prior_qv_cost_model);
+    graph_d.emplace_shared<PriorFactor<double>>(
+        TorqueKey(j, k), Torque(init_values, j, k), opt.prior_t_cost_model);
+  }
+  for (int i : dynamics_pose_links_) {
+    graph_d.emplace_shared<PriorFactor<Pose3>>(
+        PoseKey(i, k), Pose(init_values, i, k), opt.p_cost_model);
+  }
+  for (int i : dynamics_twist_links_) {
+    graph_d.emplace_shared<PriorFactor<Vector6>>(
+        TwistKey(i, k), Twist(init_values, i, k), opt.v_cost_model);
+  }
+  Merge(&init_values, optimize(graph_d, Extract(init_values, graph_d)), true);
+  Merge(values, init_values, true);
+}
+
+/* ************************************************************************* */
+Values JumpingRobotSimulator::optimize(const NonlinearFactorGraph &graph,
+                                       const Values &init_values) const {
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, init_values,
+                                               lm_params_);
+  Values result = optimizer.optimize();
+  if (graph.error(result) > threshold_) {
+    throw std::runtime_error(
+        "JumpingRobotSimulator: optimizing dynamics does not converge, "
+        "error " +
+        std::to_string(graph.error(result)));
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotSimulator.h
+ * @brief Step-by-step simulation of the pneumatic jumping robot.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// @name Keys of the pneumatic quantities, named as in jumping_robot.py.
+/// @{
+constexpr DynamicsSymbol ActuatorPressureKey(int j, int t) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('P', 'a'), j, t);
+}
+constexpr DynamicsSymbol SourcePressureKey(int t) {
+  return DynamicsSymbol::SimpleSymbol(DynamicsSymbol::MakeLabel('P', 's'), t);
+}
+constexpr DynamicsSymbol ContractionKey(int j, int t) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('d', 'x'), j, t);
+}
+constexpr DynamicsSymbol ActuatorForceKey(int j, int t) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('f', 'a'), j, t);
+}
+constexpr DynamicsSymbol ActuatorMassKey(int j, int t) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('m', 'a'), j, t);
+}
+constexpr DynamicsSymbol SourceMassKey(int t) {
+  return DynamicsSymbol::SimpleSymbol(DynamicsSymbol::MakeLabel('m', 's'), t);
+}
+constexpr DynamicsSymbol MassRateOpenKey(int j, int t) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('m', 'o'), j, t);
+}
+constexpr DynamicsSymbol MassRateActualKey(int j, int t) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('m', 'd'), j, t);
+}
+constexpr DynamicsSymbol ActuatorVolumeKey(int j, int t) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('V', 'a'), j, t);
+}
+constexpr DynamicsSymbol SourceVolumeKey() {
+  return DynamicsSymbol::SimpleSymbol(DynamicsSymbol::MakeLabel('V', 's'), 0);
+}
+constexpr DynamicsSymbol ValveOpenTimeKey(int j) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('T', 'o'), j, 0);
+}
+constexpr DynamicsSymbol ValveCloseTimeKey(int j) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('T', 'c'), j, 0);
+}
+/// @}
+
+/// Parameters of one pneumatic actuator, from the actuator configuration.
+struct JRActuatorParams {
+  int j = 0;                ///< id of the actuated joint
+  bool positive = false;    ///< whether contraction gives a positive torque
+  double k_anta = 0;        ///< antagonistic spring stiffness
+  double k_tendon = 0;      ///< tendon stiffness
+  double q_anta_limit = 0;  ///< joint angle where the antagonist engages
+  double b = 0;             ///< joint damping
+  double radius = 0;        ///< pulley radius
+  double q_rest = 0;        ///< joint angle at rest
+};
+
+/// Pneumatic parameters shared by all actuators, in SI units.
+struct JRPneumaticParams {
+  double d_tube = 0;        ///< tube diameter, valve to muscle
+  double l_tube = 0;        ///< tube length, valve to muscle
+  double mu = 0;            ///< tube viscosity
+  double epsilon = 0;       ///< tube roughness
+  double ct = 0;            ///< valve time constant
+  double k_const = 0;       ///< 1 / (Rs T)
+  double gas_constant = 0;  ///< Rs T, as in the gas law factor
+};
+
+/**
+ * JumpingRobotSimulator runs the inner loop of jr_simulator.py: each time
+ * step integrates the previous one, solves the dynamics of each actuator, and
+ * then the robot dynamics layer by layer (q, v, then accelerations and
+ * wrenches), each in a small factor graph with priors on the known values.
+ *
+ * The constraint graphs of every solve are built once, at time step 0, and
+ * shifted to each time step with TimeShiftedFactor, so a step only adds the
+ * priors; values are read and written in a single gtsam::Values, with the
+ * same keys and semantics as JRSimulator.
+ */
+class JumpingRobotSimulator {
+ private:
+  Robot robot_;
+  std::vector<JRActuatorParams> actuators_;
+  JRPneumaticParams pneumatic_;
+  DynamicsGraph graph_builder_;
+  gtsam::LevenbergMarquardtParams lm_params_;
+  double threshold_;
+  std::string torso_name_;
+  int torso_id_;
+  bool fixed_ground_;
+
+  // Templates at time step 0, built in the constructor.
+  std::vector<gtsam::NonlinearFactorGraph> actuator_graphs_, mass_flow_graphs_;
+  gtsam::NonlinearFactorGraph q_graph_, v_graph_, dynamics_graph_;
+  std::vector<int> dynamics_pose_links_, dynamics_twist_links_;
+
+  // Return the template shifted to time step k.
+  static gtsam::NonlinearFactorGraph AtStep(
+      const gtsam::NonlinearFactorGraph &graph, int k);
+
+  // Initial values of the robot dynamics of step k, as in JRValues.
+  gtsam::Values initRobotValues(int k, const gtsam::Values &values) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param robot          the robot
+   * @param actuators      parameters of each actuator
+   * @param pneumatic      pneumatic parameters
+   * @param graph_builder  builder of the robot dynamics graphs, with the
+   *                       prior cost models of its OptimizerSetting
+   * @param lm_params      parameters of every solve
+   * @param threshold      largest graph error of a converged solve
+   * @param torso_name     name of the link with the integrated pose and twist
+   */
+  JumpingRobotSimulator(
+      const Robot &robot, const std::vector<JRActuatorParams> &actuators,
+      const JRPneumaticParams &pneumatic, const DynamicsGraph &graph_builder,
+      const gtsam::LevenbergMarquardtParams &lm_params =
+          gtsam::LevenbergMarquardtParams(),
+      double threshold = 1e-5, const std::string &torso_name = "torso");
+
+  /// Return the robot.
+  const Robot &robot() const { return robot_; }
+
+  /**
+   * Integrate step k - 1 into step k: joint angles and velocities, torso
+   * pose and twist, time, and, with include_actuation, the air masses.
+   */
+  void stepIntegration(int k, double dt, gtsam::Values *values,
+                       bool include_actuation = true) const;
+
+  /**
+   * Solve the dynamics of each actuator at step k, given the joint angles,
+   * velocities, air masses and source mass of step k and the valve times,
+   * and add the pressures, forces, torques and mass flow rates to values.
+   * Throws std::runtime_error if a solve does not converge.
+   */
+  void stepActuationDynamics(int k, gtsam::Values *values) const;
+
+  /**
+   * Solve the robot dynamics of step k by layers, given the torso pose and
+   * twist, joint angles and velocities (unless the robot has a "ground"
+   * link) and torques of step k, and write the results to values.
+   * Throws std::runtime_error if a solve does not converge.
+   */
+  void stepRobotDynamicsByLayer(int k, gtsam::Values *values) const;
+
+  /**
+   * Return the nominal and valve-controlled mass flow rates of actuator
+   * j at step k, given the pressures, the time and the valve times.
+   */
+  std::pair<double, double> computeMassFlow(const gtsam::Values &values,
+                                            int j, int k) const;
+
+  /**
+   * Optimize the graph with Levenberg-Marquardt, and throw
+   * std::runtime_error if the error is above the threshold.
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &init_values) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotSweep.cpp
+ * @brief Batched simulation of the jumping robot over parameter sets.
+ */
+
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSweep.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace {
+// Vertical ground reaction force on the foot of the side, "l" or "r", in the
+// world frame, as JRValues.get_ground_force_z.
+double GroundForceZ(const Robot &robot, const std::string &side, int k,
+                    const Values &values) {
+  const int i = robot.link("shank_" + side)->id();
+  const int j = robot.joint("foot_" + side)->id();
+  const gtsam::Vector6 wrench_w =
+      Pose(values, i, k).inverse().AdjointMap().transpose() *
+      Wrench(values, i, j, k);
+  return wrench_w(5);
+}
+
+// Phase after step k, as JRSimulator.step_phase_change.
+int NextPhase(const Robot &robot, int phase, int k, const Values &values) {
+  if (phase == 0) {
+    const bool left_off = GroundForceZ(robot, "l", k, values) < 0;
+    const bool right_off = GroundForceZ(robot, "r", k, values) < 0;
+    if (left_off && right_off) return 3;
+    if (left_off) return 2;
+    if (right_off) return 1;
+  } else if (phase == 1) {
+    if (GroundForceZ(robot, "l", k, values) < 0) return 3;
+  } else if (phase == 2) {
+    if (GroundForceZ(robot, "r", k, values) < 0) return 3;
+  }
+  return phase;
+}
+
+void InsertOrUpdate(Values *values, Key key, double value) {
+  if (values->exists(key)) {
+    values->update(key, value);
+  } else {
+    values->insert(key, value);
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+JumpingRobotSweep::JumpingRobotSweep(
+    const std::vector<Robot> &phase_robots,
+    const std::vector<JRActuatorParams> &actuators,
+    const JRPneumaticParams &pneumatic, const DynamicsGraph &graph_builder,
+    const Values &initial_values, const std::string &torso_name)
+    : actuators_(actuators),
+      pneumatic_(pneumatic),
+      graph_builder_(graph_builder),
+      initial_values_(initial_values),
+      torso_name_(torso_name) {
+  if (phase_robots.size() != 1 && phase_robots.size() != 4) {
+    throw std::invalid_argument(
+        "JumpingRobotSweep: needs the robots of phase 0, or of phases 0 to "
+        "3.");
+  }
+  for (auto &&robot : phase_robots) {
+    simulators_.emplace_back(robot, actuators_, pneumatic_, graph_builder_,
+                             gtsam::LevenbergMarquardtParams(), 1e-5,
+                             torso_name_);
+  }
+}
+
+/* ************************************************************************* */
+std::vector<JumpingRobotSimulator> JumpingRobotSweep::simulators(
+    const std::vector<JRActuatorParams> &actuators) const {
+  std::vector<JumpingRobotSimulator> simulators;
+  for (auto &&simulator : simulators_) {
+    simulators.emplace_back(simulator.robot(), actuators, pneumatic_,
+                            graph_builder_, gtsam::LevenbergMarquardtParams(),
+                            1e-5, torso_name_);
+  }
+  return simulators;
+}
+
+/* ************************************************************************* */
+Values JumpingRobotSweep::initialValues(const JRSweepConfig &config) const {
+  Values values = initial_values_;
+  auto set_valve_times = [&](const std::vector<double> &times,
+                             Key (*key)(int j)) {
+    if (times.empty()) return;
+    if (times.size() != actuators_.size()) {
+      throw std::invalid_argument(
+          "JumpingRobotSweep: needs one valve time per actuator.");
+    }
+    for (size_t a = 0; a < actuators_.size(); a++) {
+      InsertOrUpdate(&values, key(actuators_[a].j), times[a]);
+    }
+  };
+  set_valve_times(config.valve_open_times,
+                  [](int j) -> Key { return ValveOpenTimeKey(j); });
+  set_valve_times(config.valve_close_times,
+                  [](int j) -> Key { return ValveCloseTimeKey(j); });
+
+  // Source mass of the pressure, as JRValues.init_config_values.
+  if (config.source_pressure > 0) {
+    const double V_s = values.atDouble(SourceVolumeKey());
+    InsertOrUpdate(&values, SourcePressureKey(0), config.source_pressure);
+    InsertOrUpdate(&values, SourceMassKey(0),
+                   V_s * config.source_pressure * 1e3 /
+                       pneumatic_.gas_constant);
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values JumpingRobotSweep::simulate(const JRSweepConfig &config,
+                                   size_t num_steps, double dt,
+                                   std::vector<int> *step_phases) const {
+  const std::vector<JumpingRobotSimulator> *phase_simulators = &simulators_;
+  std::vector<JumpingRobotSimulator> config_simulators;
+  if (!config.actuators.empty()) {
+    config_simulators = simulators(config.actuators);
+    phase_simulators = &config_simulators;
+  }
+
+  Values values = initialValues(config);
+  if (step_phases) step_phases->clear();
+  int phase = 0;
+  for (size_t k = 0; k < num_steps; k++) {
+    const JumpingRobotSimulator &simulator = (*phase_simulators)[phase];
+    if (k != 0) simulator.stepIntegration(k, dt, &values);
+    simulator.stepActuationDynamics(k, &values);
+    simulator.stepRobotDynamicsByLayer(k, &values);
+    if (step_phases) step_phases->push_back(phase);
+    if (phase_simulators->size() > 1) {
+      phase = NextPhase(simulator.robot(), phase, k, values);
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Vector JumpingRobotSweep::metrics(const Values &trajectory,
+                                  const std::vector<int> &step_phases,
+                                  double dt) const {
+  const int torso = simulators_.front().robot().link(torso_name_)->id();
+  const int K = step_phases.size();
+  Vector row = Vector::Constant(kNumColumns,
+                                std::numeric_limits<double>::quiet_NaN());
+  row(kConverged) = 1;
+  if (K == 0) return row;
+
+  const double z0 = Pose(trajectory, torso, 0).z();
+  double height = 0, work = 0;
+  for (int k = 0; k < K; k++) {
+    height = std::max(height, Pose(trajectory, torso, k).z() - z0);
+    for (auto &&actuator : actuators_) {
+      work += Torque(trajectory, actuator.j, k) *
+              JointVel(trajectory, actuator.j, k) * dt;
+    }
+  }
+  const Pose3 final_pose = Pose(trajectory, torso, K - 1);
+  row(kJumpHeight) = height;
+  row.segment<3>(kFinalX) = final_pose.translation();
+  row.segment<3>(kFinalRoll) = final_pose.rotation().rpy();
+  row(kActuationWork) = work;
+  row(kAirMassUsed) = trajectory.atDouble(SourceMassKey(0)) -
+                      trajectory.atDouble(SourceMassKey(K - 1));
+  const auto liftoff = std::find(step_phases.begin(), step_phases.end(), 3);
+  row(kLiftoffStep) =
+      liftoff == step_phases.end() ? -1 : liftoff - step_phases.begin();
+  return row;
+}
+
+/* ************************************************************************* */
+Matrix JumpingRobotSweep::sweep(const std::vector<JRSweepConfig> &configs,
+                                size_t num_steps, double dt) const {
+  // Check the parameter sets up front, before the parallel loop.
+  for (auto &&config : configs) {
+    for (auto &&times : {config.valve_open_times, config.valve_close_times}) {
+      if (!times.empty() && times.size() != actuators_.size()) {
+        throw std::invalid_argument(
+            "JumpingRobotSweep: needs one valve time per actuator.");
+      }
+    }
+  }
+
+  Matrix table(configs.size(), kNumColumns);
+  ParallelFor(configs.size(), [&](size_t i) {
+    try {
+      std::vector<int> step_phases;
+      const Values trajectory =
+          simulate(configs[i], num_steps, dt, &step_phases);
+      table.row(i) = metrics(trajectory, step_phases, dt).transpose();
+    } catch (const std::runtime_error &) {
+      table.row(i).setConstant(std::numeric_limits<double>::quiet_NaN());
+      table(i, kConverged) = 0;
+    }
+  });
+  return table;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotSweep.h
+ * @brief Batched simulation of the jumping robot over parameter sets.
+ */
+
+#pragma once
+
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtsam/base/Matrix.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * One parameter set of a sweep. Empty or non-positive fields keep the value
+ * of the base configuration.
+ */
+struct JRSweepConfig {
+  std::vector<double> valve_open_times;   ///< per actuator, in order
+  std::vector<double> valve_close_times;  ///< per actuator, in order
+  double source_pressure = 0;             ///< initial source pressure, kPa
+  std::vector<JRActuatorParams> actuators;  ///< actuator models
+
+  /// Default constructor, the base configuration.
+  JRSweepConfig() {}
+
+  /// Constructor with valve times and source pressure.
+  JRSweepConfig(const std::vector<double> &valve_open_times,
+                const std::vector<double> &valve_close_times,
+                double source_pressure)
+      : valve_open_times(valve_open_times),
+        valve_close_times(valve_close_times),
+        source_pressure(source_pressure) {}
+};
+
+/**
+ * JumpingRobotSweep simulates the jumping robot for many parameter sets in
+ * parallel, as jr_simulator.py does for one: each step integrates, solves the
+ * actuators and the robot dynamics, and switches to the robot of the next
+ * phase when a foot loses contact. The phase robots and simulators are built
+ * once and shared by all parameter sets that keep the base actuator models.
+ *
+ * Phases are those of JumpingRobot: 0 both feet on the ground, 1 only the
+ * left, 2 only the right, 3 in the air. The robot of phase p has joints
+ * "foot_l" on link "shank_l" and "foot_r" on "shank_r" for the feet on the
+ * ground, and a torso link.
+ */
+class JumpingRobotSweep {
+ public:
+  /// Columns of the metrics table.
+  enum Column {
+    kConverged,      ///< 1 if all solves converged, else 0 and NaN metrics
+    kJumpHeight,     ///< largest rise of the torso over its initial height
+    kFinalX,         ///< final torso position
+    kFinalY,
+    kFinalZ,
+    kFinalRoll,      ///< final torso orientation
+    kFinalPitch,
+    kFinalYaw,
+    kActuationWork,  ///< sum of actuator torque * joint velocity * dt
+    kAirMassUsed,    ///< air mass out of the source
+    kLiftoffStep,    ///< first step in the air, or -1
+    kNumColumns
+  };
+
+ private:
+  std::vector<JRActuatorParams> actuators_;
+  JRPneumaticParams pneumatic_;
+  DynamicsGraph graph_builder_;
+  std::vector<JumpingRobotSimulator> simulators_;  // by phase
+  gtsam::Values initial_values_;
+  std::string torso_name_;
+
+  // Simulators of all phases with other actuator models.
+  std::vector<JumpingRobotSimulator> simulators(
+      const std::vector<JRActuatorParams> &actuators) const;
+
+ public:
+  /**
+   * Constructor.
+   * @param phase_robots    robots of phases 0 to 3, or only of phase 0 to
+   *                        simulate without contact changes
+   * @param actuators       base actuator models
+   * @param pneumatic       pneumatic parameters
+   * @param graph_builder   builder of the robot dynamics graphs
+   * @param initial_values  values of step 0 of the base configuration, as
+   *                        JRValues.init_config_values, with the valve times,
+   *                        air masses and source volume
+   * @param torso_name      name of the torso link
+   */
+  JumpingRobotSweep(const std::vector<Robot> &phase_robots,
+                    const std::vector<JRActuatorParams> &actuators,
+                    const JRPneumaticParams &pneumatic,
+                    const DynamicsGraph &graph_builder,
+                    const gtsam::Values &initial_values,
+                    const std::string &torso_name = "torso");
+
+  /// Return the values of step 0 of a parameter set.
+  gtsam::Values initialValues(const JRSweepConfig &config) const;
+
+  /**
+   * Simulate one parameter set. Throws std::runtime_error if a solve does
+   * not converge.
+   * @param config       the parameter set
+   * @param num_steps    number of time steps
+   * @param dt           duration of a time step
+   * @param step_phases  if given, set to the phase of each step
+   */
+  gtsam::Values simulate(const JRSweepConfig &config, size_t num_steps,
+                         double dt,
+                         std::vector<int> *step_phases = nullptr) const;
+
+  /// Return the metrics of a simulated trajectory, a row of the table.
+  gtsam::Vector metrics(const gtsam::Values &trajectory,
+                        const std::vector<int> &step_phases, double dt) const;
+
+  /**
+   * Simulate all parameter sets in parallel, and return their metrics, one
+   * row per parameter set and one column per Column.
+   */
+  gtsam::Matrix sweep(const std::vector<JRSweepConfig> &configs,
+                      size_t num_steps, double dt) const;
+};
+
+}  // namespace gtdynamics
@@ -64,3 +64,25 @@ class JRGraphBuilder:
         graph = self.actuation_graph_builder.dynamics_graph(jr, k)
         graph.add(self.robot_graph_builder.dynamics_graph(jr, k))
         return graph
+
+    def trajectory_graph(self, yaml_file_path: str, init_config: dict,
+                         step_phases: list) -> NonlinearFactorGraph:
+        """ Create the whole trajectory graph in one native call: the
+            dynamics and mass flow graphs of all steps, with the robot of
+            each phase, and the collocation graph.
+        """
+        return self.native_builder(yaml_file_path,
+                                   init_config).trajectoryGraph(step_phases)
+
+    def native_builder(self, yaml_file_path: str, init_config: dict):
+        """ Create the C++ JumpingRobotGraphBuilder, with the robots of all
+            phases and the noise models of the robot graph builder.
+        """
+        jr = JumpingRobot(yaml_file_path, init_config)
+        phase_robots = [
+            JumpingRobot(yaml_file_path, init_config, phase).robot
+            for phase in range(4)
+        ]
+        return gtd.JumpingRobotGraphBuilder(
+            phase_robots, jr.actuator_params(), jr.pneumatic_params(),
+            self.robot_graph_builder.graph_builder)
@@ -40,6 +40,61 @@ class JRSimulator:
         self.jr_graph_builder = JRGraphBuilder()
         self.init_config = init_config
         self.jr = JumpingRobot(yaml_file_path, init_config)
+        self.engine = self.create_engine(self.jr)
+
+    @staticmethod
+    def actuator_params(jr):
+        """ Parameters of the actuators of the native simulator engine. """
+        return jr.actuator_params()
+
+    @staticmethod
+    def pneumatic_params(jr):
+        """ Pneumatic parameters of the native simulator engine. """
+        return jr.pneumatic_params()
+
+    def create_engine(self, jr):
+        """ Create the native simulator engine of the jumping robot. """
+        graph_builder = self.jr_graph_builder.robot_graph_builder.graph_builder
+        return gtd.JumpingRobotSimulator(jr.robot, self.actuator_params(jr),
+                                         self.pneumatic_params(jr),
+                                         graph_builder)
+
+    def create_sweep(self, controls):
+        """ Create the native batched simulator, with the robots of all
+            phases and the initial values of the base controls. """
+        jr = JumpingRobot(self.yaml_file_path, self.init_config)
+        phase_robots = [
+            JumpingRobot(self.yaml_file_path, self.init_config, phase).robot
+            for phase in range(4)
+        ]
+        graph_builder = self.jr_graph_builder.robot_graph_builder.graph_builder
+        return gtd.JumpingRobotSweep(phase_robots, self.actuator_params(jr),
+                                     self.pneumatic_params(jr), graph_builder,
+                                     JRValues.init_config_values(jr, controls))
+
+    def sweep(self, num_steps: int, dt: float, controls_list):
+        """ Simulate many controls in parallel, and return their metrics.
+
+        Args:
+            num_steps (int): total number of simulation steps
+            dt (float): duration of each step
+            controls_list (list): controls of each simulation, with the same
+                keys as in `simulate`
+
+        Returns:
+            np.ndarray: one row per controls, with the columns of the
+                        C++ JumpingRobotSweep::Column
+        """
+        jr = JumpingRobot(self.yaml_file_path, self.init_config)
+        sweep = self.create_sweep(controls_list[0])
+        names = [actuator.name for actuator in jr.actuators]
+        configs = []
+        for controls in controls_list:
+            configs.append(
+                gtd.JRSweepConfig([float(controls["Tos"][n]) for n in names],
+                                  [float(controls["Tcs"][n]) for n in names],
+                                  float(controls["P_s_0"])))
+        return sweep.sweep(configs, num_steps, dt)
 
     def step_integration(self, k, dt, values, include_actuation=True):
         """ Perform integration, and add results to values.
@@ -49,15 +104,7 @@ class JRSimulator:
             dt (float): duration of time step
             values (gtsam.Values): values and derivatives of previous step
         """
-        JRValues.integrate_joints(self.jr, values, k, dt)
-        JRValues.integrate_torso(self.jr, values, k, dt)
-        if include_actuation:
-            JRValues.integrate_mass(self.jr, values, k, dt)
-
-        # integrate time
-        t_prev = values.atDouble(gtd.TimeKey(k - 1).key())
-        t_curr = t_prev + dt
-        values.insert(gtd.TimeKey(k).key(), t_curr)
+        self.engine.stepIntegration(k, dt, values, include_actuation)
 
     def step_actuation_dynamics(self, k, values):
         """ Perform actuation dynamics by solving the actuation dynamics factor
@@ -72,56 +119,7 @@ class JRSimulator:
             Exception: optimization does not converge
         """
 
-        # directly compute source pressure
-        m_s = values.atDouble(Actuator.SourceMassKey(k))
-        V_s = values.atDouble(Actuator.SourceVolumeKey())
-        P_s = m_s * self.jr.gas_constant / V_s / 1e3
-        P_s_key = Actuator.SourcePressureKey(k)
-
-        # perform actuator forward dynamics by solving its dynamcis graph
-        for actuator in self.jr.actuators:
-            j = actuator.j
-
-            # construct graph
-            graph = self.jr_graph_builder.actuation_graph_builder.actuator_dynamics_graph(
-                self.jr, actuator, k)
-            m_a_key = Actuator.MassKey(j, k)
-            q_key = gtd.JointAngleKey(j, k).key()
-            v_key = gtd.JointVelKey(j, k).key()
-            m_a = values.atDouble(m_a_key)
-            q = values.atDouble(q_key)
-            v = values.atDouble(v_key)
-            actuation_graph_builder = self.jr_graph_builder.actuation_graph_builder
-            graph.add(
-                gtd.PriorFactorDouble(
-                    m_a_key, m_a, actuation_graph_builder.prior_m_cost_model))
-            graph.add(
-                gtd.PriorFactorDouble(
-                    P_s_key, P_s,
-                    actuation_graph_builder.prior_pressure_cost_model))
-            graph.add(
-                gtd.PriorFactorDouble(
-                    q_key, q, actuation_graph_builder.prior_q_cost_model))
-            graph.add(
-                gtd.PriorFactorDouble(
-                    v_key, v, actuation_graph_builder.prior_v_cost_model))
-            # TODO(yetong): check why adding the massflow graph makes it unable to optimize
-
-            # construct init values and optimize
-            if k == 0:
-                init_values = JRValues.init_values_from_init_config_actuator(
-                    self.jr, j, k, values)
-            else:
-                init_values = JRValues.init_values_from_prev_actuator(
-                    j, k, values)
-            results = self.optimize(graph, init_values)
-            mergeValues(values, results)
-
-            # compute mass flow
-            mdot, mdot_sigma = JRValues.compute_mass_flow(
-                self.jr, values, j, k)
-            values.insert(Actuator.MassRateOpenKey(j, k), mdot)
-            values.insert(Actuator.MassRateActualKey(j, k), mdot_sigma)
+        self.engine.stepActuationDynamics(k, values)
 
     def step_robot_dynamics_by_layer(self, k, values):
         """ In case solving the entire dynamics graph is hard to converge,
@@ -129,109 +127,7 @@ class JRSimulator:
             graph by layers (q, v, dynamics).
         """
 
-        # construct init values
-        if k == 0:
-            init_values = JRValues.init_values_from_fk_robot(
-                self.jr, k, values)
-        else:
-            init_values = JRValues.init_values_from_prev_robot(
-                self.jr.robot, k, values)
-
-        robot_graph_builder = self.jr_graph_builder.robot_graph_builder
-        opt = robot_graph_builder.graph_builder.opt()
-        torso_i = self.jr.robot.link("torso").id()
-        link_names = [link.name() for link in self.jr.robot.links()]
-
-        # solve q level
-        graph_q = robot_graph_builder.graph_builder.qFactors(
-            self.jr.robot, k, None)
-        pose_key = gtd.PoseKey(torso_i, k).key()
-        torso_pose = gtd.Pose(values, torso_i, k)
-        graph_q.add(
-            gtsam.PriorFactorPose3(pose_key, torso_pose, opt.p_cost_model))
-        if "ground" not in link_names:
-            for joint in self.jr.robot.joints():
-                j = joint.id()
-                q_key = gtd.JointAngleKey(j, k).key()
-                graph_q.add(
-                    gtd.PriorFactorDouble(q_key, gtd.JointAngle(values, j, k),
-                                          opt.prior_q_cost_model))
-
-        init_values_q = gtd.ExtractValues(init_values, graph_q.keys())
-        results_q = self.optimize(graph_q, init_values_q)
-        mergeValues(init_values, results_q, overwrite=True)
-
-        # solve v level
-        graph_v = robot_graph_builder.graph_builder.vFactors(
-            self.jr.robot, k, None)
-        twist_key = gtd.TwistKey(torso_i, k).key()
-        torso_twist = gtd.Twist(values, torso_i, k)
-        graph_v.add(
-            gtd.PriorFactorVector6(twist_key, torso_twist, opt.v_cost_model))
-        for joint in self.jr.robot.joints():
-            j = joint.id()
-            q_key = gtd.JointAngleKey(j, k).key()
-            graph_v.add(
-                gtd.PriorFactorDouble(q_key, init_values.atDouble(q_key),
-                                      opt.prior_q_cost_model))
-        if not "ground" in link_names:
-            for joint in self.jr.robot.joints():
-                j = joint.id()
-                v_key = gtd.JointVelKey(j, k).key()
-                graph_v.add(
-                    gtd.PriorFactorDouble(v_key, gtd.JointVel(values, j, k),
-                                          opt.prior_qv_cost_model))
-
-        init_values_v = gtd.ExtractValues(init_values, graph_v.keys())
-        results_v = self.optimize(graph_v, init_values_v)
-        mergeValues(init_values, results_v, overwrite=True)
-
-        # solve dynamics level
-        graph_a = robot_graph_builder.graph_builder.aFactors(
-            self.jr.robot, k, None)
-        graph_d = robot_graph_builder.graph_builder.dynamicsFactors(
-            self.jr.robot, k, None, None)
-        graph_dynamics = graph_a
-        graph_dynamics.push_back(graph_d)
-
-        for joint in self.jr.robot.joints():
-            j = joint.id()
-            q_key = gtd.JointAngleKey(j, k).key()
-            v_key = gtd.JointVelKey(j, k).key()
-            torque_key = gtd.TorqueKey(j, k).key()
-            graph_dynamics.add(
-                gtd.PriorFactorDouble(q_key, init_values.atDouble(q_key),
-                                      opt.prior_q_cost_model))
-            graph_dynamics.add(
-                gtd.PriorFactorDouble(v_key, init_values.atDouble(v_key),
-                                      opt.prior_qv_cost_model))
-            graph_dynamics.add(
-                gtd.PriorFactorDouble(torque_key,
-                                      init_values.atDouble(torque_key),
-                                      opt.prior_t_cost_model))
-        for link in self.jr.robot.links():
-            i = link.id()
-            pose_key = gtd.PoseKey(i, k).key()
-            twist_key = gtd.TwistKey(i, k).key()
-            graph_dynamics_keys = [
-                key for key in gtd.KeySetToKeyVector(graph_dynamics.keys())
-            ]
-            if pose_key in graph_dynamics_keys:
-                graph_dynamics.add(
-                    gtsam.PriorFactorPose3(pose_key,
-                                           init_values.atPose3(pose_key),
-                                           opt.p_cost_model))
-            if twist_key in graph_dynamics_keys:
-                graph_dynamics.add(
-                    gtd.PriorFactorVector6(twist_key,
-                                           gtd.Twist(init_values, i, k),
-                                           opt.v_cost_model))
-
-        init_values_dynamics = gtd.ExtractValues(init_values,
-                                                 graph_dynamics.keys())
-        results_dynamics = self.optimize(graph_dynamics, init_values_dynamics)
-        mergeValues(init_values, results_dynamics, overwrite=True)
-        mergeValues(values, init_values, overwrite=True)
+        self.engine.stepRobotDynamicsByLayer(k, values)
 
     def step_robot_dynamics(self, k, values):
         """ Perform robot dynamics by first performing forward kinematics,
@@ -359,6 +255,7 @@ class JRSimulator:
         if new_phase != phase:
             self.jr = JumpingRobot(self.yaml_file_path, self.init_config,
                                    new_phase)
+            self.engine = self.create_engine(self.jr)
         return new_phase
 
     def simulate(self, num_steps: int, dt: float, controls):
@@ -374,6 +271,7 @@ class JRSimulator:
                                    each step)
         """
         self.jr = JumpingRobot(self.yaml_file_path, self.init_config)
+        self.engine = self.create_engine(self.jr)
         phase = 0
         step_phases = [phase]
 
@@ -393,6 +291,7 @@ class JRSimulator:
         """ Run simulation with specified torque sequence. """
         controls = JumpingRobot.create_controls()
         self.jr = JumpingRobot(self.yaml_file_path, controls)
+        self.engine = self.create_engine(self.jr)
         phase = 0
         step_phases = [phase]
         values = self.init_config_values(controls)
@@ -171,6 +171,36 @@ class JumpingRobot:
             controls["Tcs"][actuator_name] = Tc
         return controls
 
+    def actuator_params(self):
+        """ Parameters of the actuators of the native C++ classes. """
+        actuators = []
+        for actuator in self.actuators:
+            params = gtd.JRActuatorParams()
+            params.j = actuator.j
+            params.positive = actuator.positive
+            params.k_anta = actuator.config["k_anta"]
+            params.k_tendon = actuator.config["k_tendon"]
+            params.q_anta_limit = actuator.config["q_anta_limit"]
+            params.b = actuator.config["b"]
+            params.radius = actuator.config["rad0"]
+            params.q_rest = self.init_config["qs_rest"][actuator.name]
+            actuators.append(params)
+        return actuators
+
+    def pneumatic_params(self):
+        """ Pneumatic parameters of the native C++ classes. """
+        pneumatic_config = self.params["pneumatic"]
+        pneumatic = gtd.JRPneumaticParams()
+        pneumatic.d_tube = pneumatic_config["d_tube_valve_musc"] * 0.0254
+        pneumatic.l_tube = pneumatic_config["l_tube_valve_musc"] * 0.0254
+        pneumatic.mu = pneumatic_config["mu_tube"]
+        pneumatic.epsilon = pneumatic_config["eps_tube"]
+        pneumatic.ct = pneumatic_config["time_constant_valve"]
+        pneumatic.k_const = 1.0 / (pneumatic_config["Rs"] *
+                                   pneumatic_config["T"])
+        pneumatic.gas_constant = self.gas_constant
+        return pneumatic
+
     @staticmethod
     def create_robot(params, phase) -> gtd.Robot:
         """ Create the robot. """
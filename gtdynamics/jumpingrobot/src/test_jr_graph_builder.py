@@ -60,5 +60,22 @@ class TestJRGraphBuilder(unittest.TestCase):
         self.assertEqual(graph_col.size(), 48)
 
 
+    def test_native_graph_size(self):
+        """ Test the sizes of the graphs of the native builder. """
+        step_phases = [0, 0, 3, 3]
+        builder = self.jr_graph_builder.native_builder(self.yaml_file_path,
+                                                       self.init_config)
+        self.assertEqual(builder.collocationGraph(step_phases).size(), 48)
+
+        # dynamics and mass flow graphs of all 5 knots, and collocation
+        expected = builder.collocationGraph(step_phases).size()
+        for k in range(len(step_phases) + 1):
+            phase = step_phases[max(k - 1, 0)]
+            expected += builder.dynamicsGraph(phase, k).size()
+            expected += builder.massFlowGraph(k).size()
+        graph = self.jr_graph_builder.trajectory_graph(
+            self.yaml_file_path, self.init_config, step_phases)
+        self.assertEqual(graph.size(), expected)
+
 if __name__ == "__main__":
     unittest.main()
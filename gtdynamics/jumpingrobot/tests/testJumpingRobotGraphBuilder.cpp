@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJumpingRobotGraphBuilder.cpp
+ * @brief Test the trajectory factor graphs of the jumping robot.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotGraphBuilder.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+
+using namespace gtdynamics;
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+
+namespace example {
+// Pneumatic parameters of robot_config.yaml.
+JRPneumaticParams Pneumatic() {
+  JRPneumaticParams pneumatic;
+  pneumatic.d_tube = 0.1575 * 0.0254;
+  pneumatic.l_tube = 74 * 0.0254;
+  pneumatic.mu = 1.8377e-5;
+  pneumatic.epsilon = 1e-5;
+  pneumatic.ct = 1e-3;
+  pneumatic.gas_constant = 287.0550 * 296.15;
+  pneumatic.k_const = 1.0 / pneumatic.gas_constant;
+  return pneumatic;
+}
+
+// Knee actuator of robot_config.yaml on joint 0.
+JRActuatorParams Knee() {
+  JRActuatorParams knee;
+  knee.j = 0;
+  knee.k_anta = 2.1;
+  knee.k_tendon = 8200;
+  knee.b = 0.03;
+  knee.radius = 0.04;
+  return knee;
+}
+
+JumpingRobotGraphBuilder Builder() {
+  const DynamicsGraph graph_builder(simple_urdf::gravity,
+                                    simple_urdf::planar_axis);
+  return JumpingRobotGraphBuilder({simple_urdf::getRobot()}, {Knee()},
+                                  Pneumatic(), graph_builder, "l1");
+}
+}  // namespace example
+
+// Shifted templates have all keys at the step, but the source volume.
+TEST(JumpingRobotGraphBuilder, dynamicsGraph) {
+  const JumpingRobotGraphBuilder builder = example::Builder();
+  const NonlinearFactorGraph graph0 = builder.dynamicsGraph(0, 0),
+                             graph2 = builder.dynamicsGraph(0, 2);
+  EXPECT_LONGS_EQUAL(graph0.size(), graph2.size());
+  EXPECT_LONGS_EQUAL(graph0.keys().size(), graph2.keys().size());
+  for (Key key : graph2.keys()) {
+    if (key == SourceVolumeKey()) continue;
+    EXPECT_LONGS_EQUAL(2, DynamicsSymbol(key).time());
+  }
+  EXPECT(graph2.keys().count(SourceMassKey(2)));
+  EXPECT(graph2.keys().count(TorqueKey(0, 2)));
+
+  // Only the robot of phase 0 was given.
+  THROWS_EXCEPTION(builder.dynamicsGraph(1, 0));
+}
+
+// One mass flow and one valve factor per actuator.
+TEST(JumpingRobotGraphBuilder, massFlowGraph) {
+  const NonlinearFactorGraph graph = example::Builder().massFlowGraph(3);
+  EXPECT_LONGS_EQUAL(2, graph.size());
+  EXPECT(graph.keys().count(ValveOpenTimeKey(0)));
+  EXPECT(graph.keys().count(MassRateActualKey(0, 3)));
+}
+
+TEST(JumpingRobotGraphBuilder, collocationGraph) {
+  const std::vector<int> step_phases{0, 0, 3, 3};
+  const NonlinearFactorGraph graph =
+      example::Builder().collocationGraph(step_phases);
+  // Masses: (1 + 1) * 4, joints in the air: 1 * 2 * 2, torso: 2 * 4, time: 4.
+  EXPECT_LONGS_EQUAL(24, graph.size());
+  EXPECT(graph.keys().count(PhaseKey(3)));
+  EXPECT(graph.keys().count(JointAngleKey(0, 4)));
+  EXPECT(!graph.keys().count(JointAngleKey(0, 1)));
+}
+
+TEST(JumpingRobotGraphBuilder, trajectoryGraph) {
+  const JumpingRobotGraphBuilder builder = example::Builder();
+  const std::vector<int> step_phases{0, 0, 0};
+  size_t expected = builder.collocationGraph(step_phases).size();
+  for (int k = 0; k <= 3; k++) {
+    expected += builder.dynamicsGraph(0, k).size();
+    expected += builder.massFlowGraph(k).size();
+  }
+  EXPECT_LONGS_EQUAL(expected, builder.trajectoryGraph(step_phases).size());
+  THROWS_EXCEPTION(builder.trajectoryGraph({}));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
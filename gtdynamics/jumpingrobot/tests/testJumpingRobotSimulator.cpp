@@ -0,0 +1,140 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJumpingRobotSimulator.cpp
+ * @brief Test the step-by-step jumping robot simulator.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSimulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace example {
+// Pneumatic parameters of robot_config.yaml.
+JRPneumaticParams Pneumatic() {
+  JRPneumaticParams pneumatic;
+  pneumatic.d_tube = 0.1575 * 0.0254;
+  pneumatic.l_tube = 74 * 0.0254;
+  pneumatic.mu = 1.8377e-5;
+  pneumatic.epsilon = 1e-5;
+  pneumatic.ct = 1e-3;
+  pneumatic.gas_constant = 287.0550 * 296.15;
+  pneumatic.k_const = 1.0 / pneumatic.gas_constant;
+  return pneumatic;
+}
+
+// Knee actuator of robot_config.yaml on joint 0.
+JRActuatorParams Knee() {
+  JRActuatorParams knee;
+  knee.j = 0;
+  knee.k_anta = 2.1;
+  knee.k_tendon = 8200;
+  knee.b = 0.03;
+  knee.radius = 0.04;
+  knee.q_rest = 0.1;
+  return knee;
+}
+}  // namespace example
+
+// The layer-by-layer solve gives the forward dynamics of the robot, and the
+// next step is integrated from it.
+TEST(JumpingRobotSimulator, RobotDynamicsByLayer) {
+  auto robot = simple_urdf::getRobot();
+  const DynamicsGraph graph_builder(simple_urdf::gravity,
+                                    simple_urdf::planar_axis);
+  const JumpingRobotSimulator simulator(robot, {}, example::Pneumatic(),
+                                        graph_builder,
+                                        gtsam::LevenbergMarquardtParams(),
+                                        1e-5, "l1");
+
+  Values values;
+  InsertJointAngle(&values, 0, 0, 0.1);
+  InsertJointVel(&values, 0, 0, -0.2);
+  InsertTorque(&values, 0, 0, 1.0);
+  InsertPose(&values, 0, 0, robot.link("l1")->getFixedPose());
+  InsertTwist(&values, 0, 0, Vector6::Zero());
+  values.insert(TimeKey(0), 0.0);
+  simulator.stepRobotDynamicsByLayer(0, &values);
+
+  Values initial_values;
+  InsertJointAngle(&initial_values, 0, 0.1);
+  InsertJointVel(&initial_values, 0, -0.2);
+  JointSpaceSimulator expected(robot, initial_values, 1, simple_urdf::gravity,
+                               simple_urdf::planar_axis);
+  const double dt = 0.01;
+  expected.step(gtsam::Vector1(1.0), dt);
+  const double a = JointAccel(values, 0, 0);
+  EXPECT_DOUBLES_EQUAL(expected.jointAccels()(0, 0), a, 1e-4);
+  EXPECT(values.exists(WrenchKey(1, 0, 0)));
+
+  simulator.stepIntegration(1, dt, &values, false);
+  EXPECT_DOUBLES_EQUAL(0.1 - 0.2 * dt + 0.5 * a * dt * dt,
+                       JointAngle(values, 0, 1), 1e-9);
+  EXPECT_DOUBLES_EQUAL(-0.2 + a * dt, JointVel(values, 0, 1), 1e-9);
+  EXPECT_DOUBLES_EQUAL(dt, values.atDouble(TimeKey(1)), 1e-9);
+  EXPECT(assert_equal(robot.link("l1")->getFixedPose(), Pose(values, 0, 1)));
+}
+
+// The actuator solve gives the torque and the mass flow, halved by the valve
+// opening at the current time.
+TEST(JumpingRobotSimulator, ActuationDynamics) {
+  auto robot = simple_urdf::getRobot();
+  const DynamicsGraph graph_builder(simple_urdf::gravity,
+                                    simple_urdf::planar_axis);
+  const auto pneumatic = example::Pneumatic();
+  const JumpingRobotSimulator simulator(
+      robot, {example::Knee()}, pneumatic, graph_builder,
+      gtsam::LevenbergMarquardtParams(), 1e-5, "l1");
+
+  const double V_s = 1.475e-3, P_s = 65 * 6894.76 / 1000;
+  Values values;
+  values.insert(SourceVolumeKey(), V_s);
+  values.insert(SourceMassKey(0), V_s * P_s * 1e3 / pneumatic.gas_constant);
+  values.insert(ActuatorMassKey(0, 0), 7.873172488131229e-05);
+  values.insert(ValveOpenTimeKey(0), 0.0);
+  values.insert(ValveCloseTimeKey(0), 1.0);
+  values.insert(TimeKey(0), 0.0);
+  InsertJointAngle(&values, 0, 0, 0.1);
+  InsertJointVel(&values, 0, 0, 0.0);
+  simulator.stepActuationDynamics(0, &values);
+
+  EXPECT_DOUBLES_EQUAL(P_s, values.atDouble(SourcePressureKey(0)), 1e-6);
+  EXPECT(values.exists(TorqueKey(0, 0)));
+  const double mdot = values.atDouble(MassRateOpenKey(0, 0));
+  EXPECT(mdot > 0);
+  EXPECT_DOUBLES_EQUAL(0.5 * mdot, values.atDouble(MassRateActualKey(0, 0)),
+                       1e-9);
+
+  // The next step moves air from the source into the actuator.
+  const double dt = 0.005;
+  InsertJointAccel(&values, 0, 0, 0.0);
+  InsertPose(&values, 0, 0, robot.link("l1")->getFixedPose());
+  InsertTwist(&values, 0, 0, Vector6::Zero());
+  InsertTwistAccel(&values, 0, 0, Vector6::Zero());
+  simulator.stepIntegration(1, dt, &values);
+  const double m_in = 0.5 * mdot * dt;
+  EXPECT_DOUBLES_EQUAL(7.873172488131229e-05 + m_in,
+                       values.atDouble(ActuatorMassKey(0, 1)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(values.atDouble(SourceMassKey(0)) - m_in,
+                       values.atDouble(SourceMassKey(1)), 1e-12);
+  THROWS_EXCEPTION(simulator.computeMassFlow(values, 1, 0));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
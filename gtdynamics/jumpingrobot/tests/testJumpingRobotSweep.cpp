@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJumpingRobotSweep.cpp
+ * @brief Test batched jumping robot simulations over parameter sets.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/jumpingrobot/simulator/JumpingRobotSweep.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace example {
+// Pneumatic parameters of robot_config.yaml.
+JRPneumaticParams Pneumatic() {
+  JRPneumaticParams pneumatic;
+  pneumatic.d_tube = 0.1575 * 0.0254;
+  pneumatic.l_tube = 74 * 0.0254;
+  pneumatic.mu = 1.8377e-5;
+  pneumatic.epsilon = 1e-5;
+  pneumatic.ct = 1e-3;
+  pneumatic.gas_constant = 287.0550 * 296.15;
+  pneumatic.k_const = 1.0 / pneumatic.gas_constant;
+  return pneumatic;
+}
+
+// Knee actuator of robot_config.yaml on joint 0.
+JRActuatorParams Knee() {
+  JRActuatorParams knee;
+  knee.j = 0;
+  knee.k_anta = 2.1;
+  knee.k_tendon = 8200;
+  knee.b = 0.03;
+  knee.radius = 0.04;
+  knee.q_rest = 0.1;
+  return knee;
+}
+
+const double V_s = 1.475e-3, P_s = 65 * 6894.76 / 1000;
+
+// Step 0 of simple_urdf with the knee actuator, valve open from 0 to 1 s.
+Values InitialValues(const Robot &robot) {
+  Values values;
+  values.insert(SourceVolumeKey(), V_s);
+  values.insert(SourceMassKey(0), V_s * P_s * 1e3 / Pneumatic().gas_constant);
+  values.insert(ActuatorMassKey(0, 0), 7.873172488131229e-05);
+  values.insert(ValveOpenTimeKey(0), 0.0);
+  values.insert(ValveCloseTimeKey(0), 1.0);
+  values.insert(TimeKey(0), 0.0);
+  InsertJointAngle(&values, 0, 0, 0.1);
+  InsertJointVel(&values, 0, 0, 0.0);
+  InsertPose(&values, 0, 0, robot.link("l1")->getFixedPose());
+  InsertTwist(&values, 0, 0, Vector6::Zero());
+  return values;
+}
+}  // namespace example
+
+// Parameter sets override the valve times and the source pressure.
+TEST(JumpingRobotSweep, InitialValues) {
+  auto robot = simple_urdf::getRobot();
+  const DynamicsGraph graph_builder(simple_urdf::gravity,
+                                    simple_urdf::planar_axis);
+  const JumpingRobotSweep sweep({robot}, {example::Knee()},
+                                example::Pneumatic(), graph_builder,
+                                example::InitialValues(robot), "l1");
+
+  const Values base = sweep.initialValues(JRSweepConfig());
+  EXPECT(assert_equal(example::InitialValues(robot), base));
+
+  const Values values = sweep.initialValues(JRSweepConfig({0.1}, {0.2}, 300));
+  EXPECT_DOUBLES_EQUAL(0.1, values.atDouble(ValveOpenTimeKey(0)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.2, values.atDouble(ValveCloseTimeKey(0)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(300, values.atDouble(SourcePressureKey(0)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(
+      example::V_s * 300e3 / example::Pneumatic().gas_constant,
+      values.atDouble(SourceMassKey(0)), 1e-12);
+
+  THROWS_EXCEPTION(sweep.initialValues(JRSweepConfig({0.1, 0.2}, {}, 0)));
+  THROWS_EXCEPTION(sweep.sweep({JRSweepConfig({0.1, 0.2}, {}, 0)}, 2, 0.005));
+}
+
+// The sweep gives one row per parameter set, as simulating them one by one.
+TEST(JumpingRobotSweep, Sweep) {
+  auto robot = simple_urdf::getRobot();
+  const DynamicsGraph graph_builder(simple_urdf::gravity,
+                                    simple_urdf::planar_axis);
+  const JumpingRobotSweep sweep({robot}, {example::Knee()},
+                                example::Pneumatic(), graph_builder,
+                                example::InitialValues(robot), "l1");
+
+  const size_t num_steps = 4;
+  const double dt = 0.005;
+  const std::vector<JRSweepConfig> configs{
+      JRSweepConfig(), JRSweepConfig({}, {}, 2 * example::P_s),
+      JRSweepConfig({1.0}, {2.0}, 0)};
+  const gtsam::Matrix table = sweep.sweep(configs, num_steps, dt);
+  EXPECT_LONGS_EQUAL(3, table.rows());
+  EXPECT_LONGS_EQUAL(JumpingRobotSweep::kNumColumns, table.cols());
+
+  for (size_t i = 0; i < configs.size(); i++) {
+    std::vector<int> step_phases;
+    const Values trajectory =
+        sweep.simulate(configs[i], num_steps, dt, &step_phases);
+    EXPECT_LONGS_EQUAL(num_steps, step_phases.size());
+    const gtsam::Vector row = sweep.metrics(trajectory, step_phases, dt);
+    EXPECT(assert_equal(row, gtsam::Vector(table.row(i).transpose()), 1e-9));
+    EXPECT_DOUBLES_EQUAL(1, row(JumpingRobotSweep::kConverged), 0);
+    EXPECT_DOUBLES_EQUAL(-1, row(JumpingRobotSweep::kLiftoffStep), 0);
+    EXPECT(row(JumpingRobotSweep::kJumpHeight) >= 0);
+  }
+
+  // More source pressure moves more air, and a closed valve none.
+  EXPECT(table(0, JumpingRobotSweep::kAirMassUsed) > 0);
+  EXPECT(table(1, JumpingRobotSweep::kAirMassUsed) >
+         table(0, JumpingRobotSweep::kAirMassUsed));
+  EXPECT_DOUBLES_EQUAL(0, table(2, JumpingRobotSweep::kAirMassUsed), 1e-12);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
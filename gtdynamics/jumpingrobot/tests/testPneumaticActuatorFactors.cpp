@@ -264,6 +264,37 @@ TEST(SmoothActuatorFactor, zero_force) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
 }
 
+/** Test SmoothActuatorFactor evaluated from the table against the model */
+TEST(SmoothActuatorFactor, tabulated) {
+  SmoothActuatorFactor factor(example::delta_x_key, example::p_key,
+                              example::f_key, example::cost_model);
+  SmoothActuatorFactor tabulated(example::delta_x_key, example::p_key,
+                                 example::f_key, example::cost_model, true);
+  EXPECT(!factor.tabulated());
+  EXPECT(tabulated.tabulated());
+
+  const double f = 1;
+  gtsam::Matrix H_x, H_p, H_x_t, H_p_t;
+  for (double p : {110.0, 157.3, 250.0, 333.3, 480.0, 600.0}) {
+    for (double delta_x : {-0.5, 0.5, 2.25, 4.0, 6.75}) {
+      const Vector1 expected = factor.evaluateError(delta_x, p, f, H_x, H_p);
+      const Vector1 actual =
+          tabulated.evaluateError(delta_x, p, f, H_x_t, H_p_t);
+      const double scale = std::max(1.0, std::abs(expected(0)));
+      EXPECT(assert_equal(expected, actual, 1e-6 * scale));
+      EXPECT(assert_equal(H_x, H_x_t, 1e-6 * std::max(1.0, H_x.norm())));
+      EXPECT(assert_equal(H_p, H_p_t, 1e-6 * std::max(1.0, H_p.norm())));
+    }
+  }
+
+  // Make sure linearization is correct
+  Values values;
+  values.insert(example::delta_x_key, 2.0);
+  values.insert(example::p_key, 300.0);
+  values.insert(example::f_key, f);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(tabulated, values, 1e-7, 1e-3);
+}
+
 //// following tests are deprecated
 TEST(ClippingActuatorFactor, Factor) {
   const double delta_x = 1;
@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnalyticIK.cpp
+ * @brief Interface and registry for analytic inverse kinematics solvers.
+ */
+
+#include <gtdynamics/kinematics/AnalyticIK.h>
+#include <gtdynamics/utils/ParallelFor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+void AnalyticIK::setLimits(const Robot &robot) {
+  const std::vector<std::string> names = jointNames();
+  lower_limits_.resize(names.size());
+  upper_limits_.resize(names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    const JointScalarLimit &limits =
+        robot.joint(names[i])->parameters().scalar_limits;
+    lower_limits_(i) = limits.value_lower_limit;
+    upper_limits_(i) = limits.value_upper_limit;
+  }
+}
+
+/* ************************************************************************* */
+void AnalyticIK::setUnbounded() {
+  const size_t n = numJoints();
+  lower_limits_ = Vector::Constant(n, -std::numeric_limits<double>::max());
+  upper_limits_ = Vector::Constant(n, std::numeric_limits<double>::max());
+}
+
+/* ************************************************************************* */
+bool AnalyticIK::withinLimits(const Vector &q) const {
+  return (q.array() >= lower_limits_.array()).all() &&
+         (q.array() <= upper_limits_.array()).all();
+}
+
+/* ************************************************************************* */
+boost::optional<Vector> AnalyticIK::nearest(const Pose3 &bTe,
+                                            const Vector &seed,
+                                            size_t num_samples) const {
+  // Samples of each free joint: its seed value, then a uniform grid within
+  // its limits, and at most a full turn.
+  const std::vector<size_t> free_joints = freeJoints();
+  const size_t num_free = free_joints.size();
+  std::vector<std::vector<double>> samples(num_free);
+  for (size_t f = 0; f < num_free; f++) {
+    const size_t i = free_joints[f];
+    const double lower = std::max(lower_limits_(i), -M_PI),
+                 upper = std::min(upper_limits_(i), M_PI);
+    samples[f].push_back(seed(i));
+    for (size_t k = 0; k < num_samples; k++) {
+      samples[f].push_back(lower + (upper - lower) * (k + 0.5) / num_samples);
+    }
+  }
+
+  // Enumerate the grid of free joint angles, with a mixed-radix counter.
+  boost::optional<Vector> best;
+  double best_distance = std::numeric_limits<double>::infinity();
+  std::vector<size_t> counter(num_free, 0);
+  std::vector<Vector> solutions;
+  Vector free(num_free);
+  while (true) {
+    bool in_limits = true;
+    for (size_t f = 0; f < num_free; f++) {
+      free(f) = samples[f][counter[f]];
+      const size_t i = free_joints[f];
+      in_limits &= free(f) >= lower_limits_(i) && free(f) <= upper_limits_(i);
+    }
+    if (in_limits && computeInverse(bTe, free, &solutions)) {
+      for (const Vector &solution : solutions) {
+        if (!withinLimits(solution)) continue;
+        const double distance = (solution - seed).squaredNorm();
+        if (distance < best_distance) {
+          best_distance = distance;
+          best = solution;
+        }
+      }
+    }
+
+    size_t f = 0;
+    while (f < num_free && ++counter[f] == samples[f].size()) {
+      counter[f++] = 0;
+    }
+    if (f == num_free) break;
+  }
+  return best;
+}
+
+/* ************************************************************************* */
+std::vector<boost::optional<Vector>> AnalyticIK::nearest(
+    const std::vector<Pose3> &bTes, const Vector &seed,
+    size_t num_samples) const {
+  std::vector<boost::optional<Vector>> results(bTes.size());
+  ParallelFor(bTes.size(), [&](size_t i) {
+    results[i] = nearest(bTes[i], seed, num_samples);
+  });
+  return results;
+}
+
+/* ************************************************************************* */
+std::map<std::string, AnalyticIKFactory> &AnalyticIKRegistry::Factories() {
+  static std::map<std::string, AnalyticIKFactory> factories;
+  return factories;
+}
+
+/* ************************************************************************* */
+bool AnalyticIKRegistry::Register(const std::string &name,
+                                  const AnalyticIKFactory &factory) {
+  Factories()[name] = factory;
+  return true;
+}
+
+/* ************************************************************************* */
+bool AnalyticIKRegistry::Has(const std::string &name) {
+  return Factories().count(name) > 0;
+}
+
+/* ************************************************************************* */
+std::vector<std::string> AnalyticIKRegistry::Names() {
+  std::vector<std::string> names;
+  for (auto &&entry : Factories()) names.push_back(entry.first);
+  return names;
+}
+
+/* ************************************************************************* */
+AnalyticIKPtr AnalyticIKRegistry::Create(const std::string &name,
+                                         const Robot &robot) {
+  auto it = Factories().find(name);
+  if (it == Factories().end()) {
+    throw std::invalid_argument("AnalyticIKRegistry: no solver for " + name);
+  }
+  return it->second(robot);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnalyticIK.h
+ * @brief Interface and registry for analytic inverse kinematics solvers.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Analytic inverse kinematics of a serial arm, such as the solvers generated
+ * by IKFast. Derived classes wrap the generated forward and inverse functions;
+ * solution selection within joint limits is shared by all of them.
+ *
+ * Joint angles are ordered as jointNames(). Redundant arms have free joints,
+ * whose angles are inputs of the inverse and are sampled by nearest().
+ */
+class AnalyticIK {
+ protected:
+  gtsam::Vector lower_limits_, upper_limits_;
+
+  /// Set the joint limits from the joints of a robot with jointNames().
+  void setLimits(const Robot &robot);
+
+  /// Set unbounded joint limits.
+  void setUnbounded();
+
+ public:
+  virtual ~AnalyticIK() {}
+
+  /// Return the names of the joints, in the order of joint angle vectors.
+  virtual std::vector<std::string> jointNames() const = 0;
+
+  /// Return the indices of the free joints in joint angle vectors.
+  virtual std::vector<size_t> freeJoints() const = 0;
+
+  /// Return the end-effector pose wrt the base frame.
+  virtual gtsam::Pose3 computeForward(const gtsam::Vector &q) const = 0;
+
+  /**
+   * Compute all non-singular solutions for the given free joint angles.
+   * @param bTe        the desired end-effector pose wrt the base frame
+   * @param free       angles of the free joints, ordered as freeJoints()
+   * @param solutions  (out) joint angle vectors
+   * @returns false if the pose cannot be reached.
+   */
+  virtual bool computeInverse(const gtsam::Pose3 &bTe,
+                              const gtsam::Vector &free,
+                              std::vector<gtsam::Vector> *solutions) const = 0;
+
+  /// Return the number of joints.
+  size_t numJoints() const { return jointNames().size(); }
+
+  /// Return whether joint angles are within the joint limits.
+  bool withinLimits(const gtsam::Vector &q) const;
+
+  /**
+   * Return the solution within joint limits nearest to a seed configuration.
+   * The free joints are sampled on a uniform grid within their limits, and at
+   * their seed values.
+   * @param bTe          the desired end-effector pose wrt the base frame
+   * @param seed         joint angles to stay close to
+   * @param num_samples  number of samples per free joint
+   * @returns the nearest solution, none if the pose cannot be reached.
+   */
+  boost::optional<gtsam::Vector> nearest(const gtsam::Pose3 &bTe,
+                                         const gtsam::Vector &seed,
+                                         size_t num_samples = 32) const;
+
+  /// Batched nearest, in parallel when GTSAM is built with TBB.
+  std::vector<boost::optional<gtsam::Vector>> nearest(
+      const std::vector<gtsam::Pose3> &bTes, const gtsam::Vector &seed,
+      size_t num_samples = 32) const;
+};
+
+using AnalyticIKPtr = std::shared_ptr<const AnalyticIK>;
+
+/// Create an analytic IK solver for a robot, taking its joint limits.
+using AnalyticIKFactory = std::function<AnalyticIKPtr(const Robot &)>;
+
+/**
+ * Registry of analytic IK solvers keyed by robot name. Solvers register a
+ * factory once, typically from a static initializer next to their generated
+ * code, and are then created by name.
+ */
+class AnalyticIKRegistry {
+  static std::map<std::string, AnalyticIKFactory> &Factories();
+
+ public:
+  /// Register a factory, replacing any previous one; returns true.
+  static bool Register(const std::string &name,
+                       const AnalyticIKFactory &factory);
+
+  /// Return whether a solver is registered for a robot name.
+  static bool Has(const std::string &name);
+
+  /// Return the registered robot names.
+  static std::vector<std::string> Names();
+
+  /// Create the solver registered for a robot name, throws if there is none.
+  static AnalyticIKPtr Create(const std::string &name, const Robot &robot);
+};
+
+}  // namespace gtdynamics
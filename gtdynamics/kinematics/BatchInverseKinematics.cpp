@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchInverseKinematics.cpp
+ * @brief Solve many independent inverse kinematics problems concurrently.
+ */
+
+#include <gtdynamics/kinematics/BatchInverseKinematics.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+BatchInverseKinematics::BatchInverseKinematics(
+    const Robot& robot, const Slice& slice,
+    const KinematicsParameters& parameters, bool contact_goals_as_constraints)
+    : kinematics_(parameters),
+      parameters_(parameters),
+      slice_(slice),
+      contact_goals_as_constraints_(contact_goals_as_constraints) {
+  for (const auto& constraint : kinematics_.constraints(slice_, robot)) {
+    base_graph_.add(constraint->createFactor(1.0));
+  }
+  base_graph_.add(kinematics_.jointAngleObjectives(slice_, robot));
+
+  // Goals only involve link poses, which are all in the base graph.
+  ordering_ = gtsam::Ordering::Colamd(base_graph_);
+  initial_values_ = kinematics_.initialValues(slice_, robot);
+}
+
+/* ************************************************************************* */
+std::vector<InverseKinematicsResult> BatchInverseKinematics::solve(
+    const std::vector<ContactGoals>& problems, double tolerance) const {
+  gtsam::LevenbergMarquardtParams params = parameters_.lm_parameters;
+  params.setOrdering(ordering_);
+
+  std::vector<InverseKinematicsResult> results(problems.size());
+  ParallelFor(problems.size(), [&](size_t i) {
+    const ContactGoals& contact_goals = problems[i];
+    NonlinearFactorGraph graph = base_graph_;
+    if (contact_goals_as_constraints_) {
+      for (const auto& constraint :
+           kinematics_.pointGoalConstraints(slice_, contact_goals)) {
+        graph.add(constraint->createFactor(1.0));
+      }
+    } else {
+      graph.add(kinematics_.pointGoalObjectives(slice_, contact_goals));
+    }
+
+    gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial_values_,
+                                                 params);
+    InverseKinematicsResult& result = results[i];
+    result.values = optimizer.optimize();
+    result.iterations = optimizer.iterations();
+    result.error = optimizer.error();
+    result.converged = ContactGoalsSatisfied(contact_goals, result.values,
+                                             slice_.k, tolerance);
+  });
+  return results;
+}
+
+}  // namespace gtdynamics
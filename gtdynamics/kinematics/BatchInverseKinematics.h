@@ -0,0 +1,81 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchInverseKinematics.h
+ * @brief Solve many independent inverse kinematics problems concurrently.
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Result of one problem solved by BatchInverseKinematics.
+struct InverseKinematicsResult {
+  gtsam::Values values;    ///< poses and joint angles
+  bool converged = false;  ///< true if all goals are satisfied
+  size_t iterations = 0;   ///< number of LM iterations
+  double error = 0;        ///< final error of the problem
+};
+
+/**
+ * BatchInverseKinematics solves Kinematics::inverse in one slice for many
+ * sets of contact goals on the same robot, e.g. for reachability analysis.
+ *
+ * The kinematics and joint angle factors, the initial values and the
+ * elimination ordering are computed once, and each problem only adds its goal
+ * factors. Problems are solved in parallel when GTSAM is built with TBB.
+ *
+ * Constraints are treated as soft, as with the SOFT_CONSTRAINTS method.
+ */
+class BatchInverseKinematics {
+ private:
+  const Kinematics kinematics_;
+  const KinematicsParameters parameters_;
+  const Slice slice_;
+  const bool contact_goals_as_constraints_;
+
+  gtsam::NonlinearFactorGraph base_graph_;
+  gtsam::Ordering ordering_;
+  gtsam::Values initial_values_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot       Robot specification from URDF/SDF.
+   * @param slice       Slice in which to solve.
+   * @param parameters  Noise models and LM parameters.
+   * @param contact_goals_as_constraints  treat goals as (soft) constraints
+   */
+  BatchInverseKinematics(
+      const Robot& robot, const Slice& slice,
+      const KinematicsParameters& parameters = KinematicsParameters(),
+      bool contact_goals_as_constraints = true);
+
+  /// Return the initial values shared by all problems.
+  const gtsam::Values& initialValues() const { return initial_values_; }
+
+  /**
+   * Solve one problem per set of goals.
+   * @param problems   goals for contact points, one set per problem
+   * @param tolerance  distance below which a goal counts as satisfied
+   * @returns one result per problem, in the same order.
+   */
+  std::vector<InverseKinematicsResult> solve(
+      const std::vector<ContactGoals>& problems,
+      double tolerance = 1e-3) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainInverseKinematics.cpp
+ * @brief Damped least-squares inverse kinematics of serial legs.
+ */
+
+#include <gtdynamics/kinematics/ChainInverseKinematics.h>
+#include <gtdynamics/utils/values.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Stacked errors of the goals on a leg, and optionally their Jacobian with
+// respect to the leg angles.
+static Vector LegError(const LegChain& leg, const ContactGoals& goals,
+                       const Pose3& wTtrunk, const Vector& q,
+                       Matrix* H = nullptr) {
+  // poe is the trunk pose in the foot frame, with the body Jacobian J in the
+  // trunk frame: fTt(q + dq) = fTt(q) * Exp(J * dq).
+  Matrix J;
+  const Pose3 tTf = H ? leg.chain.poe(q, boost::none, J).inverse()
+                      : leg.chain.poe(q).inverse();
+  const gtsam::Matrix3 wRt = wTtrunk.rotation().matrix();
+
+  Vector error(3 * goals.size());
+  if (H) H->resize(3 * goals.size(), q.size());
+  for (size_t g = 0; g < goals.size(); g++) {
+    // Point in the trunk frame: y(dq) = Exp(-J * dq) * y.
+    const gtsam::Point3 y = tTf.transformFrom(goals[g].contactInCoM());
+    error.segment<3>(3 * g) = wTtrunk.transformFrom(y) - goals[g].goal_point;
+    if (H) {
+      gtsam::Matrix36 D;
+      D << -gtsam::skewSymmetric(y), gtsam::I_3x3;
+      H->middleRows<3>(3 * g) = -wRt * D * J;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+ChainInverseKinematics::ChainInverseKinematics(
+    const Robot& robot, const std::string& trunk_name,
+    const ChainInverseKinematicsParameters& parameters)
+    : robot_(robot),
+      trunk_(robot.link(trunk_name)),
+      legs_(LeanDynamicsGraph::Legs(robot, trunk_)),
+      parameters_(parameters) {}
+
+/* ************************************************************************* */
+Values ChainInverseKinematics::inverse(const Slice& slice,
+                                       const ContactGoals& contact_goals,
+                                       const Pose3& wTtrunk,
+                                       const Values& initial,
+                                       bool* converged) const {
+  const size_t k = slice.k;
+
+  // Assign the goals to legs.
+  std::vector<ContactGoals> leg_goals(legs_.size());
+  for (const ContactGoal& goal : contact_goals) {
+    size_t l = 0;
+    while (l < legs_.size() && legs_[l].foot != goal.link()) l++;
+    if (l == legs_.size()) {
+      throw std::invalid_argument("ChainInverseKinematics: link " +
+                                  goal.link()->name() + " is not a foot.");
+    }
+    leg_goals[l].push_back(goal);
+  }
+
+  Values values;
+  bool all_converged = true;
+  for (size_t l = 0; l < legs_.size(); l++) {
+    const LegChain& leg = legs_[l];
+    Vector q(leg.joints.size());
+    for (size_t i = 0; i < leg.joints.size(); i++) {
+      const gtsam::Key key = JointAngleKey(leg.joints[i]->id(), k);
+      q(i) = initial.exists(key) ? initial.at<double>(key) : 0.0;
+    }
+
+    // Levenberg-Marquardt on the goal errors of this leg.
+    const ContactGoals& goals = leg_goals[l];
+    if (!goals.empty()) {
+      double lambda = parameters_.lambda_initial;
+      Matrix H;
+      Vector error = LegError(leg, goals, wTtrunk, q, &H);
+      for (size_t iteration = 0; iteration < parameters_.max_iterations;
+           iteration++) {
+        if (error.norm() < parameters_.tolerance) break;
+        const Matrix HtH = H.transpose() * H;
+        const Vector Hte = H.transpose() * error;
+        bool improved = false;
+        while (!improved && lambda < parameters_.lambda_max) {
+          const Matrix A =
+              HtH + lambda * Matrix::Identity(q.size(), q.size());
+          const Vector q_new = q - A.ldlt().solve(Hte);
+          const Vector new_error = LegError(leg, goals, wTtrunk, q_new);
+          if (new_error.norm() < error.norm()) {
+            q = q_new;
+            lambda /= 10;
+            improved = true;
+          } else {
+            lambda *= 10;
+          }
+        }
+        if (!improved) break;
+        error = LegError(leg, goals, wTtrunk, q, &H);
+      }
+      all_converged &= error.norm() < parameters_.tolerance;
+    }
+
+    for (size_t i = 0; i < leg.joints.size(); i++) {
+      InsertJointAngle(&values, leg.joints[i]->id(), k, q(i));
+    }
+  }
+  if (converged) *converged = all_converged;
+
+  // Link poses by forward kinematics from the trunk, without the twists.
+  Values known = values;
+  InsertPose(&known, trunk_->id(), k, wTtrunk);
+  const Values fk = robot_.forwardKinematics(known, k, trunk_->name());
+  for (auto&& link : robot_.links()) {
+    InsertPose(&values, link->id(), k, Pose(fk, link->id(), k));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainInverseKinematics.h
+ * @brief Damped least-squares inverse kinematics of serial legs.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/LeanDynamicsGraph.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of ChainInverseKinematics.
+struct ChainInverseKinematicsParameters {
+  size_t max_iterations = 100;   ///< per leg
+  double tolerance = 1e-6;       ///< goal distance at which a leg is solved
+  double lambda_initial = 1e-3;  ///< initial damping
+  double lambda_max = 1e10;      ///< give up when damping exceeds this
+
+  ChainInverseKinematicsParameters() {}
+};
+
+/**
+ * ChainInverseKinematics solves the same problem as Kinematics::inverse in a
+ * slice, without building a factor graph, for robots made of a trunk with
+ * serial legs, or a single serial chain attached to a base link.
+ *
+ * The trunk pose is given, which decouples the legs. Each leg with goals is
+ * solved by Levenberg-Marquardt with damped least-squares steps, using the
+ * Jacobian of Chain::poe. Legs without goals keep their initial angles. All
+ * goals must be on the foot link of a leg.
+ */
+class ChainInverseKinematics {
+ private:
+  Robot robot_;
+  LinkSharedPtr trunk_;
+  std::vector<LegChain> legs_;
+  ChainInverseKinematicsParameters parameters_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot, a trunk with serial legs
+   * @param trunk_name  name of the trunk or base link
+   * @param parameters  iteration and damping parameters
+   */
+  ChainInverseKinematics(const Robot& robot, const std::string& trunk_name,
+                         const ChainInverseKinematicsParameters& parameters =
+                             ChainInverseKinematicsParameters());
+
+  /// Return the legs, ordered as the joints of the trunk.
+  const std::vector<LegChain>& legs() const { return legs_; }
+
+  /**
+   * Inverse kinematics given a set of contact goals.
+   * @param slice          Slice instance.
+   * @param contact_goals  goals for contact points on feet
+   * @param wTtrunk        pose of the trunk CoM
+   * @param initial        optional initial joint angles at slice.k, zero for
+   *                       any joint not given
+   * @param converged      optional output, true if all legs were solved
+   * @returns values with poses and joint angles, as Kinematics::inverse.
+   */
+  gtsam::Values inverse(const Slice& slice, const ContactGoals& contact_goals,
+                        const gtsam::Pose3& wTtrunk,
+                        const gtsam::Values& initial = gtsam::Values(),
+                        bool* converged = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InverseKinematicsSession.cpp
+ * @brief Warm-started inverse kinematics for streams of slowly moving goals.
+ */
+
+#include <gtdynamics/kinematics/InverseKinematicsSession.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+InverseKinematicsSession::InverseKinematicsSession(
+    const Robot& robot, const Slice& slice,
+    const KinematicsParameters& parameters, bool contact_goals_as_constraints)
+    : kinematics_(parameters),
+      parameters_(parameters),
+      robot_(robot),
+      slice_(slice),
+      contact_goals_as_constraints_(contact_goals_as_constraints),
+      lambda_(parameters.lm_parameters.lambdaInitial) {
+  for (const auto& constraint : kinematics_.constraints(slice_, robot_)) {
+    base_graph_.add(constraint->createFactor(1.0));
+  }
+  base_graph_.add(kinematics_.jointAngleObjectives(slice_, robot_));
+}
+
+/* ************************************************************************* */
+void InverseKinematicsSession::reset() {
+  solution_ = boost::none;
+  lambda_ = parameters_.lm_parameters.lambdaInitial;
+}
+
+/* ************************************************************************* */
+const Values& InverseKinematicsSession::solve(const ContactGoals& contact_goals,
+                                              double time_budget) {
+  const auto start = std::chrono::steady_clock::now();
+
+  NonlinearFactorGraph graph = base_graph_;
+  if (contact_goals_as_constraints_) {
+    for (const auto& constraint :
+         kinematics_.pointGoalConstraints(slice_, contact_goals)) {
+      graph.add(constraint->createFactor(1.0));
+    }
+  } else {
+    graph.add(kinematics_.pointGoalObjectives(slice_, contact_goals));
+  }
+
+  // Goals only involve link poses, which are all in the base graph, so the
+  // ordering is the same for every solve.
+  if (!ordering_) ordering_ = gtsam::Ordering::Colamd(base_graph_);
+  if (!solution_) solution_ = kinematics_.initialValues(slice_, robot_);
+
+  gtsam::LevenbergMarquardtParams params = parameters_.lm_parameters;
+  params.setOrdering(*ordering_);
+  params.setlambdaInitial(lambda_);
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, *solution_, params);
+
+  // Iterate by hand to honor the time budget.
+  double error = optimizer.error();
+  while (optimizer.iterations() < size_t(params.maxIterations)) {
+    optimizer.iterate();
+    const double new_error = optimizer.error();
+    const bool converged = gtsam::checkConvergence(params, error, new_error);
+    error = new_error;
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (converged || elapsed.count() > time_budget) break;
+  }
+
+  // Keep the damping for the next solve, within the parameter bounds.
+  lambda_ = std::max(params.lambdaLowerBound,
+                     std::min(optimizer.lambda(), params.lambdaUpperBound));
+  iterations_ = optimizer.iterations();
+  solution_ = optimizer.values();
+  return *solution_;
+}
+
+}  // namespace gtdynamics
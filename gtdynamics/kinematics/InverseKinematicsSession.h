@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InverseKinematicsSession.h
+ * @brief Warm-started inverse kinematics for streams of slowly moving goals.
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <limits>
+
+namespace gtdynamics {
+
+/**
+ * InverseKinematicsSession solves Kinematics::inverse in one slice repeatedly,
+ * for goals that move little between calls, as in teleoperation or tracking.
+ *
+ * The kinematics and joint angle factors are built once. Each solve only adds
+ * the contact goal factors, and starts Levenberg-Marquardt from the previous
+ * solution, with the previous elimination ordering and the damping it ended
+ * with. The first solve starts from Kinematics::initialValues.
+ *
+ * Constraints are always treated as soft, as with the SOFT_CONSTRAINTS method,
+ * since the constrained solvers do not support warm-starting their
+ * multipliers.
+ */
+class InverseKinematicsSession {
+ private:
+  const Kinematics kinematics_;
+  const KinematicsParameters parameters_;
+  const Robot robot_;
+  const Slice slice_;
+  const bool contact_goals_as_constraints_;
+
+  gtsam::NonlinearFactorGraph base_graph_;
+  boost::optional<gtsam::Ordering> ordering_;
+  boost::optional<gtsam::Values> solution_;
+  double lambda_;
+  size_t iterations_ = 0;
+
+ public:
+  /**
+   * Constructor
+   * @param robot       Robot specification from URDF/SDF.
+   * @param slice       Slice in which to solve.
+   * @param parameters  Noise models and LM parameters; lambdaInitial is only
+   *                    used for the first solve.
+   * @param contact_goals_as_constraints  treat goals as (soft) constraints
+   */
+  InverseKinematicsSession(
+      const Robot& robot, const Slice& slice,
+      const KinematicsParameters& parameters = KinematicsParameters(),
+      bool contact_goals_as_constraints = true);
+
+  /**
+   * Solve for the given goals, starting from the previous solution.
+   * @param contact_goals  goals for contact points, the links may change
+   *                       between calls
+   * @param time_budget    wall-clock time in seconds after which to stop
+   *                       iterating; at least one iteration is done
+   * @returns values with poses and joint angles.
+   */
+  const gtsam::Values& solve(
+      const ContactGoals& contact_goals,
+      double time_budget = std::numeric_limits<double>::infinity());
+
+  /// Return whether there is a previous solution to start from.
+  bool warm() const { return static_cast<bool>(solution_); }
+
+  /// Set the values to start the next solve from, e.g. a measured state.
+  void setSolution(const gtsam::Values& values) { solution_ = values; }
+
+  /// Forget the previous solution and damping; the ordering is kept.
+  void reset();
+
+  /// Return the number of LM iterations done by the last solve.
+  size_t iterations() const { return iterations_; }
+};
+
+}  // namespace gtdynamics
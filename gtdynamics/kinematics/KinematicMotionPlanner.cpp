@@ -0,0 +1,237 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicMotionPlanner.cpp
+ * @brief Kinematic crawl-gait planner along a cubic base trajectory.
+ */
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/kinematics/KinematicMotionPlanner.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+KinematicMotionPlanner::KinematicMotionPlanner(
+    const Robot &robot, const KinematicMotionPlannerParams &params)
+    : robot_(robot), p_(params), wTb_i_(robot.link(params.base)->bMcom()) {
+  if (p_.feet.empty()) {
+    throw std::invalid_argument("KinematicMotionPlanner: no feet.");
+  }
+  if (!(p_.dt > 0 && p_.t_support > 0 && p_.horizon >= p_.t_support)) {
+    throw std::invalid_argument(
+        "KinematicMotionPlanner: needs dt > 0 and horizon >= t_support > 0.");
+  }
+
+  // The spline is parameterized by the normalized time u = t / horizon.
+  coefficients_ =
+      HermiteCoefficients(wTb_i_.translation(), p_.wTb_f.translation(),
+                          p_.start_tangent, p_.end_tangent, 1.0);
+
+  // Footholds under the base at the end of each support phase.
+  const Pose3 comTfoot(Rot3(), p_.contact_in_com);
+  for (auto &&foot : p_.feet) {
+    bTfs_.push_back(robot.link(foot)->bMcom() * comTfoot);
+  }
+  const int num_phases = static_cast<int>(p_.horizon / p_.t_support);
+  const Vector u =
+      Vector::LinSpaced(num_phases + 1, 0, num_phases * p_.t_support) /
+      p_.horizon;
+  const std::vector<Pose3> wTbs = basePoses(u);
+  for (size_t f = 0; f < p_.feet.size(); f++) {
+    Matrix footholds(3, num_phases + 1);
+    for (int i = 0; i <= num_phases; i++) {
+      const Point3 wPf = (wTbs[i] * bTfs_[f]).translation();
+      footholds.col(i) << wPf.x(), wPf.y(), p_.ground_height;
+    }
+    footholds_.push_back(footholds);
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Matrix43 KinematicMotionPlanner::HermiteCoefficients(
+    const Vector3 &p_0, const Vector3 &p_1, const Vector3 &tangent_0,
+    const Vector3 &tangent_1, double horizon) {
+  // Hermite parameterization p(u) = U(u) B C, with U(u) = [u^3, u^2, u, 1],
+  // basis matrix B and control matrix C.
+  gtsam::Matrix43 C;
+  C.row(0) = p_0;
+  C.row(1) = p_1;
+  C.row(2) = tangent_0;
+  C.row(3) = tangent_1;
+  gtsam::Matrix4 B;
+  B << 2, -2, 1, 1, -3, 3, -2, -1, 0, 0, 1, 0, 1, 0, 0, 0;
+  gtsam::Matrix43 A = B * C;
+
+  // Scale by the horizon, u = t / horizon, so that t can be used directly.
+  A.row(0) /= horizon * horizon * horizon;
+  A.row(1) /= horizon * horizon;
+  A.row(2) /= horizon;
+  return A;
+}
+
+/* ************************************************************************* */
+size_t KinematicMotionPlanner::numSteps() const {
+  return static_cast<size_t>(std::ceil(p_.horizon / p_.dt - 1e-9));
+}
+
+/* ************************************************************************* */
+Vector KinematicMotionPlanner::times() const {
+  const size_t n = numSteps();
+  return Vector::LinSpaced(n, 0, (n - 1) * p_.dt);
+}
+
+/* ************************************************************************* */
+std::vector<Pose3> KinematicMotionPlanner::basePoses(const Vector &u) const {
+  // Positions and velocities at all times as two matrix products.
+  const size_t n = u.size();
+  Matrix U(n, 4), dU(n, 4);
+  U.col(0) = u.array().cube();
+  U.col(1) = u.array().square();
+  U.col(2) = u;
+  U.col(3).setOnes();
+  dU.col(0) = 3 * u.array().square();
+  dU.col(1) = 2 * u;
+  dU.col(2).setOnes();
+  dU.col(3).setZero();
+  const Matrix P = U * coefficients_, dP = dU * coefficients_;
+
+  // The base turns from its heading at rest to the direction of motion.
+  const Vector3 heading = p_.heading.normalized();
+  std::vector<Pose3> poses;
+  poses.reserve(n);
+  for (size_t k = 0; k < n; k++) {
+    const Vector3 direction = dP.row(k).transpose().normalized();
+    const Vector3 axis = heading.cross(direction);
+    const double angle =
+        std::acos(std::max(-1.0, std::min(1.0, heading.dot(direction))));
+    const Rot3 R = axis.norm() > 1e-12
+                       ? wTb_i_.rotation() *
+                             Rot3::AxisAngle(axis.normalized(), angle)
+                       : wTb_i_.rotation();
+    poses.emplace_back(R, Point3(P.row(k).transpose()));
+  }
+  return poses;
+}
+
+/* ************************************************************************* */
+std::vector<Pose3> KinematicMotionPlanner::basePoses() const {
+  return basePoses(times() / p_.horizon);
+}
+
+/* ************************************************************************* */
+Matrix KinematicMotionPlanner::footPositions(size_t foot) const {
+  const Matrix &footholds = footholds_.at(foot);
+  const int num_feet = p_.feet.size();
+  const double t_swing = p_.t_support / num_feet;
+  const Vector t = times();
+  Matrix positions(3, t.size());
+  for (int k = 0; k < t.size(); k++) {
+    const int prev = std::floor(t(k) / p_.t_support);
+    const int next = std::ceil(t(k) / p_.t_support);
+    const double t_in_support = std::fmod(t(k), p_.t_support);
+
+    // Feet before the swinging one are at their next foothold.
+    const int swinging =
+        t_in_support > 0
+            ? std::min(num_feet - 1,
+                       static_cast<int>(std::ceil(t_in_support / t_swing)) - 1)
+            : 0;
+    if (static_cast<int>(foot) < swinging) {
+      positions.col(k) = footholds.col(next);
+    } else if (static_cast<int>(foot) > swinging) {
+      positions.col(k) = footholds.col(prev);
+    } else {
+      const double s = std::max(
+          0.0, std::min(1.0, (t_in_support - swinging * t_swing) / t_swing));
+      positions.col(k) =
+          footholds.col(prev) + (footholds.col(next) - footholds.col(prev)) * s;
+      positions(2, k) = p_.ground_height + p_.swing_height *
+                                               std::pow(s, 1.1) *
+                                               std::pow(1 - s, 0.7);
+    }
+  }
+  return positions;
+}
+
+/* ************************************************************************* */
+TrajectoryState KinematicMotionPlanner::plan() const {
+  const size_t num_steps = numSteps();
+  const std::vector<Pose3> wTbs = basePoses();
+  std::vector<Matrix> goals;
+  std::vector<int> foot_ids;
+  for (size_t f = 0; f < p_.feet.size(); f++) {
+    goals.push_back(footPositions(f));
+    foot_ids.push_back(robot_.link(p_.feet[f])->id());
+  }
+  const int base_id = robot_.link(p_.base)->id();
+
+  TrajectoryState state(
+      robot_, num_steps,
+      TrajectoryState::kJointAngles | TrajectoryState::kPoses);
+  const DynamicsGraph dgb(Vector3(0, 0, -9.8));
+  const size_t chunk_size = p_.chunk_size ? p_.chunk_size : num_steps;
+  const size_t num_chunks = (num_steps + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, [&](size_t c) {
+    const size_t t0 = c * chunk_size;
+    const size_t t1 = std::min(num_steps, t0 + chunk_size);
+
+    // The rest configuration, moved with the base.
+    Values values;
+    const Pose3 delta = wTbs[t0] * wTb_i_.inverse();
+    for (auto &&link : robot_.links()) {
+      InsertPose(&values, link->id(), t0, delta * link->bMcom());
+    }
+    for (auto &&joint : robot_.joints()) {
+      InsertJointAngle(&values, joint->id(), t0, 0.0);
+    }
+
+    for (size_t t = t0; t < t1; t++) {
+      auto graph = dgb.qFactors(robot_, t);
+      graph.addPrior(PoseKey(base_id, t), wTbs[t], InternedConstrained(6));
+      for (size_t f = 0; f < foot_ids.size(); f++) {
+        graph.emplace_shared<PointGoalFactor>(
+            PoseKey(foot_ids[f], t), InternedConstrained(3), p_.contact_in_com,
+            Point3(goals[f].col(t)));
+      }
+      const Values result =
+          gtsam::LevenbergMarquardtOptimizer(graph, values, p_.lm_parameters)
+              .optimize();
+      state.setStep(t, result, t);
+
+      // Warm start the next step.
+      values.clear();
+      for (auto &&link : robot_.links()) {
+        InsertPose(&values, link->id(), t + 1, Pose(result, link->id(), t));
+      }
+      for (auto &&joint : robot_.joints()) {
+        InsertJointAngle(&values, joint->id(), t + 1,
+                         JointAngle(result, joint->id(), t));
+      }
+    }
+  });
+  return state;
+}
+
+}  // namespace gtdynamics
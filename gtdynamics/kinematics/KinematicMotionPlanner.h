@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicMotionPlanner.h
+ * @brief Kinematic crawl-gait planner along a cubic base trajectory.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/TrajectoryState.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of KinematicMotionPlanner, defaults as for the Vision 60.
+struct KinematicMotionPlannerParams {
+  std::string base = "body";       ///< base link
+  std::vector<std::string> feet;   ///< foot links, in swing order
+  gtsam::Point3 contact_in_com = gtsam::Point3(0.14, 0, 0);  ///< foot point
+  gtsam::Pose3 wTb_f = gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(3, 0, 0.1));
+  gtsam::Vector3 heading = gtsam::Vector3(1, 0, 0);  ///< base forward at rest
+  gtsam::Vector3 start_tangent = gtsam::Vector3(1, 0, 0.4);
+  gtsam::Vector3 end_tangent = gtsam::Vector3(1, 0, 0);
+  double horizon = 72;     ///< duration of the motion
+  double t_support = 8;    ///< duration of a support phase, each foot swings
+  double dt = 1. / 240;    ///< time step
+  double ground_height = -0.2, swing_height = 0.2;
+  size_t chunk_size = 240;  ///< steps solved in sequence, 0 for all
+  gtsam::LevenbergMarquardtParams lm_parameters;  ///< per-step IK
+
+  KinematicMotionPlannerParams() {
+    lm_parameters.setMaxIterations(50);
+    lm_parameters.setlambdaInitial(1e5);
+  }
+};
+
+/**
+ * KinematicMotionPlanner moves the base of a legged robot along a cubic
+ * Hermite spline from its rest pose to wTb_f, facing along the spline, while
+ * the feet swing one at a time in each support phase to footholds placed
+ * under the base at the end of the phase, as in example_quadruped_mp.
+ *
+ * The base and foot trajectories are evaluated for all time steps at once,
+ * as matrix products with the spline coefficients, and the inverse kinematics
+ * of each step is solved with the base pose and foot points as hard goals.
+ * Steps are split in chunks solved in parallel; within a chunk each step is
+ * warm started from the previous one, and the first one from the rest
+ * configuration moved with the base. Solutions go straight into a
+ * TrajectoryState.
+ */
+class KinematicMotionPlanner {
+ private:
+  Robot robot_;
+  KinematicMotionPlannerParams p_;
+  gtsam::Pose3 wTb_i_;
+  gtsam::Matrix43 coefficients_;
+  std::vector<gtsam::Pose3> bTfs_;  // foot points in the base rest frame
+  std::vector<gtsam::Matrix> footholds_;  // 3 x phases + 1, for each foot
+
+  // Base poses at normalized times u in [0, 1].
+  std::vector<gtsam::Pose3> basePoses(const gtsam::Vector &u) const;
+
+ public:
+  /**
+   * Constructor, throws std::invalid_argument without feet or time steps.
+   * @param robot   the robot, at rest in its URDF/SDF configuration
+   * @param params  gait, base trajectory and solver parameters
+   */
+  KinematicMotionPlanner(const Robot &robot,
+                         const KinematicMotionPlannerParams &params);
+
+  /**
+   * Return the 4 x 3 coefficients A of the cubic Hermite spline p(t) =
+   * [t^3, t^2, t, 1] A from p_0 to p_1 in time horizon, with the tangents.
+   */
+  static gtsam::Matrix43 HermiteCoefficients(const gtsam::Vector3 &p_0,
+                                             const gtsam::Vector3 &p_1,
+                                             const gtsam::Vector3 &tangent_0,
+                                             const gtsam::Vector3 &tangent_1,
+                                             double horizon);
+
+  /// Return the number of time steps, those with k dt < horizon.
+  size_t numSteps() const;
+
+  /// Return the times of all steps.
+  gtsam::Vector times() const;
+
+  /// Return the base poses at all steps.
+  std::vector<gtsam::Pose3> basePoses() const;
+
+  /// Return the footholds of a foot, by index in feet, at each phase end.
+  const gtsam::Matrix &footholds(size_t foot) const {
+    return footholds_.at(foot);
+  }
+
+  /// Return the 3 x numSteps() goal positions of the point of a foot.
+  gtsam::Matrix footPositions(size_t foot) const;
+
+  /// Solve the inverse kinematics of all steps, into joint angles and poses.
+  TrajectoryState plan() const;
+};
+
+}  // namespace gtdynamics
@@ -15,12 +15,17 @@
 
 #include <gtdynamics/optimizer/Optimizer.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
 #include <gtdynamics/utils/Interval.h>
 #include <gtdynamics/utils/PointOnLink.h>
 #include <gtsam/geometry/Point3.h>
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <vector>
+
 namespace gtdynamics {
 
 /**
@@ -65,6 +70,25 @@ struct ContactGoal {
 ///< Map of link name to ContactGoal
 using ContactGoals = std::vector<ContactGoal>;
 
+/**
+ * Return the largest distance of the contact goals from their points at each
+ * of the time steps ks, predicting all points at all steps in one batch, see
+ * PointOnLinkBatch.
+ * @param goals   the contact goals
+ * @param values  values with the poses of the links of the goals at ks
+ * @param ks      time steps to check
+ * @return one distance per time step, zero if there are no goals
+ */
+gtsam::Vector ContactGoalErrors(const ContactGoals& goals,
+                                const gtsam::Values& values,
+                                const std::vector<size_t>& ks);
+
+/// Return whether all contact goals are satisfied at time step k, as with
+/// ContactGoal::satisfied for each goal.
+bool ContactGoalsSatisfied(const ContactGoals& goals,
+                           const gtsam::Values& values, size_t k = 0,
+                           double tol = 1e-9);
+
 /// Noise models etc specific to Kinematics class
 struct KinematicsParameters : public OptimizationParameters {
   using Isotropic = gtsam::noiseModel::Isotropic;
@@ -72,11 +96,35 @@ struct KinematicsParameters : public OptimizationParameters {
       g_cost_model,                            // goal point
       prior_q_cost_model;                      // joint angle prior factor
 
+  /// How Kinematics::interpolate finds the slices inside an interval.
+  enum Interpolation {
+    INVERSE_PER_SLICE = 0,  // inverse kinematics on every slice
+    LINEAR_JOINTS = 1,      // joint angles linear between the end solutions
+    CUBIC_JOINTS = 2        // cubic joint angles, at rest at both ends
+  };
+  Interpolation interpolation = INVERSE_PER_SLICE;
+
+  // With joint interpolation, a slice whose contact goals are further than
+  // this from their interpolated goal points is refined by optimization.
+  double interpolation_tolerance = 1e-3;
+
+  // If set, the noise of initialValues at slice k is drawn from
+  // RandomStream(seed, k), which is reproducible for any thread count.
+  // Otherwise every slice gets the same noise.
+  boost::optional<uint64_t> seed;
+
+  // If set, the pose constraints of all joints of a slice, and its point
+  // goal constraints, are each one StackedVectorEquality with a single block
+  // factor, instead of one constraint per joint or goal. This saves virtual
+  // calls and factors for large constraint sets, but makes the block dense
+  // in elimination.
+  bool stack_constraints = false;
+
   // TODO(yetong): replace noise model with tolerance.
   KinematicsParameters()
-      : p_cost_model(Isotropic::Sigma(6, 1e-4)),
-        g_cost_model(Isotropic::Sigma(3, 0.01)),
-        prior_q_cost_model(Isotropic::Sigma(1, 0.5)) {}
+      : p_cost_model(InternedIsotropic(6, 1e-4)),
+        g_cost_model(InternedIsotropic(3, 0.01)),
+        prior_q_cost_model(InternedIsotropic(1, 0.5)) {}
 };
 
 /// All things kinematics, zero velocities/twists, and no forces.
@@ -99,7 +147,21 @@ class Kinematics : public Optimizer {
    */
   template <class CONTEXT>
   gtsam::NonlinearFactorGraph graph(const CONTEXT& context,
-                                    const Robot& robot) const;
+                                    const Robot& robot) const {
+    gtsam::NonlinearFactorGraph result;
+    graph(&result, context, robot);
+    return result;
+  }
+
+  /**
+   * @fn Append kinematics cost factors to a graph.
+   * @param graph factor graph to append to.
+   * @param context Slice or Interval instance.
+   * @param robot Robot specification from URDF/SDF.
+   */
+  template <class CONTEXT>
+  void graph(gtsam::NonlinearFactorGraph* graph, const CONTEXT& context,
+             const Robot& robot) const;
 
   /**
    * @fn Create kinematics constraints.
@@ -171,6 +233,13 @@ class Kinematics : public Optimizer {
 
   /**
    * Interpolate using inverse kinematics: the goals are linearly interpolated.
+   *
+   * With p_.interpolation LINEAR_JOINTS or CUBIC_JOINTS, inverse kinematics is
+   * only solved at both ends. The joint angles of the slices in between are
+   * interpolated, the pose of the first link along the geodesic, and the
+   * other poses follow by forward kinematics. Slices that miss their
+   * interpolated goals by more than p_.interpolation_tolerance are then
+   * optimized, starting from the interpolated values.
    * @param context Interval instance
    * @param robot Robot specification from URDF/SDF.
    * @param contact_goals1 goals for contact points for context.k_start
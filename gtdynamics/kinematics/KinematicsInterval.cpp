@@ -12,8 +12,11 @@
  */
 
 #include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/ForwardKinematicsPlan.h>
 #include <gtdynamics/utils/Interval.h>
+#include <gtdynamics/utils/ParallelFor.h>
 #include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
@@ -25,13 +28,14 @@ using std::string;
 using std::vector;
 
 template <>
-NonlinearFactorGraph Kinematics::graph<Interval>(const Interval& interval,
-                                                 const Robot& robot) const {
-  NonlinearFactorGraph graph;
+void Kinematics::graph<Interval>(NonlinearFactorGraph* graph,
+                                 const Interval& interval,
+                                 const Robot& robot) const {
+  graph->reserve(graph->size() +
+                 (interval.k_end - interval.k_start + 1) * robot.numJoints());
   for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    graph.add(this->graph(Slice(k), robot));
+    this->graph(graph, Slice(k), robot);
   }
-  return graph;
 }
 
 template <>
@@ -78,44 +82,130 @@ template <>
 Values Kinematics::initialValues<Interval>(const Interval& interval,
                                            const Robot& robot,
                                            double gaussian_noise) const {
+  const size_t num_slices = interval.k_end - interval.k_start + 1;
+  vector<Values> slice_values(num_slices);
+  ParallelFor(num_slices, [&](size_t i) {
+    slice_values[i] =
+        initialValues(Slice(interval.k_start + i), robot, gaussian_noise);
+  });
+
   Values values;
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    values.insert(initialValues(Slice(k), robot, gaussian_noise));
-  }
+  for (const Values& slice_value : slice_values) values.insert(slice_value);
   return values;
 }
 
+// No kinematics factor couples different slices, so each slice is solved on
+// its own, in parallel when GTSAM is built with TBB.
 template <>
 Values Kinematics::inverse<Interval>(const Interval& interval,
                                      const Robot& robot,
                                      const ContactGoals& contact_goals,
                                      bool contact_goals_as_constraints) const {
+  const size_t num_slices = interval.k_end - interval.k_start + 1;
+  vector<Values> slice_results(num_slices);
+  ParallelFor(num_slices, [&](size_t i) {
+    slice_results[i] = inverse(Slice(interval.k_start + i), robot,
+                               contact_goals, contact_goals_as_constraints);
+  });
+
   Values results;
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    results.insert(
-        inverse(Slice(k), robot, contact_goals, contact_goals_as_constraints));
+  for (const Values& slice_result : slice_results) {
+    results.insert(slice_result);
   }
   return results;
 }
 
+// Goals linearly interpolated between two goal sets, at t in [0, 1].
+static ContactGoals InterpolatedGoals(const ContactGoals& contact_goals1,
+                                      const ContactGoals& contact_goals2,
+                                      double t) {
+  ContactGoals goals;
+  transform(contact_goals1.begin(), contact_goals1.end(),
+            contact_goals2.begin(), std::back_inserter(goals),
+            [t](const ContactGoal& goal1, const ContactGoal& goal2) {
+              return ContactGoal{
+                  goal1.point_on_link,
+                  (1.0 - t) * goal1.goal_point + t * goal2.goal_point};
+            });
+  return goals;
+}
+
 template <>
 Values Kinematics::interpolate<Interval>(
     const Interval& interval, const Robot& robot,
     const ContactGoals& contact_goals1,
     const ContactGoals& contact_goals2) const {
+  const double dt = 1.0 / (interval.k_end - interval.k_start);  // 5 6 7 8 9 [10
+  const size_t num_slices = interval.k_end - interval.k_start + 1;
+  vector<Values> slice_results(num_slices);
+
+  if (p_.interpolation == KinematicsParameters::INVERSE_PER_SLICE ||
+      num_slices < 3) {
+    ParallelFor(num_slices, [&](size_t i) {
+      const size_t k = interval.k_start + i;
+      const double t = dt * (k - interval.k_start);
+      slice_results[i] =
+          inverse(Slice(k), robot,
+                  InterpolatedGoals(contact_goals1, contact_goals2, t));
+    });
+  } else {
+    // Inverse kinematics at both ends only.
+    const size_t k1 = interval.k_start, k2 = interval.k_end;
+    ParallelFor(2, [&](size_t end) {
+      slice_results[end ? num_slices - 1 : 0] =
+          inverse(Slice(end ? k2 : k1), robot,
+                  end ? contact_goals2 : contact_goals1);
+    });
+    const Values &values1 = slice_results.front(),
+                 &values2 = slice_results.back();
+
+    const LinkSharedPtr root = robot.links()[0];
+    const ForwardKinematicsPlan plan(robot, root->name());
+    const gtsam::Vector zero = gtsam::Vector::Zero(plan.numJointSlots());
+    gtsam::Vector q1 = zero, q2 = zero;
+    for (auto&& joint : robot.joints()) {
+      q1(joint->id()) = JointAngle(values1, joint->id(), k1);
+      q2(joint->id()) = JointAngle(values2, joint->id(), k2);
+    }
+    const gtsam::Pose3 wTroot1 = Pose(values1, root->id(), k1),
+                       wTroot2 = Pose(values2, root->id(), k2);
+    const bool cubic = p_.interpolation == KinematicsParameters::CUBIC_JOINTS;
+
+    ParallelFor(num_slices - 2, [&](size_t i) {
+      const size_t k = k1 + i + 1;
+      const double t = dt * (i + 1);
+      const double s = cubic ? t * t * (3 - 2 * t) : t;
+      const gtsam::Vector q = q1 + s * (q2 - q1);
+      std::vector<gtsam::Pose3> poses;
+      plan.compute(q, zero, gtsam::interpolate(wTroot1, wTroot2, s),
+                   gtsam::Vector6::Zero(), &poses);
+
+      Values values;
+      for (auto&& joint : robot.joints()) {
+        InsertJointAngle(&values, joint->id(), k, q(joint->id()));
+      }
+      for (auto&& link : robot.links()) {
+        InsertPose(&values, link->id(), k, poses[link->id()]);
+      }
+
+      // Refine only if the interpolated slice misses its goals.
+      const Slice slice(k);
+      const ContactGoals goals =
+          InterpolatedGoals(contact_goals1, contact_goals2, t);
+      if (!ContactGoalsSatisfied(goals, values, k,
+                                 p_.interpolation_tolerance)) {
+        auto constraints = this->constraints(slice, robot);
+        constraints.add(pointGoalConstraints(slice, goals));
+        values = optimize(jointAngleObjectives(slice, robot), constraints,
+                          values);
+      }
+      slice_results[i + 1] = values;
+    });
+  }
+
   Values result;
-  const double dt = 1.0 / (interval.k_start - interval.k_end);  // 5 6 7 8 9 [10
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    const double t = dt * (k - interval.k_start);
-    ContactGoals goals;
-    transform(contact_goals1.begin(), contact_goals1.end(),
-              contact_goals2.begin(), std::back_inserter(goals),
-              [t](const ContactGoal& goal1, const ContactGoal& goal2) {
-                return ContactGoal{
-                    goal1.point_on_link,
-                    (1.0 - t) * goal1.goal_point + t * goal2.goal_point};
-              });
-    result.insert(inverse(Slice(k), robot, goals));
+  for (const Values& slice_result : slice_results) {
+    result.insert(slice_result);
   }
   return result;
 }
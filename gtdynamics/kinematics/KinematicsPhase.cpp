@@ -23,6 +23,62 @@ using gtsam::Values;
 using std::string;
 using std::vector;
 
+// Kinematics does not add contact constraints across the slices of a phase
+// yet, so all methods treat a phase as the interval it spans.
 
+template <>
+void Kinematics::graph<Phase>(NonlinearFactorGraph* graph, const Phase& phase,
+                              const Robot& robot) const {
+  this->graph(graph, static_cast<const Interval&>(phase), robot);
+}
+
+template <>
+EqualityConstraints Kinematics::constraints<Phase>(const Phase& phase,
+                                                   const Robot& robot) const {
+  return constraints(static_cast<const Interval&>(phase), robot);
+}
+
+template <>
+NonlinearFactorGraph Kinematics::pointGoalObjectives<Phase>(
+    const Phase& phase, const ContactGoals& contact_goals) const {
+  return pointGoalObjectives(static_cast<const Interval&>(phase),
+                             contact_goals);
+}
+
+template <>
+EqualityConstraints Kinematics::pointGoalConstraints<Phase>(
+    const Phase& phase, const ContactGoals& contact_goals) const {
+  return pointGoalConstraints(static_cast<const Interval&>(phase),
+                              contact_goals);
+}
+
+template <>
+NonlinearFactorGraph Kinematics::jointAngleObjectives<Phase>(
+    const Phase& phase, const Robot& robot) const {
+  return jointAngleObjectives(static_cast<const Interval&>(phase), robot);
+}
+
+template <>
+Values Kinematics::initialValues<Phase>(const Phase& phase, const Robot& robot,
+                                        double gaussian_noise) const {
+  return initialValues(static_cast<const Interval&>(phase), robot,
+                       gaussian_noise);
+}
+
+template <>
+Values Kinematics::inverse<Phase>(const Phase& phase, const Robot& robot,
+                                  const ContactGoals& contact_goals,
+                                  bool contact_goals_as_constraints) const {
+  return inverse(static_cast<const Interval&>(phase), robot, contact_goals,
+                 contact_goals_as_constraints);
+}
+
+template <>
+Values Kinematics::interpolate<Phase>(
+    const Phase& phase, const Robot& robot, const ContactGoals& contact_goals1,
+    const ContactGoals& contact_goals2) const {
+  return interpolate(static_cast<const Interval&>(phase), robot,
+                     contact_goals1, contact_goals2);
+}
 
 }  // namespace gtdynamics
@@ -14,6 +14,10 @@
 #include <gtdynamics/factors/PointGoalFactor.h>
 #include <gtdynamics/factors/PoseFactor.h>
 #include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/PointOnLinkBatch.h>
+#include <gtdynamics/utils/Profiler.h>
+#include <gtdynamics/utils/RandomStream.h>
 #include <gtdynamics/utils/Slice.h>
 #include <gtsam/linear/Sampler.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
@@ -34,20 +38,46 @@ void ContactGoal::print(const std::string& s) const {
   std::cout << (s.empty() ? s : s + " ") << *this;
 }
 
+gtsam::Vector ContactGoalErrors(const ContactGoals& goals,
+                                const Values& values,
+                                const std::vector<size_t>& ks) {
+  gtsam::Vector errors = gtsam::Vector::Zero(ks.size());
+  if (goals.empty()) return errors;
+
+  PointOnLinks points;
+  points.reserve(goals.size());
+  for (const ContactGoal& goal : goals) points.push_back(goal.point_on_link);
+  const PointOnLinkBatch batch(points);
+  const auto positions = batch.predict(values, ks);
+  for (size_t i = 0; i < goals.size(); i++) {
+    const gtsam::Vector distances =
+        (positions[i].matrix().colwise() - goals[i].goal_point)
+            .colwise()
+            .norm()
+            .transpose();
+    errors = errors.cwiseMax(distances);
+  }
+  return errors;
+}
+
+bool ContactGoalsSatisfied(const ContactGoals& goals, const Values& values,
+                           size_t k, double tol) {
+  return goals.empty() || ContactGoalErrors(goals, values, {k})(0) < tol;
+}
+
 template <>
-NonlinearFactorGraph Kinematics::graph<Slice>(const Slice& slice,
-                                              const Robot& robot) const {
-  NonlinearFactorGraph graph;
+void Kinematics::graph<Slice>(NonlinearFactorGraph* graph, const Slice& slice,
+                              const Robot& robot) const {
+  GTD_PROFILE_SCOPE("Kinematics::graph");
 
   // Constrain kinematics at joints.
+  graph->reserve(graph->size() + robot.numJoints());
   for (auto&& joint : robot.joints()) {
     const auto j = joint->id();
-    graph.add(PoseFactor(PoseKey(joint->parent()->id(), slice.k),
-                         PoseKey(joint->child()->id(), slice.k),
-                         JointAngleKey(j, slice.k), p_.p_cost_model, joint));
+    graph->add(PoseFactor(PoseKey(joint->parent()->id(), slice.k),
+                          PoseKey(joint->child()->id(), slice.k),
+                          JointAngleKey(j, slice.k), p_.p_cost_model, joint));
   }
-
-  return graph;
 }
 
 template <>
@@ -57,6 +87,17 @@ EqualityConstraints Kinematics::constraints<Slice>(const Slice& slice,
 
   // Constrain kinematics at joints.
   gtsam::Vector6 tolerance = p_.p_cost_model->sigmas();
+  if (p_.stack_constraints) {
+    std::vector<gtsam::Vector6_> expressions;
+    for (auto&& joint : robot.joints()) {
+      expressions.push_back(joint->poseConstraint(slice.k));
+    }
+    if (!expressions.empty()) {
+      constraints.emplace_shared<StackedVectorEquality<6>>(expressions,
+                                                           tolerance);
+    }
+    return constraints;
+  }
   for (auto&& joint : robot.joints()) {
     auto constraint_expr = joint->poseConstraint(slice.k);
     constraints.emplace_shared<VectorExpressionEquality<6>>(constraint_expr,
@@ -88,12 +129,21 @@ EqualityConstraints Kinematics::pointGoalConstraints<Slice>(
 
   // Add objectives.
   gtsam::Vector3 tolerance = p_.g_cost_model->sigmas();
+  std::vector<gtsam::Vector3_> expressions;
   for (const ContactGoal& goal : contact_goals) {
     const gtsam::Key pose_key = PoseKey(goal.link()->id(), slice.k);
     auto constraint_expr =
         PointGoalConstraint(pose_key, goal.contactInCoM(), goal.goal_point);
-    constraints.emplace_shared<VectorExpressionEquality<3>>(constraint_expr,
-                                                            tolerance);
+    if (p_.stack_constraints) {
+      expressions.push_back(constraint_expr);
+    } else {
+      constraints.emplace_shared<VectorExpressionEquality<3>>(constraint_expr,
+                                                              tolerance);
+    }
+  }
+  if (!expressions.empty()) {
+    constraints.emplace_shared<StackedVectorEquality<3>>(expressions,
+                                                         tolerance);
   }
   return constraints;
 }
@@ -117,9 +167,7 @@ Values Kinematics::initialValues<Slice>(const Slice& slice, const Robot& robot,
                                         double gaussian_noise) const {
   Values values;
 
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  gtsam::Sampler sampler(sampler_noise_model);
+  StepNoise sampler(p_.seed, slice.k, gaussian_noise);
 
   // Initialize all joint angles.
   for (auto&& joint : robot.joints()) {
@@ -139,6 +187,7 @@ template <>
 Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
                                   const ContactGoals& contact_goals,
                                   bool contact_goals_as_constraints) const {
+  GTD_PROFILE_SCOPE("Kinematics::inverse");
   // Robot kinematics constraints
   auto constraints = this->constraints(slice, robot);
   NonlinearFactorGraph graph;
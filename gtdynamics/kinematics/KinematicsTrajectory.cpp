@@ -25,13 +25,12 @@ using std::string;
 using std::vector;
 
 template <>
-NonlinearFactorGraph Kinematics::graph<Trajectory>(const Trajectory& trajectory,
-                                                   const Robot& robot) const {
-  NonlinearFactorGraph graph;
+void Kinematics::graph<Trajectory>(NonlinearFactorGraph* graph,
+                                   const Trajectory& trajectory,
+                                   const Robot& robot) const {
   for (auto&& phase : trajectory.phases()) {
-    graph.add(this->graph<Interval>(phase, robot));
+    this->graph<Interval>(graph, phase, robot);
   }
-  return graph;
 }
 
 template <>
@@ -0,0 +1,279 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ReachabilityMap.cpp
+ * @brief Voxel maps of the positions reachable by a foot, to prune
+ * footholds without solving inverse kinematics.
+ */
+
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/kinematics/ReachabilityMap.h>
+#include <gtdynamics/utils/RandomStream.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+using gtsam::Pose3;
+
+// Joint configurations per call to the batched forward kinematics.
+static constexpr size_t kBatchSize = 4096;
+
+static const char kMagic[8] = {'G', 'T', 'D', 'R', 'E', 'A', 'C', 'H'};
+
+/* ************************************************************************* */
+// Return the index of the link named name in robot.links().
+static size_t LinkIndex(const Robot &robot, const std::string &name) {
+  const auto &links = robot.links();
+  for (size_t i = 0; i < links.size(); i++) {
+    if (links[i]->name() == name) return i;
+  }
+  throw std::invalid_argument("ReachabilityMap: no link " + name);
+}
+
+/* ************************************************************************* */
+// Return the indices in robot.joints() of the joints from link up to its
+// ancestor named reference.
+static std::vector<size_t> ChainJoints(const Robot &robot,
+                                       const std::string &reference,
+                                       LinkSharedPtr link) {
+  const auto &joints = robot.joints();
+  std::vector<size_t> chain;
+  while (link->name() != reference) {
+    auto it = std::find_if(joints.begin(), joints.end(),
+                           [&link](const JointSharedPtr &joint) -> bool {
+                             return joint->child() == link;
+                           });
+    if (it == joints.end()) {
+      throw std::invalid_argument("ReachabilityMap: " + reference +
+                                  " is not an ancestor of the foot.");
+    }
+    chain.push_back(it - joints.begin());
+    link = (*it)->parent();
+  }
+  return chain;
+}
+
+/* ************************************************************************* */
+// Return the CoM pose of link i from a column of BatchSimulator poses.
+static Pose3 FlatPose(const gtsam::Matrix &poses, size_t column, size_t i) {
+  const double *p = poses.col(column).data() + 12 * i;
+  const gtsam::Matrix3 R =
+      (gtsam::Matrix3() << p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7],
+       p[8])
+          .finished();
+  return Pose3(gtsam::Rot3(R), Point3(p[9], p[10], p[11]));
+}
+
+/* ************************************************************************* */
+int64_t ReachabilityMap::voxel(const Point3 &p) const {
+  const Point3 cell = (p - origin_) / resolution_;
+  if (!(cell.x() >= 0 && cell.y() >= 0 && cell.z() >= 0)) return -1;
+  const size_t ix = cell.x(), iy = cell.y(), iz = cell.z();
+  if (ix >= nx_ || iy >= ny_ || iz >= nz_) return -1;
+  return (iz * ny_ + iy) * nx_ + ix;
+}
+
+/* ************************************************************************* */
+ReachabilityMap ReachabilityMap::Compute(
+    const Robot &robot, const std::string &reference, const PointOnLink &foot,
+    const ReachabilityParameters &parameters) {
+  if (!(parameters.resolution > 0) || parameters.num_samples == 0) {
+    throw std::invalid_argument(
+        "ReachabilityMap: needs a positive resolution and samples.");
+  }
+  const size_t r = LinkIndex(robot, reference),
+               f = LinkIndex(robot, foot.link->name());
+  const std::vector<size_t> chain = ChainJoints(robot, reference, foot.link);
+
+  // Sample the chain joints within their limits, in batches.
+  const BatchSimulator simulator(robot);
+  const auto &joints = robot.joints();
+  RandomStream stream(parameters.seed, 0);
+  std::vector<Point3> positions;
+  positions.reserve(parameters.num_samples);
+  for (size_t start = 0; start < parameters.num_samples;
+       start += kBatchSize) {
+    const size_t n = std::min(kBatchSize, parameters.num_samples - start);
+    gtsam::Matrix qs = gtsam::Matrix::Zero(joints.size(), n);
+    for (size_t c = 0; c < n; c++) {
+      for (size_t j : chain) {
+        const auto &limits = joints[j]->parameters().scalar_limits;
+        qs(j, c) = limits.value_lower_limit +
+                   stream.uniform() * (limits.value_upper_limit -
+                                       limits.value_lower_limit);
+      }
+    }
+    const gtsam::Matrix poses = simulator.forwardKinematics(qs);
+    for (size_t c = 0; c < n; c++) {
+      const Point3 wP = FlatPose(poses, c, f).transformFrom(foot.point);
+      positions.push_back(FlatPose(poses, c, r).transformTo(wP));
+    }
+  }
+
+  // Grid over the samples, with room for the dilation.
+  ReachabilityMap map;
+  map.reference_ = reference;
+  map.foot_ = foot.link->name();
+  map.point_ = foot.point;
+  map.resolution_ = parameters.resolution;
+  Point3 lower = positions.front(), upper = lower;
+  for (const Point3 &p : positions) {
+    lower = lower.cwiseMin(p);
+    upper = upper.cwiseMax(p);
+  }
+  const double margin = (parameters.dilation + 1) * parameters.resolution;
+  map.origin_ = lower - Point3::Constant(margin);
+  const Point3 extent = (upper - map.origin_) / parameters.resolution;
+  map.nx_ = size_t(extent.x()) + parameters.dilation + 2;
+  map.ny_ = size_t(extent.y()) + parameters.dilation + 2;
+  map.nz_ = size_t(extent.z()) + parameters.dilation + 2;
+  const size_t num_voxels = map.nx_ * map.ny_ * map.nz_;
+  std::vector<uint64_t> sampled((num_voxels + 63) / 64, 0);
+  for (const Point3 &p : positions) {
+    const int64_t i = map.voxel(p);
+    sampled[i >> 6] |= uint64_t(1) << (i & 63);
+  }
+
+  // Dilate by a cube of dilation voxels on each side.
+  const int64_t d = parameters.dilation;
+  map.bits_.assign(sampled.size(), 0);
+  for (size_t i = 0; i < num_voxels; i++) {
+    if (!(sampled[i >> 6] >> (i & 63) & 1)) continue;
+    const int64_t ix = i % map.nx_, iy = (i / map.nx_) % map.ny_,
+                  iz = i / (map.nx_ * map.ny_);
+    for (int64_t z = iz - d; z <= iz + d; z++) {
+      for (int64_t y = iy - d; y <= iy + d; y++) {
+        for (int64_t x = ix - d; x <= ix + d; x++) {
+          const size_t k = (z * map.ny_ + y) * map.nx_ + x;
+          map.bits_[k >> 6] |= uint64_t(1) << (k & 63);
+        }
+      }
+    }
+  }
+  return map;
+}
+
+/* ************************************************************************* */
+size_t ReachabilityMap::numReachable() const {
+  size_t count = 0;
+  for (uint64_t word : bits_) {
+    for (; word; word &= word - 1) count++;
+  }
+  return count;
+}
+
+/* ************************************************************************* */
+bool ReachabilityMap::reachable(const Pose3 &wTr,
+                                const ContactGoal &goal) const {
+  if (goal.link()->name() != foot_) {
+    throw std::invalid_argument("ReachabilityMap: goal on " +
+                                goal.link()->name() + ", map of " + foot_);
+  }
+  return reachable(wTr, goal.goal_point);
+}
+
+/* ************************************************************************* */
+// Write and read plain values and strings.
+template <class T>
+static void Write(std::ofstream &file, const T &value) {
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+static void Read(std::ifstream &file, T *value) {
+  file.read(reinterpret_cast<char *>(value), sizeof(T));
+}
+
+static void WriteString(std::ofstream &file, const std::string &s) {
+  Write(file, uint64_t(s.size()));
+  file.write(s.data(), s.size());
+}
+
+static std::string ReadString(std::ifstream &file) {
+  uint64_t size = 0;
+  Read(file, &size);
+  std::string s(file ? size : 0, '\0');
+  file.read(&s[0], s.size());
+  return s;
+}
+
+/* ************************************************************************* */
+void ReachabilityMap::save(const std::string &filename) const {
+  std::ofstream file(filename, std::ios::binary);
+  file.write(kMagic, sizeof(kMagic));
+  WriteString(file, reference_);
+  WriteString(file, foot_);
+  for (const Point3 *p : {&point_, &origin_}) {
+    for (size_t i = 0; i < 3; i++) Write(file, (*p)(i));
+  }
+  Write(file, resolution_);
+  for (size_t n : {nx_, ny_, nz_}) Write(file, uint64_t(n));
+  file.write(reinterpret_cast<const char *>(bits_.data()), numBytes());
+  if (!file) {
+    throw std::runtime_error("ReachabilityMap: could not write " + filename);
+  }
+}
+
+/* ************************************************************************* */
+ReachabilityMap ReachabilityMap::Load(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("ReachabilityMap: could not open " + filename);
+  }
+  char magic[sizeof(kMagic)];
+  file.read(magic, sizeof(magic));
+  if (!file || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    throw std::runtime_error("ReachabilityMap: " + filename +
+                             " is not a reachability map.");
+  }
+  ReachabilityMap map;
+  map.reference_ = ReadString(file);
+  map.foot_ = ReadString(file);
+  for (Point3 *p : {&map.point_, &map.origin_}) {
+    for (size_t i = 0; i < 3; i++) Read(file, &(*p)(i));
+  }
+  Read(file, &map.resolution_);
+  uint64_t n[3] = {0, 0, 0};
+  for (size_t i = 0; i < 3; i++) Read(file, &n[i]);
+  map.nx_ = n[0];
+  map.ny_ = n[1];
+  map.nz_ = n[2];
+  map.bits_.resize(file ? (n[0] * n[1] * n[2] + 63) / 64 : 0);
+  file.read(reinterpret_cast<char *>(map.bits_.data()), map.numBytes());
+  if (!file) {
+    throw std::runtime_error("ReachabilityMap: " + filename +
+                             " is truncated.");
+  }
+  return map;
+}
+
+/* ************************************************************************* */
+ContactGoals ReachableGoals(const std::vector<ReachabilityMap> &maps,
+                            const std::map<std::string, Pose3> &poses,
+                            const ContactGoals &goals) {
+  ContactGoals reachable;
+  for (const ContactGoal &goal : goals) {
+    auto map = std::find_if(maps.begin(), maps.end(),
+                            [&goal](const ReachabilityMap &m) -> bool {
+                              return m.foot() == goal.link()->name();
+                            });
+    if (map == maps.end() ||
+        map->reachable(poses.at(map->reference()), goal)) {
+      reachable.push_back(goal);
+    }
+  }
+  return reachable;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ReachabilityMap.h
+ * @brief Voxel maps of the positions reachable by a foot, to prune
+ * footholds without solving inverse kinematics.
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of ReachabilityMap::Compute.
+struct ReachabilityParameters {
+  double resolution = 0.02;     ///< voxel size
+  size_t num_samples = 100000;  ///< joint configurations sampled
+  size_t dilation = 1;          ///< voxels added around the sampled ones
+  uint64_t seed = 0;            ///< seed of the sampled joint angles
+};
+
+/**
+ * ReachabilityMap is a voxel grid over the position of a point on a foot,
+ * in the CoM frame of a reference link such as the hip or the base, with
+ * one bit per voxel set if the point reaches it within the joint limits.
+ *
+ * Maps are computed offline by sampling the joints between the reference
+ * link and the foot uniformly within their limits, with batched forward
+ * kinematics, then dilated to fill the gaps between samples, so that they
+ * err on the side of reachable. A query is then a bit lookup, so hundreds
+ * of candidate footholds are pruned before building any graph, and only the
+ * ones left are checked with Kinematics::inverse.
+ */
+class ReachabilityMap {
+ private:
+  std::string reference_, foot_;  // names of the reference and foot links
+  gtsam::Point3 point_;           // point on the foot, in its CoM frame
+  gtsam::Point3 origin_;          // corner of the first voxel
+  double resolution_ = 1;
+  size_t nx_ = 0, ny_ = 0, nz_ = 0;
+  std::vector<uint64_t> bits_;  // x fastest, then y, then z
+
+  // Return the index of the voxel containing p, or -1 if outside the grid.
+  int64_t voxel(const gtsam::Point3 &p) const;
+
+ public:
+  /// Default constructor, an empty map where nothing is reachable.
+  ReachabilityMap() {}
+
+  /**
+   * Compute the map of a point on a foot.
+   * @param robot       the robot, must be a tree
+   * @param reference   link whose frame the map is in, an ancestor of the foot
+   * @param foot        the point on the foot
+   * @param parameters  resolution, number of samples and dilation
+   * @throws std::invalid_argument if reference is not an ancestor of the foot
+   */
+  static ReachabilityMap Compute(
+      const Robot &robot, const std::string &reference,
+      const PointOnLink &foot,
+      const ReachabilityParameters &parameters = ReachabilityParameters());
+
+  /// Return the name of the reference link.
+  const std::string &reference() const { return reference_; }
+
+  /// Return the name of the foot link.
+  const std::string &foot() const { return foot_; }
+
+  /// Return the point on the foot, in its CoM frame.
+  const gtsam::Point3 &point() const { return point_; }
+
+  /// Return the voxel size.
+  double resolution() const { return resolution_; }
+
+  /// Return the number of reachable voxels.
+  size_t numReachable() const;
+
+  /// Return the memory taken by the voxels, in bytes.
+  size_t numBytes() const { return bits_.size() * sizeof(uint64_t); }
+
+  /// Return whether a position in the reference CoM frame is reachable.
+  bool reachable(const gtsam::Point3 &position) const {
+    const int64_t i = voxel(position);
+    return i >= 0 && (bits_[i >> 6] >> (i & 63) & 1);
+  }
+
+  /**
+   * Return whether a foothold in the world frame is reachable with the
+   * reference link at pose wTr, the pose of its CoM.
+   */
+  bool reachable(const gtsam::Pose3 &wTr, const gtsam::Point3 &foothold) const {
+    return reachable(wTr.transformTo(foothold));
+  }
+
+  /**
+   * Return whether a contact goal on the foot of this map is reachable with
+   * the reference link at pose wTr.
+   * @throws std::invalid_argument if the goal is on another link.
+   */
+  bool reachable(const gtsam::Pose3 &wTr, const ContactGoal &goal) const;
+
+  /// Write the map to a binary file.
+  void save(const std::string &filename) const;
+
+  /// Read a map written by save.
+  static ReachabilityMap Load(const std::string &filename);
+};
+
+/**
+ * Return the contact goals reachable according to the map of their foot,
+ * with the reference link of each map at its pose in poses. Goals on links
+ * without a map are kept.
+ * @param maps     one map per foot
+ * @param poses    CoM poses of the reference links, by link name
+ * @param goals    the candidate contact goals
+ */
+ContactGoals ReachableGoals(const std::vector<ReachabilityMap> &maps,
+                            const std::map<std::string, gtsam::Pose3> &poses,
+                            const ContactGoals &goals);
+
+}  // namespace gtdynamics
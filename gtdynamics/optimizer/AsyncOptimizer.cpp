@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AsyncOptimizer.cpp
+ * @brief Asynchronous, cancellable solves on a shared executor.
+ */
+
+#include <gtdynamics/optimizer/AsyncOptimizer.h>
+
+#include <algorithm>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+SolveExecutor::SolveExecutor(size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this]() { work(); });
+  }
+}
+
+/* ************************************************************************* */
+SolveExecutor::~SolveExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+/* ************************************************************************* */
+void SolveExecutor::submit(const std::function<void()>& task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+  ready_.notify_one();
+}
+
+/* ************************************************************************* */
+void SolveExecutor::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this]() -> bool {
+        return stopping_ || !tasks_.empty();
+      });
+      if (tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+/* ************************************************************************* */
+AsyncOptimizer::AsyncOptimizer(const OptimizationParameters& parameters,
+                               const std::shared_ptr<SolveExecutor>& executor)
+    : parameters_(parameters),
+      executor_(executor ? executor : std::make_shared<SolveExecutor>()) {}
+
+/* ************************************************************************* */
+SolveHandle AsyncOptimizer::solve(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    const SolveControl::Progress& progress) const {
+  auto control = std::make_shared<SolveControl>(progress);
+  OptimizationParameters parameters = parameters_;
+  parameters.control = control;
+
+  // The task owns copies of the problem, and the promise of its result.
+  auto promise = std::make_shared<std::promise<AsyncSolveResult>>();
+  const std::shared_future<AsyncSolveResult> future =
+      promise->get_future().share();
+  executor_->submit([=]() {
+    try {
+      AsyncSolveResult result;
+      if (control->cancelled()) {
+        result.values = initial_values;
+        result.status.cancelled = true;
+      } else {
+        const Optimizer optimizer(parameters);
+        result.values = optimizer.optimize(graph, constraints, initial_values,
+                                           nullptr, &result.status);
+      }
+      promise->set_value(std::move(result));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return SolveHandle(control, future);
+}
+
+}  // namespace gtdynamics
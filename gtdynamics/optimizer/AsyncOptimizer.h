@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AsyncOptimizer.h
+ * @brief Asynchronous, cancellable solves on a shared executor.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * A fixed pool of threads running submitted tasks in order of submission,
+ * shared by any number of AsyncOptimizer instances. Tasks still queued at
+ * destruction are run before the threads are joined.
+ */
+class SolveExecutor {
+ private:
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  bool stopping_ = false;
+
+  /// Run tasks until stopping with an empty queue.
+  void work();
+
+ public:
+  /// Constructor, with one thread per hardware thread if num_threads is 0.
+  explicit SolveExecutor(size_t num_threads = 0);
+
+  SolveExecutor(const SolveExecutor&) = delete;
+  SolveExecutor& operator=(const SolveExecutor&) = delete;
+
+  ~SolveExecutor();
+
+  /// Queue a task.
+  void submit(const std::function<void()>& task);
+
+  /// Return the number of threads.
+  size_t numThreads() const { return threads_.size(); }
+};
+
+/// Result of an asynchronous solve.
+struct AsyncSolveResult {
+  gtsam::Values values;       // the result, initial values if never started
+  OptimizationStatus status;  // status of Optimizer::optimize
+};
+
+/**
+ * Handle of an asynchronous solve. Cancellation is cooperative: the solve
+ * stops at its next check, between LM iterations, and its result is then the
+ * current iterate, or the best feasible one so far for constrained methods.
+ * A solve cancelled before it starts returns its initial values.
+ */
+class SolveHandle {
+ private:
+  std::shared_ptr<SolveControl> control_;
+  std::shared_future<AsyncSolveResult> future_;
+
+ public:
+  /// Default constructor, an invalid handle.
+  SolveHandle() {}
+
+  /// Constructor.
+  SolveHandle(const std::shared_ptr<SolveControl>& control,
+              const std::shared_future<AsyncSolveResult>& future)
+      : control_(control), future_(future) {}
+
+  /// Ask the solve to stop.
+  void cancel() const { control_->cancel(); }
+
+  /// Return whether the solve was cancelled.
+  bool cancelled() const { return control_->cancelled(); }
+
+  /// Return whether the result is available.
+  bool ready() const {
+    return future_.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+
+  /// Wait for the result.
+  void wait() const { future_.wait(); }
+
+  /// Wait for the result and return it, or rethrow the solver exception.
+  const AsyncSolveResult& get() const { return future_.get(); }
+
+  /// Return the number of iterations so far.
+  size_t iterations() const { return control_->iterations(); }
+};
+
+/**
+ * AsyncOptimizer runs Optimizer::optimize on a SolveExecutor and returns a
+ * handle at once, so that many solves can be in flight, e.g. speculative
+ * plans abandoned when the world changes. Each solve gets its own
+ * SolveControl, with the progress callback if given, which is called on the
+ * executor thread.
+ */
+class AsyncOptimizer {
+ private:
+  OptimizationParameters parameters_;
+  std::shared_ptr<SolveExecutor> executor_;
+
+ public:
+  /**
+   * Constructor
+   * @param parameters  parameters of every solve, without control
+   * @param executor    executor to share, a new one if null
+   */
+  AsyncOptimizer(const OptimizationParameters& parameters,
+                 const std::shared_ptr<SolveExecutor>& executor = nullptr);
+
+  /// Return the executor.
+  const std::shared_ptr<SolveExecutor>& executor() const {
+    return executor_;
+  }
+
+  /**
+   * Queue a solve. The graph, constraints and values are copied.
+   * @param graph           cost factors
+   * @param constraints     equality constraints
+   * @param initial_values  initial values of all variables
+   * @param progress        optional, called with the iteration and error
+   */
+  SolveHandle solve(const gtsam::NonlinearFactorGraph& graph,
+                    const EqualityConstraints& constraints,
+                    const gtsam::Values& initial_values,
+                    const SolveControl::Progress& progress = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -12,34 +12,32 @@
  */
 
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/SolveCheckpoint.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 
 namespace gtdynamics {
 
+/// Name of the solver in its checkpoints.
+static const char kSolver[] = "AugmentedLagrangian";
+
 /** Update penalty parameter and Lagrangian multipliers from unconstrained
- * optimization result. */
-void update_parameters(const EqualityConstraints& constraints,
-                       const gtsam::Values& previous_values,
-                       const gtsam::Values& current_values, double& mu,
+ * optimization result, given the constraint violations before and after. */
+void update_parameters(const ConstraintViolations& previous,
+                       const ConstraintViolations& current, double& mu,
                        std::vector<gtsam::Vector>& z) {
-  double previous_error = 0;
-  double current_error = 0;
-  for (size_t constraint_index = 0; constraint_index < constraints.size();
+  // Update Lagrangian multipliers.
+  for (size_t constraint_index = 0; constraint_index < z.size();
        constraint_index++) {
-    auto constraint = constraints.at(constraint_index);
-
-    // Update Lagrangian multipliers.
-    auto violation = (*constraint)(current_values);
-    z[constraint_index] += mu * violation;
-
-    // Sum errors for updating penalty parameter.
-    previous_error +=
-        pow(constraint->toleranceScaledViolation(previous_values).norm(), 2);
-    current_error +=
-        pow(constraint->toleranceScaledViolation(current_values).norm(), 2);
+    z[constraint_index] += mu * current.violations[constraint_index];
   }
 
   // Update penalty parameter.
-  if (sqrt(current_error) >= 0.25 * sqrt(previous_error)) {
+  if (sqrt(current.squaredNorm()) >= 0.25 * sqrt(previous.squaredNorm())) {
     mu *= 2;
   }
 }
@@ -57,37 +55,119 @@ gtsam::Values AugmentedLagrangianOptimizer::optimize(
     z.push_back(gtsam::Vector::Zero(constraint->dim()));
   }
 
+  // Or continue from the checkpoint of an interrupted solve.
+  size_t first_iteration = 0;
+  const bool checkpoint = !p_.checkpoint_path.empty();
+  boost::optional<SolveCheckpoint> resumed;
+  if (checkpoint) {
+    resumed = LoadSolveCheckpoint(p_.checkpoint_path, kSolver, initial_values);
+  }
+  if (resumed) {
+    if (resumed->multipliers.size() != z.size()) {
+      throw std::runtime_error(
+          "AugmentedLagrangianOptimizer: the checkpoint has other "
+          "constraints.");
+    }
+    values = resumed->values;
+    mu = resumed->mu;
+    z = resumed->multipliers;
+    first_iteration = resumed->iterations;
+  }
+
+  // The merit graph keeps the same structure in all outer iterations: the
+  // cost factors, followed by one penalty factor per constraint, which is
+  // updated in place when mu and the multipliers change.
+  gtsam::NonlinearFactorGraph merit_graph = graph;
+  const size_t first_penalty = merit_graph.size();
+  for (const auto& constraint : constraints) {
+    merit_graph.add(constraint->createFactor(mu));
+  }
+
+  // Hence the symbolic structure, with the elimination ordering, is
+  // computed once, and each inner loop starts with the damping the previous
+  // one ended with.
+  const auto structure = p_.symbolic_structure
+                             ? p_.symbolic_structure
+                             : std::make_shared<SymbolicStructure>();
+  gtsam::LevenbergMarquardtParams lm_parameters =
+      StructuredParameters(merit_graph, p_.lm_parameters, structure.get());
+  if (resumed) lm_parameters.setlambdaInitial(resumed->lambda);
+
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
-  for (int i = 0; i < p_.num_iterations; i++) {
-    // Construct merit function.
-    gtsam::NonlinearFactorGraph merit_graph = graph;
-
-    // Create factors corresponding to penalty terms of constraints.
+  const Deadline deadline(p_.deadline, p_.control);
+  BestFeasibleIterate best;
+  ConstraintViolations previous = constraints.evaluate(values);
+  for (size_t i = first_iteration;
+       i < p_.num_iterations && !deadline.expired(); i++) {
+    // Update the penalty terms of constraints.
     for (size_t constraint_index = 0; constraint_index < constraints.size();
          constraint_index++) {
       auto constraint = constraints.at(constraint_index);
       gtsam::Vector bias = z[constraint_index] / mu;
-      merit_graph.add(constraint->createFactor(mu, bias));
+      const size_t factor_index = first_penalty + constraint_index;
+      if (!constraint->updateFactor(*merit_graph.at(factor_index), mu, bias)) {
+        merit_graph.replace(factor_index, constraint->createFactor(mu, bias));
+      }
     }
 
-    // Run LM optimization.
-    gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
-    auto result = optimizer.optimize();
+    // Run LM optimization, instrumented if telemetry is requested.
+    gtsam::Values result;
+    size_t num_iters;
+    double lambda = lm_parameters.lambdaInitial;
+    if (intermediate_result != nullptr && intermediate_result->telemetry) {
+      SolverTelemetry* telemetry = intermediate_result->telemetry;
+      const size_t begin = telemetry->iterations.size();
+      result = InstrumentedLevenbergMarquardt(merit_graph, values,
+                                              lm_parameters, telemetry, i,
+                                              &num_iters, structure.get());
+      if (telemetry->iterations.size() > begin) {
+        lambda = telemetry->iterations.back().lambda;
+      }
+    } else {
+      result = LevenbergMarquardtUntil(merit_graph, values, lm_parameters,
+                                       deadline, &num_iters, &lambda,
+                                       structure);
+    }
+    lm_parameters.setlambdaInitial(
+        std::max(lm_parameters.lambdaLowerBound,
+                 std::min(lambda, lm_parameters.lambdaUpperBound)));
 
-    // Update parameters.
-    update_parameters(constraints, values, result, mu, z);
+    // Update parameters, the violations at the result are kept for the next
+    // outer iteration.
+    ConstraintViolations current = constraints.evaluate(result);
+    update_parameters(previous, current, mu, z);
+    previous = std::move(current);
 
     // Update values.
     values = result;
+    if (!deadline.unlimited()) best.update(graph, constraints, values);
 
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
       intermediate_result->intermediate_values.push_back(values);
-      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
+      intermediate_result->num_iters.push_back(num_iters);
       intermediate_result->mu_values.push_back(mu);
     }
+
+    // Save the state to resume from.
+    if (checkpoint && (CheckpointDue(i + 1, p_.checkpoint_interval) ||
+                       i + 1 == p_.num_iterations || deadline.expired())) {
+      SolveCheckpoint state;
+      state.solver = kSolver;
+      state.values = values;
+      state.iterations = i + 1;
+      state.mu = mu;
+      state.lambda = lm_parameters.lambdaInitial;
+      state.multipliers = z;
+      SaveSolveCheckpoint(state, p_.checkpoint_path);
+    }
+  }
+
+  // Out of time: return the best feasible iterate, if any.
+  if (deadline.expired()) {
+    if (intermediate_result != nullptr) intermediate_result->timed_out = true;
+    if (best.values()) return *best.values();
   }
   return values;
 }
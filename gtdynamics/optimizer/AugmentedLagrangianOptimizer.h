@@ -32,7 +32,15 @@ struct AugmentedLagrangianParameters
       : Base(_lm_parameters), num_iterations(_num_iterations) {}
 };
 
-/// Augmented Lagrangian method only considering equality constraints.
+/**
+ * Augmented Lagrangian method only considering equality constraints.
+ *
+ * The merit graph and its symbolic structure are built once, only the
+ * penalty factors are replaced between outer iterations, and each inner LM
+ * loop starts from the damping the previous one ended with. An ordering given
+ * in the LM parameters is used as is, otherwise the one of their ordering
+ * type is computed once.
+ */
 class AugmentedLagrangianOptimizer : public ConstrainedOptimizer {
  protected:
   const AugmentedLagrangianParameters p_;
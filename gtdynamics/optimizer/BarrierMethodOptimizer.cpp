@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BarrierMethodOptimizer.cpp
+ * @brief Interior-point barrier method for inequality constraints.
+ */
+
+#include <gtdynamics/optimizer/BarrierMethodOptimizer.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+gtsam::Values BarrierMethodOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& equality_constraints,
+    const InequalityConstraints& inequality_constraints,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  if (!inequality_constraints.feasible(initial_values)) {
+    throw std::invalid_argument(
+        "BarrierMethodOptimizer: initial values must strictly satisfy all "
+        "inequality constraints.");
+  }
+
+  gtsam::Values values = initial_values;
+  double barrier = p_.initial_barrier;
+  double mu = p_.initial_mu;
+
+  // Solve the constrained optimization problem by solving a sequence of
+  // unconstrained optimization problems.
+  for (size_t i = 0; i < p_.num_iterations; i++) {
+    gtsam::NonlinearFactorGraph merit_graph = graph;
+
+    // Create factors corresponding to penalty and barrier terms.
+    for (auto& constraint : equality_constraints) {
+      merit_graph.add(constraint->createFactor(mu));
+    }
+    for (auto& constraint : inequality_constraints) {
+      merit_graph.add(constraint->createBarrierFactor(barrier));
+    }
+
+    // Run optimization.
+    gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
+                                                 p_.lm_parameters);
+    auto result = optimizer.optimize();
+
+    // Save results and update parameters.
+    values = result;
+    barrier *= p_.barrier_decrease_rate;
+    mu *= p_.mu_increase_rate;
+
+    /// Store intermediate results.
+    if (intermediate_result != nullptr) {
+      intermediate_result->intermediate_values.push_back(values);
+      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
+      intermediate_result->mu_values.push_back(barrier);
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BarrierMethodOptimizer.h
+ * @brief Interior-point barrier method for inequality constraints.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/optimizer/InequalityConstraint.h>
+
+namespace gtdynamics {
+
+/// Parameters for barrier method
+struct BarrierMethodParameters : public ConstrainedOptimizationParameters {
+  using Base = ConstrainedOptimizationParameters;
+  size_t num_iterations;
+  double initial_barrier;        // initial barrier parameter
+  double barrier_decrease_rate;  // decrease rate of barrier parameter
+  double initial_mu;             // initial penalty of equality constraints
+  double mu_increase_rate;       // increase rate of penalty parameter
+
+  /** Constructor. */
+  BarrierMethodParameters()
+      : BarrierMethodParameters(gtsam::LevenbergMarquardtParams()) {}
+
+  BarrierMethodParameters(const gtsam::LevenbergMarquardtParams& _lm_parameters,
+                          const size_t& _num_iterations = 10,
+                          const double& _initial_barrier = 1.0,
+                          const double& _barrier_decrease_rate = 0.2,
+                          const double& _initial_mu = 1.0,
+                          const double& _mu_increase_rate = 2.0)
+      : Base(_lm_parameters),
+        num_iterations(_num_iterations),
+        initial_barrier(_initial_barrier),
+        barrier_decrease_rate(_barrier_decrease_rate),
+        initial_mu(_initial_mu),
+        mu_increase_rate(_mu_increase_rate) {}
+};
+
+/**
+ * Barrier method: inequality constraints are enforced by BarrierFactors, whose
+ * parameter shrinks over a sequence of LM solves, and equality constraints by
+ * penalties, as in PenaltyMethodOptimizer. The initial values must strictly
+ * satisfy all inequality constraints; since the barrier is infinite outside
+ * the feasible set, LM rejects any step leaving it, and all iterates stay
+ * feasible.
+ */
+class BarrierMethodOptimizer : public ConstrainedOptimizer {
+ protected:
+  const BarrierMethodParameters p_;
+
+ public:
+  /** Default constructor. */
+  BarrierMethodOptimizer() : p_(BarrierMethodParameters()) {}
+
+  /** Construct from parameters. */
+  BarrierMethodOptimizer(const BarrierMethodParameters& parameters)
+      : p_(parameters) {}
+
+  /**
+   * Run optimization with equality and inequality constraints.
+   * @throws std::invalid_argument if initial values are not strictly feasible.
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& equality_constraints,
+      const InequalityConstraints& inequality_constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
+
+  /// Run optimization with equality constraints only.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override {
+    return optimize(graph, constraints, InequalityConstraints(),
+                    initial_values, intermediate_result);
+  }
+};
+
+}  // namespace gtdynamics
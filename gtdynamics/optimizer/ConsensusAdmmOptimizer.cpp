@@ -0,0 +1,214 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConsensusAdmmOptimizer.cpp
+ * @brief Consensus ADMM over partitions of a factor graph, e.g. time windows
+ * of a long trajectory or the robots of a fleet.
+ */
+
+#include <gtdynamics/optimizer/ConsensusAdmmOptimizer.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::VectorValues;
+
+namespace {
+
+// Values of `keys` only.
+Values Restrict(const Values &values, const KeyVector &keys) {
+  Values result;
+  for (Key key : keys) result.insert(key, values.at(key));
+  return result;
+}
+
+// Add a prior on key at target, if the value is of type T.
+template <typename T>
+bool AddPrior(Key key, const gtsam::Value &target,
+              const gtsam::SharedNoiseModel &model,
+              NonlinearFactorGraph *graph) {
+  const auto value = dynamic_cast<const gtsam::GenericValue<T> *>(&target);
+  if (!value) return false;
+  graph->emplace_shared<gtsam::PriorFactor<T>>(key, value->value(), model);
+  return true;
+}
+
+// Add a prior on key at target, for the supported types of shared values.
+void AddConsensusPrior(Key key, const gtsam::Value &target, double rho,
+                       NonlinearFactorGraph *graph) {
+  const auto model = InternedIsotropic(target.dim(), 1.0 / std::sqrt(rho));
+  if (!AddPrior<double>(key, target, model, graph) &&
+      !AddPrior<gtsam::Vector>(key, target, model, graph) &&
+      !AddPrior<gtsam::Vector3>(key, target, model, graph) &&
+      !AddPrior<gtsam::Vector6>(key, target, model, graph) &&
+      !AddPrior<gtsam::Pose2>(key, target, model, graph) &&
+      !AddPrior<gtsam::Pose3>(key, target, model, graph) &&
+      !AddPrior<gtsam::Rot3>(key, target, model, graph)) {
+    throw std::invalid_argument(
+        "ConsensusAdmmOptimizer: unsupported type of shared variable " +
+        std::string(DynamicsSymbol(key)) + ".");
+  }
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+std::vector<NonlinearFactorGraph> PartitionByTime(
+    const NonlinearFactorGraph &graph, size_t num_windows) {
+  if (num_windows == 0) {
+    throw std::invalid_argument("PartitionByTime: num_windows should be > 0.");
+  }
+
+  // Earliest time step of each factor, -1 if it has only global keys.
+  std::vector<int> times;
+  int first = std::numeric_limits<int>::max(), last = -1;
+  for (const auto &factor : graph) {
+    int time = -1;
+    if (factor) {
+      for (Key key : factor->keys()) {
+        const DynamicsSymbol symbol(key);
+        if (symbol.linkIdx() == DynamicsSymbol::kNoIndex &&
+            symbol.jointIdx() == DynamicsSymbol::kNoIndex) {
+          continue;
+        }
+        const int t = symbol.time();
+        time = time < 0 ? t : std::min(time, t);
+      }
+    }
+    times.push_back(time);
+    if (time >= 0) {
+      first = std::min(first, time);
+      last = std::max(last, time);
+    }
+  }
+
+  std::vector<NonlinearFactorGraph> windows(num_windows);
+  const size_t span = last < 0 ? 1 : last - first + 1;
+  for (size_t i = 0; i < graph.size(); i++) {
+    if (!graph[i]) continue;
+    const size_t w = times[i] < 0 ? 0 : (times[i] - first) * num_windows / span;
+    windows[w].push_back(graph[i]);
+  }
+  return windows;
+}
+
+/* ************************************************************************* */
+Values ConsensusAdmmOptimizer::optimize(
+    const std::vector<NonlinearFactorGraph> &partitions,
+    const Values &initial_values, ConsensusAdmmStatus *status) const {
+  const size_t n = partitions.size();
+
+  // Variables of each partition, and the partitions of each variable.
+  std::vector<Values> x(n);
+  std::map<Key, std::vector<size_t>> owners;
+  for (size_t i = 0; i < n; i++) {
+    for (Key key : partitions[i].keys()) {
+      x[i].insert(key, initial_values.at(key));
+      owners[key].push_back(i);
+    }
+  }
+
+  // Consensus of shared variables, and the scaled duals of each partition.
+  Values z;
+  std::vector<KeyVector> shared(n);
+  for (const auto &key_owners : owners) {
+    if (key_owners.second.size() < 2) continue;
+    z.insert(key_owners.first, initial_values.at(key_owners.first));
+    for (size_t i : key_owners.second) shared[i].push_back(key_owners.first);
+  }
+  std::vector<VectorValues> u(n);
+  for (size_t i = 0; i < n; i++) u[i] = Restrict(z, shared[i]).zeroVectors();
+
+  ConsensusAdmmStatus result;
+  while (result.iterations < params_.max_iterations) {
+    result.iterations++;
+
+    // Solve the partitions, pulled towards the consensus.
+    ParallelFor(n, [&](size_t i) {
+      if (partitions[i].empty()) return;
+      NonlinearFactorGraph graph = partitions[i];
+      const Values targets = Restrict(z, shared[i]).retract(-1.0 * u[i]);
+      for (const auto &key_value : targets) {
+        AddConsensusPrior(key_value.key, key_value.value, params_.rho, &graph);
+      }
+      x[i] = gtsam::LevenbergMarquardtOptimizer(graph, x[i],
+                                                params_.lm_parameters)
+                 .optimize();
+    });
+
+    // Average the shared variables and their duals in the tangent space at z.
+    VectorValues mean = z.zeroVectors();
+    for (size_t i = 0; i < n; i++) {
+      const VectorValues local =
+          Restrict(z, shared[i]).localCoordinates(Restrict(x[i], shared[i]));
+      for (Key key : shared[i]) {
+        mean.at(key) += (local.at(key) + u[i].at(key)) /
+                        double(owners.at(key).size());
+      }
+    }
+    const Values new_z = z.retract(mean);
+
+    // Update the duals with the disagreement left.
+    double primal = 0, dual = 0;
+    for (size_t i = 0; i < n; i++) {
+      const VectorValues residual = Restrict(new_z, shared[i])
+                                        .localCoordinates(
+                                            Restrict(x[i], shared[i]));
+      u[i] += residual;
+      primal += residual.squaredNorm();
+    }
+    const VectorValues change = z.localCoordinates(new_z);
+    for (const auto &key_delta : change) {
+      dual += owners.at(key_delta.first).size() *
+              key_delta.second.squaredNorm();
+    }
+    z = new_z;
+    result.primal_residual = std::sqrt(primal);
+    result.dual_residual = params_.rho * std::sqrt(dual);
+    result.converged = result.primal_residual <= params_.tolerance &&
+                       result.dual_residual <= params_.tolerance;
+    if (result.converged) break;
+  }
+
+  // Shared variables take the consensus, the others their partition value.
+  Values values = z;
+  for (size_t i = 0; i < n; i++) {
+    for (const auto &key_value : x[i]) {
+      if (!values.exists(key_value.key)) {
+        values.insert(key_value.key, key_value.value);
+      }
+    }
+  }
+  for (const auto &key_value : initial_values) {
+    if (!values.exists(key_value.key)) {
+      values.insert(key_value.key, key_value.value);
+    }
+  }
+  if (status) *status = result;
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConsensusAdmmOptimizer.h
+ * @brief Consensus ADMM over partitions of a factor graph, e.g. time windows
+ * of a long trajectory or the robots of a fleet.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Partition a trajectory graph into time windows of about equal length.
+ * Each factor goes to the window of the earliest time step of its link and
+ * joint keys, factors with only global keys, e.g. phase durations, to the
+ * first. Factors coupling two windows, e.g. collocation factors, thus go to
+ * the earlier one, and the variables of the later one they involve become
+ * shared by both.
+ * @param graph        the trajectory graph
+ * @param num_windows  number of windows, at least 1
+ * @return the graph of each window, earliest first; some may be empty
+ */
+std::vector<gtsam::NonlinearFactorGraph> PartitionByTime(
+    const gtsam::NonlinearFactorGraph &graph, size_t num_windows);
+
+/// Parameters of ConsensusAdmmOptimizer.
+struct ConsensusAdmmParams {
+  double rho = 1.0;             ///< penalty on disagreement with consensus
+  size_t max_iterations = 100;  ///< maximum number of ADMM iterations
+  double tolerance = 1e-4;      ///< on the primal and dual residuals
+  gtsam::LevenbergMarquardtParams lm_parameters;  ///< of the subproblems
+};
+
+/// Outcome of ConsensusAdmmOptimizer::optimize.
+struct ConsensusAdmmStatus {
+  size_t iterations = 0;       ///< ADMM iterations run
+  double primal_residual = 0;  ///< disagreement of partitions with consensus
+  double dual_residual = 0;    ///< change of the consensus, scaled by rho
+  bool converged = false;      ///< both residuals within tolerance
+};
+
+/**
+ * ConsensusAdmmOptimizer minimizes the sum of the errors of several factor
+ * graphs, the partitions, by the alternating direction method of
+ * multipliers. Each partition keeps its own copy of its variables; those
+ * shared with other partitions are pulled towards a consensus value z by a
+ * prior with sigma 1/sqrt(rho), at z retracted by minus the scaled dual u.
+ * Each iteration solves all partitions in parallel with LM, warm started,
+ * then averages the shared variables in the tangent space of z and updates
+ * the duals with the remaining disagreement.
+ *
+ * Only the shared, boundary variables are exchanged between the partitions
+ * and the consensus step, so partitions can be solved independently. They
+ * are solved here in the threads of this process.
+ *
+ * Shared variables may be doubles, gtsam::Vector, Vector3, Vector6, Pose2,
+ * Pose3 or Rot3.
+ */
+class ConsensusAdmmOptimizer {
+ private:
+  ConsensusAdmmParams params_;
+
+ public:
+  explicit ConsensusAdmmOptimizer(
+      const ConsensusAdmmParams &params = ConsensusAdmmParams())
+      : params_(params) {}
+
+  /**
+   * Optimize the partitions to consensus.
+   * @param partitions      graphs whose errors add up to the problem's
+   * @param initial_values  initial values of all their variables
+   * @param status          if given, iterations and final residuals
+   * @return consensus values of shared variables, the partition values of
+   *         the others, and initial values of variables of no partition
+   * @throws std::invalid_argument if a shared variable has another type.
+   */
+  gtsam::Values optimize(
+      const std::vector<gtsam::NonlinearFactorGraph> &partitions,
+      const gtsam::Values &initial_values,
+      ConsensusAdmmStatus *status = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConstrainedOptimizer.cpp
+ * @brief Helpers shared by constrained optimizers.
+ */
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtsam/nonlinear/NonlinearOptimizer.h>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+Deadline::Deadline(double seconds,
+                   const std::shared_ptr<SolveControl>& control)
+    : unlimited_(!(seconds < std::numeric_limits<double>::max())),
+      control_(control) {
+  end_ = Clock::time_point::max();
+  if (!unlimited_) {
+    end_ = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::duration<double>(seconds));
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Values LevenbergMarquardtUntil(
+    const gtsam::NonlinearFactorGraph& graph,
+    const gtsam::Values& initial_values,
+    const gtsam::LevenbergMarquardtParams& params, const Deadline& deadline,
+    size_t* iterations, double* lambda,
+    const std::shared_ptr<SymbolicStructure>& structure) {
+  StructuredLevenbergMarquardt optimizer(graph, initial_values, params,
+                                         structure);
+  if (deadline.unlimited()) {
+    optimizer.optimize();
+  } else {
+    double error = optimizer.error();
+    while (optimizer.iterations() < size_t(params.maxIterations) &&
+           !deadline.expired()) {
+      optimizer.iterate();
+      const double new_error = optimizer.error();
+      const bool converged = gtsam::checkConvergence(params, error, new_error);
+      error = new_error;
+      deadline.iterated(error);
+      if (converged) break;
+    }
+  }
+  if (iterations) *iterations = optimizer.getInnerIterations();
+  if (lambda) *lambda = optimizer.lambda();
+  return optimizer.values();
+}
+
+/* ************************************************************************* */
+void BestFeasibleIterate::update(const gtsam::NonlinearFactorGraph& graph,
+                                 const EqualityConstraints& constraints,
+                                 const gtsam::Values& values) {
+  for (const auto& constraint : constraints) {
+    if (!constraint->feasible(values)) return;
+  }
+  const double error = graph.error(values);
+  if (error < error_) {
+    error_ = error;
+    values_ = values;
+  }
+}
+
+}  // namespace gtdynamics
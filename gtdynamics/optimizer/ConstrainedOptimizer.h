@@ -14,16 +14,78 @@
 #pragma once
 
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/SolverTelemetry.h>
+#include <gtdynamics/optimizer/SymbolicStructure.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <boost/optional.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+
 namespace gtdynamics {
 
+/**
+ * Cooperative control of a running solve, shared with the thread that runs
+ * it: cancellation, checked with the deadline between LM iterations, and a
+ * progress callback, called with the error after each of them. Parallel
+ * starts and components report to the same control, so the callback may be
+ * called concurrently.
+ */
+class SolveControl {
+ public:
+  using Progress = std::function<void(size_t iteration, double error)>;
+
+ private:
+  std::atomic<bool> cancelled_{false};
+  std::atomic<size_t> iterations_{0};
+  Progress progress_;
+
+ public:
+  /// Constructor, with an optional progress callback.
+  explicit SolveControl(const Progress& progress = nullptr)
+      : progress_(progress) {}
+
+  /// Ask the solve to stop at its next check.
+  void cancel() { cancelled_ = true; }
+
+  /// Return whether the solve was cancelled.
+  bool cancelled() const { return cancelled_; }
+
+  /// Record an iteration with the error after it.
+  void iterated(double error) {
+    const size_t iteration = ++iterations_;
+    if (progress_) progress_(iteration, error);
+  }
+
+  /// Return the number of iterations recorded so far.
+  size_t iterations() const { return iterations_; }
+};
+
 /// Constrained optimization parameters shared between all solvers.
 struct ConstrainedOptimizationParameters {
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
+  double deadline = std::numeric_limits<double>::infinity();  // seconds
+
+  // Symbolic structure shared by all LM solves. If not set, one is created
+  // per problem; set it to carry the structure between re-solves.
+  std::shared_ptr<SymbolicStructure> symbolic_structure;
+
+  // If set, the solve stops when it is cancelled, and reports progress.
+  std::shared_ptr<SolveControl> control;
+
+  // If set, the state of the solve is saved to this file, see
+  // SolveCheckpoint, after every checkpoint_interval outer iterations and
+  // the last one, and a solve resumes from the file when it exists, e.g.,
+  // after the job running it was preempted.
+  std::string checkpoint_path;
+  size_t checkpoint_interval = 1;
 
   /// Constructor.
   ConstrainedOptimizationParameters() {}
@@ -40,6 +102,77 @@ struct ConstrainedOptResult {
       intermediate_values;        // values after each inner loop
   std::vector<int> num_iters;     // number of LM iterations for each inner loop
   std::vector<double> mu_values;  // penalty parameter for each inner loop
+  SolverTelemetry* telemetry = nullptr;  // if set, inner loops record to it
+  bool timed_out = false;                // stopped by the deadline
+};
+
+/**
+ * Wall-clock deadline, a number of seconds after construction, which also
+ * expires when the solve is cancelled through its control, if any.
+ */
+class Deadline {
+ private:
+  using Clock = std::chrono::steady_clock;
+  bool unlimited_;
+  Clock::time_point end_;
+  std::shared_ptr<SolveControl> control_;
+
+ public:
+  /// Constructor, infinite seconds for no deadline.
+  explicit Deadline(double seconds = std::numeric_limits<double>::infinity(),
+                    const std::shared_ptr<SolveControl>& control = nullptr);
+
+  /// Return whether there is neither a deadline nor a control, so that
+  /// solvers need not check between iterations.
+  bool unlimited() const { return unlimited_ && !control_; }
+
+  /// Return whether the deadline has passed or the solve was cancelled.
+  bool expired() const {
+    return (control_ && control_->cancelled()) ||
+           (!unlimited_ && Clock::now() >= end_);
+  }
+
+  /// Report an iteration to the control, if any.
+  void iterated(double error) const {
+    if (control_) control_->iterated(error);
+  }
+
+  /// Return the seconds left, infinite if unlimited, zero if expired.
+  double remaining() const {
+    if (unlimited_) return std::numeric_limits<double>::infinity();
+    const std::chrono::duration<double> left = end_ - Clock::now();
+    return left.count() > 0 ? left.count() : 0.0;
+  }
+};
+
+/**
+ * Run Levenberg-Marquardt until convergence or the deadline, checked after
+ * each iteration. Without deadline, this is LevenbergMarquardtOptimizer.
+ * @param iterations  optional output, number of LM iterations
+ * @param lambda      optional output, final damping
+ * @param structure   optional symbolic structure of the problem
+ */
+gtsam::Values LevenbergMarquardtUntil(
+    const gtsam::NonlinearFactorGraph& graph,
+    const gtsam::Values& initial_values,
+    const gtsam::LevenbergMarquardtParams& params, const Deadline& deadline,
+    size_t* iterations = nullptr, double* lambda = nullptr,
+    const std::shared_ptr<SymbolicStructure>& structure = nullptr);
+
+/// Keeps the iterate with the lowest cost among those satisfying constraints.
+class BestFeasibleIterate {
+ private:
+  boost::optional<gtsam::Values> values_;
+  double error_ = std::numeric_limits<double>::infinity();
+
+ public:
+  /// Keep values if they are feasible and have a lower graph error.
+  void update(const gtsam::NonlinearFactorGraph& graph,
+              const EqualityConstraints& constraints,
+              const gtsam::Values& values);
+
+  /// Return the best feasible iterate, if any.
+  const boost::optional<gtsam::Values>& values() const { return values_; }
 };
 
 /// Base class for constrained optimizer.
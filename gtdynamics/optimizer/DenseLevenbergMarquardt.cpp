@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DenseLevenbergMarquardt.cpp
+ * @brief Levenberg-Marquardt with dense linear solves, for tiny problems.
+ */
+
+#include <gtdynamics/optimizer/DenseLevenbergMarquardt.h>
+#include <gtdynamics/universal_robot/JointKinematicsCache.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <Eigen/Cholesky>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Key;
+using gtsam::Matrix;
+
+/* ************************************************************************* */
+bool DenseSolvable(const gtsam::NonlinearFactorGraph &graph,
+                   const gtsam::Values &values, size_t max_dimension) {
+  size_t dimension = 0;
+  for (Key key : graph.keys()) {
+    if (!values.exists(key)) return false;
+    dimension += values.at(key).dim();
+    if (dimension > max_dimension) return false;
+  }
+  for (const auto &factor : graph) {
+    auto noise_model_factor =
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    if (noise_model_factor && noise_model_factor->noiseModel() &&
+        noise_model_factor->noiseModel()->isConstrained()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+DenseLevenbergMarquardt::DenseLevenbergMarquardt(
+    const gtsam::NonlinearFactorGraph &graph,
+    const gtsam::Values &initial_values,
+    const gtsam::LevenbergMarquardtParams &params)
+    : gtsam::LevenbergMarquardtOptimizer(graph, initial_values, params) {
+  size_t offset = 0;
+  for (Key key : graph.keys()) {
+    const size_t dim = initial_values.at(key).dim();
+    keys_.push_back(key);
+    dims_.push_back(dim);
+    offsets_[key] = offset;
+    offset += dim;
+  }
+  hessian_.resize(offset, offset);
+  gradient_.resize(offset);
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr DenseLevenbergMarquardt::linearize() const {
+  JointKinematicsCache::Scope scope;
+  return gtsam::LevenbergMarquardtOptimizer::linearize();
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues DenseLevenbergMarquardt::solve(
+    const GaussianFactorGraph &graph,
+    const gtsam::NonlinearOptimizerParams & /*params*/) const {
+  // Accumulate the normal equations of each factor, which are those of its
+  // whitened Jacobian, or its own information for Hessian factors.
+  hessian_.setZero();
+  gradient_.setZero();
+  std::vector<size_t> offsets;
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    const Matrix information = factor->augmentedInformation();
+    const size_t last = information.cols() - 1;
+    offsets.clear();
+    size_t row = 0;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      offsets.push_back(row);
+      row += factor->getDim(it);
+    }
+    for (size_t a = 0; a < factor->size(); a++) {
+      const size_t i = offsets_.at(factor->keys()[a]);
+      const size_t d_a = factor->getDim(factor->begin() + a);
+      gradient_.segment(i, d_a) += information.block(offsets[a], last, d_a, 1);
+      for (size_t b = 0; b < factor->size(); b++) {
+        const size_t j = offsets_.at(factor->keys()[b]);
+        const size_t d_b = factor->getDim(factor->begin() + b);
+        hessian_.block(i, j, d_a, d_b) +=
+            information.block(offsets[a], offsets[b], d_a, d_b);
+      }
+    }
+  }
+
+  const Eigen::LLT<Matrix> llt(hessian_);
+  if (llt.info() != Eigen::Success) {
+    throw gtsam::IndeterminantLinearSystemException(keys_.front());
+  }
+  const gtsam::Vector delta = llt.solve(gradient_);
+
+  gtsam::VectorValues result;
+  for (size_t k = 0; k < keys_.size(); k++) {
+    result.insert(keys_[k], delta.segment(offsets_.at(keys_[k]), dims_[k]));
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DenseLevenbergMarquardt.h
+ * @brief Levenberg-Marquardt with dense linear solves, for tiny problems.
+ */
+
+#pragma once
+
+#include <gtsam/base/FastMap.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Return whether a problem can be solved by DenseLevenbergMarquardt within
+ * a dimension: the variables of the graph have at most max_dimension scalars
+ * in total, and no factor has a constrained noise model, whose zero sigmas
+ * the normal equations cannot represent.
+ */
+bool DenseSolvable(const gtsam::NonlinearFactorGraph &graph,
+                   const gtsam::Values &values, size_t max_dimension);
+
+/**
+ * LevenbergMarquardtOptimizer solving its damped systems densely: the normal
+ * equations are accumulated factor by factor into a dense matrix, allocated
+ * once for the problem, and solved by Cholesky. For problems of a few dozen
+ * variables, e.g. the cart-pole or a single manipulator slice, this avoids
+ * the ordering, variable index and Bayes tree of sparse elimination, which
+ * cost more than the arithmetic. The damping schedule is that of gtsam, so
+ * iterates agree with LevenbergMarquardtOptimizer up to round-off.
+ */
+class DenseLevenbergMarquardt : public gtsam::LevenbergMarquardtOptimizer {
+ private:
+  gtsam::KeyVector keys_;           // variables, in column order
+  std::vector<size_t> dims_;        // dimension of each variable
+  gtsam::FastMap<gtsam::Key, size_t> offsets_;  // column of each variable
+  mutable gtsam::Matrix hessian_;   // J^T J of the damped system
+  mutable gtsam::Vector gradient_;  // J^T b of the damped system
+
+ public:
+  /// Constructor, the graph must be DenseSolvable at the initial values.
+  DenseLevenbergMarquardt(const gtsam::NonlinearFactorGraph &graph,
+                          const gtsam::Values &initial_values,
+                          const gtsam::LevenbergMarquardtParams &params =
+                              gtsam::LevenbergMarquardtParams());
+
+  /// Return the dimension of the dense system.
+  size_t dim() const { return gradient_.size(); }
+
+  /// Linearize the graph at the current values, with a joint cache.
+  gtsam::GaussianFactorGraph::shared_ptr linearize() const override;
+
+  /**
+   * Solve a damped system by dense Cholesky. Throws
+   * gtsam::IndeterminantLinearSystemException if it is not positive
+   * definite, which LM handles by increasing the damping.
+   */
+  gtsam::VectorValues solve(
+      const gtsam::GaussianFactorGraph &graph,
+      const gtsam::NonlinearOptimizerParams &params) const override;
+};
+
+}  // namespace gtdynamics
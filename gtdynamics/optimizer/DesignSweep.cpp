@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DesignSweep.cpp
+ * @brief Parallel sweeps of one optimization problem over design parameters.
+ */
+
+#include <gtdynamics/optimizer/DesignSweep.h>
+#include <gtdynamics/optimizer/SymbolicStructure.h>
+#include <gtdynamics/utils/ParallelFor.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+// A shared problem and the symbolic structure of its solves.
+struct CachedProblem {
+  DesignProblem problem;
+  std::shared_ptr<SymbolicStructure> symbolic;
+};
+}  // namespace
+
+/* ************************************************************************* */
+DesignSweep::DesignSweep(const DesignProblemFactory &factory,
+                         const DesignSweepParams &params)
+    : factory_(factory), params_(params) {
+  if (!factory_.build) {
+    throw std::invalid_argument("DesignSweep: the factory needs a builder.");
+  }
+}
+
+/* ************************************************************************* */
+std::vector<DesignSolution> DesignSweep::run(
+    const std::vector<Vector> &designs) const {
+  const size_t n = designs.size();
+  const size_t batch_size = std::max<size_t>(params_.batch_size, 1);
+  std::vector<DesignSolution> solutions(n);
+  std::vector<std::string> structures(n);
+  std::map<std::string, CachedProblem> cache;
+  std::vector<const CachedProblem *> problems(n);
+
+  for (size_t begin = 0; begin < n; begin += batch_size) {
+    const size_t end = std::min(n, begin + batch_size);
+
+    // Build the new structures serially, and pick the warm starts among the
+    // designs of earlier batches.
+    for (size_t d = begin; d < end; d++) {
+      DesignSolution &solution = solutions[d];
+      solution.design = designs[d];
+      structures[d] = factory_.structure ? factory_.structure(designs[d])
+                                         : "#" + std::to_string(d);
+      auto it = cache.find(structures[d]);
+      if (it == cache.end()) {
+        CachedProblem cached{factory_.build(designs[d]),
+                             std::make_shared<SymbolicStructure>()};
+        it = cache.emplace(structures[d], std::move(cached)).first;
+        solution.built = true;
+      }
+      problems[d] = &it->second;
+
+      if (!params_.warm_start) continue;
+      double nearest = std::numeric_limits<double>::infinity();
+      for (size_t s = 0; s < begin; s++) {
+        if (factory_.structure && structures[s] != structures[d]) continue;
+        if (designs[s].size() != designs[d].size()) continue;
+        const double distance = (designs[s] - designs[d]).norm();
+        if (distance < nearest) {
+          nearest = distance;
+          solution.warm_start = s;
+        }
+      }
+    }
+
+    // Solve the batch in parallel.
+    ParallelFor(end - begin, [&](size_t k) {
+      const size_t d = begin + k;
+      DesignSolution &solution = solutions[d];
+      const DesignProblem &problem = problems[d]->problem;
+      gtsam::NonlinearFactorGraph graph = problem.graph;
+      if (factory_.variant) graph.push_back(factory_.variant(designs[d]));
+
+      Values initial_values = problem.initial_values;
+      if (solution.warm_start >= 0) {
+        const Values &start = solutions[solution.warm_start].values;
+        for (auto &&key_value : problem.initial_values) {
+          if (start.exists(key_value.key)) {
+            initial_values.update(key_value.key, start.at(key_value.key));
+          }
+        }
+      }
+
+      OptimizationParameters parameters = params_.optimization;
+      parameters.symbolic_structure = problems[d]->symbolic;
+      const Optimizer optimizer(parameters);
+      solution.values =
+          optimizer.optimize(graph, problem.constraints, initial_values,
+                             nullptr, &solution.status);
+    });
+  }
+  return solutions;
+}
+
+}  // namespace gtdynamics
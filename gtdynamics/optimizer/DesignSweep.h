@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DesignSweep.h
+ * @brief Parallel sweeps of one optimization problem over design parameters.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// An optimization problem, e.g. a trajectory optimization for one design.
+struct DesignProblem {
+  gtsam::NonlinearFactorGraph graph;
+  EqualityConstraints constraints;
+  gtsam::Values initial_values;
+};
+
+/**
+ * Builds the problem of a design vector, e.g. link lengths or spring
+ * constants. Designs with the same structure key share one problem, built
+ * once from the first of them, to which the variant factors of each design
+ * are appended, e.g. priors on the inertial parameters of a graph built with
+ * OptimizerSetting::inertial_variables. Without a structure function every
+ * design is built on its own.
+ */
+struct DesignProblemFactory {
+  /// Build the problem of a design, or the shared part of its structure.
+  std::function<DesignProblem(const gtsam::Vector &)> build;
+
+  /// Return a key that is equal for designs with the same shared problem.
+  std::function<std::string(const gtsam::Vector &)> structure;
+
+  /// Return the factors of a design that are not in the shared problem.
+  std::function<gtsam::NonlinearFactorGraph(const gtsam::Vector &)> variant;
+};
+
+/// Parameters of DesignSweep.
+struct DesignSweepParams {
+  OptimizationParameters optimization;  ///< parameters of every solve
+
+  /// Start each design from the solution of the nearest solved design with
+  /// the same structure.
+  bool warm_start = true;
+
+  /// Designs solved concurrently. Designs warm-start from those of earlier
+  /// batches, so the results do not depend on the scheduling.
+  size_t batch_size = 8;
+
+  DesignSweepParams() {}
+};
+
+/// The solution of one design.
+struct DesignSolution {
+  gtsam::Vector design;
+  gtsam::Values values;
+  OptimizationStatus status;
+  int warm_start = -1;  ///< index of the design started from, -1 if none
+  bool built = false;   ///< whether the shared problem was built for it
+};
+
+/**
+ * DesignSweep solves the same optimization problem for many designs, in
+ * batches solved in parallel. Problems are cached by structure, with one
+ * symbolic structure each, so that designs differing only in the values of
+ * factors share the graph, its elimination ordering and its variable index.
+ *
+ * Each design warm-starts from the solution of the nearest design, in
+ * Euclidean distance, with the same structure in an earlier batch. Variables
+ * it lacks are taken from the initial values of the problem.
+ */
+class DesignSweep {
+ private:
+  DesignProblemFactory factory_;
+  DesignSweepParams params_;
+
+ public:
+  /**
+   * Constructor
+   * @param factory  builds the problem of each design
+   * @param params   parameters
+   */
+  DesignSweep(const DesignProblemFactory &factory,
+              const DesignSweepParams &params = DesignSweepParams());
+
+  /// Solve all designs, and return their solutions in the same order.
+  std::vector<DesignSolution> run(
+      const std::vector<gtsam::Vector> &designs) const;
+};
+
+}  // namespace gtdynamics
@@ -14,6 +14,10 @@
 #pragma once
 
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/utils/ParallelFor.h>
+
+#include <algorithm>
+#include <set>
 
 namespace gtdynamics {
 
@@ -26,7 +30,25 @@ gtsam::NoiseModelFactor::shared_ptr VectorExpressionEquality<P>::createFactor(
     measure = -*bias;
   }
   return gtsam::NoiseModelFactor::shared_ptr(
-      new gtsam::ExpressionFactor<VectorP>(noise, measure, expression_));
+      new PenaltyFactor<VectorP>(noise, mu, measure, expression_));
+}
+
+template <int P>
+bool VectorExpressionEquality<P>::updateFactor(
+    gtsam::NonlinearFactor& factor, const double mu,
+    boost::optional<gtsam::Vector&> bias) const {
+  auto penalty = dynamic_cast<PenaltyFactor<VectorP>*>(&factor);
+  if (!penalty) return false;
+  if (penalty->mu() != mu) {
+    penalty->setPenalty(
+        mu, gtsam::noiseModel::Diagonal::Sigmas(tolerance_ / sqrt(mu)));
+  }
+  if (bias) {
+    penalty->setMeasured(-*bias);
+  } else {
+    penalty->setMeasured(VectorP::Zero());
+  }
+  return true;
 }
 
 template <int P>
@@ -63,4 +85,115 @@ size_t VectorExpressionEquality<P>::dim() const {
   return P;
 }
 
+template <int P>
+StackedExpressions<P>::StackedExpressions(
+    const std::vector<gtsam::Expression<VectorP>>& expressions)
+    : expressions_(expressions) {
+  std::set<gtsam::Key> all_keys;
+  for (const auto& expression : expressions_) {
+    const std::set<gtsam::Key> keys = expression.keys();
+    all_keys.insert(keys.begin(), keys.end());
+  }
+  keys_.assign(all_keys.begin(), all_keys.end());
+
+  // Expression::value gives the Jacobians in the order of its sorted keys.
+  slots_.reserve(expressions_.size());
+  for (const auto& expression : expressions_) {
+    std::vector<size_t> slots;
+    for (gtsam::Key key : expression.keys()) {
+      slots.push_back(std::lower_bound(keys_.begin(), keys_.end(), key) -
+                      keys_.begin());
+    }
+    slots_.push_back(slots);
+  }
+}
+
+template <int P>
+gtsam::Vector StackedExpressions<P>::value(
+    const gtsam::Values& x, bool parallel,
+    std::vector<gtsam::Matrix>* H) const {
+  const size_t n = expressions_.size();
+  gtsam::Vector result(P * n);
+  if (H) {
+    H->resize(keys_.size());
+    for (size_t j = 0; j < keys_.size(); j++) {
+      (*H)[j] = gtsam::Matrix::Zero(P * n, x.at(keys_[j]).dim());
+    }
+  }
+
+  // Each expression writes its own rows.
+  auto evaluate = [&](size_t i) {
+    const auto& expression = expressions_[i];
+    if (!H) {
+      result.template segment<P>(P * i) = expression.value(x);
+      return;
+    }
+    std::vector<gtsam::Matrix> H_i(slots_[i].size());
+    result.template segment<P>(P * i) = expression.value(x, H_i);
+    for (size_t k = 0; k < H_i.size(); k++) {
+      (*H)[slots_[i][k]].middleRows(P * i, P) = H_i[k];
+    }
+  };
+  if (parallel) {
+    ParallelFor(n, evaluate);
+  } else {
+    for (size_t i = 0; i < n; i++) evaluate(i);
+  }
+  return result;
+}
+
+template <int P>
+StackedVectorEquality<P>::StackedVectorEquality(
+    const std::vector<gtsam::Expression<VectorP>>& expressions,
+    const VectorP& tolerance, bool parallel)
+    : expressions_(boost::make_shared<const StackedExpressions<P>>(
+          expressions)),
+      tolerance_(tolerance.replicate(expressions.size(), 1)),
+      parallel_(parallel) {}
+
+template <int P>
+gtsam::NoiseModelFactor::shared_ptr StackedVectorEquality<P>::createFactor(
+    const double mu, boost::optional<gtsam::Vector&> bias) const {
+  auto noise = gtsam::noiseModel::Diagonal::Sigmas(tolerance_ / sqrt(mu));
+  const gtsam::Vector measured = bias ? gtsam::Vector(-*bias)
+                                      : gtsam::Vector::Zero(dim());
+  return gtsam::NoiseModelFactor::shared_ptr(new StackedPenaltyFactor<P>(
+      noise, mu, measured, expressions_, parallel_));
+}
+
+template <int P>
+bool StackedVectorEquality<P>::updateFactor(
+    gtsam::NonlinearFactor& factor, const double mu,
+    boost::optional<gtsam::Vector&> bias) const {
+  auto penalty = dynamic_cast<StackedPenaltyFactor<P>*>(&factor);
+  if (!penalty || penalty->dim() != dim()) return false;
+  if (penalty->mu() != mu) {
+    penalty->setPenalty(
+        mu, gtsam::noiseModel::Diagonal::Sigmas(tolerance_ / sqrt(mu)));
+  }
+  if (bias) {
+    penalty->setMeasured(-*bias);
+  } else {
+    penalty->setMeasured(gtsam::Vector::Zero(dim()));
+  }
+  return true;
+}
+
+template <int P>
+bool StackedVectorEquality<P>::feasible(const gtsam::Values& x) const {
+  return toleranceScaledViolation(x).template lpNorm<Eigen::Infinity>() <= 1;
+}
+
+template <int P>
+gtsam::Vector StackedVectorEquality<P>::operator()(
+    const gtsam::Values& x) const {
+  return expressions_->value(x, parallel_);
+}
+
+template <int P>
+gtsam::Vector StackedVectorEquality<P>::toleranceScaledViolation(
+    const gtsam::Values& x) const {
+  return scaleViolation((*this)(x));
+}
+
 }  // namespace gtdynamics
@@ -12,6 +12,10 @@
  */
 
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/Profiler.h>
+
+#include <stdexcept>
 
 namespace gtdynamics {
 
@@ -23,7 +27,20 @@ gtsam::NoiseModelFactor::shared_ptr DoubleExpressionEquality::createFactor(
     measure = -(*bias)(0);
   }
   return gtsam::NoiseModelFactor::shared_ptr(
-      new gtsam::ExpressionFactor<double>(noise, measure, expression_));
+      new PenaltyFactor<double>(noise, mu, measure, expression_));
+}
+
+bool DoubleExpressionEquality::updateFactor(
+    gtsam::NonlinearFactor& factor, const double mu,
+    boost::optional<gtsam::Vector&> bias) const {
+  auto penalty = dynamic_cast<PenaltyFactor<double>*>(&factor);
+  if (!penalty) return false;
+  if (penalty->mu() != mu) {
+    penalty->setPenalty(
+        mu, gtsam::noiseModel::Isotropic::Sigma(1, tolerance_ / sqrt(mu)));
+  }
+  penalty->setMeasured(bias ? -(*bias)(0) : 0.0);
+  return true;
 }
 
 bool DoubleExpressionEquality::feasible(const gtsam::Values& x) const {
@@ -43,4 +60,94 @@ gtsam::Vector DoubleExpressionEquality::toleranceScaledViolation(
   return (gtsam::Vector(1) << result / tolerance_).finished();
 }
 
+FactorEquality::FactorEquality(
+    const gtsam::NoiseModelFactor::shared_ptr& factor)
+    : factor_(factor) {
+  auto diagonal = boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+      factor->noiseModel());
+  if (!diagonal) {
+    throw std::invalid_argument(
+        "FactorEquality: the factor must have a diagonal noise model.");
+  }
+  tolerance_ = diagonal->sigmas();
+  auto constrained =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Constrained>(diagonal);
+  for (int i = 0; i < tolerance_.size(); i++) {
+    if (tolerance_(i) == 0) {
+      tolerance_(i) = constrained ? 1 / sqrt(constrained->mu()(i)) : 1;
+    }
+  }
+}
+
+gtsam::NoiseModelFactor::shared_ptr FactorEquality::createFactor(
+    const double mu, boost::optional<gtsam::Vector&> bias) const {
+  auto noise = gtsam::noiseModel::Diagonal::Sigmas(tolerance_ / sqrt(mu));
+  const gtsam::Vector b = bias ? *bias : gtsam::Vector::Zero(dim());
+  return gtsam::NoiseModelFactor::shared_ptr(
+      new BiasedFactor(noise, mu, b, factor_));
+}
+
+bool FactorEquality::updateFactor(gtsam::NonlinearFactor& factor,
+                                  const double mu,
+                                  boost::optional<gtsam::Vector&> bias) const {
+  auto penalty = dynamic_cast<BiasedFactor*>(&factor);
+  if (!penalty) return false;
+  if (penalty->mu() != mu) {
+    penalty->setPenalty(
+        mu, gtsam::noiseModel::Diagonal::Sigmas(tolerance_ / sqrt(mu)));
+  }
+  penalty->setBias(bias ? *bias : gtsam::Vector::Zero(dim()));
+  return true;
+}
+
+bool FactorEquality::feasible(const gtsam::Values& x) const {
+  return toleranceScaledViolation(x).lpNorm<Eigen::Infinity>() <= 1;
+}
+
+gtsam::Vector FactorEquality::operator()(const gtsam::Values& x) const {
+  return factor_->unwhitenedError(x);
+}
+
+gtsam::Vector FactorEquality::toleranceScaledViolation(
+    const gtsam::Values& x) const {
+  return scaleViolation((*this)(x));
+}
+
+EqualityConstraints HardConstraints(const gtsam::NonlinearFactorGraph& graph,
+                                    double max_sigma,
+                                    gtsam::NonlinearFactorGraph* soft) {
+  EqualityConstraints hard;
+  for (const auto& factor : graph) {
+    auto noise_factor =
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    gtsam::noiseModel::Diagonal::shared_ptr diagonal;
+    if (noise_factor) {
+      diagonal = boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(
+          noise_factor->noiseModel());
+    }
+    if (diagonal && (diagonal->isConstrained() ||
+                     diagonal->sigmas().maxCoeff() <= max_sigma)) {
+      hard.emplace_shared<FactorEquality>(noise_factor);
+    } else {
+      soft->push_back(factor);
+    }
+  }
+  return hard;
+}
+
+ConstraintViolations EqualityConstraints::evaluate(
+    const gtsam::Values& x) const {
+  GTD_PROFILE_SCOPE("EqualityConstraints::evaluate");
+  GTD_PROFILE_COUNT("EqualityConstraints::evaluate constraints", size());
+  ConstraintViolations result;
+  result.violations.resize(size());
+  result.scaled.resize(size());
+  ParallelFor(size(), [&](size_t i) {
+    const auto& constraint = at(i);
+    result.violations[i] = (*constraint)(x);
+    result.scaled[i] = constraint->scaleViolation(result.violations[i]);
+  });
+  return result;
+}
+
 }  // namespace gtdynamics
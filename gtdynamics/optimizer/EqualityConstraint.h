@@ -13,11 +13,56 @@
 
 #pragma once
 
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
 #include <gtsam/nonlinear/ExpressionFactor.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
 namespace gtdynamics {
 
+/**
+ * Penalty factor 1/2 mu||g(x)-measured||_Diag(tolerance^2)^2 of an equality
+ * constraint, whose penalty parameter and measurement can be updated without
+ * copying the expression g.
+ */
+template <typename T>
+class PenaltyFactor : public CompiledExpressionFactor<T> {
+ private:
+  using This = PenaltyFactor<T>;
+  using Base = CompiledExpressionFactor<T>;
+
+  double mu_;  ///< Penalty parameter the noise model was made for.
+
+ public:
+  /**
+   * Constructor.
+   * @param noise_model  noise model with sigmas tolerance/sqrt(mu)
+   * @param mu           penalty parameter
+   * @param measurement  measurement, -bias
+   * @param expression   expression representing g(x)
+   */
+  PenaltyFactor(const gtsam::SharedNoiseModel& noise_model, double mu,
+                const T& measurement, const gtsam::Expression<T>& expression)
+      : Base(noise_model, measurement, expression), mu_(mu) {}
+
+  /// Return the penalty parameter.
+  double mu() const { return mu_; }
+
+  /// Set the penalty parameter and the noise model made for it.
+  void setPenalty(double mu, const gtsam::SharedNoiseModel& noise_model) {
+    mu_ = mu;
+    this->noiseModel_ = noise_model;
+  }
+
+  /// Set the measurement, i.e., minus the bias.
+  void setMeasured(const T& measurement) { this->measured_ = measurement; }
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return gtsam::NonlinearFactor::shared_ptr(new This(*this));
+  }
+};
+
 /**
  * Equality constraint base class.
  */
@@ -43,6 +88,23 @@ class EqualityConstraint {
       const double mu,
       boost::optional<gtsam::Vector&> bias = boost::none) const = 0;
 
+  /**
+   * @brief Update a factor made by createFactor of this constraint to
+   * another penalty parameter and bias, in place, so that optimizers can
+   * keep their merit graphs across outer iterations. The factor must not be
+   * in use elsewhere, e.g. by a running optimizer.
+   *
+   * @param factor factor returned by createFactor.
+   * @param mu penalty parameter.
+   * @param bias additional bias.
+   * @return false if the factor cannot be updated and should be created anew.
+   */
+  virtual bool updateFactor(
+      gtsam::NonlinearFactor& factor, const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const {
+    return false;
+  }
+
   /**
    * @brief Check if constraint violation is within tolerance.
    *
@@ -63,6 +125,10 @@ class EqualityConstraint {
   virtual gtsam::Vector toleranceScaledViolation(
       const gtsam::Values& x) const = 0;
 
+  /** @brief Scale a violation g(x) by tolerance, e.g. g(x)/tolerance. */
+  virtual gtsam::Vector scaleViolation(
+      const gtsam::Vector& violation) const = 0;
+
   /** @brief return the dimension of the constraint. */
   virtual size_t dim() const = 0;
 };
@@ -90,12 +156,20 @@ class DoubleExpressionEquality : public EqualityConstraint {
       const double mu,
       boost::optional<gtsam::Vector&> bias = boost::none) const override;
 
+  bool updateFactor(
+      gtsam::NonlinearFactor& factor, const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
   bool feasible(const gtsam::Values& x) const override;
 
   gtsam::Vector operator()(const gtsam::Values& x) const override;
 
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
+  gtsam::Vector scaleViolation(const gtsam::Vector& violation) const override {
+    return violation / tolerance_;
+  }
+
   size_t dim() const override { return 1; }
 };
 
@@ -125,15 +199,282 @@ class VectorExpressionEquality : public EqualityConstraint {
       const double mu,
       boost::optional<gtsam::Vector&> bias = boost::none) const override;
 
+  bool updateFactor(
+      gtsam::NonlinearFactor& factor, const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
   bool feasible(const gtsam::Values& x) const override;
 
   gtsam::Vector operator()(const gtsam::Values& x) const override;
 
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
+  gtsam::Vector scaleViolation(const gtsam::Vector& violation) const override {
+    return violation.cwiseQuotient(tolerance_);
+  }
+
   size_t dim() const override;
 };
 
+/**
+ * Many same-shaped vector expressions g_i(x) in P dimensions, stored
+ * contiguously with the keys of all of them, and evaluated stacked.
+ */
+template <int P>
+class StackedExpressions {
+ public:
+  using VectorP = Eigen::Matrix<double, P, 1>;
+
+ private:
+  std::vector<gtsam::Expression<VectorP>> expressions_;
+  gtsam::KeyVector keys_;  ///< sorted keys of all expressions
+  std::vector<std::vector<size_t>> slots_;  ///< index in keys_ of each key
+
+ public:
+  /// Constructor, from the expressions g_i.
+  explicit StackedExpressions(
+      const std::vector<gtsam::Expression<VectorP>>& expressions);
+
+  /// Return the number of expressions.
+  size_t size() const { return expressions_.size(); }
+
+  /// Return the sorted keys of all expressions.
+  const gtsam::KeyVector& keys() const { return keys_; }
+
+  /**
+   * Evaluate [g_1(x); ...; g_n(x)], concurrently over the expressions when
+   * parallel is set, as ParallelFor.
+   * @param x         values of all keys.
+   * @param parallel  whether to evaluate the expressions concurrently.
+   * @param H         (optional) Jacobians, one per key of keys().
+   */
+  gtsam::Vector value(const gtsam::Values& x, bool parallel,
+                      std::vector<gtsam::Matrix>* H = nullptr) const;
+};
+
+/**
+ * Penalty factor 1/2 mu||G(x)-measured||_Diag(tolerance^2)^2 of a
+ * StackedVectorEquality, with G(x) the stacked expressions: one block
+ * factor on the keys of all of them.
+ */
+template <int P>
+class StackedPenaltyFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = StackedPenaltyFactor<P>;
+  boost::shared_ptr<const StackedExpressions<P>> expressions_;
+  gtsam::Vector measured_;
+  double mu_;
+  bool parallel_;
+
+ public:
+  /**
+   * Constructor.
+   * @param noise_model  noise model with sigmas tolerance/sqrt(mu)
+   * @param mu           penalty parameter
+   * @param measured     measurement, -bias
+   * @param expressions  the stacked expressions, shared with the constraint
+   * @param parallel     whether to evaluate the expressions concurrently
+   */
+  StackedPenaltyFactor(
+      const gtsam::SharedNoiseModel& noise_model, double mu,
+      const gtsam::Vector& measured,
+      const boost::shared_ptr<const StackedExpressions<P>>& expressions,
+      bool parallel)
+      : gtsam::NoiseModelFactor(noise_model, expressions->keys()),
+        expressions_(expressions),
+        measured_(measured),
+        mu_(mu),
+        parallel_(parallel) {}
+
+  /// Return the penalty parameter.
+  double mu() const { return mu_; }
+
+  /// Set the penalty parameter and the noise model made for it.
+  void setPenalty(double mu, const gtsam::SharedNoiseModel& noise_model) {
+    mu_ = mu;
+    this->noiseModel_ = noise_model;
+  }
+
+  /// Set the measurement, i.e., minus the bias.
+  void setMeasured(const gtsam::Vector& measured) { measured_ = measured; }
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values& x,
+      boost::optional<std::vector<gtsam::Matrix>&> H =
+          boost::none) const override {
+    return expressions_->value(x, parallel_, H ? &*H : nullptr) - measured_;
+  }
+
+  /// @return a deep copy of this factor, sharing the expressions
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return gtsam::NonlinearFactor::shared_ptr(new This(*this));
+  }
+};
+
+/**
+ * Equality constraints [g_1(x); ...; g_n(x)] = 0 on many same-shaped vector
+ * expressions, e.g., the pose constraints of all joints of a slice, as one
+ * constraint: violations are evaluated in one batch, optionally in
+ * parallel, and createFactor makes a single block factor. This saves n - 1
+ * virtual calls per evaluation and n - 1 factors in merit graphs, at the
+ * price of one dense block in elimination over the keys of all g_i.
+ */
+template <int P>
+class StackedVectorEquality : public EqualityConstraint {
+ public:
+  using VectorP = Eigen::Matrix<double, P, 1>;
+
+ protected:
+  boost::shared_ptr<const StackedExpressions<P>> expressions_;
+  gtsam::Vector tolerance_;  ///< stacked tolerances, P per expression
+  bool parallel_;
+
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param expressions  expressions representing g_i(x).
+   * @param tolerance    tolerance in each dimension, the same for all g_i.
+   * @param parallel     whether to evaluate the g_i concurrently.
+   */
+  StackedVectorEquality(
+      const std::vector<gtsam::Expression<VectorP>>& expressions,
+      const VectorP& tolerance, bool parallel = true);
+
+  /// Return the number of stacked expressions.
+  size_t size() const { return expressions_->size(); }
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool updateFactor(
+      gtsam::NonlinearFactor& factor, const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool feasible(const gtsam::Values& x) const override;
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override;
+
+  gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
+
+  gtsam::Vector scaleViolation(const gtsam::Vector& violation) const override {
+    return violation.cwiseQuotient(tolerance_);
+  }
+
+  size_t dim() const override { return tolerance_.size(); }
+};
+
+/**
+ * Penalty factor 1/2 mu||h(x)+bias||_Diag(tolerance^2)^2 of a FactorEquality,
+ * where h(x) is the unwhitened error of the wrapped factor.
+ */
+class BiasedFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = BiasedFactor;
+  gtsam::NoiseModelFactor::shared_ptr factor_;
+  gtsam::Vector bias_;
+  double mu_;
+
+ public:
+  /**
+   * Constructor
+   * @param noise_model  noise model with sigmas tolerance/sqrt(mu)
+   * @param mu           penalty parameter
+   * @param bias         added to the error of factor
+   * @param factor       the factor whose unwhitened error is constrained
+   */
+  BiasedFactor(const gtsam::SharedNoiseModel& noise_model, double mu,
+               const gtsam::Vector& bias,
+               const gtsam::NoiseModelFactor::shared_ptr& factor)
+      : gtsam::NoiseModelFactor(noise_model, factor->keys()),
+        factor_(factor),
+        bias_(bias),
+        mu_(mu) {}
+
+  /// Return the penalty parameter.
+  double mu() const { return mu_; }
+
+  /// Set the penalty parameter and the matching noise model.
+  void setPenalty(double mu, const gtsam::SharedNoiseModel& noise_model) {
+    mu_ = mu;
+    this->noiseModel_ = noise_model;
+  }
+
+  /// Set the bias.
+  void setBias(const gtsam::Vector& bias) { bias_ = bias; }
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values& x,
+      boost::optional<std::vector<gtsam::Matrix>&> H =
+          boost::none) const override {
+    return factor_->unwhitenedError(x, H) + bias_;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return gtsam::NonlinearFactor::shared_ptr(new This(*this));
+  }
+};
+
+/**
+ * Equality constraint h(x) = 0 on the unwhitened error of a factor with a
+ * diagonal noise model, whose sigmas are the tolerances. Zero sigmas of a
+ * Constrained model get tolerance 1/sqrt(mu), so that createFactor(1.0) has
+ * the same error as the factor.
+ */
+class FactorEquality : public EqualityConstraint {
+ protected:
+  gtsam::NoiseModelFactor::shared_ptr factor_;
+  gtsam::Vector tolerance_;
+
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param factor  factor with a diagonal noise model.
+   */
+  explicit FactorEquality(const gtsam::NoiseModelFactor::shared_ptr& factor);
+
+  /// Return the constrained factor.
+  const gtsam::NoiseModelFactor::shared_ptr& factor() const { return factor_; }
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool updateFactor(
+      gtsam::NonlinearFactor& factor, const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool feasible(const gtsam::Values& x) const override;
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override;
+
+  gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
+
+  gtsam::Vector scaleViolation(const gtsam::Vector& violation) const override {
+    return violation.cwiseQuotient(tolerance_);
+  }
+
+  size_t dim() const override { return tolerance_.size(); }
+};
+
+/**
+ * Violations of a set of constraints at one iterate, so they can be kept and
+ * reused instead of evaluating the constraints again.
+ */
+struct ConstraintViolations {
+  std::vector<gtsam::Vector> violations;  ///< g(x) of each constraint
+  std::vector<gtsam::Vector> scaled;      ///< g(x)/tolerance of each
+
+  /// Return the sum of squared tolerance-scaled violations.
+  double squaredNorm() const {
+    double result = 0;
+    for (const auto& v : scaled) result += v.squaredNorm();
+    return result;
+  }
+};
+
 /// Container of EqualityConstraint.
 class EqualityConstraints : public std::vector<EqualityConstraint::shared_ptr> {
  private:
@@ -151,6 +492,13 @@ class EqualityConstraints : public std::vector<EqualityConstraint::shared_ptr> {
     insert(end(), other.begin(), other.end());
   }
 
+  /**
+   * Evaluate all constraints at x, in parallel, each one once.
+   * @param x values to evaluate the constraints at.
+   * @return violations and scaled violations, in constraint order.
+   */
+  ConstraintViolations evaluate(const gtsam::Values& x) const;
+
   /// Emplace a shared pointer to constraint of given type.
   template <class DERIVEDCONSTRAINT, class... Args>
   IsDerived<DERIVEDCONSTRAINT> emplace_shared(Args&&... args) {
@@ -161,6 +509,21 @@ class EqualityConstraints : public std::vector<EqualityConstraint::shared_ptr> {
 
 };
 
+/**
+ * Split off the factors of a graph that emulate hard constraints with stiff
+ * noise models: factors with a Constrained model, or a diagonal one whose
+ * sigmas are all at most max_sigma, become FactorEquality constraints, so
+ * that constrained optimizers, e.g., SQPOptimizer, can eliminate them exactly
+ * instead of weighting them.
+ * @param graph      the factor graph
+ * @param max_sigma  largest sigma of a hard constraint
+ * @param soft       (output) the remaining factors, in their order
+ * @return the hard constraints, in the order of their factors
+ */
+EqualityConstraints HardConstraints(const gtsam::NonlinearFactorGraph& graph,
+                                    double max_sigma,
+                                    gtsam::NonlinearFactorGraph* soft);
+
 }  // namespace gtdynamics
 
 #include <gtdynamics/optimizer/EqualityConstraint-inl.h>
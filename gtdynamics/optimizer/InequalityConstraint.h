@@ -0,0 +1,225 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InequalityConstraint.h
+ * @brief Inequality constraints g(x) >= 0 and their barrier factors.
+ */
+
+#pragma once
+
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/Expression.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <cmath>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+namespace internal {
+/// Return a constraint value as a vector.
+inline gtsam::Vector AsVector(double g) { return gtsam::Vector1(g); }
+template <typename DERIVED>
+gtsam::Vector AsVector(const Eigen::MatrixBase<DERIVED>& g) {
+  return g;
+}
+}  // namespace internal
+
+/**
+ * Barrier factor with error mu * sum_i log(1 + 1/g_i(x)), which is positive,
+ * infinite on the boundary g_i(x) = 0 and outside, and vanishes as g_i(x)
+ * grows. It linearizes to the Gauss-Newton model of the barrier in each g_i,
+ * exact in the gradient.
+ */
+template <typename T>
+class BarrierFactor : public gtsam::NonlinearFactor {
+ private:
+  using Base = gtsam::NonlinearFactor;
+  gtsam::Expression<T> expression_;
+  double mu_;
+
+  static gtsam::KeyVector Keys(const gtsam::Expression<T>& expression) {
+    const std::set<gtsam::Key> keys = expression.keys();
+    return gtsam::KeyVector(keys.begin(), keys.end());
+  }
+
+ public:
+  /**
+   * Constructor
+   * @param expression  expression representing g(x).
+   * @param mu          barrier parameter.
+   */
+  BarrierFactor(const gtsam::Expression<T>& expression, double mu)
+      : Base(Keys(expression)),
+        expression_(expression),
+        mu_(mu) {}
+
+  double error(const gtsam::Values& x) const override {
+    const gtsam::Vector g = internal::AsVector(expression_.value(x));
+    double result = 0;
+    for (int i = 0; i < g.size(); i++) {
+      if (g(i) <= 0) return std::numeric_limits<double>::infinity();
+      result += mu_ * std::log1p(1 / g(i));
+    }
+    return result;
+  }
+
+  size_t dim() const override { return gtsam::traits<T>::dimension; }
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values& x) const override {
+    std::vector<gtsam::Matrix> H(size());
+    const gtsam::Vector g = internal::AsVector(expression_.value(x, H));
+
+    // Row i is sqrt(h_i) dg_i, with h_i the second derivative of the barrier
+    // in g_i, and the right-hand side matches the barrier gradient.
+    const int n = g.size();
+    gtsam::Vector w(n), b(n);
+    for (int i = 0; i < n; i++) {
+      if (g(i) <= 0) {
+        throw std::runtime_error("BarrierFactor: linearized when infeasible.");
+      }
+      const double h =
+          mu_ * (1 / (g(i) * g(i)) - 1 / ((g(i) + 1) * (g(i) + 1)));
+      w(i) = std::sqrt(h);
+      b(i) = mu_ / (g(i) * (g(i) + 1)) / w(i);
+    }
+    std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+    for (size_t j = 0; j < size(); j++) {
+      terms.emplace_back(keys()[j], w.asDiagonal() * H[j]);
+    }
+    return boost::make_shared<gtsam::JacobianFactor>(terms, b);
+  }
+};
+
+/**
+ * Inequality constraint base class, for constraints g(x) >= 0.
+ */
+class InequalityConstraint {
+ public:
+  typedef InequalityConstraint This;
+  typedef boost::shared_ptr<This> shared_ptr;
+
+  /** Default constructor. */
+  InequalityConstraint() {}
+
+  /** Destructor. */
+  virtual ~InequalityConstraint() {}
+
+  /**
+   * @brief Create a barrier factor for the constraint.
+   *
+   * @param mu barrier parameter.
+   * @return a BarrierFactor with error mu * sum_i log(1 + 1/g_i(x)).
+   */
+  virtual gtsam::NonlinearFactor::shared_ptr createBarrierFactor(
+      const double mu) const = 0;
+
+  /**
+   * @brief Check if the constraint is strictly satisfied, g(x) > 0.
+   *
+   * @param x values to evalute constraint at.
+   * @return bool representing if is strictly feasible.
+   */
+  virtual bool feasible(const gtsam::Values& x) const = 0;
+
+  /**
+   * @brief Evaluate the constraint function, g(x).
+   *
+   * @param x values to evalute constraint at.
+   * @return a vector with g(x) in each dimension.
+   */
+  virtual gtsam::Vector operator()(const gtsam::Values& x) const = 0;
+
+  /** @brief return the dimension of the constraint. */
+  virtual size_t dim() const = 0;
+};
+
+/**
+ * Inequality constraint g(x) >= 0, where g(x) is a scalar or vector-valued
+ * expression, component-wise for vectors.
+ */
+template <typename T>
+class ExpressionInequality : public InequalityConstraint {
+ protected:
+  gtsam::Expression<T> expression_;
+
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param expression  expression representing g(x).
+   */
+  explicit ExpressionInequality(const gtsam::Expression<T>& expression)
+      : expression_(expression) {}
+
+  gtsam::NonlinearFactor::shared_ptr createBarrierFactor(
+      const double mu) const override {
+    return boost::make_shared<BarrierFactor<T>>(expression_, mu);
+  }
+
+  bool feasible(const gtsam::Values& x) const override {
+    return (*this)(x).minCoeff() > 0;
+  }
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override {
+    return internal::AsVector(expression_.value(x));
+  }
+
+  size_t dim() const override { return gtsam::traits<T>::dimension; }
+};
+
+/// Scalar inequality constraint g(x) >= 0.
+using DoubleExpressionInequality = ExpressionInequality<double>;
+
+/// Vector inequality constraint g(x) >= 0, component-wise.
+template <int P>
+using VectorExpressionInequality =
+    ExpressionInequality<Eigen::Matrix<double, P, 1>>;
+
+/// Container of InequalityConstraint.
+class InequalityConstraints
+    : public std::vector<InequalityConstraint::shared_ptr> {
+ private:
+  using Base = std::vector<InequalityConstraint::shared_ptr>;
+
+  template <typename DERIVEDCONSTRAINT>
+  using IsDerived = typename std::enable_if<
+      std::is_base_of<InequalityConstraint, DERIVEDCONSTRAINT>::value>::type;
+
+ public:
+  InequalityConstraints() : Base() {}
+
+  /// Add a set of inequality constraints.
+  void add(const InequalityConstraints& other) {
+    insert(end(), other.begin(), other.end());
+  }
+
+  /// Emplace a shared pointer to constraint of given type.
+  template <class DERIVEDCONSTRAINT, class... Args>
+  IsDerived<DERIVEDCONSTRAINT> emplace_shared(Args&&... args) {
+    push_back(boost::allocate_shared<DERIVEDCONSTRAINT>(
+        Eigen::aligned_allocator<DERIVEDCONSTRAINT>(),
+        std::forward<Args>(args)...));
+  }
+
+  /// Return whether all constraints are strictly satisfied.
+  bool feasible(const gtsam::Values& x) const {
+    for (const auto& constraint : *this) {
+      if (!constraint->feasible(x)) return false;
+    }
+    return true;
+  }
+};
+
+}  // namespace gtdynamics
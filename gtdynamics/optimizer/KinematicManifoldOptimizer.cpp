@@ -0,0 +1,256 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicManifoldOptimizer.cpp
+ * @brief Optimization on the kinematic constraint manifold of a robot.
+ */
+
+#include <gtdynamics/optimizer/KinematicManifoldOptimizer.h>
+#include <gtdynamics/utils/ParallelLinearize.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearOptimizer.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+
+/* ************************************************************************* */
+KinematicManifoldOptimizer::KinematicManifoldOptimizer(
+    const Robot& robot, size_t k, const boost::optional<std::string>& base_name,
+    const KinematicManifoldParameters& parameters)
+    : robot_(robot), k_(k), p_(parameters) {
+  if (base_name) {
+    root_ = robot_.link(*base_name);
+  } else {
+    // Use the last fixed link, as Robot::forwardKinematics does.
+    for (auto&& link : robot_.links()) {
+      if (robot_.isFixed(link)) root_ = link;
+    }
+    if (!root_) {
+      throw std::invalid_argument(
+          "KinematicManifoldOptimizer: no base link given and no fixed link.");
+    }
+  }
+  root_free_ = !robot_.isFixed(root_);
+}
+
+/* ************************************************************************* */
+bool KinematicManifoldOptimizer::isEliminated(Key key) const {
+  const DynamicsSymbol symbol(key);
+  return symbol.linkIdx() != DynamicsSymbol::kNoIndex &&
+         symbol.label() == "p" && symbol.time() == k_ &&
+         !(root_free_ && symbol.linkIdx() == root_->id());
+}
+
+/* ************************************************************************* */
+Values KinematicManifoldOptimizer::reduce(const Values& values) const {
+  Values reduced;
+  for (const auto& key_value : values) {
+    if (!isEliminated(key_value.key)) {
+      reduced.insert(key_value.key, key_value.value);
+    }
+  }
+  for (auto&& joint : robot_.joints()) {
+    const Key key = JointAngleKey(joint->id(), k_);
+    if (!reduced.exists(key)) reduced.insert(key, 0.0);
+  }
+  const Key root_key = PoseKey(root_->id(), k_);
+  if (root_free_ && !reduced.exists(root_key)) {
+    reduced.insert(root_key, root_->bMcom());
+  }
+  return reduced;
+}
+
+/* ************************************************************************* */
+// Forward kinematics from joint angles and, if free, the root pose.
+static Values ForwardKinematics(const Robot& robot, size_t k,
+                                const LinkSharedPtr& root, bool root_free,
+                                const Values& reduced) {
+  Values known;
+  for (auto&& joint : robot.joints()) {
+    const Key key = JointAngleKey(joint->id(), k);
+    known.insert(key, reduced.at<double>(key));
+  }
+  if (root_free) {
+    const Key key = PoseKey(root->id(), k);
+    known.insert(key, reduced.at<Pose3>(key));
+  }
+  return robot.forwardKinematics(known, k, root->name());
+}
+
+/* ************************************************************************* */
+Values KinematicManifoldOptimizer::expand(const Values& reduced) const {
+  const Values fk = ForwardKinematics(robot_, k_, root_, root_free_, reduced);
+  Values full = reduced;
+  for (auto&& link : robot_.links()) {
+    const Key key = PoseKey(link->id(), k_);
+    if (isEliminated(key)) full.insert(key, fk.at<Pose3>(key));
+  }
+  return full;
+}
+
+/* ************************************************************************* */
+KinematicManifoldOptimizer::PoseJacobians
+KinematicManifoldOptimizer::poseJacobians(const Values& reduced,
+                                          const Values& full) const {
+  // The manifold coordinates: joint angles, then the root pose.
+  std::vector<Key> coordinates;
+  for (auto&& joint : robot_.joints()) {
+    coordinates.push_back(JointAngleKey(joint->id(), k_));
+  }
+  if (root_free_) coordinates.push_back(PoseKey(root_->id(), k_));
+
+  const auto links = robot_.links();
+  PoseJacobians jacobians;
+  const double h = p_.fd_step;
+  for (const Key coordinate : coordinates) {
+    const size_t d = reduced.at(coordinate).dim();
+    std::vector<Matrix> columns(links.size(), Matrix::Zero(6, d));
+    for (size_t i = 0; i < d; i++) {
+      gtsam::VectorValues delta;
+      delta.insert(coordinate, gtsam::Vector::Unit(d, i) * h);
+      const Values fk = ForwardKinematics(robot_, k_, root_, root_free_,
+                                          reduced.retract(delta));
+      for (size_t l = 0; l < links.size(); l++) {
+        const Key key = PoseKey(links[l]->id(), k_);
+        if (isEliminated(key)) {
+          columns[l].col(i) =
+              full.at<Pose3>(key).localCoordinates(fk.at<Pose3>(key)) / h;
+        }
+      }
+    }
+    // Only keep the links moved by this coordinate.
+    for (size_t l = 0; l < links.size(); l++) {
+      const Key key = PoseKey(links[l]->id(), k_);
+      if (isEliminated(key) && !columns[l].isZero(0)) {
+        jacobians[key].emplace_back(coordinate, columns[l]);
+      }
+    }
+  }
+  return jacobians;
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph KinematicManifoldOptimizer::linearize(
+    const gtsam::NonlinearFactorGraph& graph, const Values& reduced,
+    const Values& full) const {
+  const PoseJacobians jacobians = poseJacobians(reduced, full);
+  GaussianFactorGraph result;
+  for (const auto& factor : *graph.linearize(full)) {
+    auto jacobian = boost::dynamic_pointer_cast<JacobianFactor>(factor);
+    if (!jacobian) {
+      throw std::runtime_error(
+          "KinematicManifoldOptimizer: only Jacobian factors are supported.");
+    }
+
+    // Chain rule: A_pose * d(pose)/d(coordinates), summed per reduced key.
+    std::map<Key, Matrix> blocks;
+    auto accumulate = [&](Key key, const Matrix& A) {
+      auto it = blocks.find(key);
+      if (it == blocks.end()) {
+        blocks.emplace(key, A);
+      } else {
+        it->second += A;
+      }
+    };
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      const Matrix A = jacobian->getA(it);
+      auto pose_jacobian = jacobians.find(*it);
+      if (pose_jacobian != jacobians.end()) {
+        for (const auto& term : pose_jacobian->second) {
+          accumulate(term.first, A * term.second);
+        }
+      } else if (!isEliminated(*it)) {
+        accumulate(*it, A);
+      }
+    }
+    if (blocks.empty()) continue;
+    const std::vector<std::pair<Key, Matrix>> terms(blocks.begin(),
+                                                    blocks.end());
+    result.emplace_shared<JacobianFactor>(terms, jacobian->getb(),
+                                          jacobian->get_model());
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values KinematicManifoldOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  gtsam::NonlinearFactorGraph merit_graph = graph;
+  for (const auto& constraint : constraints) {
+    merit_graph.add(constraint->createFactor(1.0));
+  }
+
+  const gtsam::LevenbergMarquardtParams& params = p_.lm_parameters;
+  Values reduced = reduce(initial_values);
+  Values full = expand(reduced);
+  double error = ParallelError(merit_graph, full);
+  double lambda = params.lambdaInitial;
+  boost::optional<gtsam::Ordering> ordering;
+
+  for (int i = 0; i < params.maxIterations; i++) {
+    const GaussianFactorGraph linear = linearize(merit_graph, reduced, full);
+
+    // Levenberg-Marquardt: increase damping until the error decreases.
+    size_t num_tries = 0;
+    bool accepted = false;
+    double new_error = error;
+    while (!accepted && lambda <= params.lambdaUpperBound) {
+      num_tries++;
+      GaussianFactorGraph damped = linear;
+      const double sqrt_lambda = std::sqrt(lambda);
+      for (const auto& key_value : reduced.zeroVectors()) {
+        const size_t d = key_value.second.size();
+        damped.emplace_shared<JacobianFactor>(
+            key_value.first, sqrt_lambda * Matrix::Identity(d, d),
+            gtsam::Vector::Zero(d));
+      }
+      if (!ordering) ordering = gtsam::Ordering::Colamd(damped);
+      const Values candidate = reduced.retract(damped.optimize(*ordering));
+      const Values candidate_full = expand(candidate);
+      new_error = ParallelError(merit_graph, candidate_full);
+      if (new_error < error) {
+        accepted = true;
+        reduced = candidate;
+        full = candidate_full;
+        lambda = std::max(params.lambdaLowerBound,
+                          lambda / params.lambdaFactor);
+      } else {
+        lambda *= params.lambdaFactor;
+      }
+    }
+
+    /// Store intermediate results.
+    if (intermediate_result != nullptr) {
+      intermediate_result->intermediate_values.push_back(full);
+      intermediate_result->num_iters.push_back(num_tries);
+      intermediate_result->mu_values.push_back(lambda);
+    }
+
+    if (!accepted) break;
+    const bool converged = gtsam::checkConvergence(params, error, new_error);
+    error = new_error;
+    if (converged) break;
+  }
+  return full;
+}
+
+}  // namespace gtdynamics
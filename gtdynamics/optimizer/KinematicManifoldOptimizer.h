@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicManifoldOptimizer.h
+ * @brief Optimization on the kinematic constraint manifold of a robot.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters for KinematicManifoldOptimizer.
+struct KinematicManifoldParameters : public ConstrainedOptimizationParameters {
+  using Base = ConstrainedOptimizationParameters;
+  double fd_step = 1e-6;  // step of the forward kinematics finite differences
+
+  /** Constructor. */
+  KinematicManifoldParameters() : Base(gtsam::LevenbergMarquardtParams()) {}
+
+  /** Constructor with LM parameters: iterations, tolerances and damping. */
+  KinematicManifoldParameters(
+      const gtsam::LevenbergMarquardtParams& _lm_parameters)
+      : Base(_lm_parameters) {}
+};
+
+/**
+ * KinematicManifoldOptimizer optimizes a graph over link poses at one time
+ * step on the manifold where all joint pose constraints hold, instead of
+ * carrying them as penalties, as in Kinematics::constraints.
+ *
+ * The manifold of a tree-structured robot is parameterized by its minimal
+ * coordinates, the joint angles and the pose of the root link unless it is
+ * fixed, and retracted by Robot::forwardKinematics. Link poses at the time
+ * step are eliminated from the problem, all other variables are kept. Each
+ * Levenberg-Marquardt iteration linearizes the graph at the forward kinematics
+ * solution, and maps the pose Jacobians to the reduced variables with the
+ * chain rule, using finite differences of forward kinematics.
+ *
+ * Remaining constraints, e.g. contact goals, are treated as soft, as with the
+ * SOFT_CONSTRAINTS method; joint pose constraints hold by construction.
+ */
+class KinematicManifoldOptimizer : public ConstrainedOptimizer {
+ protected:
+  const Robot robot_;
+  const size_t k_;
+  const KinematicManifoldParameters p_;
+  LinkSharedPtr root_;
+  bool root_free_;
+
+  // Pose Jacobians, per eliminated pose key, w.r.t. the reduced variables.
+  using PoseJacobians =
+      std::map<gtsam::Key, std::vector<std::pair<gtsam::Key, gtsam::Matrix>>>;
+
+  /// Compute the pose Jacobians at the given reduced values.
+  PoseJacobians poseJacobians(const gtsam::Values& reduced,
+                              const gtsam::Values& full) const;
+
+  /// Linearize the graph in the reduced variables.
+  gtsam::GaussianFactorGraph linearize(const gtsam::NonlinearFactorGraph& graph,
+                                       const gtsam::Values& reduced,
+                                       const gtsam::Values& full) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot      a tree-structured robot
+   * @param k          time step of the link poses and joint angles
+   * @param base_name  name of the root link, a fixed link if not given
+   * @param parameters LM and finite difference parameters
+   */
+  KinematicManifoldOptimizer(
+      const Robot& robot, size_t k = 0,
+      const boost::optional<std::string>& base_name = boost::none,
+      const KinematicManifoldParameters& parameters =
+          KinematicManifoldParameters());
+
+  /// Return whether a key is a link pose eliminated by the manifold.
+  bool isEliminated(gtsam::Key key) const;
+
+  /**
+   * Reduce values to the manifold coordinates: drop the eliminated link poses,
+   * and add zero joint angles and the root link CoM pose if missing.
+   */
+  gtsam::Values reduce(const gtsam::Values& values) const;
+
+  /// Expand reduced values with all link poses from forward kinematics.
+  gtsam::Values expand(const gtsam::Values& reduced) const;
+
+  /**
+   * Run optimization, intermediate results hold the values, the number of
+   * tried steps and the damping of each iteration.
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedEstimator.cpp
+ * @brief Fixed-lag state estimator of a legged robot from encoder and
+ * contact streams.
+ */
+
+#include <gtdynamics/factors/JointMeasurementFactor.h>
+#include <gtdynamics/factors/PreintegratedContactFactors.h>
+#include <gtdynamics/optimizer/LeggedEstimator.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+
+/* ************************************************************************* */
+LeggedEstimator::LeggedEstimator(const Robot &robot,
+                                 const std::string &base_name,
+                                 const Pose3 &wTbase,
+                                 const LeggedEstimatorParams &params)
+    : robot_(robot),
+      base_(robot.link(base_name)),
+      params_(params),
+      smoother_(params.smoother),
+      k_(-1),
+      t_(0),
+      wTbase_(wTbase) {}
+
+/* ************************************************************************* */
+int LeggedEstimator::update(double t, const gtsam::Vector &joint_angles,
+                            const std::vector<std::string> &contact_links,
+                            const NonlinearFactorGraph &extra_factors,
+                            const Values &extra_values) {
+  const auto &joints = robot_.joints();
+  if (size_t(joint_angles.size()) != joints.size()) {
+    throw std::invalid_argument(
+        "LeggedEstimator: one encoder reading per joint expected.");
+  }
+  if (k_ >= 0 && t <= t_) {
+    throw std::invalid_argument("LeggedEstimator: times should increase.");
+  }
+  const int k = k_ + 1, base = base_->id();
+
+  // Initial link poses, by forward kinematics from the latest base pose.
+  Values known;
+  InsertPose(&known, base, k, wTbase_);
+  for (size_t j = 0; j < joints.size(); j++) {
+    InsertJointAngle(&known, joints[j]->id(), k, joint_angles(j));
+  }
+  const Values fk = robot_.forwardKinematics(known, k, base_->name());
+
+  NonlinearFactorGraph graph = extra_factors;
+  Values values = extra_values;
+  std::map<Key, double> timestamps;
+  for (const auto &key_value : extra_values) timestamps[key_value.key] = t;
+  for (auto &&link : robot_.links()) {
+    InsertPose(&values, link->id(), k, Pose(fk, link->id(), k));
+    timestamps[PoseKey(link->id(), k)] = t;
+  }
+
+  const auto encoder_model = InternedIsotropic(6, params_.encoder_sigma);
+  for (size_t j = 0; j < joints.size(); j++) {
+    graph.emplace_shared<JointMeasurementFactor>(encoder_model, joints[j],
+                                                 joint_angles(j), k);
+  }
+
+  // Anchor the first base pose, then let it walk.
+  if (k == 0) {
+    graph.addPrior<Pose3>(PoseKey(base, 0), wTbase_,
+                          InternedIsotropic(6, params_.prior_sigma));
+  } else {
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(base, k - 1), PoseKey(base, k), Pose3(),
+        gtsam::noiseModel::Isotropic::Sigma(
+            6, params_.base_motion_sigma * std::sqrt(t - t_)));
+  }
+
+  // Links in contact since the previous step stay in place.
+  std::set<int> contacts;
+  for (const std::string &name : contact_links) {
+    const int id = robot_.link(name)->id();
+    contacts.insert(id);
+    if (k == 0 || !contacts_.count(id)) continue;
+    PreintegratedPointContactMeasurements pcm(
+        params_.contact_velocity_covariance);
+    pcm.integrateMeasurement(gtsam::Rot3(),
+                             wTbase_.between(Pose(fk, id, k)), t - t_);
+    graph.emplace_shared<PreintegratedPointContactFactor>(
+        PoseKey(base, k - 1), PoseKey(id, k - 1), PoseKey(base, k),
+        PoseKey(id, k), pcm);
+  }
+
+  smoother_.update(graph, values, timestamps);
+  k_ = k;
+  t_ = t;
+  contacts_ = contacts;
+  wTbase_ = smoother_.calculateEstimate<Pose3>(PoseKey(base, k));
+  return k;
+}
+
+/* ************************************************************************* */
+Pose3 LeggedEstimator::linkPose(const std::string &name, int k) const {
+  const int id = robot_.link(name)->id();
+  return smoother_.calculateEstimate<Pose3>(PoseKey(id, k));
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedEstimator.h
+ * @brief Fixed-lag state estimator of a legged robot from encoder and
+ * contact streams.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/StreamingSmoother.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of the LeggedEstimator.
+struct LeggedEstimatorParams {
+  /// Parameters of the fixed-lag smoother, the lag in the stream's time.
+  StreamingSmootherParams smoother;
+
+  /// Sigma of the JointMeasurementFactor of each encoder reading.
+  double encoder_sigma = 1e-3;
+
+  /// Sigma of the prior on the initial base pose.
+  double prior_sigma = 1e-3;
+
+  /// Sigma of the random walk of the base pose, per square root of second.
+  double base_motion_sigma = 1.0;
+
+  /// Covariance of the discrete velocity of a foot in contact.
+  gtsam::Matrix3 contact_velocity_covariance = 1e-4 * gtsam::I_3x3;
+};
+
+/**
+ * LeggedEstimator estimates the link poses of a legged robot over a lag
+ * window, from a stream of joint encoder readings and contact states.
+ *
+ * Each update is a time step k, whose link poses PoseKey(i, k) are new
+ * variables, initialized with forward kinematics from the latest base pose
+ * estimate. The encoder readings add a JointMeasurementFactor per joint,
+ * the base pose a random-walk BetweenFactor from the previous step, and
+ * each link in contact at both steps a PreintegratedPointContactFactor,
+ * that keeps it in place. Other factors, e.g. IMU ones on the base, can be
+ * added to any update.
+ *
+ * Variables older than the lag are marginalized by a StreamingSmoother, so
+ * that the memory and latency of an update stay bounded over long runs.
+ */
+class LeggedEstimator {
+ private:
+  Robot robot_;
+  LinkSharedPtr base_;
+  LeggedEstimatorParams params_;
+  StreamingSmoother smoother_;
+  int k_;
+  double t_;
+  gtsam::Pose3 wTbase_;
+  std::set<int> contacts_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot      the robot, without fixed links
+   * @param base_name  name of the base link
+   * @param wTbase     initial pose of the base link CoM
+   * @param params     parameters
+   */
+  LeggedEstimator(const Robot &robot, const std::string &base_name,
+                  const gtsam::Pose3 &wTbase,
+                  const LeggedEstimatorParams &params =
+                      LeggedEstimatorParams());
+
+  /**
+   * Add a time step, and update the estimate.
+   * @param t              time of the step, increasing
+   * @param joint_angles   encoder readings, ordered as robot.joints()
+   * @param contact_links  names of the links in contact at time t
+   * @param extra_factors  other factors to add
+   * @param extra_values   initial estimates of their new variables, which
+   *                       take timestamp t
+   * @return the index k of the new time step
+   */
+  int update(double t, const gtsam::Vector &joint_angles,
+             const std::vector<std::string> &contact_links,
+             const gtsam::NonlinearFactorGraph &extra_factors =
+                 gtsam::NonlinearFactorGraph(),
+             const gtsam::Values &extra_values = gtsam::Values());
+
+  /// Return the index of the latest time step, -1 before the first update.
+  int currentStep() const { return k_; }
+
+  /// Return the estimated pose of the base link at the latest step.
+  const gtsam::Pose3 &basePose() const { return wTbase_; }
+
+  /// Return the estimated pose of a link at step k, in the lag window.
+  gtsam::Pose3 linkPose(const std::string &name, int k) const;
+
+  /// Return the fixed-lag smoother.
+  const StreamingSmoother &smoother() const { return smoother_; }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LqrGains.cpp
+ * @brief Time-varying LQR gains from a linearized trajectory graph.
+ */
+
+#include <gtdynamics/optimizer/LqrGains.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+
+#include <map>
+#include <set>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::GaussianConditional;
+using gtsam::GaussianFactorGraph;
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::Matrix;
+using gtsam::Ordering;
+using gtsam::Vector;
+
+namespace {
+void CheckNumSteps(const std::vector<KeyVector> &state_keys,
+                   const std::vector<KeyVector> &control_keys) {
+  if (control_keys.size() != state_keys.size() &&
+      control_keys.size() + 1 != state_keys.size()) {
+    throw std::invalid_argument(
+        "LqrGains: needs controls for all steps or all but the last one.");
+  }
+}
+
+// Return the dimension of the keys of a step, the same for all steps.
+size_t StepDim(const std::vector<KeyVector> &step_keys,
+               const std::map<Key, size_t> &dims) {
+  size_t step_dim = 0;
+  for (size_t t = 0; t < step_keys.size(); t++) {
+    size_t dim = 0;
+    for (Key key : step_keys[t]) {
+      const auto it = dims.find(key);
+      if (it == dims.end()) {
+        throw std::invalid_argument("LqrGains: a key is not in the graph.");
+      }
+      dim += it->second;
+    }
+    if (t > 0 && dim != step_dim) {
+      throw std::invalid_argument(
+          "LqrGains: all steps need the same dimension.");
+    }
+    step_dim = dim;
+  }
+  return step_dim;
+}
+}  // namespace
+
+/* ************************************************************************* */
+Ordering LqrOrdering(const GaussianFactorGraph &graph,
+                     const std::vector<KeyVector> &state_keys,
+                     const std::vector<KeyVector> &control_keys) {
+  CheckNumSteps(state_keys, control_keys);
+  std::set<Key> step_keys;
+  for (auto &&keys : state_keys) step_keys.insert(keys.begin(), keys.end());
+  for (auto &&keys : control_keys) step_keys.insert(keys.begin(), keys.end());
+
+  Ordering ordering;
+  for (Key key : graph.keys()) {
+    if (!step_keys.count(key)) ordering.push_back(key);
+  }
+  for (size_t t = state_keys.size(); t-- > 0;) {
+    if (t < control_keys.size()) {
+      ordering.insert(ordering.end(), control_keys[t].begin(),
+                      control_keys[t].end());
+    }
+    ordering.insert(ordering.end(), state_keys[t].begin(),
+                    state_keys[t].end());
+  }
+  return ordering;
+}
+
+/* ************************************************************************* */
+LqrGains EliminateLqrGains(const GaussianFactorGraph &graph,
+                           const std::vector<KeyVector> &state_keys,
+                           const std::vector<KeyVector> &control_keys) {
+  const Ordering ordering = LqrOrdering(graph, state_keys, control_keys);
+  const std::map<Key, size_t> dims = graph.getKeyDimMap();
+
+  LqrGains gains;
+  gains.state_dim = StepDim(state_keys, dims);
+  gains.control_dim = StepDim(control_keys, dims);
+  const size_t num_steps = control_keys.size();
+  gains.K.resize(num_steps * gains.control_dim, gains.state_dim);
+  gains.k.resize(gains.control_dim, num_steps);
+
+  // Sequential elimination gives one conditional per key.
+  const auto bayes_net = graph.eliminateSequential(ordering);
+  std::map<Key, GaussianConditional::shared_ptr> conditionals;
+  for (auto &&conditional : *bayes_net) {
+    conditionals[conditional->firstFrontalKey()] = conditional;
+  }
+
+  for (size_t t = 0; t < num_steps; t++) {
+    std::map<Key, size_t> state_offsets;
+    size_t offset = 0;
+    for (Key key : state_keys[t]) {
+      state_offsets[key] = offset;
+      offset += dims.at(key);
+    }
+
+    // The last control key of the step only depends on the state; solve
+    // R u = d - S [u'; x] back to the first, as affine maps u = M x + m.
+    std::map<Key, std::pair<Matrix, Vector>> maps;
+    offset = gains.control_dim;
+    for (auto it = control_keys[t].rbegin(); it != control_keys[t].rend();
+         ++it) {
+      const GaussianConditional &conditional = *conditionals.at(*it);
+      Matrix M = Matrix::Zero(conditional.rows(), gains.state_dim);
+      Vector m = conditional.d();
+      for (auto parent = conditional.beginParents();
+           parent != conditional.endParents(); ++parent) {
+        const auto S = conditional.getA(parent);
+        if (state_offsets.count(*parent)) {
+          M.middleCols(state_offsets.at(*parent), S.cols()) -= S;
+        } else if (maps.count(*parent)) {
+          const auto &map = maps.at(*parent);
+          M -= S * map.first;
+          m -= S * map.second;
+        } else {
+          throw std::runtime_error(
+              "EliminateLqrGains: a control depends on keys of another "
+              "step.");
+        }
+      }
+      const auto R = conditional.R().triangularView<Eigen::Upper>();
+      M = R.solve(M);
+      m = R.solve(m);
+
+      offset -= m.size();
+      gains.K.block(t * gains.control_dim + offset, 0, m.size(),
+                    gains.state_dim) = M;
+      gains.k.col(t).segment(offset, m.size()) = m;
+      maps.emplace(*it, std::make_pair(M, m));
+    }
+  }
+  return gains;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LqrGains.h
+ * @brief Time-varying LQR gains from a linearized trajectory graph.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Feedback gains and feed-forward terms of a trajectory, in contiguous
+ * arrays: the control update at step t is du_t = K_t dx_t + k_t, where dx_t
+ * and du_t stack the state and control keys of step t in the given order.
+ */
+struct LqrGains {
+  size_t state_dim = 0;    ///< dimension of the state of every step
+  size_t control_dim = 0;  ///< dimension of the control of every step
+  gtsam::Matrix K;  ///< gains K_t stacked, (num steps * control_dim) x state
+  gtsam::Matrix k;  ///< feed-forward terms k_t, one column per step
+
+  /// Return the number of steps with a control.
+  size_t numSteps() const { return k.cols(); }
+
+  /// Return the gain K_t.
+  gtsam::Matrix gain(size_t t) const {
+    return K.middleRows(t * control_dim, control_dim);
+  }
+
+  /// Return the feed-forward term k_t.
+  gtsam::Vector feedForward(size_t t) const { return k.col(t); }
+
+  /// Return the control update K_t dx + k_t of step t.
+  gtsam::Vector control(size_t t, const gtsam::Vector &dx) const {
+    return gain(t) * dx + k.col(t);
+  }
+};
+
+/**
+ * Return the elimination ordering of a trajectory graph for gain extraction:
+ * first the keys of the graph in neither the states nor the controls, e.g.,
+ * wrenches and accelerations, then, backwards in time, the controls and
+ * states of each step. Eliminating the states in this order is the Riccati
+ * recursion, and leaves each control conditioned on the state of its step.
+ * @param graph         linearized trajectory graph
+ * @param state_keys    state keys of each step
+ * @param control_keys  control keys of each step, for all steps or all but
+ *                      the last one
+ */
+gtsam::Ordering LqrOrdering(const gtsam::GaussianFactorGraph &graph,
+                            const std::vector<gtsam::KeyVector> &state_keys,
+                            const std::vector<gtsam::KeyVector> &control_keys);
+
+/**
+ * Eliminate a linearized trajectory graph in the LqrOrdering, and return the
+ * time-varying gains and feed-forward terms of the controls, the solution of
+ * the graph for the controls given the state deltas.
+ * @param graph         linearized trajectory graph, e.g., the linearization
+ *                      of the iLQR graph at the current trajectory
+ * @param state_keys    state keys of each step
+ * @param control_keys  control keys of each step, for all steps or all but
+ *                      the last one
+ * @throws std::invalid_argument if the steps have different state or control
+ *         dimensions, and std::runtime_error if a control depends on keys of
+ *         another step.
+ */
+LqrGains EliminateLqrGains(const gtsam::GaussianFactorGraph &graph,
+                           const std::vector<gtsam::KeyVector> &state_keys,
+                           const std::vector<gtsam::KeyVector> &control_keys);
+
+}  // namespace gtdynamics
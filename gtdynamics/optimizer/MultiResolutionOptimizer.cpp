@@ -0,0 +1,238 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiResolutionOptimizer.cpp
+ * @brief Coarse-to-fine trajectory optimization over phase resolutions.
+ */
+
+#include <gtdynamics/optimizer/MultiResolutionOptimizer.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/base/Lie.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+using std::vector;
+
+namespace gtdynamics {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// The quantity of a key, not its time step.
+using Quantity = std::tuple<std::string, uint16_t, uint16_t>;
+
+DynamicsSymbol AtTime(const Quantity &quantity, int k) {
+  return DynamicsSymbol::LinkJointSymbol(std::get<0>(quantity),
+                                         std::get<1>(quantity),
+                                         std::get<2>(quantity), k);
+}
+
+template <class T>
+const T *Get(const Values &values, Key key) {
+  auto value = dynamic_cast<const gtsam::GenericValue<T> *>(&values.at(key));
+  return value ? &value->value() : nullptr;
+}
+
+// Linear interpolation of a value of type T, false if of another type.
+template <class T>
+bool Lerp(const Values &values, Key key0, Key key1, double alpha, Key key,
+          Values *result) {
+  const T *x0 = Get<T>(values, key0), *x1 = Get<T>(values, key1);
+  if (!x0 || !x1) return false;
+  result->insert(key, T((1 - alpha) * (*x0) + alpha * (*x1)));
+  return true;
+}
+
+// Cubic Hermite interpolation of a scalar x with derivative label `dx`,
+// over a step of duration dt; linear if a derivative is missing.
+double Hermite(const Values &values, const Quantity &quantity,
+               const std::string &dx, int k0, int k1, double alpha,
+               double dt) {
+  const double x0 = values.at<double>(AtTime(quantity, k0));
+  const double x1 = values.at<double>(AtTime(quantity, k1));
+  const Quantity derivative(dx, std::get<1>(quantity), std::get<2>(quantity));
+  const Key d0 = AtTime(derivative, k0), d1 = AtTime(derivative, k1);
+  if (dt <= 0 || !values.exists(d0) || !values.exists(d1)) {
+    return (1 - alpha) * x0 + alpha * x1;
+  }
+  const double a2 = alpha * alpha, a3 = a2 * alpha;
+  return (2 * a3 - 3 * a2 + 1) * x0 + (a3 - 2 * a2 + alpha) * dt *
+         values.at<double>(d0) + (-2 * a3 + 3 * a2) * x1 +
+         (a3 - a2) * dt * values.at<double>(d1);
+}
+}  // namespace
+
+/* ************************************************************************* */
+Values ResampleTrajectory(const Trajectory &coarse, const Values &values,
+                          const Trajectory &fine) {
+  if (coarse.numPhases() != fine.numPhases()) {
+    throw std::invalid_argument(
+        "ResampleTrajectory: trajectories must have the same phases");
+  }
+
+  // Quantities at each coarse time step; phase time steps are scaled below.
+  std::map<int, std::set<Quantity>> quantities;
+  for (const auto &key_value : values) {
+    const DynamicsSymbol symbol(key_value.key);
+    if (symbol.label() == "dt") continue;
+    quantities[symbol.time()].emplace(symbol.label(), symbol.linkIdx(),
+                                      symbol.jointIdx());
+  }
+
+  Values result;
+  const int K_c = coarse.getEndTimeStep(coarse.numPhases() - 1);
+  const int K_f = fine.getEndTimeStep(fine.numPhases() - 1);
+  for (int k = 0; k <= K_f; k++) {
+    // Position of k in the coarse time steps of the same phase.
+    const size_t p = fine.phaseIndex(k);
+    const int fine_base = p == 0 ? 0 : fine.getEndTimeStep(p - 1);
+    const int coarse_base = p == 0 ? 0 : coarse.getEndTimeStep(p - 1);
+    const double x =
+        coarse_base + double(k - fine_base) * coarse.phase(p).numTimeSteps() /
+                          fine.phase(p).numTimeSteps();
+    const int k0 = std::max(0, std::min(int(std::floor(x)), K_c - 1));
+    const int k1 = std::min(k0 + 1, K_c);
+    const double alpha = std::min(1.0, std::max(0.0, x - k0));
+    const Key dt_key = PhaseKey(p);
+    const double dt =
+        values.exists(dt_key) ? values.at<double>(dt_key) : 0.0;
+
+    std::set<Quantity> at_k = quantities[k0];
+    at_k.insert(quantities[k1].begin(), quantities[k1].end());
+    for (const Quantity &quantity : at_k) {
+      const Key key = AtTime(quantity, k);
+      const Key key0 = AtTime(quantity, k0), key1 = AtTime(quantity, k1);
+      const bool has0 = values.exists(key0), has1 = values.exists(key1);
+      if (!has0 || !has1) {
+        result.insert(key, values.at(has0 ? key0 : key1));
+        continue;
+      }
+      const std::string &label = std::get<0>(quantity);
+      if (label == "q" || label == "v") {
+        const std::string dx = label == "q" ? "v" : "a";
+        result.insert(key,
+                      Hermite(values, quantity, dx, k0, k1, alpha, dt));
+      } else if (const Pose3 *pose0 = Get<Pose3>(values, key0)) {
+        result.insert(key, gtsam::interpolate(
+                               *pose0, values.at<Pose3>(key1), alpha));
+      } else if (!Lerp<double>(values, key0, key1, alpha, key, &result) &&
+                 !Lerp<Vector6>(values, key0, key1, alpha, key, &result) &&
+                 !Lerp<Vector3>(values, key0, key1, alpha, key, &result) &&
+                 !Lerp<Vector>(values, key0, key1, alpha, key, &result)) {
+        result.insert(key, values.at(alpha < 0.5 ? key0 : key1));
+      }
+    }
+  }
+
+  // Keep the duration of each phase.
+  for (size_t p = 0; p < fine.numPhases(); p++) {
+    const Key key = PhaseKey(p);
+    if (!values.exists(key)) continue;
+    result.insert(key, values.at<double>(key) *
+                           coarse.phase(p).numTimeSteps() /
+                           fine.phase(p).numTimeSteps());
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+MultiResolutionOptimizer::MultiResolutionOptimizer(
+    const Trajectory &trajectory, double dt,
+    const MultiResolutionParams &params)
+    : params_(params) {
+  if (dt <= 0) {
+    throw std::invalid_argument("MultiResolutionOptimizer: dt must be > 0");
+  }
+  vector<size_t> factors = params.coarsening;
+  factors.push_back(1);
+  const vector<int> finest = trajectory.phaseDurations();
+  vector<int> previous;
+  for (size_t factor : factors) {
+    if (factor < 1) {
+      throw std::invalid_argument(
+          "MultiResolutionOptimizer: coarsening factors must be >= 1");
+    }
+    vector<int> durations;
+    vector<double> dts;
+    for (const Phase &phase : trajectory.phases()) {
+      const int n = phase.numTimeSteps();
+      const int n_l = std::max(1, int(std::round(double(n) / factor)));
+      durations.push_back(n_l);
+      dts.push_back(dt * n / n_l);
+    }
+    // Skip coarse levels that are no coarser than the previous one.
+    if (factor != 1 && (durations == previous || durations == finest)) {
+      continue;
+    }
+    previous = durations;
+    trajectories_.push_back(trajectory.withPhaseDurations(durations));
+    phase_dts_.push_back(dts);
+  }
+}
+
+/* ************************************************************************* */
+Values MultiResolutionOptimizer::optimize(const GraphBuilder &build,
+                                          const Initialization &initialize) {
+  levels_.clear();
+  Values solution;
+  for (size_t l = 0; l < numLevels(); l++) {
+    const auto start = Clock::now();
+    const Trajectory &trajectory = trajectories_[l];
+    const NonlinearFactorGraph graph = build(trajectory, phase_dts_[l]);
+
+    Values initial;
+    if (l == 0) {
+      initial = initialize(trajectory, phase_dts_[l]);
+    } else {
+      const Values resampled =
+          ResampleTrajectory(trajectories_[l - 1], solution, trajectory);
+      for (Key key : graph.keys()) {
+        if (!resampled.exists(key)) {
+          throw std::runtime_error(
+              "MultiResolutionOptimizer: no initial value for " +
+              _GTDKeyFormatter(key) + " at level " + std::to_string(l));
+        }
+        initial.insert(key, resampled.at(key));
+      }
+    }
+
+    const bool finest = l + 1 == numLevels();
+    gtsam::LevenbergMarquardtOptimizer optimizer(
+        graph, initial, finest ? params_.lm : params_.coarse_lm);
+    solution = optimizer.optimize();
+
+    MultiResolutionLevel level;
+    level.num_time_steps =
+        trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+    level.iterations = optimizer.iterations();
+    level.error = graph.error(solution);
+    level.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    levels_.push_back(level);
+  }
+  return solution;
+}
+
+}  // namespace gtdynamics
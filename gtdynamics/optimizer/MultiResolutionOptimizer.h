@@ -0,0 +1,133 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiResolutionOptimizer.h
+ * @brief Coarse-to-fine trajectory optimization over phase resolutions.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Resample the solution of a trajectory to the same phases with other
+ * numbers of time steps, e.g. to seed a finer resolution.
+ *
+ * Each phase is stretched to its new number of steps, so a step of the
+ * result falls between two steps of `values`, in the same phase. Joint
+ * angles and velocities are interpolated by cubic Hermite splines with the
+ * velocities and accelerations as derivatives, over the phase time step
+ * dt, so the result satisfies the collocation constraints up to the
+ * interpolation error. Poses are interpolated along geodesics, all other
+ * quantities linearly. A quantity present at only one of the two steps,
+ * e.g. a contact wrench around a transition, is copied from it. Phase time
+ * steps are scaled to keep the duration of each phase.
+ *
+ * @param coarse  the trajectory `values` is a solution of
+ * @param values  the values of all time steps of `coarse`
+ * @param fine    the same phases as `coarse`, e.g. withPhaseDurations
+ * @return the values of all time steps of `fine`
+ */
+gtsam::Values ResampleTrajectory(const Trajectory &coarse,
+                                 const gtsam::Values &values,
+                                 const Trajectory &fine);
+
+/// Parameters of MultiResolutionOptimizer.
+struct MultiResolutionParams {
+  /// Ratio of the time step of each coarse level to the finest, coarsest
+  /// first; the finest level is always solved last.
+  std::vector<size_t> coarsening = {4, 2};
+  gtsam::LevenbergMarquardtParams coarse_lm;  ///< LM of the coarse levels
+  gtsam::LevenbergMarquardtParams lm;         ///< LM of the finest level
+
+  MultiResolutionParams() {
+    coarse_lm.setlambdaInitial(1e7);
+    coarse_lm.setRelativeErrorTol(1e-3);
+    lm.setlambdaInitial(1e7);
+    lm.setAbsoluteErrorTol(1e-3);
+  }
+};
+
+/// Outcome of the solve of one level.
+struct MultiResolutionLevel {
+  int num_time_steps = 0;  // final time step of the level
+  size_t iterations = 0;   // LM iterations
+  double error = 0;        // final error of the level graph
+  double seconds = 0;      // wall-clock time of building and solving
+};
+
+/**
+ * MultiResolutionOptimizer solves a multi-phase trajectory coarse to fine.
+ * The phases are first solved with fewer time steps each, and longer time
+ * steps keeping the phase durations; each solution is resampled with
+ * ResampleTrajectory to seed the next finer level, and only the finest level
+ * is solved at full size, from a good initial guess.
+ *
+ * Graphs are built per level by a user function, as objectives usually
+ * depend on the time steps, and receive the phase time steps of the level.
+ */
+class MultiResolutionOptimizer {
+ public:
+  /// Build the graph of a trajectory with the given time step per phase.
+  using GraphBuilder = std::function<gtsam::NonlinearFactorGraph(
+      const Trajectory &trajectory, const std::vector<double> &phase_dts)>;
+
+  /// Initial values of the coarsest level.
+  using Initialization = std::function<gtsam::Values(
+      const Trajectory &trajectory, const std::vector<double> &phase_dts)>;
+
+ private:
+  MultiResolutionParams params_;
+  std::vector<Trajectory> trajectories_;         // coarsest first
+  std::vector<std::vector<double>> phase_dts_;  // of each level
+  std::vector<MultiResolutionLevel> levels_;    // of the last optimize
+
+ public:
+  /**
+   * Constructor
+   * @param trajectory  the trajectory at the finest resolution
+   * @param dt          time step of all phases at the finest resolution
+   * @param params      levels and optimizer parameters
+   */
+  MultiResolutionOptimizer(
+      const Trajectory &trajectory, double dt,
+      const MultiResolutionParams &params = MultiResolutionParams());
+
+  /// Return the number of levels, the finest included.
+  size_t numLevels() const { return trajectories_.size(); }
+
+  /// Return the trajectory of level l, 0 the coarsest.
+  const Trajectory &trajectory(size_t l) const { return trajectories_[l]; }
+
+  /// Return the time step of each phase at level l.
+  const std::vector<double> &phaseDts(size_t l) const {
+    return phase_dts_[l];
+  }
+
+  /**
+   * Solve all levels, coarsest first.
+   * @param build       builds the graph of each level
+   * @param initialize  initial values of the coarsest level
+   * @return the solution at the finest level
+   */
+  gtsam::Values optimize(const GraphBuilder &build,
+                         const Initialization &initialize);
+
+  /// Return the summary of every level of the last optimize.
+  const std::vector<MultiResolutionLevel> &levels() const { return levels_; }
+};
+
+}  // namespace gtdynamics
@@ -12,42 +12,457 @@
  */
 
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/DenseLevenbergMarquardt.h>
 #include <gtdynamics/optimizer/Optimizer.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtdynamics/optimizer/SolveCheckpoint.h>
+#include <gtdynamics/optimizer/SolveSnapshot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/Profiler.h>
+#include <gtsam/base/DSFMap.h>
+#include <gtsam/linear/Sampler.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
 using gtsam::Values;
 
+gtsam::Ordering TimeOrdering(const NonlinearFactorGraph& graph) {
+  const gtsam::KeySet keys = graph.keys();
+
+  // Group keys by time step, global keys go in the last group.
+  gtsam::FastMap<gtsam::Key, int> groups;
+  int last_group = 0;
+  for (gtsam::Key key : keys) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.linkIdx() != DynamicsSymbol::kNoIndex ||
+        symbol.jointIdx() != DynamicsSymbol::kNoIndex) {
+      groups[key] = symbol.time();
+      last_group = std::max(last_group, int(symbol.time()) + 1);
+    }
+  }
+  for (gtsam::Key key : keys) {
+    if (!groups.count(key)) groups[key] = last_group;
+  }
+  return gtsam::Ordering::ColamdConstrained(graph, groups);
+}
+
+// Append the time slices [begin, end) in nested-dissection order.
+static void NestedSlices(const std::vector<int>& times, size_t begin,
+                         size_t end, size_t leaf_slices,
+                         std::vector<int>* order) {
+  if (end - begin <= std::max<size_t>(leaf_slices, 1)) {
+    order->insert(order->end(), times.begin() + begin, times.begin() + end);
+    return;
+  }
+  const size_t middle = begin + (end - begin) / 2;
+  NestedSlices(times, begin, middle, leaf_slices, order);
+  NestedSlices(times, middle + 1, end, leaf_slices, order);
+  order->push_back(times[middle]);
+}
+
+gtsam::Ordering NestedTimeOrdering(const NonlinearFactorGraph& graph,
+                                   size_t leaf_slices) {
+  const gtsam::KeySet keys = graph.keys();
+
+  // The time steps of keys with a link or joint index.
+  std::set<int> time_set;
+  for (gtsam::Key key : keys) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.linkIdx() != DynamicsSymbol::kNoIndex ||
+        symbol.jointIdx() != DynamicsSymbol::kNoIndex) {
+      time_set.insert(symbol.time());
+    }
+  }
+  const std::vector<int> times(time_set.begin(), time_set.end());
+  std::vector<int> order;
+  NestedSlices(times, 0, times.size(), leaf_slices, &order);
+  std::map<int, int> rank;
+  for (size_t r = 0; r < order.size(); r++) rank[order[r]] = r;
+
+  // Group keys by the rank of their time step, global keys last.
+  gtsam::FastMap<gtsam::Key, int> groups;
+  for (gtsam::Key key : keys) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.linkIdx() != DynamicsSymbol::kNoIndex ||
+        symbol.jointIdx() != DynamicsSymbol::kNoIndex) {
+      groups[key] = rank[symbol.time()];
+    } else {
+      groups[key] = order.size();
+    }
+  }
+  return gtsam::Ordering::ColamdConstrained(graph, groups);
+}
+
+// Rank of a label in a list, labels not in it come last.
+static int LabelRank(const std::string& label,
+                     const std::vector<std::string>& labels) {
+  return std::find(labels.begin(), labels.end(), label) - labels.begin();
+}
+
+gtsam::Ordering DynamicsOrdering(const NonlinearFactorGraph& graph,
+                                 const boost::optional<int>& root) {
+  using gtsam::Key;
+  const uint16_t kNoIndex = DynamicsSymbol::kNoIndex;
+
+  // Links of every joint, from the wrench keys, and from factors on the
+  // keys of a single joint and of links.
+  std::set<int> links;
+  std::map<int, std::set<int>> joint_links;
+  for (const auto& factor : graph) {
+    if (!factor) continue;
+    std::set<int> factor_joints, factor_links;
+    for (Key key : factor->keys()) {
+      const DynamicsSymbol symbol(key);
+      const bool has_link = symbol.linkIdx() != kNoIndex;
+      const bool has_joint = symbol.jointIdx() != kNoIndex;
+      if (has_link) links.insert(symbol.linkIdx());
+      if (has_link && has_joint) {
+        if (symbol.label() == "F") {
+          joint_links[symbol.jointIdx()].insert(symbol.linkIdx());
+        }
+      } else if (has_joint) {
+        factor_joints.insert(symbol.jointIdx());
+      } else if (has_link) {
+        factor_links.insert(symbol.linkIdx());
+      }
+    }
+    if (factor_joints.size() == 1 && !factor_links.empty()) {
+      joint_links[*factor_joints.begin()].insert(factor_links.begin(),
+                                                 factor_links.end());
+    }
+  }
+
+  // Neighbors of every link, and the joints to them.
+  std::map<int, std::vector<std::pair<int, int>>> neighbors;
+  for (auto&& entry : joint_links) {
+    for (int i : entry.second) {
+      for (int c : entry.second) {
+        if (c != i) neighbors[i].emplace_back(c, entry.first);
+      }
+    }
+  }
+
+  // Breadth-first search from the root of every tree, which gives the depth
+  // of the links and the child link of the tree joints.
+  std::map<int, int> depth, child;
+  std::vector<int> roots;
+  if (root) roots.push_back(*root);
+  roots.insert(roots.end(), links.begin(), links.end());
+  for (int r : roots) {
+    if (depth.count(r)) continue;
+    depth[r] = 0;
+    std::queue<int> queue;
+    queue.push(r);
+    while (!queue.empty()) {
+      const int i = queue.front();
+      queue.pop();
+      for (auto&& neighbor : neighbors[i]) {
+        if (depth.count(neighbor.first)) continue;
+        depth[neighbor.first] = depth[i] + 1;
+        child[neighbor.second] = neighbor.first;
+        queue.push(neighbor.first);
+      }
+    }
+  }
+
+  // Sort by: global, time, decreasing depth, link (or joint outside the
+  // tree), link-joint/joint/link keys, label, key.
+  const std::vector<std::string> joint_labels = {"T", "a", "v", "q"};
+  const std::vector<std::string> link_labels = {"A", "V", "p"};
+  using Rank = std::tuple<bool, uint64_t, int, int, int, int, Key>;
+  std::vector<Rank> ranks;
+  for (Key key : graph.keys()) {
+    const DynamicsSymbol symbol(key);
+    const bool has_link = symbol.linkIdx() != kNoIndex;
+    const bool has_joint = symbol.jointIdx() != kNoIndex;
+    if (!has_link && !has_joint) {
+      ranks.emplace_back(true, 0, 0, 0, 0, 0, key);
+    } else if (has_link) {
+      const int i = symbol.linkIdx();
+      const int category = has_joint ? 0 : 2;
+      const int label = has_joint ? 0 : LabelRank(symbol.label(), link_labels);
+      ranks.emplace_back(false, symbol.time(), -depth[i], i, category, label,
+                         key);
+    } else {
+      const int j = symbol.jointIdx();
+      const int label = LabelRank(symbol.label(), joint_labels);
+      const auto it = child.find(j);
+      if (it != child.end()) {
+        ranks.emplace_back(false, symbol.time(), -depth[it->second],
+                           it->second, 1, label, key);
+      } else {
+        ranks.emplace_back(false, symbol.time(), 1, j, 1, label, key);
+      }
+    }
+  }
+  std::sort(ranks.begin(), ranks.end());
+
+  gtsam::Ordering ordering;
+  for (auto&& rank : ranks) ordering.push_back(std::get<6>(rank));
+  return ordering;
+}
+
+std::vector<GraphComponent> ConnectedComponents(
+    const NonlinearFactorGraph& graph, const EqualityConstraints& constraints) {
+  // Keys of the factors, followed by those of the constraints.
+  std::vector<gtsam::KeyVector> keys;
+  for (const auto& factor : graph) {
+    keys.push_back(factor ? factor->keys() : gtsam::KeyVector());
+  }
+  for (const auto& constraint : constraints) {
+    keys.push_back(constraint->createFactor(1.0)->keys());
+  }
+
+  gtsam::DSFMap<gtsam::Key> sets;
+  for (const auto& factor_keys : keys) {
+    for (gtsam::Key key : factor_keys) sets.merge(factor_keys.front(), key);
+  }
+
+  // Number the components by the root of their set, in order of appearance.
+  std::vector<GraphComponent> components;
+  std::map<gtsam::Key, size_t> index;
+  auto component = [&](const gtsam::KeyVector& factor_keys) -> GraphComponent& {
+    const gtsam::Key root = sets.find(factor_keys.front());
+    auto it = index.find(root);
+    if (it == index.end()) {
+      it = index.emplace(root, components.size()).first;
+      components.emplace_back();
+    }
+    GraphComponent& result = components[it->second];
+    result.keys.insert(factor_keys.begin(), factor_keys.end());
+    return result;
+  };
+  for (size_t i = 0; i < graph.size(); i++) {
+    if (!keys[i].empty()) component(keys[i]).graph.push_back(graph[i]);
+  }
+  for (size_t i = 0; i < constraints.size(); i++) {
+    const auto& constraint_keys = keys[graph.size() + i];
+    if (!constraint_keys.empty()) {
+      component(constraint_keys).constraints.push_back(constraints[i]);
+    }
+  }
+  return components;
+}
+
+/// Name of the LM solve of the SOFT_CONSTRAINTS method in its checkpoints.
+static const char kCheckpointSolver[] = "LevenbergMarquardt";
+
+// Continue LM after the iterations of a checkpoint, with its damping.
+static gtsam::LevenbergMarquardtParams Resumed(
+    gtsam::LevenbergMarquardtParams params,
+    const boost::optional<SolveCheckpoint>& resumed) {
+  if (resumed) {
+    params.setlambdaInitial(resumed->lambda);
+    params.setMaxIterations(
+        std::max(0, params.maxIterations - int(resumed->iterations)));
+  }
+  return params;
+}
+
+// Run LM to convergence, or until proceed returns false for the error after
+// an iteration, or the deadline. With a checkpoint path, the state after
+// every interval iterations, and the last one, is saved, counting the
+// iterations done before resuming.
+static Values IterateUntil(gtsam::LevenbergMarquardtOptimizer* optimizer,
+                           const gtsam::LevenbergMarquardtParams& params,
+                           const std::function<bool(double)>& proceed,
+                           const Deadline& deadline,
+                           const std::string& checkpoint_path = "",
+                           size_t checkpoint_interval = 1, size_t done = 0) {
+  const bool checkpoint = !checkpoint_path.empty();
+  if (!proceed && deadline.unlimited() && !checkpoint) {
+    return optimizer->optimize();
+  }
+
+  // Iterate by hand to stop unpromising starts or at the deadline.
+  double error = optimizer->error();
+  while (optimizer->iterations() < size_t(params.maxIterations)) {
+    optimizer->iterate();
+    const double new_error = optimizer->error();
+    const bool converged = gtsam::checkConvergence(params, error, new_error);
+    error = new_error;
+    deadline.iterated(error);
+    const bool stop =
+        converged || (proceed && !proceed(error)) || deadline.expired();
+    const size_t iterations = done + optimizer->iterations();
+    if (checkpoint &&
+        (stop || CheckpointDue(iterations, checkpoint_interval) ||
+         optimizer->iterations() == size_t(params.maxIterations))) {
+      SolveCheckpoint state;
+      state.solver = kCheckpointSolver;
+      state.values = optimizer->values();
+      state.iterations = iterations;
+      state.lambda = optimizer->lambda();
+      SaveSolveCheckpoint(state, checkpoint_path);
+    }
+    if (stop) break;
+  }
+  return optimizer->values();
+}
+
+std::shared_ptr<SymbolicStructure> Optimizer::structure() const {
+  return p_.symbolic_structure ? p_.symbolic_structure
+                               : std::make_shared<SymbolicStructure>();
+}
+
+gtsam::LevenbergMarquardtParams Optimizer::lmParameters(
+    const NonlinearFactorGraph& graph, SymbolicStructure* structure) const {
+  std::function<gtsam::Ordering()> order;
+  if (p_.dynamics_ordering) {
+    order = [&]() -> gtsam::Ordering { return DynamicsOrdering(graph); };
+  } else if (p_.nested_ordering) {
+    order = [&]() -> gtsam::Ordering { return NestedTimeOrdering(graph); };
+  } else if (p_.time_ordering) {
+    order = [&]() -> gtsam::Ordering { return TimeOrdering(graph); };
+  }
+  return StructuredParameters(graph, p_.lm_parameters, structure, order);
+}
+
 Values Optimizer::optimize(const NonlinearFactorGraph& graph,
-                           const Values& initial_values) const {
-  gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial_values,
-                                               p_.lm_parameters);
+                           const Values& initial_values,
+                           SolverTelemetry* telemetry) const {
+  if (p_.num_threads > 0) {
+    OptimizationParameters parameters = p_;
+    parameters.num_threads = 0;
+    Values result;
+    WithThreads(p_.num_threads, [&] {
+      result = Optimizer(parameters).optimize(graph, initial_values,
+                                              telemetry);
+    });
+    return result;
+  }
+  if (!p_.snapshot_path.empty()) {
+    SaveSolveSnapshot(SolveSnapshot(graph, EqualityConstraints(),
+                                    initial_values, p_),
+                      p_.snapshot_path);
+  }
+  // Checkpoints are kept by the LM loop of the SOFT_CONSTRAINTS method.
+  if (!telemetry && !p_.checkpoint_path.empty()) {
+    OptimizationParameters parameters = p_;
+    parameters.method = OptimizationParameters::Method::SOFT_CONSTRAINTS;
+    parameters.snapshot_path.clear();
+    return Optimizer(parameters).optimizeOnce(graph, EqualityConstraints(),
+                                              initial_values);
+  }
+  if (!telemetry && p_.dense_dimension &&
+      DenseSolvable(graph, initial_values, p_.dense_dimension)) {
+    DenseLevenbergMarquardt optimizer(graph, initial_values, p_.lm_parameters);
+    return optimizer.optimize();
+  }
+  const auto shared = structure();
+  const gtsam::LevenbergMarquardtParams params =
+      lmParameters(graph, shared.get());
+  if (telemetry) {
+    return InstrumentedLevenbergMarquardt(graph, initial_values, params,
+                                          telemetry, 0, nullptr,
+                                          shared.get());
+  }
+  StructuredLevenbergMarquardt optimizer(graph, initial_values, params,
+                                         shared);
   const Values result = optimizer.optimize();
   return result;
 }
 
-Values Optimizer::optimize(const gtsam::NonlinearFactorGraph& graph,
-                           const EqualityConstraints& constraints,
-                           const gtsam::Values& initial_values) const {
-  if (p_.method == OptimizationParameters::Method::SOFT_CONSTRAINTS) {
-    auto merit_graph = graph;
-    for (const auto& constraint : constraints) {
-      merit_graph.add(constraint->createFactor(1.0));
+Values Optimizer::optimizeOnce(
+    const NonlinearFactorGraph& graph, const EqualityConstraints& constraints,
+    const Values& initial_values, const std::function<bool(double)>& proceed,
+    SolverTelemetry* telemetry, const Deadline& deadline,
+    std::shared_ptr<SymbolicStructure> structure) const {
+  GTD_PROFILE_SCOPE("Optimizer::optimizeOnce");
+  auto merit_graph = graph;
+  for (const auto& constraint : constraints) {
+    merit_graph.add(constraint->createFactor(1.0));
+  }
+
+  // Soft solves without telemetry continue from their checkpoint, if any.
+  const bool soft =
+      p_.method == OptimizationParameters::Method::SOFT_CONSTRAINTS;
+  const std::string checkpoint_path =
+      soft && !telemetry ? p_.checkpoint_path : std::string();
+  boost::optional<SolveCheckpoint> resumed;
+  if (!checkpoint_path.empty()) {
+    resumed = LoadSolveCheckpoint(checkpoint_path, kCheckpointSolver,
+                                  initial_values);
+  }
+  const Values& start = resumed ? resumed->values : initial_values;
+  const size_t done = resumed ? resumed->iterations : 0;
+
+  // Tiny soft problems are solved densely, without a symbolic structure.
+  if (soft && !(!proceed && telemetry) && p_.dense_dimension &&
+      DenseSolvable(merit_graph, initial_values, p_.dense_dimension)) {
+    const gtsam::LevenbergMarquardtParams params =
+        Resumed(p_.lm_parameters, resumed);
+    DenseLevenbergMarquardt optimizer(merit_graph, start, params);
+    return IterateUntil(&optimizer, params, proceed, deadline,
+                        checkpoint_path, p_.checkpoint_interval, done);
+  }
+
+  // The merit graph has the keys of both the graph and the constraints, and
+  // the structure of the merit graphs of the constrained methods.
+  if (!structure) structure = this->structure();
+  const gtsam::LevenbergMarquardtParams lm_parameters =
+      lmParameters(merit_graph, structure.get());
+
+  if (soft) {
+    if (!proceed && telemetry) {
+      return InstrumentedLevenbergMarquardt(merit_graph, initial_values,
+                                            lm_parameters, telemetry, 0,
+                                            nullptr, structure.get());
     }
-    return optimize(merit_graph, initial_values);
+    const gtsam::LevenbergMarquardtParams params =
+        Resumed(lm_parameters, resumed);
+    StructuredLevenbergMarquardt optimizer(merit_graph, start, params,
+                                           structure);
+    return IterateUntil(&optimizer, params, proceed, deadline,
+                        checkpoint_path, p_.checkpoint_interval, done);
 
   } else if (p_.method == OptimizationParameters::Method::PENALTY) {
-    PenaltyMethodParameters params = p_.lm_parameters;
+    PenaltyMethodParameters params = lm_parameters;
+    params.deadline = deadline.remaining();
+    params.control = p_.control;
+    params.checkpoint_path = p_.checkpoint_path;
+    params.checkpoint_interval = p_.checkpoint_interval;
+    params.symbolic_structure = structure;
     PenaltyMethodOptimizer optimizer(params);
-    return optimizer.optimize(graph, constraints, initial_values);
+    ConstrainedOptResult result;
+    result.telemetry = telemetry;
+    return optimizer.optimize(graph, constraints, initial_values, &result);
 
   } else if (p_.method ==
              OptimizationParameters::Method::AUGMENTED_LAGRANGIAN) {
-    AugmentedLagrangianParameters params = p_.lm_parameters;
+    AugmentedLagrangianParameters params = lm_parameters;
+    params.deadline = deadline.remaining();
+    params.control = p_.control;
+    params.checkpoint_path = p_.checkpoint_path;
+    params.checkpoint_interval = p_.checkpoint_interval;
+    params.symbolic_structure = structure;
     AugmentedLagrangianOptimizer optimizer(params);
+    ConstrainedOptResult result;
+    result.telemetry = telemetry;
+    return optimizer.optimize(graph, constraints, initial_values, &result);
+
+  } else if (p_.method == OptimizationParameters::Method::SQP) {
+    SQPParameters params = lm_parameters;
+    params.deadline = deadline.remaining();
+    params.control = p_.control;
+    SQPOptimizer optimizer(params);
     return optimizer.optimize(graph, constraints, initial_values);
 
   } else {
@@ -55,4 +470,173 @@ Values Optimizer::optimize(const gtsam::NonlinearFactorGraph& graph,
   }
 }
 
+Values Optimizer::optimize(const gtsam::NonlinearFactorGraph& graph,
+                           const EqualityConstraints& constraints,
+                           const gtsam::Values& initial_values,
+                           SolverTelemetry* telemetry,
+                           OptimizationStatus* status) const {
+  if (p_.num_threads > 0) {
+    OptimizationParameters parameters = p_;
+    parameters.num_threads = 0;
+    Values result;
+    WithThreads(p_.num_threads, [&] {
+      result = Optimizer(parameters).optimize(graph, constraints,
+                                              initial_values, telemetry,
+                                              status);
+    });
+    return result;
+  }
+  if (!p_.snapshot_path.empty()) {
+    SaveSolveSnapshot(SolveSnapshot(graph, constraints, initial_values, p_),
+                      p_.snapshot_path);
+  }
+
+  // Stiff factors become constraints, to be eliminated exactly.
+  if (p_.hard_sigma > 0) {
+    NonlinearFactorGraph soft;
+    EqualityConstraints all_constraints = constraints;
+    all_constraints.add(HardConstraints(graph, p_.hard_sigma, &soft));
+    OptimizationParameters parameters = p_;
+    parameters.hard_sigma = 0;
+    parameters.snapshot_path.clear();
+    return Optimizer(parameters).optimize(soft, all_constraints,
+                                          initial_values, telemetry, status);
+  }
+
+  // Parallel starts or components would all write the same checkpoint.
+  if (!p_.checkpoint_path.empty() &&
+      (p_.num_starts > 1 || p_.split_components)) {
+    OptimizationParameters parameters = p_;
+    parameters.checkpoint_path.clear();
+    parameters.snapshot_path.clear();
+    return Optimizer(parameters).optimize(graph, constraints, initial_values,
+                                          telemetry, status);
+  }
+
+  const Deadline deadline(p_.deadline, p_.control);
+  std::vector<GraphComponent> components;
+  if (p_.split_components && !p_.lm_parameters.ordering) {
+    components = ConnectedComponents(graph, constraints);
+  }
+  Values result;
+  if (components.size() > 1) {
+    result = optimizeComponents(components, initial_values, deadline);
+  } else if (p_.num_starts <= 1) {
+    result = optimizeOnce(graph, constraints, initial_values, nullptr,
+                          telemetry, deadline);
+  } else {
+    result = optimizeMultiStart(graph, constraints, initial_values, telemetry,
+                                deadline);
+  }
+
+  if (status) {
+    status->cancelled = p_.control && p_.control->cancelled();
+    status->timed_out = deadline.expired() && !status->cancelled;
+    status->feasible = true;
+    for (const auto& constraint : constraints) {
+      if (!constraint->feasible(result)) status->feasible = false;
+    }
+    status->violation = std::sqrt(constraints.evaluate(result).squaredNorm());
+    status->error = graph.error(result);
+  }
+  return result;
+}
+
+Values Optimizer::optimizeMultiStart(
+    const NonlinearFactorGraph& graph, const EqualityConstraints& constraints,
+    const Values& initial_values, SolverTelemetry* telemetry,
+    const Deadline& deadline,
+    std::shared_ptr<SymbolicStructure> structure) const {
+  // All starts share the structure of the problem.
+  if (!structure) structure = this->structure();
+  auto merit_graph = graph;
+  for (const auto& constraint : constraints) {
+    merit_graph.add(constraint->createFactor(1.0));
+  }
+
+  // Lowest merit error reached by any start so far, for early cancellation.
+  std::mutex mutex;
+  double lowest_error = merit_graph.error(initial_values);
+  auto proceed = [&](double error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    lowest_error = std::min(lowest_error, error);
+    return error <= p_.cancel_ratio * lowest_error;
+  };
+
+  const size_t dim = initial_values.dim();
+  std::vector<Values> results(p_.num_starts);
+  ParallelFor(p_.num_starts, [&](size_t i) {
+    Values start = initial_values;
+    if (i > 0) {
+      gtsam::Sampler sampler(gtsam::Vector::Constant(dim, p_.start_noise), i);
+      const gtsam::Vector noise = sampler.sample();
+      gtsam::VectorValues delta = initial_values.zeroVectors();
+      size_t offset = 0;
+      for (auto& key_value : delta) {
+        const size_t d = key_value.second.size();
+        key_value.second = noise.segment(offset, d);
+        offset += d;
+      }
+      start = initial_values.retract(delta);
+    }
+    results[i] = optimizeOnce(
+        graph, constraints, start,
+        p_.cancel_ratio > 0 ? std::function<bool(double)>(proceed) : nullptr,
+        i == 0 ? telemetry : nullptr, deadline, structure);
+  });
+
+  // Prefer feasible results, then the lowest error.
+  auto feasible = [&](const Values& values) {
+    for (const auto& constraint : constraints) {
+      if (!constraint->feasible(values)) return false;
+    }
+    return true;
+  };
+  size_t best = 0;
+  bool best_feasible = false;
+  double best_error = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < results.size(); i++) {
+    const bool is_feasible = feasible(results[i]);
+    if (best_feasible && !is_feasible) continue;
+    const double error = is_feasible ? graph.error(results[i])
+                                     : merit_graph.error(results[i]);
+    if ((is_feasible && !best_feasible) || error < best_error) {
+      best = i;
+      best_feasible = is_feasible;
+      best_error = error;
+    }
+  }
+  return results[best];
+}
+
+Values Optimizer::optimizeComponents(
+    const std::vector<GraphComponent>& components, const Values& initial_values,
+    const Deadline& deadline) const {
+  std::vector<Values> results(components.size());
+  ParallelFor(components.size(), [&](size_t i) {
+    const GraphComponent& component = components[i];
+    Values initial;
+    for (gtsam::Key key : component.keys) {
+      initial.insert(key, initial_values.at(key));
+    }
+    const auto structure = std::make_shared<SymbolicStructure>();
+    results[i] = p_.num_starts <= 1
+                     ? optimizeOnce(component.graph, component.constraints,
+                                    initial, nullptr, nullptr, deadline,
+                                    structure)
+                     : optimizeMultiStart(component.graph,
+                                          component.constraints, initial,
+                                          nullptr, deadline, structure);
+  });
+
+  Values result;
+  for (const Values& values : results) result.insert(values);
+  for (const auto& key_value : initial_values) {
+    if (!result.exists(key_value.key)) {
+      result.insert(key_value.key, key_value.value);
+    }
+  }
+  return result;
+}
+
 }  // namespace gtdynamics
@@ -13,9 +13,22 @@
 
 #pragma once
 
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/SolverTelemetry.h>
+#include <gtdynamics/optimizer/SymbolicStructure.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/inference/Ordering.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 // Forward declarations.
 namespace gtsam {
@@ -27,48 +40,269 @@ namespace gtdynamics {
 
 /// Optimization parameters shared between all solvers
 struct OptimizationParameters {
-  enum Method { SOFT_CONSTRAINTS = 0, PENALTY = 1, AUGMENTED_LAGRANGIAN = 2 };
+  enum Method {
+    SOFT_CONSTRAINTS = 0,
+    PENALTY = 1,
+    AUGMENTED_LAGRANGIAN = 2,
+    SQP = 3
+  };
 
   Method method = Method::SOFT_CONSTRAINTS;       // optimization method
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
+  bool time_ordering = false;  // eliminate trajectories slice by slice
+  bool dynamics_ordering = false;  // DynamicsOrdering, over time_ordering
+  bool nested_ordering = false;    // NestedTimeOrdering, over time_ordering
+
+  // Threads used by TBB, e.g. by the multifrontal elimination of GTSAM when
+  // it is built with TBB, 0 for the default. Combine with nested_ordering
+  // for trajectories, whose elimination tree is otherwise a chain.
+  size_t num_threads = 0;
+
+  // Multi-start: solve from the initial values and num_starts - 1 random
+  // perturbations of them, in parallel, and keep the best result.
+  size_t num_starts = 1;     // number of starts, 1 disables multi-start
+  double start_noise = 0.1;  // std. dev. of the tangent-space perturbations
+  double cancel_ratio = 0;   // stop a start whose error exceeds cancel_ratio
+                             // times the lowest error of any start, 0 never;
+                             // otherwise at least 1, so the best start is
+                             // never cancelled
+
+  // Anytime mode: stop iterating after this many wall-clock seconds.
+  double deadline = std::numeric_limits<double>::infinity();
+
+  // Solve the connected components of the graph and constraints, e.g. of
+  // several robots, independently and in parallel, each with its own LM
+  // damping. Ignored when lm_parameters has an explicit ordering.
+  bool split_components = false;
+
+  // Problems of the SOFT_CONSTRAINTS method, or without constraints, with at
+  // most this many scalar variables are solved by DenseLevenbergMarquardt,
+  // unless recording telemetry or a factor has a constrained noise model.
+  // Below a few dozen variables dense Cholesky beats sparse elimination.
+  // 0 always eliminates sparsely.
+  size_t dense_dimension = 64;
+
+  // Factors with a Constrained noise model, or with all sigmas at most
+  // hard_sigma, e.g., the stiff factors of kinematics and dynamics graphs,
+  // are optimized as equality constraints, so that the SQP method eliminates
+  // them exactly in its linear solves. 0 keeps them as factors.
+  double hard_sigma = 0;
+
+  // Symbolic structure shared by all LM solves. If not set, one is created
+  // per problem; set it to carry the structure between re-solves of the same
+  // problem. Not used for split components, which each have their own.
+  std::shared_ptr<SymbolicStructure> symbolic_structure;
+
+  // If set, the solve stops when it is cancelled, and reports progress after
+  // each LM iteration, or each SQP step. Not checked by the instrumented
+  // solver used for telemetry.
+  std::shared_ptr<SolveControl> control;
+
+  // If set, the state of the solve is saved to this file, see
+  // SolveCheckpoint, after every checkpoint_interval LM iterations, or outer
+  // iterations of the PENALTY and AUGMENTED_LAGRANGIAN methods, and the solve
+  // resumes from the file when it exists, e.g., after the job running it was
+  // preempted. Not used by the SQP method, with telemetry, multiple starts or
+  // split components.
+  std::string checkpoint_path;
+  size_t checkpoint_interval = 1;
+
+  // If set, every optimize call saves its problem to this file before
+  // solving, see SaveSolveSnapshot, so that it can be replayed offline.
+  std::string snapshot_path;
+
   OptimizationParameters() {
     lm_parameters.setlambdaInitial(1e7);
     lm_parameters.setAbsoluteErrorTol(1e-3);
   }
 };
 
+/// Outcome of a constrained optimization.
+struct OptimizationStatus {
+  bool timed_out = false;  // stopped by the deadline
+  bool cancelled = false;  // stopped through OptimizationParameters::control
+  bool feasible = true;    // all constraints within tolerance
+  double violation = 0;    // norm of the tolerance-scaled violations
+  double error = 0;        // error of the graph, without constraints
+
+  OptimizationStatus() {}
+};
+
+/**
+ * Elimination ordering for trajectory graphs: variables are eliminated one
+ * time slice at a time, in increasing time. Since slices are only coupled to
+ * their neighbors, this amounts to a Riccati-like recursion whose cost is
+ * linear in the number of slices. Within a slice COLAMD is used, and keys
+ * without link or joint index (e.g., phase durations) are eliminated last.
+ */
+gtsam::Ordering TimeOrdering(const gtsam::NonlinearFactorGraph& graph);
+
+/**
+ * Elimination ordering for trajectory graphs by nested dissection over time:
+ * the middle time slice is eliminated last, after the slices before it and
+ * those after it, which are ordered recursively in the same way, down to
+ * runs of at most leaf_slices slices ordered as in TimeOrdering. Since the
+ * middle slice separates the trajectory, the two halves are independent
+ * subtrees of the elimination tree that the multifrontal elimination of
+ * GTSAM can eliminate in parallel, at the cost of some fill-in on the
+ * separators. Within a slice COLAMD is used, and global keys come last.
+ */
+gtsam::Ordering NestedTimeOrdering(const gtsam::NonlinearFactorGraph& graph,
+                                   size_t leaf_slices = 4);
+
+/**
+ * Elimination ordering for dynamics graphs, read off the DynamicsSymbol of
+ * the keys: time slices are eliminated in increasing time as in
+ * TimeOrdering, and within a slice the kinematic tree is eliminated from the
+ * leaves to the root. The tree is inferred from the wrench keys F(i, j), and
+ * from factors on the keys of one joint and of links, e.g., pose factors.
+ * The links of a slice are eliminated in decreasing depth, each with its
+ * link-joint keys (wrenches, contact wrenches) first, then the keys of the
+ * joint to its parent (torque, acceleration, velocity, angle) and then its
+ * own keys (twist acceleration, twist, pose). Keys of joints outside the
+ * tree follow those of the links, and global keys are eliminated last.
+ * @param root  id of the root link, by default the lowest one of every tree
+ */
+gtsam::Ordering DynamicsOrdering(
+    const gtsam::NonlinearFactorGraph& graph,
+    const boost::optional<int>& root = boost::none);
+
+/// Factors and constraints of a connected component, and their variables.
+struct GraphComponent {
+  gtsam::NonlinearFactorGraph graph;
+  EqualityConstraints constraints;
+  gtsam::KeySet keys;
+};
+
+/**
+ * Split a graph and constraints into connected components: two factors or
+ * constraints are in the same component if they are linked by a chain of
+ * shared variables. Components are in the order of their first factor, or
+ * first constraint, and factors without keys are dropped.
+ */
+std::vector<GraphComponent> ConnectedComponents(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints = EqualityConstraints());
+
 /// Base class for GTDynamics optimizer hierarchy.
 class Optimizer {
  protected:
   const OptimizationParameters p_;
 
+  /// Return p_.symbolic_structure, or a new structure if not set.
+  std::shared_ptr<SymbolicStructure> structure() const;
+
+  /**
+   * Return the LM parameters with the ordering of p_, computed through the
+   * structure: the given one, DynamicsOrdering, TimeOrdering, or the one of
+   * the ordering type.
+   */
+  gtsam::LevenbergMarquardtParams lmParameters(
+      const gtsam::NonlinearFactorGraph& graph,
+      SymbolicStructure* structure) const;
+
+  /**
+   * Optimize once from the given initial values with p_.method.
+   * @param proceed  if given, called with the merit error after each LM
+   *                 iteration of the SOFT_CONSTRAINTS method, which stops
+   *                 iterating when it returns false
+   * @param telemetry  if given, LM iterations are recorded to it
+   * @param deadline   when to stop iterating
+   * @param structure  symbolic structure of the problem, structure() if null
+   */
+  gtsam::Values optimizeOnce(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      const std::function<bool(double)>& proceed = nullptr,
+      SolverTelemetry* telemetry = nullptr,
+      const Deadline& deadline = Deadline(),
+      std::shared_ptr<SymbolicStructure> structure = nullptr) const;
+
+  /// Optimize from p_.num_starts starts, sharing one symbolic structure, and
+  /// keep the best result.
+  gtsam::Values optimizeMultiStart(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values, SolverTelemetry* telemetry,
+      const Deadline& deadline,
+      std::shared_ptr<SymbolicStructure> structure = nullptr) const;
+
+  /**
+   * Optimize each component in parallel, from the initial values of its
+   * variables, and merge the results. Variables of no component keep their
+   * initial values. Telemetry is not recorded.
+   */
+  gtsam::Values optimizeComponents(
+      const std::vector<GraphComponent>& components,
+      const gtsam::Values& initial_values, const Deadline& deadline) const;
+
  public:
   /**
    * @fn Constructor.
+   * Throws std::invalid_argument if cancel_ratio is neither 0 nor at least 1.
    */
   Optimizer(const OptimizationParameters& parameters = OptimizationParameters())
-      : p_(parameters) {}
+      : p_(parameters) {
+    if (p_.cancel_ratio != 0 && !(p_.cancel_ratio >= 1)) {
+      throw std::invalid_argument(
+          "Optimizer: cancel_ratio should be 0 (disabled) or at least 1.");
+    }
+  }
 
   /**
    * @brief optimize graph using optimizer settings.
    *
    * @param graph a Nonlinear factor graph built by derived class
    * @param initial_values Initial values for all variables.
+   * @param telemetry (optional) records timing and statistics of iterations.
    * @return Values The result of the optimization.
    */
   // TODO(yetong): remove after discussing with team
   gtsam::Values optimize(const gtsam::NonlinearFactorGraph& graph,
-                         const gtsam::Values& initial_values) const;
+                         const gtsam::Values& initial_values,
+                         SolverTelemetry* telemetry = nullptr) const;
 
   /**
    * @brief optimize with constraints using optimizer settings.
    *
+   * With p_.num_starts > 1, the problem is solved from num_starts initial
+   * values in parallel: the given ones, and perturbations of them by Gaussian
+   * noise of std. dev. start_noise in the tangent space of every variable,
+   * with a fixed seed per start. The result is the feasible solution with the
+   * lowest graph error, or the one with the lowest merit error if none
+   * satisfies all constraints. Early cancellation with cancel_ratio only
+   * applies to SOFT_CONSTRAINTS, the constrained methods run every start to
+   * completion.
+   *
+   * Telemetry is recorded by the SOFT_CONSTRAINTS, PENALTY and
+   * AUGMENTED_LAGRANGIAN methods, for the first start only, and not when
+   * starts are cancelled early.
+   *
+   * With a finite p_.deadline, iterating stops when it passes, and the result
+   * is the best feasible iterate so far, or the last one if none is feasible.
+   * The soft constraints method returns its last iterate, whose merit error
+   * never increases. The deadline is checked between LM iterations, and not
+   * by the instrumented solver used for telemetry.
+   *
+   * With p_.hard_sigma > 0, stiff factors of the graph are moved to the
+   * constraints first, see HardConstraints, and the status error is that of
+   * the remaining factors.
+   *
+   * With p_.split_components, disconnected components are solved as
+   * separate problems, as above and without telemetry, and the status is
+   * that of the merged result.
+   *
    * @param graph a Nonlinear factor graph built by derived class
    * @param initial_values Initial values for all variables.
+   * @param telemetry (optional) records timing and statistics of iterations.
+   * @param status (optional) timed out flag and constraint violation.
    * @return Values The result of the optimization.
    */
   gtsam::Values optimize(const gtsam::NonlinearFactorGraph& graph,
                          const EqualityConstraints& constraints,
-                         const gtsam::Values& initial_values) const;
+                         const gtsam::Values& initial_values,
+                         SolverTelemetry* telemetry = nullptr,
+                         OptimizationStatus* status = nullptr) const;
 };
 }  // namespace gtdynamics
@@ -0,0 +1,268 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OutOfCoreOptimizer.cpp
+ * @brief Levenberg-Marquardt streaming through the time slices of very long
+ * trajectories, with values and factorization paged to disk.
+ */
+
+#include <gtdynamics/optimizer/OutOfCoreOptimizer.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtsam/linear/GaussianConditional.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/nonlinear/NonlinearOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+OutOfCoreOptimizer::OutOfCoreOptimizer(
+    const SliceFactors &factors, const gtsam::LevenbergMarquardtParams &params,
+    const std::string &prefix)
+    : factors_(factors), params_(params), prefix_(prefix) {}
+
+/* ************************************************************************* */
+NonlinearFactorGraph OutOfCoreOptimizer::sliceFactors(
+    const PagedValues &values, size_t k) const {
+  NonlinearFactorGraph graph = factors_(k);
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    for (Key key : factor->keys()) {
+      const size_t slice = values.sliceOf(key);
+      if (slice != k && slice + 1 != k) {
+        throw std::invalid_argument(
+            "OutOfCoreOptimizer: a factor of slice " + std::to_string(k) +
+            " involves " + _GTDKeyFormatter(key) + " of slice " +
+            std::to_string(slice));
+      }
+    }
+  }
+  return graph;
+}
+
+// Linearize the factors of a graph, skipping empty ones.
+static GaussianFactorGraph Linearize(const NonlinearFactorGraph &graph,
+                                     const Values &values) {
+  GaussianFactorGraph linear;
+  for (const auto &factor : graph) {
+    if (factor) linear.push_back(factor->linearize(values));
+  }
+  return linear;
+}
+
+/* ************************************************************************* */
+double OutOfCoreOptimizer::error(const PagedValues &values) const {
+  double error = 0;
+  Values window;
+  for (size_t k = 0; k < values.numSlices(); k++) {
+    Values next = values.slice(k);
+    window.insert(next);
+    error += sliceFactors(values, k).error(window);
+    window = next;
+    if (k > 0) values.release(k - 1);
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void OutOfCoreOptimizer::eliminate(const PagedValues &values, double lambda,
+                                   RecordFile *conditionals) const {
+  const size_t N = values.numSlices(), n = values.dim();
+  const std::vector<size_t> dims = values.dims();
+
+  // Write the conditional of slice k on slice k + 1 as dense R, S and d.
+  auto write = [&](size_t k, const gtsam::GaussianConditional &conditional) {
+    const gtsam::KeyVector keys = values.keys(k);
+    if (conditional.nrFrontals() != keys.size() || conditional.rows() != n ||
+        !std::equal(keys.begin(), keys.end(), conditional.beginFrontals())) {
+      throw gtsam::IndeterminantLinearSystemException(keys.front());
+    }
+    std::map<Key, size_t> columns;
+    const gtsam::KeyVector next = k + 1 < N ? values.keys(k + 1) : keys;
+    for (size_t i = 0, column = 0; i < next.size(); column += dims[i++]) {
+      columns[next[i]] = column;
+    }
+    Matrix record = Matrix::Zero(n, 2 * n + 1);
+    record.leftCols(n) = conditional.get_R();
+    for (auto it = conditional.beginParents(); it != conditional.endParents();
+         ++it) {
+      record.block(0, n + columns.at(*it), n, conditional.getDim(it)) =
+          conditional.getA(it);
+    }
+    record.col(2 * n) = conditional.get_d();
+    conditionals->write(k, record.data());
+  };
+
+  // Eliminate slice k from its factors, with the LM damping.
+  auto eliminateSlice = [&](size_t k, GaussianFactorGraph graph)
+      -> gtsam::GaussianFactor::shared_ptr {
+    const gtsam::KeyVector keys = values.keys(k);
+    for (size_t i = 0; i < keys.size(); i++) {
+      graph.emplace_shared<gtsam::JacobianFactor>(
+          keys[i], std::sqrt(lambda) * Matrix::Identity(dims[i], dims[i]),
+          Vector::Zero(dims[i]));
+    }
+    auto eliminated =
+        gtsam::EliminatePreferCholesky(graph, gtsam::Ordering(keys));
+    write(k, *eliminated.first);
+    return eliminated.second;
+  };
+
+  // The factors on slice k, linearized, and the marginal of earlier slices.
+  GaussianFactorGraph carry;
+  Values window = values.slice(0);
+  carry.push_back(Linearize(sliceFactors(values, 0), window));
+  for (size_t k = 1; k < N; k++) {
+    const Values next = values.slice(k);
+    window.insert(next);
+    const gtsam::KeyVector previous = values.keys(k - 1);
+    const gtsam::KeySet previous_keys(previous.begin(), previous.end());
+    GaussianFactorGraph graph = carry, later;
+    for (const auto &factor : Linearize(sliceFactors(values, k), window)) {
+      const bool involves_previous = std::any_of(
+          factor->begin(), factor->end(),
+          [&](Key key) -> bool { return previous_keys.count(key) > 0; });
+      (involves_previous ? graph : later).push_back(factor);
+    }
+    auto marginal = eliminateSlice(k - 1, graph);
+    if (marginal && !marginal->empty()) later.push_back(marginal);
+    carry = later;
+    window = next;
+    values.release(k - 1);
+  }
+  eliminateSlice(N - 1, carry);
+  values.release(N - 1);
+}
+
+/* ************************************************************************* */
+void OutOfCoreOptimizer::backSubstitute(const RecordFile &conditionals,
+                                        RecordFile *deltas) const {
+  const size_t N = deltas->numRecords(), n = deltas->recordSize();
+  Vector delta = Vector::Zero(n);
+  for (size_t k = N; k-- > 0;) {
+    const double *record = conditionals.record(k);
+    Eigen::Map<const Matrix> R(record, n, n), S(record + n * n, n, n);
+    Eigen::Map<const Vector> d(record + 2 * n * n, n);
+    delta = R.triangularView<Eigen::Upper>().solve(d - S * delta);
+    if (!delta.allFinite()) {
+      throw gtsam::IndeterminantLinearSystemException(0);
+    }
+    deltas->write(k, delta.data());
+    conditionals.release(k);
+  }
+}
+
+/* ************************************************************************* */
+std::unique_ptr<PagedValues> OutOfCoreOptimizer::retract(
+    const PagedValues &values, const RecordFile &deltas,
+    const std::string &name, double *error) const {
+  const std::vector<size_t> dims = values.dims();
+  std::unique_ptr<PagedValues> result;
+  *error = 0;
+  Values window;
+  for (size_t k = 0; k < values.numSlices(); k++) {
+    const gtsam::KeyVector keys = values.keys(k);
+    const double *record = deltas.record(k);
+    gtsam::VectorValues delta;
+    for (size_t i = 0; i < keys.size(); record += dims[i++]) {
+      delta.insert(keys[i], Eigen::Map<const Vector>(record, dims[i]));
+    }
+    const Values next = values.slice(k).retract(delta);
+    if (result) {
+      result->write(k, next);
+    } else {
+      result.reset(new PagedValues(name, next, values.numSlices()));
+    }
+    window.insert(next);
+    *error += sliceFactors(values, k).error(window);
+    window = next;
+    values.release(k);
+    deltas.release(k);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+PagedValues OutOfCoreOptimizer::optimize(const PagedValues &initial) {
+  const size_t N = initial.numSlices(), n = initial.dim();
+  const std::string names[2] = {prefix_ + ".0.values", prefix_ + ".1.values"};
+  auto close = [](std::unique_ptr<PagedValues> *values) {
+    const std::string name = (*values)->name();
+    values->reset();
+    std::remove(name.c_str());
+  };
+
+  // Work on a copy, so that the result is always in a file of the optimizer.
+  size_t c = 0;
+  std::unique_ptr<PagedValues> current(
+      new PagedValues(names[c], initial.slice(0), N));
+  for (size_t k = 1; k < N; k++) {
+    current->write(k, initial.slice(k));
+    initial.release(k);
+  }
+
+  double current_error = error(*current);
+  iterations_ = 0;
+  lambda_ = params_.lambdaInitial;
+  while (iterations_ < size_t(params_.maxIterations)) {
+    // Increase the damping until the error decreases.
+    std::unique_ptr<PagedValues> candidate;
+    double new_error = std::numeric_limits<double>::infinity();
+    while (!candidate) {
+      try {
+        RecordFile conditionals(prefix_ + ".conditionals", n * (2 * n + 1), N,
+                                true);
+        eliminate(*current, lambda_, &conditionals);
+        RecordFile deltas(prefix_ + ".deltas", n, N, true);
+        backSubstitute(conditionals, &deltas);
+        candidate = retract(*current, deltas, names[1 - c], &new_error);
+      } catch (const gtsam::IndeterminantLinearSystemException &) {
+        new_error = std::numeric_limits<double>::infinity();
+      }
+      if (candidate && new_error <= current_error) {
+        lambda_ =
+            std::max(params_.lambdaLowerBound, lambda_ / params_.lambdaFactor);
+        break;
+      }
+      if (candidate) close(&candidate);
+      lambda_ *= params_.lambdaFactor;
+      if (lambda_ >= params_.lambdaUpperBound) break;
+    }
+    if (!candidate) break;
+
+    close(&current);
+    current = std::move(candidate);
+    c = 1 - c;
+    iterations_++;
+    const bool converged =
+        gtsam::checkConvergence(params_, current_error, new_error);
+    current_error = new_error;
+    if (converged) break;
+  }
+  return std::move(*current);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OutOfCoreOptimizer.h
+ * @brief Levenberg-Marquardt streaming through the time slices of very long
+ * trajectories, with values and factorization paged to disk.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/PagedValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * OutOfCoreOptimizer runs Levenberg-Marquardt on trajectories whose values,
+ * or the factorization of one iteration, do not fit in memory. Values are
+ * kept in PagedValues, the factors are built slice by slice when needed, and
+ * each iteration eliminates the slices in time order, as TimeOrdering does,
+ * paging the conditional of each slice out to a RecordFile, then
+ * back-substitutes them in reverse. Only the factors and values of two
+ * slices, and the marginal on the next slice, are in memory at any time.
+ *
+ * The factors of slice k may only involve the variables of slices k - 1 and
+ * k, as those of one time step and one-step collocation factors do. Damping
+ * is the LM default, lambda times the identity; diagonalDamping is ignored.
+ */
+class OutOfCoreOptimizer {
+ public:
+  /// Returns the factors of slice k.
+  using SliceFactors = std::function<gtsam::NonlinearFactorGraph(size_t k)>;
+
+  /**
+   * Constructor.
+   * @param factors  the factors of each slice
+   * @param params   LM parameters
+   * @param prefix   prefix of the files written, next to each other
+   */
+  OutOfCoreOptimizer(
+      const SliceFactors &factors,
+      const gtsam::LevenbergMarquardtParams &params =
+          gtsam::LevenbergMarquardtParams(),
+      const std::string &prefix = "out_of_core");
+
+  /// Return the error of the factors of all slices.
+  double error(const PagedValues &values) const;
+
+  /**
+   * Optimize from the initial values of all slices. The result is in the
+   * file result.name(), which the optimizer keeps; its other files are
+   * removed.
+   * @throws std::invalid_argument if a factor involves other slices.
+   */
+  PagedValues optimize(const PagedValues &initial);
+
+  /// Number of accepted iterations of the last optimize.
+  size_t iterations() const { return iterations_; }
+
+  /// Damping at the end of the last optimize.
+  double lambda() const { return lambda_; }
+
+ private:
+  SliceFactors factors_;
+  gtsam::LevenbergMarquardtParams params_;
+  std::string prefix_;
+  size_t iterations_ = 0;
+  double lambda_ = 0;
+
+  // Return the factors of slice k, checking their keys.
+  gtsam::NonlinearFactorGraph sliceFactors(const PagedValues &values,
+                                           size_t k) const;
+
+  // Eliminate the damped linearization at values slice by slice, writing
+  // the conditional of each slice on the next to a record.
+  void eliminate(const PagedValues &values, double lambda,
+                 RecordFile *conditionals) const;
+
+  // Solve the conditionals from the last slice, writing the update of each.
+  void backSubstitute(const RecordFile &conditionals, RecordFile *deltas) const;
+
+  // Write the updated values to a file and return them, with their error.
+  std::unique_ptr<PagedValues> retract(const PagedValues &values,
+                                       const RecordFile &deltas,
+                                       const std::string &name,
+                                       double *error) const;
+};
+
+}  // namespace gtdynamics
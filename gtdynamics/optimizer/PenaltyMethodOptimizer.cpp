@@ -12,41 +12,173 @@
  */
 
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtdynamics/optimizer/SolveCheckpoint.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <cmath>
+#include <memory>
 
 namespace gtdynamics {
 
+/// Name of the solver in its checkpoints.
+static const char kSolver[] = "PenaltyMethod";
+
+/* ************************************************************************* */
+/**
+ * Predict the solution at penalty mu * rate from the solution x at mu.
+ *
+ * At x the gradient of the merit function f(x) + mu * p(x) vanishes, so its
+ * derivative along the path is A dx/dmu = -grad p(x), with A the Gauss-Newton
+ * Hessian of the merit function. The penalty factors are proportional to mu,
+ * so the step (rate - 1) * mu * dx/dmu solves the linearized merit graph
+ * with the right-hand sides of the cost factors zeroed and those of the
+ * penalty factors scaled by rate - 1, with one linear solve.
+ * Returns none if a factor does not linearize to a JacobianFactor or the
+ * system is indeterminant.
+ */
+static boost::optional<gtsam::Values> PredictSolution(
+    const gtsam::NonlinearFactorGraph& merit_graph, size_t first_penalty,
+    const gtsam::Values& x, double rate, double damping,
+    const gtsam::LevenbergMarquardtParams& lm_parameters) {
+  gtsam::GaussianFactorGraph linear;
+  const gtsam::KeySet keys = merit_graph.keys();
+  linear.reserve(merit_graph.size() + keys.size());
+  for (size_t k = 0; k < merit_graph.size(); k++) {
+    if (!merit_graph[k]) continue;
+    auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+        merit_graph[k]->linearize(x));
+    if (!jacobian) return boost::none;
+    if (k < first_penalty) {
+      jacobian->getb().setZero();
+    } else {
+      jacobian->getb() *= rate - 1.0;
+    }
+    linear.push_back(jacobian);
+  }
+  const double sqrt_damping = std::sqrt(damping);
+  for (gtsam::Key key : keys) {
+    const size_t dim = x.at(key).dim();
+    linear.emplace_shared<gtsam::JacobianFactor>(
+        key, sqrt_damping * gtsam::Matrix::Identity(dim, dim),
+        gtsam::Vector::Zero(dim));
+  }
+
+  try {
+    const gtsam::VectorValues delta =
+        lm_parameters.ordering ? linear.optimize(*lm_parameters.ordering)
+                               : linear.optimize();
+    return x.retract(delta);
+  } catch (const gtsam::IndeterminantLinearSystemException&) {
+    return boost::none;
+  }
+}
+
 gtsam::Values PenaltyMethodOptimizer::optimize(
     const gtsam::NonlinearFactorGraph& graph,
     const EqualityConstraints& constraints, const gtsam::Values& initial_values,
     ConstrainedOptResult* intermediate_result) const {
   gtsam::Values values = initial_values;
   double mu = p_.initial_mu;
+  const Deadline deadline(p_.deadline, p_.control);
+  BestFeasibleIterate best;
+
+  // Continue from the checkpoint of an interrupted solve, if any.
+  size_t first_iteration = 0;
+  const bool checkpoint = !p_.checkpoint_path.empty();
+  boost::optional<SolveCheckpoint> resumed;
+  if (checkpoint) {
+    resumed = LoadSolveCheckpoint(p_.checkpoint_path, kSolver, initial_values);
+  }
+  if (resumed) {
+    values = resumed->values;
+    mu = resumed->mu;
+    first_iteration = resumed->iterations;
+  }
+
+  // The merit graph is the cost factors followed by one penalty factor per
+  // constraint, created once and updated in place as mu increases.
+  gtsam::NonlinearFactorGraph merit_graph = graph;
+  const size_t first_penalty = merit_graph.size();
+  for (auto& constraint : constraints) {
+    merit_graph.add(constraint->createFactor(mu));
+  }
+
+  // Its symbolic structure, with the elimination ordering, is the same in
+  // all outer iterations.
+  const auto structure = p_.symbolic_structure
+                             ? p_.symbolic_structure
+                             : std::make_shared<SymbolicStructure>();
+  const gtsam::LevenbergMarquardtParams lm_parameters =
+      StructuredParameters(merit_graph, p_.lm_parameters, structure.get());
 
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
-  for (int i = 0; i < p_.num_iterations; i++) {
-    gtsam::NonlinearFactorGraph merit_graph = graph;
+  boost::optional<gtsam::Values> predicted;
+  for (size_t i = first_iteration;
+       i < p_.num_iterations && !deadline.expired(); i++) {
+    // Update the penalty terms of constraints.
+    for (size_t k = 0; i > first_iteration && k < constraints.size(); k++) {
+      const auto& constraint = constraints[k];
+      if (!constraint->updateFactor(*merit_graph.at(first_penalty + k), mu)) {
+        merit_graph.replace(first_penalty + k, constraint->createFactor(mu));
+      }
+    }
 
-    // Create factors corresponding to penalty terms of constraints.
-    for (auto& constraint : constraints) {
-      merit_graph.add(constraint->createFactor(mu));
+    // Start from the predicted solution if it is better at the new mu.
+    if (predicted &&
+        merit_graph.error(*predicted) < merit_graph.error(values)) {
+      values = *predicted;
     }
+    predicted = boost::none;
 
-    // Run optimization.
-    gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
-    auto result = optimizer.optimize();
+    // Run optimization, instrumented if telemetry is requested.
+    gtsam::Values result;
+    size_t num_iters;
+    if (intermediate_result != nullptr && intermediate_result->telemetry) {
+      result = InstrumentedLevenbergMarquardt(
+          merit_graph, values, lm_parameters, intermediate_result->telemetry,
+          i, &num_iters, structure.get());
+    } else {
+      result = LevenbergMarquardtUntil(merit_graph, values, lm_parameters,
+                                       deadline, &num_iters, nullptr,
+                                       structure);
+    }
 
     // Save results and update parameters.
     values = result;
+    if (p_.predictor && i + 1 < p_.num_iterations && !deadline.expired()) {
+      predicted = PredictSolution(merit_graph, first_penalty, values,
+                                  p_.mu_increase_rate, p_.predictor_damping,
+                                  lm_parameters);
+    }
     mu *= p_.mu_increase_rate;
+    if (!deadline.unlimited()) best.update(graph, constraints, values);
 
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
       intermediate_result->intermediate_values.push_back(values);
-      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
+      intermediate_result->num_iters.push_back(num_iters);
       intermediate_result->mu_values.push_back(mu);
     }
+
+    // Save the state to resume from.
+    if (checkpoint && (CheckpointDue(i + 1, p_.checkpoint_interval) ||
+                       i + 1 == p_.num_iterations || deadline.expired())) {
+      SolveCheckpoint state;
+      state.solver = kSolver;
+      state.values = values;
+      state.iterations = i + 1;
+      state.mu = mu;
+      SaveSolveCheckpoint(state, p_.checkpoint_path);
+    }
+  }
+
+  // Out of time: return the best feasible iterate, if any.
+  if (deadline.expired()) {
+    if (intermediate_result != nullptr) intermediate_result->timed_out = true;
+    if (best.values()) return *best.values();
   }
   return values;
 }
@@ -24,6 +24,12 @@ struct PenaltyMethodParameters : public ConstrainedOptimizationParameters {
   double initial_mu;        // initial penalty parameter
   double mu_increase_rate;  // increase rate of penalty parameter
 
+  // If set, each penalty level starts from a first-order prediction of its
+  // solution, along the tangent of the solution path with respect to mu at
+  // the previous solution, when that lowers the merit error at the new mu.
+  bool predictor = false;
+  double predictor_damping = 1e-9;  // diagonal damping of the tangent solve
+
   /** Constructor. */
   PenaltyMethodParameters()
       : Base(gtsam::LevenbergMarquardtParams()),
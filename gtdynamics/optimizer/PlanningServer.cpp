@@ -0,0 +1,328 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanningServer.cpp
+ * @brief Resident planner with warm robot, gait and solution caches.
+ */
+
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/optimizer/PlanningServer.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/WalkCycle.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::noiseModel::Isotropic;
+using gtsam::noiseModel::Unit;
+
+namespace gtdynamics {
+
+namespace {
+// Split a string at a separator, with no empty parts.
+std::vector<std::string> Split(const std::string &s, const std::string &sep) {
+  std::vector<std::string> parts;
+  boost::algorithm::split(parts, s, boost::is_any_of(sep),
+                          boost::token_compress_on);
+  parts.erase(std::remove(parts.begin(), parts.end(), ""), parts.end());
+  return parts;
+}
+
+// Parse a number, throws std::invalid_argument naming the key if malformed.
+double ParseNumber(const std::string &key, const std::string &value) {
+  try {
+    size_t end;
+    const double x = std::stod(value, &end);
+    if (end == value.size()) return x;
+  } catch (const std::exception &) {
+  }
+  throw std::invalid_argument("PlanRequest: bad " + key + " '" + value + "'");
+}
+
+// Parse a point "x,y,z".
+Point3 ParsePoint(const std::string &key, const std::string &value) {
+  const auto parts = Split(value, ",");
+  if (parts.size() != 3) {
+    throw std::invalid_argument("PlanRequest: bad " + key + " '" + value +
+                                "'");
+  }
+  return Point3(ParseNumber(key, parts[0]), ParseNumber(key, parts[1]),
+                ParseNumber(key, parts[2]));
+}
+}  // namespace
+
+/* ************************************************************************* */
+PlanRequest PlanRequest::Parse(const std::string &line) {
+  PlanRequest request;
+  for (const std::string &token : Split(line, " \t\r\n")) {
+    const size_t eq = token.find('=');
+    if (eq == std::string::npos) {
+      throw std::invalid_argument("PlanRequest: expected key=value, got '" +
+                                  token + "'");
+    }
+    const std::string key = token.substr(0, eq), value = token.substr(eq + 1);
+    if (key == "id") {
+      request.id = value;
+    } else if (key == "robot") {
+      request.robot = value;
+    } else if (key == "name") {
+      request.name = value;
+    } else if (key == "base") {
+      request.base = value;
+    } else if (key == "output") {
+      request.output = value;
+    } else if (key == "phase") {
+      const size_t colon = value.find(':');
+      const double steps = ParseNumber(key, value.substr(0, colon));
+      if (steps < 1 || steps != static_cast<int>(steps)) {
+        throw std::invalid_argument("PlanRequest: bad phase '" + value + "'");
+      }
+      request.phase_steps.push_back(static_cast<int>(steps));
+      request.phase_links.push_back(
+          colon == std::string::npos ? std::vector<std::string>()
+                                     : Split(value.substr(colon + 1), ","));
+    } else if (key == "contact") {
+      request.contact = ParsePoint(key, value);
+    } else if (key == "step") {
+      request.step = ParsePoint(key, value);
+    } else if (key == "cycles") {
+      const double cycles = ParseNumber(key, value);
+      if (cycles < 1 || cycles != static_cast<size_t>(cycles)) {
+        throw std::invalid_argument("PlanRequest: bad cycles '" + value +
+                                    "'");
+      }
+      request.cycles = static_cast<size_t>(cycles);
+    } else if (key == "height") {
+      request.height = ParseNumber(key, value);
+    } else if (key == "ground") {
+      request.ground = ParseNumber(key, value);
+    } else if (key == "dt") {
+      request.dt = ParseNumber(key, value);
+      if (request.dt <= 0) {
+        throw std::invalid_argument("PlanRequest: bad dt '" + value + "'");
+      }
+    } else {
+      throw std::invalid_argument("PlanRequest: unknown key '" + key + "'");
+    }
+  }
+  if (request.robot.empty()) {
+    throw std::invalid_argument("PlanRequest: no robot.");
+  }
+  if (request.phase_steps.empty()) {
+    throw std::invalid_argument("PlanRequest: no phase.");
+  }
+  return request;
+}
+
+/* ************************************************************************* */
+gtsam::Vector PlanRequest::boundary() const {
+  return (gtsam::Vector(4) << step, height).finished();
+}
+
+/* ************************************************************************* */
+std::string PlanResponse::toString() const {
+  std::ostringstream ss;
+  ss << (ok ? "ok" : "error");
+  if (!id.empty()) ss << " id=" << id;
+  if (ok) {
+    ss << " error=" << status.error << " feasible=" << status.feasible
+       << " timed_out=" << status.timed_out << " warm_start=" << warm_started
+       << " seconds=" << seconds;
+  } else {
+    ss << " message=" << message;
+  }
+  return ss.str();
+}
+
+/* ************************************************************************* */
+PlanningServer::PlanningServer(const PlanningServerParams &params)
+    : params_(params),
+      executor_(std::make_shared<SolveExecutor>(params.num_threads)) {}
+
+/* ************************************************************************* */
+size_t PlanningServer::numRobots() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return models_.size();
+}
+
+/* ************************************************************************* */
+size_t PlanningServer::numSolutions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return solutions_.size();
+}
+
+/* ************************************************************************* */
+std::shared_ptr<PlanningServer::Model> PlanningServer::model(
+    const std::string &robot, const std::string &name) {
+  const std::string key = robot + "|" + name;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(key);
+    if (it != models_.end()) return it->second;
+  }
+
+  // Parse outside the lock; if two workers race, the first one is kept.
+  auto model = std::make_shared<Model>();
+  model->robot = CreateRobotFromFile(params_.model_directory + robot, name);
+  OptimizerSetting opt(params_.sigma_dynamics);
+  const DynamicsGraph graph_builder(opt, params_.gravity);
+  model->gaits.reset(new GaitLibrary(model->robot, graph_builder,
+                                     CollocationScheme::Euler, params_.mu));
+  std::lock_guard<std::mutex> lock(mutex_);
+  return models_.emplace(key, model).first->second;
+}
+
+/* ************************************************************************* */
+std::shared_ptr<SymbolicStructure> PlanningServer::structure(
+    const TaskDescriptor &task) {
+  std::ostringstream key;
+  key << task.structure();
+  for (int steps : task.phase_steps) key << "|" << steps;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &structure = structures_[key.str()];
+  if (!structure) structure = std::make_shared<SymbolicStructure>();
+  return structure;
+}
+
+/* ************************************************************************* */
+void PlanningServer::remember(const TaskDescriptor &task,
+                              const Values &solution) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  recent_.emplace_back(task, solution);
+  if (recent_.size() <= params_.max_solutions) {
+    solutions_.insert(task, solution);
+    return;
+  }
+  // The cache has no removal, so rebuild it from the recent solutions.
+  while (recent_.size() > params_.max_solutions) recent_.pop_front();
+  solutions_ = SolutionCache();
+  for (auto &&entry : recent_) solutions_.insert(entry.task, entry.solution);
+}
+
+/* ************************************************************************* */
+PlanResponse PlanningServer::plan(const PlanRequest &request) {
+  PlanResponse response;
+  response.id = request.id;
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    const auto model = this->model(request.robot, request.name);
+    const Robot &robot = model->robot;
+
+    // The gait cycle.
+    FootContactVector states;
+    std::vector<size_t> phase_lengths;
+    for (size_t p = 0; p < request.phase_steps.size(); p++) {
+      std::vector<LinkSharedPtr> links;
+      for (auto &&name : request.phase_links[p]) {
+        links.push_back(robot.link(name));
+      }
+      states.push_back(boost::make_shared<FootContactConstraintSpec>(
+          links, request.contact));
+      phase_lengths.push_back(request.phase_steps[p]);
+    }
+    const Trajectory trajectory(WalkCycle(states, phase_lengths),
+                                request.cycles);
+
+    // Dynamics from the gait library, and objectives as in the walking
+    // examples.
+    NonlinearFactorGraph graph;
+    {
+      std::lock_guard<std::mutex> lock(model->mutex);
+      graph = model->gaits->multiPhaseFactorGraph(trajectory);
+    }
+    auto dynamics_model_6 = Isotropic::Sigma(6, params_.sigma_dynamics),
+         objectives_model_6 = Isotropic::Sigma(6, params_.sigma_objectives),
+         objectives_model_1 = Isotropic::Sigma(1, params_.sigma_objectives);
+    NonlinearFactorGraph objectives = trajectory.contactPointObjectives(
+        robot, Isotropic::Sigma(3, 1e-7), request.step, request.ground);
+    const int K = trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+    auto base_link = robot.link(request.base);
+    for (int k = 0; k <= K; k++) {
+      objectives.add(LinkObjectives(base_link->id(), k)
+                         .pose(Pose3(Rot3(), Point3(0, 0, request.height)),
+                               Isotropic::Sigma(6, 5e-5))
+                         .twist(gtsam::Z_6x1, Isotropic::Sigma(6, 5e-5)));
+    }
+    trajectory.addBoundaryConditions(&objectives, robot, dynamics_model_6,
+                                     dynamics_model_6, objectives_model_6,
+                                     objectives_model_1, objectives_model_1);
+    trajectory.addIntegrationTimeFactors(&objectives, request.dt, 1e-30);
+    trajectory.addMinimumTorqueFactors(&objectives, robot, Unit::Create(1));
+    graph.add(objectives);
+
+    // Warm start from the nearest cached solution with the same structure.
+    const TaskDescriptor task = TaskDescriptor::FromTrajectory(
+        request.robot + "|" + request.name, trajectory, request.boundary());
+    boost::optional<Values> warm_start;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      warm_start = solutions_.warmStart(task, params_.max_warm_distance);
+    }
+    Values initial;
+    if (warm_start) {
+      initial = *warm_start;
+      response.warm_started = true;
+    } else {
+      initial = trajectory.multiPhaseInitialValues(robot, Initializer(), 1e-5,
+                                                   request.dt);
+    }
+
+    OptimizationParameters parameters = params_.optimization;
+    parameters.symbolic_structure = structure(task);
+    const Optimizer optimizer(parameters);
+    response.values = optimizer.optimize(graph, EqualityConstraints(), initial,
+                                         nullptr, &response.status);
+    response.ok = true;
+    remember(task, response.values);
+
+    if (!request.output.empty()) {
+      trajectory.writeToBinaryFile(robot, request.output, response.values);
+    }
+  } catch (const std::exception &e) {
+    response.ok = false;
+    response.message = e.what();
+  }
+  response.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  return response;
+}
+
+/* ************************************************************************* */
+std::string PlanningServer::handle(const std::string &line) {
+  PlanRequest request;
+  try {
+    request = PlanRequest::Parse(line);
+  } catch (const std::exception &e) {
+    PlanResponse response;
+    response.message = e.what();
+    return response.toString();
+  }
+  return plan(request).toString();
+}
+
+/* ************************************************************************* */
+void PlanningServer::submit(
+    const std::string &line,
+    const std::function<void(const std::string &)> &reply) {
+  executor_->submit([this, line, reply]() { reply(handle(line)); });
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,165 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanningServer.h
+ * @brief Resident planner with warm robot, gait and solution caches.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/AsyncOptimizer.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SymbolicStructure.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/GaitLibrary.h>
+#include <gtdynamics/utils/SolutionCache.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * A walking problem, as in the spider and A1 walking examples: a gait cycle
+ * repeated a number of times, with the contact points stepping ahead and the
+ * base held at a height.
+ *
+ * Requests are single lines of space-separated key=value tokens, e.g.
+ *   id=7 robot=spider_alt.sdf name=spider phase=1:tarsus_1_L1,tarsus_2_L2
+ *   phase=2:tarsus_2_L2 contact=0,0.19,0 cycles=1 step=0,0.4,0 base=body
+ * with keys
+ *   id       echoed in the response
+ *   robot    URDF or SDF file, relative to the server model directory
+ *   name     model name in the file, optional
+ *   phase    steps:contact links, comma-separated, repeated for each phase
+ *   contact  contact point in the link COM frames
+ *   cycles   number of repetitions of the phases
+ *   step     displacement of the contact points over a step
+ *   base     name of the base link
+ *   height   base height
+ *   ground   ground height in the rest configuration of the robot file
+ *   dt       desired time step
+ *   output   binary trajectory file to write the solution to, optional
+ */
+struct PlanRequest {
+  std::string id, robot, name, base = "body", output;
+  std::vector<int> phase_steps;
+  std::vector<std::vector<std::string>> phase_links;
+  gtsam::Point3 contact = gtsam::Point3::Zero(), step = gtsam::Point3::Zero();
+  size_t cycles = 1;
+  double height = 0.5, ground = 1.0, dt = 1. / 240;
+
+  /// Parse a request line, throws std::invalid_argument if malformed.
+  static PlanRequest Parse(const std::string &line);
+
+  /// Return the boundary vector of the task, the step and the height.
+  gtsam::Vector boundary() const;
+};
+
+/// Result of a plan.
+struct PlanResponse {
+  std::string id;
+  bool ok = false;
+  std::string message;      // the error if not ok
+  OptimizationStatus status;
+  bool warm_started = false;  // initial values from a cached solution
+  double seconds = 0;         // time to build and solve the problem
+  gtsam::Values values;
+
+  /// Return the response line, "ok ..." with the status, or "error ...".
+  std::string toString() const;
+};
+
+/// Parameters of a PlanningServer.
+struct PlanningServerParams {
+  OptimizationParameters optimization;  // parameters of every solve
+  std::string model_directory;          // prefix of robot files
+  double sigma_dynamics = 1e-5, sigma_objectives = 1e-6, mu = 1.0;
+  gtsam::Vector3 gravity = gtsam::Vector3(0, 0, -9.8);
+  size_t num_threads = 0;  // workers, one per hardware thread if 0
+  double max_warm_distance = std::numeric_limits<double>::infinity();
+  size_t max_solutions = 256;  // solutions kept, dropping the oldest
+
+  PlanningServerParams() {}
+};
+
+/**
+ * PlanningServer keeps everything that does not depend on the request warm
+ * across requests: parsed robots, a GaitLibrary per robot, so graphs of
+ * known contact patterns are stamped from cached slices, the symbolic
+ * structure of each problem shape, and a SolutionCache of recent plans to
+ * warm start similar ones. Requests are planned concurrently on a
+ * SolveExecutor; the caches are shared between workers, with each gait
+ * library used by one worker at a time.
+ *
+ * The transport is left to the caller, see example_planning_server for a
+ * line protocol over TCP.
+ */
+class PlanningServer {
+ private:
+  // A parsed robot and its gait library.
+  struct Model {
+    Robot robot;
+    std::unique_ptr<GaitLibrary> gaits;
+    std::mutex mutex;  // guards gaits
+  };
+
+  PlanningServerParams params_;
+
+  mutable std::mutex mutex_;  // guards the members below
+  std::map<std::string, std::shared_ptr<Model>> models_;
+  std::map<std::string, std::shared_ptr<SymbolicStructure>> structures_;
+  SolutionCache solutions_;
+  std::deque<SolutionCache::Entry> recent_;  // solutions_, oldest first
+
+  // Last, so queued requests finish before the caches are destroyed.
+  std::shared_ptr<SolveExecutor> executor_;
+
+  // Return the model of a robot file, parsing it if needed.
+  std::shared_ptr<Model> model(const std::string &robot,
+                               const std::string &name);
+
+  // Return the symbolic structure of a task shape, creating it if needed.
+  std::shared_ptr<SymbolicStructure> structure(const TaskDescriptor &task);
+
+  // Add a solution, dropping the oldest beyond max_solutions.
+  void remember(const TaskDescriptor &task, const gtsam::Values &solution);
+
+ public:
+  /// Constructor.
+  explicit PlanningServer(
+      const PlanningServerParams &params = PlanningServerParams());
+
+  /// Return the number of parsed robots.
+  size_t numRobots() const;
+
+  /// Return the number of cached solutions.
+  size_t numSolutions() const;
+
+  /// Plan on the calling thread; errors are reported in the response.
+  PlanResponse plan(const PlanRequest &request);
+
+  /// Parse a request line, plan it and return the response line.
+  std::string handle(const std::string &line);
+
+  /**
+   * Queue a request line on the workers, and call reply with the response
+   * line on the worker thread when done.
+   */
+  void submit(const std::string &line,
+              const std::function<void(const std::string &)> &reply);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.cpp
+ * @brief Sequential quadratic programming for equality constrained problems.
+ */
+
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtdynamics/optimizer/WrenchElimination.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelLinearize.h>
+#include <gtdynamics/utils/Profiler.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::JacobianFactor;
+using gtsam::Values;
+using gtsam::VectorValues;
+
+/* ************************************************************************* */
+// Sum of the l1 norms of the tolerance-scaled violations.
+static double L1Violation(const EqualityConstraints& constraints,
+                          const Values& x) {
+  double result = 0;
+  for (const auto& v : constraints.evaluate(x).scaled) result += v.lpNorm<1>();
+  return result;
+}
+
+/* ************************************************************************* */
+gtsam::Values SQPOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  Values values = initial_values;
+  double rho = p_.initial_rho;
+
+  // Constraint factors with unit penalty, whose whitened linearization is the
+  // linearized tolerance-scaled constraint.
+  gtsam::NonlinearFactorGraph constraint_graph;
+  for (const auto& constraint : constraints) {
+    constraint_graph.add(constraint->createFactor(1.0));
+  }
+
+  boost::optional<gtsam::Ordering> ordering = p_.lm_parameters.ordering;
+  if (ordering && p_.eliminate_wrenches) ordering = WithoutWrenches(*ordering);
+  const double sqrt_damping = std::sqrt(p_.damping);
+  const Deadline deadline(p_.deadline, p_.control);
+  BestFeasibleIterate best;
+
+  for (size_t i = 0; i < p_.max_iterations && !deadline.expired(); i++) {
+    GTD_PROFILE_SCOPE("SQPOptimizer iteration");
+    // Gauss-Newton model of the cost.
+    const auto cost = ParallelLinearize(graph, values);
+
+    // KKT system: cost, damping, and linearized constraints as hard ones.
+    GaussianFactorGraph kkt = *cost;
+    for (const auto& key_value : values.zeroVectors()) {
+      const size_t d = key_value.second.size();
+      kkt.emplace_shared<JacobianFactor>(
+          key_value.first, sqrt_damping * gtsam::Matrix::Identity(d, d),
+          gtsam::Vector::Zero(d));
+    }
+    for (const auto& factor : *ParallelLinearize(constraint_graph, values)) {
+      auto jacobian = boost::dynamic_pointer_cast<JacobianFactor>(factor);
+      kkt.emplace_shared<JacobianFactor>(
+          jacobian->keys(), jacobian->matrixObject(),
+          InternedConstrained(jacobian->rows()));
+    }
+
+    VectorValues delta;
+    if (p_.eliminate_wrenches) {
+      const WrenchElimination elimination =
+          EliminateWrenches(kkt, gtsam::EliminateQR);
+      if (!ordering) ordering = gtsam::Ordering::Colamd(elimination.reduced);
+      delta = elimination.backSubstitute(
+          elimination.reduced.optimize(*ordering, gtsam::EliminateQR));
+    } else {
+      if (!ordering) ordering = gtsam::Ordering::Colamd(kkt);
+      delta = kkt.optimize(*ordering, gtsam::EliminateQR);
+    }
+
+    // Directional derivative of the merit function along delta, raising rho
+    // so that delta is a descent direction, as in Nocedal & Wright (18.36).
+    const VectorValues zero = delta.zeroVectors();
+    const double gradient = cost->gradientAtZero().dot(delta);
+    const double curvature =
+        std::max(0.0, 2 * (cost->error(delta) - cost->error(zero) - gradient));
+    const double violation = L1Violation(constraints, values);
+    if (violation > 0) {
+      rho = std::max(rho, (gradient + 0.5 * curvature) / (0.5 * violation));
+    }
+    const double derivative = gradient - rho * violation;
+
+    // Backtracking line search on the merit function.
+    auto merit = [&](const Values& x) {
+      return ParallelError(graph, x) + rho * L1Violation(constraints, x);
+    };
+    const double current_merit = merit(values);
+    double alpha = 1.0;
+    size_t num_steps = 1;
+    Values next = values.retract(delta);
+    while (merit(next) > current_merit + p_.armijo * alpha * derivative &&
+           alpha > p_.min_step) {
+      alpha *= 0.5;
+      num_steps++;
+      next = values.retract(delta.scale(alpha));
+    }
+    values = next;
+    if (!deadline.unlimited()) {
+      best.update(graph, constraints, values);
+      deadline.iterated(ParallelError(graph, values));
+    }
+
+    /// Store intermediate results.
+    if (intermediate_result != nullptr) {
+      intermediate_result->intermediate_values.push_back(values);
+      intermediate_result->num_iters.push_back(num_steps);
+      intermediate_result->mu_values.push_back(rho);
+    }
+
+    if (alpha * delta.vector().lpNorm<Eigen::Infinity>() <
+        p_.step_tolerance) {
+      break;
+    }
+  }
+
+  // Out of time: return the best feasible iterate, if any.
+  if (deadline.expired()) {
+    if (intermediate_result != nullptr) intermediate_result->timed_out = true;
+    if (best.values()) return *best.values();
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.h
+ * @brief Sequential quadratic programming for equality constrained problems.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/ConstrainedOptimizer.h>
+
+namespace gtdynamics {
+
+/// Parameters for sequential quadratic programming.
+struct SQPParameters : public ConstrainedOptimizationParameters {
+  using Base = ConstrainedOptimizationParameters;
+  size_t max_iterations = 100;   // number of QP subproblems
+  double damping = 1e-6;         // diagonal added to the Gauss-Newton Hessian
+  double step_tolerance = 1e-8;  // stop when the step is shorter than this
+  double initial_rho = 1.0;      // initial weight of violations in the merit
+  double armijo = 1e-4;          // sufficient decrease of the line search
+  double min_step = 1e-6;        // smallest line search step
+  bool eliminate_wrenches = false;  // Schur complement of wrenches per slice
+
+  /** Constructor. */
+  SQPParameters() : Base(gtsam::LevenbergMarquardtParams()) {}
+
+  /** Constructor, only the ordering of the LM parameters is used. */
+  SQPParameters(const gtsam::LevenbergMarquardtParams& _lm_parameters)
+      : Base(_lm_parameters) {}
+};
+
+/**
+ * Sequential quadratic programming only considering equality constraints.
+ *
+ * Each iteration linearizes the cost graph, giving a Gauss-Newton model of the
+ * cost, and the constraints, whose linearizations become hard constraints
+ * with a Constrained noise model. The resulting KKT system is a Gaussian
+ * factor graph, solved by sparse QR elimination, which handles the hard
+ * constraints without forming multipliers. The step is then scaled by a
+ * backtracking line search on the l1 merit function
+ * f(x) + rho * sum_i ||g_i(x)/tolerance_i||_1, with rho increased as needed
+ * for the step to be a descent direction.
+ *
+ * The ordering in the LM parameters is used if given, otherwise COLAMD is
+ * computed once, as the structure of the KKT system does not change.
+ *
+ * With eliminate_wrenches, the joint wrenches of each time slice are first
+ * eliminated locally, see EliminateWrenches, and only the much smaller
+ * reduced system is eliminated globally, ordered without the wrenches.
+ */
+class SQPOptimizer : public ConstrainedOptimizer {
+ protected:
+  const SQPParameters p_;
+
+ public:
+  /** Default constructor. */
+  SQPOptimizer() : p_(SQPParameters()) {}
+
+  /** Construct from parameters. */
+  SQPOptimizer(const SQPParameters& parameters) : p_(parameters) {}
+
+  /**
+   * Run optimization, intermediate results hold the values, the number of
+   * line search steps and rho of each iteration.
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelectiveMarginals.cpp
+ * @brief Marginal covariances of a few variables of a large graph.
+ */
+
+#include <gtdynamics/optimizer/SelectiveMarginals.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::Matrix;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+SelectiveMarginals::SelectiveMarginals(const gtsam::NonlinearFactorGraph &graph,
+                                       const gtsam::Values &solution,
+                                       const KeyVector &keys)
+    : keys_(keys) {
+  const auto linear = graph.linearize(solution);
+  const gtsam::Ordering ordering =
+      gtsam::Ordering::ColamdConstrainedLast(*linear, keys);
+  bayes_tree_ = *linear->eliminateMultifrontal(ordering);
+  compute();
+}
+
+/* ************************************************************************* */
+SelectiveMarginals::SelectiveMarginals(
+    const gtsam::GaussianBayesTree &bayes_tree, const KeyVector &keys)
+    : bayes_tree_(bayes_tree), keys_(keys) {
+  compute();
+}
+
+/* ************************************************************************* */
+void SelectiveMarginals::compute() {
+  // Offsets of the requested keys, with dimensions from their cliques.
+  size_t total = 0;
+  for (Key key : keys_) {
+    if (offsets_.count(key)) {
+      throw std::invalid_argument("SelectiveMarginals: duplicate key.");
+    }
+    if (!bayes_tree_.nodes().count(key)) {
+      throw std::invalid_argument("SelectiveMarginals: key not in the graph.");
+    }
+    const auto conditional = bayes_tree_[key]->conditional();
+    offsets_[key] = total;
+    dims_[key] = conditional->getDim(conditional->find(key));
+    total += dims_[key];
+  }
+  covariance_ = Matrix::Zero(total, total);
+  if (keys_.empty()) return;
+
+  // With all keys in one root clique, invert the information of its
+  // conditional only.
+  const auto &root = bayes_tree_[keys_.front()];
+  const auto conditional = root->conditional();
+  bool in_root = !root->parent();
+  for (Key key : keys_) {
+    in_root = in_root && bayes_tree_[key] == root;
+  }
+  if (in_root) {
+    Matrix R = conditional->R();
+    if (conditional->get_model()) R = conditional->get_model()->Whiten(R);
+    const Matrix R_inverse = R.triangularView<Eigen::Upper>().solve(
+        Matrix::Identity(R.rows(), R.cols()));
+    const Matrix root_covariance = R_inverse * R_inverse.transpose();
+
+    std::map<Key, size_t> root_offsets;
+    size_t offset = 0;
+    for (auto it = conditional->beginFrontals();
+         it != conditional->endFrontals(); ++it) {
+      root_offsets[*it] = offset;
+      offset += conditional->getDim(it);
+    }
+    for (Key i : keys_) {
+      for (Key j : keys_) {
+        covariance_.block(offsets_[i], offsets_[j], dims_[i], dims_[j]) =
+            root_covariance.block(root_offsets[i], root_offsets[j], dims_[i],
+                                  dims_[j]);
+      }
+    }
+    return;
+  }
+
+  // Otherwise, as gtsam::Marginals: blocks of marginal factors of each key
+  // and of the joint factors of each pair.
+  for (size_t a = 0; a < keys_.size(); a++) {
+    const Key i = keys_[a];
+    covariance_.block(offsets_[i], offsets_[i], dims_[i], dims_[i]) =
+        bayes_tree_.marginalFactor(i)->information().inverse();
+    for (size_t b = a + 1; b < keys_.size(); b++) {
+      const Key j = keys_[b];
+      const auto joint = bayes_tree_.joint(i, j);
+      const gtsam::Ordering ordering(KeyVector{i, j});
+      const Matrix information = joint->hessian(ordering).first;
+      const Matrix block =
+          information.inverse().topRightCorner(dims_[i], dims_[j]);
+      covariance_.block(offsets_[i], offsets_[j], dims_[i], dims_[j]) = block;
+      covariance_.block(offsets_[j], offsets_[i], dims_[j], dims_[i]) =
+          block.transpose();
+    }
+  }
+}
+
+/* ************************************************************************* */
+Matrix SelectiveMarginals::jointCovariance(const KeyVector &keys) const {
+  std::vector<size_t> offsets;
+  size_t total = 0;
+  for (Key key : keys) {
+    if (!offsets_.count(key)) {
+      throw std::invalid_argument("SelectiveMarginals: key not requested.");
+    }
+    offsets.push_back(total);
+    total += dims_.at(key);
+  }
+  Matrix covariance(total, total);
+  for (size_t a = 0; a < keys.size(); a++) {
+    const size_t rows = dims_.at(keys[a]);
+    for (size_t b = 0; b < keys.size(); b++) {
+      const size_t cols = dims_.at(keys[b]);
+      covariance.block(offsets[a], offsets[b], rows, cols) =
+          covariance_.block(offsets_.at(keys[a]), offsets_.at(keys[b]), rows,
+                            cols);
+    }
+  }
+  return covariance;
+}
+
+/* ************************************************************************* */
+Matrix SelectiveMarginals::marginalCovariance(Key key) const {
+  return jointCovariance(KeyVector{key});
+}
+
+}  // namespace gtdynamics
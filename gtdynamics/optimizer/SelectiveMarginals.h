@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelectiveMarginals.h
+ * @brief Marginal covariances of a few variables of a large graph.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+
+namespace gtdynamics {
+
+/**
+ * SelectiveMarginals computes the joint marginal covariance of a requested
+ * set of keys only, e.g. end-effector and base poses at a few slices of a
+ * trajectory, instead of the marginals of all variables.
+ *
+ * From a graph, the linearization at the solution is eliminated with the
+ * requested keys constrained last in a COLAMD ordering, so that they end up
+ * in the root clique of the Bayes tree. Their joint covariance is then the
+ * inverse of the information R^T R of the root conditional alone, at a cost
+ * cubic in the dimension of the requested set, on top of one elimination.
+ *
+ * A Bayes tree already computed, e.g. by the last linear solve of an
+ * optimizer, can be reused. Keys not in its root clique are then recovered
+ * per key and per pair, as gtsam::Marginals does, which costs a shortcut to
+ * the root for each.
+ *
+ * As for gtsam::Marginals, all noise models should be Gaussian: constrained
+ * directions have no finite covariance.
+ */
+class SelectiveMarginals {
+ private:
+  gtsam::GaussianBayesTree bayes_tree_;
+  gtsam::KeyVector keys_;
+  std::map<gtsam::Key, size_t> offsets_;  // of each key in covariance_
+  std::map<gtsam::Key, size_t> dims_;
+  gtsam::Matrix covariance_;
+
+  /// Fill covariance_ from the root clique, or per key and pair.
+  void compute();
+
+ public:
+  /**
+   * Marginals of keys at the solution of a graph.
+   * @param graph     nonlinear factor graph
+   * @param solution  values at which the graph is linearized
+   * @param keys      requested keys
+   */
+  SelectiveMarginals(const gtsam::NonlinearFactorGraph &graph,
+                     const gtsam::Values &solution,
+                     const gtsam::KeyVector &keys);
+
+  /// Marginals of keys from an eliminated Bayes tree.
+  SelectiveMarginals(const gtsam::GaussianBayesTree &bayes_tree,
+                     const gtsam::KeyVector &keys);
+
+  /// Return the requested keys, in the order of jointCovariance().
+  const gtsam::KeyVector &keys() const { return keys_; }
+
+  /// Return the joint covariance of all requested keys.
+  const gtsam::Matrix &jointCovariance() const { return covariance_; }
+
+  /// Return the joint covariance of some of the requested keys.
+  gtsam::Matrix jointCovariance(const gtsam::KeyVector &keys) const;
+
+  /// Return the marginal covariance of a requested key.
+  gtsam::Matrix marginalCovariance(gtsam::Key key) const;
+};
+
+}  // namespace gtdynamics
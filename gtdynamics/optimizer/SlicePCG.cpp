@@ -0,0 +1,275 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SlicePCG.cpp
+ * @brief Matrix-free preconditioned conjugate gradient for linear trajectory
+ * graphs, with one preconditioner block per time slice.
+ */
+
+#include <gtdynamics/optimizer/SlicePCG.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <Eigen/Cholesky>
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace {
+
+/// Whitened Jacobian of a factor, with the place of its keys in x.
+struct SliceFactor {
+  Matrix A;
+  Vector b;
+  std::vector<size_t> offsets;  ///< offset of each key in x
+  std::vector<size_t> columns;  ///< first column of each key in A
+  std::vector<size_t> dims;
+  std::vector<size_t> slices;  ///< slice of each key
+};
+
+/// The normal equations of a linear graph, with x ordered by slice.
+class SliceSystem {
+ public:
+  explicit SliceSystem(const GaussianFactorGraph &graph);
+
+  size_t dim() const { return dim_; }
+
+  /// Return A^T b.
+  Vector gradient() const;
+
+  /// Set y to A^T A x.
+  void multiply(const Vector &x, Vector *y) const;
+
+  /// Set z to the solve of r with the slice blocks of A^T A.
+  void precondition(const Vector &r, Vector *z) const;
+
+  /// Return x as the values of the keys.
+  gtsam::VectorValues values(const Vector &x) const;
+
+ private:
+  gtsam::KeyVector keys_;
+  std::vector<size_t> offsets_, dims_;
+  std::vector<size_t> slice_offsets_, slice_dims_;
+  std::vector<SliceFactor> factors_;
+  std::vector<std::vector<size_t>> slice_factors_;  ///< by last slice
+  std::vector<size_t> wide_factors_;  ///< spanning over two slices
+  std::vector<Eigen::LLT<Matrix>> blocks_;
+  size_t dim_ = 0;
+
+  // Call func on every factor, on factors of different slices in parallel.
+  // Factors of slice s only write slices s - 1 and s, so factors of slices
+  // of the same parity are independent.
+  template <typename FUNC>
+  void forEachFactor(const FUNC &func) const {
+    const size_t S = slice_factors_.size();
+    for (size_t parity = 0; parity < 2; parity++) {
+      ParallelFor((S + 1 - parity) / 2, [&](size_t i) {
+        for (size_t f : slice_factors_[2 * i + parity]) func(factors_[f]);
+      });
+    }
+    for (size_t f : wide_factors_) func(factors_[f]);
+  }
+};
+
+/* ************************************************************************* */
+SliceSystem::SliceSystem(const GaussianFactorGraph &graph) {
+  // Jacobians of all factors, Hessian factors are factored back.
+  std::vector<gtsam::JacobianFactor::shared_ptr> jacobians;
+  std::map<Key, size_t> key_dims;
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(factor);
+    if (!jacobian) {
+      auto hessian = boost::dynamic_pointer_cast<gtsam::HessianFactor>(factor);
+      if (!hessian) {
+        throw std::invalid_argument("SolveSlicePCG: unsupported factor type.");
+      }
+      jacobian = boost::make_shared<gtsam::JacobianFactor>(*hessian);
+    }
+    if (jacobian->isConstrained()) {
+      throw std::invalid_argument(
+          "SolveSlicePCG: constrained noise models are not supported.");
+    }
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      key_dims[*it] = jacobian->getDim(it);
+    }
+    jacobians.push_back(jacobian);
+  }
+
+  // Order x by time, then key, and number the distinct times.
+  for (const auto &key_dim : key_dims) keys_.push_back(key_dim.first);
+  std::stable_sort(keys_.begin(), keys_.end(), [](Key a, Key b) -> bool {
+    return DynamicsSymbol(a).time() < DynamicsSymbol(b).time();
+  });
+  std::map<Key, size_t> key_index, key_slice;
+  std::map<uint64_t, size_t> times;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    const uint64_t t = DynamicsSymbol(keys_[i]).time();
+    auto inserted = times.emplace(t, times.size());
+    if (inserted.second) {
+      slice_offsets_.push_back(dim_);
+      slice_dims_.push_back(0);
+    }
+    const size_t s = inserted.first->second;
+    key_index[keys_[i]] = i;
+    key_slice[keys_[i]] = s;
+    offsets_.push_back(dim_);
+    dims_.push_back(key_dims[keys_[i]]);
+    slice_dims_[s] += dims_.back();
+    dim_ += dims_.back();
+  }
+
+  const size_t S = slice_dims_.size();
+  slice_factors_.resize(S);
+  for (const auto &jacobian : jacobians) {
+    SliceFactor f;
+    std::tie(f.A, f.b) = jacobian->jacobian();
+    size_t column = 0;
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      f.offsets.push_back(offsets_[key_index[*it]]);
+      f.columns.push_back(column);
+      f.dims.push_back(jacobian->getDim(it));
+      f.slices.push_back(key_slice[*it]);
+      column += f.dims.back();
+    }
+    if (f.slices.empty()) continue;
+    const auto range = std::minmax_element(f.slices.begin(), f.slices.end());
+    if (*range.second - *range.first <= 1) {
+      slice_factors_[*range.second].push_back(factors_.size());
+    } else {
+      wide_factors_.push_back(factors_.size());
+    }
+    factors_.push_back(std::move(f));
+  }
+
+  // Sum the slice blocks of A^T A over the factors, and factor them.
+  std::vector<Matrix> blocks(S);
+  for (size_t s = 0; s < S; s++) {
+    blocks[s] = Matrix::Zero(slice_dims_[s], slice_dims_[s]);
+  }
+  forEachFactor([&](const SliceFactor &f) {
+    for (size_t i = 0; i < f.slices.size(); i++) {
+      for (size_t j = 0; j < f.slices.size(); j++) {
+        if (f.slices[i] != f.slices[j]) continue;
+        const size_t s = f.slices[i];
+        blocks[s].block(f.offsets[i] - slice_offsets_[s],
+                        f.offsets[j] - slice_offsets_[s], f.dims[i],
+                        f.dims[j]) += f.A.middleCols(f.columns[i], f.dims[i])
+                                          .transpose() *
+                                      f.A.middleCols(f.columns[j], f.dims[j]);
+      }
+    }
+  });
+  blocks_.resize(S);
+  std::vector<char> singular(S, 0);
+  ParallelFor(S, [&](size_t s) {
+    blocks_[s].compute(blocks[s]);
+    singular[s] = blocks_[s].info() != Eigen::Success;
+  });
+  for (size_t s = 0; s < S; s++) {
+    if (singular[s]) {
+      const size_t first = std::lower_bound(offsets_.begin(), offsets_.end(),
+                                            slice_offsets_[s]) -
+                           offsets_.begin();
+      throw gtsam::IndeterminantLinearSystemException(keys_[first]);
+    }
+  }
+}
+
+/* ************************************************************************* */
+Vector SliceSystem::gradient() const {
+  Vector g = Vector::Zero(dim_);
+  forEachFactor([&](const SliceFactor &f) {
+    for (size_t i = 0; i < f.offsets.size(); i++) {
+      g.segment(f.offsets[i], f.dims[i]) +=
+          f.A.middleCols(f.columns[i], f.dims[i]).transpose() * f.b;
+    }
+  });
+  return g;
+}
+
+/* ************************************************************************* */
+void SliceSystem::multiply(const Vector &x, Vector *y) const {
+  y->setZero(dim_);
+  forEachFactor([&](const SliceFactor &f) {
+    Vector e = Vector::Zero(f.A.rows());
+    for (size_t i = 0; i < f.offsets.size(); i++) {
+      e += f.A.middleCols(f.columns[i], f.dims[i]) *
+           x.segment(f.offsets[i], f.dims[i]);
+    }
+    for (size_t i = 0; i < f.offsets.size(); i++) {
+      y->segment(f.offsets[i], f.dims[i]) +=
+          f.A.middleCols(f.columns[i], f.dims[i]).transpose() * e;
+    }
+  });
+}
+
+/* ************************************************************************* */
+void SliceSystem::precondition(const Vector &r, Vector *z) const {
+  z->resize(dim_);
+  ParallelFor(blocks_.size(), [&](size_t s) {
+    z->segment(slice_offsets_[s], slice_dims_[s]) =
+        blocks_[s].solve(r.segment(slice_offsets_[s], slice_dims_[s]));
+  });
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues SliceSystem::values(const Vector &x) const {
+  gtsam::VectorValues values;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    values.insert(keys_[i], x.segment(offsets_[i], dims_[i]));
+  }
+  return values;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+gtsam::VectorValues SolveSlicePCG(const GaussianFactorGraph &graph,
+                                  const SlicePCGParameters &params,
+                                  size_t *iterations) {
+  const SliceSystem system(graph);
+  Vector x = Vector::Zero(system.dim());
+  Vector r = system.gradient(), z, q;
+  system.precondition(r, &z);
+  Vector p = z;
+  double rz = r.dot(z);
+  const double threshold =
+      std::max(params.epsilon_abs(), params.epsilon_rel() * r.norm());
+
+  size_t k = 0;
+  for (; k < params.maxIterations() && r.norm() > threshold; k++) {
+    system.multiply(p, &q);
+    const double pq = p.dot(q);
+    if (!(pq > 0)) break;  // p is in the null space of A
+    const double alpha = rz / pq;
+    x += alpha * p;
+    r -= alpha * q;
+    system.precondition(r, &z);
+    const double rz_new = r.dot(z);
+    p = z + (rz_new / rz) * p;
+    rz = rz_new;
+  }
+  if (iterations) *iterations = k;
+  return system.values(x);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,63 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SlicePCG.h
+ * @brief Matrix-free preconditioned conjugate gradient for linear trajectory
+ * graphs, with one preconditioner block per time slice.
+ */
+
+#pragma once
+
+#include <gtsam/linear/ConjugateGradientSolver.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace gtdynamics {
+
+/**
+ * Parameters of SolveSlicePCG. Set them as the iterativeParams of LM
+ * parameters with the Iterative linear solver type, as
+ * SolverProfile::SLICE_PCG does, to solve the damped systems of the
+ * GTDynamics optimizers with it. Iterations stop when the norm of the
+ * residual of the normal equations drops below the largest of epsilon_abs
+ * and epsilon_rel times its initial norm.
+ */
+class SlicePCGParameters : public gtsam::ConjugateGradientParameters {
+ public:
+  using shared_ptr = boost::shared_ptr<SlicePCGParameters>;
+
+  SlicePCGParameters() {
+    setMaxIterations(1000);
+    setEpsilon_rel(1e-10);
+    setEpsilon_abs(1e-14);
+  }
+};
+
+/**
+ * Solve the least-squares problem of a linear graph with conjugate gradient
+ * on its normal equations. Products with the normal matrix are evaluated
+ * factor by factor from the whitened Jacobians, so memory stays linear in
+ * the horizon, and the preconditioner is block Jacobi with one dense block
+ * per time slice, the variables of the same DynamicsSymbol time. Factors
+ * within two consecutive slices are multiplied in parallel, first those of
+ * even slices and then odd ones, so no two tasks write the same slice.
+ *
+ * @param graph       linear graph, of Jacobian or Hessian factors
+ * @param params      iteration limit and tolerances
+ * @param iterations  if given, set to the number of CG iterations
+ * @throws std::invalid_argument for constrained noise models.
+ * @throws gtsam::IndeterminantLinearSystemException if a slice block is
+ * singular.
+ */
+gtsam::VectorValues SolveSlicePCG(const gtsam::GaussianFactorGraph &graph,
+                                  const SlicePCGParameters &params,
+                                  size_t *iterations = nullptr);
+
+}  // namespace gtdynamics
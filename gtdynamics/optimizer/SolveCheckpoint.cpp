@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolveCheckpoint.cpp
+ * @brief State of an iterative solve, saved to resume it.
+ */
+
+#include <gtdynamics/optimizer/SolveCheckpoint.h>
+#include <gtdynamics/optimizer/SolveSnapshot.h>
+#include <gtsam/base/Matrix.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+/// Checkpoint file format version, increased when it changes.
+static constexpr uint32_t kCheckpointVersion = 1;
+
+/* ************************************************************************* */
+template <class ARCHIVE>
+void SolveCheckpoint::serialize(ARCHIVE& ar, const unsigned int version) {
+  ar& BOOST_SERIALIZATION_NVP(solver);
+  ar& BOOST_SERIALIZATION_NVP(values);
+  ar& BOOST_SERIALIZATION_NVP(iterations);
+  ar& BOOST_SERIALIZATION_NVP(mu);
+  ar& BOOST_SERIALIZATION_NVP(lambda);
+  ar& BOOST_SERIALIZATION_NVP(multipliers);
+}
+
+/* ************************************************************************* */
+void SaveSolveCheckpoint(const SolveCheckpoint& checkpoint,
+                         const std::string& filename) {
+  const std::string partial = filename + ".partial";
+  try {
+    std::ofstream os(partial, std::ios::binary);
+    if (!os) throw std::runtime_error("unable to open " + partial);
+    boost::archive::binary_oarchive oa(os);
+    oa << kCheckpointVersion;
+    RegisterSnapshotTypes(oa);
+    oa << checkpoint;
+  } catch (const std::exception& e) {
+    std::remove(partial.c_str());
+    throw std::runtime_error("SaveSolveCheckpoint: unable to save the state, " +
+                             std::string(e.what()));
+  }
+  if (std::rename(partial.c_str(), filename.c_str()) != 0) {
+    std::remove(partial.c_str());
+    throw std::runtime_error("SaveSolveCheckpoint: unable to write " +
+                             filename);
+  }
+}
+
+/* ************************************************************************* */
+boost::optional<SolveCheckpoint> LoadSolveCheckpoint(
+    const std::string& filename, const std::string& solver,
+    const gtsam::Values& initial_values) {
+  std::ifstream is(filename, std::ios::binary);
+  if (!is) return boost::none;
+
+  SolveCheckpoint checkpoint;
+  uint32_t version = 0;
+  try {
+    boost::archive::binary_iarchive ia(is);
+    ia >> version;
+    if (version == kCheckpointVersion) {
+      RegisterSnapshotTypes(ia);
+      ia >> checkpoint;
+    }
+  } catch (const std::exception& e) {
+    throw std::runtime_error("LoadSolveCheckpoint: unable to read " +
+                             filename + ", " + e.what());
+  }
+  if (version != kCheckpointVersion) {
+    throw std::runtime_error("LoadSolveCheckpoint: " + filename +
+                             " is not a checkpoint of version " +
+                             std::to_string(kCheckpointVersion));
+  }
+
+  // Resuming another solve would silently answer the wrong problem.
+  bool same_keys = checkpoint.values.size() == initial_values.size();
+  for (const auto& key_value : initial_values) {
+    if (!same_keys) break;
+    same_keys = checkpoint.values.exists(key_value.key);
+  }
+  if (checkpoint.solver != solver || !same_keys) {
+    throw std::runtime_error("LoadSolveCheckpoint: " + filename +
+                             " is the checkpoint of another " +
+                             (checkpoint.solver != solver ? "solver, "
+                                                          : "problem, ") +
+                             checkpoint.solver);
+  }
+  return checkpoint;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolveCheckpoint.h
+ * @brief State of an iterative solve, saved to resume it.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/serialization/access.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * The state of a solve after some iterations: enough to continue it where it
+ * stopped, e.g., after the job running it was preempted. Telemetry, the
+ * intermediate results and the best feasible iterate are not kept.
+ */
+struct SolveCheckpoint {
+  std::string solver;        ///< solver that wrote it, e.g. "PenaltyMethod"
+  gtsam::Values values;      ///< current iterate
+  size_t iterations = 0;     ///< completed LM or outer iterations
+  double mu = 0;             ///< penalty parameter, of constrained methods
+  double lambda = 0;         ///< LM damping to continue with
+  std::vector<gtsam::Vector> multipliers;  ///< Lagrange multipliers, if any
+
+ private:
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE& ar, const unsigned int version);
+};
+
+/// Return whether a checkpoint is due after some completed iterations, when
+/// saving every interval iterations; an interval of 0 is taken as 1.
+inline bool CheckpointDue(size_t iterations, size_t interval) {
+  return interval <= 1 || iterations % interval == 0;
+}
+
+/**
+ * Save a checkpoint to a binary file. It is written next to the file first
+ * and then renamed, so that a solve stopped while saving leaves the previous
+ * checkpoint intact.
+ * @throws std::runtime_error if the file can not be written.
+ */
+void SaveSolveCheckpoint(const SolveCheckpoint& checkpoint,
+                         const std::string& filename);
+
+/**
+ * Load the checkpoint of a solve to resume, if the file exists.
+ * @param filename        file written by SaveSolveCheckpoint
+ * @param solver          solver resuming, which must have written it
+ * @param initial_values  initial values of the solve, whose keys the
+ *                        checkpoint must have
+ * @throws std::runtime_error if the file can not be read, or is the
+ * checkpoint of another solver or problem.
+ */
+boost::optional<SolveCheckpoint> LoadSolveCheckpoint(
+    const std::string& filename, const std::string& solver,
+    const gtsam::Values& initial_values);
+
+}  // namespace gtdynamics
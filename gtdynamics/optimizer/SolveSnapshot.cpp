@@ -0,0 +1,226 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolveSnapshot.cpp
+ * @brief Capture of a solve, to replay it offline.
+ */
+
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/ContactPointFactor.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/optimizer/SolveSnapshot.h>
+#include <gtdynamics/optimizer/SolverProfile.h>
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/base/serialization.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/optional.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+using gtsam::BetweenFactor;
+using gtsam::GenericValue;
+using gtsam::NonlinearFactorGraph;
+using gtsam::PriorFactor;
+using gtsam::Values;
+
+/// Snapshot file format version, increased when it changes.
+static constexpr uint32_t kSnapshotVersion = 2;
+
+/// Register the types a snapshot may hold, in the same order for both saving
+/// and loading.
+template <class ARCHIVE>
+static void RegisterTypes(ARCHIVE& ar) {
+  ar.template register_type<gtsam::noiseModel::Gaussian>();
+  ar.template register_type<gtsam::noiseModel::Diagonal>();
+  ar.template register_type<gtsam::noiseModel::Constrained>();
+  ar.template register_type<gtsam::noiseModel::Isotropic>();
+  ar.template register_type<gtsam::noiseModel::Unit>();
+
+  ar.template register_type<GenericValue<double>>();
+  ar.template register_type<GenericValue<gtsam::Vector>>();
+  ar.template register_type<GenericValue<gtsam::Vector3>>();
+  ar.template register_type<GenericValue<gtsam::Vector6>>();
+  ar.template register_type<GenericValue<gtsam::Rot3>>();
+  ar.template register_type<GenericValue<gtsam::Pose3>>();
+
+  ar.template register_type<PriorFactor<double>>();
+  ar.template register_type<PriorFactor<gtsam::Vector>>();
+  ar.template register_type<PriorFactor<gtsam::Vector6>>();
+  ar.template register_type<PriorFactor<gtsam::Pose3>>();
+  ar.template register_type<BetweenFactor<double>>();
+  ar.template register_type<BetweenFactor<gtsam::Pose3>>();
+  ar.template register_type<MinTorqueFactor>();
+  ar.template register_type<ContactPointFactor>();
+  ar.template register_type<EulerPoseCollocationFactor>();
+  ar.template register_type<TrapezoidalPoseCollocationFactor>();
+  ar.template register_type<HermiteSimpsonPoseCollocationFactor>();
+  ar.template register_type<EulerTwistCollocationFactor>();
+  ar.template register_type<TrapezoidalTwistCollocationFactor>();
+}
+
+/* ************************************************************************* */
+void RegisterSnapshotTypes(boost::archive::binary_oarchive& ar) {
+  RegisterTypes(ar);
+}
+
+/* ************************************************************************* */
+void RegisterSnapshotTypes(boost::archive::binary_iarchive& ar) {
+  RegisterTypes(ar);
+}
+
+/* ************************************************************************* */
+SolveSnapshot::SolveSnapshot(const NonlinearFactorGraph& graph,
+                             const EqualityConstraints& constraints,
+                             const Values& initial_values,
+                             const OptimizationParameters& parameters)
+    : graph(graph), initial_values(initial_values), parameters(parameters) {
+  for (const auto& constraint : constraints) {
+    auto equality = boost::dynamic_pointer_cast<FactorEquality>(constraint);
+    if (!equality) {
+      throw std::invalid_argument(
+          "SolveSnapshot: only FactorEquality constraints can be captured.");
+    }
+    constraint_factors.push_back(equality->factor());
+  }
+  // The replay must not capture itself again.
+  this->parameters.snapshot_path.clear();
+  this->parameters.symbolic_structure.reset();
+  this->parameters.control.reset();
+}
+
+/* ************************************************************************* */
+EqualityConstraints SolveSnapshot::constraints() const {
+  EqualityConstraints constraints;
+  for (const auto& factor : constraint_factors) {
+    constraints.emplace_shared<FactorEquality>(
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor));
+  }
+  return constraints;
+}
+
+/* ************************************************************************* */
+Values SolveSnapshot::solve(OptimizationStatus* status) const {
+  return solve(parameters, status);
+}
+
+/* ************************************************************************* */
+Values SolveSnapshot::solve(const OptimizationParameters& parameters,
+                            OptimizationStatus* status) const {
+  return Optimizer(parameters).optimize(graph, constraints(), initial_values,
+                                        nullptr, status);
+}
+
+/* ************************************************************************* */
+template <class ARCHIVE>
+void SolveSnapshot::serialize(ARCHIVE& ar, const unsigned int version) {
+  using boost::serialization::make_nvp;
+  ar& BOOST_SERIALIZATION_NVP(graph);
+  ar& BOOST_SERIALIZATION_NVP(constraint_factors);
+  ar& BOOST_SERIALIZATION_NVP(initial_values);
+
+  OptimizationParameters& p = parameters;
+  ar& make_nvp("method", p.method);
+  ar& make_nvp("time_ordering", p.time_ordering);
+  ar& make_nvp("dynamics_ordering", p.dynamics_ordering);
+  ar& make_nvp("nested_ordering", p.nested_ordering);
+  ar& make_nvp("num_starts", p.num_starts);
+  ar& make_nvp("start_noise", p.start_noise);
+  ar& make_nvp("cancel_ratio", p.cancel_ratio);
+  ar& make_nvp("deadline", p.deadline);
+  ar& make_nvp("split_components", p.split_components);
+  ar& make_nvp("dense_dimension", p.dense_dimension);
+  ar& make_nvp("hard_sigma", p.hard_sigma);
+
+  gtsam::LevenbergMarquardtParams& lm = p.lm_parameters;
+  ar& make_nvp("maxIterations", lm.maxIterations);
+  ar& make_nvp("relativeErrorTol", lm.relativeErrorTol);
+  ar& make_nvp("absoluteErrorTol", lm.absoluteErrorTol);
+  ar& make_nvp("errorTol", lm.errorTol);
+  ar& make_nvp("orderingType", lm.orderingType);
+  ar& make_nvp("linearSolverType", lm.linearSolverType);
+  ar& make_nvp("ordering", lm.ordering);
+  ar& make_nvp("lambdaInitial", lm.lambdaInitial);
+  ar& make_nvp("lambdaFactor", lm.lambdaFactor);
+  ar& make_nvp("lambdaUpperBound", lm.lambdaUpperBound);
+  ar& make_nvp("lambdaLowerBound", lm.lambdaLowerBound);
+  ar& make_nvp("minModelFidelity", lm.minModelFidelity);
+  ar& make_nvp("diagonalDamping", lm.diagonalDamping);
+  ar& make_nvp("useFixedLambdaFactor", lm.useFixedLambdaFactor);
+  ar& make_nvp("minDiagonal", lm.minDiagonal);
+  ar& make_nvp("maxDiagonal", lm.maxDiagonal);
+
+  if (ARCHIVE::is_loading::value &&
+      lm.linearSolverType == gtsam::NonlinearOptimizerParams::Iterative) {
+    // Iterative parameters are not serializable, use those of PCG.
+    OptimizationParameters pcg;
+    SetSolverProfile(SolverProfile::PCG, &pcg);
+    lm.iterativeParams = pcg.lm_parameters.iterativeParams;
+  }
+}
+
+/* ************************************************************************* */
+void SaveSolveSnapshot(const SolveSnapshot& snapshot,
+                       const std::string& filename) {
+  std::ofstream os(filename, std::ios::binary);
+  if (!os) {
+    throw std::runtime_error("SaveSolveSnapshot: unable to write " +
+                             filename);
+  }
+  try {
+    boost::archive::binary_oarchive oa(os);
+    oa << kSnapshotVersion;
+    RegisterSnapshotTypes(oa);
+    oa << snapshot;
+  } catch (const std::exception& e) {
+    // Do not leave a partial snapshot behind.
+    os.close();
+    std::remove(filename.c_str());
+    throw std::runtime_error("SaveSolveSnapshot: unable to serialize the "
+                             "problem, " + std::string(e.what()));
+  }
+}
+
+/* ************************************************************************* */
+SolveSnapshot LoadSolveSnapshot(const std::string& filename) {
+  std::ifstream is(filename, std::ios::binary);
+  if (!is) {
+    throw std::runtime_error("LoadSolveSnapshot: unable to read " + filename);
+  }
+  SolveSnapshot snapshot;
+  uint32_t version = 0;
+  try {
+    boost::archive::binary_iarchive ia(is);
+    ia >> version;
+    if (version == kSnapshotVersion) {
+      RegisterSnapshotTypes(ia);
+      ia >> snapshot;
+    }
+  } catch (const std::exception& e) {
+    throw std::runtime_error("LoadSolveSnapshot: unable to read " + filename +
+                             ", " + e.what());
+  }
+  if (version != kSnapshotVersion) {
+    throw std::runtime_error("LoadSolveSnapshot: " + filename +
+                             " is not a snapshot of version " +
+                             std::to_string(kSnapshotVersion));
+  }
+  return snapshot;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolveSnapshot.h
+ * @brief Capture of a solve, to replay it offline.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/serialization/access.hpp>
+#include <string>
+
+namespace boost {
+namespace archive {
+class binary_iarchive;
+class binary_oarchive;
+}  // namespace archive
+}  // namespace boost
+
+namespace gtdynamics {
+
+/**
+ * The problem of one call to Optimizer::optimize: graph, constraints, initial
+ * values and parameters, so that a slow solve can be saved where it happens
+ * and replayed offline, e.g., under every SolverProfile.
+ *
+ * Only FactorEquality constraints are captured, as their factors; expression
+ * constraints can not be serialized. Of the parameters, the symbolic
+ * structure, the solve control and the LM verbosity are not captured, and an
+ * iterative linear solver is restored as SolverProfile::PCG.
+ */
+struct SolveSnapshot {
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::NonlinearFactorGraph constraint_factors;  ///< of the constraints
+  gtsam::Values initial_values;
+  OptimizationParameters parameters;
+
+  SolveSnapshot() {}
+
+  /**
+   * Capture a problem.
+   * @throws std::invalid_argument if a constraint is not a FactorEquality.
+   */
+  SolveSnapshot(const gtsam::NonlinearFactorGraph& graph,
+                const EqualityConstraints& constraints,
+                const gtsam::Values& initial_values,
+                const OptimizationParameters& parameters);
+
+  /// Return the constraints, a FactorEquality for each constraint factor.
+  EqualityConstraints constraints() const;
+
+  /// Solve the problem again, with the captured or other parameters.
+  gtsam::Values solve(OptimizationStatus* status = nullptr) const;
+  gtsam::Values solve(const OptimizationParameters& parameters,
+                      OptimizationStatus* status = nullptr) const;
+
+ private:
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE& ar, const unsigned int version);
+};
+
+/**
+ * Register the noise model, variable and factor types of snapshots with a
+ * binary archive, see SaveSolveSnapshot, e.g., to save values.
+ */
+void RegisterSnapshotTypes(boost::archive::binary_oarchive& ar);
+void RegisterSnapshotTypes(boost::archive::binary_iarchive& ar);
+
+/**
+ * Save a snapshot to a binary file. Noise models, the variable types of
+ * dynamics graphs, prior and between factors, and the serializable
+ * gtdynamics factors are registered; other factor types must be exported by
+ * the application with BOOST_CLASS_EXPORT.
+ * @throws std::runtime_error if the file can not be written, or a factor or
+ * variable can not be serialized.
+ */
+void SaveSolveSnapshot(const SolveSnapshot& snapshot,
+                       const std::string& filename);
+
+/**
+ * Load a snapshot saved by SaveSolveSnapshot.
+ * @throws std::runtime_error if the file can not be read, or was written by
+ * another snapshot version.
+ */
+SolveSnapshot LoadSolveSnapshot(const std::string& filename);
+
+}  // namespace gtdynamics
@@ -0,0 +1,124 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolverProfile.cpp
+ * @brief Presets of linear solver and elimination ordering.
+ */
+
+#include <gtdynamics/optimizer/SlicePCG.h>
+#include <gtdynamics/optimizer/SolverProfile.h>
+#include <gtsam/config.h>
+#include <gtsam/linear/PCGSolver.h>
+#include <gtsam/linear/Preconditioner.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using Params = gtsam::NonlinearOptimizerParams;
+
+/* ************************************************************************* */
+std::string SolverProfileName(SolverProfile profile) {
+  switch (profile) {
+    case SolverProfile::MULTIFRONTAL_CHOLESKY:
+      return "MULTIFRONTAL_CHOLESKY";
+    case SolverProfile::MULTIFRONTAL_QR:
+      return "MULTIFRONTAL_QR";
+    case SolverProfile::SEQUENTIAL_CHOLESKY:
+      return "SEQUENTIAL_CHOLESKY";
+    case SolverProfile::SEQUENTIAL_QR:
+      return "SEQUENTIAL_QR";
+    case SolverProfile::METIS:
+      return "METIS";
+    case SolverProfile::TIME_ORDERED:
+      return "TIME_ORDERED";
+    case SolverProfile::DYNAMICS_ORDERED:
+      return "DYNAMICS_ORDERED";
+    case SolverProfile::NESTED_TIME_ORDERED:
+      return "NESTED_TIME_ORDERED";
+    case SolverProfile::PCG:
+      return "PCG";
+    case SolverProfile::SLICE_PCG:
+      return "SLICE_PCG";
+  }
+  throw std::invalid_argument("SolverProfileName: unknown profile.");
+}
+
+/* ************************************************************************* */
+std::vector<SolverProfile> AvailableSolverProfiles() {
+  std::vector<SolverProfile> profiles = {
+      SolverProfile::MULTIFRONTAL_CHOLESKY, SolverProfile::MULTIFRONTAL_QR,
+      SolverProfile::SEQUENTIAL_CHOLESKY, SolverProfile::SEQUENTIAL_QR};
+#ifdef GTSAM_SUPPORT_NESTED_DISSECTION
+  profiles.push_back(SolverProfile::METIS);
+#endif
+  profiles.push_back(SolverProfile::TIME_ORDERED);
+  profiles.push_back(SolverProfile::DYNAMICS_ORDERED);
+  profiles.push_back(SolverProfile::NESTED_TIME_ORDERED);
+  profiles.push_back(SolverProfile::PCG);
+  profiles.push_back(SolverProfile::SLICE_PCG);
+  return profiles;
+}
+
+/* ************************************************************************* */
+void SetSolverProfile(SolverProfile profile,
+                      OptimizationParameters* parameters) {
+  gtsam::LevenbergMarquardtParams& lm = parameters->lm_parameters;
+  lm.linearSolverType = Params::MULTIFRONTAL_CHOLESKY;
+  lm.orderingType = gtsam::Ordering::COLAMD;
+  lm.ordering = boost::none;
+  lm.iterativeParams.reset();
+  parameters->time_ordering = false;
+  parameters->dynamics_ordering = false;
+  parameters->nested_ordering = false;
+
+  switch (profile) {
+    case SolverProfile::MULTIFRONTAL_CHOLESKY:
+      break;
+    case SolverProfile::MULTIFRONTAL_QR:
+      lm.linearSolverType = Params::MULTIFRONTAL_QR;
+      break;
+    case SolverProfile::SEQUENTIAL_CHOLESKY:
+      lm.linearSolverType = Params::SEQUENTIAL_CHOLESKY;
+      break;
+    case SolverProfile::SEQUENTIAL_QR:
+      lm.linearSolverType = Params::SEQUENTIAL_QR;
+      break;
+    case SolverProfile::METIS:
+#ifdef GTSAM_SUPPORT_NESTED_DISSECTION
+      lm.orderingType = gtsam::Ordering::METIS;
+      break;
+#else
+      throw std::invalid_argument(
+          "SetSolverProfile: GTSAM was built without METIS.");
+#endif
+    case SolverProfile::TIME_ORDERED:
+      parameters->time_ordering = true;
+      break;
+    case SolverProfile::DYNAMICS_ORDERED:
+      parameters->dynamics_ordering = true;
+      break;
+    case SolverProfile::NESTED_TIME_ORDERED:
+      parameters->nested_ordering = true;
+      break;
+    case SolverProfile::PCG: {
+      auto pcg = boost::make_shared<gtsam::PCGSolverParameters>();
+      pcg->preconditioner_ =
+          boost::make_shared<gtsam::BlockJacobiPreconditionerParameters>();
+      lm.linearSolverType = Params::Iterative;
+      lm.iterativeParams = pcg;
+      break;
+    }
+    case SolverProfile::SLICE_PCG:
+      lm.linearSolverType = Params::Iterative;
+      lm.iterativeParams = boost::make_shared<SlicePCGParameters>();
+      break;
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolverProfile.h
+ * @brief Presets of linear solver and elimination ordering.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/Optimizer.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Linear solver and ordering used by the LM solves of an Optimizer. The
+ * default LM parameters correspond to MULTIFRONTAL_CHOLESKY.
+ */
+enum class SolverProfile {
+  MULTIFRONTAL_CHOLESKY,  // multifrontal Cholesky, COLAMD ordering
+  MULTIFRONTAL_QR,        // multifrontal QR, COLAMD ordering
+  SEQUENTIAL_CHOLESKY,    // sequential Cholesky, COLAMD ordering
+  SEQUENTIAL_QR,          // sequential QR, COLAMD ordering
+  METIS,                  // multifrontal Cholesky, METIS ordering
+  TIME_ORDERED,           // multifrontal Cholesky, TimeOrdering
+  DYNAMICS_ORDERED,       // multifrontal Cholesky, DynamicsOrdering
+  NESTED_TIME_ORDERED,    // multifrontal Cholesky, NestedTimeOrdering
+  PCG,                    // preconditioned conjugate gradient, block Jacobi
+  SLICE_PCG               // matrix-free PCG, block Jacobi per time slice
+};
+
+/// Return the name of a profile, e.g., "MULTIFRONTAL_QR".
+std::string SolverProfileName(SolverProfile profile);
+
+/// Return the profiles supported by this GTSAM build, METIS is optional.
+std::vector<SolverProfile> AvailableSolverProfiles();
+
+/**
+ * Set the linear solver and ordering of the parameters to a profile; other
+ * LM settings are kept.
+ * @throws std::invalid_argument if the profile is not available.
+ */
+void SetSolverProfile(SolverProfile profile,
+                      OptimizationParameters* parameters);
+
+}  // namespace gtdynamics
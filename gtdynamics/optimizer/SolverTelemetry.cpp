@@ -0,0 +1,237 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolverTelemetry.cpp
+ * @brief Per-iteration timing and problem statistics of LM solves.
+ */
+
+#include <gtdynamics/optimizer/SolverTelemetry.h>
+#include <gtdynamics/utils/Profiler.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/nonlinear/NonlinearOptimizer.h>
+
+#include <algorithm>
+#include <boost/core/demangle.hpp>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <typeinfo>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Values;
+using Clock = std::chrono::steady_clock;
+
+static double Seconds(const Clock::time_point& start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/* ************************************************************************* */
+double SolverTelemetry::totalTime() const {
+  double result = 0;
+  for (const auto& it : iterations) {
+    result += it.linearize_time + it.solve_time + it.retract_time;
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+void SolverTelemetry::writeJson(std::ostream& os) const {
+  os << "{\"iterations\": [";
+  for (size_t i = 0; i < iterations.size(); i++) {
+    const auto& it = iterations[i];
+    os << (i ? ", " : "") << "{\"outer_iteration\": " << it.outer_iteration
+       << ", \"iteration\": " << it.iteration
+       << ", \"num_tries\": " << it.num_tries << ", \"lambda\": " << it.lambda
+       << ", \"error\": " << it.error
+       << ", \"linearize_time\": " << it.linearize_time
+       << ", \"solve_time\": " << it.solve_time
+       << ", \"retract_time\": " << it.retract_time
+       << ", \"num_factors\": " << it.num_factors
+       << ", \"num_variables\": " << it.num_variables
+       << ", \"jacobian_entries\": " << it.jacobian_entries
+       << ", \"bayes_net_entries\": " << it.bayes_net_entries
+       << ", \"lambdas\": [";
+    for (size_t j = 0; j < it.lambdas.size(); j++) {
+      os << (j ? ", " : "") << it.lambdas[j];
+    }
+    os << "]}";
+  }
+  os << "], \"linearize_time_per_type\": {";
+  bool first = true;
+  for (const auto& type_time : linearize_time_per_type) {
+    os << (first ? "" : ", ") << "\"" << type_time.first
+       << "\": " << type_time.second;
+    first = false;
+  }
+  os << "}, \"factors_per_type\": {";
+  first = true;
+  for (const auto& type_count : factors_per_type) {
+    os << (first ? "" : ", ") << "\"" << type_count.first
+       << "\": " << type_count.second;
+    first = false;
+  }
+  os << "}}";
+}
+
+/* ************************************************************************* */
+void SolverTelemetry::writeCsv(std::ostream& os) const {
+  os << "outer_iteration,iteration,num_tries,lambda,error,linearize_time,"
+        "solve_time,retract_time,num_factors,num_variables,jacobian_entries,"
+        "bayes_net_entries\n";
+  for (const auto& it : iterations) {
+    os << it.outer_iteration << "," << it.iteration << "," << it.num_tries
+       << "," << it.lambda << "," << it.error << "," << it.linearize_time
+       << "," << it.solve_time << "," << it.retract_time << ","
+       << it.num_factors << "," << it.num_variables << ","
+       << it.jacobian_entries << "," << it.bayes_net_entries << "\n";
+  }
+}
+
+/* ************************************************************************* */
+// Number of entries of the R and S blocks of a Bayes net.
+static size_t BayesNetEntries(const gtsam::GaussianBayesNet& bayes_net) {
+  size_t result = 0;
+  for (const auto& conditional : bayes_net) {
+    const size_t n = conditional->get_R().rows();
+    result += n * (n + 1) / 2 + conditional->get_S().size();
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Values InstrumentedLevenbergMarquardt(
+    const gtsam::NonlinearFactorGraph& graph, const Values& initial_values,
+    const gtsam::LevenbergMarquardtParams& params, SolverTelemetry* telemetry,
+    size_t outer_iteration, size_t* inner_iterations,
+    SymbolicStructure* structure) {
+  Values values = initial_values;
+  double error = graph.error(values);
+  double lambda = params.lambdaInitial;
+  auto colamd = [&]() -> gtsam::Ordering {
+    return gtsam::Ordering::Colamd(graph);
+  };
+  gtsam::Ordering ordering;
+  if (params.ordering) {
+    ordering = *params.ordering;
+  } else {
+    ordering = structure ? structure->ordering(graph, colamd) : colamd();
+  }
+
+  size_t iteration = 0;
+  while (iteration < size_t(params.maxIterations) && error > params.errorTol) {
+    IterationTelemetry stats;
+    stats.outer_iteration = outer_iteration;
+    stats.iteration = iteration;
+    stats.num_factors = graph.size();
+    stats.num_variables = values.size();
+
+    // Linearize factor by factor, timing each type.
+    auto start = Clock::now();
+    GaussianFactorGraph linear;
+    {
+      GTD_PROFILE_SCOPE("InstrumentedLevenbergMarquardt linearize");
+      for (const auto& factor : graph) {
+        if (!factor) continue;
+        const auto factor_start = Clock::now();
+        linear.push_back(factor->linearize(values));
+        if (telemetry) {
+          const std::string type =
+              boost::core::demangle(typeid(*factor).name());
+          telemetry->linearize_time_per_type[type] += Seconds(factor_start);
+          telemetry->factors_per_type[type]++;
+        }
+      }
+    }
+    for (const auto& factor : linear) {
+      auto jacobian =
+          boost::dynamic_pointer_cast<gtsam::JacobianFactor>(factor);
+      if (jacobian) {
+        stats.jacobian_entries +=
+            jacobian->rows() * (jacobian->cols() - 1);  // without b
+      }
+    }
+    stats.linearize_time = Seconds(start);
+
+    // Try steps with increasing damping until the error decreases enough.
+    const gtsam::VectorValues zero = values.zeroVectors();
+    const double linear_error = linear.error(zero);
+    bool accepted = false;
+    double new_error = error;
+    while (!accepted) {
+      stats.num_tries++;
+      stats.lambdas.push_back(lambda);
+
+      start = Clock::now();
+      GaussianFactorGraph damped = linear;
+      const double sigma = 1.0 / std::sqrt(lambda);
+      for (const auto& key_value : zero) {
+        const size_t d = key_value.second.size();
+        damped.emplace_shared<gtsam::JacobianFactor>(
+            key_value.first, gtsam::Matrix::Identity(d, d),
+            gtsam::Vector::Zero(d),
+            gtsam::noiseModel::Isotropic::Sigma(d, sigma));
+      }
+      gtsam::VectorValues delta;
+      bool solved = true;
+      try {
+        GTD_PROFILE_SCOPE("InstrumentedLevenbergMarquardt eliminate");
+        const auto bayes_net =
+            structure ? damped.eliminateSequential(
+                            ordering, gtsam::EliminatePreferCholesky,
+                            *structure->variableIndex(damped))
+                      : damped.eliminateSequential(ordering);
+        stats.bayes_net_entries = BayesNetEntries(*bayes_net);
+        delta = bayes_net->optimize();
+      } catch (const gtsam::IndeterminantLinearSystemException&) {
+        solved = false;
+      }
+      stats.solve_time += Seconds(start);
+
+      if (solved) {
+        start = Clock::now();
+        const Values candidate = values.retract(delta);
+        new_error = graph.error(candidate);
+        stats.retract_time += Seconds(start);
+
+        const double cost_change = error - new_error;
+        const double linearized_change = linear_error - linear.error(delta);
+        if (linearized_change >= 0 &&
+            cost_change >= params.minModelFidelity * linearized_change) {
+          accepted = true;
+          values = candidate;
+          lambda = std::max(params.lambdaLowerBound,
+                            lambda / params.lambdaFactor);
+          break;
+        }
+      }
+      if (lambda >= params.lambdaUpperBound) break;
+      lambda *= params.lambdaFactor;
+    }
+
+    stats.lambda = stats.lambdas.back();
+    stats.error = accepted ? new_error : error;
+    if (telemetry) telemetry->iterations.push_back(stats);
+    iteration++;
+
+    if (!accepted) break;
+    const bool converged = gtsam::checkConvergence(params, error, new_error);
+    error = new_error;
+    if (converged) break;
+  }
+  if (inner_iterations) *inner_iterations = iteration;
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolverTelemetry.h
+ * @brief Per-iteration timing and problem statistics of LM solves.
+ */
+
+#pragma once
+
+#include <gtdynamics/optimizer/SymbolicStructure.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Statistics of one Levenberg-Marquardt iteration.
+struct IterationTelemetry {
+  size_t outer_iteration = 0;  // outer loop of constrained methods, else 0
+  size_t iteration = 0;        // LM iteration within the outer loop
+  size_t num_tries = 0;        // damped solves until a step was accepted
+  double lambda = 0;           // damping of the last try
+  double error = 0;            // error after the iteration
+  double linearize_time = 0;   // seconds spent linearizing
+  double solve_time = 0;       // seconds spent eliminating the damped system
+  double retract_time = 0;     // seconds spent retracting and evaluating
+  size_t num_factors = 0;      // nonlinear factors
+  size_t num_variables = 0;    // variables
+  size_t jacobian_entries = 0;    // entries of the Jacobian blocks
+  size_t bayes_net_entries = 0;   // entries of R after elimination, fill-in
+  std::vector<double> lambdas;    // damping of each try
+
+  IterationTelemetry() {}
+};
+
+/**
+ * Telemetry of one or several LM solves: per-iteration statistics, and the
+ * total linearization time and count per factor type.
+ */
+struct SolverTelemetry {
+  std::vector<IterationTelemetry> iterations;
+  std::map<std::string, double> linearize_time_per_type;
+  std::map<std::string, size_t> factors_per_type;
+
+  /// Total wall time in seconds over all iterations.
+  double totalTime() const;
+
+  /// Write as a JSON object.
+  void writeJson(std::ostream& os) const;
+
+  /// Write the per-iteration statistics as CSV with a header line.
+  void writeCsv(std::ostream& os) const;
+};
+
+/**
+ * Levenberg-Marquardt with telemetry. Follows LevenbergMarquardtOptimizer with
+ * a fixed lambda factor and uniform damping, but linearizes factor by factor
+ * and eliminates explicitly, so each phase can be timed.
+ * @param graph            the graph to optimize
+ * @param initial_values   initial values for all variables
+ * @param params           LM parameters, including an optional ordering
+ * @param telemetry        iterations are appended to this
+ * @param outer_iteration  recorded in each iteration, for constrained methods
+ * @param inner_iterations optional output, number of LM iterations
+ * @param structure        optional symbolic structure of the problem
+ * @return the optimized values.
+ */
+gtsam::Values InstrumentedLevenbergMarquardt(
+    const gtsam::NonlinearFactorGraph& graph,
+    const gtsam::Values& initial_values,
+    const gtsam::LevenbergMarquardtParams& params, SolverTelemetry* telemetry,
+    size_t outer_iteration = 0, size_t* inner_iterations = nullptr,
+    SymbolicStructure* structure = nullptr);
+
+}  // namespace gtdynamics
@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StreamingSmoother.cpp
+ * @brief Incremental fixed-lag smoother with bounded memory, for estimators
+ * running on long streams of measurements.
+ */
+
+#include <gtdynamics/optimizer/StreamingSmoother.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <set>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::FastList;
+using gtsam::FastMap;
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+
+// Mark the keys of the cliques below `clique` that have `key` as a parent,
+// which are re-eliminated with it so that it can become a leaf.
+void MarkAffectedKeys(Key key, const gtsam::ISAM2Clique::shared_ptr &clique,
+                      std::set<Key> *keys) {
+  const auto &conditional = clique->conditional();
+  if (std::find(conditional->beginParents(), conditional->endParents(),
+                key) == conditional->endParents()) {
+    return;
+  }
+  keys->insert(conditional->begin(), conditional->end());
+  for (const auto &child : clique->children) {
+    MarkAffectedKeys(key, child, keys);
+  }
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+StreamingSmoother::StreamingSmoother(const StreamingSmootherParams &params)
+    : params_(params),
+      isam_(new gtsam::ISAM2(params.isam2)),
+      latest_time_(-std::numeric_limits<double>::infinity()),
+      last_update_seconds_(0),
+      max_update_seconds_(0),
+      num_compactions_(0) {
+  if (params.lag < 0) {
+    throw std::invalid_argument("StreamingSmoother: lag should be >= 0.");
+  }
+}
+
+/* ************************************************************************* */
+void StreamingSmoother::update(const NonlinearFactorGraph &new_factors,
+                               const Values &new_values,
+                               const std::map<Key, double> &timestamps) {
+  const auto start = std::chrono::steady_clock::now();
+
+  for (const auto &key_time : timestamps) {
+    timestamps_[key_time.first] = key_time.second;
+    latest_time_ = std::max(latest_time_, key_time.second);
+  }
+  for (const auto &key_value : new_values) {
+    if (!timestamps_.count(key_value.key)) {
+      throw std::invalid_argument(
+          "StreamingSmoother: every new variable needs a timestamp.");
+    }
+  }
+
+  // Variables to marginalize, already in ISAM2 or added now.
+  const gtsam::Values &theta = isam_->getLinearizationPoint();
+  const double cutoff = latest_time_ - params_.lag;
+  FastList<Key> marginalizable;
+  for (const auto &key_time : timestamps_) {
+    if (key_time.second < cutoff &&
+        (theta.exists(key_time.first) || new_values.exists(key_time.first))) {
+      marginalizable.push_back(key_time.first);
+    }
+  }
+
+  // Eliminate them first, re-eliminating the cliques between them and the
+  // leaves, so that they end up in leaves.
+  gtsam::ISAM2UpdateParams update_params;
+  if (!marginalizable.empty()) {
+    FastMap<Key, int> groups;
+    for (const auto &key_time : timestamps_) groups[key_time.first] = 1;
+    std::set<Key> affected;
+    for (Key key : marginalizable) {
+      groups[key] = 0;
+      if (!theta.exists(key)) continue;
+      for (const auto &child : (*isam_)[key]->children) {
+        MarkAffectedKeys(key, child, &affected);
+      }
+    }
+    update_params.constrainedKeys = groups;
+    update_params.extraReelimKeys =
+        FastList<Key>(affected.begin(), affected.end());
+  }
+  isam_->update(new_factors, new_values, update_params);
+
+  if (!marginalizable.empty()) {
+    isam_->marginalizeLeaves(marginalizable);
+    for (Key key : marginalizable) timestamps_.erase(key);
+  }
+
+  const auto &factors = isam_->getFactorsUnsafe();
+  if (factors.size() >
+      params_.compaction_ratio * std::max<size_t>(factors.nrFactors(), 1)) {
+    compact();
+  }
+
+  last_update_seconds_ = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  max_update_seconds_ = std::max(max_update_seconds_, last_update_seconds_);
+}
+
+/* ************************************************************************* */
+void StreamingSmoother::compact() {
+  NonlinearFactorGraph factors;
+  for (const auto &factor : isam_->getFactorsUnsafe()) {
+    if (factor) factors.push_back(factor);
+  }
+  const Values theta = isam_->getLinearizationPoint();
+  isam_.reset(new gtsam::ISAM2(params_.isam2));
+  isam_->update(factors, theta);
+  num_compactions_++;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StreamingSmoother.h
+ * @brief Incremental fixed-lag smoother with bounded memory, for estimators
+ * running on long streams of measurements.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <memory>
+
+namespace gtdynamics {
+
+/// Parameters of the StreamingSmoother.
+struct StreamingSmootherParams {
+  /// Variables older than lag before the latest timestamp are marginalized.
+  double lag = 1.0;
+
+  /// Parameters of the underlying ISAM2.
+  gtsam::ISAM2Params isam2;
+
+  /**
+   * ISAM2 keeps an empty slot for every factor of a marginalized variable.
+   * The smoother is rebuilt from the factors left, at the linearization
+   * point, once slots outnumber them by this ratio.
+   */
+  double compaction_ratio = 4.0;
+};
+
+/**
+ * StreamingSmoother is an incremental fixed-lag smoother on ISAM2, as
+ * gtsam::IncrementalFixedLagSmoother: every variable gets a timestamp, and
+ * each update marginalizes the variables older than the lag, leaving a
+ * linear marginal factor on the variables they were connected to.
+ *
+ * The marginalized variables are first moved to the leaves of the Bayes
+ * tree, by eliminating them first in the re-eliminated part, and then
+ * removed with ISAM2::marginalizeLeaves. The slots of their factors are
+ * reclaimed by compaction, so that memory and the work of an update are
+ * bounded by the size of the lag window, however long the stream.
+ */
+class StreamingSmoother {
+ private:
+  StreamingSmootherParams params_;
+  std::unique_ptr<gtsam::ISAM2> isam_;
+  std::map<gtsam::Key, double> timestamps_;
+  double latest_time_;
+  double last_update_seconds_, max_update_seconds_;
+  size_t num_compactions_;
+
+  /// Rebuild ISAM2 from its factors, dropping the empty slots.
+  void compact();
+
+ public:
+  /// Constructor
+  explicit StreamingSmoother(
+      const StreamingSmootherParams &params = StreamingSmootherParams());
+
+  /**
+   * Add factors and variables, and marginalize the variables older than the
+   * lag before the latest timestamp.
+   * @param new_factors  factors to add
+   * @param new_values   initial estimates of the new variables
+   * @param timestamps   timestamps of the new variables, or new timestamps
+   *                     of existing ones
+   */
+  void update(const gtsam::NonlinearFactorGraph &new_factors =
+                  gtsam::NonlinearFactorGraph(),
+              const gtsam::Values &new_values = gtsam::Values(),
+              const std::map<gtsam::Key, double> &timestamps =
+                  std::map<gtsam::Key, double>());
+
+  /// Return the estimate of the variables in the lag window.
+  gtsam::Values calculateEstimate() const {
+    return isam_->calculateEstimate();
+  }
+
+  /// Return the estimate of one variable in the lag window.
+  template <class VALUE>
+  VALUE calculateEstimate(gtsam::Key key) const {
+    return isam_->calculateEstimate<VALUE>(key);
+  }
+
+  /// Return the marginal covariance of a variable in the lag window.
+  gtsam::Matrix marginalCovariance(gtsam::Key key) const {
+    return isam_->marginalCovariance(key);
+  }
+
+  /// Return the timestamps of the variables in the lag window.
+  const std::map<gtsam::Key, double> &timestamps() const {
+    return timestamps_;
+  }
+
+  /// Return the latest timestamp.
+  double latestTime() const { return latest_time_; }
+
+  /// Return the number of variables in the lag window.
+  size_t numVariables() const { return timestamps_.size(); }
+
+  /// Return the number of factor slots of ISAM2, empty ones included.
+  size_t numFactorSlots() const { return isam_->getFactorsUnsafe().size(); }
+
+  /// Return the number of times ISAM2 was rebuilt to reclaim slots.
+  size_t numCompactions() const { return num_compactions_; }
+
+  /// Return the wall time of the last update, in seconds.
+  double lastUpdateSeconds() const { return last_update_seconds_; }
+
+  /// Return the maximum wall time of an update so far, in seconds.
+  double maxUpdateSeconds() const { return max_update_seconds_; }
+
+  /// Return the underlying ISAM2.
+  const gtsam::ISAM2 &isam() const { return *isam_; }
+};
+
+}  // namespace gtdynamics
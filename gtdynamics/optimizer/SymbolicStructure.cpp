@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SymbolicStructure.cpp
+ * @brief Symbolic structure of the linear systems of LM, computed once per
+ * problem and reused by every numeric factorization.
+ */
+
+#include <gtdynamics/optimizer/SlicePCG.h>
+#include <gtdynamics/optimizer/SymbolicStructure.h>
+#include <gtdynamics/universal_robot/JointKinematicsCache.h>
+#include <gtdynamics/utils/Profiler.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Ordering;
+
+// Number of factor-variable entries of a graph.
+template <class GRAPH>
+static size_t NumEntries(const GRAPH &graph) {
+  size_t result = 0;
+  for (const auto &factor : graph) {
+    if (factor) result += factor->size();
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+Ordering SymbolicStructure::ordering(
+    const gtsam::NonlinearFactorGraph &graph,
+    const std::function<Ordering()> &order) {
+  const size_t num_entries = NumEntries(graph);
+  gtsam::KeySet keys = graph.keys();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ordering_ && ordering_factors_ == graph.size() &&
+        ordering_entries_ == num_entries && ordering_keys_ == keys) {
+      return *ordering_;
+    }
+  }
+
+  // Computed without the lock, parallel solves of the same problem at most
+  // compute it more than once.
+  auto ordering = std::make_shared<const Ordering>(order());
+  std::lock_guard<std::mutex> lock(mutex_);
+  ordering_ = ordering;
+  ordering_factors_ = graph.size();
+  ordering_entries_ = num_entries;
+  ordering_keys_ = std::move(keys);
+  num_orderings_++;
+  return *ordering;
+}
+
+/* ************************************************************************* */
+std::shared_ptr<const gtsam::VariableIndex> SymbolicStructure::variableIndex(
+    const GaussianFactorGraph &graph) {
+  const size_t num_entries = NumEntries(graph);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_solves_++;
+    if (index_ && index_->nFactors() == graph.size() &&
+        index_->nEntries() == num_entries) {
+      return index_;
+    }
+  }
+
+  std::shared_ptr<const gtsam::VariableIndex> index;
+  {
+    GTD_PROFILE_SCOPE("SymbolicStructure variable index");
+    index = std::make_shared<const gtsam::VariableIndex>(graph);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_ = index;
+  num_indices_++;
+  return index;
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues SymbolicStructure::solve(
+    const GaussianFactorGraph &graph,
+    const gtsam::NonlinearOptimizerParams &params) {
+  if (!params.ordering) {
+    throw std::invalid_argument("SymbolicStructure: no ordering given.");
+  }
+  const auto index = variableIndex(graph);
+  const auto eliminate = params.getEliminationFunction();
+  if (params.isMultifrontal()) {
+    return graph.eliminateMultifrontal(*params.ordering, eliminate, *index)
+        ->optimize();
+  } else if (params.isSequential()) {
+    return graph.eliminateSequential(*params.ordering, eliminate, *index)
+        ->optimize();
+  }
+  throw std::invalid_argument(
+      "SymbolicStructure: only direct solvers use the structure.");
+}
+
+/* ************************************************************************* */
+size_t SymbolicStructure::numOrderings() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_orderings_;
+}
+
+/* ************************************************************************* */
+size_t SymbolicStructure::numIndices() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_indices_;
+}
+
+/* ************************************************************************* */
+size_t SymbolicStructure::numSolves() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_solves_;
+}
+
+/* ************************************************************************* */
+gtsam::LevenbergMarquardtParams StructuredParameters(
+    const gtsam::NonlinearFactorGraph &graph,
+    const gtsam::LevenbergMarquardtParams &params,
+    SymbolicStructure *structure, const std::function<Ordering()> &order) {
+  if (params.ordering) return params;
+  std::function<Ordering()> compute = order;
+  if (!compute) {
+    compute = [&]() -> Ordering {
+      return Ordering::Create(params.orderingType, graph);
+    };
+  }
+  gtsam::LevenbergMarquardtParams result = params;
+  result.setOrdering(structure ? structure->ordering(graph, compute)
+                               : compute());
+  return result;
+}
+
+/* ************************************************************************* */
+StructuredLevenbergMarquardt::StructuredLevenbergMarquardt(
+    const gtsam::NonlinearFactorGraph &graph,
+    const gtsam::Values &initial_values,
+    const gtsam::LevenbergMarquardtParams &params,
+    const std::shared_ptr<SymbolicStructure> &structure)
+    : gtsam::LevenbergMarquardtOptimizer(
+          graph, initial_values,
+          StructuredParameters(graph, params, structure.get())),
+      structure_(structure) {}
+
+/* ************************************************************************* */
+gtsam::GaussianFactorGraph::shared_ptr StructuredLevenbergMarquardt::linearize()
+    const {
+  JointKinematicsCache::Scope scope;
+  return gtsam::LevenbergMarquardtOptimizer::linearize();
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues StructuredLevenbergMarquardt::solve(
+    const GaussianFactorGraph &graph,
+    const gtsam::NonlinearOptimizerParams &params) const {
+  if (params.isIterative()) {
+    auto slice_pcg = boost::dynamic_pointer_cast<SlicePCGParameters>(
+        params.iterativeParams);
+    if (slice_pcg) return SolveSlicePCG(graph, *slice_pcg);
+  }
+  if (!structure_ || !(params.isMultifrontal() || params.isSequential())) {
+    return gtsam::LevenbergMarquardtOptimizer::solve(graph, params);
+  }
+  return structure_->solve(graph, params);
+}
+
+}  // namespace gtdynamics
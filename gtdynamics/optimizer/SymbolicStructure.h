@@ -0,0 +1,129 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SymbolicStructure.h
+ * @brief Symbolic structure of the linear systems of LM, computed once per
+ * problem and reused by every numeric factorization.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/inference/VariableIndex.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace gtdynamics {
+
+/**
+ * For a fixed graph and ordering, the linear systems solved by LM have the
+ * same structure at every iteration, in every outer iteration of the
+ * constrained methods, and in re-solves from other initial values. This
+ * caches the elimination ordering of a nonlinear graph and the variable
+ * index of its damped linear systems, which are the symbolic inputs of the
+ * elimination, so they are computed once.
+ *
+ * The ordering is recomputed when the keys, the number of factors or the
+ * number of factor-variable entries of the graph change, and the variable
+ * index when the number of factors or of entries of the linear system
+ * change. Hence a structure is meant for one problem, which may be solved
+ * in parallel, e.g., from several starts.
+ */
+class SymbolicStructure {
+ private:
+  mutable std::mutex mutex_;
+  std::shared_ptr<const gtsam::Ordering> ordering_;
+  size_t ordering_factors_ = 0, ordering_entries_ = 0;
+  gtsam::KeySet ordering_keys_;
+  std::shared_ptr<const gtsam::VariableIndex> index_;
+  size_t num_orderings_ = 0, num_indices_ = 0, num_solves_ = 0;
+
+ public:
+  SymbolicStructure() {}
+
+  SymbolicStructure(const SymbolicStructure &) = delete;
+  SymbolicStructure &operator=(const SymbolicStructure &) = delete;
+
+  /**
+   * Return the ordering of a nonlinear graph, computed with `order` if the
+   * structure of the graph is not the cached one.
+   */
+  gtsam::Ordering ordering(const gtsam::NonlinearFactorGraph &graph,
+                           const std::function<gtsam::Ordering()> &order);
+
+  /// Return the variable index of a linear graph, cached by its structure.
+  std::shared_ptr<const gtsam::VariableIndex> variableIndex(
+      const gtsam::GaussianFactorGraph &graph);
+
+  /**
+   * Solve a linear system with the ordering and elimination of the
+   * parameters, which should be a direct, sequential or multifrontal,
+   * solver type, and the cached variable index.
+   */
+  gtsam::VectorValues solve(const gtsam::GaussianFactorGraph &graph,
+                            const gtsam::NonlinearOptimizerParams &params);
+
+  /// Return the number of orderings computed.
+  size_t numOrderings() const;
+
+  /// Return the number of variable indices computed.
+  size_t numIndices() const;
+
+  /// Return the number of linear systems solved.
+  size_t numSolves() const;
+};
+
+/**
+ * LevenbergMarquardtOptimizer solving its damped systems with a symbolic
+ * structure. The ordering of the parameters is used if given, otherwise the
+ * one of their ordering type is computed through the structure. Iterative
+ * solvers do not use the structure, and SlicePCGParameters select
+ * SolveSlicePCG. Factors are linearized with a
+ * JointKinematicsCache, so joint transforms are shared across the factors of
+ * each joint.
+ */
+class StructuredLevenbergMarquardt
+    : public gtsam::LevenbergMarquardtOptimizer {
+ private:
+  std::shared_ptr<SymbolicStructure> structure_;
+
+ public:
+  StructuredLevenbergMarquardt(
+      const gtsam::NonlinearFactorGraph &graph,
+      const gtsam::Values &initial_values,
+      const gtsam::LevenbergMarquardtParams &params,
+      const std::shared_ptr<SymbolicStructure> &structure);
+
+  /// Linearize the graph at the current values, with a joint cache.
+  gtsam::GaussianFactorGraph::shared_ptr linearize() const override;
+
+  /// Solve a damped system, with the structure for direct solvers.
+  gtsam::VectorValues solve(
+      const gtsam::GaussianFactorGraph &graph,
+      const gtsam::NonlinearOptimizerParams &params) const override;
+};
+
+/**
+ * Return the LM parameters with an ordering: the given one, or the one
+ * computed by `order`, by default of their ordering type, through the
+ * structure if given.
+ */
+gtsam::LevenbergMarquardtParams StructuredParameters(
+    const gtsam::NonlinearFactorGraph &graph,
+    const gtsam::LevenbergMarquardtParams &params,
+    SymbolicStructure *structure,
+    const std::function<gtsam::Ordering()> &order = nullptr);
+
+}  // namespace gtdynamics
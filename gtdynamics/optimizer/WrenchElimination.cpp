@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WrenchElimination.cpp
+ * @brief Per-slice Schur complement of the joint wrenches of linear
+ * trajectory graphs.
+ */
+
+#include <gtdynamics/optimizer/WrenchElimination.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/Profiler.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::Key;
+using gtsam::Ordering;
+using gtsam::VectorValues;
+
+/* ************************************************************************* */
+// Whether the key is a joint wrench WrenchKey(i, j, t).
+static bool IsWrench(Key key) {
+  const DynamicsSymbol symbol(key);
+  return symbol.label() == "F" &&
+         symbol.linkIdx() != DynamicsSymbol::kNoIndex &&
+         symbol.jointIdx() != DynamicsSymbol::kNoIndex;
+}
+
+/* ************************************************************************* */
+WrenchElimination EliminateWrenches(
+    const GaussianFactorGraph &graph,
+    const GaussianFactorGraph::Eliminate &function) {
+  GTD_PROFILE_SCOPE("EliminateWrenches");
+  WrenchElimination result;
+
+  // Partition the factors on wrenches by time step, the others are kept.
+  std::map<uint64_t, size_t> slice_index;
+  std::vector<GaussianFactorGraph> slice_graphs;
+  std::vector<gtsam::KeyVector> slice_wrenches;
+  std::vector<gtsam::KeySet> slice_keys;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    boost::optional<uint64_t> t;
+    for (Key key : factor->keys()) {
+      if (!IsWrench(key)) continue;
+      const uint64_t time = DynamicsSymbol(key).time();
+      if (t && *t != time) {
+        throw std::invalid_argument(
+            "EliminateWrenches: a factor couples the wrenches of time steps " +
+            std::to_string(*t) + " and " + std::to_string(time) + ".");
+      }
+      t = time;
+    }
+    if (!t) {
+      result.reduced.push_back(factor);
+      continue;
+    }
+    auto inserted = slice_index.emplace(*t, slice_graphs.size());
+    if (inserted.second) {
+      slice_graphs.emplace_back();
+      slice_wrenches.emplace_back();
+      slice_keys.emplace_back();
+    }
+    const size_t s = inserted.first->second;
+    slice_graphs[s].push_back(factor);
+    for (Key key : factor->keys()) {
+      if (IsWrench(key) && slice_keys[s].insert(key).second) {
+        slice_wrenches[s].push_back(key);
+      }
+    }
+  }
+
+  // Schur complement of each slice, slices are independent.
+  const size_t num_slices = slice_graphs.size();
+  result.slices.resize(num_slices);
+  std::vector<GaussianFactorGraph::shared_ptr> marginals(num_slices);
+  ParallelFor(num_slices, [&](size_t s) {
+    const Ordering colamd =
+        Ordering::ColamdConstrainedFirst(slice_graphs[s], slice_wrenches[s]);
+    const Ordering ordering(colamd.begin(),
+                            colamd.begin() + slice_wrenches[s].size());
+    auto eliminated =
+        slice_graphs[s].eliminatePartialSequential(ordering, function);
+    result.slices[s] = eliminated.first;
+    marginals[s] = eliminated.second;
+  });
+  for (auto &&marginal : marginals) result.reduced.push_back(*marginal);
+  return result;
+}
+
+/* ************************************************************************* */
+VectorValues WrenchElimination::backSubstitute(
+    const VectorValues &reduced_solution) const {
+  GTD_PROFILE_SCOPE("WrenchElimination::backSubstitute");
+  std::vector<VectorValues> wrenches(slices.size());
+  ParallelFor(slices.size(), [&](size_t s) {
+    // Conditionals only depend on later ones and on the reduced keys.
+    VectorValues &x = wrenches[s];
+    for (size_t c = slices[s]->size(); c-- > 0;) {
+      const auto &conditional = slices[s]->at(c);
+      VectorValues parents;
+      for (auto key = conditional->beginParents();
+           key != conditional->endParents(); ++key) {
+        parents.insert(*key, x.exists(*key) ? x.at(*key)
+                                            : reduced_solution.at(*key));
+      }
+      x.insert(conditional->solve(parents));
+    }
+  });
+
+  VectorValues solution = reduced_solution;
+  for (auto &&x : wrenches) solution.insert(x);
+  return solution;
+}
+
+/* ************************************************************************* */
+Ordering WithoutWrenches(const Ordering &ordering) {
+  Ordering result;
+  for (Key key : ordering) {
+    if (!IsWrench(key)) result.push_back(key);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+VectorValues OptimizeWithWrenchElimination(
+    const GaussianFactorGraph &graph, const boost::optional<Ordering> &ordering,
+    const GaussianFactorGraph::Eliminate &function) {
+  const WrenchElimination elimination = EliminateWrenches(graph, function);
+  const VectorValues reduced_solution =
+      ordering ? elimination.reduced.optimize(*ordering, function)
+               : elimination.reduced.optimize(function);
+  return elimination.backSubstitute(reduced_solution);
+}
+
+}  // namespace gtdynamics
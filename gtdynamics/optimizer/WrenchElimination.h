@@ -0,0 +1,81 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WrenchElimination.h
+ * @brief Per-slice Schur complement of the joint wrenches of linear
+ * trajectory graphs.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * A linear trajectory graph with its joint wrenches WrenchKey(i, j, t)
+ * eliminated. The wrenches of a time slice are only coupled to its poses,
+ * twists, accelerations and torques, so eliminating them per slice leaves a
+ * reduced graph on the kinematic and torque variables, with the same
+ * sparsity between slices, and one Bayes net per slice to recover them.
+ */
+struct WrenchElimination {
+  /// Graph on all keys but the wrenches.
+  gtsam::GaussianFactorGraph reduced;
+
+  /// Conditionals of the wrenches of each slice, in elimination order.
+  std::vector<gtsam::GaussianBayesNet::shared_ptr> slices;
+
+  /**
+   * Recover the wrenches by back-substitution.
+   * @param reduced_solution  solution of the reduced graph
+   * @return solution for all keys of the original graph
+   */
+  gtsam::VectorValues backSubstitute(
+      const gtsam::VectorValues &reduced_solution) const;
+};
+
+/**
+ * Eliminate the wrenches of a linear graph, one time slice at a time, in
+ * parallel when GTSAM is built with TBB. Within a slice the wrenches are
+ * ordered with COLAMD. The result of solving the reduced graph and
+ * back-substituting equals graph.optimize().
+ * @param graph     linear graph, e.g. the linearized trajectory graph
+ * @param function  dense elimination, EliminateQR for hard constraints
+ * @throws std::invalid_argument if a factor involves the wrenches of several
+ * time steps.
+ */
+WrenchElimination EliminateWrenches(
+    const gtsam::GaussianFactorGraph &graph,
+    const gtsam::GaussianFactorGraph::Eliminate &function =
+        gtsam::EliminatePreferCholesky);
+
+/// Return the ordering without its wrench keys, to order a reduced graph.
+gtsam::Ordering WithoutWrenches(const gtsam::Ordering &ordering);
+
+/**
+ * Solve a linear graph by eliminating its wrenches per slice first, then the
+ * reduced graph.
+ * @param graph     linear graph
+ * @param ordering  ordering of the reduced graph, COLAMD if not given
+ * @param function  dense elimination
+ */
+gtsam::VectorValues OptimizeWithWrenchElimination(
+    const gtsam::GaussianFactorGraph &graph,
+    const boost::optional<gtsam::Ordering> &ordering = boost::none,
+    const gtsam::GaussianFactorGraph::Eliminate &function =
+        gtsam::EliminatePreferCholesky);
+
+}  // namespace gtdynamics
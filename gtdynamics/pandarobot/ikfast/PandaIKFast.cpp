@@ -24,6 +24,8 @@
 #include <stdlib.h>
 
 #include <iostream>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace gtdynamics {
@@ -34,7 +36,21 @@ using gtsam::Pose3;
 using gtsam::Rot3;
 using gtsam::Vector7;
 
-PandaIKFast::PandaIKFast() {}
+PandaIKFast::PandaIKFast() { setUnbounded(); }
+
+PandaIKFast::PandaIKFast(const Robot& robot) { setLimits(robot); }
+
+std::vector<std::string> PandaIKFast::jointNames() const {
+  std::vector<std::string> names;
+  for (size_t i = 0; i < kNumJoints; ++i) {
+    names.push_back("joint" + std::to_string(i + 1));
+  }
+  return names;
+}
+
+static const bool kPandaRegistered = AnalyticIKRegistry::Register(
+    "panda",
+    [](const Robot& robot) { return std::make_shared<PandaIKFast>(robot); });
 
 Pose3 PandaIKFast::forward(const Vector7& joint_values) {
   // Arrays where solution for orientation and position will be stored
@@ -50,7 +66,9 @@ Pose3 PandaIKFast::forward(const Vector7& joint_values) {
   return Pose3(bRe, bte);
 }
 
-std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
+// Compute the solutions without reporting failures, returns false on failure.
+static bool Solve(const Pose3& bTe, double theta7,
+                  std::vector<Vector7>* joint_values) {
   // default eigen matrix storage is column major, while the ikfast uses a
   // rowmajor one, rotation matrix needs to be transposed before getting the
   // data pointer
@@ -62,15 +80,12 @@ std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
   // The inputs (except "solutions") have to be arrays
   bool success = panda_internal::ComputeIk(bTe.translation().data(), bRe.data(),
                                            &theta7, solutions);
-
-  if (!success) {
-    fprintf(stderr, "Error: (inverse PandaIKFast) failed to get ik solution\n");
-    return std::vector<Vector7>();
-  }
+  joint_values->clear();
+  if (!success) return false;
 
   unsigned int num_sols = (unsigned int)solutions.GetNumSolutions();
 
-  std::vector<Vector7> joint_values(num_sols, Vector7());
+  joint_values->assign(num_sols, Vector7());
   for (size_t i = 0, j = 0; i < num_sols; ++i) {
     const ikfast::IkSolutionBase<panda_internal::IkReal>& sol =
         solutions.GetSolution(i);
@@ -78,15 +93,30 @@ std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
     if (sol.GetFree().size() == 0) {
       // Just save solution if there is no extra degree of freedom, i.e.,if the
       // resulting joint configurations are not in a singularity
-      sol.GetSolution(joint_values[j++].data(), NULL);
+      sol.GetSolution((*joint_values)[j++].data(), NULL);
     } else {
       // If it is a singularity, do not save it and erase one of the solution
       // "containers", so there are no empty solutions returned
-      joint_values.pop_back();
+      joint_values->pop_back();
     }
   }
+  return true;
+}
 
+std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
+  std::vector<Vector7> joint_values;
+  if (!Solve(bTe, theta7, &joint_values)) {
+    fprintf(stderr, "Error: (inverse PandaIKFast) failed to get ik solution\n");
+  }
   return joint_values;
 }
 
+bool PandaIKFast::computeInverse(const Pose3& bTe, const gtsam::Vector& free,
+                                 std::vector<gtsam::Vector>* solutions) const {
+  std::vector<Vector7> joint_values;
+  const bool success = Solve(bTe, free(0), &joint_values);
+  solutions->assign(joint_values.begin(), joint_values.end());
+  return success;
+}
+
 }  // namespace gtdynamics
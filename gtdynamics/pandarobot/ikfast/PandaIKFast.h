@@ -9,20 +9,33 @@
 
 //----------------------------------------------------------------------------//
 
+#include <gtdynamics/kinematics/AnalyticIK.h>
+#include <gtdynamics/universal_robot/Robot.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <string>
 #include <vector>
 
 namespace gtdynamics {
 
-// Wrapper of IKFast functions for panda robot.
-class PandaIKFast {
+// Wrapper of IKFast functions for panda robot, registered as "panda" in
+// the AnalyticIKRegistry.
+class PandaIKFast : public AnalyticIK {
  public:
+  /// Constructor, without joint limits.
   PandaIKFast();
 
+  /**
+   * @brief Constructor taking the joint limits of joints "joint1" to "joint7"
+   * of a panda robot, as loaded from panda.urdf.
+   *
+   * @param robot -- the panda robot
+   */
+  explicit PandaIKFast(const Robot& robot);
+
   // The robot's number of joints, for the panda it's 7
   static constexpr size_t kNumJoints = 7;
 
@@ -46,6 +59,18 @@ class PandaIKFast {
    */
   static std::vector<gtsam::Vector7> inverse(const gtsam::Pose3& bRe,
                                              double theta7);
+
+  std::vector<std::string> jointNames() const override;
+
+  /// The 7th joint is the free parameter of the IKFast solution.
+  std::vector<size_t> freeJoints() const override { return {6}; }
+
+  gtsam::Pose3 computeForward(const gtsam::Vector& q) const override {
+    return forward(q);
+  }
+
+  bool computeInverse(const gtsam::Pose3& bTe, const gtsam::Vector& free,
+                      std::vector<gtsam::Vector>* solutions) const override;
 };
 
 }  // namespace gtdynamics
@@ -0,0 +1,35 @@
+/**
+ * @file  PandaIKFastInitializer.h
+ * @brief Initialize panda trajectories from analytic inverse kinematics.
+ */
+
+#pragma once
+
+#include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/AnalyticIKInitializer.h>
+
+#include <memory>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * AnalyticIKInitializer for the panda, with IKFast solutions filtered by the
+ * joint limits of the robot.
+ */
+class PandaIKFastInitializer : public AnalyticIKInitializer {
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param robot -- the panda robot, used for its joint limits
+   * @param base_name -- name of the base link, the IKFast base frame
+   */
+  explicit PandaIKFastInitializer(const Robot& robot,
+                                  const std::string& base_name = "link0")
+      : AnalyticIKInitializer(std::make_shared<PandaIKFast>(robot),
+                              base_name) {}
+};
+
+}  // namespace gtdynamics
@@ -7,6 +7,7 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtdynamics/universal_robot/sdf.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 #include <gtsam/geometry/Pose3.h>
@@ -90,6 +91,51 @@ TEST(PandaIKFast, Inverse) {
   }
 }
 
+TEST(PandaIKFast, Nearest) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"));
+  const PandaIKFast pandarobot(robot);
+
+  Vector7 q = (Vector7() << 0.1, -0.4, 0.2, -2.0, 0.3, 1.6, 0.5).finished();
+  EXPECT(pandarobot.withinLimits(q));
+  EXPECT(!pandarobot.withinLimits(Vector7::Zero()));  // joint4 limit
+
+  // Seeding with the configuration of a pose recovers it.
+  const Pose3 bTe = PandaIKFast::forward(q);
+  boost::optional<Vector> actual = pandarobot.nearest(bTe, q);
+  EXPECT(actual);
+  EXPECT(assert_equal(Vector(q), *actual, 1e-6));
+
+  // A nearby seed gives a solution reaching the pose, close to the seed.
+  const Vector7 seed = q + Vector7::Constant(0.05);
+  actual = pandarobot.nearest(bTe, seed);
+  EXPECT(actual);
+  EXPECT(pandarobot.withinLimits(*actual));
+  EXPECT(assert_equal(bTe, pandarobot.computeForward(*actual), 1e-5));
+  EXPECT((*actual - seed).norm() < 0.5);
+
+  // Batched, with an unreachable pose.
+  const Pose3 far(Rot3(), Point3(2.0, 0, 0.5));
+  const std::vector<boost::optional<Vector>> batch =
+      pandarobot.nearest(std::vector<Pose3>{bTe, far}, q);
+  EXPECT_LONGS_EQUAL(2, batch.size());
+  EXPECT(batch[0] && assert_equal(Vector(q), *batch[0], 1e-6));
+  EXPECT(!batch[1]);
+}
+
+TEST(PandaIKFast, Registry) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"));
+  EXPECT(AnalyticIKRegistry::Has("panda"));
+  THROWS_EXCEPTION(AnalyticIKRegistry::Create("no_such_robot", robot));
+
+  const AnalyticIKPtr ik = AnalyticIKRegistry::Create("panda", robot);
+  EXPECT_LONGS_EQUAL(7, ik->numJoints());
+  Vector7 q = (Vector7() << 0.1, -0.4, 0.2, -2.0, 0.3, 1.6, 0.5).finished();
+  const boost::optional<Vector> actual = ik->nearest(ik->computeForward(q), q);
+  EXPECT(actual && assert_equal(Vector(q), *actual, 1e-6));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,62 @@
+/**
+ * @file  testPandaIKFastInitializer.cpp
+ * @brief test initializing panda trajectories with IKFast
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFastInitializer.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+TEST(PandaIKFastInitializer, AnalyticIK) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"));
+  PandaIKFastInitializer initializer(robot);
+
+  // End-effector path from a straight line in joint space.
+  const Vector7 q0 =
+      (Vector7() << 0.1, -0.4, 0.2, -2.0, 0.3, 1.6, 0.5).finished();
+  const Vector7 q1 =
+      (Vector7() << 0.3, -0.2, 0.1, -1.8, 0.4, 1.8, 0.6).finished();
+  const size_t num_steps = 5;
+  std::vector<Pose3> bTe_path;
+  for (size_t t = 0; t < num_steps; ++t) {
+    const double s = double(t) / (num_steps - 1);
+    bTe_path.push_back(PandaIKFast::forward((1 - s) * q0 + s * q1));
+  }
+
+  const Values values =
+      initializer.InitializeSolutionAnalyticIK(robot, bTe_path, q0);
+  EXPECT_LONGS_EQUAL(initializer.ZeroValuesTrajectory(robot, num_steps - 1)
+                         .size(),
+                     values.size());
+
+  // Seeded joint angles reach the path, and poses agree with them.
+  for (size_t t = 0; t < num_steps; ++t) {
+    Vector7 q;
+    for (size_t i = 0; i < PandaIKFast::kNumJoints; ++i) {
+      q(i) = JointAngle(values, robot.joint("joint" + std::to_string(i + 1))
+                                    ->id(),
+                        t);
+    }
+    EXPECT(assert_equal(bTe_path[t], PandaIKFast::forward(q), 1e-5));
+  }
+  const Values fk = robot.forwardKinematics(values, 0, std::string("link0"));
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(Pose(fk, link->id(), 0), Pose(values, link->id(), 0),
+                        1e-9));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
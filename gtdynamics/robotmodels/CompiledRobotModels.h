@@ -0,0 +1,29 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompiledRobotModels.h
+ * @brief The standard robot models, compiled into gtdynamics_robot_models.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/RobotModelRegistry.h>
+
+namespace gtdynamics {
+
+/**
+ * Register the robot models compiled into the gtdynamics_robot_models
+ * library with RobotModelRegistry: "a1", "vision60", "spider", "panda" and
+ * "jumping_robot", the latter with link "l0" fixed as in RobotModels.h.
+ * Call it once before RobotModelRegistry::Create; calling it again is
+ * harmless. Registration is explicit rather than from static initializers,
+ * which linkers drop from libraries none of whose symbols are used.
+ */
+void RegisterCompiledRobotModels();
+
+}  // namespace gtdynamics
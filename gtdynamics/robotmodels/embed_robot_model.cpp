@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  embed_robot_model.cpp
+ * @brief Build step converting a URDF/SDF model into a compiled-in blob.
+ *
+ * Usage: gtdynamics_embed_robot_model <name> <model file> <output.cpp>
+ *            [--model <model name in file>] [--fix <fixed link>]
+ * The output defines RegisterCompiledRobotModel_<name>(), which registers
+ * the blob of the robot with RobotModelRegistry under <name>.
+ */
+
+#include <gtdynamics/universal_robot/sdf.h>
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace gtdynamics;
+
+int main(int argc, char **argv) {
+  std::string model_name, fixed_link;
+  bool valid = argc >= 4 && argc % 2 == 0;
+  for (int i = 4; valid && i < argc; i += 2) {
+    const std::string option = argv[i];
+    if (option == "--model") {
+      model_name = argv[i + 1];
+    } else if (option == "--fix") {
+      fixed_link = argv[i + 1];
+    } else {
+      valid = false;
+    }
+  }
+  if (!valid) {
+    std::cerr << "Usage: " << argv[0]
+              << " <name> <model file> <output.cpp> [--model <model name>]"
+                 " [--fix <fixed link>]"
+              << std::endl;
+    return 1;
+  }
+  const std::string name = argv[1], file_path = argv[2], output = argv[3];
+
+  std::string blob;
+  try {
+    Robot robot = CreateRobotFromFile(file_path, model_name);
+    if (!fixed_link.empty()) robot = robot.fixLink(fixed_link);
+    blob = SerializeRobotBlob(robot);
+  } catch (const std::exception &e) {
+    std::cerr << argv[0] << ": " << file_path << ": " << e.what()
+              << std::endl;
+    return 1;
+  }
+
+  std::ofstream os(output);
+  os << "// Generated from " << file_path
+     << " by gtdynamics_embed_robot_model, do not edit.\n\n"
+     << "#include <gtdynamics/universal_robot/RobotModelRegistry.h>\n\n"
+     << "namespace gtdynamics {\n\n"
+     << "static const unsigned char kBlob[] = {";
+  for (size_t i = 0; i < blob.size(); i++) {
+    char byte[8];
+    std::snprintf(byte, sizeof(byte), "%u,",
+                  static_cast<unsigned char>(blob[i]));
+    os << (i % 20 == 0 ? "\n    " : "") << byte;
+  }
+  os << "\n};\n\n"
+     << "void RegisterCompiledRobotModel_" << name << "() {\n"
+     << "  RobotModelRegistry::Register(\"" << name << "\",\n"
+     << "      reinterpret_cast<const char *>(kBlob), sizeof(kBlob));\n"
+     << "}\n\n"
+     << "}  // namespace gtdynamics\n";
+  if (!os) {
+    std::cerr << argv[0] << ": could not write " << output << std::endl;
+    std::remove(output.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompiledRobotModels.cpp
+ * @brief Test the robot models compiled in as binary blobs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/robotmodels/CompiledRobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+// Compare the compiled-in model with the one parsed from its file, including
+// the joints of the links, which forward kinematics and graph builders use.
+static void CheckModel(const std::string &name, const Robot &expected,
+                       const std::string &root) {
+  const Robot actual = RobotModelRegistry::Create(name);
+  EXPECT_LONGS_EQUAL(expected.numLinks(), actual.numLinks());
+  EXPECT_LONGS_EQUAL(expected.numJoints(), actual.numJoints());
+  for (auto &&link : expected.links()) {
+    auto other = actual.link(link->name());
+    EXPECT_LONGS_EQUAL(link->id(), other->id());
+    EXPECT_DOUBLES_EQUAL(link->mass(), other->mass(), 1e-12);
+    EXPECT(assert_equal(link->bMcom(), other->bMcom(), 1e-12));
+    EXPECT(expected.isFixed(link) == actual.isFixed(other));
+  }
+  for (auto &&joint : expected.joints()) {
+    auto other = actual.joint(joint->name());
+    EXPECT_LONGS_EQUAL(joint->id(), other->id());
+    EXPECT(assert_equal(joint->jMc(), other->jMc(), 1e-12));
+  }
+  for (auto &&link : expected.links()) {
+    EXPECT_LONGS_EQUAL(link->numJoints(),
+                       actual.link(link->name())->numJoints());
+  }
+
+  gtsam::Values angles;
+  for (auto &&joint : expected.joints()) {
+    InsertJointAngle(&angles, joint->id(), 0.1 * joint->id());
+  }
+  EXPECT(assert_equal(expected.forwardKinematics(angles, 0, root),
+                      actual.forwardKinematics(angles, 0, root), 1e-9));
+
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const auto expected_graph = graph_builder.dynamicsFactorGraph(expected, 0);
+  const auto actual_graph = graph_builder.dynamicsFactorGraph(actual, 0);
+  EXPECT_LONGS_EQUAL(expected_graph.size(), actual_graph.size());
+  const gtsam::Values values = Initializer().ZeroValues(expected, 0, 0.1);
+  EXPECT_DOUBLES_EQUAL(expected_graph.error(values),
+                       actual_graph.error(values), 1e-9);
+}
+
+TEST(CompiledRobotModels, Registry) {
+  RegisterCompiledRobotModels();
+  for (const std::string name :
+       {"a1", "vision60", "spider", "panda", "jumping_robot"}) {
+    EXPECT(RobotModelRegistry::Has(name));
+  }
+  THROWS_EXCEPTION(RobotModelRegistry::Create("no_such_robot"));
+}
+
+TEST(CompiledRobotModels, SameAsFiles) {
+  RegisterCompiledRobotModels();
+  CheckModel("a1", CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf")),
+             "trunk");
+  CheckModel("vision60",
+             CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf")),
+             "body");
+  CheckModel("spider",
+             CreateRobotFromFile(kSdfPath + std::string("spider.sdf"),
+                                 "spider"),
+             "body");
+  CheckModel("panda",
+             CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf")),
+             "link0");
+  CheckModel("jumping_robot",
+             CreateRobotFromFile(kSdfPath +
+                                 std::string("test/jumping_robot.sdf"))
+                 .fixLink("l0"),
+             "l0");
+}
+
+TEST(CompiledRobotModels, Blob) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  const std::string blob = SerializeRobotBlob(robot);
+  const Robot actual = CreateRobotFromBlob(blob.data(), blob.size());
+  EXPECT_LONGS_EQUAL(robot.numLinks(), actual.numLinks());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), actual.numJoints());
+
+  std::string corrupt = blob;
+  corrupt.resize(corrupt.size() / 2);
+  THROWS_EXCEPTION(CreateRobotFromBlob(corrupt.data(), corrupt.size()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,177 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearStaticsSolver.cpp
+ * @brief Direct linear solve of the statics for many configurations.
+ */
+
+#include <gtdynamics/statics/LinearStaticsSolver.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/symbolic/SymbolicFactorGraph.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace gtdynamics {
+
+using gtsam::GaussianFactorGraph;
+using gtsam::JacobianFactor;
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Values;
+
+/* ************************************************************************* */
+LinearStaticsSolver::LinearStaticsSolver(
+    const Robot& robot, const Slice& slice,
+    const StaticsParameters& parameters,
+    const std::vector<int>& supported_links, double regularization_sigma)
+    : robot_(robot), slice_(slice) {
+  const Statics statics(parameters);
+  graph_.add(statics.staticWrenchFactors(slice, robot, supported_links));
+  graph_.add(statics.wrenchEquivalenceFactors(slice, robot));
+  graph_.add(statics.torqueFactors(slice, robot));
+  graph_.add(statics.wrenchPlanarFactors(slice, robot));
+
+  for (auto&& link : robot.links()) {
+    known_keys_.insert(PoseKey(link->id(), slice.k));
+  }
+  for (auto&& joint : robot.joints()) {
+    known_keys_.insert(JointAngleKey(joint->id(), slice.k));
+  }
+  zeros_ = statics.initialValues(slice, robot);
+
+  // The structure only depends on which keys are unknown.
+  gtsam::SymbolicFactorGraph structure;
+  for (auto&& factor : graph_) {
+    gtsam::KeyVector keys;
+    for (Key key : factor->keys()) {
+      if (!known_keys_.count(key)) keys.push_back(key);
+    }
+    structure.push_back(gtsam::SymbolicFactor::FromKeys(keys));
+  }
+  ordering_ = gtsam::Ordering::Colamd(structure);
+
+  if (regularization_sigma > 0) {
+    for (Key key : zeros_.keys()) {
+      const size_t dim = zeros_.at(key).dim();
+      regularization_.emplace_shared<JacobianFactor>(
+          key, Matrix::Identity(dim, dim), gtsam::Vector::Zero(dim),
+          InternedIsotropic(dim, regularization_sigma));
+    }
+  }
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph LinearStaticsSolver::linearSystem(
+    const Values& configuration) const {
+  Values values = zeros_;
+  for (Key key : known_keys_) values.insert(key, configuration.at(key));
+
+  // The factors are linear in the unknowns, so linearizing at zero is exact.
+  // The known keys do not move, so their columns are dropped.
+  GaussianFactorGraph linear;
+  for (auto&& factor : graph_) {
+    const auto jacobian =
+        boost::dynamic_pointer_cast<JacobianFactor>(factor->linearize(values));
+    std::vector<std::pair<Key, Matrix>> terms;
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      if (!known_keys_.count(*it)) terms.emplace_back(*it, jacobian->getA(it));
+    }
+    linear.emplace_shared<JacobianFactor>(terms, jacobian->getb(),
+                                          jacobian->get_model());
+  }
+  linear += regularization_;
+  return linear;
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues LinearStaticsSolver::solveLinear(
+    const Values& configuration, double* error) const {
+  const GaussianFactorGraph system = linearSystem(configuration);
+  gtsam::VectorValues results = system.optimize(ordering_);
+  if (error) {
+    // The statics factors come first, then the regularization.
+    *error = 0.0;
+    for (size_t i = 0; i < graph_.size(); i++) {
+      *error += system[i]->error(results);
+    }
+  }
+  return results;
+}
+
+/* ************************************************************************* */
+Values LinearStaticsSolver::solve(const Values& configuration) const {
+  const gtsam::VectorValues results = solveLinear(configuration);
+
+  Values values = configuration;
+  const int k = slice_.k;
+  try {
+    for (auto&& joint : robot_.joints()) {
+      const int j = joint->id();
+      InsertTorque(&values, j, k, Torque(results, j, k)[0]);
+      InsertWrench(&values, joint->parent()->id(), j, k,
+                   Wrench(results, joint->parent()->id(), j, k));
+      InsertWrench(&values, joint->child()->id(), j, k,
+                   Wrench(results, joint->child()->id(), j, k));
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists&) {
+    throw std::invalid_argument(
+        "LinearStaticsSolver: configuration should contain no torques or "
+        "wrenches.");
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+StaticsBatchResult LinearStaticsSolver::solveBatch(const gtsam::Matrix& qs,
+                                                   double max_error) const {
+  const auto& joints = robot_.joints();
+  const size_t num_joints = joints.size();
+  const size_t num_samples = qs.cols();
+  if (size_t(qs.rows()) != num_joints) {
+    throw std::invalid_argument(
+        "LinearStaticsSolver::solveBatch: qs should be num_joints x "
+        "num_samples.");
+  }
+
+  StaticsBatchResult result;
+  result.torques.resize(num_joints, num_samples);
+  result.errors.resize(num_samples);
+  result.feasible.assign(num_samples, 0);
+
+  // Each sample writes its own column and entries, so no locking is needed.
+  const int k = slice_.k;
+  auto solve_sample = [&](size_t s) {
+    Values angles;
+    for (size_t j = 0; j < num_joints; j++) {
+      InsertJointAngle(&angles, joints[j]->id(), k, qs(j, s));
+    }
+    double error;
+    const gtsam::VectorValues results =
+        solveLinear(robot_.forwardKinematics(angles, k), &error);
+
+    bool feasible = error <= max_error;
+    for (size_t j = 0; j < num_joints; j++) {
+      const double tau = Torque(results, joints[j]->id(), k)[0];
+      result.torques(j, s) = tau;
+      feasible = feasible &&
+                 std::abs(tau) <= joints[j]->parameters().torque_limit;
+    }
+    result.errors(s) = error;
+    result.feasible[s] = feasible;
+  };
+
+  ParallelFor(num_samples, solve_sample);
+  return result;
+}
+
+}  // namespace gtdynamics
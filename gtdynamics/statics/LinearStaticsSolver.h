@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearStaticsSolver.h
+ * @brief Direct linear solve of the statics for many configurations.
+ */
+
+#pragma once
+
+#include <gtdynamics/statics/Statics.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Results of LinearStaticsSolver::solveBatch, one column or entry per sample.
+struct StaticsBatchResult {
+  gtsam::Matrix torques;       ///< num_joints x num_samples
+  gtsam::Vector errors;        ///< error of the statics factors
+  std::vector<char> feasible;  ///< balanced and within torque limits
+
+  StaticsBatchResult() {}
+};
+
+/**
+ * LinearStaticsSolver solves for the wrenches and torques that hold a robot
+ * at rest in given configurations, as Statics::solve does, but with one
+ * linear solve per configuration instead of a nonlinear optimization.
+ *
+ * With the poses and joint angles known, the factors of Statics::graph are
+ * linear in the wrenches and torques. The graph, the elimination ordering
+ * and any regularization are built once for the robot and the set of
+ * supported links; each solve only relinearizes the factors at the given
+ * configuration, keeps the columns of the unknowns, and eliminates.
+ *
+ * With several supported links the wrenches are not unique, so a weak zero
+ * prior on all wrenches and torques selects the smallest ones. Its sigma
+ * should be much larger than those of the statics, so it does not bias
+ * statically determinate problems.
+ */
+class LinearStaticsSolver {
+ private:
+  Robot robot_;
+  Slice slice_;
+  gtsam::NonlinearFactorGraph graph_;
+  gtsam::GaussianFactorGraph regularization_;
+  gtsam::KeySet known_keys_;  // poses and joint angles
+  gtsam::Values zeros_;       // wrenches and torques
+  gtsam::Ordering ordering_;
+
+  // Solve at a configuration, and return the error of the statics factors.
+  gtsam::VectorValues solveLinear(const gtsam::Values& configuration,
+                                  double* error = nullptr) const;
+
+ public:
+  /**
+   * Constructor
+   * @param robot                 Robot specification from URDF/SDF.
+   * @param slice                 Slice instance.
+   * @param parameters            noise models, gravity and planar axis
+   * @param supported_links       ids of links supported by the environment
+   * @param regularization_sigma  sigma of the zero prior on the unknowns, or
+   *                              zero for none
+   */
+  LinearStaticsSolver(
+      const Robot& robot, const Slice& slice,
+      const StaticsParameters& parameters = StaticsParameters(),
+      const std::vector<int>& supported_links = {},
+      double regularization_sigma = 1.0);
+
+  /// Return the linear system at a configuration, over wrenches and torques.
+  gtsam::GaussianFactorGraph linearSystem(
+      const gtsam::Values& configuration) const;
+
+  /**
+   * Solve for wrenches and torques.
+   * @param configuration  poses and joint angles at slice.k
+   * @returns the configuration with wrenches and torques.
+   */
+  gtsam::Values solve(const gtsam::Values& configuration) const;
+
+  /**
+   * Solve the statics for many joint configurations at once, concurrently
+   * when GTSAM is built with TBB. Poses are obtained by forward kinematics
+   * from the root link at its default pose. A sample is feasible when the
+   * error of the statics factors is at most max_error, i.e. the robot can be
+   * held at rest, and all torques are within the joint torque limits.
+   * @param qs         joint angles, num_joints x num_samples, rows ordered as
+   *                   robot.joints()
+   * @param max_error  largest error of the statics factors for feasibility
+   * @returns torques, rows ordered as robot.joints(), errors and flags.
+   */
+  StaticsBatchResult solveBatch(const gtsam::Matrix& qs,
+                                double max_error = 1.0) const;
+
+  /// Return the elimination ordering used by every solve.
+  const gtsam::Ordering& ordering() const { return ordering_; }
+};
+
+}  // namespace gtdynamics
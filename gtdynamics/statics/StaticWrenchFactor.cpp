@@ -55,4 +55,27 @@ Vector StaticWrenchFactor::unwhitenedError(
                          gravity_, H);
 }
 
+gtsam::NonlinearFactor::shared_ptr CreateStaticWrenchFactor(
+    const std::vector<DynamicsSymbol> &wrench_keys, gtsam::Key pose_key,
+    const gtsam::noiseModel::Base::shared_ptr &cost_model, double mass,
+    const boost::optional<gtsam::Vector3> &gravity) {
+  switch (wrench_keys.size()) {
+    case 1:
+      return MakeFactor<FixedStaticWrenchFactor<1>>(wrench_keys, pose_key,
+                                                    cost_model, mass, gravity);
+    case 2:
+      return MakeFactor<FixedStaticWrenchFactor<2>>(wrench_keys, pose_key,
+                                                    cost_model, mass, gravity);
+    case 3:
+      return MakeFactor<FixedStaticWrenchFactor<3>>(wrench_keys, pose_key,
+                                                    cost_model, mass, gravity);
+    case 4:
+      return MakeFactor<FixedStaticWrenchFactor<4>>(wrench_keys, pose_key,
+                                                    cost_model, mass, gravity);
+    default:
+      return MakeFactor<StaticWrenchFactor>(wrench_keys, pose_key, cost_model,
+                                            mass, gravity);
+  }
+}
+
 }  // namespace gtdynamics
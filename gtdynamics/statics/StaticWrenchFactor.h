@@ -13,7 +13,9 @@
 
 #pragma once
 
+#include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/FactorArena.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -23,6 +25,7 @@
 
 #include <boost/optional.hpp>
 #include <boost/serialization/base_object.hpp>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -87,4 +90,108 @@ class StaticWrenchFactor : public gtsam::NoiseModelFactor {
   }
 };
 
+/**
+ * FixedStaticWrenchFactor is StaticWrenchFactor for a link with exactly N
+ * wrenches, the common case of links with one to four joints. Wrenches are
+ * summed in fixed-size vectors, without collecting them in a std::vector, and
+ * the Jacobians are written as fixed-size blocks: identity for each wrench and
+ * the gravity Jacobian, or zero, for the pose.
+ *
+ * Keys are ordered as for StaticWrenchFactor: N wrenches, then the pose.
+ */
+template <size_t N>
+class FixedStaticWrenchFactor : public gtsam::NoiseModelFactor {
+  static_assert(N > 0, "FixedStaticWrenchFactor needs at least one wrench.");
+  using This = FixedStaticWrenchFactor<N>;
+  using Base = gtsam::NoiseModelFactor;
+  double mass_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+ public:
+  /**
+   * Static wrench balance factor with N wrenches.
+   * @param wrench_keys Keys for unknown external wrenches, N of them.
+   * @param pose_key Key for link CoM pose.
+   * @param cost_model Cost model to regulate constraint.
+   * @param mass Mass for this link.
+   * @param gravity (optional) Gravity vector in world frame.
+   */
+  FixedStaticWrenchFactor(
+      const std::vector<DynamicsSymbol> &wrench_keys, gtsam::Key pose_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model, double mass,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none)
+      : Base(cost_model, wrench_keys), mass_(mass), gravity_(gravity) {
+    if (wrench_keys.size() != N) {
+      throw std::invalid_argument(
+          "FixedStaticWrenchFactor: wrong number of wrench keys.");
+    }
+    keys_.push_back(pose_key);
+  }
+
+  /**
+   * Evaluate the sum of the wrenches and the gravity wrench.
+   * @param values contains the pose and wrenches acting on the link.
+   * @param H Jacobians, in the order: *wrenches, pose
+   */
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    if (!this->active(x)) return gtsam::Vector::Zero(this->dim());
+
+    gtsam::Vector6 error = x.at<gtsam::Vector6>(keys_[0]);
+    for (size_t i = 1; i < N; i++) error += x.at<gtsam::Vector6>(keys_[i]);
+
+    gtsam::Matrix6 H_pose;
+    if (gravity_) {
+      error += GravityWrench(*gravity_, mass_, x.at<gtsam::Pose3>(keys_[N]),
+                             H ? &H_pose : nullptr);
+    } else if (H) {
+      H_pose.setZero();
+    }
+
+    if (H) {
+      H->resize(N + 1);
+      for (size_t i = 0; i < N; i++) (*H)[i] = gtsam::I_6x6;
+      (*H)[N] = H_pose;
+    }
+    return error;
+  }
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        MakeFactor<This>(*this));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "static wrench factor (" << N << " wrenches)"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(mass_);
+    ar &BOOST_SERIALIZATION_NVP(gravity_);
+  }
+};
+
+/**
+ * Create the static wrench factor of a link: a FixedStaticWrenchFactor for
+ * one to four wrenches, and a StaticWrenchFactor otherwise. Arguments are
+ * those of StaticWrenchFactor.
+ */
+gtsam::NonlinearFactor::shared_ptr CreateStaticWrenchFactor(
+    const std::vector<DynamicsSymbol> &wrench_keys, gtsam::Key pose_key,
+    const gtsam::noiseModel::Base::shared_ptr &cost_model, double mass,
+    const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
 }  // namespace gtdynamics
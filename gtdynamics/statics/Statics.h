@@ -14,11 +14,14 @@
 #pragma once
 
 #include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
 #include <gtdynamics/utils/Slice.h>
 #include <gtsam/base/OptionalJacobian.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 
+#include <vector>
+
 namespace gtdynamics {
 
 /**
@@ -73,9 +76,9 @@ struct StaticsParameters : public KinematicsParameters {
       const boost::optional<gtsam::Vector3>& planar_axis = boost::none)
       : gravity(gravity),
         planar_axis(planar_axis),
-        fs_cost_model(Isotropic::Sigma(6, 1e-4)),
-        f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_dynamics)) {}
+        fs_cost_model(InternedIsotropic(6, 1e-4)),
+        f_cost_model(InternedIsotropic(6, sigma_dynamics)),
+        t_cost_model(InternedIsotropic(1, sigma_dynamics)) {}
 };
 
 /// Algorithms for Statics, i.e. kinematics + wrenches at rest
@@ -90,6 +93,15 @@ class Statics : public Kinematics {
   Statics(const StaticsParameters& parameters = StaticsParameters())
       : Kinematics(parameters), p_(parameters) {}
 
+  /**
+   * Graph with a StaticWrenchFactor for each link, except for fixed links and
+   * the given supported links, e.g. feet in contact, on which the environment
+   * exerts whatever wrench is needed.
+   */
+  gtsam::NonlinearFactorGraph staticWrenchFactors(
+      const Slice& slice, const Robot& robot,
+      const std::vector<int>& supported_links = {}) const;
+
   /// Graph with a WrenchEquivalenceFactor for each joint
   gtsam::NonlinearFactorGraph wrenchEquivalenceFactors(
       const Slice& slice, const Robot& robot) const;
@@ -129,6 +141,22 @@ class Statics : public Kinematics {
   gtsam::Values solve(const Slice& slice, const Robot& robot,
                       const gtsam::Values& configuration) const;
 
+  /**
+   * Solve for wrenches given kinematics configuration, with a linear solve.
+   * Given the poses and joint angles the statics are linear in the wrenches
+   * and torques, so this gives the same result as solve without iterating.
+   * To solve many configurations, use a LinearStaticsSolver, which caches
+   * the structure of the linear system.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param configuration A known kinematics configuration.
+   * @param supported_links ids of links supported by the environment.
+   */
+  gtsam::Values linearSolveStatics(
+      const Slice& slice, const Robot& robot,
+      const gtsam::Values& configuration,
+      const std::vector<int>& supported_links = {}) const;
+
   /**
    * Solve for wrenches and kinematics configuration.
    * @param slice Slice instance.
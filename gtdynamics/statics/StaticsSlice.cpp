@@ -14,13 +14,17 @@
 #include <gtdynamics/factors/TorqueFactor.h>             // TODO: move
 #include <gtdynamics/factors/WrenchEquivalenceFactor.h>  // TODO: move
 #include <gtdynamics/factors/WrenchPlanarFactor.h>       // TODO: move
+#include <gtdynamics/statics/LinearStaticsSolver.h>
 #include <gtdynamics/statics/StaticWrenchFactor.h>
 #include <gtdynamics/statics/Statics.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
 #include <gtsam/linear/Sampler.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/NonlinearEquality.h>
 
+#include <algorithm>
+
 namespace gtdynamics {
 using gtsam::assert_equal;
 using gtsam::Point3;
@@ -28,6 +32,32 @@ using gtsam::Pose3;
 using std::map;
 using std::string;
 
+gtsam::NonlinearFactorGraph Statics::staticWrenchFactors(
+    const Slice& slice, const Robot& robot,
+    const std::vector<int>& supported_links) const {
+  gtsam::NonlinearFactorGraph graph;
+  const auto k = slice.k;
+  for (auto&& link : robot.links()) {
+    int i = link->id();
+    if (robot.isFixed(link)) continue;
+    if (std::find(supported_links.begin(), supported_links.end(), i) !=
+        supported_links.end())
+      continue;
+    const auto& connected_joints = link->joints();
+    std::vector<DynamicsSymbol> wrench_keys;
+
+    // Add wrench keys for joints.
+    for (auto&& joint : connected_joints)
+      wrench_keys.push_back(WrenchKey(i, joint->id(), k));
+
+    // Add static wrench factor for link.
+    graph.add(CreateStaticWrenchFactor(wrench_keys, PoseKey(link->id(), k),
+                                       p_.fs_cost_model, link->mass(),
+                                       p_.gravity));
+  }
+  return graph;
+}
+
 gtsam::NonlinearFactorGraph Statics::wrenchEquivalenceFactors(
     const Slice& slice, const Robot& robot) const {
   gtsam::NonlinearFactorGraph graph;
@@ -60,24 +90,9 @@ gtsam::NonlinearFactorGraph Statics::wrenchPlanarFactors(
 gtsam::NonlinearFactorGraph Statics::graph(const Slice& slice,
                                            const Robot& robot) const {
   gtsam::NonlinearFactorGraph graph;
-  const auto k = slice.k;
 
   // Add static wrench factors for all links
-  for (auto&& link : robot.links()) {
-    int i = link->id();
-    if (link->isFixed()) continue;
-    const auto& connected_joints = link->joints();
-    std::vector<DynamicsSymbol> wrench_keys;
-
-    // Add wrench keys for joints.
-    for (auto&& joint : connected_joints)
-      wrench_keys.push_back(WrenchKey(i, joint->id(), k));
-
-    // Add static wrench factor for link.
-    graph.emplace_shared<StaticWrenchFactor>(
-        wrench_keys, PoseKey(link->id(), k), p_.fs_cost_model, link->mass(),
-        p_.gravity);
-  }
+  graph.add(staticWrenchFactors(slice, robot));
 
   /// Add a WrenchEquivalenceFactor for each joint.
   graph.add(wrenchEquivalenceFactors(slice, robot));
@@ -96,8 +111,7 @@ gtsam::Values Statics::initialValues(const Slice& slice, const Robot& robot,
   gtsam::Values values;
   const auto k = slice.k;
 
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
+  auto sampler_noise_model = InternedIsotropic(6, gaussian_noise);
   gtsam::Sampler sampler(sampler_noise_model);
 
   // Initialize wrenches and torques to 0.
@@ -139,6 +153,13 @@ gtsam::Values Statics::solve(const Slice& slice, const Robot& robot,
   return optimize(graph, initial_values);
 }
 
+gtsam::Values Statics::linearSolveStatics(
+    const Slice& slice, const Robot& robot, const gtsam::Values& configuration,
+    const std::vector<int>& supported_links) const {
+  return LinearStaticsSolver(robot, slice, p_, supported_links)
+      .solve(configuration);
+}
+
 gtsam::Values Statics::minimizeTorques(const Slice& slice,
                                        const Robot& robot) const {
   auto graph = this->graph(slice, robot);
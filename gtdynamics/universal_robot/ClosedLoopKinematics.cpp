@@ -0,0 +1,189 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ClosedLoopKinematics.cpp
+ * @brief Forward kinematics of closed chains: spanning-tree kinematics and a
+ * Newton solve on the loop-closure constraints of the cut joints.
+ */
+
+#include <gtdynamics/universal_robot/ClosedLoopKinematics.h>
+#include <gtdynamics/utils/values.h>
+
+#include <Eigen/QR>
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ClosedLoopKinematics::ClosedLoopKinematics(
+    const Robot &robot, const std::string &root_name,
+    const std::vector<std::string> &independent,
+    const ClosedLoopKinematicsParams &params)
+    : fk_(robot, root_name), params_(params) {
+  const ForwardKinematicsPlan &plan = fk_.plan();
+  const auto &steps = plan.steps();
+  independent_.assign(plan.numJointSlots(), false);
+  joint_loops_.resize(plan.numJointSlots());
+  for (auto &&name : independent) independent_[robot.joint(name)->id()] = true;
+  for (auto &&link : robot.links()) link_ids_.push_back(link->id());
+
+  // The step reaching each link, and the tree joints.
+  std::vector<int> link_step(plan.numLinkSlots(), -1);
+  std::vector<bool> in_tree(plan.numJointSlots(), false);
+  for (size_t i = 0; i < steps.size(); i++) {
+    link_step[steps[i].to_id] = i;
+    in_tree[steps[i].joint_id] = true;
+  }
+
+  // Joints from a link up to the root.
+  auto ancestors = [&](int link_id) -> std::set<int> {
+    std::set<int> joints;
+    for (int s = link_step[link_id]; s >= 0; s = link_step[steps[s].from_id]) {
+      joints.insert(steps[s].joint_id);
+    }
+    return joints;
+  };
+
+  // Each joint not in the tree closes a loop through the tree joints from
+  // its parent and child links up to their common ancestor.
+  std::set<int> loop_joints;
+  for (auto &&joint : robot.joints()) {
+    joint_ids_.push_back(joint->id());
+    if (in_tree[joint->id()]) continue;
+    Loop loop{joint, JointKernel(*joint), joint->id(), joint->parent()->id(),
+              joint->child()->id(), {}};
+    const std::set<int> parent = ancestors(loop.parent_id),
+                        child = ancestors(loop.child_id);
+    std::set_symmetric_difference(parent.begin(), parent.end(), child.begin(),
+                                  child.end(),
+                                  std::back_inserter(loop.joints));
+    loop.joints.push_back(loop.joint_id);
+    for (int j : loop.joints) {
+      joint_loops_[j].push_back(loops_.size());
+      loop_joints.insert(j);
+    }
+    loops_.push_back(loop);
+  }
+  loop_joints_.assign(loop_joints.begin(), loop_joints.end());
+  for (int j : loop_joints_) {
+    if (!independent_[j]) dependent_.push_back(j);
+  }
+}
+
+/* ************************************************************************* */
+Vector6 ClosedLoopKinematics::residual(const Loop &loop) const {
+  const Pose3 wTc = fk_.pose(loop.parent_id) *
+                    loop.kernel.parentTchild(fk_.jointAngles()(loop.joint_id));
+  return Pose3::Logmap(wTc.inverse() * fk_.pose(loop.child_id));
+}
+
+/* ************************************************************************* */
+Vector ClosedLoopKinematics::residuals() const {
+  Vector r(6 * loops_.size());
+  for (size_t l = 0; l < loops_.size(); l++) {
+    r.segment<6>(6 * l) = residual(loops_[l]);
+  }
+  return r;
+}
+
+/* ************************************************************************* */
+Matrix ClosedLoopKinematics::jacobian(const std::vector<int> &joints) {
+  // Only the loops through a joint depend on its angle.
+  Matrix J = Matrix::Zero(6 * loops_.size(), joints.size());
+  const double delta = params_.delta;
+  for (size_t k = 0; k < joints.size(); k++) {
+    const int j = joints[k];
+    const double q = fk_.jointAngles()(j);
+    fk_.setJointAngle(j, q + delta);
+    fk_.update();
+    for (size_t l : joint_loops_[j]) {
+      J.block<6, 1>(6 * l, k) = residual(loops_[l]);
+    }
+    fk_.setJointAngle(j, q - delta);
+    fk_.update();
+    for (size_t l : joint_loops_[j]) {
+      J.block<6, 1>(6 * l, k) =
+          (J.block<6, 1>(6 * l, k) - residual(loops_[l])) / (2 * delta);
+    }
+    fk_.setJointAngle(j, q);
+    fk_.update();
+  }
+  return J;
+}
+
+/* ************************************************************************* */
+bool ClosedLoopKinematics::solve(const Vector &q, const Vector &q_dot,
+                                 const Pose3 &wTroot, const Vector6 &V_root) {
+  fk_.setRoot(wTroot, V_root);
+  fk_.setJointAngles(q);
+  fk_.setJointVels(q_dot);
+  fk_.update();
+
+  // Gauss-Newton on the loop residuals, with minimum-norm steps.
+  bool converged = false;
+  for (iterations_ = 0;; iterations_++) {
+    const Vector r = residuals();
+    error_ = r.norm();
+    converged = error_ <= params_.tolerance;
+    if (converged || iterations_ == params_.max_iterations ||
+        dependent_.empty()) {
+      break;
+    }
+    const Matrix J = jacobian(dependent_);
+    const Vector dq = J.completeOrthogonalDecomposition().solve(-r);
+    for (size_t k = 0; k < dependent_.size(); k++) {
+      const int j = dependent_[k];
+      fk_.setJointAngle(j, fk_.jointAngles()(j) + dq(k));
+    }
+    fk_.update();
+  }
+
+  // The loop constraints hold along the motion, so J_d v_d = -J_i v_i.
+  if (!dependent_.empty()) {
+    const Matrix J = jacobian(loop_joints_);
+    Matrix J_d(J.rows(), dependent_.size());
+    Vector b = Vector::Zero(J.rows());
+    for (size_t k = 0, d = 0; k < loop_joints_.size(); k++) {
+      const int j = loop_joints_[k];
+      if (independent_[j]) {
+        b -= J.col(k) * q_dot(j);
+      } else {
+        J_d.col(d++) = J.col(k);
+      }
+    }
+    const Vector v_d = J_d.completeOrthogonalDecomposition().solve(b);
+    for (size_t k = 0; k < dependent_.size(); k++) {
+      fk_.setJointVel(dependent_[k], v_d(k));
+    }
+    fk_.update();
+  }
+  return converged;
+}
+
+/* ************************************************************************* */
+gtsam::Values ClosedLoopKinematics::values(size_t t) const {
+  gtsam::Values result;
+  for (int j : joint_ids_) {
+    InsertJointAngle(&result, j, t, fk_.jointAngles()(j));
+    InsertJointVel(&result, j, t, fk_.jointVels()(j));
+  }
+  for (int i : link_ids_) {
+    InsertPose(&result, i, t, fk_.pose(i));
+    InsertTwist(&result, i, t, fk_.twist(i));
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ClosedLoopKinematics.h
+ * @brief Forward kinematics of closed chains: spanning-tree kinematics and a
+ * Newton solve on the loop-closure constraints of the cut joints.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/IncrementalForwardKinematics.h>
+#include <gtdynamics/universal_robot/JointKernel.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of ClosedLoopKinematics.
+struct ClosedLoopKinematicsParams {
+  size_t max_iterations = 20;  // Newton iterations
+  double tolerance = 1e-10;    // on the norm of the loop residuals
+  double delta = 1e-6;         // finite-difference step of the loop Jacobian
+
+  ClosedLoopKinematicsParams() {}
+};
+
+/**
+ * ClosedLoopKinematics computes the forward kinematics of robots with
+ * kinematic loops, e.g., four-bar linkages and parallel mechanisms. The
+ * spanning tree of a ForwardKinematicsPlan is cached per robot, and each
+ * joint it does not traverse is a cut joint, whose loop-closure constraint
+ * is that its child link pose follows from its parent link pose and angle.
+ *
+ * Given the angles of the independent joints, the angles of the other joints
+ * on the loops are found by a Gauss-Newton solve on the loop residuals only,
+ * with minimum-norm steps for redundant constraints, e.g., of planar loops.
+ * The loop Jacobian only has entries for the joints on each loop, and each
+ * column is computed by re-evaluating the subtree below its joint. Joint
+ * velocities of the dependent joints then follow from the independent ones
+ * through the same Jacobian.
+ */
+class ClosedLoopKinematics {
+ public:
+  /// A loop closed by a cut joint.
+  struct Loop {
+    JointSharedPtr joint;  // the cut joint
+    JointKernel kernel;
+    int joint_id, parent_id, child_id;
+    std::vector<int> joints;  // ids of the joints on the loop, with the cut
+  };
+
+ private:
+  IncrementalForwardKinematics fk_;
+  ClosedLoopKinematicsParams params_;
+  std::vector<Loop> loops_;
+  std::vector<int> joint_ids_, link_ids_;
+  std::vector<bool> independent_;              // indexed by joint id
+  std::vector<std::vector<size_t>> joint_loops_;  // loops of each joint id
+  std::vector<int> dependent_, loop_joints_;
+  size_t iterations_ = 0;
+  double error_ = 0;
+
+  // Residuals of all loops at the current state.
+  gtsam::Vector residuals() const;
+
+  // Residual of one loop at the current state.
+  gtsam::Vector6 residual(const Loop &loop) const;
+
+  // Jacobian of the residuals with respect to the angles of some joints.
+  gtsam::Matrix jacobian(const std::vector<int> &joints);
+
+ public:
+  /**
+   * Constructor
+   * @param robot         the robot
+   * @param root_name     name of the link with known pose and twist
+   * @param independent   names of the joints whose angles are given
+   * @param params        solver parameters
+   */
+  ClosedLoopKinematics(
+      const Robot &robot, const std::string &root_name,
+      const std::vector<std::string> &independent,
+      const ClosedLoopKinematicsParams &params = ClosedLoopKinematicsParams());
+
+  /// Return the loops, one per cut joint.
+  const std::vector<Loop> &loops() const { return loops_; }
+
+  /// Return the ids of the joints on loops whose angles are solved for.
+  const std::vector<int> &dependentJoints() const { return dependent_; }
+
+  /**
+   * Solve for the dependent joints, and compute all link poses and twists.
+   * @param q       joint angles indexed by joint id: given for independent
+   *                joints, initial guesses for dependent ones
+   * @param q_dot   joint velocities indexed by joint id, only read for
+   *                independent joints
+   * @param wTroot  pose of the root link CoM
+   * @param V_root  twist of the root link CoM
+   * @return whether the loop residuals converged within the tolerance
+   */
+  bool solve(const gtsam::Vector &q, const gtsam::Vector &q_dot,
+             const gtsam::Pose3 &wTroot = gtsam::Pose3(),
+             const gtsam::Vector6 &V_root = gtsam::Vector6::Zero());
+
+  /// Return the number of Newton iterations of the last solve.
+  size_t iterations() const { return iterations_; }
+
+  /// Return the norm of the loop residuals after the last solve.
+  double error() const { return error_; }
+
+  /// Return the joint angles, indexed by joint id.
+  const gtsam::Vector &jointAngles() const { return fk_.jointAngles(); }
+
+  /// Return the joint velocities, indexed by joint id.
+  const gtsam::Vector &jointVels() const { return fk_.jointVels(); }
+
+  /// Return the CoM pose of link i.
+  const gtsam::Pose3 &pose(int i) const { return fk_.pose(i); }
+
+  /// Return the CoM twist of link i.
+  const gtsam::Vector6 &twist(int i) const { return fk_.twist(i); }
+
+  /**
+   * Return the joint angles and velocities, and the link poses and twists,
+   * at time step t, e.g., to initialize a factor graph.
+   */
+  gtsam::Values values(size_t t = 0) const;
+};
+
+}  // namespace gtdynamics
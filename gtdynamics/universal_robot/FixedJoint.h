@@ -45,7 +45,7 @@ class FixedJoint : public Joint {
    * @param[in] parent_link   Shared pointer to the parent Link.
    * @param[in] child_link    Shared pointer to the child Link.
    */
-  FixedJoint(unsigned char id, const std::string &name, const gtsam::Pose3 &bTj,
+  FixedJoint(uint16_t id, const std::string &name, const gtsam::Pose3 &bTj,
              const LinkSharedPtr &parent_link, const LinkSharedPtr &child_link)
       : Joint(id, name, bTj, parent_link, child_link, gtsam::Vector6::Zero(),
               fixedJointParams()) {}
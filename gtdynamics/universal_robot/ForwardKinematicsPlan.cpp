@@ -0,0 +1,241 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ForwardKinematicsPlan.cpp
+ * @brief Precompiled forward kinematics traversal with flat outputs.
+ */
+
+#include <gtdynamics/universal_robot/ForwardKinematicsPlan.h>
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+using PoseArray = ForwardKinematicsPlan::PoseArray;
+using RowArray = Eigen::Array<double, 1, Eigen::Dynamic>;
+
+// Row of rotation entry (i, j) and of translation entry i in a PoseArray.
+static inline int RotRow(int i, int j) { return 3 * i + j; }
+static inline int TransRow(int i) { return 9 + i; }
+
+// out = exp(screw * q), coefficient-wise over all configurations.
+static void ExpmapArray(const Vector6 &screw, const RowArray &q,
+                        PoseArray *out) {
+  const double norm = screw.head<3>().norm();
+  out->resize(12, q.cols());
+  if (norm < 1e-9) {
+    // Pure translation.
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        out->row(RotRow(i, j)).setConstant(double(i == j));
+      }
+      out->row(TransRow(i)) = screw(3 + i) * q;
+    }
+    return;
+  }
+
+  // Rodrigues' formula with unit axis w, for angles theta = norm * q.
+  const gtsam::Vector3 w = screw.head<3>() / norm, v = screw.tail<3>() / norm;
+  const gtsam::Vector3 w_cross_v = w.cross(v);
+  const double w_dot_v = w.dot(v);
+  const RowArray theta = norm * q;
+  const RowArray c = theta.cos(), s = theta.sin(), one_minus_c = 1.0 - c;
+  const gtsam::Matrix3 W = gtsam::skewSymmetric(w);
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      out->row(RotRow(i, j)) =
+          double(i == j) * c + W(i, j) * s + w(i) * w(j) * one_minus_c;
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    out->row(TransRow(i)) = w_cross_v(i) + w(i) * w_dot_v * theta;
+    for (int j = 0; j < 3; j++) {
+      out->row(TransRow(i)) -= out->row(RotRow(i, j)) * w_cross_v(j);
+    }
+  }
+}
+
+// out = A * B, with constant A.
+static void ComposeArray(const Pose3 &A, const PoseArray &B, PoseArray *out) {
+  const gtsam::Matrix3 RA = A.rotation().matrix();
+  const gtsam::Vector3 tA = A.translation();
+  out->resize(12, B.cols());
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      out->row(RotRow(i, j)) = RA(i, 0) * B.row(RotRow(0, j)) +
+                               RA(i, 1) * B.row(RotRow(1, j)) +
+                               RA(i, 2) * B.row(RotRow(2, j));
+    }
+    out->row(TransRow(i)) = RA(i, 0) * B.row(TransRow(0)) +
+                            RA(i, 1) * B.row(TransRow(1)) +
+                            RA(i, 2) * B.row(TransRow(2)) + tA(i);
+  }
+}
+
+// out = A * B.
+static void ComposeArray(const PoseArray &A, const PoseArray &B,
+                         PoseArray *out) {
+  out->resize(12, B.cols());
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      out->row(RotRow(i, j)) = A.row(RotRow(i, 0)) * B.row(RotRow(0, j)) +
+                               A.row(RotRow(i, 1)) * B.row(RotRow(1, j)) +
+                               A.row(RotRow(i, 2)) * B.row(RotRow(2, j));
+    }
+    out->row(TransRow(i)) = A.row(RotRow(i, 0)) * B.row(TransRow(0)) +
+                            A.row(RotRow(i, 1)) * B.row(TransRow(1)) +
+                            A.row(RotRow(i, 2)) * B.row(TransRow(2)) +
+                            A.row(TransRow(i));
+  }
+}
+
+// out = A^-1.
+static void InverseArray(const PoseArray &A, PoseArray *out) {
+  out->resize(12, A.cols());
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) out->row(RotRow(i, j)) = A.row(RotRow(j, i));
+  }
+  for (int i = 0; i < 3; i++) {
+    out->row(TransRow(i)) = -(A.row(RotRow(0, i)) * A.row(TransRow(0)) +
+                              A.row(RotRow(1, i)) * A.row(TransRow(1)) +
+                              A.row(RotRow(2, i)) * A.row(TransRow(2)));
+  }
+}
+
+/* ************************************************************************* */
+ForwardKinematicsPlan::ForwardKinematicsPlan(const Robot &robot,
+                                             const std::string &root_name) {
+  const LinkSharedPtr root = robot.link(root_name);
+  root_id_ = root->id();
+  for (auto &&link : robot.links()) {
+    num_link_slots_ = std::max<size_t>(num_link_slots_, link->id() + 1);
+  }
+  for (auto &&joint : robot.joints()) {
+    num_joint_slots_ = std::max<size_t>(num_joint_slots_, joint->id() + 1);
+  }
+
+  // Same breadth-first traversal as Robot::forwardKinematics.
+  std::vector<bool> visited(num_link_slots_, false);
+  visited[root_id_] = true;
+  std::queue<LinkSharedPtr> queue;
+  queue.push(root);
+  while (!queue.empty()) {
+    const LinkSharedPtr link1 = queue.front();
+    queue.pop();
+    for (auto &&joint : link1->joints()) {
+      const LinkSharedPtr link2 = joint->otherLink(link1);
+      if (visited[link2->id()]) continue;
+      visited[link2->id()] = true;
+      steps_.push_back(Step{joint, JointKernel(*joint), joint->id(),
+                            link1->id(), link2->id(),
+                            joint->isChildLink(link1)});
+      queue.push(link2);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsPlan::compute(const Vector &q, const Vector &q_dot,
+                                    const Pose3 &wTroot, const Vector6 &V_root,
+                                    std::vector<Pose3> *poses,
+                                    std::vector<Vector6> *twists) const {
+  if (size_t(q.size()) < num_joint_slots_ ||
+      (twists && size_t(q_dot.size()) < num_joint_slots_)) {
+    throw std::invalid_argument(
+        "ForwardKinematicsPlan: joint arrays must be indexed by joint id.");
+  }
+  if (poses->size() < num_link_slots_) poses->resize(num_link_slots_);
+  if (twists && twists->size() < num_link_slots_) {
+    twists->resize(num_link_slots_);
+  }
+
+  (*poses)[root_id_] = wTroot;
+  if (twists) (*twists)[root_id_] = V_root;
+  for (size_t i = 0; i < steps_.size(); i++) {
+    computeStep(i, q, q_dot, poses, twists);
+  }
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsPlan::computeStep(size_t i, const Vector &q,
+                                        const Vector &q_dot,
+                                        std::vector<Pose3> *poses,
+                                        std::vector<Vector6> *twists) const {
+  const Step &step = steps_[i];
+  const JointKernel &joint = step.kernel;
+  const Pose3 pTc = joint.parentTchild(q(step.joint_id));
+  const Pose3 &wT1 = (*poses)[step.from_id];
+  if (step.from_child) {
+    (*poses)[step.to_id] = wT1 * pTc.inverse();
+    if (twists) {
+      (*twists)[step.to_id] = pTc.Adjoint((*twists)[step.from_id]) +
+                              joint.parentTwist(q_dot(step.joint_id));
+    }
+  } else {
+    (*poses)[step.to_id] = wT1 * pTc;
+    if (twists) {
+      (*twists)[step.to_id] = pTc.inverse().Adjoint((*twists)[step.from_id]) +
+                              joint.childTwist(q_dot(step.joint_id));
+    }
+  }
+}
+
+/* ************************************************************************* */
+void ForwardKinematicsPlan::computeBatch(const gtsam::Matrix &qs,
+                                         const Pose3 &wTroot,
+                                         std::vector<PoseArray> *poses) const {
+  if (size_t(qs.rows()) < num_joint_slots_) {
+    throw std::invalid_argument(
+        "ForwardKinematicsPlan: joint angle rows must be indexed by joint id.");
+  }
+  const size_t num_samples = qs.cols();
+  if (poses->size() < num_link_slots_) poses->resize(num_link_slots_);
+
+  PoseArray &root = (*poses)[root_id_];
+  root.resize(12, num_samples);
+  const gtsam::Matrix3 R_root = wTroot.rotation().matrix();
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      root.row(RotRow(i, j)).setConstant(R_root(i, j));
+    }
+    root.row(TransRow(i)).setConstant(wTroot.translation()(i));
+  }
+
+  // Scratch arrays, re-used for all steps.
+  PoseArray exp, pTc, relative;
+  for (auto &&step : steps_) {
+    const JointKernel &joint = step.kernel;
+    ExpmapArray(joint.cScrewAxis, qs.row(step.joint_id).array(), &exp);
+    ComposeArray(joint.pMc, exp, &pTc);
+    if (step.from_child) {
+      InverseArray(pTc, &relative);
+    } else {
+      relative.swap(pTc);
+    }
+    ComposeArray((*poses)[step.from_id], relative, &(*poses)[step.to_id]);
+  }
+}
+
+/* ************************************************************************* */
+Pose3 ForwardKinematicsPlan::PoseAt(const PoseArray &poses, size_t k) {
+  gtsam::Matrix3 rotation;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) rotation(i, j) = poses(RotRow(i, j), k);
+  }
+  const gtsam::Point3 translation(poses(TransRow(0), k), poses(TransRow(1), k),
+                                  poses(TransRow(2), k));
+  return Pose3(gtsam::Rot3(rotation), translation);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ForwardKinematicsPlan.h
+ * @brief Precompiled forward kinematics traversal with flat outputs.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/JointKernel.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ForwardKinematicsPlan stores the breadth-first traversal of
+ * Robot::forwardKinematics from a given root link, computed once. Forward
+ * kinematics can then be evaluated many times without any gtsam::Values,
+ * reading joint angles and velocities indexed by joint id and writing CoM
+ * poses and twists indexed by link id.
+ *
+ * The plan follows a spanning tree of the robot: joints closing a kinematic
+ * loop are not traversed, and their consistency is not checked. Fixed links
+ * other than the root are computed through their joints, like any other link.
+ */
+class ForwardKinematicsPlan {
+ public:
+  /**
+   * Poses of many configurations in structure-of-arrays layout: column k is
+   * configuration k, and each row holds one entry of all poses, the rotation
+   * matrix entries in row-major order followed by the translation.
+   */
+  using PoseArray = Eigen::Array<double, 12, Eigen::Dynamic, Eigen::RowMajor>;
+
+  /// One joint of the traversal, from a link with known pose to the next.
+  struct Step {
+    JointSharedPtr joint;
+    JointKernel kernel;  ///< flat copy of the joint kinematics
+    int joint_id, from_id, to_id;
+    bool from_child;  ///< true if the known link is the child of the joint
+  };
+
+ private:
+  int root_id_;
+  size_t num_link_slots_ = 0, num_joint_slots_ = 0;
+  std::vector<Step> steps_;
+
+ public:
+  /**
+   * Constructor
+   * @param robot      the robot
+   * @param root_name  name of the link with known pose and twist
+   */
+  ForwardKinematicsPlan(const Robot &robot, const std::string &root_name);
+
+  /// Return the id of the root link.
+  int rootId() const { return root_id_; }
+
+  /// Return the traversal, in breadth-first order.
+  const std::vector<Step> &steps() const { return steps_; }
+
+  /// Return the size of the output arrays, the largest link id plus one.
+  size_t numLinkSlots() const { return num_link_slots_; }
+
+  /// Return the size of the input arrays, the largest joint id plus one.
+  size_t numJointSlots() const { return num_joint_slots_; }
+
+  /**
+   * Compute forward kinematics. The output arrays are only resized if they
+   * are too small, so re-using them across calls does not allocate.
+   * @param q       joint angles, indexed by joint id
+   * @param q_dot   joint velocities, indexed by joint id, not used if twists
+   *                is null
+   * @param wTroot  pose of the root link CoM
+   * @param V_root  twist of the root link CoM
+   * @param poses   (out) link CoM poses, indexed by link id
+   * @param twists  (out) optional link CoM twists, indexed by link id
+   */
+  void compute(const gtsam::Vector &q, const gtsam::Vector &q_dot,
+               const gtsam::Pose3 &wTroot, const gtsam::Vector6 &V_root,
+               std::vector<gtsam::Pose3> *poses,
+               std::vector<gtsam::Vector6> *twists = nullptr) const;
+
+  /**
+   * Compute the pose, and optionally the twist, of the link reached by step
+   * i from those of the link it starts from, as in compute(). The output
+   * arrays should have numLinkSlots() entries.
+   */
+  void computeStep(size_t i, const gtsam::Vector &q,
+                   const gtsam::Vector &q_dot,
+                   std::vector<gtsam::Pose3> *poses,
+                   std::vector<gtsam::Vector6> *twists = nullptr) const;
+
+  /**
+   * Compute link CoM poses for many configurations at once. The joint
+   * exponentials and pose compositions are evaluated coefficient-wise over
+   * all configurations, which Eigen vectorizes across SIMD lanes.
+   * @param qs      joint angles, one row per joint id, one column per
+   *                configuration
+   * @param wTroot  pose of the root link CoM, shared by all configurations
+   * @param poses   (out) link CoM poses, indexed by link id
+   */
+  void computeBatch(const gtsam::Matrix &qs, const gtsam::Pose3 &wTroot,
+                    std::vector<PoseArray> *poses) const;
+
+  /// Return pose of configuration k from a PoseArray.
+  static gtsam::Pose3 PoseAt(const PoseArray &poses, size_t k);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FrozenRobot.cpp
+ * @brief Immutable robot model with index-based accessors.
+ */
+
+#include <gtdynamics/universal_robot/FrozenRobot.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+FrozenRobot::FrozenRobot(const Robot &robot) : robot_(robot) {
+  size_t num_link_slots = 0, num_joint_slots = 0;
+  for (auto &&link : robot_.links()) {
+    num_link_slots = std::max<size_t>(num_link_slots, link->id() + 1);
+  }
+  for (auto &&joint : robot_.joints()) {
+    num_joint_slots = std::max<size_t>(num_joint_slots, joint->id() + 1);
+  }
+
+  links_.assign(num_link_slots, nullptr);
+  link_joint_ids_.resize(num_link_slots);
+  is_fixed_.assign(num_link_slots, false);
+  fixed_poses_.resize(num_link_slots);
+  for (auto &&link : robot_.links()) {
+    const int id = link->id();
+    link_ids_.push_back(id);
+    links_[id] = link.get();
+    is_fixed_[id] = robot_.isFixed(link);
+    fixed_poses_[id] = robot_.fixedPose(link);
+    for (auto &&joint : link->joints()) {
+      link_joint_ids_[id].push_back(joint->id());
+    }
+  }
+
+  joints_.assign(num_joint_slots, nullptr);
+  parent_ids_.assign(num_joint_slots, -1);
+  child_ids_.assign(num_joint_slots, -1);
+  for (auto &&joint : robot_.joints()) {
+    const int id = joint->id();
+    joint_ids_.push_back(id);
+    joints_[id] = joint.get();
+    parent_ids_[id] = joint->parent()->id();
+    child_ids_[id] = joint->child()->id();
+  }
+}
+
+/* ************************************************************************* */
+void FrozenRobot::checkLinkId(int id) const {
+  if (id < 0 || size_t(id) >= links_.size() || !links_[id]) {
+    throw std::out_of_range("FrozenRobot: no link with id " +
+                            std::to_string(id));
+  }
+}
+
+/* ************************************************************************* */
+void FrozenRobot::checkJointId(int id) const {
+  if (id < 0 || size_t(id) >= joints_.size() || !joints_[id]) {
+    throw std::out_of_range("FrozenRobot: no joint with id " +
+                            std::to_string(id));
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FrozenRobot.h
+ * @brief Immutable robot model with index-based accessors.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * FrozenRobot is a read-only snapshot of a Robot, meant to be shared by many
+ * threads building graphs or simulating the same robot. All topology and the
+ * fixed state of links are flattened into arrays indexed by link and joint id
+ * at construction, and all accessors are const and return raw references or
+ * ids, so reading the model never touches a shared_ptr reference count and
+ * needs no locking.
+ *
+ * The snapshot keeps the robot it was created from alive. Robot copies that
+ * share its links must not call removeLink or removeJoint while the snapshot
+ * is in use, as those edit the shared links.
+ */
+class FrozenRobot {
+ private:
+  Robot robot_;
+  std::vector<int> link_ids_, joint_ids_;  // in robot.links()/joints() order
+
+  // Indexed by link id, null entries for unused ids.
+  std::vector<const Link *> links_;
+  std::vector<std::vector<int>> link_joint_ids_;
+  std::vector<char> is_fixed_;
+  std::vector<gtsam::Pose3> fixed_poses_;
+
+  // Indexed by joint id, null entries for unused ids.
+  std::vector<const Joint *> joints_;
+  std::vector<int> parent_ids_, child_ids_;
+
+  void checkLinkId(int id) const;
+  void checkJointId(int id) const;
+
+ public:
+  /// Constructor, snapshots the robot and its fixed links.
+  explicit FrozenRobot(const Robot &robot);
+
+  /// Return the robot this snapshot was created from.
+  const Robot &robot() const { return robot_; }
+
+  /// Return the ids of all links, in the order of robot.links().
+  const std::vector<int> &linkIds() const { return link_ids_; }
+
+  /// Return the ids of all joints, in the order of robot.joints().
+  const std::vector<int> &jointIds() const { return joint_ids_; }
+
+  /// Return the largest link id plus one.
+  size_t numLinkSlots() const { return links_.size(); }
+
+  /// Return the largest joint id plus one.
+  size_t numJointSlots() const { return joints_.size(); }
+
+  /// Return the link with the given id.
+  const Link &link(int id) const {
+    checkLinkId(id);
+    return *links_[id];
+  }
+
+  /// Return the joint with the given id.
+  const Joint &joint(int id) const {
+    checkJointId(id);
+    return *joints_[id];
+  }
+
+  /// Return the id of the link with the given name.
+  int linkId(const std::string &name) const {
+    return robot_.link(name)->id();
+  }
+
+  /// Return the id of the joint with the given name.
+  int jointId(const std::string &name) const {
+    return robot_.joint(name)->id();
+  }
+
+  /// Return the id of the parent link of a joint.
+  int parentId(int joint_id) const {
+    checkJointId(joint_id);
+    return parent_ids_[joint_id];
+  }
+
+  /// Return the id of the child link of a joint.
+  int childId(int joint_id) const {
+    checkJointId(joint_id);
+    return child_ids_[joint_id];
+  }
+
+  /// Return the ids of the joints connected to a link.
+  const std::vector<int> &linkJointIds(int link_id) const {
+    checkLinkId(link_id);
+    return link_joint_ids_[link_id];
+  }
+
+  /// Return whether a link is fixed, as in Robot::isFixed.
+  bool isFixed(int link_id) const {
+    checkLinkId(link_id);
+    return is_fixed_[link_id];
+  }
+
+  /// Return the pose of the CoM of a fixed link, as in Robot::fixedPose.
+  const gtsam::Pose3 &fixedPose(int link_id) const {
+    checkLinkId(link_id);
+    return fixed_poses_[link_id];
+  }
+};
+
+/// Shared handle to a frozen robot, safe to copy into worker threads.
+using FrozenRobotPtr = std::shared_ptr<const FrozenRobot>;
+
+/// Create a frozen snapshot of a robot.
+inline FrozenRobotPtr Freeze(const Robot &robot) {
+  return std::make_shared<const FrozenRobot>(robot);
+}
+
+}  // namespace gtdynamics
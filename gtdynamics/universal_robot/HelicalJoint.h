@@ -55,7 +55,7 @@ class HelicalJoint : public Joint {
    * @param[in] thread_pitch  joint's thread pitch in dist per rev
    * @param[in] parameters    JointParams struct.
    */
-  HelicalJoint(uint8_t id, const std::string &name, const gtsam::Pose3 &bTj,
+  HelicalJoint(uint16_t id, const std::string &name, const gtsam::Pose3 &bTj,
                const LinkSharedPtr &parent_link,
                const LinkSharedPtr &child_link, const gtsam::Vector3 &axis,
                double thread_pitch,
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IncrementalForwardKinematics.cpp
+ * @brief Forward kinematics state that only recomputes the subtrees of the
+ * joints that changed.
+ */
+
+#include <gtdynamics/universal_robot/IncrementalForwardKinematics.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+IncrementalForwardKinematics::IncrementalForwardKinematics(
+    const Robot &robot, const std::string &root_name, const Pose3 &wTroot,
+    const Vector6 &V_root)
+    : plan_(robot, root_name),
+      q_(Vector::Zero(plan_.numJointSlots())),
+      q_dot_(Vector::Zero(plan_.numJointSlots())),
+      poses_(plan_.numLinkSlots()),
+      twists_(plan_.numLinkSlots(), Vector6::Zero()),
+      joint_steps_(plan_.numJointSlots(), -1),
+      dirty_steps_(plan_.steps().size(), false),
+      link_updated_(plan_.numLinkSlots(), false) {
+  const auto &steps = plan_.steps();
+  for (size_t i = 0; i < steps.size(); i++) {
+    joint_steps_[steps[i].joint_id] = i;
+  }
+  poses_[plan_.rootId()] = wTroot;
+  twists_[plan_.rootId()] = V_root;
+}
+
+/* ************************************************************************* */
+void IncrementalForwardKinematics::markJoint(int j) {
+  if (joint_steps_[j] >= 0) dirty_steps_[joint_steps_[j]] = true;
+}
+
+/* ************************************************************************* */
+void IncrementalForwardKinematics::setJointAngle(int j, double q) {
+  if (j < 0 || size_t(j) >= plan_.numJointSlots()) {
+    throw std::out_of_range("IncrementalForwardKinematics: no joint " +
+                            std::to_string(j) + ".");
+  }
+  if (q_(j) != q) {
+    q_(j) = q;
+    markJoint(j);
+  }
+}
+
+/* ************************************************************************* */
+void IncrementalForwardKinematics::setJointVel(int j, double q_dot) {
+  if (j < 0 || size_t(j) >= plan_.numJointSlots()) {
+    throw std::out_of_range("IncrementalForwardKinematics: no joint " +
+                            std::to_string(j) + ".");
+  }
+  if (q_dot_(j) != q_dot) {
+    q_dot_(j) = q_dot;
+    markJoint(j);
+  }
+}
+
+/* ************************************************************************* */
+void IncrementalForwardKinematics::setJointAngles(const Vector &q) {
+  if (size_t(q.size()) != plan_.numJointSlots()) {
+    throw std::invalid_argument(
+        "IncrementalForwardKinematics: joint angles must be indexed by joint "
+        "id.");
+  }
+  for (int j = 0; j < q.size(); j++) setJointAngle(j, q(j));
+}
+
+/* ************************************************************************* */
+void IncrementalForwardKinematics::setJointVels(const Vector &q_dot) {
+  if (size_t(q_dot.size()) != plan_.numJointSlots()) {
+    throw std::invalid_argument(
+        "IncrementalForwardKinematics: joint velocities must be indexed by "
+        "joint id.");
+  }
+  for (int j = 0; j < q_dot.size(); j++) setJointVel(j, q_dot(j));
+}
+
+/* ************************************************************************* */
+void IncrementalForwardKinematics::setRoot(const Pose3 &wTroot,
+                                           const Vector6 &V_root) {
+  poses_[plan_.rootId()] = wTroot;
+  twists_[plan_.rootId()] = V_root;
+  root_dirty_ = true;
+}
+
+/* ************************************************************************* */
+bool IncrementalForwardKinematics::dirty() const {
+  return root_dirty_ ||
+         std::find(dirty_steps_.begin(), dirty_steps_.end(), true) !=
+             dirty_steps_.end();
+}
+
+/* ************************************************************************* */
+const std::vector<int> &IncrementalForwardKinematics::update() {
+  updated_links_.clear();
+  num_steps_computed_ = 0;
+  std::fill(link_updated_.begin(), link_updated_.end(), false);
+  if (root_dirty_) {
+    link_updated_[plan_.rootId()] = true;
+    updated_links_.push_back(plan_.rootId());
+  }
+
+  // Steps are in breadth-first order, so a link is updated before the steps
+  // starting from it are visited.
+  const auto &steps = plan_.steps();
+  for (size_t i = 0; i < steps.size(); i++) {
+    const auto &step = steps[i];
+    if (!dirty_steps_[i] && !link_updated_[step.from_id]) continue;
+    plan_.computeStep(i, q_, q_dot_, &poses_, &twists_);
+    link_updated_[step.to_id] = true;
+    updated_links_.push_back(step.to_id);
+    dirty_steps_[i] = false;
+    num_steps_computed_++;
+  }
+  root_dirty_ = false;
+  return updated_links_;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IncrementalForwardKinematics.h
+ * @brief Forward kinematics state that only recomputes the subtrees of the
+ * joints that changed.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/ForwardKinematicsPlan.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * IncrementalForwardKinematics keeps the joint state, and the link CoM poses
+ * and twists computed from it by a ForwardKinematicsPlan. Setters record
+ * which joints changed, and update() recomputes the subtrees below them
+ * only, e.g., one leg when only its joints moved. The links updated by the
+ * last update() are listed, so caches depending on link poses can be
+ * refreshed selectively.
+ *
+ * Joints closing kinematic loops are not part of the plan, and changing them
+ * does not update any link.
+ */
+class IncrementalForwardKinematics {
+ private:
+  ForwardKinematicsPlan plan_;
+  gtsam::Vector q_, q_dot_;
+  std::vector<gtsam::Pose3> poses_;
+  std::vector<gtsam::Vector6> twists_;
+
+  std::vector<int> joint_steps_;    // step of each joint id, -1 if none
+  std::vector<bool> dirty_steps_;   // steps whose joint changed
+  std::vector<bool> link_updated_;  // scratch, links updated in update()
+  bool root_dirty_ = true;
+  std::vector<int> updated_links_;
+  size_t num_steps_computed_ = 0;
+
+  // Mark the step of joint j as dirty.
+  void markJoint(int j);
+
+ public:
+  /**
+   * Constructor, at zero joint angles and velocities.
+   * @param robot      the robot
+   * @param root_name  name of the link with known pose and twist
+   * @param wTroot     pose of the root link CoM
+   * @param V_root     twist of the root link CoM
+   */
+  IncrementalForwardKinematics(
+      const Robot &robot, const std::string &root_name,
+      const gtsam::Pose3 &wTroot = gtsam::Pose3(),
+      const gtsam::Vector6 &V_root = gtsam::Vector6::Zero());
+
+  /// Return the plan.
+  const ForwardKinematicsPlan &plan() const { return plan_; }
+
+  /// Set the angle of joint j, marked as changed if it differs.
+  void setJointAngle(int j, double q);
+
+  /// Set the velocity of joint j, marked as changed if it differs.
+  void setJointVel(int j, double q_dot);
+
+  /// Set all joint angles, indexed by joint id; only changed ones are marked.
+  void setJointAngles(const gtsam::Vector &q);
+
+  /// Set all joint velocities, indexed by joint id.
+  void setJointVels(const gtsam::Vector &q_dot);
+
+  /// Set the pose and twist of the root link CoM, which changes all links.
+  void setRoot(const gtsam::Pose3 &wTroot, const gtsam::Vector6 &V_root);
+
+  /// Return the joint angles, indexed by joint id.
+  const gtsam::Vector &jointAngles() const { return q_; }
+
+  /// Return the joint velocities, indexed by joint id.
+  const gtsam::Vector &jointVels() const { return q_dot_; }
+
+  /// Return whether anything changed since the last update().
+  bool dirty() const;
+
+  /**
+   * Recompute the links below the changed joints, or all links if the root
+   * changed, and return their ids in breadth-first order.
+   */
+  const std::vector<int> &update();
+
+  /// Return the ids of the links updated by the last update().
+  const std::vector<int> &updatedLinks() const { return updated_links_; }
+
+  /// Return the number of joint steps computed by the last update().
+  size_t numStepsComputed() const { return num_steps_computed_; }
+
+  /// Return the CoM pose of link i as of the last update().
+  const gtsam::Pose3 &pose(int i) const { return poses_.at(i); }
+
+  /// Return the CoM twist of link i as of the last update().
+  const gtsam::Vector6 &twist(int i) const { return twists_.at(i); }
+
+  /// Return the CoM poses, indexed by link id, as of the last update().
+  const std::vector<gtsam::Pose3> &poses() const { return poses_; }
+
+  /// Return the CoM twists, indexed by link id, as of the last update().
+  const std::vector<gtsam::Vector6> &twists() const { return twists_; }
+};
+
+}  // namespace gtdynamics
@@ -16,10 +16,13 @@
 
 #include <gtdynamics/factors/JointLimitFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/JointKernel.h>
 #include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
 #include <gtsam/slam/expressions.h>
 
 #include <iostream>
+#include <stdexcept>
 
 using gtsam::Pose3;
 using gtsam::Vector6;
@@ -27,7 +30,7 @@ using gtsam::Vector6;
 namespace gtdynamics {
 
 /* ************************************************************************* */
-Joint::Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
+Joint::Joint(uint16_t id, const std::string &name, const Pose3 &bTj,
              const LinkSharedPtr &parent_link, const LinkSharedPtr &child_link,
              const Vector6 &jScrewAxis, const JointParams &parameters)
     : id_(id),
@@ -38,7 +41,11 @@ Joint::Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
       jMc_(bTj.inverse() * child_link->bMcom()),
       pScrewAxis_(-jMp_.inverse().AdjointMap() * jScrewAxis),
       cScrewAxis_(jMc_.inverse().AdjointMap() * jScrewAxis),
-      parameters_(parameters) {}
+      parameters_(parameters) {
+  if (id >= DynamicsSymbol::kNoIndex) {
+    throw std::invalid_argument("Joint id too large for DynamicsSymbol keys");
+  }
+}
 
 /* ************************************************************************* */
 bool Joint::isChildLink(const LinkSharedPtr &link) const {
@@ -48,20 +55,65 @@ bool Joint::isChildLink(const LinkSharedPtr &link) const {
   return link == child_link_;
 }
 
+/* ************************************************************************* */
+// Return pMc * exp(cScrewAxis * q), and its derivative w.r.t. q.
+static Pose3 ExpParentTchild(const Joint &joint, double q,
+                             gtsam::OptionalJacobian<6, 1> pTc_H_q) {
+  // The joint moves along a fixed screw, so in the child frame the
+  // derivative of the exponential is the screw axis itself.
+  if (pTc_H_q) *pTc_H_q = joint.cScrewAxis();
+  return joint.pMc() * JointKernel::Exp(joint.type(), joint.cScrewAxis(), q);
+}
+
+/* ************************************************************************* */
+JointKinematics Joint::kinematics(double q) const {
+  JointKinematics k;
+  k.pTc = ExpParentTchild(*this, q, k.pTc_H_q);
+  k.pAdc = k.pTc.AdjointMap();
+  k.cAdp = k.pTc.inverse().AdjointMap();
+  return k;
+}
+
 /* ************************************************************************* */
 Pose3 Joint::parentTchild(double q,
                           gtsam::OptionalJacobian<6, 1> pTc_H_q) const {
-  // Multiply screw axis with joint angle to get a finite 6D screw.
-  const Vector6 screw = cScrewAxis_ * q;
-
-  // Calculate the actual relative pose taking into account the joint angle.
-  // TODO(dellaert): use formula `pMj_ * screw_around_Z * jMc_`.
-  gtsam::Matrix6 exp_H_screw;
-  const Pose3 exp = Pose3::Expmap(screw, pTc_H_q ? &exp_H_screw : 0);
-  if (pTc_H_q) {
-    *pTc_H_q = exp_H_screw * cScrewAxis_;
+  if (JointKinematicsCache *cache = JointKinematicsCache::Active()) {
+    const JointKinematics &k = cache->at(*this, q);
+    if (pTc_H_q) *pTc_H_q = k.pTc_H_q;
+    return k.pTc;
+  }
+  return ExpParentTchild(*this, q, pTc_H_q);
+}
+
+/* ************************************************************************* */
+gtsam::Matrix6 Joint::relativeAdjointMap(const LinkSharedPtr &link2,
+                                         double q) const {
+  if (JointKinematicsCache *cache = JointKinematicsCache::Active()) {
+    const JointKinematics &k = cache->at(*this, q);
+    return isChildLink(link2) ? k.pAdc : k.cAdp;
+  }
+  return relativePoseOf(link2, q).AdjointMap();
+}
+
+/* ************************************************************************* */
+gtsam::Matrix6 Joint::relativeAdjointMapJacobianQ(const LinkSharedPtr &link2,
+                                                  double q) const {
+  // The pose of link2 in the frame of link1 is exp(-S1 * q) * T12(0), with S1
+  // the screw axis in the frame of link1, so its Adjoint map changes by
+  // -ad(S1) Ad(T12(q)) per unit angle.
+  const Vector6 &S1 = isChildLink(link2) ? pScrewAxis_ : cScrewAxis_;
+  JointKinematicsCache *cache = JointKinematicsCache::Active();
+  if (!cache) {
+    return -Pose3::adjointMap(S1) * relativeAdjointMap(link2, q);
+  }
+  JointKinematics &k = cache->at(*this, q);
+  bool &has_H_q = isChildLink(link2) ? k.has_pAdc_H_q : k.has_cAdp_H_q;
+  gtsam::Matrix6 &H_q = isChildLink(link2) ? k.pAdc_H_q : k.cAdp_H_q;
+  if (!has_H_q) {
+    H_q = -Pose3::adjointMap(S1) * (isChildLink(link2) ? k.pAdc : k.cAdp);
+    has_H_q = true;
   }
-  return pMc() * exp;  // Note: derivative of compose in exp is identity.
+  return H_q;
 }
 
 /* ************************************************************************* */
@@ -87,12 +139,11 @@ Vector6 Joint::transformTwistTo(
   Vector6 other_twist_ = other_twist ? *other_twist : Vector6::Zero();
 
   auto other = otherLink(link);
-  auto this_ad_other = relativePoseOf(other, q).AdjointMap();
+  const gtsam::Matrix6 this_ad_other = relativeAdjointMap(other, q);
 
   if (H_q) {
     // TODO(frank): really, zero below? Check derivatives
-    *H_q = AdjointMapJacobianQ(q, relativePoseOf(other, 0.0), screwAxis(link)) *
-           other_twist_;
+    *H_q = relativeAdjointMapJacobianQ(other, q) * other_twist_;
   }
   if (H_q_dot) {
     *H_q_dot = screwAxis(link);
@@ -110,8 +161,7 @@ Vector6 Joint::transformWrenchCoordinate(
     gtsam::OptionalJacobian<6, 1> H_q,
     gtsam::OptionalJacobian<6, 6> H_wrench) const {
   auto other = otherLink(link);
-  gtsam::Pose3 T_21 = relativePoseOf(other, q);
-  gtsam::Matrix6 Ad_21_T = T_21.AdjointMap().transpose();
+  gtsam::Matrix6 Ad_21_T = relativeAdjointMap(other, q).transpose();
   gtsam::Vector6 transformed_wrench = Ad_21_T * wrench;
 
   if (H_wrench) {
@@ -119,9 +169,7 @@ Vector6 Joint::transformWrenchCoordinate(
   }
   if (H_q) {
     // TODO(frank): really, child? Double-check derivatives
-    *H_q = AdjointMapJacobianQ(q, relativePoseOf(other, 0.0), screwAxis(link))
-               .transpose() *
-           wrench;
+    *H_q = relativeAdjointMapJacobianQ(other, q).transpose() * wrench;
   }
   return transformed_wrench;
 }
@@ -144,8 +192,7 @@ gtsam::GaussianFactorGraph Joint::linearFDPriors(
   gtsam::GaussianFactorGraph priors;
   gtsam::Vector1 rhs(Torque(known_values, id(), t));
   // TODO(alej`andro): use optimizer settings
-  priors.add(TorqueKey(id(), t), gtsam::I_1x1, rhs,
-             gtsam::noiseModel::Constrained::All(1));
+  priors.add(TorqueKey(id(), t), gtsam::I_1x1, rhs, InternedConstrained(1));
   return priors;
 }
 
@@ -167,8 +214,7 @@ gtsam::GaussianFactorGraph Joint::linearAFactors(
   Vector6 rhs_tw = Pose3::adjointMap(V_i2) * S_i2_j * v_j;
   graph.add(TwistAccelKey(child()->id(), t), gtsam::I_6x6,
             TwistAccelKey(parent()->id(), t), -T_i2i1.AdjointMap(),
-            JointAccelKey(id(), t), -S_i2_j, rhs_tw,
-            gtsam::noiseModel::Constrained::All(6));
+            JointAccelKey(id(), t), -S_i2_j, rhs_tw, InternedConstrained(6));
 
   return graph;
 }
@@ -189,20 +235,20 @@ gtsam::GaussianFactorGraph Joint::linearDynamicsFactors(
   gtsam::Vector1 rhs_torque = gtsam::Vector1::Zero();
   graph.add(WrenchKey(child()->id(), id(), t), S_i2_j.transpose(),
             TorqueKey(id(), t), -gtsam::I_1x1, rhs_torque,
-            gtsam::noiseModel::Constrained::All(1));
+            InternedConstrained(1));
 
   // wrench equivalence factor
   // F_i1_j + Ad(T_i2i1)^T F_i2_j = 0
   Vector6 rhs_weq = Vector6::Zero();
   graph.add(WrenchKey(parent()->id(), id(), t), gtsam::I_6x6,
             WrenchKey(child()->id(), id(), t), T_i2i1.AdjointMap().transpose(),
-            rhs_weq, gtsam::noiseModel::Constrained::All(6));
+            rhs_weq, InternedConstrained(6));
 
   // wrench planar factor
   if (planar_axis) {
     gtsam::Matrix36 J_wrench = getPlanarJacobian(*planar_axis);
     graph.add(WrenchKey(child()->id(), id(), t), J_wrench,
-              gtsam::Vector3::Zero(), gtsam::noiseModel::Constrained::All(3));
+              gtsam::Vector3::Zero(), InternedConstrained(3));
   }
 
   return graph;
@@ -325,18 +371,16 @@ gtsam::Vector6_ Joint::twistAccelConstraint(uint64_t t) const {
       [this](double q, const Vector6 &other_twist_accel,
              gtsam::OptionalJacobian<6, 1> H_q,
              gtsam::OptionalJacobian<6, 6> H_other_twist_accel) {
-        Pose3 jTi = relativePoseOf(parent(), q);
-        Vector6 this_twist_accel = jTi.AdjointMap() * other_twist_accel;
+        const gtsam::Matrix6 jAdi = relativeAdjointMap(parent(), q);
+        Vector6 this_twist_accel = jAdi * other_twist_accel;
 
         if (H_other_twist_accel) {
-          *H_other_twist_accel = jTi.AdjointMap();
+          *H_other_twist_accel = jAdi;
         }
         if (H_q) {
           // TODO(frank): really, zero below? Check derivatives. Also,
           // copy/pasta from above?
-          *H_q = AdjointMapJacobianQ(q, relativePoseOf(parent(), 0.0),
-                                     cScrewAxis_) *
-                 other_twist_accel;
+          *H_q = relativeAdjointMapJacobianQ(parent(), q) * other_twist_accel;
         }
         return this_twist_accel;
       };
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/universal_robot/JointKinematicsCache.h>
 #include <gtdynamics/universal_robot/RobotTypes.h>
 #include <gtdynamics/utils/DynamicsSymbol.h>
 #include <gtsam/geometry/Pose3.h>
@@ -131,7 +132,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   std::string name_;
 
   /// ID reference to DynamicsSymbol.
-  uint8_t id_;
+  uint16_t id_;
 
   /// Rest transform to parent link CoM frame from joint frame.
   Pose3 jMp_;
@@ -169,7 +170,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
    * @param[in] jScrewAxis   Screw axis in the joint frame
    * @param[in] parameters   The joint parameters.
    */
-  Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
+  Joint(uint16_t id, const std::string &name, const Pose3 &bTj,
         const LinkSharedPtr &parent_link, const LinkSharedPtr &child_link,
         const Vector6 &jScrewAxis,
         const JointParams &parameters = JointParams());
@@ -186,7 +187,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   JointConstSharedPtr shared() const { return shared_from_this(); }
 
   /// Get the joint's ID.
-  uint8_t id() const { return id_; }
+  uint16_t id() const { return id_; }
 
   /// Return (unchanging) pose of the parent link's COM in the joint frame.
   const Pose3 &jMp() const { return jMp_; }
@@ -215,7 +216,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   const std::string &name() const { return name_; }
 
   /// Return the connected link other than the one provided.
-  LinkSharedPtr otherLink(const LinkSharedPtr &link) const {
+  const LinkSharedPtr &otherLink(const LinkSharedPtr &link) const {
     return isChildLink(link) ? parent_link_ : child_link_;
   }
 
@@ -225,10 +226,10 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   }
 
   /// Return a shared ptr to the parent link.
-  LinkSharedPtr parent() const { return parent_link_; }
+  const LinkSharedPtr &parent() const { return parent_link_; }
 
   /// Return a shared ptr to the child link.
-  LinkSharedPtr child() const { return child_link_; }
+  const LinkSharedPtr &child() const { return child_link_; }
 
   /// Return joint parameters.
   const JointParams &parameters() const { return parameters_; }
@@ -291,6 +292,27 @@ class Joint : public boost::enable_shared_from_this<Joint> {
     return isChildLink(link2) ? parentTchild(q, H_q) : childTparent(q, H_q);
   }
 
+  /**
+   * Return the Adjoint map of relativePoseOf(link2, q), which transforms
+   * twists from the frame of link2 to the frame of the other link.
+   */
+  gtsam::Matrix6 relativeAdjointMap(const LinkSharedPtr &link2,
+                                    double q) const;
+
+  /**
+   * Return the derivative of relativeAdjointMap(link2, q) w.r.t. q, which
+   * is -ad(S) times it, for the screw axis S in the frame of the other link.
+   */
+  gtsam::Matrix6 relativeAdjointMapJacobianQ(const LinkSharedPtr &link2,
+                                             double q) const;
+
+  /**
+   * Return the transforms of this joint at angle q, computed afresh. The
+   * methods above use the entry of the active JointKinematicsCache instead,
+   * if there is one.
+   */
+  JointKinematics kinematics(double q) const;
+
   /**
    * Return the world pose of the specified link [link2], given
    * the world pose of the other link [link1].
@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointKernel.h
+ * @brief Flat, type-tagged joint kinematics for hot loops.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cmath>
+
+namespace gtdynamics {
+
+/**
+ * JointKernel is a plain copy of the kinematic data of a Joint, tagged with
+ * the joint type. Its exponential is specialized with a switch on the type:
+ * identity for fixed joints, a translation for prismatic joints, and
+ * Rodrigues' formula for revolute and screw joints. Kinematics loops can
+ * iterate over a contiguous table of kernels without chasing Joint pointers.
+ */
+struct JointKernel {
+  Joint::Type type = Joint::Type::Fixed;
+  int id = 0;
+  gtsam::Pose3 pMc;          ///< rest pose of child CoM in parent CoM frame
+  gtsam::Vector6 cScrewAxis;  ///< screw axis in child CoM frame
+  gtsam::Vector6 pScrewAxis;  ///< screw axis in parent CoM frame
+
+  JointKernel() : cScrewAxis(gtsam::Z_6x1), pScrewAxis(gtsam::Z_6x1) {}
+
+  /// Constructor from a joint.
+  explicit JointKernel(const Joint &joint)
+      : type(joint.type()),
+        id(joint.id()),
+        pMc(joint.pMc()),
+        cScrewAxis(joint.cScrewAxis()),
+        pScrewAxis(joint.pScrewAxis()) {}
+
+  /**
+   * Return exp(S * q) for a screw axis S of a joint of the given type, with
+   * one sine and cosine: a translation for prismatic joints, and a rotation
+   * about a line, with a translation along it for screw joints, otherwise.
+   * The derivative of exp(S * q) w.r.t. q is S, in the rotated frame.
+   */
+  static gtsam::Pose3 Exp(Joint::Type type, const gtsam::Vector6 &S,
+                          double q) {
+    switch (type) {
+      case Joint::Type::Fixed:
+        return gtsam::Pose3();
+      case Joint::Type::Prismatic:
+        return gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(S.tail<3>() * q));
+      case Joint::Type::Revolute:
+      case Joint::Type::Screw: {
+        // t = (I - R) * (w x v) / |w|^2 + w * (w.v) * q / |w|^2.
+        const gtsam::Vector3 w = S.head<3>();
+        const gtsam::Vector3 v = S.tail<3>();
+        const double norm2 = w.squaredNorm();
+        if (norm2 == 0) return gtsam::Pose3::Expmap(S * q);
+        const double norm = std::sqrt(norm2);
+        const gtsam::Rot3 R = gtsam::Rot3::AxisAngle(w / norm, norm * q);
+        const gtsam::Vector3 w_cross_v = w.cross(v) / norm2;
+        gtsam::Vector3 t = w_cross_v - R * w_cross_v;
+        if (type == Joint::Type::Screw) t += w * (w.dot(v) * q / norm2);
+        return gtsam::Pose3(R, gtsam::Point3(t));
+      }
+      default:
+        return gtsam::Pose3::Expmap(S * q);
+    }
+  }
+
+  /// Return exp(cScrewAxis * q), specialized on the joint type.
+  gtsam::Pose3 exp(double q) const { return Exp(type, cScrewAxis, q); }
+
+  /// Return transform of child CoM frame w.r.t parent CoM frame.
+  gtsam::Pose3 parentTchild(double q) const { return pMc * exp(q); }
+
+  /// Return transform of parent CoM frame w.r.t child CoM frame.
+  gtsam::Pose3 childTparent(double q) const {
+    return parentTchild(q).inverse();
+  }
+
+  /// Joint-induced twist in child frame.
+  gtsam::Vector6 childTwist(double q_dot) const { return cScrewAxis * q_dot; }
+
+  /// Joint-induced twist in parent frame.
+  gtsam::Vector6 parentTwist(double q_dot) const { return pScrewAxis * q_dot; }
+};
+
+}  // namespace gtdynamics
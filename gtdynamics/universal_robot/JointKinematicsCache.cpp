@@ -0,0 +1,63 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointKinematicsCache.cpp
+ * @brief Linearization-scoped cache of joint transforms, keyed by joint and
+ * joint angle.
+ */
+
+#include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/JointKinematicsCache.h>
+
+#include <cstring>
+#include <functional>
+
+namespace gtdynamics {
+
+namespace {
+// The cache of the outermost scope open on this thread.
+thread_local JointKinematicsCache *active_cache = nullptr;
+}  // namespace
+
+/* ************************************************************************* */
+size_t JointKinematicsCache::KeyHash::operator()(const Key &key) const {
+  const size_t h = std::hash<const Joint *>()(key.joint);
+  return h ^ (std::hash<uint64_t>()(key.q) + 0x9e3779b97f4a7c15ULL +
+              (h << 6) + (h >> 2));
+}
+
+/* ************************************************************************* */
+JointKinematicsCache::Scope::Scope() : previous_(active_cache) {
+  if (!active_cache) active_cache = &cache_;
+}
+
+/* ************************************************************************* */
+JointKinematicsCache::Scope::~Scope() { active_cache = previous_; }
+
+/* ************************************************************************* */
+JointKinematicsCache &JointKinematicsCache::Scope::cache() {
+  return *active_cache;
+}
+
+/* ************************************************************************* */
+JointKinematicsCache *JointKinematicsCache::Active() { return active_cache; }
+
+/* ************************************************************************* */
+JointKinematics &JointKinematicsCache::at(const Joint &joint, double q) {
+  Key key{&joint, 0};
+  std::memcpy(&key.q, &q, sizeof(q));
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    hits_++;
+    return it->second;
+  }
+  misses_++;
+  return entries_.emplace(key, joint.kinematics(q)).first->second;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointKinematicsCache.h
+ * @brief Linearization-scoped cache of joint transforms, keyed by joint and
+ * joint angle.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace gtdynamics {
+
+class Joint;  // forward declaration
+
+/// The quantities of a joint that only depend on its angle.
+struct JointKinematics {
+  gtsam::Pose3 pTc;        ///< child CoM pose in parent CoM frame
+  gtsam::Vector6 pTc_H_q;  ///< derivative of pTc w.r.t. the angle
+  gtsam::Matrix6 pAdc;     ///< Adjoint map of pTc
+  gtsam::Matrix6 cAdp;     ///< Adjoint map of cTp
+
+  /// Derivatives of cAdp and pAdc w.r.t. the angle, computed on demand.
+  gtsam::Matrix6 cAdp_H_q, pAdc_H_q;
+  bool has_cAdp_H_q = false, has_pAdc_H_q = false;
+};
+
+/**
+ * JointKinematicsCache holds the JointKinematics of the (joint, angle) pairs
+ * seen while it is active. At one time step, the pose, twist, twist
+ * acceleration and wrench equivalence factors of a joint all read the same
+ * angle, so with a cache active the joint exponential and adjoint maps are
+ * computed once per joint and linearization instead of once per factor.
+ *
+ * A cache is active on the thread that opened a Scope, for the lifetime of
+ * the scope; nested scopes share the outermost cache. Joint methods consult
+ * the active cache, if any, and compute directly otherwise, with the same
+ * results. Entries refer to Joint objects by address, so joints must not be
+ * modified or destroyed while a scope that saw them is open.
+ */
+class JointKinematicsCache {
+ private:
+  struct Key {
+    const Joint *joint;
+    uint64_t q;  // bits of the angle
+    bool operator==(const Key &other) const {
+      return joint == other.joint && q == other.q;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &key) const;
+  };
+
+  std::unordered_map<Key, JointKinematics, KeyHash> entries_;
+  size_t hits_ = 0, misses_ = 0;
+
+ public:
+  /// Activates a cache on the current thread while in scope.
+  class Scope {
+   private:
+    JointKinematicsCache *previous_;
+    JointKinematicsCache cache_;
+
+   public:
+    Scope();
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    /// Return the active cache, which is the one of the outermost scope.
+    JointKinematicsCache &cache();
+  };
+
+  /// Return the cache active on the current thread, or nullptr.
+  static JointKinematicsCache *Active();
+
+  /**
+   * Return the kinematics of a joint at angle q, computed by the joint on
+   * the first request.
+   */
+  JointKinematics &at(const Joint &joint, double q);
+
+  /// Number of (joint, angle) entries.
+  size_t size() const { return entries_.size(); }
+
+  /// Number of requests answered from the cache.
+  size_t hits() const { return hits_; }
+
+  /// Number of requests that computed an entry.
+  size_t misses() const { return misses_; }
+};
+
+}  // namespace gtdynamics
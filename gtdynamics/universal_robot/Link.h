@@ -32,6 +32,7 @@
 #include <boost/optional.hpp>
 #include <boost/shared_ptr.hpp>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -48,7 +49,7 @@ LINK_TYPEDEF_CLASS_POINTER(Joint);
  */
 class Link : public boost::enable_shared_from_this<Link> {
  private:
-  uint8_t id_;
+  uint16_t id_;
   std::string name_;
 
   /// Inertial elements.
@@ -86,7 +87,7 @@ class Link : public boost::enable_shared_from_this<Link> {
    * @param bMlink The pose of the link frame relative to the base frame.
    * @param is_fixed Flag indicating if the link is fixed.
    */
-  Link(uint8_t id, const std::string &name, const double mass,
+  Link(uint16_t id, const std::string &name, const double mass,
        const gtsam::Matrix3 &inertia, const gtsam::Pose3 &bMcom,
        const gtsam::Pose3 &bMlink, bool is_fixed = false)
       : id_(id),
@@ -95,7 +96,11 @@ class Link : public boost::enable_shared_from_this<Link> {
         inertia_(inertia),
         bMcom_(bMcom),
         bMlink_(bMlink),
-        is_fixed_(is_fixed) {}
+        is_fixed_(is_fixed) {
+    if (id >= DynamicsSymbol::kNoIndex) {
+      throw std::invalid_argument("Link id too large for DynamicsSymbol keys");
+    }
+  }
 
   /** destructor */
   virtual ~Link() = default;
@@ -126,7 +131,7 @@ class Link : public boost::enable_shared_from_this<Link> {
   }
 
   /// return ID of the link
-  uint8_t id() const { return id_; }
+  uint16_t id() const { return id_; }
 
   /// add joint to the link
   void addJoint(const JointSharedPtr &joint) { joints_.push_back(joint); }
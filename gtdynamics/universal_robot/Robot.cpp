@@ -11,9 +11,15 @@
  * @author: Frank Dellaert, Mandy Xie, and Alejandro Escontrela
  */
 
+#include <gtdynamics/universal_robot/FixedJoint.h>
+#include <gtdynamics/universal_robot/HelicalJoint.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/universal_robot/PrismaticJoint.h>
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/RobotTypes.h>
+#include <gtdynamics/utils/ContentHasher.h>
+#include <gtdynamics/utils/Profiler.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtdynamics/utils/values.h>
 
@@ -29,35 +35,101 @@ using gtsam::Vector6;
 
 namespace gtdynamics {
 
-template <typename K, typename V>
-std::vector<V> getValues(std::map<K, V> m) {
-  std::vector<V> vec;
-  vec.reserve(m.size());
-  std::transform(m.begin(), m.end(), back_inserter(vec),
-                 [](std::pair<K, V> const &pair) { return pair.second; });
-  return vec;
+Robot::Robot(const LinkMap &links, const JointMap &joints)
+    : model_(boost::make_shared<Model>()) {
+  model_->name_to_link = links;
+  model_->name_to_joint = joints;
+  model_->buildIndex();
 }
 
-Robot::Robot(const LinkMap &links, const JointMap &joints)
-    : name_to_link_(links), name_to_joint_(joints) {}
+void Robot::Model::buildIndex() {
+  links.clear();
+  id_to_link.clear();
+  for (auto &&kv : name_to_link) {
+    const LinkSharedPtr &link = kv.second;
+    links.push_back(link);
+    if (link->id() >= id_to_link.size()) id_to_link.resize(link->id() + 1);
+    id_to_link[link->id()] = link;
+  }
+
+  joints.clear();
+  id_to_joint.clear();
+  for (auto &&kv : name_to_joint) {
+    const JointSharedPtr &joint = kv.second;
+    joints.push_back(joint);
+    if (joint->id() >= id_to_joint.size()) {
+      id_to_joint.resize(joint->id() + 1);
+    }
+    id_to_joint[joint->id()] = joint;
+  }
+
+  ContentHasher hasher;
+  hasher.add(links.size());
+  for (auto &&link : links) {
+    hasher.add(link->name()).add(link->id()).add(link->mass());
+    hasher.add(link->inertia()).add(link->bMcom()).add(link->bMlink());
+  }
+  hasher.add(joints.size());
+  for (auto &&joint : joints) {
+    const JointParams &parameters = joint->parameters();
+    const JointScalarLimit &limits = parameters.scalar_limits;
+    hasher.add(joint->name()).add(joint->id()).add(joint->type());
+    hasher.add(joint->parent()->name()).add(joint->child()->name());
+    hasher.add(joint->jMp()).add(joint->jMc()).add(joint->cScrewAxis());
+    hasher.add(parameters.effort_type)
+        .add(limits.value_lower_limit)
+        .add(limits.value_upper_limit)
+        .add(limits.value_limit_threshold)
+        .add(parameters.velocity_limit)
+        .add(parameters.velocity_limit_threshold)
+        .add(parameters.acceleration_limit)
+        .add(parameters.acceleration_limit_threshold)
+        .add(parameters.torque_limit)
+        .add(parameters.torque_limit_threshold)
+        .add(parameters.damping_coefficient)
+        .add(parameters.spring_coefficient);
+  }
+  hash = hasher.value();
+}
+
+uint64_t Robot::contentHash() const {
+  ContentHasher hasher;
+  hasher.add(model_->hash);
+  for (auto &&link : links()) {
+    if (!isFixed(link)) continue;
+    hasher.add(link->id()).add(fixedPose(link));
+  }
+  return hasher.value();
+}
 
-std::vector<LinkSharedPtr> Robot::links() const {
-  return getValues<std::string, LinkSharedPtr>(name_to_link_);
+void Robot::rebuildLinkJoints() {
+  for (auto &&link : model_->links) link->joints_.clear();
+  for (auto &&joint : model_->id_to_joint) {
+    if (!joint) continue;
+    joint->parent()->addJoint(joint);
+    joint->child()->addJoint(joint);
+  }
 }
 
-std::vector<JointSharedPtr> Robot::joints() const {
-  return getValues<std::string, JointSharedPtr>(name_to_joint_);
+Robot::Model &Robot::mutableModel() {
+  if (!model_.unique()) model_ = boost::make_shared<Model>(*model_);
+  return *model_;
 }
 
 void Robot::removeLink(const LinkSharedPtr &link) {
+  // Copy the name, `link` may refer into the flat storage rebuilt below.
+  const std::string name = link->name();
+
   // remove all joints associated to the link
   auto joints = link->joints();
   for (JointSharedPtr joint : joints) {
     removeJoint(joint);
   }
 
-  // remove link from name_to_link_
-  name_to_link_.erase(link->name());
+  // remove link from name_to_link
+  Model &model = mutableModel();
+  model.name_to_link.erase(name);
+  model.buildIndex();
 }
 
 void Robot::removeJoint(const JointSharedPtr &joint) {
@@ -65,47 +137,230 @@ void Robot::removeJoint(const JointSharedPtr &joint) {
   for (auto link : joint->links()) {
     link->removeJoint(joint);
   }
-  // Remove the joint from name_to_joint_
-  name_to_joint_.erase(joint->name());
+  // Remove the joint from name_to_joint
+  Model &model = mutableModel();
+  model.name_to_joint.erase(joint->name());
+  model.buildIndex();
 }
 
-LinkSharedPtr Robot::link(const std::string &name) const {
-  if (name_to_link_.find(name) == name_to_link_.end()) {
+const LinkSharedPtr &Robot::link(const std::string &name) const {
+  const LinkMap &name_to_link = model_->name_to_link;
+  auto it = name_to_link.find(name);
+  if (it == name_to_link.end()) {
     throw std::runtime_error("no link named " + name);
   }
-  return name_to_link_.at(name);
+  return it->second;
 }
 
-Robot Robot::fixLink(const std::string &name) {
-  if (name_to_link_.find(name) == name_to_link_.end()) {
-    throw std::runtime_error("no link named " + name);
+Robot Robot::fixLink(const std::string &name,
+                     const boost::optional<Pose3> &fixed_pose) const {
+  const LinkSharedPtr fixed_link = link(name);
+  Robot fixed_robot(*this);
+  fixed_robot.fixed_states_[fixed_link->id()] =
+      FixedState{true, fixed_pose ? *fixed_pose : fixed_link->bMcom()};
+  return fixed_robot;
+}
+
+Robot Robot::unfixLink(const std::string &name) const {
+  const LinkSharedPtr unfixed_link = link(name);
+  Robot unfixed_robot(*this);
+  unfixed_robot.fixed_states_[unfixed_link->id()] =
+      FixedState{false, unfixed_link->getFixedPose()};
+  return unfixed_robot;
+}
+
+// Collect the links connected to `link` through fixed joints, including itself.
+static std::vector<LinkSharedPtr> FixedGroup(const LinkSharedPtr &link) {
+  std::vector<LinkSharedPtr> group{link};
+  for (size_t k = 0; k < group.size(); k++) {
+    for (auto &&joint : group[k]->joints()) {
+      if (joint->type() != Joint::Type::Fixed) continue;
+      const LinkSharedPtr other = joint->otherLink(group[k]);
+      if (std::find(group.begin(), group.end(), other) == group.end()) {
+        group.push_back(other);
+      }
+    }
   }
+  return group;
+}
 
-  Robot fixed_robot = Robot(*this);
-  fixed_robot.name_to_link_.at(name)->fix();
-  return fixed_robot;
+// Return the link a group is merged into: a fixed link if there is one,
+// otherwise the link that is not the child of a fixed joint.
+static LinkSharedPtr GroupRoot(const Robot &robot,
+                               const std::vector<LinkSharedPtr> &group) {
+  for (auto &&link : group) {
+    if (robot.isFixed(link)) return link;
+  }
+  for (auto &&link : group) {
+    bool is_child = false;
+    for (auto &&joint : link->joints()) {
+      if (joint->type() == Joint::Type::Fixed && joint->child() == link) {
+        is_child = true;
+      }
+    }
+    if (!is_child) return link;
+  }
+  return group.front();
 }
 
-Robot Robot::unfixLink(const std::string &name) {
-  if (name_to_link_.find(name) == name_to_link_.end()) {
-    throw std::runtime_error("no link named " + name);
+// Merge a group of rigidly attached links into a single link, which keeps
+// the CoM frame orientation of the group root.
+static LinkSharedPtr MergeLinks(const Robot &robot,
+                                const std::vector<LinkSharedPtr> &group,
+                                const LinkSharedPtr &root) {
+  double mass = 0;
+  Vector3 com = Vector3::Zero();
+  for (auto &&link : group) {
+    mass += link->mass();
+    com += link->mass() * link->bMcom().translation();
+  }
+  com = mass > 0 ? Vector3(com / mass) : root->bMcom().translation();
+  const gtsam::Rot3 bRcom = root->bMcom().rotation();
+  const Pose3 bMcom(bRcom, com);
+
+  // Parallel axis theorem, in the merged CoM frame.
+  gtsam::Matrix3 inertia = gtsam::Matrix3::Zero();
+  for (auto &&link : group) {
+    const gtsam::Matrix3 R =
+        bRcom.between(link->bMcom().rotation()).matrix();
+    const Vector3 d = bRcom.unrotate(link->bMcom().translation() - com);
+    inertia += R * link->inertia() * R.transpose() +
+               link->mass() * (d.dot(d) * gtsam::I_3x3 - d * d.transpose());
   }
 
-  Robot unfixed_robot = Robot(*this);
-  unfixed_robot.name_to_link_.at(name)->unfix();
-  return unfixed_robot;
+  auto merged = boost::make_shared<Link>(root->id(), root->name(), mass,
+                                         inertia, bMcom, root->bMlink());
+  if (robot.isFixed(root)) {
+    Pose3 fixed_pose = robot.fixedPose(root) * root->bMcom().between(bMcom);
+    merged = boost::make_shared<Link>(Link::fix(*merged, fixed_pose));
+  }
+  return merged;
+}
+
+// Re-create a joint between new links, with the given id and the same
+// kinematics.
+static JointSharedPtr RebuildJoint(const JointSharedPtr &joint, uint16_t id,
+                                   const LinkSharedPtr &parent,
+                                   const LinkSharedPtr &child) {
+  const Pose3 bTj = joint->parent()->bMcom() * joint->jMp().inverse();
+  const Vector6 jScrewAxis = joint->jMc().AdjointMap() * joint->cScrewAxis();
+  switch (joint->type()) {
+    case Joint::Type::Revolute:
+      return boost::make_shared<RevoluteJoint>(id, joint->name(), bTj, parent,
+                                               child, jScrewAxis.head<3>(),
+                                               joint->parameters());
+    case Joint::Type::Prismatic:
+      return boost::make_shared<PrismaticJoint>(id, joint->name(), bTj, parent,
+                                                child, jScrewAxis.tail<3>(),
+                                                joint->parameters());
+    case Joint::Type::Screw:
+      return boost::make_shared<HelicalJoint>(id, joint->name(), bTj, parent,
+                                              child, jScrewAxis,
+                                              joint->parameters());
+    case Joint::Type::Fixed:
+      return boost::make_shared<FixedJoint>(id, joint->name(), bTj, parent,
+                                            child);
+    default:
+      throw std::runtime_error("cannot rebuild joint " + joint->name());
+  }
+}
+
+Robot Robot::lumpFixedJoints(LumpedLinks *lumped) const {
+  LumpedLinks destinations;
+  LinkMap links;
+  for (auto &&link : links()) {
+    if (destinations.count(link->name())) continue;
+    const std::vector<LinkSharedPtr> group = FixedGroup(link);
+    const LinkSharedPtr merged =
+        MergeLinks(*this, group, GroupRoot(*this, group));
+    links.emplace(merged->name(), merged);
+    for (auto &&member : group) {
+      destinations[member->name()] =
+          LumpedLink{merged, merged->bMcom().between(member->bMcom())};
+    }
+  }
+
+  JointMap joints;
+  for (auto &&joint : joints()) {
+    if (joint->type() == Joint::Type::Fixed) continue;
+    const LinkSharedPtr &parent = destinations.at(joint->parent()->name()).link;
+    const LinkSharedPtr &child = destinations.at(joint->child()->name()).link;
+    if (parent == child) {
+      throw std::runtime_error("lumpFixedJoints: joint " + joint->name() +
+                               " connects two rigidly attached links.");
+    }
+    const JointSharedPtr rebuilt =
+        RebuildJoint(joint, joint->id(), parent, child);
+    parent->addJoint(rebuilt);
+    child->addJoint(rebuilt);
+    joints.emplace(rebuilt->name(), rebuilt);
+  }
+
+  if (lumped) *lumped = destinations;
+  return Robot(links, joints);
 }
 
-JointSharedPtr Robot::joint(const std::string &name) const {
-  if (name_to_joint_.find(name) == name_to_joint_.end()) {
+Robot Robot::offsetIds(int link_offset, int joint_offset) const {
+  if (link_offset < 0 || joint_offset < 0) {
+    throw std::invalid_argument("offsetIds: offsets should be >= 0.");
+  }
+
+  // Copies of the links, with all their properties but their joints.
+  LinkMap links;
+  for (auto &&link : links()) {
+    auto shifted = boost::make_shared<Link>(*link);
+    shifted->id_ = link->id() + link_offset;
+    shifted->joints_.clear();
+    if (shifted->id_ >= DynamicsSymbol::kNoIndex) {
+      throw std::invalid_argument("offsetIds: link id too large for keys.");
+    }
+    links.emplace(shifted->name(), shifted);
+  }
+
+  JointMap joints;
+  for (auto &&joint : joints()) {
+    const int id = joint->id() + joint_offset;
+    if (id >= DynamicsSymbol::kNoIndex) {
+      throw std::invalid_argument("offsetIds: joint id too large for keys.");
+    }
+    const LinkSharedPtr &parent = links.at(joint->parent()->name());
+    const LinkSharedPtr &child = links.at(joint->child()->name());
+    const JointSharedPtr rebuilt = RebuildJoint(joint, id, parent, child);
+    parent->addJoint(rebuilt);
+    child->addJoint(rebuilt);
+    joints.emplace(rebuilt->name(), rebuilt);
+  }
+
+  Robot shifted(links, joints);
+  for (auto &&kv : fixed_states_) {
+    shifted.fixed_states_[kv.first + link_offset] = kv.second;
+  }
+  return shifted;
+}
+
+PointOnLinks RemapPointOnLinks(const PointOnLinks &points,
+                               const LumpedLinks &lumped) {
+  PointOnLinks remapped;
+  for (auto &&point_on_link : points) {
+    const LumpedLink &to = lumped.at(point_on_link.link->name());
+    remapped.emplace_back(to.link,
+                          to.comTold.transformFrom(point_on_link.point));
+  }
+  return remapped;
+}
+
+const JointSharedPtr &Robot::joint(const std::string &name) const {
+  const JointMap &name_to_joint = model_->name_to_joint;
+  auto it = name_to_joint.find(name);
+  if (it == name_to_joint.end()) {
     throw std::runtime_error("no joint named " + name);
   }
-  return name_to_joint_.at(name);
+  return it->second;
 }
 
-int Robot::numLinks() const { return name_to_link_.size(); }
+int Robot::numLinks() const { return model_->name_to_link.size(); }
 
-int Robot::numJoints() const { return name_to_joint_.size(); }
+int Robot::numJoints() const { return model_->name_to_joint.size(); }
 
 void Robot::print(const std::string &s) const {
   using std::cout;
@@ -121,7 +376,7 @@ void Robot::print(const std::string &s) const {
   // Print links in sorted id order.
   cout << "LINKS:" << endl;
   for (const auto &link : sorted_links) {
-    std::string fixed = link->isFixed() ? " (fixed)" : "";
+    std::string fixed = isFixed(link) ? " (fixed)" : "";
     cout << link->name() << ", id=" << size_t(link->id()) << fixed << ":\n";
     cout << "\tcom pose: " << link->bMcom().rotation().rpy().transpose() << ", "
          << link->bMcom().translation().transpose() << "\n";
@@ -158,10 +413,10 @@ LinkSharedPtr Robot::findRootLink(
   if (prior_link_name) {
     root_link = link(*prior_link_name);
   } else {
-    auto links = this->links();
+    const auto &links = this->links();
     auto links_iter =
         std::find_if(links.rbegin(), links.rend(),
-                     [](const LinkSharedPtr &link) { return link->isFixed(); });
+                     [this](const LinkSharedPtr &l) { return isFixed(l); });
     // If valid link is found by find_if, assign root_link to the iterator.
     if (links_iter != links.rend()) {
       root_link = *links_iter;
@@ -177,11 +432,11 @@ LinkSharedPtr Robot::findRootLink(
 }
 
 // Insert fixed link poses into values
-static void InsertFixedLinks(const std::vector<LinkSharedPtr> &links, size_t t,
+static void InsertFixedLinks(const Robot &robot, size_t t,
                              gtsam::Values *values) {
-  for (auto &&link : links) {
-    if (link->isFixed()) {
-      InsertPose(values, link->id(), t, link->getFixedPose());
+  for (auto &&link : robot.links()) {
+    if (robot.isFixed(link)) {
+      InsertPose(values, link->id(), t, robot.fixedPose(link));
       InsertTwist(values, link->id(), t, Vector6::Zero());
     }
   }
@@ -226,11 +481,12 @@ static bool InsertWithCheck(size_t i, size_t t,
 gtsam::Values Robot::forwardKinematics(
     const gtsam::Values &known_values, size_t t,
     const boost::optional<std::string> &prior_link_name) const {
+  GTD_PROFILE_SCOPE("Robot::forwardKinematics");
   gtsam::Values values = known_values;
 
   // Set root link.
   const auto root_link = findRootLink(values, prior_link_name);
-  InsertFixedLinks(links(), t, &values);
+  InsertFixedLinks(*this, t, &values);
 
   if (!values.exists(PoseKey(root_link->id(), t))) {
     InsertPose(&values, root_link->id(), t, gtsam::Pose3());
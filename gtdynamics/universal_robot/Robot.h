@@ -17,9 +17,14 @@
 #include <gtdynamics/universal_robot/Joint.h>
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtdynamics/universal_robot/RobotTypes.h>
+#include <gtdynamics/utils/PointOnLink.h>
 
+#include <boost/make_shared.hpp>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstdint>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,21 +47,81 @@ using LinkTwists = std::map<std::string, gtsam::Vector6>;
 // type for storing forward kinematics results
 using FKResults = std::pair<LinkPoses, LinkTwists>;
 
+/// Link of a lumped robot that a link of the original robot was merged into.
+struct LumpedLink {
+  LinkSharedPtr link;    ///< link of the lumped robot
+  gtsam::Pose3 comTold;  ///< original CoM frame in the lumped link CoM frame
+};
+/// Map from original link name to the link it was merged into.
+using LumpedLinks = std::map<std::string, LumpedLink>;
+
 /**
  * Robot is used to create a representation of a robot's
  * inertial/dynamic properties from a URDF/SDF file. The resulting object
  * provides getters for the robot's various joints and links, which can then
  * be fed into an optimization pipeline.
+ *
+ * Copies of a Robot share their links and joints. Variants created with
+ * fixLink and unfixLink only record which links are fixed, at which pose, on
+ * top of the shared model, so they are cheap to create and do not affect the
+ * robot they were created from. Graph builders query `isFixed` and
+ * `fixedPose` on the robot rather than on its links for that reason.
  */
 class Robot {
  private:
-  // For quicker/easier access to links and joints.
-  LinkMap name_to_link_;
-  JointMap name_to_joint_;
+  /// Link and joint storage, shared between copies of a robot.
+  struct Model {
+    // For quicker/easier access to links and joints.
+    LinkMap name_to_link;
+    JointMap name_to_joint;
+
+    // Flat storage, rebuilt whenever links or joints are added or removed:
+    // links and joints in name order, and indexed by id (null if id unused).
+    std::vector<LinkSharedPtr> links, id_to_link;
+    std::vector<JointSharedPtr> joints, id_to_joint;
+
+    // ContentHasher hash of the links and joints, see Robot::contentHash.
+    uint64_t hash = 0;
+
+    /// Rebuild the flat storage and the hash from the name maps.
+    void buildIndex();
+  };
+  boost::shared_ptr<Model> model_;
+
+  /// Fixed state of a link in this variant, overriding the link's own.
+  struct FixedState {
+    bool is_fixed;
+    gtsam::Pose3 pose;
+
+    FixedState() : is_fixed(false) {}
+    FixedState(bool is_fixed, const gtsam::Pose3 &pose)
+        : is_fixed(is_fixed), pose(pose) {}
+
+    bool operator==(const FixedState &other) const {
+      return is_fixed == other.is_fixed && pose.equals(other.pose);
+    }
+
+    template <class ARCHIVE>
+    void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+      ar &BOOST_SERIALIZATION_NVP(is_fixed);
+      ar &BOOST_SERIALIZATION_NVP(pose);
+    }
+  };
+  std::map<int, FixedState> fixed_states_;  // by link id
+
+  /// Return the model for modification, copying it first if it is shared.
+  Model &mutableModel();
+
+  /**
+   * Rebuild the joint lists of the links from the parents and children of
+   * the joints, in joint id order, as the loaders add them. Links do not
+   * archive their joints, so this runs after deserialization.
+   */
+  void rebuildLinkJoints();
 
  public:
   /** Default Constructor */
-  Robot() {}
+  Robot() : model_(boost::make_shared<Model>()) {}
 
   /**
    * Constructor from link and joint elements.
@@ -67,41 +132,102 @@ class Robot {
    */
   explicit Robot(const LinkMap &links, const JointMap &joints);
 
-  /// Return this robot's links.
-  std::vector<LinkSharedPtr> links() const;
+  /// Return this robot's links, ordered by name.
+  const std::vector<LinkSharedPtr> &links() const { return model_->links; }
 
-  /// Return this robot's joints.
-  std::vector<JointSharedPtr> joints() const;
+  /// Return this robot's joints, ordered by name.
+  const std::vector<JointSharedPtr> &joints() const { return model_->joints; }
 
-  /// remove specified link from the robot
+  /**
+   * Remove specified link from the robot. The joints of the link are also
+   * removed from the links they connect, which are shared with other copies.
+   */
   void removeLink(const LinkSharedPtr &link);
 
-  /// remove specified joint from the robot
+  /// remove specified joint from the robot, see removeLink.
   void removeJoint(const JointSharedPtr &joint);
 
   /// Return the link corresponding to the input string.
-  LinkSharedPtr link(const std::string &name) const;
+  const LinkSharedPtr &link(const std::string &name) const;
+
+  /// Return the link with the given id, in constant time.
+  const LinkSharedPtr &link(int id) const {
+    const auto &id_to_link = model_->id_to_link;
+    if (id < 0 || size_t(id) >= id_to_link.size() || !id_to_link[id]) {
+      throw std::runtime_error("no link with id " + std::to_string(id));
+    }
+    return id_to_link[id];
+  }
 
   /**
    * @brief Return a copy of this robot with the link corresponding to the input
-   * string as a fixed link.
+   * string as a fixed link. The copy shares links and joints with this robot.
    *
    * @param name The name of the link to fix.
+   * @param fixed_pose Pose of the link CoM, bMcom if not given.
    * @return Robot
    */
-  Robot fixLink(const std::string &name);
+  Robot fixLink(const std::string &name,
+                const boost::optional<gtsam::Pose3> &fixed_pose =
+                    boost::none) const;
 
   /**
    * @brief Return a copy of this robot after unfixing the link corresponding to
-   * the input string.
+   * the input string. The copy shares links and joints with this robot.
    *
    * @param name The name of the link to unfix.
    * @return Robot
    */
-  Robot unfixLink(const std::string &name);
+  Robot unfixLink(const std::string &name) const;
+
+  /// Return whether a link is fixed in this robot.
+  bool isFixed(const LinkSharedPtr &link) const {
+    auto it = fixed_states_.find(link->id());
+    return it != fixed_states_.end() ? it->second.is_fixed : link->isFixed();
+  }
+
+  /// Return the pose of the CoM of a fixed link in this robot.
+  const gtsam::Pose3 &fixedPose(const LinkSharedPtr &link) const {
+    auto it = fixed_states_.find(link->id());
+    return it != fixed_states_.end() ? it->second.pose : link->getFixedPose();
+  }
+
+  /**
+   * @brief Return a copy of this robot in which all links connected by fixed
+   * joints are merged into a single link, with the combined mass, CoM and
+   * inertia. Each group of merged links keeps the name and id of the link
+   * closest to the root of the fixed joints, a fixed link if there is one.
+   * All other joints are re-created on the merged links, with the same
+   * names, ids and kinematics.
+   *
+   * @param lumped Optional output: where each original link ended up.
+   * @return Robot without fixed joints
+   */
+  Robot lumpFixedJoints(LumpedLinks *lumped = nullptr) const;
+
+  /**
+   * @brief Return a copy of this robot with all link ids shifted by
+   * link_offset and all joint ids by joint_offset, so that its keys do not
+   * collide with those of other robots in the same graph. Links and joints
+   * are re-created, with the same names, properties and fixed states.
+   *
+   * @param link_offset Offset added to all link ids.
+   * @param joint_offset Offset added to all joint ids.
+   * @return Robot with shifted ids
+   */
+  Robot offsetIds(int link_offset, int joint_offset) const;
 
   /// Return the joint corresponding to the input string.
-  JointSharedPtr joint(const std::string &name) const;
+  const JointSharedPtr &joint(const std::string &name) const;
+
+  /// Return the joint with the given id, in constant time.
+  const JointSharedPtr &joint(int id) const {
+    const auto &id_to_joint = model_->id_to_joint;
+    if (id < 0 || size_t(id) >= id_to_joint.size() || !id_to_joint[id]) {
+      throw std::runtime_error("no joint with id " + std::to_string(id));
+    }
+    return id_to_joint[id];
+  }
 
   /// Return number of *moving* links.
   int numLinks() const;
@@ -116,29 +242,44 @@ class Robot {
   bool operator==(const Robot &other) const {
     // Define comparators for easy std::map equality checking
     // Needed since we are storing shared pointers as the values.
-    auto link_comparator = [](decltype(*this->name_to_link_.begin()) a,
-                              decltype(a) b) {
+    const LinkMap &links = model_->name_to_link,
+                  &other_links = other.model_->name_to_link;
+    const JointMap &joints = model_->name_to_joint,
+                   &other_joints = other.model_->name_to_joint;
+    auto link_comparator = [](decltype(*links.begin()) a, decltype(a) b) {
       // compare the key name and the underlying shared_ptr object
       return a.first == b.first && (*a.second) == (*b.second);
     };
-    auto joint_comparator = [](decltype(*this->name_to_joint_.begin()) a,
-                               decltype(a) b) {
+    auto joint_comparator = [](decltype(*joints.begin()) a, decltype(a) b) {
       // compare the key name and the underlying shared_ptr object
       return a.first == b.first && (*a.second) == (*b.second);
     };
 
-    return (this->name_to_link_.size() == other.name_to_link_.size() &&
-            std::equal(this->name_to_link_.begin(), this->name_to_link_.end(),
-                       other.name_to_link_.begin(), link_comparator) &&
-            this->name_to_joint_.size() == other.name_to_joint_.size() &&
-            std::equal(this->name_to_joint_.begin(), this->name_to_joint_.end(),
-                       other.name_to_joint_.begin(), joint_comparator));
+    return (links.size() == other_links.size() &&
+            std::equal(links.begin(), links.end(), other_links.begin(),
+                       link_comparator) &&
+            joints.size() == other_joints.size() &&
+            std::equal(joints.begin(), joints.end(), other_joints.begin(),
+                       joint_comparator) &&
+            fixed_states_ == other.fixed_states_);
   }
 
   bool equals(const Robot &other, double tol = 0) const {
     return *this == other;
   }
 
+  /**
+   * Return a content hash of the robot: names, ids and inertias of the links,
+   * names, ids, types, connectivity, rest poses, screw axes and parameters of
+   * the joints, and which links are fixed at which poses. Equal robots, e.g.
+   * loaded from the same file in different processes, have the same hash,
+   * so it can key caches of anything built for a robot. The hash of the
+   * links and joints is computed once when they change, and shared by
+   * copies; only the fixed links are hashed on each call. Links and joints
+   * modified in place, rather than through the robot, are not rehashed.
+   */
+  uint64_t contentHash() const;
+
   /**
    * Calculate forward kinematics by performing BFS in the link-joint graph
    * (will throw an error when invalid joint angle specification detected).
@@ -171,12 +312,28 @@ class Robot {
   friend class boost::serialization::access;
   template <class ARCHIVE>
   void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
-    ar &BOOST_SERIALIZATION_NVP(name_to_link_);
-    ar &BOOST_SERIALIZATION_NVP(name_to_joint_);
+    if (ARCHIVE::is_loading::value) model_ = boost::make_shared<Model>();
+    ar &boost::serialization::make_nvp("name_to_link_", model_->name_to_link);
+    ar &boost::serialization::make_nvp("name_to_joint_",
+                                       model_->name_to_joint);
+    ar &BOOST_SERIALIZATION_NVP(fixed_states_);
+    if (ARCHIVE::is_loading::value) {
+      model_->buildIndex();
+      rebuildLinkJoints();
+    }
   }
 
   /// @}
 };
+
+/**
+ * Express points on links of a robot on the links of its lumped version.
+ * @param points  points on links of the original robot
+ * @param lumped  output of Robot::lumpFixedJoints
+ */
+PointOnLinks RemapPointOnLinks(const PointOnLinks &points,
+                               const LumpedLinks &lumped);
+
 }  // namespace gtdynamics
 
 namespace gtsam {
@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotModelRegistry.cpp
+ * @brief Registry of robot models compiled in as binary blobs.
+ */
+
+#include <gtdynamics/universal_robot/RobotModelRegistry.h>
+#include <gtdynamics/universal_robot/sdf.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+std::map<std::string, RobotModelRegistry::Blob> &RobotModelRegistry::Blobs() {
+  static std::map<std::string, Blob> blobs;
+  return blobs;
+}
+
+/* ************************************************************************* */
+bool RobotModelRegistry::Register(const std::string &name, const char *data,
+                                  size_t size) {
+  Blobs()[name] = Blob(data, size);
+  return true;
+}
+
+/* ************************************************************************* */
+bool RobotModelRegistry::Has(const std::string &name) {
+  return Blobs().count(name) > 0;
+}
+
+/* ************************************************************************* */
+std::vector<std::string> RobotModelRegistry::Names() {
+  std::vector<std::string> names;
+  for (auto &&entry : Blobs()) names.push_back(entry.first);
+  return names;
+}
+
+/* ************************************************************************* */
+Robot RobotModelRegistry::Create(const std::string &name) {
+  auto it = Blobs().find(name);
+  if (it == Blobs().end()) {
+    throw std::invalid_argument("RobotModelRegistry: no model " + name);
+  }
+  return CreateRobotFromBlob(it->second.first, it->second.second);
+}
+
+}  // namespace gtdynamics
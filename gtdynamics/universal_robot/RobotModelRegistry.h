@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotModelRegistry.h
+ * @brief Registry of robot models compiled in as binary blobs.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Registry of robot models keyed by name, stored as blobs of
+ * SerializeRobotBlob. The blobs of the standard models are generated from
+ * their URDF/SDF files at build time and compiled into the
+ * gtdynamics_robot_models library, see RegisterCompiledRobotModels, so that
+ * creating a robot needs neither file access nor sdformat.
+ */
+class RobotModelRegistry {
+  using Blob = std::pair<const char *, size_t>;
+  static std::map<std::string, Blob> &Blobs();
+
+ public:
+  /**
+   * Register a blob, replacing any previous one; returns true. The blob is
+   * not copied and must outlive the registry, as static data does.
+   */
+  static bool Register(const std::string &name, const char *data,
+                       size_t size);
+
+  /// Return whether a model is registered under a name.
+  static bool Has(const std::string &name);
+
+  /// Return the registered model names.
+  static std::vector<std::string> Names();
+
+  /// Create the robot registered under a name, throws if there is none.
+  static Robot Create(const std::string &name);
+};
+
+}  // namespace gtdynamics
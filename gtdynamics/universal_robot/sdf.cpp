@@ -18,18 +18,34 @@
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/universal_robot/sdf_internal.h>
-
+#include <gtdynamics/utils/ParallelFor.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
 #include <sdf/parser.hh>
 #include <sdf/sdf.hh>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
 
 namespace gtdynamics {
 
 using gtsam::Pose3;
 
-sdf::Model GetSdf(const std::string &sdf_file_path,
-                  const std::string &model_name,
-                  const sdf::ParserConfig &config) {
+// Parse and load an SDF or URDF file into root.
+static void LoadSdfRoot(const std::string &sdf_file_path,
+                        const sdf::ParserConfig &config, sdf::Root *root) {
   sdf::Errors errors;
 
   sdf::SDFPtr sdf = sdf::readFile(sdf_file_path, config, errors);
@@ -41,14 +57,20 @@ sdf::Model GetSdf(const std::string &sdf_file_path,
     throw std::runtime_error("SDF library could not parse " + sdf_file_path);
   }
 
-  sdf::Root root;
-  errors = root.Load(sdf, config);
+  errors = root->Load(sdf, config);
   if (errors.size() > 0) {
     for (auto &&error : errors) {
       std::cout << error.Message() << std::endl;
     }
     throw std::runtime_error("Error loading SDF file " + sdf_file_path);
   }
+}
+
+sdf::Model GetSdf(const std::string &sdf_file_path,
+                  const std::string &model_name,
+                  const sdf::ParserConfig &config) {
+  sdf::Root root;
+  LoadSdfRoot(sdf_file_path, config, &root);
 
   // Check whether this is a world file, in which case we have to first
   // access the world element then check whether one of its child models
@@ -166,7 +188,7 @@ gtsam::Vector3 GetSdfAxis(const sdf::Joint &sdf_joint) {
   return gtsam::Vector3(axis[0], axis[1], axis[2]);
 }
 
-LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
+LinkSharedPtr LinkFromSdf(uint16_t id, const sdf::Link &sdf_link) {
   gtsam::Matrix3 inertia;
   const auto &I = sdf_link.Inertial().Moi();
   inertia << I(0, 0), I(0, 1), I(0, 2), I(1, 0), I(1, 1), I(1, 2), I(2, 0),
@@ -183,14 +205,14 @@ LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
                                   inertia, bMcom, bMl);
 }
 
-LinkSharedPtr LinkFromSdf(uint8_t id, const std::string &link_name,
+LinkSharedPtr LinkFromSdf(uint16_t id, const std::string &link_name,
                           const std::string &sdf_file_path,
                           const std::string &model_name) {
   auto model = GetSdf(sdf_file_path, model_name);
   return LinkFromSdf(id, *model.LinkByName(link_name));
 }
 
-JointSharedPtr JointFromSdf(uint8_t id, const LinkSharedPtr &parent_link,
+JointSharedPtr JointFromSdf(uint16_t id, const LinkSharedPtr &parent_link,
                             const sdf::Link *parent_sdf_link,
                             const LinkSharedPtr &child_link,
                             const sdf::Link *child_sdf_link,
@@ -325,4 +347,165 @@ Robot CreateRobotFromFile(const std::string &file_path,
   return Robot(links_joints_pair.first, links_joints_pair.second);
 }
 
+std::map<std::string, Robot> CreateRobotsFromWorldFile(
+    const std::string &file_path, bool preserve_fixed_joint) {
+  std::ifstream is(file_path);
+  if (!is.good())
+    throw std::runtime_error("CreateRobotsFromWorldFile: no file found at " +
+                             file_path);
+  is.close();
+
+  sdf::ParserConfig config = sdf::ParserConfig::GlobalConfig();
+  config.URDFSetPreserveFixedJoint(preserve_fixed_joint);
+  sdf::Root root;
+  LoadSdfRoot(file_path, config, &root);
+
+  // Collect the models of all worlds, or the single model of the file.
+  std::vector<const sdf::Model *> models;
+  for (size_t widx = 0; widx < root.WorldCount(); widx++) {
+    const sdf::World *world = root.WorldByIndex(widx);
+    for (uint midx = 0; midx < world->ModelCount(); midx++) {
+      models.push_back(world->ModelByIndex(midx));
+    }
+  }
+  if (root.WorldCount() == 0 && root.Model()) models.push_back(root.Model());
+
+  // Build the robots concurrently, only reading the loaded DOM.
+  std::vector<Robot> robots(models.size());
+  ParallelFor(models.size(), [&](size_t m) {
+    const LinkJointPair links_joints = ExtractRobotFromSdf(*models[m]);
+    robots[m] = Robot(links_joints.first, links_joints.second);
+  });
+
+  std::map<std::string, Robot> named_robots;
+  for (size_t m = 0; m < models.size(); m++) {
+    if (!named_robots.emplace(models[m]->Name(), robots[m]).second) {
+      throw std::runtime_error("CreateRobotsFromWorldFile: two models " +
+                               models[m]->Name() + " in " + file_path);
+    }
+  }
+  return named_robots;
+}
+
+/// Version of the robot cache format, bump when Robot serialization changes.
+static constexpr uint32_t kRobotCacheVersion = 3;
+
+/// 64-bit FNV-1a hash of the file contents and of the parsing arguments.
+static uint64_t RobotSourceHash(const std::string &file_path,
+                                const std::string &model_name,
+                                bool preserve_fixed_joint) {
+  std::ifstream is(file_path, std::ios::binary);
+  if (!is) throw std::runtime_error("Unable to read file " + file_path);
+  std::string source((std::istreambuf_iterator<char>(is)),
+                     std::istreambuf_iterator<char>());
+  source += '\0' + model_name + (preserve_fixed_joint ? '1' : '0');
+
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : source) {
+    hash = (hash ^ c) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+/// Register the joint types, in the same order for saving and loading.
+template <class ARCHIVE>
+static void RegisterJointTypes(ARCHIVE &ar) {
+  ar.template register_type<RevoluteJoint>();
+  ar.template register_type<PrismaticJoint>();
+  ar.template register_type<HelicalJoint>();
+}
+
+Robot CreateRobotFromCachedFile(const std::string &file_path,
+                                const std::string &cache_path,
+                                const std::string &model_name,
+                                bool preserve_fixed_joint) {
+  const uint64_t hash =
+      RobotSourceHash(file_path, model_name, preserve_fixed_joint);
+
+  // Load from the cache if it was written for the same source.
+  std::ifstream is(cache_path, std::ios::binary);
+  if (is) {
+    try {
+      boost::archive::binary_iarchive ia(is);
+      uint32_t version;
+      uint64_t cached_hash;
+      ia >> version >> cached_hash;
+      if (version == kRobotCacheVersion && cached_hash == hash) {
+        RegisterJointTypes(ia);
+        Robot robot;
+        ia >> robot;
+        return robot;
+      }
+    } catch (const std::exception &) {
+      // Corrupt or incompatible cache: parse the file instead.
+    }
+  }
+  is.close();
+
+  Robot robot =
+      CreateRobotFromFile(file_path, model_name, preserve_fixed_joint);
+
+  // Write to a file of this process and rename it, which is atomic, so that
+  // concurrent readers never see a partial cache.
+  const std::string temp_path =
+      cache_path + ".tmp" + std::to_string(std::random_device()());
+  bool written = false;
+  try {
+    std::ofstream os(temp_path, std::ios::binary);
+    {
+      boost::archive::binary_oarchive oa(os);
+      oa << kRobotCacheVersion << hash;
+      RegisterJointTypes(oa);
+      oa << robot;
+    }
+    os.close();
+    written = os.good();
+  } catch (const std::exception &) {
+    // The robot can not be cached, e.g., it has fixed joints.
+  }
+  if (!written || std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+    // Do not leave a partial or stale cache behind.
+    std::remove(temp_path.c_str());
+    std::remove(cache_path.c_str());
+  }
+  return robot;
+}
+
+std::string SerializeRobotBlob(const Robot &robot) {
+  std::ostringstream os(std::ios::binary);
+  {
+    boost::archive::binary_oarchive oa(os);
+    oa << kRobotCacheVersion;
+    RegisterJointTypes(oa);
+    oa << robot;
+  }
+  return os.str();
+}
+
+/// Read-only stream buffer on a blob in memory, to deserialize it in place.
+class BlobBuffer : public std::streambuf {
+ public:
+  BlobBuffer(const char *data, size_t size) {
+    char *begin = const_cast<char *>(data);
+    setg(begin, begin, begin + size);
+  }
+};
+
+Robot CreateRobotFromBlob(const char *data, size_t size) {
+  BlobBuffer buffer(data, size);
+  std::istream is(&buffer);
+  boost::archive::binary_iarchive ia(is);
+  uint32_t version;
+  ia >> version;
+  if (version != kRobotCacheVersion) {
+    throw std::invalid_argument("CreateRobotFromBlob: blob of version " +
+                                std::to_string(version) + ", expected " +
+                                std::to_string(kRobotCacheVersion));
+  }
+  RegisterJointTypes(ia);
+  Robot robot;
+  ia >> robot;
+  return robot;
+}
+
 }  // namespace gtdynamics
@@ -15,6 +15,7 @@
 
 #include <gtdynamics/universal_robot/Robot.h>
 
+#include <map>
 #include <string>
 
 namespace gtdynamics {
@@ -31,4 +32,48 @@ Robot CreateRobotFromFile(const std::string &file_path,
                           const std::string &model_name = "",
                           bool preserve_fixed_joint = false);
 
+/**
+ * @fn Construct all robots of a urdf or sdf file, e.g. a world with many
+ * models. The file is parsed once, and the robots are built from it
+ * concurrently.
+ * @param[in] file_path path to the file.
+ * @param[in] preserve_fixed_joint as in CreateRobotFromFile.
+ * @return the robot of each model, by model name.
+ * @throws std::runtime_error if two models have the same name.
+ */
+std::map<std::string, Robot> CreateRobotsFromWorldFile(
+    const std::string &file_path, bool preserve_fixed_joint = false);
+
+/**
+ * @fn Construct Robot from a urdf or sdf file, through a binary cache.
+ * If the cache file exists and was written for the same file contents and
+ * arguments, the robot is deserialized from it and sdformat is not used.
+ * Otherwise the file is parsed and the cache is (re)written.
+ * @param[in] file_path path to the file.
+ * @param[in] cache_path path to the binary cache file.
+ * @param[in] model_name name of the robot we care about, as in
+ *    CreateRobotFromFile.
+ * @param[in] preserve_fixed_joint as in CreateRobotFromFile.
+ */
+Robot CreateRobotFromCachedFile(const std::string &file_path,
+                                const std::string &cache_path,
+                                const std::string &model_name = "",
+                                bool preserve_fixed_joint = false);
+
+/**
+ * @fn Serialize a robot to a binary blob, in the format of the robot cache
+ * without its source hash, to be loaded by CreateRobotFromBlob.
+ * @param[in] robot the robot, without preserved fixed joints.
+ */
+std::string SerializeRobotBlob(const Robot &robot);
+
+/**
+ * @fn Construct Robot from a binary blob of SerializeRobotBlob, e.g., one
+ * compiled into a binary, without file access or sdformat parsing.
+ * @param[in] data the blob.
+ * @param[in] size its size in bytes.
+ * @throws std::invalid_argument if the blob is of another format version.
+ */
+Robot CreateRobotFromBlob(const char *data, size_t size);
+
 }  // namespace gtdynamics
@@ -0,0 +1,62 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnalyticIKInitializer.cpp
+ * @brief Initialize arm trajectories from analytic inverse kinematics.
+ */
+
+#include <gtdynamics/utils/AnalyticIKInitializer.h>
+#include <gtdynamics/utils/values.h>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+/* ************************************************************************* */
+Values AnalyticIKInitializer::InitializeSolutionAnalyticIK(
+    const Robot &robot, const std::vector<Pose3> &bTe_path, const Vector &seed,
+    double gaussian_noise) const {
+  std::vector<int> ik_joint_ids;
+  for (auto &&name : ik_->jointNames()) {
+    ik_joint_ids.push_back(robot.joint(name)->id());
+  }
+  const LinkSharedPtr &base = robot.link(base_name_);
+  const Pose3 wTbase =
+      robot.isFixed(base) ? robot.fixedPose(base) : base->bMcom();
+
+  Values values;
+  Vector q = seed;
+  for (size_t t = 0; t < bTe_path.size(); ++t) {
+    Values step = ZeroValues(robot, t, gaussian_noise);
+
+    // IK solution nearest to the previous step, for a smooth path.
+    const boost::optional<Vector> solution = ik_->nearest(bTe_path[t], q);
+    if (solution) q = *solution;
+    for (size_t i = 0; i < ik_joint_ids.size(); ++i) {
+      step.update(JointAngleKey(ik_joint_ids[i], t), q(i));
+    }
+
+    // Link poses by forward kinematics, from the joint angles only.
+    Values known;
+    for (auto &&joint : robot.joints()) {
+      const gtsam::Key key = JointAngleKey(joint->id(), t);
+      known.insert(key, step.at<double>(key));
+    }
+    InsertPose(&known, base->id(), t, wTbase);
+    const Values fk = robot.forwardKinematics(known, t, base_name_);
+    for (auto &&link : robot.links()) {
+      step.update(PoseKey(link->id(), t), Pose(fk, link->id(), t));
+    }
+    values.insert(step);
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AnalyticIKInitializer.h
+ * @brief Initialize arm trajectories from analytic inverse kinematics.
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/AnalyticIK.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Initializer that seeds arm trajectories with analytic IK solutions along an
+ * end-effector path, instead of zero or noisy joint angles. Works with any
+ * AnalyticIK solver, e.g. one created by AnalyticIKRegistry.
+ */
+class AnalyticIKInitializer : public Initializer {
+  AnalyticIKPtr ik_;
+  std::string base_name_;
+
+ public:
+  /**
+   * Constructor
+   * @param ik         the analytic IK solver
+   * @param base_name  name of the base link, the IK base frame
+   */
+  AnalyticIKInitializer(const AnalyticIKPtr &ik, const std::string &base_name)
+      : ik_(ik), base_name_(base_name) {}
+
+  /// Return the analytic IK solver.
+  const AnalyticIK &ik() const { return *ik_; }
+
+  /**
+   * Initialize a trajectory following an end-effector path.
+   *
+   * All variables are initialized as in ZeroValues. The angles of the IK
+   * joints at each time step are then set to the solution nearest to the
+   * previous step, starting from the seed, and the link poses follow by
+   * forward kinematics from the base. A step whose pose cannot be reached
+   * keeps the angles of the previous step.
+   *
+   * @param robot           the robot
+   * @param bTe_path        end-effector pose wrt the base frame, one per step
+   * @param seed            joint angles to start the path from
+   * @param gaussian_noise  noise added by ZeroValues
+   * @return values for steps 0 to bTe_path.size() - 1
+   */
+  gtsam::Values InitializeSolutionAnalyticIK(
+      const Robot &robot, const std::vector<gtsam::Pose3> &bTe_path,
+      const gtsam::Vector &seed, double gaussian_noise = 0.0) const;
+};
+
+}  // namespace gtdynamics
@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/utils/ChainInitializer.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
 
 namespace gtdynamics {
 
@@ -19,8 +20,7 @@ gtsam::Values ChainInitializer::ZeroValues(const Robot& robot, const int t, doub
                   const boost::optional<PointOnLinks>& contact_points) const {
   gtsam::Values values;
 
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
+  auto sampler_noise_model = InternedIsotropic(6, gaussian_noise);
   gtsam::Sampler sampler(sampler_noise_model);
 
   // Initialize link dynamics to 0.
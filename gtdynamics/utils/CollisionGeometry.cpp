@@ -0,0 +1,200 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionGeometry.cpp
+ * @brief Capsule approximations of links and a bounding volume hierarchy.
+ */
+
+#include <gtdynamics/utils/CollisionGeometry.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+
+static double Clamp01(double x) { return std::min(1.0, std::max(0.0, x)); }
+
+/* ************************************************************************* */
+double SegmentClosestPoints(const Point3 &p0, const Point3 &p1,
+                            const Point3 &q0, const Point3 &q1, double *s,
+                            double *t) {
+  constexpr double kEpsilon = 1e-12;
+  const Point3 d1 = p1 - p0, d2 = q1 - q0, r = p0 - q0;
+  const double a = d1.dot(d1), e = d2.dot(d2), f = d2.dot(r);
+  if (a <= kEpsilon && e <= kEpsilon) {
+    *s = *t = 0.0;
+  } else if (a <= kEpsilon) {
+    *s = 0.0;
+    *t = Clamp01(f / e);
+  } else {
+    const double c = d1.dot(r);
+    if (e <= kEpsilon) {
+      *t = 0.0;
+      *s = Clamp01(-c / a);
+    } else {
+      // General case, clamp s then recompute t, and s again if t clamps.
+      const double b = d1.dot(d2), denominator = a * e - b * b;
+      *s = denominator > kEpsilon ? Clamp01((b * f - c * e) / denominator)
+                                  : 0.0;
+      *t = (b * *s + f) / e;
+      if (*t < 0.0) {
+        *t = 0.0;
+        *s = Clamp01(-c / a);
+      } else if (*t > 1.0) {
+        *t = 1.0;
+        *s = Clamp01((b - c) / a);
+      }
+    }
+  }
+  return (p0 + *s * d1 - q0 - *t * d2).norm();
+}
+
+/* ************************************************************************* */
+std::vector<LinkCapsule> LinkCapsules(const Robot &robot, double radius) {
+  std::vector<LinkCapsule> capsules;
+  for (auto &&link : robot.links()) {
+    // Joint anchors in the CoM frame of the link.
+    std::vector<Point3> anchors;
+    for (auto &&joint : link->joints()) {
+      const gtsam::Pose3 &jMl =
+          joint->child()->id() == link->id() ? joint->jMc() : joint->jMp();
+      anchors.push_back(jMl.inverse().translation());
+    }
+
+    Point3 a(0, 0, 0), b(0, 0, 0);
+    if (anchors.size() == 1) {
+      a = anchors[0];
+      b = -anchors[0];
+    } else if (anchors.size() > 1) {
+      double farthest = -1.0;
+      for (size_t i = 0; i < anchors.size(); ++i) {
+        for (size_t j = i + 1; j < anchors.size(); ++j) {
+          const double distance = (anchors[i] - anchors[j]).norm();
+          if (distance > farthest) {
+            farthest = distance;
+            a = anchors[i];
+            b = anchors[j];
+          }
+        }
+      }
+    }
+    capsules.emplace_back(link->id(), Capsule(a, b, radius));
+  }
+  return capsules;
+}
+
+/* ************************************************************************* */
+std::vector<std::pair<int, int>> AdjacentLinks(const Robot &robot) {
+  std::vector<std::pair<int, int>> pairs;
+  for (auto &&joint : robot.joints()) {
+    const int i = joint->parent()->id(), j = joint->child()->id();
+    pairs.emplace_back(std::min(i, j), std::max(i, j));
+  }
+  return pairs;
+}
+
+/* ************************************************************************* */
+AlignedBox AlignedBox::Of(const Capsule &capsule, double padding) {
+  const Point3 grow = Point3::Constant(capsule.radius + padding);
+  return AlignedBox(capsule.a.cwiseMin(capsule.b) - grow,
+                    capsule.a.cwiseMax(capsule.b) + grow);
+}
+
+/* ************************************************************************* */
+AlignedBox AlignedBox::merge(const AlignedBox &other) const {
+  return AlignedBox(min.cwiseMin(other.min), max.cwiseMax(other.max));
+}
+
+/* ************************************************************************* */
+bool AlignedBox::overlaps(const AlignedBox &other) const {
+  return (min.array() <= other.max.array()).all() &&
+         (other.min.array() <= max.array()).all();
+}
+
+/* ************************************************************************* */
+CapsuleBVH::CapsuleBVH(const std::vector<Capsule> &capsules, double margin) {
+  if (capsules.empty()) return;
+  // Padding each box by half the margin makes boxes of capsules closer than
+  // the margin overlap.
+  std::vector<AlignedBox> boxes;
+  boxes.reserve(capsules.size());
+  for (auto &&capsule : capsules) {
+    boxes.push_back(AlignedBox::Of(capsule, 0.5 * margin));
+  }
+  std::vector<int> indices(capsules.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  nodes_.reserve(2 * capsules.size());
+  root_ = build(boxes, &indices, 0, indices.size());
+}
+
+/* ************************************************************************* */
+int CapsuleBVH::build(const std::vector<AlignedBox> &boxes,
+                      std::vector<int> *indices, size_t begin, size_t end) {
+  if (end - begin == 1) {
+    const int index = (*indices)[begin];
+    nodes_.emplace_back(boxes[index], -1, -1, index);
+    return nodes_.size() - 1;
+  }
+
+  AlignedBox box = boxes[(*indices)[begin]];
+  for (size_t i = begin + 1; i < end; ++i) {
+    box = box.merge(boxes[(*indices)[i]]);
+  }
+
+  // Split at the median center along the longest axis.
+  int axis;
+  (box.max - box.min).maxCoeff(&axis);
+  const size_t middle = (begin + end) / 2;
+  std::nth_element(indices->begin() + begin, indices->begin() + middle,
+                   indices->begin() + end, [&](int i, int j) {
+                     return boxes[i].min[axis] + boxes[i].max[axis] <
+                            boxes[j].min[axis] + boxes[j].max[axis];
+                   });
+  const int left = build(boxes, indices, begin, middle);
+  const int right = build(boxes, indices, middle, end);
+  nodes_.emplace_back(box, left, right, -1);
+  return nodes_.size() - 1;
+}
+
+/* ************************************************************************* */
+void CapsuleBVH::collide(int a, int b,
+                         std::vector<std::pair<size_t, size_t>> *pairs) const {
+  const Node &A = nodes_[a], &B = nodes_[b];
+  if (!A.box.overlaps(B.box)) return;
+  if (A.index >= 0 && B.index >= 0) {
+    pairs->emplace_back(std::min(A.index, B.index),
+                        std::max(A.index, B.index));
+  } else if (B.index >= 0) {
+    collide(A.left, b, pairs);
+    collide(A.right, b, pairs);
+  } else {
+    collide(a, B.left, pairs);
+    collide(a, B.right, pairs);
+  }
+}
+
+/* ************************************************************************* */
+void CapsuleBVH::selfCollide(
+    int node, std::vector<std::pair<size_t, size_t>> *pairs) const {
+  const Node &N = nodes_[node];
+  if (N.index >= 0) return;
+  selfCollide(N.left, pairs);
+  selfCollide(N.right, pairs);
+  collide(N.left, N.right, pairs);
+}
+
+/* ************************************************************************* */
+std::vector<std::pair<size_t, size_t>> CapsuleBVH::candidatePairs() const {
+  std::vector<std::pair<size_t, size_t>> pairs;
+  if (root_ >= 0) selfCollide(root_, &pairs);
+  return pairs;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionGeometry.h
+ * @brief Capsule approximations of links and a bounding volume hierarchy.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * A capsule, the set of points within radius of the segment from a to b. A
+ * sphere is a capsule with a == b.
+ */
+struct Capsule {
+  gtsam::Point3 a, b;
+  double radius;
+
+  Capsule(const gtsam::Point3 &a, const gtsam::Point3 &b, double radius)
+      : a(a), b(b), radius(radius) {}
+
+  /// Return the point at parameter s in [0, 1] along the axis.
+  gtsam::Point3 point(double s) const { return a + s * (b - a); }
+
+  /// Return the capsule transformed by a pose, e.g. from link to world.
+  Capsule transformFrom(const gtsam::Pose3 &pose) const {
+    return Capsule(pose.transformFrom(a), pose.transformFrom(b), radius);
+  }
+};
+
+/// Capsule of a link, in its CoM frame.
+struct LinkCapsule {
+  int link_id;
+  Capsule capsule;
+
+  LinkCapsule(int link_id, const Capsule &capsule)
+      : link_id(link_id), capsule(capsule) {}
+};
+
+/**
+ * Return the closest points of the segments [p0, p1] and [q0, q1], as the
+ * parameters s and t along each segment, and their distance.
+ */
+double SegmentClosestPoints(const gtsam::Point3 &p0, const gtsam::Point3 &p1,
+                            const gtsam::Point3 &q0, const gtsam::Point3 &q1,
+                            double *s, double *t);
+
+/**
+ * Approximate each link of a robot by a capsule, in its CoM frame. Links have
+ * no collision geometry, so the axis goes through the joint anchors: between
+ * the two farthest anchors for links with several joints, and from the anchor
+ * through the CoM to its mirror for links with one joint. Links without
+ * joints get a sphere at the CoM.
+ * @param robot   the robot
+ * @param radius  radius of all capsules
+ */
+std::vector<LinkCapsule> LinkCapsules(const Robot &robot, double radius);
+
+/**
+ * Return the pairs of links connected by a joint, as (smaller id, larger id).
+ * Those always touch, so self-collision ignores them.
+ */
+std::vector<std::pair<int, int>> AdjacentLinks(const Robot &robot);
+
+/// Axis-aligned bounding box.
+struct AlignedBox {
+  gtsam::Point3 min, max;
+
+  AlignedBox(const gtsam::Point3 &min, const gtsam::Point3 &max)
+      : min(min), max(max) {}
+
+  /// Return the box of a capsule, grown by padding on all sides.
+  static AlignedBox Of(const Capsule &capsule, double padding = 0.0);
+
+  /// Return the smallest box containing both.
+  AlignedBox merge(const AlignedBox &other) const;
+
+  /// Return whether the boxes overlap.
+  bool overlaps(const AlignedBox &other) const;
+};
+
+/**
+ * CapsuleBVH is a bounding volume hierarchy over a set of capsules, used to
+ * find the pairs that may be closer than a margin without testing all pairs.
+ * It is a binary tree of aligned boxes, built top-down by splitting at the
+ * median along the longest axis, and is cheap enough to rebuild at every
+ * linearization.
+ */
+class CapsuleBVH {
+ private:
+  struct Node {
+    AlignedBox box;
+    int left, right;  // children, -1 for leaves
+    int index;        // capsule of a leaf, -1 for inner nodes
+
+    Node(const AlignedBox &box, int left, int right, int index)
+        : box(box), left(left), right(right), index(index) {}
+  };
+  std::vector<Node> nodes_;
+  int root_ = -1;
+
+  int build(const std::vector<AlignedBox> &boxes, std::vector<int> *indices,
+            size_t begin, size_t end);
+  void collide(int a, int b,
+               std::vector<std::pair<size_t, size_t>> *pairs) const;
+  void selfCollide(int node,
+                   std::vector<std::pair<size_t, size_t>> *pairs) const;
+
+ public:
+  /**
+   * Constructor
+   * @param capsules  capsules, in a common frame
+   * @param margin    distance below which pairs are reported
+   */
+  CapsuleBVH(const std::vector<Capsule> &capsules, double margin);
+
+  /**
+   * Return the pairs (i, j), i < j, whose boxes overlap, a superset of the
+   * pairs of capsules closer than the margin.
+   */
+  std::vector<std::pair<size_t, size_t>> candidatePairs() const;
+};
+
+}  // namespace gtdynamics
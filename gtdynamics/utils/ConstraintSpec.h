@@ -13,6 +13,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 namespace gtdynamics {
 
 /**
@@ -25,6 +28,9 @@ class ConstraintSpec {
   public:
     /// GTSAM-style print, pure virtual here
     virtual void print(const std::string &s) const = 0;
+
+    /// Return a content hash of the specification, see ContentHasher.
+    virtual uint64_t contentHash() const = 0;
     
     // destructor
     virtual ~ConstraintSpec() = default;
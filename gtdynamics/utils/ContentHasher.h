@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContentHasher.h
+ * @brief Stable 64-bit hashes of model and problem contents, for cache keys.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Pose3.h>
+
+#include <Eigen/Core>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace gtdynamics {
+
+/**
+ * ContentHasher accumulates a 64-bit FNV-1a hash of a sequence of numbers,
+ * strings, matrices and poses. The hash only depends on the values added and
+ * their order, never on addresses or on std::hash, and integers and doubles
+ * are hashed as little-endian 64-bit words, so it is the same in every
+ * process and on every platform: use it as a key of caches on disk or shared
+ * between processes. Strings and matrices are prefixed with their sizes, so
+ * that different sequences do not run together.
+ *
+ * Doubles are hashed by value: -0.0 and 0.0 hash the same, as do all NaNs.
+ */
+class ContentHasher {
+ private:
+  uint64_t hash_ = 14695981039346656037ull;
+
+  void addWord(uint64_t word) {
+    for (int i = 0; i < 8; i++) {
+      hash_ ^= (word >> (8 * i)) & 0xff;
+      hash_ *= 1099511628211ull;
+    }
+  }
+
+ public:
+  ContentHasher() {}
+
+  /// Add an integer, bool or enum.
+  template <class T>
+  typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value,
+                          ContentHasher &>::type
+  add(T x) {
+    addWord(static_cast<uint64_t>(static_cast<int64_t>(x)));
+    return *this;
+  }
+
+  /// Add a double.
+  ContentHasher &add(double x) {
+    if (x == 0) x = 0;  // -0.0
+    if (std::isnan(x)) x = std::numeric_limits<double>::quiet_NaN();
+    uint64_t word;
+    std::memcpy(&word, &x, sizeof(word));
+    addWord(word);
+    return *this;
+  }
+
+  /// Add a string, with its length.
+  ContentHasher &add(const std::string &s) {
+    add(s.size());
+    for (const char c : s) {
+      hash_ ^= static_cast<unsigned char>(c);
+      hash_ *= 1099511628211ull;
+    }
+    return *this;
+  }
+
+  /// Add a C string, with its length.
+  ContentHasher &add(const char *s) { return add(std::string(s)); }
+
+  /// Add a matrix or vector, with its size, in column-major order.
+  template <class DERIVED>
+  ContentHasher &add(const Eigen::MatrixBase<DERIVED> &M) {
+    add(M.rows());
+    add(M.cols());
+    for (Eigen::Index j = 0; j < M.cols(); j++) {
+      for (Eigen::Index i = 0; i < M.rows(); i++) add(double(M(i, j)));
+    }
+    return *this;
+  }
+
+  /// Add a pose, as its 4x4 matrix.
+  ContentHasher &add(const gtsam::Pose3 &pose) { return add(pose.matrix()); }
+
+  /// Return the hash of everything added so far.
+  uint64_t value() const { return hash_; }
+};
+
+}  // namespace gtdynamics
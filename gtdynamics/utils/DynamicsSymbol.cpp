@@ -16,26 +16,21 @@
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include <iostream>
+#include <stdexcept>
 
 using gtsam::Key;
 namespace gtdynamics {
 
 /* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol()
-    : c1_(0), c2_(0), link_idx_(0), joint_idx_(0), t_(0) {}
-
-/* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol(const DynamicsSymbol& key)
-    : c1_(key.c1_),
-      c2_(key.c2_),
-      link_idx_(key.link_idx_),
-      joint_idx_(key.joint_idx_),
-      t_(key.t_) {}
-
-/* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol(const std::string& s, uint8_t link_idx,
-                               uint8_t joint_idx, uint64_t t)
+DynamicsSymbol::DynamicsSymbol(const std::string& s, uint16_t link_idx,
+                               uint16_t joint_idx, uint64_t t)
     : link_idx_(link_idx), joint_idx_(joint_idx), t_(t) {
+  if (link_idx > kNoIndex || joint_idx > kNoIndex) {
+    throw std::invalid_argument("link or joint index too large for key");
+  }
+  if (t > time_mask) {
+    throw std::invalid_argument("time step too large for key");
+  }
   if (s.length() > 2) {
     throw std::runtime_error(
         "cannot use more than 2 characters in dynamics symbol");
@@ -53,44 +48,25 @@ DynamicsSymbol::DynamicsSymbol(const std::string& s, uint8_t link_idx,
 }
 
 DynamicsSymbol DynamicsSymbol::LinkJointSymbol(const std::string& s,
-                                               uint8_t link_idx,
-                                               uint8_t joint_idx,
+                                               uint16_t link_idx,
+                                               uint16_t joint_idx,
                                                uint64_t t) {
   return DynamicsSymbol(s, link_idx, joint_idx, t);
 }
 
 DynamicsSymbol DynamicsSymbol::JointSymbol(const std::string& s,
-                                           uint8_t joint_idx,
+                                           uint16_t joint_idx,
                                            uint64_t t) {
-  return DynamicsSymbol(s, kMax_uchar_, joint_idx, t);
+  return DynamicsSymbol(s, kNoIndex, joint_idx, t);
 }
 
 DynamicsSymbol DynamicsSymbol::LinkSymbol(const std::string& s,
-                                          uint8_t link_idx, uint64_t t) {
-  return DynamicsSymbol(s, link_idx, kMax_uchar_, t);
+                                          uint16_t link_idx, uint64_t t) {
+  return DynamicsSymbol(s, link_idx, kNoIndex, t);
 }
 
 DynamicsSymbol DynamicsSymbol::SimpleSymbol(const std::string& s, uint64_t t) {
-  return DynamicsSymbol(s, kMax_uchar_, kMax_uchar_, t);
-}
-
-/* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol(const Key& key) {
-  c1_ = (uint8_t)((key & ch1_mask) >> (key_bits - ch1_bits));
-  c2_ = (uint8_t)((key & ch2_mask) >> (key_bits - ch1_bits - ch2_bits));
-  link_idx_ = (uint8_t)((key & link_mask) >> (time_bits + joint_bits));
-  joint_idx_ = (uint8_t)((key & joint_mask) >> time_bits);
-  t_ = key & time_mask;
-}
-
-/* ************************************************************************* */
-DynamicsSymbol::operator Key() const {
-  Key ch1_comp = Key(c1_) << (key_bits - ch1_bits);
-  Key ch2_comp = Key(c2_) << (key_bits - ch1_bits - ch2_bits);
-  Key link_comp = Key(link_idx_) << (time_bits + joint_bits);
-  Key joint_comp = Key(joint_idx_) << time_bits;
-  Key key = ch1_comp | ch2_comp | link_comp | joint_comp | t_;
-  return key;
+  return DynamicsSymbol(s, kNoIndex, kNoIndex, t);
 }
 
 /* ************************************************************************* */
@@ -116,10 +92,10 @@ void DynamicsSymbol::print(const std::string& s) const {
 /* ************************************************************************* */
 DynamicsSymbol::operator std::string() const {
   std::string s = label();
-  if (link_idx_ != kMax_uchar_) {
+  if (link_idx_ != kNoIndex) {
     s += "[" + std::to_string((int)(link_idx_)) + "]";
   }
-  if (joint_idx_ != kMax_uchar_) {
+  if (joint_idx_ != kNoIndex) {
     s += "(" + std::to_string((int)(joint_idx_)) + ")";
   }
   s += std::to_string(t_);
@@ -16,11 +16,60 @@
 #include <gtsam/inference/Key.h>
 #include <gtsam/inference/Symbol.h>
 
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
 namespace gtdynamics {
 
+/**
+ * DynamicsSymbol packs a 1 or 2 character label, a link index, a joint index
+ * and a time step into a single 64-bit gtsam::Key, with the layout
+ *
+ *   | char 1 (8) | char 2 (8) | link (12) | joint (12) | time (24) |
+ *
+ * Link and joint indices range from 0 to kNoIndex - 1, kNoIndex marks symbols
+ * without a link or joint. Encoding and decoding are plain shifts and masks.
+ *
+ * Symbols are made either from a string label, or from a Label, for which
+ * construction is constexpr and does not touch strings, e.g. for the key
+ * shorthands such as PoseKey that graph builders call for every factor.
+ */
 class DynamicsSymbol {
+ public:
+  /// Number of bits of the link and joint indices.
+  static constexpr size_t kIndexBits = 12;
+
+  /// Index stored for symbols without link or joint, one more than the
+  /// largest valid link or joint id.
+  static constexpr uint16_t kNoIndex = (1 << kIndexBits) - 1;
+
+  /// Label of a symbol, its characters packed as (c1 << 8) | c2, with single
+  /// characters in c2. Other labels can be made with MakeLabel.
+  enum class Label : uint16_t {
+    JointAngle = 'q',
+    JointVel = 'v',
+    JointAccel = 'a',
+    Torque = 'T',
+    Pose = 'p',
+    Twist = 'V',
+    TwistAccel = 'A',
+    Wrench = 'F',
+    ContactWrench = 'C',
+    Inertial = 'I',
+    Time = 't',
+    Phase = ('d' << 8) | 't'
+  };
+
+  /// Return the label of characters c1 and c2, or of c2 alone if c1 is 0.
+  static constexpr Label MakeLabel(char c1, char c2) {
+    return static_cast<Label>(uint16_t(uint8_t(c1)) << 8 | uint8_t(c2));
+  }
+
  protected:
-  uint8_t c1_, c2_, link_idx_, joint_idx_;
+  uint8_t c1_, c2_;
+  uint16_t link_idx_, joint_idx_;
   uint64_t t_;
 
  private:
@@ -32,23 +81,38 @@ class DynamicsSymbol {
    * @param[in] joint_idx index of the joint
    * @param[in] t         time step
    */
-  DynamicsSymbol(const std::string& s, uint8_t link_idx,
-                 uint8_t joint_idx, uint64_t t);
+  DynamicsSymbol(const std::string& s, uint16_t link_idx,
+                 uint16_t joint_idx, uint64_t t);
+
+  /// Constructor from a label, see the string constructor.
+  constexpr DynamicsSymbol(Label label, uint16_t link_idx, uint16_t joint_idx,
+                           uint64_t t)
+      : c1_(uint8_t(uint16_t(label) >> 8)),
+        c2_(uint8_t(uint16_t(label))),
+        link_idx_(link_idx <= kNoIndex && joint_idx <= kNoIndex
+                      ? link_idx
+                      : throw std::invalid_argument(
+                            "link or joint index too large for key")),
+        joint_idx_(joint_idx),
+        t_(t <= time_mask
+               ? t
+               : throw std::invalid_argument("time step too large for key")) {}
 
  public:
   /** Default constructor */
-  DynamicsSymbol();
+  constexpr DynamicsSymbol()
+      : c1_(0), c2_(0), link_idx_(0), joint_idx_(0), t_(0) {}
 
   /** Copy constructor */
-  DynamicsSymbol(const DynamicsSymbol& key);
+  constexpr DynamicsSymbol(const DynamicsSymbol& key) = default;
 
   /**
    * Constructor for symbol related to both link and joint.
    *  See private constructor
    */
   static DynamicsSymbol LinkJointSymbol(const std::string& s,
-                                        uint8_t link_idx,
-                                        uint8_t joint_idx, uint64_t t);
+                                        uint16_t link_idx,
+                                        uint16_t joint_idx, uint64_t t);
 
   /**
    * Constructor for symbol related to only joint (e.g. joint angle).
@@ -58,16 +122,16 @@ class DynamicsSymbol {
    * @param[in] t         time step
    */
   static DynamicsSymbol JointSymbol(const std::string& s,
-                                    uint8_t joint_idx, uint64_t t);
+                                    uint16_t joint_idx, uint64_t t);
 
   /**
    * Constructor for symbol related to only link (e.g. link pose).
    *
    * @param[in] s         1 or 2 characters to represent the variable type
-   * @param[in] joint_idx index of the joint
+   * @param[in] link_idx  index of the link
    * @param[in] t         time step
    */
-  static DynamicsSymbol LinkSymbol(const std::string& s, uint8_t link_idx,
+  static DynamicsSymbol LinkSymbol(const std::string& s, uint16_t link_idx,
                                    uint64_t t);
 
   /**
@@ -78,25 +142,57 @@ class DynamicsSymbol {
    */
   static DynamicsSymbol SimpleSymbol(const std::string& s, uint64_t t);
 
+  /// Constexpr constructors from a label, see the string versions.
+  static constexpr DynamicsSymbol LinkJointSymbol(Label label,
+                                                  uint16_t link_idx,
+                                                  uint16_t joint_idx,
+                                                  uint64_t t) {
+    return DynamicsSymbol(label, link_idx, joint_idx, t);
+  }
+
+  static constexpr DynamicsSymbol JointSymbol(Label label, uint16_t joint_idx,
+                                              uint64_t t) {
+    return DynamicsSymbol(label, kNoIndex, joint_idx, t);
+  }
+
+  static constexpr DynamicsSymbol LinkSymbol(Label label, uint16_t link_idx,
+                                             uint64_t t) {
+    return DynamicsSymbol(label, link_idx, kNoIndex, t);
+  }
+
+  static constexpr DynamicsSymbol SimpleSymbol(Label label, uint64_t t) {
+    return DynamicsSymbol(label, kNoIndex, kNoIndex, t);
+  }
+
   /**
    * Constructor that decodes an integer gtsam::Key
    */
-  DynamicsSymbol(const gtsam::Key& key);
+  constexpr DynamicsSymbol(const gtsam::Key& key)
+      : c1_(uint8_t(key >> (key_bits - ch1_bits))),
+        c2_(uint8_t(key >> (key_bits - ch1_bits - ch2_bits))),
+        link_idx_(uint16_t((key & link_mask) >> (time_bits + joint_bits))),
+        joint_idx_(uint16_t((key & joint_mask) >> time_bits)),
+        t_(key & time_mask) {}
 
   /// Cast to a GTSAM Key.
-  operator gtsam::Key() const;
+  constexpr operator gtsam::Key() const {
+    return gtsam::Key(c1_) << (key_bits - ch1_bits) |
+           gtsam::Key(c2_) << (key_bits - ch1_bits - ch2_bits) |
+           gtsam::Key(link_idx_) << (time_bits + joint_bits) |
+           gtsam::Key(joint_idx_) << time_bits | (t_ & time_mask);
+  }
 
   /// Return string label.
   std::string label() const;
 
-  /// Return link id.
-  inline uint8_t linkIdx() const { return link_idx_; }
+  /// Return link id, kNoIndex if the symbol is not related to a link.
+  constexpr uint16_t linkIdx() const { return link_idx_; }
 
-  /// Return joint id.
-  inline uint8_t jointIdx() const { return joint_idx_; }
+  /// Return joint id, kNoIndex if the symbol is not related to a joint.
+  constexpr uint16_t jointIdx() const { return joint_idx_; }
 
   /// Retrieve key index.
-  inline uint64_t time() const { return t_; }
+  constexpr uint64_t time() const { return t_; }
 
   /// Print.
   void print(const std::string& s = "") const;
@@ -107,7 +203,7 @@ class DynamicsSymbol {
   }
 
   /// return the integer version
-  gtsam::Key key() const { return (gtsam::Key) * this; }
+  constexpr gtsam::Key key() const { return (gtsam::Key) * this; }
 
   /// Create a string from the key
   operator std::string() const;
@@ -134,8 +230,8 @@ class DynamicsSymbol {
   static constexpr size_t key_bits = sizeof(gtsam::Key) * 8;
   static constexpr size_t ch1_bits = sizeof(uint8_t) * 8;
   static constexpr size_t ch2_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t link_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t joint_bits = sizeof(uint8_t) * 8;
+  static constexpr size_t link_bits = kIndexBits;
+  static constexpr size_t joint_bits = kIndexBits;
   static constexpr size_t time_bits =
       key_bits - ch1_bits - ch2_bits - link_bits - joint_bits;
   // masks
@@ -143,9 +239,9 @@ class DynamicsSymbol {
                                          << (key_bits - ch1_bits);
   static constexpr gtsam::Key ch2_mask = gtsam::Key(kMax_uchar_)
                                          << (key_bits - ch1_bits - ch2_bits);
-  static constexpr gtsam::Key link_mask = gtsam::Key(kMax_uchar_)
+  static constexpr gtsam::Key link_mask = gtsam::Key(kNoIndex)
                                           << (time_bits + joint_bits);
-  static constexpr gtsam::Key joint_mask = gtsam::Key(kMax_uchar_) << time_bits;
+  static constexpr gtsam::Key joint_mask = gtsam::Key(kNoIndex) << time_bits;
   static constexpr gtsam::Key time_mask =
       ~(ch1_mask | ch2_mask | link_mask | joint_mask);
   /**@}*/
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorArena.cpp
+ * @brief Arena allocation of the factors of a graph built per planning cycle.
+ */
+
+#include <gtdynamics/utils/FactorArena.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+namespace {
+// The arena of the innermost scope open on this thread.
+thread_local FactorArena *active_arena = nullptr;
+}  // namespace
+
+/* ************************************************************************* */
+FactorArena::FactorArena(size_t block_size) : block_size_(block_size) {
+  if (block_size == 0) {
+    throw std::invalid_argument("FactorArena: block size must be positive.");
+  }
+}
+
+/* ************************************************************************* */
+void *FactorArena::allocate(size_t bytes, size_t alignment) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Carve from the current block, if it has room after aligning.
+  auto carve = [&]() -> void * {
+    const Block &block = blocks_[current_];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+    const uintptr_t aligned =
+        (base + offset_ + alignment - 1) & ~uintptr_t(alignment - 1);
+    const size_t end = aligned - base + bytes;
+    if (end > block.size) return nullptr;
+    bytes_allocated_ += end - offset_;
+    offset_ = end;
+    num_allocations_++;
+    num_live_++;
+    return reinterpret_cast<void *>(aligned);
+  };
+
+  // Blocks after the current one are kept from earlier cycles.
+  for (; current_ < blocks_.size(); current_++, offset_ = 0) {
+    if (void *p = carve()) return p;
+  }
+  const size_t size = std::max(block_size_, bytes + alignment);
+  blocks_.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+  return carve();
+}
+
+/* ************************************************************************* */
+void FactorArena::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (num_live_ > 0) {
+    throw std::runtime_error("FactorArena: reset with " +
+                             std::to_string(num_live_.load()) +
+                             " live allocations.");
+  }
+  current_ = 0;
+  offset_ = 0;
+  bytes_allocated_ = 0;
+  num_allocations_ = 0;
+}
+
+/* ************************************************************************* */
+size_t FactorArena::bytesReserved() const {
+  size_t bytes = 0;
+  for (auto &&block : blocks_) bytes += block.size;
+  return bytes;
+}
+
+/* ************************************************************************* */
+FactorArena::Scope::Scope(FactorArena *arena) : previous_(active_arena) {
+  active_arena = arena;
+}
+
+/* ************************************************************************* */
+FactorArena::Scope::~Scope() { active_arena = previous_; }
+
+/* ************************************************************************* */
+FactorArena *FactorArena::Active() { return active_arena; }
+
+}  // namespace gtdynamics
@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorArena.h
+ * @brief Arena allocation of the factors of a graph built per planning cycle.
+ */
+
+#pragma once
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * FactorArena is a monotonic memory region for the factors of a graph that
+ * is built and torn down every cycle, e.g., by a replanning loop. Factors
+ * are carved out of large blocks, freeing a factor only counts it as
+ * released, and reset() recycles all blocks at once for the next cycle, so
+ * a cycle's factors neither churn nor fragment the heap.
+ *
+ * Factor builders allocate from the arena of the Scope open on the calling
+ * thread, through MakeFactor, and from the heap otherwise. All factors
+ * allocated from an arena must be destroyed before it is reset or
+ * destroyed; reset() throws otherwise. Allocation is thread-safe.
+ */
+class FactorArena {
+ private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  size_t block_size_;
+  std::vector<Block> blocks_;
+  size_t current_ = 0, offset_ = 0;  // next free byte
+  size_t bytes_allocated_ = 0, num_allocations_ = 0;
+  std::atomic<size_t> num_live_{0};
+  std::mutex mutex_;
+
+ public:
+  /// Constructor, with the size in bytes of the blocks allocated on demand.
+  explicit FactorArena(size_t block_size = 1 << 20);
+
+  FactorArena(const FactorArena &) = delete;
+  FactorArena &operator=(const FactorArena &) = delete;
+
+  /// Return `bytes` bytes aligned to `alignment`, a power of two.
+  void *allocate(size_t bytes, size_t alignment);
+
+  /// Release an allocation; memory is only reclaimed by reset().
+  void deallocate(void *) { num_live_--; }
+
+  /// Recycle all blocks; throws if allocations are still live.
+  void reset();
+
+  /// Number of allocations not released yet.
+  size_t numLive() const { return num_live_; }
+
+  /// Number of allocations since the last reset.
+  size_t numAllocations() const { return num_allocations_; }
+
+  /// Bytes allocated since the last reset, with alignment padding.
+  size_t bytesAllocated() const { return bytes_allocated_; }
+
+  /// Bytes reserved in blocks, kept across resets.
+  size_t bytesReserved() const;
+
+  /**
+   * Makes an arena the one factor builders allocate from on this thread, or
+   * the heap if nullptr, e.g., to hand the caller's arena to worker tasks.
+   */
+  class Scope {
+   private:
+    FactorArena *previous_;
+
+   public:
+    explicit Scope(FactorArena *arena);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+
+  /// Return the arena of the innermost scope on this thread, or nullptr.
+  static FactorArena *Active();
+};
+
+/// Standard allocator drawing from a FactorArena.
+template <class T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  template <class U>
+  struct rebind {
+    using other = ArenaAllocator<U>;
+  };
+
+  explicit ArenaAllocator(FactorArena *arena) : arena_(arena) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena()) {}
+
+  T *allocate(size_t n) {
+    // At least the alignment of vectorized fixed-size Eigen members.
+    const size_t alignment = alignof(T) > 32 ? alignof(T) : 32;
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignment));
+  }
+  void deallocate(T *p, size_t) { arena_->deallocate(p); }
+
+  FactorArena *arena() const { return arena_; }
+
+  template <class U>
+  bool operator==(const ArenaAllocator<U> &other) const {
+    return arena_ == other.arena();
+  }
+  template <class U>
+  bool operator!=(const ArenaAllocator<U> &other) const {
+    return arena_ != other.arena();
+  }
+
+ private:
+  FactorArena *arena_;
+};
+
+/**
+ * Create a factor, with its shared_ptr control block, in the active arena if
+ * there is one, and as boost::make_shared otherwise.
+ */
+template <class T, class... Args>
+boost::shared_ptr<T> MakeFactor(Args &&... args) {
+  if (FactorArena *arena = FactorArena::Active()) {
+    return boost::allocate_shared<T>(ArenaAllocator<T>(arena),
+                                     std::forward<Args>(args)...);
+  }
+  return boost::make_shared<T>(std::forward<Args>(args)...);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FixedNumericalDerivative.h
+ * @brief Central-difference Jacobians with compile-time dimensions.
+ */
+
+#pragma once
+
+#include <gtsam/base/Manifold.h>
+#include <gtsam/base/Matrix.h>
+
+#include <boost/optional.hpp>
+#include <tuple>
+#include <type_traits>
+
+namespace gtdynamics {
+
+namespace internal {
+
+// Compile-time index sequences, as std::index_sequence in C++14.
+template <size_t... I>
+struct IndexSequence {};
+
+template <size_t N, size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct MakeIndexSequence<0, I...> {
+  typedef IndexSequence<I...> type;
+};
+
+// Call f with the elements of a tuple as arguments.
+template <class F, class TUPLE, size_t... I>
+auto Apply(const F &f, const TUPLE &args, IndexSequence<I...>)
+    -> decltype(f(std::get<I>(args)...)) {
+  return f(std::get<I>(args)...);
+}
+
+}  // namespace internal
+
+/// The type f returns when called with arguments of types X.
+template <class F, class... X>
+struct NumericalResultOf {
+  typedef typename std::decay<typename std::result_of<const F &(
+      const X &...)>::type>::type type;
+};
+
+/// The type of argument I of types X.
+template <size_t I, class... X>
+struct NumericalArgumentOf {
+  typedef typename std::tuple_element<I, std::tuple<X...>>::type type;
+};
+
+/// The Jacobian of the result of f with respect to argument I.
+template <size_t I, class F, class... X>
+struct FixedJacobianOf {
+  typedef typename NumericalResultOf<F, X...>::type Y;
+  typedef typename NumericalArgumentOf<I, X...>::type XI;
+  static constexpr int kRows = gtsam::traits<Y>::dimension;
+  static constexpr int kCols = gtsam::traits<XI>::dimension;
+  static_assert(kRows != Eigen::Dynamic && kCols != Eigen::Dynamic,
+                "FixedNumericalDerivative needs fixed-size types.");
+  typedef Eigen::Matrix<double, kRows, kCols> type;
+};
+
+/**
+ * Central-difference Jacobian of f with respect to its argument I, as
+ * gtsam::numericalDerivative* computes it, but with the dimensions of the
+ * result and of the argument known at compile time, so that the Jacobian and
+ * all temporaries are fixed-size Eigen matrices and nothing is allocated.
+ * f is called 2 * dim(X_I) times; it is any callable, taken by reference, so
+ * lambdas are inlined rather than wrapped in a std::function.
+ *
+ * The result and the arguments can be any types with gtsam::traits, e.g.
+ * double, fixed-size vectors and Pose3. Column j is the difference of
+ * Local(f(x), f(x_I + delta e_j)) and Local(f(x), f(x_I - delta e_j)),
+ * divided by 2 delta, with the perturbations applied by Retract.
+ *
+ * @param f      the function, callable as f(x...)
+ * @param delta  the perturbation of each coordinate
+ * @param x      the arguments at which to differentiate
+ */
+template <size_t I, class F, class... X>
+typename FixedJacobianOf<I, F, X...>::type FixedNumericalDerivative(
+    const F &f, double delta, const X &... x) {
+  typedef FixedJacobianOf<I, F, X...> Jacobian;
+  typedef typename Jacobian::Y Y;
+  typedef typename Jacobian::XI XI;
+  typedef typename internal::MakeIndexSequence<sizeof...(X)>::type Indices;
+  typedef Eigen::Matrix<double, Jacobian::kCols, 1> TangentX;
+
+  const Y hx = f(x...);
+  std::tuple<X...> args(x...);
+  const XI xi = std::get<I>(args);
+  typename Jacobian::type H;
+  TangentX dx = TangentX::Zero();
+  const double factor = 1.0 / (2.0 * delta);
+  for (int j = 0; j < Jacobian::kCols; j++) {
+    dx(j) = delta;
+    std::get<I>(args) = gtsam::traits<XI>::Retract(xi, dx);
+    const auto d_plus =
+        gtsam::traits<Y>::Local(hx, internal::Apply(f, args, Indices()));
+    dx(j) = -delta;
+    std::get<I>(args) = gtsam::traits<XI>::Retract(xi, dx);
+    const auto d_minus =
+        gtsam::traits<Y>::Local(hx, internal::Apply(f, args, Indices()));
+    dx(j) = 0;
+    H.col(j) = factor * (d_plus - d_minus);
+  }
+  return H;
+}
+
+/**
+ * Set an optional Jacobian of NoiseModelFactorN::evaluateError numerically,
+ * computing it only if it is requested, so a factor pays only for the blocks
+ * the optimizer asks for:
+ *
+ *   auto error = [this](double p, double v) -> gtsam::Vector1 {...};
+ *   NumericalJacobian<0>(H_p, error, p, v);
+ *   NumericalJacobian<1>(H_v, error, p, v);
+ *   return error(p, v);
+ *
+ * The Jacobian is computed with fixed sizes, see FixedNumericalDerivative,
+ * and only copied to the dynamic matrix of the factor interface.
+ */
+template <size_t I, class F, class... X>
+void NumericalJacobian(boost::optional<gtsam::Matrix &> H, const F &f,
+                       const X &... x) {
+  if (H) *H = FixedNumericalDerivative<I>(f, 1e-5, x...);
+}
+
+}  // namespace gtdynamics
@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/utils/ContentHasher.h>
 #include <gtdynamics/utils/FootContactConstraintSpec.h>
 
 #include <iostream>
@@ -28,6 +29,7 @@ FootContactConstraintSpec::FootContactConstraintSpec(
   for (auto &&point_on_link : points_on_links) {
     contact_points_.push_back(point_on_link);
   }
+  buildIndex();
 }
 
 FootContactConstraintSpec::FootContactConstraintSpec(
@@ -36,26 +38,31 @@ FootContactConstraintSpec::FootContactConstraintSpec(
   for (auto &&link : links) {
     contact_points_.emplace_back(link, contact_in_com);
   }
+  buildIndex();
+}
+
+void FootContactConstraintSpec::buildIndex() {
+  for (size_t i = 0; i < contact_points_.size(); i++) {
+    const LinkSharedPtr &link = contact_points_[i].link;
+    const size_t id = link->id();
+    if (id >= contact_index_.size()) contact_index_.resize(id + 1, -1);
+    if (contact_index_[id] < 0) contact_index_[id] = i;
+    contact_by_name_.emplace(link->name(), i);
+  }
 }
 
 bool FootContactConstraintSpec::hasContact(const LinkSharedPtr &link) const {
-  int link_count =
-      std::count_if(contact_points_.begin(), contact_points_.end(),
-                    [&](const PointOnLink &contact_point) {
-                      return contact_point.link->name() == link->name();
-                    });
-  return link_count > 0;
+  const size_t id = link->id();
+  return id < contact_index_.size() && contact_index_[id] >= 0 &&
+         contact_points_[contact_index_[id]].link->name() == link->name();
 }
 
 const gtsam::Point3 &FootContactConstraintSpec::contactPoint(const std::string &link_name) const {
-  auto it = std::find_if(contact_points_.begin(), contact_points_.end(),
-                          [&](const PointOnLink &contact_point) {
-                            return contact_point.link->name() == link_name;
-                          });
-  if (it == contact_points_.end())
+  auto it = contact_by_name_.find(link_name);
+  if (it == contact_by_name_.end())
     throw std::runtime_error("Link " + link_name + " has no contact point!");
   else
-    return (*it).point;
+    return contact_points_[it->second].point;
 }
 
 std::ostream &operator<<(std::ostream &os, const FootContactConstraintSpec &phase) {
@@ -130,4 +137,11 @@ ContactPointGoals FootContactConstraintSpec::updateContactPointGoals(
   return new_goals;
 }
 
+uint64_t FootContactConstraintSpec::contentHash() const {
+  return ContentHasher()
+      .add("FootContactConstraintSpec")
+      .add(ContentHashOf(contact_points_))
+      .value();
+}
+
 }  // namespace gtdynamics
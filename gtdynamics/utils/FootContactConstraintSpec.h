@@ -19,6 +19,8 @@
 #include <gtdynamics/utils/ConstraintSpec.h>
 
 #include <iosfwd>
+#include <unordered_map>
+#include <vector>
 
 namespace gtdynamics {
 /**
@@ -31,6 +33,14 @@ class FootContactConstraintSpec : public ConstraintSpec {
  protected:
   PointOnLinks contact_points_;  ///< Contact Points
 
+  /// Index of the first contact point on each link, by link id, -1 if none.
+  std::vector<int> contact_index_;
+  /// Index of the first contact point on each link, by link name.
+  std::unordered_map<std::string, size_t> contact_by_name_;
+
+  /// Build the indices from contact_points_.
+  void buildIndex();
+
  public:
   /// Constructor
   FootContactConstraintSpec() {};
@@ -55,10 +65,10 @@ class FootContactConstraintSpec : public ConstraintSpec {
   /// Returns all the contact points in the stance
   const PointOnLinks &contactPoints() const { return contact_points_; }
 
-  /// Check if phase has a contact for given link.
+  /// Check if phase has a contact for given link, in O(1).
   bool hasContact(const LinkSharedPtr &link) const;
 
-  /// Returns the contact point object of link.
+  /// Returns the contact point object of link, in O(1).
   const gtsam::Point3 &contactPoint(const std::string &link_name) const;
 
   /// Print to stream.
@@ -68,6 +78,9 @@ class FootContactConstraintSpec : public ConstraintSpec {
   /// GTSAM-style print, works with wrapper.
   void print(const std::string &s) const override;
 
+  /// Return a content hash of the contact points, see ContentHashOf.
+  uint64_t contentHash() const override;
+
   /**
    * Return PointGoalFactors for all feet as given in cp_goals.
    * @param[in] all_contact_points stance *and* swing feet.
@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GaitLibrary.cpp
+ * @brief Cached factor graph prototypes per contact pattern, for gaits.
+ */
+
+#include <gtdynamics/factors/TimeShiftedFactor.h>
+#include <gtdynamics/utils/GaitLibrary.h>
+#include <gtdynamics/utils/ParallelFor.h>
+
+#include <sstream>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+
+/* ************************************************************************* */
+GaitLibrary::GaitLibrary(const Robot &robot,
+                         const DynamicsGraph &graph_builder,
+                         CollocationScheme collocation, double mu)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      collocation_(collocation),
+      mu_(mu),
+      collocation_factors_(graph_builder.multiPhaseCollocationFactors(
+          robot, 0, 0, collocation)) {}
+
+/* ************************************************************************* */
+std::string GaitLibrary::Pattern(const PointOnLinks &contact_points) {
+  std::ostringstream ss;
+  ss.precision(17);
+  for (auto &&cp : contact_points) {
+    ss << cp.link->name() << "@" << cp.point.x() << "," << cp.point.y() << ","
+       << cp.point.z() << ";";
+  }
+  return ss.str();
+}
+
+/* ************************************************************************* */
+const NonlinearFactorGraph &GaitLibrary::prototype(
+    const PointOnLinks &contact_points) {
+  const std::string pattern = Pattern(contact_points);
+  auto it = slices_.find(pattern);
+  if (it == slices_.end()) {
+    it = slices_
+             .emplace(pattern, graph_builder_.dynamicsFactorGraph(
+                                   robot_, 0, contact_points, mu_))
+             .first;
+  }
+  return it->second;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph GaitLibrary::Stamp(const NonlinearFactorGraph &prototype,
+                                        int t, int phase) {
+  if (t == 0 && phase <= 0) return prototype;
+  NonlinearFactorGraph graph;
+  graph.reserve(prototype.size());
+  for (auto &&factor : prototype) {
+    if (factor) graph.emplace_shared<TimeShiftedFactor>(factor, t, phase);
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph GaitLibrary::slice(const PointOnLinks &contact_points,
+                                        int t) {
+  return Stamp(prototype(contact_points), t);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph GaitLibrary::multiPhaseFactorGraph(
+    const Trajectory &trajectory) {
+  const std::vector<int> phase_steps = trajectory.phaseDurations();
+  const auto &phase_cps = trajectory.phaseContactPoints();
+  const auto &transition_cps = trajectory.transitionContactPoints();
+  const int num_phases = phase_steps.size();
+
+  // Contact points of each time slice, the transition ones at the last step
+  // of all phases but the last, and the phase of each step.
+  std::vector<const PointOnLinks *> slice_cps(1, &phase_cps[0]);
+  std::vector<int> step_phases;
+  for (int p = 0; p < num_phases; p++) {
+    slice_cps.insert(slice_cps.end(), phase_steps[p] - 1, &phase_cps[p]);
+    slice_cps.push_back(p == num_phases - 1 ? &phase_cps[p]
+                                            : &transition_cps[p]);
+    step_phases.insert(step_phases.end(), phase_steps[p], p);
+  }
+
+  // Build missing prototypes first, so stamping only reads the cache.
+  std::vector<const NonlinearFactorGraph *> prototypes;
+  for (auto &&cps : slice_cps) prototypes.push_back(&prototype(*cps));
+
+  std::vector<NonlinearFactorGraph> slices(slice_cps.size());
+  ParallelFor(slices.size(),
+              [&](size_t k) { slices[k] = Stamp(*prototypes[k], k); });
+  std::vector<NonlinearFactorGraph> collocation_slices(step_phases.size());
+  ParallelFor(collocation_slices.size(), [&](size_t k) {
+    collocation_slices[k] = Stamp(collocation_factors_, k, step_phases[k]);
+  });
+
+  NonlinearFactorGraph graph;
+  for (auto &&slice : slices) graph.add(slice);
+  for (auto &&slice : collocation_slices) graph.add(slice);
+  return graph;
+}
+
+}  // namespace gtdynamics
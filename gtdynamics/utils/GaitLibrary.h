@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GaitLibrary.h
+ * @brief Cached factor graph prototypes per contact pattern, for gaits.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <map>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * GaitLibrary caches the dynamics factors of one time slice for each contact
+ * pattern, e.g. the stance feet of a trot or a tripod gait, and one set of
+ * collocation factors. Trajectories are then built by stamping the cached
+ * prototypes, with their noise models, at each time step through
+ * TimeShiftedFactor, so a new plan for a known gait creates no factors from
+ * the robot model.
+ *
+ * The graph of a trajectory is the same, up to the wrapping of factors, as
+ * Trajectory::multiPhaseFactorGraph with the same graph builder.
+ */
+class GaitLibrary {
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  CollocationScheme collocation_;
+  double mu_;
+  std::map<std::string, gtsam::NonlinearFactorGraph> slices_;  // at t = 0
+  gtsam::NonlinearFactorGraph collocation_factors_;  // at t = 0, phase 0
+
+  // Return the prototype slice of a contact pattern, building it if needed.
+  const gtsam::NonlinearFactorGraph &prototype(
+      const PointOnLinks &contact_points);
+
+  // Stamp a prototype at time step t, and phase if non-negative.
+  static gtsam::NonlinearFactorGraph Stamp(
+      const gtsam::NonlinearFactorGraph &prototype, int t, int phase = -1);
+
+ public:
+  /**
+   * Constructor.
+   * @param robot          the robot
+   * @param graph_builder  builder of the dynamics and collocation factors
+   * @param collocation    collocation scheme between time steps
+   * @param mu             coefficient of static friction
+   */
+  GaitLibrary(const Robot &robot, const DynamicsGraph &graph_builder,
+              CollocationScheme collocation, double mu);
+
+  /// Return a key that is equal for the same contact points, in order.
+  static std::string Pattern(const PointOnLinks &contact_points);
+
+  /// Return the number of cached contact patterns.
+  size_t numPatterns() const { return slices_.size(); }
+
+  /// Return the dynamics factors at time step t with the contact points.
+  gtsam::NonlinearFactorGraph slice(const PointOnLinks &contact_points,
+                                    int t);
+
+  /**
+   * Return the multi-phase factor graph of a trajectory, in the layout of
+   * DynamicsGraph::multiPhaseTrajectoryFG.
+   */
+  gtsam::NonlinearFactorGraph multiPhaseFactorGraph(
+      const Trajectory &trajectory);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HeightMap.cpp
+ * @brief Grid heightmap of the terrain with bilinear interpolation.
+ */
+
+#include <gtdynamics/utils/HeightMap.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+HeightMap::HeightMap(size_t nx, size_t ny, double x0, double y0,
+                     double resolution, double height)
+    : nx_(nx),
+      ny_(ny),
+      x0_(x0),
+      y0_(y0),
+      resolution_(resolution),
+      heights_(nx * ny, height) {
+  if (nx < 2 || ny < 2) {
+    throw std::invalid_argument("HeightMap: need at least 2x2 cells.");
+  }
+  if (!(resolution > 0)) {
+    throw std::invalid_argument("HeightMap: resolution must be positive.");
+  }
+}
+
+/* ************************************************************************* */
+HeightMap::HeightMap(const gtsam::Matrix &heights, double x0, double y0,
+                     double resolution)
+    : HeightMap(heights.cols(), heights.rows(), x0, y0, resolution) {
+  setPatch(0, 0, heights);
+}
+
+/* ************************************************************************* */
+void HeightMap::setHeight(size_t ix, size_t iy, double height) {
+  if (ix >= nx_ || iy >= ny_) {
+    throw std::out_of_range("HeightMap::setHeight: cell out of the map.");
+  }
+  heights_[iy * nx_ + ix] = height;
+}
+
+/* ************************************************************************* */
+void HeightMap::setPatch(size_t ix, size_t iy, const gtsam::Matrix &patch) {
+  if (ix + patch.cols() > nx_ || iy + patch.rows() > ny_) {
+    throw std::out_of_range("HeightMap::setPatch: patch out of the map.");
+  }
+  for (Eigen::Index r = 0; r < patch.rows(); r++) {
+    double *row = heights_.data() + (iy + r) * nx_ + ix;
+    for (Eigen::Index c = 0; c < patch.cols(); c++) row[c] = patch(r, c);
+  }
+}
+
+/* ************************************************************************* */
+// Return the cell below u, in grid units, and the fraction within it. Points
+// outside of the grid are clamped, and *inside is false for them.
+static size_t Cell(double u, size_t n, double *fraction, bool *inside) {
+  const double clamped = std::min(std::max(u, 0.0), double(n - 1));
+  *inside = (clamped == u);
+  const size_t i = std::min(size_t(clamped), n - 2);
+  *fraction = clamped - i;
+  return i;
+}
+
+/* ************************************************************************* */
+double HeightMap::height(double x, double y,
+                         gtsam::OptionalJacobian<1, 2> H) const {
+  double fx, fy;
+  bool inside_x, inside_y;
+  const size_t ix = Cell((x - x0_) / resolution_, nx_, &fx, &inside_x);
+  const size_t iy = Cell((y - y0_) / resolution_, ny_, &fy, &inside_y);
+
+  // The four corners are two pairs of adjacent doubles.
+  const double *row0 = heights_.data() + iy * nx_ + ix;
+  const double *row1 = row0 + nx_;
+  const double h00 = row0[0], h10 = row0[1], h01 = row1[0], h11 = row1[1];
+
+  const double bottom = h00 + fx * (h10 - h00);
+  const double top = h01 + fx * (h11 - h01);
+  if (H) {
+    const double dx = (1 - fy) * (h10 - h00) + fy * (h11 - h01);
+    const double dy = top - bottom;
+    *H << (inside_x ? dx / resolution_ : 0.0),
+        (inside_y ? dy / resolution_ : 0.0);
+  }
+  return bottom + fy * (top - bottom);
+}
+
+/* ************************************************************************* */
+gtsam::Vector3 HeightMap::normal(double x, double y) const {
+  gtsam::Matrix12 H;
+  height(x, y, H);
+  return gtsam::Vector3(-H(0), -H(1), 1).normalized();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HeightMap.h
+ * @brief Grid heightmap of the terrain with bilinear interpolation.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/base/Vector.h>
+
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * HeightMap is a regular grid of terrain heights z(x, y) in the world frame,
+ * with z up. Heights are stored contiguously, row-major with x along rows,
+ * and interpolated bilinearly between the four surrounding cells. Outside of
+ * the grid the height of the nearest border is used.
+ *
+ * Factors share one map through a HeightMapPtr, so many contact factors do
+ * not copy it, and updates made in place through setHeight or setPatch are
+ * seen by all of them. Updates are not synchronized with readers, so make
+ * them between optimizer iterations, not during a parallel linearization.
+ */
+class HeightMap {
+ private:
+  size_t nx_, ny_;
+  double x0_, y0_, resolution_;
+  std::vector<double> heights_;  // ny_ rows of nx_ heights
+
+ public:
+  /**
+   * Constructor, for a flat map.
+   * @param nx          number of cells along x, at least 2
+   * @param ny          number of cells along y, at least 2
+   * @param x0          x of the first cell
+   * @param y0          y of the first cell
+   * @param resolution  distance between cells
+   * @param height      initial height of all cells
+   */
+  HeightMap(size_t nx, size_t ny, double x0, double y0, double resolution,
+            double height = 0.0);
+
+  /**
+   * Constructor from a matrix of heights, heights(iy, ix) at
+   * (x0 + ix * resolution, y0 + iy * resolution).
+   */
+  HeightMap(const gtsam::Matrix &heights, double x0, double y0,
+            double resolution);
+
+  size_t nx() const { return nx_; }
+  size_t ny() const { return ny_; }
+  double resolution() const { return resolution_; }
+
+  /// Return the height of a cell.
+  double at(size_t ix, size_t iy) const { return heights_[iy * nx_ + ix]; }
+
+  /// Set the height of a cell in place.
+  void setHeight(size_t ix, size_t iy, double height);
+
+  /// Overwrite a block of cells in place, patch(r, c) goes to (ix + c, iy + r).
+  void setPatch(size_t ix, size_t iy, const gtsam::Matrix &patch);
+
+  /// Return the contiguous row-major heights, e.g. to fill from sensor data.
+  double *data() { return heights_.data(); }
+  const double *data() const { return heights_.data(); }
+
+  /**
+   * Return the interpolated height at (x, y).
+   * @param H optional gradient [dz/dx, dz/dy]
+   */
+  double height(double x, double y,
+                gtsam::OptionalJacobian<1, 2> H = boost::none) const;
+
+  /// Return the unit upward normal of the interpolated surface at (x, y).
+  gtsam::Vector3 normal(double x, double y) const;
+};
+
+/// Shared handle to a heightmap, updated in place for all its users.
+using HeightMapPtr = std::shared_ptr<HeightMap>;
+
+}  // namespace gtdynamics
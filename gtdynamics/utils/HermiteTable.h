@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HermiteTable.h
+ * @brief Tabulated functions of one variable, with analytic derivatives.
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * HermiteTable samples a smooth vector-valued function of one variable and
+ * its derivative on a uniform grid, and evaluates the cubic Hermite spline
+ * through the samples: a lookup and a few multiply-adds per evaluation, with
+ * a derivative that is exact for the spline. The interpolation error is
+ * O(h^4) in the grid spacing h, and the spline is exact for cubics.
+ *
+ * Use it to replace costly models in factors, built once when the first
+ * factor is constructed; evaluate outside [xMin(), xMax()] with the model.
+ */
+template <int N>
+class HermiteTable {
+ public:
+  typedef Eigen::Matrix<double, N, 1> VectorN;
+
+ private:
+  double x_min_ = 0, h_ = 1, h_inv_ = 1;
+  size_t num_intervals_ = 0;
+  // Values and derivatives scaled by h, at each node.
+  std::vector<VectorN, Eigen::aligned_allocator<VectorN>> values_, slopes_;
+
+ public:
+  /// Default constructor, an empty table.
+  HermiteTable() {}
+
+  /**
+   * Sample a function on num_intervals + 1 nodes in [x_min, x_max].
+   * @param function  callable as function(x, &derivative), returning the
+   *                  value at x and setting its derivative
+   */
+  template <class FUNCTION>
+  HermiteTable(double x_min, double x_max, size_t num_intervals,
+               FUNCTION &&function)
+      : x_min_(x_min),
+        h_((x_max - x_min) / num_intervals),
+        h_inv_(num_intervals / (x_max - x_min)),
+        num_intervals_(num_intervals) {
+    if (!(x_max > x_min) || num_intervals == 0) {
+      throw std::invalid_argument(
+          "HermiteTable: needs x_max > x_min and at least one interval.");
+    }
+    values_.resize(num_intervals + 1);
+    slopes_.resize(num_intervals + 1);
+    for (size_t i = 0; i <= num_intervals; i++) {
+      VectorN derivative;
+      values_[i] = function(x_min + i * h_, &derivative);
+      slopes_[i] = h_ * derivative;
+    }
+  }
+
+  /// Return the smallest tabulated argument.
+  double xMin() const { return x_min_; }
+
+  /// Return the largest tabulated argument.
+  double xMax() const { return x_min_ + num_intervals_ * h_; }
+
+  /// Return whether x is in the table.
+  bool contains(double x) const {
+    return num_intervals_ > 0 && x >= x_min_ && x <= xMax();
+  }
+
+  /**
+   * Evaluate the spline at x, clamped to the table.
+   * @param derivative  if given, set to the derivative of the spline at x
+   */
+  VectorN operator()(double x, VectorN *derivative = nullptr) const {
+    const double s = std::min(std::max((x - x_min_) * h_inv_, 0.0),
+                              double(num_intervals_));
+    const size_t i =
+        std::min(static_cast<size_t>(s), num_intervals_ - 1);
+    const double t = s - i, t2 = t * t, u = 1 - t;
+    if (derivative) {
+      *derivative = ((6 * t2 - 6 * t) * (values_[i] - values_[i + 1]) +
+                     (3 * t2 - 4 * t + 1) * slopes_[i] +
+                     (3 * t2 - 2 * t) * slopes_[i + 1]) *
+                    h_inv_;
+    }
+    return (1 + 2 * t) * u * u * values_[i] + t * u * u * slopes_[i] +
+           t2 * (3 - 2 * t) * values_[i + 1] - t2 * u * slopes_[i + 1];
+  }
+};
+
+}  // namespace gtdynamics
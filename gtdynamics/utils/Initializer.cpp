@@ -15,6 +15,9 @@
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/RandomStream.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Value.h>
 #include <gtsam/base/Vector.h>
@@ -22,6 +25,8 @@
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <algorithm>
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,24 +47,33 @@ Pose3 Initializer::AddGaussianNoiseToPose(const Pose3& T, const Sampler& sampler
   return T.expmap(xi);
 }
 
+// Normalized progress of each step of each segment, in the order of
+// InterpolatePoses; all segments start at t_i.
+static std::vector<std::vector<double>> SegmentProgress(
+    double t_i, const std::vector<double>& timesteps, double dt) {
+  std::vector<std::vector<double>> progress(timesteps.size());
+  for (size_t i = 0; i < timesteps.size(); i++) {
+    double t_f = timesteps[i];  // Final time for each step.
+    for (double t = t_i; t <= t_f; t += dt) {
+      progress[i].push_back((t - t_i) / (t_f - t_i));
+    }
+  }
+  return progress;
+}
+
 std::vector<Pose3> Initializer::InterpolatePoses(const Pose3& wTl_i,
                                     const std::vector<Pose3>& wTl_t, double t_i,
                                     const std::vector<double>& timesteps,
                                     double dt) {
+  const auto progress = SegmentProgress(t_i, timesteps, dt);
   std::vector<Pose3> wTl_dt;
   Pose3 wTl = wTl_i;
 
-  for (size_t i = 0; i < timesteps.size(); i++) {
-    double t_f = timesteps[i];  // Final time for each step.
-
-    for (double t = t_i; t <= t_f; t += dt) {
-      // Normalized phase progress.
-      double s = (t - t_i) / (t_f - t_i);
-
-      // Compute interpolated pose for link.
-      Pose3 wTl_s = gtsam::interpolate<Pose3>(wTl, wTl_t[i], s);
-
-      wTl_dt.push_back(wTl_s);
+  for (size_t i = 0; i < progress.size(); i++) {
+    // Same as gtsam::interpolate, with the logarithm computed once.
+    const gtsam::Vector6 xi = Pose3::Logmap(wTl.between(wTl_t[i]));
+    for (double s : progress[i]) {
+      wTl_dt.push_back(wTl.compose(Pose3::Expmap(s * xi)));
     }
     wTl = wTl_t[i];
   }
@@ -68,6 +82,57 @@ std::vector<Pose3> Initializer::InterpolatePoses(const Pose3& wTl_i,
   return wTl_dt;
 }
 
+gtsam::Matrix Initializer::InterpolatePosesBatch(
+    const Pose3& wTl_i, const std::vector<Pose3>& wTl_t, double t_i,
+    const std::vector<double>& timesteps, double dt) const {
+  const auto progress = SegmentProgress(t_i, timesteps, dt);
+  size_t num_steps = 1;
+  for (auto&& segment : progress) num_steps += segment.size();
+
+  gtsam::Matrix poses(12, num_steps);
+  Pose3 wTl = wTl_i;
+  size_t column = 0;
+  for (size_t i = 0; i < progress.size(); i++) {
+    const size_t n = progress[i].size();
+    const Eigen::Map<const Eigen::ArrayXd> s(progress[i].data(), n);
+
+    // R(s) = Ra (I + sin(s theta) K + (1 - cos(s theta)) K^2), with K the
+    // skew-symmetric matrix of the unit rotation axis, as outer products.
+    const gtsam::Matrix3 Ra = wTl.rotation().matrix();
+    const Vector3 omega = gtsam::Rot3::Logmap(
+        wTl.rotation().between(wTl_t[i].rotation()));
+    const double theta = omega.norm();
+    const gtsam::Matrix3 K =
+        theta > 1e-12 ? gtsam::Matrix3(gtsam::skewSymmetric(omega / theta))
+                      : gtsam::Matrix3::Zero();
+    const gtsam::Matrix3 RaK = Ra * K, RaK2 = RaK * K;
+    const Eigen::ArrayXd angles = theta * s;
+    const Eigen::Map<const gtsam::Vector9> ra(Ra.data()), rak(RaK.data()),
+        rak2(RaK2.data());
+
+    auto block = poses.middleCols(column, n);
+    block.topRows<9>() = ra.replicate(1, n) +
+                         rak * angles.sin().matrix().transpose() +
+                         rak2 * (1 - angles.cos()).matrix().transpose();
+
+    // Translations are interpolated linearly.
+    const Vector3 ta = wTl.translation();
+    block.bottomRows<3>() =
+        ta.replicate(1, n) +
+        (wTl_t[i].translation() - ta) * s.matrix().transpose();
+
+    column += n;
+    wTl = wTl_t[i];
+  }
+
+  // Add the final pose.
+  const Pose3& wTl_f = wTl_t.back();
+  poses.col(column) << Eigen::Map<const gtsam::Vector9>(
+      wTl_f.rotation().matrix().data()),
+      wTl_f.translation();
+  return poses;
+}
+
 Values Initializer::InitializePosesAndJoints(const Robot& robot, const Pose3& wTl_i,
                                 const std::vector<Pose3>& wTl_t,
                                 const std::string& link_name, double t_i,
@@ -109,8 +174,7 @@ Values Initializer::InitializeSolutionInterpolation(
     const Pose3& wTl_f, double T_s, double T_f, double dt,
     double gaussian_noise,
     const boost::optional<PointOnLinks>& contact_points) {
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
+  auto sampler_noise_model = InternedIsotropic(6, gaussian_noise);
   Sampler sampler(sampler_noise_model);
 
   // Initial and final discretized timesteps.
@@ -124,20 +188,23 @@ Values Initializer::InitializeSolutionInterpolation(
   // Initialize joint angles and velocities to 0.
   for (int t = n_steps_init; t <= n_steps_final; t++) {
     double s = (t_elapsed - T_s) / (T_f - T_s);
+    StepNoise step_noise(seed_, t, gaussian_noise);
 
     // Compute interpolated pose for link.
-    Pose3 wTl_t = AddGaussianNoiseToPose(
-        gtsam::interpolate<Pose3>(wTl_i, wTl_f, s), sampler);
+    Pose3 wTl_t = gtsam::interpolate<Pose3>(wTl_i, wTl_f, s)
+                      .expmap(seed_ ? step_noise.sample() : sampler.sample());
 
     // Compute forward dynamics to obtain remaining link poses.
     // TODO(Alejandro): forwardKinematics needs to get passed prev link twist
     for (auto&& joint : robot.joints()) {
-      InsertJointAngle(&init_vals, joint->id(), t, sampler.sample()[0]);
-      InsertJointVel(&init_vals, joint->id(), t, sampler.sample()[0]);
+      InsertJointAngle(&init_vals, joint->id(), t,
+                       seed_ ? step_noise.sample()[0] : sampler.sample()[0]);
+      InsertJointVel(&init_vals, joint->id(), t,
+                     seed_ ? step_noise.sample()[0] : sampler.sample()[0]);
     }
 
     auto link = robot.link(link_name);
-    if (link->isFixed()) {
+    if (robot.isFixed(link)) {
       throw std::invalid_argument("InitializeSolutionInterpolation: Link " +
                                   link_name + " is fixed.");
     }
@@ -177,17 +244,66 @@ Values Initializer::InitializeSolutionInterpolationMultiPhase(
   return init_vals;
 }
 
+// Solve the kinematics at time steps [0, num_steps), with the link at
+// wTl_dt[t]. Steps are split in chunks of chunk_size, or one chunk if zero,
+// solved concurrently. Within a chunk each step is seeded with the solution
+// of the previous step; the first step of a chunk is seeded with the initial
+// configuration, moved rigidly so the link is at wTl_dt[t].
+static std::vector<Values> SolveKinematicsChunks(
+    const Robot& robot, const std::string& link_name,
+    const std::vector<Pose3>& wTl_dt, const Values& seed,
+    const std::function<boost::optional<PointOnLinks>(int)>& contact_points,
+    size_t num_steps, size_t chunk_size) {
+  const DynamicsGraph dgb(Vector3(0, 0, -9.8));
+  const int link_id = robot.link(link_name)->id();
+  if (chunk_size == 0) chunk_size = std::max<size_t>(num_steps, 1);
+
+  std::vector<Values> results(num_steps);
+  const size_t num_chunks = (num_steps + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, [&](size_t c) {
+    const int t0 = c * chunk_size;
+    const int t1 = std::min(num_steps, (c + 1) * chunk_size);
+
+    Values values;
+    const Pose3 delta = wTl_dt[t0] * Pose(seed, link_id).inverse();
+    for (auto&& link : robot.links()) {
+      const Pose3 pose = Pose(seed, link->id());
+      InsertPose(&values, link->id(), t0, t0 == 0 ? pose : delta * pose);
+    }
+    for (auto&& joint : robot.joints()) {
+      InsertJointAngle(&values, joint->id(), t0, JointAngle(seed, joint->id()));
+    }
+
+    for (int t = t0; t < t1; t++) {
+      auto kfg = dgb.qFactors(robot, t, contact_points(t));
+      kfg.addPrior(PoseKey(link_id, t), wTl_dt[t], InternedIsotropic(6, 0.001));
+
+      gtsam::LevenbergMarquardtOptimizer optimizer(kfg, values);
+      results[t] = optimizer.optimize();
+
+      // Update initial values for next timestep.
+      values.clear();
+      for (auto&& link : robot.links()) {
+        InsertPose(&values, link->id(), t + 1,
+                   Pose(results[t], link->id(), t));
+      }
+      for (auto&& joint : robot.joints()) {
+        InsertJointAngle(&values, joint->id(), t + 1,
+                         JointAngle(results[t], joint->id(), t));
+      }
+    }
+  });
+  return results;
+}
+
 Values Initializer::InitializeSolutionInverseKinematics(
     const Robot& robot, const std::string& link_name, const Pose3& wTl_i,
     const std::vector<Pose3>& wTl_t, const std::vector<double>& timesteps,
     double dt, double gaussian_noise,
-    const boost::optional<PointOnLinks>& contact_points) {
+    const boost::optional<PointOnLinks>& contact_points, size_t chunk_size) {
   double t_i = 0.0;  // Time elapsed.
 
-  Vector3 gravity(0, 0, -9.8);
-
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
+  auto sampler_noise_model = InternedIsotropic(6, gaussian_noise);
   Sampler sampler(sampler_noise_model);
 
   // Link pose at each step
@@ -195,35 +311,21 @@ Values Initializer::InitializeSolutionInverseKinematics(
 
   // Iteratively solve the inverse kinematics problem while statisfying
   // the contact pose constraint.
-  Values init_vals,
-      values = InitializePosesAndJoints(robot, wTl_i, wTl_t, link_name, t_i,
-                                        timesteps, dt, sampler, &wTl_dt);
-
-  DynamicsGraph dgb(gravity);
-  for (int t = 0; t <= std::round(timesteps[timesteps.size() - 1] / dt); t++) {
-    auto kfg = dgb.qFactors(robot, t, contact_points);
-    kfg.addPrior(PoseKey(robot.link(link_name)->id(), t), wTl_dt[t],
-                 gtsam::noiseModel::Isotropic::Sigma(6, 0.001));
+  const Values values = InitializePosesAndJoints(
+      robot, wTl_i, wTl_t, link_name, t_i, timesteps, dt, sampler, &wTl_dt);
 
-    gtsam::LevenbergMarquardtOptimizer optimizer(kfg, values);
-    Values results = optimizer.optimize();
+  const int num_steps = std::round(timesteps[timesteps.size() - 1] / dt) + 1;
+  const std::vector<Values> results = SolveKinematicsChunks(
+      robot, link_name, wTl_dt, values,
+      [&](int) { return contact_points; }, num_steps, chunk_size);
 
+  Values init_vals;
+  for (int t = 0; t < num_steps; t++) {
     // Add zero initial values for remaining variables.
     init_vals.insert(ZeroValues(robot, t, gaussian_noise, contact_points));
 
     // Update with the results of the optimizer.
-    init_vals.update(results);
-
-    // Update initial values for next timestep.
-    values.clear();
-
-    for (auto&& link : robot.links()) {
-      InsertPose(&values, link->id(), t + 1, Pose(results, link->id(), t));
-    }
-    for (auto&& joint : robot.joints()) {
-      InsertJointAngle(&values, joint->id(), t + 1,
-                       JointAngle(results, joint->id(), t));
-    }
+    init_vals.update(results[t]);
   }
 
   return init_vals;
@@ -274,57 +376,36 @@ Values Initializer::MultiPhaseInverseKinematicsTrajectory(
     const std::vector<int>& phase_steps, const Pose3& wTl_i,
     const std::vector<Pose3>& wTl_t, const std::vector<double>& ts,
     std::vector<Values> transition_graph_init, double dt, double gaussian_noise,
-    const boost::optional<std::vector<PointOnLinks>>& phase_contact_points) {
+    const boost::optional<std::vector<PointOnLinks>>& phase_contact_points,
+    size_t chunk_size) {
   double t_i = 0;  // Time elapsed.
-  Vector3 gravity = (Vector(3) << 0, 0, -9.8).finished();
 
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
+  auto sampler_noise_model = InternedIsotropic(6, gaussian_noise);
   Sampler sampler(sampler_noise_model);
 
   std::vector<Pose3> wTl_dt;
 
   // Iteratively solve the inverse kinematics problem while statisfying
   // the contact pose constraint.
-  Values init_vals,
-      values = InitializePosesAndJoints(robot, wTl_i, wTl_t, link_name, t_i, ts,
-                                        dt, sampler, &wTl_dt);
-
-  DynamicsGraph dgb(gravity);
+  const Values values = InitializePosesAndJoints(
+      robot, wTl_i, wTl_t, link_name, t_i, ts, dt, sampler, &wTl_dt);
 
-  int t = 0;
+  // Phase of each time step, the last phase includes the final step.
+  std::vector<int> step_phases;
   int num_phases = phase_steps.size();
-
   for (int phase = 0; phase < num_phases; phase++) {
-    // In-phase.
     int curr_phase_steps =
         phase == (num_phases - 1) ? phase_steps[phase] + 1 : phase_steps[phase];
-    for (int phase_step = 0; phase_step < curr_phase_steps; phase_step++) {
-      auto kfg = dgb.qFactors(robot, t, (*phase_contact_points)[phase]);
-
-      kfg.addPrior(PoseKey(robot.link(link_name)->id(), t), wTl_dt[t],
-                   gtsam::noiseModel::Isotropic::Sigma(6, 0.001));
-
-      gtsam::LevenbergMarquardtOptimizer optimizer(kfg, values);
-      Values results = optimizer.optimize();
-
-      init_vals.insert(results);
+    step_phases.insert(step_phases.end(), curr_phase_steps, phase);
+  }
 
-      // Update initial values for next timestep.
-      values.clear();
-      for (auto&& link : robot.links()) {
-        int link_id = link->id();
-        InsertPose(&values, link_id, t + 1, Pose(results, link_id, t));
-      }
+  const std::vector<Values> results = SolveKinematicsChunks(
+      robot, link_name, wTl_dt, values,
+      [&](int t) { return (*phase_contact_points)[step_phases[t]]; },
+      step_phases.size(), chunk_size);
 
-      for (auto&& joint : robot.joints()) {
-        int joint_id = joint->id();
-        InsertJointAngle(&values, joint_id, t + 1,
-                         JointAngle(results, joint_id, t));
-      }
-      t++;
-    }
-  }
+  Values init_vals;
+  for (auto&& step_results : results) init_vals.insert(step_results);
 
   Values zero_values =
       MultiPhaseZeroValuesTrajectory(robot, phase_steps, transition_graph_init,
@@ -341,14 +422,12 @@ Values Initializer::ZeroValues(const Robot& robot, const int t, double gaussian_
                   const boost::optional<PointOnLinks>& contact_points) const{
   Values values;
 
-  auto sampler_noise_model =
-      gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
-  Sampler sampler(sampler_noise_model);
+  StepNoise sampler(seed_, t, gaussian_noise);
 
   // Initialize link dynamics to 0.
   for (auto&& link : robot.links()) {
     int i = link->id();
-    InsertPose(&values, i, t, AddGaussianNoiseToPose(link->bMcom(), sampler));
+    InsertPose(&values, i, t, link->bMcom().expmap(sampler.sample()));
     InsertTwist(&values, i, t, sampler.sample());
     InsertTwistAccel(&values, i, t, sampler.sample());
   }
@@ -22,6 +22,7 @@
 #include <gtsam/slam/PriorFactor.h>
 
 #include <boost/optional.hpp>
+#include <cstdint>
 #include <random>
 #include <string>
 #include <vector>
@@ -29,12 +30,25 @@
 namespace gtdynamics {
 
 class Initializer {
+ protected:
+    boost::optional<uint64_t> seed_;  // seed of the per-step noise streams
 
  public:
     
     // Default Constructor
     Initializer() {}
 
+    /**
+     * Constructor with a seed: the noise of the zero values and interpolated
+     * poses of time step t is drawn from RandomStream(seed, t), so it is
+     * reproducible however steps are split across threads, and independent
+     * between steps. Without a seed every step gets the same noise.
+     */
+    explicit Initializer(uint64_t seed) : seed_(seed) {}
+
+    /// Return the seed, if any.
+    const boost::optional<uint64_t>& seed() const { return seed_; }
+
     /**
      * Add zero-mean gaussian noise to a Pose3.
      *
@@ -58,6 +72,25 @@ class Initializer {
         const gtsam::Pose3& wTl_i, const std::vector<gtsam::Pose3>& wTl_t,
         double t_i, const std::vector<double>& timesteps, double dt);
 
+    /**
+     * Interpolate at the same steps as InterpolatePoses, into a contiguous
+     * 12 x N buffer with one column per step: the rotation matrix
+     * column-major, then the translation. Rotations are slerped and
+     * translations interpolated linearly, which differs from the screw
+     * motion of InterpolatePoses only in the path of the translation. Each
+     * segment is a few outer products, so long trajectories are cheap; see
+     * InsertPoses to insert the buffer into Values.
+     *
+     * @param wTl_i Initial pose of the link.
+     * @param wTl_t Vector of desired poses.
+     * @param t_i Initial time.
+     * @param timesteps Times at which poses start and end.
+     * @param dt The duration of a single timestep.
+     */
+    gtsam::Matrix InterpolatePosesBatch(
+        const gtsam::Pose3& wTl_i, const std::vector<gtsam::Pose3>& wTl_t,
+        double t_i, const std::vector<double>& timesteps, double dt) const;
+
     /**
      * Initialize the poses and joints needed to perform trajectory optimization.
      *
@@ -134,13 +167,18 @@ class Initializer {
      *      Noise drawn from a zero-mean gaussian distribution with a standard
      *      deviation of gaussian_noise.
      * @param[in] contact_points  PointOnLink objects.
+     * @param[in] chunk_size      If zero, solve the time steps in sequence,
+     *      each seeded with the previous solution. Otherwise solve chunks of
+     *      chunk_size steps concurrently, each chunk seeded with the initial
+     *      configuration moved to the link pose; 1 solves all steps at once.
      * @return Initial solution stored in gtsam::Values object.
      */
     gtsam::Values InitializeSolutionInverseKinematics(
         const Robot& robot, const std::string& link_name, const gtsam::Pose3& wTl_i,
         const std::vector<gtsam::Pose3>& wTl_t, const std::vector<double>& ts,
         double dt, double gaussian_noise = 1e-8,
-        const boost::optional<PointOnLinks>& contact_points = boost::none);
+        const boost::optional<PointOnLinks>& contact_points = boost::none,
+        size_t chunk_size = 0);
 
     /**
      * @fn Initialize solution for multi-phase trajectory to nominal pose.
@@ -176,6 +214,8 @@ class Initializer {
      *      Noise drawn from a zero-mean gaussian distribution with a standard
      *      deviation of gaussian_noise.
      * @param[in] phase_contact_points  Contact points at each phase.
+     * @param[in] chunk_size      Time steps per concurrent chunk, as in
+     *      InitializeSolutionInverseKinematics; zero solves them in sequence.
      * @return Initial solution stored in gtsam::Values object.
      */
     gtsam::Values MultiPhaseInverseKinematicsTrajectory(
@@ -185,7 +225,8 @@ class Initializer {
         std::vector<gtsam::Values> transition_graph_init, double dt_i = 1. / 240,
         double gaussian_noise = 1e-8,
         const boost::optional<std::vector<PointOnLinks>>& phase_contact_points =
-            boost::none);
+            boost::none,
+        size_t chunk_size = 0);
 
     /**
      * @fn Return zero values for all variables for initial value of optimization.
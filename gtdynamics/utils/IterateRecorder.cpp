@@ -0,0 +1,260 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IterateRecorder.cpp
+ * @brief Columnar recorder of optimizer iterates, with a binary dump format.
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/IterateRecorder.h>
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Values;
+
+static const char kMagic[8] = {'G', 'T', 'D', 'I', 'T', 'E', 'R', '\0'};
+static constexpr size_t kFixedHeaderSize = 32;
+static constexpr size_t kDataAlignment = 64;
+
+namespace {
+// Fixed part of the header, at offset 0.
+struct FixedHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_variables;
+  uint64_t num_iterates;
+  uint64_t data_offset;
+};
+static_assert(sizeof(FixedHeader) == kFixedHeaderSize,
+              "unexpected iterate file header size");
+
+template <typename T>
+const T *ValueAs(const gtsam::Value &value) {
+  const auto generic = dynamic_cast<const gtsam::GenericValue<T> *>(&value);
+  return generic ? &generic->value() : nullptr;
+}
+
+// Type and number of doubles of a value, type 0 if unsupported.
+char TypeOf(const gtsam::Value &value, uint32_t *dim) {
+  if (ValueAs<double>(value)) {
+    *dim = 1;
+    return 'd';
+  } else if (const auto *v = ValueAs<gtsam::Vector>(value)) {
+    *dim = v->size();
+    return 'v';
+  } else if (ValueAs<gtsam::Vector3>(value)) {
+    *dim = 3;
+    return 'v';
+  } else if (ValueAs<gtsam::Vector6>(value)) {
+    *dim = 6;
+    return 'v';
+  } else if (ValueAs<gtsam::Pose3>(value)) {
+    *dim = 12;
+    return 'p';
+  }
+  return 0;
+}
+
+// Copy the raw doubles of a value, return false if it has another type.
+bool CopyValue(const gtsam::Value &value, char type, uint32_t dim,
+               double *out) {
+  const double *data = nullptr;
+  if (type == 'd') {
+    data = ValueAs<double>(value);
+  } else if (type == 'v') {
+    if (const auto *v = ValueAs<gtsam::Vector>(value)) {
+      if (size_t(v->size()) == dim) data = v->data();
+    } else if (const auto *v3 = ValueAs<gtsam::Vector3>(value)) {
+      if (dim == 3) data = v3->data();
+    } else if (const auto *v6 = ValueAs<gtsam::Vector6>(value)) {
+      if (dim == 6) data = v6->data();
+    }
+  } else if (const auto *pose = ValueAs<gtsam::Pose3>(value)) {
+    const gtsam::Matrix3 R = pose->rotation().matrix();
+    std::memcpy(out, R.data(), 9 * sizeof(double));
+    std::memcpy(out + 9, pose->translation().data(), 3 * sizeof(double));
+    return true;
+  }
+  if (!data) return false;
+  std::memcpy(out, data, dim * sizeof(double));
+  return true;
+}
+}  // namespace
+
+/* ************************************************************************* */
+IterateRecorder::IterateRecorder(const Values &layout, size_t capacity) {
+  for (auto &&key_value : layout) {
+    uint32_t dim;
+    const char type = TypeOf(key_value.value, &dim);
+    if (!type) {
+      throw std::invalid_argument(
+          "IterateRecorder: unsupported value type for key " +
+          _GTDKeyFormatter(key_value.key));
+    }
+    indices_.emplace(key_value.key, keys_.size());
+    keys_.push_back(key_value.key);
+    types_.push_back(type);
+    dims_.push_back(dim);
+    offsets_.push_back(width_);
+    width_ += dim;
+  }
+  buffer_.reserve(capacity * width_);
+}
+
+/* ************************************************************************* */
+void IterateRecorder::record(const Values &values) {
+  buffer_.resize(buffer_.size() + width_);
+  double *row = buffer_.data() + num_iterates_ * width_;
+  for (size_t i = 0; i < keys_.size(); i++) {
+    const auto it = values.find(keys_[i]);
+    if (it == values.end() ||
+        !CopyValue(it->value, types_[i], dims_[i], row + offsets_[i])) {
+      buffer_.resize(num_iterates_ * width_);
+      throw std::invalid_argument("IterateRecorder::record: " +
+                                  _GTDKeyFormatter(keys_[i]) +
+                                  " is missing or has another type.");
+    }
+  }
+  num_iterates_++;
+}
+
+/* ************************************************************************* */
+size_t IterateRecorder::index(Key key) const {
+  const auto it = indices_.find(key);
+  if (it == indices_.end()) {
+    throw std::invalid_argument("IterateRecorder: " + _GTDKeyFormatter(key) +
+                                " is not recorded.");
+  }
+  return it->second;
+}
+
+/* ************************************************************************* */
+gtsam::Matrix IterateRecorder::history(Key key) const {
+  const size_t i = index(key);
+  return Eigen::Map<const gtsam::Matrix>(buffer_.data(), width_, num_iterates_)
+      .middleRows(offsets_[i], dims_[i]);
+}
+
+/* ************************************************************************* */
+void IterateRecorder::save(const std::string &name) const {
+  const size_t V = keys_.size();
+
+  // Variable part of the header.
+  std::string header(kFixedHeaderSize, '\0');
+  for (Key key : keys_) {
+    const uint64_t k = key;
+    header.append(reinterpret_cast<const char *>(&k), sizeof(k));
+  }
+  header.append(reinterpret_cast<const char *>(dims_.data()),
+                V * sizeof(uint32_t));
+  header.append(types_);
+  const size_t padding =
+      (kDataAlignment - header.size() % kDataAlignment) % kDataAlignment;
+  header.append(padding, '\0');
+
+  FixedHeader fixed;
+  std::memcpy(fixed.magic, kMagic, sizeof(kMagic));
+  fixed.version = kIterateFileVersion;
+  fixed.num_variables = V;
+  fixed.num_iterates = num_iterates_;
+  fixed.data_offset = header.size();
+  std::memcpy(&header[0], &fixed, sizeof(fixed));
+
+  std::ofstream file(name, std::ios::binary);
+  file.write(header.data(), header.size());
+  file.write(reinterpret_cast<const char *>(buffer_.data()),
+             num_iterates_ * width_ * sizeof(double));
+  if (!file) {
+    throw std::runtime_error("IterateRecorder::save: could not write " +
+                             name);
+  }
+}
+
+/* ************************************************************************* */
+IterateFile::IterateFile(const std::string &name) {
+  const int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("IterateFile: could not open " + name);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || size_t(st.st_size) < kFixedHeaderSize) {
+    ::close(fd);
+    throw std::runtime_error("IterateFile: " + name + " is too short.");
+  }
+  size_ = st.st_size;
+  data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // the mapping stays valid
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    throw std::runtime_error("IterateFile: could not map " + name);
+  }
+
+  // Unmap if the header is invalid, as the destructor will not run.
+  auto fail = [&](const std::string &what) {
+    ::munmap(data_, size_);
+    throw std::runtime_error("IterateFile: " + name + " " + what);
+  };
+
+  const char *bytes = static_cast<const char *>(data_);
+  FixedHeader fixed;
+  std::memcpy(&fixed, bytes, sizeof(fixed));
+  if (std::memcmp(fixed.magic, kMagic, sizeof(kMagic)) != 0) {
+    fail("is not an iterate file.");
+  }
+  if (fixed.version != kIterateFileVersion) {
+    fail("has an unsupported version.");
+  }
+  const size_t V = fixed.num_variables;
+  if (fixed.data_offset % kDataAlignment != 0 || fixed.data_offset > size_ ||
+      kFixedHeaderSize + V * (sizeof(uint64_t) + sizeof(uint32_t) + 1) >
+          fixed.data_offset) {
+    fail("is truncated or corrupt.");
+  }
+
+  const char *p = bytes + kFixedHeaderSize;
+  keys_.resize(V);
+  dims_.resize(V);
+  for (size_t i = 0; i < V; i++, p += sizeof(uint64_t)) {
+    uint64_t k;
+    std::memcpy(&k, p, sizeof(k));
+    keys_[i] = k;
+  }
+  std::memcpy(dims_.data(), p, V * sizeof(uint32_t));
+  p += V * sizeof(uint32_t);
+  types_.assign(p, V);
+  for (uint32_t dim : dims_) {
+    offsets_.push_back(width_);
+    width_ += dim;
+  }
+
+  num_iterates_ = fixed.num_iterates;
+  if (width_ > 0 && (size_ - fixed.data_offset) / sizeof(double) / width_ <
+                        num_iterates_) {
+    fail("is truncated or corrupt.");
+  }
+  iterates_ = reinterpret_cast<const double *>(bytes + fixed.data_offset);
+}
+
+/* ************************************************************************* */
+IterateFile::~IterateFile() {
+  if (data_) ::munmap(data_, size_);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,173 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  IterateRecorder.h
+ * @brief Columnar recorder of optimizer iterates, with a binary dump format.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Iterate files store the iterates of a set of variables, each iterate as one
+ * contiguous row of raw doubles, so that the visualization tools can map the
+ * file and read any iterate or variable history lazily. A variable is stored
+ * by type: 'd' double as 1 double, 'v' vector as its entries, and 'p' Pose3
+ * as its rotation matrix column-major then its translation, 12 doubles. The
+ * layout, in host byte order (little-endian on all supported platforms), is:
+ *
+ *   offset  size         contents
+ *   0       8            magic "GTDITER\0"
+ *   8       4            uint32 version, 1
+ *   12      4            uint32 number of variables V
+ *   16      8            uint64 number of iterates N
+ *   24      8            uint64 byte offset of the data, a multiple of 64
+ *   32      8 V          uint64 key of each variable
+ *   ...     4 V          uint32 number of doubles of each variable
+ *   ...     V            char type of each variable, then zero padding
+ *   offset  8 N D        double data, row-major N x D with D the sum of the
+ *                        numbers of doubles
+ */
+static constexpr uint32_t kIterateFileVersion = 1;
+
+/**
+ * IterateRecorder records the values of a fixed set of variables at each
+ * iteration into one preallocated buffer of raw doubles, rather than one heap
+ * object per variable and iteration as StorageManager does. Variables are
+ * indexed in the order of the layout Values, which stays the same for the
+ * whole recording.
+ */
+class IterateRecorder {
+ private:
+  std::vector<gtsam::Key> keys_;
+  std::string types_;
+  std::vector<uint32_t> dims_;
+  std::vector<size_t> offsets_;  // of each variable in an iterate
+  std::unordered_map<gtsam::Key, size_t> indices_;
+  size_t width_ = 0, num_iterates_ = 0;
+  std::vector<double> buffer_;
+
+ public:
+  /**
+   * Constructor.
+   * @param layout    values of the variables to record, e.g. the initial
+   *                  values; only their keys and types are used
+   * @param capacity  number of iterates to preallocate for
+   * Throws std::invalid_argument for values other than double, Vector,
+   * Vector3, Vector6 and Pose3.
+   */
+  explicit IterateRecorder(const gtsam::Values &layout, size_t capacity = 0);
+
+  /**
+   * Append the values of the recorded variables as the next iterate. Other
+   * values are ignored. Throws std::invalid_argument if a recorded variable
+   * is missing or has another type.
+   */
+  void record(const gtsam::Values &values);
+
+  /// Return the number of variables.
+  size_t numVariables() const { return keys_.size(); }
+
+  /// Return the number of recorded iterates.
+  size_t numIterates() const { return num_iterates_; }
+
+  /// Return the number of doubles of an iterate.
+  size_t width() const { return width_; }
+
+  /// Return the keys of the variables, by index.
+  const std::vector<gtsam::Key> &keys() const { return keys_; }
+
+  /// Return the index of a variable. Throws std::invalid_argument if absent.
+  size_t index(gtsam::Key key) const;
+
+  /// Return iterate k, as width() doubles.
+  Eigen::Map<const gtsam::Vector> iterate(size_t k) const {
+    return Eigen::Map<const gtsam::Vector>(buffer_.data() + k * width_,
+                                           width_);
+  }
+
+  /**
+   * Return the history of a variable, one column of raw doubles per
+   * iterate.
+   */
+  gtsam::Matrix history(gtsam::Key key) const;
+
+  /// Write the recorded iterates to an iterate file.
+  void save(const std::string &name) const;
+};
+
+/**
+ * IterateFile maps an iterate file in memory, read-only. The data accessors
+ * return Eigen maps into the mapping, valid as long as the IterateFile is
+ * alive.
+ */
+class IterateFile {
+ public:
+  using StridedMatrixMap =
+      Eigen::Map<const gtsam::Matrix, 0, Eigen::OuterStride<>>;
+  using ConstVectorMap = Eigen::Map<const gtsam::Vector>;
+
+ private:
+  void *data_ = nullptr;
+  size_t size_ = 0;
+  size_t width_ = 0, num_iterates_ = 0;
+  const double *iterates_ = nullptr;
+  std::vector<gtsam::Key> keys_;
+  std::string types_;
+  std::vector<uint32_t> dims_;
+  std::vector<size_t> offsets_;
+
+ public:
+  /// Constructor, maps the file. Throws std::runtime_error if it is invalid.
+  explicit IterateFile(const std::string &name);
+
+  ~IterateFile();
+
+  IterateFile(const IterateFile &) = delete;
+  IterateFile &operator=(const IterateFile &) = delete;
+
+  /// Return the keys of the variables, by index.
+  const std::vector<gtsam::Key> &keys() const { return keys_; }
+
+  /// Return the type of each variable, 'd', 'v' or 'p'.
+  const std::string &types() const { return types_; }
+
+  /// Return the number of doubles of each variable.
+  const std::vector<uint32_t> &dims() const { return dims_; }
+
+  /// Return the number of iterates.
+  size_t numIterates() const { return num_iterates_; }
+
+  /// Return iterate k.
+  ConstVectorMap iterate(size_t k) const {
+    return ConstVectorMap(iterates_ + k * width_, width_);
+  }
+
+  /**
+   * Return the history of variable i, its dims()[i] rows of each iterate.
+   * Rows of the map are strided by the width of an iterate.
+   */
+  StridedMatrixMap history(size_t i) const {
+    return StridedMatrixMap(iterates_ + offsets_.at(i), dims_.at(i),
+                            num_iterates_, Eigen::OuterStride<>(width_));
+  }
+};
+
+}  // namespace gtdynamics
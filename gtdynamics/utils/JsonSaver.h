@@ -17,6 +17,8 @@
 #include <gtdynamics/factors/WrenchFactor.h>
 #include <gtdynamics/factors/WrenchPlanarFactor.h>
 #include <gtdynamics/universal_robot/Joint.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/ParallelFor.h>
 #include <gtdynamics/utils/utils.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
@@ -28,10 +30,13 @@
 
 #include <boost/format.hpp>
 #include <boost/optional.hpp>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <typeinfo>
 #include <utility>
@@ -41,6 +46,58 @@
 
 // using namespace gtdynamics;
 namespace gtdynamics {
+/**
+ * @brief
+ * Write nested json lists straight to an output stream, in the layout of
+ * JsonSaver::JsonList with no indent. Only the item being written is held in
+ * memory, so large graphs can be saved without building the whole string.
+ * Compression is up to the stream, e.g. a boost::iostreams gzip filter.
+ */
+class JsonStreamWriter {
+ public:
+  /**
+   * @brief constructor
+   * @param[in] stm           output stream
+   */
+  explicit JsonStreamWriter(std::ostream& stm) : stm_(stm) {}
+
+  /**
+   * @brief open a list, as an item of the enclosing list if any
+   */
+  void beginList() {
+    separate();
+    stm_ << "[";
+    empty_.push_back(true);
+  }
+
+  /**
+   * @brief close the innermost list
+   */
+  void endList() {
+    empty_.pop_back();
+    stm_ << "\n]";
+  }
+
+  /**
+   * @brief start an item of the innermost list
+   * @return                  the stream to write the item to
+   */
+  std::ostream& item() {
+    separate();
+    return stm_;
+  }
+
+ private:
+  std::ostream& stm_;
+  std::vector<bool> empty_;  // whether each open list has no items yet
+
+  void separate() {
+    if (empty_.empty()) return;
+    stm_ << (empty_.back() ? "\n" : ",\n");
+    empty_.back() = false;
+  }
+};
+
 /**
  * @brief
  * Store optimization results history, export factor graph in json format. The
@@ -127,6 +184,22 @@ class JsonSaver {
     return s;
   }
 
+  /**
+   * @brief write key value pairs as a dict to a stream, in the layout of
+   * JsonDict with no indent
+   * @param[in] stm           output stream
+   * @param[in] items         key value paris
+   */
+  static inline void WriteDict(std::ostream& stm,
+                               const std::vector<AttributeType>& items) {
+    stm << "{";
+    for (size_t i = 0; i < items.size(); i++) {
+      stm << "\n" << items[i].first << ":" << items[i].second
+          << (i + 1 < items.size() ? "," : "");
+    }
+    stm << "\n}";
+  }
+
   /**
    * @brief combine items into a list in json format
    * @param[in] items         vector of items
@@ -345,15 +418,15 @@ class JsonSaver {
   }
 
   /**
-   * @brief get the variable in json format as a string
+   * @brief get the attributes of the variable
    * @param[in] key           corresponding key of variable
    * @param[in] values        values
    * @param[in] locations     locations
-   * @return                  a string displaying the variable in json
+   * @return                  the attributes of the variable in json
    */
-  static inline std::string GetVariable(const gtsam::Key& key,
-                                        const gtsam::Values& values,
-                                        const LocationType& locations) {
+  static inline std::vector<AttributeType> GetVariableAttributes(
+      const gtsam::Key& key, const gtsam::Values& values,
+      const LocationType& locations) {
     std::vector<AttributeType> attributes;
 
     // name;
@@ -372,19 +445,32 @@ class JsonSaver {
         attributes.emplace_back(Quoted("location"), loc_str);
       }
     }
-    return JsonDict(attributes);
+    return attributes;
   }
 
   /**
-   * @brief get the factor in json format as a string
+   * @brief get the variable in json format as a string
+   * @param[in] key           corresponding key of variable
+   * @param[in] values        values
+   * @param[in] locations     locations
+   * @return                  a string displaying the variable in json
+   */
+  static inline std::string GetVariable(const gtsam::Key& key,
+                                        const gtsam::Values& values,
+                                        const LocationType& locations) {
+    return JsonDict(GetVariableAttributes(key, values, locations));
+  }
+
+  /**
+   * @brief get the attributes of the factor
    * @param[in] idx           index of factor
    * @param[in] graph         factor graph
    * @param[in] values        values
-   * @return                  a string displaying the factor in json
+   * @return                  the attributes of the factor in json
    */
-  static inline std::string GetFactor(const size_t idx,
-                                      const gtsam::NonlinearFactorGraph& graph,
-                                      const gtsam::Values& values) {
+  static inline std::vector<AttributeType> GetFactorAttributes(
+      const size_t idx, const gtsam::NonlinearFactorGraph& graph,
+      const gtsam::Values& values) {
     const gtsam::NonlinearFactor::shared_ptr& factor = graph.at(idx);
 
     std::vector<AttributeType> attributes;
@@ -420,11 +506,25 @@ class JsonSaver {
     // error
     attributes.emplace_back(Quoted("error"), GetError(factor, values));
 
-    return JsonDict(attributes);
+    return attributes;
   }
 
   /**
-   * @brief output the json format factor graph to ostream
+   * @brief get the factor in json format as a string
+   * @param[in] idx           index of factor
+   * @param[in] graph         factor graph
+   * @param[in] values        values
+   * @return                  a string displaying the factor in json
+   */
+  static inline std::string GetFactor(const size_t idx,
+                                      const gtsam::NonlinearFactorGraph& graph,
+                                      const gtsam::Values& values) {
+    return JsonDict(GetFactorAttributes(idx, graph, values));
+  }
+
+  /**
+   * @brief output the json format factor graph to ostream, one variable or
+   * factor at a time
    * @param[in] graph         gtsam factor graph
    * @param[in] stm           output stream
    * @param[in] values        gtsam values of variables
@@ -435,24 +535,170 @@ class JsonSaver {
       const gtsam::NonlinearFactorGraph& graph, std::ostream& stm,
       const gtsam::Values& values = gtsam::Values(),
       const LocationType& locations = LocationType()) {
-    std::vector<std::string> variable_strings;
-    std::vector<std::string> factor_strings;
+    JsonStreamWriter writer(stm);
+    writer.beginList();
 
     // add variables
+    writer.beginList();
     for (gtsam::Key key : graph.keys()) {
-      variable_strings.push_back(GetVariable(key, values, locations));
+      WriteDict(writer.item(), GetVariableAttributes(key, values, locations));
     }
+    writer.endList();
 
     // add factors
+    writer.beginList();
     for (size_t i = 0; i < graph.size(); ++i) {
-      factor_strings.push_back(GetFactor(i, graph, values));
+      WriteDict(writer.item(), GetFactorAttributes(i, graph, values));
     }
+    writer.endList();
+
+    writer.endList();
+  }
 
-    std::string s_variables = JsonList(variable_strings);
-    std::string s_factors = JsonList(factor_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonList(all_strings);
-    stm << s_all;
+  /**
+   * @brief get the time step of the slice a factor belongs to, the earliest
+   * time step of its variables
+   * @param[in] factor        gtsam factor pointer
+   * @return                  the time step
+   */
+  static inline int GetSlice(
+      const gtsam::NonlinearFactor::shared_ptr& factor) {
+    int t = 0;
+    bool first = true;
+    for (gtsam::Key key : factor->keys()) {
+      const int time = DynamicsSymbol(key).time();
+      t = first ? time : std::min(t, time);
+      first = false;
+    }
+    return t;
+  }
+
+  /**
+   * @brief save a factor graph of many time steps for level-of-detail
+   * viewing: an index with one summary per slice, and one chunk per slice
+   * with its factors in detail, loaded on demand by the visualizer.
+   *
+   * <directory>/index.json is a list of dicts with attributes [name, time,
+   * chunk, num_variables, num_factors, error, max_error, types, neighbors],
+   * where types counts the factors of each type and neighbors are the
+   * slices sharing a factor with this one. <directory>/slice_<t>.json has
+   * the layout of SaveFactorGraph, with the factors of slice t and all their
+   * variables. A factor belongs to the slice of its earliest variable, see
+   * GetSlice, and keeps its name in the whole graph. Chunks are written
+   * concurrently; the directory must exist.
+   * @param[in] directory     directory to write the files to
+   * @param[in] graph         gtsam factor graph
+   * @param[in] values        gtsam values of all variables
+   * @param[in] locations     locations of the variables of each slice
+   */
+  static inline void SaveSlicedGraph(
+      const std::string& directory, const gtsam::NonlinearFactorGraph& graph,
+      const gtsam::Values& values,
+      const std::map<int, LocationType>& locations =
+          std::map<int, LocationType>()) {
+    // Group the factors and variables by slice.
+    std::map<int, std::vector<size_t>> slice_factors;
+    std::map<int, size_t> slice_variables;
+    for (size_t i = 0; i < graph.size(); i++) {
+      if (graph[i]) slice_factors[GetSlice(graph[i])].push_back(i);
+    }
+    for (gtsam::Key key : graph.keys()) {
+      slice_variables[DynamicsSymbol(key).time()]++;
+    }
+    const std::vector<std::pair<int, std::vector<size_t>>> slices(
+        slice_factors.begin(), slice_factors.end());
+
+    auto check = [&](const std::ofstream& file, const std::string& name) {
+      if (!file) {
+        throw std::runtime_error("JsonSaver: cannot write " + directory +
+                                 "/" + name);
+      }
+    };
+    auto chunk = [](int t) -> std::string {
+      return "slice_" + std::to_string(t) + ".json";
+    };
+
+    // The summaries, computed concurrently with the chunks of detail.
+    const LocationType no_locations;
+    std::vector<std::string> summaries(slices.size());
+    ParallelFor(slices.size(), [&](size_t s) {
+      const int t = slices[s].first;
+      const std::vector<size_t>& factors = slices[s].second;
+      const auto location = locations.find(t);
+      const LocationType& slice_locations =
+          location == locations.end() ? no_locations : location->second;
+
+      double error = 0, max_error = 0;
+      std::map<std::string, size_t> types;
+      std::set<int> neighbors;
+      gtsam::KeySet keys;
+      for (size_t i : factors) {
+        const double e = graph[i]->error(values);
+        error += e;
+        max_error = std::max(max_error, e);
+        types[GetType(graph[i])]++;
+        for (gtsam::Key key : graph[i]->keys()) {
+          keys.insert(key);
+          const int time = DynamicsSymbol(key).time();
+          if (time != t) neighbors.insert(time);
+        }
+      }
+
+      std::ofstream file(directory + "/" + chunk(t));
+      check(file, chunk(t));
+      JsonStreamWriter writer(file);
+      writer.beginList();
+      writer.beginList();
+      for (gtsam::Key key : keys) {
+        WriteDict(writer.item(),
+                  GetVariableAttributes(key, values, slice_locations));
+      }
+      writer.endList();
+      writer.beginList();
+      for (size_t i : factors) {
+        WriteDict(writer.item(), GetFactorAttributes(i, graph, values));
+      }
+      writer.endList();
+      writer.endList();
+
+      std::vector<AttributeType> type_counts;
+      for (auto&& type : types) {
+        type_counts.emplace_back(Quoted(type.first),
+                                 std::to_string(type.second));
+      }
+      std::vector<std::string> neighbor_times;
+      for (int n : neighbors) neighbor_times.push_back(std::to_string(n));
+      const auto num_variables = slice_variables.find(t);
+
+      std::vector<AttributeType> attributes;
+      attributes.emplace_back(Quoted("name"),
+                              Quoted("slice" + std::to_string(t)));
+      attributes.emplace_back(Quoted("time"), std::to_string(t));
+      attributes.emplace_back(Quoted("chunk"), Quoted(chunk(t)));
+      attributes.emplace_back(
+          Quoted("num_variables"),
+          std::to_string(num_variables == slice_variables.end()
+                             ? 0
+                             : num_variables->second));
+      attributes.emplace_back(Quoted("num_factors"),
+                              std::to_string(factors.size()));
+      attributes.emplace_back(Quoted("error"), std::to_string(error));
+      attributes.emplace_back(Quoted("max_error"), std::to_string(max_error));
+      attributes.emplace_back(Quoted("types"), JsonDict(type_counts, -1));
+      attributes.emplace_back(
+          Quoted("neighbors"),
+          neighbor_times.empty() ? "[]" : JsonList(neighbor_times, -1));
+      std::stringstream ss;
+      WriteDict(ss, attributes);
+      summaries[s] = ss.str();
+    });
+
+    std::ofstream index(directory + "/index.json");
+    check(index, "index.json");
+    JsonStreamWriter writer(index);
+    writer.beginList();
+    for (const std::string& summary : summaries) writer.item() << summary;
+    writer.endList();
   }
 
   /**
@@ -513,10 +759,11 @@ class JsonSaver {
       }
     }
 
-    std::vector<std::string> values_strings;
-    std::vector<std::string> graphs_strings;
+    JsonStreamWriter writer(stm);
+    writer.beginList();
 
     // add clustered values
+    writer.beginList();
     for (const auto& it : clustered_values) {
       std::string cluster_name = it.first;
       const gtsam::Values& values = it.second;
@@ -538,10 +785,12 @@ class JsonSaver {
       }
       attributes.emplace_back(JsonSaver::Quoted("value"),
                               Quoted(JsonList(varaible_names, -1)));
-      values_strings.emplace_back(JsonDict(attributes));
+      WriteDict(writer.item(), attributes);
     }
+    writer.endList();
 
     // add clustered graphs
+    writer.beginList();
     for (const auto& it : clustered_graphs) {
       std::string cluster_name = it.first;
       const gtsam::NonlinearFactorGraph& graph = it.second;
@@ -578,14 +827,11 @@ class JsonSaver {
         attributes.emplace_back(Quoted("location"), loc_str);
       }
 
-      graphs_strings.emplace_back(JsonDict(attributes));
+      WriteDict(writer.item(), attributes);
     }
+    writer.endList();
 
-    std::string s_variables = JsonList(values_strings);
-    std::string s_factors = JsonList(graphs_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonList(all_strings);
-    stm << s_all;
+    writer.endList();
   }
 };
 
@@ -667,24 +913,25 @@ class StorageManager {
       const gtsam::NonlinearFactorGraph& graph, std::ostream& stm,
       const gtsam::Values& values = gtsam::Values(),
       const JsonSaver::LocationType& locations = JsonSaver::LocationType()) {
-    std::vector<std::string> variable_strings;
-    std::vector<std::string> factor_strings;
+    JsonStreamWriter writer(stm);
+    writer.beginList();
 
     // add variables
+    writer.beginList();
     for (gtsam::Key key : graph.keys()) {
-      variable_strings.push_back(GetVariableSequence(key, locations));
+      writer.item() << GetVariableSequence(key, locations);
     }
+    writer.endList();
 
     // add factors
+    writer.beginList();
     for (size_t i = 0; i < graph.size(); ++i) {
-      factor_strings.push_back(JsonSaver::GetFactor(i, graph, values));
+      JsonSaver::WriteDict(writer.item(),
+                           JsonSaver::GetFactorAttributes(i, graph, values));
     }
+    writer.endList();
 
-    std::string s_variables = JsonSaver::JsonList(variable_strings);
-    std::string s_factors = JsonSaver::JsonList(factor_strings);
-    std::vector<std::string> all_strings{s_variables, s_factors};
-    std::string s_all = JsonSaver::JsonList(all_strings);
-    stm << s_all;
+    writer.endList();
   }
 
   /**
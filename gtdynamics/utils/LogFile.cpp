@@ -0,0 +1,304 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LogFile.cpp
+ * @brief Columnar binary sensor and trajectory logs, memory-mapped for
+ * reading, and factor builders consuming them in bulk.
+ */
+
+#include <gtdynamics/factors/JointMeasurementFactor.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/LogFile.h>
+#include <gtdynamics/utils/values.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+static const char kLogMagic[8] = {'G', 'T', 'D', 'L', 'O', 'G', '\0', '\0'};
+static constexpr size_t kLogHeaderSize = 32;
+static constexpr size_t kLogChannelSize = 16;
+static constexpr size_t kLogAlignment = 64;
+
+namespace {
+// Fixed part of the header, at offset 0.
+struct LogHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_channels;
+  uint64_t num_rows;
+  uint64_t table_offset;
+};
+static_assert(sizeof(LogHeader) == kLogHeaderSize,
+              "unexpected log file header size");
+
+// Pose from a row-major rotation matrix followed by a translation.
+Pose3 PoseFromSamples(const double *samples, size_t stride) {
+  gtsam::Matrix3 R;
+  for (size_t i = 0; i < 9; i++) R(i / 3, i % 3) = samples[i * stride];
+  const gtsam::Point3 t(samples[9 * stride], samples[10 * stride],
+                        samples[11 * stride]);
+  return Pose3(gtsam::Rot3(R), t);
+}
+}  // namespace
+
+/* ************************************************************************* */
+Vector LogSample(const Pose3 &pose) {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  Vector samples(12);
+  for (size_t i = 0; i < 9; i++) samples(i) = R(i / 3, i % 3);
+  samples.tail<3>() = pose.translation();
+  return samples;
+}
+
+/* ************************************************************************* */
+void WriteLogFile(const std::string &name, const Vector &times,
+                  const std::vector<LogChannel> &channels) {
+  const size_t N = times.size(), C = channels.size();
+  for (auto &&channel : channels) {
+    if (size_t(channel.samples.rows()) != N) {
+      throw std::invalid_argument(
+          "WriteLogFile: every channel should have one row per time.");
+    }
+    if (DynamicsSymbol(channel.key).time() != 0) {
+      throw std::invalid_argument(
+          "WriteLogFile: channel keys should be at time 0.");
+    }
+  }
+
+  std::string header(kLogHeaderSize, '\0');
+  for (auto &&channel : channels) {
+    const uint64_t descriptor[2] = {channel.key,
+                                    uint64_t(channel.samples.cols())};
+    header.append(reinterpret_cast<const char *>(descriptor),
+                  sizeof(descriptor));
+  }
+  const size_t padding =
+      (kLogAlignment - header.size() % kLogAlignment) % kLogAlignment;
+  header.append(padding, '\0');
+
+  LogHeader fixed;
+  std::memcpy(fixed.magic, kLogMagic, sizeof(kLogMagic));
+  fixed.version = kLogFileVersion;
+  fixed.num_channels = C;
+  fixed.num_rows = N;
+  fixed.table_offset = header.size();
+  std::memcpy(&header[0], &fixed, sizeof(fixed));
+
+  // Matrices are column-major, so the samples are written as is.
+  std::ofstream file(name, std::ios::binary);
+  file.write(header.data(), header.size());
+  file.write(reinterpret_cast<const char *>(times.data()),
+             N * sizeof(double));
+  for (auto &&channel : channels) {
+    file.write(reinterpret_cast<const char *>(channel.samples.data()),
+               channel.samples.size() * sizeof(double));
+  }
+  if (!file) {
+    throw std::runtime_error("WriteLogFile: could not write " + name);
+  }
+}
+
+/* ************************************************************************* */
+LogFile::LogFile(const std::string &name) {
+  const int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("LogFile: could not open " + name);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || size_t(st.st_size) < kLogHeaderSize) {
+    ::close(fd);
+    throw std::runtime_error("LogFile: " + name + " is too short.");
+  }
+  size_ = st.st_size;
+  data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // the mapping stays valid
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    throw std::runtime_error("LogFile: could not map " + name);
+  }
+
+  // Unmap if the header is invalid, as the destructor will not run.
+  auto fail = [&](const std::string &what) {
+    ::munmap(data_, size_);
+    throw std::runtime_error("LogFile: " + name + " " + what);
+  };
+
+  const char *bytes = static_cast<const char *>(data_);
+  LogHeader fixed;
+  std::memcpy(&fixed, bytes, sizeof(fixed));
+  if (std::memcmp(fixed.magic, kLogMagic, sizeof(kLogMagic)) != 0) {
+    fail("is not a log file.");
+  }
+  if (fixed.version != kLogFileVersion) fail("has an unsupported version.");
+  const size_t C = fixed.num_channels;
+  num_rows_ = fixed.num_rows;
+  if (fixed.table_offset % kLogAlignment != 0 ||
+      fixed.table_offset > size_ ||
+      kLogHeaderSize + C * kLogChannelSize > fixed.table_offset) {
+    fail("is truncated or corrupt.");
+  }
+
+  size_t table_size = num_rows_;
+  const char *p = bytes + kLogHeaderSize;
+  for (size_t i = 0; i < C; i++, p += kLogChannelSize) {
+    uint64_t descriptor[2];
+    std::memcpy(descriptor, p, sizeof(descriptor));
+    keys_.push_back(descriptor[0]);
+    widths_.push_back(descriptor[1]);
+    table_size += num_rows_ * descriptor[1];
+  }
+  if ((size_ - fixed.table_offset) / sizeof(double) < table_size) {
+    fail("is truncated or corrupt.");
+  }
+
+  times_ = reinterpret_cast<const double *>(bytes + fixed.table_offset);
+  const double *column = times_ + num_rows_;
+  for (size_t i = 0; i < C; i++) {
+    columns_.push_back(column);
+    column += num_rows_ * widths_[i];
+  }
+}
+
+/* ************************************************************************* */
+LogFile::~LogFile() {
+  if (data_) ::munmap(data_, size_);
+}
+
+/* ************************************************************************* */
+bool LogFile::hasChannel(Key key) const {
+  return std::find(keys_.begin(), keys_.end(), key) != keys_.end();
+}
+
+/* ************************************************************************* */
+size_t LogFile::findChannel(Key key) const {
+  const auto it = std::find(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end()) {
+    throw std::invalid_argument("LogFile: no channel " +
+                                std::string(DynamicsSymbol(key)) + ".");
+  }
+  return it - keys_.begin();
+}
+
+/* ************************************************************************* */
+LogFile::ConstVectorMap LogFile::scalars(Key key) const {
+  const size_t i = findChannel(key);
+  if (widths_[i] != 1) {
+    throw std::invalid_argument("LogFile: channel " +
+                                std::string(DynamicsSymbol(key)) +
+                                " is not scalar.");
+  }
+  return ConstVectorMap(columns_[i], num_rows_);
+}
+
+/* ************************************************************************* */
+Pose3 LogFile::pose(size_t i, size_t r) const {
+  if (widths_.at(i) != 12) {
+    throw std::invalid_argument("LogFile: channel is not a pose.");
+  }
+  return PoseFromSamples(columns_[i] + r, num_rows_);
+}
+
+/* ************************************************************************* */
+Key LogFile::key(size_t i, size_t r, int k0) const {
+  // Channel keys are at time 0, and the time is in the lowest bits.
+  return keys_.at(i) + Key(k0 + r);
+}
+
+/* ************************************************************************* */
+void LogFile::insertInto(Values *values, size_t begin, size_t end,
+                         int k0) const {
+  if (begin > end || end > num_rows_) {
+    throw std::out_of_range("LogFile: rows out of range.");
+  }
+  for (size_t i = 0; i < keys_.size(); i++) {
+    const ConstMatrixMap samples = channel(i);
+    for (size_t r = begin; r < end; r++) {
+      const Key k = key(i, r, k0);
+      if (widths_[i] == 1) {
+        values->insert(k, samples(r, 0));
+      } else if (widths_[i] == 6) {
+        values->insert(k, gtsam::Vector6(samples.row(r).transpose()));
+      } else if (widths_[i] == 12) {
+        values->insert(k, pose(i, r));
+      } else {
+        values->insert(k, Vector(samples.row(r).transpose()));
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values LogFile::values(int k0) const {
+  Values result;
+  insertInto(&result, 0, num_rows_, k0);
+  return result;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph LogPriorFactors(const LogFile &log, size_t i,
+                                     const gtsam::SharedNoiseModel &model,
+                                     size_t begin, size_t end, int k0) {
+  if (begin > end || end > log.numRows()) {
+    throw std::out_of_range("LogPriorFactors: rows out of range.");
+  }
+  const size_t width = log.channelWidth(i);
+  const LogFile::ConstMatrixMap samples = log.channel(i);
+  NonlinearFactorGraph graph;
+  for (size_t r = begin; r < end; r++) {
+    const Key k = log.key(i, r, k0);
+    if (width == 1) {
+      graph.addPrior<double>(k, samples(r, 0), model);
+    } else if (width == 6) {
+      graph.addPrior<gtsam::Vector6>(k, samples.row(r).transpose(), model);
+    } else if (width == 12) {
+      graph.addPrior<Pose3>(k, log.pose(i, r), model);
+    } else {
+      graph.addPrior<Vector>(k, samples.row(r).transpose(), model);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph LogJointMeasurementFactors(
+    const Robot &robot, const LogFile &log,
+    const gtsam::SharedNoiseModel &model, size_t begin, size_t end,
+    int k0) {
+  if (begin > end || end > log.numRows()) {
+    throw std::out_of_range("LogJointMeasurementFactors: rows out of range.");
+  }
+  NonlinearFactorGraph graph;
+  for (auto &&joint : robot.joints()) {
+    const Key key = JointAngleKey(joint->id());
+    if (!log.hasChannel(key)) continue;
+    const LogFile::ConstVectorMap angles = log.scalars(key);
+    for (size_t r = begin; r < end; r++) {
+      graph.emplace_shared<JointMeasurementFactor>(model, joint, angles(r),
+                                                   k0 + r);
+    }
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,167 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LogFile.h
+ * @brief Columnar binary sensor and trajectory logs, memory-mapped for
+ * reading, and factor builders consuming them in bulk.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Key.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Log files store time-indexed channels, each the samples of one quantity of
+ * one joint or link, identified by its key at time 0, e.g. JointAngleKey(j)
+ * or PoseKey(i). Row r of every channel is the sample at times()(r), which
+ * is inserted at time step k0 + r. A channel of width 1 is a double, of
+ * width 6 a Vector6, of width 12 a Pose3 as its row-major rotation matrix
+ * followed by its translation, and of any other width a Vector.
+ *
+ * The layout, in host byte order (little-endian on all supported
+ * platforms), is:
+ *
+ *   offset  size         contents
+ *   0       8            magic "GTDLOG\0\0"
+ *   8       4            uint32 version, 1
+ *   12      4            uint32 number of channels C
+ *   16      8            uint64 number of rows N
+ *   24      8            uint64 byte offset of the table, a multiple of 64
+ *   32      16 C         uint64 key and uint64 width W of each channel
+ *   ...                  zero padding
+ *   offset  8 N          double times
+ *   ...     8 N W        double samples of each channel, N x W column-major
+ */
+static constexpr uint32_t kLogFileVersion = 1;
+
+/// A channel to write: its key at time 0, and N x width samples.
+struct LogChannel {
+  gtsam::Key key;
+  gtsam::Matrix samples;
+};
+
+/// Return the samples of a pose, as one row of a channel of width 12.
+gtsam::Vector LogSample(const gtsam::Pose3 &pose);
+
+/**
+ * Write a log file in a single pass.
+ * @param name      file name
+ * @param times     times of the N rows
+ * @param channels  channels, each with N rows
+ */
+void WriteLogFile(const std::string &name, const gtsam::Vector &times,
+                  const std::vector<LogChannel> &channels);
+
+/**
+ * LogFile maps a log file in memory, read-only. The channel accessors return
+ * Eigen maps into the mapping, so nothing is copied and they are valid as
+ * long as the LogFile is alive.
+ */
+class LogFile {
+ public:
+  using ConstMatrixMap = Eigen::Map<const gtsam::Matrix>;
+  using ConstVectorMap = Eigen::Map<const gtsam::Vector>;
+
+ private:
+  void *data_ = nullptr;
+  size_t size_ = 0;
+  size_t num_rows_ = 0;
+  std::vector<gtsam::Key> keys_;
+  std::vector<size_t> widths_;
+  std::vector<const double *> columns_;
+  const double *times_ = nullptr;
+
+ public:
+  /// Constructor, maps the file. Throws std::runtime_error if it is invalid.
+  explicit LogFile(const std::string &name);
+
+  ~LogFile();
+
+  LogFile(const LogFile &) = delete;
+  LogFile &operator=(const LogFile &) = delete;
+
+  /// Return the number of rows.
+  size_t numRows() const { return num_rows_; }
+
+  /// Return the number of channels.
+  size_t numChannels() const { return keys_.size(); }
+
+  /// Return the key at time 0 of channel i.
+  gtsam::Key channelKey(size_t i) const { return keys_.at(i); }
+
+  /// Return the width of channel i.
+  size_t channelWidth(size_t i) const { return widths_.at(i); }
+
+  /// Return the index of the channel of a key at time 0, throws if none.
+  size_t findChannel(gtsam::Key key) const;
+
+  /// Return whether there is a channel of a key at time 0.
+  bool hasChannel(gtsam::Key key) const;
+
+  /// Return the times of the rows.
+  ConstVectorMap times() const { return ConstVectorMap(times_, num_rows_); }
+
+  /// Return the N x width samples of channel i.
+  ConstMatrixMap channel(size_t i) const {
+    return ConstMatrixMap(columns_.at(i), num_rows_, widths_.at(i));
+  }
+
+  /// Return the samples of a channel of width 1, e.g. a joint angle.
+  ConstVectorMap scalars(gtsam::Key key) const;
+
+  /// Return the pose of row r of channel i, of width 12.
+  gtsam::Pose3 pose(size_t i, size_t r) const;
+
+  /// Return the key of row r of channel i, at time step k0 + r.
+  gtsam::Key key(size_t i, size_t r, int k0 = 0) const;
+
+  /**
+   * Insert the samples of all channels in rows [begin, end) into values, at
+   * time steps k0 + r, with the type given by their width.
+   */
+  void insertInto(gtsam::Values *values, size_t begin, size_t end,
+                  int k0 = 0) const;
+
+  /// Return the samples of all channels in all rows as Values.
+  gtsam::Values values(int k0 = 0) const;
+};
+
+/**
+ * Return a prior factor on every sample of channel i in rows [begin, end),
+ * at time steps k0 + r, with the type given by the channel width.
+ */
+gtsam::NonlinearFactorGraph LogPriorFactors(
+    const LogFile &log, size_t i, const gtsam::SharedNoiseModel &model,
+    size_t begin, size_t end, int k0 = 0);
+
+/**
+ * Return a JointMeasurementFactor for every joint angle sample of the
+ * robot joints in rows [begin, end), at time steps k0 + r. Joints without a
+ * JointAngleKey channel are skipped.
+ * @param model  noise model of dimension 6
+ */
+gtsam::NonlinearFactorGraph LogJointMeasurementFactors(
+    const Robot &robot, const LogFile &log,
+    const gtsam::SharedNoiseModel &model, size_t begin, size_t end,
+    int k0 = 0);
+
+}  // namespace gtdynamics
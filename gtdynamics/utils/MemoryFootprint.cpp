@@ -0,0 +1,300 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryFootprint.cpp
+ * @brief Memory accounting of factor graphs and values, by type.
+ */
+
+#include <gtdynamics/utils/MemoryFootprint.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+
+#include <algorithm>
+#include <boost/core/demangle.hpp>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <typeinfo>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::NoiseModelFactor;
+using gtsam::NonlinearFactor;
+using gtsam::Value;
+
+namespace {
+// Shared count of an object held by a shared pointer.
+constexpr size_t kSharedCountBytes = 3 * sizeof(void *);
+
+// Node of the ordered map of Values: key, value pointer and tree links.
+constexpr size_t kMapNodeBytes = sizeof(gtsam::Key) + 5 * sizeof(void *);
+
+// Internal node of an expression tree: vtable, trace size, two children and
+// the function object, plus its shared count.
+constexpr size_t kExpressionNodeBytes =
+    6 * sizeof(void *) + 2 * sizeof(boost::shared_ptr<void>) +
+    kSharedCountBytes;
+
+template <typename T>
+std::string TypeName(const T &object) {
+  return boost::core::demangle(typeid(object).name());
+}
+
+// Reads the protected expression of an expression factor.
+template <typename T>
+struct ExpressionFactorAccess : public gtsam::ExpressionFactor<T> {
+  static const gtsam::Expression<T> &expression(
+      const gtsam::ExpressionFactor<T> &factor) {
+    return factor.*(&ExpressionFactorAccess::expression_);
+  }
+};
+
+// Expression nodes cannot be traversed, but print one line each.
+template <typename T>
+size_t NumExpressionNodes(const gtsam::Expression<T> &expression) {
+  std::stringstream ss;
+  std::streambuf *cout_buffer = std::cout.rdbuf(ss.rdbuf());
+  expression.print("");
+  std::cout.rdbuf(cout_buffer);
+  const std::string printed = ss.str();
+  return std::count(printed.begin(), printed.end(), '\n');
+}
+
+// If the factor is an ExpressionFactor<T>, add its expression to the
+// footprint and return the size of the factor object, else return 0.
+template <typename T>
+size_t AddExpressionFactor(const NonlinearFactor &factor,
+                           const std::string &type,
+                           MemoryFootprint *footprint) {
+  auto expression_factor =
+      dynamic_cast<const gtsam::ExpressionFactor<T> *>(&factor);
+  if (!expression_factor) return 0;
+  const auto &expression =
+      ExpressionFactorAccess<T>::expression(*expression_factor);
+  const size_t num_nodes = NumExpressionNodes(expression);
+  MemoryUsage &nodes = footprint->expression_nodes[type];
+  nodes.count += num_nodes;
+  nodes.bytes += num_nodes * kExpressionNodeBytes;
+  footprint->trace_bytes[type] += expression.traceSize();
+  return sizeof(gtsam::ExpressionFactor<T>) + factor.size() * sizeof(int);
+}
+
+// Size of a factor object, adding its expression if it has one.
+size_t FactorBytes(const NonlinearFactor &factor, const std::string &type,
+                   MemoryFootprint *footprint) {
+  size_t bytes = 0;
+  for (auto add : {&AddExpressionFactor<double>,
+                   &AddExpressionFactor<gtsam::Vector2>,
+                   &AddExpressionFactor<gtsam::Vector3>,
+                   &AddExpressionFactor<gtsam::Vector6>,
+                   &AddExpressionFactor<gtsam::Rot3>,
+                   &AddExpressionFactor<gtsam::Pose3>}) {
+    if ((bytes = add(factor, type, footprint))) return bytes;
+  }
+  return dynamic_cast<const NoiseModelFactor *>(&factor)
+             ? sizeof(NoiseModelFactor)
+             : sizeof(NonlinearFactor);
+}
+
+// Size of a noise model object and its vectors, without inner models.
+size_t NoiseModelBytes(const gtsam::noiseModel::Base &model) {
+  using namespace gtsam::noiseModel;
+  const size_t d = model.dim();
+  if (dynamic_cast<const Constrained *>(&model)) {
+    return sizeof(Constrained) + 4 * d * sizeof(double);  // sigmas and mu
+  } else if (dynamic_cast<const Unit *>(&model)) {
+    return sizeof(Unit) + 3 * d * sizeof(double);
+  } else if (dynamic_cast<const Isotropic *>(&model)) {
+    return sizeof(Isotropic) + 3 * d * sizeof(double);
+  } else if (dynamic_cast<const Diagonal *>(&model)) {
+    return sizeof(Diagonal) + 3 * d * sizeof(double);
+  } else if (dynamic_cast<const Gaussian *>(&model)) {
+    return sizeof(Gaussian) + d * d * sizeof(double);  // square-root info
+  } else if (dynamic_cast<const Robust *>(&model)) {
+    return sizeof(Robust) + sizeof(mEstimator::Base) + kSharedCountBytes;
+  }
+  return sizeof(Base);
+}
+
+// Add a noise model, and the model it wraps if robust, unless seen before.
+void AddNoiseModel(const gtsam::SharedNoiseModel &model,
+                   std::set<const void *> *seen, MemoryFootprint *footprint) {
+  if (!model || !seen->insert(model.get()).second) return;
+  MemoryUsage &usage = footprint->noise_models[TypeName(*model)];
+  usage.count++;
+  usage.bytes += NoiseModelBytes(*model) + kSharedCountBytes;
+  auto robust =
+      boost::dynamic_pointer_cast<const gtsam::noiseModel::Robust>(model);
+  if (robust) AddNoiseModel(robust->noise(), seen, footprint);
+}
+
+// If the value holds a T, return the size of its object, else 0.
+template <typename T>
+size_t FixedValueBytes(const Value &value) {
+  return dynamic_cast<const gtsam::GenericValue<T> *>(&value)
+             ? sizeof(gtsam::GenericValue<T>)
+             : 0;
+}
+
+// Size of a value object and its dynamic storage.
+size_t ValueBytes(const Value &value) {
+  size_t bytes = 0;
+  for (auto fixed :
+       {&FixedValueBytes<double>, &FixedValueBytes<gtsam::Vector2>,
+        &FixedValueBytes<gtsam::Vector3>, &FixedValueBytes<gtsam::Vector6>,
+        &FixedValueBytes<gtsam::Rot3>, &FixedValueBytes<gtsam::Pose3>}) {
+    if ((bytes = fixed(value))) return bytes;
+  }
+  if (dynamic_cast<const gtsam::GenericValue<gtsam::Vector> *>(&value)) {
+    return sizeof(gtsam::GenericValue<gtsam::Vector>) +
+           value.dim() * sizeof(double);
+  }
+  return sizeof(void *) + value.dim() * sizeof(double);  // vtable and data
+}
+
+void WriteUsages(const std::map<std::string, MemoryUsage> &usages,
+                 std::ostream &os) {
+  os << "{";
+  bool first = true;
+  for (const auto &type_usage : usages) {
+    os << (first ? "" : ", ") << "\"" << type_usage.first
+       << "\": {\"count\": " << type_usage.second.count
+       << ", \"bytes\": " << type_usage.second.bytes << "}";
+    first = false;
+  }
+  os << "}";
+}
+}  // namespace
+
+/* ************************************************************************* */
+MemoryUsage MemoryFootprint::total() const {
+  MemoryUsage result;
+  for (auto usages : {&factors, &noise_models, &expression_nodes, &values}) {
+    for (const auto &type_usage : *usages) result += type_usage.second;
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+MemoryFootprint &MemoryFootprint::operator+=(const MemoryFootprint &other) {
+  for (auto &&usages :
+       {std::make_pair(&factors, &other.factors),
+        std::make_pair(&noise_models, &other.noise_models),
+        std::make_pair(&expression_nodes, &other.expression_nodes),
+        std::make_pair(&values, &other.values)}) {
+    for (const auto &type_usage : *usages.second) {
+      (*usages.first)[type_usage.first] += type_usage.second;
+    }
+  }
+  for (const auto &type_bytes : other.trace_bytes) {
+    trace_bytes[type_bytes.first] += type_bytes.second;
+  }
+  return *this;
+}
+
+/* ************************************************************************* */
+void MemoryFootprint::writeJson(std::ostream &os) const {
+  os << "{\"factors\": ";
+  WriteUsages(factors, os);
+  os << ", \"noise_models\": ";
+  WriteUsages(noise_models, os);
+  os << ", \"expression_nodes\": ";
+  WriteUsages(expression_nodes, os);
+  os << ", \"trace_bytes\": {";
+  bool first = true;
+  for (const auto &type_bytes : trace_bytes) {
+    os << (first ? "" : ", ") << "\"" << type_bytes.first
+       << "\": " << type_bytes.second;
+    first = false;
+  }
+  os << "}, \"values\": ";
+  WriteUsages(values, os);
+  const MemoryUsage sum = total();
+  os << ", \"total\": {\"count\": " << sum.count
+     << ", \"bytes\": " << sum.bytes << "}}";
+}
+
+/* ************************************************************************* */
+void MemoryFootprint::print(const std::string &s) const {
+  // Rows of category, type and usage, largest first.
+  using Row = std::tuple<size_t, std::string, std::string, size_t>;
+  std::vector<Row> rows;
+  for (auto &&category :
+       {std::make_pair("factor", &factors),
+        std::make_pair("noise model", &noise_models),
+        std::make_pair("expression", &expression_nodes),
+        std::make_pair("value", &values)}) {
+    for (const auto &type_usage : *category.second) {
+      rows.emplace_back(type_usage.second.bytes, category.first,
+                        type_usage.first, type_usage.second.count);
+    }
+  }
+  std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+    return std::get<0>(a) > std::get<0>(b);
+  });
+
+  if (!s.empty()) std::cout << s << "\n";
+  std::cout << std::setw(14) << "bytes" << std::setw(10) << "count"
+            << "  category     type\n";
+  for (const auto &row : rows) {
+    std::cout << std::setw(14) << std::get<0>(row) << std::setw(10)
+              << std::get<3>(row) << "  " << std::left << std::setw(13)
+              << std::get<1>(row) << std::right << std::get<2>(row) << "\n";
+  }
+  const MemoryUsage sum = total();
+  std::cout << std::setw(14) << sum.bytes << std::setw(10) << sum.count
+            << "  total" << std::endl;
+}
+
+/* ************************************************************************* */
+MemoryFootprint GraphMemoryFootprint(
+    const gtsam::NonlinearFactorGraph &graph) {
+  MemoryFootprint footprint;
+  std::set<const void *> seen_noise_models;
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    const std::string type = TypeName(*factor);
+    MemoryUsage &usage = footprint.factors[type];
+    usage.count++;
+    usage.bytes += FactorBytes(*factor, type, &footprint) +
+                   factor->keys().capacity() * sizeof(gtsam::Key) +
+                   kSharedCountBytes;
+    auto noise_model_factor =
+        boost::dynamic_pointer_cast<const NoiseModelFactor>(factor);
+    if (noise_model_factor) {
+      AddNoiseModel(noise_model_factor->noiseModel(), &seen_noise_models,
+                    &footprint);
+    }
+  }
+  return footprint;
+}
+
+/* ************************************************************************* */
+MemoryFootprint ValuesMemoryFootprint(const gtsam::Values &values) {
+  MemoryFootprint footprint;
+  for (const auto &key_value : values) {
+    MemoryUsage &usage = footprint.values[TypeName(key_value.value)];
+    usage.count++;
+    usage.bytes += ValueBytes(key_value.value) + kMapNodeBytes;
+  }
+  return footprint;
+}
+
+/* ************************************************************************* */
+MemoryFootprint MemoryFootprintOf(const gtsam::NonlinearFactorGraph &graph,
+                                  const gtsam::Values &values) {
+  MemoryFootprint footprint = GraphMemoryFootprint(graph);
+  footprint += ValuesMemoryFootprint(values);
+  return footprint;
+}
+
+}  // namespace gtdynamics
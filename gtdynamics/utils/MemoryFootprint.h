@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryFootprint.h
+ * @brief Memory accounting of factor graphs and values, by type.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace gtdynamics {
+
+/// Number of objects of a type and the bytes they take.
+struct MemoryUsage {
+  size_t count = 0;
+  size_t bytes = 0;
+
+  MemoryUsage() {}
+
+  MemoryUsage &operator+=(const MemoryUsage &other) {
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+  }
+};
+
+/**
+ * Estimated heap footprint of a graph and its values, by type name.
+ *
+ * Factors count their object and key storage, noise models their object and
+ * sigma vectors or square-root information, each shared model only once.
+ * Expression factors also count the nodes of their expression tree, and the
+ * bytes of the execution trace they need at each linearization. Values count
+ * their object, dynamic storage and the node of the map holding them.
+ *
+ * Objects whose exact type is not known here count the size of their base
+ * class, so the bytes are a lower bound, meant to rank the consumers.
+ */
+struct MemoryFootprint {
+  std::map<std::string, MemoryUsage> factors;       // by factor class
+  std::map<std::string, MemoryUsage> noise_models;  // by noise model class
+  std::map<std::string, MemoryUsage> expression_nodes;  // by factor class
+  std::map<std::string, size_t> trace_bytes;  // by factor class, transient
+  std::map<std::string, MemoryUsage> values;  // by value type
+
+  /// Total over factors, noise models, expression nodes and values.
+  MemoryUsage total() const;
+
+  /// Add the usage of another footprint.
+  MemoryFootprint &operator+=(const MemoryFootprint &other);
+
+  /// Write as a JSON object.
+  void writeJson(std::ostream &os) const;
+
+  /// Print a table, largest consumers first.
+  void print(const std::string &s = "") const;
+};
+
+/// Footprint of the factors of a graph, their noise models and expressions.
+MemoryFootprint GraphMemoryFootprint(const gtsam::NonlinearFactorGraph &graph);
+
+/// Footprint of values, by value type.
+MemoryFootprint ValuesMemoryFootprint(const gtsam::Values &values);
+
+/// Footprint of a graph and its values.
+MemoryFootprint MemoryFootprintOf(const gtsam::NonlinearFactorGraph &graph,
+                                  const gtsam::Values &values);
+
+}  // namespace gtdynamics
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModelCache.cpp
+ * @brief Interned noise models, shared process-wide.
+ */
+
+#include <gtdynamics/utils/NoiseModelCache.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+using gtsam::noiseModel::Base;
+using gtsam::noiseModel::Constrained;
+using gtsam::noiseModel::Diagonal;
+using gtsam::noiseModel::Isotropic;
+using gtsam::noiseModel::Unit;
+
+namespace {
+// Kind of constructor, and its arguments.
+enum class ModelKind { ISOTROPIC, DIAGONAL, UNIT, CONSTRAINED };
+using ModelSpec = std::pair<ModelKind, std::vector<double>>;
+
+std::mutex &CacheMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::map<ModelSpec, Base::shared_ptr> &Cache() {
+  static std::map<ModelSpec, Base::shared_ptr> cache;
+  return cache;
+}
+
+// Return the cached model of a spec, creating it on first use.
+template <class MODEL>
+boost::shared_ptr<MODEL> Interned(
+    const ModelSpec &spec,
+    const std::function<boost::shared_ptr<MODEL>()> &create) {
+  std::lock_guard<std::mutex> lock(CacheMutex());
+  Base::shared_ptr &model = Cache()[spec];
+  if (!model) model = create();
+  return boost::static_pointer_cast<MODEL>(model);
+}
+}  // namespace
+
+/* ************************************************************************* */
+Isotropic::shared_ptr InternedIsotropic(size_t dim, double sigma) {
+  return Interned<Isotropic>(
+      {ModelKind::ISOTROPIC, {double(dim), sigma}},
+      [=]() -> Isotropic::shared_ptr { return Isotropic::Sigma(dim, sigma); });
+}
+
+/* ************************************************************************* */
+Diagonal::shared_ptr InternedDiagonal(const gtsam::Vector &sigmas) {
+  return Interned<Diagonal>(
+      {ModelKind::DIAGONAL,
+       std::vector<double>(sigmas.data(), sigmas.data() + sigmas.size())},
+      [&]() -> Diagonal::shared_ptr { return Diagonal::Sigmas(sigmas); });
+}
+
+/* ************************************************************************* */
+Unit::shared_ptr InternedUnit(size_t dim) {
+  return Interned<Unit>({ModelKind::UNIT, {double(dim)}},
+                        [=] { return Unit::Create(dim); });
+}
+
+/* ************************************************************************* */
+Constrained::shared_ptr InternedConstrained(size_t dim) {
+  return Interned<Constrained>({ModelKind::CONSTRAINED, {double(dim)}},
+                               [=] { return Constrained::All(dim); });
+}
+
+/* ************************************************************************* */
+size_t NumInternedNoiseModels() {
+  std::lock_guard<std::mutex> lock(CacheMutex());
+  return Cache().size();
+}
+
+/* ************************************************************************* */
+void ClearInternedNoiseModels() {
+  std::lock_guard<std::mutex> lock(CacheMutex());
+  Cache().clear();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModelCache.h
+ * @brief Interned noise models, shared process-wide.
+ */
+
+#pragma once
+
+#include <gtsam/linear/NoiseModel.h>
+
+namespace gtdynamics {
+
+/**
+ * @name Interned noise models
+ * Noise models are immutable, so factors with the same model can share one
+ * instance. These return the model of the corresponding gtsam constructor,
+ * created on first use and cached for the lifetime of the process. As in
+ * gtsam, a unit sigma yields a Unit model, whose whitening is the identity.
+ * The cache is thread-safe, and meant for the handful of distinct models of
+ * factor builders, not for models that change every iteration.
+ */
+///@{
+
+/// Interned gtsam::noiseModel::Isotropic::Sigma(dim, sigma).
+gtsam::noiseModel::Isotropic::shared_ptr InternedIsotropic(size_t dim,
+                                                          double sigma);
+
+/// Interned gtsam::noiseModel::Diagonal::Sigmas(sigmas).
+gtsam::noiseModel::Diagonal::shared_ptr InternedDiagonal(
+    const gtsam::Vector &sigmas);
+
+/// Interned gtsam::noiseModel::Unit::Create(dim).
+gtsam::noiseModel::Unit::shared_ptr InternedUnit(size_t dim);
+
+/// Interned gtsam::noiseModel::Constrained::All(dim).
+gtsam::noiseModel::Constrained::shared_ptr InternedConstrained(size_t dim);
+
+/// Number of models in the cache.
+size_t NumInternedNoiseModels();
+
+/// Empty the cache. Models already handed out remain valid.
+void ClearInternedNoiseModels();
+
+///@}
+
+}  // namespace gtdynamics
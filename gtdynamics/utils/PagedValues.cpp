@@ -0,0 +1,291 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PagedValues.cpp
+ * @brief Values of very long trajectories, stored one time slice per record
+ * of a memory-mapped file.
+ */
+
+#include <gtdynamics/factors/TimeShiftedFactor.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/PagedValues.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::GenericValue;
+using gtsam::Key;
+using gtsam::Values;
+
+/* ************************************************************************* */
+RecordFile::RecordFile(const std::string &name, size_t record_size,
+                       size_t num_records, bool temporary)
+    : name_(name),
+      record_size_(record_size),
+      num_records_(num_records),
+      temporary_(temporary),
+      size_(record_size * num_records * sizeof(double)) {
+  fd_ = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error("RecordFile: could not create " + name);
+  }
+  if (size_ == 0) return;
+  if (::ftruncate(fd_, size_) != 0) {
+    ::close(fd_);
+    throw std::runtime_error("RecordFile: could not size " + name);
+  }
+  // Shared, so that records written with pwrite are seen through the mapping.
+  data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    ::close(fd_);
+    throw std::runtime_error("RecordFile: could not map " + name);
+  }
+}
+
+/* ************************************************************************* */
+RecordFile::~RecordFile() {
+  if (data_) ::munmap(data_, size_);
+  ::close(fd_);
+  if (temporary_) std::remove(name_.c_str());
+}
+
+/* ************************************************************************* */
+void RecordFile::write(size_t i, const double *record) {
+  if (i >= num_records_) {
+    throw std::out_of_range("RecordFile: no record " + std::to_string(i) +
+                            " in " + name_);
+  }
+  const size_t bytes = record_size_ * sizeof(double);
+  const char *p = reinterpret_cast<const char *>(record);
+  off_t offset = i * bytes;
+  for (size_t done = 0; done < bytes;) {
+    const ssize_t n = ::pwrite(fd_, p + done, bytes - done, offset + done);
+    if (n <= 0) {
+      throw std::runtime_error("RecordFile: could not write " + name_);
+    }
+    done += n;
+  }
+}
+
+/* ************************************************************************* */
+void RecordFile::release(size_t i) const {
+  if (!data_ || i >= num_records_) return;
+  // Pages shared with neighboring records are dropped too, which only costs
+  // reading them again.
+  const size_t page = ::sysconf(_SC_PAGESIZE);
+  const size_t bytes = record_size_ * sizeof(double);
+  const size_t begin = (i * bytes) / page * page;
+  const size_t end =
+      std::min(size_, ((i + 1) * bytes + page - 1) / page * page);
+  ::madvise(static_cast<char *>(data_) + begin, end - begin, MADV_DONTNEED);
+}
+
+/* ************************************************************************* */
+PagedValues::PagedValues(const std::string &name, const Values &first,
+                         size_t num_slices, bool temporary) {
+  if (first.empty() || num_slices == 0) {
+    throw std::invalid_argument("PagedValues: no slices.");
+  }
+  t0_ = DynamicsSymbol(first.keys().front()).time();
+  size_t offset = 0;
+  for (const auto &key_value : first) {
+    if (DynamicsSymbol(key_value.key).time() != t0_) {
+      throw std::invalid_argument(
+          "PagedValues: the keys of a slice must have the same time, " +
+          _GTDKeyFormatter(key_value.key));
+    }
+    const gtsam::Value &value = key_value.value;
+    Variable v{key_value.key, Type::kDouble, offset, 1, 1};
+    if (dynamic_cast<const GenericValue<double> *>(&value)) {
+    } else if (dynamic_cast<const GenericValue<gtsam::Vector3> *>(&value)) {
+      v.type = Type::kVector3;
+      v.size = v.dim = 3;
+    } else if (dynamic_cast<const GenericValue<gtsam::Vector6> *>(&value)) {
+      v.type = Type::kVector6;
+      v.size = v.dim = 6;
+    } else if (dynamic_cast<const GenericValue<gtsam::Vector> *>(&value)) {
+      v.type = Type::kVector;
+      v.size = v.dim = value.dim();
+    } else if (dynamic_cast<const GenericValue<gtsam::Rot3> *>(&value)) {
+      v.type = Type::kRot3;
+      v.size = 9;
+      v.dim = 3;
+    } else if (dynamic_cast<const GenericValue<gtsam::Pose3> *>(&value)) {
+      v.type = Type::kPose3;
+      v.size = 12;
+      v.dim = 6;
+    } else {
+      throw std::invalid_argument("PagedValues: unsupported type of " +
+                                  _GTDKeyFormatter(key_value.key));
+    }
+    offset += v.size;
+    dim_ += v.dim;
+    variables_.push_back(v);
+  }
+  file_.reset(new RecordFile(name, offset, num_slices, temporary));
+  write(0, first);
+}
+
+/* ************************************************************************* */
+PagedValues PagedValues::FromValues(const std::string &name,
+                                    const Values &values, bool temporary) {
+  std::map<uint64_t, Values> slices;
+  for (const auto &key_value : values) {
+    slices[DynamicsSymbol(key_value.key).time()].insert(key_value.key,
+                                                        key_value.value);
+  }
+  if (slices.empty()) {
+    throw std::invalid_argument("PagedValues: no values.");
+  }
+  const uint64_t t0 = slices.begin()->first;
+  const size_t num_slices = slices.rbegin()->first - t0 + 1;
+  PagedValues paged(name, slices.begin()->second, num_slices, temporary);
+  for (size_t k = 1; k < num_slices; k++) {
+    auto it = slices.find(t0 + k);
+    if (it == slices.end()) {
+      throw std::invalid_argument("PagedValues: no values at time " +
+                                  std::to_string(t0 + k));
+    }
+    paged.write(k, it->second);
+  }
+  return paged;
+}
+
+/* ************************************************************************* */
+void PagedValues::write(size_t k, const Values &slice) {
+  if (slice.size() != variables_.size()) {
+    throw std::invalid_argument("PagedValues: slice " + std::to_string(k) +
+                                " has other variables than slice 0.");
+  }
+  std::vector<double> record(file_->recordSize());
+  for (const Variable &v : variables_) {
+    const Key key = ShiftTime(v.key, static_cast<int>(k));
+    if (!slice.exists(key)) {
+      throw std::invalid_argument("PagedValues: slice " + std::to_string(k) +
+                                  " has no " + _GTDKeyFormatter(key));
+    }
+    double *p = record.data() + v.offset;
+    switch (v.type) {
+      case Type::kDouble:
+        *p = slice.at<double>(key);
+        break;
+      case Type::kVector3:
+        gtsam::Vector3::Map(p) = slice.at<gtsam::Vector3>(key);
+        break;
+      case Type::kVector6:
+        gtsam::Vector6::Map(p) = slice.at<gtsam::Vector6>(key);
+        break;
+      case Type::kVector: {
+        const gtsam::Vector &x = slice.at<gtsam::Vector>(key);
+        if (size_t(x.size()) != v.size) {
+          throw std::invalid_argument("PagedValues: " + _GTDKeyFormatter(key) +
+                                      " has another size than at slice 0.");
+        }
+        gtsam::Vector::Map(p, v.size) = x;
+        break;
+      }
+      case Type::kRot3:
+        Eigen::Map<gtsam::Matrix3>(p) =
+            slice.at<gtsam::Rot3>(key).matrix().transpose();
+        break;
+      case Type::kPose3: {
+        const gtsam::Pose3 &pose = slice.at<gtsam::Pose3>(key);
+        Eigen::Map<gtsam::Matrix3>(p) = pose.rotation().matrix().transpose();
+        gtsam::Vector3::Map(p + 9) = pose.translation();
+        break;
+      }
+    }
+  }
+  file_->write(k, record.data());
+}
+
+/* ************************************************************************* */
+Values PagedValues::slice(size_t k) const {
+  if (k >= numSlices()) {
+    throw std::out_of_range("PagedValues: no slice " + std::to_string(k));
+  }
+  const double *record = file_->record(k);
+  Values slice;
+  for (const Variable &v : variables_) {
+    const Key key = ShiftTime(v.key, static_cast<int>(k));
+    const double *p = record + v.offset;
+    switch (v.type) {
+      case Type::kDouble:
+        slice.insert(key, *p);
+        break;
+      case Type::kVector3:
+        slice.insert<gtsam::Vector3>(key, gtsam::Vector3::Map(p));
+        break;
+      case Type::kVector6:
+        slice.insert<gtsam::Vector6>(key, gtsam::Vector6::Map(p));
+        break;
+      case Type::kVector:
+        slice.insert<gtsam::Vector>(key, gtsam::Vector::Map(p, v.size));
+        break;
+      case Type::kRot3:
+        slice.insert(key, gtsam::Rot3(Eigen::Map<const gtsam::Matrix3>(p)
+                                          .transpose()
+                                          .eval()));
+        break;
+      case Type::kPose3:
+        slice.insert(
+            key, gtsam::Pose3(gtsam::Rot3(Eigen::Map<const gtsam::Matrix3>(p)
+                                              .transpose()
+                                              .eval()),
+                              gtsam::Point3(gtsam::Vector3::Map(p + 9))));
+        break;
+    }
+  }
+  return slice;
+}
+
+/* ************************************************************************* */
+Values PagedValues::values() const {
+  Values values;
+  for (size_t k = 0; k < numSlices(); k++) values.insert(slice(k));
+  return values;
+}
+
+/* ************************************************************************* */
+size_t PagedValues::sliceOf(Key key) const {
+  const uint64_t t = DynamicsSymbol(key).time();
+  if (t < t0_ || t - t0_ >= numSlices()) {
+    throw std::invalid_argument("PagedValues: " + _GTDKeyFormatter(key) +
+                                " is in no slice.");
+  }
+  return t - t0_;
+}
+
+/* ************************************************************************* */
+gtsam::KeyVector PagedValues::keys(size_t k) const {
+  gtsam::KeyVector keys;
+  for (const Variable &v : variables_) {
+    keys.push_back(ShiftTime(v.key, static_cast<int>(k)));
+  }
+  return keys;
+}
+
+/* ************************************************************************* */
+std::vector<size_t> PagedValues::dims() const {
+  std::vector<size_t> dims;
+  for (const Variable &v : variables_) dims.push_back(v.dim);
+  return dims;
+}
+
+}  // namespace gtdynamics
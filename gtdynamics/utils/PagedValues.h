@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PagedValues.h
+ * @brief Values of very long trajectories, stored one time slice per record
+ * of a memory-mapped file.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * RecordFile is a file of fixed-size records of doubles, written with pwrite
+ * in any order and read through a shared read-only mapping of the file, so
+ * the kernel pages records in and out and only those in use stay resident.
+ * The file is created, or truncated, with all its records zero.
+ */
+class RecordFile {
+ public:
+  /**
+   * Constructor.
+   * @param name         file name
+   * @param record_size  number of doubles of each record
+   * @param num_records  number of records
+   * @param temporary    whether to remove the file on destruction
+   * @throws std::runtime_error if the file can not be created or mapped.
+   */
+  RecordFile(const std::string &name, size_t record_size, size_t num_records,
+             bool temporary = false);
+  ~RecordFile();
+
+  RecordFile(const RecordFile &) = delete;
+  RecordFile &operator=(const RecordFile &) = delete;
+
+  /// Write record i, of recordSize() doubles.
+  void write(size_t i, const double *record);
+
+  /// Return record i, valid as long as the file is alive.
+  const double *record(size_t i) const {
+    return static_cast<const double *>(data_) + i * record_size_;
+  }
+
+  /// Drop the pages of record i from memory; they are read again if needed.
+  void release(size_t i) const;
+
+  const std::string &name() const { return name_; }
+  size_t recordSize() const { return record_size_; }
+  size_t numRecords() const { return num_records_; }
+
+ private:
+  std::string name_;
+  size_t record_size_, num_records_;
+  bool temporary_;
+  int fd_ = -1;
+  void *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+/**
+ * PagedValues holds the values of a trajectory of numSlices() time slices in
+ * a RecordFile, one slice per record, so that only the slices in use are in
+ * memory. Slice k has the variables of slice 0 with the time of their
+ * DynamicsSymbol keys shifted by k, and all keys of slice 0 have the same
+ * time. A slice record stores double, Vector3, Vector6, Vector, Rot3 and
+ * Pose3 values as doubles, the latter two as their row-major rotation matrix
+ * followed by the translation, as in log files.
+ */
+class PagedValues {
+ public:
+  /**
+   * Create the file of a trajectory, with its first slice.
+   * @param name        file name
+   * @param first       values of slice 0, which fix the variables of all
+   * @param num_slices  number of slices
+   * @param temporary   whether to remove the file on destruction
+   * @throws std::invalid_argument for values of other types, or keys of
+   * different times.
+   */
+  PagedValues(const std::string &name, const gtsam::Values &first,
+              size_t num_slices, bool temporary = false);
+
+  /**
+   * Write the values of all keys of a trajectory to a file, one slice per
+   * time step from the earliest.
+   * @throws std::invalid_argument if the slices have different variables.
+   */
+  static PagedValues FromValues(const std::string &name,
+                                const gtsam::Values &values,
+                                bool temporary = false);
+
+  /// Write slice k, whose keys must be those of slice 0 shifted by k.
+  void write(size_t k, const gtsam::Values &slice);
+
+  /// Return the values of slice k.
+  gtsam::Values slice(size_t k) const;
+
+  /// Drop slice k from memory; it is read from the file again if needed.
+  void release(size_t k) const { file_->release(k); }
+
+  /// Return the values of all slices, in memory.
+  gtsam::Values values() const;
+
+  /// Return the slice of a key, or throw std::invalid_argument.
+  size_t sliceOf(gtsam::Key key) const;
+
+  /// Return the keys of slice k, in record order.
+  gtsam::KeyVector keys(size_t k) const;
+
+  /// Return the tangent dimension of each key of a slice, in record order.
+  std::vector<size_t> dims() const;
+
+  /// Return the tangent dimension of a slice.
+  size_t dim() const { return dim_; }
+
+  size_t numSlices() const { return file_->numRecords(); }
+  const std::string &name() const { return file_->name(); }
+
+ private:
+  enum class Type { kDouble, kVector3, kVector6, kVector, kRot3, kPose3 };
+
+  /// A variable of a slice, at its key in slice 0.
+  struct Variable {
+    gtsam::Key key;
+    Type type;
+    size_t offset;  ///< offset of its doubles in the record
+    size_t size;    ///< number of doubles in the record
+    size_t dim;     ///< tangent dimension
+  };
+
+  std::vector<Variable> variables_;
+  uint64_t t0_;
+  size_t dim_ = 0;
+  std::unique_ptr<RecordFile> file_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParallelFor.h
+ * @brief Parallel loop over independent tasks.
+ */
+
+#pragma once
+
+#include <gtsam/config.h>
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <cstddef>
+
+namespace gtdynamics {
+
+/**
+ * Call func(k) for k in [0, n), in parallel on the TBB work-stealing
+ * scheduler when GTSAM is built with TBB, serially otherwise.
+ */
+template <typename FUNC>
+void ParallelFor(size_t n, const FUNC &func) {
+#ifdef GTSAM_USE_TBB
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t k = range.begin(); k != range.end(); ++k) {
+                        func(k);
+                      }
+                    });
+#else
+  for (size_t k = 0; k < n; k++) func(k);
+#endif
+}
+
+/**
+ * Call func(begin, end) on subranges that partition [0, n), in parallel as
+ * ParallelFor, e.g., to set up per-task state once per subrange.
+ */
+template <typename FUNC>
+void ParallelForRanges(size_t n, const FUNC &func) {
+#ifdef GTSAM_USE_TBB
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      func(range.begin(), range.end());
+                    });
+#else
+  if (n > 0) func(size_t(0), n);
+#endif
+}
+
+/**
+ * Call func() with at most num_threads threads for the TBB algorithms it
+ * runs, e.g. ParallelFor and GTSAM's multifrontal elimination, or with the
+ * default number of threads if num_threads is 0. Without TBB, func() runs
+ * serially.
+ */
+template <typename FUNC>
+void WithThreads(size_t num_threads, const FUNC &func) {
+#ifdef GTSAM_USE_TBB
+  if (num_threads > 0) {
+    tbb::task_arena arena(static_cast<int>(num_threads));
+    arena.execute([&] { func(); });
+    return;
+  }
+#endif
+  func();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,61 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParallelLinearize.cpp
+ * @brief Linearization and error of factor graphs across factors, in
+ * parallel.
+ */
+
+#include <gtdynamics/universal_robot/JointKinematicsCache.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/ParallelLinearize.h>
+#include <gtdynamics/utils/Profiler.h>
+
+#include <boost/make_shared.hpp>
+#include <vector>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+gtsam::GaussianFactorGraph::shared_ptr ParallelLinearize(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values) {
+  GTD_PROFILE_SCOPE("ParallelLinearize");
+  // Each factor writes its own entry, so the order does not depend on the
+  // schedule. Factors of a subrange share joint transforms through a cache.
+  std::vector<gtsam::GaussianFactor::shared_ptr> factors(graph.size());
+  ParallelForRanges(graph.size(), [&](size_t begin, size_t end) {
+    JointKinematicsCache::Scope scope;
+    for (size_t i = begin; i < end; i++) {
+      if (graph[i]) factors[i] = graph[i]->linearize(values);
+    }
+  });
+
+  auto linear = boost::make_shared<gtsam::GaussianFactorGraph>();
+  linear->reserve(factors.size());
+  for (auto &&factor : factors) linear->push_back(factor);
+  return linear;
+}
+
+/* ************************************************************************* */
+double ParallelError(const gtsam::NonlinearFactorGraph &graph,
+                     const gtsam::Values &values) {
+  GTD_PROFILE_SCOPE("ParallelError");
+  std::vector<double> errors(graph.size(), 0.0);
+  ParallelForRanges(graph.size(), [&](size_t begin, size_t end) {
+    JointKinematicsCache::Scope scope;
+    for (size_t i = begin; i < end; i++) {
+      if (graph[i]) errors[i] = graph[i]->error(values);
+    }
+  });
+
+  double total = 0.0;
+  for (double error : errors) total += error;
+  return total;
+}
+
+}  // namespace gtdynamics
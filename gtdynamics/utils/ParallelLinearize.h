@@ -0,0 +1,58 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParallelLinearize.h
+ * @brief Linearization and error of factor graphs across factors, in
+ * parallel.
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+namespace gtdynamics {
+
+/**
+ * Linearize all factors of a graph, concurrently on the TBB scheduler when
+ * GTSAM is built with TBB, serially otherwise. The result is the same as
+ * graph.linearize(values), factor for factor and in the same order; null
+ * factors stay null. gtsam only linearizes in parallel when built with
+ * GTSAM_LINEARIZE_PARALLEL.
+ *
+ * All factors of gtdynamics/factors, statics, jumpingrobot and cablerobot
+ * can be linearized concurrently: linearize and evaluateError only read the
+ * factor, its noise model, and the Link and Joint objects it shares with
+ * other factors, whose state only changes while building a Robot. Function
+ * local tables, e.g. of the pneumatic factors, are initialized once in a
+ * thread-safe way, and interned noise models are guarded by a mutex.
+ * Factors must not be linearized while the Robot they refer to is modified.
+ *
+ * @param graph   the graph to linearize
+ * @param values  values for all keys of the graph
+ * @return the linearized graph
+ */
+gtsam::GaussianFactorGraph::shared_ptr ParallelLinearize(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values);
+
+/**
+ * Evaluate the error of a graph, as ParallelLinearize: each factor only
+ * evaluates its error, without Jacobians, and the errors are summed in
+ * factor order afterwards, so the result is graph.error(values) exactly and
+ * does not depend on the schedule. This is what step acceptance in line
+ * searches and trust regions needs, at a fraction of a linearization.
+ *
+ * @param graph   the graph to evaluate
+ * @param values  values for all keys of the graph
+ * @return the sum of the factor errors
+ */
+double ParallelError(const gtsam::NonlinearFactorGraph &graph,
+                     const gtsam::Values &values);
+
+}  // namespace gtdynamics
@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/utils/ContentHasher.h>
 #include <gtdynamics/utils/Phase.h>
 
 #include <iostream>
@@ -32,6 +33,13 @@ void Phase::print(const string &s) const {
   std::cout << (s.empty() ? s : s + " ") << *this << std::endl;
 }
 
+uint64_t Phase::contentHash() const {
+  ContentHasher hasher;
+  hasher.add(k_start).add(k_end).add(bool(constraint_spec_));
+  if (constraint_spec_) hasher.add(constraint_spec_->contentHash());
+  return hasher.value();
+}
+
 Matrix Phase::jointMatrix(const Robot &robot, const gtsam::Values &results,
                           size_t k, boost::optional<double> dt) const {
   const auto &joints = robot.joints();
@@ -51,6 +51,9 @@ class Phase : public Interval {
   /// GTSAM-style print, works with wrapper.
   void print(const std::string &s) const;
 
+  /// Return a content hash of the interval and the constraint spec.
+  uint64_t contentHash() const;
+
   /// Parse results into a matrix, in order: qs, qdots, qddots, taus, dt
   gtsam::Matrix jointMatrix(const Robot &robot, const gtsam::Values &results,
                             size_t k = 0,
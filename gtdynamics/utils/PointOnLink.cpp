@@ -11,6 +11,7 @@
  * @author Yetong Zhang, Alejandro Escontrela, Frank Dellaert
  */
 
+#include <gtdynamics/utils/ContentHasher.h>
 #include <gtdynamics/utils/PointOnLink.h>
 
 namespace gtdynamics {
@@ -35,4 +36,13 @@ bool PointOnLink::equals(const PointOnLink &other, double tol) const {
          gtsam::equal<gtsam::Point3>(other.point, point, tol);
 }
 
+uint64_t ContentHashOf(const PointOnLinks &points) {
+  ContentHasher hasher;
+  hasher.add(points.size());
+  for (auto &&cp : points) {
+    hasher.add(cp.link->name()).add(cp.link->id()).add(cp.point);
+  }
+  return hasher.value();
+}
+
 }  // namespace gtdynamics
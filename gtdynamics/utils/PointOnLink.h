@@ -17,6 +17,7 @@
 #include <gtsam/base/Testable.h>
 #include <gtsam/geometry/Point3.h>
 
+#include <cstdint>
 #include <map>
 #include <string>
 
@@ -61,6 +62,12 @@ struct PointOnLink {
 ///< Vector of `PointOnLink`s
 using PointOnLinks = std::vector<PointOnLink>;
 
+/**
+ * Return a content hash of contact points, in order: the names and ids of
+ * their links and the points, see ContentHasher.
+ */
+uint64_t ContentHashOf(const PointOnLinks &points);
+
 }  // namespace gtdynamics
 
 namespace gtsam {
@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PointOnLinkBatch.cpp
+ * @brief World positions of many points on links at many time steps at once.
+ */
+
+#include <gtdynamics/utils/PointOnLinkBatch.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+// Rows of the PoseArray layout: rotation in row-major order, translation.
+static inline int RotRow(int i, int j) { return 3 * i + j; }
+static inline int TransRow(int i) { return 9 + i; }
+
+/* ************************************************************************* */
+PointOnLinkBatch::PointOnLinkBatch(const PointOnLinks &points)
+    : points_(points) {
+  comH_.reserve(points_.size());
+  for (auto &&cp : points_) {
+    gtsam::Matrix36 H;
+    H << -gtsam::skewSymmetric(cp.point), gtsam::I_3x3;
+    comH_.push_back(H);
+    link_ids_.push_back(cp.link->id());
+  }
+  std::sort(link_ids_.begin(), link_ids_.end());
+  link_ids_.erase(std::unique(link_ids_.begin(), link_ids_.end()),
+                  link_ids_.end());
+}
+
+/* ************************************************************************* */
+std::vector<PointOnLinkBatch::PoseArray> PointOnLinkBatch::gatherPoses(
+    const gtsam::Values &values, const std::vector<size_t> &ks) const {
+  std::vector<PoseArray> poses(link_ids_.empty() ? 0 : link_ids_.back() + 1);
+  for (int id : link_ids_) {
+    PoseArray &array = poses[id];
+    array.resize(12, ks.size());
+    for (size_t k = 0; k < ks.size(); k++) {
+      const gtsam::Pose3 &wTcom = Pose(values, id, ks[k]);
+      const gtsam::Matrix3 R = wTcom.rotation().matrix();
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) array(RotRow(i, j), k) = R(i, j);
+        array(TransRow(i), k) = wTcom.translation()(i);
+      }
+    }
+  }
+  return poses;
+}
+
+/* ************************************************************************* */
+void PointOnLinkBatch::predict(const std::vector<PoseArray> &poses,
+                               std::vector<PointArray> *positions,
+                               std::vector<gtsam::Matrix36> *H) const {
+  positions->resize(points_.size());
+  if (points_.empty()) {
+    if (H) H->clear();
+    return;
+  }
+  const size_t first = points_.front().link->id();
+  if (first >= poses.size()) {
+    throw std::invalid_argument("PointOnLinkBatch: no poses of link " +
+                                points_.front().link->name());
+  }
+  const Eigen::Index num_steps = poses[first].cols();
+  if (H) H->resize(points_.size() * num_steps);
+
+  for (size_t i = 0; i < points_.size(); i++) {
+    const size_t id = points_[i].link->id();
+    if (id >= poses.size() || poses[id].cols() != num_steps) {
+      throw std::invalid_argument("PointOnLinkBatch: no poses of link " +
+                                  points_[i].link->name() +
+                                  " at all time steps");
+    }
+    const PoseArray &pose = poses[id];
+    const gtsam::Point3 &p = points_[i].point;
+    PointArray &position = (*positions)[i];
+    position.resize(3, num_steps);
+    for (int r = 0; r < 3; r++) {
+      position.row(r) = pose.row(RotRow(r, 0)) * p.x() +
+                        pose.row(RotRow(r, 1)) * p.y() +
+                        pose.row(RotRow(r, 2)) * p.z() + pose.row(TransRow(r));
+    }
+
+    if (!H) continue;
+    for (Eigen::Index k = 0; k < num_steps; k++) {
+      gtsam::Matrix3 R;
+      for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) R(r, c) = pose(RotRow(r, c), k);
+      }
+      (*H)[i * num_steps + k] = R * comH_[i];
+    }
+  }
+}
+
+/* ************************************************************************* */
+std::vector<PointOnLinkBatch::PointArray> PointOnLinkBatch::predict(
+    const gtsam::Values &values, const std::vector<size_t> &ks) const {
+  std::vector<PointArray> positions;
+  predict(gatherPoses(values, ks), &positions);
+  return positions;
+}
+
+}  // namespace gtdynamics
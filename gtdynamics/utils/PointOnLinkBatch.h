@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PointOnLinkBatch.h
+ * @brief World positions of many points on links at many time steps at once.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/ForwardKinematicsPlan.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * PointOnLinkBatch predicts the world positions of a fixed set of points on
+ * links, e.g. the feet of a robot, at many time steps at once, as
+ * PointOnLink::predict does for one point at one time step.
+ *
+ * Link CoM poses are read from ForwardKinematicsPlan::PoseArray buffers
+ * indexed by link id, one column per time step, as computeBatch writes them,
+ * or gathered from Values with one lookup per link and time step, however
+ * many points are on the link. Positions are computed coefficient-wise over
+ * all time steps. The constant factor [-p^, I] of the Jacobian of each point
+ * is computed once, at construction.
+ */
+class PointOnLinkBatch {
+ public:
+  using PoseArray = ForwardKinematicsPlan::PoseArray;
+
+  /// World positions of one point, one column per time step.
+  using PointArray = Eigen::Array<double, 3, Eigen::Dynamic, Eigen::RowMajor>;
+
+ private:
+  PointOnLinks points_;
+  std::vector<int> link_ids_;           // distinct, sorted
+  std::vector<gtsam::Matrix36> comH_;   // [-p^, I] of each point
+
+ public:
+  /// Constructor, from the points to predict.
+  explicit PointOnLinkBatch(const PointOnLinks &points);
+
+  /// Return the points, in the order of the predictions.
+  const PointOnLinks &points() const { return points_; }
+
+  /// Return the ids of the links of the points, sorted.
+  const std::vector<int> &linkIds() const { return link_ids_; }
+
+  /**
+   * Gather the CoM poses of the links of the points from values.
+   * @param values  values with the poses of linkIds() at time steps ks
+   * @param ks      time steps, one column each
+   * @return poses indexed by link id, empty for links without points
+   */
+  std::vector<PoseArray> gatherPoses(const gtsam::Values &values,
+                                     const std::vector<size_t> &ks) const;
+
+  /**
+   * Predict the world positions of all points at all time steps.
+   * @param poses      link CoM poses indexed by link id, with the same number
+   *                   of columns for all links of the points
+   * @param positions  (out) positions of each point, in order
+   * @param H          (out) optional Jacobian of each position with respect
+   *                   to its link CoM pose, at index i * num_steps + k for
+   *                   point i at column k
+   */
+  void predict(const std::vector<PoseArray> &poses,
+               std::vector<PointArray> *positions,
+               std::vector<gtsam::Matrix36> *H = nullptr) const;
+
+  /// Predict the world positions of all points at time steps ks of values.
+  std::vector<PointArray> predict(const gtsam::Values &values,
+                                  const std::vector<size_t> &ks) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Profiler.cpp
+ * @brief Scoped timers and counters aggregated in a thread-safe registry.
+ */
+
+#include <gtdynamics/utils/Profiler.h>
+
+#include <algorithm>
+#include <ostream>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ProfileRegistry &ProfileRegistry::Instance() {
+  static ProfileRegistry registry;
+  return registry;
+}
+
+/* ************************************************************************* */
+void ProfileRegistry::addTime(const std::string &name,
+                              const Clock::time_point &start,
+                              const Clock::time_point &end) {
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  std::lock_guard<std::mutex> lock(mutex_);
+  ProfileEntry &entry = entries_[name];
+  entry.count++;
+  entry.total_time += seconds;
+  entry.min_time = std::min(entry.min_time, seconds);
+  entry.max_time = std::max(entry.max_time, seconds);
+
+  if (events_.size() < max_events_) {
+    const auto thread =
+        threads_.emplace(std::this_thread::get_id(), threads_.size()).first;
+    ProfileEvent event;
+    event.name = name;
+    event.thread = thread->second;
+    event.start =
+        std::chrono::duration<double, std::micro>(start - epoch_).count();
+    event.duration = 1e6 * seconds;
+    events_.push_back(event);
+  }
+}
+
+/* ************************************************************************* */
+void ProfileRegistry::addCount(const std::string &name, size_t n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[name].count += n;
+}
+
+/* ************************************************************************* */
+std::map<std::string, ProfileEntry> ProfileRegistry::entries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_;
+}
+
+/* ************************************************************************* */
+std::vector<ProfileEvent> ProfileRegistry::events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_;
+}
+
+/* ************************************************************************* */
+size_t ProfileRegistry::maxEvents() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_events_;
+}
+
+/* ************************************************************************* */
+void ProfileRegistry::setMaxEvents(size_t max_events) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_events_ = max_events;
+}
+
+/* ************************************************************************* */
+void ProfileRegistry::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  events_.clear();
+  threads_.clear();
+  epoch_ = Clock::now();
+}
+
+/* ************************************************************************* */
+void ProfileRegistry::writeJson(std::ostream &os) const {
+  const auto entries = this->entries();
+  os << "{";
+  bool first = true;
+  for (const auto &name_entry : entries) {
+    const ProfileEntry &entry = name_entry.second;
+    os << (first ? "" : ", ") << "\"" << name_entry.first
+       << "\": {\"count\": " << entry.count;
+    if (entry.total_time > 0) {
+      os << ", \"total_time\": " << entry.total_time
+         << ", \"mean_time\": " << entry.total_time / entry.count
+         << ", \"min_time\": " << entry.min_time
+         << ", \"max_time\": " << entry.max_time;
+    }
+    os << "}";
+    first = false;
+  }
+  os << "}";
+}
+
+/* ************************************************************************* */
+void ProfileRegistry::writeChromeTrace(std::ostream &os) const {
+  const auto events = this->events();
+  os << "{\"traceEvents\": [";
+  for (size_t i = 0; i < events.size(); i++) {
+    const ProfileEvent &event = events[i];
+    os << (i ? ", " : "") << "{\"name\": \"" << event.name
+       << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << event.thread
+       << ", \"ts\": " << event.start << ", \"dur\": " << event.duration
+       << "}";
+  }
+  os << "], \"displayTimeUnit\": \"ms\"}";
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Profiler.h
+ * @brief Scoped timers and counters aggregated in a thread-safe registry.
+ */
+
+#pragma once
+
+#include <gtdynamics/config.h>
+
+#include <chrono>
+#include <iosfwd>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Aggregate of a timed scope or a counter.
+struct ProfileEntry {
+  size_t count = 0;       // calls of a scope, or sum of counter increments
+  double total_time = 0;  // seconds spent in a scope, 0 for counters
+  double min_time = std::numeric_limits<double>::infinity();
+  double max_time = 0;
+
+  ProfileEntry() {}
+};
+
+/// One call of a timed scope, in microseconds since the registry epoch.
+struct ProfileEvent {
+  std::string name;
+  size_t thread = 0;  // threads are numbered in order of their first event
+  double start = 0;
+  double duration = 0;
+};
+
+/**
+ * ProfileRegistry aggregates the timers and counters of the whole process.
+ * Scopes are recorded both as aggregates and as events for a timeline, the
+ * latter up to maxEvents() so long runs do not grow without bound.
+ *
+ * Instrumentation uses the GTD_PROFILE_SCOPE and GTD_PROFILE_COUNT macros,
+ * which compile to nothing unless GTDynamics is configured with
+ * GTDYNAMICS_ENABLE_PROFILING.
+ */
+class ProfileRegistry {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+ private:
+  mutable std::mutex mutex_;
+  Clock::time_point epoch_;
+  std::map<std::string, ProfileEntry> entries_;
+  std::vector<ProfileEvent> events_;
+  std::map<std::thread::id, size_t> threads_;
+  size_t max_events_ = 100000;
+
+  ProfileRegistry() : epoch_(Clock::now()) {}
+
+ public:
+  /// Return the registry of the process.
+  static ProfileRegistry &Instance();
+
+  /// Record a call of the scope `name` between start and end.
+  void addTime(const std::string &name, const Clock::time_point &start,
+               const Clock::time_point &end);
+
+  /// Add n to the counter `name`.
+  void addCount(const std::string &name, size_t n = 1);
+
+  /// Return a copy of the aggregates, by name.
+  std::map<std::string, ProfileEntry> entries() const;
+
+  /// Return a copy of the recorded events.
+  std::vector<ProfileEvent> events() const;
+
+  /// Maximum number of events kept, later ones are only aggregated.
+  size_t maxEvents() const;
+  void setMaxEvents(size_t max_events);
+
+  /// Clear all aggregates and events, and restart the epoch.
+  void reset();
+
+  /// Write the aggregates as a JSON object, by name.
+  void writeJson(std::ostream &os) const;
+
+  /// Write the events in the Chrome trace event format, for chrome://tracing.
+  void writeChromeTrace(std::ostream &os) const;
+};
+
+/// Times its lifetime into the registry under a name.
+class ScopedProfile {
+ private:
+  const char *name_;
+  ProfileRegistry::Clock::time_point start_;
+
+ public:
+  explicit ScopedProfile(const char *name)
+      : name_(name), start_(ProfileRegistry::Clock::now()) {}
+
+  ~ScopedProfile() {
+    ProfileRegistry::Instance().addTime(name_, start_,
+                                        ProfileRegistry::Clock::now());
+  }
+
+  ScopedProfile(const ScopedProfile &) = delete;
+  ScopedProfile &operator=(const ScopedProfile &) = delete;
+};
+
+}  // namespace gtdynamics
+
+#define GTD_PROFILE_CONCAT_INNER(a, b) a##b
+#define GTD_PROFILE_CONCAT(a, b) GTD_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef GTDYNAMICS_ENABLE_PROFILING
+/// Time the rest of the enclosing scope under `name`, a string literal.
+#define GTD_PROFILE_SCOPE(name)                         \
+  const ::gtdynamics::ScopedProfile GTD_PROFILE_CONCAT( \
+      gtd_scoped_profile_, __LINE__)(name)
+/// Add n to the counter `name`.
+#define GTD_PROFILE_COUNT(name, n) \
+  ::gtdynamics::ProfileRegistry::Instance().addCount(name, n)
+#else
+#define GTD_PROFILE_SCOPE(name) (void)0
+#define GTD_PROFILE_COUNT(name, n) (void)0
+#endif
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RandomStream.h
+ * @brief Seeded, counter-based random streams, keyed by (seed, stream).
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/Sampler.h>
+
+#include <boost/optional.hpp>
+#include <cmath>
+#include <cstdint>
+
+namespace gtdynamics {
+
+/**
+ * A counter-based random stream: the i-th draw is a hash of the key of the
+ * stream and i, with the SplitMix64 finalizer, so draws need no shared state.
+ * Streams keyed by (seed, stream), e.g. (seed, time step), are independent
+ * and are created where they are used, so work split across any number of
+ * threads draws the same numbers as a serial loop, without contention.
+ */
+class RandomStream {
+ private:
+  uint64_t key_;
+  uint64_t counter_ = 0;
+  boost::optional<double> spare_;  // second normal of the last Box-Muller pair
+
+  static uint64_t Mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+ public:
+  /// Constructor, the stream of a seed.
+  RandomStream(uint64_t seed, uint64_t stream)
+      : key_(Mix(Mix(seed) + 0x9e3779b97f4a7c15ULL * (stream + 1))) {}
+
+  /// Return the next 64 random bits.
+  uint64_t next() { return Mix(key_ + 0x9e3779b97f4a7c15ULL * ++counter_); }
+
+  /// Return a uniform sample in (0, 1).
+  double uniform() { return ((next() >> 11) + 0.5) / 9007199254740992.0; }
+
+  /// Return a standard normal sample, by the Box-Muller transform.
+  double normal() {
+    if (spare_) {
+      const double z = *spare_;
+      spare_ = boost::none;
+      return z;
+    }
+    const double r = std::sqrt(-2 * std::log(uniform()));
+    const double theta = 2 * M_PI * uniform();
+    spare_ = r * std::sin(theta);
+    return r * std::cos(theta);
+  }
+
+  /// Return a zero-mean Gaussian vector with standard deviation sigma.
+  gtsam::Vector normal(size_t dim, double sigma) {
+    gtsam::Vector v(dim);
+    for (size_t i = 0; i < dim; i++) v(i) = sigma * normal();
+    return v;
+  }
+};
+
+/**
+ * Zero-mean 6D noise for the initial values of one time step: from the
+ * stream (seed, k) if seeded, otherwise from a gtsam::Sampler with its fixed
+ * default seed, i.e., the same noise at every step.
+ */
+class StepNoise {
+ private:
+  double sigma_;
+  boost::optional<RandomStream> stream_;
+  boost::optional<gtsam::Sampler> sampler_;
+
+ public:
+  /// Constructor.
+  StepNoise(const boost::optional<uint64_t> &seed, size_t k, double sigma)
+      : sigma_(sigma) {
+    if (seed) {
+      stream_.emplace(*seed, k);
+    } else {
+      sampler_.emplace(InternedIsotropic(6, sigma));
+    }
+  }
+
+  /// Return a 6D sample.
+  gtsam::Vector6 sample() {
+    if (stream_) return stream_->normal(6, sigma_);
+    return sampler_->sample();
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SignedDistanceField.cpp
+ * @brief Precomputed signed distance field of a static environment.
+ */
+
+#include <gtdynamics/utils/SignedDistanceField.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+
+/* ************************************************************************* */
+SignedDistanceField::SignedDistanceField(const Point3 &origin,
+                                         double resolution, size_t nx,
+                                         size_t ny, size_t nz,
+                                         const std::vector<double> &distances)
+    : origin_(origin),
+      resolution_(resolution),
+      nx_(nx),
+      ny_(ny),
+      nz_(nz),
+      distances_(distances) {
+  if (nx < 2 || ny < 2 || nz < 2) {
+    throw std::invalid_argument(
+        "SignedDistanceField: need at least 2x2x2 cells.");
+  }
+  if (!(resolution > 0)) {
+    throw std::invalid_argument(
+        "SignedDistanceField: resolution must be positive.");
+  }
+  if (distances.size() != nx * ny * nz) {
+    throw std::invalid_argument(
+        "SignedDistanceField: need nx * ny * nz distances.");
+  }
+}
+
+/* ************************************************************************* */
+SignedDistanceField SignedDistanceField::FromFunction(
+    const std::function<double(const Point3 &)> &distance,
+    const Point3 &origin, double resolution, size_t nx, size_t ny,
+    size_t nz) {
+  std::vector<double> distances;
+  distances.reserve(nx * ny * nz);
+  for (size_t iz = 0; iz < nz; iz++) {
+    for (size_t iy = 0; iy < ny; iy++) {
+      for (size_t ix = 0; ix < nx; ix++) {
+        distances.push_back(
+            distance(origin + resolution * Point3(ix, iy, iz)));
+      }
+    }
+  }
+  return SignedDistanceField(origin, resolution, nx, ny, nz, distances);
+}
+
+/* ************************************************************************* */
+// Return the cell below u, in grid units, and the fraction within it. Points
+// outside of the grid are clamped, and *inside is false for them.
+static size_t Cell(double u, size_t n, double *fraction, bool *inside) {
+  const double clamped = std::min(std::max(u, 0.0), double(n - 1));
+  *inside = (clamped == u);
+  const size_t i = std::min(size_t(clamped), n - 2);
+  *fraction = clamped - i;
+  return i;
+}
+
+/* ************************************************************************* */
+double SignedDistanceField::distance(const Point3 &point,
+                                     gtsam::OptionalJacobian<1, 3> H) const {
+  const Point3 u = (point - origin_) / resolution_;
+  double fx, fy, fz;
+  bool inside_x, inside_y, inside_z;
+  const size_t ix = Cell(u.x(), nx_, &fx, &inside_x);
+  const size_t iy = Cell(u.y(), ny_, &fy, &inside_y);
+  const size_t iz = Cell(u.z(), nz_, &fz, &inside_z);
+
+  // Corners c[y][z] along x, as pairs of adjacent doubles.
+  const double *c00 = distances_.data() + (iz * ny_ + iy) * nx_ + ix;
+  const double *c10 = c00 + nx_;
+  const double *c01 = c00 + nx_ * ny_;
+  const double *c11 = c01 + nx_;
+
+  // Interpolate along x, then y, then z.
+  const double d00 = c00[0] + fx * (c00[1] - c00[0]);
+  const double d10 = c10[0] + fx * (c10[1] - c10[0]);
+  const double d01 = c01[0] + fx * (c01[1] - c01[0]);
+  const double d11 = c11[0] + fx * (c11[1] - c11[0]);
+  const double d0 = d00 + fy * (d10 - d00);
+  const double d1 = d01 + fy * (d11 - d01);
+
+  if (H) {
+    const double dx =
+        (1 - fz) * ((1 - fy) * (c00[1] - c00[0]) + fy * (c10[1] - c10[0])) +
+        fz * ((1 - fy) * (c01[1] - c01[0]) + fy * (c11[1] - c11[0]));
+    const double dy = (1 - fz) * (d10 - d00) + fz * (d11 - d01);
+    const double dz = d1 - d0;
+    *H << (inside_x ? dx / resolution_ : 0.0),
+        (inside_y ? dy / resolution_ : 0.0),
+        (inside_z ? dz / resolution_ : 0.0);
+  }
+  return d0 + fz * (d1 - d0);
+}
+
+}  // namespace gtdynamics
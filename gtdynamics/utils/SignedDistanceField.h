@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SignedDistanceField.h
+ * @brief Precomputed signed distance field of a static environment.
+ */
+
+#pragma once
+
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/geometry/Point3.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * SignedDistanceField is a regular 3D grid of distances to the obstacles of a
+ * static environment, negative inside obstacles, interpolated trilinearly.
+ * Outside of the grid the query point is clamped to it, with zero gradient
+ * along the clamped axes.
+ *
+ * The field is computed once, e.g. with FromFunction, so a query costs eight
+ * lookups however complex the environment is. Factors share one field
+ * through a SignedDistanceFieldPtr.
+ */
+class SignedDistanceField {
+ private:
+  gtsam::Point3 origin_;
+  double resolution_;
+  size_t nx_, ny_, nz_;
+  std::vector<double> distances_;  // x fastest, then y, then z
+
+ public:
+  /**
+   * Constructor
+   * @param origin      position of the first cell
+   * @param resolution  distance between cells
+   * @param nx          number of cells along x, at least 2, same for ny, nz
+   * @param distances   nx * ny * nz distances, x fastest, then y, then z
+   */
+  SignedDistanceField(const gtsam::Point3 &origin, double resolution,
+                      size_t nx, size_t ny, size_t nz,
+                      const std::vector<double> &distances);
+
+  /**
+   * Sample a signed distance function on a grid.
+   * @param distance    signed distance to the environment at a point
+   * @param origin      position of the first cell
+   * @param resolution  distance between cells
+   */
+  static SignedDistanceField FromFunction(
+      const std::function<double(const gtsam::Point3 &)> &distance,
+      const gtsam::Point3 &origin, double resolution, size_t nx, size_t ny,
+      size_t nz);
+
+  size_t nx() const { return nx_; }
+  size_t ny() const { return ny_; }
+  size_t nz() const { return nz_; }
+  double resolution() const { return resolution_; }
+  const gtsam::Point3 &origin() const { return origin_; }
+
+  /// Return the distance stored at a cell.
+  double at(size_t ix, size_t iy, size_t iz) const {
+    return distances_[(iz * ny_ + iy) * nx_ + ix];
+  }
+
+  /**
+   * Return the interpolated signed distance at a point.
+   * @param H optional gradient of the distance
+   */
+  double distance(const gtsam::Point3 &point,
+                  gtsam::OptionalJacobian<1, 3> H = boost::none) const;
+};
+
+/// Shared handle to a distance field, so factors do not copy the grid.
+using SignedDistanceFieldPtr = std::shared_ptr<const SignedDistanceField>;
+
+}  // namespace gtdynamics
@@ -0,0 +1,145 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SliceTemplate.cpp
+ * @brief Build the factors of one time slice once, stamp out copies.
+ */
+
+#include <gtdynamics/factors/ContactDynamicsMomentFactor.h>
+#include <gtdynamics/factors/ContactKinematicsAccelFactor.h>
+#include <gtdynamics/factors/ContactKinematicsTwistFactor.h>
+#include <gtdynamics/factors/JointLimitFactor.h>
+#include <gtdynamics/factors/LinkDynamicsFactor.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/factors/PoseFactor.h>
+#include <gtdynamics/factors/TwistAccelFactor.h>
+#include <gtdynamics/factors/TwistFactor.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/SliceTemplate.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+
+using gtsam::Key;
+using gtsam::NonlinearFactor;
+using gtsam::NonlinearFactorGraph;
+
+namespace gtdynamics {
+
+namespace {
+// Return whether the factor is exactly of type T, not of a derived type.
+template <class T>
+bool IsA(const NonlinearFactor &factor) {
+  return typeid(factor) == typeid(T);
+}
+
+// Factors known to read their values through keys() only, so that rekeying
+// gives a valid copy. Other factor types, e.g. expression factors, whose
+// leaves keep their own keys, are not rekeyed.
+bool IsRekeyable(const NonlinearFactor &factor) {
+  return IsA<gtsam::PriorFactor<double>>(factor) ||
+         IsA<gtsam::PriorFactor<gtsam::Vector6>>(factor) ||
+         IsA<gtsam::PriorFactor<gtsam::Pose3>>(factor) ||
+         IsA<JointLimitFactor>(factor) || IsA<MinTorqueFactor>(factor) ||
+         IsA<AnalyticPoseFactor>(factor) || IsA<AnalyticTwistFactor>(factor) ||
+         IsA<AnalyticTwistAccelFactor>(factor) ||
+         IsA<AnalyticWrenchFactor>(factor) ||
+         IsA<AnalyticContactDynamicsMomentFactor>(factor) ||
+         IsA<AnalyticContactKinematicsTwistFactor>(factor) ||
+         IsA<AnalyticContactKinematicsAccelFactor>(factor);
+}
+
+// Return whether the key is a DynamicsSymbol of a time step. Other keys, e.g.
+// gtsam::Symbol keys, do not survive a round trip through DynamicsSymbol, and
+// inertial parameters are shared by all time steps.
+bool IsTimeIndexed(Key key) {
+  const DynamicsSymbol symbol(key);
+  const std::string label = symbol.label();
+  if (label.empty() ||
+      label ==
+          DynamicsSymbol::SimpleSymbol(DynamicsSymbol::Label::Inertial, 0)
+              .label()) {
+    return false;
+  }
+  return DynamicsSymbol::LinkJointSymbol(label, symbol.linkIdx(),
+                                         symbol.jointIdx(), symbol.time())
+             .key() == key;
+}
+}  // namespace
+
+/* ************************************************************************* */
+NonlinearFactor::shared_ptr ShiftTime(const NonlinearFactor::shared_ptr &factor,
+                                      int offset) {
+  for (Key key : factor->keys()) {
+    if (!IsTimeIndexed(key)) {
+      throw std::invalid_argument("ShiftTime: key " + std::to_string(key) +
+                                  " is not a DynamicsSymbol of a time step.");
+    }
+  }
+  if (!IsTimeShiftable(factor)) {
+    throw std::invalid_argument(
+        "ShiftTime: factor is not known to be time shiftable.");
+  }
+
+  std::map<Key, Key> mapping;
+  for (Key key : factor->keys()) {
+    const DynamicsSymbol symbol(key);
+    mapping[key] = DynamicsSymbol::LinkJointSymbol(
+        symbol.label(), symbol.linkIdx(), symbol.jointIdx(),
+        symbol.time() + offset);
+  }
+  return factor->rekey(mapping);
+}
+
+/* ************************************************************************* */
+bool IsTimeShiftable(const NonlinearFactor::shared_ptr &factor) {
+  for (Key key : factor->keys()) {
+    if (!IsTimeIndexed(key)) return false;
+  }
+
+  if (auto fused = boost::dynamic_pointer_cast<LinkDynamicsFactor>(factor)) {
+    if (!IsA<LinkDynamicsFactor>(*factor)) return false;
+    for (auto &&component : fused->factors()) {
+      if (!IsTimeShiftable(component)) return false;
+    }
+    return true;
+  }
+
+  return IsRekeyable(*factor);
+}
+
+/* ************************************************************************* */
+SliceTemplate::SliceTemplate(const Builder &builder, int t0)
+    : builder_(builder), t0_(t0), template_(builder(t0)), shiftable_(true) {
+  for (auto &&factor : template_) {
+    if (factor && !IsTimeShiftable(factor)) {
+      shiftable_ = false;
+      break;
+    }
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph SliceTemplate::at(int t) const {
+  if (t == t0_) return template_;
+  if (!shiftable_) return builder_(t);
+
+  NonlinearFactorGraph graph;
+  graph.reserve(template_.size());
+  for (auto &&factor : template_) {
+    graph.push_back(factor ? ShiftTime(factor, t - t0_) : factor);
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SliceTemplate.h
+ * @brief Build the factors of one time slice once, stamp out copies.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <functional>
+
+namespace gtdynamics {
+
+/**
+ * Shift the time index of every (DynamicsSymbol) key in a factor, by rekeying
+ * it. Throws std::invalid_argument if a key is not a DynamicsSymbol of a time
+ * step, or if the factor is not time shiftable, see IsTimeShiftable.
+ * @param factor  the factor to copy
+ * @param offset  number of time steps to add to each key
+ */
+gtsam::NonlinearFactor::shared_ptr ShiftTime(
+    const gtsam::NonlinearFactor::shared_ptr &factor, int offset);
+
+/**
+ * Return true if ShiftTime gives a valid copy of the factor. Rekeying is
+ * opt-in: only factor types known to read their inputs through keys(), e.g.,
+ * priors, JointLimitFactor, MinTorqueFactor, the analytic kinematics and
+ * dynamics factors, and LinkDynamicsFactor made of those, are shiftable, and
+ * only if all their keys are DynamicsSymbols of a time step. ExpressionFactor
+ * leaves keep their own copy of the keys, so expression factors are not.
+ * Use TimeShiftedFactor to shift any other factor.
+ */
+bool IsTimeShiftable(const gtsam::NonlinearFactor::shared_ptr &factor);
+
+/**
+ * SliceTemplate builds the factors of a representative time slice once, and
+ * creates the same factors at other time steps by shifting the time field of
+ * their keys, instead of re-creating every factor.
+ *
+ * If any factor of the template cannot be shifted (see IsTimeShiftable), the
+ * builder is called for every time step instead, so the result is always the
+ * same as calling the builder directly.
+ */
+class SliceTemplate {
+ public:
+  using Builder = std::function<gtsam::NonlinearFactorGraph(int)>;
+
+ private:
+  Builder builder_;
+  int t0_;
+  gtsam::NonlinearFactorGraph template_;
+  bool shiftable_;
+
+ public:
+  /**
+   * Constructor
+   * @param builder  returns the factors of the slice at time step t
+   * @param t0       representative time step used to build the template
+   */
+  explicit SliceTemplate(const Builder &builder, int t0 = 0);
+
+  /// Return whether slices are created by shifting the template.
+  bool shiftable() const { return shiftable_; }
+
+  /// Return the factors of the slice at time step t.
+  gtsam::NonlinearFactorGraph at(int t) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,280 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolutionCache.cpp
+ * @brief Cache of solved trajectories, for nearest-neighbor warm starts.
+ */
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/SolutionCache.h>
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Pose3;
+using gtsam::Values;
+
+/* ************************************************************************* */
+TaskDescriptor TaskDescriptor::FromTrajectory(const std::string &robot,
+                                              const Trajectory &trajectory,
+                                              const gtsam::Vector &boundary) {
+  std::vector<std::string> phase_contacts;
+  for (size_t p = 0; p < trajectory.numPhases(); p++) {
+    const auto spec =
+        boost::dynamic_pointer_cast<const FootContactConstraintSpec>(
+            trajectory.phase(p).constraintSpec());
+    std::vector<std::string> links;
+    if (spec) {
+      for (auto &&cp : spec->contactPoints()) links.push_back(cp.link->name());
+    }
+    phase_contacts.push_back(boost::algorithm::join(links, ","));
+  }
+  return TaskDescriptor(robot, trajectory.phaseDurations(), phase_contacts,
+                        boundary);
+}
+
+/* ************************************************************************* */
+std::string TaskDescriptor::structure() const {
+  return robot + "|" + boost::algorithm::join(phase_contacts, "|");
+}
+
+/* ************************************************************************* */
+Values RetimeSolution(const Values &solution,
+                      const std::vector<int> &from_steps,
+                      const std::vector<int> &to_steps) {
+  if (from_steps.size() != to_steps.size()) {
+    throw std::invalid_argument(
+        "RetimeSolution: the solutions have different numbers of phases.");
+  }
+  const std::string phase_label = PhaseKey(0).label();
+
+  // Keys of each time step; phase durations are scaled right away.
+  Values result;
+  std::map<uint64_t, std::vector<Key>> keys_at;
+  for (auto &&key_value : solution) {
+    const DynamicsSymbol symbol(key_value.key);
+    if (symbol.label() == phase_label) {
+      const size_t p = symbol.time();
+      const double scale = p < to_steps.size() && to_steps[p] > 0
+                               ? double(from_steps[p]) / to_steps[p]
+                               : 1.0;
+      result.insert(key_value.key, solution.atDouble(key_value.key) * scale);
+    } else {
+      keys_at[symbol.time()].push_back(key_value.key);
+    }
+  }
+
+  // Consecutive phases share their boundary step, which is done once.
+  int from_start = 0, to_start = 0;
+  for (size_t p = 0; p < to_steps.size(); p++) {
+    for (int i = (p == 0 ? 0 : 1); i <= to_steps[p]; i++) {
+      const int k = from_start + std::lround(double(i) * from_steps[p] /
+                                             std::max(to_steps[p], 1));
+      const auto it = keys_at.find(k);
+      if (it == keys_at.end()) continue;
+      for (Key key : it->second) {
+        const DynamicsSymbol symbol(key);
+        result.insert(
+            DynamicsSymbol::LinkJointSymbol(symbol.label(), symbol.linkIdx(),
+                                            symbol.jointIdx(), to_start + i),
+            solution.at(key));
+      }
+    }
+    from_start += from_steps[p];
+    to_start += to_steps[p];
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+void SolutionCache::insert(const TaskDescriptor &task,
+                           const Values &solution) {
+  Group &group = groups_[task.structure()];
+  if (!group.entries.empty() &&
+      size_t(group.entries.front().task.boundary.size()) !=
+          size_t(task.boundary.size())) {
+    throw std::invalid_argument(
+        "SolutionCache::insert: boundary dimension differs from tasks with "
+        "the same structure.");
+  }
+  group.entries.emplace_back(task, solution);
+  group.boundaries.insert(group.boundaries.end(), task.boundary.data(),
+                          task.boundary.data() + task.boundary.size());
+  size_++;
+}
+
+/* ************************************************************************* */
+const SolutionCache::Entry *SolutionCache::nearest(const TaskDescriptor &task,
+                                                   double *distance) const {
+  const auto it = groups_.find(task.structure());
+  if (it == groups_.end()) return nullptr;
+  const Group &group = it->second;
+
+  const size_t dim = task.boundary.size(), n = group.entries.size();
+  if (group.boundaries.size() != dim * n) {
+    throw std::invalid_argument(
+        "SolutionCache::nearest: boundary dimension differs from tasks with "
+        "the same structure.");
+  }
+  const Eigen::Map<const gtsam::Matrix> boundaries(group.boundaries.data(),
+                                                   dim, n);
+  Eigen::Index best = 0;
+  const double squared_distance =
+      dim > 0 ? (boundaries.colwise() - task.boundary)
+                    .colwise()
+                    .squaredNorm()
+                    .minCoeff(&best)
+              : 0.0;
+  if (distance) *distance = std::sqrt(squared_distance);
+  return &group.entries[best];
+}
+
+/* ************************************************************************* */
+boost::optional<Values> SolutionCache::warmStart(const TaskDescriptor &task,
+                                                 double max_distance) const {
+  double distance;
+  const Entry *entry = nearest(task, &distance);
+  if (!entry || distance > max_distance) return boost::none;
+  return RetimeSolution(entry->solution, entry->task.phase_steps,
+                        task.phase_steps);
+}
+
+/* ************************************************************************* */
+namespace {
+// Values as typed flat data, so the archive needs no registered value types.
+struct FlatValues {
+  std::vector<Key> keys;
+  std::string types;
+  std::vector<uint32_t> dims;
+  std::vector<double> data;
+
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &keys &types &dims &data;
+  }
+};
+
+template <typename T>
+const T *ValueAs(const gtsam::Value &value) {
+  const auto generic = dynamic_cast<const gtsam::GenericValue<T> *>(&value);
+  return generic ? &generic->value() : nullptr;
+}
+
+template <typename VECTOR>
+void Append(FlatValues *flat, char type, const VECTOR &v) {
+  flat->types.push_back(type);
+  flat->dims.push_back(v.size());
+  flat->data.insert(flat->data.end(), v.data(), v.data() + v.size());
+}
+
+FlatValues Flatten(const Values &values) {
+  FlatValues flat;
+  for (auto &&key_value : values) {
+    const gtsam::Value &value = key_value.value;
+    flat.keys.push_back(key_value.key);
+    if (const double *d = ValueAs<double>(value)) {
+      Append(&flat, 'd', gtsam::Vector1(*d));
+    } else if (const auto *v = ValueAs<gtsam::Vector>(value)) {
+      Append(&flat, 'v', *v);
+    } else if (const auto *v3 = ValueAs<gtsam::Vector3>(value)) {
+      Append(&flat, '3', *v3);
+    } else if (const auto *v6 = ValueAs<gtsam::Vector6>(value)) {
+      Append(&flat, '6', *v6);
+    } else if (const Pose3 *pose = ValueAs<Pose3>(value)) {
+      gtsam::Vector12 p;
+      p << Eigen::Map<const gtsam::Vector9>(pose->rotation().matrix().data()),
+          pose->translation();
+      Append(&flat, 'p', p);
+    } else {
+      throw std::invalid_argument(
+          "SolutionCache::save: unsupported value type for key " +
+          _GTDKeyFormatter(key_value.key));
+    }
+  }
+  return flat;
+}
+
+Values Unflatten(const FlatValues &flat) {
+  Values values;
+  const double *d = flat.data.data();
+  for (size_t i = 0; i < flat.keys.size(); d += flat.dims[i++]) {
+    const Key key = flat.keys[i];
+    switch (flat.types[i]) {
+      case 'd':
+        values.insert(key, *d);
+        break;
+      case 'v':
+        values.insert(key, gtsam::Vector(Eigen::Map<const gtsam::Vector>(
+                               d, flat.dims[i])));
+        break;
+      case '3':
+        values.insert(key, gtsam::Vector3(d));
+        break;
+      case '6':
+        values.insert(key, gtsam::Vector6(d));
+        break;
+      case 'p':
+        values.insert(key, Pose3(gtsam::Rot3(gtsam::Matrix3(d)),
+                                 gtsam::Point3(d + 9)));
+        break;
+      default:
+        throw std::runtime_error("SolutionCache::Load: corrupt file.");
+    }
+  }
+  return values;
+}
+}  // namespace
+
+/* ************************************************************************* */
+void SolutionCache::save(const std::string &filename) const {
+  std::ofstream file(filename, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("SolutionCache::save: could not open " +
+                             filename);
+  }
+  boost::archive::binary_oarchive archive(file);
+  archive << size_;
+  for (auto &&structure_group : groups_) {
+    for (auto &&entry : structure_group.second.entries) {
+      const FlatValues flat = Flatten(entry.solution);
+      archive << entry.task << flat;
+    }
+  }
+}
+
+/* ************************************************************************* */
+SolutionCache SolutionCache::Load(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("SolutionCache::Load: could not open " +
+                             filename);
+  }
+  boost::archive::binary_iarchive archive(file);
+  size_t size;
+  archive >> size;
+  SolutionCache cache;
+  for (size_t i = 0; i < size; i++) {
+    TaskDescriptor task;
+    FlatValues flat;
+    archive >> task >> flat;
+    cache.insert(task, Unflatten(flat));
+  }
+  return cache;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SolutionCache.h
+ * @brief Cache of solved trajectories, for nearest-neighbor warm starts.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * TaskDescriptor describes a trajectory optimization problem. Problems with
+ * the same structure, the robot and the contacts of each phase, have the same
+ * variables up to the number of time steps in each phase, so the solution of
+ * one is a good initial estimate for the other. Among those, the closest
+ * boundary vector, e.g. start and goal poses stacked, is the best one.
+ */
+struct TaskDescriptor {
+  std::string robot;                        ///< robot name
+  std::vector<int> phase_steps;             ///< time steps of each phase
+  std::vector<std::string> phase_contacts;  ///< contact links of each phase
+  gtsam::Vector boundary;  ///< boundary conditions and goals
+
+  /// Default constructor (for serialization).
+  TaskDescriptor() {}
+
+  /// Constructor, phase_contacts are comma-separated link names.
+  TaskDescriptor(const std::string &robot, const std::vector<int> &phase_steps,
+                 const std::vector<std::string> &phase_contacts,
+                 const gtsam::Vector &boundary)
+      : robot(robot),
+        phase_steps(phase_steps),
+        phase_contacts(phase_contacts),
+        boundary(boundary) {}
+
+  /**
+   * Create the descriptor of a trajectory, with the contact links of each
+   * phase taken from its FootContactConstraintSpec, if any.
+   */
+  static TaskDescriptor FromTrajectory(const std::string &robot,
+                                       const Trajectory &trajectory,
+                                       const gtsam::Vector &boundary);
+
+  /// Return a key that is equal for tasks with the same structure.
+  std::string structure() const;
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &BOOST_SERIALIZATION_NVP(robot);
+    ar &BOOST_SERIALIZATION_NVP(phase_steps);
+    ar &BOOST_SERIALIZATION_NVP(phase_contacts);
+    ar &BOOST_SERIALIZATION_NVP(boundary);
+  }
+};
+
+/**
+ * Re-key a multi-phase solution to phases with other numbers of time steps.
+ * Time step k of phase p, in the layout of multiPhaseTrajectoryFG, takes the
+ * values at the time step with the same fraction of the phase in the
+ * solution. Phase durations are scaled so each phase keeps its length.
+ * @param solution   solution of a multi-phase problem
+ * @param from_steps time steps of each phase in the solution
+ * @param to_steps   time steps of each phase in the result
+ */
+gtsam::Values RetimeSolution(const gtsam::Values &solution,
+                             const std::vector<int> &from_steps,
+                             const std::vector<int> &to_steps);
+
+/**
+ * SolutionCache stores solved trajectory optimization problems by task, and
+ * returns the solution of the nearest task with the same structure, re-keyed
+ * to the time steps of a new task, to use as its initial values.
+ *
+ * Tasks are grouped by structure, and in each group the boundary vectors are
+ * packed contiguously, so a lookup is a single pass over one matrix.
+ */
+class SolutionCache {
+ public:
+  /// A solved task.
+  struct Entry {
+    TaskDescriptor task;
+    gtsam::Values solution;
+
+    Entry(const TaskDescriptor &task, const gtsam::Values &solution)
+        : task(task), solution(solution) {}
+  };
+
+ private:
+  // Entries with the same structure, with their boundaries column by column.
+  struct Group {
+    std::vector<Entry> entries;
+    std::vector<double> boundaries;
+  };
+  std::map<std::string, Group> groups_;
+  size_t size_ = 0;
+
+ public:
+  /// Default constructor, an empty cache.
+  SolutionCache() {}
+
+  /// Return the number of solutions.
+  size_t size() const { return size_; }
+
+  /**
+   * Add the solution of a task. Throws std::invalid_argument if the boundary
+   * has another dimension than those of tasks with the same structure.
+   */
+  void insert(const TaskDescriptor &task, const gtsam::Values &solution);
+
+  /**
+   * Return the entry of the task with the same structure and the closest
+   * boundary, or nullptr if there is none.
+   * @param task      the new task
+   * @param distance  if given, set to the distance between the boundaries
+   */
+  const Entry *nearest(const TaskDescriptor &task,
+                       double *distance = nullptr) const;
+
+  /**
+   * Return the solution of the nearest task, re-keyed to the time steps of
+   * the new task, or none if no task with the same structure is within
+   * max_distance.
+   */
+  boost::optional<gtsam::Values> warmStart(
+      const TaskDescriptor &task,
+      double max_distance = std::numeric_limits<double>::infinity()) const;
+
+  /**
+   * Save to a binary file. Values of types double, Vector, Vector3, Vector6
+   * and Pose3 are supported, which are all those of the dynamics graphs;
+   * throws std::invalid_argument for others.
+   */
+  void save(const std::string &filename) const;
+
+  /// Load from a file written by save.
+  static SolutionCache Load(const std::string &filename);
+};
+
+}  // namespace gtdynamics
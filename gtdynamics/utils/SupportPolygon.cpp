@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SupportPolygon.cpp
+ * @brief Support polygons and static stability margins of contact phases.
+ */
+
+#include <gtdynamics/utils/PointOnLinkBatch.h>
+#include <gtdynamics/utils/SupportPolygon.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Point2;
+using gtsam::Point3;
+
+// z component of the cross product of (a - o) and (b - o).
+static double Cross(const Point2 &o, const Point2 &a, const Point2 &b) {
+  return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x());
+}
+
+/* ************************************************************************* */
+std::vector<Point2> ConvexHull(std::vector<Point2> points) {
+  // Andrew's monotone chain.
+  std::sort(points.begin(), points.end(), [](const Point2 &a, const Point2 &b) {
+    return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+  });
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+  if (points.size() < 3) return points;
+
+  std::vector<Point2> hull(2 * points.size());
+  size_t n = 0;
+  for (size_t i = 0; i < points.size(); i++) {  // lower hull
+    while (n >= 2 && Cross(hull[n - 2], hull[n - 1], points[i]) <= 0) n--;
+    hull[n++] = points[i];
+  }
+  for (size_t i = points.size() - 1, lower = n + 1; i > 0; i--) {  // upper
+    while (n >= lower && Cross(hull[n - 2], hull[n - 1], points[i - 1]) <= 0)
+      n--;
+    hull[n++] = points[i - 1];
+  }
+  hull.resize(n - 1);  // the last point is the first one
+  return hull;
+}
+
+/* ************************************************************************* */
+SupportPolygon::SupportPolygon(const PointOnLinks &contact_points,
+                               const gtsam::Values &values, size_t k) {
+  std::vector<Point2> points;
+  points.reserve(contact_points.size());
+  const PointOnLinkBatch batch(contact_points);
+  for (auto &&p : batch.predict(values, {k})) {
+    points.emplace_back(p(0, 0), p(1, 0));
+  }
+  vertices_ = ConvexHull(points);
+}
+
+/* ************************************************************************* */
+double SupportPolygon::area() const {
+  if (vertices_.size() < 3) return 0.0;
+  double twice_area = 0.0;
+  for (size_t i = 1; i + 1 < vertices_.size(); i++) {
+    twice_area += Cross(vertices_[0], vertices_[i], vertices_[i + 1]);
+  }
+  return 0.5 * twice_area;
+}
+
+/* ************************************************************************* */
+// Distance from p to the segment [a, b].
+static double SegmentDistance(const Point2 &p, const Point2 &a,
+                              const Point2 &b) {
+  const Point2 ab = b - a;
+  const double length2 = ab.squaredNorm();
+  const double s =
+      length2 > 0 ? std::min(1.0, std::max(0.0, (p - a).dot(ab) / length2))
+                  : 0.0;
+  return (p - a - s * ab).norm();
+}
+
+/* ************************************************************************* */
+double SupportPolygon::margin(const Point2 &point) const {
+  const size_t n = vertices_.size();
+  if (n == 0) return -std::numeric_limits<double>::infinity();
+  if (n == 1) return -(point - vertices_[0]).norm();
+  if (n == 2) return -SegmentDistance(point, vertices_[0], vertices_[1]);
+
+  // Inside a convex polygon, the distance to the boundary is the smallest
+  // distance to the lines through the edges, which are all on the left.
+  double inside = std::numeric_limits<double>::infinity();
+  double outside = std::numeric_limits<double>::infinity();
+  bool is_inside = true;
+  for (size_t i = 0; i < n; i++) {
+    const Point2 &a = vertices_[i], &b = vertices_[(i + 1) % n];
+    const double signed_distance = Cross(a, b, point) / (b - a).norm();
+    if (signed_distance < 0) is_inside = false;
+    inside = std::min(inside, signed_distance);
+    outside = std::min(outside, SegmentDistance(point, a, b));
+  }
+  return is_inside ? inside : -outside;
+}
+
+/* ************************************************************************* */
+Point3 CenterOfMass(const Robot &robot, const gtsam::Values &values,
+                    size_t k) {
+  Point3 weighted(0, 0, 0);
+  double mass = 0.0;
+  for (auto &&link : robot.links()) {
+    weighted += link->mass() * Pose(values, link->id(), k).translation();
+    mass += link->mass();
+  }
+  if (!(mass > 0)) {
+    throw std::invalid_argument("CenterOfMass: robot has no mass.");
+  }
+  return weighted / mass;
+}
+
+/* ************************************************************************* */
+double StaticStabilityMargin(const Robot &robot,
+                             const FootContactConstraintSpec &spec,
+                             const gtsam::Values &values, size_t k) {
+  const Point3 com = CenterOfMass(robot, values, k);
+  return SupportPolygon(spec.contactPoints(), values, k)
+      .margin(Point2(com.x(), com.y()));
+}
+
+/* ************************************************************************* */
+bool IsStaticallyStable(const Robot &robot, const Phase &phase,
+                        const gtsam::Values &values, size_t k,
+                        double min_margin) {
+  const auto spec =
+      boost::dynamic_pointer_cast<const FootContactConstraintSpec>(
+          phase.constraintSpec());
+  if (!spec) {
+    throw std::invalid_argument(
+        "IsStaticallyStable: phase has no FootContactConstraintSpec.");
+  }
+  return StaticStabilityMargin(robot, *spec, values, k) >= min_margin;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SupportPolygon.h
+ * @brief Support polygons and static stability margins of contact phases.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/Phase.h>
+#include <gtdynamics/utils/PointOnLink.h>
+#include <gtsam/geometry/Point2.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Return the convex hull of points in the plane, counter-clockwise, without
+ * collinear points.
+ */
+std::vector<gtsam::Point2> ConvexHull(std::vector<gtsam::Point2> points);
+
+/**
+ * SupportPolygon is the convex hull of the contact points of a stance,
+ * projected on the ground plane z = 0, with gravity along -z. A robot at
+ * rest with its center of mass above the polygon does not tip over.
+ */
+class SupportPolygon {
+ private:
+  std::vector<gtsam::Point2> vertices_;  // counter-clockwise
+
+ public:
+  /// Constructor, from points in the ground plane.
+  explicit SupportPolygon(const std::vector<gtsam::Point2> &points)
+      : vertices_(ConvexHull(points)) {}
+
+  /**
+   * Constructor, from the contact points of a stance at a time step.
+   * @param contact_points  contact points on links
+   * @param values          values with the link poses at k
+   * @param k               time step
+   */
+  SupportPolygon(const PointOnLinks &contact_points,
+                 const gtsam::Values &values, size_t k = 0);
+
+  /// Return the vertices, counter-clockwise.
+  const std::vector<gtsam::Point2> &vertices() const { return vertices_; }
+
+  /// Return the area, zero for fewer than three vertices.
+  double area() const;
+
+  /**
+   * Return the signed distance from a point to the boundary, positive
+   * inside. Polygons with fewer than three vertices have no inside, so the
+   * margin is minus the distance to them, and -infinity if empty.
+   */
+  double margin(const gtsam::Point2 &point) const;
+
+  /// Return whether a point is inside or on the boundary.
+  bool contains(const gtsam::Point2 &point) const {
+    return margin(point) >= 0;
+  }
+};
+
+/// Return the center of mass of a robot, from the link poses at k.
+gtsam::Point3 CenterOfMass(const Robot &robot, const gtsam::Values &values,
+                           size_t k = 0);
+
+/**
+ * Return the static stability margin of a stance: the signed distance from
+ * the projection of the center of mass to the boundary of the support
+ * polygon, positive when the robot is statically stable.
+ * @param robot  the robot
+ * @param spec   the stance, with its contact points
+ * @param values values with the link poses at k
+ * @param k      time step
+ */
+double StaticStabilityMargin(const Robot &robot,
+                             const FootContactConstraintSpec &spec,
+                             const gtsam::Values &values, size_t k = 0);
+
+/**
+ * Return whether the stance of a phase is statically stable with at least
+ * the given margin at time step k. It only needs the link poses, so it is a
+ * cheap check to reject candidate phases before building dynamics graphs.
+ * Throws if the phase has no FootContactConstraintSpec.
+ */
+bool IsStaticallyStable(const Robot &robot, const Phase &phase,
+                        const gtsam::Values &values, size_t k,
+                        double min_margin = 0.0);
+
+}  // namespace gtdynamics
@@ -13,19 +13,32 @@
  */
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/factors/TimeShiftedFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/Profiler.h>
+#include <gtdynamics/utils/SliceTemplate.h>
 #include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/TrajectoryFile.h>
+#include <gtdynamics/utils/TrajectoryState.h>
 #include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/BetweenFactor.h>
 
 #include <algorithm>
 #include <boost/algorithm/string/join.hpp>
 #include <iostream>
 #include <map>
+#include <numeric>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 using gtsam::NonlinearFactorGraph;
 using gtsam::Point3;
+using gtsam::Pose3;
 using gtsam::SharedNoiseModel;
 using gtsam::Values;
 using gtsam::Z_6x1;
@@ -36,37 +49,136 @@ using std::vector;
 
 namespace gtdynamics {
 
+void Trajectory::buildIndex() {
+  final_timesteps_.clear();
+  int final_timestep = 0;
+  for (auto &&phase : phases_) {
+    final_timestep += phase.numTimeSteps();
+    final_timesteps_.push_back(final_timestep);
+  }
+
+  // One walk cycle over all phases gives the contact points of each phase
+  // and of each transition.
+  const WalkCycle walk_cycle(phases_);
+  phase_contact_points_ = walk_cycle.allPhasesContactPoints();
+  transition_contact_points_.clear();
+  if (phases_.size() > 1) {
+    transition_contact_points_ = walk_cycle.transitionContactPoints();
+  }
+}
+
+Trajectory Trajectory::withPhaseDurations(
+    const vector<int> &durations) const {
+  if (durations.size() != phases_.size()) {
+    throw std::invalid_argument(
+        "Trajectory::withPhaseDurations: need one duration per phase");
+  }
+  vector<Phase> phases;
+  size_t k = 0;
+  for (size_t p = 0; p < phases_.size(); p++) {
+    if (durations[p] < 1) {
+      throw std::invalid_argument(
+          "Trajectory::withPhaseDurations: durations must be at least 1");
+    }
+    Phase phase = phases_[p];
+    phase.k_start = k;
+    phase.k_end = k + durations[p];
+    k = phase.k_end;
+    phases.push_back(phase);
+  }
+  return Trajectory(phases);
+}
+
+void Trajectory::addIntegrationTimeFactors(NonlinearFactorGraph *graph,
+                                           const vector<double> &desired_dts,
+                                           double sigma) const {
+  if (desired_dts.size() != numPhases()) {
+    throw std::invalid_argument(
+        "Trajectory::addIntegrationTimeFactors: need one dt per phase");
+  }
+  auto model = InternedIsotropic(1, sigma);
+  for (size_t phase = 0; phase < numPhases(); phase++)
+    graph->addPrior<double>(PhaseKey(phase), desired_dts[phase], model);
+}
+
+size_t Trajectory::phaseIndex(int k) const {
+  if (k < 0 || final_timesteps_.empty() || k > final_timesteps_.back()) {
+    throw std::out_of_range("Trajectory::phaseIndex: no such time step");
+  }
+  return std::lower_bound(final_timesteps_.begin(), final_timesteps_.end(),
+                          k) -
+         final_timesteps_.begin();
+}
+
 vector<NonlinearFactorGraph> Trajectory::getTransitionGraphs(
     const Robot &robot, const DynamicsGraph &graph_builder, double mu) const {
-  vector<NonlinearFactorGraph> transition_graphs;
-  const vector<int> final_timesteps = finalTimeSteps();
-  const vector<PointOnLinks> trans_cps = transitionContactPoints();
-  for (int p = 1; p < numPhases(); p++) {
-    transition_graphs.push_back(graph_builder.dynamicsFactorGraph(
-        robot, final_timesteps[p - 1], trans_cps[p - 1], mu));
+  const vector<int> &final_timesteps = finalTimeSteps();
+  const vector<PointOnLinks> &trans_cps = transitionContactPoints();
+
+  // Repeated gaits have a handful of distinct transitions: build the graph
+  // of each distinct contact set once, at its first boundary, and shift it
+  // in time to the others.
+  vector<PointOnLinks> unique_cps;
+  vector<SliceTemplate> templates;
+  vector<size_t> template_index(trans_cps.size());
+  for (size_t p = 0; p < trans_cps.size(); p++) {
+    const auto it =
+        std::find(unique_cps.begin(), unique_cps.end(), trans_cps[p]);
+    template_index[p] = it - unique_cps.begin();
+    if (it != unique_cps.end()) continue;
+    unique_cps.push_back(trans_cps[p]);
+    const PointOnLinks &cps = unique_cps.back();
+    templates.emplace_back(
+        [&robot, &graph_builder, cps, mu](int k) -> NonlinearFactorGraph {
+          return graph_builder.dynamicsFactorGraph(robot, k, cps, mu);
+        },
+        final_timesteps[p]);
   }
+
+  // Each transition writes its own entry, so the order does not depend on
+  // the schedule.
+  vector<NonlinearFactorGraph> transition_graphs(trans_cps.size());
+  FactorArena *arena = FactorArena::Active();
+  ParallelFor(transition_graphs.size(), [&](size_t p) {
+    FactorArena::Scope scope(arena);
+    transition_graphs[p] =
+        templates[template_index[p]].at(final_timesteps[p]);
+  });
   return transition_graphs;
 }
 
+void Trajectory::multiPhaseFactorGraph(
+    NonlinearFactorGraph *graph, const Robot &robot,
+    const DynamicsGraph &graph_builder, const CollocationScheme collocation,
+    double mu) const {
+  GTD_PROFILE_SCOPE("Trajectory::multiPhaseFactorGraph");
+  // Graphs for transition between phases + their initial values.
+  auto transition_graphs = getTransitionGraphs(robot, graph_builder, mu);
+  graph_builder.multiPhaseTrajectoryFG(graph, robot, phaseDurations(),
+                                       transition_graphs, collocation,
+                                       phaseContactPoints(), mu);
+}
+
 NonlinearFactorGraph Trajectory::multiPhaseFactorGraph(
     const Robot &robot, const DynamicsGraph &graph_builder,
     const CollocationScheme collocation, double mu) const {
-  // Graphs for transition between phases + their initial values.
-  auto transition_graphs = getTransitionGraphs(robot, graph_builder, mu);
-  return graph_builder.multiPhaseTrajectoryFG(robot, phaseDurations(),
-                                              transition_graphs, collocation,
-                                              phaseContactPoints(), mu);
+  NonlinearFactorGraph graph;
+  multiPhaseFactorGraph(&graph, robot, graph_builder, collocation, mu);
+  return graph;
 }
 
 vector<Values> Trajectory::transitionPhaseInitialValues(
     const Robot &robot, const  Initializer & initializer, double gaussian_noise) const {
-  vector<PointOnLinks> trans_cps = transitionContactPoints();
-  vector<Values> transition_graph_init;
-  vector<int> final_timesteps = finalTimeSteps();
-  for (int p = 1; p < numPhases(); p++) {
-    transition_graph_init.push_back(initializer.ZeroValues(
-        robot, final_timesteps[p - 1], gaussian_noise, trans_cps[p - 1]));
-  }
+  const vector<PointOnLinks> &trans_cps = transitionContactPoints();
+  const vector<int> &final_timesteps = finalTimeSteps();
+
+  // ZeroValues seeds its own sampler, so the values do not depend on the
+  // schedule either.
+  vector<Values> transition_graph_init(trans_cps.size());
+  ParallelFor(transition_graph_init.size(), [&](size_t p) {
+    transition_graph_init[p] = initializer.ZeroValues(
+        robot, final_timesteps[p], gaussian_noise, trans_cps[p]);
+  });
   return transition_graph_init;
 }
 
@@ -128,6 +240,79 @@ void Trajectory::addBoundaryConditions(
                                     joint_acceleration_model, K));
 }
 
+void Trajectory::addPeriodicBoundaryConditions(
+    gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+    const Pose3 &displacement, const SharedNoiseModel &pose_model,
+    const SharedNoiseModel &twist_model,
+    const SharedNoiseModel &joint_angle_model,
+    const SharedNoiseModel &joint_velocity_model) const {
+  // Get final time step.
+  int K = getEndTimeStep(numPhases() - 1);
+
+  // Link poses repeat up to the displacement, body twists repeat exactly.
+  const gtsam::Expression<Pose3> moved(displacement);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    const gtsam::Expression<Pose3> start(PoseKey(i, 0)), end(PoseKey(i, K));
+    graph->emplace_shared<gtsam::ExpressionFactor<Pose3>>(
+        pose_model, Pose3(), gtsam::between(moved * start, end));
+    graph->emplace_shared<gtsam::BetweenFactor<gtsam::Vector6>>(
+        TwistKey(i, 0), TwistKey(i, K), Z_6x1, twist_model);
+  }
+
+  // Joint angles and velocities repeat exactly.
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph->emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(j, 0), JointAngleKey(j, K), 0.0, joint_angle_model);
+    graph->emplace_shared<gtsam::BetweenFactor<double>>(
+        JointVelKey(j, 0), JointVelKey(j, K), 0.0, joint_velocity_model);
+  }
+}
+
+Values Trajectory::repeatPeriodicSolution(const Values &cycle, size_t repeat,
+                                          const Pose3 &displacement) const {
+  const int K = getEndTimeStep(numPhases() - 1);
+  const int num_phases = numPhases();
+  const string pose_label = PoseKey(0).label(),
+               phase_label = PhaseKey(0).label(),
+               time_label = TimeKey(0).label();
+
+  // Cycle duration, if the times are in the solution.
+  double duration = 0;
+  if (cycle.exists(TimeKey(0)) && cycle.exists(TimeKey(K))) {
+    duration = cycle.atDouble(TimeKey(K)) - cycle.atDouble(TimeKey(0));
+  }
+
+  Values result;
+  Pose3 offset;
+  for (size_t r = 0; r < repeat; r++) {
+    for (auto &&key_value : cycle) {
+      const DynamicsSymbol symbol(key_value.key);
+      const string label = symbol.label();
+      const int t = symbol.time();
+
+      // Phase time steps are indexed by phase, everything else by time step.
+      if (label == phase_label) {
+        result.insert(PhaseKey(r * num_phases + t), key_value.value);
+        continue;
+      }
+      // The first slice of a cycle is the last one of the previous cycle.
+      if (r > 0 && t == 0) continue;
+      const gtsam::Key key = ShiftTime(key_value.key, r * K);
+      if (label == pose_label) {
+        result.insert(key, offset * key_value.value.cast<Pose3>());
+      } else if (label == time_label) {
+        result.insert(key, r * duration + key_value.value.cast<double>());
+      } else {
+        result.insert(key, key_value.value);
+      }
+    }
+    offset = offset * displacement;
+  }
+  return result;
+}
+
 void Trajectory::addMinimumTorqueFactors(
     gtsam::NonlinearFactorGraph *graph, const Robot &robot,
     const SharedNoiseModel &cost_model) const {
@@ -179,4 +364,46 @@ void Trajectory::writeToFile(const Robot &robot, const std::string &name,
     }
   }
 }
+
+gtsam::Matrix Trajectory::jointMatrix(const Robot &robot,
+                                      const gtsam::Values &results) const {
+  const vector<int> durations = phaseDurations();
+  const int rows = std::accumulate(durations.begin(), durations.end(), 0);
+  const int J = robot.numJoints();
+  gtsam::Matrix table(rows, 4 * J + 1);
+  if (rows == 0) return table;
+
+  // Gather the joint values of all time steps once, then copy blocks.
+  const int num_steps = final_timesteps_.back() + 1;
+  TrajectoryState state(robot, num_steps, TrajectoryState::kJointQuantities);
+  for (int k = 0; k < num_steps; k++) state.setStep(k, results, k);
+
+  for (int p = 0, row = 0; p < numPhases(); row += durations[p++]) {
+    const int k = getStartTimeStep(p), n = durations[p];
+    table.block(row, 0 * J, n, J) =
+        state.jointAngles().middleCols(k, n).transpose();
+    table.block(row, 1 * J, n, J) =
+        state.jointVels().middleCols(k, n).transpose();
+    table.block(row, 2 * J, n, J) =
+        state.jointAccels().middleCols(k, n).transpose();
+    table.block(row, 3 * J, n, J) =
+        state.torques().middleCols(k, n).transpose();
+    table.block(row, 4 * J, n, 1).setConstant(results.atDouble(PhaseKey(p)));
+  }
+  return table;
+}
+
+void Trajectory::writeToBinaryFile(const Robot &robot, const string &name,
+                                   const gtsam::Values &results) const {
+  vector<string> jnames;
+  for (auto &&joint : robot.joints()) {
+    jnames.push_back(joint->name());
+  }
+  vector<double> dts;
+  for (int p = 0; p < numPhases(); p++) {
+    dts.push_back(results.atDouble(PhaseKey(p)));
+  }
+  WriteTrajectoryFile(name, jnames, phaseDurations(), dts,
+                      jointMatrix(robot, results));
+}
 }  // namespace gtdynamics
@@ -17,7 +17,9 @@
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/factors/PointGoalFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
 #include <gtdynamics/utils/Phase.h>
+#include <gtdynamics/utils/TrajectorySpline.h>
 #include <gtdynamics/utils/WalkCycle.h>
 #include <gtdynamics/utils/Initializer.h>
 
@@ -31,6 +33,14 @@ class Trajectory {
  protected:
   std::vector<Phase> phases_;  ///< All phases in the trajectory
 
+  /// Index of the phases, built once by the constructors.
+  std::vector<int> final_timesteps_;  ///< final time step of each phase
+  std::vector<PointOnLinks> phase_contact_points_;
+  std::vector<PointOnLinks> transition_contact_points_;
+
+  /// Build the phase index from phases_.
+  void buildIndex();
+
  public:
   /// Default Constructor (for serialization)
   Trajectory() {}
@@ -52,8 +62,25 @@ class Trajectory {
       // Append phases_i of walk_cycle to phases_ vector member.
       phases_.insert(phases_.end(), phases_i.begin(), phases_i.end());
     }
+    buildIndex();
+  }
+
+  /**
+   * Construct trajectory from a sequence of phases.
+   * @param phases  The phases, in order.
+   */
+  explicit Trajectory(const std::vector<Phase> &phases) : phases_(phases) {
+    buildIndex();
   }
 
+  /**
+   * @fn Returns a trajectory with the same phases, but another number of
+   * time steps in each, e.g. to solve at another time resolution.
+   * @param[in] durations  Number of time steps of each phase, at least 1.
+   * @return Trajectory with the new phase durations.
+   */
+  Trajectory withPhaseDurations(const std::vector<int> &durations) const;
+
   /// Returns vector of phases in the trajectory
   const std::vector<Phase> &phases() const { return phases_; }
 
@@ -64,9 +91,8 @@ class Trajectory {
    * and may have repetitions, as opposed to contact_points_.
    * @return Phase CPs.
    */
-  std::vector<PointOnLinks> phaseContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.allPhasesContactPoints();
+  const std::vector<PointOnLinks> &phaseContactPoints() const {
+    return phase_contact_points_;
   }
 
   /**
@@ -74,9 +100,8 @@ class Trajectory {
    * phases after applying repetition on the original sequence.
    * @return Transition CPs.
    */
-  std::vector<PointOnLinks> transitionContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.transitionContactPoints();
+  const std::vector<PointOnLinks> &transitionContactPoints() const {
+    return transition_contact_points_;
   }
 
   /**
@@ -99,7 +124,9 @@ class Trajectory {
   size_t numPhases() const { return phases_.size(); }
 
   /**
-   * @fn Builds vector of Transition Graphs.
+   * @fn Builds vector of Transition Graphs, concurrently when GTSAM is built
+   * with TBB. The graph of each distinct transition contact set is built
+   * once and shifted in time to its other boundaries, see SliceTemplate.
    * @param[in] robot            Robot specification from URDF/SDF.
    * @param[in] graph_builder    Dynamics Graph
    * @param[in] mu               Coefficient of static friction
@@ -121,7 +148,22 @@ class Trajectory {
       const CollocationScheme collocation, double mu) const;
 
   /**
-   * @fn Returns Initial values for transition graphs.
+   * @fn Appends the multi-phase factor graph to graph.
+   * @param[out] graph           Factor graph to append to.
+   * @param[in] robot            Robot specification from URDF/SDF.
+   * @param[in] graph_builder    GraphBuilder instance.
+   * @param[in] collocation      Which collocation scheme to use.
+   * @param[in] mu               Coefficient of static friction.
+   */
+  void multiPhaseFactorGraph(gtsam::NonlinearFactorGraph *graph,
+                             const Robot &robot,
+                             const DynamicsGraph &graph_builder,
+                             const CollocationScheme collocation,
+                             double mu) const;
+
+  /**
+   * @fn Returns Initial values for transition graphs, concurrently when GTSAM
+   * is built with TBB.
    * @param[in] robot             Robot specification from URDF/SDF.
    * @param[in] initializer       Initializer class to initialize with
    * @param[in] gaussian_noise    Gaussian noise to add to initial values
@@ -146,16 +188,7 @@ class Trajectory {
    * @fn Returns a vector of final time step for every phase.
    * @return Vector of final time steps.
    */
-  std::vector<int> finalTimeSteps() const {
-    int final_timestep = 0;
-    std::vector<int> final_timesteps;
-    for (size_t i = 0; i < phases_.size(); i++) {
-      int phase_timestep = phases_[i].numTimeSteps();
-      final_timestep += phase_timestep;
-      final_timesteps.push_back(final_timestep);
-    }
-    return final_timesteps;
-  }
+  const std::vector<int> &finalTimeSteps() const { return final_timesteps_; }
 
   /**
    * @fn Return phase for given phase number p.
@@ -170,8 +203,7 @@ class Trajectory {
    * @return Initial time step.
    */
   int getStartTimeStep(size_t p) const {
-    std::vector<int> final_timesteps = finalTimeSteps();
-    int k_start = final_timesteps[p] - phase(p).numTimeSteps();
+    int k_start = final_timesteps_[p] - phase(p).numTimeSteps();
     if (p != 0) k_start += 1;
     return k_start;
   }
@@ -181,7 +213,16 @@ class Trajectory {
    * @param[in] p    Phase number.
    * @return Final time step.
    */
-  int getEndTimeStep(size_t p) const { return finalTimeSteps()[p]; }
+  int getEndTimeStep(size_t p) const { return final_timesteps_[p]; }
+
+  /**
+   * @fn Returns the phase a time step belongs to, in O(log P) for P phases.
+   * The final time step of a phase, where the transition to the next one
+   * happens, belongs to that phase.
+   * @param[in] k    Time step, at most the final time step of the trajectory.
+   * @return Phase number.
+   */
+  size_t phaseIndex(int k) const;
 
   /**
    * @fn Generates a PointGoalFactor object
@@ -247,6 +288,44 @@ class Trajectory {
       const gtsam::SharedNoiseModel &joint_velocity_model,
       const gtsam::SharedNoiseModel &joint_acceleration_model) const;
 
+  /**
+   * @fn Create cyclic boundary conditions for a single periodic walk cycle.
+   *
+   * Ties the last slice K to slice 0: link poses at K equal the poses at 0
+   * moved by the base displacement, and link twists, joint angles and joint
+   * velocities are equal. The gauge is left free, so fix it elsewhere, e.g.,
+   * with a prior on one link pose at time step 0.
+   *
+   * @param[in,out] graph nonlinear factor graph to add to.
+   * @param[in] robot Robot specification from URDF/SDF.
+   * @param[in] displacement world-frame motion of the base over one cycle.
+   */
+  void addPeriodicBoundaryConditions(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+      const gtsam::Pose3 &displacement,
+      const gtsam::SharedNoiseModel &pose_model,
+      const gtsam::SharedNoiseModel &twist_model,
+      const gtsam::SharedNoiseModel &joint_angle_model,
+      const gtsam::SharedNoiseModel &joint_velocity_model) const;
+
+  /**
+   * @fn Replicate the solution of a periodic trajectory.
+   *
+   * Copies the values of this trajectory `repeat` times, each copy shifted
+   * by K time steps and numPhases() phases, with link poses moved by the
+   * displacement, and times in TimeKey offset by the cycle duration. The
+   * last slice of each copy is the first of the next, so the result is a
+   * consistent solution for Trajectory(walk_cycle, repeat) when this
+   * trajectory is a single walk cycle.
+   *
+   * @param[in] cycle solution with periodic boundary conditions.
+   * @param[in] repeat number of cycles in the result.
+   * @param[in] displacement world-frame motion of the base over one cycle.
+   */
+  gtsam::Values repeatPeriodicSolution(const gtsam::Values &cycle,
+                                       size_t repeat,
+                                       const gtsam::Pose3 &displacement) const;
+
   /**
    * @fn Add priors on all variable time steps.
    * @param[in, out] graph NonlinearFactorGraph to add to
@@ -255,11 +334,21 @@ class Trajectory {
    */
   void addIntegrationTimeFactors(gtsam::NonlinearFactorGraph *graph,
                                  double desired_dt, double sigma = 0) const {
-    auto model = gtsam::noiseModel::Isotropic::Sigma(1, sigma);
+    auto model = InternedIsotropic(1, sigma);
     for (size_t phase = 0; phase < numPhases(); phase++)
       graph->addPrior<double>(PhaseKey(phase), desired_dt, model);
   }
 
+  /**
+   * @fn Add priors on the time step of each phase.
+   * @param[in, out] graph NonlinearFactorGraph to add to
+   * @param[in] desired_dts desired time step of each phase
+   * @param[in] sigma      standard deviation (default 0: constrained)
+   */
+  void addIntegrationTimeFactors(gtsam::NonlinearFactorGraph *graph,
+                                 const std::vector<double> &desired_dts,
+                                 double sigma = 0) const;
+
   /**
    * @fn Writes the angles, vels, accels, torques and time values for a single
    * phase to disk.
@@ -279,5 +368,38 @@ class Trajectory {
    */
   void writeToFile(const Robot &robot, const std::string &name,
                    const gtsam::Values &results) const;
+
+  /**
+   * @fn Returns the angles, vels, accels, torques and dt of all phases, one
+   * row per time step of each phase, as in writeToFile.
+   * @param[in] robot     Robot specification from URDF/SDF.
+   * @param[in] results   Results of Optimization.
+   */
+  gtsam::Matrix jointMatrix(const Robot &robot,
+                            const gtsam::Values &results) const;
+
+  /**
+   * @fn Returns a spline of the joint values of all phases, to evaluate the
+   * solved trajectory at any time, see TrajectorySpline.
+   * @param[in] robot        Robot specification from URDF/SDF.
+   * @param[in] results      Results of Optimization.
+   * @param[in] collocation  Collocation scheme of the optimization.
+   */
+  TrajectorySpline spline(const Robot &robot, const gtsam::Values &results,
+                          CollocationScheme collocation = Trapezoidal) const {
+    return TrajectorySpline::FromValues(robot, results, phaseDurations(),
+                                        collocation);
+  }
+
+  /**
+   * @fn Writes the angles, vels, accels, torques and dt of all phases to a
+   * binary trajectory file, see TrajectoryFile.h. Unlike writeToFile, the
+   * phases are written once.
+   * @param[in] robot     Robot specification from URDF/SDF.
+   * @param[in] name      Trajectory File name.
+   * @param[in] results   Results of Optimization.
+   */
+  void writeToBinaryFile(const Robot &robot, const std::string &name,
+                         const gtsam::Values &results) const;
 };
 }  // namespace gtdynamics
@@ -0,0 +1,171 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFile.cpp
+ * @brief Columnar binary trajectory files, memory-mapped for reading.
+ */
+
+#include <gtdynamics/utils/TrajectoryFile.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+static const char kMagic[8] = {'G', 'T', 'D', 'T', 'R', 'A', 'J', '\0'};
+static constexpr size_t kFixedHeaderSize = 32;
+static constexpr size_t kTableAlignment = 64;
+
+namespace {
+// Fixed part of the header, at offset 0.
+struct FixedHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_joints;
+  uint32_t num_phases;
+  uint32_t num_steps;
+  uint64_t table_offset;
+};
+static_assert(sizeof(FixedHeader) == kFixedHeaderSize,
+              "unexpected trajectory file header size");
+}  // namespace
+
+/* ************************************************************************* */
+void WriteTrajectoryFile(const std::string &name,
+                         const std::vector<std::string> &joint_names,
+                         const std::vector<int> &phase_steps,
+                         const std::vector<double> &phase_dts,
+                         const gtsam::Matrix &table) {
+  const size_t J = joint_names.size(), P = phase_steps.size();
+  const size_t N = table.rows();
+  if (phase_dts.size() != P) {
+    throw std::invalid_argument(
+        "WriteTrajectoryFile: phase_steps and phase_dts differ in size.");
+  }
+  if (size_t(table.cols()) != 4 * J + 1) {
+    throw std::invalid_argument(
+        "WriteTrajectoryFile: table should have 4J + 1 columns.");
+  }
+  if (size_t(std::accumulate(phase_steps.begin(), phase_steps.end(), 0)) !=
+      N) {
+    throw std::invalid_argument(
+        "WriteTrajectoryFile: phase_steps should add up to the table rows.");
+  }
+
+  // Variable part of the header.
+  std::string header(kFixedHeaderSize, '\0');
+  header.append(reinterpret_cast<const char *>(phase_dts.data()),
+                P * sizeof(double));
+  for (int steps : phase_steps) {
+    const uint32_t n = steps;
+    header.append(reinterpret_cast<const char *>(&n), sizeof(n));
+  }
+  for (auto &&joint_name : joint_names) {
+    header.append(joint_name.c_str(), joint_name.size() + 1);
+  }
+  const size_t padding =
+      (kTableAlignment - header.size() % kTableAlignment) % kTableAlignment;
+  header.append(padding, '\0');
+
+  FixedHeader fixed;
+  std::memcpy(fixed.magic, kMagic, sizeof(kMagic));
+  fixed.version = kTrajectoryFileVersion;
+  fixed.num_joints = J;
+  fixed.num_phases = P;
+  fixed.num_steps = N;
+  fixed.table_offset = header.size();
+  std::memcpy(&header[0], &fixed, sizeof(fixed));
+
+  // Matrices are column-major, so the table is written as is.
+  std::ofstream file(name, std::ios::binary);
+  file.write(header.data(), header.size());
+  file.write(reinterpret_cast<const char *>(table.data()),
+             table.size() * sizeof(double));
+  if (!file) {
+    throw std::runtime_error("WriteTrajectoryFile: could not write " + name);
+  }
+}
+
+/* ************************************************************************* */
+TrajectoryFile::TrajectoryFile(const std::string &name) {
+  const int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("TrajectoryFile: could not open " + name);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || size_t(st.st_size) < kFixedHeaderSize) {
+    ::close(fd);
+    throw std::runtime_error("TrajectoryFile: " + name + " is too short.");
+  }
+  size_ = st.st_size;
+  data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // the mapping stays valid
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    throw std::runtime_error("TrajectoryFile: could not map " + name);
+  }
+
+  // Unmap if the header is invalid, as the destructor will not run.
+  auto fail = [&](const std::string &what) {
+    ::munmap(data_, size_);
+    throw std::runtime_error("TrajectoryFile: " + name + " " + what);
+  };
+
+  const char *bytes = static_cast<const char *>(data_);
+  FixedHeader fixed;
+  std::memcpy(&fixed, bytes, sizeof(fixed));
+  if (std::memcmp(fixed.magic, kMagic, sizeof(kMagic)) != 0) {
+    fail("is not a trajectory file.");
+  }
+  if (fixed.version != kTrajectoryFileVersion) {
+    fail("has an unsupported version.");
+  }
+  num_joints_ = fixed.num_joints;
+  num_steps_ = fixed.num_steps;
+  const size_t P = fixed.num_phases;
+  const size_t table_size = (4 * num_joints_ + 1) * num_steps_;
+  if (fixed.table_offset % kTableAlignment != 0 ||
+      fixed.table_offset > size_ ||
+      (size_ - fixed.table_offset) / sizeof(double) < table_size ||
+      kFixedHeaderSize + P * (sizeof(double) + sizeof(uint32_t)) >
+          fixed.table_offset) {
+    fail("is truncated or corrupt.");
+  }
+
+  const char *p = bytes + kFixedHeaderSize;
+  phase_dts_.resize(P);
+  std::memcpy(phase_dts_.data(), p, P * sizeof(double));
+  p += P * sizeof(double);
+  for (size_t i = 0; i < P; i++, p += sizeof(uint32_t)) {
+    uint32_t n;
+    std::memcpy(&n, p, sizeof(n));
+    phase_steps_.push_back(n);
+  }
+  const char *end = bytes + fixed.table_offset;
+  for (size_t j = 0; j < num_joints_; j++) {
+    const char *nul = static_cast<const char *>(std::memchr(p, '\0', end - p));
+    if (!nul) fail("has corrupt joint names.");
+    joint_names_.emplace_back(p, nul);
+    p = nul + 1;
+  }
+  table_ = reinterpret_cast<const double *>(end);
+}
+
+/* ************************************************************************* */
+TrajectoryFile::~TrajectoryFile() {
+  if (data_) ::munmap(data_, size_);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,130 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFile.h
+ * @brief Columnar binary trajectory files, memory-mapped for reading.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Trajectory files store the same table as Trajectory::writeToFile, one row
+ * per time step with the joint angles, velocities, accelerations, torques and
+ * dt, but column-major in binary so that each quantity of each joint is
+ * contiguous and the table can be used in place. The layout, in host byte
+ * order (little-endian on all supported platforms), is:
+ *
+ *   offset  size         contents
+ *   0       8            magic "GTDTRAJ\0"
+ *   8       4            uint32 version, 1
+ *   12      4            uint32 number of joints J
+ *   16      4            uint32 number of phases P
+ *   20      4            uint32 number of rows N
+ *   24      8            uint64 byte offset of the table, a multiple of 64
+ *   32      8 P          double dt of each phase
+ *   ...     4 P          uint32 number of rows of each phase
+ *   ...                  J NUL-terminated joint names, then zero padding
+ *   offset  8 N (4J + 1) double table, column-major
+ */
+static constexpr uint32_t kTrajectoryFileVersion = 1;
+
+/**
+ * Write a trajectory file in a single pass.
+ * @param name         file name
+ * @param joint_names  names of the J joints, in the order of the columns
+ * @param phase_steps  number of rows of each phase, adding up to N
+ * @param phase_dts    dt of each phase
+ * @param table        N x (4J + 1) table of angles, velocities,
+ *                     accelerations, torques and dt
+ */
+void WriteTrajectoryFile(const std::string &name,
+                         const std::vector<std::string> &joint_names,
+                         const std::vector<int> &phase_steps,
+                         const std::vector<double> &phase_dts,
+                         const gtsam::Matrix &table);
+
+/**
+ * TrajectoryFile maps a trajectory file in memory, read-only. The table
+ * accessors return Eigen maps into the mapping, so nothing is copied and
+ * they are valid as long as the TrajectoryFile is alive.
+ */
+class TrajectoryFile {
+ public:
+  using ConstMatrixMap = Eigen::Map<const gtsam::Matrix>;
+  using ConstVectorMap = Eigen::Map<const gtsam::Vector>;
+
+ private:
+  void *data_ = nullptr;
+  size_t size_ = 0;
+  size_t num_joints_ = 0, num_steps_ = 0;
+  const double *table_ = nullptr;
+  std::vector<std::string> joint_names_;
+  std::vector<int> phase_steps_;
+  std::vector<double> phase_dts_;
+
+  // Columns [i * J, (i + 1) * J) of the table.
+  ConstMatrixMap block(size_t i) const {
+    return ConstMatrixMap(table_ + i * num_joints_ * num_steps_, num_steps_,
+                          num_joints_);
+  }
+
+ public:
+  /// Constructor, maps the file. Throws std::runtime_error if it is invalid.
+  explicit TrajectoryFile(const std::string &name);
+
+  ~TrajectoryFile();
+
+  TrajectoryFile(const TrajectoryFile &) = delete;
+  TrajectoryFile &operator=(const TrajectoryFile &) = delete;
+
+  /// Return the joint names, in the order of the columns.
+  const std::vector<std::string> &jointNames() const { return joint_names_; }
+
+  /// Return the number of rows of each phase.
+  const std::vector<int> &phaseSteps() const { return phase_steps_; }
+
+  /// Return the dt of each phase.
+  const std::vector<double> &phaseDts() const { return phase_dts_; }
+
+  /// Return the number of rows.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Return the whole N x (4J + 1) table.
+  ConstMatrixMap table() const {
+    return ConstMatrixMap(table_, num_steps_, 4 * num_joints_ + 1);
+  }
+
+  /// Return the N x J joint angles.
+  ConstMatrixMap jointAngles() const { return block(0); }
+
+  /// Return the N x J joint velocities.
+  ConstMatrixMap jointVels() const { return block(1); }
+
+  /// Return the N x J joint accelerations.
+  ConstMatrixMap jointAccels() const { return block(2); }
+
+  /// Return the N x J torques.
+  ConstMatrixMap torques() const { return block(3); }
+
+  /// Return the dt of each row.
+  ConstVectorMap dts() const {
+    return ConstVectorMap(table_ + 4 * num_joints_ * num_steps_, num_steps_);
+  }
+};
+
+}  // namespace gtdynamics
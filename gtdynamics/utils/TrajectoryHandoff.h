@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryHandoff.h
+ * @brief Lock-free handoff of trajectories from a planner to a controller.
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/TrajectorySpline.h>
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace gtdynamics {
+
+/**
+ * TripleBuffer hands values of type T from one writer thread to one reader
+ * thread without locks. It holds three slots: the writer fills its own back
+ * slot and publishes it by swapping it with the shared middle slot, and the
+ * reader takes the middle slot in exchange for its front slot when a newer
+ * value was published. Neither side ever waits for the other, and the reader
+ * only swaps indices, so it does not allocate or free: the values it gives
+ * up are overwritten, and freed, by the writer.
+ *
+ * The reader always sees the newest published value at the time of its
+ * update(); values published in between are skipped.
+ */
+template <class T>
+class TripleBuffer {
+ private:
+  // The index of the middle slot, with kFresh set while it is unread.
+  static constexpr uint8_t kFresh = 4;
+  static constexpr uint8_t kIndex = 3;
+
+  T slots_[3];
+  std::atomic<uint8_t> middle_{1};
+  uint8_t back_ = 0, front_ = 2;      // owned by the writer and reader
+  uint64_t versions_[3] = {0, 0, 0};  // publish count of each slot
+  uint64_t num_published_ = 0;        // owned by the writer
+
+ public:
+  /// Constructor, with all slots default-constructed and at version 0.
+  TripleBuffer() {}
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+  /// @name Writer
+  /// @{
+
+  /// Return the back slot, to fill in place before publish().
+  T &back() { return slots_[back_]; }
+
+  /// Publish the back slot, and return a new back slot to write.
+  T &publish() {
+    versions_[back_] = ++num_published_;
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            kIndex;
+    return slots_[back_];
+  }
+
+  /// Move a value into the back slot and publish it.
+  void publish(T &&value) {
+    back() = std::move(value);
+    publish();
+  }
+
+  /// @}
+  /// @name Reader
+  /// @{
+
+  /**
+   * Switch to the newest published value, if not yet read, and return
+   * whether it changed. Wait-free.
+   */
+  bool update() {
+    if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    return true;
+  }
+
+  /// Return the value read by the last update(), default before any.
+  const T &front() const { return slots_[front_]; }
+
+  /// Return the publish count of front(), 0 before the first one.
+  uint64_t version() const { return versions_[front_]; }
+
+  /// @}
+};
+
+/**
+ * Handoff of trajectory splines from a planner thread, which publishes new
+ * plans, to a control thread, which evaluates the newest one at controller
+ * rate. For example, on the planner side:
+ *
+ *   handoff.publish(trajectory.spline(robot, results));
+ *
+ * and in the control loop:
+ *
+ *   handoff.update();
+ *   handoff.front().evaluate(t, &q, &v, &a, &tau);
+ */
+using TrajectoryHandoff = TripleBuffer<TrajectorySpline>;
+
+}  // namespace gtdynamics
@@ -0,0 +1,215 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectorySpline.cpp
+ * @brief Piecewise-polynomial joint trajectories, to evaluate solved
+ * trajectories at controller rate.
+ */
+
+#include <gtdynamics/utils/TrajectorySpline.h>
+#include <gtdynamics/utils/TrajectoryState.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+constexpr int TrajectorySpline::kDegree;
+constexpr int TrajectorySpline::kNumCoefficients;
+
+// Number of quantities per joint: angle, velocity, acceleration and torque.
+static constexpr size_t kNumQuantities = 4;
+
+// Buckets per time step in the lookup grid, at most.
+static constexpr size_t kMaxBucketsPerStep = 16;
+
+namespace {
+
+// Coefficients of x(s) = sum c[i] s^i, for s in [0, h].
+struct Polynomial {
+  double *c;
+
+  // x0 held.
+  void hold(double x0) { c[0] = x0; }
+
+  // Through x0 with slope d0.
+  void line(double x0, double d0) {
+    c[0] = x0;
+    c[1] = d0;
+  }
+
+  // Integral of the derivative linear from d0 to d1.
+  void trapezoid(double x0, double d0, double d1, double h) {
+    line(x0, d0);
+    c[2] = (d1 - d0) / (2 * h);
+  }
+
+  // Cubic Hermite through x and its derivative d at both ends.
+  void cubic(double x0, double d0, double x1, double d1, double h) {
+    line(x0, d0);
+    c[2] = (3 * (x1 - x0) / h - 2 * d0 - d1) / h;
+    c[3] = (2 * (x0 - x1) / h + d0 + d1) / (h * h);
+  }
+
+  // Quintic Hermite through x and its first and second derivatives d and dd
+  // at both ends.
+  void quintic(double x0, double d0, double dd0, double x1, double d1,
+               double dd1, double h) {
+    const double h2 = h * h, h3 = h2 * h;
+    line(x0, d0);
+    c[2] = dd0 / 2;
+    c[3] = (20 * (x1 - x0) - (8 * d1 + 12 * d0) * h - (3 * dd0 - dd1) * h2) /
+           (2 * h3);
+    c[4] = (30 * (x0 - x1) + (14 * d1 + 16 * d0) * h +
+            (3 * dd0 - 2 * dd1) * h2) /
+           (2 * h3 * h);
+    c[5] = (12 * (x1 - x0) - 6 * (d1 + d0) * h - (dd0 - dd1) * h2) /
+           (2 * h3 * h2);
+  }
+};
+
+}  // namespace
+
+/* ************************************************************************* */
+TrajectorySpline::TrajectorySpline(const std::vector<double> &times,
+                                   const Matrix &q, const Matrix &v,
+                                   const Matrix &a, const Matrix &tau,
+                                   const CollocationScheme collocation)
+    : num_joints_(q.rows()), times_(times) {
+  const size_t N = times.size(), J = num_joints_;
+  if (N < 2) {
+    throw std::invalid_argument("TrajectorySpline: needs two knots.");
+  }
+  for (const Matrix *m : {&q, &v, &a, &tau}) {
+    if (size_t(m->rows()) != J || size_t(m->cols()) != N) {
+      throw std::invalid_argument(
+          "TrajectorySpline: quantities should be J x N, for N knots.");
+    }
+  }
+
+  double min_dt = times[1] - times[0];
+  coefficients_.assign((N - 1) * kNumQuantities * J * kNumCoefficients, 0.0);
+  for (size_t k = 0; k + 1 < N; k++) {
+    const double h = times[k + 1] - times[k];
+    if (!(h > 0)) {
+      throw std::invalid_argument("TrajectorySpline: times should increase.");
+    }
+    min_dt = std::min(min_dt, h);
+    double *step = coefficients_.data() + k * kNumQuantities * J *
+                                              kNumCoefficients;
+    for (size_t j = 0; j < J; j++) {
+      Polynomial pq{step + (0 * J + j) * kNumCoefficients};
+      Polynomial pv{step + (1 * J + j) * kNumCoefficients};
+      Polynomial pa{step + (2 * J + j) * kNumCoefficients};
+      Polynomial ptau{step + (3 * J + j) * kNumCoefficients};
+      const double q0 = q(j, k), q1 = q(j, k + 1), v0 = v(j, k),
+                   v1 = v(j, k + 1), a0 = a(j, k), a1 = a(j, k + 1);
+      switch (collocation) {
+        case Euler:
+          pq.line(q0, v0);
+          pv.line(v0, a0);
+          pa.hold(a0);
+          ptau.hold(tau(j, k));
+          continue;
+        case Trapezoidal:
+          pq.trapezoid(q0, v0, v1, h);
+          pv.trapezoid(v0, a0, a1, h);
+          break;
+        case HermiteSimpson:
+          pq.quintic(q0, v0, a0, q1, v1, a1, h);
+          pv.trapezoid(v0, a0, a1, h);
+          break;
+        default:
+          pq.cubic(q0, v0, q1, v1, h);
+          pv.cubic(v0, a0, v1, a1, h);
+          break;
+      }
+      pa.line(a0, (a1 - a0) / h);
+      ptau.line(tau(j, k), (tau(j, k + 1) - tau(j, k)) / h);
+    }
+  }
+
+  // Buckets no wider than the shortest step, so that a bucket starts in the
+  // step of its lookup or the one before, unless that would take too many.
+  const double T = times.back() - times.front();
+  const size_t num_buckets = std::max<size_t>(
+      1, std::min<size_t>(std::ceil(T / min_dt),
+                          kMaxBucketsPerStep * (N - 1)));
+  bucket_width_inv_ = num_buckets / T;
+  buckets_.resize(num_buckets + 1);
+  for (size_t b = 0, k = 0; b <= num_buckets; b++) {
+    const double t = times.front() + b / bucket_width_inv_;
+    while (k + 2 < N && times[k + 1] <= t) k++;
+    buckets_[b] = k;
+  }
+}
+
+/* ************************************************************************* */
+TrajectorySpline TrajectorySpline::FromValues(
+    const Robot &robot, const gtsam::Values &results,
+    const std::vector<int> &phase_steps,
+    const CollocationScheme collocation) {
+  const int num_steps =
+      std::accumulate(phase_steps.begin(), phase_steps.end(), 0);
+  TrajectoryState state(robot, num_steps + 1,
+                        TrajectoryState::kJointQuantities);
+  for (int k = 0; k <= num_steps; k++) state.setStep(k, results, k);
+
+  std::vector<double> times(1, 0.0);
+  for (size_t p = 0; p < phase_steps.size(); p++) {
+    const double dt = results.atDouble(PhaseKey(p));
+    for (int step = 0; step < phase_steps[p]; step++) {
+      times.push_back(times.back() + dt);
+    }
+  }
+  return TrajectorySpline(times, state.jointAngles(), state.jointVels(),
+                          state.jointAccels(), state.torques(), collocation);
+}
+
+/* ************************************************************************* */
+size_t TrajectorySpline::step(double t) const {
+  const double s = (t - times_.front()) * bucket_width_inv_;
+  const size_t num_buckets = buckets_.size() - 1;
+  const size_t b =
+      s <= 0 ? 0 : std::min(static_cast<size_t>(s), num_buckets);
+  size_t k = buckets_[b];
+  while (k + 2 < times_.size() && times_[k + 1] <= t) k++;
+  return k;
+}
+
+/* ************************************************************************* */
+void TrajectorySpline::evaluate(double t, Vector *q, Vector *v, Vector *a,
+                                Vector *tau) const {
+  if (times_.empty()) {
+    throw std::logic_error("TrajectorySpline: evaluating an empty spline.");
+  }
+  t = std::min(std::max(t, times_.front()), times_.back());
+  const size_t k = step(t), J = num_joints_;
+  const double s = t - times_[k];
+  const double *coefficients =
+      coefficients_.data() + k * kNumQuantities * J * kNumCoefficients;
+  Vector *outputs[kNumQuantities] = {q, v, a, tau};
+  for (size_t i = 0; i < kNumQuantities; i++) {
+    if (!outputs[i]) continue;
+    Vector &x = *outputs[i];
+    if (size_t(x.size()) != J) x.resize(J);
+    const double *c = coefficients + i * J * kNumCoefficients;
+    for (size_t j = 0; j < J; j++, c += kNumCoefficients) {
+      double value = c[kDegree];
+      for (int d = kDegree - 1; d >= 0; d--) value = value * s + c[d];
+      x(j) = value;
+    }
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectorySpline.h
+ * @brief Piecewise-polynomial joint trajectories, to evaluate solved
+ * trajectories at controller rate.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * TrajectorySpline holds the joint angles, velocities, accelerations and
+ * torques of a solved trajectory as one polynomial per time step and
+ * quantity, interpolated as the collocation scheme integrates them:
+ *
+ *   Euler           q and v linear, with the slope of the first knot, and
+ *                   a and tau held
+ *   Trapezoidal     q and v quadratic, with derivatives linear between the
+ *                   knots, and a and tau linear
+ *   HermiteSimpson  q quintic Hermite through q, v and a at both knots,
+ *                   v as Trapezoidal, and a and tau linear
+ *
+ * Other schemes interpolate q and v as cubic Hermite splines, and a and tau
+ * linearly. The coefficients are stored contiguously per time step, and a
+ * uniform bucket grid over time finds the step of any time in O(1), so
+ * evaluation at controller rate does a lookup and a few multiply-adds per
+ * joint, without allocating.
+ */
+class TrajectorySpline {
+ public:
+  /// Maximum polynomial degree, and number of coefficients per polynomial.
+  static constexpr int kDegree = 5;
+  static constexpr int kNumCoefficients = kDegree + 1;
+
+ private:
+  size_t num_joints_ = 0;
+  std::vector<double> times_;         // knot times
+  std::vector<double> coefficients_;  // by step, quantity, joint
+  std::vector<size_t> buckets_;       // step at the start of each bucket
+  double bucket_width_inv_ = 0;
+
+  // Return the time step of the interval containing t, clamped.
+  size_t step(double t) const;
+
+ public:
+  /// Default constructor, an empty spline.
+  TrajectorySpline() {}
+
+  /**
+   * Construct from the knots of a trajectory.
+   * @param times        increasing times of the N knots, N >= 2
+   * @param q            J x N joint angles at the knots
+   * @param v            J x N joint velocities
+   * @param a            J x N joint accelerations
+   * @param tau          J x N joint torques
+   * @param collocation  collocation scheme of the solve
+   * @throws std::invalid_argument if the sizes differ or the times do not
+   * increase.
+   */
+  TrajectorySpline(const std::vector<double> &times, const gtsam::Matrix &q,
+                   const gtsam::Matrix &v, const gtsam::Matrix &a,
+                   const gtsam::Matrix &tau,
+                   const CollocationScheme collocation = Trapezoidal);
+
+  /**
+   * Construct from the results of a multi-phase trajectory solve, where
+   * phase p covers phase_steps[p] time steps of duration PhaseKey(p), as in
+   * DynamicsGraph::multiPhaseTrajectoryFG. Joints are in the order of
+   * robot.joints().
+   * @param robot        the robot
+   * @param results      the solved values, with all joint quantities of the
+   *                     time steps [0, sum of phase_steps] and the PhaseKey
+   *                     of each phase
+   * @param phase_steps  number of time steps of each phase
+   * @param collocation  collocation scheme of the solve
+   */
+  static TrajectorySpline FromValues(
+      const Robot &robot, const gtsam::Values &results,
+      const std::vector<int> &phase_steps,
+      const CollocationScheme collocation = Trapezoidal);
+
+  /// Return the number of joints.
+  size_t numJoints() const { return num_joints_; }
+
+  /// Return the number of time steps, one polynomial each.
+  size_t numSteps() const { return times_.empty() ? 0 : times_.size() - 1; }
+
+  /// Return the knot times.
+  const std::vector<double> &times() const { return times_; }
+
+  /// Return the time of the first knot.
+  double startTime() const { return times_.front(); }
+
+  /// Return the time of the last knot.
+  double endTime() const { return times_.back(); }
+
+  /**
+   * Evaluate the quantities at time t, clamped to [startTime(), endTime()].
+   * Outputs may be null, and do not allocate if they already have
+   * numJoints() entries. At a knot, the polynomial of the step starting
+   * there is evaluated.
+   */
+  void evaluate(double t, gtsam::Vector *q, gtsam::Vector *v = nullptr,
+                gtsam::Vector *a = nullptr,
+                gtsam::Vector *tau = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,201 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryState.cpp
+ * @brief Trajectory values in contiguous arrays, indexed by id and time step.
+ */
+
+#include <gtdynamics/utils/TrajectoryState.h>
+#include <gtdynamics/utils/values.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+
+/* ************************************************************************* */
+TrajectoryState::TrajectoryState(const Robot &robot, size_t num_steps,
+                                 unsigned quantities, int t0)
+    : t0_(t0), num_steps_(num_steps), quantities_(quantities & kAll) {
+  for (auto &&joint : robot.joints()) {
+    joint_ids_.push_back(joint->id());
+    parent_ids_.push_back(joint->parent()->id());
+    child_ids_.push_back(joint->child()->id());
+  }
+  for (auto &&link : robot.links()) link_ids_.push_back(link->id());
+
+  // Lookup tables from id to row.
+  auto rows = [](const std::vector<int> &ids) {
+    const int size =
+        ids.empty() ? 0 : *std::max_element(ids.begin(), ids.end()) + 1;
+    std::vector<int> rows(size, -1);
+    for (size_t r = 0; r < ids.size(); r++) rows[ids[r]] = r;
+    return rows;
+  };
+  joint_rows_ = rows(joint_ids_);
+  link_rows_ = rows(link_ids_);
+
+  const size_t J = joint_ids_.size(), L = link_ids_.size();
+  auto zeros = [&](unsigned quantity, size_t rows) {
+    return has(quantity) ? Matrix(Matrix::Zero(rows, num_steps)) : Matrix();
+  };
+  q_ = zeros(kJointAngles, J);
+  v_ = zeros(kJointVels, J);
+  a_ = zeros(kJointAccels, J);
+  tau_ = zeros(kTorques, J);
+  poses_ = zeros(kPoses, 12 * L);
+  twists_ = zeros(kTwists, 6 * L);
+  twist_accels_ = zeros(kTwistAccels, 6 * L);
+  wrenches_ = zeros(kWrenches, 12 * J);
+
+  // Identity rotations.
+  if (has(kPoses)) {
+    for (size_t l = 0; l < L; l++) {
+      for (size_t d : {0, 4, 8}) poses_.row(12 * l + d).setOnes();
+    }
+  }
+}
+
+/* ************************************************************************* */
+int TrajectoryState::jointRow(int j) const {
+  if (j < 0 || size_t(j) >= joint_rows_.size() || joint_rows_[j] < 0) {
+    throw std::invalid_argument("TrajectoryState: no joint with id " +
+                                std::to_string(j));
+  }
+  return joint_rows_[j];
+}
+
+/* ************************************************************************* */
+int TrajectoryState::linkRow(int i) const {
+  if (i < 0 || size_t(i) >= link_rows_.size() || link_rows_[i] < 0) {
+    throw std::invalid_argument("TrajectoryState: no link with id " +
+                                std::to_string(i));
+  }
+  return link_rows_[i];
+}
+
+/* ************************************************************************* */
+int TrajectoryState::wrenchRow(int i, int j) const {
+  const int r = jointRow(j);
+  if (i == parent_ids_[r]) return 12 * r;
+  if (i == child_ids_[r]) return 12 * r + 6;
+  throw std::invalid_argument("TrajectoryState: link " + std::to_string(i) +
+                              " is not connected to joint " +
+                              std::to_string(j));
+}
+
+/* ************************************************************************* */
+Pose3 TrajectoryState::pose(int i, int t) const {
+  const auto column = poses_.block<12, 1>(12 * linkRow(i), t - t0_);
+  return Pose3(gtsam::Rot3(gtsam::Matrix3(column.data())),
+               gtsam::Point3(column.tail<3>()));
+}
+
+/* ************************************************************************* */
+void TrajectoryState::setPose(int i, int t, const Pose3 &pose) {
+  auto column = poses_.block<12, 1>(12 * linkRow(i), t - t0_);
+  column.head<9>() =
+      Eigen::Map<const gtsam::Vector9>(pose.rotation().matrix().data());
+  column.tail<3>() = pose.translation();
+}
+
+/* ************************************************************************* */
+TrajectoryState TrajectoryState::FromValues(const Robot &robot,
+                                            const Values &values,
+                                            size_t num_steps, int t0) {
+  unsigned quantities = 0;
+  if (!robot.joints().empty()) {
+    const auto &joint = robot.joints().front();
+    const int j = joint->id();
+    if (values.exists(JointAngleKey(j, t0))) quantities |= kJointAngles;
+    if (values.exists(JointVelKey(j, t0))) quantities |= kJointVels;
+    if (values.exists(JointAccelKey(j, t0))) quantities |= kJointAccels;
+    if (values.exists(TorqueKey(j, t0))) quantities |= kTorques;
+    if (values.exists(WrenchKey(joint->parent()->id(), j, t0)))
+      quantities |= kWrenches;
+  }
+  if (!robot.links().empty()) {
+    const int i = robot.links().front()->id();
+    if (values.exists(PoseKey(i, t0))) quantities |= kPoses;
+    if (values.exists(TwistKey(i, t0))) quantities |= kTwists;
+    if (values.exists(TwistAccelKey(i, t0))) quantities |= kTwistAccels;
+  }
+
+  TrajectoryState state(robot, num_steps, quantities, t0);
+  for (size_t k = 0; k < num_steps; k++) {
+    state.setStep(t0 + k, values, t0 + k);
+  }
+  return state;
+}
+
+/* ************************************************************************* */
+void TrajectoryState::setStep(int t, const Values &values, int t_values) {
+  const int k = t - t0_;
+  for (size_t r = 0; r < joint_ids_.size(); r++) {
+    const int j = joint_ids_[r];
+    if (has(kJointAngles)) q_(r, k) = JointAngle(values, j, t_values);
+    if (has(kJointVels)) v_(r, k) = JointVel(values, j, t_values);
+    if (has(kJointAccels)) a_(r, k) = JointAccel(values, j, t_values);
+    if (has(kTorques)) tau_(r, k) = Torque(values, j, t_values);
+    if (has(kWrenches)) {
+      wrenches_.block<6, 1>(12 * r, k) =
+          Wrench(values, parent_ids_[r], j, t_values);
+      wrenches_.block<6, 1>(12 * r + 6, k) =
+          Wrench(values, child_ids_[r], j, t_values);
+    }
+  }
+  for (size_t r = 0; r < link_ids_.size(); r++) {
+    const int i = link_ids_[r];
+    if (has(kPoses)) setPose(i, t, Pose(values, i, t_values));
+    if (has(kTwists)) {
+      twists_.block<6, 1>(6 * r, k) = Twist(values, i, t_values);
+    }
+    if (has(kTwistAccels)) {
+      twist_accels_.block<6, 1>(6 * r, k) = TwistAccel(values, i, t_values);
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values TrajectoryState::values() const {
+  Values values;
+  for (size_t k = 0; k < num_steps_; k++) {
+    const int t = t0_ + k;
+    for (size_t r = 0; r < joint_ids_.size(); r++) {
+      const int j = joint_ids_[r];
+      if (has(kJointAngles)) InsertJointAngle(&values, j, t, q_(r, k));
+      if (has(kJointVels)) InsertJointVel(&values, j, t, v_(r, k));
+      if (has(kJointAccels)) InsertJointAccel(&values, j, t, a_(r, k));
+      if (has(kTorques)) InsertTorque(&values, j, t, tau_(r, k));
+      if (has(kWrenches)) {
+        InsertWrench(&values, parent_ids_[r], j, t,
+                     wrenches_.block<6, 1>(12 * r, k));
+        InsertWrench(&values, child_ids_[r], j, t,
+                     wrenches_.block<6, 1>(12 * r + 6, k));
+      }
+    }
+    for (size_t r = 0; r < link_ids_.size(); r++) {
+      const int i = link_ids_[r];
+      if (has(kPoses)) InsertPose(&values, i, t, pose(i, t));
+      if (has(kTwists)) {
+        InsertTwist(&values, i, t, twists_.block<6, 1>(6 * r, k));
+      }
+      if (has(kTwistAccels)) {
+        InsertTwistAccel(&values, i, t, twist_accels_.block<6, 1>(6 * r, k));
+      }
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,162 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryState.h
+ * @brief Trajectory values in contiguous arrays, indexed by id and time step.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * TrajectoryState stores the joint angles, velocities, accelerations and
+ * torques, and the link poses, twists, twist accelerations and joint wrenches
+ * of a robot over time steps [t0, t0 + num_steps), in matrices with one column
+ * per time step. Joint rows are ordered as robot.joints() and link rows as
+ * robot.links(), as in the simulators; access by id and time step is O(1).
+ *
+ * Only the selected quantities are stored. Conversions to and from
+ * gtsam::Values visit each value once, see FromValues and values.
+ */
+class TrajectoryState {
+ public:
+  /// Quantities, to be or-ed together.
+  enum Quantity : unsigned {
+    kJointAngles = 1 << 0,
+    kJointVels = 1 << 1,
+    kJointAccels = 1 << 2,
+    kTorques = 1 << 3,
+    kPoses = 1 << 4,
+    kTwists = 1 << 5,
+    kTwistAccels = 1 << 6,
+    kWrenches = 1 << 7,
+    kJointQuantities = kJointAngles | kJointVels | kJointAccels | kTorques,
+    kAll = (1 << 8) - 1
+  };
+
+ private:
+  std::vector<int> joint_ids_, link_ids_;        // in robot order
+  std::vector<int> joint_rows_, link_rows_;      // by id, -1 if unused
+  std::vector<int> parent_ids_, child_ids_;      // of each joint, by row
+  int t0_ = 0;
+  size_t num_steps_ = 0;
+  unsigned quantities_ = 0;
+  gtsam::Matrix q_, v_, a_, tau_;     // num_joints x num_steps
+  gtsam::Matrix poses_;               // 12 num_links x num_steps
+  gtsam::Matrix twists_, twist_accels_;  // 6 num_links x num_steps
+  gtsam::Matrix wrenches_;  // 12 num_joints, on parent then on child
+
+  int jointRow(int j) const;
+  int linkRow(int i) const;
+  // Row of the wrench of link i at joint j.
+  int wrenchRow(int i, int j) const;
+
+ public:
+  /// Default constructor, an empty state.
+  TrajectoryState() {}
+
+  /**
+   * Constructor, with all stored values zero and poses the identity.
+   * @param robot       the robot
+   * @param num_steps   number of time steps
+   * @param quantities  quantities to store
+   * @param t0          first time step
+   */
+  TrajectoryState(const Robot &robot, size_t num_steps,
+                  unsigned quantities = kAll, int t0 = 0);
+
+  /**
+   * Create from the values at time steps [t0, t0 + num_steps). A quantity is
+   * read if the values contain it for the first joint or link at t0, and then
+   * must be there for all joints or links and time steps.
+   */
+  static TrajectoryState FromValues(const Robot &robot,
+                                    const gtsam::Values &values,
+                                    size_t num_steps, int t0 = 0);
+
+  /**
+   * Copy the stored quantities at time step t_values of the values into time
+   * step t. Throws if the values miss any of them.
+   */
+  void setStep(int t, const gtsam::Values &values, int t_values);
+
+  /// Return the stored quantities as Values, keyed by id and time step.
+  gtsam::Values values() const;
+
+  /// Return the first time step.
+  int t0() const { return t0_; }
+
+  /// Return the number of time steps.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Return the stored quantities.
+  unsigned quantities() const { return quantities_; }
+
+  /// Return whether all the given quantities are stored.
+  bool has(unsigned quantities) const {
+    return (quantities_ & quantities) == quantities;
+  }
+
+  /// @name Joint quantities, num_joints x num_steps.
+  /// @{
+  const gtsam::Matrix &jointAngles() const { return q_; }
+  const gtsam::Matrix &jointVels() const { return v_; }
+  const gtsam::Matrix &jointAccels() const { return a_; }
+  const gtsam::Matrix &torques() const { return tau_; }
+  gtsam::Matrix &jointAngles() { return q_; }
+  gtsam::Matrix &jointVels() { return v_; }
+  gtsam::Matrix &jointAccels() { return a_; }
+  gtsam::Matrix &torques() { return tau_; }
+  /// @}
+
+  /// @name Access by joint id j and time step t.
+  /// @{
+  double jointAngle(int j, int t) const { return q_(jointRow(j), t - t0_); }
+  double jointVel(int j, int t) const { return v_(jointRow(j), t - t0_); }
+  double jointAccel(int j, int t) const { return a_(jointRow(j), t - t0_); }
+  double torque(int j, int t) const { return tau_(jointRow(j), t - t0_); }
+  double &jointAngle(int j, int t) { return q_(jointRow(j), t - t0_); }
+  double &jointVel(int j, int t) { return v_(jointRow(j), t - t0_); }
+  double &jointAccel(int j, int t) { return a_(jointRow(j), t - t0_); }
+  double &torque(int j, int t) { return tau_(jointRow(j), t - t0_); }
+  /// @}
+
+  /// @name Access by link id i, joint id j and time step t.
+  /// @{
+  gtsam::Pose3 pose(int i, int t) const;
+  void setPose(int i, int t, const gtsam::Pose3 &pose);
+  gtsam::Vector6 twist(int i, int t) const {
+    return twists_.block<6, 1>(6 * linkRow(i), t - t0_);
+  }
+  void setTwist(int i, int t, const gtsam::Vector6 &twist) {
+    twists_.block<6, 1>(6 * linkRow(i), t - t0_) = twist;
+  }
+  gtsam::Vector6 twistAccel(int i, int t) const {
+    return twist_accels_.block<6, 1>(6 * linkRow(i), t - t0_);
+  }
+  void setTwistAccel(int i, int t, const gtsam::Vector6 &twist_accel) {
+    twist_accels_.block<6, 1>(6 * linkRow(i), t - t0_) = twist_accel;
+  }
+  gtsam::Vector6 wrench(int i, int j, int t) const {
+    return wrenches_.block<6, 1>(wrenchRow(i, j), t - t0_);
+  }
+  void setWrench(int i, int j, int t, const gtsam::Vector6 &wrench) {
+    wrenches_.block<6, 1>(wrenchRow(i, j), t - t0_) = wrench;
+  }
+  /// @}
+};
+
+}  // namespace gtdynamics
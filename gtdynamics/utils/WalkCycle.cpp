@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/utils/ContentHasher.h>
 #include <gtdynamics/utils/WalkCycle.h> 
 
 namespace gtdynamics {
@@ -28,19 +29,36 @@ castFootContactConstraintSpec(
       constraint_spec);
 }
 
+PointOnLinks WalkCycle::getIntersection(const PointOnLinks &cps1,
+                                        const PointOnLinks &cps2) {
+  std::unordered_multimap<int, const PointOnLink *> cps2_by_link;
+  for (auto &&cp2 : cps2) cps2_by_link.emplace(cp2.link->id(), &cp2);
+
+  PointOnLinks intersection;
+  for (auto &&cp1 : cps1) {
+    auto range = cps2_by_link.equal_range(cp1.link->id());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (cp1 == *it->second) intersection.push_back(cp1);
+    }
+  }
+  return intersection;
+}
+
 void WalkCycle::addPhaseContactPoints(const Phase &phase) {
   // Add unique PointOnLink objects to contact_points_
   auto foot_contact_spec =
       castFootContactConstraintSpec(phase.constraintSpec());
   if (foot_contact_spec) {
     for (auto &&kv : foot_contact_spec->contactPoints()) {
-      int link_count =
-          std::count_if(contact_points_.begin(), contact_points_.end(),
-                        [&](const PointOnLink &contact_point) {
-                          return contact_point.point == kv.point &&
-                                  contact_point.link == kv.link;
-                        });
-      if (link_count == 0) contact_points_.push_back(kv);
+      auto range = contact_index_.equal_range(kv.link->id());
+      bool found = false;
+      for (auto it = range.first; it != range.second && !found; ++it) {
+        found = contact_points_[it->second] == kv;
+      }
+      if (!found) {
+        contact_index_.emplace(kv.link->id(), contact_points_.size());
+        contact_points_.push_back(kv);
+      }
     }
   }
 }
@@ -181,6 +199,13 @@ std::vector<PointOnLinks> WalkCycle::transitionContactPoints() const {
   return trans_cps_orig;
 }
 
+uint64_t WalkCycle::contentHash() const {
+  ContentHasher hasher;
+  hasher.add(phases_.size());
+  for (auto &&phase : phases_) hasher.add(phase.contentHash());
+  return hasher.value();
+}
+
 void WalkCycle::print(const std::string &s) const {
   std::cout << (s.empty() ? s : s + " ") << *this << std::endl;
 }
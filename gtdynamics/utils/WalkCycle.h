@@ -20,6 +20,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace gtdynamics {
@@ -34,19 +35,15 @@ class WalkCycle {
   std::vector<Phase> phases_;    ///< Phases in walk cycle
   PointOnLinks contact_points_;  ///< All unique contact points in the walk cycle
 
- /// Gets the intersection between two PointOnLinks objects
+  /// Indices of contact_points_ on each link, by link id.
+  std::unordered_multimap<int, size_t> contact_index_;
+
+  /**
+   * Gets the intersection between two PointOnLinks objects, in the order of
+   * cps1, with cps2 indexed by link id so it is linear in their sizes.
+   */
   static PointOnLinks getIntersection(const PointOnLinks &cps1,
-                                      const PointOnLinks &cps2) {
-    PointOnLinks intersection;
-    for (auto &&cp1 : cps1) {
-      for (auto &&cp2 : cps2) {
-        if (cp1 == cp2) {
-          intersection.push_back(cp1);
-        }
-      }
-    }
-    return intersection;
-  }
+                                      const PointOnLinks &cps2);
 
  public:
   /// Default Constructor
@@ -175,6 +172,14 @@ class WalkCycle {
 
   /// GTSAM-style print, works with wrapper.
   void print(const std::string& s = "") const;
+
+  /**
+   * Return a content hash of the phases, in order, see Phase::contentHash.
+   * Walk cycles with the same phases and contact points on the same links
+   * have the same hash, in any process, so it can key caches of gait graph
+   * templates and solutions together with Robot::contentHash.
+   */
+  uint64_t contentHash() const;
   
 };
 }  // namespace gtdynamics
@@ -0,0 +1,74 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WeightGroup.cpp
+ * @brief Diagonal noise models whose weight can be changed in place.
+ */
+
+#include <gtdynamics/utils/WeightGroup.h>
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+WeightGroup::WeightGroup(const gtsam::Vector &base_sigmas, double weight)
+    : gtsam::noiseModel::Diagonal(base_sigmas), base_sigmas_(base_sigmas) {
+  if (!(base_sigmas.size() > 0 && (base_sigmas.array() > 0).all())) {
+    throw std::invalid_argument("WeightGroup: base sigmas must be positive.");
+  }
+  setWeight(weight);
+}
+
+/* ************************************************************************* */
+void WeightGroup::setWeight(double weight) {
+  if (!(weight > 0 && std::isfinite(weight))) {
+    throw std::invalid_argument("WeightGroup: weight must be positive.");
+  }
+  weight_ = weight;
+  sigmas_ = base_sigmas_ / std::sqrt(weight);
+  invsigmas_ = sigmas_.array().inverse();
+  precisions_ = invsigmas_.array().square();
+}
+
+/* ************************************************************************* */
+void WeightGroup::print(const std::string &name) const {
+  std::cout << name << "WeightGroup, weight " << weight_ << std::endl;
+  gtsam::noiseModel::Diagonal::print("");
+}
+
+/* ************************************************************************* */
+WeightGroup::shared_ptr WeightGroups::group(const std::string &name,
+                                            const gtsam::Vector &base_sigmas) {
+  auto it = groups_.find(name);
+  if (it == groups_.end()) {
+    return groups_[name] = WeightGroup::Sigmas(base_sigmas);
+  }
+  const gtsam::Vector &existing = it->second->baseSigmas();
+  if (existing.size() != base_sigmas.size() || existing != base_sigmas) {
+    throw std::invalid_argument("WeightGroups: group " + name +
+                                " exists with other base sigmas.");
+  }
+  return it->second;
+}
+
+/* ************************************************************************* */
+void WeightGroups::setWeights(const std::map<std::string, double> &weights) {
+  for (auto &&kv : weights) setWeight(kv.first, kv.second);
+}
+
+/* ************************************************************************* */
+std::map<std::string, double> WeightGroups::weights() const {
+  std::map<std::string, double> weights;
+  for (auto &&kv : groups_) weights[kv.first] = kv.second->weight();
+  return weights;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WeightGroup.h
+ * @brief Diagonal noise models whose weight can be changed in place.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <map>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * A diagonal noise model with base sigmas and a mutable weight w, with
+ * sigmas base / sqrt(w), so that the cost of its factors scales by w.
+ * Factors hold their noise model by pointer, so all factors built with one
+ * group are reweighted by setWeight, without rebuilding the graph: a weight
+ * sweep or online reweighting touches only the groups.
+ *
+ * Changing the weight while a graph is being linearized is a data race, and
+ * factors that cache whitened Jacobians, e.g. ConstantJacobianFactor, keep
+ * the weight they were linearized with.
+ */
+class WeightGroup : public gtsam::noiseModel::Diagonal {
+ public:
+  using shared_ptr = boost::shared_ptr<WeightGroup>;
+
+ private:
+  gtsam::Vector base_sigmas_;
+  double weight_ = 1.0;
+
+ public:
+  /// Constructor, from base sigmas, all positive, and a positive weight.
+  explicit WeightGroup(const gtsam::Vector &base_sigmas, double weight = 1.0);
+
+  /// Create a group with base sigmas.
+  static shared_ptr Sigmas(const gtsam::Vector &base_sigmas,
+                           double weight = 1.0) {
+    return boost::make_shared<WeightGroup>(base_sigmas, weight);
+  }
+
+  /// Create a group with a base sigma in all dim dimensions.
+  static shared_ptr Isotropic(size_t dim, double base_sigma,
+                              double weight = 1.0) {
+    return Sigmas(gtsam::Vector::Constant(dim, base_sigma), weight);
+  }
+
+  /// Return the weight.
+  double weight() const { return weight_; }
+
+  /// Return the sigmas at weight 1.
+  const gtsam::Vector &baseSigmas() const { return base_sigmas_; }
+
+  /// Set the weight, throws std::invalid_argument unless it is positive.
+  void setWeight(double weight);
+
+  void print(const std::string &name = "") const override;
+};
+
+/**
+ * Named weight groups, e.g. one per objective of a trajectory optimization,
+ * created on first use and reweighted by name.
+ */
+class WeightGroups {
+ private:
+  std::map<std::string, WeightGroup::shared_ptr> groups_;
+
+ public:
+  /**
+   * Return the group of a name, created with the base sigmas on first use.
+   * Throws std::invalid_argument if it exists with other base sigmas.
+   */
+  WeightGroup::shared_ptr group(const std::string &name,
+                                const gtsam::Vector &base_sigmas);
+
+  /// Return the group of a name, created isotropic on first use.
+  WeightGroup::shared_ptr group(const std::string &name, size_t dim,
+                                double base_sigma) {
+    return group(name, gtsam::Vector::Constant(dim, base_sigma));
+  }
+
+  /// Return whether a group exists.
+  bool exists(const std::string &name) const {
+    return groups_.count(name) > 0;
+  }
+
+  /// Return an existing group, throws std::out_of_range otherwise.
+  WeightGroup::shared_ptr at(const std::string &name) const {
+    return groups_.at(name);
+  }
+
+  /// Set the weight of an existing group.
+  void setWeight(const std::string &name, double weight) {
+    at(name)->setWeight(weight);
+  }
+
+  /// Set the weights of existing groups, by name.
+  void setWeights(const std::map<std::string, double> &weights);
+
+  /// Return the weights of all groups, by name.
+  std::map<std::string, double> weights() const;
+
+  /// Return the number of groups.
+  size_t size() const { return groups_.size(); }
+};
+
+}  // namespace gtdynamics
@@ -14,6 +14,9 @@
 
 #include <gtdynamics/utils/values.h>
 
+#include <stdexcept>
+#include <string>
+
 namespace gtdynamics {
 
 using gtsam::Pose3;
@@ -99,6 +102,46 @@ double Torque(const Values &values, int j, int t) {
   return at<double>(values, TorqueKey(j, t));
 };
 
+/* ************************************************************************* */
+// Insert a T x J buffer of joint values, one row per time step.
+template <typename KEY>
+static void InsertJointValues(Values *values, const std::vector<int> &joint_ids,
+                              const gtsam::Matrix &buffer, int t, KEY key,
+                              const char *name) {
+  if (buffer.cols() != static_cast<int>(joint_ids.size())) {
+    throw std::invalid_argument(std::string(name) +
+                                ": needs one column per joint id.");
+  }
+  for (int k = 0; k < buffer.rows(); k++) {
+    for (size_t c = 0; c < joint_ids.size(); c++) {
+      values->insert(key(joint_ids[c], t + k), buffer(k, c));
+    }
+  }
+}
+
+void InsertJointAngles(Values *values, const std::vector<int> &joint_ids,
+                       const gtsam::Matrix &angles, int t) {
+  InsertJointValues(values, joint_ids, angles, t, JointAngleKey,
+                    "InsertJointAngles");
+}
+
+void InsertJointVels(Values *values, const std::vector<int> &joint_ids,
+                     const gtsam::Matrix &vels, int t) {
+  InsertJointValues(values, joint_ids, vels, t, JointVelKey,
+                    "InsertJointVels");
+}
+
+void InsertJointAccels(Values *values, const std::vector<int> &joint_ids,
+                       const gtsam::Matrix &accels, int t) {
+  InsertJointValues(values, joint_ids, accels, t, JointAccelKey,
+                    "InsertJointAccels");
+}
+
+void InsertTorques(Values *values, const std::vector<int> &joint_ids,
+                   const gtsam::Matrix &torques, int t) {
+  InsertJointValues(values, joint_ids, torques, t, TorqueKey, "InsertTorques");
+}
+
 /* ************************************************************************* */
 /// Insert pose for i-th link at time t.
 void InsertPose(Values *values, int i, int t, Pose3 value) {
@@ -110,6 +153,19 @@ void InsertPose(Values *values, int i, Pose3 value) {
   values->insert(PoseKey(i), value);
 }
 
+/// Insert poses for i-th link at time steps t, t + 1, ...
+void InsertPoses(Values *values, int i, const gtsam::Matrix &poses, int t) {
+  if (poses.rows() != 12) {
+    throw std::invalid_argument("InsertPoses: poses should be 12 x N.");
+  }
+  for (int n = 0; n < poses.cols(); n++) {
+    const double *pose = poses.col(n).data();
+    values->insert(PoseKey(i, t + n),
+                   Pose3(gtsam::Rot3(gtsam::Matrix3(pose)),
+                         gtsam::Point3(pose + 9)));
+  }
+}
+
 /// Retrieve pose for i-th link at time t.
 Pose3 Pose(const Values &values, int i, int t) {
   return at<Pose3>(values, PoseKey(i, t));
@@ -19,6 +19,8 @@
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <vector>
+
 #define GTD_PRINT(x) ((x).print(#x, gtdynamics::_GTDKeyFormatter))
 
 namespace gtdynamics {
@@ -39,43 +41,44 @@ class KeyDoesNotExist : public gtsam::ValuesKeyDoesNotExist {
   Key definitions.
  ************************************************************************* */
 /// Shorthand for q_j_t, for j-th joint angle at time t.
-inline DynamicsSymbol JointAngleKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("q", j, t);
+constexpr DynamicsSymbol JointAngleKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::Label::JointAngle, j, t);
 }
 
 /// Shorthand for v_j_t, for j-th joint velocity at time t.
-inline DynamicsSymbol JointVelKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("v", j, t);
+constexpr DynamicsSymbol JointVelKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::Label::JointVel, j, t);
 }
 
 /// Shorthand for a_j_t, for j-th joint acceleration at time t.
-inline DynamicsSymbol JointAccelKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("a", j, t);
+constexpr DynamicsSymbol JointAccelKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::Label::JointAccel, j, t);
 }
 
 /// Shorthand for T_j_t, for torque on the j-th joint at time t.
-inline DynamicsSymbol TorqueKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("T", j, t);
+constexpr DynamicsSymbol TorqueKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsSymbol::Label::Torque, j, t);
 }
 
 /// Shorthand for p_i_t, for COM pose on the i-th link at time t.
-inline DynamicsSymbol PoseKey(int i, int t = 0) {
-  return DynamicsSymbol::LinkSymbol("p", i, t);
+constexpr DynamicsSymbol PoseKey(int i, int t = 0) {
+  return DynamicsSymbol::LinkSymbol(DynamicsSymbol::Label::Pose, i, t);
 }
 
 /// Shorthand for V_i_t, for 6D link twist vector on the i-th link.
-inline DynamicsSymbol TwistKey(int i, int t = 0) {
-  return DynamicsSymbol::LinkSymbol("V", i, t);
+constexpr DynamicsSymbol TwistKey(int i, int t = 0) {
+  return DynamicsSymbol::LinkSymbol(DynamicsSymbol::Label::Twist, i, t);
 }
 
 /// Shorthand for A_i_t, for twist accelerations on the i-th link at time t.
-inline DynamicsSymbol TwistAccelKey(int i, int t = 0) {
-  return DynamicsSymbol::LinkSymbol("A", i, t);
+constexpr DynamicsSymbol TwistAccelKey(int i, int t = 0) {
+  return DynamicsSymbol::LinkSymbol(DynamicsSymbol::Label::TwistAccel, i, t);
 }
 
 /// Shorthand for F_i_j_t, wrenches at j-th joint on the i-th link at time t.
-inline DynamicsSymbol WrenchKey(int i, int j, int t = 0) {
-  return DynamicsSymbol::LinkJointSymbol("F", i, j, t);
+constexpr DynamicsSymbol WrenchKey(int i, int j, int t = 0) {
+  return DynamicsSymbol::LinkJointSymbol(DynamicsSymbol::Label::Wrench, i, j,
+                                         t);
 }
 
 /// Custom retrieval that throws KeyDoesNotExist
@@ -264,6 +267,34 @@ gtsam::Vector Torque(const gtsam::VectorValues &values, int j, int t = 0);
  */
 double Torque(const gtsam::Values &values, int j, int t = 0);
 
+/* *************************************************************************
+  Functions for joint trajectories.
+ ************************************************************************* */
+
+/**
+ * @brief Insert joint angles of several joints at time steps t, t + 1, ...
+ *
+ * @param values Values pointer to insert joint angles into.
+ * @param joint_ids The joint ids, one per column of angles.
+ * @param angles T x J buffer, one row per time step, as returned by
+ *        DynamicsGraph::jointAnglesTrajectory.
+ * @param t First time step.
+ */
+void InsertJointAngles(gtsam::Values *values, const std::vector<int> &joint_ids,
+                       const gtsam::Matrix &angles, int t = 0);
+
+/// Insert joint velocities over time steps, see InsertJointAngles.
+void InsertJointVels(gtsam::Values *values, const std::vector<int> &joint_ids,
+                     const gtsam::Matrix &vels, int t = 0);
+
+/// Insert joint accelerations over time steps, see InsertJointAngles.
+void InsertJointAccels(gtsam::Values *values, const std::vector<int> &joint_ids,
+                       const gtsam::Matrix &accels, int t = 0);
+
+/// Insert joint torques over time steps, see InsertJointAngles.
+void InsertTorques(gtsam::Values *values, const std::vector<int> &joint_ids,
+                   const gtsam::Matrix &torques, int t = 0);
+
 /* *************************************************************************
   Functions for Poses.
  ************************************************************************* */
@@ -287,6 +318,18 @@ void InsertPose(gtsam::Values *values, int i, int t, gtsam::Pose3 value);
  */
 void InsertPose(gtsam::Values *values, int i, gtsam::Pose3 value);
 
+/**
+ * @brief Insert poses for i-th link at time steps t, t + 1, ...
+ *
+ * @param values Values pointer to insert Pose3 into.
+ * @param i The link id.
+ * @param poses 12 x N buffer, one column per pose: the rotation matrix
+ *        column-major, then the translation.
+ * @param t First time step.
+ */
+void InsertPoses(gtsam::Values *values, int i, const gtsam::Matrix &poses,
+                 int t = 0);
+
 /**
  * @brief Retrieve pose for i-th link at time t.
  *
@@ -2,7 +2,7 @@ import gtsam
 
 from gtdynamics.gtdynamics import *
 
-from . import sim
+from . import iterate_file, sim, trajectory_file
 
 
 class _GtdKeyFormatter(object):
@@ -12,8 +12,32 @@ class _GtdKeyFormatter(object):
 
 
 class Values(_GtdKeyFormatter, gtsam.Values):
-    pass
+    def __reduce__(self):
+        return (_values_from_binary, (SerializeBinary(self), ))
 
 
 class NonlinearFactorGraph(_GtdKeyFormatter, gtsam.NonlinearFactorGraph):
-    pass
+    def __reduce__(self):
+        return (_graph_from_binary, (SerializeBinary(self), ))
+
+
+# Pickle through the binary boost archives, e.g., to ship robots, graphs and
+# values to multiprocessing workers.
+def _robot_from_binary(data):
+    return DeserializeRobotBinary(data)
+
+
+def _values_from_binary(data):
+    values = Values()
+    values.insert(DeserializeValuesBinary(data))
+    return values
+
+
+def _graph_from_binary(data):
+    graph = NonlinearFactorGraph()
+    graph.push_back(DeserializeGraphBinary(data))
+    return graph
+
+
+Robot.__reduce__ = lambda self: (_robot_from_binary,
+                                 (SerializeBinary(self), ))
@@ -0,0 +1,62 @@
+"""Read binary iterate files written by IterateRecorder.save."""
+
+from typing import NamedTuple
+
+import numpy as np
+
+_MAGIC = b"GTDITER\0"
+_VERSION = 1
+_HEADER = np.dtype([("magic", "S8"), ("version", "<u4"),
+                    ("num_variables", "<u4"), ("num_iterates", "<u8"),
+                    ("data_offset", "<u8")])
+
+
+class IterateFile(NamedTuple):
+    """Contents of an iterate file, with the iterates memory-mapped."""
+    keys: np.ndarray
+    types: str
+    dims: np.ndarray
+    iterates: np.ndarray
+
+    @property
+    def offsets(self) -> np.ndarray:
+        """Offset of each variable in an iterate."""
+        return np.concatenate(([0], np.cumsum(self.dims)[:-1])).astype(int)
+
+    def history(self, i: int) -> np.ndarray:
+        """N x dims[i] history of variable i."""
+        offset = int(self.offsets[i])
+        return self.iterates[:, offset:offset + int(self.dims[i])]
+
+
+def read_iterate_file(path: str) -> IterateFile:
+    """
+    Read an iterate file, see gtdynamics/utils/IterateRecorder.h for the
+    layout. The iterates are a read-only N x D numpy.memmap, so nothing is
+    copied until it is used.
+
+    Args:
+        path: File name.
+    """
+    header = np.fromfile(path, dtype=_HEADER, count=1)
+    if len(header) != 1 or header["magic"][0] != _MAGIC.rstrip(b"\0"):
+        raise ValueError(f"{path} is not an iterate file.")
+    header = header[0]
+    if header["version"] != _VERSION:
+        raise ValueError(f"{path} has an unsupported version.")
+
+    V, N = int(header["num_variables"]), int(header["num_iterates"])
+    offset = int(header["data_offset"])
+    with open(path, "rb") as f:
+        f.seek(_HEADER.itemsize)
+        variable = f.read(offset - _HEADER.itemsize)
+    keys = np.frombuffer(variable, dtype="<u8", count=V)
+    dims = np.frombuffer(variable, dtype="<u4", count=V, offset=8 * V)
+    types = variable[12 * V:13 * V].decode()
+    width = int(dims.sum())
+    if N == 0 or width == 0:
+        iterates = np.zeros((N, width))
+    else:
+        iterates = np.memmap(path, dtype="<f8", mode="r", offset=offset,
+                             shape=(N, width))
+    return IterateFile(keys, types, dims.astype(int), iterates)
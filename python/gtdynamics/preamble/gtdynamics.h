@@ -2,3 +2,30 @@ namespace pybind11 { namespace detail {
     template <typename T>
     struct type_caster<boost::optional<T>> : optional_caster<boost::optional<T>> {};
 }}
+
+// Replace the methods `name` of a wrapped class with the given overloads,
+// called with the GIL released so that Python threads can run them
+// concurrently. Arguments are converted before and results after the call,
+// with the GIL held; the overloads must not touch Python objects.
+template <typename... Overloads>
+void DefReleasingGil(pybind11::object cls, const char *name,
+                     Overloads... overloads) {
+  pybind11::delattr(cls, name);
+  (void)std::initializer_list<int>{
+      (pybind11::setattr(
+           cls, name,
+           pybind11::cpp_function(
+               overloads, pybind11::name(name), pybind11::is_method(cls),
+               pybind11::sibling(pybind11::getattr(cls, name,
+                                                   pybind11::none())),
+               pybind11::call_guard<pybind11::gil_scoped_release>())),
+       0)...};
+}
+
+// Value types of GTDynamics trajectories, so that Values holding them can be
+// serialized through the boost archives.
+GTSAM_VALUE_EXPORT(double);
+GTSAM_VALUE_EXPORT(gtsam::Point3);
+GTSAM_VALUE_EXPORT(gtsam::Pose3);
+GTSAM_VALUE_EXPORT(gtsam::Vector);
+GTSAM_VALUE_EXPORT(gtsam::Vector6);
@@ -2,3 +2,107 @@
 // These are required to save one copy operation on Python calls
 py::bind_vector<gtdynamics::PointOnLinks>(m_, "PointOnLinks");
 py::bind_map<gtdynamics::ContactPointGoals>(m_, "ContactPointGoals");
+
+// Zero-copy views of the joint matrices of TrajectoryState, as read-only
+// [num_steps x num_joints] NumPy arrays that keep the state alive.
+{
+  using gtdynamics::TrajectoryState;
+  py::object cls = m_.attr("TrajectoryState");
+  auto add_view = [&cls](const char *name,
+                         const gtsam::Matrix &(TrajectoryState::*get)()
+                             const) {
+    py::setattr(cls, name,
+                py::cpp_function(
+                    [get](py::object self) {
+                      const gtsam::Matrix &matrix =
+                          (self.cast<const TrajectoryState &>().*get)();
+                      const py::ssize_t size = sizeof(double);
+                      py::array_t<double> view(
+                          {py::ssize_t(matrix.cols()),
+                           py::ssize_t(matrix.rows())},
+                          {size * matrix.rows(), size}, matrix.data(), self);
+                      view.attr("setflags")(py::arg("write") = false);
+                      return view;
+                    },
+                    py::is_method(cls)));
+  };
+  add_view("jointAnglesArray", &TrajectoryState::jointAngles);
+  add_view("jointVelsArray", &TrajectoryState::jointVels);
+  add_view("jointAccelsArray", &TrajectoryState::jointAccels);
+  add_view("torquesArray", &TrajectoryState::torques);
+}
+
+// Long-running solves and simulations release the GIL. Objects with state,
+// e.g., simulators, must still not be shared between threads.
+{
+  using gtdynamics::ArticulatedBodySolver;
+  using gtdynamics::DynamicsGraph;
+  using gtdynamics::JointSpaceSimulator;
+  using gtdynamics::Robot;
+  using gtdynamics::Simulator;
+  using gtsam::Values;
+  DefReleasingGil(m_.attr("DynamicsGraph"), "linearSolveFD",
+                  [](DynamicsGraph &self, const Robot &robot, int t,
+                     const Values &known_values) {
+                    return self.linearSolveFD(robot, t, known_values);
+                  });
+  DefReleasingGil(m_.attr("DynamicsGraph"), "linearSolveID",
+                  [](DynamicsGraph &self, const Robot &robot, int t,
+                     const Values &known_values) {
+                    return self.linearSolveID(robot, t, known_values);
+                  });
+  DefReleasingGil(m_.attr("ArticulatedBodySolver"), "solveFD",
+                  [](const ArticulatedBodySolver &self,
+                     const Values &known_values, int t) {
+                    return self.solveFD(known_values, t);
+                  });
+  DefReleasingGil(m_.attr("ArticulatedBodySolver"), "solveID",
+                  [](const ArticulatedBodySolver &self,
+                     const Values &known_values, int t) {
+                    return self.solveID(known_values, t);
+                  });
+  DefReleasingGil(m_.attr("Simulator"), "simulate",
+                  [](Simulator &self, const std::vector<Values> &torques_seq,
+                     double dt) { return self.simulate(torques_seq, dt); });
+  DefReleasingGil(m_.attr("Simulator"), "simulateTrajectory",
+                  [](Simulator &self, const std::vector<Values> &torques_seq,
+                     double dt) {
+                    return self.simulateTrajectory(torques_seq, dt);
+                  });
+  DefReleasingGil(m_.attr("JointSpaceSimulator"), "simulate",
+                  [](JointSpaceSimulator &self, const gtsam::Matrix &torques,
+                     double dt) { self.simulate(torques, dt); });
+}
+
+// Binary boost archives of robots, values and graphs, for pickling in
+// __init__.py. They are smaller and faster than the text archives of
+// `serialize`; graphs may only hold factors that serialize.
+{
+  using gtdynamics::Robot;
+  using gtsam::NonlinearFactorGraph;
+  using gtsam::Values;
+  m_.def("SerializeBinary", [](const Robot &robot) {
+    return py::bytes(gtsam::serializeBinary(robot));
+  });
+  m_.def("SerializeBinary", [](const Values &values) {
+    return py::bytes(gtsam::serializeBinary(values));
+  });
+  m_.def("SerializeBinary", [](const NonlinearFactorGraph &graph) {
+    return py::bytes(gtsam::serializeBinary(graph));
+  });
+  m_.def("DeserializeRobotBinary", [](const py::bytes &data) {
+    Robot robot;
+    gtsam::deserializeBinary(std::string(data), robot);
+    return robot;
+  });
+  m_.def("DeserializeValuesBinary", [](const py::bytes &data) {
+    Values values;
+    gtsam::deserializeBinary(std::string(data), values);
+    return values;
+  });
+  m_.def("DeserializeGraphBinary", [](const py::bytes &data) {
+    NonlinearFactorGraph graph;
+    gtsam::deserializeBinary(std::string(data), graph);
+    return graph;
+  });
+}
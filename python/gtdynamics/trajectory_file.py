@@ -0,0 +1,83 @@
+"""Read binary trajectory files written by Trajectory.writeToBinaryFile."""
+
+from typing import List, NamedTuple
+
+import numpy as np
+
+_MAGIC = b"GTDTRAJ\0"
+_VERSION = 1
+_HEADER = np.dtype([("magic", "S8"), ("version", "<u4"),
+                    ("num_joints", "<u4"), ("num_phases", "<u4"),
+                    ("num_steps", "<u4"), ("table_offset", "<u8")])
+
+
+class TrajectoryFile(NamedTuple):
+    """Contents of a trajectory file, with the table memory-mapped."""
+    joint_names: List[str]
+    phase_steps: np.ndarray
+    phase_dts: np.ndarray
+    table: np.ndarray
+
+    @property
+    def num_joints(self) -> int:
+        """Number of joints J."""
+        return len(self.joint_names)
+
+    def _block(self, i: int) -> np.ndarray:
+        J = self.num_joints
+        return self.table[:, i * J:(i + 1) * J]
+
+    @property
+    def joint_angles(self) -> np.ndarray:
+        """N x J joint angles."""
+        return self._block(0)
+
+    @property
+    def joint_vels(self) -> np.ndarray:
+        """N x J joint velocities."""
+        return self._block(1)
+
+    @property
+    def joint_accels(self) -> np.ndarray:
+        """N x J joint accelerations."""
+        return self._block(2)
+
+    @property
+    def torques(self) -> np.ndarray:
+        """N x J torques."""
+        return self._block(3)
+
+    @property
+    def dts(self) -> np.ndarray:
+        """dt of each row."""
+        return self.table[:, -1]
+
+
+def read_trajectory_file(path: str) -> TrajectoryFile:
+    """
+    Read a trajectory file, see gtdynamics/utils/TrajectoryFile.h for the
+    layout. The table is a read-only numpy.memmap, so nothing is copied
+    until it is used.
+
+    Args:
+        path: File name.
+    """
+    header = np.fromfile(path, dtype=_HEADER, count=1)
+    if len(header) != 1 or header["magic"][0] != _MAGIC.rstrip(b"\0"):
+        raise ValueError(f"{path} is not a trajectory file.")
+    header = header[0]
+    if header["version"] != _VERSION:
+        raise ValueError(f"{path} has an unsupported version.")
+
+    J, P = int(header["num_joints"]), int(header["num_phases"])
+    N, offset = int(header["num_steps"]), int(header["table_offset"])
+    with open(path, "rb") as f:
+        f.seek(_HEADER.itemsize)
+        variable = f.read(offset - _HEADER.itemsize)
+    phase_dts = np.frombuffer(variable, dtype="<f8", count=P)
+    phase_steps = np.frombuffer(variable, dtype="<u4", count=P, offset=8 * P)
+    names = variable[12 * P:].split(b"\0")[:J]
+    table = np.memmap(path, dtype="<f8", mode="r", offset=offset,
+                      shape=(N, 4 * J + 1), order="F")
+    return TrajectoryFile([name.decode() for name in names],
+                          phase_steps.astype(int), phase_dts, table)
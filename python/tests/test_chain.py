@@ -106,7 +106,7 @@ class TestPanda(GtsamTestCase):
         """Test GTSAM forward kinematics at rest."""
 
         # First check link 0 is fixed:
-        self.assertTrue(ROBOT.link("link0").isFixed())
+        self.assertTrue(ROBOT.isFixed(ROBOT.link("link0")))
 
         # Check FK at rest, Conventional FK with GTSAM.
         joint_angles = self.JointAngles(np.zeros((7, )))
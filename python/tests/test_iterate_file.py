@@ -0,0 +1,48 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_iterate_file.py
+ * @brief Test reading binary iterate files.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+import os
+import tempfile
+import unittest
+
+import numpy as np
+from gtdynamics.iterate_file import read_iterate_file
+
+
+class TestIterateFile(unittest.TestCase):
+    """Tests for read_iterate_file."""
+    def test_read(self):
+        """Read a file laid out as in IterateRecorder.h."""
+        iterates = np.arange(4 * 13, dtype=float).reshape(4, 13)
+        variable = (np.array([7, 9], dtype="<u8").tobytes() +
+                    np.array([1, 12], dtype="<u4").tobytes() + b"dp")
+        offset = 32 + len(variable)
+        offset += -offset % 64
+        header = (b"GTDITER\0" + np.array([1, 2], "<u4").tobytes() +
+                  np.array([4, offset], "<u8").tobytes())
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "test.iter")
+            with open(path, "wb") as f:
+                f.write((header + variable).ljust(offset, b"\0"))
+                f.write(iterates.tobytes())
+
+            recorded = read_iterate_file(path)
+            np.testing.assert_array_equal(recorded.keys, [7, 9])
+            self.assertEqual(recorded.types, "dp")
+            np.testing.assert_array_equal(recorded.dims, [1, 12])
+            np.testing.assert_array_equal(recorded.iterates, iterates)
+            np.testing.assert_array_equal(recorded.history(1),
+                                          iterates[:, 1:])
+            del recorded
+
+
+if __name__ == "__main__":
+    unittest.main()
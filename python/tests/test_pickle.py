@@ -0,0 +1,76 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_pickle.py
+ * @brief Test pickling of robots, values and graphs.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import pickle
+import unittest
+
+import gtsam
+import numpy as np
+from gtsam.utils.test_case import GtsamTestCase
+
+import gtdynamics as gtd
+
+
+class TestPickle(GtsamTestCase):
+    """Test binary pickles, as used to ship work to other processes."""
+    def test_robot(self):
+        """Test a robot with revolute joints survives a pickle."""
+        robot = gtd.CreateRobotFromFile(
+            osp.join(gtd.SDF_PATH, "test", "four_bar_linkage_pure.sdf"))
+        restored = pickle.loads(pickle.dumps(robot))
+        self.assertEqual(restored.numLinks(), robot.numLinks())
+        self.assertEqual(restored.numJoints(), robot.numJoints())
+        for link in robot.links():
+            self.gtsamAssertEquals(restored.link(link.name()).bMcom(),
+                                   link.bMcom())
+
+        # The restored links know their joints, so forward kinematics reaches
+        # every link, as it does on the original robot.
+        joint_angles = gtsam.Values()
+        for joint in robot.joints():
+            gtd.InsertJointAngle(joint_angles, joint.id(), 0.0)
+        expected = robot.forwardKinematics(joint_angles, 0, "l1")
+        actual = restored.forwardKinematics(joint_angles, 0, "l1")
+        for link in robot.links():
+            self.gtsamAssertEquals(gtd.Pose(actual, link.id(), 0),
+                                   gtd.Pose(expected, link.id(), 0))
+
+    def test_values(self):
+        """Test values of a trajectory survive a pickle, as gtd.Values."""
+        values = gtd.Values()
+        gtd.InsertJointAngle(values, 0, 1, 0.5)
+        gtd.InsertPose(values, 2, 1, gtsam.Pose3(gtsam.Rot3.Rz(0.3),
+                                                 gtsam.Point3(1, 2, 3)))
+        gtd.InsertTwist(values, 2, 1, np.arange(6.0))
+        restored = pickle.loads(pickle.dumps(values))
+        self.assertIsInstance(restored, gtd.Values)
+        self.gtsamAssertEquals(restored, values)
+
+    def test_graph(self):
+        """Test a graph of GTDynamics factors survives a pickle."""
+        model = gtsam.noiseModel.Isotropic.Sigma(1, 0.1)
+        graph = gtd.NonlinearFactorGraph()
+        graph.push_back(gtd.MinTorqueFactor(gtd.TorqueKey(0, 0).key(), model))
+        graph.push_back(
+            gtd.EulerPoseCollocationFactor(
+                gtd.PoseKey(1, 0).key(),
+                gtd.PoseKey(1, 1).key(),
+                gtd.TwistKey(1, 0).key(), 0,
+                gtsam.noiseModel.Isotropic.Sigma(6, 0.1)))
+        restored = pickle.loads(pickle.dumps(graph))
+        self.assertIsInstance(restored, gtd.NonlinearFactorGraph)
+        self.assertTrue(restored.equals(graph, 1e-9))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -13,6 +13,7 @@
 
 import os.path as osp
 import unittest
+from concurrent.futures import ThreadPoolExecutor
 
 import numpy as np
 from gtsam import Values
@@ -56,6 +57,27 @@ class TestLink(GtsamTestCase):
         self.assertEqual(expected_qVel, gtd.JointVel(results, 0, 0))
         self.assertEqual(expected_qAccel, gtd.JointAccel(results, 0, 0))
 
+    def test_simulate_in_threads(self):
+        """Test simulating with one simulator per thread, without the GIL."""
+        robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "simple_urdf.urdf"), "")
+        robot = robot.fixLink("l1")
+        gravity = np.zeros(3)
+        planar_axis = np.asarray([1, 0, 0])
+
+        def simulate(torque):
+            torques = Values()
+            gtd.InsertTorque(torques, 0, torque)
+            simulator = gtd.Simulator(robot, Values(), gravity, planar_axis)
+            results = simulator.simulate([torques, torques], 1)
+            return gtd.JointAccel(results, 0, 0)
+
+        torques = [1.0, 2.0, 3.0, 4.0]
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            accels = list(executor.map(simulate, torques))
+        for torque, accel in zip(torques, accels):
+            self.assertAlmostEqual(0.0625 * torque, accel)
+
 
 if __name__ == "__main__":
     unittest.main()
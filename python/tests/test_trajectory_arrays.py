@@ -0,0 +1,91 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_trajectory_arrays.py
+ * @brief Test bulk extraction of trajectories as NumPy arrays.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import unittest
+
+import gtsam
+import numpy as np
+from gtsam import Values
+from gtsam.utils.test_case import GtsamTestCase
+
+import gtdynamics as gtd
+
+
+class TestTrajectoryArrays(GtsamTestCase):
+    """Test [num_steps x num_joints] arrays of trajectories."""
+
+    URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                         "models", "urdfs")
+
+    def setUp(self):
+        self.robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "four_bar_linkage_pure.urdf"),
+            "")
+        self.num_steps = 3
+        self.values = Values()
+        for t in range(self.num_steps):
+            for joint in self.robot.joints():
+                j = joint.id()
+                gtd.InsertJointAngle(self.values, j, t, 10.0 * t + j)
+                gtd.InsertJointVel(self.values, j, t, -10.0 * t - j)
+
+    def expected(self, sign):
+        """Expected array, rows are time steps, columns joints."""
+        return np.array([[sign * (10.0 * t + joint.id())
+                          for joint in self.robot.joints()]
+                         for t in range(self.num_steps)])
+
+    def test_dynamics_graph(self):
+        """Test the bulk extractors of DynamicsGraph."""
+        angles = gtd.DynamicsGraph.jointAnglesTrajectory(
+            self.robot, self.values, self.num_steps)
+        np.testing.assert_array_equal(angles, self.expected(1))
+        vels = gtd.DynamicsGraph.jointVelsTrajectory(self.robot, self.values,
+                                                     2, 1)
+        np.testing.assert_array_equal(vels, self.expected(-1)[1:])
+
+    def test_trajectory_state_views(self):
+        """Test the views of the matrices of TrajectoryState."""
+        state = gtd.TrajectoryState.FromValues(self.robot, self.values,
+                                               self.num_steps, 0)
+        angles = state.jointAnglesArray()
+        np.testing.assert_array_equal(angles, self.expected(1))
+        np.testing.assert_array_equal(state.jointVelsArray(),
+                                      self.expected(-1))
+        self.assertFalse(angles.flags.writeable)
+        self.assertFalse(angles.flags.owndata)
+
+        # The view keeps the state alive.
+        del state
+        np.testing.assert_array_equal(angles, self.expected(1))
+
+    def test_batch_insert_and_objectives(self):
+        """Test inserting values and adding priors from arrays."""
+        joint_ids = [joint.id() for joint in self.robot.joints()]
+        values = Values()
+        gtd.InsertJointAngles(values, joint_ids, self.expected(1))
+        gtd.InsertJointVels(values, joint_ids, self.expected(-1))
+        np.testing.assert_array_equal(
+            gtd.DynamicsGraph.jointAnglesTrajectory(self.robot, values,
+                                                    self.num_steps),
+            self.expected(1))
+        self.assertEqual(values.size(), self.values.size())
+
+        model = gtsam.noiseModel.Unit.Create(1)
+        graph = gtd.JointAngleObjectives(joint_ids, self.expected(1), model)
+        self.assertEqual(graph.size(), self.num_steps * len(joint_ids))
+        self.assertAlmostEqual(graph.error(values), 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,49 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_trajectory_file.py
+ * @brief Test reading binary trajectory files.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+import os
+import tempfile
+import unittest
+
+import numpy as np
+from gtdynamics.trajectory_file import read_trajectory_file
+
+
+class TestTrajectoryFile(unittest.TestCase):
+    """Tests for read_trajectory_file."""
+    def test_read(self):
+        """Read a file laid out as in TrajectoryFile.h."""
+        table = np.arange(5 * 9, dtype=float).reshape(5, 9)
+        variable = (np.array([0.1, 0.2]).tobytes() +
+                    np.array([2, 3], dtype="<u4").tobytes() +
+                    b"j0\0joint_1\0")
+        offset = 32 + len(variable)
+        offset += -offset % 64
+        header = (b"GTDTRAJ\0" + np.array([1, 2, 2, 5], "<u4").tobytes() +
+                  np.array([offset], "<u8").tobytes())
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "test.traj")
+            with open(path, "wb") as f:
+                f.write((header + variable).ljust(offset, b"\0"))
+                f.write(table.tobytes(order="F"))
+
+            trajectory = read_trajectory_file(path)
+            self.assertEqual(trajectory.joint_names, ["j0", "joint_1"])
+            np.testing.assert_array_equal(trajectory.phase_steps, [2, 3])
+            np.testing.assert_array_equal(trajectory.phase_dts, [0.1, 0.2])
+            np.testing.assert_array_equal(trajectory.table, table)
+            np.testing.assert_array_equal(trajectory.torques, table[:, 6:8])
+            np.testing.assert_array_equal(trajectory.dts, table[:, 8])
+            del trajectory
+
+
+if __name__ == "__main__":
+    unittest.main()
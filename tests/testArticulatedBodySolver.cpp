@@ -0,0 +1,190 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testArticulatedBodySolver.cpp
+ * @brief Test recursive forward dynamics against the linear factor graph.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+// Check all accelerations, twist accelerations and wrenches at time t.
+static void CheckSameDynamics(const Robot& robot, const Values& expected,
+                              const Values& actual, int t, TestResult& result_,
+                              const std::string& name_) {
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT(assert_equal(JointAccel(expected, j, t), JointAccel(actual, j, t),
+                        1e-6));
+    for (auto&& link : joint->links()) {
+      EXPECT(assert_equal(Wrench(expected, link->id(), j, t),
+                          Wrench(actual, link->id(), j, t), 1e-6));
+    }
+  }
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(TwistAccel(expected, link->id(), t),
+                        TwistAccel(actual, link->id(), t), 1e-6));
+  }
+}
+
+// Fixed-base two-link robot, compare with linearSolveFD.
+TEST(ArticulatedBodySolver, simple_urdf) {
+  auto robot = simple_urdf::getRobot();
+  ArticulatedBodySolver solver(robot, simple_urdf::gravity,
+                               simple_urdf::planar_axis);
+  EXPECT(solver.root()->name() == "l1");
+
+  const int t = 3;
+  Values known_values;
+  const int j = robot.joint("j1")->id();
+  InsertJointAngle(&known_values, j, t, 0.3);
+  InsertJointVel(&known_values, j, t, -0.5);
+  InsertTorque(&known_values, j, t, 1.0);
+  Values fk_values = robot.forwardKinematics(known_values, t);
+
+  DynamicsGraph graph_builder(simple_urdf::gravity, simple_urdf::planar_axis);
+  Values expected = graph_builder.linearSolveFD(robot, t, fk_values);
+  Values actual = solver.solveFD(fk_values, t);
+  CheckSameDynamics(robot, expected, actual, t, result_, name_);
+}
+
+// Floating two-link robot with equal masses.
+TEST(ArticulatedBodySolver, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  ArticulatedBodySolver solver(robot, simple_urdf_eq_mass::gravity,
+                               simple_urdf_eq_mass::planar_axis);
+
+  // Result of the factor graph test in testDynamicsGraph.
+  const int t = 777;
+  auto l1 = robot.link("l1");
+  Values known_values;
+  const int j = robot.joint("j1")->id();
+  InsertPose(&known_values, l1->id(), t, l1->bMcom());
+  InsertTwist(&known_values, l1->id(), t, gtsam::Z_6x1);
+  InsertJointAngle(&known_values, j, t, 0.0);
+  InsertJointVel(&known_values, j, t, 0.0);
+  InsertTorque(&known_values, j, t, 1.0);
+  Values actual = solver.solveFD(known_values, t);
+  EXPECT(assert_equal(4.0, JointAccel(actual, j, t), 1e-6));
+}
+
+// Floating-base quadruped in motion, with gravity.
+TEST(ArticulatedBodySolver, a1) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  ArticulatedBodySolver solver(robot, gravity);
+  auto root = solver.root();
+
+  const int t = 0;
+  Values known_values;
+  int index = 0;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&known_values, j, t, 0.2 * std::sin(index + 1.0));
+    InsertJointVel(&known_values, j, t, 0.7 * std::cos(2.0 * index));
+    InsertTorque(&known_values, j, t, 0.5 * std::sin(3.0 * index));
+    index++;
+  }
+  InsertPose(&known_values, root->id(), t,
+             gtsam::Pose3(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                          gtsam::Point3(0.1, 0.2, 0.4)));
+  Vector6 root_twist;
+  root_twist << 0.1, -0.3, 0.2, 0.5, 0.0, -0.1;
+  InsertTwist(&known_values, root->id(), t, root_twist);
+  Values fk_values = robot.forwardKinematics(known_values, t, root->name());
+
+  DynamicsGraph graph_builder(gravity);
+  Values expected = graph_builder.linearSolveFD(robot, t, fk_values);
+  Values actual = solver.solveFD(fk_values, t);
+  CheckSameDynamics(robot, expected, actual, t, result_, name_);
+}
+
+// Inverse dynamics agrees with linearSolveID and inverts forward dynamics.
+TEST(ArticulatedBodySolver, inverse_dynamics) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  ArticulatedBodySolver solver(robot, gravity);
+  auto root = solver.root();
+
+  const int t = 5;
+  Values known_values;
+  int index = 0;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&known_values, j, t, 0.3 * std::cos(index + 0.5));
+    InsertJointVel(&known_values, j, t, -0.4 * std::sin(2.0 * index));
+    InsertJointAccel(&known_values, j, t, 1.5 * std::cos(3.0 * index));
+    index++;
+  }
+  Vector6 root_twist;
+  root_twist << -0.2, 0.1, 0.3, 0.0, 0.4, 0.2;
+  InsertTwist(&known_values, root->id(), t, root_twist);
+  Values fk_values = robot.forwardKinematics(known_values, t, root->name());
+
+  DynamicsGraph graph_builder(gravity);
+  Values expected = graph_builder.linearSolveID(robot, t, fk_values);
+  Values actual = solver.solveID(fk_values, t);
+  for (auto&& joint : robot.joints()) {
+    EXPECT(assert_equal(Torque(expected, joint->id(), t),
+                        Torque(actual, joint->id(), t), 1e-6));
+  }
+  CheckSameDynamics(robot, expected, actual, t, result_, name_);
+
+  // Feeding the torques back through forward dynamics recovers the input.
+  const TreeDynamicsResult id_result = solver.inverseDynamics(
+      Vector::Constant(12, 0.1), Vector::Constant(12, -0.2),
+      Vector::Constant(12, 0.5));
+  const TreeDynamicsResult fd_result = solver.forwardDynamics(
+      Vector::Constant(12, 0.1), Vector::Constant(12, -0.2),
+      id_result.torques);
+  EXPECT(assert_equal(Vector(Vector::Constant(12, 0.5)),
+                      Vector(fd_result.joint_accels), 1e-6));
+}
+
+// Kinematic loops are rejected.
+TEST(ArticulatedBodySolver, four_bar_linkage) {
+  auto robot = four_bar_linkage_pure::getRobot();
+  THROWS_EXCEPTION(ArticulatedBodySolver solver(robot));
+}
+
+// The simulator gives the same result with either forward dynamics method.
+TEST(ArticulatedBodySolver, Simulator) {
+  auto robot = simple_urdf::getRobot();
+  Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+
+  Simulator graph_simulator(robot, initial_values, simple_urdf::gravity,
+                            simple_urdf::planar_axis);
+  Simulator aba_simulator(robot, initial_values, simple_urdf::gravity,
+                          simple_urdf::planar_axis, ArticulatedBody);
+
+  std::vector<Values> torques_seq(2, torques);
+  auto expected = graph_simulator.simulate(torques_seq, 1.0);
+  auto actual = aba_simulator.simulate(torques_seq, 1.0);
+  EXPECT(assert_equal(JointAngle(expected, 0), JointAngle(actual, 0), 1e-9));
+  EXPECT(assert_equal(JointVel(expected, 0), JointVel(actual, 0), 1e-9));
+  EXPECT(assert_equal(0.0625, JointAccel(actual, 0), 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAsyncOptimizer.cpp
+ * @brief Test asynchronous, cancellable solves.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AsyncOptimizer.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+namespace {
+Values Initial() {
+  using namespace constrained_example;
+  Values initial;
+  initial.insert(x1_key, 0.8);
+  initial.insert(x2_key, 0.5);
+  return initial;
+}
+}  // namespace
+
+// Solves in flight give the results of blocking solves, with progress.
+TEST(AsyncOptimizer, solve) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::PENALTY;
+  const Values expected =
+      Optimizer(parameters).optimize(graph, constraints, Initial());
+
+  const AsyncOptimizer optimizer(parameters,
+                                 std::make_shared<SolveExecutor>(2));
+  EXPECT_LONGS_EQUAL(2, optimizer.executor()->numThreads());
+  std::atomic<size_t> num_calls{0};
+  std::vector<SolveHandle> handles;
+  for (size_t i = 0; i < 4; i++) {
+    handles.push_back(optimizer.solve(
+        graph, constraints, Initial(),
+        [&num_calls](size_t, double) { num_calls++; }));
+  }
+  size_t iterations = 0;
+  for (const auto& handle : handles) {
+    const AsyncSolveResult& result = handle.get();
+    EXPECT(handle.ready());
+    EXPECT(assert_equal(expected, result.values, 1e-6));
+    EXPECT(!result.status.cancelled && result.status.feasible);
+    EXPECT(handle.iterations() > 0);
+    iterations += handle.iterations();
+  }
+  EXPECT_LONGS_EQUAL(iterations, num_calls);
+}
+
+// A solve cancelled before it starts returns its initial values.
+TEST(AsyncOptimizer, cancelQueued) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  auto executor = std::make_shared<SolveExecutor>(1);
+  const AsyncOptimizer optimizer(OptimizationParameters(), executor);
+
+  // Block the only thread until the solve is cancelled.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  executor->submit([released]() { released.wait(); });
+  const SolveHandle handle = optimizer.solve(graph, constraints, Initial());
+  handle.cancel();
+  release.set_value();
+
+  const AsyncSolveResult& result = handle.get();
+  EXPECT(handle.cancelled() && result.status.cancelled);
+  EXPECT(assert_equal(Initial(), result.values));
+  EXPECT_LONGS_EQUAL(0, handle.iterations());
+}
+
+// Cancellation is checked after every iteration.
+TEST(Optimizer, control) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  for (auto method : {OptimizationParameters::Method::SOFT_CONSTRAINTS,
+                      OptimizationParameters::Method::PENALTY,
+                      OptimizationParameters::Method::SQP}) {
+    SolveControl* raw = nullptr;
+    auto control = std::make_shared<SolveControl>(
+        [&raw](size_t, double) { raw->cancel(); });
+    raw = control.get();
+    OptimizationParameters parameters;
+    parameters.method = method;
+    parameters.control = control;
+    OptimizationStatus status;
+    Optimizer(parameters).optimize(graph, constraints, Initial(), nullptr,
+                                   &status);
+    EXPECT(status.cancelled && !status.timed_out);
+    EXPECT_LONGS_EQUAL(1, control->iterations());
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBarrierMethodOptimizer.cpp
+ * @brief Test inequality constraints and the barrier method optimizer.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/BarrierMethodOptimizer.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using constrained_example::x1, constrained_example::x2;
+using constrained_example::x1_key, constrained_example::x2_key;
+
+// Test methods of InequalityConstraint and its barrier factor.
+TEST(InequalityConstraint, DoubleExpressionInequality) {
+  // g(x1) = 1 - x1 >= 0
+  auto g = Double_(1.0) - x1;
+  DoubleExpressionInequality constraint(g);
+  EXPECT_LONGS_EQUAL(1, constraint.dim());
+
+  Values values1, values2;
+  values1.insert(x1_key, 0.0);
+  values2.insert(x1_key, 2.0);
+  EXPECT(constraint.feasible(values1));
+  EXPECT(!constraint.feasible(values2));
+  EXPECT(assert_equal(Vector::Constant(1, -1.0), constraint(values2)));
+
+  // Error is mu * log(1 + 1/g), infinite when infeasible.
+  const double mu = 0.5;
+  auto factor = constraint.createBarrierFactor(mu);
+  EXPECT_DOUBLES_EQUAL(mu * std::log(2.0), factor->error(values1), 1e-9);
+  EXPECT(std::isinf(factor->error(values2)));
+
+  // The linearization has the gradient of the barrier.
+  Values values3;
+  values3.insert(x1_key, 0.5);
+  auto linear = factor->linearize(values3);
+  const double h = 1e-6;
+  Values plus, minus;
+  plus.insert(x1_key, 0.5 + h);
+  minus.insert(x1_key, 0.5 - h);
+  const double expected_gradient =
+      (factor->error(plus) - factor->error(minus)) / (2 * h);
+  EXPECT(assert_equal(Vector1(expected_gradient),
+                      linear->gradientAtZero()[x1_key], 1e-5));
+}
+
+// Minimize (x1 - 2)^2 + (x2 - 1)^2 s.t. x1 <= 1 and x1 + x2 = 1.
+TEST(BarrierMethodOptimizer, ConstrainedExample) {
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.addPrior(x1_key, 2.0, cost_noise);
+  graph.addPrior(x2_key, 1.0, cost_noise);
+
+  EqualityConstraints equalities;
+  equalities.emplace_shared<DoubleExpressionEquality>(x1 + x2 - Double_(1.0),
+                                                      1e-3);
+  InequalityConstraints inequalities;
+  inequalities.emplace_shared<DoubleExpressionInequality>(Double_(1.0) - x1);
+
+  Values init_values;
+  init_values.insert(x1_key, 0.0);
+  init_values.insert(x2_key, 0.0);
+
+  BarrierMethodParameters parameters;
+  parameters.num_iterations = 15;
+  BarrierMethodOptimizer optimizer(parameters);
+  ConstrainedOptResult intermediate;
+  const Values result = optimizer.optimize(graph, equalities, inequalities,
+                                           init_values, &intermediate);
+
+  // Every iterate is strictly feasible.
+  for (const Values& values : intermediate.intermediate_values) {
+    EXPECT(inequalities.feasible(values));
+  }
+
+  // Optimum is on the boundary x1 = 1, x2 = 0.
+  EXPECT_DOUBLES_EQUAL(1.0, result.at<double>(x1_key), 1e-3);
+  EXPECT_DOUBLES_EQUAL(0.0, result.at<double>(x2_key), 1e-3);
+
+  // Infeasible initial values are rejected.
+  Values infeasible;
+  infeasible.insert(x1_key, 2.0);
+  infeasible.insert(x2_key, 0.0);
+  THROWS_EXCEPTION(
+      optimizer.optimize(graph, equalities, inequalities, infeasible));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchInverseKinematics.cpp
+ * @brief Test batch inverse kinematics against single solves.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/BatchInverseKinematics.h>
+
+#include "contactGoalsExample.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+
+TEST(BatchInverseKinematics, solve) {
+  using namespace contact_goals_example;
+  const size_t k = 2;
+
+  // Two reachable goal sets, and one with a foot far out of reach.
+  ContactGoals lowered = contact_goals, unreachable = contact_goals;
+  for (ContactGoal& goal : lowered) goal.goal_point.z() -= 0.02;
+  unreachable[0].goal_point = Point3(-3.0, 0.16, -0.2);
+  const std::vector<ContactGoals> problems{contact_goals, lowered,
+                                           unreachable};
+
+  BatchInverseKinematics batch(robot, Slice(k));
+  const auto results = batch.solve(problems);
+  EXPECT_LONGS_EQUAL(3, results.size());
+  EXPECT(results[0].converged);
+  EXPECT(results[1].converged);
+  EXPECT(!results[2].converged);
+  for (const ContactGoal& goal : lowered) {
+    EXPECT(goal.satisfied(results[1].values, k, 1e-3));
+  }
+  EXPECT(results[2].error > results[0].error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
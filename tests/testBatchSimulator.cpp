@@ -0,0 +1,192 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchSimulator.cpp
+ * @brief Test parallel rollouts against the single rollout simulator.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Values;
+
+// Every rollout matches a JointSpaceSimulator run with the same inputs.
+TEST(BatchSimulator, a1) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  BatchSimulator batch(robot, gravity);
+  const size_t m = batch.numJoints(), num_rollouts = 4, num_steps = 5;
+  const double dt = 0.01;
+
+  Matrix initial_qs(m, num_rollouts), initial_vs(m, num_rollouts);
+  std::vector<Matrix> torques;
+  for (size_t r = 0; r < num_rollouts; r++) {
+    Matrix tau(m, num_steps);
+    for (size_t j = 0; j < m; j++) {
+      initial_qs(j, r) = 0.1 * std::sin(j + r);
+      initial_vs(j, r) = 0.2 * std::cos(j * r);
+      for (size_t k = 0; k < num_steps; k++) {
+        tau(j, k) = 0.5 * std::sin(j + 2.0 * k + 3.0 * r);
+      }
+    }
+    torques.push_back(tau);
+  }
+
+  const BatchTrajectories actual =
+      batch.simulate(initial_qs, initial_vs, torques, dt);
+  EXPECT_LONGS_EQUAL(num_rollouts, actual.numRollouts());
+  EXPECT_LONGS_EQUAL(m * (num_steps + 1), actual.qs.rows());
+
+  for (size_t r = 0; r < num_rollouts; r++) {
+    Values initial_values;
+    for (size_t j = 0; j < m; j++) {
+      const int id = batch.solver().joints()[j]->id();
+      InsertJointAngle(&initial_values, id, initial_qs(j, r));
+      InsertJointVel(&initial_values, id, initial_vs(j, r));
+    }
+    JointSpaceSimulator expected(robot, initial_values, num_steps, gravity);
+    expected.simulate(torques[r], dt);
+    EXPECT(assert_equal(expected.jointAngles(),
+                        Matrix(actual.jointAngles(r)), 1e-9));
+    EXPECT(assert_equal(expected.jointVels(), Matrix(actual.jointVels(r)),
+                        1e-9));
+    EXPECT(assert_equal(expected.jointAccels(),
+                        Matrix(actual.jointAccels(r)), 1e-9));
+  }
+}
+
+// Inputs of inconsistent size are rejected.
+TEST(BatchSimulator, sizes) {
+  auto robot = simple_urdf::getRobot();
+  BatchSimulator batch(robot, simple_urdf::gravity, simple_urdf::planar_axis,
+                       RK4);
+  std::vector<Matrix> torques{Matrix::Ones(1, 3), Matrix::Ones(1, 2)};
+  THROWS_EXCEPTION(
+      batch.simulate(Matrix::Zero(1, 2), Matrix::Zero(1, 2), torques, 0.1));
+  THROWS_EXCEPTION(batch.simulate(Matrix::Zero(1, 2), Matrix::Zero(1, 2),
+                                  {Matrix::Ones(1, 3)}, 0.1));
+
+  // Constant acceleration is integrated exactly by RK4.
+  const BatchTrajectories trajectories = batch.simulate(
+      Matrix::Zero(1, 1), Matrix::Zero(1, 1), {Matrix::Ones(1, 2)}, 1.0);
+  EXPECT_DOUBLES_EQUAL(0.0625 * 0.5 * 4.0, trajectories.jointAngles(0)(0, 2),
+                       1e-9);
+}
+
+// Batched kinematics and dynamics match the solver on every rollout.
+TEST(BatchSimulator, forwardDynamics) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  BatchSimulator batch(robot, gravity);
+  const size_t m = batch.numJoints(), num_rollouts = 3;
+  Matrix qs(m, num_rollouts), vs(m, num_rollouts), taus(m, num_rollouts);
+  for (size_t r = 0; r < num_rollouts; r++) {
+    for (size_t j = 0; j < m; j++) {
+      qs(j, r) = 0.3 * std::sin(j + r);
+      vs(j, r) = 0.2 * std::cos(j * r);
+      taus(j, r) = 0.5 * std::sin(j + 3.0 * r);
+    }
+  }
+
+  const Matrix poses = batch.forwardKinematics(qs);
+  const Matrix accels = batch.forwardDynamics(qs, vs, taus);
+  EXPECT_LONGS_EQUAL(12 * robot.numLinks(), poses.rows());
+  for (size_t r = 0; r < num_rollouts; r++) {
+    const TreeDynamicsResult expected = batch.solver().forwardDynamics(
+        qs.col(r), vs.col(r), taus.col(r));
+    EXPECT(assert_equal(expected.joint_accels, gtsam::Vector(accels.col(r)),
+                        1e-9));
+    for (size_t i = 0; i < size_t(robot.numLinks()); i++) {
+      const gtsam::Matrix3 R = expected.poses[i].rotation().matrix();
+      for (size_t k = 0; k < 9; k++) {
+        EXPECT_DOUBLES_EQUAL(R(k / 3, k % 3), poses(12 * i + k, r), 1e-9);
+      }
+      EXPECT(assert_equal(expected.poses[i].translation(),
+                          gtsam::Point3(poses.block<3, 1>(12 * i + 9, r)),
+                          1e-9));
+    }
+  }
+}
+
+// Single precision kernels agree with double ones up to float round-off.
+TEST(BatchSimulator, singlePrecision) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  BatchSimulator batch(robot, gtsam::Vector3(0, 0, -9.8));
+  const size_t m = batch.numJoints(), num_rollouts = 3;
+  Matrix qs(m, num_rollouts), vs(m, num_rollouts), taus(m, num_rollouts);
+  for (size_t r = 0; r < num_rollouts; r++) {
+    for (size_t j = 0; j < m; j++) {
+      qs(j, r) = 0.3 * std::sin(j + r);
+      vs(j, r) = 0.2 * std::cos(j * r);
+      taus(j, r) = 0.5 * std::sin(j + 3.0 * r);
+    }
+  }
+  const Eigen::MatrixXf qs_f = qs.cast<float>(), vs_f = vs.cast<float>(),
+                        taus_f = taus.cast<float>();
+
+  const Eigen::MatrixXf poses = batch.forwardKinematics(qs_f);
+  const Eigen::MatrixXf accels = batch.forwardDynamics(qs_f, vs_f, taus_f);
+  EXPECT(assert_equal(batch.forwardKinematics(qs),
+                      Matrix(poses.cast<double>()), 1e-4));
+  const Matrix expected = batch.forwardDynamics(qs, vs, taus);
+  EXPECT(assert_equal(expected, Matrix(accels.cast<double>()),
+                      1e-3 * (1 + expected.cwiseAbs().maxCoeff())));
+
+  // Verification checks every float evaluation against double.
+  batch.setFloatVerification(1e-12);
+  THROWS_EXCEPTION(batch.forwardKinematics(qs_f));
+  THROWS_EXCEPTION(batch.forwardDynamics(qs_f, vs_f, taus_f));
+  batch.setFloatVerification(1e-1 * (1 + expected.cwiseAbs().maxCoeff()));
+  batch.forwardDynamics(qs_f, vs_f, taus_f);
+}
+
+// The CUDA backend gives the CPU results, or is rejected without a device.
+TEST(BatchSimulator, cuda) {
+  auto robot = simple_urdf::getRobot();
+  THROWS_EXCEPTION(BatchSimulator(robot, simple_urdf::gravity,
+                                  simple_urdf::planar_axis, RK4, 1e-6,
+                                  CudaBackend));
+  if (!CudaBatchBackend::Available()) {
+    THROWS_EXCEPTION(BatchSimulator(robot, simple_urdf::gravity,
+                                    simple_urdf::planar_axis, ExplicitEuler,
+                                    1e-6, CudaBackend));
+    return;
+  }
+
+  BatchSimulator cpu(robot, simple_urdf::gravity, simple_urdf::planar_axis);
+  BatchSimulator gpu(robot, simple_urdf::gravity, simple_urdf::planar_axis,
+                     ExplicitEuler, 1e-6, CudaBackend);
+  const Matrix initial_qs = Matrix::Constant(1, 2, 0.3),
+               initial_vs = Matrix::Constant(1, 2, -0.1);
+  const std::vector<Matrix> torques{Matrix::Ones(1, 4), Matrix::Zero(1, 4)};
+  const BatchTrajectories expected =
+      cpu.simulate(initial_qs, initial_vs, torques, 0.01);
+  const BatchTrajectories actual =
+      gpu.simulate(initial_qs, initial_vs, torques, 0.01);
+  EXPECT(assert_equal(expected.qs, actual.qs, 1e-9));
+  EXPECT(assert_equal(expected.vs, actual.vs, 1e-9));
+  EXPECT(assert_equal(expected.as, actual.as, 1e-9));
+  EXPECT(assert_equal(cpu.forwardKinematics(initial_qs),
+                      gpu.forwardKinematics(initial_qs), 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
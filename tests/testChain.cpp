@@ -14,6 +14,7 @@
 #define BOOST_BIND_NO_PLACEHOLDERS
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/dynamics/Chain.h>
+#include <gtdynamics/factors/ChainConstraintFactor.h>
 #include <gtdynamics/optimizer/EqualityConstraint.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtsam/base/Matrix.h>
@@ -583,6 +584,163 @@ TEST(Chain, ChainConstraintFactorJacobians) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, init_values, 1e-7, 1e-3);
 }
 
+// Test the N-joint dynamical equality on a four-joint chain, fixed and
+// dynamic size, against central differences.
+TEST(Chain, DynamicalEqualityN) {
+  Matrix axes(6, 4);
+  axes << 0, 1, 0, 0.3,  //
+      0, 0, 1, 0.4,      //
+      1, 0, 0, 0.5,      //
+      0, 0.2, 0.1, 0,    //
+      2, 0, 0.7, 0,      //
+      0, 1, 0, 0.1;
+  Chain chain(Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 2, 3)), axes);
+  Vector6 wrench;
+  wrench << 1.0, -2.0, 0.5, 3.0, 1.0, -1.0;
+  gtsam::Vector4 angles(0.3, -0.5, 0.7, 0.2), torques(1, 2, 3, 4);
+
+  Eigen::Matrix<double, 4, 6> H_wrench;
+  gtsam::Matrix4 H_angles, H_torques;
+  gtsam::Vector4 actual = chain.DynamicalEquality<4>(
+      wrench, angles, torques, H_wrench, H_angles, H_torques);
+
+  // Same as J^T * F - tau with the Jacobian of poe.
+  Matrix J;
+  chain.poe(angles, boost::none, J);
+  EXPECT(assert_equal(Vector(J.transpose() * wrench - torques), actual, 1e-9));
+  EXPECT(assert_equal(Matrix(J.transpose()), Matrix(H_wrench), 1e-9));
+  EXPECT(assert_equal(Matrix(-gtsam::I_4x4), Matrix(H_torques), 1e-9));
+
+  // Central differences for the angles.
+  const double delta = 1e-6;
+  Matrix numerical_H(4, 4);
+  for (int k = 0; k < 4; k++) {
+    gtsam::Vector4 plus = angles, minus = angles;
+    plus(k) += delta;
+    minus(k) -= delta;
+    numerical_H.col(k) = (chain.DynamicalEquality<4>(wrench, plus, torques) -
+                          chain.DynamicalEquality<4>(wrench, minus, torques)) /
+                         (2 * delta);
+  }
+  EXPECT(assert_equal(numerical_H, Matrix(H_angles), 1e-6));
+
+  // The dynamic-size version agrees.
+  Matrix dH_wrench, dH_angles, dH_torques;
+  Vector dynamic = chain.DynamicalEquality<Eigen::Dynamic>(
+      wrench, Vector(angles), Vector(torques), dH_wrench, dH_angles,
+      dH_torques);
+  EXPECT(assert_equal(Vector(actual), dynamic, 1e-9));
+  EXPECT(assert_equal(Matrix(H_angles), dH_angles, 1e-9));
+  EXPECT(assert_equal(Matrix(H_wrench), dH_wrench, 1e-9));
+
+  // Wrong number of angles.
+  THROWS_EXCEPTION(chain.DynamicalEquality<Eigen::Dynamic>(
+      wrench, Vector::Zero(3), Vector::Zero(3)));
+}
+
+// Test the chain constraint factor against the expression version
+TEST(Chain, ChainConstraintFactor) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  std::vector<Chain> chains;
+  for (auto&& joint : robot.joints()) {
+    chains.emplace_back(joint->pMc(), joint->cScrewAxis());
+  }
+  Chain composed = Chain::compose(chains);
+  const gtsam::Key wrench_key = gtdynamics::WrenchKey(0, 1, 0);
+
+  gtsam::Values values;
+  int index = 0;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), 0, 0.2 * (index + 1));
+    InsertTorque(&values, joint->id(), 0, 0.5 - index);
+    index++;
+  }
+  gtsam::Vector wrench(6);
+  wrench << 1.0, 2.0, 3.0, 4.0, 5.0, 6.0;
+  InsertWrench(&values, 0, 1, 0, wrench);
+
+  auto cost_model = gtsam::noiseModel::Unit::Create(3);
+  auto expression = composed.ChainConstraint3(robot.joints(), wrench_key, 0);
+  Vector3 expected = expression.value(values);
+
+  ChainConstraintFactor<3> fixed_factor(cost_model, composed, robot.joints(),
+                                        wrench_key, 0);
+  ChainConstraintFactor<> dynamic_factor(cost_model, composed, robot.joints(),
+                                         wrench_key, 0);
+  EXPECT(assert_equal(Vector(expected), fixed_factor.unwhitenedError(values),
+                      1e-9));
+  EXPECT(assert_equal(Vector(expected),
+                      dynamic_factor.unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(fixed_factor, values, 1e-7, 1e-3);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(dynamic_factor, values, 1e-7, 1e-3);
+
+  // Chain length and joints must match.
+  THROWS_EXCEPTION(ChainConstraintFactor<4>(cost_model, composed,
+                                            robot.joints(), wrench_key, 0));
+}
+
+// The tree reduction in compose agrees with a sequential fold.
+TEST(Chain, ComposeTree) {
+  std::vector<Chain> chains;
+  for (int i = 0; i < 7; i++) {
+    Vector6 axis;
+    axis << 0.1 * i, 1, 0.2, 0, 0.5 * i, 1;
+    chains.emplace_back(Pose3(Rot3::RzRyRx(0.1 * i, -0.2, 0.3),
+                              Point3(1, 0.5 * i, -1)),
+                        axis);
+  }
+  Chain expected;
+  for (auto&& chain : chains) expected = expected * chain;
+
+  const Chain actual = Chain::compose(chains);
+  EXPECT(assert_equal(expected.sMb(), actual.sMb(), 1e-9));
+  EXPECT(assert_equal(expected.axes(), actual.axes(), 1e-9));
+
+  // A single chain is returned as is.
+  const Chain single = Chain::compose({chains[3]});
+  EXPECT(assert_equal(chains[3].sMb(), single.sMb(), 1e-9));
+}
+
+// Batched poe agrees with poe for each sample.
+TEST(Chain, poeBatch) {
+  Matrix axes(6, 3);
+  axes << 0, 1, 0,  //
+      0, 0, 1,      //
+      1, 0, 0,      //
+      0, 0.2, 0.1,  //
+      2, 0, 0.7,    //
+      0, 1, 0;
+  const Chain chain(Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 2, 3)), axes);
+  Pose3 fTe(Rot3::Rz(0.5), Point3(0, 0, 0.2));
+
+  Matrix qs(3, 5);
+  for (int k = 0; k < 5; k++) qs.col(k) << 0.1 * k, -0.3 * k, 0.7 - 0.2 * k;
+  std::vector<Matrix> Js;
+  const std::vector<Pose3> poses = chain.poeBatch(qs, fTe, &Js);
+  EXPECT_LONGS_EQUAL(5, poses.size());
+  EXPECT_LONGS_EQUAL(5, Js.size());
+  for (int k = 0; k < 5; k++) {
+    Matrix J;
+    const Pose3 expected = chain.poe(qs.col(k), fTe, J);
+    EXPECT(assert_equal(expected, poses[k], 1e-9));
+    EXPECT(assert_equal(J, Js[k], 1e-9));
+
+    // The Jacobian matches the monoid composition of the joint chains.
+    Chain monoid(chain.sMb());
+    for (int j = 0; j < 3; j++) {
+      const Vector6 axis = axes.col(j);
+      monoid = monoid * Chain(Pose3::Expmap(axis * qs(j, k)), axis);
+    }
+    monoid = monoid * Chain(fTe);
+    EXPECT(assert_equal(monoid.sMb(), poses[k], 1e-9));
+    EXPECT(assert_equal(monoid.axes(), Js[k], 1e-9));
+  }
+
+  // Without Jacobians.
+  EXPECT(assert_equal(poses[2], chain.poeBatch(qs, fTe)[2], 1e-9));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,63 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testChainInverseKinematics.cpp
+ * @brief Test damped least-squares inverse kinematics of legs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/ChainInverseKinematics.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "contactGoalsExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+
+// Goals reached by forward kinematics at known angles are recovered.
+TEST(ChainInverseKinematics, legs) {
+  using namespace contact_goals_example;
+  const size_t k = 4;
+  ChainInverseKinematics ik(robot, "body");
+  EXPECT_LONGS_EQUAL(4, ik.legs().size());
+
+  const Pose3 wTbody(gtsam::Rot3::Rz(0.1), gtsam::Point3(0, 0, 0.1));
+  const ContactGoals no_goals;
+  bool converged = false;
+  const gtsam::Values rest = ik.inverse(Slice(k), no_goals, wTbody,
+                                        gtsam::Values(), &converged);
+  EXPECT(converged);
+  EXPECT(assert_equal(wTbody, Pose(rest, robot.link("body")->id(), k)));
+
+  // Goals 2cm below the rest position of the feet.
+  ContactGoals goals;
+  for (const ContactGoal& goal : contact_goals) {
+    const gtsam::Point3 at_rest = goal.point_on_link.predict(rest, k);
+    goals.emplace_back(goal.point_on_link,
+                       at_rest + gtsam::Point3(0, 0, -0.02));
+  }
+  const gtsam::Values result =
+      ik.inverse(Slice(k), goals, wTbody, gtsam::Values(), &converged);
+  EXPECT(converged);
+  for (const ContactGoal& goal : goals) {
+    EXPECT(goal.satisfied(result, k, 1e-5));
+  }
+  EXPECT_LONGS_EQUAL(13 + 12, result.size());
+
+  // Goals must be on feet.
+  const ContactGoals bad{{{robot.link("body"), gtsam::Point3()},
+                          gtsam::Point3()}};
+  THROWS_EXCEPTION(ik.inverse(Slice(k), bad, wTbody));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
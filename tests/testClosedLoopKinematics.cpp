@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testClosedLoopKinematics.cpp
+ * @brief Test closed-loop forward kinematics on the four-bar linkage.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/ClosedLoopKinematics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Driving one joint of the four-bar linkage closes the loop with the others.
+TEST(ClosedLoopKinematics, four_bar_linkage) {
+  const Robot robot = four_bar_linkage_pure::getRobot();
+  ClosedLoopKinematics kinematics(robot, "l1", {"j1"});
+
+  // One cut joint, three joints solved for.
+  EXPECT_LONGS_EQUAL(1, kinematics.loops().size());
+  EXPECT_LONGS_EQUAL(4, kinematics.loops()[0].joints.size());
+  EXPECT_LONGS_EQUAL(3, kinematics.dependentJoints().size());
+
+  const int j1 = robot.joint("j1")->id();
+  Vector q = Vector::Zero(robot.numJoints()), q_dot = q;
+  q(j1) = 0.2;
+  q_dot(j1) = 0.5;
+  EXPECT(kinematics.solve(q, q_dot));
+  EXPECT(kinematics.error() < 1e-8);
+  EXPECT(kinematics.iterations() > 0);
+  EXPECT_DOUBLES_EQUAL(0.2, kinematics.jointAngles()(j1), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.5, kinematics.jointVels()(j1), 1e-12);
+
+  // Traversing every joint, including the cut one, is consistent.
+  const Values fk =
+      robot.forwardKinematics(kinematics.values(), 0, std::string("l1"));
+  for (auto &&link : robot.links()) {
+    EXPECT(assert_equal(kinematics.pose(link->id()),
+                        Pose(fk, link->id()), 1e-6));
+    EXPECT(assert_equal(kinematics.twist(link->id()),
+                        Twist(fk, link->id()), 1e-6));
+  }
+
+  // Solving again from the loop-closing state converges immediately.
+  EXPECT(kinematics.solve(kinematics.jointAngles(), q_dot));
+  EXPECT_LONGS_EQUAL(0, kinematics.iterations());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
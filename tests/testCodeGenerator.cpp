@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCodeGenerator.cpp
+ * @brief Test generation of robot-specific dynamics kernels.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/CodeGenerator.h>
+#include <gtdynamics/dynamics/GeneratedDynamics.h>
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace gtdynamics;
+
+TEST(CodeGenerator, fingerprint) {
+  const Robot robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  EXPECT(RobotFingerprint(robot) == RobotFingerprint(simple_urdf::getRobot()));
+  EXPECT(RobotFingerprint(robot) != RobotFingerprint(robot, gravity));
+  EXPECT(RobotFingerprint(robot) !=
+         RobotFingerprint(simple_urdf_eq_mass::getRobot()));
+
+  const DynamicsCodeGenerator generator(robot, gravity);
+  EXPECT(generator.fingerprint() == RobotFingerprint(robot, gravity));
+}
+
+TEST(CodeGenerator, generate) {
+  const Robot robot = simple_urdf::getRobot();
+  const DynamicsCodeGenerator generator(robot, simple_urdf::gravity);
+  const std::string source = generator.generate("SimpleUrdfKernels");
+
+  // Exported entry point, and one template per kernel.
+  EXPECT(source.find("extern \"C\" GTD_GENERATED_EXPORT") !=
+         std::string::npos);
+  EXPECT(source.find("*\nSimpleUrdfKernels() {") != std::string::npos);
+  for (const std::string name :
+       {"void Poses(", "void Velocities(", "void InverseDynamics(",
+        "void ForwardDynamics("}) {
+    EXPECT(source.find(name) != std::string::npos);
+  }
+  EXPECT(source.find("constexpr size_t kNumLinks = 2;") != std::string::npos);
+  EXPECT(source.find("constexpr size_t kNumJoints = 1;") != std::string::npos);
+
+  // The traversal is unrolled, and the link masses are literals.
+  EXPECT(source.find("// j1: l1 -> l2") != std::string::npos);
+  for (auto &&link : robot.links()) {
+    const std::string mass = ", " + std::to_string(int(link->mass())) + ".0);";
+    EXPECT(source.find(mass) != std::string::npos);
+  }
+
+  // The same robot yields the same source.
+  EXPECT(source == DynamicsCodeGenerator(robot, simple_urdf::gravity)
+                       .generate("SimpleUrdfKernels"));
+}
+
+TEST(CodeGenerator, loop) {
+  CHECK_EXCEPTION(DynamicsCodeGenerator(four_bar_linkage_pure::getRobot()),
+                  std::invalid_argument);
+}
+
+TEST(GeneratedDynamics, validation) {
+  const Robot robot = simple_urdf::getRobot();
+  GeneratedKernels kernels = {};
+  kernels.abi_version = kGeneratedKernelsAbiVersion;
+  kernels.fingerprint = RobotFingerprint(robot);
+  kernels.num_links = robot.numLinks();
+  kernels.num_joints = robot.numJoints();
+
+  const GeneratedDynamics dynamics(robot, &kernels);
+  EXPECT_LONGS_EQUAL(1, dynamics.numJoints());
+
+  // Another gravity, robot or ABI version are rejected.
+  CHECK_EXCEPTION(GeneratedDynamics(robot, &kernels, gtsam::Vector3(0, 0, -1)),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(
+      GeneratedDynamics(simple_urdf_eq_mass::getRobot(), &kernels),
+      std::invalid_argument);
+  kernels.abi_version++;
+  CHECK_EXCEPTION(GeneratedDynamics(robot, &kernels), std::invalid_argument);
+  CHECK_EXCEPTION(GeneratedDynamics(robot, nullptr), std::invalid_argument);
+  CHECK_EXCEPTION(GeneratedDynamics::Load(robot, "/nonexistent/kernels.so"),
+                  std::runtime_error);
+}
+
+TEST(JointSpaceSimulator, useGeneratedDynamics) {
+  const Robot robot = simple_urdf::getRobot();
+  GeneratedKernels kernels = {};
+  kernels.abi_version = kGeneratedKernelsAbiVersion;
+  kernels.fingerprint = RobotFingerprint(robot);
+  kernels.num_links = robot.numLinks();
+  kernels.num_joints = robot.numJoints();
+  const GeneratedDynamics dynamics(robot, &kernels);
+
+  // Kernels generated without gravity do not fit a simulator with gravity.
+  JointSpaceSimulator simulator(robot, gtsam::Values(), 1);
+  JointSpaceSimulator with_gravity(robot, gtsam::Values(), 1,
+                                   gtsam::Vector3(0, 0, -9.8));
+  simulator.useGeneratedDynamics(dynamics);
+  EXPECT(simulator.usesGeneratedDynamics());
+  simulator.useSolver();
+  EXPECT(!simulator.usesGeneratedDynamics());
+  CHECK_EXCEPTION(with_gravity.useGeneratedDynamics(dynamics),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCollisionFactors.cpp
+ * @brief Test capsules, the distance field and collision avoidance factors.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/CollisionFactors.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/CollisionGeometry.h>
+#include <gtdynamics/utils/SignedDistanceField.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+#include <memory>
+
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+using namespace gtdynamics;
+
+namespace example {
+// The floor z = 0 sampled on a 1 m cube with 0.1 m cells.
+SignedDistanceFieldPtr Floor() {
+  return std::make_shared<const SignedDistanceField>(
+      SignedDistanceField::FromFunction(
+          [](const Point3 &p) { return p.z(); }, Point3(-0.5, -0.5, -0.5),
+          0.1, 11, 11, 11));
+}
+}  // namespace example
+
+TEST(SegmentClosestPoints, crossing_and_parallel) {
+  double s, t;
+  // Crossing segments at height 1 apart.
+  EXPECT_DOUBLES_EQUAL(
+      1.0,
+      SegmentClosestPoints(Point3(-1, 0, 0), Point3(1, 0, 0), Point3(0, -1, 1),
+                           Point3(0, 1, 1), &s, &t),
+      1e-9);
+  EXPECT_DOUBLES_EQUAL(0.5, s, 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.5, t, 1e-9);
+
+  // Collinear segments with a gap of 1.
+  EXPECT_DOUBLES_EQUAL(
+      1.0,
+      SegmentClosestPoints(Point3(0, 0, 0), Point3(1, 0, 0), Point3(2, 0, 0),
+                           Point3(3, 0, 0), &s, &t),
+      1e-9);
+  EXPECT_DOUBLES_EQUAL(1.0, s, 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0, t, 1e-9);
+
+  // Point to segment.
+  EXPECT_DOUBLES_EQUAL(
+      2.0,
+      SegmentClosestPoints(Point3(0.5, 2, 0), Point3(0.5, 2, 0),
+                           Point3(0, 0, 0), Point3(1, 0, 0), &s, &t),
+      1e-9);
+  EXPECT_DOUBLES_EQUAL(0.5, t, 1e-9);
+}
+
+TEST(CapsuleBVH, candidatePairs) {
+  // A row of spheres 1 m apart, and one close to the second.
+  std::vector<Capsule> capsules;
+  for (int i = 0; i < 8; i++) {
+    capsules.emplace_back(Point3(i, 0, 0), Point3(i, 0, 0), 0.1);
+  }
+  capsules.emplace_back(Point3(1, 0.25, 0), Point3(1, 0.25, 0), 0.1);
+
+  const auto pairs = CapsuleBVH(capsules, 0.1).candidatePairs();
+  EXPECT_LONGS_EQUAL(1, pairs.size());
+  EXPECT_LONGS_EQUAL(1, pairs[0].first);
+  EXPECT_LONGS_EQUAL(8, pairs[0].second);
+
+  // With a large margin all neighbors are candidates.
+  EXPECT(CapsuleBVH(capsules, 1.0).candidatePairs().size() >= 8);
+}
+
+TEST(SignedDistanceField, distance) {
+  const auto sdf = example::Floor();
+
+  // A linear field is interpolated exactly.
+  gtsam::Matrix13 H;
+  EXPECT_DOUBLES_EQUAL(0.23, sdf->distance(Point3(0.12, -0.31, 0.23), H),
+                       1e-9);
+  EXPECT(assert_equal(gtsam::Matrix13(0, 0, 1), H, 1e-9));
+
+  // Outside of the grid the point is clamped, with zero gradient.
+  EXPECT_DOUBLES_EQUAL(0.5, sdf->distance(Point3(0, 0, 2), H), 1e-9);
+  EXPECT(assert_equal(gtsam::Matrix13(0, 0, 0), H, 1e-9));
+}
+
+TEST(ObstacleCollisionFactor, error_and_jacobians) {
+  const auto sdf = example::Floor();
+  const Capsule capsule(Point3(-0.1, 0, 0), Point3(0.1, 0, 0), 0.05);
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(3, 0.01);
+  const gtsam::Key key = gtsam::Symbol('p', 0);
+  ObstacleCollisionFactor factor(key, model, capsule, sdf, 0.02);
+
+  // Tilted so that one end is above the margin.
+  const Pose3 pose(Rot3::Pitch(-0.5), Point3(0.01, 0.02, 0.06));
+  const gtsam::Vector error = factor.evaluateError(pose);
+  EXPECT_LONGS_EQUAL(3, error.size());
+  EXPECT_DOUBLES_EQUAL(0.07 - (0.06 - 0.1 * std::sin(0.5)), error(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.01, error(1), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0, error(2), 1e-9);
+
+  gtsam::Values values;
+  values.insert(key, pose);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  // Far from the floor there is no error.
+  EXPECT(assert_equal(gtsam::Vector3::Zero().eval(),
+                      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 0.3))),
+                      1e-9));
+}
+
+TEST(SelfCollisionFactor, linearize) {
+  const gtsam::Key k0 = gtsam::Symbol('p', 0), k1 = gtsam::Symbol('p', 1);
+  const Capsule capsule(Point3(-0.5, 0, 0), Point3(0.5, 0, 0), 0.1);
+  SelfCollisionFactor factor({k0, k1}, {capsule, capsule}, {}, 0.1, 0.01);
+  EXPECT_LONGS_EQUAL(1, factor.dim());
+
+  gtsam::Values values;
+  values.insert(k0, Pose3());
+  values.insert(k1, Pose3(Rot3::Yaw(1.0), Point3(0.1, 0.02, 0.25)));
+
+  const auto pairs = factor.nearPairs(values);
+  EXPECT_LONGS_EQUAL(1, pairs.size());
+  EXPECT_DOUBLES_EQUAL(0.05, pairs[0].distance, 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.5 * 25.0, factor.error(values), 1e-9);
+
+  // The gradient of the linear factor matches the nonlinear error.
+  const auto linear =
+      boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+          factor.linearize(values));
+  EXPECT(linear);
+  const gtsam::VectorValues gradient = linear->gradientAtZero();
+  for (const gtsam::Key key : {k0, k1}) {
+    const auto f = [&](const gtsam::Vector6 &xi) {
+      gtsam::Values perturbed = values;
+      perturbed.update(key, values.at<Pose3>(key).retract(xi));
+      return factor.error(perturbed);
+    };
+    const gtsam::Vector expected = gtsam::numericalGradient<gtsam::Vector6>(
+        f, gtsam::Vector6::Zero(), 1e-6);
+    EXPECT(assert_equal(expected, gradient.at(key), 1e-4));
+  }
+
+  // Apart, the linear factor is null.
+  values.update(k1, Pose3(Rot3(), Point3(0, 0, 1)));
+  EXPECT_DOUBLES_EQUAL(0.0, factor.error(values), 1e-9);
+  EXPECT(!factor.linearize(values));
+}
+
+TEST(CollisionFactors, simple_rrr) {
+  const Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+
+  CollisionParameters parameters;
+  const auto self = CollisionFactors(robot, parameters);
+  EXPECT_LONGS_EQUAL(1, self.size());
+  // Four links and three joints leave three pairs.
+  EXPECT_LONGS_EQUAL(3, self.at(0)->dim());
+
+  const auto graph = CollisionFactors(robot, parameters, example::Floor(), 2);
+  EXPECT_LONGS_EQUAL(5, graph.size());
+  EXPECT(graph.keys().exists(PoseKey(0, 2)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
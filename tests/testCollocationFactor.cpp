@@ -136,6 +136,39 @@ TEST(RandomData, TrapezoidalPose) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
 }
 
+TEST(RandomData, HermiteSimpsonPose) {
+  Pose3 pose_p(Rot3::RzRyRx(0.7, -0.5, 2), gtsam::Point3(0.4, -0.3, 0.9));
+  Vector6 twist_p, twist_c, accel_p, accel_c;
+  twist_p << 0.1, 0.6, 0.2, -0.1, 0.9, 1;
+  twist_c << 0.6, 0.2, -0.1, 0.4, -0.8, -0.9;
+  accel_p << 2, -9, -1, 5, -7, -9;
+  accel_c << 1, 2, 3, -4, 5, -6;
+  double dt = 0.3;
+  Vector6 twistdt = 0.5 * dt * (twist_p + twist_c) +
+                    dt * dt / 12 * (accel_p - accel_c);
+  Pose3 pose_c = pose_p * Pose3::Expmap(twistdt);
+
+  HermiteSimpsonPoseCollocationFactor factor(
+      example::pose_p_key, example::pose_c_key, example::twist_p_key,
+      example::twist_c_key, example::accel_p_key, example::accel_c_key,
+      example::dt_key, example::cost_model);
+
+  auto actual_errors = factor.evaluateError(pose_p, pose_c, twist_p, twist_c,
+                                            accel_p, accel_c, dt);
+  EXPECT(assert_equal(gtsam::Vector(gtsam::Z_6x1), actual_errors, 1e-6));
+
+  gtsam::Values values;
+  values.insert(example::pose_p_key, pose_p);
+  values.insert(example::pose_c_key, pose_c);
+  values.insert(example::twist_p_key, twist_p);
+  values.insert(example::twist_c_key, twist_c);
+  values.insert(example::accel_p_key, accel_p);
+  values.insert(example::accel_c_key, accel_c);
+  values.insert(example::dt_key, dt);
+  double diffDelta = 1e-7;
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
+}
+
 TEST(RandomData, EulerTwist) {
   // create functor
   Vector6 twist_p, twist_c, accel_p;
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompiledExpressionFactor.cpp
+ * @brief Test expression factors with preallocated evaluation buffers.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/CompiledExpressionFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace {
+const Robot robot = simple_rr::getRobot();
+const JointConstSharedPtr joint = robot.joints()[0];
+const int t = 3;
+
+Values TestValues() {
+  Values values;
+  InsertPose(&values, joint->parent()->id(), t,
+             Pose3(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                   gtsam::Point3(0.4, -0.5, 0.6)));
+  InsertPose(&values, joint->child()->id(), t,
+             Pose3(gtsam::Rot3::RzRyRx(-0.3, 0.2, 0.7),
+                   gtsam::Point3(-0.1, 0.2, 1.1)));
+  InsertJointAngle(&values, joint->id(), t, 0.8);
+  return values;
+}
+
+// Compiled and plain expression factors agree on error and linearization.
+void CheckSame(const gtsam::SharedNoiseModel &model) {
+  const gtsam::Vector6_ expression = joint->poseConstraint(t);
+  const gtsam::ExpressionFactor<Vector6> expected(model, Vector6::Zero(),
+                                                  expression);
+  const CompiledExpressionFactor<Vector6> actual(model, Vector6::Zero(),
+                                                 expression);
+  const Values values = TestValues();
+
+  // Evaluate twice, the second time from the reused buffers.
+  for (int i = 0; i < 2; i++) {
+    std::vector<gtsam::Matrix> H_expected, H_actual;
+    EXPECT(assert_equal(expected.unwhitenedError(values, H_expected),
+                        actual.unwhitenedError(values, H_actual)));
+    for (size_t k = 0; k < H_expected.size(); k++) {
+      EXPECT(assert_equal(H_expected[k], H_actual[k]));
+    }
+    EXPECT(assert_equal(*expected.linearize(values),
+                        *actual.linearize(values)));
+  }
+}
+}  // namespace
+
+// Same results as gtsam::ExpressionFactor, with and without constraints.
+TEST(CompiledExpressionFactor, sameAsExpressionFactor) {
+  CheckSame(gtsam::noiseModel::Isotropic::Sigma(6, 0.1));
+  CheckSame(gtsam::noiseModel::Constrained::All(6));
+}
+
+// Jacobians are correct when factors of other sizes share the buffers.
+TEST(CompiledExpressionFactor, interleaved) {
+  const auto model = gtsam::noiseModel::Unit::Create(6);
+  const CompiledExpressionFactor<Vector6> pose_factor(
+      model, Vector6::Zero(), joint->poseConstraint(t));
+  const gtsam::Double_ q(JointAngleKey(joint->id(), t));
+  const CompiledExpressionFactor<double> angle_factor(
+      gtsam::noiseModel::Unit::Create(1), 0.5, q - gtsam::Double_(0.2));
+  const Values values = TestValues();
+  for (int i = 0; i < 2; i++) {
+    EXPECT_CORRECT_FACTOR_JACOBIANS(pose_factor, values, 1e-7, 1e-5);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(angle_factor, values, 1e-7, 1e-5);
+  }
+}
+
+// Clones keep the compiled type and the expression.
+TEST(CompiledExpressionFactor, clone) {
+  const CompiledExpressionFactor<Vector6> factor(
+      gtsam::noiseModel::Unit::Create(6), Vector6::Zero(),
+      joint->poseConstraint(t));
+  const auto clone = factor.clone();
+  EXPECT(boost::dynamic_pointer_cast<CompiledExpressionFactor<Vector6>>(
+      clone));
+  const Values values = TestValues();
+  EXPECT_DOUBLES_EQUAL(factor.error(values), clone->error(values), 1e-12);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
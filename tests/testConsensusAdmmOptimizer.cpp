@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testConsensusAdmmOptimizer.cpp
+ * @brief Test consensus ADMM over time windows of a trajectory graph.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/ConsensusAdmmOptimizer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace {
+const int kNumSteps = 12;
+
+// Chains in time of joint angles and link poses, coupled by a phase key.
+NonlinearFactorGraph TrajectoryGraph(Values *initial) {
+  const auto model = gtsam::noiseModel::Unit::Create(1);
+  const auto pose_model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, model);
+  graph.addPrior<Pose3>(PoseKey(0, 0), Pose3(), pose_model);
+  graph.addPrior<double>(PhaseKey(0), 0.1, model);
+  initial->insert(PhaseKey(0), 0.4);
+  const Pose3 step(gtsam::Rot3::Rz(0.1), gtsam::Point3(0.2, 0, 0));
+  for (int t = 0; t <= kNumSteps; t++) {
+    InsertJointAngle(initial, 0, t, 0.1 * t);
+    InsertPose(initial, 0, t,
+               Pose3(gtsam::Rot3(), gtsam::Point3(0.1 * t, 0, 0)));
+    if (t == kNumSteps) break;
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t), JointAngleKey(0, t + 1), 0.3, model);
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        PhaseKey(0), JointAngleKey(0, t + 1), 0.5, model);
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(0, t), PoseKey(0, t + 1), step, pose_model);
+  }
+  graph.addPrior<double>(JointAngleKey(0, kNumSteps), 3.0, model);
+  return graph;
+}
+}  // namespace
+
+// Factors go to the window of their earliest time step.
+TEST(ConsensusAdmmOptimizer, PartitionByTime) {
+  Values initial;
+  const NonlinearFactorGraph graph = TrajectoryGraph(&initial);
+  const auto windows = PartitionByTime(graph, 3);
+  EXPECT_LONGS_EQUAL(3, windows.size());
+  size_t num_factors = 0;
+  for (const auto &window : windows) num_factors += window.size();
+  EXPECT_LONGS_EQUAL(graph.size(), num_factors);
+
+  // The first window has the priors at 0 and the factors up to step 4: the
+  // steps from 0 to 4, and the phase factors of steps 1 to 4.
+  EXPECT_LONGS_EQUAL(3 + 5 + 5 + 4, windows[0].size());
+  EXPECT(windows[0].keys().count(JointAngleKey(0, 5)));
+  EXPECT(windows[1].keys().count(JointAngleKey(0, 5)));
+  EXPECT(!windows[1].keys().count(JointAngleKey(0, 4)));
+  THROWS_EXCEPTION(PartitionByTime(graph, 0));
+}
+
+// The consensus converges to the solution of the whole graph.
+TEST(ConsensusAdmmOptimizer, optimize) {
+  Values initial;
+  const NonlinearFactorGraph graph = TrajectoryGraph(&initial);
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(graph, initial).optimize();
+
+  ConsensusAdmmParams params;
+  params.max_iterations = 500;
+  params.tolerance = 1e-6;
+  params.lm_parameters.setRelativeErrorTol(1e-10);
+  ConsensusAdmmStatus status;
+  const Values actual = ConsensusAdmmOptimizer(params).optimize(
+      PartitionByTime(graph, 3), initial, &status);
+  EXPECT(status.converged);
+  EXPECT(status.iterations > 1);
+  EXPECT(assert_equal(expected, actual, 1e-3));
+}
+
+// A single partition is solved in one iteration.
+TEST(ConsensusAdmmOptimizer, single) {
+  Values initial;
+  const NonlinearFactorGraph graph = TrajectoryGraph(&initial);
+  ConsensusAdmmStatus status;
+  const Values actual =
+      ConsensusAdmmOptimizer().optimize({graph}, initial, &status);
+  EXPECT_LONGS_EQUAL(1, status.iterations);
+  EXPECT(assert_equal(
+      gtsam::LevenbergMarquardtOptimizer(graph, initial).optimize(), actual,
+      1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testConstantJacobianFactor.cpp
+ * @brief Test caching the linearization of constant-Jacobian factors.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/ConstantJacobianFactor.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Symbol;
+
+namespace example {
+auto model1 = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+auto model6 = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+gtsam::Key t1 = Symbol('t', 1), t2 = Symbol('t', 2), p = Symbol('p', 0);
+}  // namespace example
+
+using namespace example;
+
+// Only linear factors on vector-space keys are detected.
+TEST(ConstantJacobianFactor, detect) {
+  gtsam::Values values;
+  values.insert(t1, 2.0);
+  values.insert(t2, -1.0);
+  values.insert(p, gtsam::Pose3());
+
+  auto min_torque = boost::make_shared<MinTorqueFactor>(t1, model1);
+  auto between = boost::make_shared<gtsam::BetweenFactor<double>>(
+      t1, t2, 0.5, model1);
+  auto pose_prior = boost::make_shared<gtsam::PriorFactor<gtsam::Pose3>>(
+      p, gtsam::Pose3(), model6);
+  gtsam::Double_ x(t1);
+  auto square =
+      boost::make_shared<gtsam::ExpressionFactor<double>>(model1, 0., x * x);
+  auto robust = boost::make_shared<MinTorqueFactor>(
+      t1, gtsam::noiseModel::Robust::Create(
+              gtsam::noiseModel::mEstimator::Huber::Create(1.0), model1));
+
+  EXPECT(HasConstantJacobian(min_torque, values));
+  EXPECT(HasConstantJacobian(between, values));
+  EXPECT(!HasConstantJacobian(pose_prior, values));
+  EXPECT(!HasConstantJacobian(square, values));
+  EXPECT(!HasConstantJacobian(robust, values));
+
+  gtsam::NonlinearFactorGraph graph;
+  graph.push_back(min_torque);
+  graph.push_back(between);
+  graph.push_back(pose_prior);
+  graph.push_back(square);
+  size_t num_cached;
+  auto cached = CacheConstantJacobians(graph, values, &num_cached);
+  EXPECT_LONGS_EQUAL(2, num_cached);
+  EXPECT_LONGS_EQUAL(4, cached.size());
+  EXPECT(boost::dynamic_pointer_cast<ConstantJacobianFactor>(cached[0]));
+  EXPECT(cached[2] == graph[2]);
+}
+
+// The cached linearization matches a fresh one away from the linearization
+// point, and optimizing the cached graph gives the same result.
+TEST(ConstantJacobianFactor, linearize) {
+  gtsam::Values values;
+  values.insert(t1, 2.0);
+  values.insert(t2, -1.0);
+  auto between = boost::make_shared<gtsam::BetweenFactor<double>>(
+      t1, t2, 0.5, model1);
+  ConstantJacobianFactor factor(between, values);
+
+  gtsam::Values other;
+  other.insert(t1, 0.3);
+  other.insert(t2, 4.0);
+  EXPECT_DOUBLES_EQUAL(between->error(other), factor.error(other), 1e-9);
+  auto expected = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+      between->linearize(other));
+  auto actual = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+      factor.linearize(other));
+  EXPECT(assert_equal(*expected, *actual, 1e-9));
+
+  gtsam::NonlinearFactorGraph graph;
+  graph.push_back(between);
+  graph.addPrior<double>(t1, 1.0, model1);
+  gtsam::Double_ x(t2);
+  graph.emplace_shared<gtsam::ExpressionFactor<double>>(model1, 1.0, x * x);
+  auto cached = CacheConstantJacobians(graph, values);
+
+  gtsam::LevenbergMarquardtOptimizer expected_optimizer(graph, values);
+  gtsam::LevenbergMarquardtOptimizer optimizer(cached, values);
+  EXPECT(assert_equal(expected_optimizer.optimize(), optimizer.optimize(),
+                      1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
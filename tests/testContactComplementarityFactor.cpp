@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactComplementarityFactor.cpp
+ * @brief Test the relaxed contact complementarity and schedule extraction.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ContactSchedule.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/ContactComplementarityFactor.h>
+#include <gtdynamics/factors/ContactHeightFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using gtsam::LabeledSymbol;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+LabeledSymbol pose_key('p', 0, 0), twist_key('V', 0, 0),
+    contact_wrench_key('C', 0, 0);
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const Point3 comPc(0, 0, -1);
+auto cost_model = gtsam::noiseModel::Isotropic::Sigma(5, 1.0);
+
+ContactComplementarityFactor Factor() {
+  return ContactComplementarityFactor(pose_key, twist_key, contact_wrench_key,
+                                      cost_model, comPc, gravity, 0.01);
+}
+
+Vector6 Force(double fx, double fy, double fz) {
+  return (Vector6() << 0, 0, 0, fx, fy, fz).finished();
+}
+}  // namespace example
+
+using namespace example;
+
+TEST(ContactComplementarityFactor, error) {
+  const ContactComplementarityFactor factor = Factor();
+  const Vector6 still = Vector6::Zero();
+
+  // Resting on the ground, or in the air without force, is complementary.
+  const Pose3 resting(Rot3(), Point3(0, 0, 1));
+  EXPECT(assert_equal(Vector(Vector::Zero(5)),
+                      factor.evaluateError(resting, still, Force(1, 0, 10))));
+  const Pose3 flying(Rot3(), Point3(0, 0, 2));
+  EXPECT(assert_equal(Vector(Vector::Zero(5)),
+                      factor.evaluateError(flying, still, Force(0, 0, 0))));
+
+  // Pushing from the air, beyond the relaxation.
+  Vector error = factor.evaluateError(flying, still, Force(0, 0, 10));
+  EXPECT_DOUBLES_EQUAL(10 - 0.01, error(2), 1e-9);
+
+  // Below the ground and pulling on it.
+  error = factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 0.5)), still,
+                               Force(0, 0, -2));
+  EXPECT_DOUBLES_EQUAL(0.5, error(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(2, error(1), 1e-9);
+
+  // Sliding while pushing: the contact point moves along x.
+  const Vector6 sliding = (Vector6() << 0, 0, 0, 0.5, 0, 0).finished();
+  error = factor.evaluateError(resting, sliding, Force(0, 0, 10));
+  EXPECT_DOUBLES_EQUAL(5, error.tail<2>().norm(), 1e-9);
+}
+
+TEST(ContactComplementarityFactor, jacobians) {
+  const ContactComplementarityFactor factor = Factor();
+  gtsam::Values values;
+  values.insert(pose_key,
+                Pose3(Rot3::RzRyRx(0.3, -0.2, 0.1), Point3(1, 2, 0.5)));
+  values.insert(twist_key,
+                (Vector6() << 0.1, -0.3, 0.2, 0.4, 0.5, -0.6).finished());
+  values.insert(contact_wrench_key,
+                (Vector6() << 0.1, 0.2, 0.3, 1.1, -0.4, -0.9).finished());
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+
+  // With the height-force hinge active.
+  values.update(pose_key,
+                Pose3(Rot3::RzRyRx(0.3, -0.2, 0.1), Point3(1, 2, 3)));
+  values.update(contact_wrench_key,
+                (Vector6() << 0.1, 0.2, 0.3, 1.1, -0.4, 6.0).finished());
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+}
+
+// In contact-implicit mode candidates get complementarity factors instead of
+// the contact height, twist and acceleration factors.
+TEST(ContactComplementarityFactor, contactImplicit) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), Point3(0, 0, -0.1));
+
+  OptimizerSetting opt;
+  opt.contact_implicit = true;
+  DynamicsGraph graph_builder(opt, gravity);
+  auto graph = graph_builder.dynamicsFactorGraph(robot, 0, contact_points);
+
+  size_t num_complementarity = 0, num_height = 0;
+  for (const auto &factor : graph) {
+    if (boost::dynamic_pointer_cast<ContactComplementarityFactor>(factor)) {
+      num_complementarity++;
+    }
+    if (boost::dynamic_pointer_cast<ContactHeightFactor>(factor)) {
+      num_height++;
+    }
+  }
+  EXPECT_LONGS_EQUAL(1, num_complementarity);
+  EXPECT_LONGS_EQUAL(0, num_height);
+}
+
+// Runs of steps with the same pushing candidates make up the phases.
+TEST(ContactComplementarityFactor, schedule) {
+  auto robot = simple_rr::getRobot();
+  const PointOnLink candidate(robot.link("link_0"), Point3(0, 0, -0.1));
+  const int i = candidate.link->id();
+
+  gtsam::Values values;
+  const std::vector<double> forces{20, 20, 20, 0, 0, 20, 20};
+  for (size_t k = 0; k < forces.size(); k++) {
+    InsertPose(&values, i, k, Pose3());
+    values.insert(ContactWrenchKey(i, 0, k), Force(0, 0, forces[k]));
+  }
+
+  const ContactSchedule schedule =
+      ExtractContactSchedule(values, {candidate}, forces.size() - 1);
+  EXPECT(std::vector<int>({2, 2, 2}) == schedule.phase_steps);
+  EXPECT_LONGS_EQUAL(3, schedule.phase_contact_points.size());
+  EXPECT_LONGS_EQUAL(1, schedule.phase_contact_points[0].size());
+  EXPECT_LONGS_EQUAL(0, schedule.phase_contact_points[1].size());
+  EXPECT_LONGS_EQUAL(1, schedule.phase_contact_points[2].size());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
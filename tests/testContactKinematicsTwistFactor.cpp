@@ -25,6 +25,7 @@
 #include <math.h>
 
 #include <iostream>
+#include <vector>
 
 using namespace gtdynamics;
 using gtsam::assert_equal;
@@ -133,6 +134,26 @@ TEST(ContactKinematicsTwistFactor, optimization) {
                       (gtsam::Vector(3) << 0, 0, 0).finished()));
 }
 
+/**
+ * Test that the analytic factor agrees with the expression-based one.
+ **/
+TEST(ContactKinematicsTwistFactor, analytic) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(3, 0.1);
+  const gtsam::LabeledSymbol key = gtsam::LabeledSymbol('V', 0, 0);
+  const gtsam::Pose3 cTcom(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                           gtsam::Point3(0.1, -0.2, -1));
+  ContactKinematicsTwistFactor expected(key, cost_model, cTcom);
+  AnalyticContactKinematicsTwistFactor actual(key, cost_model, cTcom);
+
+  gtsam::Values values;
+  values.insert(key, (gtsam::Vector(6) << 1, 2, 4, 4, 9, 3).finished());
+  std::vector<gtsam::Matrix> H_expected(1), H_actual(1);
+  EXPECT(assert_equal(expected.unwhitenedError(values, H_expected),
+                      actual.unwhitenedError(values, H_actual), 1e-9));
+  EXPECT(assert_equal(H_expected[0], H_actual[0], 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(actual, values, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
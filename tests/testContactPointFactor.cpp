@@ -18,12 +18,14 @@
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 #include <gtsam/base/numericalDerivative.h>
+#include <gtsam/base/serialization.h>
 #include <gtsam/inference/Symbol.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/factorTesting.h>
 
+#include <boost/serialization/export.hpp>
 #include <iostream>
 
 using namespace gtdynamics;
@@ -79,6 +81,26 @@ TEST(ContactPointFactor, Jacobians) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
 }
 
+// Declaration needed for serialization of the noise model.
+BOOST_CLASS_EXPORT_GUID(gtsam::noiseModel::Isotropic,
+                        "gtsam_noiseModel_Isotropic")
+
+TEST(ContactPointFactor, Serialization) {
+  Key link_pose_key = gtdynamics::PoseKey(0, 0),
+      point_key = gtdynamics::PoseKey(1, 0);
+  ContactPointFactor factor(link_pose_key, point_key, kModel, Point3(0, 0, 1));
+
+  ContactPointFactor restored;
+  gtsam::deserializeBinary(gtsam::serializeBinary(factor), restored);
+  EXPECT(restored.equals(factor, 1e-9));
+
+  // The contact point is restored with the factor.
+  Pose3 wTcom(Rot3::Rz(0.3), Point3(1, 2, 3));
+  Point3 wPc(0, 1, 2);
+  EXPECT(assert_equal(factor.evaluateError(wTcom, wPc),
+                      restored.evaluateError(wTcom, wPc), 1e-9));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactSimulator.cpp
+ * @brief Test time-stepping with frictional contacts on the ground.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ContactSimulator.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// The two-link floating robot, standing upright on the bottom of l1.
+Robot TwoLinks() {
+  return CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+}
+
+PointOnLinks Corners(const Robot &robot) {
+  PointOnLinks corners;
+  for (double x : {-0.2, 0.2}) {
+    for (double y : {-0.2, 0.2}) {
+      corners.emplace_back(robot.link("l1"), Point3(x, y, -1));
+    }
+  }
+  return corners;
+}
+
+Values InitialValues(const Robot &robot, double height,
+                     const Vector6 &twist = Vector6::Zero()) {
+  Values values;
+  const int id = robot.link("l1")->id();
+  InsertPose(&values, id, 0, Pose3(gtsam::Rot3(), Point3(0, 0, height)));
+  InsertTwist(&values, id, 0, twist);
+  return values;
+}
+}  // namespace
+
+// Dropped from above, the robot comes to rest on the ground, the normal
+// impulses carrying its weight.
+TEST(ContactSimulator, drop) {
+  const Robot robot = TwoLinks();
+  ContactSimulator simulator(robot, InitialValues(robot, 1.1), Corners(robot),
+                             kGravity);
+  const double dt = 0.005;
+  for (size_t k = 0; k < 200; k++) simulator.step(Vector::Zero(1), dt);
+
+  EXPECT_DOUBLES_EQUAL(1.0, simulator.rootPose().z(), 1e-3);
+  EXPECT(simulator.rootTwist().norm() < 1e-3);
+  EXPECT(simulator.activeContacts()[0]);
+  EXPECT_DOUBLES_EQUAL(115 * 9.8 * dt,
+                       simulator.contactImpulses().row(0).sum(), 1e-2);
+  EXPECT(simulator.contactImpulses().row(0).minCoeff() >= 0);
+
+  // Lifted well clear of the ground, no contact is active.
+  ContactSimulator flying(robot, InitialValues(robot, 2.0), Corners(robot),
+                          kGravity);
+  flying.step(Vector::Zero(1), dt);
+  EXPECT(!flying.activeContacts()[0]);
+  EXPECT_DOUBLES_EQUAL(0, flying.contactImpulses().norm(), 1e-12);
+  EXPECT_DOUBLES_EQUAL(-9.8 * dt, flying.rootTwist()(5), 1e-9);
+}
+
+// Friction stops a sliding robot, which keeps sliding without friction.
+TEST(ContactSimulator, friction) {
+  const Robot robot = TwoLinks();
+  Vector6 sliding = Vector6::Zero();
+  sliding(3) = 1.0;
+  const double dt = 0.005;
+
+  // Low enough friction not to tip the robot over, which stops in 1s.
+  ContactSimulatorParams params;
+  params.mu = 0.1;
+  ContactSimulator sticky(robot, InitialValues(robot, 1.0, sliding),
+                          Corners(robot), kGravity, params);
+  for (size_t k = 0; k < 300; k++) sticky.step(Vector::Zero(1), dt);
+  EXPECT_DOUBLES_EQUAL(0, sticky.rootTwist()(3), 1e-3);
+  EXPECT_DOUBLES_EQUAL(0.51, sticky.rootPose().x(), 0.05);
+
+  params.mu = 0;
+  ContactSimulator slippery(robot, InitialValues(robot, 1.0, sliding),
+                            Corners(robot), kGravity, params);
+  for (size_t k = 0; k < 100; k++) slippery.step(Vector::Zero(1), dt);
+  EXPECT_DOUBLES_EQUAL(1.0, slippery.rootTwist()(3), 1e-6);
+  EXPECT_DOUBLES_EQUAL(0.5, slippery.rootPose().x(), 1e-3);
+}
+
+// Contact points can be replaced between steps, e.g. by a new stance.
+TEST(ContactSimulator, contactPoints) {
+  const Robot robot = TwoLinks();
+  ContactSimulator simulator(robot, InitialValues(robot, 1.0), Corners(robot),
+                             kGravity);
+  simulator.step(Vector::Zero(1), 0.01);
+  EXPECT_LONGS_EQUAL(4, simulator.contactImpulses().cols());
+
+  simulator.setContactPoints({});
+  simulator.step(Vector::Zero(1), 0.01);
+  EXPECT_LONGS_EQUAL(0, simulator.contactImpulses().cols());
+  EXPECT(simulator.rootTwist()(5) < 0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
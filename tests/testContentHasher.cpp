@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContentHasher.cpp
+ * @brief Test the stable content hashes used as cache keys.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/ContentHasher.h>
+
+#include <limits>
+
+using namespace gtdynamics;
+
+// The hash is a fixed function of the values, the same in every process.
+TEST(ContentHasher, Stable) {
+  const uint64_t hash = ContentHasher().add(1).add("ab").add(0.5).value();
+  EXPECT(hash == 5848457766509686120ull);
+  EXPECT(hash == ContentHasher()
+                     .add(int64_t(1))
+                     .add(std::string("ab"))
+                     .add(0.5)
+                     .value());
+}
+
+// Order, sizes and values all change the hash; signed zeros and NaNs do not.
+TEST(ContentHasher, Values) {
+  EXPECT(ContentHasher().add(1).add(2).value() !=
+         ContentHasher().add(2).add(1).value());
+  EXPECT(ContentHasher().add("a").add("bc").value() !=
+         ContentHasher().add("ab").add("c").value());
+  EXPECT(ContentHasher().add(gtsam::Vector2(1, 2)).value() !=
+         ContentHasher().add(gtsam::Matrix12(1, 2)).value());
+  EXPECT(ContentHasher().add(0.0).value() ==
+         ContentHasher().add(-0.0).value());
+  EXPECT(ContentHasher().add(std::numeric_limits<double>::quiet_NaN())
+             .value() ==
+         ContentHasher().add(-std::numeric_limits<double>::quiet_NaN())
+             .value());
+  EXPECT(ContentHasher().add(gtsam::Pose3()).value() ==
+         ContentHasher().add(gtsam::Matrix4(gtsam::Matrix4::Identity()))
+             .value());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
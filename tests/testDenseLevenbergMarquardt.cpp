@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testDenseLevenbergMarquardt.cpp
+ * @brief Test Levenberg-Marquardt with dense linear solves.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/DenseLevenbergMarquardt.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+
+using namespace gtdynamics;
+
+// A short chain of link poses, with a prior on the first one, started away
+// from the solution.
+namespace example {
+const int num_steps = 4;
+const auto model = gtsam::noiseModel::Diagonal::Sigmas(
+    (gtsam::Vector6() << 0.1, 0.2, 0.1, 0.3, 0.2, 0.1).finished());
+
+gtsam::NonlinearFactorGraph Graph() {
+  gtsam::NonlinearFactorGraph graph;
+  graph.addPrior(PoseKey(0, 0), Pose3(), model);
+  for (int k = 0; k < num_steps; k++) {
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(0, k), PoseKey(0, k + 1),
+        Pose3(gtsam::Rot3::Rz(0.3), gtsam::Point3(1, 0, 0)), model);
+  }
+  return graph;
+}
+
+Values Initial() {
+  Values values;
+  for (int k = 0; k <= num_steps; k++) {
+    InsertPose(&values, 0, k, Pose3(gtsam::Rot3::Rx(0.1 * k),
+                                    gtsam::Point3(0.8 * k, 0.2, 0)));
+  }
+  return values;
+}
+}  // namespace example
+
+TEST(DenseLevenbergMarquardt, DenseSolvable) {
+  const auto graph = example::Graph();
+  const Values initial = example::Initial();
+  EXPECT(DenseSolvable(graph, initial, 30));
+  EXPECT(!DenseSolvable(graph, initial, 29));
+
+  // Missing values, or a constrained noise model, are not.
+  Values partial = initial;
+  partial.erase(PoseKey(0, 0));
+  EXPECT(!DenseSolvable(graph, partial, 30));
+  auto constrained = graph;
+  constrained.addPrior(PoseKey(0, 1), Pose3(),
+                       gtsam::noiseModel::Constrained::All(6));
+  EXPECT(!DenseSolvable(constrained, initial, 30));
+}
+
+// Iterates, and so the solution, agree with sparse LM.
+TEST(DenseLevenbergMarquardt, optimize) {
+  const auto graph = example::Graph();
+  const Values initial = example::Initial();
+  gtsam::LevenbergMarquardtParams params;
+  params.setlambdaInitial(1e3);
+
+  DenseLevenbergMarquardt optimizer(graph, initial, params);
+  EXPECT_LONGS_EQUAL(30, optimizer.dim());
+  const Values result = optimizer.optimize();
+  gtsam::LevenbergMarquardtOptimizer sparse(graph, initial, params);
+  EXPECT(assert_equal(sparse.optimize(), result, 1e-9));
+  EXPECT_DOUBLES_EQUAL(0, graph.error(result), 1e-6);
+}
+
+// Small soft-constraint solves of Optimizer take the dense path with the
+// same result as the sparse one.
+TEST(DenseLevenbergMarquardt, Optimizer) {
+  const auto graph = example::Graph();
+  const Values initial = example::Initial();
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::SOFT_CONSTRAINTS;
+  const Values dense =
+      Optimizer(parameters).optimize(graph, EqualityConstraints(), initial);
+  parameters.dense_dimension = 0;
+  const Values sparse =
+      Optimizer(parameters).optimize(graph, EqualityConstraints(), initial);
+  EXPECT(assert_equal(sparse, dense, 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
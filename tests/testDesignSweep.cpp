@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testDesignSweep.cpp
+ * @brief Test parallel sweeps over design parameters.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/DesignSweep.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Vector;
+using gtsam::Vector1;
+using gtsam::Vector2;
+
+using namespace gtdynamics;
+
+// A chain x0 - x1 shared by all designs, with a variant prior x0 = d(0).
+// Two-dimensional designs have a second chain link x1 - x2.
+static DesignProblemFactory ChainFactory(size_t *num_builds) {
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  DesignProblemFactory factory;
+  factory.build = [=](const Vector &design) -> DesignProblem {
+    (*num_builds)++;
+    DesignProblem problem;
+    for (int i = 0; i < design.size(); i++) {
+      problem.graph.emplace_shared<gtsam::BetweenFactor<double>>(i, i + 1, 1.0,
+                                                                 model);
+    }
+    for (int i = 0; i <= design.size(); i++) {
+      problem.initial_values.insert<double>(i, 0.0);
+    }
+    return problem;
+  };
+  factory.structure = [](const Vector &design) -> std::string {
+    return std::to_string(design.size());
+  };
+  factory.variant = [=](const Vector &design) -> NonlinearFactorGraph {
+    NonlinearFactorGraph graph;
+    graph.addPrior<double>(0, design(0), model);
+    return graph;
+  };
+  return factory;
+}
+
+TEST(DesignSweep, Chain) {
+  size_t num_builds = 0;
+  DesignSweepParams params;
+  params.batch_size = 2;
+  const DesignSweep sweep(ChainFactory(&num_builds), params);
+  const std::vector<Vector> designs{Vector1(0.0), Vector1(1.0),
+                                    Vector1(0.9), Vector2(3.0, 0.0),
+                                    Vector1(0.2)};
+  const auto solutions = sweep.run(designs);
+  EXPECT_LONGS_EQUAL(designs.size(), solutions.size());
+
+  // One shared problem per structure.
+  EXPECT_LONGS_EQUAL(2, num_builds);
+  EXPECT(solutions[0].built && !solutions[1].built);
+  EXPECT(solutions[3].built);
+
+  // Each design has its own solution.
+  for (size_t d = 0; d < designs.size(); d++) {
+    EXPECT(assert_equal(designs[d], solutions[d].design));
+    EXPECT_DOUBLES_EQUAL(designs[d](0) + 1, solutions[d].values.atDouble(1),
+                         1e-6);
+  }
+  EXPECT_DOUBLES_EQUAL(5.0, solutions[3].values.atDouble(2), 1e-6);
+
+  // Warm starts from the nearest design of an earlier batch.
+  EXPECT_LONGS_EQUAL(-1, solutions[0].warm_start);
+  EXPECT_LONGS_EQUAL(-1, solutions[1].warm_start);
+  EXPECT_LONGS_EQUAL(1, solutions[2].warm_start);
+  EXPECT_LONGS_EQUAL(-1, solutions[3].warm_start);
+  EXPECT_LONGS_EQUAL(0, solutions[4].warm_start);
+}
+
+TEST(DesignSweep, NoFactory) {
+  THROWS_EXCEPTION(DesignSweep{DesignProblemFactory()});
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -13,6 +13,9 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/dynamics/Pseudospectral.h>
+#include <gtdynamics/factors/JointLimitFactor.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
@@ -29,6 +32,7 @@
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
 #include <gtsam/slam/PriorFactor.h>
 
 #include <iostream>
@@ -128,6 +132,51 @@ TEST(dynamicsFactorGraph_FD, simple_urdf_eq_mass) {
   EXPECT(assert_equal(expected_qAccel, actual_qAccel, 1e-3));
 }
 
+// Inertial parameters as variables: the same graph solves for a robot with
+// all inertias doubled, given new priors and twice the torques.
+TEST(dynamicsFactorGraph_FD, inertial_variables) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  size_t t = 777;
+  OptimizerSetting opt;
+  opt.inertial_variables = true;
+  DynamicsGraph graph_builder(opt, simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  const NonlinearFactorGraph dynamics = graph_builder.dynamicsFactorGraph(
+      robot, t);
+
+  Values doubled;
+  for (auto link : robot.links()) {
+    doubled.insert(InertialParametersKey(link->id()),
+                   gtsam::Vector10(2 * InertialParameters(*link)));
+  }
+  for (double scale : {1.0, 2.0}) {
+    NonlinearFactorGraph graph = dynamics;
+    graph.add(graph_builder.inertialParameterPriors(
+        robot, scale == 1.0 ? Values() : doubled));
+    Values known_values = zero_values(robot, t);
+    for (auto&& joint : robot.joints()) {
+      InsertTorque(&known_values, joint->id(), t, scale);
+    }
+    graph.add(graph_builder.forwardDynamicsPriors(robot, t, known_values));
+    for (auto link : robot.links()) {
+      int i = link->id();
+      graph.addPrior(PoseKey(i, t), link->bMcom(),
+                     graph_builder.opt().bp_cost_model);
+      graph.addPrior<Vector6>(TwistKey(i, t), gtsam::Z_6x1,
+                              graph_builder.opt().bv_cost_model);
+    }
+    Initializer initializer;
+    Values init = initializer.ZeroValues(robot, t);
+    InsertInertialParameters(&init, robot);
+    gtsam::GaussNewtonOptimizer optimizer(graph, init);
+    Values result = optimizer.optimize();
+
+    gtsam::Vector expected_qAccel = (gtsam::Vector(1) << 4).finished();
+    EXPECT(assert_equal(expected_qAccel,
+                        DynamicsGraph::jointAccels(robot, result, t), 1e-3));
+  }
+}
+
 // ========================== OLD_STYLE BELOW ===============================
 
 // Test forward dynamics with gravity of a four-bar linkage
@@ -309,6 +358,84 @@ TEST(collocationFactors, simple_urdf) {
   EXPECT(assert_equal(2.5, JointVel(mp_trapezoidal_result, j, t + 1)));
 }
 
+// Hermite-Simpson is exact for a cubic angle trajectory, a = 1 + t.
+TEST(collocationFactors, hermite_simpson) {
+  DynamicsGraph graph_builder;
+  auto robot = simple_urdf::getRobot();
+  double dt = 1;
+  int t = 0, phase = 0;
+  int j = robot.joints()[0]->id();
+
+  NonlinearFactorGraph prior_factors;
+  prior_factors.addPrior(JointAngleKey(j, t), 1.0,
+                         graph_builder.opt().prior_q_cost_model);
+  prior_factors.addPrior(JointVelKey(j, t), 1.0,
+                         graph_builder.opt().prior_qv_cost_model);
+  prior_factors.addPrior(JointAccelKey(j, t), 1.0,
+                         graph_builder.opt().prior_qa_cost_model);
+  prior_factors.addPrior(JointAccelKey(j, t + 1), 2.0,
+                         graph_builder.opt().prior_qa_cost_model);
+  prior_factors.addPrior(PhaseKey(phase), dt,
+                         graph_builder.opt().time_cost_model);
+
+  Values init_values;
+  for (int k = t; k <= t + 1; k++) {
+    InsertJointAngle(&init_values, j, k, 0.0);
+    InsertJointVel(&init_values, j, k, 0.0);
+    InsertJointAccel(&init_values, j, k, 0.0);
+  }
+  init_values.insert(PhaseKey(phase), 0.5);
+
+  NonlinearFactorGraph graph = prior_factors;
+  graph.add(graph_builder.collocationFactors(
+      robot, t, dt, CollocationScheme::HermiteSimpson));
+  Values result = gtsam::GaussNewtonOptimizer(graph, init_values).optimize();
+  EXPECT(assert_equal(8.0 / 3, JointAngle(result, j, t + 1), 1e-9));
+  EXPECT(assert_equal(2.5, JointVel(result, j, t + 1), 1e-9));
+
+  NonlinearFactorGraph mp_graph = prior_factors;
+  mp_graph.add(graph_builder.multiPhaseCollocationFactors(
+      robot, t, phase, CollocationScheme::HermiteSimpson));
+  Values mp_result =
+      gtsam::GaussNewtonOptimizer(mp_graph, init_values).optimize();
+  EXPECT(assert_equal(8.0 / 3, JointAngle(mp_result, j, t + 1), 1e-6));
+  EXPECT(assert_equal(2.5, JointVel(mp_result, j, t + 1), 1e-6));
+}
+
+// LGR defects vanish for polynomial trajectories of degree N at the nodes.
+TEST(collocationFactors, legendre_gauss_radau) {
+  RadauCollocation radau = LegendreGaussRadau(3);
+  EXPECT_DOUBLES_EQUAL(-1, radau.nodes(0), 1e-12);
+  EXPECT_DOUBLES_EQUAL((1 - std::sqrt(6)) / 5, radau.nodes(1), 1e-12);
+  EXPECT_DOUBLES_EQUAL((1 + std::sqrt(6)) / 5, radau.nodes(2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(1, radau.nodes(3), 1e-12);
+
+  DynamicsGraph graph_builder;
+  auto robot = simple_urdf::getRobot();
+  const size_t N = 3;
+  const double dt = 0.2, t0 = 0.5;
+  int j = robot.joints()[0]->id();
+
+  // q = s^3, v = 3 s^2, a = 6 s with s the time.
+  Values values;
+  for (size_t i = 0; i <= N; i++) {
+    const double s = radau.time(i, t0, N * dt);
+    InsertJointAngle(&values, j, i, s * s * s);
+    InsertJointVel(&values, j, i, 3 * s * s);
+    InsertJointAccel(&values, j, i, 6 * s);
+  }
+  values.insert(PhaseKey(0), dt);
+
+  auto graph = graph_builder.pseudospectralCollocationFactors(robot, 0, N, dt);
+  EXPECT_LONGS_EQUAL(2 * N * robot.numJoints(), graph.size());
+  EXPECT_DOUBLES_EQUAL(0, graph.error(values), 1e-9);
+
+  auto mp_graph =
+      graph_builder.multiPhasePseudospectralCollocationFactors(robot, 0, N, 0);
+  EXPECT_LONGS_EQUAL(2 * N * robot.numJoints(), mp_graph.size());
+  EXPECT_DOUBLES_EQUAL(0, mp_graph.error(values), 1e-9);
+}
+
 // test forward dynamics of a trajectory
 TEST(dynamicsTrajectoryFG, simple_urdf_eq_mass) {
   auto robot = simple_urdf_eq_mass::getRobot();
@@ -420,6 +547,45 @@ TEST(dynamicsTrajectoryFG, simple_urdf_eq_mass) {
   EXPECT(assert_equal(3.0, JointAccel(mp_trapezoidal_result, j, 2)));
 }
 
+// Sink overloads append the same factors as the graph-returning versions.
+TEST(dynamicsTrajectoryFG, sinks) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  const int num_steps = 3;
+  const double dt = 0.5;
+  Initializer initializer;
+  const Values init_values =
+      initializer.ZeroValuesTrajectory(robot, num_steps, 2, 0.1);
+
+  // Existing factors are kept in front.
+  NonlinearFactorGraph expected = graph_builder.trajectoryFG(
+      robot, num_steps, dt, CollocationScheme::Trapezoidal);
+  NonlinearFactorGraph graph;
+  graph.add(PriorFactor<double>(PhaseKey(0), dt,
+                                graph_builder.opt().time_cost_model));
+  graph_builder.trajectoryFG(&graph, robot, num_steps, dt,
+                             CollocationScheme::Trapezoidal);
+  EXPECT_LONGS_EQUAL(expected.size() + 1, graph.size());
+  graph.erase(graph.begin());
+  EXPECT(assert_equal(expected.error(init_values), graph.error(init_values),
+                      1e-9));
+
+  // Multi-phase trajectories.
+  vector<int> phase_steps{1, 2};
+  vector<NonlinearFactorGraph> transition_graphs{
+      graph_builder.dynamicsFactorGraph(robot, 1)};
+  expected = graph_builder.multiPhaseTrajectoryFG(
+      robot, phase_steps, transition_graphs, CollocationScheme::Euler);
+  graph = NonlinearFactorGraph();
+  graph_builder.multiPhaseTrajectoryFG(&graph, robot, phase_steps,
+                                       transition_graphs,
+                                       CollocationScheme::Euler);
+  EXPECT_LONGS_EQUAL(expected.size(), graph.size());
+  EXPECT(assert_equal(expected.error(init_values), graph.error(init_values),
+                      1e-9));
+}
+
 // Test contacts in dynamics graph.
 TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rr) {
   // Load the robot from urdf file
@@ -551,6 +717,41 @@ TEST(jointlimitFactors, simple_urdf) {
                       joint_limit_factors.keys().size()));
 }
 
+// One VectorJointLimitFactor per quantity gives the same error.
+TEST(jointlimitFactors, vector_joint_limits) {
+  Robot robot = CreateRobotFromFile(
+      kSdfPath + std::string("test/simple_rrr.sdf"), "simple_rrr_sdf");
+  OptimizerSetting opt;
+  NonlinearFactorGraph scalar_factors =
+      DynamicsGraph(opt).jointLimitFactors(robot, 0);
+  opt.vector_joint_limits = true;
+  NonlinearFactorGraph vector_factors =
+      DynamicsGraph(opt).jointLimitFactors(robot, 0);
+  EXPECT_LONGS_EQUAL(4, vector_factors.size());
+  EXPECT_LONGS_EQUAL(scalar_factors.keys().size(),
+                     vector_factors.keys().size());
+
+  // Values inside and outside of the limits.
+  Values values;
+  double x = -2e4;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, 0, x);
+    InsertJointVel(&values, j, 0, 0.5 * x);
+    InsertJointAccel(&values, j, 0, 0.1 * x);
+    InsertTorque(&values, j, 0, -x);
+    x += 1.5e4;
+  }
+  EXPECT_DOUBLES_EQUAL(scalar_factors.error(values),
+                       vector_factors.error(values), 1e-6);
+  EXPECT(scalar_factors.error(values) > 0);
+  for (auto &&factor : vector_factors) {
+    auto limit = boost::dynamic_pointer_cast<VectorJointLimitFactor>(factor);
+    CHECK(limit);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*limit, values, 1e-3, 1e-5);
+  }
+}
+
 // Test contacts in dynamics graph.
 TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rrr) {
   // Load the robot from urdf file
@@ -607,6 +808,68 @@ TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rrr) {
     EXPECT(assert_equal(0, Torque(results, joint->id())));
 }
 
+// Batched forward dynamics agrees with one linearSolveFD call per sample.
+TEST(linearSolveFDBatch, jumping_robot) {
+  using jumping_robot::gravity, jumping_robot::planar_axis;
+  auto robot = jumping_robot::getRobot();
+  DynamicsGraph graph_builder(gravity, planar_axis);
+  const auto joints = robot.joints();
+  const size_t num_joints = joints.size(), num_samples = 4;
+
+  gtsam::Matrix qs(num_joints, num_samples), vs(num_joints, num_samples),
+      taus(num_joints, num_samples);
+  for (size_t j = 0; j < num_joints; j++) {
+    for (size_t k = 0; k < num_samples; k++) {
+      qs(j, k) = 0.1 * std::sin(j + 2.0 * k);
+      vs(j, k) = 0.2 * std::cos(3.0 * j + k);
+      taus(j, k) = 0.5 * j - 0.3 * k;
+    }
+  }
+  gtsam::Matrix actual = graph_builder.linearSolveFDBatch(robot, qs, vs, taus);
+
+  for (size_t k = 0; k < num_samples; k++) {
+    Values known_values;
+    for (size_t j = 0; j < num_joints; j++) {
+      InsertJointAngle(&known_values, joints[j]->id(), qs(j, k));
+      InsertJointVel(&known_values, joints[j]->id(), vs(j, k));
+    }
+    known_values = robot.forwardKinematics(known_values);
+    for (size_t j = 0; j < num_joints; j++) {
+      InsertTorque(&known_values, joints[j]->id(), taus(j, k));
+    }
+    Values result = graph_builder.linearSolveFD(robot, 0, known_values);
+    for (size_t j = 0; j < num_joints; j++) {
+      EXPECT(assert_equal(JointAccel(result, joints[j]->id()), actual(j, k),
+                          1e-9));
+    }
+  }
+}
+
+// Trajectory extractors have one row per time step, in robot.joints() order.
+TEST(jointAnglesTrajectory, jumping_robot) {
+  auto robot = jumping_robot::getRobot();
+  const auto joints = robot.joints();
+  Values values;
+  for (int t = 0; t < 4; t++) {
+    for (size_t idx = 0; idx < joints.size(); idx++) {
+      InsertJointAngle(&values, joints[idx]->id(), t, 10.0 * t + idx);
+      InsertTorque(&values, joints[idx]->id(), t, -10.0 * t - idx);
+    }
+  }
+
+  const gtsam::Matrix angles =
+      DynamicsGraph::jointAnglesTrajectory(robot, values, 3, 1);
+  EXPECT_LONGS_EQUAL(3, angles.rows());
+  EXPECT_LONGS_EQUAL(joints.size(), angles.cols());
+  for (int k = 0; k < 3; k++) {
+    EXPECT(assert_equal(DynamicsGraph::jointAngles(robot, values, k + 1),
+                        Vector(angles.row(k).transpose())));
+  }
+  const gtsam::Matrix torques =
+      DynamicsGraph::jointTorquesTrajectory(robot, values, 4);
+  EXPECT_DOUBLES_EQUAL(-31, torques(3, 1), 1e-12);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -23,12 +23,12 @@ using namespace gtdynamics;
 /* ************************************************************************* */
 TEST(DynamicsSymbol, LinkJointSymbol) {
   std::string variable_type = "F";
-  const uint8_t link_index = 1;
-  const uint8_t joint_index = 2;
+  const uint16_t link_index = 1;
+  const uint16_t joint_index = 2;
   const uint64_t t = 10;
   const DynamicsSymbol symbol = DynamicsSymbol::LinkJointSymbol(
       variable_type, link_index, joint_index, t);
-  const Key key = 0x004601020000000A;
+  const Key key = 0x004600100200000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal(variable_type, symbol.label()));
   EXPECT_LONGS_EQUAL(link_index, symbol.linkIdx());
@@ -41,11 +41,11 @@ TEST(DynamicsSymbol, LinkJointSymbol) {
 }
 
 TEST(DynamicsSymbol, LinkSymbol) {
-  const uint8_t link_index = 2;
+  const uint16_t link_index = 2;
   const uint64_t t = 10;
   const DynamicsSymbol symbol =
       DynamicsSymbol::LinkSymbol("FA", link_index, 10);
-  const Key key = 0x464102FF0000000A;
+  const Key key = 0x4641002FFF00000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("FA", symbol.label()));
   EXPECT_LONGS_EQUAL(link_index, symbol.linkIdx());
@@ -57,11 +57,11 @@ TEST(DynamicsSymbol, LinkSymbol) {
 }
 
 TEST(DynamicsSymbol, JointSymbol) {
-  const uint8_t joint_index = 1;
+  const uint16_t joint_index = 1;
   const uint64_t t = 10;
   const DynamicsSymbol symbol =
       DynamicsSymbol::JointSymbol("q", joint_index, 10);
-  const Key key = 0x0071FF010000000A;
+  const Key key = 0x0071FFF00100000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("q", symbol.label()));
   EXPECT_LONGS_EQUAL(joint_index, symbol.jointIdx());
@@ -74,7 +74,7 @@ TEST(DynamicsSymbol, JointSymbol) {
 
 TEST(DynamicsSymbol, SimpleSymbol) {
   const DynamicsSymbol symbol = DynamicsSymbol::SimpleSymbol("ti", 10);
-  const Key key = 0x7469FFFF0000000A;
+  const Key key = 0x7469FFFFFF00000A;
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("ti", symbol.label()));
   EXPECT_LONGS_EQUAL(10, symbol.time());
@@ -84,6 +84,46 @@ TEST(DynamicsSymbol, SimpleSymbol) {
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)DynamicsSymbol(key));
 }
 
+// Indices beyond 8 bits, as needed for large models and multi-robot scenes.
+TEST(DynamicsSymbol, LargeIndices) {
+  const uint16_t link_index = 1000, joint_index = 4094;
+  const uint64_t t = (1 << 24) - 1;
+  const DynamicsSymbol symbol =
+      DynamicsSymbol::LinkJointSymbol("F", link_index, joint_index, t);
+  const Key key = 0x00463E8FFEFFFFFF;
+  EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
+  const DynamicsSymbol decoded(key);
+  EXPECT(assert_equal("F", decoded.label()));
+  EXPECT_LONGS_EQUAL(link_index, decoded.linkIdx());
+  EXPECT_LONGS_EQUAL(joint_index, decoded.jointIdx());
+  EXPECT_LONGS_EQUAL(t, decoded.time());
+  EXPECT(assert_equal("F[1000](4094)16777215", (std::string)(decoded)));
+
+  // Indices and time steps that do not fit are rejected.
+  THROWS_EXCEPTION(DynamicsSymbol::LinkSymbol("p", 5000, 0));
+  THROWS_EXCEPTION(DynamicsSymbol::SimpleSymbol("t", uint64_t(1) << 24));
+}
+
+// Labels give the same keys as strings, at compile time.
+TEST(DynamicsSymbol, Label) {
+  using Label = DynamicsSymbol::Label;
+  static constexpr Key wrench =
+      DynamicsSymbol::LinkJointSymbol(Label::Wrench, 1, 2, 10);
+  static_assert(wrench == 0x004600100200000A, "key not packed at compile time");
+  EXPECT_LONGS_EQUAL(
+      (long)(Key)DynamicsSymbol::LinkJointSymbol("F", 1, 2, 10), (long)wrench);
+  EXPECT_LONGS_EQUAL((long)(Key)DynamicsSymbol::SimpleSymbol("dt", 3),
+                     (long)(Key)DynamicsSymbol::SimpleSymbol(Label::Phase, 3));
+  const DynamicsSymbol fa =
+      DynamicsSymbol::JointSymbol(DynamicsSymbol::MakeLabel('f', 'a'), 4, 5);
+  EXPECT(assert_equal("fa(4)5", (std::string)(fa)));
+
+  // Indices and time steps that do not fit are still rejected.
+  THROWS_EXCEPTION(DynamicsSymbol::LinkSymbol(Label::Pose, 5000, 0));
+  THROWS_EXCEPTION(
+      DynamicsSymbol::SimpleSymbol(Label::Time, uint64_t(1) << 24));
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
@@ -165,6 +165,153 @@ TEST(EqualityConstraint, Container) {
   EXPECT_LONGS_EQUAL(2, constraints.size());
 }
 
+// Test batch evaluation of a container.
+TEST(EqualityConstraint, Evaluate) {
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  auto g2 = x1 + x2;
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, 0.1);
+  constraints.emplace_shared<DoubleExpressionEquality>(g2, 0.5);
+
+  Values values;
+  values.insert(x1_key, 1.0);
+  values.insert(x2_key, 1.0);
+  const ConstraintViolations result = constraints.evaluate(values);
+
+  EXPECT_LONGS_EQUAL(2, result.violations.size());
+  EXPECT(assert_equal(Vector::Constant(1, 4.0), result.violations[0]));
+  EXPECT(assert_equal(Vector::Constant(1, 2.0), result.violations[1]));
+  EXPECT(assert_equal(constraints[0]->toleranceScaledViolation(values),
+                      result.scaled[0]));
+  EXPECT(assert_equal(Vector::Constant(1, 4.0), result.scaled[1]));
+  EXPECT_DOUBLES_EQUAL(1616.0, result.squaredNorm(), 1e-9);
+}
+
+// Test that updated penalty factors equal newly created ones.
+TEST(EqualityConstraint, updateFactor) {
+  Vector2_ x1_vec_expr(x1_key);
+  Vector2_ x2_vec_expr(x2_key);
+  const DoubleExpressionEquality scalar(x1 + pow(x1, 3) + x2, 0.1);
+  const VectorExpressionEquality<2> vector(x1_vec_expr + x2_vec_expr,
+                                           Vector2(0.1, 0.5));
+
+  Values values;
+  values.insert(x1_key, 1.0);
+  values.insert(x2_key, -0.5);
+  Values vector_values;
+  vector_values.insert(x1_key, Vector2(1, 2));
+  vector_values.insert(x2_key, Vector2(0.5, -1));
+
+  Vector scalar_bias = Vector::Constant(1, 0.5);
+  Vector vector_bias = Vector2(1, 0.5);
+  auto scalar_factor = scalar.createFactor(1.0);
+  auto vector_factor = vector.createFactor(1.0);
+  EXPECT(scalar.updateFactor(*scalar_factor, 4.0, scalar_bias));
+  EXPECT(vector.updateFactor(*vector_factor, 4.0, vector_bias));
+  EXPECT_DOUBLES_EQUAL(scalar.createFactor(4.0, scalar_bias)->error(values),
+                       scalar_factor->error(values), 1e-9);
+  EXPECT_DOUBLES_EQUAL(
+      vector.createFactor(4.0, vector_bias)->error(vector_values),
+      vector_factor->error(vector_values), 1e-9);
+
+  // Back to no bias with the same mu, which keeps the noise model.
+  auto noise_model = scalar_factor->noiseModel();
+  EXPECT(scalar.updateFactor(*scalar_factor, 4.0));
+  EXPECT(noise_model == scalar_factor->noiseModel());
+  EXPECT_DOUBLES_EQUAL(scalar.createFactor(4.0)->error(values),
+                       scalar_factor->error(values), 1e-9);
+
+  // Factors of another kind cannot be updated.
+  auto other = PoseFactor(noiseModel::Unit::Create(6),
+                          make_joint(Pose3(), Vector6::Unit(2)), 0);
+  EXPECT(!scalar.updateFactor(*other, 4.0));
+}
+
+// A stacked constraint is the separate constraints, in one block factor.
+TEST(EqualityConstraint, StackedVectorEquality) {
+  Vector2_ x1_vec_expr(x1_key);
+  Vector2_ x2_vec_expr(x2_key);
+  Symbol x3_key('x', 3);
+  Vector2_ x3_vec_expr(x3_key);
+  const std::vector<Vector2_> expressions{x1_vec_expr + x2_vec_expr,
+                                          x2_vec_expr - x3_vec_expr};
+  const Vector2 tolerance(0.1, 0.5);
+  for (bool parallel : {false, true}) {
+    const StackedVectorEquality<2> stacked(expressions, tolerance, parallel);
+    const VectorExpressionEquality<2> first(expressions[0], tolerance),
+        second(expressions[1], tolerance);
+    EXPECT_LONGS_EQUAL(2, stacked.size());
+    EXPECT_LONGS_EQUAL(4, stacked.dim());
+
+    Values values;
+    values.insert(x1_key, Vector2(1, 1));
+    values.insert(x2_key, Vector2(-1, -1));
+    values.insert(x3_key, Vector2(-1, -1));
+    EXPECT(stacked.feasible(values));
+    values.update(x3_key, Vector2(1, 2));
+    EXPECT(!stacked.feasible(values));
+
+    Vector expected(4);
+    expected << first(values), second(values);
+    EXPECT(assert_equal(expected, stacked(values)));
+    EXPECT(assert_equal(stacked.scaleViolation(expected),
+                        stacked.toleranceScaledViolation(values)));
+
+    // One factor, with the error of both penalty factors.
+    Vector bias = (Vector(4) << 1, 0.5, -1, 0).finished();
+    Vector bias1 = bias.head<2>(), bias2 = bias.tail<2>();
+    auto factor = stacked.createFactor(4.0, bias);
+    EXPECT_LONGS_EQUAL(3, factor->size());
+    EXPECT_DOUBLES_EQUAL(first.createFactor(4.0, bias1)->error(values) +
+                             second.createFactor(4.0, bias2)->error(values),
+                         factor->error(values), 1e-9);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+
+    // Updated in place, as the other penalty factors.
+    EXPECT(stacked.updateFactor(*factor, 1.0));
+    EXPECT_DOUBLES_EQUAL(stacked.createFactor(1.0)->error(values),
+                         factor->error(values), 1e-9);
+  }
+}
+
+// Test methods of FactorEquality, and splitting off stiff factors.
+TEST(EqualityConstraint, FactorEquality) {
+  NonlinearFactorGraph graph;
+  graph.addPrior(x1_key, 1.0, noiseModel::Isotropic::Sigma(1, 1e-4));
+  graph.addPrior(x2_key, 2.0, noiseModel::Isotropic::Sigma(1, 0.1));
+  graph.addPrior(x2_key, 3.0, noiseModel::Constrained::All(1));
+
+  NonlinearFactorGraph soft;
+  const EqualityConstraints hard = HardConstraints(graph, 1e-3, &soft);
+  EXPECT_LONGS_EQUAL(2, hard.size());
+  EXPECT_LONGS_EQUAL(1, soft.size());
+  EXPECT(soft.at(0) == graph.at(1));
+
+  Values values;
+  values.insert(x1_key, 1.00005);
+  values.insert(x2_key, 0.0);
+  const auto& stiff = *hard.at(0);
+  EXPECT(stiff.feasible(values));
+  EXPECT(assert_equal(Vector::Constant(1, 0.00005), stiff(values), 1e-12));
+  EXPECT(assert_equal(Vector::Constant(1, 0.5),
+                      stiff.toleranceScaledViolation(values), 1e-9));
+  EXPECT(!hard.at(1)->feasible(values));
+
+  // The merit factor with unit penalty has the error of the factor.
+  EXPECT_DOUBLES_EQUAL(graph.at(0)->error(values),
+                       stiff.createFactor(1.0)->error(values), 1e-9);
+  EXPECT_DOUBLES_EQUAL(graph.at(2)->error(values),
+                       hard.at(1)->createFactor(1.0)->error(values), 1e-9);
+
+  // Bias and penalty update in place.
+  Vector bias = Vector::Constant(1, 0.00005);
+  auto merit_factor = stiff.createFactor(1.0);
+  EXPECT(stiff.updateFactor(*merit_factor, 4.0, bias));
+  EXPECT(assert_equal(*stiff.createFactor(4.0, bias), *merit_factor));
+  EXPECT_DOUBLES_EQUAL(0.5 * 4 * 1.0, merit_factor->error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*merit_factor, values, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
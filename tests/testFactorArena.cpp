@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFactorArena.cpp
+ * @brief Test arena allocation of factor graphs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/FactorArena.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdint>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// Allocations are aligned, and a reset recycles the blocks.
+TEST(FactorArena, allocate) {
+  FactorArena arena(256);
+  void *a = arena.allocate(10, 32);
+  void *b = arena.allocate(100, 64);
+  void *c = arena.allocate(1000, 16);  // larger than a block
+  EXPECT_LONGS_EQUAL(0, reinterpret_cast<uintptr_t>(a) % 32);
+  EXPECT_LONGS_EQUAL(0, reinterpret_cast<uintptr_t>(b) % 64);
+  EXPECT_LONGS_EQUAL(0, reinterpret_cast<uintptr_t>(c) % 16);
+  EXPECT_LONGS_EQUAL(3, arena.numLive());
+  EXPECT(arena.bytesAllocated() >= 1110);
+
+  THROWS_EXCEPTION(arena.reset());
+  arena.deallocate(a);
+  arena.deallocate(b);
+  arena.deallocate(c);
+  const size_t reserved = arena.bytesReserved();
+  arena.reset();
+  EXPECT_LONGS_EQUAL(0, arena.numAllocations());
+  arena.deallocate(arena.allocate(10, 32));
+  EXPECT_LONGS_EQUAL(reserved, arena.bytesReserved());
+}
+
+// A dynamics graph built in an arena is the same as one on the heap.
+TEST(FactorArena, dynamicsGraph) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder(OptimizerSetting(1e-5), simple_rr::gravity);
+  const Values values = Initializer().ZeroValues(robot, 0, 0.1);
+  const NonlinearFactorGraph expected =
+      graph_builder.dynamicsFactorGraph(robot, 0);
+
+  FactorArena arena;
+  for (int cycle = 0; cycle < 2; cycle++) {
+    {
+      FactorArena::Scope scope(&arena);
+      EXPECT(FactorArena::Active() == &arena);
+      NonlinearFactorGraph graph = graph_builder.dynamicsFactorGraph(robot, 0);
+      graph.add(LinkObjectives(0).pose(gtsam::Pose3(),
+                                       gtsam::noiseModel::Unit::Create(6)));
+      const size_t live = arena.numLive();
+      EXPECT(live > 1);
+      EXPECT_DOUBLES_EQUAL(expected.error(values) + graph.back()->error(values),
+                           graph.error(values), 1e-9);
+
+      // Clones of arena factors are in the arena too.
+      const auto clone = graph[0]->clone();
+      EXPECT_LONGS_EQUAL(live + 1, arena.numLive());
+    }
+    EXPECT(FactorArena::Active() == nullptr);
+    EXPECT_LONGS_EQUAL(0, arena.numLive());
+    arena.reset();
+  }
+
+  // Without a scope, factors are on the heap.
+  const NonlinearFactorGraph heap = graph_builder.dynamicsFactorGraph(robot, 0);
+  EXPECT_LONGS_EQUAL(0, arena.numLive());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFixedNumericalDerivative.cpp
+ * @brief Test the fixed-size central-difference Jacobians.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/FixedNumericalDerivative.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/geometry/Pose3.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+const Pose3 wTb(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(1, 2, 0.5));
+const Point3 bP(0.3, -0.1, 0.2);
+const double scale = 1.5;
+
+// A function of mixed scalar, vector and manifold arguments.
+Point3 Transform(double s, const Pose3 &pose, const Point3 &point) {
+  return s * pose.transformFrom(point);
+}
+}  // namespace example
+
+using namespace example;
+
+// The Jacobians match those of gtsam::numericalDerivative3*, in fixed sizes.
+TEST(FixedNumericalDerivative, MatchesGtsam) {
+  auto f = [](double s, const Pose3 &pose, const Point3 &point) -> Point3 {
+    return Transform(s, pose, point);
+  };
+  const Eigen::Matrix<double, 3, 1> H_s =
+      FixedNumericalDerivative<0>(f, 1e-5, scale, wTb, bP);
+  const Eigen::Matrix<double, 3, 6> H_pose =
+      FixedNumericalDerivative<1>(f, 1e-5, scale, wTb, bP);
+  const Eigen::Matrix<double, 3, 3> H_point =
+      FixedNumericalDerivative<2>(f, 1e-5, scale, wTb, bP);
+
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative31<Point3, double, Pose3, Point3>(
+          Transform, scale, wTb, bP),
+      gtsam::Matrix(H_s), 1e-9));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative32<Point3, double, Pose3, Point3>(
+          Transform, scale, wTb, bP),
+      gtsam::Matrix(H_pose), 1e-9));
+  EXPECT(assert_equal(gtsam::Matrix(scale * wTb.rotation().matrix()),
+                      gtsam::Matrix(H_point), 1e-8));
+}
+
+// Only the requested Jacobians of a factor are computed.
+TEST(FixedNumericalDerivative, NumericalJacobian) {
+  const double c = 2.0;
+  auto error = [c](double p, double v, double m) -> gtsam::Vector1 {
+    return gtsam::Vector1(1e3 * p * v - c * m);
+  };
+  gtsam::Matrix H_p, H_m;
+  NumericalJacobian<0>(H_p, error, 0.2, 0.3, 0.4);
+  NumericalJacobian<1>(boost::none, error, 0.2, 0.3, 0.4);
+  NumericalJacobian<2>(H_m, error, 0.2, 0.3, 0.4);
+  EXPECT(assert_equal(gtsam::Matrix::Constant(1, 1, 1e3 * 0.3), H_p, 1e-6));
+  EXPECT(assert_equal(gtsam::Matrix::Constant(1, 1, -c), H_m, 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,153 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testForwardKinematicsPlan.cpp
+ * @brief Test the precompiled forward kinematics against Robot.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/ForwardKinematicsPlan.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+// Same poses and twists as Robot::forwardKinematics on the A1.
+TEST(ForwardKinematicsPlan, A1) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const ForwardKinematicsPlan plan(robot, "trunk");
+  EXPECT_LONGS_EQUAL(robot.numJoints(), plan.steps().size());
+
+  const Pose3 wTroot(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                     gtsam::Point3(1, 2, 0.5));
+  Vector6 V_root;
+  V_root << 0.1, 0.2, -0.3, 0.5, 0.0, 0.4;
+
+  Values known_values;
+  Vector q = Vector::Zero(plan.numJointSlots()), q_dot = q;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    q(j) = 0.3 * std::sin(j + 1.0);
+    q_dot(j) = 0.5 * std::cos(2.0 * j);
+    InsertJointAngle(&known_values, j, 3, q(j));
+    InsertJointVel(&known_values, j, 3, q_dot(j));
+  }
+  const int root_id = robot.link("trunk")->id();
+  InsertPose(&known_values, root_id, 3, wTroot);
+  InsertTwist(&known_values, root_id, 3, V_root);
+  const Values expected = robot.forwardKinematics(known_values, 3, "trunk");
+
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  plan.compute(q, q_dot, wTroot, V_root, &poses, &twists);
+  EXPECT_LONGS_EQUAL(plan.numLinkSlots(), poses.size());
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(Pose(expected, i, 3), poses[i], 1e-9));
+    EXPECT(assert_equal(Twist(expected, i, 3), twists[i], 1e-9));
+  }
+
+  // Re-using the outputs does not reallocate them.
+  const Pose3* data = poses.data();
+  plan.compute(q, q_dot, wTroot, V_root, &poses);
+  EXPECT(data == poses.data());
+
+  // Joint arrays must be indexed by joint id.
+  THROWS_EXCEPTION(plan.compute(Vector::Zero(1), Vector::Zero(1), wTroot,
+                                V_root, &poses));
+}
+
+// A closed loop is traversed as a spanning tree.
+TEST(ForwardKinematicsPlan, FourBar) {
+  const Robot robot = four_bar_linkage_pure::getRobot();
+  const ForwardKinematicsPlan plan(robot, "l1");
+  EXPECT_LONGS_EQUAL(robot.numLinks() - 1, plan.steps().size());
+
+  Values known_values;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&known_values, joint->id(), 0.0);
+    InsertJointVel(&known_values, joint->id(), 0.0);
+  }
+  const Values expected = robot.forwardKinematics(known_values, 0, "l1");
+
+  std::vector<Pose3> poses;
+  const Vector q = Vector::Zero(plan.numJointSlots());
+  plan.compute(q, q, Pose3(), Vector6::Zero(), &poses);
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(Pose(expected, link->id()), poses[link->id()], 1e-9));
+  }
+}
+
+// Batched poses match single-configuration forward kinematics.
+TEST(ForwardKinematicsPlan, computeBatch) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const ForwardKinematicsPlan plan(robot, "trunk");
+  const Pose3 wTroot(gtsam::Rot3::RzRyRx(0.3, 0.2, -0.1),
+                     gtsam::Point3(0, 1, 0.4));
+
+  const size_t num_samples = 9;
+  gtsam::Matrix qs(plan.numJointSlots(), num_samples);
+  for (size_t j = 0; j < plan.numJointSlots(); j++) {
+    for (size_t k = 0; k < num_samples; k++) {
+      qs(j, k) = std::sin(1.0 + j + 3.0 * k);
+    }
+  }
+
+  std::vector<ForwardKinematicsPlan::PoseArray> batch;
+  plan.computeBatch(qs, wTroot, &batch);
+  std::vector<Pose3> poses;
+  for (size_t k = 0; k < num_samples; k++) {
+    const Vector q = qs.col(k);
+    plan.compute(q, q, wTroot, Vector6::Zero(), &poses);
+    for (auto&& link : robot.links()) {
+      const int i = link->id();
+      EXPECT_LONGS_EQUAL(num_samples, batch[i].cols());
+      EXPECT(assert_equal(poses[i],
+                          ForwardKinematicsPlan::PoseAt(batch[i], k), 1e-9));
+    }
+  }
+}
+
+// Prismatic joints are batched as pure translations.
+TEST(ForwardKinematicsPlan, computeBatchPrismatic) {
+  const Robot robot = simple_urdf_prismatic::getRobot();
+  const ForwardKinematicsPlan plan(robot, "l1");
+  gtsam::Matrix qs(plan.numJointSlots(), 3);
+  qs.setZero();
+  qs.row(robot.joints()[0]->id()) << -0.5, 0.1, 2.0;
+
+  std::vector<ForwardKinematicsPlan::PoseArray> batch;
+  plan.computeBatch(qs, Pose3(), &batch);
+  std::vector<Pose3> poses;
+  for (size_t k = 0; k < 3; k++) {
+    const Vector q = qs.col(k);
+    plan.compute(q, q, Pose3(), Vector6::Zero(), &poses);
+    for (auto&& link : robot.links()) {
+      EXPECT(assert_equal(poses[link->id()],
+                          ForwardKinematicsPlan::PoseAt(batch[link->id()], k),
+                          1e-9));
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
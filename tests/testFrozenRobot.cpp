@@ -0,0 +1,63 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFrozenRobot.cpp
+ * @brief Test the immutable robot snapshot.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/FrozenRobot.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+
+// Links, joints and topology match the robot.
+TEST(FrozenRobot, accessors) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const FrozenRobotPtr frozen = Freeze(robot);
+
+  EXPECT_LONGS_EQUAL(robot.links().size(), frozen->linkIds().size());
+  EXPECT_LONGS_EQUAL(robot.joints().size(), frozen->jointIds().size());
+  for (auto &&link : robot.links()) {
+    EXPECT(&frozen->link(link->id()) == link.get());
+    EXPECT_LONGS_EQUAL(link->id(), frozen->linkId(link->name()));
+    EXPECT_LONGS_EQUAL(link->joints().size(),
+                       frozen->linkJointIds(link->id()).size());
+  }
+  for (auto &&joint : robot.joints()) {
+    EXPECT(&frozen->joint(joint->id()) == joint.get());
+    EXPECT_LONGS_EQUAL(joint->parent()->id(), frozen->parentId(joint->id()));
+    EXPECT_LONGS_EQUAL(joint->child()->id(), frozen->childId(joint->id()));
+  }
+  THROWS_EXCEPTION(frozen->link(-1));
+  THROWS_EXCEPTION(frozen->joint(int(frozen->numJointSlots())));
+}
+
+// The fixed state is that of the robot variant at the time of freezing.
+TEST(FrozenRobot, fixedLinks) {
+  const Robot robot = simple_urdf::getRobot();
+  const int l1 = robot.link("l1")->id(), l2 = robot.link("l2")->id();
+  const Pose3 wTl2(gtsam::Rot3::Rx(0.2), gtsam::Point3(0, 0, 2));
+  const FrozenRobot frozen(robot.unfixLink("l1").fixLink("l2", wTl2));
+
+  EXPECT(!frozen.isFixed(l1));
+  EXPECT(frozen.isFixed(l2));
+  EXPECT(assert_equal(wTl2, frozen.fixedPose(l2)));
+  EXPECT(robot.isFixed(robot.link("l1")));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGaitLibrary.cpp
+ * @brief Test building trajectory graphs from cached prototypes.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/GaitLibrary.h>
+#include <gtdynamics/utils/Trajectory.h>
+
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+TEST(GaitLibrary, multiPhaseFactorGraph) {
+  using namespace walk_cycle_example;
+  const Trajectory trajectory(walk_cycle, 3);
+  const double mu = 1.0;
+  const auto graph_builder =
+      DynamicsGraph(OptimizerSetting(1e-5), gtsam::Vector3(0, 0, -9.8));
+
+  const NonlinearFactorGraph expected = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Euler, mu);
+
+  GaitLibrary library(robot, graph_builder, CollocationScheme::Euler, mu);
+  const NonlinearFactorGraph graph = library.multiPhaseFactorGraph(trajectory);
+  EXPECT_LONGS_EQUAL(expected.size(), graph.size());
+  EXPECT(expected.keys() == graph.keys());
+
+  // Both phases, and the contacts common to both at the transitions.
+  EXPECT_LONGS_EQUAL(3, library.numPatterns());
+
+  // The stamped factors have the same errors.
+  Initializer initializer;
+  Values values =
+      trajectory.multiPhaseInitialValues(robot, initializer, 1e-5, 1. / 240);
+  for (size_t p = 0; p < trajectory.numPhases(); p++) {
+    values.insert(PhaseKey(p), 1. / 240);
+  }
+  const double error = expected.error(values);
+  EXPECT_DOUBLES_EQUAL(error, graph.error(values), 1e-9 * error);
+
+  // A second trajectory with the same gait reuses the prototypes.
+  library.multiPhaseFactorGraph(Trajectory(walk_cycle, 2));
+  EXPECT_LONGS_EQUAL(3, library.numPatterns());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
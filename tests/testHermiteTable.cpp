@@ -0,0 +1,60 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testHermiteTable.cpp
+ * @brief Test tabulated functions with cubic Hermite interpolation.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/HermiteTable.h>
+#include <gtsam/base/Vector.h>
+
+#include <cmath>
+
+using gtdynamics::HermiteTable;
+using gtsam::Vector2;
+
+// Cubics are reproduced exactly, with their derivatives.
+TEST(HermiteTable, Cubic) {
+  const HermiteTable<2> table(-1, 2, 3, [](double x, Vector2 *H) {
+    *H << 3 * x * x - 2, 1;
+    return Vector2(x * x * x - 2 * x + 1, x);
+  });
+  EXPECT(table.contains(-1) && table.contains(2) && !table.contains(2.1));
+  EXPECT_DOUBLES_EQUAL(2, table.xMax(), 1e-12);
+  for (double x : {-1.0, -0.3, 0.0, 0.7, 1.5, 2.0}) {
+    Vector2 H;
+    const Vector2 value = table(x, &H);
+    EXPECT_DOUBLES_EQUAL(x * x * x - 2 * x + 1, value(0), 1e-12);
+    EXPECT_DOUBLES_EQUAL(x, value(1), 1e-12);
+    EXPECT_DOUBLES_EQUAL(3 * x * x - 2, H(0), 1e-12);
+    EXPECT_DOUBLES_EQUAL(1, H(1), 1e-12);
+  }
+}
+
+// Smooth functions are approximated to O(h^4).
+TEST(HermiteTable, Smooth) {
+  typedef HermiteTable<1>::VectorN Vector1;
+  const HermiteTable<1> table(0, M_PI, 100, [](double x, Vector1 *H) {
+    (*H)(0) = std::cos(x);
+    return Vector1::Constant(std::sin(x));
+  });
+  for (double x = 0; x <= M_PI; x += 0.0137) {
+    Vector1 H;
+    EXPECT_DOUBLES_EQUAL(std::sin(x), table(x, &H)(0), 1e-8);
+    EXPECT_DOUBLES_EQUAL(std::cos(x), H(0), 1e-5);
+  }
+  THROWS_EXCEPTION(HermiteTable<1>(1, 0, 10, [](double, Vector1 *) {
+    return Vector1::Zero();
+  }));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIncrementalForwardKinematics.cpp
+ * @brief Test that incremental forward kinematics only updates the subtrees
+ * of changed joints, and matches the full computation.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/IncrementalForwardKinematics.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace {
+// Check all poses and twists against a full computation by the plan.
+bool MatchesPlan(const IncrementalForwardKinematics &fk, const Pose3 &wTroot,
+                 const Vector6 &V_root) {
+  std::vector<Pose3> poses;
+  std::vector<Vector6> twists;
+  fk.plan().compute(fk.jointAngles(), fk.jointVels(), wTroot, V_root, &poses,
+                    &twists);
+  bool result = true;
+  for (size_t i = 0; i < poses.size(); i++) {
+    result &= assert_equal(poses[i], fk.pose(i), 1e-9);
+    result &= assert_equal(twists[i], fk.twist(i), 1e-9);
+  }
+  return result;
+}
+
+bool Contains(const std::vector<int> &ids, int id) {
+  return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+}  // namespace
+
+// Moving one joint of a leg only updates the links below it.
+TEST(IncrementalForwardKinematics, A1) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const Pose3 wTroot(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                     gtsam::Point3(1, 2, 0.5));
+  Vector6 V_root;
+  V_root << 0.1, 0.2, -0.3, 0.5, 0.0, 0.4;
+  IncrementalForwardKinematics fk(robot, "trunk", wTroot, V_root);
+
+  // The first update computes everything.
+  Vector q = Vector::Zero(fk.plan().numJointSlots()), q_dot = q;
+  for (auto &&joint : robot.joints()) {
+    q(joint->id()) = 0.3 * std::sin(joint->id() + 1.0);
+    q_dot(joint->id()) = 0.5 * std::cos(2.0 * joint->id());
+  }
+  fk.setJointAngles(q);
+  fk.setJointVels(q_dot);
+  EXPECT(fk.dirty());
+  EXPECT_LONGS_EQUAL(robot.numLinks(), fk.update().size());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), fk.numStepsComputed());
+  EXPECT(!fk.dirty());
+  EXPECT(MatchesPlan(fk, wTroot, V_root));
+
+  // Setting the same values changes nothing.
+  fk.setJointAngles(q);
+  EXPECT(!fk.dirty());
+  EXPECT(fk.update().empty());
+
+  // The lower leg and its toe.
+  const auto lower_joint = robot.joint("FR_lower_joint");
+  fk.setJointAngle(lower_joint->id(), 0.7);
+  const std::vector<int> updated = fk.update();
+  EXPECT_LONGS_EQUAL(2, updated.size());
+  EXPECT_LONGS_EQUAL(2, fk.numStepsComputed());
+  EXPECT(Contains(updated, lower_joint->child()->id()));
+  EXPECT(Contains(updated, robot.joint("FR_toe_fixed")->child()->id()));
+  EXPECT(MatchesPlan(fk, wTroot, V_root));
+
+  // A velocity change only updates the subtree too.
+  fk.setJointVel(robot.joint("RL_hip_joint")->id(), -1.0);
+  EXPECT(!Contains(fk.update(), robot.link("trunk")->id()));
+  EXPECT(MatchesPlan(fk, wTroot, V_root));
+
+  // Moving the root updates every link.
+  const Pose3 wTroot2 = wTroot.retract(Vector6::Constant(0.1));
+  fk.setRoot(wTroot2, V_root);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), fk.update().size());
+  EXPECT(MatchesPlan(fk, wTroot2, V_root));
+
+  THROWS_EXCEPTION(fk.setJointAngle(-1, 0.0));
+  THROWS_EXCEPTION(fk.setJointAngles(Vector::Zero(1)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInertialIdentification.cpp
+ * @brief Test the inertial regressor and the streamed identification.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/InertialIdentification.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/TrajectoryFile.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+Robot FixedRR() { return simple_rr::getRobot().fixLink("link_0"); }
+
+// Joint angles, velocities and accelerations of sample i.
+void Sample(int i, Vector *q, Vector *v, Vector *a) {
+  *q = (Vector(2) << std::sin(0.3 * i), std::cos(0.7 * i)).finished();
+  *v = (Vector(2) << std::cos(0.2 * i), -std::sin(0.5 * i)).finished();
+  *a = (Vector(2) << std::sin(1.1 * i), 0.5 * std::cos(0.9 * i)).finished();
+}
+}  // namespace
+
+// The regressor times the nominal parameters is the RNEA.
+TEST(InertialRegressor, inverseDynamics) {
+  const Robot robot = FixedRR();
+  const InertialRegressor regressor(robot, kGravity);
+  EXPECT_LONGS_EQUAL(30, regressor.numParameters());
+  Vector q, v, a;
+  Sample(3, &q, &v, &a);
+  const Matrix Y = regressor.regressor(q, v, a);
+  EXPECT(assert_equal(regressor.inverseDynamics(q, v, a).torques,
+                      Vector(Y * regressor.nominalParameters()), 1e-9));
+  THROWS_EXCEPTION(InertialRegressor(simple_rr::getRobot(), kGravity));
+}
+
+// Inertial parameters round trip, and match Link::inertiaMatrix().
+TEST(InertialRegressor, parameters) {
+  const Robot robot = FixedRR();
+  const auto link = robot.link("link_1");
+  EXPECT(assert_equal(Matrix(link->inertiaMatrix()),
+                      Matrix(SpatialInertia(InertialParameters(*link)))));
+
+  const double m = 2.0;
+  const gtsam::Point3 c(0.1, 0.2, 0.3);
+  const gtsam::Matrix3 I_c = gtsam::Vector3(1, 2, 3).asDiagonal();
+  const gtsam::Matrix3 S_c = gtsam::skewSymmetric(c(0), c(1), c(2));
+  const gtsam::Matrix3 I_o = I_c - m * S_c * S_c;
+  gtsam::Vector10 parameters;
+  parameters << m, m * c, I_o(0, 0), I_o(0, 1), I_o(0, 2), I_o(1, 1),
+      I_o(1, 2), I_o(2, 2);
+  gtsam::Point3 com;
+  gtsam::Matrix3 inertia;
+  EXPECT_DOUBLES_EQUAL(m, MassProperties(parameters, &com, &inertia), 1e-12);
+  EXPECT(assert_equal(c, com, 1e-12));
+  EXPECT(assert_equal(I_c, inertia, 1e-12));
+}
+
+// Streamed samples identify parameters that predict the torques, from
+// samples added one by one or read from a trajectory file.
+TEST(InertialIdentification, identify) {
+  const Robot robot = FixedRR();
+  InertialIdentificationParams params;
+  params.torque_sigma = 1e-3;
+  params.chunk_size = 7;
+  InertialIdentification identification(robot, kGravity, boost::none,
+                                         params);
+  const InertialRegressor &regressor = identification.regressor();
+
+  // True parameters, away from the nominal ones.
+  Vector truth = regressor.nominalParameters();
+  for (int i = 0; i < truth.size(); i++) truth(i) *= 1.0 + 0.1 * (i % 4);
+
+  const int num_samples = 50;
+  const size_t J = robot.numJoints();
+  Matrix table(num_samples, 4 * J + 1);
+  for (int i = 0; i < num_samples; i++) {
+    Vector q, v, a;
+    Sample(i, &q, &v, &a);
+    const Vector tau = regressor.regressor(q, v, a) * truth;
+    identification.addSample(q, v, a, tau);
+    table.row(i) << q.transpose(), v.transpose(), a.transpose(),
+        tau.transpose(), 0.01;
+  }
+  EXPECT_LONGS_EQUAL(num_samples, identification.numSamples());
+  const Vector solution = identification.solve();
+  EXPECT(identification.residualRms() < 1e-3);
+
+  Vector q, v, a;
+  Sample(num_samples + 5, &q, &v, &a);
+  const Matrix Y = regressor.regressor(q, v, a);
+  EXPECT(assert_equal(Vector(Y * truth), Vector(Y * solution), 1e-3));
+
+  // The same problem as a JacobianFactor on the parameter keys.
+  gtsam::GaussianFactorGraph graph;
+  graph.push_back(identification.linearFactor());
+  const gtsam::VectorValues x = graph.optimize();
+  const auto &links = regressor.links();
+  for (size_t i = 0; i < links.size(); i++) {
+    EXPECT(assert_equal(Vector(solution.segment<10>(10 * i)),
+                        x.at(InertialParametersKey(links[i]->id())), 1e-6));
+  }
+
+  // The same samples from a memory-mapped file.
+  std::vector<std::string> names;
+  for (auto &&joint : robot.joints()) names.push_back(joint->name());
+  WriteTrajectoryFile("testInertialIdentification.traj", names,
+                      {num_samples}, {0.01}, table);
+  InertialIdentification from_file(robot, kGravity, boost::none, params);
+  EXPECT_LONGS_EQUAL(num_samples, from_file.addTrajectoryFile(
+                                      "testInertialIdentification.traj"));
+  EXPECT(assert_equal(solution, from_file.solve(), 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
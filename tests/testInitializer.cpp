@@ -16,6 +16,7 @@
 #include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 #include <gtsam/base/numericalDerivative.h>
@@ -104,6 +105,33 @@ TEST(InitializeSolutionUtils, InitializeSolutionInterpolationMultiPhase) {
   EXPECT(assert_equal(wTb_t[1], pose));
 }
 
+TEST(InitializeSolutionUtils, InterpolatePosesBatch) {
+  const Pose3 wTb_i(Rot3(), Point3(0, 0, 1));
+  const std::vector<Pose3> wTb_t = {
+      Pose3(Rot3::RzRyRx(0.3, -0.2, 1.0), Point3(1, 0, 2.5)),
+      Pose3(Rot3::RzRyRx(0.0, 0.4, -0.5), Point3(2, 1, 2.5))};
+  const std::vector<double> timesteps = {5, 10};
+
+  Initializer initializer;
+  const std::vector<Pose3> expected =
+      initializer.InterpolatePoses(wTb_i, wTb_t, 0.0, timesteps, 1.0);
+  const gtsam::Matrix poses =
+      initializer.InterpolatePosesBatch(wTb_i, wTb_t, 0.0, timesteps, 1.0);
+  EXPECT_LONGS_EQUAL(expected.size(), poses.cols());
+
+  // Rotations are the same, translations are linear.
+  gtsam::Values values;
+  InsertPoses(&values, 3, poses, 2);
+  for (size_t k = 0; k < expected.size(); k++) {
+    const Pose3 pose = Pose(values, 3, k + 2);
+    EXPECT(assert_equal(expected[k].rotation(), pose.rotation(), 1e-9));
+  }
+  EXPECT(assert_equal(Point3(0.6, 0, 1.9), Pose(values, 3, 2 + 3).translation(),
+                      1e-9));
+  EXPECT(assert_equal(wTb_t[0], Pose(values, 3, 2 + 5), 1e-9));
+  EXPECT(assert_equal(wTb_t[1], Pose(values, 3, 2 + 17), 1e-9));
+}
+
 TEST(InitializeSolutionUtils, InitializePosesAndJoints) {
   auto robot =
       CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
@@ -200,6 +228,21 @@ TEST(InitializeSolutionUtils, InverseKinematics) {
   EXPECT(assert_equal(wTb_t[0], pose, 1e-3));
   pose = Pose(init_vals, l1->id(), T) * oTc_l1;
   EXPECT(assert_equal(0.0, pose.translation().z(), 1e-3));
+
+  // Chunks of time steps solved concurrently satisfy the same constraints.
+  for (size_t chunk_size : {1, 3}) {
+    const gtsam::Values chunked_vals =
+        initializer.InitializeSolutionInverseKinematics(
+            robot, l2->name(), wTb_i, wTb_t, ts, dt, kNoiseSigma,
+            contact_points, chunk_size);
+    EXPECT_LONGS_EQUAL(init_vals.size(), chunked_vals.size());
+    for (size_t t = 0; t <= T; t++) {
+      EXPECT(assert_equal(Pose(init_vals, l2->id(), t),
+                          Pose(chunked_vals, l2->id(), t), 1e-3));
+      pose = Pose(chunked_vals, l1->id(), t) * oTc_l1;
+      EXPECT(assert_equal(0.0, pose.translation().z(), 1e-3));
+    }
+  }
 }
 
 TEST(InitializeSolutionUtils, ZeroValues) {
@@ -258,6 +301,25 @@ TEST(InitializeSolutionUtils, ZeroValuesTrajectory) {
   }
 }
 
+// Seeded noise depends on the seed and the step only.
+TEST(InitializeSolutionUtils, SeededZeroValues) {
+  auto robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  const Initializer a(3), b(3), c(4);
+  const gtsam::Values values = a.ZeroValues(robot, 5, 0.1);
+  EXPECT(assert_equal(values, b.ZeroValues(robot, 5, 0.1), 0));
+  EXPECT(!assert_equal(values, c.ZeroValues(robot, 5, 0.1), 1e-9));
+
+  // Other steps get other noise.
+  const gtsam::Values shifted = a.ZeroValues(robot, 6, 0.1);
+  EXPECT(!assert_equal(Pose(values, 0, 5), Pose(shifted, 0, 6), 1e-9));
+
+  // So do the slices of a trajectory, whatever order they are built in.
+  const gtsam::Values trajectory =
+      Initializer(3).ZeroValuesTrajectory(robot, 10, -1, 0.1);
+  EXPECT(assert_equal(Pose(values, 0, 5), Pose(trajectory, 0, 5), 0));
+}
+
 TEST(InitializeSolutionUtils, MultiPhaseInverseKinematicsTrajectory) {
   auto robot =
       CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
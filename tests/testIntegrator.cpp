@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIntegrator.cpp
+ * @brief Test the joint space integrators.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/Integrator.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Vector;
+
+namespace example {
+// Harmonic oscillator a = -q, with solution q = cos(t), v = -sin(t).
+const AccelFunction oscillator = [](const Vector &q, const Vector &v) {
+  return Vector(-q);
+};
+
+// Integrate num_steps steps of size dt from q = 1, v = 0.
+size_t Simulate(IntegrationMethod method, double dt, size_t num_steps,
+                Vector *q, Vector *v, double tolerance = 1e-6) {
+  *q = Vector::Ones(1);
+  *v = Vector::Zero(1);
+  size_t evaluations = 0;
+  for (size_t k = 0; k < num_steps; k++) {
+    evaluations +=
+        Integrate(method, oscillator, dt, oscillator(*q, *v), q, v, tolerance);
+  }
+  return evaluations;
+}
+}  // namespace example
+
+// Both Euler methods only use the given accelerations.
+TEST(Integrator, Euler) {
+  Vector q = Vector::Ones(1), v = Vector::Ones(1);
+  const Vector a = Vector::Constant(1, 2.0);
+  EXPECT_LONGS_EQUAL(
+      0, Integrate(ExplicitEuler, example::oscillator, 0.1, a, &q, &v));
+  EXPECT(assert_equal(Vector(Vector::Constant(1, 1.11)), q, 1e-12));
+  EXPECT(assert_equal(Vector(Vector::Constant(1, 1.2)), v, 1e-12));
+
+  q = Vector::Ones(1);
+  v = Vector::Ones(1);
+  EXPECT_LONGS_EQUAL(
+      0, Integrate(SemiImplicitEuler, example::oscillator, 0.1, a, &q, &v));
+  EXPECT(assert_equal(Vector(Vector::Constant(1, 1.12)), q, 1e-12));
+  EXPECT(assert_equal(Vector(Vector::Constant(1, 1.2)), v, 1e-12));
+}
+
+// RK4 is much more accurate than Euler for the same step size.
+TEST(Integrator, RK4) {
+  Vector q, v;
+  EXPECT_LONGS_EQUAL(30, example::Simulate(RK4, 0.1, 10, &q, &v));
+  EXPECT_DOUBLES_EQUAL(std::cos(1.0), q(0), 1e-6);
+  EXPECT_DOUBLES_EQUAL(-std::sin(1.0), v(0), 1e-6);
+
+  example::Simulate(ExplicitEuler, 0.1, 10, &q, &v);
+  EXPECT(std::abs(q(0) - std::cos(1.0)) > 1e-3);
+}
+
+// RK45 takes sub-steps to meet the tolerance over one large step.
+TEST(Integrator, RK45) {
+  Vector q, v;
+  const size_t evaluations = example::Simulate(RK45, 2.0, 1, &q, &v, 1e-9);
+  EXPECT(evaluations > 6);
+  EXPECT_DOUBLES_EQUAL(std::cos(2.0), q(0), 1e-7);
+  EXPECT_DOUBLES_EQUAL(-std::sin(2.0), v(0), 1e-7);
+
+  // A looser tolerance needs fewer evaluations.
+  EXPECT(example::Simulate(RK45, 2.0, 1, &q, &v, 1e-3) < evaluations);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
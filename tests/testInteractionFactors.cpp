@@ -0,0 +1,93 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInteractionFactors.cpp
+ * @brief Test the factors between links of two robots in contact.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/InteractionFactors.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+namespace example {
+const Pose3 wTa(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(1, 2, 0.5)),
+    wTb(Rot3::RzRyRx(-0.4, 0.2, 0.1), Point3(1.2, 1.8, 0.7));
+const auto kModel3 = gtsam::noiseModel::Isotropic::Sigma(3, 0.1);
+const auto kModel6 = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+}  // namespace example
+
+using namespace example;
+
+// The world wrench is Ad(wTcom^{-1})^T F, with correct Jacobians.
+TEST(WorldWrench, Jacobians) {
+  Vector6 F;
+  F << 0.3, -0.2, 0.1, 1.0, -2.0, 3.0;
+  gtsam::Matrix6 H_pose, H_F;
+  const Vector6 W = WorldWrench(wTa, F, H_pose, H_F);
+  EXPECT(assert_equal(Vector6(wTa.inverse().AdjointMap().transpose() * F), W,
+                      1e-9));
+
+  auto f = [](const Pose3 &pose, const Vector6 &wrench) {
+    return WorldWrench(pose, wrench);
+  };
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative21<Vector6, Pose3, Vector6>(f, wTa, F), H_pose,
+      1e-7));
+  EXPECT(assert_equal(
+      gtsam::numericalDerivative22<Vector6, Pose3, Vector6>(f, wTa, F), H_F,
+      1e-7));
+}
+
+// The contact points coincide when both are at the same world point.
+TEST(InteractionPointFactor, error) {
+  const Point3 comPa(0.1, 0, 0);
+  const Point3 comPb = wTb.transformTo(wTa.transformFrom(comPa));
+  InteractionPointFactor factor(PoseKey(0), PoseKey(5), kModel3, comPa, comPb);
+  EXPECT(assert_equal(gtsam::Vector3::Zero(), factor.evaluateError(wTa, wTb),
+                      1e-9));
+
+  gtsam::Values values;
+  InsertPose(&values, 0, wTa);
+  InsertPose(&values, 5, Pose3(Rot3(), Point3(0, 0, 1)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// Opposite wrenches in the world frame have zero error.
+TEST(ReactionWrenchFactor, error) {
+  ReactionWrenchFactor factor(PoseKey(0), PoseKey(5), ContactWrenchKey(0, 1),
+                              ContactWrenchKey(5, 1), kModel6);
+  Vector6 F_a;
+  F_a << 0.3, -0.2, 0.1, 1.0, -2.0, 3.0;
+  const Vector6 F_b = -wTb.AdjointMap().transpose() * WorldWrench(wTa, F_a);
+  EXPECT(assert_equal(Vector6::Zero(), factor.evaluateError(wTa, wTb, F_a, F_b),
+                      1e-9));
+
+  gtsam::Values values;
+  InsertPose(&values, 0, wTa);
+  InsertPose(&values, 5, wTb);
+  values.insert(ContactWrenchKey(0, 1), F_a);
+  values.insert(ContactWrenchKey(5, 1), Vector6(Vector6::Ones()));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
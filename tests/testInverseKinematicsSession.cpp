@@ -0,0 +1,63 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInverseKinematicsSession.cpp
+ * @brief Test warm-started inverse kinematics.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/InverseKinematicsSession.h>
+
+#include "contactGoalsExample.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+
+// Shift all goals by the same offset.
+static ContactGoals Shifted(const ContactGoals& goals, const Point3& offset) {
+  ContactGoals shifted;
+  for (const ContactGoal& goal : goals) {
+    shifted.emplace_back(goal.point_on_link, goal.goal_point + offset);
+  }
+  return shifted;
+}
+
+TEST(InverseKinematicsSession, warmStart) {
+  using namespace contact_goals_example;
+  const size_t k = 3;
+  InverseKinematicsSession session(robot, Slice(k));
+  EXPECT(!session.warm());
+
+  constexpr double tol = 1e-3;
+  const gtsam::Values& first = session.solve(contact_goals);
+  EXPECT(session.warm());
+  for (const ContactGoal& goal : contact_goals) {
+    EXPECT(goal.satisfied(first, k, tol));
+  }
+  const size_t cold_iterations = session.iterations();
+
+  // A small motion of the goals is tracked in fewer iterations.
+  const ContactGoals moved = Shifted(contact_goals, Point3(0.01, 0, 0.005));
+  const gtsam::Values& second = session.solve(moved);
+  for (const ContactGoal& goal : moved) {
+    EXPECT(goal.satisfied(second, k, tol));
+  }
+  EXPECT(session.iterations() < cold_iterations);
+
+  // A zero time budget still does one iteration.
+  session.solve(Shifted(moved, Point3(0.01, 0, 0)), 0.0);
+  EXPECT_LONGS_EQUAL(1, session.iterations());
+
+  session.reset();
+  EXPECT(!session.warm());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testIterateRecorder.cpp
+ * @brief Test recording optimizer iterates and iterate files.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/IterateRecorder.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <fstream>
+
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+using namespace gtdynamics;
+
+// Iterate k of a joint angle, a twist and a pose.
+static Values Iterate(int k) {
+  Values values;
+  InsertJointAngle(&values, 0, 0, 0.5 * k);
+  InsertTwist(&values, 1, 0, Vector6::Constant(k));
+  InsertPose(&values, 1, 0, Pose3(gtsam::Rot3(), gtsam::Point3(k, 0, 0)));
+  return values;
+}
+
+TEST(IterateRecorder, record) {
+  IterateRecorder recorder(Iterate(0), 3);
+  EXPECT_LONGS_EQUAL(3, recorder.numVariables());
+  EXPECT_LONGS_EQUAL(1 + 6 + 12, recorder.width());
+  for (int k = 0; k < 3; k++) recorder.record(Iterate(k));
+  EXPECT_LONGS_EQUAL(3, recorder.numIterates());
+
+  EXPECT(assert_equal((Matrix(1, 3) << 0, 0.5, 1).finished(),
+                      recorder.history(JointAngleKey(0, 0))));
+  const Matrix poses = recorder.history(PoseKey(1, 0));
+  EXPECT_LONGS_EQUAL(12, poses.rows());
+  EXPECT(assert_equal(Vector(gtsam::Vector3(2, 0, 0)),
+                      Vector(poses.col(2).tail<3>())));
+  EXPECT_DOUBLES_EQUAL(1.0, poses(0, 2), 1e-9);
+
+  // Missing variables leave the recorded iterates as they were.
+  Values partial;
+  InsertJointAngle(&partial, 0, 0, 1.0);
+  THROWS_EXCEPTION(recorder.record(partial));
+  EXPECT_LONGS_EQUAL(3, recorder.numIterates());
+  THROWS_EXCEPTION(recorder.index(TorqueKey(0, 0)));
+}
+
+TEST(IterateRecorder, save) {
+  IterateRecorder recorder(Iterate(0));
+  for (int k = 0; k < 4; k++) recorder.record(Iterate(k));
+  recorder.save("testIterateRecorder.iter");
+
+  const IterateFile file("testIterateRecorder.iter");
+  EXPECT_LONGS_EQUAL(4, file.numIterates());
+  EXPECT(file.keys() == recorder.keys());
+  EXPECT(assert_equal(Vector(recorder.iterate(3)), Vector(file.iterate(3))));
+  const size_t i = recorder.index(TwistKey(1, 0));
+  EXPECT(assert_equal(recorder.history(TwistKey(1, 0)),
+                      Matrix(file.history(i))));
+  EXPECT_LONGS_EQUAL(0, reinterpret_cast<uintptr_t>(file.iterate(0).data()) %
+                            64);
+
+  std::ofstream("testIterateRecorder.csv") << "not an iterate file\n";
+  THROWS_EXCEPTION(IterateFile("testIterateRecorder.csv"));
+  THROWS_EXCEPTION(IterateFile("testIterateRecorder_missing.iter"));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
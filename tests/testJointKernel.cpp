@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointKernel.cpp
+ * @brief Test the type-specialized joint kinematics against Joint.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/FixedJoint.h>
+#include <gtdynamics/universal_robot/HelicalJoint.h>
+#include <gtdynamics/universal_robot/JointKernel.h>
+#include <gtdynamics/universal_robot/PrismaticJoint.h>
+#include <gtdynamics/universal_robot/RevoluteJoint.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+// Check a kernel against its joint for a few angles.
+bool Agrees(const Joint& joint) {
+  const JointKernel kernel(joint);
+  bool ok = kernel.type == joint.type() && kernel.id == joint.id();
+  for (double q : {-2.0, -0.3, 0.0, 1e-8, 0.7, 3.0}) {
+    ok = ok && assert_equal(joint.parentTchild(q), kernel.parentTchild(q),
+                            1e-9);
+    ok = ok && assert_equal(joint.childTparent(q), kernel.childTparent(q),
+                            1e-9);
+    ok = ok && assert_equal(joint.childTwist(q), kernel.childTwist(q));
+    ok = ok && assert_equal(joint.parentTwist(q), kernel.parentTwist(q));
+  }
+  return ok;
+}
+
+// Check the closed-form exponential against Expmap, and the derivatives of
+// the joint transforms against numerical ones.
+bool ExpAndDerivativesAgree(const Joint& joint) {
+  bool ok = true;
+  for (double q : {-2.0, -0.3, 0.0, 1e-8, 0.7, 3.0}) {
+    const gtsam::Vector6 S = joint.cScrewAxis();
+    ok = ok && assert_equal(Pose3::Expmap(S * q),
+                            JointKernel::Exp(joint.type(), S, q), 1e-9);
+
+    gtsam::Vector6 H_q;
+    joint.parentTchild(q, H_q);
+    auto pTc = [&](double x) -> Pose3 { return joint.parentTchild(x); };
+    const gtsam::Matrix expected_H_q =
+        gtsam::numericalDerivative11<Pose3, double>(pTc, q);
+    ok = ok && assert_equal(expected_H_q, gtsam::Matrix(H_q), 1e-7);
+
+    for (auto&& link : joint.links()) {
+      const gtsam::Matrix6 actual = joint.relativeAdjointMapJacobianQ(link, q);
+      const double d = 1e-6;
+      const gtsam::Matrix6 numerical =
+          (joint.relativeAdjointMap(link, q + d) -
+           joint.relativeAdjointMap(link, q - d)) /
+          (2 * d);
+      ok = ok && assert_equal(gtsam::Matrix(numerical), gtsam::Matrix(actual),
+                              1e-6);
+    }
+  }
+  return ok;
+}
+}  // namespace example
+
+TEST(JointKernel, AllTypes) {
+  auto robot = simple_urdf::getRobot();
+  auto l1 = robot.link("l1");
+  auto l2 = robot.link("l2");
+  const Pose3 bTj(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(0.5, 0, 2));
+  const gtsam::Vector3 axis(1, 2, 3);
+
+  EXPECT(example::Agrees(
+      RevoluteJoint(1, "r", bTj, l1, l2, axis.normalized())));
+  EXPECT(example::Agrees(PrismaticJoint(2, "p", bTj, l1, l2, axis)));
+  EXPECT(example::Agrees(
+      HelicalJoint(3, "h", bTj, l1, l2, axis.normalized(), 0.5)));
+  EXPECT(example::Agrees(FixedJoint(4, "f", bTj, l1, l2)));
+}
+
+// The closed-form exponentials and derivatives of each joint type.
+TEST(JointKernel, ExpAndDerivatives) {
+  auto robot = simple_urdf::getRobot();
+  auto l1 = robot.link("l1");
+  auto l2 = robot.link("l2");
+  const Pose3 bTj(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(0.5, 0, 2));
+  const gtsam::Vector3 axis(1, 2, 3);
+
+  EXPECT(example::ExpAndDerivativesAgree(
+      RevoluteJoint(1, "r", bTj, l1, l2, axis.normalized())));
+  EXPECT(example::ExpAndDerivativesAgree(
+      PrismaticJoint(2, "p", bTj, l1, l2, axis)));
+  EXPECT(example::ExpAndDerivativesAgree(
+      HelicalJoint(3, "h", bTj, l1, l2, axis.normalized(), 0.5)));
+  EXPECT(example::ExpAndDerivativesAgree(FixedJoint(4, "f", bTj, l1, l2)));
+}
+
+// All joints of the A1 agree.
+TEST(JointKernel, A1) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  for (auto&& joint : robot.joints()) {
+    EXPECT(example::Agrees(*joint));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,64 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointKinematicsCache.cpp
+ * @brief Test that joint factors share transforms through the cache, with
+ * the same linearization.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/JointKinematicsCache.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Linearizing a time slice computes each joint's transforms once.
+TEST(JointKinematicsCache, dynamicsGraph) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder(OptimizerSetting(1e-5), simple_rr::gravity);
+  const gtsam::NonlinearFactorGraph graph =
+      graph_builder.dynamicsFactorGraph(robot, 0);
+  const Values values = Initializer().ZeroValues(robot, 0, 0.1);
+
+  EXPECT(JointKinematicsCache::Active() == nullptr);
+  const auto expected = graph.linearize(values);
+  {
+    JointKinematicsCache::Scope scope;
+    JointKinematicsCache &cache = scope.cache();
+    EXPECT(JointKinematicsCache::Active() == &cache);
+    const auto actual = graph.linearize(values);
+    EXPECT(assert_equal(*expected, *actual, 1e-12));
+
+    // At most one entry per joint at its angle, and one at zero angle for
+    // the derivatives of the adjoint maps.
+    const size_t size = cache.size();
+    EXPECT(size >= robot.numJoints() && size <= 2 * robot.numJoints());
+    EXPECT_LONGS_EQUAL(cache.size(), cache.misses());
+    EXPECT(cache.hits() > cache.misses());
+
+    // Nested scopes share the outer cache.
+    JointKinematicsCache::Scope nested;
+    EXPECT(&nested.cache() == &cache);
+    const size_t hits = cache.hits();
+    graph.linearize(values);
+    EXPECT_LONGS_EQUAL(size, cache.size());
+    EXPECT(cache.hits() > hits);
+  }
+  EXPECT(JointKinematicsCache::Active() == nullptr);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,177 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointSpaceSimulator.cpp
+ * @brief Test the preallocated joint space simulator.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Same trajectory as the Values based Simulator, with the full history.
+TEST(JointSpaceSimulator, simple_urdf) {
+  using simple_urdf::gravity;
+  using simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  Values initial_values;
+  InsertJointAngle(&initial_values, 0, 0.1);
+  InsertJointVel(&initial_values, 0, -0.2);
+
+  const size_t num_steps = 3;
+  const double dt = 0.1;
+  Simulator simulator(robot, initial_values, gravity, planar_axis,
+                      ArticulatedBody);
+  JointSpaceSimulator joint_simulator(robot, initial_values, num_steps,
+                                      gravity, planar_axis);
+  EXPECT_LONGS_EQUAL(0, joint_simulator.currentStep());
+
+  for (size_t k = 0; k < num_steps; k++) {
+    Values torques;
+    InsertTorque(&torques, 0, 1.0 + k);
+    simulator.step(torques, dt);
+    joint_simulator.step(Vector::Constant(1, 1.0 + k), dt);
+
+    const Values &expected = simulator.getValues();
+    EXPECT_DOUBLES_EQUAL(JointAngle(expected, 0),
+                         joint_simulator.jointAngles()(0, k), 1e-9);
+    EXPECT_DOUBLES_EQUAL(JointVel(expected, 0),
+                         joint_simulator.jointVels()(0, k), 1e-9);
+    EXPECT_DOUBLES_EQUAL(JointAccel(expected, 0),
+                         joint_simulator.jointAccels()(0, k), 1e-9);
+    EXPECT_DOUBLES_EQUAL(1.0 + k, joint_simulator.torques()(0, k), 1e-9);
+  }
+  EXPECT_LONGS_EQUAL(num_steps, joint_simulator.currentStep());
+  EXPECT_LONGS_EQUAL(num_steps + 1, joint_simulator.jointAngles().cols());
+
+  // Values of a simulated step.
+  Values values = joint_simulator.values(1);
+  EXPECT(assert_equal(joint_simulator.jointAngles()(0, 1),
+                      JointAngle(values, 0, 1)));
+  EXPECT(assert_equal(2.0, Torque(values, 0, 1)));
+
+  // The same history as a TrajectoryState.
+  const TrajectoryState state = joint_simulator.trajectoryState();
+  EXPECT_LONGS_EQUAL(num_steps + 1, state.numSteps());
+  EXPECT(assert_equal(joint_simulator.jointAngles(), state.jointAngles()));
+  EXPECT_DOUBLES_EQUAL(3.0, state.torque(0, 2), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0, state.torque(0, 3), 1e-9);
+
+  // The history is full.
+  THROWS_EXCEPTION(joint_simulator.step(Vector::Zero(1), dt));
+}
+
+// simulateTrajectory() records the steps of the Values based Simulator.
+TEST(JointSpaceSimulator, simulateTrajectory) {
+  auto robot = simple_urdf::getRobot();
+  Values initial_values;
+  InsertJointAngle(&initial_values, 0, 0.1);
+  InsertJointVel(&initial_values, 0, 0.0);
+  std::vector<Values> torques_seq(2);
+  InsertTorque(&torques_seq[0], 0, 1.0);
+  InsertTorque(&torques_seq[1], 0, 2.0);
+
+  Simulator simulator(robot, initial_values, simple_urdf::gravity,
+                      simple_urdf::planar_axis, ArticulatedBody);
+  JointSpaceSimulator joint_simulator(robot, initial_values, 2,
+                                      simple_urdf::gravity,
+                                      simple_urdf::planar_axis);
+  const TrajectoryState state = simulator.simulateTrajectory(torques_seq, 0.1);
+  joint_simulator.simulate((gtsam::Matrix(1, 2) << 1.0, 2.0).finished(), 0.1);
+  EXPECT(assert_equal(joint_simulator.jointAccels(), state.jointAccels()));
+  EXPECT(assert_equal(joint_simulator.torques(), state.torques()));
+}
+
+// simulate() resets and replays a torque matrix.
+TEST(JointSpaceSimulator, simulate) {
+  auto robot = simple_urdf::getRobot();
+  JointSpaceSimulator simulator(robot, Values(), 2, simple_urdf::gravity,
+                                simple_urdf::planar_axis);
+  gtsam::Matrix torques = gtsam::Matrix::Constant(1, 2, 1.0);
+  simulator.simulate(torques, 1.0);
+  const gtsam::Matrix first = simulator.jointAngles();
+  simulator.simulate(torques, 1.0);
+  EXPECT(assert_equal(first, simulator.jointAngles()));
+  EXPECT_DOUBLES_EQUAL(0.0625, simulator.jointAccels()(0, 1), 1e-9);
+  THROWS_EXCEPTION(simulator.simulate(gtsam::Matrix::Zero(1, 3), 1.0));
+}
+
+// Adjoint gradients of a rollout loss match finite differences of rollouts.
+TEST(JointSpaceSimulator, adjoint) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const size_t num_steps = 5;
+  const double dt = 0.02;
+  JointSpaceSimulator simulator(robot, Values(), num_steps, gravity);
+  simulator.recordTape();
+  EXPECT(simulator.recordsTape());
+
+  // L = sum over steps of q_k . w, plus |v_K|^2 / 2.
+  const Vector w = (Vector(2) << 1.0, -0.5).finished();
+  const Vector q0 = (Vector(2) << 0.3, -0.2).finished();
+  const Vector v0 = (Vector(2) << 0.1, 0.4).finished();
+  gtsam::Matrix torques(2, num_steps);
+  for (size_t k = 0; k < num_steps; k++) torques.col(k) << 0.5 * k, -1.0;
+  auto loss = [&](const Vector &q, const Vector &v,
+                  const gtsam::Matrix &tau) -> double {
+    simulator.reset(q, v);
+    simulator.simulate(tau, dt);
+    return (w.transpose() * simulator.jointAngles()).sum() +
+           0.5 * simulator.v().squaredNorm();
+  };
+
+  loss(q0, v0, torques);
+  gtsam::Matrix dL_dq = w.replicate(1, num_steps + 1);
+  gtsam::Matrix dL_dv = gtsam::Matrix::Zero(2, num_steps + 1);
+  dL_dv.col(num_steps) = simulator.v();
+  const JointSpaceSimulator::Gradient gradient =
+      simulator.adjoint(dL_dq, dL_dv);
+
+  const double h = 1e-6;
+  for (size_t k = 0; k < num_steps; k++) {
+    for (size_t j = 0; j < 2; j++) {
+      gtsam::Matrix plus = torques, minus = torques;
+      plus(j, k) += h;
+      minus(j, k) -= h;
+      EXPECT_DOUBLES_EQUAL(
+          (loss(q0, v0, plus) - loss(q0, v0, minus)) / (2 * h),
+          gradient.torques(j, k), 1e-6);
+    }
+  }
+  for (size_t j = 0; j < 2; j++) {
+    const Vector e = h * Vector::Unit(2, j);
+    EXPECT_DOUBLES_EQUAL(
+        (loss(q0 + e, v0, torques) - loss(q0 - e, v0, torques)) / (2 * h),
+        gradient.q0(j), 1e-6);
+    EXPECT_DOUBLES_EQUAL(
+        (loss(q0, v0 + e, torques) - loss(q0, v0 - e, torques)) / (2 * h),
+        gradient.v0(j), 1e-6);
+  }
+
+  // The accelerations are affine in the torques.
+  gtsam::Matrix J_tau;
+  simulator.stepJacobian(0, nullptr, &J_tau);
+  EXPECT(assert_equal(gradient.torques.col(0),
+                      J_tau.transpose() * gradient.accels.col(0), 1e-6));
+  THROWS_EXCEPTION(simulator.stepJacobian(num_steps));
+  THROWS_EXCEPTION(simulator.adjoint(dL_dq.leftCols(2), dL_dv));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJsonSaver.cpp
+ * @brief Test the streaming json export of factor graphs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/JsonSaver.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// The streamed lists have the layout of JsonSaver::JsonList.
+TEST(JsonStreamWriter, Layout) {
+  std::stringstream ss;
+  JsonStreamWriter writer(ss);
+  writer.beginList();
+  writer.beginList();
+  writer.item() << "1";
+  writer.item() << "2";
+  writer.endList();
+  writer.item() << "3";
+  writer.endList();
+
+  const std::string inner = JsonSaver::JsonList({"1", "2"});
+  EXPECT(JsonSaver::JsonList({inner, "3"}) == ss.str());
+}
+
+// SaveFactorGraph writes the same json as composing the strings.
+TEST(JsonSaver, SaveFactorGraph) {
+  NonlinearFactorGraph graph;
+  Values values;
+  auto noise = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  for (int t = 0; t < 3; t++) {
+    graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, t), t,
+                                                     noise);
+    InsertJointAngle(&values, 0, t, 0.5 * t);
+  }
+
+  std::stringstream ss;
+  JsonSaver::SaveFactorGraph(graph, ss, values);
+
+  std::vector<std::string> variables, factors;
+  for (gtsam::Key key : graph.keys()) {
+    variables.push_back(
+        JsonSaver::GetVariable(key, values, JsonSaver::LocationType()));
+  }
+  for (size_t i = 0; i < graph.size(); i++) {
+    factors.push_back(JsonSaver::GetFactor(i, graph, values));
+  }
+  const std::string expected = JsonSaver::JsonList(
+      {JsonSaver::JsonList(variables), JsonSaver::JsonList(factors)});
+  EXPECT(expected == ss.str());
+}
+
+// The sliced graph has one summary per slice, and chunks of detail with the
+// factors of each slice under their names in the whole graph.
+TEST(JsonSaver, SaveSlicedGraph) {
+  NonlinearFactorGraph graph;
+  Values values;
+  auto noise = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  for (int t = 0; t < 3; t++) {
+    graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, t), t,
+                                                     noise);
+    InsertJointAngle(&values, 0, t, 0.5 * t);
+  }
+  // A factor between slices 0 and 1 belongs to slice 0.
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      JointAngleKey(0, 0), JointAngleKey(0, 1), 0.5, noise);
+
+  JsonSaver::SaveSlicedGraph(".", graph, values);
+  auto read = [](const std::string &path) -> std::string {
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+  };
+
+  const std::string index = read("./index.json");
+  for (int t = 0; t < 3; t++) {
+    EXPECT(index.find("\"slice_" + std::to_string(t) + ".json\"") !=
+           std::string::npos);
+  }
+  EXPECT(index.find("\"neighbors\":[1]") != std::string::npos);
+
+  const std::string chunk = read("./slice_0.json");
+  EXPECT(chunk.find("\"Factor3\"") != std::string::npos);
+  EXPECT(chunk.find("\"Factor1\"") == std::string::npos);
+  EXPECT(read("./slice_1.json").find("\"Factor1\"") != std::string::npos);
+
+  for (auto &&name : {"index", "slice_0", "slice_1", "slice_2"}) {
+    std::remove((std::string("./") + name + ".json").c_str());
+  }
+  THROWS_EXCEPTION(
+      JsonSaver::SaveSlicedGraph("./no/such/directory", graph, values));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
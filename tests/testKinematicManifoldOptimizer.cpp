@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testKinematicManifoldOptimizer.cpp
+ * @brief Test optimization on the kinematic constraint manifold.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/optimizer/KinematicManifoldOptimizer.h>
+#include <gtdynamics/utils/Slice.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "contactGoalsExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Reducing drops all link poses but the root, expanding restores them by FK.
+TEST(KinematicManifoldOptimizer, reduceExpand) {
+  using namespace contact_goals_example;
+  const size_t k = 3;
+  KinematicManifoldOptimizer optimizer(robot, k, std::string("body"));
+
+  Kinematics kinematics;
+  const Values values = kinematics.initialValues(Slice(k), robot, 0.0);
+  const Values reduced = optimizer.reduce(values);
+  EXPECT_LONGS_EQUAL(12 + 1, reduced.size());
+  EXPECT(!optimizer.isEliminated(PoseKey(robot.link("body")->id(), k)));
+  EXPECT(optimizer.isEliminated(PoseKey(robot.link("lower0")->id(), k)));
+
+  const Values full = optimizer.expand(reduced);
+  EXPECT_LONGS_EQUAL(12 + 13, full.size());
+  for (const auto& constraint : kinematics.constraints(Slice(k), robot)) {
+    EXPECT(constraint->feasible(full));
+  }
+}
+
+// Goals are reached while pose constraints hold exactly.
+TEST(KinematicManifoldOptimizer, inverseKinematics) {
+  using namespace contact_goals_example;
+  const size_t k = 777;
+  const Slice slice(k);
+  Kinematics kinematics;
+  auto graph = kinematics.jointAngleObjectives(slice, robot);
+  graph.addPrior(PoseKey(robot.link("body")->id(), k),
+                 robot.link("body")->bMcom(),
+                 gtsam::noiseModel::Isotropic::Sigma(6, 0.1));
+  const auto goals = kinematics.pointGoalConstraints(slice, contact_goals);
+
+  KinematicManifoldOptimizer optimizer(robot, k, std::string("body"));
+  ConstrainedOptResult intermediate;
+  const Values result =
+      optimizer.optimize(graph, goals, kinematics.initialValues(slice, robot),
+                         &intermediate);
+  EXPECT(!intermediate.intermediate_values.empty());
+
+  for (const auto& constraint : kinematics.constraints(slice, robot)) {
+    EXPECT(constraint->feasible(result));
+  }
+  for (const ContactGoal& goal : contact_goals) {
+    EXPECT(goal.satisfied(result, k, 1e-2));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
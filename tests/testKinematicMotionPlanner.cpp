@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testKinematicMotionPlanner.cpp
+ * @brief Test the kinematic crawl-gait planner.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/KinematicMotionPlanner.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector3;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"));
+
+// A short crawl, one support phase per 0.4 s.
+KinematicMotionPlannerParams Params() {
+  KinematicMotionPlannerParams params;
+  params.feet = {"lower0", "lower1", "lower2", "lower3"};
+  params.wTb_f = Pose3(gtsam::Rot3(), Point3(0.1, 0, 0.1));
+  params.horizon = 0.8;
+  params.t_support = 0.4;
+  params.dt = 0.025;
+  params.chunk_size = 8;
+  return params;
+}
+}  // namespace example
+
+TEST(KinematicMotionPlanner, HermiteCoefficients) {
+  const Vector3 p_0(1, 2, 3), p_1(4, 5, 6), v_0(1, 0, 0), v_1(0, 1, 0);
+  const double T = 2;
+  const auto A =
+      KinematicMotionPlanner::HermiteCoefficients(p_0, p_1, v_0, v_1, T);
+  const gtsam::Matrix14 U_0(0, 0, 0, 1), U_T(T * T * T, T * T, T, 1);
+  EXPECT(assert_equal(p_0, Vector3((U_0 * A).transpose())));
+  EXPECT(assert_equal(p_1, Vector3((U_T * A).transpose())));
+}
+
+TEST(KinematicMotionPlanner, Trajectories) {
+  using namespace example;
+  const KinematicMotionPlanner planner(robot, Params());
+  EXPECT_LONGS_EQUAL(32, planner.numSteps());
+  const auto wTbs = planner.basePoses();
+  EXPECT_LONGS_EQUAL(32, wTbs.size());
+  EXPECT(assert_equal(robot.link("body")->bMcom().translation(),
+                      wTbs[0].translation(), 1e-9));
+
+  // Three footholds per foot, on the ground, and every foot starts on its
+  // first one and ends on its last one.
+  for (size_t f = 0; f < 4; f++) {
+    const gtsam::Matrix footholds = planner.footholds(f);
+    EXPECT_LONGS_EQUAL(3, footholds.cols());
+    EXPECT_DOUBLES_EQUAL(-0.2, footholds(2, 1), 1e-12);
+    const gtsam::Matrix positions = planner.footPositions(f);
+    EXPECT_LONGS_EQUAL(32, positions.cols());
+    EXPECT(assert_equal(gtsam::Vector(footholds.col(0)),
+                        gtsam::Vector(positions.col(0)), 1e-9));
+  }
+
+  // Foot 1 swings in the second quarter of each support phase.
+  const gtsam::Matrix positions = planner.footPositions(1);
+  EXPECT(positions(2, 6) > -0.2);
+  EXPECT_DOUBLES_EQUAL(-0.2, positions(2, 2), 1e-12);
+
+  THROWS_EXCEPTION(
+      KinematicMotionPlanner(robot, KinematicMotionPlannerParams()));
+}
+
+// The planned steps meet the base and foot goals, in chunks or not.
+TEST(KinematicMotionPlanner, Plan) {
+  using namespace example;
+  auto params = Params();
+  for (size_t chunk_size : {0, 8}) {
+    params.chunk_size = chunk_size;
+    const KinematicMotionPlanner planner(robot, params);
+    const TrajectoryState state = planner.plan();
+    EXPECT_LONGS_EQUAL(planner.numSteps(), state.numSteps());
+    const auto wTbs = planner.basePoses();
+    const Point3 contact = params.contact_in_com;
+    for (size_t k = 0; k < state.numSteps(); k += 5) {
+      EXPECT(assert_equal(wTbs[k], state.pose(robot.link("body")->id(), k),
+                          1e-4));
+      for (size_t f = 0; f < 4; f++) {
+        const int id = robot.link(params.feet[f])->id();
+        EXPECT(assert_equal(Point3(planner.footPositions(f).col(k)),
+                            state.pose(id, k).transformFrom(contact), 1e-3));
+      }
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
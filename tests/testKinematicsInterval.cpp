@@ -73,7 +73,7 @@ TEST(Interval, Interpolate) {
   parameters.method = OptimizationParameters::Method::SOFT_CONSTRAINTS;
   Kinematics kinematics(parameters);
   auto result1 = kinematics.inverse(Slice(5), robot, contact_goals);
-  auto result2 = kinematics.inverse(Slice(9), robot, contact_goals);
+  auto result2 = kinematics.inverse(Slice(9), robot, contact_goals2);
 
   // Create a kinematic trajectory over timesteps 5, 6, 7, 8, 9 that
   // interpolates between goal configurations at timesteps 5 and 9.
@@ -85,6 +85,56 @@ TEST(Interval, Interpolate) {
   EXPECT(assert_equal(Pose(result2, 0, 9), Pose(result, 0, 9)));
 }
 
+TEST(Interval, InterpolateJoints) {
+  using namespace contact_goals_example;
+  auto contact_goals2 = contact_goals;
+  contact_goals2[2] = {{RF, contact_in_com}, {0.4, -0.16, -0.2}};
+  const Interval interval(5, 9);
+
+  for (auto interpolation : {KinematicsParameters::LINEAR_JOINTS,
+                             KinematicsParameters::CUBIC_JOINTS}) {
+    KinematicsParameters parameters;
+    parameters.method = OptimizationParameters::Method::SOFT_CONSTRAINTS;
+    parameters.interpolation = interpolation;
+    parameters.interpolation_tolerance = 1e-2;
+    Kinematics kinematics(parameters);
+    auto result1 = kinematics.inverse(Slice(5), robot, contact_goals);
+    auto result2 = kinematics.inverse(Slice(9), robot, contact_goals2);
+
+    // Inverse kinematics at the ends, and every pose and angle in between.
+    gtsam::Values result = kinematics.interpolate(
+        interval, robot, contact_goals, contact_goals2);
+    EXPECT_LONGS_EQUAL(5 * (robot.numLinks() + robot.numJoints()),
+                       result.size());
+    EXPECT(assert_equal(Pose(result1, 0, 5), Pose(result, 0, 5)));
+    EXPECT(assert_equal(Pose(result2, 0, 9), Pose(result, 0, 9)));
+
+    // The fixed goals hold within the tolerance on all slices.
+    for (size_t k = 6; k < 9; k++) {
+      EXPECT(contact_goals[0].satisfied(result, k, 2e-2));
+      EXPECT(contact_goals[1].satisfied(result, k, 2e-2));
+    }
+  }
+}
+
+// Seeded initial values of an interval, built in parallel, are those of its
+// slices.
+TEST(Interval, SeededInitialValues) {
+  using namespace contact_goals_example;
+  KinematicsParameters parameters;
+  parameters.seed = 11;
+  const Kinematics kinematics(parameters);
+  const Interval interval(0, 7);
+  const gtsam::Values values = kinematics.initialValues(interval, robot, 0.1);
+  for (size_t k = 0; k <= 7; k++) {
+    const gtsam::Values slice = kinematics.initialValues(Slice(k), robot, 0.1);
+    for (auto&& key_value : slice) {
+      EXPECT(values.at(key_value.key).equals(key_value.value, 0));
+    }
+  }
+  EXPECT(!assert_equal(Pose(values, 0, 0), Pose(values, 0, 1), 1e-9));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
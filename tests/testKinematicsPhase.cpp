@@ -36,6 +36,16 @@ TEST(Phase, InverseKinematics) {
 
   Phase phase0(0, num_time_steps, constraint);
   // TODO(frank): test methods producing constraints.
+
+  // Slices are solved independently, as for an interval.
+  Kinematics kinematics;
+  auto result = kinematics.inverse(phase0, robot, contact_goals);
+  constexpr double tol = 1e-3;
+  for (const ContactGoal& goal : contact_goals) {
+    for (size_t k = 0; k <= num_time_steps; k++) {
+      EXPECT(goal.satisfied(result, k, tol));
+    }
+  }
 }
 
 int main() {
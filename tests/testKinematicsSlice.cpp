@@ -81,6 +81,37 @@ TEST(Slice, InverseKinematics) {
   }
 }
 
+// Stacked constraints are one constraint per kind, with the same violations.
+TEST(Slice, StackedConstraints) {
+  using namespace contact_goals_example;
+  const size_t k = 777;
+  const Slice slice(k);
+  KinematicsParameters parameters;
+  parameters.stack_constraints = true;
+  const Kinematics stacked(parameters), separate;
+
+  const auto constraints = stacked.constraints(slice, robot);
+  EXPECT_LONGS_EQUAL(1, constraints.size());
+  EXPECT_LONGS_EQUAL(12 * 6, constraints[0]->dim());
+  const auto goals = stacked.pointGoalConstraints(slice, contact_goals);
+  EXPECT_LONGS_EQUAL(1, goals.size());
+  EXPECT_LONGS_EQUAL(4 * 3, goals[0]->dim());
+
+  const auto values = separate.initialValues(slice, robot, 0.1);
+  const auto expected = separate.constraints(slice, robot);
+  const gtsam::Vector violation = (*constraints[0])(values);
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT(assert_equal((*expected[i])(values),
+                        gtsam::Vector(violation.segment<6>(6 * i))));
+  }
+
+  // Inverse kinematics reaches the goals as well.
+  const auto result = stacked.inverse(slice, robot, contact_goals, true);
+  for (const ContactGoal& goal : contact_goals) {
+    EXPECT(goal.satisfied(result, k, 1e-2));
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLeanDynamicsGraph.cpp
+ * @brief Test the chain-based dynamics graph of a legged robot.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/LeanDynamicsGraph.h>
+#include <gtdynamics/factors/ChainConstraintFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace example {
+const Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const int k = 1;
+}  // namespace example
+
+// The A1 decomposes into four legs of three joints each.
+TEST(LeanDynamicsGraph, Legs) {
+  const LeanDynamicsGraph graph(example::robot, "trunk");
+  EXPECT_LONGS_EQUAL(4, graph.legs().size());
+  for (auto&& leg : graph.legs()) {
+    EXPECT_LONGS_EQUAL(3, leg.joints.size());
+    EXPECT_LONGS_EQUAL(3, leg.chain.length());
+    EXPECT(leg.hip()->otherLink(graph.trunk()) != nullptr);
+    EXPECT_LONGS_EQUAL(1, leg.foot->joints().size());
+  }
+}
+
+// The leg chains agree with forward kinematics of the full robot.
+TEST(LeanDynamicsGraph, footPose) {
+  const LeanDynamicsGraph graph(example::robot, "trunk");
+  Values known_values;
+  int index = 0;
+  for (auto&& joint : example::robot.joints()) {
+    InsertJointAngle(&known_values, joint->id(), example::k,
+                     0.3 * std::sin(index + 1.0));
+    InsertJointVel(&known_values, joint->id(), example::k, 0.0);
+    index++;
+  }
+  const Pose3 wTtrunk(gtsam::Rot3::Rz(0.3), gtsam::Point3(0.1, 0.2, 0.4));
+  InsertPose(&known_values, graph.trunk()->id(), example::k, wTtrunk);
+  InsertTwist(&known_values, graph.trunk()->id(), example::k, gtsam::Z_6x1);
+  const Values fk =
+      example::robot.forwardKinematics(known_values, example::k, "trunk");
+
+  for (auto&& leg : graph.legs()) {
+    EXPECT(assert_equal(Pose(fk, leg.foot->id(), example::k),
+                        leg.footPose(wTtrunk, leg.angles(fk, example::k)),
+                        1e-9));
+  }
+}
+
+// One factor per leg and one for the trunk, an order of magnitude fewer than
+// the full dynamics graph.
+TEST(LeanDynamicsGraph, dynamicsFactorGraph) {
+  const LeanDynamicsGraph lean(example::robot, "trunk", OptimizerSetting(),
+                               example::gravity);
+  const NonlinearFactorGraph graph = lean.dynamicsFactorGraph(example::k);
+  EXPECT_LONGS_EQUAL(5, graph.size());
+  EXPECT_LONGS_EQUAL(3 + 4 + 4 * 3 * 2, graph.keys().size());
+
+  const NonlinearFactorGraph full =
+      DynamicsGraph(example::gravity)
+          .dynamicsFactorGraph(example::robot, example::k);
+  EXPECT(10 * graph.size() < full.size());
+
+  // Legs without contact are held to a zero wrench.
+  const PointOnLinks contact_points{
+      PointOnLink(lean.legs()[0].foot, gtsam::Point3(0, 0, -0.1))};
+  EXPECT_LONGS_EQUAL(
+      8, lean.dynamicsFactorGraph(example::k, contact_points).size());
+}
+
+// At a static pose, the solution of the full dynamics graph satisfies the
+// chain constraints. Without gravity and at rest the legs carry no inertial
+// load, so they are massless as the lean graph assumes. The trunk is fixed,
+// and each foot is pushed by a known wrench.
+TEST(LeanDynamicsGraph, staticPose) {
+  const Robot robot = example::robot.fixLink("trunk");
+  const auto trunk = robot.link("trunk");
+  const LeanDynamicsGraph lean(example::robot, "trunk");
+  const int k = example::k;
+
+  const auto sigma = gtsam::noiseModel::Isotropic::Sigma(1, 1e-4);
+  const auto wrench_sigma = gtsam::noiseModel::Isotropic::Sigma(6, 1e-4);
+  const DynamicsGraph graph_builder(gtsam::Vector3::Zero());
+  LinkWrenchKeys external_wrenches;
+  NonlinearFactorGraph priors;
+  Values known;
+  int index = 0;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    const double q = 0.3 * std::sin(index + 1.0);
+    priors.addPrior<double>(JointAngleKey(j, k), q, sigma);
+    priors.addPrior<double>(JointVelKey(j, k), 0.0, sigma);
+    priors.addPrior<double>(JointAccelKey(j, k), 0.0, sigma);
+    InsertJointAngle(&known, j, k, q);
+    InsertJointVel(&known, j, k, 0.0);
+    index++;
+  }
+  for (auto&& leg : lean.legs()) {
+    const int i = leg.foot->id();
+    const DynamicsSymbol key = ContactWrenchKey(i, 0, k);
+    external_wrenches[i] = {key};
+    gtsam::Vector6 wrench;
+    wrench << 0.1 * i, -0.2, 0.3, 1.0, -2.0, 10.0 + i;
+    priors.addPrior<gtsam::Vector6>(key, wrench, wrench_sigma);
+  }
+  InsertPose(&known, trunk->id(), k, robot.fixedPose(trunk));
+  InsertTwist(&known, trunk->id(), k, gtsam::Z_6x1);
+
+  NonlinearFactorGraph graph = graph_builder.dynamicsFactorGraph(
+      robot, k, boost::none, boost::none, external_wrenches);
+  graph.add(priors);
+
+  // Start from forward kinematics, so only the wrenches remain to be solved.
+  Values initial = robot.forwardKinematics(known, k, "trunk");
+  for (auto&& key_value : Initializer().ZeroValues(robot, k)) {
+    if (!initial.exists(key_value.key)) {
+      initial.insert(key_value.key, key_value.value);
+    }
+  }
+  for (auto&& external : external_wrenches) {
+    initial.insert(external.second[0], gtsam::Vector6::Zero().eval());
+  }
+  const Values result =
+      gtsam::LevenbergMarquardtOptimizer(graph, initial).optimize();
+  EXPECT(graph.error(result) < 1e-6);
+
+  // Each leg pushes on the trunk, and the chain constraints hold.
+  const NonlinearFactorGraph lean_graph = lean.dynamicsFactorGraph(k);
+  for (auto&& leg : lean.legs()) {
+    const auto wrench = Wrench(result, trunk->id(), leg.hip()->id(), k);
+    EXPECT(wrench.norm() > 1.0);
+  }
+  for (size_t f = 0; f < lean.legs().size(); f++) {
+    auto factor = boost::dynamic_pointer_cast<ChainConstraintFactor<3>>(
+        lean_graph.at(f));
+    CHECK(factor);
+    EXPECT(assert_equal(gtsam::Vector3::Zero().eval(),
+                        factor->unwhitenedError(result), 1e-6));
+  }
+}
+
+// A leg that branches is rejected.
+TEST(LeanDynamicsGraph, notSerial) {
+  // Seen from a hip link, the leg through the trunk branches.
+  const auto trunk = example::robot.link("trunk");
+  const auto hip = trunk->joints()[0]->otherLink(trunk);
+  THROWS_EXCEPTION(LeanDynamicsGraph::Legs(example::robot, hip));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
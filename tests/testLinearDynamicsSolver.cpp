@@ -0,0 +1,74 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLinearDynamicsSolver.cpp
+ * @brief Test the cached linear dynamics solver.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/LinearDynamicsSolver.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Ordering keys are shifted to a new time step.
+TEST(LinearDynamicsSolver, OrderingAtTime) {
+  gtsam::Ordering ordering;
+  ordering.push_back(TwistAccelKey(1, 0));
+  ordering.push_back(WrenchKey(1, 2, 0));
+  ordering.push_back(JointAccelKey(2, 0));
+
+  gtsam::Ordering expected;
+  expected.push_back(TwistAccelKey(1, 7));
+  expected.push_back(WrenchKey(1, 2, 7));
+  expected.push_back(JointAccelKey(2, 7));
+  EXPECT(assert_equal(expected,
+                      LinearDynamicsSolver::OrderingAtTime(ordering, 7)));
+}
+
+// Repeated calls at different time steps match DynamicsGraph.
+TEST(LinearDynamicsSolver, simple_urdf) {
+  using simple_urdf::gravity;
+  using simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  DynamicsGraph graph_builder(gravity, planar_axis);
+  LinearDynamicsSolver solver(robot, gravity, planar_axis);
+  const int j = robot.joint("j1")->id();
+
+  for (int t = 0; t < 3; t++) {
+    Values known_values;
+    InsertJointAngle(&known_values, j, t, 0.2 * t);
+    InsertJointVel(&known_values, j, t, 0.5 - t);
+    Values kinematics = robot.forwardKinematics(known_values, t);
+
+    Values fd_values = kinematics;
+    InsertTorque(&fd_values, j, t, 1.0 + t);
+    Values expected_fd = graph_builder.linearSolveFD(robot, t, fd_values);
+    Values actual_fd = solver.solveFD(t, fd_values);
+    EXPECT(assert_equal(JointAccel(expected_fd, j, t),
+                        JointAccel(actual_fd, j, t), 1e-9));
+
+    Values id_values = kinematics;
+    InsertJointAccel(&id_values, j, t, 2.0 - t);
+    Values expected_id = graph_builder.linearSolveID(robot, t, id_values);
+    Values actual_id = solver.solveID(t, id_values);
+    EXPECT(assert_equal(Torque(expected_id, j, t), Torque(actual_id, j, t),
+                        1e-9));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,157 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLinkDynamicsFactor.cpp
+ * @brief Test the fused per-link dynamics factor.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/LinkDynamicsFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/SliceTemplate.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const int t = 2;
+
+// Dynamically consistent values, with perturbed joint angles.
+Values values() {
+  Values known_values;
+  int index = 0;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&known_values, j, t, 0.2 * std::sin(index + 1.0));
+    InsertJointVel(&known_values, j, t, 0.7 * std::cos(2.0 * index));
+    InsertTorque(&known_values, j, t, 0.5 * std::sin(3.0 * index));
+    index++;
+  }
+  auto root = robot.link("trunk");
+  InsertPose(&known_values, root->id(), t, root->bMcom());
+  InsertTwist(&known_values, root->id(), t, gtsam::Z_6x1);
+  Values fk_values = robot.forwardKinematics(known_values, t, root->name());
+  Values result = DynamicsGraph(gravity).linearSolveFD(robot, t, fk_values);
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    result.update(JointAngleKey(j, t), JointAngle(result, j, t) + 0.1);
+  }
+  return result;
+}
+}  // namespace example
+
+// The fused graph has one core factor per link and the same error.
+TEST(LinkDynamicsFactor, Graph) {
+  using example::robot;
+  using example::t;
+  OptimizerSetting opt;
+  opt.fused_link_factors = true;
+  DynamicsGraph graph_builder(example::gravity);
+  DynamicsGraph fused_builder(opt, example::gravity);
+
+  NonlinearFactorGraph expected = graph_builder.dynamicsFactorGraph(robot, t);
+  NonlinearFactorGraph actual = fused_builder.dynamicsFactorGraph(robot, t);
+
+  // 3 joint factors per joint and one wrench factor per link become one per
+  // link, a1 has no fixed link.
+  const size_t num_links = robot.numLinks(), num_joints = robot.numJoints();
+  EXPECT_LONGS_EQUAL(expected.size() - 3 * num_joints, actual.size());
+  size_t num_fused = 0;
+  for (auto&& factor : actual) {
+    if (boost::dynamic_pointer_cast<LinkDynamicsFactor>(factor)) num_fused++;
+  }
+  EXPECT_LONGS_EQUAL(num_links, num_fused);
+  EXPECT(expected.keys() == actual.keys());
+
+  const Values values = example::values();
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+
+  // Both graphs have the same Hessian.
+  const gtsam::KeySet keys = expected.keys();
+  const gtsam::Ordering ordering(keys.begin(), keys.end());
+  auto expected_hessian = expected.linearize(values)->hessian(ordering);
+  auto actual_hessian = actual.linearize(values)->hessian(ordering);
+  EXPECT(assert_equal(expected_hessian.first, actual_hessian.first, 1e-9));
+  EXPECT(assert_equal(expected_hessian.second, actual_hessian.second, 1e-9));
+}
+
+// Check the stacked Jacobians of each fused factor numerically.
+TEST(LinkDynamicsFactor, Jacobians) {
+  OptimizerSetting opt;
+  opt.fused_link_factors = true;
+  DynamicsGraph fused_builder(opt, example::gravity);
+  const Values values = example::values();
+  for (auto&& factor :
+       fused_builder.dynamicsFactorGraph(example::robot, example::t)) {
+    auto fused = boost::dynamic_pointer_cast<LinkDynamicsFactor>(factor);
+    if (!fused) continue;
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*fused, values, 1e-7, 1e-3);
+  }
+}
+
+// Fused factors can still be stamped out by rekeying. The joint factors of
+// the slice are expression factors, so the slice itself is rebuilt.
+TEST(LinkDynamicsFactor, SliceTemplate) {
+  OptimizerSetting opt;
+  opt.fused_link_factors = true;
+  DynamicsGraph fused_builder(opt, example::gravity);
+  auto builder = [&](int k) {
+    return fused_builder.dynamicsFactorGraph(example::robot, k);
+  };
+  SliceTemplate slice(builder);
+  EXPECT(!slice.shiftable());
+
+  const NonlinearFactorGraph slice0 = builder(0);
+  const NonlinearFactorGraph expected = builder(example::t);
+  const Values values = example::values();
+  size_t num_fused = 0;
+  for (size_t f = 0; f < slice0.size(); f++) {
+    if (!boost::dynamic_pointer_cast<LinkDynamicsFactor>(slice0.at(f))) {
+      continue;
+    }
+    EXPECT(IsTimeShiftable(slice0.at(f)));
+    const auto actual = ShiftTime(slice0.at(f), example::t);
+    EXPECT(expected.at(f)->keys() == actual->keys());
+    EXPECT_DOUBLES_EQUAL(expected.at(f)->error(values), actual->error(values),
+                         1e-9);
+    num_fused++;
+  }
+  EXPECT_LONGS_EQUAL(example::robot.numLinks(), num_fused);
+
+  const NonlinearFactorGraph actual = slice.at(example::t);
+  EXPECT(expected.keys() == actual.keys());
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+}
+
+// Constrained components are rejected.
+TEST(LinkDynamicsFactor, Constrained) {
+  auto joint = example::robot.joints().front();
+  auto constrained = gtsam::noiseModel::Constrained::All(6);
+  std::vector<gtsam::NoiseModelFactor::shared_ptr> factors{
+      boost::make_shared<AnalyticPoseFactor>(constrained, joint, 0)};
+  THROWS_EXCEPTION(LinkDynamicsFactor factor(factors));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
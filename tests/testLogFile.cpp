@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLogFile.cpp
+ * @brief Test memory-mapped log files and the factor builders using them.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/LogFile.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <fstream>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace {
+const size_t kRows = 4;
+const Pose3 kPose(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                  gtsam::Point3(1, 2, 3));
+
+// Joint angles, torques, a pose and a twist channel.
+std::vector<LogChannel> Channels() {
+  std::vector<LogChannel> channels;
+  for (int j = 0; j < 2; j++) {
+    channels.push_back({JointAngleKey(j), Matrix(kRows, 1)});
+    channels.push_back({TorqueKey(j), Matrix(kRows, 1)});
+    channels.push_back({JointVelKey(j), Matrix::Zero(kRows, 1)});
+    for (size_t r = 0; r < kRows; r++) {
+      channels[3 * j].samples(r, 0) = 0.1 * r + j;
+      channels[3 * j + 1].samples(r, 0) = -1.0 * r;
+    }
+  }
+  LogChannel pose{PoseKey(1), Matrix(kRows, 12)};
+  LogChannel twist{TwistKey(1), Matrix(kRows, 6)};
+  for (size_t r = 0; r < kRows; r++) {
+    pose.samples.row(r) = LogSample(kPose.retract(Vector::Constant(6, 0.1 * r)))
+                              .transpose();
+    twist.samples.row(r) = Vector::Constant(6, r).transpose();
+  }
+  channels.push_back(pose);
+  channels.push_back(twist);
+  return channels;
+}
+}  // namespace
+
+// Channels are read in place, and inserted into Values by type.
+TEST(LogFile, roundtrip) {
+  const Vector times = Vector::LinSpaced(kRows, 0.0, 0.3);
+  const std::vector<LogChannel> channels = Channels();
+  WriteLogFile("testLogFile.log", times, channels);
+
+  const LogFile log("testLogFile.log");
+  EXPECT_LONGS_EQUAL(kRows, log.numRows());
+  EXPECT_LONGS_EQUAL(channels.size(), log.numChannels());
+  EXPECT(assert_equal(times, Vector(log.times())));
+  EXPECT_LONGS_EQUAL(12, log.channelWidth(log.findChannel(PoseKey(1))));
+  EXPECT(assert_equal(channels[0].samples,
+                      Matrix(log.channel(log.findChannel(JointAngleKey(0))))));
+  EXPECT(assert_equal(Vector(channels[3].samples.col(0)),
+                      Vector(log.scalars(JointAngleKey(1)))));
+  EXPECT(!log.hasChannel(JointAngleKey(2)));
+  THROWS_EXCEPTION(log.findChannel(JointAngleKey(2)));
+  THROWS_EXCEPTION(log.scalars(PoseKey(1)));
+
+  const size_t pose_channel = log.findChannel(PoseKey(1));
+  EXPECT(assert_equal(kPose.retract(Vector::Constant(6, 0.2)),
+                      log.pose(pose_channel, 2), 1e-9));
+  EXPECT(log.key(pose_channel, 2, 10) == PoseKey(1, 12));
+
+  // Rows 1 and 2 at time steps 6 and 7.
+  gtsam::Values values;
+  log.insertInto(&values, 1, 3, 5);
+  EXPECT_LONGS_EQUAL(2 * channels.size(), values.size());
+  EXPECT_DOUBLES_EQUAL(1.2, JointAngle(values, 1, 7), 1e-12);
+  EXPECT(assert_equal(gtsam::Vector6(gtsam::Vector6::Constant(1)),
+                      Twist(values, 1, 6)));
+  EXPECT(assert_equal(log.pose(pose_channel, 2), Pose(values, 1, 7)));
+  THROWS_EXCEPTION(log.insertInto(&values, 2, kRows + 1));
+
+  // Invalid files.
+  std::ofstream("testLogFile.bad") << "not a log file, but long enough";
+  THROWS_EXCEPTION(LogFile("testLogFile.bad"));
+  THROWS_EXCEPTION(LogFile("testLogFile.missing"));
+  THROWS_EXCEPTION(WriteLogFile("testLogFile.log", Vector::Zero(2), channels));
+  THROWS_EXCEPTION(WriteLogFile(
+      "testLogFile.log", times, {{JointAngleKey(0, 1), Matrix(kRows, 1)}}));
+}
+
+// Factor builders consume channels in bulk.
+TEST(LogFile, factors) {
+  WriteLogFile("testLogFile.log", Vector::LinSpaced(kRows, 0.0, 0.3),
+               Channels());
+  const LogFile log("testLogFile.log");
+  const gtsam::Values values = log.values();
+
+  const auto pose_model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+  const auto priors = LogPriorFactors(log, log.findChannel(PoseKey(1)),
+                                      pose_model, 1, kRows);
+  EXPECT_LONGS_EQUAL(kRows - 1, priors.size());
+  EXPECT_DOUBLES_EQUAL(0, priors.error(values), 1e-12);
+  EXPECT_DOUBLES_EQUAL(
+      0,
+      LogPriorFactors(log, log.findChannel(TwistKey(1)), pose_model, 0, kRows)
+          .error(values),
+      1e-12);
+
+  const Robot robot = simple_rr::getRobot();
+  const auto measurements = LogJointMeasurementFactors(
+      robot, log, pose_model, 0, kRows);
+  EXPECT_LONGS_EQUAL(robot.numJoints() * kRows, measurements.size());
+
+  // Known values of finite-difference priors, straight from the log.
+  const auto fd_priors = DynamicsGraph(gtsam::Vector3(0, 0, -9.8))
+                             .trajectoryFDPriors(robot, kRows - 1, values);
+  EXPECT_LONGS_EQUAL(robot.numJoints() * (2 + kRows), fd_priors.size());
+  EXPECT_DOUBLES_EQUAL(0, fd_priors.error(values), 1e-12);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLqrGains.cpp
+ * @brief Test LQR gains from linearized trajectory graphs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/LqrGains.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::GaussianFactorGraph;
+using gtsam::I_1x1;
+using gtsam::KeyVector;
+using gtsam::Symbol;
+using gtsam::Vector1;
+
+namespace example {
+const double a = 1.1, b = 0.5, q = 1.0, r = 0.1;
+const size_t N = 5;
+const auto constrained = gtsam::noiseModel::Constrained::All(1);
+
+// Scalar system x_{t+1} = a x_t + w_t, w_t = b u_t, with costs q x^2 around
+// x_ref and r u^2, and a prior on x_0.
+GaussianFactorGraph Graph(double x_ref) {
+  GaussianFactorGraph graph;
+  for (size_t t = 0; t < N; t++) {
+    const Symbol x('x', t), u('u', t), w('w', t);
+    graph.add(x, std::sqrt(q) * I_1x1, Vector1(std::sqrt(q) * x_ref));
+    if (t + 1 == N) break;
+    graph.add(u, std::sqrt(r) * I_1x1, Vector1::Zero());
+    graph.add(w, I_1x1, u, -b * I_1x1, Vector1::Zero(), constrained);
+    graph.add(Symbol('x', t + 1), I_1x1, x, -a * I_1x1, w, -I_1x1,
+              Vector1::Zero(), constrained);
+  }
+  graph.add(Symbol('x', 0), I_1x1, Vector1(1.0), constrained);
+  return graph;
+}
+
+std::vector<KeyVector> Keys(char c, size_t n) {
+  std::vector<KeyVector> keys;
+  for (size_t t = 0; t < n; t++) keys.push_back({Symbol(c, t)});
+  return keys;
+}
+}  // namespace example
+
+// The gains are those of the Riccati recursion.
+TEST(LqrGains, Riccati) {
+  using namespace example;
+  const auto gains =
+      EliminateLqrGains(Graph(0), Keys('x', N), Keys('u', N - 1));
+  EXPECT_LONGS_EQUAL(N - 1, gains.numSteps());
+  EXPECT_LONGS_EQUAL(1, gains.state_dim);
+  EXPECT_LONGS_EQUAL(1, gains.control_dim);
+
+  double P = q;
+  for (size_t t = N - 1; t-- > 0;) {
+    const double K = -b * P * a / (r + b * b * P);
+    EXPECT_DOUBLES_EQUAL(K, gains.gain(t)(0, 0), 1e-9);
+    EXPECT_DOUBLES_EQUAL(0, gains.feedForward(t)(0), 1e-9);
+    P = q + a * a * P - (a * b * P) * (a * b * P) / (r + b * b * P);
+  }
+}
+
+// The controls of the solution follow the gains and feed-forward terms.
+TEST(LqrGains, FeedForward) {
+  using namespace example;
+  const GaussianFactorGraph graph = Graph(0.3);
+  const auto gains = EliminateLqrGains(graph, Keys('x', N), Keys('u', N - 1));
+  const gtsam::VectorValues solution = graph.optimize();
+  for (size_t t = 0; t + 1 < N; t++) {
+    EXPECT(gtsam::assert_equal(solution.at(Symbol('u', t)),
+                               gains.control(t, solution.at(Symbol('x', t))),
+                               1e-9));
+  }
+  EXPECT(gains.feedForward(0)(0) != 0);
+
+  // The ordering eliminates the intermediate keys first.
+  const gtsam::Ordering ordering =
+      LqrOrdering(graph, Keys('x', N), Keys('u', N - 1));
+  EXPECT_LONGS_EQUAL(3 * N - 2, ordering.size());
+  EXPECT(ordering.front() == Symbol('w', 0));
+  EXPECT(ordering.back() == Symbol('x', 0));
+
+  THROWS_EXCEPTION(EliminateLqrGains(graph, Keys('x', N), Keys('u', 2)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMemoryFootprint.cpp
+ * @brief Test memory accounting of graphs and values.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/MemoryFootprint.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+
+#include <sstream>
+#include <string>
+
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::noiseModel::Isotropic;
+
+using namespace gtdynamics;
+
+TEST(MemoryFootprint, graph) {
+  const auto shared_model = Isotropic::Sigma(1, 0.1);
+  gtsam::NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, shared_model);
+  graph.addPrior<double>(JointAngleKey(1, 0), 0.0, shared_model);
+  const gtsam::Double_ q0(JointAngleKey(0, 0)), q1(JointAngleKey(1, 0));
+  graph.emplace_shared<gtsam::ExpressionFactor<double>>(
+      Isotropic::Sigma(1, 0.2), 0.0, q0 - q1);
+
+  const MemoryFootprint footprint = GraphMemoryFootprint(graph);
+  EXPECT_LONGS_EQUAL(2, footprint.factors.size());
+  EXPECT_LONGS_EQUAL(
+      2, footprint.factors.at("gtsam::PriorFactor<double>").count);
+  const std::string expression_type = "gtsam::ExpressionFactor<double>";
+  EXPECT_LONGS_EQUAL(1, footprint.factors.at(expression_type).count);
+
+  // Both priors share one noise model.
+  size_t num_noise_models = 0;
+  for (auto &&type_usage : footprint.noise_models) {
+    num_noise_models += type_usage.second.count;
+  }
+  EXPECT_LONGS_EQUAL(2, num_noise_models);
+
+  // The difference of the leaves has at least three nodes.
+  EXPECT_LONGS_EQUAL(1, footprint.expression_nodes.size());
+  EXPECT(footprint.expression_nodes.at(expression_type).count >= 3);
+  EXPECT(footprint.trace_bytes.at(expression_type) > 0);
+  EXPECT(footprint.values.empty());
+}
+
+TEST(MemoryFootprint, values) {
+  Values values;
+  InsertJointAngle(&values, 0, 0, 0.1);
+  InsertJointAngle(&values, 1, 0, 0.2);
+  InsertPose(&values, 0, 0, Pose3());
+  InsertTwist(&values, 0, 0, gtsam::Vector6::Zero());
+
+  const MemoryFootprint footprint = ValuesMemoryFootprint(values);
+  EXPECT_LONGS_EQUAL(3, footprint.values.size());
+  EXPECT_LONGS_EQUAL(4, footprint.total().count);
+  const auto &doubles = footprint.values.at("gtsam::GenericValue<double>");
+  const auto &poses =
+      footprint.values.at("gtsam::GenericValue<gtsam::Pose3>");
+  EXPECT_LONGS_EQUAL(2, doubles.count);
+  EXPECT_LONGS_EQUAL(1, poses.count);
+  EXPECT(poses.bytes > doubles.bytes / 2);
+}
+
+TEST(MemoryFootprint, total) {
+  gtsam::NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, Isotropic::Sigma(1, 0.1));
+  Values values;
+  InsertJointAngle(&values, 0, 0, 0.1);
+
+  const MemoryFootprint footprint = MemoryFootprintOf(graph, values);
+  EXPECT_LONGS_EQUAL(3, footprint.total().count);
+  EXPECT_LONGS_EQUAL(GraphMemoryFootprint(graph).total().bytes +
+                         ValuesMemoryFootprint(values).total().bytes,
+                     footprint.total().bytes);
+
+  std::stringstream json;
+  footprint.writeJson(json);
+  EXPECT(json.str().find("\"factors\": {\"gtsam::PriorFactor<double>\": "
+                         "{\"count\": 1, \"bytes\": ") == 0);
+  EXPECT(json.str().find("\"total\": {\"count\": 3, ") != std::string::npos);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
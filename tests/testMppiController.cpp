@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMppiController.cpp
+ * @brief Test the sampling-based controller on a single joint.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/MppiController.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace {
+// Track a joint angle of 0.5 with a small final velocity.
+double TrackingCost(const Eigen::Map<const Matrix> &qs,
+                    const Eigen::Map<const Matrix> &vs,
+                    const Eigen::Map<const Matrix> &) {
+  const double final_v = vs(0, vs.cols() - 1);
+  return (qs.array() - 0.5).square().sum() + final_v * final_v;
+}
+
+MppiParams Params() {
+  MppiParams params;
+  params.num_samples = 64;
+  params.horizon = 10;
+  params.dt = 0.05;
+  params.lambda = 0.1;
+  params.sigmas = Vector::Constant(1, 0.5);
+  params.lower = Vector::Constant(1, -2.0);
+  params.upper = Vector::Constant(1, 2.0);
+  return params;
+}
+}  // namespace
+
+// Iterating from rest lowers the cost of the nominal torques.
+TEST(MppiController, update) {
+  auto robot = simple_urdf::getRobot();
+  const BatchSimulator simulator(robot, simple_urdf::gravity);
+  MppiController controller(simulator, Params(), TrackingCost);
+  const Vector q = Vector::Zero(1), v = Vector::Zero(1);
+
+  controller.update(q, v);
+  const double initial_cost = controller.costs()(0);
+  EXPECT_DOUBLES_EQUAL(1.0, controller.weights().sum(), 1e-9);
+  EXPECT_LONGS_EQUAL(64, controller.rollouts().numRollouts());
+
+  // Buffers are re-used across iterations.
+  const double *rollout_data = controller.rollouts().qs.data();
+  for (size_t i = 0; i < 20; i++) controller.update(q, v);
+  EXPECT(rollout_data == controller.rollouts().qs.data());
+  EXPECT(controller.costs()(0) < initial_cost);
+
+  // Sampled and nominal torques stay within the limits.
+  EXPECT(controller.sampledTorques().cwiseAbs().maxCoeff() <= 2.0);
+  EXPECT(controller.nominalTorques().cwiseAbs().maxCoeff() <= 2.0);
+}
+
+// A control cycle returns the first updated torques and shifts the rest.
+TEST(MppiController, control) {
+  auto robot = simple_urdf::getRobot();
+  const BatchSimulator simulator(robot, simple_urdf::gravity);
+  const MppiParams params = Params();
+  const size_t K = params.horizon;
+  Matrix nominal(1, K);
+  for (size_t k = 0; k < K; k++) nominal(0, k) = 0.1 * k;
+  const Vector q = Vector::Constant(1, 0.2), v = Vector::Zero(1);
+
+  // Both controllers draw the same samples from the same seed.
+  MppiController expected(simulator, params, TrackingCost, nominal);
+  expected.update(q, v);
+  const Matrix updated = expected.nominalTorques();
+
+  MppiController controller(simulator, params, TrackingCost, nominal);
+  const Vector command = controller.control(q, v);
+  EXPECT(gtsam::assert_equal(Vector(updated.col(0)), command));
+  EXPECT(gtsam::assert_equal(
+      Matrix(updated.rightCols(K - 1)),
+      Matrix(controller.nominalTorques().leftCols(K - 1))));
+  EXPECT_DOUBLES_EQUAL(updated(0, K - 1), controller.nominalTorques()(0, K - 1),
+                       1e-12);
+}
+
+// Inconsistent parameters are rejected.
+TEST(MppiController, params) {
+  auto robot = simple_urdf::getRobot();
+  const BatchSimulator simulator(robot, simple_urdf::gravity);
+  MppiParams params = Params();
+  params.sigmas = Vector::Ones(2);
+  THROWS_EXCEPTION(MppiController(simulator, params, TrackingCost));
+  params = Params();
+  params.lambda = 0;
+  THROWS_EXCEPTION(MppiController(simulator, params, TrackingCost));
+  THROWS_EXCEPTION(MppiController(simulator, Params(), nullptr));
+  THROWS_EXCEPTION(
+      MppiController(simulator, Params(), TrackingCost, Matrix::Zero(1, 3)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
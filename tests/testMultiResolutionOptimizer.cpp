@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultiResolutionOptimizer.cpp
+ * @brief Test resampling and coarse-to-fine solving of trajectories.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/MultiResolutionOptimizer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using std::vector;
+
+namespace {
+// Two phases, of 2 and 3 time steps.
+Trajectory TwoPhases() {
+  return Trajectory(walk_cycle_example::walk_cycle, 1);
+}
+
+// Times of the steps of a trajectory, for the given time step per phase.
+vector<double> Times(const Trajectory &trajectory, const vector<double> &dts) {
+  vector<double> times = {0.0};
+  for (size_t p = 0; p < trajectory.numPhases(); p++) {
+    for (int k = 0; k < trajectory.phase(p).numTimeSteps(); k++) {
+      times.push_back(times.back() + dts[p]);
+    }
+  }
+  return times;
+}
+}  // namespace
+
+TEST(Trajectory, withPhaseDurations) {
+  const Trajectory trajectory = TwoPhases().withPhaseDurations({4, 6});
+  EXPECT_LONGS_EQUAL(2, trajectory.numPhases());
+  EXPECT_LONGS_EQUAL(4, trajectory.getEndTimeStep(0));
+  EXPECT_LONGS_EQUAL(10, trajectory.getEndTimeStep(1));
+  EXPECT_LONGS_EQUAL(5, trajectory.getStartTimeStep(1));
+  EXPECT_LONGS_EQUAL(1, trajectory.phaseIndex(5));
+  THROWS_EXCEPTION(TwoPhases().withPhaseDurations({4}));
+  THROWS_EXCEPTION(TwoPhases().withPhaseDurations({4, 0}));
+}
+
+// A cubic joint angle is resampled exactly, with its derivatives.
+TEST(MultiResolutionOptimizer, ResampleTrajectory) {
+  const Trajectory coarse = TwoPhases();
+  const Trajectory fine = coarse.withPhaseDurations({4, 6});
+  const int j = 0;
+
+  Values values;
+  const vector<double> times = Times(coarse, {0.1, 0.1});
+  for (size_t k = 0; k < times.size(); k++) {
+    const double t = times[k];
+    InsertJointAngle(&values, j, k, t * t * t);
+    InsertJointVel(&values, j, k, 3 * t * t);
+    InsertJointAccel(&values, j, k, 6 * t);
+  }
+  values.insert(PhaseKey(0), 0.1);
+  values.insert(PhaseKey(1), 0.1);
+
+  const Values resampled = ResampleTrajectory(coarse, values, fine);
+  EXPECT_LONGS_EQUAL(3 * 11 + 2, resampled.size());
+  EXPECT_DOUBLES_EQUAL(0.05, resampled.at<double>(PhaseKey(0)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.05, resampled.at<double>(PhaseKey(1)), 1e-12);
+  const vector<double> fine_times = Times(fine, {0.05, 0.05});
+  for (size_t k = 0; k < fine_times.size(); k++) {
+    const double t = fine_times[k];
+    EXPECT_DOUBLES_EQUAL(t * t * t, JointAngle(resampled, j, k), 1e-12);
+    EXPECT_DOUBLES_EQUAL(3 * t * t, JointVel(resampled, j, k), 1e-12);
+    EXPECT_DOUBLES_EQUAL(6 * t, JointAccel(resampled, j, k), 1e-12);
+  }
+}
+
+// Joint angles tracking a sine are solved through all levels.
+TEST(MultiResolutionOptimizer, optimize) {
+  const double dt = 0.1;
+  const MultiResolutionOptimizer optimizer_levels(TwoPhases(), dt);
+  EXPECT_LONGS_EQUAL(3, optimizer_levels.numLevels());
+  EXPECT_LONGS_EQUAL(2, optimizer_levels.trajectory(0).getEndTimeStep(1));
+  EXPECT_LONGS_EQUAL(3, optimizer_levels.trajectory(1).getEndTimeStep(1));
+  EXPECT_DOUBLES_EQUAL(0.2, optimizer_levels.phaseDts(0)[0], 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.3, optimizer_levels.phaseDts(0)[1], 1e-12);
+  EXPECT_DOUBLES_EQUAL(dt, optimizer_levels.phaseDts(2)[1], 1e-12);
+
+  auto build = [](const Trajectory &trajectory,
+                  const vector<double> &dts) -> NonlinearFactorGraph {
+    NonlinearFactorGraph graph;
+    const auto model = gtsam::noiseModel::Unit::Create(1);
+    const vector<double> times = Times(trajectory, dts);
+    for (size_t k = 0; k < times.size(); k++) {
+      graph.addPrior<double>(JointAngleKey(0, k), std::sin(times[k]), model);
+    }
+    trajectory.addIntegrationTimeFactors(&graph, dts, 1e-3);
+    return graph;
+  };
+  auto initialize = [](const Trajectory &trajectory,
+                       const vector<double> &dts) -> Values {
+    Values values;
+    for (size_t k = 0; k < Times(trajectory, dts).size(); k++) {
+      InsertJointAngle(&values, 0, k, 0.0);
+    }
+    for (size_t p = 0; p < dts.size(); p++) values.insert(PhaseKey(p), 1.0);
+    return values;
+  };
+
+  MultiResolutionOptimizer optimizer(TwoPhases(), dt);
+  const Values solution = optimizer.optimize(build, initialize);
+  EXPECT_LONGS_EQUAL(3, optimizer.levels().size());
+  EXPECT_LONGS_EQUAL(5, optimizer.levels().back().num_time_steps);
+  EXPECT_LONGS_EQUAL(6 + 2, solution.size());
+  for (int k = 0; k <= 5; k++) {
+    EXPECT_DOUBLES_EQUAL(std::sin(k * dt), JointAngle(solution, 0, k), 1e-6);
+  }
+  EXPECT_DOUBLES_EQUAL(dt, solution.at<double>(PhaseKey(1)), 1e-6);
+  EXPECT(optimizer.levels().back().error < 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultiRobotScene.cpp
+ * @brief Test dynamics graphs of several robots in contact.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/MultiRobotScene.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <algorithm>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace example {
+// A fixed base arm.
+Robot Arm() { return simple_rr::getRobot().fixLink("link_0"); }
+
+// A box without joints.
+Robot Payload() {
+  auto box = boost::make_shared<Link>(0, "box", 1.0, gtsam::I_3x3, Pose3(),
+                                      Pose3());
+  return Robot({{"box", box}}, {});
+}
+
+int MaxLinkId(const Robot &robot) {
+  int id = 0;
+  for (auto &&link : robot.links()) id = std::max(id, int(link->id()));
+  return id;
+}
+}  // namespace example
+
+using namespace example;
+
+// Robots get disjoint ids, and are found by name.
+TEST(MultiRobotScene, addRobot) {
+  MultiRobotScene scene;
+  EXPECT_LONGS_EQUAL(0, scene.addRobot("left", Arm()));
+  EXPECT_LONGS_EQUAL(1, scene.addRobot("right", Arm()));
+  EXPECT_LONGS_EQUAL(2, scene.addRobot("box", Payload()));
+  THROWS_EXCEPTION(scene.addRobot("left", Arm()));
+
+  EXPECT_LONGS_EQUAL(0, scene.linkOffset(0));
+  EXPECT_LONGS_EQUAL(MaxLinkId(Arm()) + 1, scene.linkOffset(1));
+  EXPECT_LONGS_EQUAL(1, scene.robotIndex("right"));
+  const Robot &right = scene.robot("right");
+  EXPECT_LONGS_EQUAL(scene.linkOffset(1) + Arm().link("link_1")->id(),
+                     right.link("link_1")->id());
+  EXPECT(right.isFixed(right.link("link_0")));
+
+  // Keys belong to the robot of their link or joint.
+  const int l = scene.robot("box").link("box")->id();
+  const int j = right.joint("joint_1")->id();
+  EXPECT_LONGS_EQUAL(2, *scene.robotOfKey(PoseKey(l, 3)));
+  EXPECT_LONGS_EQUAL(1, *scene.robotOfKey(JointAngleKey(j, 3)));
+  EXPECT(!scene.robotOfKey(TimeKey(3)));
+}
+
+// Without contacts, each robot is a component of its own; holding the box
+// joins them, and the partition by robot keeps all factors.
+TEST(MultiRobotScene, contacts) {
+  MultiRobotScene scene;
+  scene.addRobot("left", Arm());
+  scene.addRobot("right", Arm());
+  scene.addRobot("box", Payload());
+  const auto separate = ConnectedComponents(scene.dynamicsFactorGraph(0));
+  EXPECT_LONGS_EQUAL(3, separate.size());
+
+  EXPECT_LONGS_EQUAL(0, scene.addPointContact("left", "link_2",
+                                              Point3(0, 0, 0.5), "box", "box",
+                                              Point3(-0.1, 0, 0)));
+  EXPECT_LONGS_EQUAL(1, scene.addRigidContact("right", "link_2",
+                                              Pose3(), "box", "box",
+                                              Pose3(gtsam::Rot3(),
+                                                    Point3(0.1, 0, 0))));
+  THROWS_EXCEPTION(scene.addPointContact("left", "link_2", Point3(), "left",
+                                         "link_1", Point3()));
+
+  const gtsam::NonlinearFactorGraph graph = scene.dynamicsFactorGraph(0);
+  const auto keys = scene.contactWrenchKeys(1, 0);
+  EXPECT(graph.keys().exists(keys.first));
+  EXPECT(graph.keys().exists(keys.second));
+  EXPECT_LONGS_EQUAL(1, ConnectedComponents(graph).size());
+
+  const auto partitions = scene.partition(graph);
+  EXPECT_LONGS_EQUAL(3, partitions.size());
+  size_t num_factors = 0;
+  for (auto &&partition : partitions) num_factors += partition.size();
+  EXPECT_LONGS_EQUAL(graph.size(), num_factors);
+  EXPECT(partitions[2].size() > 0);
+
+  // Trajectories have the contacts at each step.
+  const auto trajectory = scene.trajectoryFG(2, 0.1);
+  EXPECT(trajectory.keys().exists(scene.contactWrenchKeys(0, 2).second));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultipleShooting.cpp
+ * @brief Test multiple-shooting trajectory optimization.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/JointSpaceSimulator.h>
+#include <gtdynamics/dynamics/MultipleShooting.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Values;
+
+namespace {
+const double kDt = 0.05;
+const size_t kSegments = 3, kSteps = 4;
+
+Values InitialState() {
+  Values values;
+  InsertJointAngle(&values, 0, 0.1);
+  InsertJointVel(&values, 0, -0.2);
+  return values;
+}
+
+MultipleShooting Shooting(const Robot &robot) {
+  return MultipleShooting(robot, kSegments, kSteps, kDt, simple_urdf::gravity,
+                          simple_urdf::planar_axis);
+}
+}  // namespace
+
+// Forward-difference sensitivities match numerical derivatives.
+TEST(ShootingFactor, jacobians) {
+  const Robot robot = simple_urdf::getRobot();
+  const ShootingFactor factor(gtsam::noiseModel::Unit::Create(2), robot, 4,
+                              kSteps, kDt, simple_urdf::gravity,
+                              simple_urdf::planar_axis);
+  EXPECT_LONGS_EQUAL(2 + kSteps + 2, factor.size());
+
+  Values values;
+  InsertJointAngle(&values, 0, 4, 0.3);
+  InsertJointVel(&values, 0, 4, 0.5);
+  for (size_t k = 0; k < kSteps; k++) InsertTorque(&values, 0, 4 + k, 1.0 * k);
+  InsertJointAngle(&values, 0, 8, 0.2);
+  InsertJointVel(&values, 0, 8, -0.1);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-6, 1e-4);
+}
+
+// A simulated start satisfies all shooting factors, and rolls out the
+// same trajectory as a single simulation.
+TEST(MultipleShooting, initialValues) {
+  const Robot robot = simple_urdf::getRobot();
+  const MultipleShooting shooting = Shooting(robot);
+  EXPECT_LONGS_EQUAL(kSegments * kSteps, shooting.numSteps());
+  EXPECT_LONGS_EQUAL(kSegments + 1, shooting.boundaries().size());
+
+  const Matrix torques = Matrix::Constant(1, shooting.numSteps(), 0.5);
+  const Values values = shooting.initialValues(InitialState(), torques);
+  const gtsam::NonlinearFactorGraph graph = shooting.shootingFactors();
+  EXPECT_LONGS_EQUAL(kSegments, graph.size());
+  EXPECT_DOUBLES_EQUAL(0, graph.error(values), 1e-12);
+
+  JointSpaceSimulator simulator(robot, InitialState(), shooting.numSteps(),
+                                simple_urdf::gravity,
+                                simple_urdf::planar_axis);
+  simulator.simulate(torques, kDt);
+  const TrajectoryState trajectory = shooting.rollout(values);
+  EXPECT(assert_equal(simulator.jointAngles(), trajectory.jointAngles(),
+                      1e-9));
+  EXPECT(assert_equal(simulator.jointVels(), trajectory.jointVels(), 1e-9));
+}
+
+// Optimizing the boundary states and torques reaches a goal.
+TEST(MultipleShooting, optimize) {
+  const Robot robot = simple_urdf::getRobot();
+  const MultipleShooting shooting = Shooting(robot);
+  const int T = shooting.numSteps();
+
+  gtsam::NonlinearFactorGraph graph = shooting.shootingFactors();
+  const auto tight = gtsam::noiseModel::Isotropic::Sigma(1, 1e-4);
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.1, tight);
+  graph.addPrior<double>(JointVelKey(0, 0), -0.2, tight);
+  graph.addPrior<double>(JointAngleKey(0, T), 0.5, tight);
+  graph.addPrior<double>(JointVelKey(0, T), 0.0, tight);
+  for (int k = 0; k < T; k++) {
+    graph.addPrior<double>(TorqueKey(0, k), 0.0,
+                           gtsam::noiseModel::Isotropic::Sigma(1, 10));
+  }
+
+  const Values initial = shooting.initialValues(
+      InitialState(), Matrix::Zero(1, shooting.numSteps()));
+  const Values result =
+      gtsam::LevenbergMarquardtOptimizer(graph, initial).optimize();
+  EXPECT(shooting.shootingFactors().error(result) < 1e-3);
+
+  const TrajectoryState trajectory = shooting.rollout(result);
+  EXPECT_DOUBLES_EQUAL(0.5, trajectory.jointAngle(0, T), 1e-3);
+  EXPECT_DOUBLES_EQUAL(0.0, trajectory.jointVel(0, T), 1e-3);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNoiseModelCache.cpp
+ * @brief Test interned noise models.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/OptimizerSetting.h>
+#include <gtdynamics/utils/NoiseModelCache.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using gtsam::assert_equal;
+
+using namespace gtdynamics;
+namespace noiseModel = gtsam::noiseModel;
+
+TEST(NoiseModelCache, Isotropic) {
+  auto model = InternedIsotropic(6, 0.1);
+  EXPECT(model == InternedIsotropic(6, 0.1));
+  EXPECT(model != InternedIsotropic(6, 0.2));
+  EXPECT(model != InternedIsotropic(3, 0.1));
+  EXPECT(model->equals(*noiseModel::Isotropic::Sigma(6, 0.1)));
+
+  // As in gtsam, a unit sigma yields a unit model.
+  EXPECT(boost::dynamic_pointer_cast<noiseModel::Unit>(
+      InternedIsotropic(2, 1.0)));
+}
+
+TEST(NoiseModelCache, Others) {
+  const gtsam::Vector3 sigmas(0.1, 0.2, 0.3);
+  auto diagonal = InternedDiagonal(sigmas);
+  EXPECT(diagonal == InternedDiagonal(sigmas));
+  EXPECT(assert_equal(sigmas, diagonal->sigmas()));
+
+  EXPECT(InternedUnit(4) == InternedUnit(4));
+  EXPECT_LONGS_EQUAL(4, InternedUnit(4)->dim());
+
+  auto constrained = InternedConstrained(6);
+  EXPECT(constrained == InternedConstrained(6));
+  EXPECT(constrained->isConstrained());
+  EXPECT(constrained->equals(*noiseModel::Constrained::All(6)));
+}
+
+TEST(NoiseModelCache, Clear) {
+  ClearInternedNoiseModels();
+  auto model = InternedIsotropic(1, 0.5);
+  InternedIsotropic(1, 0.5);
+  InternedConstrained(1);
+  EXPECT_LONGS_EQUAL(2, NumInternedNoiseModels());
+
+  // Models handed out before clearing stay valid, new ones are fresh.
+  ClearInternedNoiseModels();
+  EXPECT_LONGS_EQUAL(0, NumInternedNoiseModels());
+  EXPECT_DOUBLES_EQUAL(0.5, model->sigma(), 1e-9);
+  EXPECT(model != InternedIsotropic(1, 0.5));
+}
+
+TEST(NoiseModelCache, OptimizerSetting) {
+  // Settings with equal sigmas share their models.
+  const OptimizerSetting a(1e-3), b(1e-3);
+  EXPECT(a.p_cost_model == b.p_cost_model);
+  EXPECT(a.f_cost_model == b.f_cost_model);
+  EXPECT(a.p_cost_model == a.v_cost_model);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -78,6 +78,22 @@ TEST(ObjectiveFactors, OptionalNoiseModels) {
   EXPECT_LONGS_EQUAL(5, graph.size());
 }
 
+TEST(ObjectiveFactors, JointAngleObjectives) {
+  const gtsam::Matrix angles =
+      (gtsam::Matrix(2, 3) << 1, 2, 3, 4, 5, 6).finished();
+  auto graph = JointAngleObjectives({4, 0, 2}, angles, kModel1, 3);
+  EXPECT_LONGS_EQUAL(6, graph.size());
+  auto prior = boost::dynamic_pointer_cast<gtsam::PriorFactor<double>>(
+      graph.at(5));
+  EXPECT(prior && prior->key() == JointAngleKey(2, 4).key());
+  EXPECT_DOUBLES_EQUAL(6, prior->prior(), 0);
+
+  EXPECT_LONGS_EQUAL(2, TorqueObjectives({1}, gtsam::Matrix::Zero(2, 1),
+                                         kModel1)
+                            .size());
+  THROWS_EXCEPTION(JointVelObjectives({1, 2}, angles, kModel1));
+}
+
 TEST(Phase, AddGoals) {
   Robot robot =
       CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"), "spider");
@@ -89,7 +105,7 @@ TEST(Phase, AddGoals) {
   auto LF = robot.link("lower0");  // left forward leg
   Point3 stance_point = LF->bMcom().transformFrom(point_com);
 
-  uint8_t id = LF->id();
+  uint16_t id = LF->id();
   constexpr size_t num_stance_steps = 10;
   constexpr size_t k = 777;
   const gtsam::SharedNoiseModel &cost_model = kModel3;
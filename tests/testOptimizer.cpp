@@ -0,0 +1,390 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testOptimizer.cpp
+ * @brief Test the time-slice and dynamics elimination orderings, multi-start
+ *        solving, solver telemetry, deadlines, component splitting and
+ *        solver profiles.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SolverProfile.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <map>
+#include <sstream>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// A chain in time, with joint angles and velocities coupled by a global key.
+static NonlinearFactorGraph ChainGraph(int num_steps, Values* initial) {
+  auto model = gtsam::noiseModel::Unit::Create(1);
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0, model);
+  graph.addPrior<double>(PhaseKey(0), 0.1, model);
+  InsertJointAngle(initial, 0, 0, 0.3);
+  initial->insert(PhaseKey(0), 0.5);
+  for (int t = 0; t < num_steps; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t), JointVelKey(0, t), 1.0, model);
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointVelKey(0, t), JointAngleKey(0, t + 1), -0.5, model);
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        PhaseKey(0), JointVelKey(0, t), 0.2, model);
+    InsertJointVel(initial, 0, t, 0.1 * t);
+    InsertJointAngle(initial, 0, t + 1, -0.2 * t);
+  }
+  return graph;
+}
+
+// Keys are eliminated in increasing time, global keys last.
+TEST(TimeOrdering, chain) {
+  Values initial;
+  const int num_steps = 4;
+  auto graph = ChainGraph(num_steps, &initial);
+  const gtsam::Ordering ordering = TimeOrdering(graph);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+
+  uint64_t previous_time = 0;
+  for (size_t i = 0; i + 1 < ordering.size(); i++) {
+    const DynamicsSymbol symbol(ordering[i]);
+    EXPECT(symbol.time() >= previous_time);
+    previous_time = symbol.time();
+  }
+  EXPECT(ordering.back() == gtsam::Key(PhaseKey(0)));
+}
+
+// The ordering does not change the optimization result.
+TEST(TimeOrdering, optimize) {
+  Values initial;
+  auto graph = ChainGraph(10, &initial);
+
+  OptimizationParameters parameters;
+  Optimizer default_optimizer(parameters);
+  parameters.time_ordering = true;
+  Optimizer time_optimizer(parameters);
+
+  EXPECT(assert_equal(default_optimizer.optimize(graph, initial),
+                      time_optimizer.optimize(graph, initial), 1e-6));
+}
+
+// The middle slice is eliminated after both halves, which are then
+// independent subtrees, and neither the ordering nor threads change the
+// result.
+TEST(NestedTimeOrdering, chain) {
+  Values initial;
+  auto graph = ChainGraph(16, &initial);
+  const gtsam::Ordering ordering = NestedTimeOrdering(graph);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+  EXPECT(ordering.back() == gtsam::Key(PhaseKey(0)));
+  std::map<gtsam::Key, size_t> position;
+  for (size_t i = 0; i < ordering.size(); i++) position[ordering[i]] = i;
+  for (int t = 0; t <= 16; t++) {
+    if (t == 8) continue;
+    EXPECT(position.at(JointAngleKey(0, t)) < position.at(JointAngleKey(0, 8)));
+  }
+  EXPECT(position.at(JointAngleKey(0, 3)) < position.at(JointAngleKey(0, 4)));
+  EXPECT(position.at(JointAngleKey(0, 12)) <
+         position.at(JointAngleKey(0, 13)));
+  EXPECT(position.at(JointAngleKey(0, 16)) <
+         position.at(JointAngleKey(0, 13)));
+
+  const auto bayes_tree =
+      graph.linearize(initial)->eliminateMultifrontal(ordering);
+  EXPECT_LONGS_EQUAL(1, bayes_tree->roots().size());
+  EXPECT(bayes_tree->roots().front()->children.size() >= 2);
+
+  OptimizationParameters parameters;
+  parameters.nested_ordering = true;
+  parameters.num_threads = 2;
+  EXPECT(assert_equal(Optimizer().optimize(graph, initial),
+                      Optimizer(parameters).optimize(graph, initial), 1e-6));
+}
+
+// Trees are eliminated from the leaves to the root, wrenches before poses.
+TEST(DynamicsOrdering, tree) {
+  const Robot robot = simple_rr::getRobot();
+  const auto graph = DynamicsGraph(simple_rr::gravity, simple_rr::planar_axis)
+                         .dynamicsFactorGraph(robot, 0);
+  const int l0 = robot.link("link_0")->id(), l1 = robot.link("link_1")->id(),
+            l2 = robot.link("link_2")->id();
+  const int j2 = robot.joint("joint_2")->id();
+
+  const gtsam::Ordering ordering = DynamicsOrdering(graph);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+  std::map<gtsam::Key, size_t> position;
+  for (size_t i = 0; i < ordering.size(); i++) position[ordering[i]] = i;
+  EXPECT(position.at(WrenchKey(l2, j2)) < position.at(TorqueKey(j2)));
+  EXPECT(position.at(TorqueKey(j2)) < position.at(JointAngleKey(j2)));
+  EXPECT(position.at(JointAngleKey(j2)) < position.at(PoseKey(l2)));
+  EXPECT(position.at(PoseKey(l2)) < position.at(WrenchKey(l1, j2)));
+  EXPECT(position.at(PoseKey(l1)) < position.at(PoseKey(l0)));
+
+  // From another root.
+  const gtsam::Ordering from_l2 = DynamicsOrdering(graph, l2);
+  for (size_t i = 0; i < from_l2.size(); i++) position[from_l2[i]] = i;
+  EXPECT(position.at(PoseKey(l0)) < position.at(PoseKey(l1)));
+  EXPECT(position.at(PoseKey(l1)) < position.at(PoseKey(l2)));
+}
+
+// Slices are eliminated in increasing time, and the result does not change.
+TEST(DynamicsOrdering, chain) {
+  Values initial;
+  auto graph = ChainGraph(10, &initial);
+  const gtsam::Ordering ordering = DynamicsOrdering(graph);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), ordering.size());
+  for (size_t i = 1; i + 1 < ordering.size(); i++) {
+    EXPECT(DynamicsSymbol(ordering[i - 1]).time() <=
+           DynamicsSymbol(ordering[i]).time());
+  }
+  EXPECT(ordering.back() == gtsam::Key(PhaseKey(0)));
+
+  OptimizationParameters parameters;
+  parameters.dynamics_ordering = true;
+  EXPECT(assert_equal(Optimizer().optimize(graph, initial),
+                      Optimizer(parameters).optimize(graph, initial), 1e-6));
+}
+
+// A double well in x1, with the global minimum near 1 and a local one near -1,
+// and the constraint x2 = x1.
+static NonlinearFactorGraph DoubleWell(EqualityConstraints* constraints) {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  graph.add(gtsam::ExpressionFactor<double>(
+      gtsam::noiseModel::Unit::Create(1), 0., pow(x1, 2.0) + -1.0));
+  graph.addPrior<double>(x1_key, 1.0,
+                         gtsam::noiseModel::Isotropic::Sigma(1, 10));
+  constraints->emplace_shared<DoubleExpressionEquality>(x2 + (-x1), 1e-3);
+  return graph;
+}
+
+// Multi-start escapes the local minimum the single start converges to.
+TEST(Optimizer, multiStart) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  Values initial;
+  initial.insert(x1_key, -1.2);
+  initial.insert(x2_key, -1.2);
+
+  for (auto method : {OptimizationParameters::Method::SOFT_CONSTRAINTS,
+                      OptimizationParameters::Method::PENALTY,
+                      OptimizationParameters::Method::AUGMENTED_LAGRANGIAN}) {
+    OptimizationParameters parameters;
+    parameters.method = method;
+    const Values single =
+        Optimizer(parameters).optimize(graph, constraints, initial);
+    EXPECT(single.at<double>(x1_key) < 0);
+
+    parameters.num_starts = 16;
+    parameters.start_noise = 2.0;
+    const Values multi =
+        Optimizer(parameters).optimize(graph, constraints, initial);
+    EXPECT(multi.at<double>(x1_key) > 0);
+    EXPECT(graph.error(multi) < graph.error(single));
+  }
+}
+
+// Cancelling the starts that fall behind keeps the best one.
+TEST(Optimizer, multiStartCancel) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  Values initial;
+  initial.insert(x1_key, 0.8);
+  initial.insert(x2_key, 0.8);
+
+  OptimizationParameters parameters;
+  parameters.num_starts = 16;
+  parameters.start_noise = 2.0;
+  parameters.cancel_ratio = 10.0;
+  const Values result =
+      Optimizer(parameters).optimize(graph, constraints, initial);
+  EXPECT_DOUBLES_EQUAL(1.0, result.at<double>(x1_key), 0.1);
+}
+
+// A cancel ratio below 1 would cancel the best start, and is rejected.
+TEST(Optimizer, cancelRatio) {
+  OptimizationParameters parameters;
+  parameters.cancel_ratio = 0.5;
+  THROWS_EXCEPTION(Optimizer{parameters});
+  parameters.cancel_ratio = -1.0;
+  THROWS_EXCEPTION(Optimizer{parameters});
+  parameters.cancel_ratio = 1.0;
+  Optimizer{parameters};  // does not throw
+}
+
+// Telemetry does not change the result, and records every iteration.
+TEST(Optimizer, telemetry) {
+  Values initial;
+  auto graph = ChainGraph(10, &initial);
+  Optimizer optimizer;
+  SolverTelemetry telemetry;
+  const Values result = optimizer.optimize(graph, initial, &telemetry);
+  EXPECT(assert_equal(optimizer.optimize(graph, initial), result, 1e-6));
+
+  EXPECT(!telemetry.iterations.empty());
+  for (const auto& iteration : telemetry.iterations) {
+    EXPECT_LONGS_EQUAL(graph.size(), iteration.num_factors);
+    EXPECT_LONGS_EQUAL(initial.size(), iteration.num_variables);
+    EXPECT(iteration.num_tries >= 1);
+    EXPECT(iteration.bayes_net_entries > 0);
+  }
+  EXPECT_LONGS_EQUAL(2, telemetry.factors_per_type.size());  // prior, between
+  EXPECT(telemetry.totalTime() >= 0);
+
+  std::stringstream csv, json;
+  telemetry.writeCsv(csv);
+  telemetry.writeJson(json);
+  std::string line;
+  size_t num_lines = 0;
+  while (std::getline(csv, line)) num_lines++;
+  EXPECT_LONGS_EQUAL(telemetry.iterations.size() + 1, num_lines);
+  EXPECT(json.str().front() == '{' && json.str().back() == '}');
+}
+
+// Constrained methods record the outer iteration of each LM iteration.
+TEST(Optimizer, telemetryPenalty) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  Values initial;
+  initial.insert(x1_key, 0.8);
+  initial.insert(x2_key, 0.8);
+
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::PENALTY;
+  SolverTelemetry telemetry;
+  Optimizer(parameters).optimize(graph, constraints, initial, &telemetry);
+  EXPECT(!telemetry.iterations.empty());
+  for (size_t i = 1; i < telemetry.iterations.size(); i++) {
+    EXPECT(telemetry.iterations[i].outer_iteration >=
+           telemetry.iterations[i - 1].outer_iteration);
+  }
+}
+
+// An expired deadline returns the initial values, with a timed out status.
+TEST(Optimizer, deadline) {
+  using namespace constrained_example;
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  Values initial;
+  initial.insert(x1_key, 0.8);
+  initial.insert(x2_key, 0.5);
+
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::PENALTY;
+  OptimizationStatus status;
+  const Values result = Optimizer(parameters).optimize(
+      graph, constraints, initial, nullptr, &status);
+  EXPECT(!status.timed_out);
+  EXPECT(status.feasible);
+  EXPECT_DOUBLES_EQUAL(graph.error(result), status.error, 1e-9);
+
+  parameters.deadline = 0;
+  const Values timed_out = Optimizer(parameters).optimize(
+      graph, constraints, initial, nullptr, &status);
+  EXPECT(assert_equal(initial, timed_out));
+  EXPECT(status.timed_out);
+  EXPECT(!status.feasible);
+  EXPECT_DOUBLES_EQUAL(300.0, status.violation, 1e-6);
+}
+
+// Independent problems are found as components, and solved as one would be.
+TEST(Optimizer, splitComponents) {
+  using namespace constrained_example;
+  Values initial;
+  auto chain = ChainGraph(5, &initial);
+  EqualityConstraints constraints;
+  auto graph = DoubleWell(&constraints);
+  graph.add(chain);
+  initial.insert(x1_key, 0.8);
+  initial.insert(x2_key, 0.5);
+  initial.insert(Symbol('y', 0), 3.0);
+
+  const auto components = ConnectedComponents(graph, constraints);
+  EXPECT_LONGS_EQUAL(2, components.size());
+  EXPECT_LONGS_EQUAL(2, components[0].graph.size());
+  EXPECT_LONGS_EQUAL(1, components[0].constraints.size());
+  EXPECT_LONGS_EQUAL(2, components[0].keys.size());
+  EXPECT_LONGS_EQUAL(chain.size(), components[1].graph.size());
+  EXPECT_LONGS_EQUAL(0, components[1].constraints.size());
+  EXPECT(assert_equal(chain.keys(), components[1].keys));
+
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::PENALTY;
+  const Values expected =
+      Optimizer(parameters).optimize(graph, constraints, initial);
+  parameters.split_components = true;
+  OptimizationStatus status;
+  const Values actual = Optimizer(parameters).optimize(
+      graph, constraints, initial, nullptr, &status);
+  EXPECT(assert_equal(expected, actual, 1e-2));
+  EXPECT_DOUBLES_EQUAL(3.0, actual.at<double>(Symbol('y', 0)), 1e-12);
+  EXPECT(status.feasible);
+}
+
+// Stiff factors are satisfied exactly by SQP when made constraints.
+TEST(Optimizer, hardSigma) {
+  using gtsam::Symbol;
+  NonlinearFactorGraph graph;
+  const Symbol x0('x', 0), x1('x', 1);
+  auto stiff = gtsam::noiseModel::Isotropic::Sigma(1, 1e-4);
+  graph.addPrior(x0, 0.0, stiff);
+  graph.addPrior(x1, 3.0, stiff);
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      x0, x1, 1.0, gtsam::noiseModel::Isotropic::Sigma(1, 1.0));
+  Values initial;
+  initial.insert(x0, 0.1);
+  initial.insert(x1, 0.2);
+
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::SQP;
+  parameters.hard_sigma = 1e-3;
+  OptimizationStatus status;
+  const Values result = Optimizer(parameters).optimize(
+      graph, EqualityConstraints(), initial, nullptr, &status);
+  EXPECT_DOUBLES_EQUAL(0.0, result.at<double>(x0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(3.0, result.at<double>(x1), 1e-9);
+  EXPECT(status.feasible);
+  EXPECT_DOUBLES_EQUAL(0.5 * 2 * 2, status.error, 1e-9);
+}
+
+// All solver profiles find the same solution.
+TEST(SolverProfile, optimize) {
+  Values initial;
+  auto graph = ChainGraph(10, &initial);
+  const Values expected = Optimizer().optimize(graph, initial);
+
+  for (SolverProfile profile : AvailableSolverProfiles()) {
+    OptimizationParameters parameters;
+    SetSolverProfile(profile, &parameters);
+    const double tol = profile == SolverProfile::PCG ? 1e-3 : 1e-6;
+    EXPECT(assert_equal(expected,
+                        Optimizer(parameters).optimize(graph, initial), tol));
+  }
+  EXPECT(SolverProfileName(SolverProfile::SEQUENTIAL_QR) == "SEQUENTIAL_QR");
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testOutOfCoreOptimizer.cpp
+ * @brief Test LM streaming through time slices paged to disk.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/OutOfCoreOptimizer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+
+static const size_t kNumSlices = 20;
+
+// A pose and a joint angle per slice, chained to the previous slice.
+static NonlinearFactorGraph SliceFactors(size_t k) {
+  const int t = k;
+  NonlinearFactorGraph graph;
+  if (k == 0) {
+    graph.addPrior(PoseKey(0, 0), Pose3(), gtsam::noiseModel::Unit::Create(6));
+    graph.addPrior<double>(JointAngleKey(0, 0), 0.0,
+                           gtsam::noiseModel::Unit::Create(1));
+    return graph;
+  }
+  const Pose3 step(gtsam::Rot3::Rz(0.1), gtsam::Point3(1, 0, 0));
+  graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+      PoseKey(0, t - 1), PoseKey(0, t), step,
+      gtsam::noiseModel::Isotropic::Sigma(6, 0.1));
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      JointAngleKey(0, t - 1), JointAngleKey(0, t), 0.2,
+      gtsam::noiseModel::Isotropic::Sigma(1, 0.1));
+  // Measurements of each slice alone.
+  graph.addPrior<double>(JointAngleKey(0, t), 0.1 * t,
+                         gtsam::noiseModel::Isotropic::Sigma(1, 1.0));
+  return graph;
+}
+
+static Values Initial() {
+  Values values;
+  for (int t = 0; t < int(kNumSlices); t++) {
+    values.insert(PoseKey(0, t), Pose3(gtsam::Rot3(), gtsam::Point3(t, 1, 0)));
+    InsertJointAngle(&values, 0, t, 0.0);
+  }
+  return values;
+}
+
+TEST(OutOfCoreOptimizer, matchesBatch) {
+  NonlinearFactorGraph graph;
+  for (size_t k = 0; k < kNumSlices; k++) graph.push_back(SliceFactors(k));
+  gtsam::LevenbergMarquardtParams params;
+  params.setRelativeErrorTol(1e-12);
+  params.setAbsoluteErrorTol(1e-12);
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(graph, Initial(), params).optimize();
+
+  const std::string prefix = "testOutOfCoreOptimizer";
+  const PagedValues initial =
+      PagedValues::FromValues(prefix + ".initial", Initial(), true);
+  OutOfCoreOptimizer optimizer(SliceFactors, params, prefix);
+  EXPECT_DOUBLES_EQUAL(graph.error(Initial()), optimizer.error(initial),
+                       1e-9);
+  const PagedValues result = optimizer.optimize(initial);
+  CHECK(optimizer.iterations() > 0);
+  EXPECT(assert_equal(expected, result.values(), 1e-5));
+  EXPECT_DOUBLES_EQUAL(graph.error(expected), optimizer.error(result), 1e-6);
+
+  // Only the result is left, and the initial values are untouched.
+  EXPECT(std::ifstream(result.name()).good());
+  EXPECT(!std::ifstream(prefix + ".conditionals").good());
+  EXPECT(!std::ifstream(prefix + ".deltas").good());
+  EXPECT(assert_equal(Initial(), initial.values(), 1e-12));
+  std::remove(result.name().c_str());
+}
+
+TEST(OutOfCoreOptimizer, longFactors) {
+  // Factors may only involve the previous slice.
+  auto factors = [](size_t k) -> NonlinearFactorGraph {
+    NonlinearFactorGraph graph = SliceFactors(k);
+    if (k == 3) {
+      graph.emplace_shared<gtsam::BetweenFactor<double>>(
+          JointAngleKey(0, 0), JointAngleKey(0, 3), 0.6,
+          gtsam::noiseModel::Unit::Create(1));
+    }
+    return graph;
+  };
+  const PagedValues initial = PagedValues::FromValues(
+      "testOutOfCoreOptimizer_long.initial", Initial(), true);
+  OutOfCoreOptimizer optimizer(factors, gtsam::LevenbergMarquardtParams(),
+                               "testOutOfCoreOptimizer_long");
+  THROWS_EXCEPTION(optimizer.error(initial));
+  THROWS_EXCEPTION(optimizer.optimize(initial));
+  std::remove("testOutOfCoreOptimizer_long.0.values");
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
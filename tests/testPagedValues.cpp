@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPagedValues.cpp
+ * @brief Test values paged to memory-mapped files.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/PagedValues.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <fstream>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Values of every supported type at times 2 to 5.
+static Values Example() {
+  Values values;
+  for (int t = 2; t < 6; t++) {
+    InsertJointAngle(&values, 0, t, 0.1 * t);
+    InsertWrench(&values, 1, 0, t, gtsam::Vector6::Constant(t));
+    values.insert<gtsam::Vector3>(TwistAccelKey(1, t),
+                                  gtsam::Vector3(1, 2, t));
+    values.insert<gtsam::Vector>(JointAccelKey(0, t), gtsam::Vector2(t, -t));
+    values.insert(PoseKey(1, t),
+                  gtsam::Pose3(gtsam::Rot3::RzRyRx(0.1, 0.2, 0.3 * t),
+                               gtsam::Point3(t, 0, 1)));
+    values.insert(TwistKey(1, t), gtsam::Rot3::Ry(0.2 * t));
+  }
+  return values;
+}
+
+TEST(PagedValues, roundtrip) {
+  const std::string path = "testPagedValues.bin";
+  const Values values = Example();
+  {
+    const PagedValues paged = PagedValues::FromValues(path, values, true);
+    EXPECT_LONGS_EQUAL(4, paged.numSlices());
+    EXPECT_LONGS_EQUAL(1 + 6 + 3 + 2 + 6 + 3, paged.dim());
+    EXPECT_LONGS_EQUAL(2, paged.sliceOf(PoseKey(1, 4)));
+    THROWS_EXCEPTION(paged.sliceOf(PoseKey(1, 6)));
+    const Values slice = paged.slice(1);
+    EXPECT_LONGS_EQUAL(6, slice.size());
+    for (const auto &key_value : slice) {
+      EXPECT(key_value.value.equals(values.at(key_value.key), 1e-12));
+    }
+    paged.release(1);
+    EXPECT(assert_equal(values, paged.values(), 1e-12));
+    EXPECT(std::ifstream(path).good());
+  }
+  // Temporary files are removed.
+  EXPECT(!std::ifstream(path).good());
+}
+
+TEST(PagedValues, write) {
+  const std::string path = "testPagedValues_write.bin";
+  Values first;
+  InsertJointAngle(&first, 0, 0, 1.0);
+  PagedValues paged(path, first, 3, true);
+
+  // Slices must have the keys of the first, shifted in time.
+  Values slice;
+  InsertJointAngle(&slice, 0, 2, 3.0);
+  paged.write(2, slice);
+  EXPECT_DOUBLES_EQUAL(3.0, JointAngle(paged.slice(2), 0, 2), 0);
+  EXPECT_DOUBLES_EQUAL(0.0, JointAngle(paged.slice(1), 0, 1), 0);
+  THROWS_EXCEPTION(paged.write(1, slice));
+  THROWS_EXCEPTION(paged.write(3, slice));
+
+  Values mixed = first;
+  InsertJointAngle(&mixed, 1, 1, 1.0);
+  THROWS_EXCEPTION(PagedValues(path, mixed, 2, true));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
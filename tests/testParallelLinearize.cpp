@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testParallelLinearize.cpp
+ * @brief Test concurrent linearization and error of dynamics graphs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/ParallelLinearize.h>
+#include <gtdynamics/utils/Trajectory.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::GaussianFactorGraph;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+// The spider walking graph, with contacts, and its initial values.
+NonlinearFactorGraph SpiderGraph(Values *values) {
+  using namespace walk_cycle_example;
+  const Trajectory trajectory(walk_cycle, 1);
+  const DynamicsGraph graph_builder(OptimizerSetting(1e-5),
+                                    gtsam::Vector3(0, 0, -9.8));
+  NonlinearFactorGraph graph = trajectory.multiPhaseFactorGraph(
+      robot, graph_builder, CollocationScheme::Trapezoidal, 1.0);
+  trajectory.addIntegrationTimeFactors(&graph, 1. / 240);
+
+  Initializer initializer;
+  *values = trajectory.multiPhaseInitialValues(robot, initializer, 0.1,
+                                               1. / 240);
+  return graph;
+}
+}  // namespace
+
+// The parallel path gives the serial linearization, factor for factor.
+TEST(ParallelLinearize, sameAsSerial) {
+  Values values;
+  const NonlinearFactorGraph graph = SpiderGraph(&values);
+  const auto expected = graph.linearize(values);
+  const auto actual = ParallelLinearize(graph, values);
+  EXPECT_LONGS_EQUAL(expected->size(), actual->size());
+  EXPECT(gtsam::assert_equal(*expected, *actual, 1e-12));
+
+  // Null factors stay in place.
+  NonlinearFactorGraph with_null = graph;
+  with_null.push_back(gtsam::NonlinearFactor::shared_ptr());
+  const auto linear = ParallelLinearize(with_null, values);
+  EXPECT_LONGS_EQUAL(graph.size() + 1, linear->size());
+  EXPECT(!linear->back());
+}
+
+// Linearizing the same factors from several threads at once, which share
+// their links, joints and noise models, gives the same result in each.
+TEST(ParallelLinearize, concurrent) {
+  Values values;
+  const NonlinearFactorGraph graph = SpiderGraph(&values);
+  const auto expected = graph.linearize(values);
+
+  std::vector<GaussianFactorGraph::shared_ptr> results(8);
+  ParallelFor(results.size(),
+              [&](size_t i) { results[i] = ParallelLinearize(graph, values); });
+  for (auto &&result : results) {
+    EXPECT(gtsam::assert_equal(*expected, *result, 1e-12));
+  }
+}
+
+// The parallel error sums in factor order, so it is the serial error exactly.
+TEST(ParallelError, sameAsSerial) {
+  Values values;
+  NonlinearFactorGraph graph = SpiderGraph(&values);
+  graph.push_back(gtsam::NonlinearFactor::shared_ptr());
+  EXPECT(graph.error(values) > 0);
+  EXPECT(graph.error(values) == ParallelError(graph, values));
+  EXPECT_DOUBLES_EQUAL(0, ParallelError(NonlinearFactorGraph(), values), 0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -55,6 +55,17 @@ TEST(PenaltyMethodOptimizer, ConstrainedExample) {
   gt_results.insert(x2_key, 0.0);
   double tol = 1e-4;
   EXPECT(assert_equal(gt_results, results, tol));
+
+  /// The predictor of each penalty level leads to the same solution.
+  PenaltyMethodParameters parameters;
+  parameters.predictor = true;
+  ConstrainedOptResult intermediate;
+  Values predicted = PenaltyMethodOptimizer(parameters)
+                         .optimize(graph, constraints, init_values,
+                                   &intermediate);
+  EXPECT(assert_equal(gt_results, predicted, tol));
+  EXPECT_LONGS_EQUAL(parameters.num_iterations,
+                     intermediate.num_iters.size());
 }
 
 int main() {
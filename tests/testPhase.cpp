@@ -39,6 +39,7 @@ TEST(Phase, All) {
 
   Point3 cp = phase1_foot_constraint->contactPoint("tarsus_3_L3");
   EXPECT(assert_equal(contact_in_com, cp));
+  THROWS_EXCEPTION(phase1_foot_constraint->contactPoint("tarsus_4_L4"));
 
   PointOnLinks cps = phase1_foot_constraint->contactPoints();
   EXPECT_LONGS_EQUAL(3, cps.size());
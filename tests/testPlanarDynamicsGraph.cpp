@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPlanarDynamicsGraph.cpp
+ * @brief Test the SE(2) dynamics of planar robots against the 3D ones.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/PlanarDynamicsGraph.h>
+#include <gtdynamics/factors/PlanarDynamicsFactors.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <algorithm>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose2;
+using gtsam::Values;
+using gtsam::Vector3;
+
+namespace {
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+const gtsam::Vector3 kPlanarAxis(1, 0, 0);
+
+// Joint angle and velocity of the single joint of simple_urdf.
+Values Joints(const Robot &robot, int t) {
+  Values values;
+  const int j = robot.joint("j1")->id();
+  InsertJointAngle(&values, j, t, 0.3);
+  InsertJointVel(&values, j, t, -0.7);
+  return values;
+}
+
+// Planar and 3D forward kinematics and dynamics agree.
+void CheckAgainst3D(const Robot &robot,
+                    const boost::optional<std::string> &prior_link) {
+  const int t = 2, j = robot.joint("j1")->id();
+  const PlanarDynamicsGraph planar(robot, kPlanarAxis, kGravity);
+  const PlanarProjection &projection = planar.projection();
+
+  Values kinematics = robot.forwardKinematics(Joints(robot, t), t, prior_link);
+  Values planar_kinematics =
+      planar.forwardKinematics(Joints(robot, t), t, prior_link);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(projection.pose(Pose(kinematics, i, t)),
+                        planar_kinematics.at<Pose2>(PoseKey(i, t)), 1e-9));
+    EXPECT(assert_equal(projection.twist(Twist(kinematics, i, t)),
+                        planar_kinematics.at<Vector3>(TwistKey(i, t)), 1e-9));
+  }
+  const Values lifted = planar.lift(planar_kinematics);
+  for (auto &&link : robot.links()) {
+    EXPECT(assert_equal(Pose(kinematics, link->id(), t),
+                        Pose(lifted, link->id(), t), 1e-9));
+  }
+
+  InsertTorque(&kinematics, j, t, 20.0);
+  InsertTorque(&planar_kinematics, j, t, 20.0);
+  DynamicsGraph graph_builder(kGravity, kPlanarAxis);
+  const Values expected = graph_builder.linearSolveFD(robot, t, kinematics);
+  const Values actual = planar.forwardDynamics(t, planar_kinematics);
+  EXPECT_DOUBLES_EQUAL(JointAccel(expected, j, t), JointAccel(actual, j, t),
+                       1e-6);
+  const int i = robot.joint("j1")->child()->id();
+  EXPECT(assert_equal(projection.wrench(Wrench(expected, i, j, t)),
+                      actual.at<Vector3>(WrenchKey(i, j, t)), 1e-6));
+}
+}  // namespace
+
+// Planar poses, twists and wrenches round-trip through 3D.
+TEST(PlanarProjection, lift) {
+  const PlanarProjection projection(kPlanarAxis);
+  const Pose2 pose(0.1, -0.2, 0.3);
+  EXPECT(assert_equal(pose, projection.pose(projection.liftPose(pose, 2.0))));
+  EXPECT(projection.isPlanar(projection.liftPose(pose)));
+  const Vector3 twist(1, 2, 3);
+  EXPECT(assert_equal(twist, projection.twist(projection.liftTwist(twist))));
+  EXPECT(projection.isPlanar(projection.liftTwist(twist)));
+  EXPECT(assert_equal(twist, projection.wrench(projection.liftWrench(twist))));
+  THROWS_EXCEPTION(PlanarProjection(gtsam::Vector3(1, 1, 0)));
+}
+
+// Factor Jacobians match numerical derivatives.
+TEST(PlanarDynamicsGraph, jacobians) {
+  const Robot robot = simple_urdf::getRobot();
+  const PlanarDynamicsGraph planar(robot, kPlanarAxis, kGravity);
+  const PlanarJoint &joint = planar.joints()[0];
+  const int t = 0, p = joint.parent_id, c = joint.child_id, j = joint.id;
+  const auto model = gtsam::noiseModel::Unit::Create(3);
+
+  Values values;
+  values.insert(PoseKey(p, t), Pose2(0.1, 0.2, 0.3));
+  values.insert(PoseKey(c, t), Pose2(-0.4, 0.5, -0.6));
+  values.insert(TwistKey(p, t), Vector3(0.3, -0.1, 0.2));
+  values.insert(TwistKey(c, t), Vector3(-0.2, 0.4, 0.5));
+  values.insert(TwistAccelKey(p, t), Vector3(1.0, -0.5, 0.3));
+  values.insert(TwistAccelKey(c, t), Vector3(0.2, 0.7, -0.4));
+  values.insert(WrenchKey(p, j, t), Vector3(3.0, -1.0, 2.0));
+  values.insert(WrenchKey(c, j, t), Vector3(-2.0, 4.0, 1.0));
+  InsertJointAngle(&values, j, t, 0.4);
+  InsertJointVel(&values, j, t, -0.8);
+  InsertJointAccel(&values, j, t, 1.5);
+  InsertTorque(&values, j, t, 2.5);
+
+  const double delta = 1e-7;
+  EXPECT_CORRECT_FACTOR_JACOBIANS(PlanarPoseFactor(model, joint, t), values,
+                                  delta, 1e-5);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(PlanarTwistFactor(model, joint, t), values,
+                                  delta, 1e-5);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(PlanarTwistAccelFactor(model, joint, t),
+                                  values, delta, 1e-5);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(
+      PlanarWrenchEquivalenceFactor(model, joint, t), values, delta, 1e-5);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(
+      PlanarTorqueFactor(gtsam::noiseModel::Unit::Create(1), joint, t),
+      values, delta, 1e-5);
+  const PlanarLink &link = *std::find_if(
+      planar.links().begin(), planar.links().end(),
+      [c](const PlanarLink &l) { return l.id == c; });
+  const PlanarWrenchFactor wrench_factor(model, link,
+                                         {WrenchKey(c, j, t)}, t,
+                                         gtsam::Vector2(0, -9.8));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(wrench_factor, values, delta, 1e-5);
+}
+
+// A fixed-base robot matches the 3D model with planar wrench factors.
+TEST(PlanarDynamicsGraph, fixedBase) {
+  CheckAgainst3D(simple_urdf::getRobot(), boost::none);
+}
+
+// So does a floating one, with Coriolis and gravity terms on both links.
+TEST(PlanarDynamicsGraph, floatingBase) {
+  CheckAgainst3D(
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf")),
+      std::string("l1"));
+}
+
+// The factor graph has 3-dimensional link variables and no planar factors.
+TEST(PlanarDynamicsGraph, dynamicsFactorGraph) {
+  const Robot robot = simple_urdf::getRobot();
+  const PlanarDynamicsGraph planar(robot, kPlanarAxis, kGravity);
+  const gtsam::NonlinearFactorGraph graph = planar.dynamicsFactorGraph(0);
+  // Three fixed link priors, three joint factors, one wrench factor, and
+  // the wrench equivalence and torque factors.
+  EXPECT_LONGS_EQUAL(9, graph.size());
+
+  Values values = planar.forwardKinematics(Joints(robot, 0), 0);
+  InsertTorque(&values, robot.joint("j1")->id(), 0, 20.0);
+  const Values solution = planar.forwardDynamics(0, values);
+  EXPECT_DOUBLES_EQUAL(0, graph.error(solution), 1e-6);
+}
+
+// Robots that do not move in the plane are rejected.
+TEST(PlanarDynamicsGraph, notPlanar) {
+  THROWS_EXCEPTION(
+      PlanarDynamicsGraph(simple_rr::getRobot(), kPlanarAxis, kGravity));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPlanningServer.cpp
+ * @brief Test the resident planner and its request lines.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/optimizer/PlanningServer.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <future>
+#include <string>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+
+namespace {
+// A spider standing on all feet, then lifting the odd ones.
+const std::string kRequest =
+    "robot=spider_alt.sdf name=spider contact=0,0.19,0 step=0,0.4,0 "
+    "phase=1:tarsus_1_L1,tarsus_2_L2,tarsus_3_L3,tarsus_4_L4,tarsus_5_R4,"
+    "tarsus_6_R3,tarsus_7_R2,tarsus_8_R1 "
+    "phase=1:tarsus_2_L2,tarsus_4_L4,tarsus_6_R3,tarsus_8_R1";
+
+PlanningServerParams Params() {
+  PlanningServerParams params;
+  params.model_directory = kSdfPath;
+  params.num_threads = 2;
+  params.optimization.lm_parameters.setMaxIterations(3);
+  return params;
+}
+}  // namespace
+
+TEST(PlanRequest, Parse) {
+  const PlanRequest request = PlanRequest::Parse("id=3 cycles=2 " + kRequest);
+  EXPECT(request.id == "3" && request.robot == "spider_alt.sdf");
+  EXPECT(request.name == "spider" && request.base == "body");
+  EXPECT_LONGS_EQUAL(2, request.cycles);
+  EXPECT_LONGS_EQUAL(2, request.phase_steps.size());
+  EXPECT_LONGS_EQUAL(8, request.phase_links[0].size());
+  EXPECT(request.phase_links[1][3] == "tarsus_8_R1");
+  EXPECT(assert_equal(Point3(0, 0.19, 0), request.contact));
+  EXPECT(assert_equal(Point3(0, 0.4, 0), request.step));
+
+  THROWS_EXCEPTION(PlanRequest::Parse("robot=a.sdf"));
+  THROWS_EXCEPTION(PlanRequest::Parse("phase=1:a"));
+  THROWS_EXCEPTION(PlanRequest::Parse(kRequest + " cycles=0"));
+  THROWS_EXCEPTION(PlanRequest::Parse(kRequest + " step=0,1"));
+  THROWS_EXCEPTION(PlanRequest::Parse(kRequest + " speed=1"));
+}
+
+// Malformed requests and unknown links are reported, not thrown.
+TEST(PlanningServer, errors) {
+  PlanningServer server(Params());
+  EXPECT(server.handle("robot=").find("error message=") == 0);
+  const std::string response =
+      server.handle("id=4 " + kRequest + " base=no_such_link");
+  EXPECT(response.find("error id=4 message=") == 0);
+  EXPECT_LONGS_EQUAL(0, server.numSolutions());
+}
+
+// The robot is parsed once, and the second plan warm starts from the first.
+TEST(PlanningServer, plan) {
+  PlanningServer server(Params());
+  const PlanResponse first = server.plan(PlanRequest::Parse(kRequest));
+  CHECK(first.ok);
+  EXPECT(!first.warm_started);
+
+  std::promise<std::string> reply;
+  server.submit("id=2 " + kRequest + " step=0,0.35,0",
+                [&reply](const std::string &response) {
+                  reply.set_value(response);
+                });
+  const std::string second = reply.get_future().get();
+  EXPECT(second.find("ok id=2 ") == 0);
+  EXPECT(second.find(" warm_start=1 ") != std::string::npos);
+  EXPECT_LONGS_EQUAL(1, server.numRobots());
+  EXPECT_LONGS_EQUAL(2, server.numSolutions());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
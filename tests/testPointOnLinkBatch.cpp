@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPointOnLinkBatch.cpp
+ * @brief Test batched prediction of points on links.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/PointOnLinkBatch.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+const Robot robot = simple_rr::getRobot();
+const PointOnLinks points{{robot.link("link_1"), Point3(0, 0, 0.3)},
+                          {robot.link("link_2"), Point3(0.1, 0, -0.2)},
+                          {robot.link("link_2"), Point3(0, 0.2, 0.1)}};
+
+// Values with a different pose of each link at time steps 0 to 2.
+gtsam::Values Poses() {
+  gtsam::Values values;
+  for (size_t k = 0; k < 3; k++) {
+    for (auto &&link : robot.links()) {
+      const double a = 0.3 * (k + 1) + 0.1 * link->id();
+      InsertPose(&values, link->id(), k,
+                 Pose3(Rot3::RzRyRx(a, -a, 2 * a), Point3(a, 1, -a)));
+    }
+  }
+  return values;
+}
+}  // namespace example
+
+using namespace example;
+
+// Batched predictions are those of PointOnLink::predict.
+TEST(PointOnLinkBatch, predict) {
+  const PointOnLinkBatch batch(points);
+  EXPECT_LONGS_EQUAL(2, batch.linkIds().size());
+
+  const gtsam::Values values = Poses();
+  const std::vector<size_t> ks{2, 0, 1};
+  std::vector<PointOnLinkBatch::PointArray> positions;
+  std::vector<gtsam::Matrix36> H;
+  batch.predict(batch.gatherPoses(values, ks), &positions, &H);
+  EXPECT_LONGS_EQUAL(3, positions.size());
+  EXPECT_LONGS_EQUAL(9, H.size());
+
+  for (size_t i = 0; i < points.size(); i++) {
+    for (size_t k = 0; k < ks.size(); k++) {
+      const Point3 expected = points[i].predict(values, ks[k]);
+      EXPECT(assert_equal(expected, Point3(positions[i].col(k).matrix()),
+                          1e-9));
+
+      const Pose3 wTcom = Pose(values, points[i].link->id(), ks[k]);
+      const gtsam::Matrix36 expected_H =
+          gtsam::numericalDerivative11<Point3, Pose3>(
+              [&](const Pose3 &pose) {
+                return pose.transformFrom(points[i].point);
+              },
+              wTcom);
+      EXPECT(assert_equal(expected_H, H[i * ks.size() + k], 1e-7));
+    }
+  }
+}
+
+// Contact goals are checked at once for all time steps.
+TEST(PointOnLinkBatch, ContactGoalErrors) {
+  const gtsam::Values values = Poses();
+  ContactGoals goals;
+  for (auto &&cp : points) goals.emplace_back(cp, cp.predict(values, 1));
+  goals[1].goal_point += Point3(0, 0, 0.5);
+
+  const gtsam::Vector errors = ContactGoalErrors(goals, values, {1});
+  EXPECT_DOUBLES_EQUAL(0.5, errors(0), 1e-9);
+  EXPECT(!ContactGoalsSatisfied(goals, values, 1));
+  goals.erase(goals.begin() + 1);
+  EXPECT(ContactGoalsSatisfied(goals, values, 1));
+  EXPECT(ContactGoalsSatisfied(ContactGoals(), values, 1));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPolyhedralFrictionConeFactor.cpp
+ * @brief Test the pyramid approximation of the friction cone.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/PolyhedralFrictionConeFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+
+using gtsam::LabeledSymbol;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+namespace example {
+LabeledSymbol pose_key('p', 0, 0), contact_wrench_key('C', 0, 0);
+const Vector3 gravity(0, 0, -9.8);
+}  // namespace example
+
+// With four facets the pyramid is |f_x|, |f_y| <= mu cos(pi/4) f_z.
+TEST(PolyhedralFrictionConeFactor, error) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(4, 1.0);
+  PolyhedralFrictionConeFactor factor(example::pose_key,
+                                      example::contact_wrench_key, cost_model,
+                                      1.0, example::gravity, 4);
+  const double mu = std::cos(M_PI / 4);
+  Pose3 upright(Rot3(), Point3(0, 0, 2));
+
+  // Normal force only, and a force just inside the pyramid.
+  EXPECT(assert_equal(
+      gtsam::Vector(gtsam::Vector4::Zero()),
+      factor.evaluateError(upright,
+                           (Vector6() << 0, 0, 0, 0, 0, 1).finished())));
+  EXPECT(assert_equal(
+      gtsam::Vector(gtsam::Vector4::Zero()),
+      factor.evaluateError(upright,
+                           (Vector6() << 0, 0, 0, 0.7, -0.7, 1).finished())));
+
+  // Slipping along x violates exactly one facet.
+  gtsam::Vector error = factor.evaluateError(
+      upright, (Vector6() << 0, 0, 0, 1, 0, 1).finished());
+  EXPECT_DOUBLES_EQUAL(1 - mu, error.sum(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1 - mu, error.maxCoeff(), 1e-9);
+
+  // Pulling on the ground violates all facets.
+  error = factor.evaluateError(upright,
+                               (Vector6() << 0, 0, 0, 0, 0, -1).finished());
+  EXPECT(assert_equal(gtsam::Vector(gtsam::Vector4::Constant(mu)), error,
+                      1e-9));
+
+  // Facets are expressed in the world frame: a tilted link can slip.
+  Pose3 tilted(Rot3::Ry(M_PI / 3), Point3(0, 0, 2));
+  error = factor.evaluateError(tilted,
+                               (Vector6() << 0, 0, 0, 0, 0, 1).finished());
+  EXPECT(error.maxCoeff() > 0);
+}
+
+TEST(PolyhedralFrictionConeFactor, jacobians) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(6, 1.0);
+  PolyhedralFrictionConeFactor factor(example::pose_key,
+                                      example::contact_wrench_key, cost_model,
+                                      0.5, example::gravity, 6);
+
+  gtsam::Values values;
+  values.insert(example::pose_key,
+                Pose3(Rot3::RzRyRx(0.3, -0.2, 0.1), Point3(1, 2, 3)));
+  values.insert(example::contact_wrench_key,
+                (Vector6() << 0.1, 0.2, 0.3, 1.1, -0.4, 0.9).finished());
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+}
+
+// DynamicsGraph uses the pyramid when OptimizerSetting asks for facets.
+TEST(PolyhedralFrictionConeFactor, dynamicsFactors) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), Point3(0, 0, -0.1));
+
+  OptimizerSetting opt;
+  opt.friction_cone_facets = 8;
+  DynamicsGraph graph_builder(opt, example::gravity);
+  auto graph = graph_builder.dynamicsFactors(robot, 0, contact_points, 1.0);
+
+  size_t num_pyramids = 0;
+  for (const auto& factor : graph) {
+    auto pyramid =
+        boost::dynamic_pointer_cast<PolyhedralFrictionConeFactor>(factor);
+    if (!pyramid) continue;
+    num_pyramids++;
+    EXPECT_LONGS_EQUAL(8, pyramid->dim());
+    EXPECT_LONGS_EQUAL(8, pyramid->facets().rows());
+  }
+  EXPECT_LONGS_EQUAL(1, num_pyramids);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -207,6 +207,28 @@ TEST(PoseFactor, ForwardKinematics) {
   EXPECT(assert_equal(Pose(result, 2, t), Pose(expected, 2, t)));
 }
 
+// Analytic factor agrees with the expression-based reference.
+TEST(PoseFactor, Analytic) {
+  Pose3 cMp = Pose3(Rot3(), Point3(-2, 0, 0));
+  Vector6 screw_axis;
+  screw_axis << 0, 0, 1, 0, 1, 0;
+  auto joint = make_joint(cMp, screw_axis);
+
+  auto expected = PoseFactor(example::cost_model, joint, 0);
+  AnalyticPoseFactor actual(example::cost_model, joint, 0);
+  EXPECT(expected->keys() == actual.keys());
+
+  Values values;
+  InsertPose(&values, 1, Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 0, 0)));
+  InsertPose(&values, 2, Pose3(Rot3::RzRyRx(-0.2, 0.1, 0.5), Point3(3, 1, 0)));
+  InsertJointAngle(&values, 1, 0.7);
+  EXPECT(assert_equal(expected->unwhitenedError(values),
+                      actual.unwhitenedError(values), 1e-9));
+  EXPECT(assert_equal(*expected->linearize(values), *actual.linearize(values),
+                      1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(actual, values, 1e-7, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -34,7 +34,9 @@ using gtsam::assert_equal;
 // Test constructor of Preintegrated Point Contact Measurements object.
 // Used to perform forward integration for Preintegrated Point Contact Factor.
 TEST(PreintegratedPointContactMeasurements, Constructor) {
-  PreintegratedPointContactMeasurements();
+  // A default-constructed preintegration has not integrated anything.
+  EXPECT(assert_equal<Matrix3>(
+      Z_3x3, PreintegratedPointContactMeasurements().preintMeasCov()));
   PreintegratedPointContactMeasurements pcm(
       Pose3(), Pose3(Rot3(), Vector3(0, 0, 1)), 0.01, I_3x3);
   EXPECT(assert_equal<Matrix3>(I_3x3 * 1e-4, pcm.preintMeasCov()));
@@ -58,6 +60,30 @@ TEST(PreintegratedPointContactMeasurements, IntegrateMeasurement) {
   EXPECT(assert_equal<Matrix3>(I_3x3 * 3e-4, pcm.preintMeasCov()));
 }
 
+/* ************************************************************************* */
+// Test streaming measurements in step with an IMU preintegration.
+TEST(PreintegratedPointContactMeasurements, IntegrateWithImu) {
+  const double dt = 0.001;
+  const Vector3 omega(0, 0.5, 0);
+  PreintegratedImuMeasurements pim(PreintegrationParams::MakeSharedU(9.81));
+  PreintegratedPointContactMeasurements streamed(I_3x3), expected(I_3x3);
+  const Pose3 contact_k(Rot3::Rz(0.3), Vector3(0, 0, -0.4));
+
+  for (int k = 1; k <= 10; k++) {
+    pim.integrateMeasurement(Vector3(0, 0, 9.81), omega, dt);
+    streamed.integrateMeasurement(pim, contact_k);
+    expected.integrateMeasurement(Rot3::Ry(0.5 * k * dt), contact_k, dt);
+  }
+  EXPECT_DOUBLES_EQUAL(0.01, streamed.deltaTij(), 1e-12);
+  EXPECT(assert_equal<Matrix3>(expected.preintMeasCov(),
+                               streamed.preintMeasCov(), 1e-12));
+
+  // A reset starts a new interval.
+  streamed.resetIntegration();
+  EXPECT_DOUBLES_EQUAL(0.0, streamed.deltaTij(), 1e-12);
+  EXPECT(assert_equal<Matrix3>(Z_3x3, streamed.preintMeasCov()));
+}
+
 /* ************************************************************************* */
 // Test constructor for Preintegrated Point Contact Factor.
 TEST(PreintegratedPointContactFactor, Constructor) {
@@ -122,7 +148,9 @@ TEST(PreintegratedPointContactFactor, Jacobians) {
 /* ************************************************************************* */
 // Test constructor for Preintegrated Rigid Contact Factor.
 TEST(PreintegratedRigidContactMeasurements, Constructor) {
-  PreintegratedRigidContactMeasurements();
+  // A default-constructed preintegration has not integrated anything.
+  EXPECT(assert_equal<Matrix6>(
+      Z_6x6, PreintegratedRigidContactMeasurements().preintMeasCov()));
 
   PreintegratedRigidContactMeasurements pcm(I_3x3, I_3x3);
   // Covariance is 0 initially
@@ -160,6 +188,22 @@ TEST(PreintegratedRigidContactMeasurements, IntegrateMeasurementVarying) {
   EXPECT(assert_equal<Matrix6>(expected * dt * dt, pcm.preintMeasCov()));
 }
 
+/* ************************************************************************* */
+// Test that streaming constant noise gives the same result as integrating the
+// whole interval at once.
+TEST(PreintegratedRigidContactMeasurements, IntegrateMeasurementStreamed) {
+  PreintegratedRigidContactMeasurements whole(I_3x3 * 2, I_3x3),
+      streamed(I_3x3 * 2, I_3x3);
+  whole.integrateMeasurement(0.1);
+  for (size_t k = 0; k < 100; k++) streamed.integrateMeasurement(0.001);
+  EXPECT_DOUBLES_EQUAL(0.1, streamed.deltaTij(), 1e-12);
+  EXPECT(assert_equal<Matrix6>(whole.preintMeasCov(), streamed.preintMeasCov(),
+                               1e-12));
+
+  streamed.resetIntegration();
+  EXPECT(assert_equal<Matrix6>(Z_6x6, streamed.preintMeasCov()));
+}
+
 /* ************************************************************************* */
 // Test constructor for Preintegrated Rigid Contact Factor.
 TEST(PreintegratedRigidContactFactor, Constructor) {
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testProfiler.cpp
+ * @brief Test the registry of scoped timers and counters.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/Profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gtdynamics;
+
+using Clock = ProfileRegistry::Clock;
+
+TEST(ProfileRegistry, addTime) {
+  auto &registry = ProfileRegistry::Instance();
+  registry.reset();
+
+  const auto start = Clock::now();
+  registry.addTime("scope", start, start + std::chrono::milliseconds(2));
+  registry.addTime("scope", start, start + std::chrono::milliseconds(4));
+
+  const auto entries = registry.entries();
+  EXPECT_LONGS_EQUAL(1, entries.size());
+  const ProfileEntry &entry = entries.at("scope");
+  EXPECT_LONGS_EQUAL(2, entry.count);
+  EXPECT_DOUBLES_EQUAL(6e-3, entry.total_time, 1e-9);
+  EXPECT_DOUBLES_EQUAL(2e-3, entry.min_time, 1e-9);
+  EXPECT_DOUBLES_EQUAL(4e-3, entry.max_time, 1e-9);
+
+  const auto events = registry.events();
+  EXPECT_LONGS_EQUAL(2, events.size());
+  EXPECT(events[0].name == "scope");
+  EXPECT_LONGS_EQUAL(0, events[0].thread);
+  EXPECT_DOUBLES_EQUAL(4000, events[1].duration, 1e-3);
+}
+
+TEST(ProfileRegistry, addCount) {
+  auto &registry = ProfileRegistry::Instance();
+  registry.reset();
+
+  registry.addCount("factors", 3);
+  registry.addCount("factors");
+  const auto entries = registry.entries();
+  EXPECT_LONGS_EQUAL(4, entries.at("factors").count);
+  EXPECT_DOUBLES_EQUAL(0, entries.at("factors").total_time, 1e-9);
+  EXPECT_LONGS_EQUAL(0, registry.events().size());
+}
+
+TEST(ProfileRegistry, maxEvents) {
+  auto &registry = ProfileRegistry::Instance();
+  registry.reset();
+  const size_t max_events = registry.maxEvents();
+  registry.setMaxEvents(2);
+
+  const auto start = Clock::now();
+  for (size_t i = 0; i < 5; i++) registry.addTime("scope", start, start);
+  EXPECT_LONGS_EQUAL(5, registry.entries().at("scope").count);
+  EXPECT_LONGS_EQUAL(2, registry.events().size());
+
+  registry.setMaxEvents(max_events);
+  registry.reset();
+  EXPECT_LONGS_EQUAL(0, registry.entries().size());
+  EXPECT_LONGS_EQUAL(0, registry.events().size());
+}
+
+TEST(ProfileRegistry, threads) {
+  auto &registry = ProfileRegistry::Instance();
+  registry.reset();
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++) {
+    threads.emplace_back([&registry] {
+      for (size_t i = 0; i < 100; i++) {
+        const ScopedProfile profile("scope");
+        registry.addCount("counter");
+      }
+    });
+  }
+  for (auto &&thread : threads) thread.join();
+
+  const auto entries = registry.entries();
+  EXPECT_LONGS_EQUAL(400, entries.at("scope").count);
+  EXPECT_LONGS_EQUAL(400, entries.at("counter").count);
+  size_t max_thread = 0;
+  for (auto &&event : registry.events()) {
+    max_thread = std::max(max_thread, event.thread);
+  }
+  EXPECT_LONGS_EQUAL(3, max_thread);
+}
+
+TEST(ProfileRegistry, write) {
+  auto &registry = ProfileRegistry::Instance();
+  registry.reset();
+
+  const auto start = Clock::now();
+  registry.addTime("scope", start, start + std::chrono::microseconds(5));
+  registry.addCount("counter", 2);
+
+  std::stringstream json;
+  registry.writeJson(json);
+  EXPECT(json.str().find("\"counter\": {\"count\": 2}") != std::string::npos);
+  EXPECT(json.str().find("\"scope\": {\"count\": 1, \"total_time\": ") !=
+         std::string::npos);
+
+  std::stringstream trace;
+  registry.writeChromeTrace(trace);
+  EXPECT(trace.str().find("{\"traceEvents\": [{\"name\": \"scope\", "
+                          "\"ph\": \"X\", \"pid\": 0, \"tid\": 0") == 0);
+  EXPECT(trace.str().find("\"dur\": 5}]") != std::string::npos);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRandomStream.cpp
+ * @brief Test seeded, counter-based random streams.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/ParallelFor.h>
+#include <gtdynamics/utils/RandomStream.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+// Streams are functions of (seed, stream) only.
+TEST(RandomStream, Deterministic) {
+  RandomStream a(7, 3), b(7, 3), c(7, 4), d(8, 3);
+  for (size_t i = 0; i < 100; i++) {
+    const uint64_t x = a.next();
+    EXPECT(x == b.next());
+    EXPECT(x != c.next());
+    EXPECT(x != d.next());
+  }
+}
+
+TEST(RandomStream, Normal) {
+  RandomStream stream(42, 0);
+  const size_t n = 100000;
+  double sum = 0, sum_squares = 0;
+  for (size_t i = 0; i < n; i++) {
+    const double z = stream.normal();
+    sum += z;
+    sum_squares += z * z;
+  }
+  EXPECT_DOUBLES_EQUAL(0, sum / n, 0.02);
+  EXPECT_DOUBLES_EQUAL(1, sum_squares / n, 0.02);
+
+  for (size_t i = 0; i < 1000; i++) {
+    const double u = stream.uniform();
+    EXPECT(u > 0 && u < 1);
+  }
+}
+
+// Streams keyed by index give the same draws serially and in parallel.
+TEST(RandomStream, Parallel) {
+  const size_t num_streams = 64;
+  std::vector<gtsam::Vector> serial(num_streams), parallel(num_streams);
+  for (size_t k = 0; k < num_streams; k++) {
+    serial[k] = RandomStream(5, k).normal(6, 0.1);
+  }
+  ParallelFor(num_streams, [&](size_t k) {
+    parallel[k] = RandomStream(5, k).normal(6, 0.1);
+  });
+  for (size_t k = 0; k < num_streams; k++) {
+    EXPECT(assert_equal(serial[k], parallel[k], 0));
+  }
+  EXPECT(!assert_equal(serial[0], serial[1], 1e-9));
+}
+
+// Without a seed, every step gets the noise of a fresh gtsam::Sampler.
+TEST(StepNoise, Unseeded) {
+  StepNoise a(boost::none, 0, 0.1), b(boost::none, 9, 0.1);
+  EXPECT(assert_equal(a.sample(), b.sample(), 0));
+  StepNoise c(uint64_t(1), 0, 0.1), d(uint64_t(1), 9, 0.1);
+  EXPECT(!assert_equal(c.sample(), d.sample(), 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testReachabilityMap.cpp
+ * @brief Test the voxel maps of reachable foot positions.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/BatchSimulator.h>
+#include <gtdynamics/kinematics/ReachabilityMap.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+const PointOnLink foot(robot.link("FR_lower"), Point3(0, 0, -0.1));
+
+ReachabilityParameters Parameters() {
+  ReachabilityParameters parameters;
+  parameters.resolution = 0.02;
+  parameters.num_samples = 200000;
+  return parameters;
+}
+
+// Return the foot point in the trunk frame for leg angles within limits.
+Point3 FootInTrunk(double hip, double upper, double lower) {
+  const BatchSimulator simulator(robot);
+  gtsam::Matrix qs = gtsam::Matrix::Zero(robot.numJoints(), 1);
+  const auto &joints = robot.joints();
+  for (size_t j = 0; j < joints.size(); j++) {
+    if (joints[j]->name() == "FR_hip_joint") qs(j, 0) = hip;
+    if (joints[j]->name() == "FR_upper_joint") qs(j, 0) = upper;
+    if (joints[j]->name() == "FR_lower_joint") qs(j, 0) = lower;
+  }
+  const gtsam::Matrix poses = simulator.forwardKinematics(qs);
+  auto pose = [&poses](size_t i) -> Pose3 {
+    const double *p = poses.data() + 12 * i;
+    gtsam::Matrix3 R;
+    R << p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8];
+    return Pose3(gtsam::Rot3(R), Point3(p[9], p[10], p[11]));
+  };
+  size_t trunk = 0, lower_link = 0;
+  for (size_t i = 0; i < robot.links().size(); i++) {
+    if (robot.links()[i]->name() == "trunk") trunk = i;
+    if (robot.links()[i] == foot.link) lower_link = i;
+  }
+  return pose(trunk).transformTo(pose(lower_link).transformFrom(foot.point));
+}
+}  // namespace example
+
+using namespace example;
+
+TEST(ReachabilityMap, a1) {
+  const ReachabilityMap map =
+      ReachabilityMap::Compute(robot, "trunk", foot, Parameters());
+  EXPECT(map.foot() == "FR_lower");
+  EXPECT(map.numReachable() > 0);
+
+  // Configurations within the joint limits are reachable.
+  for (double s : {-0.5, 0.0, 0.5}) {
+    EXPECT(map.reachable(FootInTrunk(0.3 * s, 0.5 + s, -1.5 + 0.5 * s)));
+  }
+
+  // The leg does not reach behind the body, nor a meter down.
+  EXPECT(!map.reachable(Point3(-0.5, -0.1, 0)));
+  EXPECT(!map.reachable(Point3(0.2, -0.1, -1.0)));
+
+  // World frame queries and contact goals.
+  const Pose3 wTtrunk(gtsam::Rot3(), Point3(1, 2, 0.3));
+  const Point3 reached = FootInTrunk(0, 0.7, -1.4);
+  EXPECT(map.reachable(wTtrunk, wTtrunk.transformFrom(reached)));
+  ContactGoals goals{{foot, wTtrunk.transformFrom(reached)},
+                     {foot, Point3(1, 2, -0.7)}};
+  const std::map<std::string, Pose3> poses{{"trunk", wTtrunk}};
+  const ContactGoals reachable = ReachableGoals({map}, poses, goals);
+  EXPECT_LONGS_EQUAL(1, reachable.size());
+}
+
+TEST(ReachabilityMap, save) {
+  const ReachabilityMap map =
+      ReachabilityMap::Compute(robot, "trunk", foot, Parameters());
+  const std::string filename = "reachability_map_test.bin";
+  map.save(filename);
+  const ReachabilityMap loaded = ReachabilityMap::Load(filename);
+  std::remove(filename.c_str());
+  EXPECT(loaded.reference() == "trunk");
+  EXPECT(gtsam::assert_equal(foot.point, loaded.point()));
+  EXPECT_LONGS_EQUAL(map.numReachable(), loaded.numReachable());
+  const Point3 reached = FootInTrunk(0, 0.7, -1.4);
+  EXPECT(loaded.reachable(reached));
+}
+
+TEST(ReachabilityMap, invalid) {
+  CHECK_EXCEPTION(ReachabilityMap::Compute(robot, "FL_hip", foot),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(ReachabilityMap::Load("no_such_file.bin"),
+                  std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
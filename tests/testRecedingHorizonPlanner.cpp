@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRecedingHorizonPlanner.cpp
+ * @brief Test the sliding-window trajectory planner.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/RecedingHorizonPlanner.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+TEST(RecedingHorizonPlanner, simple_urdf) {
+  using simple_urdf::gravity;
+  using simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  const int j = robot.joint("j1")->id();
+  DynamicsGraph graph_builder(gravity, planar_axis);
+
+  // Fix the torque at every time step.
+  auto torque_model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  auto objectives = [&](int k) {
+    NonlinearFactorGraph graph;
+    graph.addPrior<double>(TorqueKey(j, k), 1.0, torque_model);
+    return graph;
+  };
+
+  const int horizon = 3;
+  RecedingHorizonPlanner planner(robot, graph_builder, horizon, 0.1,
+                                 CollocationScheme::Euler, boost::none,
+                                 boost::none, objectives);
+
+  auto state_model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  NonlinearFactorGraph priors;
+  priors.addPrior<double>(JointAngleKey(j, 0), 0.0, state_model);
+  priors.addPrior<double>(JointVelKey(j, 0), 0.0, state_model);
+  Initializer initializer;
+  planner.initialize(priors, initializer.ZeroValues(robot, 0));
+  EXPECT_LONGS_EQUAL(0, planner.firstStep());
+  EXPECT_LONGS_EQUAL(horizon, planner.lastStep());
+
+  planner.advance();
+  planner.advance();
+  EXPECT_LONGS_EQUAL(2, planner.firstStep());
+  EXPECT_LONGS_EQUAL(horizon + 2, planner.lastStep());
+
+  // Old slices are marginalized out, new ones have been added.
+  Values estimate = planner.estimate();
+  EXPECT(!estimate.exists(JointAngleKey(j, 1)));
+  EXPECT(estimate.exists(JointAngleKey(j, 2)));
+  EXPECT(estimate.exists(JointAngleKey(j, horizon + 2)));
+  EXPECT(assert_equal(1.0, Torque(estimate, j, horizon + 2), 1e-2));
+
+  // The joint accelerates from rest under constant torque.
+  EXPECT(JointVel(estimate, j, horizon + 2) > JointVel(estimate, j, 2));
+}
+
+// Advance a two-link arm many times past the initial window, so old slices
+// are marginalized out of a Bayes tree that ISAM2 has reordered repeatedly.
+TEST(RecedingHorizonPlanner, simple_rr_many_advances) {
+  using simple_rr::gravity;
+  using simple_rr::planar_axis;
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  DynamicsGraph graph_builder(gravity, planar_axis);
+
+  auto torque_model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  auto objectives = [&](int k) {
+    NonlinearFactorGraph graph;
+    for (auto &&joint : robot.joints()) {
+      graph.addPrior<double>(TorqueKey(joint->id(), k), 0.5, torque_model);
+    }
+    return graph;
+  };
+
+  const int horizon = 4, num_advances = 20;
+  RecedingHorizonPlanner planner(robot, graph_builder, horizon, 0.05,
+                                 CollocationScheme::Trapezoidal, boost::none,
+                                 boost::none, objectives);
+
+  auto state_model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  NonlinearFactorGraph priors;
+  for (auto &&joint : robot.joints()) {
+    priors.addPrior<double>(JointAngleKey(joint->id(), 0), 0.0, state_model);
+    priors.addPrior<double>(JointVelKey(joint->id(), 0), 0.0, state_model);
+  }
+  Initializer initializer;
+  planner.initialize(priors, initializer.ZeroValues(robot, 0));
+
+  for (int i = 0; i < num_advances; i++) planner.advance();
+  EXPECT_LONGS_EQUAL(num_advances, planner.firstStep());
+  EXPECT_LONGS_EQUAL(horizon + num_advances, planner.lastStep());
+
+  // Only the slices in the window are left, and the torques are as asked.
+  Values estimate = planner.estimate();
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT(!estimate.exists(JointAngleKey(j, num_advances - 1)));
+    for (int k = num_advances; k <= horizon + num_advances; k++) {
+      EXPECT(estimate.exists(JointAngleKey(j, k)));
+    }
+    EXPECT(assert_equal(0.5, Torque(estimate, j, horizon + num_advances),
+                        1e-2));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,169 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRigidBodyDynamics.cpp
+ * @brief Test mass matrix, bias forces and Jacobians against RNEA and ABA.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/RigidBodyDynamics.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace example {
+const Robot a1 = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const Pose3 wTroot(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                   gtsam::Point3(0.1, 0.2, 0.4));
+const Vector6 V_root =
+    (Vector6() << 0.1, -0.3, 0.2, 0.5, 0.0, -0.1).finished();
+
+Vector Wave(size_t n, double amplitude, double frequency) {
+  Vector x(n);
+  for (size_t i = 0; i < n; i++) {
+    x(i) = amplitude * std::sin(frequency * i + 1.0);
+  }
+  return x;
+}
+}  // namespace example
+
+// Fixed base: M * a + C equals the RNEA torques.
+TEST(RigidBodyDynamics, fixedBase) {
+  auto robot = simple_urdf::getRobot();
+  RigidBodyDynamics dynamics(robot, simple_urdf::gravity);
+  EXPECT_LONGS_EQUAL(0, dynamics.rootDofs());
+  EXPECT_LONGS_EQUAL(1, dynamics.numDofs());
+
+  const Vector q = Vector::Constant(1, 0.3), v = Vector::Constant(1, -0.5),
+               a = Vector::Constant(1, 2.0);
+  dynamics.update(q, v);
+  const TreeDynamicsResult expected = dynamics.inverseDynamics(q, v, a);
+  const Vector actual = dynamics.massMatrix() * a + dynamics.biasForces();
+  EXPECT(assert_equal(Vector(expected.torques), actual, 1e-9));
+}
+
+// Floating base: M * [A_root; a] + C = [0; tau] at the ABA solution.
+TEST(RigidBodyDynamics, floatingBase) {
+  RigidBodyDynamics dynamics(example::a1, example::gravity);
+  const size_t n = dynamics.numJoints();
+  EXPECT_LONGS_EQUAL(6, dynamics.rootDofs());
+  EXPECT_LONGS_EQUAL(18, dynamics.numDofs());
+
+  const Vector q = example::Wave(n, 0.2, 1.0), v = example::Wave(n, 0.7, 2.0),
+               tau = example::Wave(n, 0.5, 3.0);
+  TreeDynamicsResult fd;
+  dynamics.forwardDynamics(q, v, tau, example::wTroot, example::V_root, &fd);
+
+  dynamics.update(q, v, example::wTroot, example::V_root);
+  const Matrix &M = dynamics.massMatrix();
+  EXPECT(assert_equal(Matrix(M.transpose()), M, 1e-12));
+
+  Vector accel(18), expected(18);
+  accel << fd.twist_accels[dynamics.linkIndex("trunk")], fd.joint_accels;
+  expected << Vector6::Zero(), tau;
+  EXPECT(assert_equal(expected, M * accel + dynamics.biasForces(), 1e-6));
+}
+
+// Body Jacobians reproduce the link twists, point Jacobians the world frame
+// velocity of points.
+TEST(RigidBodyDynamics, jacobians) {
+  RigidBodyDynamics dynamics(example::a1, example::gravity);
+  const size_t n = dynamics.numJoints();
+  const Vector q = example::Wave(n, 0.3, 0.5), v = example::Wave(n, -0.4, 2.0);
+  dynamics.update(q, v, example::wTroot, example::V_root);
+
+  Vector generalized(18);
+  generalized << example::V_root, v;
+  const TreeDynamicsResult &kinematics = dynamics.kinematics();
+  for (size_t i = 0; i < dynamics.links().size(); i++) {
+    EXPECT(assert_equal(kinematics.twists[i],
+                        Vector6(dynamics.linkJacobian(i) * generalized),
+                        1e-9));
+  }
+
+  const size_t foot = dynamics.linkIndex("FR_lower");
+  const gtsam::Point3 point(0, 0, -0.1);
+  const Vector6 &V = kinematics.twists[foot];
+  const gtsam::Vector3 expected =
+      kinematics.poses[foot].rotation().matrix() *
+      (V.tail<3>() + V.head<3>().cross(point));
+  EXPECT(assert_equal(expected,
+                      gtsam::Vector3(dynamics.pointJacobian(foot, point) *
+                                     generalized),
+                      1e-9));
+}
+
+// The bias acceleration of a point is the derivative of its velocity along
+// a motion with zero generalized acceleration.
+TEST(RigidBodyDynamics, pointBiasAcceleration) {
+  const size_t n = example::a1.numJoints();
+  const Vector q = example::Wave(n, 0.3, 0.5), v = example::Wave(n, -0.4, 2.0);
+  Vector generalized(18);
+  generalized << example::V_root, v;
+  const gtsam::Point3 point(0, 0, -0.1);
+
+  auto velocity = [&](double t) -> gtsam::Vector3 {
+    RigidBodyDynamics dynamics(example::a1, example::gravity);
+    dynamics.update(q + t * v, v,
+                    example::wTroot * Pose3::Expmap(t * example::V_root),
+                    example::V_root);
+    const size_t foot = dynamics.linkIndex("FR_lower");
+    return dynamics.pointJacobian(foot, point) * generalized;
+  };
+  const double dt = 1e-6;
+  const gtsam::Vector3 expected = (velocity(dt) - velocity(-dt)) / (2 * dt);
+
+  RigidBodyDynamics dynamics(example::a1, example::gravity);
+  dynamics.update(q, v, example::wTroot, example::V_root);
+  const size_t foot = dynamics.linkIndex("FR_lower");
+  EXPECT(assert_equal(expected, dynamics.pointBiasAcceleration(foot, point),
+                      1e-5));
+}
+
+// Cached terms follow the state.
+TEST(RigidBodyDynamics, update) {
+  RigidBodyDynamics dynamics(example::a1, example::gravity);
+  THROWS_EXCEPTION(dynamics.massMatrix());
+
+  const size_t n = dynamics.numJoints();
+  const Vector q1 = example::Wave(n, 0.2, 1.0), q2 = example::Wave(n, 0.4, 2.0);
+  const Vector v = example::Wave(n, 0.3, 1.5);
+
+  RigidBodyDynamics fresh(example::a1, example::gravity);
+  fresh.update(q2, v);
+  const Matrix expected_M = fresh.massMatrix();
+  const Vector expected_C = fresh.biasForces();
+
+  dynamics.update(q1, v);
+  dynamics.massMatrix();
+  dynamics.biasForces();
+  dynamics.update(q2, v);
+  EXPECT(assert_equal(expected_M, dynamics.massMatrix(), 1e-12));
+  EXPECT(assert_equal(expected_C, dynamics.biasForces(), 1e-12));
+
+  // Changing only the velocity keeps the mass matrix but not the bias.
+  dynamics.update(q2, Vector::Zero(n));
+  EXPECT(assert_equal(expected_M, dynamics.massMatrix(), 1e-12));
+  EXPECT((expected_C - dynamics.biasForces()).norm() > 1e-6);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
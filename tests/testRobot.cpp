@@ -80,12 +80,63 @@ TEST(Robot, simple_rr_sdf) {
 TEST(Robot, removeLink) {
   // Initialize Robot instance from a file.
   auto robot = four_bar_linkage_pure::getRobot();
+  const int l2_id = robot.link("l2")->id();
 
   robot.removeLink(robot.link("l2"));
   EXPECT(robot.numLinks() == 3);
   EXPECT(robot.numJoints() == 2);
   EXPECT(robot.link("l1")->joints().size() == 1);
   EXPECT(robot.link("l3")->joints().size() == 1);
+
+  // The id index is updated too.
+  EXPECT_LONGS_EQUAL(3, robot.links().size());
+  EXPECT_LONGS_EQUAL(2, robot.joints().size());
+  THROWS_EXCEPTION(robot.link(l2_id));
+  EXPECT(robot.link(robot.link("l1")->id()) == robot.link("l1"));
+}
+
+TEST(Robot, linkJointById) {
+  Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  for (auto&& link : robot.links()) {
+    EXPECT(robot.link(link->id()) == link);
+  }
+  for (auto&& joint : robot.joints()) {
+    EXPECT(robot.joint(joint->id()) == joint);
+  }
+  THROWS_EXCEPTION(robot.link(-1));
+  THROWS_EXCEPTION(robot.joint(robot.numJoints() + 100));
+
+  // links() and joints() return the same storage on every call.
+  EXPECT(&robot.links() == &robot.links());
+  EXPECT(robot.links().data() == robot.links().data());
+  EXPECT(robot.joints().data() == robot.joints().data());
+}
+
+// Fixed and unfixed variants share links and joints, and do not affect the
+// robot they were created from.
+TEST(Robot, fixLinkVariants) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  const LinkSharedPtr l1 = robot.link("l1");
+  EXPECT(!robot.isFixed(l1));
+
+  const Pose3 wTl1(Rot3::Rz(0.3), Point3(1, 2, 3));
+  const Robot fixed = robot.fixLink("l1", wTl1);
+  EXPECT(fixed.isFixed(l1));
+  EXPECT(assert_equal(wTl1, fixed.fixedPose(l1)));
+  EXPECT(fixed.link("l1") == l1);
+  EXPECT(fixed.joints()[0] == robot.joints()[0]);
+  EXPECT(!robot.isFixed(l1));
+  EXPECT(!l1->isFixed());
+  EXPECT(!fixed.equals(robot));
+
+  // Default fixed pose is the rest pose.
+  EXPECT(assert_equal(l1->bMcom(), robot.fixLink("l1").fixedPose(l1)));
+
+  const Robot unfixed = fixed.unfixLink("l1");
+  EXPECT(!unfixed.isFixed(l1));
+  EXPECT(fixed.isFixed(l1));
+  THROWS_EXCEPTION(robot.fixLink("no_such_link"));
 }
 
 TEST(Robot, ForwardKinematics) {
@@ -302,6 +353,90 @@ TEST(Robot, Equality) {
   EXPECT(!robot1.equals(robot2));
 }
 
+// Equal robots have equal content hashes, and changes change them.
+TEST(Robot, contentHash) {
+  const std::string path =
+      kSdfPath + std::string("test/four_bar_linkage_pure.sdf");
+  const Robot robot1 = CreateRobotFromFile(path);
+  const Robot robot2 = CreateRobotFromFile(path);
+  EXPECT(robot1.contentHash() == robot2.contentHash());
+  const Robot copy = robot1;
+  EXPECT(copy.contentHash() == robot1.contentHash());
+
+  const Robot fixed = robot1.fixLink("l1");
+  EXPECT(fixed.contentHash() != robot1.contentHash());
+  EXPECT(fixed.contentHash() == robot2.fixLink("l1").contentHash());
+  EXPECT(fixed.unfixLink("l1").contentHash() == robot1.contentHash());
+
+  EXPECT(simple_rr::getRobot().contentHash() != robot1.contentHash());
+}
+
+// Lumping the fixed joints of the A1 recovers the model that the URDF parser
+// builds when it merges fixed joints itself.
+TEST(Robot, lumpFixedJoints) {
+  const std::string path = kUrdfPath + std::string("a1/a1.urdf");
+  const Robot preserved = CreateRobotFromFile(path, "", true);
+  const Robot expected = CreateRobotFromFile(path);
+
+  LumpedLinks lumped;
+  const Robot robot = preserved.lumpFixedJoints(&lumped);
+  EXPECT_LONGS_EQUAL(expected.numJoints(), robot.numJoints());
+  EXPECT_LONGS_EQUAL(expected.numLinks(), robot.numLinks());
+  EXPECT_LONGS_EQUAL(preserved.numLinks(), lumped.size());
+
+  for (auto &&link : expected.links()) {
+    const LinkSharedPtr actual = robot.link(link->name());
+    EXPECT_DOUBLES_EQUAL(link->mass(), actual->mass(), 1e-9);
+    EXPECT(assert_equal(link->bMcom().translation(),
+                        actual->bMcom().translation(), 1e-6));
+    const gtsam::Matrix3 R = link->bMcom().rotation().matrix(),
+                         actual_R = actual->bMcom().rotation().matrix();
+    EXPECT(assert_equal(gtsam::Matrix3(R * link->inertia() * R.transpose()),
+                        gtsam::Matrix3(actual_R * actual->inertia() *
+                                       actual_R.transpose()),
+                        1e-6));
+  }
+  EXPECT(lumped.at("imu_link").link == robot.link("trunk"));
+
+  // Points on merged links stay at the same place.
+  const LinkSharedPtr toe = preserved.link("FR_toe");
+  const PointOnLinks remapped =
+      RemapPointOnLinks({PointOnLink(toe, Point3(0, 0, -0.02))}, lumped);
+  EXPECT(remapped[0].link == robot.link("FR_lower"));
+  EXPECT(assert_equal(toe->bMcom().transformFrom(Point3(0, 0, -0.02)),
+                      robot.link("FR_lower")->bMcom().transformFrom(
+                          remapped[0].point),
+                      1e-9));
+}
+
+// Shifted ids leave names, kinematics and fixed states as they were.
+TEST(Robot, offsetIds) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const int id_0 = robot.link("link_0")->id();
+  const Robot shifted = robot.offsetIds(10, 20);
+  EXPECT_LONGS_EQUAL(robot.numLinks(), shifted.numLinks());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), shifted.numJoints());
+
+  for (auto &&link : robot.links()) {
+    const LinkSharedPtr actual = shifted.link(link->name());
+    EXPECT_LONGS_EQUAL(link->id() + 10, actual->id());
+    EXPECT(actual == shifted.link(link->id() + 10));
+    EXPECT(assert_equal(link->bMcom(), actual->bMcom()));
+    EXPECT_LONGS_EQUAL(link->joints().size(), actual->joints().size());
+    EXPECT(robot.isFixed(link) == shifted.isFixed(actual));
+  }
+  for (auto &&joint : robot.joints()) {
+    const JointSharedPtr actual = shifted.joint(joint->name());
+    EXPECT_LONGS_EQUAL(joint->id() + 20, actual->id());
+    EXPECT(actual->parent() == shifted.link(joint->parent()->name()));
+    EXPECT(assert_equal(joint->jMc(), actual->jMc()));
+    EXPECT(assert_equal(joint->cScrewAxis(), actual->cScrewAxis()));
+  }
+
+  // The original robot keeps its ids.
+  EXPECT_LONGS_EQUAL(id_0, robot.link("link_0")->id());
+}
+
 // Declaration needed for serialization of derived class.
 BOOST_CLASS_EXPORT(gtdynamics::RevoluteJoint)
 BOOST_CLASS_EXPORT(gtdynamics::HelicalJoint)
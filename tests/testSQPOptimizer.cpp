@@ -0,0 +1,67 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSQPOptimizer.cpp
+ * @brief Test sequential quadratic programming optimizer.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/SQPOptimizer.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using gtsam::assert_equal;
+
+TEST(SQPOptimizer, ConstrainedExample) {
+  using namespace constrained_example;
+
+  /// Create a constrained optimization problem with 2 cost factors and 1
+  /// constraint.
+  NonlinearFactorGraph graph;
+  auto f1 = x1 + exp(-x2);
+  auto f2 = pow(x1, 2.0) + 2.0 * x2 + 1.0;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f1));
+  graph.add(ExpressionFactor<double>(cost_noise, 0., f2));
+
+  EqualityConstraints constraints;
+  double tolerance = 1.0;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.emplace_shared<DoubleExpressionEquality>(g1, tolerance);
+
+  /// Create initial values.
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  /// Solve the constraint problem with the SQP optimizer.
+  SQPOptimizer optimizer;
+  ConstrainedOptResult intermediate;
+  Values results =
+      optimizer.optimize(graph, constraints, init_values, &intermediate);
+
+  /// Check the result is correct within tolerance.
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+  double tol = 1e-4;
+  EXPECT(assert_equal(gt_results, results, tol));
+
+  /// The constraint is satisfied and few QP subproblems are needed.
+  EXPECT(constraints[0]->feasible(results));
+  EXPECT(intermediate.intermediate_values.size() < 30);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
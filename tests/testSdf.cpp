@@ -14,16 +14,22 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
 #include <gtdynamics/universal_robot/HelicalJoint.h>
 #include <gtdynamics/universal_robot/Link.h>
 #include <gtdynamics/universal_robot/PrismaticJoint.h>
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
 #include <gtdynamics/universal_robot/sdf.h>
 #include <gtdynamics/universal_robot/sdf_internal.h>
+#include <gtdynamics/utils/Initializer.h>
 #include <gtdynamics/utils/utils.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 
+#include <cstdio>
+#include <fstream>
+
 using namespace gtdynamics;
 using gtsam::assert_equal;
 using gtsam::Point3;
@@ -80,6 +86,24 @@ TEST(Sdf, load_and_parse_sdf_world_file) {
   EXPECT(assert_equal(0.03, l1.Inertial().Moi()(2, 2)));
 }
 
+// All models of a world are loaded at once, as they are one by one.
+TEST(Sdf, CreateRobotsFromWorldFile) {
+  const std::string path = kSdfPath + std::string("test/multi_model_world.sdf");
+  const std::map<std::string, Robot> robots = CreateRobotsFromWorldFile(path);
+  EXPECT_LONGS_EQUAL(3, robots.size());
+  for (const std::string name : {"arm_a", "arm_b", "box"}) {
+    EXPECT(robots.at(name) == CreateRobotFromFile(path, name));
+  }
+  EXPECT_LONGS_EQUAL(1, robots.at("arm_b").numJoints());
+  EXPECT_LONGS_EQUAL(0, robots.at("box").numJoints());
+
+  // A file with a single model gives a single robot.
+  const auto single = CreateRobotsFromWorldFile(
+      kSdfPath + std::string("test/simple_rr.sdf"));
+  EXPECT_LONGS_EQUAL(1, single.size());
+  EXPECT_LONGS_EQUAL(3, single.at("simple_rr_sdf").links().size());
+}
+
 TEST(Sdf, Pose3FromIgnition) {
   ignition::math::Pose3d pose_to_parse(-1, 1, -1, M_PI / 2, 0, -M_PI);
 
@@ -658,6 +682,62 @@ TEST(Sdf, PreserveFixedJoint) {
   EXPECT_LONGS_EQUAL(21, a1_fixed_joints.numJoints());
 }
 
+// A deserialized robot has the joints of its links, so that forward
+// kinematics and the graph builders give the same results as on the robot
+// parsed from the file.
+static void CheckSameStructure(const Robot &expected, const Robot &actual,
+                               const std::string &root) {
+  for (auto &&link : expected.links()) {
+    EXPECT_LONGS_EQUAL(link->numJoints(),
+                       actual.link(link->name())->numJoints());
+  }
+  Values angles;
+  for (auto &&joint : expected.joints()) {
+    InsertJointAngle(&angles, joint->id(), 0.1 * joint->id());
+  }
+  EXPECT(assert_equal(expected.forwardKinematics(angles, 0, root),
+                      actual.forwardKinematics(angles, 0, root), 1e-9));
+
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const auto expected_graph = graph_builder.dynamicsFactorGraph(expected, 0);
+  const auto actual_graph = graph_builder.dynamicsFactorGraph(actual, 0);
+  EXPECT_LONGS_EQUAL(expected_graph.size(), actual_graph.size());
+  const Values values = Initializer().ZeroValues(expected, 0, 0.1);
+  EXPECT_DOUBLES_EQUAL(expected_graph.error(values),
+                       actual_graph.error(values), 1e-9);
+}
+
+TEST(Sdf, CreateRobotFromCachedFile) {
+  const std::string file_path = kUrdfPath + std::string("a1/a1.urdf");
+  const std::string cache_path = "testSdf_a1_cache.bin";
+  std::remove(cache_path.c_str());
+  const Robot expected = CreateRobotFromFile(file_path);
+
+  // The first call parses the file and writes the cache, the second reads it.
+  const Robot parsed = CreateRobotFromCachedFile(file_path, cache_path);
+  EXPECT(expected.equals(parsed));
+  EXPECT(std::ifstream(cache_path).good());
+  const Robot cached = CreateRobotFromCachedFile(file_path, cache_path);
+  EXPECT(expected.equals(cached));
+  auto trunk = cached.link("trunk");
+  EXPECT(cached.link(trunk->id()) == trunk);
+  CheckSameStructure(expected, cached, "trunk");
+
+  // A corrupt cache is ignored and rewritten.
+  std::ofstream(cache_path) << "not a robot";
+  EXPECT(expected.equals(CreateRobotFromCachedFile(file_path, cache_path)));
+  EXPECT(expected.equals(CreateRobotFromCachedFile(file_path, cache_path)));
+
+  // A cache for other arguments is stale. Fixed joints are not cached.
+  const Robot fixed =
+      CreateRobotFromCachedFile(file_path, cache_path, "", true);
+  EXPECT_LONGS_EQUAL(21, fixed.numJoints());
+  EXPECT(!std::ifstream(cache_path).good());
+
+  THROWS_EXCEPTION(CreateRobotFromCachedFile("no_such_file.urdf", cache_path));
+  std::remove(cache_path.c_str());
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSelectiveMarginals.cpp
+ * @brief Test marginal covariances of requested keys.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/SelectiveMarginals.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/Marginals.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using gtsam::assert_equal;
+using gtsam::KeyVector;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+
+using namespace gtdynamics;
+
+// A chain of link poses over time, with a prior on the first one.
+namespace example {
+const int num_steps = 20;
+
+gtsam::NonlinearFactorGraph Graph() {
+  gtsam::NonlinearFactorGraph graph;
+  auto model = gtsam::noiseModel::Diagonal::Sigmas(
+      (gtsam::Vector6() << 0.1, 0.2, 0.1, 0.3, 0.2, 0.1).finished());
+  graph.addPrior(PoseKey(0, 0), Pose3(), model);
+  for (int k = 0; k < num_steps; k++) {
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(0, k), PoseKey(0, k + 1),
+        Pose3(gtsam::Rot3::Rz(0.1), gtsam::Point3(1, 0, 0)), model);
+  }
+  return graph;
+}
+
+Values Solution() {
+  Values values;
+  for (int k = 0; k <= num_steps; k++) {
+    InsertPose(&values, 0, k,
+               Pose3(gtsam::Rot3::Rz(0.1 * k), gtsam::Point3(k, 0, 0)));
+  }
+  return values;
+}
+}  // namespace example
+
+TEST(SelectiveMarginals, Graph) {
+  const auto graph = example::Graph();
+  const Values solution = example::Solution();
+  const KeyVector keys{PoseKey(0, 5), PoseKey(0, 15)};
+  const SelectiveMarginals marginals(graph, solution, keys);
+  const gtsam::Marginals expected(graph, solution);
+
+  EXPECT(assert_equal(expected.jointMarginalCovariance(keys).fullMatrix(),
+                      marginals.jointCovariance(), 1e-9));
+  EXPECT(assert_equal(expected.marginalCovariance(PoseKey(0, 15)),
+                      marginals.marginalCovariance(PoseKey(0, 15)), 1e-9));
+  EXPECT(assert_equal(marginals.jointCovariance(keys).block(0, 6, 6, 6),
+                      marginals.jointCovariance().block(0, 6, 6, 6)));
+  THROWS_EXCEPTION(marginals.marginalCovariance(PoseKey(0, 3)));
+}
+
+// A Bayes tree eliminated in another order, keys outside the root clique.
+TEST(SelectiveMarginals, BayesTree) {
+  const auto graph = example::Graph();
+  const Values solution = example::Solution();
+  const auto linear = graph.linearize(solution);
+  const auto bayes_tree =
+      linear->eliminateMultifrontal(gtsam::Ordering::Colamd(*linear));
+  const KeyVector keys{PoseKey(0, 2), PoseKey(0, 11), PoseKey(0, 19)};
+  const SelectiveMarginals marginals(*bayes_tree, keys);
+  const gtsam::Marginals expected(graph, solution);
+  EXPECT(assert_equal(expected.jointMarginalCovariance(keys).fullMatrix(),
+                      marginals.jointCovariance(), 1e-9));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
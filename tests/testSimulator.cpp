@@ -52,6 +52,82 @@ TEST(Simulate, simple_urdf) {
   EXPECT(assert_equal(expected_qAccel, JointAccel(results, 0)));
 }
 
+// All integrators are exact for the constant acceleration of simple_urdf,
+// except semi-implicit Euler which is only first order in q.
+TEST(Simulate, integration_methods) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+  std::vector<gtsam::Values> torques_seq(2, torques);
+  const double acceleration = 0.0625, dt = 1;
+
+  for (auto method : {ExplicitEuler, RK4, RK45}) {
+    Simulator simulator(robot, initial_values, gravity, planar_axis);
+    simulator.setIntegrationMethod(method);
+    EXPECT(simulator.integrationMethod() == method);
+    auto results = simulator.simulate(torques_seq, dt);
+    EXPECT(assert_equal(acceleration * 0.5 * dt * dt, JointAngle(results, 0),
+                        1e-9));
+    EXPECT(assert_equal(acceleration * dt, JointVel(results, 0), 1e-9));
+  }
+
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+  simulator.setIntegrationMethod(SemiImplicitEuler);
+  auto results = simulator.simulate(torques_seq, dt);
+  EXPECT(assert_equal(acceleration * dt * dt, JointAngle(results, 0), 1e-9));
+  EXPECT(assert_equal(acceleration * dt, JointVel(results, 0), 1e-9));
+}
+
+// With constant acceleration a, q = a t^2 / 2 crosses 0.5 at t = 4, which
+// the event locates within the step although dt = 1.5.
+TEST(Simulate, events) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+  std::vector<gtsam::Values> torques_seq(4, torques);
+  const double acceleration = 0.0625, dt = 1.5;
+
+  Simulator simulator(robot, initial_values, gravity, planar_axis);
+  size_t num_actions = 0;
+  SimulatorEvent event;
+  event.name = "half";
+  event.function = [](const gtsam::Values &values) {
+    return JointAngle(values, 0) - 0.5;
+  };
+  event.direction = 1;
+  event.action = [&num_actions](Simulator &sim) {
+    num_actions++;
+    sim.setRobot(sim.robot());
+  };
+  simulator.addEvent(event);
+  simulator.setEventTolerance(1e-12);
+
+  std::vector<SimulatorEventRecord> records;
+  simulator.simulateWithEvents(torques_seq, dt, &records);
+  EXPECT_LONGS_EQUAL(1, records.size());
+  EXPECT_LONGS_EQUAL(1, num_actions);
+  EXPECT(records[0].name == "half");
+  EXPECT(assert_equal(4.0, records[0].time, 1e-9));
+  EXPECT(assert_equal(6.0, simulator.time(), 1e-9));
+
+  // Splitting the steps at the event does not change the exact solution.
+  simulator.forwardDynamics(torques);
+  const gtsam::Values &results = simulator.getValues();
+  EXPECT(assert_equal(acceleration * 0.5 * 36, JointAngle(results, 0), 1e-9));
+  EXPECT(assert_equal(acceleration * 6, JointVel(results, 0), 1e-9));
+
+  // A touchdown event measures the height of the point.
+  const PointOnLink point(robot.link("l2"), gtsam::Point3(0, 0, 1));
+  const SimulatorEvent touchdown = ContactHeightEvent(point, -1.0);
+  EXPECT_LONGS_EQUAL(-1, touchdown.direction);
+  EXPECT(assert_equal(point.predict(results).z() + 1.0,
+                      touchdown.function(results), 1e-9));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSlicePCG.cpp
+ * @brief Test the matrix-free PCG with per-slice block preconditioner.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/SlicePCG.h>
+#include <gtdynamics/optimizer/SymbolicStructure.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <boost/make_shared.hpp>
+#include <memory>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+
+// A pose and a joint angle per time step, chained, with a loop closure.
+static NonlinearFactorGraph Chain(int T, Values* initial) {
+  NonlinearFactorGraph graph;
+  graph.addPrior(PoseKey(0, 0), Pose3(), gtsam::noiseModel::Unit::Create(6));
+  graph.addPrior<double>(JointAngleKey(0, 0), 0.0,
+                         gtsam::noiseModel::Unit::Create(1));
+  const Pose3 step(gtsam::Rot3::Rz(0.2), gtsam::Point3(1, 0, 0));
+  for (int t = 1; t < T; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(0, t - 1), PoseKey(0, t), step,
+        gtsam::noiseModel::Isotropic::Sigma(6, 0.1));
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t - 1), JointAngleKey(0, t), 0.3,
+        gtsam::noiseModel::Isotropic::Sigma(1, 0.2));
+  }
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      JointAngleKey(0, 0), JointAngleKey(0, T - 1), 0.3 * (T - 1),
+      gtsam::noiseModel::Unit::Create(1));
+  for (int t = 0; t < T; t++) {
+    initial->insert(PoseKey(0, t),
+                    Pose3(gtsam::Rot3::Rz(0.1 * t), gtsam::Point3(t, 1, 0)));
+    InsertJointAngle(initial, 0, t, 0.0);
+  }
+  return graph;
+}
+
+TEST(SlicePCG, solve) {
+  Values initial;
+  const auto linear = Chain(12, &initial).linearize(initial);
+  // A Hessian factor on two slices is factored back.
+  linear->push_back(gtsam::HessianFactor(
+      gtsam::JacobianFactor(JointAngleKey(0, 3), gtsam::I_1x1,
+                            JointAngleKey(0, 4), -gtsam::I_1x1,
+                            gtsam::Vector1(0.5))));
+
+  size_t iterations = 0;
+  const gtsam::VectorValues expected = linear->optimize();
+  const gtsam::VectorValues actual =
+      SolveSlicePCG(*linear, SlicePCGParameters(), &iterations);
+  EXPECT(assert_equal(expected, actual, 1e-7));
+  EXPECT(iterations > 0);
+
+  // Tolerances and iterations are those of the parameters.
+  SlicePCGParameters few;
+  few.setMaxIterations(2);
+  SolveSlicePCG(*linear, few, &iterations);
+  EXPECT_LONGS_EQUAL(2, iterations);
+}
+
+TEST(SlicePCG, unsupported) {
+  gtsam::GaussianFactorGraph graph;
+  graph.emplace_shared<gtsam::JacobianFactor>(
+      JointAngleKey(0, 0), gtsam::I_1x1, gtsam::Vector1(1),
+      gtsam::noiseModel::Constrained::All(1));
+  THROWS_EXCEPTION(SolveSlicePCG(graph, SlicePCGParameters()));
+
+  // A variable without any information makes its slice block singular.
+  gtsam::GaussianFactorGraph singular;
+  singular.emplace_shared<gtsam::JacobianFactor>(
+      JointAngleKey(0, 0), gtsam::I_1x1, JointAngleKey(1, 0), gtsam::I_1x1,
+      gtsam::Vector1(1));
+  THROWS_EXCEPTION(SolveSlicePCG(singular, SlicePCGParameters()));
+}
+
+// LM with the solver finds the result of LM with direct solves.
+TEST(SlicePCG, levenbergMarquardt) {
+  Values initial;
+  const NonlinearFactorGraph graph = Chain(20, &initial);
+  gtsam::LevenbergMarquardtParams params;
+  params.setRelativeErrorTol(1e-10);
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(graph, initial, params).optimize();
+
+  params.linearSolverType = gtsam::NonlinearOptimizerParams::Iterative;
+  params.iterativeParams = boost::make_shared<SlicePCGParameters>();
+  StructuredLevenbergMarquardt optimizer(
+      graph, initial, params, std::make_shared<SymbolicStructure>());
+  EXPECT(assert_equal(expected, optimizer.optimize(), 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
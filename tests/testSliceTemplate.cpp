@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSliceTemplate.cpp
+ * @brief Test time shifting of slice factors.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/JointLimitFactor.h>
+#include <gtdynamics/factors/PoseFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/SliceTemplate.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// Keys of NoiseModelFactorN factors are shifted, values are read from them.
+TEST(SliceTemplate, ShiftTime) {
+  auto cost_model = gtsam::noiseModel::Unit::Create(1);
+  gtsam::NonlinearFactor::shared_ptr factor =
+      boost::make_shared<JointLimitFactor>(JointAngleKey(2, 3), cost_model,
+                                           -1.0, 1.0, 0.0);
+  EXPECT(IsTimeShiftable(factor));
+
+  auto shifted = ShiftTime(factor, 4);
+  EXPECT(shifted->keys().size() == 1);
+  EXPECT(shifted->keys()[0] == gtsam::Key(JointAngleKey(2, 7)));
+
+  Values values;
+  InsertJointAngle(&values, 2, 7, 1.5);
+  EXPECT(assert_equal(0.125, shifted->error(values), 1e-9));
+}
+
+// Expression factors are not shifted.
+TEST(SliceTemplate, ExpressionFactor) {
+  auto robot = simple_urdf::getRobot();
+  auto factor = PoseFactor(gtsam::noiseModel::Unit::Create(6),
+                           robot.joint("j1"), 0);
+  EXPECT(!IsTimeShiftable(factor));
+}
+
+// Rekeying is opt-in: factor types that are not known to read their values
+// through keys() are not shifted.
+TEST(SliceTemplate, OptIn) {
+  auto cost_model = gtsam::noiseModel::Unit::Create(1);
+  gtsam::NonlinearFactor::shared_ptr factor =
+      boost::make_shared<gtsam::BetweenFactor<double>>(
+          JointAngleKey(1, 0), JointAngleKey(2, 0), 0.0, cost_model);
+  EXPECT(!IsTimeShiftable(factor));
+  THROWS_EXCEPTION(ShiftTime(factor, 1));
+}
+
+// Keys that are not DynamicsSymbols of a time step are rejected.
+TEST(SliceTemplate, NotDynamicsSymbol) {
+  auto cost_model = gtsam::noiseModel::Unit::Create(1);
+  gtsam::NonlinearFactor::shared_ptr symbol_prior =
+      boost::make_shared<gtsam::PriorFactor<double>>(gtsam::Symbol('x', 1),
+                                                     0.0, cost_model);
+  EXPECT(!IsTimeShiftable(symbol_prior));
+  THROWS_EXCEPTION(ShiftTime(symbol_prior, 1));
+
+  gtsam::NonlinearFactor::shared_ptr integer_prior =
+      boost::make_shared<gtsam::PriorFactor<double>>(5, 0.0, cost_model);
+  EXPECT(!IsTimeShiftable(integer_prior));
+
+  gtsam::NonlinearFactor::shared_ptr mixed = boost::make_shared<
+      gtsam::BetweenFactor<double>>(JointAngleKey(1, 0), gtsam::Symbol('x', 1),
+                                    0.0, cost_model);
+  THROWS_EXCEPTION(ShiftTime(mixed, 1));
+}
+
+// The template gives the same factors as the builder.
+TEST(SliceTemplate, at) {
+  auto cost_model = gtsam::noiseModel::Unit::Create(1);
+  auto builder = [&](int t) {
+    NonlinearFactorGraph graph;
+    graph.addPrior<double>(JointAngleKey(1, t), 0.5, cost_model);
+    graph.emplace_shared<JointLimitFactor>(JointVelKey(1, t), cost_model, -1.0,
+                                           1.0, 0.0);
+    return graph;
+  };
+  SliceTemplate slice(builder, 0);
+  EXPECT(slice.shiftable());
+
+  const NonlinearFactorGraph expected = builder(5);
+  const NonlinearFactorGraph actual = slice.at(5);
+  EXPECT(assert_equal(expected.keys(), actual.keys()));
+
+  Values values;
+  InsertJointAngle(&values, 1, 5, 0.2);
+  InsertJointVel(&values, 1, 5, -1.2);
+  EXPECT(assert_equal(expected.error(values), actual.error(values), 1e-9));
+}
+
+// Slices with expression factors fall back to the builder.
+TEST(SliceTemplate, dynamicsFactorGraph) {
+  auto robot = simple_urdf::getRobot();
+  DynamicsGraph graph_builder;
+  SliceTemplate slice(
+      [&](int t) { return graph_builder.dynamicsFactorGraph(robot, t); });
+  EXPECT(!slice.shiftable());
+  EXPECT(assert_equal(graph_builder.dynamicsFactorGraph(robot, 3).keys(),
+                      slice.at(3).keys()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
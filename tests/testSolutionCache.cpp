@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSolutionCache.cpp
+ * @brief Test the cache of solved trajectories.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/SolutionCache.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector1;
+using gtsam::Vector6;
+
+using namespace gtdynamics;
+
+// Solution of a two-phase task, with the joint angle equal to the time step
+// plus an offset.
+static Values Solution(const std::vector<int> &phase_steps, double offset) {
+  Values values;
+  const int K = phase_steps[0] + phase_steps[1];
+  for (int k = 0; k <= K; k++) {
+    InsertJointAngle(&values, 0, k, k + offset);
+    InsertPose(&values, 1, k,
+               Pose3(gtsam::Rot3::Rz(k), gtsam::Point3(k, 0, 0)));
+    InsertTwist(&values, 1, k, Vector6::Constant(k));
+  }
+  values.insert(PhaseKey(0), 0.1);
+  values.insert(PhaseKey(1), 0.2);
+  return values;
+}
+
+TEST(SolutionCache, Retime) {
+  // Twice as many steps in the first phase.
+  const Values retimed = RetimeSolution(Solution({2, 3}, 0), {2, 3}, {4, 3});
+  EXPECT_LONGS_EQUAL(3 * 8 + 2, retimed.size());
+  EXPECT_DOUBLES_EQUAL(0.05, retimed.atDouble(PhaseKey(0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.2, retimed.atDouble(PhaseKey(1)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1, JointAngle(retimed, 0, 2), 1e-9);
+  EXPECT_DOUBLES_EQUAL(2, JointAngle(retimed, 0, 4), 1e-9);
+  EXPECT_DOUBLES_EQUAL(3, JointAngle(retimed, 0, 5), 1e-9);
+  EXPECT_DOUBLES_EQUAL(5, JointAngle(retimed, 0, 7), 1e-9);
+  EXPECT(assert_equal(Vector6::Constant(5), Twist(retimed, 1, 7)));
+
+  THROWS_EXCEPTION(RetimeSolution(Solution({2, 3}, 0), {2, 3}, {5}));
+}
+
+TEST(SolutionCache, Nearest) {
+  const std::vector<std::string> contacts = {"l1,l2", "l1"};
+  SolutionCache cache;
+  for (double goal : {0.0, 1.0, 2.0}) {
+    cache.insert(TaskDescriptor("rr", {2, 3}, contacts, Vector1(goal)),
+                 Solution({2, 3}, goal));
+  }
+  EXPECT_LONGS_EQUAL(3, cache.size());
+
+  double distance;
+  const TaskDescriptor task("rr", {4, 3}, contacts, Vector1(1.2));
+  const SolutionCache::Entry *entry = cache.nearest(task, &distance);
+  CHECK(entry);
+  EXPECT(assert_equal(Vector1(1.0), entry->task.boundary));
+  EXPECT_DOUBLES_EQUAL(0.2, distance, 1e-9);
+
+  // The warm start is re-keyed to the time steps of the task.
+  const auto init = cache.warmStart(task);
+  CHECK(init);
+  EXPECT_DOUBLES_EQUAL(2 + 1, JointAngle(*init, 0, 4), 1e-9);
+  EXPECT(init->exists(PoseKey(1, 7)));
+  EXPECT(!cache.warmStart(task, 0.1));
+
+  // Tasks with other contacts or robots have no warm start.
+  EXPECT(!cache.nearest(TaskDescriptor("rr", {2, 3}, {"l1", "l1"},
+                                       Vector1(1.0))));
+  EXPECT(!cache.warmStart(TaskDescriptor("rrr", {2, 3}, contacts,
+                                         Vector1(1.0))));
+  THROWS_EXCEPTION(cache.insert(
+      TaskDescriptor("rr", {2, 3}, contacts, gtsam::Vector2(1, 2)), Values()));
+}
+
+TEST(SolutionCache, SaveLoad) {
+  const std::vector<std::string> contacts = {"l1,l2", "l1"};
+  SolutionCache cache;
+  cache.insert(TaskDescriptor("rr", {2, 3}, contacts, Vector1(0.0)),
+               Solution({2, 3}, 0.0));
+  cache.insert(TaskDescriptor("rr", {2, 2}, {"", ""}, Vector1(1.0)),
+               Solution({2, 2}, 1.0));
+  cache.save("testSolutionCache.bin");
+
+  const SolutionCache loaded = SolutionCache::Load("testSolutionCache.bin");
+  EXPECT_LONGS_EQUAL(2, loaded.size());
+  const TaskDescriptor task("rr", {2, 3}, contacts, Vector1(0.0));
+  const SolutionCache::Entry *entry = loaded.nearest(task);
+  CHECK(entry);
+  EXPECT(assert_equal(Solution({2, 3}, 0.0), entry->solution));
+  EXPECT(entry->task.phase_steps == task.phase_steps);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSolveCheckpoint.cpp
+ * @brief Test checkpointing and resuming solves.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
+#include <gtdynamics/optimizer/SolveCheckpoint.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+using namespace constrained_example;
+
+// The constrained example of testPenaltyMethodOptimizer.cpp.
+NonlinearFactorGraph Graph() {
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  NonlinearFactorGraph graph;
+  graph.add(gtsam::ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(gtsam::ExpressionFactor<double>(
+      cost_noise, 0., pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+EqualityConstraints Constraints() {
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 1.0);
+  return constraints;
+}
+
+Values Initial() {
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, -0.2);
+  return values;
+}
+}  // namespace example
+
+TEST(SolveCheckpoint, saveLoad) {
+  const std::string path = "testSolveCheckpoint.bin";
+  SolveCheckpoint checkpoint;
+  checkpoint.solver = "AugmentedLagrangian";
+  checkpoint.values = example::Initial();
+  checkpoint.iterations = 3;
+  checkpoint.mu = 4.0;
+  checkpoint.lambda = 1e-3;
+  checkpoint.multipliers.push_back(gtsam::Vector2(1, 2));
+  SaveSolveCheckpoint(checkpoint, path);
+  EXPECT(!std::ifstream(path + ".partial").good());
+
+  auto loaded = LoadSolveCheckpoint(path, "AugmentedLagrangian",
+                                    example::Initial());
+  CHECK(loaded);
+  EXPECT(assert_equal(checkpoint.values, loaded->values));
+  EXPECT_LONGS_EQUAL(3, loaded->iterations);
+  EXPECT_DOUBLES_EQUAL(4.0, loaded->mu, 0);
+  EXPECT_DOUBLES_EQUAL(1e-3, loaded->lambda, 0);
+  EXPECT(assert_equal(gtsam::Vector(gtsam::Vector2(1, 2)),
+                      loaded->multipliers.at(0)));
+
+  // Checkpoints of other solvers or problems are not resumed.
+  THROWS_EXCEPTION(
+      LoadSolveCheckpoint(path, "PenaltyMethod", example::Initial()));
+  Values other = example::Initial();
+  other.insert(gtsam::Symbol('x', 3), 0.0);
+  THROWS_EXCEPTION(LoadSolveCheckpoint(path, "AugmentedLagrangian", other));
+  std::ofstream(path) << "not a checkpoint";
+  THROWS_EXCEPTION(
+      LoadSolveCheckpoint(path, "AugmentedLagrangian", example::Initial()));
+  std::remove(path.c_str());
+  EXPECT(!LoadSolveCheckpoint(path, "AugmentedLagrangian", example::Initial()));
+}
+
+TEST(SolveCheckpoint, penaltyMethod) {
+  const std::string path = "testSolveCheckpoint_penalty.bin";
+  std::remove(path.c_str());
+  PenaltyMethodParameters params;
+  const Values expected = PenaltyMethodOptimizer(params).optimize(
+      example::Graph(), example::Constraints(), example::Initial());
+
+  // Interrupted after 4 outer iterations, then resumed to the end.
+  params.checkpoint_path = path;
+  params.checkpoint_interval = 2;
+  params.num_iterations = 4;
+  PenaltyMethodOptimizer(params).optimize(
+      example::Graph(), example::Constraints(), example::Initial());
+  EXPECT_LONGS_EQUAL(
+      4, LoadSolveCheckpoint(path, "PenaltyMethod", example::Initial())
+             ->iterations);
+  params.num_iterations = PenaltyMethodParameters().num_iterations;
+  ConstrainedOptResult result;
+  const Values resumed = PenaltyMethodOptimizer(params).optimize(
+      example::Graph(), example::Constraints(), example::Initial(), &result);
+  EXPECT_LONGS_EQUAL(params.num_iterations - 4, result.num_iters.size());
+  EXPECT(assert_equal(expected, resumed, 1e-9));
+  std::remove(path.c_str());
+}
+
+TEST(SolveCheckpoint, augmentedLagrangian) {
+  const std::string path = "testSolveCheckpoint_al.bin";
+  std::remove(path.c_str());
+  AugmentedLagrangianParameters params;
+  const Values expected = AugmentedLagrangianOptimizer(params).optimize(
+      example::Graph(), example::Constraints(), example::Initial());
+
+  params.checkpoint_path = path;
+  params.num_iterations = 5;
+  AugmentedLagrangianOptimizer(params).optimize(
+      example::Graph(), example::Constraints(), example::Initial());
+  params.num_iterations = AugmentedLagrangianParameters().num_iterations;
+  const Values resumed = AugmentedLagrangianOptimizer(params).optimize(
+      example::Graph(), example::Constraints(), example::Initial());
+  EXPECT(assert_equal(expected, resumed, 1e-9));
+
+  // A finished solve resumes to its result.
+  EXPECT(assert_equal(expected,
+                      AugmentedLagrangianOptimizer(params).optimize(
+                          example::Graph(), example::Constraints(),
+                          example::Initial()),
+                      1e-9));
+  std::remove(path.c_str());
+}
+
+TEST(SolveCheckpoint, optimizer) {
+  const std::string path = "testSolveCheckpoint_lm.bin";
+  std::remove(path.c_str());
+  OptimizationParameters params;
+  params.lm_parameters.setlambdaInitial(1.0);
+  params.lm_parameters.setAbsoluteErrorTol(0);
+  params.lm_parameters.setRelativeErrorTol(0);
+  params.lm_parameters.setMaxIterations(8);
+  const Values expected = Optimizer(params).optimize(
+      example::Graph(), example::Constraints(), example::Initial());
+
+  // Dense and sparse LM, interrupted after 3 iterations.
+  for (size_t dense_dimension : {64, 0}) {
+    params.dense_dimension = dense_dimension;
+    params.checkpoint_path = path;
+    params.lm_parameters.setMaxIterations(3);
+    Optimizer(params).optimize(example::Graph(), example::Constraints(),
+                               example::Initial());
+    EXPECT_LONGS_EQUAL(3, LoadSolveCheckpoint(path, "LevenbergMarquardt",
+                                              example::Initial())
+                              ->iterations);
+    params.lm_parameters.setMaxIterations(8);
+    const Values resumed = Optimizer(params).optimize(
+        example::Graph(), example::Constraints(), example::Initial());
+    EXPECT(assert_equal(expected, resumed, 1e-6));
+    std::remove(path.c_str());
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
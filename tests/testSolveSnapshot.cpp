@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSolveSnapshot.cpp
+ * @brief Test capturing, saving and replaying solves.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/optimizer/SolveSnapshot.h>
+#include <gtdynamics/optimizer/SolverProfile.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// Torques of a chain pulled to a prior, with the last one constrained.
+static SolveSnapshot Example() {
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.5);
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(TorqueKey(0, 0), 1.0, model);
+  Values initial;
+  for (int t = 0; t < 3; t++) {
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        TorqueKey(0, t), TorqueKey(0, t + 1), 0.5, model);
+    graph.emplace_shared<MinTorqueFactor>(TorqueKey(0, t),
+                                          gtsam::noiseModel::Unit::Create(1));
+    InsertTorque(&initial, 0, t, 0.1 * t);
+  }
+  InsertTorque(&initial, 0, 3, 0.0);
+
+  EqualityConstraints constraints;
+  constraints.emplace_shared<FactorEquality>(
+      boost::make_shared<gtsam::PriorFactor<double>>(
+          TorqueKey(0, 3), 2.0, gtsam::noiseModel::Isotropic::Sigma(1, 1e-3)));
+
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  parameters.lm_parameters.setMaxIterations(20);
+  parameters.lm_parameters.setOrdering(
+      gtsam::Ordering{TorqueKey(0, 3), TorqueKey(0, 2), TorqueKey(0, 1),
+                      TorqueKey(0, 0)});
+  parameters.dense_dimension = 0;
+  return SolveSnapshot(graph, constraints, initial, parameters);
+}
+
+TEST(SolveSnapshot, saveLoad) {
+  const std::string path = "testSolveSnapshot.bin";
+  const SolveSnapshot snapshot = Example();
+  SaveSolveSnapshot(snapshot, path);
+  const SolveSnapshot loaded = LoadSolveSnapshot(path);
+  std::remove(path.c_str());
+
+  EXPECT(snapshot.graph.equals(loaded.graph));
+  EXPECT(snapshot.constraint_factors.equals(loaded.constraint_factors));
+  EXPECT(assert_equal(snapshot.initial_values, loaded.initial_values));
+  EXPECT_LONGS_EQUAL(1, loaded.constraints().size());
+  const OptimizationParameters& p = loaded.parameters;
+  EXPECT(p.method == OptimizationParameters::Method::AUGMENTED_LAGRANGIAN);
+  EXPECT_LONGS_EQUAL(20, p.lm_parameters.maxIterations);
+  EXPECT_LONGS_EQUAL(0, p.dense_dimension);
+  EXPECT(p.lm_parameters.ordering &&
+         p.lm_parameters.ordering->equals(
+             *snapshot.parameters.lm_parameters.ordering));
+  EXPECT_DOUBLES_EQUAL(snapshot.parameters.lm_parameters.lambdaInitial,
+                       p.lm_parameters.lambdaInitial, 0);
+
+  // The replay solves the same problem.
+  OptimizationStatus expected_status, status;
+  const Values expected = snapshot.solve(&expected_status);
+  EXPECT(assert_equal(expected, loaded.solve(&status), 1e-9));
+  EXPECT(status.feasible);
+  EXPECT_DOUBLES_EQUAL(2.0, Torque(expected, 0, 3), 1e-2);
+
+  // Under every profile.
+  for (SolverProfile profile : AvailableSolverProfiles()) {
+    OptimizationParameters parameters = loaded.parameters;
+    SetSolverProfile(profile, &parameters);
+    EXPECT(assert_equal(expected, loaded.solve(parameters), 1e-3));
+  }
+
+  THROWS_EXCEPTION(LoadSolveSnapshot("no_such_snapshot.bin"));
+  std::ofstream(path) << "not a snapshot";
+  THROWS_EXCEPTION(LoadSolveSnapshot(path));
+  std::remove(path.c_str());
+}
+
+TEST(SolveSnapshot, capture) {
+  const std::string path = "testSolveSnapshot_capture.bin";
+  std::remove(path.c_str());
+  const SolveSnapshot snapshot = Example();
+  OptimizationParameters parameters = snapshot.parameters;
+  parameters.snapshot_path = path;
+  parameters.hard_sigma = 1e-2;
+  const Values result = Optimizer(parameters).optimize(
+      snapshot.graph, snapshot.constraints(), snapshot.initial_values);
+
+  // The problem is captured as given, before moving stiff factors, and
+  // replaying it does not capture again.
+  const SolveSnapshot captured = LoadSolveSnapshot(path);
+  std::remove(path.c_str());
+  EXPECT(snapshot.graph.equals(captured.graph));
+  EXPECT_LONGS_EQUAL(1, captured.constraint_factors.size());
+  EXPECT(captured.parameters.snapshot_path.empty());
+  EXPECT_DOUBLES_EQUAL(1e-2, captured.parameters.hard_sigma, 0);
+  EXPECT(assert_equal(result, captured.solve(), 1e-9));
+  EXPECT(!std::ifstream(path).good());
+}
+
+TEST(SolveSnapshot, unsupported) {
+  // Expression constraints can not be captured.
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      gtsam::Double_(TorqueKey(0, 0)), 1.0);
+  THROWS_EXCEPTION(SolveSnapshot(NonlinearFactorGraph(), constraints,
+                                 Values(), OptimizationParameters()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
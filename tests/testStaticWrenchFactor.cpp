@@ -66,6 +66,46 @@ TEST(StaticWrenchFactor, GravityCompensation) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, x, diffDelta, tol);
 }
 
+// The fixed-arity factors agree with the generic one, for any pose.
+TEST(FixedStaticWrenchFactor, MatchesGeneric) {
+  const int id = 0;
+  const double M = example::mass;
+  Values x;
+  std::vector<DynamicsSymbol> keys;
+  for (int j = 1; j <= 4; j++) {
+    keys.push_back(WrenchKey(id, j));
+    InsertWrench(&x, id, j, (Vector(6) << j, -1, 2, 0.5, M * j, -j).finished());
+  }
+  InsertPose(&x, id, Pose3(Rot3::RzRyRx(0.1, 0.2, -0.3), Point3(1, 0, 0)));
+
+  for (size_t n = 1; n <= 4; n++) {
+    const std::vector<DynamicsSymbol> wrench_keys(keys.begin(),
+                                                  keys.begin() + n);
+    StaticWrenchFactor generic(wrench_keys, PoseKey(id), example::cost_model,
+                               M, example::gravity);
+    auto fixed = CreateStaticWrenchFactor(wrench_keys, PoseKey(id),
+                                          example::cost_model, M,
+                                          example::gravity);
+    auto noise_factor =
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(fixed);
+    CHECK(noise_factor);
+    EXPECT(assert_equal(generic.unwhitenedError(x),
+                        noise_factor->unwhitenedError(x), 1e-9));
+    EXPECT(assert_equal(*generic.linearize(x), *fixed->linearize(x), 1e-9));
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*noise_factor, x, diffDelta, tol);
+  }
+
+  // Without gravity the pose Jacobian is zero.
+  FixedStaticWrenchFactor<2> factor({WrenchKey(id, 1), WrenchKey(id, 2)},
+                                    PoseKey(id), example::cost_model, M);
+  std::vector<Matrix> H;
+  factor.unwhitenedError(x, H);
+  EXPECT(assert_equal(Matrix(Z_6x6), H[2]));
+  EXPECT(assert_equal(Matrix(I_6x6), H[0]));
+  THROWS_EXCEPTION(FixedStaticWrenchFactor<3>({WrenchKey(id, 1)}, PoseKey(id),
+                                              example::cost_model, M));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -12,9 +12,13 @@
  */
 
 #include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/statics/LinearStaticsSolver.h>
 #include <gtdynamics/statics/Statics.h>
 #include <gtdynamics/universal_robot/RevoluteJoint.h>
 
+#include <cmath>
+#include <vector>
+
 #include "contactGoalsExample.h"
 
 using namespace gtdynamics;
@@ -95,6 +99,34 @@ TEST(Statics, OneMovingLink) {
   EXPECT_DOUBLES_EQUAL(
       5, joint->transformWrenchToTorque(joint->child(), actualWrench), kTol);
   EXPECT_DOUBLES_EQUAL(expected_tau, Torque(result, joint->id(), k), 1e-5);
+
+  // The linear solve gives the same wrenches and torques.
+  auto linear = statics.linearSolveStatics(slice, robot, fk_solution);
+  EXPECT(assert_equal(expectedWrench,
+                      Wrench(linear, joint->child()->id(), joint->id(), k),
+                      kTol));
+  EXPECT_DOUBLES_EQUAL(expected_tau, Torque(linear, joint->id(), k), kTol);
+
+  // A cached solver can be reused for other configurations.
+  LinearStaticsSolver solver(robot, slice, parameters2D);
+  for (double angle : {0.0, M_PI / 6, M_PI / 2, 2.0}) {
+    Values angles;
+    InsertJointAngle(&angles, joint->id(), k, angle);
+    auto solution = solver.solve(robot.forwardKinematics(angles, k));
+    EXPECT_DOUBLES_EQUAL(mass * g * L / 2 * std::cos(angle),
+                         Torque(solution, joint->id(), k), kTol);
+  }
+
+  // Or solve them all at once.
+  const Matrix qs = (Matrix(1, 4) << 0.0, M_PI / 6, M_PI / 2, 2.0).finished();
+  const auto batch = solver.solveBatch(qs);
+  EXPECT_LONGS_EQUAL(4, batch.feasible.size());
+  for (size_t s = 0; s < 4; s++) {
+    EXPECT_DOUBLES_EQUAL(mass * g * L / 2 * std::cos(qs(0, s)),
+                         batch.torques(0, s), kTol);
+    EXPECT(batch.errors(s) < 1e-6);
+    EXPECT(batch.feasible[s]);
+  }
 }
 
 // Do test with Quadruped and desired contact goals.
@@ -128,6 +160,17 @@ TEST(Statics, Quadruped) {
   result.print("", GTDKeyFormatter);
   // EXPECT_DOUBLES_EQUAL(0.0670426, Torque(result, 0, k), 1e-5);
 
+  // Solve linearly with the feet supported by the ground, so that the trunk
+  // is balanced by the legs.
+  const std::vector<int> feet = {LH->id(), LF->id(), RF->id(), RH->id()};
+  auto linear = statics.linearSolveStatics(slice, robot, ik_solution, feet);
+  EXPECT_LONGS_EQUAL(61, linear.size());
+  auto supported_graph = statics.staticWrenchFactors(slice, robot, feet);
+  EXPECT_LONGS_EQUAL(9, supported_graph.size());
+  supported_graph.add(statics.wrenchEquivalenceFactors(slice, robot));
+  supported_graph.add(statics.torqueFactors(slice, robot));
+  EXPECT(supported_graph.error(linear) < 1e-3);
+
   // Optimize kinematics while minimizing torque
   auto minimal = statics.minimizeTorques(slice, robot);
   EXPECT_LONGS_EQUAL(61, minimal.size());
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testStreamingSmoother.cpp
+ * @brief Test the fixed-lag smoother and the legged estimator built on it.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/LeggedEstimator.h>
+#include <gtdynamics/optimizer/StreamingSmoother.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::symbol_shorthand::X;
+
+// On a linear chain, marginalization is exact: the latest estimate is the
+// one of the batch solution, with a bounded window.
+TEST(StreamingSmoother, chain) {
+  StreamingSmootherParams params;
+  params.lag = 0.35;
+  StreamingSmoother smoother(params);
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.5);
+
+  NonlinearFactorGraph batch;
+  Values initial;
+  const int num_steps = 200;
+  for (int k = 0; k < num_steps; k++) {
+    NonlinearFactorGraph factors;
+    factors.addPrior<double>(X(k), k + 0.1 * (k % 3), model);
+    if (k > 0) {
+      factors.emplace_shared<gtsam::BetweenFactor<double>>(X(k - 1), X(k),
+                                                           1.0, model);
+    }
+    Values values;
+    values.insert(X(k), 0.0);
+    smoother.update(factors, values, {{X(k), 0.1 * k}});
+    batch.push_back(factors);
+    initial.insert(X(k), 0.0);
+    EXPECT(smoother.numVariables() <= 5);
+  }
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(batch, initial).optimize();
+  EXPECT_DOUBLES_EQUAL(expected.at<double>(X(num_steps - 1)),
+                       smoother.calculateEstimate<double>(X(num_steps - 1)),
+                       1e-6);
+  EXPECT(!smoother.calculateEstimate().exists(X(0)));
+  EXPECT_DOUBLES_EQUAL(0.1 * (num_steps - 1), smoother.latestTime(), 1e-9);
+
+  // Empty slots are reclaimed.
+  EXPECT(smoother.numCompactions() > 0);
+  EXPECT(smoother.numFactorSlots() <=
+         params.compaction_ratio * smoother.isam().getFactorsUnsafe()
+                                       .nrFactors());
+  EXPECT(smoother.maxUpdateSeconds() >= smoother.lastUpdateSeconds());
+
+  // New variables need a timestamp.
+  Values values;
+  values.insert(X(num_steps), 0.0);
+  THROWS_EXCEPTION(smoother.update(NonlinearFactorGraph(), values));
+}
+
+// A standing robot keeps its base pose, with a bounded window.
+TEST(LeggedEstimator, standing) {
+  const Robot robot = simple_rr::getRobot();
+  const gtsam::Pose3 wTbase(gtsam::Rot3::Rz(0.2), gtsam::Point3(1, 2, 0.5));
+  LeggedEstimatorParams params;
+  params.smoother.lag = 0.05;
+  LeggedEstimator estimator(robot, "link_0", wTbase, params);
+  EXPECT_LONGS_EQUAL(-1, estimator.currentStep());
+
+  const gtsam::Vector angles = (gtsam::Vector(2) << 0.3, -0.4).finished();
+  const double dt = 0.01;
+  for (int k = 0; k < 30; k++) {
+    EXPECT_LONGS_EQUAL(k, estimator.update(k * dt, angles, {"link_2"}));
+    EXPECT(estimator.smoother().numVariables() <= 3 * 7);
+  }
+  EXPECT(assert_equal(wTbase, estimator.basePose(), 1e-3));
+  const gtsam::Pose3 wTfoot = estimator.linkPose("link_2", 29);
+  EXPECT(assert_equal(wTfoot, estimator.linkPose("link_2", 28), 1e-4));
+  THROWS_EXCEPTION(estimator.linkPose("link_2", 0));
+
+  // Times increase, and every joint has a reading.
+  THROWS_EXCEPTION(estimator.update(0.0, angles, {}));
+  THROWS_EXCEPTION(estimator.update(1.0, gtsam::Vector::Zero(1), {}));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
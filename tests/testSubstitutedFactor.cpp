@@ -0,0 +1,138 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSubstitutedFactor.cpp
+ * @brief Test pruning pinned variables out of factor graphs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/SubstitutedFactor.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/Initializer.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/GaussNewtonOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+auto constrained = gtsam::noiseModel::Constrained::All(1);
+
+// A hard prior on q0 and soft factors on q0 + q1 and q1.
+NonlinearFactorGraph Graph() {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, 0), 1.0,
+                                                   constrained);
+  gtsam::Double_ q0(JointAngleKey(0, 0)), q1(JointAngleKey(0, 1));
+  graph.emplace_shared<gtsam::ExpressionFactor<double>>(model, 3.0, q0 + q1);
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, 1), 1.0,
+                                                   model);
+  return graph;
+}
+}  // namespace example
+
+using namespace example;
+
+TEST(SubstitutedFactor, linearize) {
+  const NonlinearFactorGraph graph = Graph();
+  Values known, values;
+  known.insert(JointAngleKey(0, 0), 1.0);
+  values.insert(JointAngleKey(0, 1), 0.5);
+  Values all = values;
+  all.insert(known);
+
+  SubstitutedFactor factor(graph.at(1), known);
+  EXPECT(factor.keys() == gtsam::KeyVector{JointAngleKey(0, 1)});
+  EXPECT_DOUBLES_EQUAL(graph.at(1)->error(all), factor.error(values), 1e-9);
+
+  auto expected = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+      graph.at(1)->linearize(all));
+  auto actual = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+      factor.linearize(values));
+  CHECK(expected && actual);
+  EXPECT(assert_equal(expected->getA(expected->find(JointAngleKey(0, 1))),
+                      actual->getA(actual->begin())));
+  EXPECT(assert_equal(expected->getb(), actual->getb()));
+
+  // Substituting again keeps the original factor.
+  SubstitutedFactor twice(boost::make_shared<SubstitutedFactor>(factor),
+                          Values());
+  EXPECT(twice.factor() == graph.at(1));
+  EXPECT_LONGS_EQUAL(1, twice.known().size());
+}
+
+TEST(SubstitutedFactor, PruneHardPriors) {
+  const NonlinearFactorGraph graph = Graph();
+  const PrunedGraph pruned = PruneHardPriors(graph);
+  EXPECT_LONGS_EQUAL(1, pruned.pinned.size());
+  EXPECT_DOUBLES_EQUAL(1.0, pruned.pinned.at<double>(JointAngleKey(0, 0)),
+                       1e-9);
+  EXPECT_LONGS_EQUAL(2, pruned.graph.size());
+  EXPECT_LONGS_EQUAL(1, pruned.graph.keys().size());
+
+  Values initial;
+  initial.insert(JointAngleKey(0, 0), 0.0);
+  initial.insert(JointAngleKey(0, 1), 0.0);
+  EXPECT_LONGS_EQUAL(1, pruned.free(initial).size());
+
+  // q1 balances q0 + q1 = 3 and q1 = 1 with equal weights.
+  gtsam::GaussNewtonOptimizer optimizer(pruned.graph, pruned.free(initial));
+  const Values result = pruned.restore(optimizer.optimize());
+  EXPECT_DOUBLES_EQUAL(1.0, result.at<double>(JointAngleKey(0, 0)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1.5, result.at<double>(JointAngleKey(0, 1)), 1e-9);
+}
+
+// Forward dynamics of a two-link robot with the link poses and twists pinned
+// by stiff priors: the pruned graph has the same solution on fewer variables.
+TEST(SubstitutedFactor, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  const size_t t = 0;
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  auto graph = graph_builder.dynamicsFactorGraph(robot, t);
+  Values known_values = zero_values(robot, t);
+  for (auto&& joint : robot.joints()) {
+    InsertTorque(&known_values, joint->id(), t, 1.0);
+  }
+  graph.add(graph_builder.forwardDynamicsPriors(robot, t, known_values));
+  for (auto link : robot.links()) {
+    int i = link->id();
+    graph.addPrior(PoseKey(i, t), link->bMcom(),
+                   graph_builder.opt().bp_cost_model);
+    graph.addPrior<gtsam::Vector6>(TwistKey(i, t), gtsam::Z_6x1,
+                                   graph_builder.opt().bv_cost_model);
+  }
+
+  const PrunedGraph pruned = PruneHardPriors(graph, 1e-4);
+  EXPECT_LONGS_EQUAL(2 * robot.numLinks(), pruned.pinned.size());
+  EXPECT(pruned.graph.size() < graph.size());
+  EXPECT(pruned.graph.keys().size() + pruned.pinned.size() ==
+         graph.keys().size());
+
+  Initializer initializer;
+  const Values initial = initializer.ZeroValues(robot, t);
+  gtsam::GaussNewtonOptimizer optimizer(pruned.graph, pruned.free(initial));
+  const Values result = pruned.restore(optimizer.optimize());
+  gtsam::Vector expected_qAccel = (gtsam::Vector(1) << 4).finished();
+  EXPECT(assert_equal(expected_qAccel,
+                      DynamicsGraph::jointAccels(robot, result, t), 1e-3));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
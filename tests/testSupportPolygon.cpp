@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSupportPolygon.cpp
+ * @brief Test support polygons and static stability margins.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/SupportPolygon.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using gtsam::assert_equal;
+using gtsam::Point2;
+using gtsam::Point3;
+
+using namespace gtdynamics;
+
+TEST(ConvexHull, square) {
+  // Corners of the unit square, with an inside and an edge point.
+  const std::vector<Point2> hull =
+      ConvexHull({Point2(1, 1), Point2(0.5, 0.5), Point2(0, 0), Point2(1, 0),
+                  Point2(0.5, 0), Point2(0, 1), Point2(1, 1)});
+  EXPECT_LONGS_EQUAL(4, hull.size());
+  EXPECT(assert_equal(Point2(0, 0), hull[0]));
+  EXPECT(assert_equal(Point2(1, 0), hull[1]));
+  EXPECT(assert_equal(Point2(1, 1), hull[2]));
+  EXPECT(assert_equal(Point2(0, 1), hull[3]));
+
+  // Collinear points give a segment.
+  EXPECT_LONGS_EQUAL(
+      2, ConvexHull({Point2(0, 0), Point2(1, 1), Point2(2, 2)}).size());
+}
+
+TEST(SupportPolygon, margin) {
+  const SupportPolygon square(
+      {Point2(0, 0), Point2(2, 0), Point2(2, 2), Point2(0, 2)});
+  EXPECT_DOUBLES_EQUAL(4.0, square.area(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1.0, square.margin(Point2(1, 1)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.5, square.margin(Point2(1.5, 1)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0, square.margin(Point2(2, 1)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(-1.0, square.margin(Point2(3, 1)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(-std::sqrt(2.0), square.margin(Point2(3, 3)), 1e-9);
+  EXPECT(square.contains(Point2(0.1, 1.9)));
+  EXPECT(!square.contains(Point2(-0.1, 1)));
+
+  // Two contacts have no inside.
+  const SupportPolygon segment({Point2(0, 0), Point2(2, 0)});
+  EXPECT_DOUBLES_EQUAL(0.0, segment.area(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(-0.5, segment.margin(Point2(1, 0.5)), 1e-9);
+}
+
+TEST(SupportPolygon, spider) {
+  const Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  const Point3 contact_in_com(0, 0.19, 0);
+
+  gtsam::Values angles;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&angles, joint->id(), 0.0);
+  }
+  const gtsam::Values values = robot.forwardKinematics(angles);
+  const Point3 com = CenterOfMass(robot, values);
+
+  // Standing on all feet is stable, the margin is that of the polygon.
+  std::vector<LinkSharedPtr> feet;
+  for (auto &&name : {"tarsus_1_L1", "tarsus_2_L2", "tarsus_3_L3",
+                      "tarsus_4_L4", "tarsus_5_R4", "tarsus_6_R3",
+                      "tarsus_7_R2", "tarsus_8_R1"}) {
+    feet.push_back(robot.link(name));
+  }
+  const auto all_feet =
+      boost::make_shared<FootContactConstraintSpec>(feet, contact_in_com);
+  const SupportPolygon polygon(all_feet->contactPoints(), values);
+  EXPECT(polygon.vertices().size() >= 3);
+  const double margin = StaticStabilityMargin(robot, *all_feet, values);
+  EXPECT_DOUBLES_EQUAL(polygon.margin(Point2(com.x(), com.y())), margin,
+                       1e-9);
+  EXPECT(margin > 0);
+  EXPECT(IsStaticallyStable(robot, Phase(0, 1, all_feet), values, 0));
+  EXPECT(!IsStaticallyStable(robot, Phase(0, 1, all_feet), values, 0,
+                             margin + 1e-3));
+
+  // Standing on the left feet only is not.
+  const std::vector<LinkSharedPtr> left(feet.begin(), feet.begin() + 4);
+  const auto left_feet =
+      boost::make_shared<FootContactConstraintSpec>(left, contact_in_com);
+  EXPECT(!IsStaticallyStable(robot, Phase(0, 1, left_feet), values, 0));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSymbolicStructure.cpp
+ * @brief Test reuse of the symbolic structure across LM iterations, outer
+ * iterations and re-solves.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/Optimizer.h>
+#include <gtdynamics/optimizer/SymbolicStructure.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <memory>
+
+#include "constrainedExample.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace {
+// The constrained example: two cost factors, and one constraint.
+NonlinearFactorGraph Example(EqualityConstraints* constraints,
+                             Values* initial) {
+  using namespace constrained_example;
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  NonlinearFactorGraph graph;
+  graph.add(gtsam::ExpressionFactor<double>(model, 0., x1 + exp(-x2)));
+  graph.add(gtsam::ExpressionFactor<double>(
+      model, 0., pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  constraints->emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 1.0);
+  initial->insert(x1_key, -0.2);
+  initial->insert(x2_key, -0.2);
+  return graph;
+}
+}  // namespace
+
+// LM iterations share one ordering and variable index, with the same result.
+TEST(SymbolicStructure, levenbergMarquardt) {
+  EqualityConstraints constraints;
+  Values initial;
+  const NonlinearFactorGraph graph = Example(&constraints, &initial);
+  const gtsam::LevenbergMarquardtParams params;
+
+  auto structure = std::make_shared<SymbolicStructure>();
+  StructuredLevenbergMarquardt optimizer(graph, initial, params, structure);
+  const Values result = optimizer.optimize();
+  EXPECT(assert_equal(
+      gtsam::LevenbergMarquardtOptimizer(graph, initial, params).optimize(),
+      result, 1e-9));
+  EXPECT_LONGS_EQUAL(1, structure->numOrderings());
+  EXPECT_LONGS_EQUAL(1, structure->numIndices());
+  EXPECT(structure->numSolves() > 1);
+
+  // A different problem recomputes both.
+  NonlinearFactorGraph other = graph;
+  other.addPrior<double>(constrained_example::x1_key, 0.0,
+                         gtsam::noiseModel::Unit::Create(1));
+  StructuredLevenbergMarquardt(other, initial, params, structure).optimize();
+  EXPECT_LONGS_EQUAL(2, structure->numOrderings());
+  EXPECT_LONGS_EQUAL(2, structure->numIndices());
+}
+
+// Outer iterations of the augmented Lagrangian method and re-solves from
+// other initial values reuse the structure given in the parameters.
+TEST(SymbolicStructure, reSolve) {
+  EqualityConstraints constraints;
+  Values initial;
+  const NonlinearFactorGraph graph = Example(&constraints, &initial);
+
+  AugmentedLagrangianParameters al_parameters;
+  al_parameters.symbolic_structure = std::make_shared<SymbolicStructure>();
+  const AugmentedLagrangianOptimizer al_optimizer(al_parameters);
+  const Values expected =
+      AugmentedLagrangianOptimizer().optimize(graph, constraints, initial);
+  EXPECT(assert_equal(expected,
+                      al_optimizer.optimize(graph, constraints, initial),
+                      1e-9));
+  EXPECT_LONGS_EQUAL(1, al_parameters.symbolic_structure->numOrderings());
+  EXPECT_LONGS_EQUAL(1, al_parameters.symbolic_structure->numIndices());
+
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  parameters.symbolic_structure = std::make_shared<SymbolicStructure>();
+  const Optimizer optimizer(parameters);
+  const Values first = optimizer.optimize(graph, constraints, initial);
+  Values perturbed;
+  perturbed.insert(constrained_example::x1_key, 0.1);
+  perturbed.insert(constrained_example::x2_key, -0.1);
+  const Values second = optimizer.optimize(graph, constraints, perturbed);
+  EXPECT(assert_equal(first, second, 1e-3));
+  EXPECT_LONGS_EQUAL(1, parameters.symbolic_structure->numOrderings());
+  EXPECT_LONGS_EQUAL(1, parameters.symbolic_structure->numIndices());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTerrainHeightFactor.cpp
+ * @brief Test the heightmap and the terrain contact height factor.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/TerrainHeightFactor.h>
+#include <gtdynamics/utils/HeightMap.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <memory>
+
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+using namespace gtdynamics;
+
+namespace example {
+// A ramp z = 0.5 x + 0.25 y on a 5x4 grid with 0.5 m cells starting at (-1, 0).
+std::shared_ptr<HeightMap> Ramp() {
+  gtsam::Matrix heights(4, 5);
+  for (int iy = 0; iy < 4; iy++) {
+    for (int ix = 0; ix < 5; ix++) {
+      heights(iy, ix) = 0.5 * (-1 + 0.5 * ix) + 0.25 * (0.5 * iy);
+    }
+  }
+  return std::make_shared<HeightMap>(heights, -1.0, 0.0, 0.5);
+}
+}  // namespace example
+
+// Bilinear interpolation is exact on a plane, and clamps outside the map.
+TEST(HeightMap, height) {
+  auto map = example::Ramp();
+  gtsam::Matrix12 H;
+  EXPECT_DOUBLES_EQUAL(0.5 * 0.3 + 0.25 * 1.1, map->height(0.3, 1.1, H), 1e-9);
+  EXPECT(assert_equal(gtsam::Matrix12(0.5, 0.25), H, 1e-9));
+
+  // Beyond the last column the height is that of the border, flat in x.
+  EXPECT_DOUBLES_EQUAL(0.5 * 1.0 + 0.25 * 1.1, map->height(3.0, 1.1, H), 1e-9);
+  EXPECT(assert_equal(gtsam::Matrix12(0.0, 0.25), H, 1e-9));
+
+  // The gradient matches numerical differentiation inside a cell.
+  auto f = [&](const gtsam::Vector2 &p) {
+    return map->height(p.x(), p.y());
+  };
+  gtsam::Matrix expected =
+      gtsam::numericalDerivative11<double, gtsam::Vector2>(
+          f, gtsam::Vector2(0.3, 1.1));
+  map->height(0.3, 1.1, H);
+  EXPECT(assert_equal(expected, gtsam::Matrix(H), 1e-6));
+
+  EXPECT(assert_equal(gtsam::Vector3(-0.5, -0.25, 1).normalized(),
+                      map->normal(0.3, 1.1), 1e-9));
+}
+
+// In-place updates are seen by factors sharing the map.
+TEST(TerrainHeightFactor, error) {
+  auto map = example::Ramp();
+  auto model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  gtsam::Key pose_key = gtsam::Symbol('p', 0);
+  const Point3 comPc(0, 0, -0.1);
+  TerrainHeightFactor factor(pose_key, model, comPc, map);
+
+  // Contact point at (0.5, 1, 0.5) is on the ramp.
+  Pose3 pose(Rot3(), Point3(0.5, 1.0, 0.6));
+  EXPECT(assert_equal(gtsam::Vector1(0.0), factor.evaluateError(pose), 1e-9));
+
+  gtsam::Values values;
+  values.insert(pose_key, Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3),
+                                Point3(0.2, 0.7, 0.9)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  // Raise the whole map by 0.2 in place.
+  for (size_t iy = 0; iy < map->ny(); iy++) {
+    for (size_t ix = 0; ix < map->nx(); ix++) {
+      map->setHeight(ix, iy, map->at(ix, iy) + 0.2);
+    }
+  }
+  EXPECT(assert_equal(gtsam::Vector1(-0.2), factor.evaluateError(pose), 1e-9));
+  EXPECT(boost::dynamic_pointer_cast<TerrainHeightFactor>(factor.clone())
+             ->map() == map);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTimeOptimalRetiming.cpp
+ * @brief Test time-optimal retiming of joint-space paths.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/TimeOptimalRetiming.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector3;
+
+// A single pendulum swinging up by one radian, from rest to rest.
+TEST(TimeOptimalRetiming, Pendulum) {
+  const Robot robot = simple_urdf::getRobot();
+  const Vector3 gravity(0, 0, -9.8);
+  const size_t num_waypoints = 51;
+  const Matrix path = gtsam::Vector::LinSpaced(num_waypoints, 0.0, 1.0);
+
+  const TimeOptimalRetiming retiming(robot, gravity);
+  const RetimedPath retimed = retiming.retime(path);
+  EXPECT_LONGS_EQUAL(num_waypoints, retimed.times.size());
+  EXPECT_DOUBLES_EQUAL(0.0, retimed.times(0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.0, retimed.speeds(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.0, retimed.speeds(num_waypoints - 1), 1e-9);
+  for (size_t i = 1; i < num_waypoints; i++) {
+    EXPECT(retimed.times(i) > retimed.times(i - 1));
+  }
+
+  // The velocity limit of 0.5 rad/s is reached, and no limit is exceeded.
+  const auto &params = robot.joints()[0]->parameters();
+  EXPECT(retimed.velocities.cwiseAbs().maxCoeff() <=
+         params.velocity_limit + 1e-6);
+  EXPECT(retimed.velocities.cwiseAbs().maxCoeff() >=
+         params.velocity_limit - 1e-6);
+  EXPECT(retimed.torques.cwiseAbs().maxCoeff() <= params.torque_limit + 1e-6);
+
+  // Mostly at full speed, so close to one radian over the velocity limit.
+  EXPECT(retimed.duration() >= 1.0 / params.velocity_limit);
+  EXPECT(retimed.duration() <= 1.1 / params.velocity_limit);
+
+  // The same path from Values.
+  gtsam::Values values;
+  const int j = robot.joints()[0]->id();
+  for (size_t i = 0; i < num_waypoints; i++) {
+    InsertJointAngle(&values, j, 3 + i, path(i, 0));
+  }
+  EXPECT(assert_equal(retimed.times,
+                      retiming.retime(values, 3, 2 + num_waypoints).times));
+}
+
+// Gravity beyond the torque limit cannot be held.
+TEST(TimeOptimalRetiming, Infeasible) {
+  const Robot robot = simple_urdf::getRobot();
+  const TimeOptimalRetiming retiming(robot, Vector3(0, 0, -1000));
+  const Matrix path = gtsam::Vector::LinSpaced(11, 0.0, 1.0);
+  THROWS_EXCEPTION(retiming.retime(path));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTimeShiftedFactor.cpp
+ * @brief Test shifting factor graphs and values in time.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/factors/TimeShiftedFactor.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// Slice t: a prior on the joint angle and, for t > 0, an expression factor
+// on the sum of the angles of t - 1 and t.
+NonlinearFactorGraph Slice(int t) {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, t), t,
+                                                   model);
+  if (t > 0) {
+    gtsam::Double_ q0(JointAngleKey(0, t - 1)), q1(JointAngleKey(0, t));
+    graph.emplace_shared<gtsam::ExpressionFactor<double>>(model, 2.0 * t,
+                                                          q0 + q1);
+  }
+  return graph;
+}
+}  // namespace example
+
+using namespace example;
+
+TEST(TimeShiftedFactor, ShiftTime) {
+  EXPECT(ShiftTime(JointAngleKey(2, 3), -1) == JointAngleKey(2, 2));
+  EXPECT(ShiftTime(WrenchKey(1, 2, 0), 4) == WrenchKey(1, 2, 4));
+  EXPECT(ShiftTime(PhaseKey(1), 1) == PhaseKey(2));
+  EXPECT(ShiftTime(TimeKey(5), -5) == TimeKey(0));
+  THROWS_EXCEPTION(ShiftTime(JointAngleKey(0, 0), -1));
+}
+
+TEST(TimeShiftedFactor, ShiftTimeSteps) {
+  NonlinearFactorGraph graph;
+  Values values;
+  for (int t = 0; t <= 2; t++) {
+    graph.push_back(Slice(t));
+    InsertJointAngle(&values, 0, t, 0.3 * t);
+  }
+
+  // Factors of step 0 are dropped, the others keep their errors.
+  const NonlinearFactorGraph shifted = ShiftTimeSteps(graph, -1);
+  const Values shifted_values = ShiftTimeSteps(values, -1);
+  EXPECT_LONGS_EQUAL(3, shifted.size());
+  EXPECT_LONGS_EQUAL(2, shifted_values.size());
+  EXPECT_DOUBLES_EQUAL(0.3, JointAngle(shifted_values, 0, 0), 1e-9);
+  const double expected = graph[1]->error(values) +
+                          graph[3]->error(values) + graph[4]->error(values);
+  EXPECT_DOUBLES_EQUAL(expected, shifted.error(shifted_values), 1e-9);
+
+  // Linearization is on the shifted keys.
+  const auto linear = shifted.back()->linearize(shifted_values);
+  EXPECT(linear->keys() ==
+         gtsam::KeyVector({JointAngleKey(0, 0), JointAngleKey(0, 1)}));
+  const auto original = graph.back()->linearize(values);
+  EXPECT(assert_equal(original->augmentedJacobian(),
+                      linear->augmentedJacobian()));
+
+  // Shifting again wraps the original factor.
+  const NonlinearFactorGraph back = ShiftTimeSteps(shifted, 1);
+  auto factor = boost::dynamic_pointer_cast<TimeShiftedFactor>(back.back());
+  CHECK(factor);
+  EXPECT_LONGS_EQUAL(0, factor->offset());
+  EXPECT(factor->factor() == graph.back());
+}
+
+TEST(TimeShiftedFactor, SlideWindow) {
+  NonlinearFactorGraph graph;
+  Values values;
+  for (int t = 0; t <= 2; t++) {
+    graph.push_back(Slice(t));
+    InsertJointAngle(&values, 0, t, 0.3 * t);
+  }
+
+  // The new step 2 is the old step 3, initialized with the old step 2.
+  SlideWindow(&graph, &values, ShiftTimeSteps(Slice(3), -1));
+  EXPECT_LONGS_EQUAL(5, graph.size());
+  EXPECT_LONGS_EQUAL(3, values.size());
+  EXPECT_DOUBLES_EQUAL(0.6, JointAngle(values, 0, 2), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.6, JointAngle(values, 0, 1), 1e-9);
+  EXPECT(graph.keys().size() == 3);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
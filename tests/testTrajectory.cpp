@@ -18,6 +18,7 @@
 #include <gtdynamics/utils/DynamicsSymbol.h>
 #include <gtdynamics/utils/Phase.h>
 #include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/TrajectoryFile.h>
 #include <gtdynamics/utils/WalkCycle.h>
 
 #include "walkCycleExample.h"
@@ -64,6 +65,15 @@ TEST(Trajectory, error) {
   EXPECT_LONGS_EQUAL(6, trajectory.getStartTimeStep(2));
   EXPECT_LONGS_EQUAL(7, trajectory.getEndTimeStep(2));
 
+  // Phases own their final time steps, transitions included.
+  EXPECT_LONGS_EQUAL(0, trajectory.phaseIndex(0));
+  EXPECT_LONGS_EQUAL(0, trajectory.phaseIndex(2));
+  EXPECT_LONGS_EQUAL(1, trajectory.phaseIndex(3));
+  EXPECT_LONGS_EQUAL(2, trajectory.phaseIndex(6));
+  EXPECT_LONGS_EQUAL(2, trajectory.phaseIndex(7));
+  EXPECT_LONGS_EQUAL(5, trajectory.phaseIndex(15));
+  THROWS_EXCEPTION(trajectory.phaseIndex(16));
+
   auto cp_goals = walk_cycle.initContactPointGoal(robot, 0);
   EXPECT_LONGS_EQUAL(5, cp_goals.size());
   // regression
@@ -89,6 +99,13 @@ TEST(Trajectory, error) {
   // regression test
   EXPECT_LONGS_EQUAL(203, transition_graphs[0].size());
 
+  // Shifted transition graphs are those built at their own boundaries.
+  for (size_t p = 0; p < transition_graphs.size(); p++) {
+    EXPECT(transition_graphs[p].equals(graph_builder.dynamicsFactorGraph(
+        robot, trajectory.getEndTimeStep(p),
+        trajectory.transitionContactPoints()[p], mu)));
+  }
+
   // Test multi-phase factor graph.
   auto graph = trajectory.multiPhaseFactorGraph(robot, graph_builder,
                                                 CollocationScheme::Euler, mu);
@@ -99,6 +116,25 @@ TEST(Trajectory, error) {
   Values init_vals = trajectory.multiPhaseInitialValues(robot, initializer, 1e-5, 1. / 240);
   EXPECT_LONGS_EQUAL(4712, init_vals.size());
 
+  // Test binary export, with the same rows as the CSV phases.
+  for (size_t p = 0; p < trajectory.numPhases(); p++) {
+    init_vals.insert(PhaseKey(p), 1. / 240);
+  }
+  const Matrix table = trajectory.jointMatrix(robot, init_vals);
+  EXPECT_LONGS_EQUAL(repeat * (2 + 3), table.rows());
+  EXPECT_LONGS_EQUAL(4 * robot.numJoints() + 1, table.cols());
+  EXPECT(assert_equal(
+      trajectory.phase(1).jointMatrix(robot, init_vals,
+                                      trajectory.getStartTimeStep(1), 1. / 240),
+      Matrix(table.middleRows(2, 3))));
+
+  trajectory.writeToBinaryFile(robot, "testTrajectory.traj", init_vals);
+  const TrajectoryFile file("testTrajectory.traj");
+  EXPECT_LONGS_EQUAL(robot.numJoints(), file.jointNames().size());
+  EXPECT(robot.joints()[0]->name() == file.jointNames()[0]);
+  EXPECT(trajectory.phaseDurations() == file.phaseSteps());
+  EXPECT(assert_equal(table, Matrix(file.table())));
+
   // Test objectives for contact links.
   const Point3 step(0, 0.4, 0);
   auto contact_link_objectives = trajectory.contactPointObjectives(
@@ -121,6 +157,60 @@ TEST(Trajectory, error) {
   EXPECT_LONGS_EQUAL(260, boundary_conditions.size());
 }
 
+TEST(Trajectory, periodic) {
+  using namespace walk_cycle_example;
+  // A single walk cycle, K = 5.
+  auto trajectory = Trajectory(walk_cycle, 1);
+  const int K = trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+  EXPECT_LONGS_EQUAL(5, K);
+
+  const Pose3 displacement(Rot3(), Point3(0, 0.4, 0));
+  NonlinearFactorGraph boundary_conditions;
+  trajectory.addPeriodicBoundaryConditions(&boundary_conditions, robot,
+                                           displacement, kModel6, kModel6,
+                                           kModel1, kModel1);
+  EXPECT_LONGS_EQUAL(2 * robot.numLinks() + 2 * robot.numJoints(),
+                     boundary_conditions.size());
+
+  // A periodic solution has zero error on the boundary conditions.
+  const int i = robot.links()[0]->id(), j = robot.joints()[0]->id();
+  const Pose3 start(Rot3::Rz(0.1), Point3(1, 2, 0.3));
+  Values cycle;
+  for (int k = 0; k <= K; k++) {
+    InsertJointAngle(&cycle, j, k, k < K ? 0.1 * k : 0.0);
+    cycle.insert(TimeKey(k), 0.1 * k);
+  }
+  for (size_t p = 0; p < trajectory.numPhases(); p++) {
+    cycle.insert(PhaseKey(p), 0.1);
+  }
+  InsertPose(&cycle, i, 0, start);
+  InsertPose(&cycle, i, K, displacement * start);
+  for (auto &&factor : boundary_conditions) {
+    bool covered = true;
+    for (auto key : factor->keys()) covered = covered && cycle.exists(key);
+    if (covered) EXPECT_DOUBLES_EQUAL(0, factor->error(cycle), 1e-9);
+  }
+
+  // Replicating the cycle continues the walk.
+  const size_t repeat = 3;
+  const Values walk =
+      trajectory.repeatPeriodicSolution(cycle, repeat, displacement);
+  auto long_trajectory = Trajectory(walk_cycle, repeat);
+  EXPECT_LONGS_EQUAL(
+      long_trajectory.getEndTimeStep(long_trajectory.numPhases() - 1),
+      repeat * K);
+  // Shared slices are not duplicated: angles and times at 0..3K, phases,
+  // and link poses at 0, K, 2K, 3K.
+  EXPECT_LONGS_EQUAL(2 * (repeat * K + 1) + 2 * repeat + (repeat + 1),
+                     walk.size());
+  EXPECT(assert_equal(displacement * displacement * displacement * start,
+                      Pose(walk, i, repeat * K)));
+  EXPECT(assert_equal(displacement * start, Pose(walk, i, K)));
+  EXPECT_DOUBLES_EQUAL(0.1 * (K + 2), walk.atDouble(TimeKey(K + 2)), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.2, JointAngle(walk, j, 2 * K + 2), 1e-9);
+  EXPECT(walk.exists(PhaseKey(repeat * trajectory.numPhases() - 1)));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryFile.cpp
+ * @brief Test binary trajectory files.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/TrajectoryFile.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <fstream>
+
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+using namespace gtdynamics;
+
+TEST(TrajectoryFile, roundtrip) {
+  // Two joints, two phases of 2 and 3 rows.
+  Matrix table(5, 9);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 8; j++) table(i, j) = 10 * i + j;
+    table(i, 8) = i < 2 ? 0.1 : 0.2;
+  }
+  WriteTrajectoryFile("testTrajectoryFile.traj", {"j0", "joint_1"}, {2, 3},
+                      {0.1, 0.2}, table);
+
+  const TrajectoryFile file("testTrajectoryFile.traj");
+  EXPECT_LONGS_EQUAL(5, file.numSteps());
+  EXPECT(file.jointNames() == std::vector<std::string>({"j0", "joint_1"}));
+  EXPECT(file.phaseSteps() == std::vector<int>({2, 3}));
+  EXPECT(file.phaseDts() == std::vector<double>({0.1, 0.2}));
+  EXPECT(assert_equal(table, Matrix(file.table())));
+  EXPECT(assert_equal(Matrix(table.middleCols(0, 2)),
+                      Matrix(file.jointAngles())));
+  EXPECT(assert_equal(Matrix(table.middleCols(4, 2)),
+                      Matrix(file.jointAccels())));
+  EXPECT(assert_equal(Matrix(table.middleCols(6, 2)), Matrix(file.torques())));
+  EXPECT(assert_equal(Vector(table.col(8)), Vector(file.dts())));
+
+  // The table is aligned for memory mapping.
+  EXPECT_LONGS_EQUAL(
+      0, reinterpret_cast<uintptr_t>(file.table().data()) % 64);
+
+  // Inconsistent tables are rejected.
+  THROWS_EXCEPTION(WriteTrajectoryFile("testTrajectoryFile.traj", {"j0"},
+                                       {2, 3}, {0.1, 0.2}, table));
+  THROWS_EXCEPTION(WriteTrajectoryFile("testTrajectoryFile.traj",
+                                       {"j0", "joint_1"}, {2, 2}, {0.1, 0.2},
+                                       table));
+}
+
+TEST(TrajectoryFile, invalid) {
+  THROWS_EXCEPTION(TrajectoryFile("testTrajectoryFile_missing.traj"));
+
+  std::ofstream("testTrajectoryFile.csv") << "j0,j0,j0,j0,t\n0, 0, 0, 0, 0\n";
+  THROWS_EXCEPTION(TrajectoryFile("testTrajectoryFile.csv"));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryHandoff.cpp
+ * @brief Test the lock-free handoff of trajectories between threads.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/utils/TrajectoryHandoff.h>
+
+#include <thread>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Matrix;
+
+TEST(TripleBuffer, update) {
+  TripleBuffer<int> buffer;
+  EXPECT(!buffer.update());
+  EXPECT_LONGS_EQUAL(0, buffer.version());
+
+  buffer.publish(1);
+  buffer.publish(2);
+  EXPECT(buffer.update());
+  EXPECT_LONGS_EQUAL(2, buffer.front());
+  EXPECT_LONGS_EQUAL(2, buffer.version());
+  EXPECT(!buffer.update());
+  EXPECT_LONGS_EQUAL(2, buffer.front());
+
+  // Filling the back slot in place.
+  buffer.back() = 3;
+  buffer.publish();
+  EXPECT(buffer.update());
+  EXPECT_LONGS_EQUAL(3, buffer.front());
+}
+
+// The reader only ever sees complete values, in increasing versions.
+TEST(TripleBuffer, threads) {
+  TripleBuffer<std::vector<int>> buffer;
+  const int n = 2000;
+  std::thread writer([&buffer, n]() {
+    for (int i = 1; i <= n; i++) buffer.publish(std::vector<int>(64, i));
+  });
+  uint64_t last = 0;
+  bool consistent = true;
+  while (last < uint64_t(n)) {
+    if (!buffer.update()) continue;
+    const std::vector<int> &value = buffer.front();
+    consistent = consistent && buffer.version() > last &&
+                 value.size() == 64 && value.front() == value.back() &&
+                 uint64_t(value.front()) == buffer.version();
+    last = buffer.version();
+  }
+  writer.join();
+  EXPECT(consistent);
+}
+
+TEST(TrajectoryHandoff, spline) {
+  TrajectoryHandoff handoff;
+  Matrix q(1, 2), zero = Matrix::Zero(1, 2);
+  q << 0, 1;
+  const Matrix v = Matrix::Ones(1, 2);
+  handoff.publish(TrajectorySpline({0, 1}, q, v, zero, zero));
+  EXPECT(handoff.update());
+  gtsam::Vector qt(1);
+  handoff.front().evaluate(0.25, &qt);
+  EXPECT_DOUBLES_EQUAL(0.25, qt(0), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectorySpline.cpp
+ * @brief Test evaluating solved trajectories at arbitrary times.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/TrajectorySpline.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace example {
+// Knots of x(t) = 1 + 2t + 3t^2 on one joint, with v = 2 + 6t, a = 6 and
+// tau = t, at uneven times.
+const std::vector<double> times{0.0, 0.1, 0.3, 0.4, 1.0};
+
+Matrix Row(double (*f)(double)) {
+  Matrix m(1, times.size());
+  for (size_t k = 0; k < times.size(); k++) m(0, k) = f(times[k]);
+  return m;
+}
+double Q(double t) { return 1 + 2 * t + 3 * t * t; }
+double V(double t) { return 2 + 6 * t; }
+double A(double) { return 6; }
+double Tau(double t) { return t; }
+}  // namespace example
+
+using namespace example;
+
+// Trapezoidal and Hermite-Simpson reproduce a quadratic exactly.
+TEST(TrajectorySpline, quadratic) {
+  for (auto collocation : {Trapezoidal, HermiteSimpson, RungeKutta}) {
+    TrajectorySpline spline(times, Row(Q), Row(V), Row(A), Row(Tau),
+                            collocation);
+    EXPECT_LONGS_EQUAL(1, spline.numJoints());
+    EXPECT_LONGS_EQUAL(4, spline.numSteps());
+    Vector q, v, a, tau;
+    for (double t = 0; t <= 1.0; t += 0.0125) {
+      spline.evaluate(t, &q, &v, &a, &tau);
+      EXPECT_DOUBLES_EQUAL(Q(t), q(0), 1e-9);
+      EXPECT_DOUBLES_EQUAL(V(t), v(0), 1e-9);
+      EXPECT_DOUBLES_EQUAL(A(t), a(0), 1e-9);
+      EXPECT_DOUBLES_EQUAL(Tau(t), tau(0), 1e-9);
+    }
+
+    // Times are clamped.
+    spline.evaluate(-1.0, &q);
+    EXPECT_DOUBLES_EQUAL(Q(0), q(0), 1e-9);
+    spline.evaluate(2.0, &q);
+    EXPECT_DOUBLES_EQUAL(Q(1), q(0), 1e-9);
+  }
+}
+
+// Euler steps with the slopes of the first knot, and holds a and tau.
+TEST(TrajectorySpline, Euler) {
+  TrajectorySpline spline(times, Row(Q), Row(V), Row(A), Row(Tau), Euler);
+  Vector q(1), v(1), a(1), tau(1);
+  spline.evaluate(0.2, &q, &v, &a, &tau);
+  EXPECT_DOUBLES_EQUAL(Q(0.1) + 0.1 * V(0.1), q(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(V(0.1) + 0.1 * A(0.1), v(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(A(0.1), a(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(Tau(0.1), tau(0), 1e-9);
+
+  // The knot values.
+  for (size_t k = 0; k + 1 < times.size(); k++) {
+    spline.evaluate(times[k], &q, &v);
+    EXPECT_DOUBLES_EQUAL(Q(times[k]), q(0), 1e-9);
+    EXPECT_DOUBLES_EQUAL(V(times[k]), v(0), 1e-9);
+  }
+}
+
+// Hermite-Simpson interpolates q, v and a of a quintic at the knots.
+TEST(TrajectorySpline, HermiteSimpson) {
+  const double h = 0.5;
+  Matrix q(1, 2), v(1, 2), a(1, 2), tau = Matrix::Zero(1, 2);
+  q << 0, 1;
+  v << 0.5, -1;
+  a << 2, 3;
+  TrajectorySpline spline({0, h}, q, v, a, tau, HermiteSimpson);
+  Vector qt, vt;
+  spline.evaluate(h, &qt);
+  EXPECT_DOUBLES_EQUAL(1, qt(0), 1e-9);
+
+  // Finite differences of q at the ends match v.
+  const double d = 1e-6;
+  Vector q0, q1;
+  spline.evaluate(0, &q0);
+  spline.evaluate(d, &q1);
+  EXPECT_DOUBLES_EQUAL(0.5, (q1(0) - q0(0)) / d, 1e-4);
+  spline.evaluate(h - d, &q0);
+  spline.evaluate(h, &q1);
+  EXPECT_DOUBLES_EQUAL(-1, (q1(0) - q0(0)) / d, 1e-4);
+}
+
+// Knot times follow the PhaseKey durations of a multi-phase solve.
+TEST(TrajectorySpline, FromValues) {
+  auto robot = simple_urdf::getRobot();
+  auto j = robot.joints()[0]->id();
+  const std::vector<int> phase_steps{2, 3};
+  gtsam::Values results;
+  results.insert(PhaseKey(0), 0.1);
+  results.insert(PhaseKey(1), 0.2);
+  for (int k = 0; k <= 5; k++) {
+    InsertJointAngle(&results, j, k, double(k));
+    InsertJointVel(&results, j, k, 0.0);
+    InsertJointAccel(&results, j, k, 0.0);
+    InsertTorque(&results, j, k, 0.0);
+  }
+  auto spline = TrajectorySpline::FromValues(robot, results, phase_steps,
+                                             Euler);
+  EXPECT_LONGS_EQUAL(5, spline.numSteps());
+  EXPECT_DOUBLES_EQUAL(0.8, spline.endTime(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0.4, spline.times()[3], 1e-9);
+  Vector q;
+  spline.evaluate(0.45, &q);
+  EXPECT_DOUBLES_EQUAL(3, q(0), 1e-9);
+}
+
+TEST(TrajectorySpline, invalid) {
+  Matrix m = Matrix::Zero(1, 2);
+  CHECK_EXCEPTION(TrajectorySpline({0.0}, m, m, m, m), std::invalid_argument);
+  CHECK_EXCEPTION(TrajectorySpline({0.0, 0.0}, m, m, m, m),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(TrajectorySpline({0.0, 1.0, 2.0}, m, m, m, m),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryState.cpp
+ * @brief Test the flat trajectory container.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/TrajectoryState.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+// Values of all quantities at time steps [t0, t0 + num_steps).
+static Values AllValues(const Robot &robot, int t0, int num_steps) {
+  Values values;
+  for (int t = t0; t < t0 + num_steps; t++) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, t, 1.0 * t);
+      InsertJointVel(&values, j, t, 2.0 * t);
+      InsertJointAccel(&values, j, t, 3.0 * t);
+      InsertTorque(&values, j, t, 4.0 * t);
+      InsertWrench(&values, joint->parent()->id(), j, t,
+                   Vector6::Constant(t));
+      InsertWrench(&values, joint->child()->id(), j, t,
+                   Vector6::Constant(-t));
+    }
+    for (auto &&link : robot.links()) {
+      const int i = link->id();
+      InsertPose(&values, i, t, Pose3(gtsam::Rot3::Rz(0.1 * t),
+                                      gtsam::Point3(t, i, 0)));
+      InsertTwist(&values, i, t, Vector6::Constant(5.0 * t));
+      InsertTwistAccel(&values, i, t, Vector6::Constant(6.0 * t));
+    }
+  }
+  return values;
+}
+
+TEST(TrajectoryState, Constructor) {
+  const Robot robot = simple_urdf::getRobot();
+  TrajectoryState state(robot, 3, TrajectoryState::kJointAngles |
+                                      TrajectoryState::kPoses);
+  EXPECT_LONGS_EQUAL(3, state.numSteps());
+  EXPECT(state.has(TrajectoryState::kJointAngles));
+  EXPECT(!state.has(TrajectoryState::kJointQuantities));
+  EXPECT_LONGS_EQUAL(robot.numJoints(), state.jointAngles().rows());
+  EXPECT_LONGS_EQUAL(0, state.torques().size());
+  EXPECT(assert_equal(Pose3(), state.pose(0, 2)));
+
+  state.jointAngle(0, 1) = 0.5;
+  EXPECT_DOUBLES_EQUAL(0.5, state.jointAngles()(0, 1), 1e-9);
+  EXPECT_LONGS_EQUAL(3 * (robot.numJoints() + robot.numLinks()),
+                     state.values().size());
+  THROWS_EXCEPTION(state.jointAngle(7, 0));
+}
+
+TEST(TrajectoryState, RoundTrip) {
+  const Robot robot = simple_urdf::getRobot();
+  const Values values = AllValues(robot, 2, 3);
+  const TrajectoryState state =
+      TrajectoryState::FromValues(robot, values, 3, 2);
+  EXPECT_LONGS_EQUAL(TrajectoryState::kAll, state.quantities());
+  EXPECT_LONGS_EQUAL(2, state.t0());
+
+  const int j = robot.joints().front()->id();
+  EXPECT_DOUBLES_EQUAL(3.0, state.jointAngle(j, 3), 1e-9);
+  EXPECT_DOUBLES_EQUAL(16.0, state.torque(j, 4), 1e-9);
+  EXPECT_DOUBLES_EQUAL(4.0, state.jointAngles()(0, 2), 1e-9);
+  EXPECT(assert_equal(Pose(values, 1, 3), state.pose(1, 3)));
+  EXPECT(assert_equal(Vector6::Constant(10), state.twist(1, 2)));
+
+  // Wrenches on either side of the joint.
+  const int parent = robot.joints().front()->parent()->id();
+  const int child = robot.joints().front()->child()->id();
+  EXPECT(assert_equal(Vector6::Constant(4), state.wrench(parent, j, 4)));
+  EXPECT(assert_equal(Vector6::Constant(-4), state.wrench(child, j, 4)));
+
+  EXPECT(assert_equal(values, state.values()));
+
+  // Missing quantities throw.
+  TrajectoryState joints(robot, 1, TrajectoryState::kJointQuantities);
+  THROWS_EXCEPTION(joints.setStep(0, Values(), 0));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -68,6 +68,31 @@ TEST(TwistFactor, error) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, diffDelta, 1e-3);
 }
 
+// Analytic factor agrees with the expression-based reference.
+TEST(TwistFactor, Analytic) {
+  gtsam::Pose3 cMp = gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(-1, 0, 0));
+  gtsam::Vector6 screw_axis;
+  screw_axis << 0, 0, 1, 0, 1, 0;
+  auto joint = make_joint(cMp, screw_axis);
+
+  auto expected = TwistFactor(example::cost_model, joint, 0);
+  AnalyticTwistFactor actual(example::cost_model, joint, 0);
+  EXPECT(expected->keys() == actual.keys());
+
+  gtsam::Values values;
+  values.insert(example::qKey, 0.3);
+  values.insert(example::qVelKey, -2.0);
+  values.insert(example::twist_p_key,
+                (gtsam::Vector(6) << 1, 0, 2, 0, 3, 1).finished());
+  values.insert(example::twist_c_key,
+                (gtsam::Vector(6) << 0, 1, 2, 3, 4, 5).finished());
+  EXPECT(assert_equal(expected->unwhitenedError(values),
+                      actual.unwhitenedError(values), 1e-9));
+  EXPECT(assert_equal(*expected->linearize(values), *actual.linearize(values),
+                      1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(actual, values, 1e-7, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
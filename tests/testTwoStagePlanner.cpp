@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTwoStagePlanner.cpp
+ * @brief Test kinematics-then-dynamics planning.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/ArticulatedBodySolver.h>
+#include <gtdynamics/dynamics/TwoStagePlanner.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <boost/make_shared.hpp>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace {
+const Vector3 kGravity(0, 0, -9.8);
+
+// A single phase of 4 steps with the given contacts.
+Trajectory OnePhase(const PointOnLinks &contacts) {
+  const auto spec = boost::make_shared<FootContactConstraintSpec>(contacts);
+  return Trajectory(std::vector<Phase>{Phase(0, 4, spec)});
+}
+
+// Joint angle q = 0.5 a t^2 of the single joint of simple_urdf.
+Values Accelerating(const Robot &robot, double a, double dt) {
+  Values kinematics;
+  const int j = robot.joint("j1")->id();
+  for (int k = 0; k <= 4; k++) {
+    InsertJointAngle(&kinematics, j, k, 0.5 * a * (k * dt) * (k * dt));
+  }
+  return kinematics;
+}
+}  // namespace
+
+// A fixed-base motion is differentiated exactly, with the torques of RNEA.
+TEST(TwoStagePlanner, fixedBase) {
+  const Robot robot = simple_urdf::getRobot();
+  const double dt = 0.1;
+  const TwoStagePlanner planner(robot, OnePhase({}), {dt}, kGravity);
+  const TwoStageResult result = planner.plan(Accelerating(robot, 2.0, dt));
+  EXPECT(result.violations.empty());
+  EXPECT(!result.full_solve);
+
+  const int j = robot.joint("j1")->id();
+  const ArticulatedBodySolver solver(robot, kGravity);
+  for (int k = 0; k <= 4; k++) {
+    EXPECT_DOUBLES_EQUAL(2.0 * k * dt, JointVel(result.values, j, k), 1e-9);
+    EXPECT_DOUBLES_EQUAL(2.0, JointAccel(result.values, j, k), 1e-9);
+    Values known;
+    InsertJointAngle(&known, j, k, JointAngle(result.values, j, k));
+    InsertJointVel(&known, j, k, JointVel(result.values, j, k));
+    InsertJointAccel(&known, j, k, JointAccel(result.values, j, k));
+    EXPECT_DOUBLES_EQUAL(Torque(solver.solveID(known, k), j, k),
+                         Torque(result.values, j, k), 1e-3);
+  }
+  EXPECT_DOUBLES_EQUAL(dt, result.values.at<double>(PhaseKey(0)), 1e-12);
+}
+
+// A floating robot standing on one contact carries its weight on it.
+TEST(TwoStagePlanner, standing) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("test/simple_urdf.urdf"));
+  const PointOnLink foot(robot.link("l1"), Point3(0, 0, -1));
+  const TwoStagePlanner planner(robot, OnePhase({foot}), {0.1}, kGravity,
+                                std::string("l1"));
+
+  Values kinematics;
+  const int i = foot.link->id(), j = robot.joint("j1")->id();
+  for (int k = 0; k <= 4; k++) {
+    InsertPose(&kinematics, i, k, Pose3(gtsam::Rot3(), Point3(0, 0, 1)));
+    InsertJointAngle(&kinematics, j, k, 0.0);
+  }
+  const TwoStageResult result = planner.plan(kinematics);
+  EXPECT(result.violations.empty());
+  for (int k = 0; k <= 4; k++) {
+    const Vector6 wrench = result.values.at<Vector6>(ContactWrenchKey(i, 0, k));
+    EXPECT(gtsam::assert_equal(Vector3(0, 0, 115 * 9.8),
+                               Vector3(wrench.tail<3>()), 1e-3));
+    EXPECT_DOUBLES_EQUAL(0, Torque(result.values, j, k), 1e-3);
+  }
+}
+
+// Torques beyond the joint limit are reported, and trigger the full solve.
+TEST(TwoStagePlanner, violations) {
+  const Robot robot = simple_urdf::getRobot();
+  const double dt = 0.01;
+  TwoStagePlannerParams params;
+  params.fallback = false;
+  const TwoStagePlanner planner(robot, OnePhase({}), {dt}, kGravity,
+                                boost::none, params);
+
+  // About 16 kg m^2 about the joint, so 100 rad/s^2 needs 1600 Nm > 1000 Nm.
+  const TwoStageResult result = planner.plan(Accelerating(robot, 100, dt));
+  EXPECT_LONGS_EQUAL(5, result.violations.size());
+  EXPECT(!result.full_solve);
+  EXPECT(planner.violations(result.values) == result.violations);
+
+  THROWS_EXCEPTION(TwoStagePlanner(robot, OnePhase({}), {dt, dt}));
+  THROWS_EXCEPTION(TwoStagePlanner(robot, OnePhase({}), {0.0}));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -34,6 +34,20 @@ TEST(Values, at) {
   CHECK_EXCEPTION(TwistAccel(values, 7), KeyDoesNotExist);
 }
 
+TEST(Values, InsertJointAngles) {
+  gtsam::Values values;
+  const gtsam::Matrix angles =
+      (gtsam::Matrix(2, 3) << 1, 2, 3, 4, 5, 6).finished();
+  InsertJointAngles(&values, {4, 0, 2}, angles, 3);
+  EXPECT_LONGS_EQUAL(6, values.size());
+  EXPECT_DOUBLES_EQUAL(1, JointAngle(values, 4, 3), 0);
+  EXPECT_DOUBLES_EQUAL(6, JointAngle(values, 2, 4), 0);
+
+  InsertTorques(&values, {1}, gtsam::Matrix::Constant(2, 1, 0.5));
+  EXPECT_DOUBLES_EQUAL(0.5, Torque(values, 1, 1), 0);
+  THROWS_EXCEPTION(InsertJointVels(&values, {1, 2}, angles));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -62,6 +62,23 @@ TEST(WalkCycle, contactPoints) {
   EXPECT_LONGS_EQUAL(5, walk_cycle.contactPoints().size());
 }
 
+// Walk cycles with the same phases and contacts have the same hash.
+TEST(WalkCycle, contentHash) {
+  using namespace walk_cycle_example;
+  const WalkCycle same(walk_cycle.phases());
+  EXPECT(same.contentHash() == walk_cycle.contentHash());
+
+  std::vector<Phase> phases = walk_cycle.phases();
+  std::swap(phases[0], phases[1]);
+  EXPECT(WalkCycle(phases).contentHash() != walk_cycle.contentHash());
+
+  const Phase shorter(0, 1, phase_1);
+  EXPECT(shorter.contentHash() != walk_cycle.phase(0).contentHash());
+  EXPECT(phase_1->contentHash() != phase_2->contentHash());
+  EXPECT(ContentHashOf(phase_1->contactPoints()) !=
+         ContentHashOf(phase_2->contactPoints()));
+}
+
 TEST(WalkCycle, objectives) {
   Robot robot =
       CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"), "spider");
@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWeightGroup.cpp
+ * @brief Test reweighting factors in place through shared noise models.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/MinTorqueFactor.h>
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/utils/WeightGroup.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <cmath>
+
+using namespace gtdynamics;
+
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+TEST(WeightGroup, setWeight) {
+  auto group = WeightGroup::Sigmas(gtsam::Vector2(1, 2), 4);
+  EXPECT(assert_equal(gtsam::Vector2(0.5, 1), group->sigmas()));
+  EXPECT(assert_equal(gtsam::Vector2(2, 1), group->invsigmas()));
+  EXPECT(assert_equal(gtsam::Vector2(4, 1), group->precisions()));
+  group->setWeight(1);
+  EXPECT(assert_equal(group->baseSigmas(), group->sigmas()));
+  EXPECT(assert_equal(gtsam::Vector2(1, 0.5),
+                      group->whiten(gtsam::Vector2(1, 1))));
+
+  THROWS_EXCEPTION(group->setWeight(0));
+  THROWS_EXCEPTION(WeightGroup::Sigmas(gtsam::Vector2(1, 0)));
+  EXPECT_DOUBLES_EQUAL(1, group->weight(), 0);
+}
+
+// Minimum-torque and torque-goal objectives reweighted in place solve as
+// rebuilt graphs with the corresponding noise models.
+TEST(WeightGroup, Reweight) {
+  WeightGroups groups;
+  auto effort = groups.group("effort", 1, 1.0);
+  auto goal = groups.group("goal", 1, 1.0);
+  EXPECT(effort == groups.group("effort", 1, 1.0));
+  THROWS_EXCEPTION(groups.group("effort", 2, 1.0));
+  EXPECT_LONGS_EQUAL(2, groups.size());
+
+  auto Graph = [](const gtsam::SharedNoiseModel &effort_model,
+                  const gtsam::SharedNoiseModel &goal_model)
+      -> NonlinearFactorGraph {
+    NonlinearFactorGraph graph;
+    graph.emplace_shared<MinTorqueFactor>(TorqueKey(0, 0), effort_model);
+    AddPrior<double>(&graph, TorqueKey(0, 0), 1.0, goal_model);
+    return graph;
+  };
+  const NonlinearFactorGraph graph = Graph(effort, goal);
+  Values initial;
+  InsertTorque(&initial, 0, 0, 0.5);
+
+  for (double w : {0.1, 1.0, 10.0}) {
+    groups.setWeights({{"effort", w}, {"goal", 1 / w}});
+    const NonlinearFactorGraph rebuilt =
+        Graph(gtsam::noiseModel::Isotropic::Sigma(1, 1 / std::sqrt(w)),
+              gtsam::noiseModel::Isotropic::Sigma(1, std::sqrt(w)));
+    EXPECT_DOUBLES_EQUAL(rebuilt.error(initial), graph.error(initial), 1e-9);
+    const Values result =
+        gtsam::LevenbergMarquardtOptimizer(graph, initial).optimize();
+    EXPECT(assert_equal(
+        gtsam::LevenbergMarquardtOptimizer(rebuilt, initial).optimize(),
+        result, 1e-9));
+
+    // The weighted mean of the two goals.
+    EXPECT_DOUBLES_EQUAL(1 / (1 + w * w), Torque(result, 0, 0), 1e-6);
+  }
+  EXPECT_DOUBLES_EQUAL(10, groups.weights().at("effort"), 0);
+  THROWS_EXCEPTION(groups.setWeight("missing", 1));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
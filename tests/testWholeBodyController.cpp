@@ -0,0 +1,147 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWholeBodyController.cpp
+ * @brief Test the whole-body inverse dynamics QP.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/WholeBodyController.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Vector;
+
+namespace example {
+const Robot a1 = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+const gtsam::Vector3 gravity(0, 0, -9.8);
+
+std::vector<WholeBodyContact> Feet() {
+  std::vector<WholeBodyContact> feet;
+  for (const std::string leg : {"FR", "FL", "RR", "RL"}) {
+    feet.emplace_back(leg + "_lower", Point3(0, 0, -0.1), 0.6);
+  }
+  return feet;
+}
+
+// Standing joint angles, ordered as robot.joints().
+Vector Standing() {
+  Vector q = Vector::Zero(a1.numJoints());
+  for (size_t j = 0; j < a1.joints().size(); j++) {
+    const std::string &name = a1.joints()[j]->name();
+    if (name.find("upper") != std::string::npos) q(j) = 0.7;
+    if (name.find("lower") != std::string::npos) q(j) = -1.4;
+  }
+  return q;
+}
+
+double TotalMass(const Robot &robot) {
+  double mass = 0;
+  for (auto &&link : robot.links()) mass += link->mass();
+  return mass;
+}
+}  // namespace example
+
+using namespace example;
+
+// Without contacts or active limits, the torques are the inverse dynamics.
+TEST(WholeBodyController, fixedBase) {
+  auto robot = simple_urdf::getRobot();
+  WholeBodyController controller(robot, simple_urdf::gravity, {});
+  const Vector q = Vector::Constant(1, 0.3), v = Vector::Constant(1, -0.5),
+               a = Vector::Constant(1, 2.0);
+  const WholeBodyCommand &command = controller.compute(q, v, a);
+  EXPECT(command.converged);
+
+  RigidBodyDynamics dynamics(robot, simple_urdf::gravity);
+  const TreeDynamicsResult expected = dynamics.inverseDynamics(q, v, a);
+  EXPECT(assert_equal(Vector(expected.torques), command.torques, 1e-9));
+  EXPECT(assert_equal(a, command.accelerations, 1e-9));
+}
+
+// Torques saturate at their limits, at the closest feasible acceleration.
+TEST(WholeBodyController, torqueLimits) {
+  auto robot = simple_urdf::getRobot();
+  WholeBodyParams params;
+  params.torque_limits = Vector::Constant(1, 0.1);
+  WholeBodyController controller(robot, simple_urdf::gravity, {}, params);
+  const Vector q = Vector::Constant(1, 0.3), v = Vector::Zero(1),
+               a = Vector::Constant(1, 20.0);
+  const WholeBodyCommand &command = controller.compute(q, v, a);
+  EXPECT(command.converged);
+  EXPECT_DOUBLES_EQUAL(0.1, std::abs(command.torques(0)), 1e-9);
+  EXPECT_LONGS_EQUAL(1, controller.activeSet().size());
+
+  // The limit stays active on the next tick, without active set changes.
+  controller.compute(q, v, a);
+  EXPECT(command.converged);
+  EXPECT_LONGS_EQUAL(0, command.iterations);
+}
+
+// Standing still, the feet carry the weight within their friction cones.
+TEST(WholeBodyController, standing) {
+  WholeBodyController controller(a1, gravity, Feet());
+  const Vector q = Standing(), v = Vector::Zero(a1.numJoints());
+  const Vector a_des = Vector::Zero(18);
+  const WholeBodyCommand &command = controller.compute(q, v, a_des);
+  EXPECT(command.converged);
+  EXPECT(assert_equal(a_des, command.accelerations, 1e-6));
+
+  gtsam::Vector3 total = gtsam::Vector3::Zero();
+  for (size_t k = 0; k < 4; k++) {
+    const gtsam::Vector3 f = command.forces.segment<3>(3 * k);
+    total += f;
+    EXPECT(f.z() > 0);
+    EXPECT(f.head<2>().lpNorm<Eigen::Infinity>() <=
+           0.6 / std::sqrt(2.0) * f.z() + 1e-9);
+  }
+  EXPECT(assert_equal(gtsam::Vector3(0, 0, 9.8 * TotalMass(a1)), total,
+                      1e-6));
+
+  // A foot in the air carries no force.
+  controller.setContactActive(0, false);
+  controller.compute(q, v, a_des);
+  EXPECT(command.converged);
+  EXPECT(assert_equal(gtsam::Vector3::Zero(),
+                      gtsam::Vector3(command.forces.head<3>()), 1e-9));
+}
+
+// Falling faster than gravity would pull on the ground: the normal force
+// bounds become active, and stay so on the next tick.
+TEST(WholeBodyController, warmStart) {
+  WholeBodyController controller(a1, gravity, Feet());
+  const Vector q = Standing(), v = Vector::Zero(a1.numJoints());
+  Vector a_des = Vector::Zero(18);
+  a_des(5) = -20;
+  const WholeBodyCommand &command = controller.compute(q, v, a_des);
+  EXPECT(command.converged);
+  EXPECT(!controller.activeSet().empty());
+  for (size_t k = 0; k < 4; k++) {
+    EXPECT(command.forces(3 * k + 2) > -1e-9);
+  }
+
+  const std::vector<size_t> active = controller.activeSet();
+  controller.compute(q, v, a_des);
+  EXPECT(command.converged);
+  EXPECT_LONGS_EQUAL(0, command.iterations);
+  EXPECT(active == controller.activeSet());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
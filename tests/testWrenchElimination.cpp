@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWrenchElimination.cpp
+ * @brief Test the per-slice elimination of joint wrenches.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/optimizer/WrenchElimination.h>
+#include <gtdynamics/universal_robot/RobotModels.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+using namespace gtdynamics;
+using gtsam::GaussianFactorGraph;
+using gtsam::Values;
+using gtsam::VectorValues;
+
+namespace {
+// Forward dynamics of simple_urdf over 3 time steps, with the torque
+// priors of consecutive steps tied by soft factors.
+GaussianFactorGraph ThreeSlices() {
+  using simple_urdf::gravity;
+  using simple_urdf::planar_axis;
+  const Robot robot = simple_urdf::getRobot();
+  DynamicsGraph graph_builder(gravity, planar_axis);
+  const int j = robot.joint("j1")->id();
+
+  GaussianFactorGraph graph;
+  for (int t = 0; t < 3; t++) {
+    Values known_values;
+    InsertJointAngle(&known_values, j, t, 0.2 * t);
+    InsertJointVel(&known_values, j, t, 0.5 - t);
+    known_values = robot.forwardKinematics(known_values, t);
+    InsertTorque(&known_values, j, t, 1.0 + t);
+    graph += graph_builder.linearDynamicsGraph(robot, t, known_values);
+    graph += DynamicsGraph::linearFDPriors(robot, t, known_values);
+    if (t > 0) {
+      graph.emplace_shared<gtsam::JacobianFactor>(
+          JointAccelKey(j, t - 1), gtsam::I_1x1, JointAccelKey(j, t),
+          -gtsam::I_1x1, gtsam::Vector1(0.1));
+    }
+  }
+  return graph;
+}
+}  // namespace
+
+// Eliminating the wrenches first gives the solution of the full graph.
+TEST(WrenchElimination, sameSolution) {
+  const GaussianFactorGraph graph = ThreeSlices();
+  const WrenchElimination elimination = EliminateWrenches(graph);
+  EXPECT_LONGS_EQUAL(3, elimination.slices.size());
+  for (gtsam::Key key : elimination.reduced.keys()) {
+    EXPECT(DynamicsSymbol(key).label() != "F");
+  }
+  EXPECT(elimination.reduced.keys().size() < graph.keys().size());
+
+  const VectorValues expected = graph.optimize();
+  EXPECT(gtsam::assert_equal(
+      expected, elimination.backSubstitute(elimination.reduced.optimize()),
+      1e-9));
+  EXPECT(gtsam::assert_equal(expected, OptimizeWithWrenchElimination(graph),
+                             1e-9));
+  EXPECT(gtsam::assert_equal(
+      expected,
+      OptimizeWithWrenchElimination(graph, boost::none, gtsam::EliminateQR),
+      1e-9));
+}
+
+// Factors on the wrenches of different time steps are rejected.
+TEST(WrenchElimination, coupledSlices) {
+  GaussianFactorGraph graph = ThreeSlices();
+  graph.emplace_shared<gtsam::JacobianFactor>(
+      WrenchKey(1, 1, 0), gtsam::I_6x6, WrenchKey(1, 1, 1), -gtsam::I_6x6,
+      gtsam::Vector6::Zero());
+  THROWS_EXCEPTION(EliminateWrenches(graph));
+}
+
+// Wrenches are dropped from orderings.
+TEST(WrenchElimination, WithoutWrenches) {
+  gtsam::Ordering ordering;
+  ordering.push_back(TwistAccelKey(1, 0));
+  ordering.push_back(WrenchKey(1, 2, 0));
+  ordering.push_back(JointAccelKey(2, 0));
+
+  gtsam::Ordering expected;
+  expected.push_back(TwistAccelKey(1, 0));
+  expected.push_back(JointAccelKey(2, 0));
+  EXPECT(gtsam::assert_equal(expected, WithoutWrenches(ordering)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
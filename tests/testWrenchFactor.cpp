@@ -12,6 +12,7 @@
  */
 
 #include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/factors/InertialWrenchFactor.h>
 #include <gtdynamics/factors/WrenchFactor.h>
 #include <gtdynamics/universal_robot/RobotModels.h>
 #include <gtdynamics/utils/values.h>
@@ -115,6 +116,71 @@ TEST(WrenchFactor, NonzeroTwistCase) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, x, diffDelta, tol);
 }
 
+// Analytic factor agrees with the expression-based reference.
+TEST(WrenchFactor, Analytic) {
+  int id = 0;
+  const std::vector<DynamicsSymbol> wrench_keys{WrenchKey(id, 1),
+                                                WrenchKey(id, 2)};
+  auto expected = WrenchFactor(example::cost_model, example::link, wrench_keys,
+                               0, example::gravity);
+  AnalyticWrenchFactor actual(example::cost_model, example::link, wrench_keys,
+                              0, example::gravity);
+  EXPECT(gtsam::KeySet(expected->keys().begin(), expected->keys().end()) ==
+         gtsam::KeySet(actual.keys().begin(), actual.keys().end()));
+
+  Values x;
+  InsertTwist(&x, id, (Vector(6) << 0, 0, 1, 0, 1, 0).finished());
+  InsertTwistAccel(&x, id, (Vector(6) << 1, 0, 1, 0, 1, 2).finished());
+  InsertWrench(&x, id, 1, (Vector(6) << 0, 0, 4, -1, 2, 0).finished());
+  InsertWrench(&x, id, 2, (Vector(6) << 1, 0, -3, 0, -1, 0).finished());
+  InsertPose(&x, id, Pose3(Rot3::RzRyRx(0.3, -0.1, 0.2), Point3(1, 0, 0)));
+  EXPECT(assert_equal(expected->unwhitenedError(x), actual.unwhitenedError(x),
+                      1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(actual, x, diffDelta, tol);
+}
+
+// Inertial parameters as a variable: nominal ones agree with the analytic
+// factor, and a payload is a change of Values only.
+TEST(WrenchFactor, Inertial) {
+  int id = 0;
+  const std::vector<DynamicsSymbol> wrench_keys{WrenchKey(id, 1),
+                                                WrenchKey(id, 2)};
+  AnalyticWrenchFactor expected(example::cost_model, example::link,
+                                wrench_keys, 0, example::gravity);
+  InertialWrenchFactor actual(example::cost_model, example::link, wrench_keys,
+                              0, example::gravity);
+  EXPECT_LONGS_EQUAL(expected.size() + 1, actual.size());
+  EXPECT(actual.keys().back() == InertialParametersKey(id));
+
+  Values x;
+  InsertTwist(&x, id, (Vector(6) << 0, 0, 1, 0, 1, 0).finished());
+  InsertTwistAccel(&x, id, (Vector(6) << 1, 0, 1, 0, 1, 2).finished());
+  InsertWrench(&x, id, 1, (Vector(6) << 0, 0, 4, -1, 2, 0).finished());
+  InsertWrench(&x, id, 2, (Vector(6) << 1, 0, -3, 0, -1, 0).finished());
+  InsertPose(&x, id, Pose3(Rot3::RzRyRx(0.3, -0.1, 0.2), Point3(1, 0, 0)));
+  Vector10 parameters = InertialParameters(*example::link);
+  x.insert(InertialParametersKey(id), parameters);
+  EXPECT(assert_equal(expected.unwhitenedError(x), actual.unwhitenedError(x),
+                      1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(actual, x, diffDelta, tol);
+
+  // Added mass, with its CoM off the nominal one.
+  parameters(0) += 2;
+  parameters.segment<3>(1) << 0.2, -0.1, 0.3;
+  parameters(4) += 0.5;
+  parameters(5) += 0.1;
+  x.update(InertialParametersKey(id), parameters);
+  const Matrix6 G = SpatialInertia(parameters);
+  const Vector6 V = Twist(x, id, 0), A = TwistAccel(x, id, 0);
+  Vector6 gravity_accel;
+  gravity_accel << Z_3x1, Pose(x, id).rotation().unrotate(example::gravity);
+  const Vector6 expected_error = Pose3::adjointTranspose(V, G * V) - G * A +
+                                 Wrench(x, id, 1) + Wrench(x, id, 2) +
+                                 G * gravity_accel;
+  EXPECT(assert_equal(expected_error, actual.unwhitenedError(x), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(actual, x, diffDelta, tol);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
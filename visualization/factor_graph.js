@@ -11,12 +11,15 @@ var line_chart = svg.append("g")
                     .attr('class', 'line_chart');
 
 // =================== load data =================== //
+// Pages that load chunks of detail on demand set lazy_factor_graph.
 var file = "factor_graph.json";
-Promise.all([d3.json(file)])
-        .then(function(data) 
-        {
-            draw_factor_graph(data[0])
-        });
+if (typeof lazy_factor_graph == 'undefined') {
+    Promise.all([d3.json(file)])
+            .then(function(data) 
+            {
+                draw_factor_graph(data[0])
+            });
+}
 
 
 /**
@@ -0,0 +1,77 @@
+// =================== level of detail =================== //
+// Shows the per-slice summaries of DynamicsGraph::saveGraphSlices, and
+// fetches the factors of a slice only when it is clicked. The directory of
+// the files is given as ?dir=..., by default factor_graph_slices.
+var slices_dir = new URLSearchParams(window.location.search).get("dir") ||
+                 "factor_graph_slices";
+var chunk_cache = {};
+
+var slices_div = d3.select("body").append('div').attr('class', 'slices');
+
+d3.json(slices_dir + "/index.json")
+  .then(function(summaries) {
+      draw_slices(summaries);
+  });
+
+
+/**
+ * @brief       draw one bar per slice, with height by number of factors and
+ *              color by error; clicking a bar loads the slice in detail
+ * @param[in]   summaries: list of slice summaries from index.json
+ */
+function draw_slices(summaries) {
+    var bar_w = Math.max(1, Math.min(20, 1000 / Math.max(1, summaries.length)));
+    var bars_h = 60;
+    var max_factors = d3.max(summaries, function(d) { return d.num_factors; });
+    var heightScale = d3.scaleLinear().domain([0, max_factors || 1])
+                                      .range([2, bars_h]);
+    var errorScale = d3.scaleSequential(d3.interpolateReds)
+        .domain([0, d3.max(summaries, function(d) { return d.max_error; }) || 1]);
+
+    slices_div.append("div").text(summaries.length + " slices");
+    var bars = slices_div.append("svg")
+        .attr("width", bar_w * summaries.length)
+        .attr("height", bars_h);
+
+    bars.selectAll("rect")
+        .data(summaries)
+        .enter().append("rect")
+        .attr("x", function(d, i) { return i * bar_w; })
+        .attr("y", function(d) { return bars_h - heightScale(d.num_factors); })
+        .attr("width", Math.max(1, bar_w - 1))
+        .attr("height", function(d) { return heightScale(d.num_factors); })
+        .attr("fill", function(d) { return errorScale(d.max_error); })
+        .on("click", load_slice)
+        .append("title")
+        .text(function(d) {
+            var types = Object.keys(d.types).map(function(type) {
+                return type + ": " + d.types[type];
+            });
+            return [d.name,
+                    "variables: " + d.num_variables,
+                    "factors: " + d.num_factors,
+                    "error: " + d.error,
+                    "max error: " + d.max_error,
+                    "neighbors: " + d.neighbors.join(", ")]
+                .concat(types).join("\n");
+        });
+}
+
+
+/**
+ * @brief       fetch the chunk of a slice, once, and draw it in detail
+ * @param[in]   summary: the summary of the slice
+ */
+function load_slice(summary) {
+    var chunk = chunk_cache[summary.chunk];
+    var loaded = chunk ? Promise.resolve(chunk)
+                       : d3.json(slices_dir + "/" + summary.chunk);
+    loaded.then(function(data) {
+        chunk_cache[summary.chunk] = data;
+        svg.selectAll("*").remove();
+        clear_options();
+        write_text(svg);
+        line_chart = svg.append("g").attr('class', 'line_chart');
+        draw_factor_graph(data);
+    });
+}